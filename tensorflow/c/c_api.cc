@@ -235,6 +235,80 @@ int64_t TF_Dim(const TF_Tensor* t, int dim_index) {
 size_t TF_TensorByteSize(const TF_Tensor* t) { return t->buffer->size(); }
 void* TF_TensorData(const TF_Tensor* t) { return t->buffer->data(); }
 
+// --------------------------------------------------------------------------
+namespace {
+
+// Deallocator of the buffers of TF_TensorPool, called when TensorFlow and the
+// caller hold no more references to a buffer.
+void ReturnBufferToPool(void* data, size_t len, void* arg) {
+  TF_TensorPool* pool = static_cast<TF_TensorPool*>(arg);
+  {
+    tensorflow::mutex_lock l(pool->mu);
+    if (!pool->deleted && pool->cached_bytes + len <= pool->max_cached_bytes) {
+      pool->free_buffers.emplace(len, data);
+      pool->cached_bytes += len;
+      data = nullptr;
+    }
+  }
+  if (data != nullptr) {
+    deallocate_buffer(data, len, nullptr);
+  }
+  pool->Unref();
+}
+
+}  // namespace
+
+TF_TensorPool::~TF_TensorPool() {
+  for (const auto& buffer : free_buffers) {
+    deallocate_buffer(buffer.second, buffer.first, nullptr);
+  }
+}
+
+TF_TensorPool* TF_NewTensorPool(size_t max_cached_bytes) {
+  return new TF_TensorPool(max_cached_bytes);
+}
+
+void TF_DeleteTensorPool(TF_TensorPool* pool) {
+  std::unordered_multimap<size_t, void*> free_buffers;
+  {
+    tensorflow::mutex_lock l(pool->mu);
+    pool->deleted = true;
+    pool->free_buffers.swap(free_buffers);
+    pool->cached_bytes = 0;
+  }
+  for (const auto& buffer : free_buffers) {
+    deallocate_buffer(buffer.second, buffer.first, nullptr);
+  }
+  pool->Unref();
+}
+
+TF_Tensor* TF_TensorPoolAllocate(TF_TensorPool* pool, TF_DataType dtype,
+                                 const int64_t* dims, int num_dims,
+                                 size_t len) {
+  void* data = nullptr;
+  {
+    tensorflow::mutex_lock l(pool->mu);
+    auto it = pool->free_buffers.find(len);
+    if (it != pool->free_buffers.end()) {
+      data = it->second;
+      pool->free_buffers.erase(it);
+      pool->cached_bytes -= len;
+    }
+  }
+  if (data == nullptr) {
+    data = allocate_tensor("TF_TensorPoolAllocate", len);
+  }
+  // Released by ReturnBufferToPool.
+  pool->Ref();
+  return TF_NewTensor(dtype, dims, num_dims, data, len, &ReturnBufferToPool,
+                      pool);
+}
+
+size_t TF_TensorPoolCachedBytes(TF_TensorPool* pool) {
+  tensorflow::mutex_lock l(pool->mu);
+  return pool->cached_bytes;
+}
+
 // --------------------------------------------------------------------------
 size_t TF_StringEncode(const char* src, size_t src_len, char* dst,
                        size_t dst_len, TF_Status* status) {
@@ -2540,6 +2614,44 @@ void TF_SessionRun(TF_Session* session, const TF_Buffer* run_options,
                 status);
 }
 
+void TF_SessionRunWithOutputTensors(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    TF_Tensor* const* input_values, int ninputs, const TF_Output* outputs,
+    TF_Tensor** output_values, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets,
+    TF_Buffer* run_metadata, TF_Status* status) {
+  std::vector<TF_Tensor*> fetched(noutputs, nullptr);
+  TF_SessionRun(session, run_options, inputs, input_values, ninputs, outputs,
+                fetched.data(), noutputs, target_opers, ntargets, run_metadata,
+                status);
+  if (!status->status.ok()) {
+    for (TF_Tensor* t : fetched) {
+      if (t != nullptr) TF_DeleteTensor(t);
+    }
+    return;
+  }
+
+  for (int i = 0; i < noutputs; ++i) {
+    TF_Tensor* provided = output_values[i];
+    TF_Tensor* value = fetched[i];
+    // A buffer referenced by a tensor in the runtime, e.g. one of a fed
+    // input that was enqueued, must not be overwritten.
+    if (provided != nullptr && provided->dtype == value->dtype &&
+        value->dtype != TF_STRING && value->dtype != TF_RESOURCE &&
+        provided->shape == value->shape &&
+        provided->buffer->size() == value->buffer->size() &&
+        provided->buffer->RefCountIsOne() &&
+        provided->buffer->root_buffer()->RefCountIsOne()) {
+      std::memcpy(provided->buffer->data(), value->buffer->data(),
+                  value->buffer->size());
+      TF_DeleteTensor(value);
+    } else {
+      if (provided != nullptr) TF_DeleteTensor(provided);
+      output_values[i] = value;
+    }
+  }
+}
+
 void TF_SessionPRunSetup(TF_Session* session, const TF_Output* inputs,
                          int ninputs, const TF_Output* outputs, int noutputs,
                          const TF_Operation* const* target_opers, int ntargets,
@@ -267,6 +267,33 @@ TF_CAPI_EXPORT extern size_t TF_TensorByteSize(const TF_Tensor*);
 // Return a pointer to the underlying data buffer.
 TF_CAPI_EXPORT extern void* TF_TensorData(const TF_Tensor*);
 
+// --------------------------------------------------------------------------
+// TF_TensorPool recycles the buffers of tensors, e.g. of the inputs fed to
+// TF_SessionRun on every request, instead of freeing and allocating them
+// again. A buffer returns to its pool once the tensor allocated from it is
+// deleted and TensorFlow holds no reference to it, e.g. from a queue it was
+// enqueued to, so a recycled buffer is never shared with a running graph.
+typedef struct TF_TensorPool TF_TensorPool;
+
+// Returns a new pool, which keeps up to `max_cached_bytes` of unused buffers.
+TF_CAPI_EXPORT extern TF_TensorPool* TF_NewTensorPool(size_t max_cached_bytes);
+
+// Deletes the pool and the unused buffers it keeps. Tensors allocated from it
+// remain valid and free their buffers when they are deleted.
+TF_CAPI_EXPORT extern void TF_DeleteTensorPool(TF_TensorPool*);
+
+// Like TF_AllocateTensor, but reuses an unused buffer of `pool` of exactly
+// `len` bytes if there is one. The contents of a reused buffer are those
+// left by its previous tensor.
+TF_CAPI_EXPORT extern TF_Tensor* TF_TensorPoolAllocate(TF_TensorPool* pool,
+                                                       TF_DataType,
+                                                       const int64_t* dims,
+                                                       int num_dims,
+                                                       size_t len);
+
+// Returns the number of bytes of unused buffers that `pool` keeps.
+TF_CAPI_EXPORT extern size_t TF_TensorPoolCachedBytes(TF_TensorPool* pool);
+
 // --------------------------------------------------------------------------
 // Encode the string `src` (`src_len` bytes long) into `dst` in the format
 // required by TF_STRING tensors. Does not write to memory more than `dst_len`
@@ -1342,6 +1369,31 @@ TF_CAPI_EXPORT extern void TF_SessionRun(
     // Output status
     TF_Status*);
 
+// Like TF_SessionRun, but output_values[i] may hold a tensor provided by the
+// caller, e.g. from a previous call, to receive the value of outputs[i]. The
+// value is copied into the provided tensor, which is returned in
+// output_values[i], when it has the same type and shape, the type is neither
+// TF_STRING nor TF_RESOURCE, and TensorFlow holds no other reference to the
+// tensor's buffer. Otherwise the provided tensor is deleted and replaced by a
+// new one, as if output_values[i] were NULL.
+//
+// On failure, output_values[] contains the provided tensors, unmodified, and
+// NULLs.
+TF_CAPI_EXPORT extern void TF_SessionRunWithOutputTensors(
+    TF_Session* session,
+    // RunOptions
+    const TF_Buffer* run_options,
+    // Input tensors
+    const TF_Output* inputs, TF_Tensor* const* input_values, int ninputs,
+    // Output tensors
+    const TF_Output* outputs, TF_Tensor** output_values, int noutputs,
+    // Target operations
+    const TF_Operation* const* target_opers, int ntargets,
+    // RunMetadata
+    TF_Buffer* run_metadata,
+    // Output status
+    TF_Status*);
+
 // Set up the graph with the intended feeds (inputs) and fetches (outputs) for a
 // sequence of partial run calls.
 //
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -55,6 +56,22 @@ struct TF_Tensor {
   tensorflow::TensorBuffer* buffer;
 };
 
+// Holds a reference for its owner and one for each buffer allocated from it
+// that is in use, so that buffers can return to it after TF_DeleteTensorPool.
+struct TF_TensorPool : public tensorflow::core::RefCounted {
+  explicit TF_TensorPool(size_t max_cached_bytes)
+      : max_cached_bytes(max_cached_bytes) {}
+  ~TF_TensorPool() override;
+
+  const size_t max_cached_bytes;
+  tensorflow::mutex mu;
+  // Unused buffers by size.
+  std::unordered_multimap<size_t, void*> free_buffers GUARDED_BY(mu);
+  size_t cached_bytes GUARDED_BY(mu) = 0;
+  // Set by TF_DeleteTensorPool, after which buffers are freed when unused.
+  bool deleted GUARDED_BY(mu) = false;
+};
+
 struct TF_SessionOptions {
   tensorflow::SessionOptions options;
 };
@@ -121,6 +121,39 @@ TEST(CAPI, MaybeMove) {
   EXPECT_TRUE(deallocator_called);
 }
 
+TEST(CAPI, TensorPool) {
+  TF_TensorPool* pool = TF_NewTensorPool(1 << 20);
+  int64_t dims[] = {2, 3};
+  const int num_bytes = 6 * sizeof(float);
+  TF_Tensor* t = TF_TensorPoolAllocate(pool, TF_FLOAT, dims, 2, num_bytes);
+  EXPECT_EQ(TF_FLOAT, TF_TensorType(t));
+  EXPECT_EQ(2, TF_NumDims(t));
+  EXPECT_EQ(num_bytes, TF_TensorByteSize(t));
+  void* data = TF_TensorData(t);
+  EXPECT_EQ(0, reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES);
+  TF_DeleteTensor(t);
+  EXPECT_EQ(num_bytes, TF_TensorPoolCachedBytes(pool));
+
+  // A buffer of the same size is reused, one of another size is not.
+  t = TF_TensorPoolAllocate(pool, TF_INT32, dims, 2, num_bytes);
+  EXPECT_EQ(data, TF_TensorData(t));
+  EXPECT_EQ(0, TF_TensorPoolCachedBytes(pool));
+  TF_Tensor* other = TF_TensorPoolAllocate(pool, TF_FLOAT, dims, 1, 8);
+  EXPECT_NE(data, TF_TensorData(other));
+
+  // A buffer still referenced by the runtime does not return to the pool.
+  tensorflow::Tensor in_use;
+  ASSERT_TRUE(TF_TensorToTensor(t, &in_use).ok());
+  TF_DeleteTensor(t);
+  EXPECT_EQ(0, TF_TensorPoolCachedBytes(pool));
+  in_use = tensorflow::Tensor();
+  EXPECT_EQ(num_bytes, TF_TensorPoolCachedBytes(pool));
+
+  // Tensors outlive their pool.
+  TF_DeleteTensorPool(pool);
+  TF_DeleteTensor(other);
+}
+
 TEST(CAPI, LibraryLoadFunctions) {
   // Load the library.
   TF_Status* status = TF_NewStatus();
@@ -886,6 +919,65 @@ TEST(CAPI, Session) {
   TF_DeleteStatus(s);
 }
 
+TEST(CAPI, SessionRunWithOutputTensors) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+  TF_Operation* feed = Placeholder(graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_Operation* add = Add(feed, two, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* session = TF_NewSession(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Output input{feed, 0};
+  TF_Output output{add, 0};
+  TF_Tensor* input_value = Int32Tensor(3);
+
+  // A tensor of the fetched type and shape receives the value.
+  TF_Tensor* provided = TF_AllocateTensor(TF_INT32, nullptr, 0, sizeof(int32));
+  TF_Tensor* output_value = provided;
+  TF_SessionRunWithOutputTensors(session, nullptr, &input, &input_value, 1,
+                                 &output, &output_value, 1, nullptr, 0,
+                                 nullptr, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(provided, output_value);
+  EXPECT_EQ(3 + 2, *static_cast<int32*>(TF_TensorData(output_value)));
+
+  // A tensor of another shape is replaced.
+  int64_t dims[] = {2};
+  TF_DeleteTensor(output_value);
+  output_value = TF_AllocateTensor(TF_INT32, dims, 1, 2 * sizeof(int32));
+  TF_SessionRunWithOutputTensors(session, nullptr, &input, &input_value, 1,
+                                 &output, &output_value, 1, nullptr, 0,
+                                 nullptr, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  EXPECT_EQ(0, TF_NumDims(output_value));
+  EXPECT_EQ(3 + 2, *static_cast<int32*>(TF_TensorData(output_value)));
+
+  // On failure, here because the placeholder is not fed, the provided tensor
+  // is returned unmodified.
+  TF_SessionRunWithOutputTensors(session, nullptr, &input, &input_value, 0,
+                                 &output, &output_value, 1, nullptr, 0,
+                                 nullptr, s);
+  EXPECT_NE(TF_OK, TF_GetCode(s));
+  ASSERT_TRUE(output_value != nullptr);
+  EXPECT_EQ(3 + 2, *static_cast<int32*>(TF_TensorData(output_value)));
+
+  TF_DeleteTensor(output_value);
+  TF_DeleteTensor(input_value);
+  TF_CloseSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(session, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 TEST(CAPI, SessionPRun) {
   TF_Status* s = TF_NewStatus();
   TF_Graph* graph = TF_NewGraph();
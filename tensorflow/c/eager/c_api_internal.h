@@ -70,8 +70,8 @@ struct TFE_Context {
 };
 
 struct TFE_TensorHandle {
-  TFE_TensorHandle(const tensorflow::Tensor& t, tensorflow::Device* d)
-      : t(t), d(d) {}
+  TFE_TensorHandle(tensorflow::Tensor t, tensorflow::Device* d)
+      : t(std::move(t)), d(d) {}
 
   tensorflow::Tensor t;
   // TODO(ashankar): d == nullptr iff local CPU
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/public/version.h"
@@ -164,7 +165,15 @@ namespace {
 inline tensorflow::Fprint128 FingerprintCat128(const tensorflow::Fprint128& a,
                                                const tensorflow::Fprint128& b) {
   return {tensorflow::FingerprintCat64(a.low64, b.low64),
-          tensorflow::FingerprintCat64(a.low64, b.low64)};
+          tensorflow::FingerprintCat64(a.high64, b.high64)};
+}
+
+// The cache key only has to be stable within the process, so attribute names
+// and string values are hashed in place instead of being copied into the
+// strings that Fingerprint128 takes.
+inline tensorflow::Fprint128 HashString(const StringPiece& s) {
+  return {Hash64(s.data(), s.size(), 0xDECAFCAFFE),
+          Hash64(s.data(), s.size(), 0xFEEDFACE)};
 }
 
 void CombineUnordered(const tensorflow::Fprint128& a,
@@ -175,9 +184,7 @@ void CombineUnordered(const tensorflow::Fprint128& a,
 
 inline tensorflow::Fprint128 CacheKeyHelper(const StringPiece& s,
                                             const tensorflow::Fprint128& b) {
-  // TODO(agarwal): avoid ToString().
-  tensorflow::Fprint128 a = tensorflow::Fingerprint128(s.ToString());
-  return FingerprintCat128(a, b);
+  return FingerprintCat128(HashString(s), b);
 }
 
 inline tensorflow::Fprint128 CacheKeyHelper(const StringPiece& s, uint64 b) {
@@ -204,10 +211,7 @@ tensorflow::Fprint128 AttrBuilder::CacheKey(const string& device) const {
     if (node_def_finalized_) return f;
   }
   for (const auto& p : string_attrs_) {
-    // TODO(agarwal): avoid ToString().
-    CombineUnordered(CacheKeyHelper(p.first, tensorflow::Fingerprint128(
-                                                 p.second.ToString())),
-                     &f);
+    CombineUnordered(CacheKeyHelper(p.first, HashString(p.second)), &f);
   }
   for (const auto& p : int_attrs_) {
     CombineUnordered(CacheKeyHelper(p.first, static_cast<uint64>(p.second)),
@@ -247,6 +251,7 @@ Status KernelAndDevice::InitOp(Device* device, const NodeDef& ndef,
   out->device_ = device;
   out->kernel_.reset(k);
   out->flib_ = nullptr;
+  if (s.ok()) out->InitOutputAttrs();
   return s;
 }
 
@@ -258,9 +263,19 @@ Status KernelAndDevice::Init(const NodeDef& ndef, FunctionLibraryRuntime* flib,
   out->device_ = flib->device();
   out->kernel_.reset(k);
   out->flib_ = flib;
+  if (s.ok()) out->InitOutputAttrs();
   return s;
 }
 
+void KernelAndDevice::InitOutputAttrs() {
+  output_attrs_.resize(kernel_->num_outputs());
+  for (size_t i = 0; i < output_attrs_.size(); ++i) {
+    output_attrs_[i] = AllocatorAttributes();
+    output_attrs_[i].set_on_host(kernel_->output_memory_types()[i] ==
+                                 tensorflow::HOST_MEMORY);
+  }
+}
+
 Status KernelAndDevice::Run(std::vector<Tensor>* input_tensors,
                             std::vector<Tensor>* output_tensors) {
   gtl::InlinedVector<TensorValue, 4> inputs;
@@ -268,34 +283,33 @@ Status KernelAndDevice::Run(std::vector<Tensor>* input_tensors,
     inputs.push_back(TensorValue(&t));
   }
 
-  std::vector<AllocatorAttributes> out_attrs(kernel_->num_outputs());
-  for (size_t i = 0; i < out_attrs.size(); ++i) {
-    out_attrs[i].set_on_host(kernel_->output_memory_types()[i] ==
-                             tensorflow::HOST_MEMORY);
-  }
-
   OpKernelContext::Params params;
   params.device = device_;
   params.frame_iter = FrameAndIter(0, 0);
   params.inputs = &inputs;
   params.op_kernel = kernel_.get();
   params.resource_manager = device_->resource_manager();
-  params.output_attr_array = gtl::vector_as_array(&out_attrs);
+  params.output_attr_array = output_attrs_.data();
   params.function_library = flib_;
   params.slice_reader_cache = &slice_reader_cache_;
   params.rendezvous = rendez_;
-  // TODO(apassos): use a thread pool.
-  std::function<void(std::function<void()>)> runner =
-      [](std::function<void()> f) { f(); };
-  params.runner = &runner;
+  params.runner = &runner_;
 
   OpKernelContext context(&params);
   device_->Compute(kernel_.get(), &context);
   if (!context.status().ok()) return context.status();
 
   output_tensors->clear();
+  output_tensors->reserve(context.num_outputs());
   for (int i = 0; i < context.num_outputs(); ++i) {
-    output_tensors->push_back(Tensor(*context.mutable_output(i)));
+    TensorValue val = context.release_output(i);
+    if (val.is_ref()) {
+      // Ref outputs are owned by the op, e.g. a variable, so copy the handle.
+      output_tensors->push_back(*val.tensor);
+    } else {
+      output_tensors->push_back(std::move(*val.tensor));
+      delete val.tensor;
+    }
   }
   return Status::OK();
 }
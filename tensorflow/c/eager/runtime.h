@@ -171,8 +171,12 @@ class KernelAndDevice {
   static Status InitOp(Device* device, const NodeDef& ndef,
                        KernelAndDevice* out);
 
+  // TODO(apassos): use a thread pool.
   KernelAndDevice(tensorflow::Rendezvous* rendez)
-      : device_(nullptr), flib_(nullptr), rendez_(rendez) {}
+      : device_(nullptr),
+        flib_(nullptr),
+        rendez_(rendez),
+        runner_([](std::function<void()> f) { f(); }) {}
 
   // TODO(ashankar): Handle list-valued inputs.
   Status Run(std::vector<Tensor>* inputs, std::vector<Tensor>* outputs);
@@ -180,11 +184,17 @@ class KernelAndDevice {
   const OpKernel* kernel() const { return kernel_.get(); }
 
  private:
+  // Computes the allocator attributes of the outputs once per kernel, instead
+  // of once per Run().
+  void InitOutputAttrs();
+
   std::unique_ptr<OpKernel> kernel_;
   Device* device_;
   FunctionLibraryRuntime* flib_;
   checkpoint::TensorSliceReaderCacheWrapper slice_reader_cache_;
   Rendezvous* rendez_;
+  std::vector<AllocatorAttributes> output_attrs_;
+  std::function<void(std::function<void()>)> runner_;
 };
 
 }  // namespace tensorflow
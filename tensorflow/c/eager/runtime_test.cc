@@ -79,6 +79,25 @@ TEST(AttrTypeMap, Lookup) {
   EXPECT_NE(is_list, 0);
 }
 
+TEST(AttrBuilder, CacheKey) {
+  auto key = [](bool transpose_a, const string& device) {
+    return AttrBuilder("MatMul")
+        .Set("T", DT_FLOAT)
+        .Set("transpose_a", transpose_a)
+        .Set("transpose_b", false)
+        .NumInputs(2)
+        .CacheKey(device);
+  };
+  EXPECT_EQ(key(false, "cpu:0"), key(false, "cpu:0"));
+  EXPECT_FALSE(key(false, "cpu:0") == key(true, "cpu:0"));
+  EXPECT_FALSE(key(false, "cpu:0") == key(false, "cpu:1"));
+
+  const Fprint128 a = AttrBuilder("Squeeze").Set("T", DT_FLOAT).CacheKey("");
+  const Fprint128 b = AttrBuilder("Squeeze").Set("T", DT_INT32).CacheKey("");
+  EXPECT_FALSE(a == b);
+  EXPECT_FALSE(a.low64 == a.high64);
+}
+
 TEST(KernelAndDevice, Run) {
   Tensor t(Input({{1.0f, 2.0f}, {3.0f, 4.0f}}).tensor());
   std::vector<Tensor> inputs;
@@ -187,5 +206,20 @@ void BM_KernelAndDeviceRun(int iters) {
   }
 }
 BENCHMARK(BM_KernelAndDeviceRun);
+
+void BM_AttrBuilderCacheKey(int iters) {
+  const string device = "/job:a/replica:0/task:0/device:CPU:0";
+  uint64 sum = 0;
+  for (int i = 0; i < iters; ++i) {
+    AttrBuilder a("MatMul");
+    a.Set("T", DT_FLOAT)
+        .Set("transpose_a", false)
+        .Set("transpose_b", false)
+        .NumInputs(2);
+    sum += a.CacheKey(device).low64;
+  }
+  CHECK_NE(sum, 0);
+}
+BENCHMARK(BM_AttrBuilderCacheKey);
 }  // namespace
 }  // namespace tensorflow
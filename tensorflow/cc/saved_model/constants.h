@@ -24,6 +24,13 @@ constexpr char kSavedModelAssetsDirectory[] = "assets";
 /// SavedModel assets.extra directory.
 constexpr char kSavedModelAssetsExtraDirectory[] = "assets.extra";
 
+/// Name of the file in the assets.extra directory with the requests to replay
+/// through the session after loading. It is a TFRecord file of serialized
+/// RunStepRequest protos, of which only the feeds, fetches, targets and run
+/// options are used.
+constexpr char kSavedModelWarmupRequestsFilename[] =
+    "saved_model_warmup_requests";
+
 /// SavedModel assets key for graph collection-def.
 constexpr char kSavedModelAssetsKey[] = "saved_model_assets";
 
@@ -15,14 +15,20 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
 #include <unordered_set>
 
 #include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
+#include "tensorflow/core/protobuf/master.pb.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
@@ -40,6 +46,11 @@ auto* load_latency = monitoring::Counter<1>::New(
     "/tensorflow/cc/saved_model/load_latency",
     "Latency in microseconds for SavedModels that were successfully loaded.",
     "model_path");
+auto* warmup_latency = monitoring::Counter<1>::New(
+    "/tensorflow/cc/saved_model/warmup_latency",
+    "Latency in microseconds for running the warmup requests of SavedModels "
+    "that were successfully loaded.",
+    "model_path");
 constexpr char kLoadAttemptFail[] = "fail";
 constexpr char kLoadAttemptSuccess[] = "success";
 
@@ -62,10 +73,13 @@ Status ReadSavedModel(const string& export_dir, SavedModel* saved_model_proto) {
                     export_dir);
 }
 
-Status FindMetaGraphDefToLoad(const SavedModel& saved_model_proto,
+// Moves the meta graph def matching 'tags' out of '*saved_model_proto', which
+// saves copying a possibly large graph.
+Status FindMetaGraphDefToLoad(SavedModel* saved_model_proto,
                               const std::unordered_set<string>& tags,
                               MetaGraphDef* meta_graph_def_to_load) {
-  for (const MetaGraphDef& meta_graph_def : saved_model_proto.meta_graphs()) {
+  for (MetaGraphDef& meta_graph_def :
+       *saved_model_proto->mutable_meta_graphs()) {
     // Get tags from the meta_graph_def.
     std::unordered_set<string> graph_tags;
     for (const string& tag : meta_graph_def.meta_info_def().tags()) {
@@ -73,7 +87,7 @@ Status FindMetaGraphDefToLoad(const SavedModel& saved_model_proto,
     }
     // Match with the set of tags provided.
     if (graph_tags == tags) {
-      *meta_graph_def_to_load = meta_graph_def;
+      meta_graph_def_to_load->Swap(&meta_graph_def);
       return Status::OK();
     }
   }
@@ -207,6 +221,19 @@ Status RunLegacyInitOp(const RunOptions& run_options, const string& export_dir,
   return Status::OK();
 }
 
+// Runs the main op if there is one, or else the legacy init op.
+Status RunInitOp(const RunOptions& run_options, const string& export_dir,
+                 const MetaGraphDef& meta_graph_def,
+                 const std::vector<AssetFileDef>& asset_file_defs,
+                 Session* session) {
+  if (HasMainOp(meta_graph_def)) {
+    return RunMainOp(run_options, export_dir, meta_graph_def, asset_file_defs,
+                     session);
+  }
+  return RunLegacyInitOp(run_options, export_dir, meta_graph_def,
+                         asset_file_defs, session);
+}
+
 Status GetAssetFileDefs(const MetaGraphDef& meta_graph_def,
                         std::vector<AssetFileDef>* asset_file_defs) {
   const auto& collection_def_map = meta_graph_def.collection_def();
@@ -224,8 +251,94 @@ Status GetAssetFileDefs(const MetaGraphDef& meta_graph_def,
   return Status::OK();
 }
 
+// Reads the warmup requests of the SavedModel in 'export_dir', if any.
+Status ReadWarmupRequests(const string& export_dir,
+                          std::vector<RunStepRequest>* requests) {
+  const string warmup_path =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                   kSavedModelWarmupRequestsFilename);
+  if (!Env::Default()->FileExists(warmup_path).ok()) {
+    return Status::OK();
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(warmup_path, &file));
+  io::RecordReader reader(file.get());
+  uint64 offset = 0;
+  string record;
+  for (;;) {
+    const Status status = reader.ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(status)) break;
+    TF_RETURN_IF_ERROR(status);
+    requests->emplace_back();
+    if (!requests->back().ParseFromString(record)) {
+      return errors::DataLoss("Could not parse warmup request ",
+                              requests->size() - 1, " of ", warmup_path);
+    }
+  }
+  return Status::OK();
+}
+
+Status RunWarmupRequest(const RunStepRequest& request, Session* session) {
+  std::vector<std::pair<string, Tensor>> inputs;
+  for (const NamedTensorProto& feed : request.feed()) {
+    Tensor tensor;
+    if (!tensor.FromProto(feed.tensor())) {
+      return errors::InvalidArgument("Invalid warmup tensor for ",
+                                     feed.name());
+    }
+    inputs.emplace_back(feed.name(), tensor);
+  }
+  const std::vector<string> output_names(request.fetch().begin(),
+                                         request.fetch().end());
+  const std::vector<string> target_names(request.target().begin(),
+                                         request.target().end());
+  std::vector<Tensor> outputs;
+  RunMetadata run_metadata;
+  return session->Run(request.options(), inputs, output_names, target_names,
+                      &outputs, &run_metadata);
+}
+
+// Replays the warmup requests of the SavedModel in 'export_dir', if any, on
+// 'num_threads' threads. Returns the first error.
+Status RunWarmupRequests(const string& export_dir, int num_threads,
+                         Session* session) {
+  std::vector<RunStepRequest> requests;
+  TF_RETURN_IF_ERROR(ReadWarmupRequests(export_dir, &requests));
+  if (requests.empty()) {
+    return Status::OK();
+  }
+  LOG(INFO) << "Running " << requests.size()
+            << " warmup requests on SavedModel bundle.";
+  const uint64 start_microseconds = Env::Default()->NowMicros();
+  mutex mu;
+  Status status;
+  {
+    thread::ThreadPool pool(Env::Default(), "saved_model_warmup",
+                            std::min<int>(num_threads, requests.size()));
+    for (const RunStepRequest& request : requests) {
+      pool.Schedule([&request, session, &mu, &status] {
+        const Status request_status = RunWarmupRequest(request, session);
+        mutex_lock l(mu);
+        status.Update(request_status);
+      });
+    }
+  }  // Waits for all the requests.
+  const uint64 end_microseconds = Env::Default()->NowMicros();
+  const uint64 warmup_latency_microsecs =
+      end_microseconds > start_microseconds
+          ? end_microseconds - start_microseconds
+          : 0;
+  LOG(INFO) << "Warmup of SavedModel: " << (status.ok() ? "success" : "fail")
+            << ". Took " << warmup_latency_microsecs << " microseconds.";
+  if (status.ok()) {
+    warmup_latency->GetCell(export_dir)->IncrementBy(warmup_latency_microsecs);
+  }
+  return status;
+}
+
 Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
+                              const LoadSavedModelOptions& load_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
@@ -238,8 +351,8 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   SavedModel saved_model_proto;
   TF_RETURN_IF_ERROR(ReadSavedModel(export_dir, &saved_model_proto));
 
-  TF_RETURN_IF_ERROR(
-      FindMetaGraphDefToLoad(saved_model_proto, tags, &bundle->meta_graph_def));
+  TF_RETURN_IF_ERROR(FindMetaGraphDefToLoad(&saved_model_proto, tags,
+                                            &bundle->meta_graph_def));
 
   TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
       bundle->meta_graph_def, session_options, &bundle->session));
@@ -247,19 +360,36 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(
       GetAssetFileDefs(bundle->meta_graph_def, &asset_file_defs));
-  TF_RETURN_IF_ERROR(
-      RunRestore(run_options, export_dir,
-                 bundle->meta_graph_def.saver_def().restore_op_name(),
-                 bundle->meta_graph_def.saver_def().filename_tensor_name(),
-                 asset_file_defs, bundle->session.get()));
-  if (HasMainOp(bundle->meta_graph_def)) {
-    TF_RETURN_IF_ERROR(RunMainOp(run_options, export_dir,
+  auto run_restore = [&]() {
+    return RunRestore(run_options, export_dir,
+                      bundle->meta_graph_def.saver_def().restore_op_name(),
+                      bundle->meta_graph_def.saver_def().filename_tensor_name(),
+                      asset_file_defs, bundle->session.get());
+  };
+  if (!load_options.run_restore_and_init_concurrently) {
+    TF_RETURN_IF_ERROR(run_restore());
+    TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir,
                                  bundle->meta_graph_def, asset_file_defs,
                                  bundle->session.get()));
   } else {
-    TF_RETURN_IF_ERROR(RunLegacyInitOp(run_options, export_dir,
-                                       bundle->meta_graph_def, asset_file_defs,
-                                       bundle->session.get()));
+    // Session::Run() may be called concurrently, so the restore runs on its
+    // own thread while this one runs the init op.
+    Status restore_status;
+    Status init_status;
+    {
+      std::unique_ptr<Thread> restore_thread(Env::Default()->StartThread(
+          ThreadOptions(), "saved_model_restore",
+          [&run_restore, &restore_status] { restore_status = run_restore(); }));
+      init_status = RunInitOp(run_options, export_dir, bundle->meta_graph_def,
+                              asset_file_defs, bundle->session.get());
+    }  // Joins 'restore_thread'.
+    TF_RETURN_IF_ERROR(restore_status);
+    TF_RETURN_IF_ERROR(init_status);
+  }
+
+  if (load_options.num_warmup_threads > 0) {
+    TF_RETURN_IF_ERROR(RunWarmupRequests(
+        export_dir, load_options.num_warmup_threads, bundle->session.get()));
   }
   return Status::OK();
 }
@@ -270,10 +400,20 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const RunOptions& run_options, const string& export_dir,
                       const std::unordered_set<string>& tags,
                       SavedModelBundle* const bundle) {
+  return LoadSavedModel(session_options, run_options, LoadSavedModelOptions(),
+                        export_dir, tags, bundle);
+}
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options,
+                      const LoadSavedModelOptions& load_options,
+                      const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      SavedModelBundle* const bundle) {
   // TODO(robson): Add tests for the counters.
   const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
+  const Status status = LoadSavedModelInternal(
+      session_options, run_options, load_options, export_dir, tags, bundle);
   const uint64 load_latency_microsecs = [&]() -> uint64 {
     const uint64 end_microseconds = Env::Default()->NowMicros();
     // Avoid clock skew.
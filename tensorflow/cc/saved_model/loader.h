@@ -43,6 +43,23 @@ struct SavedModelBundle {
   SavedModelBundle() = default;
 };
 
+/// Options for LoadSavedModel() that don't concern the session.
+struct LoadSavedModelOptions {
+  /// Runs the restore op and the main op (or legacy init op) concurrently
+  /// instead of one after the other, which hides the cheaper of the two. Only
+  /// safe if the init op doesn't read restored variables, as is the case of
+  /// the usual table and local variable initializers.
+  bool run_restore_and_init_concurrently = false;
+
+  /// If positive, the requests recorded in the assets.extra directory (see
+  /// kSavedModelWarmupRequestsFilename), if any, are run through the session
+  /// on this many threads before the load returns. This moves lazy
+  /// initialization work, such as allocator growth, kernel autotuning and
+  /// compilation, from the first real requests to the load. A failing warmup
+  /// request fails the load.
+  int num_warmup_threads = 0;
+};
+
 /// Loads a SavedModel from the specified export directory. The meta graph def
 /// to be loaded is identified by the supplied tags, corresponding exactly to
 /// the set of tags used at SavedModel build time. Returns a SavedModel bundle
@@ -52,6 +69,14 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundle* const bundle);
 
+/// Like the above, with the given load options.
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options,
+                      const LoadSavedModelOptions& load_options,
+                      const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      SavedModelBundle* const bundle);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
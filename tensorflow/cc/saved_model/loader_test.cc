@@ -24,7 +24,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/master.pb.h"
 
 namespace tensorflow {
 namespace {
@@ -179,6 +181,92 @@ TEST_F(LoaderTest, MainOpFormat) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, ConcurrentRestoreAndInit) {
+  SessionOptions session_options;
+  RunOptions run_options;
+  LoadSavedModelOptions load_options;
+  load_options.run_restore_and_init_concurrently = true;
+
+  for (const char* test_data : {kTestDataSharded, kTestDataMainOp}) {
+    SavedModelBundle bundle;
+    const string export_dir =
+        io::JoinPath(testing::TensorFlowSrcRoot(), test_data);
+    TF_ASSERT_OK(LoadSavedModel(session_options, run_options, load_options,
+                                export_dir, {kSavedModelTagServe}, &bundle));
+    CheckSavedModelBundle(export_dir, bundle);
+  }
+}
+
+// Copies the directory tree at 'from' to 'to'.
+void CopyDirectory(const string& from, const string& to) {
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(to));
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(from, &children));
+  for (const string& child : children) {
+    const string from_child = io::JoinPath(from, child);
+    const string to_child = io::JoinPath(to, child);
+    if (Env::Default()->IsDirectory(from_child).ok()) {
+      CopyDirectory(from_child, to_child);
+    } else {
+      string contents;
+      TF_ASSERT_OK(ReadFileToString(Env::Default(), from_child, &contents));
+      TF_ASSERT_OK(WriteStringToFile(Env::Default(), to_child, contents));
+    }
+  }
+}
+
+TEST_F(LoaderTest, WarmupRequests) {
+  const string export_dir =
+      io::JoinPath(testing::TmpDir(), "warmup_requests/00000123");
+  CopyDirectory(io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded),
+                export_dir);
+
+  // Record a request of the regression signature, and one that fails.
+  const string assets_extra_dir =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory);
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(assets_extra_dir));
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(
+      io::JoinPath(assets_extra_dir, kSavedModelWarmupRequestsFilename),
+      &file));
+  io::RecordWriter writer(file.get());
+  RunStepRequest request;
+  NamedTensorProto* feed = request.add_feed();
+  feed->set_name("tf_example:0");
+  test::AsTensor<string>({MakeSerializedExample(1)}, TensorShape({1}))
+      .AsProtoField(feed->mutable_tensor());
+  request.add_fetch("y:0");
+  TF_ASSERT_OK(writer.WriteRecord(request.SerializeAsString()));
+  TF_ASSERT_OK(writer.Flush());
+  TF_ASSERT_OK(file->Close());
+
+  SessionOptions session_options;
+  RunOptions run_options;
+  LoadSavedModelOptions load_options;
+  load_options.num_warmup_threads = 2;
+  {
+    SavedModelBundle bundle;
+    TF_ASSERT_OK(LoadSavedModel(session_options, run_options, load_options,
+                                export_dir, {kSavedModelTagServe}, &bundle));
+    CheckSavedModelBundle(export_dir, bundle);
+  }
+
+  request.set_fetch(0, "no_such_tensor:0");
+  TF_ASSERT_OK(Env::Default()->NewAppendableFile(
+      io::JoinPath(assets_extra_dir, kSavedModelWarmupRequestsFilename),
+      &file));
+  io::RecordWriter appender(file.get());
+  TF_ASSERT_OK(appender.WriteRecord(request.SerializeAsString()));
+  TF_ASSERT_OK(appender.Flush());
+  TF_ASSERT_OK(file->Close());
+  {
+    SavedModelBundle bundle;
+    EXPECT_FALSE(LoadSavedModel(session_options, run_options, load_options,
+                                export_dir, {kSavedModelTagServe}, &bundle)
+                     .ok());
+  }
+}
+
 TEST_F(LoaderTest, InvalidExportPath) {
   SavedModelBundle bundle;
   RunOptions run_options;
@@ -107,6 +107,11 @@ void DumpStatsToStdout(const Stats& stats) {
     printf("  %-*s %*.3f us\n", max_label_size, g.first.c_str(), max_digits + 4,
            g.second);
   }
+  if (stats.batch_size > 0 && stats.total_us > 0) {
+    printf("Throughput with batch size %lld: %.3f examples/s\n",
+           stats.batch_size,
+           1e6 * stats.batch_size * count_us / stats.total_us);
+  }
 }
 
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
@@ -115,6 +120,7 @@ void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
                            ? Options::kDefaultMicros
                            : options.max_micros;
   printf("Running benchmark for %lld us\n", max_us);
+  stats->batch_size = options.batch_size;
   const int64 start_us = NowMicros();
   int64 iters = 0;
   while (true) {
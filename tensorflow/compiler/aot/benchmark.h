@@ -42,18 +42,21 @@ struct Options {
 
   int64 max_iters = 0;   // Maximum iterations to run, ignored if <= 0.
   int64 max_micros = 0;  // Maximum microseconds to run, ignored if <= 0.
+  int64 batch_size = 0;  // Examples per iteration, ignored if <= 0.
 };
 
 // Stats holds statistics collected during benchmarking.
 struct Stats {
   std::vector<int64> per_iter_us;  // Per-iteration deltas in us.
   int64 total_us;                  // Total time in us.
+  int64 batch_size;                // Examples per iteration, or 0 if unknown.
 
-  Stats() : total_us(0) { per_iter_us.reserve(5000); }
+  Stats() : total_us(0), batch_size(0) { per_iter_us.reserve(5000); }
 };
 
 // DumpStatsToStdout printfs to stdout stats in a multi-line human-friendly
-// form.
+// form. If the batch size is known, the throughput in examples per second is
+// printed as well.
 void DumpStatsToStdout(const Stats& stats);
 
 // BenchmarkFn is the signature of the function generated by tfcompile.
@@ -38,6 +38,20 @@ TEST(Benchmark, Benchmark) {
   Stats stats5;
   Benchmark(options, [&] { add.Run(); }, &stats5);
   EXPECT_EQ(stats5.per_iter_us.size(), 5);
+  EXPECT_EQ(stats5.batch_size, 0);
+}
+
+TEST(Benchmark, BatchSize) {
+  AddComp add;
+
+  Options options;
+  options.max_iters = 3;
+  options.batch_size = 8;
+  Stats stats;
+  Benchmark(options, [&] { add.Run(); }, &stats);
+  EXPECT_EQ(stats.per_iter_us.size(), 3);
+  EXPECT_EQ(stats.batch_size, 8);
+  DumpStatsToStdout(stats);
 }
 
 }  // namespace
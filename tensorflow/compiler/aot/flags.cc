@@ -48,6 +48,11 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "http://clang.llvm.org/docs/CrossCompilation.html#cpu-fpu-abi"},
       {"target_features", &flags->target_features,
        "Target features, e.g. +avx2, +neon, etc."},
+      {"target_parallel_tasks", &flags->target_parallel_tasks,
+       "Maximum number of parallel tasks that one HLO op of the generated "
+       "function is split into.  If greater than 1, the generated function "
+       "runs these tasks on the thread pool passed to set_thread_pool, and "
+       "the binary depends on the XLA fork-join runtime."},
       {"entry_point", &flags->entry_point,
        "Name of the generated function.  If multiple generated object files "
        "will be linked into the same binary, each will need a unique entry "
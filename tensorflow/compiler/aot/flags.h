@@ -33,6 +33,7 @@ struct MainFlags {
   string target_cpu;
   string target_features;
   string entry_point;
+  int32 target_parallel_tasks = 1;
   string cpp_class;
   string out_object;
   string out_header;
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/kernels/xla_launch_op.h"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <vector>
+
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
@@ -25,15 +30,19 @@ limitations under the License.
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/variable_ops.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 
 namespace gpu = perftools::gputools;
@@ -145,7 +154,7 @@ Status XlaAllocator::MakeTensorFromBuffer(gpu::DeviceMemoryBase buffer,
 }
 
 XlaLocalLaunchOp::XlaLocalLaunchOp(OpKernelConstruction* ctx)
-    : OpKernel(ctx), device_type_(ctx->device_type()) {
+    : AsyncOpKernel(ctx), device_type_(ctx->device_type()) {
   const NameAttrList* func;
   OP_REQUIRES_OK(ctx, ctx->GetAttr("function", &func));
   function_ = *func;
@@ -160,15 +169,27 @@ XlaLocalLaunchOp::XlaLocalLaunchOp(OpKernelConstruction* ctx)
   } else {
     platform_id_ = nullptr;
   }
+  // XLA devices have no kernels to fall back to, and the function would not
+  // expect the compile-time constants in host memory on a GPU.
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_XLA_COMPILE_IN_BACKGROUND",
+                                         /*default_val=*/false,
+                                         &compile_in_background_));
+  compile_in_background_ =
+      compile_in_background_ && platform_id_ != nullptr &&
+      (device_type_ == DeviceType(DEVICE_CPU) || num_constant_args_ == 0);
 }
 
 Status XlaLocalLaunchOp::BuildCompilationCache(OpKernelContext* ctx,
                                                XlaCompilationCache** cache) {
+  // The number of signatures each cache holds; 0 leaves the cache unbounded.
+  int64 capacity;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_XLA_COMPILATION_CACHE_CAPACITY",
+                                         /*default_val=*/0, &capacity));
   const XlaDevice::Metadata* metadata;
   Status s = XlaDevice::GetMetadata(ctx, &metadata);
   if (s.ok()) {
     *cache = new XlaCompilationCache(metadata->client(),
-                                     metadata->jit_device_type());
+                                     metadata->jit_device_type(), capacity);
     return Status::OK();
   }
 
@@ -191,7 +212,8 @@ Status XlaLocalLaunchOp::BuildCompilationCache(OpKernelContext* ctx,
                                    device_type_.type());
   }
   *cache = new XlaCompilationCache(
-      client.ValueOrDie(), DeviceType(registration->compilation_device_name));
+      client.ValueOrDie(), DeviceType(registration->compilation_device_name),
+      capacity);
   return Status::OK();
 }
 
@@ -212,7 +234,144 @@ std::vector<OptionalTensor> SnapshotResourceVariables(OpKernelContext* ctx,
   return snapshot;
 }
 
-void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
+// Copies the buffer of `from` into `to`, which has the same size, on the
+// device of `ctx`.
+void CopyDeviceBuffer(OpKernelContext* ctx, const Tensor& from, Tensor* to) {
+  const size_t total_bytes = from.TotalBytes();
+  gpu::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream) {
+    gpu::DeviceMemoryBase src(const_cast<void*>(DMAHelper::base(&from)),
+                              total_bytes);
+    gpu::DeviceMemoryBase dst(DMAHelper::base(to), total_bytes);
+    stream->ThenMemcpyD2D(&dst, src, total_bytes);
+  } else {
+    std::memcpy(DMAHelper::base(to), DMAHelper::base(&from), total_bytes);
+  }
+}
+
+Status XlaLocalLaunchOp::DonateVariableBuffers(
+    OpKernelContext* ctx, const XlaCompiler::CompilationResult& kernel,
+    const xla::LocalExecutable& executable,
+    std::vector<OptionalTensor>* variables,
+    std::vector<Var*>* donated_variables,
+    std::vector<mutex_lock>* variable_locks,
+    std::map<int, Tensor>* donated_args) {
+  const int first_variable_arg = ctx->num_inputs() - num_resource_args_;
+  // The donated parameters of each variable. The variables are locked in the
+  // order of their addresses, so that concurrent launches cannot deadlock.
+  std::map<Var*, std::vector<int>> parameters_by_variable;
+  for (int64 parameter : executable.build_options().donated_parameters()) {
+    const int arg_num = kernel.input_mapping[parameter];
+    const int variable_num = arg_num - first_variable_arg;
+    if (variable_num < 0 || !(*variables)[variable_num].present) {
+      return errors::Internal("Parameter ", parameter,
+                              " of the XLA computation is donated but does "
+                              "not hold a variable");
+    }
+    Var* variable = nullptr;
+    TF_RETURN_IF_ERROR(
+        LookupResource(ctx, HandleFromInput(ctx, arg_num), &variable));
+    std::vector<int>& parameters = parameters_by_variable[variable];
+    if (parameters.empty()) {
+      donated_variables->push_back(variable);
+    } else {
+      variable->Unref();
+    }
+    parameters.push_back(parameter);
+  }
+
+  variable_locks->reserve(parameters_by_variable.size());
+  for (const auto& entry : parameters_by_variable) {
+    Var* variable = entry.first;
+    variable_locks->emplace_back(*variable->mu());
+    for (int parameter : entry.second) {
+      OptionalTensor& snapshot =
+          (*variables)[kernel.input_mapping[parameter] - first_variable_arg];
+      Tensor& arg = (*donated_args)[parameter];
+      if (snapshot.value.TotalBytes() == 0) {
+        arg = snapshot.value;
+        continue;
+      }
+      // Only the first parameter of a variable can use its buffer, and only
+      // if the variable still holds the snapshot. Our own snapshot is
+      // dropped before checking that no other tensor shares the buffer.
+      const Tensor* value = &snapshot.value;
+      bool in_place = false;
+      if (parameter == entry.second.front() &&
+          variable->tensor()->TotalBytes() > 0 &&
+          variable->tensor()->SharesBufferWith(snapshot.value)) {
+        snapshot.value = Tensor();
+        value = variable->tensor();
+        in_place = value->RefCountIsOne();
+      }
+      if (in_place) {
+        arg = *value;
+      } else {
+        TF_RETURN_IF_ERROR(
+            ctx->allocate_temp(value->dtype(), value->shape(), &arg));
+        CopyDeviceBuffer(ctx, *value, &arg);
+      }
+      VLOG(2) << "Variable " << snapshot.name << " is updated "
+              << (in_place ? "in place" : "in a copy");
+    }
+  }
+  return Status::OK();
+}
+
+void XlaLocalLaunchOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
+  bool fall_back = false;
+  ComputeWithXla(ctx, &fall_back);
+  if (fall_back) {
+    ComputeWithFunction(ctx, std::move(done));
+  } else {
+    done();
+  }
+}
+
+void XlaLocalLaunchOp::ComputeWithFunction(OpKernelContext* ctx,
+                                           DoneCallback done) {
+  VLOG(1) << "Running " << function_.name() << " until it is compiled";
+  FunctionLibraryRuntime* lib = ctx->function_library();
+  OP_REQUIRES_ASYNC(ctx, lib != nullptr,
+                    errors::Internal("No function library is provided."),
+                    done);
+  FunctionLibraryRuntime::Handle handle;
+  OP_REQUIRES_OK_ASYNC(
+      ctx,
+      lib->Instantiate(function_.name(), AttrSlice(&function_.attr()), &handle),
+      done);
+  FunctionLibraryRuntime::Options opts;
+  opts.step_id = ctx->step_id();
+  opts.rendezvous = ctx->rendezvous();
+  opts.cancellation_manager = ctx->cancellation_manager();
+  opts.step_container = ctx->step_container();
+  opts.stats_collector = ctx->stats_collector();
+  opts.runner = ctx->runner();
+  std::vector<Tensor> args;
+  args.reserve(ctx->num_inputs());
+  for (int i = 0; i < ctx->num_inputs(); ++i) {
+    args.push_back(ctx->input(i));
+  }
+  std::vector<Tensor>* rets = new std::vector<Tensor>;
+  lib->Run(opts, handle, args, rets, [ctx, done, rets](const Status& status) {
+    if (!status.ok()) {
+      ctx->SetStatus(status);
+    } else if (rets->size() != ctx->num_outputs()) {
+      ctx->SetStatus(errors::Internal("Expected ", ctx->num_outputs(),
+                                      " results from the function, got ",
+                                      rets->size()));
+    } else {
+      for (int i = 0; i < rets->size(); ++i) {
+        ctx->set_output(i, (*rets)[i]);
+      }
+    }
+    delete rets;
+    done();
+  });
+}
+
+void XlaLocalLaunchOp::ComputeWithXla(OpKernelContext* ctx, bool* fall_back) {
   VLOG(1) << "XlaLocalLaunchOp::Compute "
           << Canonicalize(function_.name(), AttrSlice(&function_.attr()));
   // We store information about the JIT-compiled XLA computation
@@ -257,11 +416,40 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
 
   const XlaCompiler::CompilationResult* kernel;
   xla::LocalExecutable* executable;
-  OP_REQUIRES_OK(ctx, cache->Compile(options, function_, num_constant_args_,
-                                     variables, ctx, &kernel, &executable));
+  std::shared_ptr<const void> cache_entry;
+  if (compile_in_background_) {
+    bool ready;
+    OP_REQUIRES_OK(ctx, cache->CompileInBackground(
+                            options, function_, num_constant_args_, variables,
+                            ctx, &kernel, &executable, &cache_entry, &ready));
+    if (!ready) {
+      *fall_back = true;
+      return;
+    }
+  } else {
+    OP_REQUIRES_OK(ctx,
+                   cache->Compile(options, function_, num_constant_args_,
+                                  variables, ctx, &kernel, &executable,
+                                  &cache_entry));
+  }
 
   VLOG(1) << "Executing XLA Computation...";
 
+  // The variables whose buffers the executable may overwrite stay locked
+  // until their new values are written.
+  std::vector<Var*> donated_variables;
+  auto unref_donated_variables = gtl::MakeCleanup([&donated_variables]() {
+    for (Var* variable : donated_variables) {
+      variable->Unref();
+    }
+  });
+  std::vector<mutex_lock> donated_variable_locks;
+  std::map<int, Tensor> donated_args;
+  OP_REQUIRES_OK(ctx, DonateVariableBuffers(ctx, *kernel, *executable,
+                                            &variables, &donated_variables,
+                                            &donated_variable_locks,
+                                            &donated_args));
+
   // Builds an XLA allocator for the device.
   XlaAllocator xla_allocator(client->platform(), ctx);
 
@@ -278,7 +466,10 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
   for (int i = 0; i < kernel->xla_input_shapes.size(); ++i) {
     int arg_num = kernel->input_mapping[i];
     const xla::Shape& shape = kernel->xla_input_shapes[i];
-    if (arg_num >= first_variable_arg) {
+    auto donated_arg = donated_args.find(i);
+    if (donated_arg != donated_args.end()) {
+      t = &donated_arg->second;
+    } else if (arg_num >= first_variable_arg) {
       t = &(variables[arg_num - first_variable_arg].value);
     } else {
       t = &(ctx->input(arg_num));
@@ -302,6 +493,12 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
   run_options.set_stream(stream);
   run_options.set_allocator(&xla_allocator);
   run_options.set_intra_op_thread_pool(&ctx->eigen_cpu_device());
+  // If the step is traced and the computation was compiled with HLO
+  // profiling, collect the time of each HLO instruction for the timeline.
+  DeviceStepStats hlo_profile_stats;
+  if (ctx->stats_collector() != nullptr) {
+    run_options.set_hlo_profile_device_stats(&hlo_profile_stats);
+  }
   Env* env = Env::Default();
   auto start_time = env->NowMicros();
   auto run_result = executable->Run(arg_ptrs, run_options);
@@ -310,6 +507,11 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
   output = run_result.ConsumeValueOrDie()->release();
   auto elapsed = env->NowMicros() - start_time;
   VLOG(2) << "Elapsed time: " << elapsed << "us";
+  for (NodeExecStats& hlo_stats : *hlo_profile_stats.mutable_node_stats()) {
+    NodeExecStats* node_stats = new NodeExecStats;
+    node_stats->Swap(&hlo_stats);
+    ctx->stats_collector()->Save(ctx->device()->name(), node_stats);
+  }
 
   // Computation output should always be a tuple.
   if (VLOG_IS_ON(2)) {
@@ -382,14 +584,22 @@ void XlaLocalLaunchOp::Compute(OpKernelContext* ctx) {
 
     core::ScopedUnref s(variable);
 
-    mutex_lock ml(*variable->mu());
-    OP_REQUIRES(ctx, variable->tensor()->dtype() == write.type,
-                errors::Internal("Mismatched type in variable write"));
-
-    // Looks up the owning Tensor by buffer address.
-    OP_REQUIRES_OK(
-        ctx, xla_allocator.MakeTensorFromBuffer(buffer, write.type, write_shape,
-                                                variable->tensor()));
+    auto write_variable = [&]() -> Status {
+      if (variable->tensor()->dtype() != write.type) {
+        return errors::Internal("Mismatched type in variable write");
+      }
+      // Looks up the owning Tensor by buffer address.
+      return xla_allocator.MakeTensorFromBuffer(
+          buffer, write.type, write_shape, variable->tensor());
+    };
+    if (std::find(donated_variables.begin(), donated_variables.end(),
+                  variable) != donated_variables.end()) {
+      // The variables with donated buffers are already locked.
+      OP_REQUIRES_OK(ctx, write_variable());
+    } else {
+      mutex_lock ml(*variable->mu());
+      OP_REQUIRES_OK(ctx, write_variable());
+    }
     ++output_num;
   }
 
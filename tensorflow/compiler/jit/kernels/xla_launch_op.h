@@ -16,16 +16,22 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_KERNELS_XLA_LOCAL_LAUNCH_OP_H_
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_LOCAL_LAUNCH_OP_H_
 
+#include <map>
+#include <vector>
+
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/stream_executor_util.h"
 
 namespace tensorflow {
 
+class Var;
+
 // Takes a snapshot of the values of resource variable arguments, which are
 // the last `num_variables` arguments. We snapshot tensors that back
 // resource variables since concurrent updates may modify the shape, and it is
@@ -43,14 +49,47 @@ std::vector<OptionalTensor> SnapshotResourceVariables(OpKernelContext* ctx,
 // XlaLocalLaunchOp uses xla::LocalClient::Compile() and
 // xla::LocalExecutable::Run(), and passes arguments into/out of XLA in device
 // memory.
-class XlaLocalLaunchOp : public OpKernel {
+//
+// The executable may overwrite the buffers of the variables it updates. A
+// variable whose buffer no other tensor shares is updated in place; otherwise
+// the executable gets a copy of its value.
+//
+// If the environment variable TF_XLA_COMPILE_IN_BACKGROUND is true, a step
+// that misses the cache on a CPU or GPU device does not wait for the
+// compilation: the cache compiles on a background thread while the step runs
+// the original function with the regular executor. Later steps use the
+// executable once it is ready.
+class XlaLocalLaunchOp : public AsyncOpKernel {
  public:
   explicit XlaLocalLaunchOp(OpKernelConstruction* ctx);
   ~XlaLocalLaunchOp() override;
 
-  void Compute(OpKernelContext* ctx) override;
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override;
 
  private:
+  // Runs the computation with XLA. Sets `*fall_back` to true, and does
+  // nothing else, if the computation is still being compiled in the
+  // background.
+  void ComputeWithXla(OpKernelContext* ctx, bool* fall_back);
+
+  // Runs `function_` with the function library runtime of `ctx`.
+  void ComputeWithFunction(OpKernelContext* ctx, DoneCallback done);
+
+  // Returns in `donated_args` the tensors to pass for the parameters of
+  // `executable` whose buffers it may overwrite, which hold the values of
+  // variables that it updates. Each of these variables is added, with a
+  // reference, to `donated_variables` and stays locked by `variable_locks`
+  // until its new value is written. The buffer of a variable is donated if no
+  // other tensor shares it, in which case the snapshot in `variables` is
+  // dropped; otherwise the parameter gets a copy of the snapshot.
+  Status DonateVariableBuffers(OpKernelContext* ctx,
+                               const XlaCompiler::CompilationResult& kernel,
+                               const xla::LocalExecutable& executable,
+                               std::vector<OptionalTensor>* variables,
+                               std::vector<Var*>* donated_variables,
+                               std::vector<mutex_lock>* variable_locks,
+                               std::map<int, Tensor>* donated_args);
+
   // Builds a XlaCompilationCache class suitable for the current device.
   Status BuildCompilationCache(OpKernelContext* ctx,
                                XlaCompilationCache** compiler);
@@ -63,6 +102,9 @@ class XlaLocalLaunchOp : public OpKernel {
 
   perftools::gputools::Platform::Id platform_id_;
 
+  // Whether steps run `function_` while it is compiled in the background.
+  bool compile_in_background_ = false;
+
   TF_DISALLOW_COPY_AND_ASSIGN(XlaLocalLaunchOp);
 };
 
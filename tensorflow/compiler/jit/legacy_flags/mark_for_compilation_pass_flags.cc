@@ -40,6 +40,8 @@ static void AllocateFlags() {
   flags->tf_xla_max_cluster_size = std::numeric_limits<int32>::max();
   flags->tf_xla_clustering_debug = false;
   flags->tf_xla_cpu_global_jit = false;
+  flags->tf_xla_cost_based_clustering = false;
+  flags->tf_xla_min_cluster_benefit_us = 0.0f;
   flag_list = new std::vector<Flag>(
       {Flag("tf_xla_auto_jit", &flags->tf_xla_auto_jit,
             "Control compilation of operators into XLA computations on CPU and "
@@ -55,7 +57,18 @@ static void AllocateFlags() {
        Flag("tf_xla_clustering_debug", &flags->tf_xla_clustering_debug,
             "Dump graphs during XLA compilation."),
        Flag("tf_xla_cpu_global_jit", &flags->tf_xla_cpu_global_jit,
-            "Enables global JIT compilation for CPU via SessionOptions.")});
+            "Enables global JIT compilation for CPU via SessionOptions."),
+       Flag("tf_xla_cost_based_clustering",
+            &flags->tf_xla_cost_based_clustering,
+            "Estimate the time saved by compiling each cluster with the "
+            "grappler cost model, and only compile the clusters that save at "
+            "least tf_xla_min_cluster_benefit_us. Clusters whose shapes are "
+            "unknown are compiled. With tf_xla_clustering_debug, the estimate "
+            "of each cluster is logged."),
+       Flag("tf_xla_min_cluster_benefit_us",
+            &flags->tf_xla_min_cluster_benefit_us,
+            "Minimum estimated time saved by compiling a cluster, in "
+            "microseconds. Only used with tf_xla_cost_based_clustering.")});
   xla::legacy_flags::ParseFlagsFromEnv(*flag_list);
 }
 
@@ -48,6 +48,11 @@ typedef struct {
   bool tf_xla_clustering_debug;   // Dump graphs during XLA compilation.
   bool tf_xla_cpu_global_jit;     // Enables global JIT compilation for CPU
                                   // via SessionOptions.
+  bool tf_xla_cost_based_clustering;    // Only compile clusters whose
+                                        // estimated benefit is at least
+                                        // tf_xla_min_cluster_benefit_us.
+  float tf_xla_min_cluster_benefit_us;  // Minimum estimated time saved by
+                                        // compiling a cluster, in us.
 } MarkForCompilationPassFlags;
 
 // Return a pointer to the MarkForCompilationPassFlags struct;
@@ -35,6 +35,10 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/control_flow.h"
+#include "tensorflow/core/grappler/costs/calibrated_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/public/version.h"
 
@@ -233,6 +237,118 @@ struct Cluster {
   int representative = -1;
 };
 
+// The overhead of running one op in the TensorFlow executor, which a cluster
+// saves for each of its ops but one.
+const double kTfOpOverheadUs = 5.0;
+
+// The overhead of an _XlaLaunch op: the compilation cache lookup and the
+// handling of the arguments and results of the computation.
+const double kXlaLaunchOverheadUs = 20.0;
+
+// Roofline estimates of the time a cluster takes when its ops are run one by
+// one by the TensorFlow executor, and when it runs as one XLA computation.
+struct ClusterCostEstimate {
+  double tf_us = 0;
+  double xla_us = kXlaLaunchOverheadUs;
+  // False if the shapes of some tensors of the cluster are not statically
+  // known, in which case the estimate is meaningless.
+  bool accurate = true;
+
+  double benefit_us() const { return tf_us - xla_us; }
+};
+
+// Returns the size in bytes of 'tensor', or -1 if its shape is not known.
+int64 TensorBytes(const OpInfo::TensorProperties& tensor) {
+  const PartialTensorShape shape(tensor.shape());
+  if (!shape.IsFullyDefined()) {
+    return -1;
+  }
+  return shape.num_elements() * DataTypeSize(tensor.dtype());
+}
+
+// Estimates the costs of the clusters of 'graph', where 'cluster_of' maps the
+// id of each node to the representative of its cluster, or -1. An op of a
+// compiled cluster keeps its compute time, but only reads and writes main
+// memory for the tensors that cross the boundary of the cluster; the tensors
+// that are produced and consumed within the cluster are assumed to be fused
+// away.
+Status EstimateClusterCosts(
+    const Graph& graph, const std::vector<int>& cluster_of,
+    std::unordered_map<int, ClusterCostEstimate>* estimates) {
+  grappler::GrapplerItem item;
+  item.id = "mark_for_compilation";
+  graph.ToGraphDef(&item.graph);
+  grappler::GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(false));
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : item.graph.node()) {
+    name_to_node[node.name()] = &node;
+  }
+  std::unique_ptr<grappler::OpLevelCostEstimator> estimator =
+      grappler::NewOpLevelCostEstimator();
+
+  for (const Node* n : graph.op_nodes()) {
+    const int cluster = cluster_of[n->id()];
+    if (cluster < 0) {
+      continue;
+    }
+    ClusterCostEstimate& estimate = (*estimates)[cluster];
+    if (!properties.HasInputProperties(n->name()) ||
+        !properties.HasOutputProperties(n->name())) {
+      estimate.accurate = false;
+      continue;
+    }
+    grappler::OpContext op_context;
+    op_context.name = n->name();
+    op_context.op_info = grappler::BuildOpInfoWithoutDevice(
+        *name_to_node.at(n->name()), name_to_node,
+        properties.GetInputProperties(n->name()));
+    for (const auto& output : properties.GetOutputProperties(n->name())) {
+      *op_context.op_info.add_outputs() = output;
+    }
+    *op_context.op_info.mutable_device() =
+        grappler::GetDeviceInfo(n->assigned_device_name());
+    const grappler::Costs costs = estimator->PredictCosts(op_context);
+    if (costs.inaccurate ||
+        op_context.op_info.inputs_size() != n->num_inputs() ||
+        op_context.op_info.outputs_size() != n->num_outputs()) {
+      estimate.accurate = false;
+      continue;
+    }
+
+    // The bytes of the inputs and outputs that cross the cluster boundary.
+    std::vector<bool> output_crosses(n->num_outputs(), false);
+    int64 boundary_bytes = 0;
+    int64 total_bytes = 0;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      const int64 bytes =
+          TensorBytes(op_context.op_info.inputs(e->dst_input()));
+      total_bytes += bytes;
+      if (cluster_of[e->src()->id()] != cluster) boundary_bytes += bytes;
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) continue;
+      if (cluster_of[e->dst()->id()] != cluster) {
+        output_crosses[e->src_output()] = true;
+      }
+    }
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      const int64 bytes = TensorBytes(op_context.op_info.outputs(i));
+      total_bytes += bytes;
+      if (output_crosses[i]) boundary_bytes += bytes;
+    }
+    const double compute_us = costs.compute_time.count() / 1e3;
+    const double memory_us = costs.memory_time.count() / 1e3;
+    estimate.tf_us += kTfOpOverheadUs + compute_us + memory_us;
+    estimate.xla_us += compute_us;
+    if (total_bytes > 0) {
+      estimate.xla_us += memory_us * boundary_bytes / total_bytes;
+    }
+  }
+  return Status::OK();
+}
+
 // Returns a string describing how an edge from src to dst would
 // create a cycle.
 string DescribeCycle(const GraphCycles& cycles, const Graph& graph, int src,
@@ -539,6 +655,40 @@ Status MarkForCompilationPass::RunImpl(
     cluster_sizes[cluster]++;
   }
 
+  // Estimate the benefit of compiling each cluster, if requested.
+  std::unordered_map<int, ClusterCostEstimate> cost_estimates;
+  if (flags->tf_xla_cost_based_clustering) {
+    std::vector<int> cluster_of(graph->num_node_ids(), -1);
+    for (const Node* n : compilation_candidates) {
+      cluster_of[n->id()] = clusters[n->id()].Get().representative;
+    }
+    Status status = EstimateClusterCosts(*graph, cluster_of, &cost_estimates);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to estimate the costs of the XLA clusters, "
+                   << "clustering by size only: " << status;
+      cost_estimates.clear();
+    }
+  }
+  // Returns false if the cost model says that compiling 'cluster' does not
+  // pay off.
+  const float min_benefit_us = flags->tf_xla_min_cluster_benefit_us;
+  auto is_beneficial = [&cost_estimates, min_benefit_us](int cluster) {
+    auto it = cost_estimates.find(cluster);
+    return it == cost_estimates.end() || !it->second.accurate ||
+           it->second.benefit_us() >= min_benefit_us;
+  };
+  if (flags->tf_xla_clustering_debug) {
+    for (const auto& entry : cost_estimates) {
+      const ClusterCostEstimate& estimate = entry.second;
+      LOG(INFO) << "XLA cluster of " << cluster_sizes[entry.first]
+                << " ops rooted at " << graph->FindNodeId(entry.first)->name()
+                << ": estimated " << estimate.tf_us << " us in TensorFlow, "
+                << estimate.xla_us << " us compiled"
+                << (estimate.accurate ? "" : ", shapes unknown")
+                << (is_beneficial(entry.first) ? "" : ", not compiled");
+    }
+  }
+
   // Names for each cluster.
   std::unordered_map<int, string> cluster_names;
 
@@ -546,7 +696,9 @@ Status MarkForCompilationPass::RunImpl(
   // * are placed on a device that requires compilation (an XlaDevice),
   // * are explicitly marked for compilation (_XlaCompile=true), or
   // * have more than flags->tf_xla_min_cluster_size elements (applicable only
-  //   if compilation is enabled, otherwise there will be no such candidates).
+  //   if compilation is enabled, otherwise there will be no such candidates),
+  //   and, with flags->tf_xla_cost_based_clustering, an estimated benefit of
+  //   at least flags->tf_xla_min_cluster_benefit_us.
   const int min_cluster_size = flags->tf_xla_min_cluster_size;
   for (Node* n : compilation_candidates) {
     int cluster = clusters[n->id()].Get().representative;
@@ -571,8 +723,9 @@ Status MarkForCompilationPass::RunImpl(
 
     // Or compile if this is a cluster of >= min_cluster_size compilable
     // operators.
-    if (cluster_sizes[cluster] >= min_cluster_size || marked_for_compilation ||
-        registration->requires_compilation) {
+    if ((cluster_sizes[cluster] >= min_cluster_size &&
+         is_beneficial(cluster)) ||
+        marked_for_compilation || registration->requires_compilation) {
       string& name = cluster_names[cluster];
 
       if (name.empty()) {
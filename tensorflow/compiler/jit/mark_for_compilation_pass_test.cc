@@ -19,8 +19,10 @@ limitations under the License.
 #include "tensorflow/cc/ops/control_flow_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/legacy_flags/mark_for_compilation_pass_flags.h"
 #include "tensorflow/compiler/tf2xla/xla_op_kernel.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
+#include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/graph/graph_constructor.h"
@@ -33,6 +35,10 @@ namespace {
 
 REGISTER_OP("UncompilableNullary").Output("o: float");
 REGISTER_OP("UncompilableUnary").Input("a: float").Output("o: float");
+REGISTER_OP("UncompilableShapedNullary")
+    .Output("o: float")
+    .Attr("shape: shape")
+    .SetShapeFn(shape_inference::ExplicitShape);
 
 Status MarkForCompilation(std::unique_ptr<Graph>* graph,
                           FunctionLibraryDefinition* flib_def) {
@@ -552,5 +558,43 @@ TEST(XlaCompilationTest, Retval) {
   EXPECT_EQ(clusters["A"], clusters["B"]);
 }
 
+// Builds A -> B -> C -> D -> E, where B and C are element-wise and A has the
+// given shape.
+void BuildReluChain(const TensorShape& shape, Graph* graph) {
+  GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+  Node* a = ops::SourceOp(
+      "UncompilableShapedNullary",
+      builder.opts().WithName("A").WithAttr("shape", shape));
+  Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+  Node* c = ops::UnaryOp("Tanh", b, builder.opts().WithName("C"));
+  Node* d = ops::UnaryOp("Relu", c, builder.opts().WithName("D"));
+  ops::UnaryOp("UncompilableUnary", d, builder.opts().WithName("E"));
+  TF_EXPECT_OK(builder.ToGraph(graph));
+}
+
+TEST(XlaCompilationTest, CostBasedClustering) {
+  legacy_flags::MarkForCompilationPassFlags* flags =
+      legacy_flags::GetMarkForCompilationPassFlags();
+  flags->tf_xla_cost_based_clustering = true;
+
+  // Fusing three ops on a few elements saves less than the launch overhead.
+  std::unique_ptr<Graph> small(new Graph(OpRegistry::Global()));
+  BuildReluChain(TensorShape({2}), small.get());
+  TF_ASSERT_OK(MarkForCompilation(&small));
+  EXPECT_TRUE(GetClusters(*small).empty());
+
+  // Fusing them on a large tensor saves reading and writing the
+  // intermediate results.
+  std::unique_ptr<Graph> large(new Graph(OpRegistry::Global()));
+  BuildReluChain(TensorShape({1024, 1024}), large.get());
+  TF_ASSERT_OK(MarkForCompilation(&large));
+  auto clusters = GetClusters(*large);
+  EXPECT_EQ(3, clusters.size());
+  EXPECT_EQ(clusters["B"], clusters["C"]);
+  EXPECT_EQ(clusters["B"], clusters["D"]);
+
+  flags->tf_xla_cost_based_clustering = false;
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/type_util.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
@@ -31,15 +32,42 @@ limitations under the License.
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
 
+namespace {
+
+auto* cache_lookups = monitoring::Counter<2>::New(
+    "/tensorflow/compiler/jit/compilation_cache/lookups",
+    "The number of lookups in the XLA JIT compilation cache.", "device",
+    "result");
+auto* cache_compilations = monitoring::Counter<1>::New(
+    "/tensorflow/compiler/jit/compilation_cache/compilations",
+    "The number of functions compiled by the XLA JIT compilation cache.",
+    "device");
+auto* cache_compile_time = monitoring::Counter<1>::New(
+    "/tensorflow/compiler/jit/compilation_cache/compile_time_usecs",
+    "Time in microseconds spent compiling in the XLA JIT compilation cache.",
+    "device");
+auto* cache_evictions = monitoring::Counter<1>::New(
+    "/tensorflow/compiler/jit/compilation_cache/evictions",
+    "The number of entries evicted from the XLA JIT compilation cache.",
+    "device");
+constexpr char kCacheHit[] = "hit";
+constexpr char kCacheMiss[] = "miss";
+
+}  // namespace
+
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
-                                         DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+                                         DeviceType device_type,
+                                         int64 capacity)
+    : client_(client),
+      device_type_(std::move(device_type)),
+      capacity_(capacity) {}
 XlaCompilationCache::~XlaCompilationCache() = default;
 
 string XlaCompilationCache::DebugString() {
@@ -224,6 +252,21 @@ Status XlaCompilationCache::BuildExecutable(
   build_options.set_device_ordinal(client_->default_device_ordinal());
   build_options.set_result_layout(result.xla_output_shape);
 
+  // The variables that the computation updates are overwritten with their new
+  // values, so the executable may reuse the buffers of their old values.
+  std::vector<int64> donated_parameters;
+  for (int i = 0; i < result.xla_input_shapes.size(); ++i) {
+    const int arg_num = result.input_mapping[i];
+    bool updated = false;
+    for (const XlaCompiler::ResourceUpdate& update : result.resource_updates) {
+      updated |= update.input_index == arg_num;
+    }
+    if (updated && xla::ShapeUtil::IsArray(result.xla_input_shapes[i])) {
+      donated_parameters.push_back(i);
+    }
+  }
+  build_options.set_donated_parameters(donated_parameters);
+
   auto compile_result =
       client_->Compile(*result.computation, argument_layouts, build_options);
   if (!compile_result.ok()) {
@@ -233,12 +276,56 @@ Status XlaCompilationCache::BuildExecutable(
   return Status::OK();
 }
 
+Status XlaCompilationCache::CompileFunction(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    std::vector<XlaCompiler::Argument> args,
+    XlaCompiler::CompilationResult* result,
+    std::unique_ptr<xla::LocalExecutable>* executable) {
+  const uint64 start_us = Env::Default()->NowMicros();
+  XlaCompiler compiler(options);
+  Status status = compiler.CompileFunction(XlaCompiler::CompileOptions(),
+                                           function, std::move(args), result);
+  if (status.ok() && executable) {
+    status = BuildExecutable(options, *result, executable);
+  }
+  cache_compilations->GetCell(device_type_.type())->IncrementBy(1);
+  cache_compile_time->GetCell(device_type_.type())
+      ->IncrementBy(Env::Default()->NowMicros() - start_us);
+  return status;
+}
+
 Status XlaCompilationCache::Compile(
     const XlaCompiler::Options& options, const NameAttrList& function,
     int num_constant_args, const std::vector<OptionalTensor>& variable_args,
     OpKernelContext* ctx,
     const XlaCompiler::CompilationResult** compilation_result,
-    xla::LocalExecutable** executable) {
+    xla::LocalExecutable** executable,
+    std::shared_ptr<const void>* entry_ref) {
+  bool ready;
+  return CompileImpl(options, function, num_constant_args, variable_args, ctx,
+                     /*compile_in_background=*/false, compilation_result,
+                     executable, entry_ref, &ready);
+}
+
+Status XlaCompilationCache::CompileInBackground(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    int num_constant_args, const std::vector<OptionalTensor>& variable_args,
+    OpKernelContext* ctx,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable,
+    std::shared_ptr<const void>* entry_ref, bool* ready) {
+  return CompileImpl(options, function, num_constant_args, variable_args, ctx,
+                     /*compile_in_background=*/true, compilation_result,
+                     executable, entry_ref, ready);
+}
+
+Status XlaCompilationCache::CompileImpl(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    int num_constant_args, const std::vector<OptionalTensor>& variable_args,
+    OpKernelContext* ctx, bool compile_in_background,
+    const XlaCompiler::CompilationResult** compilation_result,
+    xla::LocalExecutable** executable,
+    std::shared_ptr<const void>* entry_ref, bool* ready) {
   VLOG(1) << "XlaCompilationCache::Compile " << DebugString();
 
   if (VLOG_IS_ON(2)) {
@@ -270,37 +357,91 @@ Status XlaCompilationCache::Compile(
 
   VLOG(2) << "Signature: " << SignatureDebugString(signature);
   // The outer lock protects the existence of the cache entry. It does not
-  // protect the contents of the cache entry.
-  Entry* entry;
+  // protect the contents of the cache entry. An evicted entry lives on until
+  // the last caller that uses it releases its reference.
+  std::shared_ptr<Entry> entry;
   {
     mutex_lock lock(mu_);
     // Find or create a cache entry.
-    std::unique_ptr<Entry>& e = cache_[signature];
+    std::shared_ptr<Entry>& e = cache_[signature];
     if (!e) {
-      e.reset(new Entry);
+      e = std::make_shared<Entry>();
+      lru_.push_front(signature);
+      e->lru_position = lru_.begin();
+      cache_lookups->GetCell(device_type_.type(), kCacheMiss)->IncrementBy(1);
+    } else {
+      lru_.splice(lru_.begin(), lru_, e->lru_position);
+      cache_lookups->GetCell(device_type_.type(), kCacheHit)->IncrementBy(1);
+    }
+    entry = e;
+    while (capacity_ > 0 && static_cast<int64>(lru_.size()) > capacity_) {
+      VLOG(1) << "Evicting signature from the compilation cache: "
+              << SignatureDebugString(lru_.back());
+      cache_.erase(lru_.back());
+      lru_.pop_back();
+      cache_evictions->GetCell(device_type_.type())->IncrementBy(1);
     }
-    entry = e.get();
   }
+  *entry_ref = entry;
 
   // Acquire the cache entry lock and compile, if necessary.
-  // TODO(phawkins): this locking will need to be restructured when we implement
-  // cache eviction.
   mutex_lock entry_lock(entry->mu);
   if (!entry->compiled) {
+    std::vector<XlaCompiler::Argument> args;
+    if (compile_in_background) {
+      *ready = false;
+      *compilation_result = nullptr;
+      *executable = nullptr;
+      if (entry->compiling_in_background) {
+        return Status::OK();
+      }
+      VLOG(1) << "Compiling in the background for signature: "
+              << SignatureDebugString(signature);
+      TF_RETURN_IF_ERROR(
+          BuildArguments(num_constant_args, variable_args, ctx, &args));
+      entry->compiling_in_background = true;
+
+      // The function library of the caller may not outlive the compilation.
+      auto flib_def =
+          std::make_shared<FunctionLibraryDefinition>(*options.flib_def);
+      XlaCompiler::Options background_options = options;
+      background_options.flib_def = flib_def.get();
+      mutex_lock lock(mu_);
+      if (background_compiler_ == nullptr) {
+        background_compiler_.reset(new thread::ThreadPool(
+            Env::Default(), "xla_background_compiler", /*num_threads=*/1));
+      }
+      background_compiler_->Schedule([this, background_options, flib_def,
+                                      function, args, entry]() {
+        XlaCompiler::CompilationResult result;
+        std::unique_ptr<xla::LocalExecutable> executable;
+        Status status = CompileFunction(background_options, function, args,
+                                        &result, &executable);
+        mutex_lock entry_lock(entry->mu);
+        entry->compiling_in_background = false;
+        // A concurrent Compile() may have compiled the entry in the meantime.
+        if (!entry->compiled) {
+          entry->compiled = true;
+          entry->compilation_status = status;
+          entry->compilation_result = std::move(result);
+          entry->executable = std::move(executable);
+        }
+      });
+      return Status::OK();
+    }
     VLOG(1) << "Compilation cache miss for signature: "
             << SignatureDebugString(signature);
     // Do the actual JIT compilation without holding the lock (it can take
     // a long time.)
-    std::vector<XlaCompiler::Argument> args;
     TF_RETURN_IF_ERROR(
         BuildArguments(num_constant_args, variable_args, ctx, &args));
 
-    XlaCompiler compiler(options);
     entry->compiled = true;
-    entry->compilation_status =
-        compiler.CompileFunction(XlaCompiler::CompileOptions(), function, args,
-                                 &entry->compilation_result);
+    entry->compilation_status = CompileFunction(
+        options, function, std::move(args), &entry->compilation_result,
+        executable ? &entry->executable : nullptr);
   }
+  *ready = true;
   *compilation_result = &entry->compilation_result;
   if (entry->compilation_status.ok() && executable) {
     if (entry->executable == nullptr) {
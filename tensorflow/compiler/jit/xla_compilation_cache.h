@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 #define TENSORFLOW_COMPILER_JIT_XLA_COMPILATION_CACHE_H_
 
+#include <list>
+#include <memory>
+
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/compiler/tf2xla/xla_context.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
@@ -42,11 +45,16 @@ struct OptionalTensor {
 // Since XLA computations must have static shapes, the cache generates a new
 // XLA computation for each new set of input shapes.
 //
-// Currently no cache eviction policy is implemented and the cache grows without
-// bound.
+// If `capacity` is positive, the cache holds at most `capacity` signatures and
+// evicts the least recently used one when a new signature is compiled, so
+// inputs with many distinct shapes do not grow the cache without bound.
+// Otherwise the cache is unbounded. Lookups, compilations, compilation time and
+// evictions are exported through tensorflow/core/lib/monitoring under
+// /tensorflow/compiler/jit/compilation_cache/.
 class XlaCompilationCache : public ResourceBase {
  public:
-  XlaCompilationCache(xla::LocalClient* client, DeviceType device_type);
+  XlaCompilationCache(xla::LocalClient* client, DeviceType device_type,
+                      int64 capacity = 0);
   ~XlaCompilationCache() override;
 
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
@@ -61,12 +69,29 @@ class XlaCompilationCache : public ResourceBase {
   // xla::LocalExecutable and sets `executable to point to it. The resulting
   // executable pointer may be null if the computation has no non-constant
   // outputs.
+  // `*entry_ref`, which must be non-null, is set to a reference that keeps the
+  // compilation result and the executable alive even if the cache evicts them
+  // while the caller still uses them.
   Status Compile(const XlaCompiler::Options& options,
                  const NameAttrList& function, int num_constant_args,
                  const std::vector<OptionalTensor>& variable_args,
                  OpKernelContext* ctx,
                  const XlaCompiler::CompilationResult** compilation_result,
-                 xla::LocalExecutable** executable);
+                 xla::LocalExecutable** executable,
+                 std::shared_ptr<const void>* entry_ref);
+
+  // Like Compile(), but never blocks on a compilation: if `function` has not
+  // been compiled for the signature of the inputs of `ctx` yet, schedules the
+  // compilation on a background thread, if it is not already pending, and sets
+  // `*ready` to false. Once the compilation has finished, sets the outputs like
+  // Compile() and `*ready` to true. Always builds an executable.
+  Status CompileInBackground(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      int num_constant_args, const std::vector<OptionalTensor>& variable_args,
+      OpKernelContext* ctx,
+      const XlaCompiler::CompilationResult** compilation_result,
+      xla::LocalExecutable** executable,
+      std::shared_ptr<const void>* entry_ref, bool* ready);
 
   xla::LocalClient* client() const { return client_; }
   const DeviceType& device_type() const { return device_type_; }
@@ -74,6 +99,23 @@ class XlaCompilationCache : public ResourceBase {
   string DebugString() override;
 
  private:
+  // Implements Compile() and CompileInBackground().
+  Status CompileImpl(const XlaCompiler::Options& options,
+                     const NameAttrList& function, int num_constant_args,
+                     const std::vector<OptionalTensor>& variable_args,
+                     OpKernelContext* ctx, bool compile_in_background,
+                     const XlaCompiler::CompilationResult** compilation_result,
+                     xla::LocalExecutable** executable,
+                     std::shared_ptr<const void>* entry_ref, bool* ready);
+
+  // Compiles `function` for `args` into `result` and, if `executable` is
+  // non-null, builds the executable of the result.
+  Status CompileFunction(const XlaCompiler::Options& options,
+                         const NameAttrList& function,
+                         std::vector<XlaCompiler::Argument> args,
+                         XlaCompiler::CompilationResult* result,
+                         std::unique_ptr<xla::LocalExecutable>* executable);
+
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
   Status BuildExecutable(const XlaCompiler::Options& options,
@@ -82,6 +124,7 @@ class XlaCompilationCache : public ResourceBase {
 
   xla::LocalClient* const client_;
   const DeviceType device_type_;
+  const int64 capacity_;
 
   // Describes the types, shapes and any compile-time constant arguments
   // to a kernel. Key that uniquely identifies a compilation output.
@@ -114,6 +157,9 @@ class XlaCompilationCache : public ResourceBase {
     // Have we tried compiling this entry?
     bool compiled = false;
 
+    // Is a compilation of this entry pending on the background thread?
+    bool compiling_in_background GUARDED_BY(mu) = false;
+
     // Did compilation succeed?
     Status compilation_status GUARDED_BY(mu);
 
@@ -123,11 +169,22 @@ class XlaCompilationCache : public ResourceBase {
     // The XLA executable compiled from <computation>. May be null if no
     // executable has been built.
     std::unique_ptr<xla::LocalExecutable> executable GUARDED_BY(mu);
+
+    // The position of the signature of this entry in `lru_`. Guarded by the
+    // mutex of the cache.
+    std::list<Signature>::iterator lru_position;
   };
 
   mutex mu_;
-  std::unordered_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
+  std::unordered_map<Signature, std::shared_ptr<Entry>, Signature::Hash> cache_
       GUARDED_BY(mu_);
+  // The signatures in the cache, most recently used first.
+  std::list<Signature> lru_ GUARDED_BY(mu_);
+
+  // Runs the compilations of CompileInBackground(); created on first use.
+  // Destroyed first, so that pending compilations finish while the rest of the
+  // cache is alive.
+  std::unique_ptr<thread::ThreadPool> background_compiler_ GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(XlaCompilationCache);
 };
@@ -13,7 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
-// Declaration of the Gather Op using the XLA dynamic slice implementation.
+// Declaration of the Gather Op using the XLA gather implementation.
 
 #ifndef TENSORFLOW_COMPILER_TF2XLA_KERNELS_GATHER_OP_H_
 #define TENSORFLOW_COMPILER_TF2XLA_KERNELS_GATHER_OP_H_
@@ -26,14 +26,14 @@ limitations under the License.
 
 namespace tensorflow {
 
-class GatherOpDynamicSlice : public XlaOpKernel {
+class GatherOp : public XlaOpKernel {
  public:
-  explicit GatherOpDynamicSlice(OpKernelConstruction* context);
+  explicit GatherOp(OpKernelConstruction* context);
 
   void Compile(XlaOpKernelContext* context) override;
 
  private:
-  TF_DISALLOW_COPY_AND_ASSIGN(GatherOpDynamicSlice);
+  TF_DISALLOW_COPY_AND_ASSIGN(GatherOp);
 };
 
 }  // namespace tensorflow
@@ -27,14 +27,14 @@ limitations under the License.
 namespace tensorflow {
 
 // Adds to builder an XLA computation that performs a gather on input (of
-// shape input_shape) keyed on indices (of shape indices_shape).
+// shape input_shape) along axis, keyed on indices (of shape indices_shape).
+// Indices out of the bounds of axis gather zeros.
 //
-// index_type must be must be DT_INT32 or DT_INT64.
-xla::ComputationDataHandle XlaComputeGatherDynamicSlice(
-    XlaOpKernelContext* ctx, const xla::ComputationDataHandle& input,
-    const TensorShape& input_shape, const xla::ComputationDataHandle& indices,
-    const TensorShape& indices_shape, int64 axis, DataType dtype,
-    DataType index_type, xla::ComputationBuilder* builder);
+// The type of indices must be must be DT_INT32 or DT_INT64.
+xla::ComputationDataHandle XlaComputeGather(
+    const xla::ComputationDataHandle& input, const TensorShape& input_shape,
+    const xla::ComputationDataHandle& indices, const TensorShape& indices_shape,
+    int64 axis, xla::ComputationBuilder* builder);
 
 }  // namespace tensorflow
 
@@ -27,12 +27,12 @@ namespace tensorflow {
 // Adds to builder an XLA computation that performs a scatter-add of input (of
 // shape input_shape) keyed on indices (of shape indices_shape). The shape
 // of the Tensor returned by this is num_segments input_shape[indices.dims():]
+// Entries of input whose indices are outside [0, num_segments) are dropped.
 //
-static xla::ComputationDataHandle XlaComputeScatterAddDynamicSlice(
-    XlaOpKernelContext* ctx, const xla::ComputationDataHandle& input,
-    const TensorShape& input_shape, const xla::ComputationDataHandle& indices,
-    const TensorShape& indices_shape, int64 num_segments, DataType dtype,
-    xla::ComputationBuilder* builder);
+xla::ComputationDataHandle XlaComputeScatterAdd(
+    const xla::ComputationDataHandle& input, const TensorShape& input_shape,
+    const xla::ComputationDataHandle& indices, const TensorShape& indices_shape,
+    int64 num_segments, DataType dtype, xla::ComputationBuilder* builder);
 
 }  // namespace tensorflow
 
@@ -307,7 +307,6 @@ class TensorArrayGatherOp : public XlaOpKernel {
     OP_REQUIRES(ctx, indices_shape.dims() == 1,
                 errors::InvalidArgument("indices must be rank 1"));
     auto indices = ctx->Input(1);
-    DataType index_type = ctx->input_type(1);
 
     xla::ComputationDataHandle ta = resource->value;
 
@@ -337,8 +336,8 @@ class TensorArrayGatherOp : public XlaOpKernel {
       }
     }
 
-    xla::ComputationDataHandle gather = XlaComputeGatherDynamicSlice(
-        ctx, ta, ta_shape, indices, indices_shape, 0, dtype_, index_type, b);
+    xla::ComputationDataHandle gather =
+        XlaComputeGather(ta, ta_shape, indices, indices_shape, 0, b);
     ctx->SetOutput(0, gather);
   }
 
@@ -350,6 +350,53 @@ ComputationDataHandle ComputationBuilder::DynamicUpdateSlice(
   return ParseOpResponse(s, &response);
 }
 
+ComputationDataHandle ComputationBuilder::Gather(
+    const ComputationDataHandle& operand, const ComputationDataHandle& indices,
+    int64 dimension) {
+  if (!first_error_.ok() || !PrepareComputation().ok()) {
+    return ComputationDataHandle();
+  }
+
+  GatherRequest request;
+  *request.mutable_operand() = operand;
+  *request.mutable_indices() = indices;
+  request.set_dimension(dimension);
+  OpRequest op_request;
+  *op_request.mutable_computation() = computation_.handle();
+  *op_request.mutable_gather_request() = request;
+  AddCommonFieldsToOpRequest(&op_request);
+  OpResponse response;
+
+  VLOG(2) << "making gather request";
+  Status s = client_->stub()->Op(&op_request, &response);
+  return ParseOpResponse(s, &response);
+}
+
+ComputationDataHandle ComputationBuilder::Scatter(
+    const ComputationDataHandle& operand, const ComputationDataHandle& indices,
+    const ComputationDataHandle& updates, const Computation& to_apply,
+    int64 dimension) {
+  if (!first_error_.ok() || !PrepareComputation().ok()) {
+    return ComputationDataHandle();
+  }
+
+  ScatterRequest request;
+  *request.mutable_operand() = operand;
+  *request.mutable_indices() = indices;
+  *request.mutable_updates() = updates;
+  *request.mutable_to_apply() = to_apply.handle();
+  request.set_dimension(dimension);
+  OpRequest op_request;
+  *op_request.mutable_computation() = computation_.handle();
+  *op_request.mutable_scatter_request() = request;
+  AddCommonFieldsToOpRequest(&op_request);
+  OpResponse response;
+
+  VLOG(2) << "making scatter request";
+  Status s = client_->stub()->Op(&op_request, &response);
+  return ParseOpResponse(s, &response);
+}
+
 ComputationDataHandle ComputationBuilder::ConcatInDim(
     tensorflow::gtl::ArraySlice<ComputationDataHandle> operands,
     int64 dimension) {
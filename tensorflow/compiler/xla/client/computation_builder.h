@@ -335,6 +335,39 @@ class ComputationBuilder {
       const ComputationDataHandle& operand, const ComputationDataHandle& update,
       const ComputationDataHandle& start_indices);
 
+  // Enqueues a gather operation onto the computation, which selects the
+  // slices of 'operand' along 'dimension' at the positions given by the
+  // rank-1 array 'indices':
+  //
+  //   [1 2 3]
+  //   [4 5 6]  => Gather(data, indices = {2, 0}, dimension = 0) => [7 8 9]
+  //   [7 8 9]                                                      [1 2 3]
+  //
+  // The result has the shape of 'operand', with the size of 'dimension'
+  // replaced by the number of indices. Indices out of the bounds of
+  // 'dimension' yield slices of zeros.
+  ComputationDataHandle Gather(const ComputationDataHandle& operand,
+                               const ComputationDataHandle& indices,
+                               int64 dimension);
+
+  // Enqueues a scatter operation onto the computation, which combines each
+  // slice of 'updates' along 'dimension' into the slice of 'operand' at the
+  // position given by the rank-1 array 'indices', using 'to_apply':
+  //
+  //   [1 1]                   [10 20]
+  //   [1 1]  => Scatter(data, [30 40], indices = {2, 2}, add, 0) => [1  1 ]
+  //   [1 1]                                                          [1  1 ]
+  //                                                                  [41 61]
+  //
+  // 'updates' has the shape of 'operand', with the size of 'dimension'
+  // replaced by the number of indices. Updates at indices out of the bounds
+  // of 'dimension' are dropped. Updates to the same position are combined in
+  // an unspecified order.
+  ComputationDataHandle Scatter(const ComputationDataHandle& operand,
+                                const ComputationDataHandle& indices,
+                                const ComputationDataHandle& updates,
+                                const Computation& to_apply, int64 dimension);
+
   // Enqueues a concatenate instruction onto the computation. 'operands' must
   // have >= 1 entry.
   ComputationDataHandle ConcatInDim(
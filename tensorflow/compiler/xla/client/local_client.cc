@@ -46,6 +46,17 @@ const Shape* ExecutableBuildOptions::result_layout() const {
   return result_layout_set_ ? &result_layout_ : nullptr;
 }
 
+ExecutableBuildOptions& ExecutableBuildOptions::set_donated_parameters(
+    tensorflow::gtl::ArraySlice<int64> donated_parameters) {
+  donated_parameters_.assign(donated_parameters.begin(),
+                             donated_parameters.end());
+  return *this;
+}
+
+const std::vector<int64>& ExecutableBuildOptions::donated_parameters() const {
+  return donated_parameters_;
+}
+
 namespace {
 StatusOr<Backend::StreamPtr> BorrowStreamForDevice(int device_ordinal,
                                                    Backend* backend) {
@@ -269,7 +280,8 @@ StatusOr<std::unique_ptr<LocalExecutable>> LocalClient::Compile(
   TF_ASSIGN_OR_RETURN(std::unique_ptr<Executable> executable,
                       local_service_->CompileExecutable(
                           computation.handle(), argument_layouts,
-                          options.result_layout(), device_ordinal));
+                          options.result_layout(),
+                          options.donated_parameters(), device_ordinal));
   return WrapUnique(new LocalExecutable(std::move(executable),
                                         local_service_->mutable_backend(),
                                         device_ordinal, options));
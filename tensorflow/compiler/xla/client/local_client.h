@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_CLIENT_LOCAL_CLIENT_H_
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/compiler/xla/client/client.h"
 #include "tensorflow/compiler/xla/client/computation.h"
@@ -53,10 +54,19 @@ class ExecutableBuildOptions {
   ExecutableBuildOptions& set_result_layout(const Shape& shape_with_layout);
   const Shape* result_layout() const;
 
+  // If set, the numbers of the parameters whose buffers are donated to the
+  // executable. The executable may then write its result, or temporaries,
+  // into the buffers of these arguments, which the caller must not use after
+  // running the executable. Only array-shaped parameters can be donated.
+  ExecutableBuildOptions& set_donated_parameters(
+      tensorflow::gtl::ArraySlice<int64> donated_parameters);
+  const std::vector<int64>& donated_parameters() const;
+
  private:
   int device_ordinal_ = -1;
   Shape result_layout_;
   bool result_layout_set_ = false;
+  std::vector<int64> donated_parameters_;
 };
 
 class LocalExecutable {
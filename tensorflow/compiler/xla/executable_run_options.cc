@@ -77,6 +77,17 @@ ExecutionProfile* ExecutableRunOptions::execution_profile() const {
   return execution_profile_;
 }
 
+ExecutableRunOptions& ExecutableRunOptions::set_hlo_profile_device_stats(
+    tensorflow::DeviceStepStats* device_stats) {
+  hlo_profile_device_stats_ = device_stats;
+  return *this;
+}
+
+tensorflow::DeviceStepStats* ExecutableRunOptions::hlo_profile_device_stats()
+    const {
+  return hlo_profile_device_stats_;
+}
+
 ExecutableRunOptions& ExecutableRunOptions::set_device_assignment(
     DeviceAssignment* device_assignment) {
   device_assignment_ = device_assignment;
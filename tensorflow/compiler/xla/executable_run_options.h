@@ -28,6 +28,7 @@ class Platform;
 }
 
 namespace tensorflow {
+class DeviceStepStats;
 namespace thread {
 class ThreadPool;
 }
@@ -80,6 +81,12 @@ class ExecutableRunOptions {
   ExecutionProfile* execution_profile() const;
   ExecutableRunOptions& set_execution_profile(ExecutionProfile* profile);
 
+  // If set, and the executable was compiled with HLO profiling, the time taken
+  // by each HLO instruction is appended to 'device_stats' as NodeExecStats.
+  tensorflow::DeviceStepStats* hlo_profile_device_stats() const;
+  ExecutableRunOptions& set_hlo_profile_device_stats(
+      tensorflow::DeviceStepStats* device_stats);
+
   ExecutableRunOptions& set_device_assignment(
       DeviceAssignment* device_assignment);
   DeviceAssignment* device_assignment() const;
@@ -92,6 +99,7 @@ class ExecutableRunOptions {
   tensorflow::thread::ThreadPool* inter_op_thread_pool_ = nullptr;
   const Eigen::ThreadPoolDevice* intra_op_thread_pool_ = nullptr;
   ExecutionProfile* execution_profile_ = nullptr;
+  tensorflow::DeviceStepStats* hlo_profile_device_stats_ = nullptr;
 };
 
 }  // namespace xla
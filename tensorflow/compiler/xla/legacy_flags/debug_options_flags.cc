@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/legacy_flags/debug_options_parsers.h"
 #include "tensorflow/compiler/xla/legacy_flags/parse_flags_from_env.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/protobuf.h"
 
 namespace xla {
 namespace legacy_flags {
@@ -67,6 +68,16 @@ void AllocateFlags() {
     };
   };
 
+  // Returns a lambda that calls "member_setter" on "flag_values" with the
+  // argument passed in to the lambda.
+  auto int64_setter_for =
+      [](void (DebugOptions::*member_setter)(tensorflow::protobuf_int64)) {
+        return [member_setter](int64 value) {
+          (flag_values->*member_setter)(value);
+          return true;
+        };
+      };
+
   // Custom "sub-parser" lambda for xla_disable_hlo_passes.
   auto setter_for_xla_disable_hlo_passes = [](string comma_separated_values) {
     std::vector<string> disabled_passes =
@@ -202,6 +213,10 @@ void AllocateFlags() {
            flag_values->xla_cpu_multi_thread_eigen(),
            "When generating calls to Eigen in the CPU backend, "
            "use multi-threaded Eigen mode."),
+       tensorflow::Flag("xla_cpu_object_cache_dir",
+                        flag_values->mutable_xla_cpu_object_cache_dir(),
+                        "If non-empty, cache the object code generated by the "
+                        "CPU backend in this directory across processes."),
        tensorflow::Flag("xla_gpu_cuda_data_dir",
                         flag_values->mutable_xla_gpu_cuda_data_dir(),
                         "If non-empty, speficies a local directory containing "
@@ -217,6 +232,20 @@ void AllocateFlags() {
            bool_setter_for(&DebugOptions::set_xla_gpu_disable_multi_streaming),
            flag_values->xla_gpu_disable_multi_streaming(),
            "If true, multi-streaming in the GPU backend is disabled."),
+       tensorflow::Flag("xla_gpu_autotune_cache_file",
+                        flag_values->mutable_xla_gpu_autotune_cache_file(),
+                        "If non-empty, reuse the convolution and gemm "
+                        "algorithms picked by autotuning in this file across "
+                        "processes."),
+       tensorflow::Flag(
+           "xla_gpu_rematerialization_memory_limit_bytes",
+           int64_setter_for(
+               &DebugOptions::set_xla_gpu_rematerialization_memory_limit_bytes),
+           static_cast<int64>(
+               flag_values->xla_gpu_rematerialization_memory_limit_bytes()),
+           "If non-zero, rematerialize instructions in the GPU backend until "
+           "the executable fits in this many bytes; if negative, in the free "
+           "memory of the device at compile time."),
        tensorflow::Flag(
            "xla_dump_hlo_proto_to",
            flag_values->mutable_xla_dump_hlo_proto_to(),
@@ -243,6 +272,19 @@ void AllocateFlags() {
            bool_setter_for(&DebugOptions::set_xla_hlo_profile),
            flag_values->xla_hlo_profile(),
            "Instrument the computation to collect per-HLO cycle counts"),
+       tensorflow::Flag(
+           "xla_hlo_profile_step_stats",
+           bool_setter_for(&DebugOptions::set_xla_hlo_profile_step_stats),
+           flag_values->xla_hlo_profile_step_stats(),
+           "Instrument the computation to collect per-HLO cycle counts, and "
+           "only export them as the step stats of traced TensorFlow steps"),
+       tensorflow::Flag(
+           "xla_hlo_pass_threads",
+           int32_setter_for(&DebugOptions::set_xla_hlo_pass_threads),
+           flag_values->xla_hlo_pass_threads(),
+           "Number of threads that HLO passes which transform each "
+           "computation independently use to run over the computations of a "
+           "module concurrently"),
        tensorflow::Flag("xla_dump_computations_to",
                         flag_values->mutable_xla_dump_computations_to(),
                         "Dump computations that XLA executes into the provided "
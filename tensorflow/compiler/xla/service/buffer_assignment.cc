@@ -119,6 +119,9 @@ string BufferAllocation::ToString() const {
   }
   if (is_entry_computation_parameter()) {
     tensorflow::strings::StrAppend(&output, ", parameter ", parameter_number());
+    if (is_donated_parameter()) {
+      tensorflow::strings::StrAppend(&output, ", donated");
+    }
   }
   if (is_thread_local()) {
     tensorflow::strings::StrAppend(&output, ", thread-local");
@@ -598,6 +601,7 @@ Status GatherComputationsByAllocationType(
           case HloOpcode::kMap:
           case HloOpcode::kReduce:
           case HloOpcode::kReduceWindow:
+          case HloOpcode::kScatter:
           case HloOpcode::kSelectAndScatter:
           case HloOpcode::kFusion:
             // Map/reduce etc computations are always thread-local.
@@ -663,7 +667,8 @@ bool BufferAssigner::MaybeAssignBuffer(BufferAllocation* allocation,
     return false;
   }
 
-  if (allocation->is_entry_computation_parameter()) {
+  if (allocation->is_entry_computation_parameter() &&
+      !allocation->is_donated_parameter()) {
     VLOG(4) << "Can't assign: allocation holds parameter";
     return false;
   }
@@ -833,13 +838,22 @@ Status BufferAssigner::AssignBuffersForComputation(
       // If the LogicalBuffer is part of an external parameter, creates a new
       // allocation and sets its parameter number. Parameters of non-entry
       // computations do not need special allocations because they live inside
-      // callers.
+      // callers. The allocation of a donated array parameter can be reused
+      // by the buffers that are defined after the parameter is dead.
+      const bool is_donated =
+          buffer->IsTopLevel() && !buffer->IsTuple() &&
+          assignment->module_->config().is_donated_parameter(
+              instruction->parameter_number());
       BufferAllocation* allocation =
           assignment->NewAllocation(*buffer, buffer_size,
                                     /*is_thread_local=*/false,
-                                    /*is_reusable=*/false);
+                                    /*is_reusable=*/is_donated);
       allocation->set_entry_computation_parameter(
           instruction->parameter_number());
+      if (is_donated) {
+        allocation->set_donated_parameter();
+        allocation_indices.push_back(allocation->index());
+      }
       VLOG(3) << "New allocation #" << allocation->index()
               << " for entry computation parameter: " << *buffer;
       continue;
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_module_config.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/hlo_ordering.h"
 #include "tensorflow/compiler/xla/service/hlo_scheduling.h"
@@ -825,6 +826,58 @@ TEST_F(BufferAssignmentTest, UnaryOpReuseChain) {
   EXPECT_EQ(buffer_for_exp1, GetTopLevelAllocation(*assignment, neg));
 }
 
+TEST_F(BufferAssignmentTest, ReuseDonatedParameter) {
+  // param0[100] ---> (exp) ---> (neg)
+  //
+  // With param0 donated, exp and neg update it in place.
+  auto builder = HloComputation::Builder(TestName());
+  auto param0 = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, f32vec100_, "param0"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32vec100_, HloOpcode::kExp, param0));
+  auto neg = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32vec100_, HloOpcode::kNegate, exp));
+
+  HloModuleConfig config;
+  config.set_debug_options(GetDebugOptionsForTest());
+  config.set_donated_parameters({0});
+  auto module = MakeUnique<HloModule>(TestName(), VersionedComputationHandle(),
+                                      config);
+  module->AddEntryComputation(builder.Build());
+  auto assignment = RunBufferAssignment(module.get());
+
+  const BufferAllocation& param_buffer =
+      GetTopLevelAllocation(*assignment, param0);
+  EXPECT_TRUE(param_buffer.is_entry_computation_parameter());
+  EXPECT_TRUE(param_buffer.is_donated_parameter());
+  EXPECT_EQ(param_buffer, GetTopLevelAllocation(*assignment, exp));
+  EXPECT_EQ(param_buffer, GetTopLevelAllocation(*assignment, neg));
+}
+
+TEST_F(BufferAssignmentTest, NoReuseLiveDonatedParameter) {
+  // param0[100] ---> (exp) ---> (tuple)
+  //        \--------------------/
+  //
+  // The donated param0 is live out, so exp cannot reuse its buffer.
+  auto builder = HloComputation::Builder(TestName());
+  auto param0 = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, f32vec100_, "param0"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(f32vec100_, HloOpcode::kExp, param0));
+  builder.AddInstruction(HloInstruction::CreateTuple({param0, exp}));
+
+  HloModuleConfig config;
+  config.set_debug_options(GetDebugOptionsForTest());
+  config.set_donated_parameters({0});
+  auto module = MakeUnique<HloModule>(TestName(), VersionedComputationHandle(),
+                                      config);
+  module->AddEntryComputation(builder.Build());
+  auto assignment = RunBufferAssignment(module.get());
+
+  EXPECT_NE(GetTopLevelAllocation(*assignment, param0),
+            GetTopLevelAllocation(*assignment, exp));
+}
+
 TEST_F(BufferAssignmentTest, ReuseNonOperandBuffer) {
   // This computation is a chain of operations which decreases in buffer size
   // (via slice) then increases in size (via broadcast):
@@ -25,11 +25,13 @@ limitations under the License.
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/ExecutionEngine/ObjectMemoryBuffer.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO.h"
@@ -45,6 +47,12 @@ limitations under the License.
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -105,8 +113,93 @@ class FilteredPassManager : public llvm::legacy::PassManager {
 };
 }  // anonymous namespace
 
+namespace {
+
+// Returns the object file held by `buffer`, or an empty OwningBinary if it is
+// not a valid object file.
+llvm::object::OwningBinary<llvm::object::ObjectFile> MakeObjectFile(
+    std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>>
+      object_file_or_error =
+          llvm::object::ObjectFile::createObjectFile(buffer->getMemBufferRef());
+  if (!object_file_or_error) {
+    llvm::consumeError(object_file_or_error.takeError());
+    return llvm::object::OwningBinary<llvm::object::ObjectFile>();
+  }
+  return llvm::object::OwningBinary<llvm::object::ObjectFile>(
+      std::move(object_file_or_error.get()), std::move(buffer));
+}
+
+// Writes `contents` to `filename` through a temporary file, so that a
+// concurrent reader never sees a partially written object.
+tensorflow::Status WriteCachedObject(const string& dir, const string& filename,
+                                     tensorflow::StringPiece contents) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  tensorflow::Status s = env->RecursivelyCreateDir(dir);
+  if (!s.ok() && s.code() != tensorflow::error::ALREADY_EXISTS) {
+    return s;
+  }
+  const string tmp_filename = tensorflow::strings::StrCat(
+      filename, ".tmp", tensorflow::strings::Hex(tensorflow::random::New64()));
+  s = tensorflow::WriteStringToFile(env, tmp_filename, contents);
+  if (s.ok()) {
+    s = env->RenameFile(tmp_filename, filename);
+  }
+  if (!s.ok()) {
+    env->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+}  // namespace
+
+string CompilerFunctor::ObjectCacheFileName(const llvm::Module& module) const {
+  string key_data = llvm_ir::DumpModuleToString(module);
+  tensorflow::strings::StrAppend(
+      &key_data, "\n", LLVM_VERSION_STRING, "\n",
+      target_machine_->getTargetTriple().str(), "\n",
+      target_machine_->getTargetCPU().str(), "\n",
+      target_machine_->getTargetFeatureString().str(), "\n",
+      tensorflow::strings::Printf(
+          "%u %d %d %d %d %d %d", opt_level_, optimize_for_size_,
+          enable_fast_math_, disable_expensive_passes_,
+          available_intrinsics_.sse_intrinsics,
+          available_intrinsics_.avx_intrinsics,
+          available_intrinsics_.neon_intrinsics));
+  const tensorflow::Fprint128 fingerprint =
+      tensorflow::Fingerprint128(key_data);
+  return tensorflow::io::JoinPath(
+      object_cache_dir_,
+      tensorflow::strings::Printf(
+          "%016llx%016llx.o",
+          static_cast<unsigned long long>(fingerprint.high64),
+          static_cast<unsigned long long>(fingerprint.low64)));
+}
+
 llvm::object::OwningBinary<llvm::object::ObjectFile> CompilerFunctor::
 operator()(llvm::Module& module) const {
+  // The key is computed before the hooks run, since they may change the
+  // module.
+  string cache_file_name;
+  if (!object_cache_dir_.empty()) {
+    cache_file_name = ObjectCacheFileName(module);
+    string contents;
+    if (tensorflow::Env::Default()->FileExists(cache_file_name).ok() &&
+        tensorflow::ReadFileToString(tensorflow::Env::Default(),
+                                     cache_file_name, &contents)
+            .ok()) {
+      llvm::object::OwningBinary<llvm::object::ObjectFile> object =
+          MakeObjectFile(
+              llvm::MemoryBuffer::getMemBufferCopy(contents, cache_file_name));
+      if (object.getBinary() != nullptr) {
+        VLOG(1) << "Loaded the object code of " << module.getName().str()
+                << " from " << cache_file_name;
+        return object;
+      }
+      LOG(WARNING) << "Ignoring the invalid cached object " << cache_file_name;
+    }
+  }
+
   FilteredPassManager module_passes(disable_expensive_passes_);
   FilteredFunctionPassManager function_passes(&module,
                                               disable_expensive_passes_);
@@ -168,6 +261,16 @@ operator()(llvm::Module& module) const {
   target_machine_->addPassesToEmitMC(codegen_passes, mc_context, ostream);
   codegen_passes.run(module);
 
+  if (!cache_file_name.empty()) {
+    tensorflow::Status s = WriteCachedObject(
+        object_cache_dir_, cache_file_name,
+        tensorflow::StringPiece(stream_buffer.data(), stream_buffer.size()));
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to cache the object code in " << cache_file_name
+                   << ": " << s;
+    }
+  }
+
   // Construct ObjectFile from machine code buffer.
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer(
       new llvm::ObjectMemoryBuffer(std::move(stream_buffer)));
@@ -22,6 +22,7 @@ limitations under the License.
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/disassembler.h"
 #include "tensorflow/compiler/xla/service/llvm_compiler.h"
+#include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -47,7 +48,8 @@ class CompilerFunctor {
       bool disable_expensive_passes,
       const VectorIntrinsics& available_intrinsics,
       LLVMCompiler::ModuleHook pre_optimization_hook = nullptr,
-      LLVMCompiler::ModuleHook post_optimization_hook = nullptr)
+      LLVMCompiler::ModuleHook post_optimization_hook = nullptr,
+      const string& object_cache_dir = "")
       : target_machine_(target_machine),
         disassembler_(CHECK_NOTNULL(disassembler)),
         opt_level_(opt_level),
@@ -56,13 +58,18 @@ class CompilerFunctor {
         disable_expensive_passes_(disable_expensive_passes),
         available_intrinsics_(available_intrinsics),
         pre_optimization_hook_(pre_optimization_hook),
-        post_optimization_hook_(post_optimization_hook) {}
+        post_optimization_hook_(post_optimization_hook),
+        object_cache_dir_(object_cache_dir) {}
 
   // Compile a Module to an ObjectFile.
   llvm::object::OwningBinary<llvm::object::ObjectFile> operator()(
       llvm::Module& module) const;  // NOLINT
 
  private:
+  // Returns the name of the file of the object cache that holds the object
+  // code of `module`, keyed by the fingerprint of its IR and of the options
+  // that affect code generation.
+  string ObjectCacheFileName(const llvm::Module& module) const;
   // Populates the given pass manager with TargetLibraryInfo and
   // TargetTransformInfo passes.
   void AddTargetInfoPasses(llvm::legacy::PassManagerBase* passes) const;
@@ -81,6 +88,8 @@ class CompilerFunctor {
   const VectorIntrinsics available_intrinsics_;
   LLVMCompiler::ModuleHook pre_optimization_hook_;
   LLVMCompiler::ModuleHook post_optimization_hook_;
+  // If non-empty, the directory of the object cache.
+  const string object_cache_dir_;
 };
 
 }  // namespace cpu
@@ -160,6 +160,10 @@ CpuCompiler::CpuCompiler() {
 
 namespace {
 
+// The number of elements above which constant folding an instruction takes
+// longer than evaluating it in the compiled code.
+constexpr int64 kMaxConstantFoldingCost = 1 << 26;
+
 // LLVM makes certain options configurable only through its command-line
 // options; it provide the ParseCommandLineOptions function that lets us set
 // flags at runtime. However, since these flags are global we want to avoid
@@ -258,7 +262,8 @@ class CollectProfileCandidates : public DfsHloVisitorWithDefault {
 };
 }  // namespace
 
-Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile) {
+Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile,
+                                 int max_aot_parallel_tasks) {
   // Optimization pipeline.
   HloPassPipeline pipeline("CPU");
   pipeline.AddInvariantChecker<HloVerifier>(ShapeSizeBytesFunction());
@@ -294,7 +299,10 @@ Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile) {
     pass.AddPass<WhileLoopSimplifier>();
     pass.AddPass<HloDCE>();
     pass.AddPass<ReshapeMover>();
-    pass.AddPass<HloConstantFolding>();
+    // Leaves instructions that are too expensive to evaluate at compile time
+    // to the compiled code.
+    pass.AddPass<HloConstantFolding>(
+        /*max_evaluation_cost=*/kMaxConstantFoldingCost);
   }
   pipeline.AddPass<TransposeFolding>(
       [](const HloInstruction& dot,
@@ -323,18 +331,19 @@ Status CpuCompiler::RunHloPasses(HloModule* module, bool is_aot_compile) {
   pipeline.AddPass<HloElementTypeConverter>(BF16, F32);
   // Outline ops in the entry computation into calls to subcomputations.
   const int max_parallelism =
-      module->config().intra_op_parallelism_threads() > 0
-          ? module->config().intra_op_parallelism_threads()
-          : tensorflow::port::NumSchedulableCPUs();
+      is_aot_compile ? max_aot_parallel_tasks
+                     : module->config().intra_op_parallelism_threads() > 0
+                           ? module->config().intra_op_parallelism_threads()
+                           : tensorflow::port::NumSchedulableCPUs();
   if (options::CpuParallelBackendRequested(module->config())) {
     pipeline.AddPass<ParallelizationPreparation>(max_parallelism,
                                                  ShapeSizeBytesFunction());
-  } else if (!is_aot_compile) {
+  } else if (!is_aot_compile || max_parallelism > 1) {
     // Run ParallelTaskAssigner to assign parallel tasks to HLOs in module.
-    // Note this is not run for AOT because it would bring in thread pool
-    // and thread synchronization dependencies which would likely increase
-    // binary size (and most AOT applications are single-threaded).
-    // TODO(29630486) Support multi-threaded AOT.
+    // AOT compilation only does this when asked to, because the generated
+    // code then depends on the fork-join runtime and a thread pool, which
+    // increases the binary size (and most AOT applications are
+    // single-threaded).
     pipeline.AddPass<ParallelTaskAssigner>(max_parallelism,
                                            ShapeSizeBytesFunction());
   }
@@ -446,7 +455,8 @@ StatusOr<std::unique_ptr<HloModule>> CpuCompiler::RunHloPasses(
   VLOG(2) << "Before optimization:";
   XLA_VLOG_LINES(2, module->ToString());
 
-  TF_RETURN_IF_ERROR(RunHloPasses(module.get(), /*is_aot_compile=*/false));
+  TF_RETURN_IF_ERROR(RunHloPasses(module.get(), /*is_aot_compile=*/false,
+                                  /*max_aot_parallel_tasks=*/1));
 
   VLOG(2) << "After optimization:";
   XLA_VLOG_LINES(2, module->ToString());
@@ -482,7 +492,8 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
       options::OptimizeForSizeRequested(module->config()),
       module->config().debug_options().xla_enable_fast_math(),
       module->config().debug_options().xla_llvm_disable_expensive_passes(),
-      pre_optimization_ir_hook, post_optimization_ir_hook);
+      pre_optimization_ir_hook, post_optimization_ir_hook,
+      module->config().debug_options().xla_cpu_object_cache_dir());
   llvm_module->setDataLayout(jit->data_layout());
   llvm_module->setTargetTriple(jit->target_triple().getTriple());
 
@@ -813,7 +824,8 @@ CpuCompiler::CompileAheadOfTime(std::vector<std::unique_ptr<HloModule>> modules,
     VLOG(2) << "Before optimization:";
     XLA_VLOG_LINES(2, module->ToString());
 
-    TF_RETURN_IF_ERROR(RunHloPasses(module, /*is_aot_compile=*/true));
+    TF_RETURN_IF_ERROR(RunHloPasses(module, /*is_aot_compile=*/true,
+                                    options.max_parallel_tasks()));
 
     VLOG(2) << "After optimization:";
     XLA_VLOG_LINES(2, module->ToString());
@@ -66,12 +66,21 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   // The relocation model used for compilation.
   RelocationModel relocation_model() const { return relocation_model_; }
 
+  // The maximum number of parallel tasks that one HLO op is split into. The
+  // default of 1 compiles single-threaded code; larger values run the tasks
+  // on ExecutableRunOptions::intra_op_thread_pool, if one is set.
+  int max_parallel_tasks() const { return max_parallel_tasks_; }
+  void set_max_parallel_tasks(int max_parallel_tasks) {
+    max_parallel_tasks_ = max_parallel_tasks;
+  }
+
  private:
   const string triple_;
   const string cpu_name_;
   const string features_;
   const string entry_point_name_;
   const RelocationModel relocation_model_;
+  int max_parallel_tasks_ = 1;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {
@@ -137,8 +146,10 @@ class CpuCompiler : public LLVMCompiler {
   static void InitializeLLVMTarget();
 
   // Runs the HLO passes which are necessary for both optimizations and
-  // correctness.
-  Status RunHloPasses(HloModule* module, bool is_aot_compile);
+  // correctness. For AOT compilation, ParallelTaskAssigner only runs if
+  // "max_aot_parallel_tasks" is greater than 1.
+  Status RunHloPasses(HloModule* module, bool is_aot_compile,
+                      int max_aot_parallel_tasks);
 
   TF_DISALLOW_COPY_AND_ASSIGN(CpuCompiler);
 };
@@ -195,9 +195,16 @@ Status CpuExecutable::ExecuteComputeFunction(
     profile_counter_for_entry_computation.push_back(0);
   }
 
-  // Call the computation function following the calling convention.
+  // Call the computation function following the calling convention. The
+  // logical buffers assigned to the allocation of a donated parameter live in
+  // the buffer of the argument.
   std::vector<void*> buffer_pointers;
-  for (auto& buffer : buffers) {
+  for (BufferAllocation::Index i = 0; i < buffers.size(); ++i) {
+    const BufferAllocation& allocation = assignment_->GetAllocation(i);
+    const se::DeviceMemoryBase& buffer =
+        allocation.is_donated_parameter()
+            ? arguments[allocation.parameter_number()]
+            : buffers[i];
     buffer_pointers.push_back(const_cast<void*>(buffer.opaque()));
   }
   TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice result_slice,
@@ -294,7 +301,10 @@ StatusOr<perftools::gputools::DeviceMemoryBase> CpuExecutable::ExecuteOnStream(
   std::unordered_set<const void*> marked_addresses;
   TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice result_slice,
                       assignment_->GetUniqueTopLevelOutputSlice());
-  se::DeviceMemoryBase top_level_output = buffers[result_slice.index()];
+  se::DeviceMemoryBase top_level_output =
+      result_slice.allocation()->is_donated_parameter()
+          ? arguments[result_slice.allocation()->parameter_number()]
+          : buffers[result_slice.index()];
   MarkLiveAddressesInOutput(top_level_output.opaque(), result_shape(),
                             &marked_addresses);
 
@@ -332,7 +342,7 @@ StatusOr<std::unique_ptr<ShapedBuffer>> CpuExecutable::ExecuteOnStream(
   TF_RETURN_IF_ERROR(
       result_buffer->mutable_shape_index_to_buffer_entry()
           ->ForEachMutableElementWithStatus(
-              [&buffers, &buffers_in_result, &result_buffer, this](
+              [&arguments, &buffers, &buffers_in_result, &result_buffer, this](
                   const ShapeIndex& index, size_t* buffer_entry) {
                 const auto& sources = this->GetRootPointsToSet().element(index);
                 // The points to set is unambiguous so the set should be a
@@ -345,14 +355,20 @@ StatusOr<std::unique_ptr<ShapedBuffer>> CpuExecutable::ExecuteOnStream(
                 // such as a tuple element.
 
                 // The source instruction should have a non-parameter buffer
-                // assigned.
+                // assigned, unless the buffer reuses a donated parameter.
                 TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice slice,
                                     this->assignment_->GetUniqueSlice(
                                         src, buffer_source->index()));
-                CHECK(!slice.allocation()->is_entry_computation_parameter());
+                const BufferAllocation* allocation = slice.allocation();
+                CHECK(!allocation->is_entry_computation_parameter() ||
+                      allocation->is_donated_parameter());
 
                 const BufferAllocation::Index buffer_index = slice.index();
-                const se::DeviceMemoryBase& buffer = buffers[buffer_index];
+                const se::DeviceMemoryBase buffer =
+                    allocation->is_donated_parameter()
+                        ? arguments[allocation->parameter_number()]->buffer(
+                              /*index=*/{})
+                        : buffers[buffer_index];
                 CHECK(!buffer.is_null() || buffer.size() == 0);
                 *buffer_entry = result_buffer->mutable_buffers()->size();
                 result_buffer->mutable_buffers()->push_back(buffer);
@@ -398,7 +414,10 @@ CpuExecutable::ExecuteAsyncOnStream(
   std::unordered_set<const void*> marked_addresses;
   TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice result_slice,
                       assignment_->GetUniqueTopLevelOutputSlice());
-  se::DeviceMemoryBase top_level_output = buffers[result_slice.index()];
+  se::DeviceMemoryBase top_level_output =
+      result_slice.allocation()->is_donated_parameter()
+          ? arguments[result_slice.allocation()->parameter_number()]
+          : buffers[result_slice.index()];
   MarkLiveAddressesInOutput(top_level_output.opaque(), result_shape(),
                             &marked_addresses);
 
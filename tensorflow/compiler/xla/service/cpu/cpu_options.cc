@@ -23,6 +23,7 @@ const char* const kXlaParallelCpuOption = "xla_cpu_parallel";
 const char* const kXlaOptimizeForSizeCpuOption = "xla_cpu_optimize_for_size";
 const char* const kXlaDisableVectorizedReduce = "xla_disable_vectorized_reduce";
 const char* const kLlvmIrDotTilingFactor = "xla_llvm_dot_tiling_factor";
+const char* const kLlvmIrGemmMaxSize = "xla_llvm_gemm_max_size";
 
 }  // namespace
 
@@ -45,7 +46,7 @@ bool OptimizeForSizeRequested(const HloModuleConfig& config) {
 bool VectorizedReduceDisabled(const HloModuleConfig& config) {
   const auto& extra_options_map =
       config.debug_options().xla_backend_extra_options();
-  return extra_options_map.count(kXlaOptimizeForSizeCpuOption) > 0;
+  return extra_options_map.count(kXlaDisableVectorizedReduce) > 0;
 }
 
 tensorflow::gtl::optional<int64> LlvmIrGemvTilingFactor(
@@ -61,6 +62,19 @@ tensorflow::gtl::optional<int64> LlvmIrGemvTilingFactor(
   return tensorflow::gtl::nullopt;
 }
 
+tensorflow::gtl::optional<int64> LlvmIrGemmMaxSize(
+    const HloModuleConfig& config) {
+  const auto& extra_options_map =
+      config.debug_options().xla_backend_extra_options();
+  auto it = extra_options_map.find(kLlvmIrGemmMaxSize);
+  int64 max_size;
+  if (it != extra_options_map.end() &&
+      tensorflow::strings::safe_strto64(it->second, &max_size)) {
+    return max_size;
+  }
+  return tensorflow::gtl::nullopt;
+}
+
 }  // namespace options
 }  // namespace cpu
 }  // namespace xla
@@ -29,6 +29,8 @@ bool OptimizeForSizeRequested(const HloModuleConfig& config);
 bool VectorizedReduceDisabled(const HloModuleConfig& config);
 tensorflow::gtl::optional<int64> LlvmIrGemvTilingFactor(
     const HloModuleConfig& config);
+tensorflow::gtl::optional<int64> LlvmIrGemmMaxSize(
+    const HloModuleConfig& config);
 
 }  // namespace options
 }  // namespace cpu
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "llvm/IR/BasicBlock.h"
@@ -519,6 +520,190 @@ void RowMajorMatrixVectorProductEmitter::EmitInnerLoopEpilogue(
   }
 }
 
+// Computes the matrix-matrix product of "[M,K]{1,0} lhs" and "[K,N]{1,0} rhs"
+// into "[M,N]{1,0} result".  This is meant for matrices that are too small for
+// the overhead of calling into Eigen to pay off, e.g. the 128x128 products in
+// the cells of RNNs.
+//
+// The result is computed in tiles of tile_rows_ rows and tile_vectors_ vectors
+// of columns, that are kept in vector registers while we iterate over the
+// reduction dimension:
+//
+//   for each row r in the tile:
+//     T[r][0..tile_vectors_) += broadcast(lhs[r][k]) * rhs[k][tile columns]
+//
+// so each element loaded from the RHS is reused tile_rows_ times and each
+// element loaded from the LHS is reused for every column of the tile.  The
+// reduction dimension is split into blocks of tile_k_ so that the slice of the
+// RHS used by a tile stays in the L1 cache while we sweep over the rows.
+//
+// Columns that do not form a full vector are handled by a second, scalar,
+// VectorSupportLibrary, and rows and vectors that do not form a full tile by
+// emitting narrower tiles.
+class MatrixMatrixProductEmitter {
+ public:
+  MatrixMatrixProductEmitter(PrimitiveType scalar_type, int64 vector_size,
+                             int64 tile_rows, int64 tile_vectors, int64 tile_k,
+                             int64 m, int64 k, int64 n, llvm::Value* lhs,
+                             llvm::Value* rhs, llvm::Value* result,
+                             llvm::IRBuilder<>* ir_builder)
+      : tile_rows_(tile_rows),
+        tile_vectors_(tile_vectors),
+        tile_k_(tile_k),
+        m_(m),
+        k_(k),
+        n_(n),
+        lhs_(lhs),
+        rhs_(rhs),
+        result_(result),
+        ir_builder_(ir_builder),
+        ksl_(ir_builder_),
+        vsl_(scalar_type, vector_size, ir_builder_, "gemm"),
+        scalar_vsl_(scalar_type, /*vector_size=*/1, ir_builder_, "gemm") {
+    CHECK(tile_rows_ > 0 && tile_vectors_ > 0 && tile_k_ > 0);
+  }
+
+  void Emit();
+
+ private:
+  // Accumulates the product of rows [0, m_) of the LHS and columns
+  // [col_begin, col_end) of the RHS over the reduction dimension slice
+  // [k_begin, k_end) into the result, with vectors of `vsl`.
+  void EmitColumnRange(VectorSupportLibrary* vsl, int64 col_begin,
+                       int64 col_end, llvm::Value* k_begin, llvm::Value* k_end,
+                       bool is_first_k_block);
+
+  // Accumulates one tile of `rows` rows starting at `row` and `vectors`
+  // vectors of columns starting at `col` over [k_begin, k_end).  If
+  // `is_first_k_block` is true the tile starts from zero instead of the
+  // partial sums in the result.
+  void EmitTile(VectorSupportLibrary* vsl, llvm::Value* row, int64 rows,
+                llvm::Value* col, int64 vectors, llvm::Value* k_begin,
+                llvm::Value* k_end, bool is_first_k_block);
+
+  llvm::Value* GetInt64(int64 value) { return ir_builder_->getInt64(value); }
+
+  int64 tile_rows_;
+  int64 tile_vectors_;
+  int64 tile_k_;
+  int64 m_;
+  int64 k_;
+  int64 n_;
+  llvm::Value* lhs_;
+  llvm::Value* rhs_;
+  llvm::Value* result_;
+  llvm::IRBuilder<>* ir_builder_;
+  KernelSupportLibrary ksl_;
+  VectorSupportLibrary vsl_;
+  VectorSupportLibrary scalar_vsl_;
+};
+
+void MatrixMatrixProductEmitter::Emit() {
+  int64 vectorized_cols = n_ - n_ % vsl_.vector_size();
+  ksl_.For("gemm.k_block", /*start=*/0, /*end=*/k_, /*step=*/tile_k_,
+           [&](llvm::Value* k_begin, bool is_first_k_block) {
+             llvm::Value* k_block_end =
+                 ir_builder_->CreateAdd(k_begin, GetInt64(tile_k_));
+             llvm::Value* k_end = ir_builder_->CreateSelect(
+                 ir_builder_->CreateICmpSLT(k_block_end, GetInt64(k_)),
+                 k_block_end, GetInt64(k_));
+             EmitColumnRange(&vsl_, 0, vectorized_cols, k_begin, k_end,
+                             is_first_k_block);
+             EmitColumnRange(&scalar_vsl_, vectorized_cols, n_, k_begin, k_end,
+                             is_first_k_block);
+           });
+}
+
+void MatrixMatrixProductEmitter::EmitColumnRange(VectorSupportLibrary* vsl,
+                                                 int64 col_begin,
+                                                 int64 col_end,
+                                                 llvm::Value* k_begin,
+                                                 llvm::Value* k_end,
+                                                 bool is_first_k_block) {
+  int64 tile_cols = tile_vectors_ * vsl->vector_size();
+  int64 tiled_col_end =
+      col_begin + (col_end - col_begin) / tile_cols * tile_cols;
+  int64 tiled_row_end = m_ - m_ % tile_rows_;
+  int64 remainder_rows = m_ - tiled_row_end;
+  int64 remainder_vectors = (col_end - tiled_col_end) / vsl->vector_size();
+
+  auto emit_rows = [&](llvm::Value* col, int64 vectors) {
+    ksl_.For("gemm.rows", /*start=*/0, /*end=*/tiled_row_end,
+             /*step=*/tile_rows_, [&](llvm::Value* row) {
+               EmitTile(vsl, row, tile_rows_, col, vectors, k_begin, k_end,
+                        is_first_k_block);
+             });
+    if (remainder_rows != 0) {
+      EmitTile(vsl, GetInt64(tiled_row_end), remainder_rows, col, vectors,
+               k_begin, k_end, is_first_k_block);
+    }
+  };
+
+  ksl_.For("gemm.cols", /*start=*/col_begin, /*end=*/tiled_col_end,
+           /*step=*/tile_cols,
+           [&](llvm::Value* col) { emit_rows(col, tile_vectors_); });
+  if (remainder_vectors != 0) {
+    emit_rows(GetInt64(tiled_col_end), remainder_vectors);
+  }
+}
+
+void MatrixMatrixProductEmitter::EmitTile(VectorSupportLibrary* vsl,
+                                          llvm::Value* row, int64 rows,
+                                          llvm::Value* col, int64 vectors,
+                                          llvm::Value* k_begin,
+                                          llvm::Value* k_end,
+                                          bool is_first_k_block) {
+  // The accumulator for row r and vector v of the tile is
+  // accumulators[r * vectors + v].
+  std::vector<llvm::Value*> result_pointers;
+  std::vector<VectorVariable> accumulators;
+  for (int64 r = 0; r < rows; r++) {
+    llvm::Value* row_offset = ir_builder_->CreateMul(
+        ir_builder_->CreateAdd(row, GetInt64(r)), GetInt64(n_));
+    for (int64 v = 0; v < vectors; v++) {
+      llvm::Value* offset = ir_builder_->CreateAdd(
+          row_offset,
+          ir_builder_->CreateAdd(col, GetInt64(v * vsl->vector_size())));
+      result_pointers.push_back(vsl->ComputeOffsetPointer(result_, offset));
+      accumulators.emplace_back(vsl, is_first_k_block
+                                         ? vsl->GetZeroVector()
+                                         : vsl->LoadVector(
+                                               result_pointers.back()));
+    }
+  }
+
+  ksl_.For("gemm.reduction", k_begin, k_end, /*step=*/GetInt64(1),
+           [&](llvm::Value* reduction_index) {
+             llvm::Value* rhs_row_offset =
+                 ir_builder_->CreateMul(reduction_index, GetInt64(n_));
+             std::vector<llvm::Value*> rhs_vectors;
+             for (int64 v = 0; v < vectors; v++) {
+               rhs_vectors.push_back(vsl->LoadVector(
+                   rhs_, ir_builder_->CreateAdd(
+                             rhs_row_offset,
+                             ir_builder_->CreateAdd(
+                                 col, GetInt64(v * vsl->vector_size())))));
+             }
+             for (int64 r = 0; r < rows; r++) {
+               llvm::Value* lhs_element = vsl->LoadBroadcast(
+                   lhs_, ir_builder_->CreateAdd(
+                             ir_builder_->CreateMul(
+                                 ir_builder_->CreateAdd(row, GetInt64(r)),
+                                 GetInt64(k_)),
+                             reduction_index));
+               for (int64 v = 0; v < vectors; v++) {
+                 VectorVariable& accumulator = accumulators[r * vectors + v];
+                 accumulator.Set(vsl->MulAdd(lhs_element, rhs_vectors[v],
+                                             accumulator.Get()));
+               }
+             }
+           });
+
+  for (int64 i = 0; i < result_pointers.size(); i++) {
+    vsl->StoreVector(accumulators[i].Get(), result_pointers[i]);
+  }
+}
+
 }  // namespace
 
 DotOpEmitter::DotOpEmitter(
@@ -607,7 +792,7 @@ bool DotOpEmitter::EmitLlvmIrDotIfProfitable() {
   }
 
   if (!is_column_major_matrix_vector && !is_row_major_matrix_vector) {
-    return false;
+    return EmitSmallMatrixMatrixProductIfProfitable(mat_mult_dims);
   }
 
   int64 tiling_factor = GetGemvTilingFactor();
@@ -675,6 +860,85 @@ bool DotOpEmitter::EmitLlvmIrDotIfProfitable() {
   return true;
 }
 
+bool DotOpEmitter::EmitSmallMatrixMatrixProductIfProfitable(
+    const MatMultDims& mat_mult_dims) {
+  PrimitiveType primitive_type = dot_.shape().element_type();
+  if (addend_array_ != nullptr ||
+      (primitive_type != F32 && primitive_type != F64)) {
+    return false;
+  }
+
+  // Beyond this many multiply-adds the (multi-threaded, better blocked) Eigen
+  // matrix multiply wins over the code we emit.
+  const int64 kDefaultMaxSize = 128 * 128 * 256;
+  const int64 max_size =
+      options::LlvmIrGemmMaxSize(hlo_module_config_).value_or(kDefaultMaxSize);
+  int64 m = mat_mult_dims.m;
+  int64 k = mat_mult_dims.k;
+  int64 n = mat_mult_dims.n;
+  if (m * k * n > max_size) {
+    return false;
+  }
+
+  // We emit a product of row major matrices.  If all the operands are column
+  // major we compute the transposed product instead, since
+  // transpose(A * B) = transpose(B) * transpose(A).
+  bool lhs_effectively_column_major =
+      transpose_lhs_ ^ mat_mult_dims.lhs_column_major;
+  bool rhs_effectively_column_major =
+      transpose_rhs_ ^ mat_mult_dims.rhs_column_major;
+  bool result_column_major =
+      target_array_.GetShape().layout().minor_to_major(0) == 0;
+  if (lhs_effectively_column_major != result_column_major ||
+      rhs_effectively_column_major != result_column_major) {
+    return false;
+  }
+  bool swap_operands = result_column_major;
+  if (swap_operands) {
+    std::swap(m, n);
+  }
+
+  llvm::Value* lhs_op =
+      swap_operands ? rhs_array_.GetBasePointer() : lhs_array_.GetBasePointer();
+  llvm::Value* rhs_op =
+      swap_operands ? lhs_array_.GetBasePointer() : rhs_array_.GetBasePointer();
+
+  // With 256 bit vectors a tile of 4x2 vectors keeps 8 accumulators, 2 RHS
+  // vectors and a broadcast LHS element in the 16 vector registers of AVX.  A
+  // block of 256 rows of the two RHS vectors is 16KB of floats.
+  const int64 kVectorSizeInBytes = 32;
+  int64 vector_size =
+      kVectorSizeInBytes / ShapeUtil::ByteSizeOfPrimitiveType(primitive_type);
+  int64 tile_rows = 4;
+  int64 tile_vectors = 2;
+  int64 tile_k = 256;
+
+  VLOG(2) << "Emitting matrix-matrix multiply with m = " << m << ", k = " << k
+          << " and n = " << n;
+
+  string kernel_name = tensorflow::strings::StrCat(
+      "gemm_", PrimitiveType_Name(primitive_type), "_", tile_rows, "_",
+      tile_vectors, "_", tile_k, "_", m, "_", k, "_", n);
+
+  KernelSupportLibrary::EmitAndCallOutlinedKernel(
+      /*enable_fast_math=*/hlo_module_config_.debug_options()
+          .xla_enable_fast_math(),
+      /*optimize_for_size=*/options::OptimizeForSizeRequested(
+          hlo_module_config_),
+      ir_builder_, kernel_name, lhs_op, rhs_op,
+      target_array_.GetBasePointer(),
+      [this, vector_size, tile_rows, tile_vectors, tile_k, m, k, n,
+       primitive_type](llvm::Value* lhs_op, llvm::Value* rhs_op,
+                       llvm::Value* result_op) {
+        MatrixMatrixProductEmitter emitter(primitive_type, vector_size,
+                                           tile_rows, tile_vectors, tile_k, m,
+                                           k, n, lhs_op, rhs_op, result_op,
+                                           ir_builder_);
+        emitter.Emit();
+      });
+  return true;
+}
+
 tensorflow::Status DotOpEmitter::Emit() {
   // The dot operation performs a sum of products over dimension 0 of the left
   // hand side operand and dimension 1 of the right hand side operand.
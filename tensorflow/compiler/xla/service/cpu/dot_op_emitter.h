@@ -124,6 +124,12 @@ class DotOpEmitter {
   // of rank 2 as well).
   MatMultDims GetMatMultDims() const;
 
+  // Emits a tiled LLVM IR implementation of a matrix-matrix product if the
+  // matrices are small enough for it to beat the runtime call.  Returns true if
+  // an LLVM IR implementation was emitted.
+  bool EmitSmallMatrixMatrixProductIfProfitable(
+      const MatMultDims& mat_mult_dims);
+
   // When doing a tiled GEMV in LLVM IR, a "tile" consists of this many vector
   // registers.
   int64 GetGemvTilingFactor() const {
@@ -21,6 +21,7 @@ limitations under the License.
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -210,11 +211,99 @@ Status IrEmitter::HandleCopy(HloInstruction* copy) {
     TF_RETURN_IF_ERROR(EmitTargetAddressForOp(copy));
     return EmitMemcpy(*(copy->operand(0)), *copy);
   } else {
+    string failure_reason;
+    TF_ASSIGN_OR_RETURN(bool successful,
+                        EmitTiledTranspose(copy, &failure_reason));
+    if (successful) {
+      VLOG(1) << "Emitted tiled transpose for " << copy->ToString();
+      return Status::OK();
+    }
+    VLOG(1) << "Could not emit tiled transpose for " << copy->ToString()
+            << ": " << failure_reason;
     // Use the elemental emitter for non-tuple shapes.
     return DefaultAction(copy);
   }
 }
 
+StatusOr<bool> IrEmitter::EmitTiledTranspose(HloInstruction* copy,
+                                             string* failure_reason) {
+  // The side of a tile, in elements. A tile of the operand and a tile of the
+  // result fit in the L1 cache for all element types.
+  const int64 kTileSize = 32;
+
+  const HloInstruction* operand = copy->operand(0);
+  const Shape& shape = copy->shape();
+  if (ShouldEmitParallelLoopFor(*copy)) {
+    *failure_reason = "parallel copies are emitted by the elemental emitter";
+    return false;
+  }
+  if (ShapeUtil::Rank(shape) < 2 || !LayoutUtil::HasLayout(operand->shape())) {
+    *failure_reason = "not a layout change of an array of rank 2 or more";
+    return false;
+  }
+  // Writes are contiguous along "write_dim" and reads along "read_dim".
+  const int64 write_dim = shape.layout().minor_to_major(0);
+  const int64 read_dim = operand->shape().layout().minor_to_major(0);
+  if (read_dim == write_dim) {
+    *failure_reason = "operand and result have the same minor dimension";
+    return false;
+  }
+  if (shape.dimensions(read_dim) < kTileSize ||
+      shape.dimensions(write_dim) < kTileSize) {
+    *failure_reason = "transposed dimensions are smaller than a tile";
+    return false;
+  }
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(copy));
+  llvm_ir::IrArray operand_array(GetIrArrayFor(operand));
+  llvm_ir::IrArray target_array(GetIrArrayFor(copy));
+
+  // The other dimensions, major to minor in the result, then the tiles, then
+  // the elements of a tile, writing a row of the result at a time.
+  llvm_ir::ForLoopNest loop_nest(IrName(copy), &ir_builder_);
+  llvm_ir::IrArray::Index index(ShapeUtil::Rank(shape));
+  for (int i = shape.layout().minor_to_major_size() - 1; i > 0; --i) {
+    const int64 dimension = shape.layout().minor_to_major(i);
+    if (dimension == read_dim) {
+      continue;
+    }
+    std::unique_ptr<llvm_ir::ForLoop> loop = loop_nest.AddLoop(
+        0, shape.dimensions(dimension),
+        tensorflow::strings::Printf("dim.%lld", dimension));
+    index[dimension] = loop->GetIndVarValue();
+  }
+  std::unique_ptr<llvm_ir::ForLoop> read_tile_loop =
+      loop_nest.AddLoop(0, shape.dimensions(read_dim), kTileSize,
+                        tensorflow::strings::Printf("tile.%lld", read_dim));
+  std::unique_ptr<llvm_ir::ForLoop> write_tile_loop =
+      loop_nest.AddLoop(0, shape.dimensions(write_dim), kTileSize,
+                        tensorflow::strings::Printf("tile.%lld", write_dim));
+  auto tile_end = [this](llvm::Value* tile_start, int64 dimension_size) {
+    llvm::Value* end =
+        ir_builder_.CreateAdd(tile_start, ir_builder_.getInt64(kTileSize));
+    llvm::Value* size = ir_builder_.getInt64(dimension_size);
+    return ir_builder_.CreateSelect(ir_builder_.CreateICmpULT(end, size), end,
+                                    size);
+  };
+  llvm::Value* read_start = read_tile_loop->GetIndVarValue();
+  llvm::Value* write_start = write_tile_loop->GetIndVarValue();
+  std::unique_ptr<llvm_ir::ForLoop> read_loop = loop_nest.AddLoop(
+      tensorflow::strings::Printf("dim.%lld", read_dim), read_start,
+      tile_end(read_start, shape.dimensions(read_dim)));
+  std::unique_ptr<llvm_ir::ForLoop> write_loop = loop_nest.AddLoop(
+      tensorflow::strings::Printf("dim.%lld", write_dim), write_start,
+      tile_end(write_start, shape.dimensions(write_dim)));
+  index[read_dim] = read_loop->GetIndVarValue();
+  index[write_dim] = write_loop->GetIndVarValue();
+
+  SetToFirstInsertPoint(loop_nest.GetInnerLoopBodyBasicBlock(), &ir_builder_);
+  llvm::Value* element =
+      operand_array.EmitReadArrayElement(index, &ir_builder_);
+  target_array.EmitWriteArrayElement(index, element, &ir_builder_);
+  SetToFirstInsertPoint(loop_nest.GetOuterLoopExitBasicBlock(), &ir_builder_);
+  return true;
+}
+
 // Calculate the alignment of a buffer with a particular size.
 int IrEmitter::MinimumAlignmentForBufferSize(int64 buffer_size) {
   // GLibc returns a pointer with alignment 8 on 32-bit platforms and 16 on
@@ -1670,6 +1759,149 @@ void IrEmitter::EmitShardedVectorStore(
   }
 }
 
+StatusOr<bool> IrEmitter::EmitVectorizedReduceOverMinorDimensions(
+    HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+    tensorflow::gtl::ArraySlice<int64> dimensions,
+    const ReductionGenerator& reduction_generator, string* failure_reason) {
+  // The number of vector accumulators. Independent accumulators hide the
+  // latency of the reduction operation.
+  const int64 kNumAccumulators = 4;
+
+  // Each output element reduces a contiguous block of the input if the reduced
+  // dimensions are the most minor ones.
+  const Layout& arg_layout = arg->shape().layout();
+  int64 block_size = 1;
+  for (int i = 0; i < dimensions.size(); ++i) {
+    const int64 dimension = arg_layout.minor_to_major(i);
+    if (std::find(dimensions.begin(), dimensions.end(), dimension) ==
+        dimensions.end()) {
+      *failure_reason = "reduced dimensions are not the most minor ones";
+      return false;
+    }
+    block_size *= arg->shape().dimensions(dimension);
+  }
+
+  const PrimitiveType element_type = reduce->shape().element_type();
+  const int vectorization_factor =
+      target_machine_features_.vectorization_factor_in_bytes() /
+      ShapeUtil::ByteSizeOfPrimitiveType(element_type);
+  const int64 tile_size = vectorization_factor * kNumAccumulators;
+  if (vectorization_factor < 2 || block_size < tile_size) {
+    *failure_reason = "reduced block is too small to vectorize";
+    return false;
+  }
+
+  unsigned element_alignment = tensorflow::MathUtil::GCD<unsigned>(
+      ShapeUtil::ByteSizeOfPrimitiveType(element_type),
+      MinimumAlignmentForPrimitiveType(element_type));
+  llvm::Type* element_ir_type =
+      llvm_ir::PrimitiveTypeToIrType(element_type, module_);
+  llvm::Type* vector_type =
+      llvm::VectorType::get(element_ir_type, vectorization_factor);
+  llvm_ir::IrArray arg_array(GetIrArrayFor(arg));
+
+  // The reduction is reassociated as
+  //
+  //  for (d in D) {
+  //    acc[k] = block[k * VS : (k + 1) * VS] for k in [0, NA)
+  //    for (i in [NA * VS, end of the last tile) with stride NA * VS) {
+  //      acc[k] = elementwise_reduce(acc[k], block[i + k * VS : ...])
+  //    }
+  //    result = reduce(init, horizontal_reduce(acc[0], ..., acc[NA - 1]))
+  //    result = reduce(result, remaining elements of block)
+  //    output[d] = result
+  //  }
+  //
+  // which is allowed since the order in which a reduction is applied is
+  // unspecified.
+  auto element_generator = [&](const llvm_ir::IrArray::Index& output_index)
+      -> StatusOr<llvm::Value*> {
+    llvm_ir::IrArray::Index input_index(arg->shape().dimensions_size());
+    auto it = output_index.begin();
+    for (int64 i = 0; i < input_index.size(); ++i) {
+      if (std::find(dimensions.begin(), dimensions.end(), i) !=
+          dimensions.end()) {
+        input_index[i] = ir_builder_.getInt64(0);
+      } else {
+        input_index[i] = *it++;
+      }
+    }
+    llvm::Value* block = ir_builder_.CreateBitCast(
+        arg_array.EmitArrayElementAddress(input_index, &ir_builder_),
+        element_ir_type->getPointerTo());
+    auto load = [&](llvm::Type* type, llvm::Value* offset) {
+      llvm::Value* address = ir_builder_.CreateBitCast(
+          ir_builder_.CreateInBoundsGEP(block, offset), type->getPointerTo());
+      llvm::LoadInst* value =
+          ir_builder_.CreateAlignedLoad(address, element_alignment);
+      arg_array.AnnotateLoadStoreInstructionWithMetadata(value);
+      return value;
+    };
+
+    std::vector<llvm::Value*> accumulators;
+    for (int64 k = 0; k < kNumAccumulators; ++k) {
+      accumulators.push_back(llvm_ir::EmitAllocaAtFunctionEntry(
+          vector_type, "accumulator", &ir_builder_, 0));
+      ir_builder_.CreateStore(
+          load(vector_type, ir_builder_.getInt64(k * vectorization_factor)),
+          accumulators.back());
+    }
+    const int64 tiles_end = block_size / tile_size * tile_size;
+    if (tiles_end > tile_size) {
+      llvm_ir::ForLoopNest loop_nest(IrName(reduce, "tiles"), &ir_builder_);
+      std::unique_ptr<llvm_ir::ForLoop> loop =
+          loop_nest.AddLoop(tile_size, tiles_end, tile_size, "tile");
+      SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &ir_builder_);
+      for (int64 k = 0; k < kNumAccumulators; ++k) {
+        llvm::Value* offset = ir_builder_.CreateAdd(
+            loop->GetIndVarValue(),
+            ir_builder_.getInt64(k * vectorization_factor));
+        ir_builder_.CreateStore(
+            reduction_generator(&ir_builder_,
+                                ir_builder_.CreateLoad(accumulators[k]),
+                                load(vector_type, offset)),
+            accumulators[k]);
+      }
+      SetToFirstInsertPoint(loop_nest.GetOuterLoopExitBasicBlock(),
+                            &ir_builder_);
+    }
+
+    llvm::Value* vector = ir_builder_.CreateLoad(accumulators[0]);
+    for (int64 k = 1; k < kNumAccumulators; ++k) {
+      vector = reduction_generator(&ir_builder_, vector,
+                                   ir_builder_.CreateLoad(accumulators[k]));
+    }
+    llvm::Value* result =
+        ir_builder_.CreateLoad(GetEmittedValueFor(init_value));
+    for (int i = 0; i < vectorization_factor; ++i) {
+      result = reduction_generator(&ir_builder_, result,
+                                   ir_builder_.CreateExtractElement(vector, i));
+    }
+
+    if (tiles_end < block_size) {
+      llvm::Value* result_address = llvm_ir::EmitAllocaAtFunctionEntry(
+          element_ir_type, "result", &ir_builder_, 0);
+      ir_builder_.CreateStore(result, result_address);
+      llvm_ir::ForLoopNest loop_nest(IrName(reduce, "remainder"),
+                                     &ir_builder_);
+      std::unique_ptr<llvm_ir::ForLoop> loop =
+          loop_nest.AddLoop(tiles_end, block_size, "remainder");
+      SetToFirstInsertPoint(loop->GetBodyBasicBlock(), &ir_builder_);
+      ir_builder_.CreateStore(
+          reduction_generator(&ir_builder_,
+                              ir_builder_.CreateLoad(result_address),
+                              load(element_ir_type, loop->GetIndVarValue())),
+          result_address);
+      SetToFirstInsertPoint(loop_nest.GetOuterLoopExitBasicBlock(),
+                            &ir_builder_);
+      result = ir_builder_.CreateLoad(result_address);
+    }
+    return result;
+  };
+  TF_RETURN_IF_ERROR(EmitTargetElementLoop(reduce, element_generator));
+  return true;
+}
+
 StatusOr<bool> IrEmitter::EmitVectorizedReduce(
     HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
     tensorflow::gtl::ArraySlice<int64> dimensions, HloComputation* function,
@@ -1697,9 +1929,21 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
       MinimumAlignmentForPrimitiveType(reduce->shape().element_type()));
 
   if (is_reduction_over_minor_dimension) {
-    // TODO(sanjoy): Implement vectorized reduction over the minor dimension.
-    *failure_reason = "reduction over minor dimension not implemented";
-    return false;
+    return EmitVectorizedReduceOverMinorDimensions(
+        reduce, arg, init_value, dimensions, reduction_generator,
+        failure_reason);
+  }
+
+  // If the reduction is the root of a parallel task, the outer dimensions of
+  // the output are partitioned by dynamic loop bounds. The innermost
+  // dimension is vectorized and cannot honour them.
+  std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds;
+  if (ShouldEmitParallelLoopFor(*reduce)) {
+    if (num_dynamic_loop_bounds_ >= reduce->shape().dimensions_size()) {
+      *failure_reason = "innermost dimension is partitioned";
+      return false;
+    }
+    dynamic_loop_bounds = compute_function_->GetDynamicLoopBounds();
   }
 
   CHECK(!ShapeUtil::IsTuple(reduce->shape()));
@@ -1726,14 +1970,24 @@ StatusOr<bool> IrEmitter::EmitVectorizedReduce(
   //  }
 
   llvm_ir::ForLoopNest loop_nest(IrName(reduce), &ir_builder_);
-  llvm_ir::IrArray::Index array_index(reduce->shape().dimensions_size());
+  const int64 num_dims = reduce->shape().dimensions_size();
+  llvm_ir::IrArray::Index array_index(num_dims);
   for (int i = reduce->shape().layout().minor_to_major_size() - 1; i > 0; --i) {
     int64 dimension = reduce->shape().layout().minor_to_major(i);
-    int64 start_index = 0;
-    int64 end_index = reduce->shape().dimensions(dimension);
-    std::unique_ptr<llvm_ir::ForLoop> loop =
-        loop_nest.AddLoop(start_index, end_index,
-                          tensorflow::strings::Printf("dim.%lld", dimension));
+    const int bounds_index = num_dims - 1 - i;
+    std::unique_ptr<llvm_ir::ForLoop> loop;
+    if (bounds_index < dynamic_loop_bounds.size()) {
+      loop = loop_nest.AddLoop(
+          /*suffix=*/tensorflow::strings::Printf("dim.%lld", dimension),
+          dynamic_loop_bounds[bounds_index].first,
+          dynamic_loop_bounds[bounds_index].second);
+    } else {
+      int64 start_index = 0;
+      int64 end_index = reduce->shape().dimensions(dimension);
+      loop = loop_nest.AddLoop(
+          start_index, end_index,
+          tensorflow::strings::Printf("dim.%lld", dimension));
+    }
     array_index[dimension] = loop->GetIndVarValue();
   }
 
@@ -2060,6 +2314,71 @@ Status IrEmitter::HandleDynamicUpdateSlice(
   return DefaultAction(dynamic_update_slice);
 }
 
+Status IrEmitter::HandleGather(HloInstruction* gather) {
+  // The elemental IR of gather reads only the gathered slices of the operand.
+  return DefaultAction(gather);
+}
+
+Status IrEmitter::HandleScatter(HloInstruction* scatter) {
+  const HloInstruction* operand = scatter->operand(0);
+  const HloInstruction* indices = scatter->operand(1);
+  const HloInstruction* updates = scatter->operand(2);
+
+  // The to_apply computation should have been emitted previously.
+  llvm::Function* to_apply_function =
+      FindOrDie(emitted_functions_, scatter->to_apply());
+
+  // Pseudo code for scatter:
+  //
+  // output = operand  // Unless they share a buffer.
+  // for (coordinates U in the updates) {
+  //   O = U with O[dimension] = indices[U[dimension]]
+  //   if O within bounds of output:
+  //     output(O) = to_apply(output(O), updates(U))
+  // }
+  //
+  // Only the updated elements of the output are touched when the scatter
+  // updates its operand in place.
+  if (llvm_ir::CanScatterInPlace(scatter, assignment_)) {
+    TF_RETURN_IF_ERROR(EmitTargetAddressForOp(scatter));
+  } else {
+    TF_RETURN_IF_ERROR(EmitTargetElementLoop(
+        scatter, /*desc=*/IrName(scatter, "copy"),
+        [this, operand](const llvm_ir::IrArray::Index& index) {
+          return GetIrArrayFor(operand).EmitReadArrayElement(index,
+                                                             &ir_builder_);
+        }));
+  }
+
+  llvm_ir::ForLoopNest loops(IrName(scatter), &ir_builder_);
+  const llvm_ir::IrArray::Index update_index =
+      loops.AddLoopsForShape(updates->shape(), "updates");
+  SetToFirstInsertPoint(loops.GetInnerLoopBodyBasicBlock(), &ir_builder_);
+
+  llvm_ir::IrArray::Index output_index;
+  llvm::Value* in_bounds;
+  std::tie(output_index, in_bounds) = llvm_ir::EmitScatterOutputIndex(
+      *scatter, GetIrArrayFor(indices), update_index, &ir_builder_);
+  llvm_ir::LlvmIfData if_in_bounds = llvm_ir::EmitIfThenElse(
+      in_bounds, "in_bounds", &ir_builder_, /*emit_else=*/false);
+  SetToFirstInsertPoint(if_in_bounds.true_block, &ir_builder_);
+
+  llvm_ir::IrArray output_array(GetIrArrayFor(scatter));
+  llvm::Value* output_value_address =
+      output_array.EmitArrayElementAddress(output_index, &ir_builder_);
+  llvm::Value* update_value_address =
+      GetIrArrayFor(updates).EmitArrayElementAddress(update_index,
+                                                     &ir_builder_);
+  llvm::Value* result = EmitElementFunctionCall(
+      to_apply_function,
+      ShapeUtil::MakeShape(scatter->shape().element_type(), {}),
+      {output_value_address, update_value_address}, "to_apply");
+  output_array.EmitWriteArrayElement(output_index, result, &ir_builder_);
+
+  SetToFirstInsertPoint(loops.GetOuterLoopExitBasicBlock(), &ir_builder_);
+  return Status::OK();
+}
+
 Status IrEmitter::HandleRecv(HloInstruction* recv) {
   // TODO(b/33942983): Support Send/Recv on CPU.
   return Unimplemented("Recv is not implemented on CPU. See b/33942983.");
@@ -181,6 +181,8 @@ class IrEmitter : public DfsHloVisitorWithDefault {
   Status HandleDynamicSlice(HloInstruction* dynamic_slice) override;
   Status HandleDynamicUpdateSlice(
       HloInstruction* dynamic_update_slice) override;
+  Status HandleGather(HloInstruction* gather) override;
+  Status HandleScatter(HloInstruction* scatter) override;
   Status HandleRecv(HloInstruction* recv) override;
   Status HandleRecvDone(HloInstruction* recv_done) override;
   Status HandlePad(HloInstruction* pad) override;
@@ -409,6 +411,24 @@ class IrEmitter : public DfsHloVisitorWithDefault {
       HloInstruction* arg, tensorflow::gtl::ArraySlice<int64> dimensions,
       unsigned element_alignment);
 
+  // Tries to emit a reduction of "arg" over its most minor dimensions, which
+  // reduces a contiguous block of the input into each output element with
+  // several vector accumulators.  Returns false and sets "failure_reason" if
+  // "dimensions" are not the most minor dimensions or the block is too small.
+  // Helper function for EmitVectorizedReduce.
+  StatusOr<bool> EmitVectorizedReduceOverMinorDimensions(
+      HloInstruction* reduce, HloInstruction* arg, HloInstruction* init_value,
+      tensorflow::gtl::ArraySlice<int64> dimensions,
+      const ReductionGenerator& reduction_generator, string* failure_reason);
+
+  // Tries to emit a copy that changes the layout of its operand as a transpose
+  // in square tiles, so that both the reads and the writes of a tile stay in
+  // cache.  Returns true if successful, and false on failure.  On failure,
+  // sets "failure_reason" to a string describing why it could not emit a
+  // tiled transpose.
+  StatusOr<bool> EmitTiledTranspose(HloInstruction* copy,
+                                    string* failure_reason);
+
   // Tries to emit a fast concatenate operation using memcpy.  Returns true if
   // successful, and false on failure.  On failure, sets "failure_reason" to a
   // string describing why it could not emit a fast concatenate.
@@ -396,9 +396,16 @@ Status ParallelCpuExecutable::ExecuteComputeFunctions(
     profile_counters = hlo_execution_profile->mutable_profile_counters();
   }
 
+  // The logical buffers assigned to the allocation of a donated parameter
+  // live in the buffer of the argument.
   std::vector<void*> buffer_pointers;
   buffer_pointers.reserve(buffers.size());
-  for (auto device_allocation : buffers) {
+  for (BufferAllocation::Index i = 0; i < buffers.size(); ++i) {
+    const BufferAllocation& allocation = assignment_->GetAllocation(i);
+    se::DeviceMemoryBase device_allocation =
+        allocation.is_donated_parameter()
+            ? arguments[allocation.parameter_number()]
+            : buffers[i];
     buffer_pointers.push_back(device_allocation.opaque());
   }
 
@@ -493,11 +500,15 @@ ParallelCpuExecutable::ExecuteOnStream(
   TF_RETURN_IF_ERROR(ExecuteComputeFunctions(
       run_options, arguments, device_allocations, hlo_execution_profile));
 
+  const se::DeviceMemoryBase result =
+      result_slice.allocation()->is_donated_parameter()
+          ? arguments[result_slice.allocation()->parameter_number()]
+          : device_allocations[result_index];
+
   // Mark the buffers that are actually live (used in the output) when the
   // computation finishes executing.
   std::unordered_set<const void*> marked_addresses;
-  MarkLiveAddressesInOutput(device_allocations[result_index].opaque(),
-                            result_shape(), &marked_addresses);
+  MarkLiveAddressesInOutput(result.opaque(), result_shape(), &marked_addresses);
 
   VLOG(3) << "Live addresses in output marking found "
           << marked_addresses.size() << " addresses:\n"
@@ -521,7 +532,7 @@ ParallelCpuExecutable::ExecuteOnStream(
     }
   }
 
-  return device_allocations[result_index];
+  return result;
 }
 
 StatusOr<std::unique_ptr<ShapedBuffer>> ParallelCpuExecutable::ExecuteOnStream(
@@ -552,7 +563,7 @@ StatusOr<std::unique_ptr<ShapedBuffer>> ParallelCpuExecutable::ExecuteOnStream(
   TF_RETURN_IF_ERROR(
       result_buffer->mutable_shape_index_to_buffer_entry()
           ->ForEachMutableElementWithStatus(
-              [&buffers, &buffers_in_result, &result_buffer, this](
+              [&arguments, &buffers, &buffers_in_result, &result_buffer, this](
                   const ShapeIndex& index, size_t* buffer_entry) {
                   const auto& sources =
                       this->GetRootPointsToSet().element(index);
@@ -566,14 +577,20 @@ StatusOr<std::unique_ptr<ShapedBuffer>> ParallelCpuExecutable::ExecuteOnStream(
                   // such as a tuple element.
 
                   // The source instruction should have a non-parameter buffer
-                  // assigned.
+                  // assigned, unless the buffer reuses a donated parameter.
                   TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice slice,
                                       this->assignment_->GetUniqueSlice(
                                           src, buffer_source->index()));
-                  CHECK(!slice.allocation()->is_entry_computation_parameter());
+                  const BufferAllocation* allocation = slice.allocation();
+                  CHECK(!allocation->is_entry_computation_parameter() ||
+                        allocation->is_donated_parameter());
 
                   const BufferAllocation::Index buffer_index = slice.index();
-                  const se::DeviceMemoryBase& buffer = buffers[buffer_index];
+                  const se::DeviceMemoryBase buffer =
+                      allocation->is_donated_parameter()
+                          ? arguments[allocation->parameter_number()]->buffer(
+                                /*index=*/{})
+                          : buffers[buffer_index];
                   CHECK(!buffer.is_null() || buffer.size() == 0);
                   *buffer_entry = result_buffer->mutable_buffers()->size();
                   result_buffer->mutable_buffers()->push_back(buffer);
@@ -127,14 +127,17 @@ int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
   // Currently, we do not assign parallel tasks to instructions with at least
   // one of the following properties:
   // *) Internal threading (library calls to kConv, kDot, and kCustomCall).
-  // *) Emit custom loops (kSelectAndScatter, FusionKind::kTransposeDot).
+  // *) Emit custom loops (kSelectAndScatter, kScatter, kDot emitted in LLVM IR,
+  //    FusionKind::kTransposeDot).
   // *) Tuple-shaped.
   // TODO(b/27458679) Parallelize instructions which are skipped here.
   if (instruction->opcode() == HloOpcode::kParameter ||
       instruction->opcode() == HloOpcode::kConstant ||
       instruction->opcode() == HloOpcode::kCall ||
       instruction->opcode() == HloOpcode::kCustomCall ||
+      instruction->opcode() == HloOpcode::kDot ||
       instruction->opcode() == HloOpcode::kSelectAndScatter ||
+      instruction->opcode() == HloOpcode::kScatter ||
       instruction->opcode() == HloOpcode::kGetTupleElement ||
       instruction->opcode() == HloOpcode::kBitcast ||
       (instruction->opcode() == HloOpcode::kConvolution &&
@@ -74,6 +74,17 @@ void __xla_cpu_runtime_ParallelForkJoin(
   // Compute partition stride in 'partitions' array.
   const int64 stride = 2 * num_partitioned_dims;
 
+  // Without a thread pool, e.g. for AOT-compiled code whose caller did not
+  // set one, run the partitions one after the other.
+  if (run_options->intra_op_thread_pool() == nullptr) {
+    for (int32 i = 0; i < num_partitions; ++i) {
+      function(result_ptr, run_options_ptr, params, temps,
+               &partitions[i * stride], prof_counters);
+    }
+    VLOG(2) << "ParallelForkJoin EXIT";
+    return;
+  }
+
   // Dispatch 'num_partitions - 1' compute functions to run in parallel.
   tensorflow::BlockingCounter bc(num_partitions - 1);
   for (int32 i = 1; i < num_partitions; ++i) {
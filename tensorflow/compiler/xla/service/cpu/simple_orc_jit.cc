@@ -115,7 +115,8 @@ SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions& target_options,
                            bool optimize_for_size, bool enable_fast_math,
                            bool disable_expensive_passes,
                            LLVMCompiler::ModuleHook pre_optimization_hook,
-                           LLVMCompiler::ModuleHook post_optimization_hook)
+                           LLVMCompiler::ModuleHook post_optimization_hook,
+                           const string& object_cache_dir)
     : target_machine_(
           CHECK_NOTNULL(llvm::EngineBuilder()
                             .setTargetOptions(target_options)
@@ -136,7 +137,8 @@ SimpleOrcJIT::SimpleOrcJIT(const llvm::TargetOptions& target_options,
                           optimize_for_size, enable_fast_math,
                           disable_expensive_passes, GetAvailableIntrinsics(),
                           std::move(pre_optimization_hook),
-                          std::move(post_optimization_hook))) {
+                          std::move(post_optimization_hook),
+                          object_cache_dir)) {
   VLOG(1) << "CPU target: " << target_machine_->getTargetCPU().str()
           << " features: " << target_machine_->getTargetFeatureString().str();
 }
@@ -64,11 +64,16 @@ class SimpleOrcJIT {
   // level optimizations are applied.
   // The |post_optimization_hook| is invoked on the module after all IR
   // level optimizations are applied.
+  // If |object_cache_dir| is non-empty, the object code of the modules is
+  // cached in that directory, and the modules identical to one that was
+  // already compiled, possibly by another process, are not compiled again.
+  // The hooks are not invoked for those modules.
   SimpleOrcJIT(const llvm::TargetOptions& target_options,
                llvm::CodeGenOpt::Level opt_level, bool optimize_for_size,
                bool enable_fast_math, bool disable_expensive_passes,
                LLVMCompiler::ModuleHook pre_optimization_hook,
-               LLVMCompiler::ModuleHook post_optimization_hook);
+               LLVMCompiler::ModuleHook post_optimization_hook,
+               const string& object_cache_dir = "");
 
   // Data layout this JIT was created with.
   const llvm::DataLayout& data_layout() const { return data_layout_; }
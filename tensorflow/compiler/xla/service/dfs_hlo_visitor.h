@@ -206,6 +206,8 @@ class DfsHloVisitorBase {
   virtual Status HandleSlice(HloInstructionPtr hlo) = 0;
   virtual Status HandleDynamicSlice(HloInstructionPtr hlo) = 0;
   virtual Status HandleDynamicUpdateSlice(HloInstructionPtr hlo) = 0;
+  virtual Status HandleGather(HloInstructionPtr hlo) = 0;
+  virtual Status HandleScatter(HloInstructionPtr hlo) = 0;
   virtual Status HandleTuple(HloInstructionPtr hlo) = 0;
   virtual Status HandleMap(HloInstructionPtr hlo) = 0;
   virtual Status HandleReduceWindow(HloInstructionPtr hlo) = 0;
@@ -134,6 +134,12 @@ class DfsHloVisitorWithDefaultBase
       HloInstructionPtr dynamic_update_slice) override {
     return DefaultAction(dynamic_update_slice);
   }
+  Status HandleGather(HloInstructionPtr gather) override {
+    return DefaultAction(gather);
+  }
+  Status HandleScatter(HloInstructionPtr scatter) override {
+    return DefaultAction(scatter);
+  }
   Status HandleTuple(HloInstructionPtr tuple) override {
     return DefaultAction(tuple);
   }
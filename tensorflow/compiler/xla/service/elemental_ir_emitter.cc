@@ -1397,6 +1397,54 @@ llvm_ir::ElementGenerator ElementalIrEmitter::MakeElementGenerator(
         }
         return operand_to_generator.at(input_hlo)(input_index);
       };
+    case HloOpcode::kGather:
+      return [this, hlo, &operand_to_generator](
+                 const IrArray::Index& index) -> StatusOr<llvm::Value*> {
+        const HloInstruction* operand = hlo->operand(0);
+        const HloInstruction* indices = hlo->operand(1);
+        const int64 dimension = hlo->indexed_dimension();
+
+        // Read the position along 'dimension' of the slice that holds the
+        // element.
+        llvm::Value* gather_index = index[dimension];
+        TF_ASSIGN_OR_RETURN(llvm::Value * position,
+                            operand_to_generator.at(indices)(
+                                IrArray::Index(1, gather_index)));
+        position->setName(AsStringRef(IrName(hlo, "position")));
+        llvm::Type* index_type = gather_index->getType();
+        const PrimitiveType indices_type = indices->shape().element_type();
+        position = primitive_util::IsSignedIntegralType(indices_type)
+                       ? ir_builder_->CreateSExtOrTrunc(position, index_type)
+                       : ir_builder_->CreateZExtOrTrunc(position, index_type);
+
+        // Security note: positions out of the bounds of the operand, including
+        // negative ones, read zero instead of memory outside of the operand.
+        llvm::Value* in_bounds = ir_builder_->CreateICmpULT(
+            position, llvm::ConstantInt::get(
+                          index_type, operand->shape().dimensions(dimension)));
+        llvm::Type* element_type = llvm_ir::PrimitiveTypeToIrType(
+            hlo->shape().element_type(), module_);
+        llvm::Value* ret_value_addr = llvm_ir::EmitAllocaAtFunctionEntry(
+            element_type, "ret_value_addr", ir_builder_);
+        llvm_ir::LlvmIfData if_data =
+            llvm_ir::EmitIfThenElse(in_bounds, "in_bounds", ir_builder_);
+
+        SetToFirstInsertPoint(if_data.true_block, ir_builder_);
+        IrArray::Index operand_index(index.size());
+        for (int64 i = 0; i < index.size(); ++i) {
+          operand_index[i] = i == dimension ? position : index[i];
+        }
+        TF_ASSIGN_OR_RETURN(llvm::Value * gathered_value,
+                            operand_to_generator.at(operand)(operand_index));
+        ir_builder_->CreateStore(gathered_value, ret_value_addr);
+
+        SetToFirstInsertPoint(if_data.false_block, ir_builder_);
+        ir_builder_->CreateStore(llvm::Constant::getNullValue(element_type),
+                                 ret_value_addr);
+
+        SetToFirstInsertPoint(if_data.after_block, ir_builder_);
+        return ir_builder_->CreateLoad(ret_value_addr);
+      };
     case HloOpcode::kDynamicUpdateSlice:
       return [this, hlo, &operand_to_generator](
                  const IrArray::Index& index) -> StatusOr<llvm::Value*> {
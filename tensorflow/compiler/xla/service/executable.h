@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -209,15 +210,21 @@ StatusOr<ReturnT> Executable::ExecuteOnStreamWrapper(
   }
 
   VLOG(1) << "enqueueing executable on stream...";
-  // If the profiling flag isn't enabled, we pass nullptr as the profile to
-  // indicate profiling is not requested.
+  // If the profiling flag isn't enabled and the caller did not ask for step
+  // stats, we pass nullptr as the profile to indicate profiling is not
+  // requested.
+  const bool print_hlo_profile =
+      module_config().debug_options().xla_hlo_profile();
+  tensorflow::DeviceStepStats* device_stats =
+      run_options->run_options().hlo_profile_device_stats();
   std::unique_ptr<HloExecutionProfile> profile_ptr =
-      module_config().debug_options().xla_hlo_profile() &&
+      (print_hlo_profile || device_stats != nullptr) &&
               hlo_profiling_enabled()
           ? MakeUnique<HloExecutionProfile>(&hlo_profile_printer(),
                                             &hlo_profile_index_map())
           : nullptr;
 
+  const int64 start_micros = tensorflow::Env::Default()->NowMicros();
   auto return_value =
       ExecuteOnStream(run_options, arguments, profile_ptr.get());
 
@@ -251,7 +258,11 @@ StatusOr<ReturnT> Executable::ExecuteOnStreamWrapper(
     }
   }
 
-  if (profile_ptr != nullptr) {
+  if (profile_ptr != nullptr && device_stats != nullptr) {
+    profile_ptr->AppendToDeviceStepStats(
+        stream->parent()->GetDeviceDescription(), start_micros, device_stats);
+  }
+  if (profile_ptr != nullptr && print_hlo_profile) {
     XLA_LOG_LINES(
         tensorflow::INFO,
         profile_ptr->ToString(stream->parent()->GetDeviceDescription()));
@@ -0,0 +1,145 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache.h"
+
+#include <map>
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace se = ::perftools::gputools;
+
+namespace xla {
+namespace gpu {
+
+AutotuneCache::AutotuneCache(const string& filename) : filename_(filename) {
+  if (filename_.empty()) {
+    return;
+  }
+  tensorflow::Env* env = tensorflow::Env::Default();
+  string contents;
+  if (!env->FileExists(filename_).ok() ||
+      !tensorflow::ReadFileToString(env, filename_, &contents).ok()) {
+    return;
+  }
+  tensorflow::mutex_lock lock(mu_);
+  for (const string& line : tensorflow::str_util::Split(contents, '\n')) {
+    const size_t tab = line.find('\t');
+    if (tab == string::npos) {
+      continue;
+    }
+    std::vector<int64> values;
+    bool ok = true;
+    for (const string& value : tensorflow::str_util::Split(
+             line.substr(0, tab), ' ', tensorflow::str_util::SkipEmpty())) {
+      int64 parsed;
+      ok = ok && tensorflow::strings::safe_strto64(value, &parsed);
+      values.push_back(parsed);
+    }
+    if (ok) {
+      results_[line.substr(tab + 1)] = std::move(values);
+    }
+  }
+  VLOG(1) << "Loaded " << results_.size() << " autotune results from "
+          << filename_;
+}
+
+/* static */ AutotuneCache* AutotuneCache::Get(const string& filename) {
+  static tensorflow::mutex* mu = new tensorflow::mutex;
+  static auto* caches = new std::map<string, AutotuneCache*>;
+  tensorflow::mutex_lock lock(*mu);
+  AutotuneCache*& cache = (*caches)[filename];
+  if (cache == nullptr) {
+    cache = new AutotuneCache(filename);
+  }
+  return cache;
+}
+
+/* static */ AutotuneCache* AutotuneCache::ForInstruction(
+    const HloInstruction* hlo) {
+  if (hlo == nullptr || hlo->parent() == nullptr ||
+      hlo->parent()->parent() == nullptr) {
+    return Get("");
+  }
+  return Get(hlo->parent()
+                 ->parent()
+                 ->config()
+                 .debug_options()
+                 .xla_gpu_autotune_cache_file());
+}
+
+/* static */ string AutotuneCache::DeviceModel(
+    se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& description =
+      stream_exec->GetDeviceDescription();
+  int cc_major = 0;
+  int cc_minor = 0;
+  description.cuda_compute_capability(&cc_major, &cc_minor);
+  return tensorflow::strings::StrCat(description.name(), " sm_", cc_major,
+                                     cc_minor);
+}
+
+bool AutotuneCache::Lookup(const string& key,
+                           std::vector<int64>* values) const {
+  tensorflow::mutex_lock lock(mu_);
+  auto it = results_.find(key);
+  if (it == results_.end()) {
+    return false;
+  }
+  *values = it->second;
+  return true;
+}
+
+void AutotuneCache::Insert(const string& key,
+                           const std::vector<int64>& values) {
+  DCHECK_EQ(string::npos, key.find_first_of("\t\n")) << key;
+  tensorflow::mutex_lock lock(mu_);
+  results_[key] = values;
+  if (!filename_.empty()) {
+    SaveLocked();
+  }
+}
+
+void AutotuneCache::SaveLocked() {
+  string contents;
+  for (const auto& result : results_) {
+    tensorflow::strings::StrAppend(
+        &contents, tensorflow::str_util::Join(result.second, " "), "\t",
+        result.first, "\n");
+  }
+  // Write to a temporary file first, so that a concurrent reader never sees
+  // a partial file.
+  tensorflow::Env* env = tensorflow::Env::Default();
+  const string tmp_filename =
+      tensorflow::strings::StrCat(filename_, ".tmp", env->NowMicros());
+  tensorflow::Status status =
+      tensorflow::WriteStringToFile(env, tmp_filename, contents);
+  if (status.ok()) {
+    status = env->RenameFile(tmp_filename, filename_);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to save the autotune results to " << filename_
+                 << ": " << status;
+  }
+}
+
+}  // namespace gpu
+}  // namespace xla
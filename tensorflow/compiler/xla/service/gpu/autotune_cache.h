@@ -0,0 +1,83 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace xla {
+namespace gpu {
+
+// Holds the algorithms that autotuning picked for cuDNN convolutions and
+// cuBLAS gemms, keyed by a string that describes the problem (shapes, element
+// type, layouts and the device model). Each result is a short list of
+// integers whose meaning is up to the thunk that stores it.
+//
+// If the cache has a file, the results in the file are loaded on
+// construction, and the whole cache is written back on every insertion, so
+// that other processes on the same kind of device skip the autotuning. The
+// file has one result per line: its integers separated by spaces, a tab, and
+// the key.
+//
+// This is thread-safe.
+class AutotuneCache {
+ public:
+  // Constructs a cache backed by "filename", or an in-memory cache if
+  // "filename" is empty. A missing or malformed file is not an error.
+  explicit AutotuneCache(const string& filename);
+
+  AutotuneCache(const AutotuneCache&) = delete;
+  AutotuneCache& operator=(const AutotuneCache&) = delete;
+
+  // Returns the process-wide cache backed by "filename".
+  static AutotuneCache* Get(const string& filename);
+
+  // Returns the process-wide cache backed by the file that the
+  // xla_gpu_autotune_cache_file debug option of the module of "hlo" names.
+  // "hlo" may be null.
+  static AutotuneCache* ForInstruction(const HloInstruction* hlo);
+
+  // Returns the part of a key that identifies the device of "stream_exec":
+  // its name and compute capability.
+  static string DeviceModel(perftools::gputools::StreamExecutor* stream_exec);
+
+  // Returns true and sets "values" if there is a result for "key".
+  bool Lookup(const string& key, std::vector<int64>* values) const;
+
+  // Stores "values" as the result for "key", and saves the cache to its file.
+  // Keys must not contain tabs or newlines.
+  void Insert(const string& key, const std::vector<int64>& values);
+
+ private:
+  void SaveLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const string filename_;
+
+  mutable tensorflow::mutex mu_;
+  std::unordered_map<string, std::vector<int64>> results_ GUARDED_BY(mu_);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_H_
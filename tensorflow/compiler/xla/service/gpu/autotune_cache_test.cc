@@ -0,0 +1,82 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache.h"
+
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class AutotuneCacheTest : public ::testing::Test {};
+
+TEST_F(AutotuneCacheTest, LooksUpInsertedResults) {
+  AutotuneCache cache("");
+  std::vector<int64> values;
+  EXPECT_FALSE(cache.Lookup("conv", &values));
+
+  cache.Insert("conv", {3, 1, 0, 0});
+  cache.Insert("gemm", {-4});
+  ASSERT_TRUE(cache.Lookup("conv", &values));
+  EXPECT_EQ(std::vector<int64>({3, 1, 0, 0}), values);
+  ASSERT_TRUE(cache.Lookup("gemm", &values));
+  EXPECT_EQ(std::vector<int64>({-4}), values);
+
+  cache.Insert("conv", {5, 0, 5, 0});
+  ASSERT_TRUE(cache.Lookup("conv", &values));
+  EXPECT_EQ(std::vector<int64>({5, 0, 5, 0}), values);
+}
+
+TEST_F(AutotuneCacheTest, PersistsResults) {
+  const string filename =
+      tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), "autotune");
+  {
+    AutotuneCache cache(filename);
+    cache.Insert("conv f32[1,2,3,4]{3,2,1,0} window {size: 3}", {3, 1, 0, 0});
+    cache.Insert("gemm", {-4});
+  }
+
+  AutotuneCache cache(filename);
+  std::vector<int64> values;
+  ASSERT_TRUE(
+      cache.Lookup("conv f32[1,2,3,4]{3,2,1,0} window {size: 3}", &values));
+  EXPECT_EQ(std::vector<int64>({3, 1, 0, 0}), values);
+  ASSERT_TRUE(cache.Lookup("gemm", &values));
+  EXPECT_EQ(std::vector<int64>({-4}), values);
+  EXPECT_FALSE(cache.Lookup("other", &values));
+}
+
+TEST_F(AutotuneCacheTest, IgnoresMalformedLines) {
+  const string filename =
+      tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), "malformed");
+  TF_ASSERT_OK(tensorflow::WriteStringToFile(
+      tensorflow::Env::Default(), filename,
+      "no tab\n1 x\tbad value\n7 8\tgood\n"));
+
+  AutotuneCache cache(filename);
+  std::vector<int64> values;
+  EXPECT_FALSE(cache.Lookup("no tab", &values));
+  EXPECT_FALSE(cache.Lookup("bad value", &values));
+  ASSERT_TRUE(cache.Lookup("good", &values));
+  EXPECT_EQ(std::vector<int64>({7, 8}), values);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
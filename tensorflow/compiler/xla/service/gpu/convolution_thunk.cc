@@ -17,8 +17,12 @@ limitations under the License.
 
 #include <string>
 
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/compiler/xla/window_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
@@ -122,6 +126,28 @@ tensorflow::Status ConvolutionThunk::ExecuteOnStream(
   VLOG(3) << "Dim nums: { " << dim_nums_.ShortDebugString() << " }";
   VLOG(3) << "Window: { " << window_.ShortDebugString() << " }";
 
+  BatchDescriptor input_descriptor;
+  FilterDescriptor filter_descriptor;
+  BatchDescriptor output_descriptor;
+  ConvolutionDescriptor convolution_descriptor;
+  MakeDescriptors(&input_descriptor, &filter_descriptor, &output_descriptor,
+                  &convolution_descriptor);
+
+  se::DeviceMemory<float> input_data(
+      buffer_allocations.GetDeviceAddress(input_buffer_));
+  se::DeviceMemory<float> filter_data(
+      buffer_allocations.GetDeviceAddress(filter_buffer_));
+  se::DeviceMemory<float> output_data(
+      buffer_allocations.GetDeviceAddress(output_buffer_));
+  return ConvolveWithTune(input_descriptor, input_data, filter_descriptor,
+                          filter_data, output_descriptor, output_data,
+                          convolution_descriptor, buffer_allocations, stream);
+}
+
+void ConvolutionThunk::MakeDescriptors(
+    BatchDescriptor* input_descriptor, FilterDescriptor* filter_descriptor,
+    BatchDescriptor* output_descriptor,
+    ConvolutionDescriptor* convolution_descriptor) const {
   const int num_dimensions = window_.dimensions_size();
   CHECK_LE(num_dimensions, 3);
   // cuDNN does not support 1D convolutions. We therefore express 1D
@@ -140,34 +166,34 @@ tensorflow::Status ConvolutionThunk::ExecuteOnStream(
 
   // cuDNN's convolution APIs support the BDYX layout for activations/output and
   // the OIYX layout for weights.
-  BatchDescriptor input_descriptor(effective_num_dimensions);
-  input_descriptor.set_layout(DataLayout::kBatchDepthYX)
+  *input_descriptor = BatchDescriptor(effective_num_dimensions);
+  input_descriptor->set_layout(DataLayout::kBatchDepthYX)
       .set_feature_map_count(
           input_shape_.dimensions(dim_nums_.input_feature_dimension()))
       .set_count(input_shape_.dimensions(dim_nums_.input_batch_dimension()));
   for (int dim = 0; dim < num_dimensions; ++dim) {
     // Note that the dimensions are reversed. The same holds below.
-    input_descriptor.set_spatial_dim(
+    input_descriptor->set_spatial_dim(
         static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
         input_shape_.dimensions(dim_nums_.input_spatial_dimensions(dim)));
   }
 
-  FilterDescriptor filter_descriptor(effective_num_dimensions);
-  filter_descriptor.set_layout(FilterLayout::kOutputInputYX)
+  *filter_descriptor = FilterDescriptor(effective_num_dimensions);
+  filter_descriptor->set_layout(FilterLayout::kOutputInputYX)
       .set_input_feature_map_count(
           filter_shape_.dimensions(dim_nums_.kernel_input_feature_dimension()))
       .set_output_feature_map_count(filter_shape_.dimensions(
           dim_nums_.kernel_output_feature_dimension()));
   for (int dim = 0; dim < num_dimensions; ++dim) {
-    filter_descriptor.set_spatial_dim(
+    filter_descriptor->set_spatial_dim(
         static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
         filter_shape_.dimensions(dim_nums_.kernel_spatial_dimensions(dim)));
   }
 
-  ConvolutionDescriptor convolution_descriptor(effective_num_dimensions);
+  *convolution_descriptor = ConvolutionDescriptor(effective_num_dimensions);
   for (int dim = 0; dim < num_dimensions; ++dim) {
     convolution_descriptor
-        .set_zero_padding(
+        ->set_zero_padding(
             static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
             window_.dimensions(dim).padding_low())
         .set_filter_stride(
@@ -175,36 +201,27 @@ tensorflow::Status ConvolutionThunk::ExecuteOnStream(
             window_.dimensions(dim).stride());
   }
 
-  BatchDescriptor output_descriptor(effective_num_dimensions);
-  output_descriptor.set_layout(DataLayout::kBatchDepthYX)
+  *output_descriptor = BatchDescriptor(effective_num_dimensions);
+  output_descriptor->set_layout(DataLayout::kBatchDepthYX)
       .set_feature_map_count(
           output_shape_.dimensions(dim_nums_.output_feature_dimension()))
       .set_count(output_shape_.dimensions(dim_nums_.output_batch_dimension()));
   for (int dim = 0; dim < num_dimensions; ++dim) {
-    output_descriptor.set_spatial_dim(
+    output_descriptor->set_spatial_dim(
         static_cast<se::dnn::DimIndex>(effective_num_dimensions - dim - 1),
         output_shape_.dimensions(dim_nums_.output_spatial_dimensions(dim)));
   }
 
   // Add a singleton dimension in the 1D convolution case.
   if (num_dimensions == 1) {
-    input_descriptor.set_spatial_dim(static_cast<se::dnn::DimIndex>(0), 1);
-    output_descriptor.set_spatial_dim(static_cast<se::dnn::DimIndex>(0), 1);
-    filter_descriptor.set_spatial_dim(static_cast<se::dnn::DimIndex>(0), 1);
+    input_descriptor->set_spatial_dim(static_cast<se::dnn::DimIndex>(0), 1);
+    output_descriptor->set_spatial_dim(static_cast<se::dnn::DimIndex>(0), 1);
+    filter_descriptor->set_spatial_dim(static_cast<se::dnn::DimIndex>(0), 1);
     convolution_descriptor
-        .set_zero_padding(static_cast<se::dnn::DimIndex>(0), 0)
+        ->set_zero_padding(static_cast<se::dnn::DimIndex>(0), 0)
         .set_filter_stride(static_cast<se::dnn::DimIndex>(0), 1);
   }
 
-  se::DeviceMemory<float> input_data(
-      buffer_allocations.GetDeviceAddress(input_buffer_));
-  se::DeviceMemory<float> filter_data(
-      buffer_allocations.GetDeviceAddress(filter_buffer_));
-  se::DeviceMemory<float> output_data(
-      buffer_allocations.GetDeviceAddress(output_buffer_));
-  return ConvolveWithTune(input_descriptor, input_data, filter_descriptor,
-                          filter_data, output_descriptor, output_data,
-                          convolution_descriptor, buffer_allocations, stream);
 }
 
 tensorflow::Status ConvolutionThunk::Convolve(
@@ -305,97 +322,183 @@ static bool ShouldIncludeWinogradNonfusedAlgo(
   return total_size < threshold;
 }
 
-tensorflow::Status ConvolutionThunk::ConvolveWithTune(
+string ConvolutionThunk::AutotuneCacheKey(
+    se::StreamExecutor* stream_exec) const {
+  return tensorflow::strings::StrCat(
+      "convolution ", ConvolutionKindToString(convolution_kind_), " ",
+      AutotuneCache::DeviceModel(stream_exec), " ",
+      ShapeUtil::HumanStringWithLayout(input_shape_), " ",
+      ShapeUtil::HumanStringWithLayout(filter_shape_), " ",
+      ShapeUtil::HumanStringWithLayout(output_shape_), " ",
+      window_util::ToString(window_), " ", dim_nums_.ShortDebugString());
+}
+
+tensorflow::Status ConvolutionThunk::PickBestAlgorithm(
     const BatchDescriptor& input_descriptor, se::DeviceMemory<float> input_data,
     const FilterDescriptor& filter_descriptor,
     se::DeviceMemory<float> filter_data,
     const BatchDescriptor& output_descriptor,
     se::DeviceMemory<float> output_data,
-    const ConvolutionDescriptor& convolution_descriptor,
-    const BufferAllocations& buffer_allocations, se::Stream* stream) {
+    const ConvolutionDescriptor& convolution_descriptor, int device_ordinal,
+    DeviceMemoryAllocator* memory_allocator, se::Stream* stream) {
   // TODO(b/29126320): Try cudnn v5's new auto-tuner when it's rolled out.
-  if (!best_algorithm_.has_value()) {
-    best_algorithm_.emplace();
-
-    // Auto-tuning either is disabled or only happens in the first run of this
-    // function.
-    VLOG(2) << "Profiling for best convolution algorithm used for "
-               "ConvolutionThunk: "
-            << this;
-
-    bool with_winograd_nonfused =
-        ShouldIncludeWinogradNonfusedAlgo(input_descriptor, output_descriptor);
-
-    se::dnn::ProfileResult best_result;
-    se::dnn::ProfileResult best_result_without_scratch;
-    std::vector<AlgorithmDesc> algorithms =
-        GetAlgorithms(with_winograd_nonfused, stream->parent());
-    for (auto algorithm : algorithms) {
-      ConvolveScratchAllocator scratch_allocator(
-          buffer_allocations.device_ordinal(),
-          buffer_allocations.memory_allocator());
-      se::dnn::ProfileResult profile_result;
-      VLOG(3) << "Trying algorithm " << AlgorithmToString(algorithm)
-              << " for ConvolutionThunk: " << this;
-      bool launch_ok =
-          Convolve(input_descriptor, input_data, filter_descriptor, filter_data,
-                   output_descriptor, output_data, convolution_descriptor,
-                   se::dnn::AlgorithmConfig(algorithm, algorithm), stream,
-                   &scratch_allocator, &profile_result)
-              .ok();
-      if (launch_ok && profile_result.is_valid()) {
-        VLOG(3) << "Run of algorithm " << AlgorithmToString(algorithm)
-                << " for ConvolutionThunk " << this << " succeeded, taking "
-                << profile_result.elapsed_time_in_ms()
-                << "ms. (Best result: " << best_result.elapsed_time_in_ms()
-                << "ms)";
-        if (profile_result.elapsed_time_in_ms() <
-            best_result.elapsed_time_in_ms()) {
-          best_result = profile_result;
-        }
-        if (scratch_allocator.TotalAllocatedBytes() == 0 &&
-            profile_result.elapsed_time_in_ms() <
-                best_result_without_scratch.elapsed_time_in_ms()) {
-          best_result_without_scratch = profile_result;
-        }
-      } else {
-        VLOG(3) << "Run of algorithm " << AlgorithmToString(algorithm)
-                << " for ConvolutionThunk " << this << " failed.";
-      }
-    }
+  AutotuneCache* cache = AutotuneCache::ForInstruction(hlo_instruction());
+  const string key = AutotuneCacheKey(stream->parent());
+  std::vector<int64> cached;
+  if (cache->Lookup(key, &cached) && cached.size() == 4) {
+    best_algorithm_.emplace(AlgorithmDesc(cached[0], cached[1] != 0),
+                            AlgorithmDesc(cached[2], cached[3] != 0));
+    VLOG(2) << "Found convolution algorithm ("
+            << AlgorithmToString(best_algorithm_->algorithm()) << ", "
+            << AlgorithmToString(best_algorithm_->algorithm_no_scratch())
+            << ") for ConvolutionThunk " << this << " in the autotune cache";
+    return tensorflow::Status::OK();
+  }
 
-    if (best_result.is_valid()) {
-      best_algorithm_->set_algorithm(best_result.algorithm());
+  best_algorithm_.emplace();
+  VLOG(2) << "Profiling for best convolution algorithm used for "
+             "ConvolutionThunk: "
+          << this;
+
+  bool with_winograd_nonfused =
+      ShouldIncludeWinogradNonfusedAlgo(input_descriptor, output_descriptor);
+
+  se::dnn::ProfileResult best_result;
+  se::dnn::ProfileResult best_result_without_scratch;
+  std::vector<AlgorithmDesc> algorithms =
+      GetAlgorithms(with_winograd_nonfused, stream->parent());
+  for (auto algorithm : algorithms) {
+    ConvolveScratchAllocator scratch_allocator(device_ordinal,
+                                               memory_allocator);
+    se::dnn::ProfileResult profile_result;
+    VLOG(3) << "Trying algorithm " << AlgorithmToString(algorithm)
+            << " for ConvolutionThunk: " << this;
+    bool launch_ok =
+        Convolve(input_descriptor, input_data, filter_descriptor, filter_data,
+                 output_descriptor, output_data, convolution_descriptor,
+                 se::dnn::AlgorithmConfig(algorithm, algorithm), stream,
+                 &scratch_allocator, &profile_result)
+            .ok();
+    if (launch_ok && profile_result.is_valid()) {
+      VLOG(3) << "Run of algorithm " << AlgorithmToString(algorithm)
+              << " for ConvolutionThunk " << this << " succeeded, taking "
+              << profile_result.elapsed_time_in_ms()
+              << "ms. (Best result: " << best_result.elapsed_time_in_ms()
+              << "ms)";
+      if (profile_result.elapsed_time_in_ms() <
+          best_result.elapsed_time_in_ms()) {
+        best_result = profile_result;
+      }
+      if (scratch_allocator.TotalAllocatedBytes() == 0 &&
+          profile_result.elapsed_time_in_ms() <
+              best_result_without_scratch.elapsed_time_in_ms()) {
+        best_result_without_scratch = profile_result;
+      }
     } else {
-      LOG(ERROR) << "No convolution algorithm works with profiling. Fall back "
-                    "to the default algorithm.";
-      best_algorithm_->set_algorithm(AlgorithmDesc());
+      VLOG(3) << "Run of algorithm " << AlgorithmToString(algorithm)
+              << " for ConvolutionThunk " << this << " failed.";
     }
+  }
 
-    if (best_result_without_scratch.is_valid()) {
-      best_algorithm_->set_algorithm_no_scratch(
-          best_result_without_scratch.algorithm());
-    } else {
-      LOG(ERROR) << "No convolution algorithm without scratch works with "
-                    "profiling. Fall back "
-                    "to the default algorithm.";
-      best_algorithm_->set_algorithm_no_scratch(AlgorithmDesc());
-    }
+  if (best_result.is_valid()) {
+    best_algorithm_->set_algorithm(best_result.algorithm());
+  } else {
+    LOG(ERROR) << "No convolution algorithm works with profiling. Fall back "
+                  "to the default algorithm.";
+    best_algorithm_->set_algorithm(AlgorithmDesc());
   }
 
-  {
-    VLOG(2) << "Using convolution algorithm ("
-            << AlgorithmToString(best_algorithm_->algorithm()) << ", "
-            << AlgorithmToString(best_algorithm_->algorithm_no_scratch())
-            << ") for ConvolutionThunk: " << this;
-    ConvolveScratchAllocator scratch_allocator(
+  if (best_result_without_scratch.is_valid()) {
+    best_algorithm_->set_algorithm_no_scratch(
+        best_result_without_scratch.algorithm());
+  } else {
+    LOG(ERROR) << "No convolution algorithm without scratch works with "
+                  "profiling. Fall back "
+                  "to the default algorithm.";
+    best_algorithm_->set_algorithm_no_scratch(AlgorithmDesc());
+  }
+
+  if (best_result.is_valid() && best_result_without_scratch.is_valid()) {
+    const AlgorithmDesc& algorithm = best_algorithm_->algorithm();
+    const AlgorithmDesc& algorithm_no_scratch =
+        best_algorithm_->algorithm_no_scratch();
+    cache->Insert(key, {algorithm.algo_id(), algorithm.tensor_ops_enabled(),
+                        algorithm_no_scratch.algo_id(),
+                        algorithm_no_scratch.tensor_ops_enabled()});
+  }
+  return tensorflow::Status::OK();
+}
+
+tensorflow::Status ConvolutionThunk::ConvolveWithTune(
+    const BatchDescriptor& input_descriptor, se::DeviceMemory<float> input_data,
+    const FilterDescriptor& filter_descriptor,
+    se::DeviceMemory<float> filter_data,
+    const BatchDescriptor& output_descriptor,
+    se::DeviceMemory<float> output_data,
+    const ConvolutionDescriptor& convolution_descriptor,
+    const BufferAllocations& buffer_allocations, se::Stream* stream) {
+  // Autotuning only happens here if Autotune was not called at compile time.
+  if (!best_algorithm_.has_value()) {
+    TF_RETURN_IF_ERROR(PickBestAlgorithm(
+        input_descriptor, input_data, filter_descriptor, filter_data,
+        output_descriptor, output_data, convolution_descriptor,
         buffer_allocations.device_ordinal(),
-        buffer_allocations.memory_allocator());
-    return Convolve(input_descriptor, input_data, filter_descriptor,
-                    filter_data, output_descriptor, output_data,
-                    convolution_descriptor, *best_algorithm_, stream,
-                    &scratch_allocator, nullptr);
+        buffer_allocations.memory_allocator(), stream));
+  }
+
+  VLOG(2) << "Using convolution algorithm ("
+          << AlgorithmToString(best_algorithm_->algorithm()) << ", "
+          << AlgorithmToString(best_algorithm_->algorithm_no_scratch())
+          << ") for ConvolutionThunk: " << this;
+  ConvolveScratchAllocator scratch_allocator(
+      buffer_allocations.device_ordinal(),
+      buffer_allocations.memory_allocator());
+  return Convolve(input_descriptor, input_data, filter_descriptor, filter_data,
+                  output_descriptor, output_data, convolution_descriptor,
+                  *best_algorithm_, stream, &scratch_allocator, nullptr);
+}
+
+tensorflow::Status ConvolutionThunk::Autotune(
+    se::Stream* stream, DeviceMemoryAllocator* memory_allocator) {
+  if (best_algorithm_.has_value()) {
+    return tensorflow::Status::OK();
+  }
+  BatchDescriptor input_descriptor;
+  FilterDescriptor filter_descriptor;
+  BatchDescriptor output_descriptor;
+  ConvolutionDescriptor convolution_descriptor;
+  MakeDescriptors(&input_descriptor, &filter_descriptor, &output_descriptor,
+                  &convolution_descriptor);
+
+  // The convolutions run on uninitialized buffers of the right sizes; their
+  // contents do not matter for timing.
+  const int device_ordinal = stream->parent()->device_ordinal();
+  std::vector<se::DeviceMemoryBase> buffers;
+  tensorflow::Status status;
+  for (const Shape* shape : {&input_shape_, &filter_shape_, &output_shape_}) {
+    StatusOr<se::DeviceMemoryBase> buffer = memory_allocator->Allocate(
+        device_ordinal, ShapeUtil::ByteSizeOf(*shape),
+        /*retry_on_failure=*/false);
+    if (!buffer.ok()) {
+      status = buffer.status();
+      break;
+    }
+    buffers.push_back(buffer.ValueOrDie());
+  }
+  if (status.ok()) {
+    status = PickBestAlgorithm(
+        input_descriptor, se::DeviceMemory<float>(buffers[0]),
+        filter_descriptor, se::DeviceMemory<float>(buffers[1]),
+        output_descriptor, se::DeviceMemory<float>(buffers[2]),
+        convolution_descriptor, device_ordinal, memory_allocator, stream);
+  }
+  if (status.ok()) {
+    status = stream->BlockHostUntilDone();
+  }
+  for (se::DeviceMemoryBase& buffer : buffers) {
+    TF_RETURN_IF_ERROR(memory_allocator->Deallocate(device_ordinal, &buffer));
   }
+  return status;
 }
 
 }  // namespace gpu
@@ -83,7 +83,7 @@ class ConvolutionThunk : public Thunk {
   ConvolutionThunk& operator=(const ConvolutionThunk&) = delete;
 
   // Does the convolution for the thunk on "stream". Auto-tuning happens on the
-  // first run of this function.
+  // first run of this function, unless Autotune was called before.
   tensorflow::Status ExecuteOnStream(
       const BufferAllocations& buffer_allocations,
       perftools::gputools::Stream* stream) override;
@@ -96,7 +96,39 @@ class ConvolutionThunk : public Thunk {
     return !best_algorithm_.has_value();
   }
 
+  // Picks the convolution algorithm for the device of "stream", running the
+  // candidates on buffers allocated from "memory_allocator".
+  tensorflow::Status Autotune(perftools::gputools::Stream* stream,
+                              DeviceMemoryAllocator* memory_allocator) override;
+
  private:
+  // Fills in the cuDNN descriptors of the convolution.
+  void MakeDescriptors(
+      perftools::gputools::dnn::BatchDescriptor* input_descriptor,
+      perftools::gputools::dnn::FilterDescriptor* filter_descriptor,
+      perftools::gputools::dnn::BatchDescriptor* output_descriptor,
+      perftools::gputools::dnn::ConvolutionDescriptor* convolution_descriptor)
+      const;
+
+  // Returns the key of the convolution in the AutotuneCache: its kind, shapes
+  // with layouts, window and dimension numbers, and the device model.
+  string AutotuneCacheKey(
+      perftools::gputools::StreamExecutor* stream_exec) const;
+
+  // Sets best_algorithm_ from the AutotuneCache, or else by profiling every
+  // algorithm on the given buffers and storing the result in the cache.
+  tensorflow::Status PickBestAlgorithm(
+      const perftools::gputools::dnn::BatchDescriptor& input_descriptor,
+      perftools::gputools::DeviceMemory<float> input_data,
+      const perftools::gputools::dnn::FilterDescriptor& filter_descriptor,
+      perftools::gputools::DeviceMemory<float> filter_data,
+      const perftools::gputools::dnn::BatchDescriptor& output_descriptor,
+      perftools::gputools::DeviceMemory<float> output_data,
+      const perftools::gputools::dnn::ConvolutionDescriptor&
+          convolution_descriptor,
+      int device_ordinal, DeviceMemoryAllocator* memory_allocator,
+      perftools::gputools::Stream* stream);
+
   tensorflow::Status ConvolveWithTune(
       const perftools::gputools::dnn::BatchDescriptor& input_descriptor,
       perftools::gputools::DeviceMemory<float> input_data,
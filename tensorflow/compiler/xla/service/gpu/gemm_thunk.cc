@@ -17,7 +17,11 @@ limitations under the License.
 
 #include <functional>
 
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/platform/types.h"
@@ -205,41 +209,26 @@ se::blas::ComputationType GetBlasComputationType(PrimitiveType type) {
   }
 }
 
-}  // namespace
-
-GemmThunk::GemmThunk(const BufferAllocation::Slice& lhs_buffer,
-                     const BufferAllocation::Slice& rhs_buffer,
-                     const BufferAllocation::Slice& output_buffer,
-                     const Shape& lhs_shape, const Shape& rhs_shape,
-                     const Shape& output_shape, bool transpose_lhs,
-                     bool transpose_rhs, const HloInstruction* hlo_instruction)
-    : Thunk(Kind::kGemm, hlo_instruction),
-      lhs_buffer_(lhs_buffer),
-      rhs_buffer_(rhs_buffer),
-      output_buffer_(output_buffer),
-      lhs_shape_(lhs_shape),
-      rhs_shape_(rhs_shape),
-      output_shape_(output_shape),
-      transpose_lhs_(transpose_lhs),
-      transpose_rhs_(transpose_rhs) {}
-
-tensorflow::Status GemmThunk::ExecuteOnStream(
-    const BufferAllocations& buffer_allocations, se::Stream* stream) {
-  VLOG(2) << "Executing a GemmThunk";
-
-  se::DeviceMemoryBase lhs_data =
-      buffer_allocations.GetDeviceAddress(lhs_buffer_);
-  se::DeviceMemoryBase rhs_data =
-      buffer_allocations.GetDeviceAddress(rhs_buffer_);
-  se::DeviceMemoryBase output_data =
-      buffer_allocations.GetDeviceAddress(output_buffer_);
+// The operands of the cuBLAS gemm that computes a GemmThunk, in the order the
+// gemm takes them.
+struct GemmOperands {
+  MatrixDescriptor lhs;
+  MatrixDescriptor rhs;
+  MatrixDescriptor output;
+};
 
+GemmOperands MakeGemmOperands(se::DeviceMemoryBase lhs_data,
+                              se::DeviceMemoryBase rhs_data,
+                              se::DeviceMemoryBase output_data,
+                              const Shape& lhs_shape, const Shape& rhs_shape,
+                              const Shape& output_shape, bool transpose_lhs,
+                              bool transpose_rhs) {
   // BLAS gemm reduces rows of LHS and columns of RHS. The Dot operator between
   // matrices reduces dimension 1 of LHS and dimension 0 of RHS regardless of
   // their layout. Therefore, we should treat dimension 0 as row and dimension 1
   // as column when mapping a matrix Dot to BLAS gemm.
-  int64 output_num_rows = output_shape_.dimensions(0);
-  int64 output_num_cols = output_shape_.dimensions(1);
+  int64 output_num_rows = output_shape.dimensions(0);
+  int64 output_num_cols = output_shape.dimensions(1);
 
   // BLAS gemm expects the inputs and the output are in column-major order.
   // Therefore, we need to convert dot between row-major matrices to that
@@ -262,74 +251,140 @@ tensorflow::Status GemmThunk::ExecuteOnStream(
   // the leading dimension of the LHS matrix of gemm is the number of rows in
   // B^T and thus the number of columns in B.
 
-  auto make_descriptor = [this](se::DeviceMemoryBase data, const Shape& shape,
-                                bool transpose) -> MatrixDescriptor {
+  auto make_descriptor = [&output_shape](se::DeviceMemoryBase data,
+                                         const Shape& shape,
+                                         bool transpose) -> MatrixDescriptor {
     bool is_row_major = shape.layout().minor_to_major(0) != 0;
     bool layout_mismatch = shape.layout().minor_to_major(0) !=
-                           output_shape_.layout().minor_to_major(0);
+                           output_shape.layout().minor_to_major(0);
     return MatrixDescriptor(data, transpose ^ layout_mismatch,
                             shape.dimensions(is_row_major),
                             shape.dimensions(!is_row_major));
   };
 
   const MatrixDescriptor lhs_descriptor =
-      make_descriptor(lhs_data, lhs_shape_, transpose_lhs_);
+      make_descriptor(lhs_data, lhs_shape, transpose_lhs);
   const MatrixDescriptor rhs_descriptor =
-      make_descriptor(rhs_data, rhs_shape_, transpose_rhs_);
-
-  // Dispatches to a regular cublas gemm, a gemm-with-algorithm, or attempts to
-  // autotune this gemm to figure out the best algorithm.
-  auto launch = [this](MatrixDescriptor lhs_matrix, MatrixDescriptor rhs_matrix,
-                       MatrixDescriptor output_matrix, se::Stream* stream) {
-    PrimitiveType element_type = output_shape_.element_type();
-    se::blas::ComputationType computation_type =
-        GetBlasComputationType(element_type);
-
-    const string& device_name = stream->parent()->GetDeviceDescription().name();
-    auto autotune_it = autotune_results_.find(device_name);
-    if (autotune_it == autotune_results_.end()) {
-      StatusOr<se::blas::AlgorithmType> best_algorithm =
-          GetGemmAutotuneFn(element_type)(lhs_matrix, rhs_matrix, output_matrix,
-                                          computation_type, stream);
-      autotune_it =
-          autotune_results_.insert({device_name, best_algorithm}).first;
-
-      if (autotune_it->second.ok()) {
-        VLOG(2) << "Autotune on GemmThunk " << this
-                << " successful; best algorithm is "
-                << best_algorithm.ValueOrDie();
-      } else {
-        VLOG(2) << "Autotune on GemmThunk " << this
-                << " unsuccessful.  Will use generic gemm.";
-      }
-    }
+      make_descriptor(rhs_data, rhs_shape, transpose_rhs);
+  if (output_shape.layout().minor_to_major(0) == 0) {
+    return {lhs_descriptor, rhs_descriptor,
+            MatrixDescriptor(output_data, false, output_num_rows,
+                             output_num_cols)};
+  }
+  return {rhs_descriptor, lhs_descriptor,
+          MatrixDescriptor(output_data, false, output_num_cols,
+                           output_num_rows)};
+}
 
-    const StatusOr<se::blas::AlgorithmType>& best_algorithm =
-        autotune_it->second;
-    if (best_algorithm.ok()) {
-      auto algorithm = best_algorithm.ValueOrDie();
-      VLOG(2) << "Using algorithm " << algorithm
-              << " chosen by autotuning on GemmThunk " << this;
-      return GetGemmWithAlgorithmFn(element_type)(
-          lhs_matrix, rhs_matrix, output_matrix, computation_type, algorithm,
-          stream,
-          /*output_profile_result=*/nullptr);
+// Returns the key of a gemm in the AutotuneCache.
+string GemmAutotuneCacheKey(const GemmOperands& operands, PrimitiveType type,
+                            se::StreamExecutor* stream_exec) {
+  return tensorflow::strings::StrCat(
+      "gemm ", PrimitiveType_Name(type), " ",
+      AutotuneCache::DeviceModel(stream_exec), " ", operands.lhs.transpose,
+      operands.rhs.transpose, " ", operands.lhs.num_rows, "x",
+      operands.lhs.num_cols, " ", operands.rhs.num_rows, "x",
+      operands.rhs.num_cols, " ", operands.output.num_rows, "x",
+      operands.output.num_cols);
+}
+
+}  // namespace
+
+GemmThunk::GemmThunk(const BufferAllocation::Slice& lhs_buffer,
+                     const BufferAllocation::Slice& rhs_buffer,
+                     const BufferAllocation::Slice& output_buffer,
+                     const Shape& lhs_shape, const Shape& rhs_shape,
+                     const Shape& output_shape, bool transpose_lhs,
+                     bool transpose_rhs, const HloInstruction* hlo_instruction)
+    : Thunk(Kind::kGemm, hlo_instruction),
+      lhs_buffer_(lhs_buffer),
+      rhs_buffer_(rhs_buffer),
+      output_buffer_(output_buffer),
+      lhs_shape_(lhs_shape),
+      rhs_shape_(rhs_shape),
+      output_shape_(output_shape),
+      transpose_lhs_(transpose_lhs),
+      transpose_rhs_(transpose_rhs) {}
+
+const StatusOr<se::blas::AlgorithmType>& GemmThunk::GetAutotuneResult(
+    se::DeviceMemoryBase lhs_data, se::DeviceMemoryBase rhs_data,
+    se::DeviceMemoryBase output_data, se::Stream* stream) {
+  const string& device_name = stream->parent()->GetDeviceDescription().name();
+  auto autotune_it = autotune_results_.find(device_name);
+  if (autotune_it != autotune_results_.end()) {
+    return autotune_it->second;
+  }
+
+  PrimitiveType element_type = output_shape_.element_type();
+  const GemmOperands operands =
+      MakeGemmOperands(lhs_data, rhs_data, output_data, lhs_shape_, rhs_shape_,
+                       output_shape_, transpose_lhs_, transpose_rhs_);
+  AutotuneCache* cache = AutotuneCache::ForInstruction(hlo_instruction());
+  const string key =
+      GemmAutotuneCacheKey(operands, element_type, stream->parent());
+  std::vector<int64> cached;
+  if (cache->Lookup(key, &cached) && cached.size() == 1) {
+    StatusOr<se::blas::AlgorithmType> best_algorithm = cached[0];
+    if (cached[0] == se::blas::kNoAlgorithm) {
+      best_algorithm = InternalError(
+          "The autotune cache has no cuBLAS gemm algorithm for %s",
+          key.c_str());
     }
-    return GetGemmFn(element_type)(lhs_matrix, rhs_matrix, output_matrix,
-                                   stream);
-  };
+    VLOG(2) << "Found the autotune result of GemmThunk " << this
+            << " in the autotune cache";
+    return autotune_results_.insert({device_name, best_algorithm})
+        .first->second;
+  }
+
+  StatusOr<se::blas::AlgorithmType> best_algorithm =
+      GetGemmAutotuneFn(element_type)(operands.lhs, operands.rhs,
+                                      operands.output,
+                                      GetBlasComputationType(element_type),
+                                      stream);
+  if (best_algorithm.ok()) {
+    VLOG(2) << "Autotune on GemmThunk " << this
+            << " successful; best algorithm is "
+            << best_algorithm.ValueOrDie();
+    cache->Insert(key, {best_algorithm.ValueOrDie()});
+  } else {
+    VLOG(2) << "Autotune on GemmThunk " << this
+            << " unsuccessful.  Will use generic gemm.";
+    cache->Insert(key, {se::blas::kNoAlgorithm});
+  }
+  return autotune_results_.insert({device_name, best_algorithm}).first->second;
+}
+
+tensorflow::Status GemmThunk::ExecuteOnStream(
+    const BufferAllocations& buffer_allocations, se::Stream* stream) {
+  VLOG(2) << "Executing a GemmThunk";
 
+  se::DeviceMemoryBase lhs_data =
+      buffer_allocations.GetDeviceAddress(lhs_buffer_);
+  se::DeviceMemoryBase rhs_data =
+      buffer_allocations.GetDeviceAddress(rhs_buffer_);
+  se::DeviceMemoryBase output_data =
+      buffer_allocations.GetDeviceAddress(output_buffer_);
+
+  // Dispatches to a regular cublas gemm, or to a gemm-with-algorithm if
+  // autotuning found the best algorithm for this gemm.
+  PrimitiveType element_type = output_shape_.element_type();
+  const GemmOperands operands =
+      MakeGemmOperands(lhs_data, rhs_data, output_data, lhs_shape_, rhs_shape_,
+                       output_shape_, transpose_lhs_, transpose_rhs_);
+  const StatusOr<se::blas::AlgorithmType>& best_algorithm =
+      GetAutotuneResult(lhs_data, rhs_data, output_data, stream);
   bool launch_ok;
-  if (output_shape_.layout().minor_to_major(0) == 0) {
-    launch_ok = launch(
-        lhs_descriptor, rhs_descriptor,
-        MatrixDescriptor(output_data, false, output_num_rows, output_num_cols),
-        stream);
+  if (best_algorithm.ok()) {
+    auto algorithm = best_algorithm.ValueOrDie();
+    VLOG(2) << "Using algorithm " << algorithm
+            << " chosen by autotuning on GemmThunk " << this;
+    launch_ok = GetGemmWithAlgorithmFn(element_type)(
+        operands.lhs, operands.rhs, operands.output,
+        GetBlasComputationType(element_type), algorithm, stream,
+        /*output_profile_result=*/nullptr);
   } else {
-    launch_ok = launch(
-        rhs_descriptor, lhs_descriptor,
-        MatrixDescriptor(output_data, false, output_num_cols, output_num_rows),
-        stream);
+    launch_ok = GetGemmFn(element_type)(operands.lhs, operands.rhs,
+                                        operands.output, stream);
   }
 
   if (!launch_ok) {
@@ -338,5 +393,32 @@ tensorflow::Status GemmThunk::ExecuteOnStream(
   return tensorflow::Status::OK();
 }
 
+tensorflow::Status GemmThunk::Autotune(
+    se::Stream* stream, DeviceMemoryAllocator* memory_allocator) {
+  // The gemms run on uninitialized buffers of the right sizes; their contents
+  // do not matter for timing.
+  const int device_ordinal = stream->parent()->device_ordinal();
+  std::vector<se::DeviceMemoryBase> buffers;
+  for (const Shape* shape : {&lhs_shape_, &rhs_shape_, &output_shape_}) {
+    StatusOr<se::DeviceMemoryBase> buffer = memory_allocator->Allocate(
+        device_ordinal, ShapeUtil::ByteSizeOf(*shape),
+        /*retry_on_failure=*/false);
+    if (!buffer.ok()) {
+      break;
+    }
+    buffers.push_back(buffer.ValueOrDie());
+  }
+  tensorflow::Status status;
+  if (buffers.size() == 3) {
+    GetAutotuneResult(buffers[0], buffers[1], buffers[2], stream);
+    status = stream->BlockHostUntilDone();
+  }
+  // If the buffers don't fit, the first execution autotunes instead.
+  for (se::DeviceMemoryBase& buffer : buffers) {
+    TF_RETURN_IF_ERROR(memory_allocator->Deallocate(device_ordinal, &buffer));
+  }
+  return status;
+}
+
 }  // namespace gpu
 }  // namespace xla
@@ -58,10 +58,24 @@ class GemmThunk : public Thunk {
   bool ShouldHaltAllActivityBeforeRunning(
       perftools::gputools::Stream* stream) override {
     return autotune_results_.count(
-               stream->parent()->GetDeviceDescription().name()) != 0;
+               stream->parent()->GetDeviceDescription().name()) == 0;
   }
 
+  // Picks the cuBLAS gemm algorithm for the device of "stream", running the
+  // candidates on buffers allocated from "memory_allocator".
+  tensorflow::Status Autotune(perftools::gputools::Stream* stream,
+                              DeviceMemoryAllocator* memory_allocator) override;
+
  private:
+  // Returns the autotune result for the device of "stream". It comes from
+  // autotune_results_, or else from the AutotuneCache, or else from profiling
+  // the algorithms on the given buffers, which stores it in the cache.
+  const StatusOr<perftools::gputools::blas::AlgorithmType>& GetAutotuneResult(
+      perftools::gputools::DeviceMemoryBase lhs_data,
+      perftools::gputools::DeviceMemoryBase rhs_data,
+      perftools::gputools::DeviceMemoryBase output_data,
+      perftools::gputools::Stream* stream);
+
   const BufferAllocation::Slice lhs_buffer_;
   const BufferAllocation::Slice rhs_buffer_;
   const BufferAllocation::Slice output_buffer_;
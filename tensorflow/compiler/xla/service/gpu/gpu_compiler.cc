@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/buffer_liveness.h"
 #include "tensorflow/compiler/xla/service/call_inliner.h"
+#include "tensorflow/compiler/xla/service/device_memory_allocator.h"
 #include "tensorflow/compiler/xla/service/dot_decomposer.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
 #include "tensorflow/compiler/xla/service/gpu/convolution_folding.h"
@@ -38,6 +39,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_copy_insertion.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_layout_assignment.h"
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_schedule.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
@@ -48,21 +50,26 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/partition_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk_schedule.h"
+#include "tensorflow/compiler/xla/service/heap_simulator.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_constant_folding.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_cse.h"
 #include "tensorflow/compiler/xla/service/hlo_dce.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/service/hlo_proto_util.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
+#include "tensorflow/compiler/xla/service/hlo_scheduling.h"
 #include "tensorflow/compiler/xla/service/hlo_subcomputation_unification.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
 #include "tensorflow/compiler/xla/service/reduce_precision_insertion.h"
 #include "tensorflow/compiler/xla/service/reshape_mover.h"
 #include "tensorflow/compiler/xla/service/transpose_folding.h"
+#include "tensorflow/compiler/xla/service/tuple_points_to_analysis.h"
 #include "tensorflow/compiler/xla/service/tuple_simplifier.h"
 #include "tensorflow/compiler/xla/service/while_loop_simplifier.h"
 #include "tensorflow/compiler/xla/status_macros.h"
@@ -71,6 +78,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cuda_libdevice_path.h"
 #include "tensorflow/core/platform/env.h"
@@ -91,6 +99,7 @@ namespace gpu {
 namespace {
 
 using tensorflow::port::Tracing;
+using tensorflow::strings::HumanReadableNumBytes;
 using tensorflow::strings::StrCat;
 
 // Any address of a variable residing in global memory or returned by one of the
@@ -193,6 +202,12 @@ tensorflow::Status OptimizeHloModule(
       // fuse the new ReducePrecision operations.
       TF_RETURN_IF_ERROR(fusion.Run(hlo_module).status());
     }
+
+    // Fuse the siblings that are left by the vertical fusion passes.
+    HloPassPipeline horizontal_fusion("horizontal-fusion");
+    horizontal_fusion.AddInvariantChecker<HloVerifier>(shape_size_function);
+    horizontal_fusion.AddPass<HorizontalFusion>();
+    TF_RETURN_IF_ERROR(horizontal_fusion.Run(hlo_module).status());
   }
   return tensorflow::Status::OK();
 }
@@ -292,6 +307,133 @@ StatusOr<std::vector<uint8>> CompilePtx(const string& ptx, int cc_major,
   return cubin_vector;
 }
 
+// Returns the peak memory of "module" when its computations run in
+// "sequence", with the buffers packed by the HeapSimulator as BufferAssigner
+// packs them.
+StatusOr<int64> SimulatePeakMemory(
+    const HloModule& module,
+    const SequentialHloOrdering::HloModuleSequence& sequence,
+    const LogicalBuffer::SizeFunction& buffer_size) {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<TuplePointsToAnalysis> points_to_analysis,
+                      TuplePointsToAnalysis::Run(&module));
+  TF_ASSIGN_OR_RETURN(
+      const HeapSimulator::Result result,
+      HeapSimulator::Run(
+          MakeUnique<DecreasingSizeRunsHeap>(
+              MakeUnique<LazyBestFitHeap>(kMemoryAlignment)),
+          module, sequence, *points_to_analysis, buffer_size));
+  return result.heap_size;
+}
+
+StatusOr<float> CountFlops(
+    const HloModule& module,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size_function) {
+  HloCostAnalysis cost_analysis(shape_size_function);
+  TF_RETURN_IF_ERROR(module.entry_computation()->Accept(&cost_analysis));
+  return cost_analysis.flop_count();
+}
+
+// Rematerializes instructions of "hlo_module" until its simulated peak memory
+// fits in the limit that the xla_gpu_rematerialization_memory_limit_bytes debug
+// option sets, or in the free memory of "stream_exec" if the option is
+// negative. If it rematerializes, "sequence" is set to the order in which the
+// instructions must run to stay within the limit; otherwise it is left empty.
+tensorflow::Status RematerializeToFitMemoryLimit(
+    HloModule* hlo_module, se::StreamExecutor* stream_exec,
+    const HloCostAnalysis::ShapeSizeFunction& shape_size_function,
+    SequentialHloOrdering::HloModuleSequence* sequence) {
+  int64 memory_limit = hlo_module->config()
+                           .debug_options()
+                           .xla_gpu_rematerialization_memory_limit_bytes();
+  if (memory_limit == 0) {
+    return tensorflow::Status::OK();
+  }
+  if (memory_limit < 0) {
+    int64 free_bytes;
+    int64 total_bytes;
+    if (!stream_exec->DeviceMemoryUsage(&free_bytes, &total_bytes)) {
+      LOG(WARNING) << "Couldn't get the free memory of the device; not "
+                      "rematerializing "
+                   << hlo_module->name();
+      return tensorflow::Status::OK();
+    }
+    memory_limit = free_bytes;
+  }
+
+  auto buffer_size = [&shape_size_function](const LogicalBuffer& buffer) {
+    return shape_size_function(buffer.shape());
+  };
+  TF_ASSIGN_OR_RETURN(
+      const SequentialHloOrdering::HloModuleSequence default_sequence,
+      CreateMemoryMinimizingSequence(*hlo_module, buffer_size));
+  TF_ASSIGN_OR_RETURN(
+      const int64 peak_before,
+      SimulatePeakMemory(*hlo_module, default_sequence, buffer_size));
+  if (peak_before <= memory_limit) {
+    VLOG(1) << "Simulated peak memory of " << hlo_module->name() << " is "
+            << HumanReadableNumBytes(peak_before) << ", within the limit of "
+            << HumanReadableNumBytes(memory_limit);
+    return tensorflow::Status::OK();
+  }
+
+  TF_ASSIGN_OR_RETURN(const float flops_before,
+                      CountFlops(*hlo_module, shape_size_function));
+  TF_RETURN_IF_ERROR(HloRematerialization::RematerializeAndSchedule(
+                         shape_size_function, memory_limit, hlo_module,
+                         sequence)
+                         .status());
+  TF_ASSIGN_OR_RETURN(const int64 peak_after,
+                      SimulatePeakMemory(*hlo_module, *sequence, buffer_size));
+  TF_ASSIGN_OR_RETURN(const float flops_after,
+                      CountFlops(*hlo_module, shape_size_function));
+  LOG(INFO) << "Rematerialized " << hlo_module->name() << " to fit in "
+            << HumanReadableNumBytes(memory_limit)
+            << ": simulated peak memory went from "
+            << HumanReadableNumBytes(peak_before) << " to "
+            << HumanReadableNumBytes(peak_after) << " ("
+            << HumanReadableNumBytes(peak_before - peak_after)
+            << " saved) for " << flops_after - flops_before << " more flops ("
+            << (flops_before > 0
+                    ? 100.0 * (flops_after - flops_before) / flops_before
+                    : 0.0)
+            << "%)";
+  if (peak_after > memory_limit) {
+    LOG(WARNING) << "The simulated peak memory of " << hlo_module->name()
+                 << ", " << HumanReadableNumBytes(peak_after)
+                 << ", still exceeds the limit of "
+                 << HumanReadableNumBytes(memory_limit);
+  }
+  return tensorflow::Status::OK();
+}
+
+// Runs the autotuning of the library calls of the thunks in "thunk_schedule"
+// on "stream_exec". This is not fatal when it fails: the thunks that are not
+// autotuned here autotune on their first run instead.
+void AutotuneThunks(const ThunkSchedule& thunk_schedule,
+                    se::StreamExecutor* stream_exec) {
+  XLA_SCOPED_LOGGING_TIMER("GpuCompiler::RunBackend - Autotune");
+  auto platform =
+      se::MultiPlatformManager::PlatformWithId(se::cuda::kCudaPlatformId);
+  if (!platform.ok()) {
+    LOG(WARNING) << "Couldn't autotune at compile time: " << platform.status();
+    return;
+  }
+  // The allocator indexes its executors by device ordinal.
+  std::vector<se::StreamExecutor*> stream_executors(
+      stream_exec->device_ordinal() + 1, nullptr);
+  stream_executors[stream_exec->device_ordinal()] = stream_exec;
+  StreamExecutorMemoryAllocator memory_allocator(platform.ValueOrDie(),
+                                                 stream_executors);
+  se::Stream stream(stream_exec);
+  stream.Init();
+  for (Thunk* thunk : thunk_schedule.TotalOrder()) {
+    Status status = thunk->Autotune(&stream, &memory_allocator);
+    if (!status.ok()) {
+      LOG(WARNING) << "Couldn't autotune thunk at compile time: " << status;
+    }
+  }
+}
+
 }  // namespace
 
 GpuCompiler::GpuCompiler()
@@ -335,10 +477,24 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
   // Determine the HLO schedule, which is an ordering of HLO instructions.  This
   // is used by buffer assignment to enable buffer reuse, and the same ordering
   // must also be used to determine the thunk launch schedule.
-  std::unique_ptr<StreamAssignment> stream_assignment = AssignStreams(*module);
+  //
+  // A module that had to be rematerialized to fit in memory runs on one
+  // stream, in the order the rematerialization chose, since concurrent streams
+  // would hold more buffers live.
+  SequentialHloOrdering::HloModuleSequence rematerialized_sequence;
+  TF_RETURN_IF_ERROR(RematerializeToFitMemoryLimit(
+      module.get(), stream_exec, ShapeSizeBytesFunction(),
+      &rematerialized_sequence));
+  const bool rematerialized = !rematerialized_sequence.empty();
+  std::unique_ptr<StreamAssignment> stream_assignment =
+      AssignStreams(*module, /*allow_multi_streaming=*/!rematerialized);
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<HloSchedule> hlo_schedule,
-      HloSchedule::Build(*module, *stream_assignment, pointer_size_));
+      HloSchedule::Build(
+          *module, *stream_assignment, pointer_size_,
+          rematerialized
+              ? &rematerialized_sequence.at(module->entry_computation())
+              : nullptr));
 
   // Run buffer analysis on the HLO graph. This analysis figures out which
   // temporary buffers are required to run the computation.
@@ -466,6 +622,7 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
       hlo_schedule->ThunkLaunchOrder());
   VLOG(2) << "Printing the thunk schedule...";
   XLA_VLOG_LINES(2, thunk_schedule->ToString());
+  AutotuneThunks(*thunk_schedule, stream_exec);
 
   std::unique_ptr<HloProfileIndexMap> profile_index_map;
   std::unique_ptr<HloProfilePrinter> profile_printer;
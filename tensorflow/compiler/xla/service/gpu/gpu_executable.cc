@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable.h"
 
 #include <set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -121,7 +122,65 @@ GpuExecutable::GpuExecutable(
       cubin_(cubin),
       compute_capability_(compute_capability),
       thunk_schedule_(std::move(thunk_schedule)),
-      assignment_(std::move(assignment)) {}
+      assignment_(std::move(assignment)) {
+  std::unordered_map<const Thunk*, int> thunk_to_finish_event;
+  for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
+    ThunkLaunch launch;
+    launch.thunk = thunk;
+    launch.stream_no =
+        thunk_schedule_->StreamNumberForHlo(*thunk->hlo_instruction());
+    for (const Thunk* dependency : thunk_schedule_->DependsOn(thunk)) {
+      launch.wait_events.push_back(
+          FindOrDie(thunk_to_finish_event, dependency));
+    }
+    launch.finish_event = -1;
+    if (thunk_schedule_->Depended(thunk)) {
+      launch.finish_event = num_events_++;
+      InsertOrDie(&thunk_to_finish_event, thunk, launch.finish_event);
+    }
+    thunk_launches_.push_back(std::move(launch));
+  }
+}
+
+Status GpuExecutable::InitializeThunks() {
+  tensorflow::mutex_lock lock(mu_);
+  if (thunks_initialized_) {
+    return Status::OK();
+  }
+  for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
+    TF_RETURN_IF_ERROR(thunk->Initialize(*this));
+  }
+  thunks_initialized_ = true;
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<GpuExecutable::EventSet>>
+GpuExecutable::BorrowEventSet(se::StreamExecutor* executor) {
+  {
+    tensorflow::mutex_lock lock(mu_);
+    auto it = free_event_sets_.find(executor);
+    if (it != free_event_sets_.end() && !it->second.empty()) {
+      std::unique_ptr<EventSet> event_set = std::move(it->second.back());
+      it->second.pop_back();
+      return std::move(event_set);
+    }
+  }
+  auto event_set = MakeUnique<EventSet>();
+  for (int64 i = 0; i < num_events_; ++i) {
+    event_set->push_back(MakeUnique<se::Event>(executor));
+    if (!event_set->back()->Init()) {
+      return InternalError("Failed to create an event for %s",
+                           module().name().c_str());
+    }
+  }
+  return std::move(event_set);
+}
+
+void GpuExecutable::ReturnEventSet(se::StreamExecutor* executor,
+                                   std::unique_ptr<EventSet> event_set) {
+  tensorflow::mutex_lock lock(mu_);
+  free_event_sets_[executor].push_back(std::move(event_set));
+}
 
 Status GpuExecutable::ExecuteThunks(
     const ServiceExecutableRunOptions* run_options,
@@ -155,16 +214,20 @@ Status GpuExecutable::ExecuteThunks(
         run_options->BorrowStream(main_stream->parent()->device_ordinal()));
   }
 
-  std::map<const Thunk*, std::unique_ptr<se::Event>> thunk_to_finish_event;
-  for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
-    TF_RETURN_IF_ERROR(thunk->Initialize(*this));
-    int32 stream_no =
-        thunk_schedule_->StreamNumberForHlo(*thunk->hlo_instruction());
-    se::Stream* stream =
-        (stream_no == 0 ? main_stream : sub_streams[stream_no - 1].get());
-
-    for (const Thunk* dependency : thunk_schedule_->DependsOn(thunk)) {
-      stream->ThenWaitFor(FindOrDie(thunk_to_finish_event, dependency).get());
+  TF_RETURN_IF_ERROR(InitializeThunks());
+  // Re-recording an event does not affect the waits that were enqueued for its
+  // earlier recording, so the events can be reused as soon as all the waits of
+  // this execution have been enqueued.
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<EventSet> events,
+                      BorrowEventSet(main_stream->parent()));
+  for (const ThunkLaunch& launch : thunk_launches_) {
+    Thunk* thunk = launch.thunk;
+    se::Stream* stream = (launch.stream_no == 0
+                              ? main_stream
+                              : sub_streams[launch.stream_no - 1].get());
+
+    for (int event : launch.wait_events) {
+      stream->ThenWaitFor((*events)[event].get());
     }
 
     // If this thunk requests it, wait for all currently-executing thunks to
@@ -176,16 +239,14 @@ Status GpuExecutable::ExecuteThunks(
     profiler.StartOperation();
     VLOG(2) << "Executing the thunk for "
             << thunk->hlo_instruction()->ToString() << " on stream "
-            << stream_no;
+            << launch.stream_no;
     TF_RETURN_IF_ERROR(thunk->ExecuteOnStream(buffer_allocations, stream));
-    if (thunk_schedule_->Depended(thunk)) {
-      auto finish_event = MakeUnique<se::Event>(main_stream->parent());
-      finish_event->Init();
-      stream->ThenRecordEvent(finish_event.get());
-      thunk_to_finish_event[thunk] = std::move(finish_event);
+    if (launch.finish_event >= 0) {
+      stream->ThenRecordEvent((*events)[launch.finish_event].get());
     }
     profiler.FinishOperation(thunk->hlo_instruction());
   }
+  ReturnEventSet(main_stream->parent(), std::move(events));
 
   main_stream->ThenWaitFor(&sub_streams);
   // Make sure kernels are completed before deallocating temporary buffers.
@@ -264,7 +325,8 @@ StatusOr<se::DeviceMemoryBase> GpuExecutable::ExecuteOnStream(
             TF_ASSIGN_OR_RETURN(
                 const BufferAllocation::Slice slice,
                 this->assignment_->GetUniqueSlice(hlo, buffers[0]->index()));
-            CHECK(!slice.allocation()->is_entry_computation_parameter());
+            CHECK(!slice.allocation()->is_entry_computation_parameter() ||
+                  slice.allocation()->is_donated_parameter());
             referred_by_output.insert(
                 buffer_allocations->GetDeviceAddress(slice.index()));
             return Status::OK();
@@ -336,11 +398,12 @@ StatusOr<std::unique_ptr<ShapedBuffer>> GpuExecutable::ExecuteOnStream(
                 VLOG(4) << "Looking at: " << sources[0];
 
                 // The source instruction should have a non-parameter buffer
-                // assigned.
+                // assigned, unless the buffer reuses a donated parameter.
                 TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice slice,
                                     this->assignment_->GetUniqueSlice(
                                         src_hlo, sources[0]->index()));
-                CHECK(!slice.allocation()->is_entry_computation_parameter());
+                CHECK(!slice.allocation()->is_entry_computation_parameter() ||
+                      slice.allocation()->is_donated_parameter());
 
                 perftools::gputools::DeviceMemoryBase src_base =
                     buffer_allocations->GetDeviceAddress(slice.index());
@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/device_memory_allocator.h"
@@ -35,7 +37,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace xla {
 namespace gpu {
@@ -44,7 +48,8 @@ namespace gpu {
 //
 // Launches the given CUDA kernel via the StreamExecutor.
 //
-// This is an immutable data type after initialization, and thus thread safe.
+// This is an immutable data type after initialization, except for the caches
+// that are guarded by mu_, and thus thread safe.
 class GpuExecutable : public Executable {
  public:
   // cubin (i.e. the compiled ptx) may be empty, in which case we leave
@@ -111,6 +116,34 @@ class GpuExecutable : public Executable {
   // computation. Uses points-to analysis from buffer assignment.
   const PointsToSet& GetRootPointsToSet() const;
 
+  // The events that thunks record for the thunks on other streams that depend
+  // on them, indexed by ThunkLaunch::finish_event.
+  using EventSet = std::vector<std::unique_ptr<perftools::gputools::Event>>;
+
+  // Returns an event set for `executor`, reusing one from an earlier execution
+  // if there is one. The event set must be returned by ReturnEventSet once all
+  // the waits for its events have been enqueued.
+  StatusOr<std::unique_ptr<EventSet>> BorrowEventSet(
+      perftools::gputools::StreamExecutor* executor);
+  void ReturnEventSet(perftools::gputools::StreamExecutor* executor,
+                      std::unique_ptr<EventSet> event_set);
+
+  // Initializes all the thunks, once they have been initialized successfully
+  // this does nothing.
+  Status InitializeThunks();
+
+  // How a thunk of the schedule is launched. This is computed once from
+  // thunk_schedule_ so that executions only walk a vector.
+  struct ThunkLaunch {
+    Thunk* thunk;
+    // Stream 0 is the main stream.
+    int stream_no;
+    // The events, of other streams, to wait for before the thunk runs.
+    std::vector<int> wait_events;
+    // The event to record after the thunk, or -1 if no thunk depends on it.
+    int finish_event;
+  };
+
   // The LLVM IR, in string format, of the unoptimized module generated for this
   // GpuExecutable. We save a string instead of an llvm::Module* because leaving
   // llvm::Module* in a singleton can cause the heap checker to emit false
@@ -139,6 +172,18 @@ class GpuExecutable : public Executable {
   // memory for every output/temp buffers.
   const std::unique_ptr<const BufferAssignment> assignment_;
 
+  // thunk_schedule_ in total order.
+  std::vector<ThunkLaunch> thunk_launches_;
+  int64 num_events_ = 0;
+
+  tensorflow::mutex mu_;
+  bool thunks_initialized_ GUARDED_BY(mu_) = false;
+  // Creating events is expensive compared to the launch of a small kernel, so
+  // the event sets of finished executions are kept for later ones.
+  std::unordered_map<perftools::gputools::StreamExecutor*,
+                     std::vector<std::unique_ptr<EventSet>>>
+      free_event_sets_ GUARDED_BY(mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(GpuExecutable);
 };
 
@@ -0,0 +1,188 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// Returns whether the buffer of 'instruction' may be returned by its
+// computation. The elements of a tuple-shaped kernel output are bound to the
+// temporary buffer of the kernel, which does not hold the results of a
+// computation, so these instructions are not fused.
+bool IsReturned(const HloInstruction* instruction) {
+  if (instruction == instruction->parent()->root_instruction()) {
+    return true;
+  }
+  for (const HloInstruction* user : instruction->users()) {
+    if ((user->opcode() == HloOpcode::kTuple ||
+         user->opcode() == HloOpcode::kBitcast) &&
+        IsReturned(user)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns whether 'instruction' can be fused with its siblings.
+bool IsFusibleSibling(const HloInstruction* instruction) {
+  if (instruction->user_count() == 0 || IsReturned(instruction)) {
+    return false;
+  }
+  if (instruction->opcode() == HloOpcode::kFusion) {
+    // Other kinds of fusion are emitted by specialized emitters, which only
+    // produce one result. Fusions rooted at a dynamic-update-slice are
+    // emitted in place.
+    return instruction->fusion_kind() == HloInstruction::FusionKind::kLoop &&
+           instruction->fused_expression_root()->opcode() !=
+               HloOpcode::kDynamicUpdateSlice;
+  }
+  // Copies are implemented as memcpys where possible.
+  return instruction->IsElementwise() && instruction->IsFusable() &&
+         instruction->opcode() != HloOpcode::kCopy &&
+         !ShapeUtil::IsTuple(instruction->shape());
+}
+
+// Returns the dimensions the kernel of 'instruction' loops over.
+const Shape& LoopShape(const HloInstruction* instruction) {
+  return instruction->IsMultiOutputFusion()
+             ? ShapeUtil::GetSubshape(instruction->shape(), {0})
+             : instruction->shape();
+}
+
+int64 OutputCount(const HloInstruction* instruction) {
+  return instruction->IsMultiOutputFusion()
+             ? ShapeUtil::TupleElementCount(instruction->shape())
+             : 1;
+}
+
+// Returns the users of 'operand' which can be fused into one instruction. A
+// multi-output fusion, produced by an earlier merge, always comes first.
+std::vector<HloInstruction*> GetFusibleSiblings(
+    const HloInstruction* operand, const HloReachabilityMap& reachability) {
+  std::vector<HloInstruction*> candidates;
+  for (HloInstruction* user : operand->users()) {
+    if (IsFusibleSibling(user)) {
+      candidates.push_back(user);
+    }
+  }
+  std::stable_partition(candidates.begin(), candidates.end(),
+                        [](const HloInstruction* instruction) {
+                          return instruction->IsMultiOutputFusion();
+                        });
+
+  std::vector<HloInstruction*> siblings;
+  std::set<const HloInstruction*> operands;
+  int64 outputs = 0;
+  for (HloInstruction* candidate : candidates) {
+    if (!siblings.empty() &&
+        (candidate->IsMultiOutputFusion() ||
+         !ShapeUtil::SameDimensions(LoopShape(siblings.front()),
+                                    LoopShape(candidate)) ||
+         std::any_of(siblings.begin(), siblings.end(),
+                     [&](const HloInstruction* sibling) {
+                       return reachability.IsConnected(sibling, candidate);
+                     }))) {
+      continue;
+    }
+    std::set<const HloInstruction*> new_operands = operands;
+    new_operands.insert(candidate->operands().begin(),
+                        candidate->operands().end());
+    const int64 new_outputs = outputs + OutputCount(candidate);
+    if (new_operands.size() + new_outputs >
+        HorizontalFusion::GetMaxOperandsAndOutputs()) {
+      continue;
+    }
+    operands.swap(new_operands);
+    outputs = new_outputs;
+    siblings.push_back(candidate);
+  }
+  return siblings;
+}
+
+// Fuses 'siblings' into one multi-output loop fusion.
+void FuseSiblings(HloComputation* computation,
+                  const std::vector<HloInstruction*>& siblings) {
+  HloInstruction* fusion = siblings.front();
+  if (fusion->opcode() != HloOpcode::kFusion) {
+    fusion = computation->CreateFusionInstruction(
+        {fusion}, HloInstruction::FusionKind::kLoop);
+  }
+  for (int64 i = 1; i < siblings.size(); ++i) {
+    HloInstruction* sibling = siblings[i];
+    if (sibling->opcode() == HloOpcode::kFusion) {
+      fusion->MergeFusionInstructionIntoMultiOutput(sibling);
+    } else {
+      fusion->FuseInstructionIntoMultiOutput(sibling);
+      CHECK_EQ(0, sibling->user_count());
+      TF_CHECK_OK(computation->RemoveInstruction(sibling));
+    }
+  }
+  VLOG(2) << "Fused " << siblings.size() << " siblings into "
+          << fusion->name();
+}
+
+// Fuses one group of siblings in 'computation'. Returns false if there are
+// none left.
+bool FuseOneGroupOfSiblings(HloComputation* computation) {
+  std::unique_ptr<HloReachabilityMap> reachability =
+      computation->ComputeReachability();
+  for (HloInstruction* operand : computation->MakeInstructionPostOrder()) {
+    if (operand->user_count() < 2) {
+      continue;
+    }
+    std::vector<HloInstruction*> siblings =
+        GetFusibleSiblings(operand, *reachability);
+    if (siblings.size() >= 2) {
+      FuseSiblings(computation, siblings);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+StatusOr<bool> HorizontalFusion::Run(HloModule* module) {
+  bool changed = false;
+  VLOG(2) << "HorizontalFusion for module: " << module->name();
+  for (auto* computation : module->MakeNonfusionComputations()) {
+    XLA_VLOG_LINES(3, computation->ToString());
+    // Fusing siblings changes the reachability of the instructions, so it is
+    // recomputed after each fused group.
+    while (FuseOneGroupOfSiblings(computation)) {
+      changed = true;
+    }
+    XLA_VLOG_LINES(3, computation->ToString());
+  }
+  return changed;
+}
+
+}  // namespace gpu
+}  // namespace xla
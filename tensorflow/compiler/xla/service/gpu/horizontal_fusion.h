@@ -0,0 +1,51 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// An HLO pass that fuses sibling instructions, i.e. independent users of the
+// same operand, into one multi-output loop fusion to reduce kernel launch
+// overhead. The per-gate computations of an LSTM cell or the updates of
+// several variables by an optimizer are typical examples.
+//
+// Siblings are fused if they are element-wise instructions or loop fusions,
+// their results have the same dimensions (they are emitted in the same loop),
+// neither of them reaches the other, and their results are not returned by
+// their computation. The operands and results of the fused instruction are
+// bounded to keep the kernel's argument list short.
+//
+// This pass is meant to run after the vertical fusion passes, which leave the
+// siblings that they could not fuse into a common consumer.
+class HorizontalFusion : public HloPassInterface {
+ public:
+  tensorflow::StringPiece name() const override { return "horizontal fusion"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+  // The maximum number of operands plus results of a fused instruction.
+  static int64 GetMaxOperandsAndOutputs() { return 64; }
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HORIZONTAL_FUSION_H_
@@ -0,0 +1,168 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/test_helpers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class HorizontalFusionTest : public HloTestBase {
+ protected:
+  Shape shape_ = ShapeUtil::MakeShape(F32, {16, 8});
+};
+
+// Builds the following computation:
+//
+//          Param
+//         /     \
+//       Exp     Tanh
+//         \     /
+//           Add
+//
+// Exp and Tanh are fused into one multi-output fusion.
+TEST_F(HorizontalFusionTest, FusesElementwiseSiblings) {
+  auto module = CreateNewModule();
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape_, "param"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kExp, param));
+  auto tanh = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kTanh, param));
+  builder.AddInstruction(
+      HloInstruction::CreateBinary(shape_, HloOpcode::kAdd, exp, tanh));
+  auto computation = module->AddEntryComputation(builder.Build());
+
+  EXPECT_TRUE(HorizontalFusion().Run(module.get()).ValueOrDie());
+
+  const HloInstruction* root = computation->root_instruction();
+  EXPECT_EQ(HloOpcode::kAdd, root->opcode());
+  EXPECT_EQ(HloOpcode::kGetTupleElement, root->operand(0)->opcode());
+  EXPECT_EQ(HloOpcode::kGetTupleElement, root->operand(1)->opcode());
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_TRUE(fusion->IsMultiOutputFusion());
+  EXPECT_EQ(HloInstruction::FusionKind::kLoop, fusion->fusion_kind());
+  EXPECT_EQ(1, fusion->operand_count());
+  EXPECT_EQ(2, ShapeUtil::TupleElementCount(fusion->shape()));
+  EXPECT_EQ(5, computation->instruction_count());
+}
+
+// Three siblings, two of which are already loop fusions, are fused into a
+// single instruction.
+TEST_F(HorizontalFusionTest, FusesLoopFusionSiblings) {
+  auto module = CreateNewModule();
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape_, "param"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kExp, param));
+  auto negate = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kNegate, exp));
+  auto log = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kLog, param));
+  auto abs = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kAbs, log));
+  auto tanh = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kTanh, param));
+  auto add = builder.AddInstruction(
+      HloInstruction::CreateBinary(shape_, HloOpcode::kAdd, negate, abs));
+  builder.AddInstruction(
+      HloInstruction::CreateBinary(shape_, HloOpcode::kMultiply, add, tanh));
+  auto computation = module->AddEntryComputation(builder.Build());
+  computation->CreateFusionInstruction({negate, exp},
+                                       HloInstruction::FusionKind::kLoop);
+  computation->CreateFusionInstruction({abs, log},
+                                       HloInstruction::FusionKind::kLoop);
+
+  EXPECT_TRUE(HorizontalFusion().Run(module.get()).ValueOrDie());
+
+  int64 fusion_count = 0;
+  for (const HloInstruction* instruction : computation->instructions()) {
+    if (instruction->opcode() == HloOpcode::kFusion) {
+      ++fusion_count;
+      EXPECT_TRUE(instruction->IsMultiOutputFusion());
+      EXPECT_EQ(3, ShapeUtil::TupleElementCount(instruction->shape()));
+      EXPECT_EQ(1, instruction->operand_count());
+    }
+  }
+  EXPECT_EQ(1, fusion_count);
+}
+
+// Builds the following computation:
+//
+//          Param
+//         /  |  \
+//       Exp  |   \
+//         \  |    \
+//          Add   Broadcast
+//           |      |
+//        Reshape Reshape
+//            \    /
+//            Tuple
+//
+// Add reaches Exp, and Broadcast has other dimensions, so nothing is fused.
+TEST_F(HorizontalFusionTest, DoesNotFuseDependentOrDifferentShapedSiblings) {
+  auto module = CreateNewModule();
+  auto builder = HloComputation::Builder(TestName());
+  Shape cube_shape = ShapeUtil::MakeShape(F32, {2, 16, 8});
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape_, "param"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kExp, param));
+  auto add = builder.AddInstruction(
+      HloInstruction::CreateBinary(shape_, HloOpcode::kAdd, param, exp));
+  auto broadcast = builder.AddInstruction(
+      HloInstruction::CreateBroadcast(cube_shape, param, {1, 2}));
+  auto reshape = builder.AddInstruction(
+      HloInstruction::CreateReshape(ShapeUtil::MakeShape(F32, {256}),
+                                    broadcast));
+  auto add_reshape = builder.AddInstruction(HloInstruction::CreateReshape(
+      ShapeUtil::MakeShape(F32, {128}), add));
+  builder.AddInstruction(HloInstruction::CreateTuple({reshape, add_reshape}));
+  auto computation = module->AddEntryComputation(builder.Build());
+  const int64 instruction_count = computation->instruction_count();
+
+  EXPECT_FALSE(HorizontalFusion().Run(module.get()).ValueOrDie());
+  EXPECT_EQ(instruction_count, computation->instruction_count());
+}
+
+// Siblings whose results are returned by the computation are not fused.
+TEST_F(HorizontalFusionTest, DoesNotFuseReturnedSiblings) {
+  auto module = CreateNewModule();
+  auto builder = HloComputation::Builder(TestName());
+  auto param = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, shape_, "param"));
+  auto exp = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kExp, param));
+  auto tanh = builder.AddInstruction(
+      HloInstruction::CreateUnary(shape_, HloOpcode::kTanh, param));
+  builder.AddInstruction(HloInstruction::CreateTuple({exp, tanh}));
+  module->AddEntryComputation(builder.Build());
+
+  EXPECT_FALSE(HorizontalFusion().Run(module.get()).ValueOrDie());
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
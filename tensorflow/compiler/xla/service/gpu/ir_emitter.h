@@ -241,6 +241,7 @@ class IrEmitterUnnested : public IrEmitter {
   Status HandleFusion(HloInstruction* fusion) override;
   Status HandleGetTupleElement(HloInstruction* get_tuple_element) override;
   Status HandleReduce(HloInstruction* reduce) override;
+  Status HandleScatter(HloInstruction* scatter) override;
   Status HandleSelectAndScatter(HloInstruction* instruction) override;
   Status HandleTuple(HloInstruction* tuple) override;
   Status HandleWhile(HloInstruction* xla_while) override;
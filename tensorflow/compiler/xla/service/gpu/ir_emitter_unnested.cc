@@ -24,6 +24,7 @@ limitations under the License.
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/ptr_util.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
@@ -1522,6 +1523,82 @@ Status IrEmitterUnnested::HandleSelectAndScatter(
       .EmitLoop(IrName(select_and_scatter));
 }
 
+Status IrEmitterUnnested::HandleScatter(HloInstruction* scatter) {
+  const HloInstruction* operand = scatter->operand(0);
+  const HloInstruction* indices = scatter->operand(1);
+  const HloInstruction* updates = scatter->operand(2);
+
+  // Unless the scatter updates its operand in place, kScatter is implemented
+  // as a copy of the operand to the output followed by a kernel launch that
+  // scatters the updates into the output. The copy is a device-to-device
+  // memcpy if the operand and the output have the same layout.
+  Thunk* scatter_thunk;
+  if (llvm_ir::CanScatterInPlace(scatter,
+                                 ir_emitter_context_->buffer_assignment())) {
+    thunk_sequence_->emplace_back(BuildKernelThunk(scatter));
+    scatter_thunk = LastThunk();
+  } else {
+    std::vector<std::unique_ptr<Thunk>> thunks;
+    if (LayoutUtil::Equal(operand->shape().layout(),
+                          scatter->shape().layout())) {
+      thunks.emplace_back(BuildDeviceToDeviceCopyThunk(scatter));
+    } else {
+      thunks.emplace_back(BuildKernelThunk(scatter));
+      TF_RETURN_IF_ERROR(EmitTargetElementLoopInThunk(
+          *scatter,
+          [=](const llvm_ir::IrArray::Index& index) {
+            return GetIrArray(*operand, *scatter)
+                .EmitReadArrayElement(index, &ir_builder_);
+          },
+          static_cast<KernelThunk*>(thunks.back().get())));
+      bindings_.UnbindAllLocalIrValues();
+    }
+    thunks.emplace_back(BuildKernelThunk(scatter));
+    scatter_thunk = thunks.back().get();
+    thunk_sequence_->emplace_back(
+        MakeUnique<SequentialThunk>(std::move(thunks), scatter));
+  }
+
+  // Pseudo code for scatter:
+  //
+  // for (coordinates U in the updates):  # This loop is parallel.
+  //   O = U with O[dimension] = indices[U[dimension]]
+  //   if O within bounds of output:
+  //     output(O) = to_apply(output(O), updates(U))  # Atomically.
+  //
+  // Only the updated elements of the output are read, so the cost of the
+  // kernel is proportional to the size of the updates rather than to the size
+  // of the output.
+  auto loop_body_emitter =
+      [=](const llvm_ir::IrArray::Index& update_index) -> Status {
+    llvm_ir::IrArray::Index output_index;
+    llvm::Value* in_bounds;
+    std::tie(output_index, in_bounds) = llvm_ir::EmitScatterOutputIndex(
+        *scatter, GetIrArray(*indices, *scatter), update_index, &ir_builder_);
+    llvm_ir::LlvmIfData if_in_bounds = llvm_ir::EmitIfThenElse(
+        in_bounds, "in_bounds", &ir_builder_, /*emit_else=*/false);
+    llvm_ir::SetToFirstInsertPoint(if_in_bounds.true_block, &ir_builder_);
+    llvm::Value* update_value_address =
+        GetIrArray(*updates, *scatter)
+            .EmitArrayElementAddress(update_index, &ir_builder_);
+    llvm::Value* output_value_address =
+        GetIrArray(*scatter, *scatter)
+            .EmitArrayElementAddress(output_index, &ir_builder_);
+    TF_RETURN_IF_ERROR(EmitAtomicOperationForNestedComputation(
+        *scatter->to_apply(), output_value_address, update_value_address));
+    llvm_ir::SetToFirstInsertPoint(if_in_bounds.after_block, &ir_builder_);
+    return Status::OK();
+  };
+
+  LaunchDimensions launch_dimensions = CalculateLaunchDimensions(
+      updates->shape(), ir_emitter_context_->device_description());
+  UpdateLaunchDimensions(launch_dimensions, scatter_thunk,
+                         ir_emitter_context_->llvm_module());
+  return ParallelLoopEmitter(loop_body_emitter, updates->shape(),
+                             launch_dimensions, &ir_builder_)
+      .EmitLoop(IrName(scatter));
+}
+
 Status IrEmitterUnnested::HandleWhile(HloInstruction* xla_while) {
   HloComputation* condition = xla_while->while_condition();
   TF_RET_CHECK(ShapeUtil::IsScalar(condition->root_instruction()->shape()) &&
@@ -28,6 +28,29 @@ namespace se = ::perftools::gputools;
 namespace xla {
 namespace gpu {
 
+namespace {
+
+// Launches `kernel` on `stream` with the addresses of `io_buffers` and the
+// temp buffer base as its arguments, which are packed into `kernel_args`.
+template <size_t kNumArgs>
+bool LaunchKernel(const std::vector<BufferAllocation::Slice>& io_buffers,
+                  const BufferAllocations& buffer_allocations,
+                  const LaunchDimensions& launch_dimensions,
+                  const se::KernelBase& kernel, se::Stream* stream,
+                  se::KernelArgsArray<kNumArgs>* kernel_args) {
+  for (const BufferAllocation::Slice io_buffer : io_buffers) {
+    kernel_args->add_device_memory_argument(
+        buffer_allocations.GetDeviceAddress(io_buffer));
+  }
+  kernel_args->add_device_memory_argument(
+      buffer_allocations.GetTempBufferBase());
+  return stream->parent()->Launch(
+      stream, se::ThreadDim(launch_dimensions.threads_per_block()),
+      se::BlockDim(launch_dimensions.block_count()), kernel, *kernel_args);
+}
+
+}  // namespace
+
 KernelThunk::KernelThunk(
     tensorflow::gtl::ArraySlice<BufferAllocation::Slice> io_buffers,
     const string& kernel_name, const HloInstruction* hlo_instruction)
@@ -81,19 +104,23 @@ tensorflow::Status KernelThunk::ExecuteOnStream(
     kernel = &it->second;
   }
 
-  // Launch the kernel with potentially multiple blocks and threads.
+  // Launch the kernel with potentially multiple blocks and threads. Most
+  // kernels take few arguments, whose array lives on the stack; the largest
+  // array is allocated only for the kernels that need it, as its allocation is
+  // a noticeable part of the host time of launching a small kernel.
+  static constexpr int kSmallKernelArgsLimit = 32;
   static constexpr int kKernelArgsLimit = 1024;
-  auto kernel_args = MakeUnique<se::KernelArgsArray<kKernelArgsLimit>>();
-  for (const BufferAllocation::Slice io_buffer : io_buffers_) {
-    kernel_args->add_device_memory_argument(
-        buffer_allocations.GetDeviceAddress(io_buffer));
+  bool launched;
+  if (io_buffers_.size() + 1 <= kSmallKernelArgsLimit) {
+    se::KernelArgsArray<kSmallKernelArgsLimit> kernel_args;
+    launched = LaunchKernel(io_buffers_, buffer_allocations, launch_dimensions,
+                            *kernel, stream, &kernel_args);
+  } else {
+    auto kernel_args = MakeUnique<se::KernelArgsArray<kKernelArgsLimit>>();
+    launched = LaunchKernel(io_buffers_, buffer_allocations, launch_dimensions,
+                            *kernel, stream, kernel_args.get());
   }
-  kernel_args->add_device_memory_argument(
-      buffer_allocations.GetTempBufferBase());
-  if (!stream->parent()->Launch(
-          stream, se::ThreadDim(launch_dimensions.threads_per_block()),
-          se::BlockDim(launch_dimensions.block_count()), *kernel,
-          *kernel_args)) {
+  if (!launched) {
     return InternalError("Unable to launch kernel %s", kernel_name_.c_str());
   }
   return tensorflow::Status::OK();
@@ -54,21 +54,23 @@ bool CanRunConcurrently(const HloInstruction& a, const HloInstruction& b,
 // Returns which existing stream to assign to `hlo`, or -1 if a stream is not
 // needed. `stream_assignment` is the existing stream assignment for all
 // instructions topologically before `hlo`. `seen_gemms` contains all GEMMs that
-// are topologically before `hlo`.
+// are topologically before `hlo`. All instructions go to the main stream if
+// `allow_multi_streaming` is false.
 int ComputeStreamToAssign(
     const HloInstruction& hlo, const StreamAssignment& stream_assignment,
     const HloReachabilityMap& reachability,
-    const std::vector<const HloInstruction*>& seen_gemms) {
+    const std::vector<const HloInstruction*>& seen_gemms,
+    bool allow_multi_streaming) {
   if (hlo.opcode() == HloOpcode::kParameter ||
       hlo.opcode() == HloOpcode::kConstant) {
     // kParameter and kConstant do not need a thunk.
     return -1;
   }
 
-  if (hlo.GetModule()
-          ->config()
-          .debug_options()
-          .xla_gpu_disable_multi_streaming()) {
+  if (!allow_multi_streaming || hlo.GetModule()
+                                     ->config()
+                                     .debug_options()
+                                     .xla_gpu_disable_multi_streaming()) {
     return 0;
   }
 
@@ -112,15 +114,17 @@ int ComputeStreamToAssign(
 
 }  // namespace
 
-std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
+std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module,
+                                                bool allow_multi_streaming) {
   auto stream_assignment = MakeUnique<StreamAssignment>();
   const HloComputation& computation = *module.entry_computation();
   std::unique_ptr<HloReachabilityMap> reachability =
       computation.ComputeReachability();
   std::vector<const HloInstruction*> seen_gemms;
   for (const auto* hlo : computation.MakeInstructionPostOrder()) {
-    int stream_no = ComputeStreamToAssign(*hlo, *stream_assignment,
-                                          *reachability, seen_gemms);
+    int stream_no =
+        ComputeStreamToAssign(*hlo, *stream_assignment, *reachability,
+                              seen_gemms, allow_multi_streaming);
     if (stream_no != -1) {
       stream_assignment->AssignStreamToHlo(hlo, stream_no);
     }
@@ -37,8 +37,11 @@ class StreamAssignment {
   tensorflow::gtl::FlatMap<const HloInstruction*, int> hlo_to_stream_number_;
 };
 
-// Assigns GPU streams to instructions in `module`.
-std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module);
+// Assigns GPU streams to instructions in `module`. If `allow_multi_streaming`
+// is false, or multi-streaming is disabled in the debug options of `module`,
+// all instructions are assigned to the main stream.
+std::unique_ptr<StreamAssignment> AssignStreams(
+    const HloModule& module, bool allow_multi_streaming = true);
 
 }  // namespace gpu
 }  // namespace xla
@@ -74,6 +74,30 @@ TEST_F(StreamAssignmentTest, ConcurrentMatMul) {
             assignment->StreamNumberForHlo(*dot2));
 }
 
+TEST_F(StreamAssignmentTest, ConcurrentMatMulOnOneStream) {
+  HloComputation::Builder builder("entry_computation");
+  HloInstruction* x = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/0, f32_2x2_, /*name=*/"x"));
+  HloInstruction* y = builder.AddInstruction(HloInstruction::CreateParameter(
+      /*parameter_number=*/1, f32_2x2_, /*name=*/"y"));
+  HloInstruction* dot1 = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kDot, x, y));
+  HloInstruction* dot2 = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kDot, y, x));
+  HloInstruction* add = builder.AddInstruction(
+      HloInstruction::CreateBinary(f32_2x2_, HloOpcode::kAdd, dot1, dot2));
+
+  auto module = CreateNewModule();
+  module->AddEntryComputation(builder.Build(add));
+
+  std::unique_ptr<StreamAssignment> assignment =
+      AssignStreams(*module, /*allow_multi_streaming=*/false);
+  EXPECT_EQ(1, assignment->StreamCount());
+  EXPECT_EQ(0, assignment->StreamNumberForHlo(*dot1));
+  EXPECT_EQ(0, assignment->StreamNumberForHlo(*dot2));
+  EXPECT_EQ(0, assignment->StreamNumberForHlo(*add));
+}
+
 TEST_F(StreamAssignmentTest, LatticeMatMul) {
   //      d00      -- layer 0
   //     /   \
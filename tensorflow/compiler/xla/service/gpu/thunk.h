@@ -83,6 +83,17 @@ class Thunk {
     return false;
   }
 
+  // Picks the library algorithm that ExecuteOnStream will use on the device of
+  // "stream", e.g. the fastest cuDNN convolution algorithm, by running the
+  // candidates on scratch buffers from "memory_allocator". GpuCompiler calls
+  // this at compile time, so that the first execution does not autotune. A
+  // thunk that is not autotuned here does its autotuning on its first run.
+  virtual tensorflow::Status Autotune(
+      perftools::gputools::Stream* /*stream*/,
+      DeviceMemoryAllocator* /*memory_allocator*/) {
+    return tensorflow::Status::OK();
+  }
+
   // Execute the kernel for the thunk on the given stream. This method must be
   // called after Initialize and can be called multiple times over Thunk's
   // lifetime. Stream argument must be non-null.
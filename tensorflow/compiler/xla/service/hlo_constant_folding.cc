@@ -34,6 +34,31 @@ limitations under the License.
 
 namespace xla {
 
+namespace {
+
+// Returns the number of elements that the evaluator reads and writes to
+// evaluate 'instruction', counting every element of a dot's result once for
+// each of the products it sums.
+int64 EvaluationCost(const HloInstruction& instruction) {
+  int64 cost = 0;
+  for (const HloInstruction* operand : instruction.operands()) {
+    if (ShapeUtil::IsArray(operand->shape())) {
+      cost += ShapeUtil::ElementsIn(operand->shape());
+    }
+  }
+  if (!ShapeUtil::IsArray(instruction.shape())) {
+    return cost;
+  }
+  int64 result_cost = ShapeUtil::ElementsIn(instruction.shape());
+  if (instruction.opcode() == HloOpcode::kDot) {
+    const Shape& lhs_shape = instruction.operand(0)->shape();
+    result_cost *= lhs_shape.dimensions(ShapeUtil::Rank(lhs_shape) - 1);
+  }
+  return cost + result_cost;
+}
+
+}  // namespace
+
 StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
   auto evaluator = MakeUnique<HloEvaluator>();
 
@@ -70,6 +95,13 @@ StatusOr<bool> HloConstantFolding::Run(HloModule* module) {
         continue;
       }
 
+      if (max_evaluation_cost_ >= 0 &&
+          EvaluationCost(*instruction) > max_evaluation_cost_) {
+        VLOG(2) << "Not folding expensive instruction: "
+                << instruction->ToString();
+        continue;
+      }
+
       std::unique_ptr<Literal> result = evaluator->TryEvaluate(instruction);
       // Currently we skip unimplemented operations.
       // TODO(b/35975797): Fold constant computations for more operations.
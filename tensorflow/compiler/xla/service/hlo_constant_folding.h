@@ -25,11 +25,21 @@ namespace xla {
 // computation on constants.
 class HloConstantFolding : public HloPassInterface {
  public:
+  // Instructions whose evaluation reads and writes more than
+  // 'max_evaluation_cost' elements are not folded, which leaves them to the
+  // code that the backend compiles for the module.  A negative value folds
+  // every instruction regardless of its cost.
+  explicit HloConstantFolding(int64 max_evaluation_cost = -1)
+      : max_evaluation_cost_(max_evaluation_cost) {}
+
   tensorflow::StringPiece name() const override { return "constant_folding"; }
 
   // Run constant folding operations on the given module. Returns whether the
   // module was changed (constant expressions folded).
   StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 max_evaluation_cost_;
 };
 
 }  // namespace xla
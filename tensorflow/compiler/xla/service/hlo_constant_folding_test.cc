@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/compiler/xla/array2d.h"
 #include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/literal_util.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
@@ -202,5 +203,30 @@ TEST_F(HloConstantFoldingTest, TransposeConstantFold) {
   EXPECT_TRUE(matched);
 }
 
+TEST_F(HloConstantFoldingTest, SkipsInstructionsAboveMaxEvaluationCost) {
+  HloComputation::Builder builder(TestName());
+  Shape shape = ShapeUtil::MakeShape(F32, {16, 16});
+  Array2D<float> values(16, 16, 1.0f);
+  HloInstruction* lhs = builder.AddInstruction(
+      HloInstruction::CreateConstant(Literal::CreateR2FromArray2D(values)));
+  HloInstruction* rhs = builder.AddInstruction(
+      HloInstruction::CreateConstant(Literal::CreateR2FromArray2D(values)));
+  builder.AddInstruction(
+      HloInstruction::CreateBinary(shape, HloOpcode::kAdd, lhs, rhs));
+  auto module = CreateNewModule();
+  auto computation = module->AddEntryComputation(builder.Build());
+
+  // Reads 2 * 256 and writes 256 elements.
+  HloConstantFolding const_folder(/*max_evaluation_cost=*/3 * 256 - 1);
+  TF_ASSERT_OK_AND_ASSIGN(bool result, const_folder.Run(module.get()));
+  EXPECT_FALSE(result);
+  EXPECT_THAT(computation->root_instruction(), op::Add(lhs, rhs));
+
+  HloConstantFolding const_folder_at_cost(/*max_evaluation_cost=*/3 * 256);
+  TF_ASSERT_OK_AND_ASSIGN(result, const_folder_at_cost.Run(module.get()));
+  EXPECT_TRUE(result);
+  EXPECT_THAT(computation->root_instruction(), op::Constant());
+}
+
 }  // namespace
 }  // namespace xla
@@ -177,6 +177,29 @@ Status HloCostAnalysis::HandleDynamicUpdateSlice(const HloInstruction*) {
   return Status::OK();
 }
 
+Status HloCostAnalysis::HandleGather(const HloInstruction* gather) {
+  // Only the gathered slices of the operand are read.
+  current_properties_[kBytesAccessedKey] =
+      2 * shape_size_(gather->shape()) +
+      shape_size_(gather->operand(1)->shape());
+  return Status::OK();
+}
+
+Status HloCostAnalysis::HandleScatter(const HloInstruction* scatter) {
+  TF_ASSIGN_OR_RETURN(const Properties sub_properties,
+                      ProcessSubcomputation(scatter->to_apply()));
+
+  // The combining function is applied once per element of the updates.
+  const int64 update_count =
+      ShapeUtil::ElementsIn(scatter->operand(2)->shape());
+  for (const auto& property : sub_properties) {
+    if (property.first != kBytesAccessedKey) {
+      current_properties_[property.first] = property.second * update_count;
+    }
+  }
+  return Status::OK();
+}
+
 Status HloCostAnalysis::HandleTuple(const HloInstruction* tuple) {
   // The tuple instruction only gathers pointers from inputs (it doesn't iterate
   // through them). The memory touched is then only the size of the output
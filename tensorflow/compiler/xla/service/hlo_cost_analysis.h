@@ -87,6 +87,8 @@ class HloCostAnalysis : public ConstDfsHloVisitor {
   Status HandleDynamicSlice(const HloInstruction* dynamic_slice) override;
   Status HandleDynamicUpdateSlice(
       const HloInstruction* dynamic_update_slice) override;
+  Status HandleGather(const HloInstruction* gather) override;
+  Status HandleScatter(const HloInstruction* scatter) override;
   Status HandleTuple(const HloInstruction* tuple) override;
   Status HandleMap(const HloInstruction* map) override;
   Status HandleReduceWindow(const HloInstruction* reduce_window) override;
@@ -89,48 +89,53 @@ bool CombineConstants(HloComputation* computation, bool is_layout_sensitive) {
 
 }  // namespace
 
-StatusOr<bool> HloCSE::Run(HloModule* module) {
-  bool changed = false;
-  for (auto* computation : module->computations()) {
-    changed |= CombineConstants(computation, is_layout_sensitive_);
-
-    std::list<HloInstruction*> post_order =
-        computation->MakeInstructionPostOrder();
-    std::set<HloInstruction*> removed_instructions;
-    for (auto instruction : post_order) {
-      // If the instruction has already been removed by CSE skip over it.
-      if (removed_instructions.count(instruction) > 0 ||
-          instruction->operand_count() == 0) {
-        continue;
-      }
+StatusOr<bool> HloCSE::RunOnComputation(HloComputation* computation) {
+  bool changed = CombineConstants(computation, is_layout_sensitive_);
+
+  std::list<HloInstruction*> post_order =
+      computation->MakeInstructionPostOrder();
+  std::set<HloInstruction*> removed_instructions;
+  for (auto instruction : post_order) {
+    // If the instruction has already been removed by CSE skip over it.
+    if (removed_instructions.count(instruction) > 0 ||
+        instruction->operand_count() == 0) {
+      continue;
+    }
 
-      // An instruction is considered to be equivalent to another only if they
-      // share the exact same set of operands. So to find equivalent
-      // instructions, we just search among instructions which share operand(0)
-      // of this instruction.
-      const HloInstruction* operand = instruction->operand(0);
-
-      std::vector<HloInstruction*> equivalent_instructions;
-      for (HloInstruction* user : operand->users()) {
-        if (user != instruction && user->Identical(*instruction) &&
-            (!is_layout_sensitive_ ||
-             ShapeUtil::Equal(user->shape(), instruction->shape()))) {
-          equivalent_instructions.push_back(user);
-        }
+    // An instruction is considered to be equivalent to another only if they
+    // share the exact same set of operands. So to find equivalent
+    // instructions, we just search among instructions which share operand(0)
+    // of this instruction.
+    const HloInstruction* operand = instruction->operand(0);
+
+    std::vector<HloInstruction*> equivalent_instructions;
+    for (HloInstruction* user : operand->users()) {
+      if (user != instruction && user->Identical(*instruction) &&
+          (!is_layout_sensitive_ ||
+           ShapeUtil::Equal(user->shape(), instruction->shape()))) {
+        equivalent_instructions.push_back(user);
       }
+    }
 
-      // Replace all equivalent instructions with this instruction.
-      for (HloInstruction* equivalent_instruction : equivalent_instructions) {
-        TF_RETURN_IF_ERROR(
-            equivalent_instruction->ReplaceAllUsesWith(instruction));
-        TF_RETURN_IF_ERROR(
-            computation->RemoveInstruction(equivalent_instruction));
-        removed_instructions.insert(equivalent_instruction);
-        changed = true;
-      }
+    // Replace all equivalent instructions with this instruction.
+    for (HloInstruction* equivalent_instruction : equivalent_instructions) {
+      TF_RETURN_IF_ERROR(
+          equivalent_instruction->ReplaceAllUsesWith(instruction));
+      TF_RETURN_IF_ERROR(
+          computation->RemoveInstruction(equivalent_instruction));
+      removed_instructions.insert(equivalent_instruction);
+      changed = true;
     }
   }
   return changed;
 }
 
+std::vector<HloComputation*> HloCSE::ComputationsToRun(HloModule* module) {
+  std::vector<HloComputation*> computations;
+  for (HloComputation* computation : module->computations()) {
+    computations.push_back(computation);
+  }
+  return computations;
+}
+
 }  // namespace xla
@@ -25,7 +25,7 @@ namespace xla {
 // and identical instructions with the same operands are commoned. The pass
 // iterates over the instructions in topological order which enables the pass to
 // find arbitrarily large common expressions.
-class HloCSE : public HloPassInterface {
+class HloCSE : public HloComputationPass {
  public:
   // If is_layout_sensitive is true, then the simplifier preserves layout during
   // transformation. Otherwise, layout is ignored.
@@ -34,9 +34,12 @@ class HloCSE : public HloPassInterface {
   ~HloCSE() override {}
   tensorflow::StringPiece name() const override { return "cse"; }
 
-  // Run CSE on the given module. Returns whether the module was changed (common
-  // subexpressions were found and eliminated).
-  StatusOr<bool> Run(HloModule* module) override;
+  // Run CSE on the given computation. Returns whether the computation was
+  // changed (common subexpressions were found and eliminated).
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override;
+
+  // CSE also runs on the fusion computations.
+  std::vector<HloComputation*> ComputationsToRun(HloModule* module) override;
 
  private:
   bool is_layout_sensitive_;
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_cse.h"
 
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_matchers.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 #include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/tests/literal_test_util.h"
@@ -468,5 +470,40 @@ TEST_F(HloCseTest, DISABLED_DoNotCombineCallsToImpureFunctions) {
   EXPECT_THAT(root, op::Add(operand, operand));
 }
 
+TEST_F(HloCseTest, ConcurrentComputations) {
+  // Test that CSE run by a pipeline on several threads commons the constants of
+  // each computation, and keeps the instruction ids unique.
+  HloModuleConfig config;
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_hlo_pass_threads(4);
+  config.set_debug_options(debug_options);
+  HloModule module(TestName(), VersionedComputationHandle(), config);
+  std::vector<HloComputation*> computations;
+  for (int i = 0; i < 8; ++i) {
+    auto builder = HloComputation::Builder(TestName());
+    auto constant1 = builder.AddInstruction(
+        HloInstruction::CreateConstant(Literal::CreateR0<float>(i)));
+    auto constant2 = builder.AddInstruction(
+        HloInstruction::CreateConstant(Literal::CreateR0<float>(i)));
+    builder.AddInstruction(HloInstruction::CreateBinary(
+        constant1->shape(), HloOpcode::kAdd, constant1, constant2));
+    computations.push_back(module.AddEmbeddedComputation(builder.Build()));
+  }
+
+  HloPassPipeline pipeline("cse");
+  pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/false);
+  EXPECT_TRUE(pipeline.Run(&module).ValueOrDie());
+
+  std::set<int> unique_ids;
+  for (HloComputation* computation : computations) {
+    EXPECT_EQ(2, computation->instruction_count());
+    EXPECT_THAT(computation->root_instruction(),
+                op::Add(op::Constant(), op::Constant()));
+    for (HloInstruction* instruction : computation->instructions()) {
+      EXPECT_TRUE(unique_ids.insert(instruction->unique_id()).second);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xla
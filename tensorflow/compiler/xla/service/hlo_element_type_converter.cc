@@ -91,6 +91,7 @@ StatusOr<bool> HloElementTypeConverter::Run(HloModule* module) {
           hlo->opcode() == HloOpcode::kMap ||
           hlo->opcode() == HloOpcode::kReduce ||
           hlo->opcode() == HloOpcode::kReduceWindow ||
+          hlo->opcode() == HloOpcode::kScatter ||
           hlo->opcode() == HloOpcode::kSelectAndScatter ||
           hlo->opcode() == HloOpcode::kConditional) {
         continue;
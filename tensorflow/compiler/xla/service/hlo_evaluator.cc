@@ -56,6 +56,57 @@ struct is_complex_t : public std::false_type {};
 template <>
 struct is_complex_t<complex64> : public std::true_type {};
 
+// Returns true if the elements of an array of 'shape' are stored in the order
+// of its layout without padding, so that they can be walked with a linear
+// index instead of a multi-dimensional index per element.
+bool HasDenseLayout(const Shape& shape) {
+  return ShapeUtil::IsArray(shape) && LayoutUtil::HasLayout(shape) &&
+         !LayoutUtil::IsPadded(shape);
+}
+
+// Returns true if the literals have the dimensions of 'shape' and store their
+// elements in the same order as an array of 'shape', so that element-wise
+// operations on them can use the same linear index for all of them.
+bool SameDenseLayouts(const Shape& shape,
+                      tensorflow::gtl::ArraySlice<const Literal*> literals) {
+  if (!HasDenseLayout(shape)) {
+    return false;
+  }
+  for (const Literal* literal : literals) {
+    if (!HasDenseLayout(literal->shape()) ||
+        !ShapeUtil::SameDimensions(shape, literal->shape()) ||
+        !LayoutUtil::Equal(shape.layout(), literal->shape().layout())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Calls 'visitor' with the linear index of every element of an array of
+// 'shape', which must have a dense layout, in the order of that layout.
+// Along with it, passes the linear index of the corresponding element of
+// another array, whose stride along each dimension of 'shape' is given by
+// 'strides'; a stride of 0 maps the whole dimension to the same element.
+template <typename Visitor>
+void ForEachLinearIndex(const Shape& shape,
+                        tensorflow::gtl::ArraySlice<int64> strides,
+                        const Visitor& visitor) {
+  const int64 num_elements = ShapeUtil::ElementsIn(shape);
+  std::vector<int64> index(ShapeUtil::Rank(shape), 0);
+  int64 mapped_index = 0;
+  for (int64 linear_index = 0; linear_index < num_elements; ++linear_index) {
+    visitor(linear_index, mapped_index);
+    for (const int64 dim : shape.layout().minor_to_major()) {
+      if (++index[dim] < shape.dimensions(dim)) {
+        mapped_index += strides[dim];
+        break;
+      }
+      mapped_index -= (shape.dimensions(dim) - 1) * strides[dim];
+      index[dim] = 0;
+    }
+  }
+}
+
 template <typename OperandT>
 StatusOr<std::unique_ptr<Literal>> Compare(const Shape& shape, HloOpcode opcode,
                                            const Literal& lhs_literal,
@@ -98,6 +149,15 @@ StatusOr<std::unique_ptr<Literal>> Compare(const Shape& shape, HloOpcode opcode,
   }
 
   auto result = Literal::CreateFromShape(shape);
+  if (SameDenseLayouts(shape, {&lhs_literal, &rhs_literal})) {
+    auto result_data = result->GetMutableArraySlice<bool>();
+    auto lhs_data = lhs_literal.GetArraySlice<OperandT>();
+    auto rhs_data = rhs_literal.GetArraySlice<OperandT>();
+    for (int64 i = 0; i < result_data.size(); ++i) {
+      result_data[i] = compare_op(lhs_data[i], rhs_data[i]);
+    }
+    return std::move(result);
+  }
   TF_RETURN_IF_ERROR(result->Populate<bool>(
       [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
         return compare_op(lhs_literal.Get<OperandT>(multi_index),
@@ -129,6 +189,15 @@ StatusOr<std::unique_ptr<Literal>> Compare<complex64>(
   }
 
   auto result = Literal::CreateFromShape(shape);
+  if (SameDenseLayouts(shape, {&lhs_literal, &rhs_literal})) {
+    auto result_data = result->GetMutableArraySlice<bool>();
+    auto lhs_data = lhs_literal.GetArraySlice<complex64>();
+    auto rhs_data = rhs_literal.GetArraySlice<complex64>();
+    for (int64 i = 0; i < result_data.size(); ++i) {
+      result_data[i] = compare_op(lhs_data[i], rhs_data[i]);
+    }
+    return std::move(result);
+  }
   TF_RETURN_IF_ERROR(result->Populate<bool>(
       [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
         return compare_op(lhs_literal.Get<complex64>(multi_index),
@@ -138,10 +207,9 @@ StatusOr<std::unique_ptr<Literal>> Compare<complex64>(
   return std::move(result);
 }
 
-template <typename ReturnT, typename NativeT>
+template <typename ReturnT, typename NativeT, typename UnaryOp>
 StatusOr<std::unique_ptr<Literal>> ElementWiseUnaryOpImpl(
-    HloInstruction* instruction,
-    const std::function<ReturnT(NativeT)>& unary_op,
+    HloInstruction* instruction, const UnaryOp& unary_op,
     const Literal& operand_literal) {
   const auto shape = instruction->shape();
   const auto* operand = instruction->operand(0);
@@ -158,6 +226,15 @@ StatusOr<std::unique_ptr<Literal>> ElementWiseUnaryOpImpl(
 
   auto result = Literal::CreateFromShape(shape);
 
+  if (SameDenseLayouts(shape, {&operand_literal})) {
+    auto result_data = result->GetMutableArraySlice<ReturnT>();
+    auto operand_data = operand_literal.GetArraySlice<NativeT>();
+    for (int64 i = 0; i < result_data.size(); ++i) {
+      result_data[i] = unary_op(operand_data[i]);
+    }
+    return std::move(result);
+  }
+
   TF_RETURN_IF_ERROR(result->Populate<ReturnT>(
       [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
         return unary_op(operand_literal.Get<NativeT>(multi_index));
@@ -233,7 +310,7 @@ class HloEvaluator::TypedVisitor : public DfsHloVisitorWithDefault {
     parent_->evaluated_[broadcast] =
         Literal::CreateFromShape(broadcast->shape());
     auto output = parent_->evaluated_[broadcast].get();
-    auto operand_to_broadcast =
+    const Literal& operand_to_broadcast =
         parent_->GetEvaluatedLiteralFor(broadcast->operand(0));
     std::vector<int64> broadcast_indices(
         ShapeUtil::Rank(broadcast->operand(0)->shape()), 0);
@@ -250,6 +327,25 @@ class HloEvaluator::TypedVisitor : public DfsHloVisitorWithDefault {
                    operand_to_broadcast.shape().dimensions(i));
     }
 
+    // Walks the output in the order of its layout, and the operand along the
+    // broadcast dimensions only.
+    if (HasDenseLayout(output->shape()) &&
+        HasDenseLayout(operand_to_broadcast.shape())) {
+      std::vector<int64> operand_strides(ShapeUtil::Rank(output->shape()), 0);
+      for (int64 i = 0; i < broadcast->dimensions().size(); ++i) {
+        operand_strides[broadcast->dimensions(i)] =
+            IndexUtil::GetDimensionStride(operand_to_broadcast.shape(), i);
+      }
+      auto output_data = output->GetMutableArraySlice<ReturnT>();
+      auto operand_data = operand_to_broadcast.GetArraySlice<ReturnT>();
+      ForEachLinearIndex(output->shape(), operand_strides,
+                         [&](int64 output_index, int64 operand_index) {
+                           output_data[output_index] =
+                               operand_data[operand_index];
+                         });
+      return Status::OK();
+    }
+
     return output->Populate<ReturnT>(
         [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
           for (int64 i = 0; i < broadcast->dimensions().size(); ++i) {
@@ -965,6 +1061,55 @@ class HloEvaluator::TypedVisitor : public DfsHloVisitorWithDefault {
     const Literal& rhs_literal = parent_->GetEvaluatedLiteralFor(rhs);
 
     auto result = Literal::CreateFromShape(dot->shape());
+
+    // Accumulates rows of rhs into rows of the result, so that the innermost
+    // loop walks along the non-contracted dimension of rhs. Every result
+    // element still sums its products in the order of the contracted
+    // dimension.
+    if (HasDenseLayout(result->shape()) &&
+        HasDenseLayout(lhs_literal.shape()) &&
+        HasDenseLayout(rhs_literal.shape())) {
+      const int64 rows = lhs_rank > 1 ? lhs->shape().dimensions(0) : 1;
+      const int64 cols = rhs_rank > 1 ? rhs->shape().dimensions(1) : 1;
+      const int64 lhs_row_stride =
+          lhs_rank > 1 ? IndexUtil::GetDimensionStride(lhs_literal.shape(), 0)
+                       : 0;
+      const int64 lhs_contracted_stride = IndexUtil::GetDimensionStride(
+          lhs_literal.shape(), lhs_contracted_dimension);
+      const int64 rhs_contracted_stride = IndexUtil::GetDimensionStride(
+          rhs_literal.shape(), rhs_contracted_dimension);
+      const int64 rhs_col_stride =
+          rhs_rank > 1 ? IndexUtil::GetDimensionStride(rhs_literal.shape(), 1)
+                       : 0;
+      const int64 result_row_stride =
+          lhs_rank > 1 ? IndexUtil::GetDimensionStride(result->shape(), 0) : 0;
+      const int64 result_col_stride =
+          rhs_rank > 1 ? IndexUtil::GetDimensionStride(result->shape(),
+                                                       dot_rank - 1)
+                       : 0;
+
+      auto result_data = result->GetMutableArraySlice<ReturnT>();
+      auto lhs_data = lhs_literal.GetArraySlice<ReturnT>();
+      auto rhs_data = rhs_literal.GetArraySlice<ReturnT>();
+      std::fill(result_data.begin(), result_data.end(),
+                static_cast<ReturnT>(0));
+      for (int64 row = 0; row < rows; ++row) {
+        for (int64 i = 0; i < contracted_dimension_size; ++i) {
+          const ReturnT lhs_val =
+              lhs_data[row * lhs_row_stride + i * lhs_contracted_stride];
+          const int64 rhs_base = i * rhs_contracted_stride;
+          const int64 result_base = row * result_row_stride;
+          for (int64 col = 0; col < cols; ++col) {
+            result_data[result_base + col * result_col_stride] +=
+                lhs_val * rhs_data[rhs_base + col * rhs_col_stride];
+          }
+        }
+      }
+
+      parent_->evaluated_[dot] = std::move(result);
+      return Status::OK();
+    }
+
     TF_RETURN_IF_ERROR(result->Populate<ReturnT>(
         [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
           ReturnT result_val = static_cast<ReturnT>(0);
@@ -1201,6 +1346,22 @@ class HloEvaluator::TypedVisitor : public DfsHloVisitorWithDefault {
 
     auto result = Literal::CreateFromShape(reduce->shape());
 
+    // Reductions with a single add, multiply, maximum or minimum of the two
+    // parameters apply it directly, instead of evaluating the computation
+    // with a new evaluator for every element.
+    HloOpcode reduce_opcode;
+    if (IsBinaryOpOfParameters(*function, &reduce_opcode) &&
+        HasDenseLayout(arg_literal.shape()) &&
+        HasDenseLayout(result->shape())) {
+      auto result_data = result->GetMutableArraySlice<ReturnT>();
+      std::fill(result_data.begin(), result_data.end(), init_scalar);
+      if (ReduceWithOpcode<ReturnT>(reduce_opcode, arg_literal, dimensions,
+                                    result.get())) {
+        parent_->evaluated_[reduce] = std::move(result);
+        return Status::OK();
+      }
+    }
+
     const auto arg_dimensions = AsInt64Slice(arg_literal.shape().dimensions());
     std::vector<int64> arg_dim_steps(arg_dimensions.size());
     std::vector<int64> arg_dim_counts(arg_dimensions.size());
@@ -1263,6 +1424,110 @@ class HloEvaluator::TypedVisitor : public DfsHloVisitorWithDefault {
     return Status::OK();
   }
 
+  // Returns true if the root of 'function' applies an element-wise binary
+  // opcode, returned in 'opcode', to its two parameters.
+  static bool IsBinaryOpOfParameters(const HloComputation& function,
+                                     HloOpcode* opcode) {
+    const HloInstruction* root = function.root_instruction();
+    if (function.num_parameters() != 2 || root->operand_count() != 2 ||
+        root->operand(0) == root->operand(1) ||
+        root->operand(0)->opcode() != HloOpcode::kParameter ||
+        root->operand(1)->opcode() != HloOpcode::kParameter ||
+        !ShapeUtil::IsScalar(root->shape()) ||
+        root->shape().element_type() !=
+            primitive_util::NativeToPrimitiveType<ReturnT>()) {
+      return false;
+    }
+    *opcode = root->opcode();
+    return true;
+  }
+
+  // Accumulates every element of 'arg_literal' into the element of 'result'
+  // it reduces to, walking 'arg_literal' in the order of its layout.
+  template <typename ReduceOp>
+  static void ReduceLinear(const Literal& arg_literal,
+                           tensorflow::gtl::ArraySlice<int64> dimensions,
+                           Literal* result, const ReduceOp& reduce_op) {
+    const Shape& arg_shape = arg_literal.shape();
+    std::vector<int64> result_strides(ShapeUtil::Rank(arg_shape), 0);
+    int64 result_dim = 0;
+    for (int64 i = 0; i < ShapeUtil::Rank(arg_shape); ++i) {
+      if (std::find(dimensions.begin(), dimensions.end(), i) ==
+          dimensions.end()) {
+        result_strides[i] =
+            IndexUtil::GetDimensionStride(result->shape(), result_dim++);
+      }
+    }
+    auto result_data = result->GetMutableArraySlice<ReturnT>();
+    auto arg_data = arg_literal.GetArraySlice<ReturnT>();
+    ForEachLinearIndex(arg_shape, result_strides,
+                       [&](int64 arg_index, int64 result_index) {
+                         result_data[result_index] = reduce_op(
+                             arg_data[arg_index], result_data[result_index]);
+                       });
+  }
+
+  // Reduces with 'opcode' the way its handler applies it. Returns false for
+  // opcodes that are left to the evaluation of the reduce computation.
+  template <
+      typename NativeT,
+      typename std::enable_if<!is_complex_t<NativeT>::value>::type* = nullptr>
+  static bool ReduceWithOpcode(HloOpcode opcode, const Literal& arg_literal,
+                               tensorflow::gtl::ArraySlice<int64> dimensions,
+                               Literal* result) {
+    switch (opcode) {
+      case HloOpcode::kAdd:
+        ReduceLinear(arg_literal, dimensions, result,
+                     [](ReturnT lhs, ReturnT rhs) -> ReturnT {
+                       return lhs + rhs;
+                     });
+        return true;
+      case HloOpcode::kMultiply:
+        if (!std::is_floating_point<NativeT>::value) {
+          return false;
+        }
+        ReduceLinear(arg_literal, dimensions, result,
+                     [](ReturnT lhs, ReturnT rhs) -> ReturnT {
+                       return lhs * rhs;
+                     });
+        return true;
+      case HloOpcode::kMaximum:
+        ReduceLinear(arg_literal, dimensions, result,
+                     [](ReturnT lhs, ReturnT rhs) -> ReturnT {
+                       return std::fmax(lhs, rhs);
+                     });
+        return true;
+      case HloOpcode::kMinimum:
+        ReduceLinear(arg_literal, dimensions, result,
+                     [](ReturnT lhs, ReturnT rhs) -> ReturnT {
+                       return std::fmin(lhs, rhs);
+                     });
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  template <
+      typename NativeT,
+      typename std::enable_if<is_complex_t<NativeT>::value>::type* = nullptr>
+  static bool ReduceWithOpcode(HloOpcode opcode, const Literal& arg_literal,
+                               tensorflow::gtl::ArraySlice<int64> dimensions,
+                               Literal* result) {
+    switch (opcode) {
+      case HloOpcode::kAdd:
+        ReduceLinear(arg_literal, dimensions, result,
+                     [](ReturnT lhs, ReturnT rhs) { return lhs + rhs; });
+        return true;
+      case HloOpcode::kMultiply:
+        ReduceLinear(arg_literal, dimensions, result,
+                     [](ReturnT lhs, ReturnT rhs) { return lhs * rhs; });
+        return true;
+      default:
+        return false;
+    }
+  }
+
   Status HandleReduceWindow(HloInstruction* reduce_window) override {
     auto operand = reduce_window->operand(0);
     const Window& window = reduce_window->window();
@@ -1485,18 +1750,18 @@ class HloEvaluator::TypedVisitor : public DfsHloVisitorWithDefault {
     return std::move(result);
   }
 
+  template <typename UnaryOp>
   StatusOr<std::unique_ptr<Literal>> ElementWiseUnaryOp(
-      HloInstruction* instruction,
-      const std::function<ReturnT(ReturnT)>& unary_op) {
+      HloInstruction* instruction, const UnaryOp& unary_op) {
     const Literal& operand_literal =
         parent_->GetEvaluatedLiteralFor(instruction->operand(0));
     return ElementWiseUnaryOpImpl<ReturnT, ReturnT>(instruction, unary_op,
                                                     operand_literal);
   }
 
+  template <typename BinaryOp>
   StatusOr<std::unique_ptr<Literal>> ElementWiseBinaryOp(
-      HloInstruction* instruction,
-      const std::function<ReturnT(ReturnT, ReturnT)>& binary_op) {
+      HloInstruction* instruction, const BinaryOp& binary_op) {
     const auto shape = instruction->shape();
     const auto* lhs = instruction->operand(0);
     const auto* rhs = instruction->operand(1);
@@ -1518,6 +1783,16 @@ class HloEvaluator::TypedVisitor : public DfsHloVisitorWithDefault {
 
     auto result = Literal::CreateFromShape(shape);
 
+    if (SameDenseLayouts(shape, {&lhs_literal, &rhs_literal})) {
+      auto result_data = result->GetMutableArraySlice<ReturnT>();
+      auto lhs_data = lhs_literal.GetArraySlice<ReturnT>();
+      auto rhs_data = rhs_literal.GetArraySlice<ReturnT>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = binary_op(lhs_data[i], rhs_data[i]);
+      }
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(result->Populate<ReturnT>(
         [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
           return binary_op(lhs_literal.Get<ReturnT>(multi_index),
@@ -1555,6 +1830,17 @@ class HloEvaluator::TypedVisitor : public DfsHloVisitorWithDefault {
 
     auto result = Literal::CreateFromShape(shape);
 
+    if (SameDenseLayouts(shape, {&lhs_literal, &rhs_literal, &ehs_literal})) {
+      auto result_data = result->GetMutableArraySlice<ReturnT>();
+      auto lhs_data = lhs_literal.GetArraySlice<LhsType>();
+      auto rhs_data = rhs_literal.GetArraySlice<RhsType>();
+      auto ehs_data = ehs_literal.GetArraySlice<EhsType>();
+      for (int64 i = 0; i < result_data.size(); ++i) {
+        result_data[i] = ternary_op(lhs_data[i], rhs_data[i], ehs_data[i]);
+      }
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(result->Populate<ReturnT>(
         [&](tensorflow::gtl::ArraySlice<int64> multi_index) {
           return ternary_op(lhs_literal.Get<LhsType>(multi_index),
@@ -1741,8 +2027,17 @@ Status HloEvaluator::HandleReshape(HloInstruction* reshape) {
 }
 
 Status HloEvaluator::HandleTranspose(HloInstruction* transpose) {
-  evaluated_[transpose] = GetEvaluatedLiteralFor(transpose->operand(0))
-                              .Transpose(transpose->dimensions());
+  // Transpose permutes the layout without moving any element, so the result
+  // is relaid out to the layout of the instruction, which lets its users take
+  // the linear paths of the element-wise handlers.
+  std::unique_ptr<Literal> result =
+      GetEvaluatedLiteralFor(transpose->operand(0))
+          .Transpose(transpose->dimensions());
+  if (LayoutUtil::HasLayout(transpose->shape()) &&
+      !LayoutUtil::LayoutsInShapesEqual(result->shape(), transpose->shape())) {
+    result = result->Relayout(transpose->shape().layout());
+  }
+  evaluated_[transpose] = std::move(result);
   return Status::OK();
 }
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/human_readable_profile_builder.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace xla {
 HloProfileIndexMap::HloProfileIndexMap(const HloModule& module) {
@@ -132,4 +133,40 @@ uint64 HloExecutionProfile::GetCyclesTakenBy(const HloInstruction& hlo) const {
   return profile_counters_[hlo_profile_index_map_.GetProfileIndexFor(hlo)];
 }
 
+void HloExecutionProfile::AppendToDeviceStepStats(
+    const DeviceDescription& device_description, int64 start_micros,
+    tensorflow::DeviceStepStats* device_stats) const {
+  std::vector<std::pair<int64, const HloInstruction*>> instructions;
+  for (const auto& pair : hlo_profile_index_map_.instruction_to_profile_idx()) {
+    if (profile_counters_[pair.second] > 0) {
+      instructions.emplace_back(pair.second, pair.first);
+    }
+  }
+  std::sort(instructions.begin(), instructions.end());
+
+  const double cycles_per_micro = device_description.clock_rate_ghz() * 1e3;
+  double now_micros = start_micros;
+  for (const auto& pair : instructions) {
+    const HloInstruction* hlo = pair.second;
+    const double micros =
+        cycles_per_micro > 0 ? profile_counters_[pair.first] / cycles_per_micro
+                             : 0;
+    const string& op_name = hlo->metadata().op_name();
+    const string& op_type = hlo->metadata().op_type();
+
+    tensorflow::NodeExecStats* stats = device_stats->add_node_stats();
+    stats->set_node_name(op_name.empty() ? hlo->name() : op_name);
+    stats->set_timeline_label(tensorflow::strings::StrCat(
+        op_name.empty() ? hlo->name() : op_name, " = ",
+        op_type.empty() ? HloOpcodeString(hlo->opcode()) : op_type, "(",
+        hlo->name(), ")"));
+    stats->set_all_start_micros(static_cast<int64>(now_micros));
+    const int64 duration_micros = static_cast<int64>(micros);
+    stats->set_op_start_rel_micros(0);
+    stats->set_op_end_rel_micros(duration_micros);
+    stats->set_all_end_rel_micros(duration_micros);
+    now_micros += micros;
+  }
+}
+
 }  // namespace xla
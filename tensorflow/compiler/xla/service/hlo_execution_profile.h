@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_profile_printer.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/platform/stream_executor_no_cuda.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -124,6 +125,16 @@ class HloExecutionProfile {
                                          device_description.clock_rate_ghz());
   }
 
+  // Appends to `device_stats` a NodeExecStats for each instruction that took
+  // cycles, so that XLA kernels show up in the TensorFlow timeline and tfprof.
+  // The stats are named after the TensorFlow op recorded in the OpMetadata of
+  // the instruction, or after the instruction if it has none. The profile has
+  // no start times, so the instructions are laid out back to back from
+  // `start_micros`, in the order of their profile indices.
+  void AppendToDeviceStepStats(const DeviceDescription& device_description,
+                               int64 start_micros,
+                               tensorflow::DeviceStepStats* device_stats) const;
+
   std::vector<int64>* mutable_profile_counters() { return &profile_counters_; }
 
  private:
@@ -99,5 +99,59 @@ TEST_F(HloExecutionProfileTest, Basic) {
   EXPECT_EQ(line_3[kInstructionCyclesIndex], std::to_string(add_cycles));
   EXPECT_EQ(line_3[kInstructionNameIndex], '%' + add_instruction->name());
 }
+
+TEST_F(HloExecutionProfileTest, StepStats) {
+  std::unique_ptr<HloModule> hlo_module = CreateNewModule();
+
+  HloComputation::Builder builder(TestName());
+  Shape shape = ShapeUtil::MakeShape(F32, {30, 30});
+  HloInstruction* param_lhs =
+      builder.AddInstruction(HloInstruction::CreateParameter(0, shape, "lhs"));
+  HloInstruction* param_rhs =
+      builder.AddInstruction(HloInstruction::CreateParameter(1, shape, "rhs"));
+  HloInstruction* add_instruction =
+      builder.AddInstruction(HloInstruction::CreateBinary(
+          shape, HloOpcode::kAdd, param_lhs, param_rhs));
+  HloInstruction* dot_instruction =
+      builder.AddInstruction(HloInstruction::CreateBinary(
+          shape, HloOpcode::kDot, param_lhs, add_instruction));
+  OpMetadata metadata;
+  metadata.set_op_type("Add");
+  metadata.set_op_name("model/add");
+  add_instruction->set_metadata(metadata);
+
+  hlo_module->AddEntryComputation(builder.Build());
+
+  HloCostAnalysis cost_analysis(
+      [](const Shape& shape) { return ShapeUtil::ByteSizeOf(shape, 8); });
+  HloProfileIndexMap profile_index_map(*hlo_module);
+  std::unique_ptr<HloProfilePrinter> profile_printer =
+      CreateHloProfilePrinter(profile_index_map, cost_analysis);
+  HloExecutionProfile execution_profile(profile_printer.get(),
+                                        &profile_index_map);
+  execution_profile.SetCyclesTakenBy(add_instruction, 1000000);
+  execution_profile.SetCyclesTakenBy(dot_instruction, 4000000);
+
+  const int64 start_micros = 5000;
+  tensorflow::DeviceStepStats device_stats;
+  execution_profile.AppendToDeviceStepStats(
+      backend().default_stream_executor()->GetDeviceDescription(),
+      start_micros, &device_stats);
+
+  // The parameters took no cycles, so they have no stats.
+  ASSERT_EQ(device_stats.node_stats_size(), 2);
+  const tensorflow::NodeExecStats& add_stats = device_stats.node_stats(0);
+  const tensorflow::NodeExecStats& dot_stats = device_stats.node_stats(1);
+  EXPECT_EQ(add_stats.node_name(), "model/add");
+  EXPECT_EQ(add_stats.timeline_label(),
+            "model/add = Add(" + add_instruction->name() + ")");
+  EXPECT_EQ(dot_stats.node_name(), dot_instruction->name());
+  EXPECT_EQ(add_stats.all_start_micros(), start_micros);
+  EXPECT_NEAR(dot_stats.all_start_micros(),
+              add_stats.all_start_micros() + add_stats.all_end_rel_micros(),
+              1);
+  EXPECT_NEAR(dot_stats.all_end_rel_micros(),
+              4 * add_stats.all_end_rel_micros(), 4);
+}
 }  // namespace
 }  // namespace xla
@@ -939,9 +939,10 @@ ColorScheme HloDotDumper::GetInstructionColor(const HloInstruction* instr) {
       }
       return kGreen;
     case HloOpcode::kDynamicUpdateSlice:
-      // Unlike the data-movement ops above, dynamic-update-slice is not ~free
-      // inside of fusion nodes, so we de-emphasize it only if it's
-      // scalar-shaped.
+    case HloOpcode::kGather:
+      // Unlike the data-movement ops above, dynamic-update-slice and gather
+      // are not ~free inside of fusion nodes, so we de-emphasize them only if
+      // they are scalar-shaped.
       if (ShapeUtil::IsEffectiveScalar(instr->shape())) {
         return kWhite;
       }
@@ -958,6 +959,7 @@ ColorScheme HloDotDumper::GetInstructionColor(const HloInstruction* instr) {
     case HloOpcode::kBatchNormTraining:
     case HloOpcode::kReduce:
     case HloOpcode::kReduceWindow:
+    case HloOpcode::kScatter:
     case HloOpcode::kSelectAndScatter:
       return kPurple;
     case HloOpcode::kFusion:
@@ -512,6 +512,29 @@ HloInstruction::CreateCrossReplicaSum(
   return instruction;
 }
 
+/* static */ std::unique_ptr<HloInstruction> HloInstruction::CreateGather(
+    const Shape& shape, HloInstruction* operand, HloInstruction* indices,
+    int64 dimension) {
+  auto instruction = WrapUnique(new HloInstruction(HloOpcode::kGather, shape));
+  instruction->AppendOperand(operand);
+  instruction->AppendOperand(indices);
+  instruction->dimensions_.push_back(dimension);
+  return instruction;
+}
+
+/* static */ std::unique_ptr<HloInstruction> HloInstruction::CreateScatter(
+    const Shape& shape, HloInstruction* operand, HloInstruction* indices,
+    HloInstruction* updates, HloComputation* to_apply, int64 dimension) {
+  auto instruction =
+      WrapUnique(new HloInstruction(HloOpcode::kScatter, shape));
+  instruction->AppendOperand(operand);
+  instruction->AppendOperand(indices);
+  instruction->AppendOperand(updates);
+  instruction->called_computations_.push_back(to_apply);
+  instruction->dimensions_.push_back(dimension);
+  return instruction;
+}
+
 /* static */ std::unique_ptr<HloInstruction>
 HloInstruction::CreateDynamicUpdateSlice(const Shape& shape,
                                          HloInstruction* operand,
@@ -1225,6 +1248,16 @@ std::unique_ptr<HloInstruction> HloInstruction::CloneWithNewOperands(
       clone = CreateDynamicUpdateSlice(shape, new_operands[0], new_operands[1],
                                        new_operands[2]);
       break;
+    case HloOpcode::kGather:
+      CHECK_EQ(new_operands.size(), 2);
+      clone = CreateGather(shape, new_operands[0], new_operands[1],
+                           indexed_dimension());
+      break;
+    case HloOpcode::kScatter:
+      CHECK_EQ(new_operands.size(), 3);
+      clone = CreateScatter(shape, new_operands[0], new_operands[1],
+                            new_operands[2], to_apply(), indexed_dimension());
+      break;
     case HloOpcode::kTranspose:
       CHECK_EQ(new_operands.size(), 1);
       clone = CreateTranspose(shape, new_operands[0], dimensions_);
@@ -1428,7 +1461,8 @@ bool HloInstruction::CanHaveDimensionsField() const {
   return (opcode() == HloOpcode::kReverse ||
           opcode() == HloOpcode::kConcatenate ||
           opcode() == HloOpcode::kReduce || opcode() == HloOpcode::kBroadcast ||
-          opcode() == HloOpcode::kTranspose);
+          opcode() == HloOpcode::kTranspose || opcode() == HloOpcode::kGather ||
+          opcode() == HloOpcode::kScatter);
 }
 
 const std::vector<int64>& HloInstruction::dimensions() const {
@@ -1440,6 +1474,12 @@ int64 HloInstruction::dimensions(int64 index) const {
   return dimensions()[index];
 }
 
+int64 HloInstruction::indexed_dimension() const {
+  CHECK(opcode() == HloOpcode::kGather || opcode() == HloOpcode::kScatter);
+  CHECK_EQ(1, dimensions_.size());
+  return dimensions(0);
+}
+
 int64 HloInstruction::concatenate_dimension() const {
   CHECK(opcode() == HloOpcode::kConcatenate);
   CHECK_EQ(1, dimensions_.size());
@@ -1662,6 +1702,11 @@ bool HloInstruction::IdenticalSlowPath(
              dynamic_slice_sizes_ == other.dynamic_slice_sizes_;
     case HloOpcode::kDynamicUpdateSlice:
       return ShapeUtil::Compatible(shape(), other.shape());
+    case HloOpcode::kGather:
+      return dimensions() == other.dimensions();
+    case HloOpcode::kScatter:
+      return dimensions() == other.dimensions() &&
+             eq_computations(to_apply(), other.to_apply());
     case HloOpcode::kCall:
     case HloOpcode::kMap:
       return eq_computations(to_apply(), other.to_apply());
@@ -1793,6 +1838,7 @@ HloComputation* HloInstruction::to_apply() const {
     case HloOpcode::kMap:
     case HloOpcode::kReduceWindow:
     case HloOpcode::kReduce:
+    case HloOpcode::kScatter:
       CHECK_EQ(called_computations_.size(), 1);
       return called_computations_[0];
     default:
@@ -1810,6 +1856,7 @@ void HloInstruction::set_to_apply(HloComputation* computation) {
     case HloOpcode::kMap:
     case HloOpcode::kReduceWindow:
     case HloOpcode::kReduce:
+    case HloOpcode::kScatter:
       CHECK_EQ(called_computations_.size(), 1);
       called_computations_[0] = computation;
       break;
@@ -2038,7 +2085,8 @@ std::vector<string> HloInstruction::ExtraAttributesToString() const {
     extra.push_back(StrCat("false_computation=%", false_computation()->name()));
   } else if (opcode() == HloOpcode::kCall || opcode() == HloOpcode::kMap ||
              opcode() == HloOpcode::kReduceWindow ||
-             opcode() == HloOpcode::kReduce) {
+             opcode() == HloOpcode::kReduce ||
+             opcode() == HloOpcode::kScatter) {
     extra.push_back(StrCat("to_apply=%", to_apply()->name()));
   } else if (!called_computations().empty()) {
     extra.push_back(StrCat(
@@ -2437,6 +2485,10 @@ Status HloInstruction::Visit(DfsHloVisitorBase<HloInstructionPtr>* visitor) {
       return visitor->HandleDynamicSlice(this);
     case HloOpcode::kDynamicUpdateSlice:
       return visitor->HandleDynamicUpdateSlice(this);
+    case HloOpcode::kGather:
+      return visitor->HandleGather(this);
+    case HloOpcode::kScatter:
+      return visitor->HandleScatter(this);
     case HloOpcode::kSort:
       return visitor->HandleSort(this);
     case HloOpcode::kInfeed:
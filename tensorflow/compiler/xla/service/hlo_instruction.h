@@ -248,6 +248,21 @@ class HloInstruction {
       const Shape& shape, HloInstruction* operand, HloInstruction* update,
       HloInstruction* start_indices);
 
+  // Creates a gather instruction, which selects the slices of 'operand' along
+  // 'dimension' at the positions in the rank-1 'indices'. Out-of-bounds
+  // indices select slices of zeros.
+  static std::unique_ptr<HloInstruction> CreateGather(const Shape& shape,
+                                                      HloInstruction* operand,
+                                                      HloInstruction* indices,
+                                                      int64 dimension);
+
+  // Creates a scatter instruction, which combines each slice of 'updates'
+  // along 'dimension' into the slice of 'operand' at the position in the
+  // rank-1 'indices' with 'to_apply'. Out-of-bounds updates are dropped.
+  static std::unique_ptr<HloInstruction> CreateScatter(
+      const Shape& shape, HloInstruction* operand, HloInstruction* indices,
+      HloInstruction* updates, HloComputation* to_apply, int64 dimension);
+
   // Creates a concatenate instruction, where the operands are concatenated on
   // the provided dimension.
   static std::unique_ptr<HloInstruction> CreateConcatenate(
@@ -566,7 +581,7 @@ class HloInstruction {
   // Returns the dimension sizes or numbers associated with this instruction.
   //
   // Precondition: opcode() is one of: concatenate, reduce, broadcast, reshape,
-  // and reverse.
+  // reverse, gather and scatter.
   const std::vector<int64>& dimensions() const;
   int64 dimensions(int64 index) const;
 
@@ -574,6 +589,10 @@ class HloInstruction {
   // Precondition: opcode() == HloOpcode::kConcatenate
   int64 concatenate_dimension() const;
 
+  // Accessor for the dimension along which a gather or scatter HLO indexes.
+  // Precondition: opcode() == HloOpcode::kGather or HloOpcode::kScatter
+  int64 indexed_dimension() const;
+
   // Returns the tuple index associated with this instruction.
   //
   // Precondition: opcode() == HloOpcode::kGetTupleElement
@@ -120,7 +120,8 @@ void HloModule::ReplaceComputations(
         case HloOpcode::kCall:
         case HloOpcode::kMap:
         case HloOpcode::kReduce:
-        case HloOpcode::kReduceWindow: {
+        case HloOpcode::kReduceWindow:
+        case HloOpcode::kScatter: {
           HloComputation* new_arg = tensorflow::gtl::FindWithDefault(
               replacements, instruction->to_apply(), nullptr);
           if (new_arg != nullptr) {
@@ -544,4 +545,10 @@ uint64 HloModule::RandomNew64() const {
   return rng_();
 }
 
+void HloModule::UniquifyInstruction(HloInstruction* instruction) {
+  tensorflow::mutex_lock l(instruction_uniquer_mutex_);
+  instruction->UniquifyName(&instruction_name_uniquer_);
+  instruction->SetUniqueId(next_unique_id_++);
+}
+
 }  // namespace xla
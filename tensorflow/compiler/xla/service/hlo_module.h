@@ -180,11 +180,17 @@ class HloModule {
 
   // Assign a new unique dense id for an instruction
   int NewUniqueInstructionId() {
+    tensorflow::mutex_lock l(instruction_uniquer_mutex_);
     int result = next_unique_id_;
     next_unique_id_++;
     return result;
   }
 
+  // Gives the instruction a name and a dense id that are unique in this
+  // module. This is thread-safe, so that an HloComputationPass can add
+  // instructions to several computations of the module concurrently.
+  void UniquifyInstruction(HloInstruction* instruction);
+
   // Returns the number of unique intruction ids given out.  All ids up to
   // this point are guaranteed to be in the range [0..NumUniqueInstructionIds())
   int NumUniqueInstructionIds() const { return next_unique_id_; }
@@ -215,6 +221,7 @@ class HloModule {
   NameUniquer computation_name_uniquer_{/*separator=*/"."};
   NameUniquer instruction_name_uniquer_{/*separator=*/"."};
   int next_unique_id_ = 0;
+  tensorflow::mutex instruction_uniquer_mutex_;
 };
 
 }  // namespace xla
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_module_config.h"
 
+#include <algorithm>
 #include <atomic>
 #include <vector>
 
@@ -62,7 +63,16 @@ string HloModuleConfig::compilation_cache_key() const {
     StrAppend(&key, "::intra_op_parallelism_threads=",
               intra_op_parallelism_threads());
   }
+  if (!donated_parameters_.empty()) {
+    StrAppend(&key, "::donated_parameters=",
+              tensorflow::str_util::Join(donated_parameters_, ","));
+  }
   return key;
 }
 
+bool HloModuleConfig::is_donated_parameter(int64 parameter_number) const {
+  return std::find(donated_parameters_.begin(), donated_parameters_.end(),
+                   parameter_number) != donated_parameters_.end();
+}
+
 }  // namespace xla
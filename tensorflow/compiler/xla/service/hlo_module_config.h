@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_MODULE_CONFIG_H_
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/compiler/xla/service/computation_layout.h"
 #include "tensorflow/compiler/xla/types.h"
@@ -96,6 +97,18 @@ class HloModuleConfig {
     return intra_op_parallelism_threads_;
   }
 
+  // Sets/returns the numbers of the entry computation parameters whose
+  // buffers are donated to the executable: the caller gives up their
+  // contents, so buffer assignment may reuse them for the output or for
+  // temporaries. Only array-shaped parameters can be donated.
+  void set_donated_parameters(std::vector<int64> donated_parameters) {
+    donated_parameters_ = std::move(donated_parameters);
+  }
+  const std::vector<int64>& donated_parameters() const {
+    return donated_parameters_;
+  }
+  bool is_donated_parameter(int64 parameter_number) const;
+
  private:
   // If you add new members, be sure to update compilation_cache_key.
 
@@ -114,6 +127,9 @@ class HloModuleConfig {
   // execution on the CPU backend.
   int64 intra_op_parallelism_threads_ = -1;
 
+  // The entry computation parameters donated to the executable.
+  std::vector<int64> donated_parameters_;
+
   DebugOptions debug_options_;
 };
 
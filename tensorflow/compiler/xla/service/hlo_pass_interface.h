@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_INTERFACE_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_INTERFACE_H_
 
+#include <vector>
+
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/statusor.h"
@@ -36,6 +38,36 @@ class HloPassInterface {
   virtual StatusOr<bool> Run(HloModule* module) = 0;
 };
 
+// Base class for HLO passes that transform each computation of a module
+// independently of the other computations. Such a pass may add instructions to
+// and remove instructions from the computation it runs on, but must not change
+// the other computations or the module itself, e.g. by adding computations. The
+// HloPassPipeline can then run it over several computations concurrently; see
+// --xla_hlo_pass_threads.
+class HloComputationPass : public HloPassInterface {
+ public:
+  // Run the pass on the given computation. Return whether it modified the
+  // computation.
+  virtual StatusOr<bool> RunOnComputation(HloComputation* computation) = 0;
+
+  // Returns the computations of the module the pass runs on: by default, the
+  // non-fusion computations.
+  virtual std::vector<HloComputation*> ComputationsToRun(HloModule* module) {
+    return module->MakeNonfusionComputations();
+  }
+
+  // Run the pass on each of ComputationsToRun(module) in turn.
+  StatusOr<bool> Run(HloModule* module) override {
+    bool changed = false;
+    for (HloComputation* computation : ComputationsToRun(module)) {
+      TF_ASSIGN_OR_RETURN(bool changed_computation,
+                          RunOnComputation(computation));
+      changed |= changed_computation;
+    }
+    return changed;
+  }
+};
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_INTERFACE_H_
@@ -15,16 +15,22 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include <algorithm>
 #include <functional>
 
 #include "tensorflow/compiler/xla/service/hlo_graph_dumper.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
 
 using ::tensorflow::strings::StrAppend;
 using ::tensorflow::strings::StrCat;
@@ -32,12 +38,50 @@ using ::tensorflow::strings::StrCat;
 namespace xla {
 
 namespace {
+
+auto* pass_run_time = tensorflow::monitoring::Counter<2>::New(
+    "/tensorflow/compiler/xla/hlo_pass/run_time_usecs",
+    "Time in microseconds spent running HLO passes.", "pipeline", "pass");
+auto* pass_peak_memory_increase = tensorflow::monitoring::Counter<2>::New(
+    "/tensorflow/compiler/xla/hlo_pass/peak_memory_increase_bytes",
+    "Bytes by which HLO passes raised the peak resident memory of the process.",
+    "pipeline", "pass");
+
 void DumpModule(const HloModule& module,
                 const string& message) {
   hlo_graph_dumper::MaybeDumpHloModule(module, message);
   VLOG(3) << "HLO " << message << ":";
   XLA_VLOG_LINES(3, module.ToString());
 }
+
+// Runs the pass over the computations of the module, on up to num_threads
+// threads at once.
+StatusOr<bool> RunConcurrently(HloComputationPass* pass, HloModule* module,
+                               int num_threads) {
+  std::vector<HloComputation*> computations = pass->ComputationsToRun(module);
+  if (num_threads < 2 || computations.size() < 2) {
+    return pass->Run(module);
+  }
+  std::vector<StatusOr<bool>> results(computations.size(), false);
+  {
+    tensorflow::thread::ThreadPool pool(
+        tensorflow::Env::Default(), "hlo_pass",
+        std::min<int64>(num_threads, computations.size()));
+    for (int64 i = 0; i < computations.size(); ++i) {
+      pool.Schedule([pass, &computations, &results, i]() {
+        results[i] = pass->RunOnComputation(computations[i]);
+      });
+    }
+    // The destructor of the pool waits for the scheduled runs to finish.
+  }
+  bool changed = false;
+  for (const StatusOr<bool>& result : results) {
+    TF_RETURN_IF_ERROR(result.status());
+    changed |= result.ValueOrDie();
+  }
+  return changed;
+}
+
 }  // namespace
 
 StatusOr<bool> HloPassPipeline::Run(HloModule* module) {
@@ -73,6 +117,11 @@ StatusOr<bool> HloPassPipeline::Run(HloModule* module) {
     return Status::OK();
   };
 
+  const int num_threads =
+      module->config().debug_options().xla_hlo_pass_threads();
+  tensorflow::Env* env = tensorflow::Env::Default();
+  const uint64 pipeline_start_micros = env->NowMicros();
+
   string prefix = name().ToString() + ": pipeline start";
   bool changed = false;
   string message;
@@ -92,7 +141,29 @@ StatusOr<bool> HloPassPipeline::Run(HloModule* module) {
     StrAppend(&message, prefix, ", before ", pass->name());
     DumpModule(*module, message);
 
-    TF_ASSIGN_OR_RETURN(bool changed_this_pass, pass->Run(module));
+    const uint64 start_micros = env->NowMicros();
+    const size_t start_peak_bytes = tensorflow::port::PeakResidentMemoryBytes();
+    auto* computation_pass = dynamic_cast<HloComputationPass*>(pass.get());
+    TF_ASSIGN_OR_RETURN(
+        bool changed_this_pass,
+        computation_pass != nullptr
+            ? RunConcurrently(computation_pass, module, num_threads)
+            : pass->Run(module));
+    const uint64 elapsed_micros = env->NowMicros() - start_micros;
+    const size_t peak_bytes = tensorflow::port::PeakResidentMemoryBytes();
+    const size_t peak_increase_bytes =
+        peak_bytes > start_peak_bytes ? peak_bytes - start_peak_bytes : 0;
+    pass_run_time->GetCell(name().ToString(), pass->name().ToString())
+        ->IncrementBy(elapsed_micros);
+    pass_peak_memory_increase
+        ->GetCell(name().ToString(), pass->name().ToString())
+        ->IncrementBy(peak_increase_bytes);
+    VLOG(1) << "  HLO pass " << pass->name() << " took " << elapsed_micros
+            << " us; peak memory "
+            << tensorflow::strings::HumanReadableNumBytes(peak_bytes) << " (+"
+            << tensorflow::strings::HumanReadableNumBytes(peak_increase_bytes)
+            << ")";
+
     TF_RETURN_IF_ERROR(
         run_invariant_checkers(StrCat("after running pass: ", pass->name())));
 
@@ -101,6 +172,8 @@ StatusOr<bool> HloPassPipeline::Run(HloModule* module) {
     StrAppend(&prefix, name(), ": after ", pass->name());
   }
   DumpModule(*module, prefix + ", pipeline end");
+  VLOG(1) << "HLO pass pipeline " << name() << " took "
+          << env->NowMicros() - pipeline_start_micros << " us";
   return changed;
 }
 
@@ -222,6 +222,22 @@ class ShapeVerifier : public DfsHloVisitor {
                           dynamic_update_slice->operand(2)->shape()));
   }
 
+  Status HandleGather(HloInstruction* gather) override {
+    return CheckShape(gather, ShapeInference::InferGatherShape(
+                                  gather->operand(0)->shape(),
+                                  gather->operand(1)->shape(),
+                                  gather->indexed_dimension()));
+  }
+
+  Status HandleScatter(HloInstruction* scatter) override {
+    return CheckShape(
+        scatter, ShapeInference::InferScatterShape(
+                     scatter->operand(0)->shape(), scatter->operand(1)->shape(),
+                     scatter->operand(2)->shape(),
+                     scatter->to_apply()->ComputeProgramShape(),
+                     scatter->indexed_dimension()));
+  }
+
   Status HandleTuple(HloInstruction* tuple) override {
     return CheckVariadicShape(tuple);
   }
@@ -31,10 +31,21 @@ static const BufferAllocation* kParameterAllocation = new BufferAllocation(
     /*index=*/-1, /*size=*/0, /*is_thread_local=*/false, /*is_reusable=*/false,
     LogicalBuffer::Color(0));
 
+// Returns whether 'hlo' is a parameter of the entry computation whose buffer is
+// donated. Other buffers may be assigned to the allocation of such a
+// parameter, so it is treated like an ordinary buffer.
+static bool IsDonatedEntryParameter(const HloModule& module,
+                                    const HloInstruction& hlo) {
+  return hlo.opcode() == HloOpcode::kParameter &&
+         hlo.parent() == module.entry_computation() &&
+         module.config().is_donated_parameter(hlo.parameter_number());
+}
+
 void AliasAnalysis::AddAliasingInformationToIrArray(const HloInstruction& hlo,
                                                     llvm_ir::IrArray* array) {
   BufferAllocation::Slice buffer_slice;
-  if (hlo.opcode() == HloOpcode::kParameter) {
+  if (hlo.opcode() == HloOpcode::kParameter &&
+      !IsDonatedEntryParameter(module_, hlo)) {
     // Parameters may alias with each other but may not alias with our temporary
     // buffers.
     buffer_slice = BufferAllocation::Slice(kParameterAllocation, 0, 0);
@@ -77,7 +88,9 @@ void AliasAnalysis::AddAliasingInformationToIrArray(const HloInstruction& hlo,
           .xla_llvm_enable_invariant_load_metadata()) {
     // Parameters of the entry computation are never stored to, loading from a
     // parameter pointer should always return the same result within a loop.
-    if (hlo.opcode() == HloOpcode::kParameter) {
+    // Donated parameters may be overwritten once they are dead.
+    if (hlo.opcode() == HloOpcode::kParameter &&
+        !IsDonatedEntryParameter(module_, hlo)) {
       const std::vector<HloInstruction*>& parameter_instructions =
           module_.entry_computation()->parameter_instructions();
       if (std::find(parameter_instructions.begin(),
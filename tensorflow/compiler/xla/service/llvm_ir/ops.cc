@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/compiler/xla/service/llvm_ir/ops.h"
+#include "tensorflow/compiler/xla/primitive_util.h"
 #include "tensorflow/compiler/xla/service/gpu/parallel_loop_emitter.h"
 #include "tensorflow/compiler/xla/service/gpu/partition_assignment.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/fused_ir_emitter.h"
@@ -177,5 +178,38 @@ Status EmitParallelFusedDynamicUpdateSliceInPlace(
       &launch_dimensions, ir_builder);
 }
 
+bool CanScatterInPlace(HloInstruction* scatter,
+                       const BufferAssignment& assignment) {
+  CHECK_EQ(HloOpcode::kScatter, scatter->opcode());
+  const HloInstruction* operand = scatter->operand(0);
+  return assignment.HasTopLevelAllocation(scatter) &&
+         assignment.HasTopLevelAllocation(operand) &&
+         assignment.SharesTopLevelSlice(scatter, operand);
+}
+
+std::pair<IrArray::Index, llvm::Value*> EmitScatterOutputIndex(
+    const HloInstruction& scatter, const IrArray& indices_array,
+    const IrArray::Index& update_index, llvm::IRBuilder<>* ir_builder) {
+  CHECK_EQ(HloOpcode::kScatter, scatter.opcode());
+  const int64 dimension = scatter.indexed_dimension();
+  llvm::Value* position = indices_array.EmitReadArrayElement(
+      IrArray::Index({update_index[dimension]}), ir_builder, "position");
+  llvm::Type* index_type = update_index[dimension]->getType();
+  position = primitive_util::IsSignedIntegralType(
+                 indices_array.GetShape().element_type())
+                 ? ir_builder->CreateSExtOrTrunc(position, index_type)
+                 : ir_builder->CreateZExtOrTrunc(position, index_type);
+
+  // The unsigned comparison also rejects negative positions.
+  llvm::Value* in_bounds = ir_builder->CreateICmpULT(
+      position, llvm::ConstantInt::get(
+                    index_type, scatter.shape().dimensions(dimension)));
+  IrArray::Index output_index(update_index.size());
+  for (int64 i = 0; i < update_index.size(); ++i) {
+    output_index[i] = i == dimension ? position : update_index[i];
+  }
+  return {output_index, in_bounds};
+}
+
 }  // namespace llvm_ir
 }  // namespace xla
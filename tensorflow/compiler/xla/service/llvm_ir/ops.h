@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_COMPILER_XLA_SERVICE_LLVM_IR_OPS_H_
 #define THIRD_PARTY_TENSORFLOW_COMPILER_XLA_SERVICE_LLVM_IR_OPS_H_
 
+#include <utility>
+
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/elemental_ir_emitter.h"
 #include "tensorflow/compiler/xla/service/gpu/partition_assignment.h"
@@ -87,6 +89,23 @@ Status EmitParallelFusedDynamicUpdateSliceInPlace(
     const gpu::LaunchDimensions& launch_dimensions,
     llvm::IRBuilder<>* ir_builder);
 
+// Checks if we can emit code for the given Scatter node that updates its
+// operand in place, i.e. if the scatter's operand and output share the same
+// BufferAllocation::Slice. Otherwise the operand has to be copied to the
+// output before the updates are scattered.
+//
+// scatter must be a Scatter op.
+bool CanScatterInPlace(HloInstruction* scatter,
+                       const BufferAssignment& assignment);
+
+// Emits IR to read the position at which the element of the updates of the
+// given Scatter op at 'update_index' is scattered. Returns the index of the
+// output element it updates, and a condition which is true iff that position
+// is within the bounds of the output; updates out of bounds must be dropped.
+std::pair<IrArray::Index, llvm::Value*> EmitScatterOutputIndex(
+    const HloInstruction& scatter, const IrArray& indices_array,
+    const IrArray::Index& update_index, llvm::IRBuilder<>* ir_builder);
+
 }  // namespace llvm_ir
 }  // namespace xla
 
@@ -71,7 +71,9 @@ LocalService::LocalService(const ServiceOptions& options,
 StatusOr<std::unique_ptr<Executable>> LocalService::CompileExecutable(
     const ComputationHandle& computation,
     const tensorflow::gtl::ArraySlice<const Shape*> argument_layouts,
-    const Shape* result_layout, int device_ordinal) {
+    const Shape* result_layout,
+    tensorflow::gtl::ArraySlice<int64> donated_parameters,
+    int device_ordinal) {
   TF_ASSIGN_OR_RETURN(UserComputation * user_computation,
                       computation_tracker_.Resolve(computation));
   VersionedComputationHandle versioned_handle =
@@ -101,6 +103,19 @@ StatusOr<std::unique_ptr<Executable>> LocalService::CompileExecutable(
     TF_RETURN_IF_ERROR(
         ValidateResultShapeWithLayout(*result_layout, program_shape->result()));
   }
+  for (int64 parameter_number : donated_parameters) {
+    if (parameter_number < 0 ||
+        parameter_number >= program_shape->parameters_size()) {
+      return InvalidArgument("invalid donated parameter %lld",
+                             parameter_number);
+    }
+    if (!ShapeUtil::IsArray(program_shape->parameters(parameter_number))) {
+      return InvalidArgument(
+          "donated parameter %lld must be an array, got %s", parameter_number,
+          ShapeUtil::HumanString(program_shape->parameters(parameter_number))
+              .c_str());
+    }
+  }
 
   ExecutionOptions execution_options = CreateDefaultExecutionOptions();
   if (result_layout != nullptr) {
@@ -114,6 +129,8 @@ StatusOr<std::unique_ptr<Executable>> LocalService::CompileExecutable(
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<HloModuleConfig> module_config,
       CreateModuleConfig(*program_shape, argument_layouts, &execution_options));
+  module_config->set_donated_parameters(std::vector<int64>(
+      donated_parameters.begin(), donated_parameters.end()));
 
   TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
                       execute_backend_->stream_executor(device_ordinal));
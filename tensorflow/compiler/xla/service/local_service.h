@@ -41,11 +41,14 @@ class LocalService : public Service {
 
   // Builds an Executable with the given argument layouts and options. If
   // result_layout is non-null, then the executable is compiled to produce a
-  // result of the given layout.
+  // result of the given layout. The buffers of the parameters numbered in
+  // donated_parameters may be reused by the executable.
   StatusOr<std::unique_ptr<Executable>> CompileExecutable(
       const ComputationHandle& computation,
       const tensorflow::gtl::ArraySlice<const Shape*> argument_layouts,
-      const Shape* result_layout, int device_ordinal);
+      const Shape* result_layout,
+      tensorflow::gtl::ArraySlice<int64> donated_parameters,
+      int device_ordinal);
 
  private:
   explicit LocalService(const ServiceOptions& options,
@@ -317,19 +317,17 @@ StatusOr<bool> TrySinkReshapeOrTranspose(HloComputation* computation,
 
 }  // namespace
 
-StatusOr<bool> ReshapeMover::Run(HloModule* module) {
+StatusOr<bool> ReshapeMover::RunOnComputation(HloComputation* computation) {
   bool changed = false;
   VLOG(2) << "Pre ReshapeMover HLO:";
-  XLA_VLOG_LINES(2, module->ToString());
-  for (auto* comp : module->MakeNonfusionComputations()) {
-    for (HloInstruction* instruction : comp->MakeInstructionPostOrder()) {
-      TF_ASSIGN_OR_RETURN(bool did_change,
-                          TrySinkReshapeOrTranspose(comp, instruction));
-      changed |= did_change;
-    }
+  XLA_VLOG_LINES(2, computation->ToString());
+  for (HloInstruction* instruction : computation->MakeInstructionPostOrder()) {
+    TF_ASSIGN_OR_RETURN(bool did_change,
+                        TrySinkReshapeOrTranspose(computation, instruction));
+    changed |= did_change;
   }
   VLOG(2) << "Post ReshapeMover HLO:";
-  XLA_VLOG_LINES(2, module->ToString());
+  XLA_VLOG_LINES(2, computation->ToString());
   return changed;
 }
 
@@ -310,7 +310,8 @@ StatusOr<std::unique_ptr<HloModuleConfig>> Service::CreateModuleConfig(
     config->set_seed(execution_options->seed());
     config->set_debug_options(execution_options->debug_options());
     config->enable_hlo_profiling(
-        execution_options->debug_options().xla_hlo_profile());
+        execution_options->debug_options().xla_hlo_profile() ||
+        execution_options->debug_options().xla_hlo_profile_step_stats());
   } else {
     config->set_debug_options(legacy_flags::GetDebugOptionsFromFlags());
   }
@@ -1438,6 +1439,10 @@ tensorflow::Status Service::Op(const OpRequest* arg, OpResponse* result) {
       handle_status = computation->AddDynamicUpdateSliceInstruction(
           arg->dynamic_update_slice_request());
       break;
+    case OpRequest::kGatherRequest:
+      handle_status =
+          computation->AddGatherInstruction(arg->gather_request());
+      break;
     case OpRequest::kGetTupleElementRequest:
       handle_status = computation->AddGetTupleElementInstruction(
           arg->get_tuple_element_request());
@@ -1496,6 +1501,14 @@ tensorflow::Status Service::Op(const OpRequest* arg, OpResponse* result) {
     case OpRequest::kRngRequest:
       handle_status = computation->AddRngInstruction(arg->rng_request());
       break;
+    case OpRequest::kScatterRequest: {
+      TF_ASSIGN_OR_RETURN(
+          UserComputation * to_apply,
+          computation_tracker_.Resolve(arg->scatter_request().to_apply()));
+      handle_status = computation->AddScatterInstruction(
+          arg->scatter_request(), *to_apply);
+      break;
+    }
     case OpRequest::kSelectAndScatterRequest: {
       TF_ASSIGN_OR_RETURN(UserComputation * select,
                           computation_tracker_.Resolve(
@@ -2021,6 +2021,72 @@ ShapeInference::InferDegenerateDimensionBroadcastShape(
   return operand_shape;
 }
 
+namespace {
+
+// Checks the operand and indices of a gather or scatter along dimension.
+tensorflow::Status ExpectGatherOrScatterOperands(const Shape& operand_shape,
+                                                 const Shape& indices_shape,
+                                                 int64 dimension,
+                                                 const char* op_type) {
+  TF_RETURN_IF_ERROR(ExpectNotTupleOrOpaque(
+      operand_shape, tensorflow::strings::StrCat("operand of ", op_type)));
+  TF_RETURN_IF_ERROR(ExpectNotTupleOrOpaque(
+      indices_shape, tensorflow::strings::StrCat("indices of ", op_type)));
+  if (ShapeUtil::Rank(indices_shape) != 1) {
+    return InvalidArgument("%s indices of rank %lld must be rank 1.", op_type,
+                           ShapeUtil::Rank(indices_shape));
+  }
+  if (!ShapeUtil::ElementIsIntegral(indices_shape)) {
+    return InvalidArgument("%s indices must be of integral type.", op_type);
+  }
+  if (dimension < 0 || dimension >= ShapeUtil::Rank(operand_shape)) {
+    return InvalidArgument("%s dimension %lld is out of bounds for shape %s",
+                           op_type, dimension,
+                           ShapeUtil::HumanString(operand_shape).c_str());
+  }
+  return tensorflow::Status::OK();
+}
+
+}  // namespace
+
+/* static */ StatusOr<Shape> ShapeInference::InferGatherShape(
+    const Shape& operand_shape, const Shape& indices_shape, int64 dimension) {
+  TF_RETURN_IF_ERROR(ExpectGatherOrScatterOperands(operand_shape, indices_shape,
+                                                   dimension, "gather"));
+  std::vector<int64> dimensions(operand_shape.dimensions().begin(),
+                                operand_shape.dimensions().end());
+  dimensions[dimension] = indices_shape.dimensions(0);
+  return ShapeUtil::MakeShape(operand_shape.element_type(), dimensions);
+}
+
+/* static */ StatusOr<Shape> ShapeInference::InferScatterShape(
+    const Shape& operand_shape, const Shape& indices_shape,
+    const Shape& updates_shape, const ProgramShape& to_apply_shape,
+    int64 dimension) {
+  TF_RETURN_IF_ERROR(ExpectGatherOrScatterOperands(operand_shape, indices_shape,
+                                                   dimension, "scatter"));
+  TF_RETURN_IF_ERROR(
+      ExpectNotTupleOrOpaque(updates_shape, "updates of scatter"));
+
+  Shape expected_updates_shape = operand_shape;
+  expected_updates_shape.set_dimensions(dimension,
+                                        indices_shape.dimensions(0));
+  if (!ShapeUtil::SameDimensions(updates_shape, expected_updates_shape)) {
+    return InvalidArgument(
+        "scatter updates shape %s must be the operand shape %s with dimension "
+        "%lld of the size of the indices %s",
+        ShapeUtil::HumanString(updates_shape).c_str(),
+        ShapeUtil::HumanString(operand_shape).c_str(), dimension,
+        ShapeUtil::HumanString(indices_shape).c_str());
+  }
+
+  // The current value at each position acts as the accumulator.
+  TF_RETURN_IF_ERROR(VerifyReducerShape(
+      to_apply_shape, ShapeUtil::MakeShape(operand_shape.element_type(), {}),
+      updates_shape.element_type()));
+  return operand_shape;
+}
+
 /*static */ StatusOr<Shape> ShapeInference::InferReverseShape(
     const Shape& operand_shape, tensorflow::gtl::ArraySlice<int64> dimensions) {
   TF_RETURN_IF_ERROR(
@@ -165,6 +165,21 @@ class ShapeInference {
       const Shape& operand_shape, const Shape& update_shape,
       const Shape& start_indices_shape);
 
+  // Infers the shape produced by gathering the slices of operand along
+  // dimension at the given indices.
+  static StatusOr<Shape> InferGatherShape(const Shape& operand_shape,
+                                          const Shape& indices_shape,
+                                          int64 dimension);
+
+  // Infers the shape produced by scattering the slices of updates along
+  // dimension into operand at the given indices, combining them with
+  // to_apply.
+  static StatusOr<Shape> InferScatterShape(const Shape& operand_shape,
+                                           const Shape& indices_shape,
+                                           const Shape& updates_shape,
+                                           const ProgramShape& to_apply_shape,
+                                           int64 dimension);
+
   // Infers the shape produced by doing a compile-time-constant indexing into
   // the given input shape. This is essential for operations on tuples, because
   // it is impossible to infer the type that comes out of the tuple indexing if
@@ -789,6 +789,37 @@ TEST_F(ShapeInferenceTest, InferSliceShapeRank1) {
   ASSERT_TRUE(ShapeUtil::Equal(inferred, ShapeUtil::MakeShape(F32, {2})));
 }
 
+TEST_F(ShapeInferenceTest, InferGatherShape) {
+  Shape indices_shape = ShapeUtil::MakeShape(S32, {5});
+  auto inferred_status =
+      ShapeInference::InferGatherShape(matrix_32_64_, indices_shape, 1);
+  ASSERT_IS_OK(inferred_status.status());
+  ASSERT_TRUE(ShapeUtil::Equal(ShapeUtil::MakeShape(F32, {32, 5}),
+                               inferred_status.ValueOrDie()));
+}
+
+TEST_F(ShapeInferenceTest, InferGatherShapeWithMatrixIndices) {
+  auto inferred_status =
+      ShapeInference::InferGatherShape(matrix_32_64_, s32matrix_64_64_, 0);
+  ASSERT_FALSE(inferred_status.ok());
+  ASSERT_THAT(inferred_status.status().error_message(),
+              HasSubstr("rank 1"));
+}
+
+TEST_F(ShapeInferenceTest, InferScatterShape) {
+  Shape indices_shape = ShapeUtil::MakeShape(S32, {5});
+  Shape updates_shape = ShapeUtil::MakeShape(F32, {5, 64});
+  ProgramShape to_apply = ShapeUtil::MakeProgramShape({f32_, f32_}, f32_);
+  auto inferred_status = ShapeInference::InferScatterShape(
+      matrix_32_64_, indices_shape, updates_shape, to_apply, 0);
+  ASSERT_IS_OK(inferred_status.status());
+  ASSERT_TRUE(ShapeUtil::Equal(matrix_32_64_, inferred_status.ValueOrDie()));
+
+  inferred_status = ShapeInference::InferScatterShape(
+      matrix_32_64_, indices_shape, matrix_32_64_, to_apply, 0);
+  ASSERT_FALSE(inferred_status.ok());
+}
+
 TEST_F(ShapeInferenceTest, InferConstIndexShape) {
   Shape tuple_shape = ShapeUtil::MakeTupleShape({f32_, s32_});
   auto inferred0_status =
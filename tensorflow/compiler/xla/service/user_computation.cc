@@ -950,6 +950,74 @@ StatusOr<ComputationDataHandle> UserComputation::AddDynamicSliceInstruction(
   return handle;
 }
 
+StatusOr<ComputationDataHandle> UserComputation::AddGatherInstruction(
+    const GatherRequest& gather_request) {
+  tensorflow::mutex_lock lock(mutex_);
+
+  TF_ASSIGN_OR_RETURN(const OperationRequest* operand,
+                      LookUpRequest(gather_request.operand()));
+  TF_ASSIGN_OR_RETURN(const OperationRequest* indices,
+                      LookUpRequest(gather_request.indices()));
+
+  TF_ASSIGN_OR_RETURN(Shape new_shape,
+                      ShapeInference::InferGatherShape(
+                          operand->output_shape(), indices->output_shape(),
+                          gather_request.dimension()));
+
+  ComputationDataHandle handle = CreateComputationDataHandle();
+
+  OperationRequest& request =
+      (*session_computation_.mutable_requests())[handle.handle()];
+  *request.mutable_output_handle() = handle;
+  *request.mutable_output_shape() = new_shape;
+  *request.mutable_request()->mutable_gather_request() = gather_request;
+
+  VLOG(1) << "AddGatherInstruction (" << GetVersionedHandleInternal()
+          << "), data handle " << handle.handle() << ": "
+          << gather_request.ShortDebugString();
+  return handle;
+}
+
+StatusOr<ComputationDataHandle> UserComputation::AddScatterInstruction(
+    const ScatterRequest& scatter_request,
+    const UserComputation& to_apply_computation) {
+  tensorflow::mutex_lock lock(mutex_);
+
+  TF_ASSIGN_OR_RETURN(const OperationRequest* operand,
+                      LookUpRequest(scatter_request.operand()));
+  TF_ASSIGN_OR_RETURN(const OperationRequest* indices,
+                      LookUpRequest(scatter_request.indices()));
+  TF_ASSIGN_OR_RETURN(const OperationRequest* updates,
+                      LookUpRequest(scatter_request.updates()));
+
+  VersionedComputationHandle::Version to_apply_version =
+      to_apply_computation.version();
+  TF_ASSIGN_OR_RETURN(
+      std::shared_ptr<const ProgramShape> to_apply_program_shape,
+      to_apply_computation.ComputeProgramShape(to_apply_version));
+
+  TF_ASSIGN_OR_RETURN(
+      Shape inferred_shape,
+      ShapeInference::InferScatterShape(
+          operand->output_shape(), indices->output_shape(),
+          updates->output_shape(), *to_apply_program_shape,
+          scatter_request.dimension()));
+
+  ComputationDataHandle handle = CreateComputationDataHandle();
+
+  OperationRequest& request =
+      (*session_computation_.mutable_requests())[handle.handle()];
+  *request.mutable_output_handle() = handle;
+  *request.mutable_output_shape() = inferred_shape;
+  request.add_embedded_computation_versions(to_apply_version);
+  *request.mutable_request()->mutable_scatter_request() = scatter_request;
+
+  VLOG(1) << "AddScatterInstruction (" << GetVersionedHandleInternal()
+          << "), data handle " << handle.handle() << ": "
+          << scatter_request.ShortDebugString();
+  return handle;
+}
+
 StatusOr<ComputationDataHandle>
 UserComputation::AddDynamicUpdateSliceInstruction(
     const DynamicUpdateSliceRequest& dynamic_update_slice_request) {
@@ -1631,6 +1699,28 @@ void PureFunctionalVisitor(const SessionComputation& session_computation,
       break;
     }
 
+    case OpRequest::kGatherRequest: {
+      const GatherRequest& gather_request = request.request().gather_request();
+      PureFunctionalVisitor(session_computation, gather_request.operand(),
+                            num_parameters, visited, is_functional);
+      PureFunctionalVisitor(session_computation, gather_request.indices(),
+                            num_parameters, visited, is_functional);
+      break;
+    }
+
+    case OpRequest::kScatterRequest: {
+      const ScatterRequest& scatter_request =
+          request.request().scatter_request();
+      PureFunctionalVisitor(session_computation, scatter_request.operand(),
+                            num_parameters, visited, is_functional);
+      PureFunctionalVisitor(session_computation, scatter_request.indices(),
+                            num_parameters, visited, is_functional);
+      PureFunctionalVisitor(session_computation, scatter_request.updates(),
+                            num_parameters, visited, is_functional);
+      // TODO(b/32495713): We aren't checking the to_apply computation itself.
+      break;
+    }
+
     case OpRequest::kDynamicUpdateSliceRequest: {
       const DynamicUpdateSliceRequest& dynamic_update_slice_request =
           request.request().dynamic_update_slice_request();
@@ -2056,6 +2146,17 @@ UserComputation::GetEmbeddedComputations(
           break;
         }
 
+        case OpRequest::kScatterRequest: {
+          CHECK_EQ(1, request.embedded_computation_versions_size());
+          const ScatterRequest& scatter_request =
+              request.request().scatter_request();
+          const VersionedComputationHandle versioned_handle = {
+              scatter_request.to_apply(),
+              request.embedded_computation_versions(0)};
+          computations.push_back(versioned_handle);
+          break;
+        }
+
         case OpRequest::kSelectAndScatterRequest: {
           CHECK_EQ(2, request.embedded_computation_versions_size());
           const SelectAndScatterRequest& select_and_scatter_request =
@@ -2167,6 +2268,13 @@ Status UserComputation::RemapEmbeddedComputations(
         TF_RETURN_IF_ERROR(update(reduce_window_request->mutable_to_apply()));
         break;
       }
+      case OpRequest::kScatterRequest: {
+        TF_RET_CHECK(1 == request.embedded_computation_versions_size());
+        ScatterRequest* scatter_request =
+            request.mutable_request()->mutable_scatter_request();
+        TF_RETURN_IF_ERROR(update(scatter_request->mutable_to_apply()));
+        break;
+      }
       case OpRequest::kSelectAndScatterRequest: {
         TF_RET_CHECK(2 == request.embedded_computation_versions_size());
         SelectAndScatterRequest* select_and_scatter_request =
@@ -2371,6 +2479,22 @@ static void ForEachOperand(
       break;
     }
 
+    case OpRequest::kGatherRequest: {
+      const GatherRequest& gather_request = request.request().gather_request();
+      apply(gather_request.operand());
+      apply(gather_request.indices());
+      break;
+    }
+
+    case OpRequest::kScatterRequest: {
+      const ScatterRequest& scatter_request =
+          request.request().scatter_request();
+      apply(scatter_request.operand());
+      apply(scatter_request.indices());
+      apply(scatter_request.updates());
+      break;
+    }
+
     case OpRequest::kDynamicUpdateSliceRequest: {
       const DynamicUpdateSliceRequest& dynamic_update_slice_request =
           request.request().dynamic_update_slice_request();
@@ -2832,6 +2956,33 @@ void ComputationLowerer::Visit(
       break;
     }
 
+    case OpRequest::kGatherRequest: {
+      const GatherRequest& gather_request = request.request().gather_request();
+      HloInstruction* operand = lookup_instruction(gather_request.operand());
+      HloInstruction* indices = lookup_instruction(gather_request.indices());
+      hlo_instruction = add_instruction(HloInstruction::CreateGather(
+          request.output_shape(), operand, indices,
+          gather_request.dimension()));
+      break;
+    }
+
+    case OpRequest::kScatterRequest: {
+      const ScatterRequest& scatter_request =
+          request.request().scatter_request();
+      HloInstruction* operand = lookup_instruction(scatter_request.operand());
+      HloInstruction* indices = lookup_instruction(scatter_request.indices());
+      HloInstruction* updates = lookup_instruction(scatter_request.updates());
+      CHECK_EQ(1, request.embedded_computation_versions_size());
+      VersionedComputationHandle::Version to_apply_version =
+          request.embedded_computation_versions(0);
+      HloComputation* to_apply =
+          ResolveComputation(scatter_request.to_apply(), to_apply_version);
+      hlo_instruction = add_instruction(HloInstruction::CreateScatter(
+          request.output_shape(), operand, indices, updates, to_apply,
+          scatter_request.dimension()));
+      break;
+    }
+
     case OpRequest::kDynamicUpdateSliceRequest: {
       const DynamicUpdateSliceRequest& dynamic_update_slice_request =
           request.request().dynamic_update_slice_request();
@@ -181,6 +181,15 @@ class UserComputation {
   StatusOr<ComputationDataHandle> AddDynamicUpdateSliceInstruction(
       const DynamicUpdateSliceRequest& dynamic_update_slice_request);
 
+  // Enqueues a gather instruction onto this user computation.
+  StatusOr<ComputationDataHandle> AddGatherInstruction(
+      const GatherRequest& gather_request);
+
+  // Enqueues a scatter instruction onto this user computation.
+  StatusOr<ComputationDataHandle> AddScatterInstruction(
+      const ScatterRequest& scatter_request,
+      const UserComputation& to_apply_computation);
+
   // Enqueues a concatenate instruction onto this user computation.
   StatusOr<ComputationDataHandle> AddConcatenateInstruction(
       const ConcatenateRequest& concatenate_request);
@@ -327,6 +327,22 @@ XLA_TEST_F(DotOperationTest, MatrixDotF32_260_3_520_MinorToMajorFF) {
   TestMatrixDot(260, 3, 520, false, false);
 }
 
+XLA_TEST_F(DotOperationTest, MatrixDotF32_128_128_128_MinorToMajorTT) {
+  TestMatrixDot(128, 128, 128, true, true);
+}
+
+XLA_TEST_F(DotOperationTest, MatrixDotF32_128_128_128_MinorToMajorFF) {
+  TestMatrixDot(128, 128, 128, false, false);
+}
+
+XLA_TEST_F(DotOperationTest, MatrixDotF32_13_300_21_MinorToMajorTT) {
+  TestMatrixDot(13, 300, 21, true, true);
+}
+
+XLA_TEST_F(DotOperationTest, MatrixDotF32_13_300_21_MinorToMajorFF) {
+  TestMatrixDot(13, 300, 21, false, false);
+}
+
 XLA_TEST_F(DotOperationTest, MatrixVectorDotF32_1x8x8) {
   TestMatrixDot(1, 8, 8, true, true);
 }
@@ -155,6 +155,7 @@ StatusOr<std::unique_ptr<Literal>> CreateLiteralForConstrainedUses(
 
       case HloOpcode::kReduce:
       case HloOpcode::kReduceWindow:
+      case HloOpcode::kScatter:
       case HloOpcode::kSelectAndScatter:
         needs_zero = use;
         break;
@@ -88,6 +88,7 @@ void RealMain(tensorflow::gtl::ArraySlice<char*> args) {
     StatusOr<std::unique_ptr<Executable>> executable =
         local_service->CompileExecutable(computation.handle(), layouts,
                                          &program_shape->result(),
+                                         /*donated_parameters=*/{},
                                          /*device_ordinal=*/0);
 
     const HloModule& module = executable.ValueOrDie()->module();
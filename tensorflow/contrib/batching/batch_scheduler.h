@@ -29,6 +29,7 @@ limitations under the License.
 #include <stddef.h>
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -44,6 +45,9 @@ limitations under the License.
 namespace tensorflow {
 namespace serving {
 
+// The deadline of tasks that don't have one. See BatchTask::deadline_micros().
+constexpr uint64 kNoDeadlineMicros = std::numeric_limits<uint64>::max();
+
 // The abstract superclass for a unit of work to be done as part of a batch.
 //
 // An implementing subclass typically contains (or points to):
@@ -62,6 +66,16 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the time (in Env::NowMicros() terms) by which the task should be
+  // done, or kNoDeadlineMicros. Schedulers that support deadlines serve tasks
+  // with earlier deadlines first, and may give up on tasks whose deadline has
+  // passed.
+  virtual uint64 deadline_micros() const { return kNoDeadlineMicros; }
+
+  // Returns the priority class of the task. Tasks with higher priorities are
+  // served first among tasks with equal deadlines.
+  virtual int priority() const { return 0; }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <numeric>
+
 #include "tensorflow/contrib/batching/shared_batch_scheduler.h"
 #include "tensorflow/contrib/batching/util/periodic_function.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -25,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
@@ -209,6 +213,7 @@ class BatchResource : public ResourceBase {
   static Status Create(int32 num_batch_threads, int32 max_batch_size,
                        int32 batch_timeout_micros,
                        const std::vector<int32>& allowed_batch_sizes,
+                       bool sort_by_length,
                        std::unique_ptr<BatchResource>* resource) {
     std::unique_ptr<BatchResource> new_resource(new BatchResource);
 
@@ -222,6 +227,7 @@ class BatchResource : public ResourceBase {
         batch_timeout_micros;
 
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
+    new_resource->sort_by_length_ = sort_by_length;
 
     *resource = std::move(new_resource);
     return Status::OK();
@@ -230,9 +236,12 @@ class BatchResource : public ResourceBase {
   string DebugString() final { return "BatchResource"; }
 
   // Ingests data from one invocation of the batch op. The data is enqueued to
-  // be combined with others into a batch, asynchronously.
+  // be combined with others into a batch, asynchronously. If 'length_buckets'
+  // is non-empty, the data is only batched with invocations whose
+  // 0th-dimension size falls in the same bucket.
   Status RegisterInput(int64 guid, OpKernelContext* context,
                        const string& batcher_queue_name,
+                       const std::vector<int32>& length_buckets,
                        AsyncOpKernel::DoneCallback done_callback) {
     std::unique_ptr<BatchTask> batch_components(new BatchTask);
     batch_components->guid = guid;
@@ -255,9 +264,19 @@ class BatchResource : public ResourceBase {
     batch_components->context = context;
     batch_components->done_callback = std::move(done_callback);
 
+    string queue_name = batcher_queue_name;
+    if (!length_buckets.empty()) {
+      const int64 length = batch_components->size();
+      size_t bucket = 0;
+      while (bucket < length_buckets.size() &&
+             length > length_buckets[bucket]) {
+        ++bucket;
+      }
+      strings::StrAppend(&queue_name, "/length_bucket_", bucket);
+    }
+
     BatcherQueue* batcher_queue;
-    TF_RETURN_IF_ERROR(
-        LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+    TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(queue_name, &batcher_queue));
     return batcher_queue->Schedule(&batch_components);
   }
 
@@ -331,6 +350,16 @@ class BatchResource : public ResourceBase {
     // All tasks should have the same number of input edges.
     const int num_input_edges = batch->task(0).inputs.size();
 
+    // The order in which the tasks' inputs are concatenated.
+    std::vector<int> task_order(batch->num_tasks());
+    std::iota(task_order.begin(), task_order.end(), 0);
+    if (sort_by_length_) {
+      std::stable_sort(task_order.begin(), task_order.end(),
+                       [&batch](int a, int b) {
+                         return batch->task(a).size() > batch->task(b).size();
+                       });
+    }
+
     // Process each input edge one at a time (the typical case has just one).
     for (int i = 0; i < num_input_edges; ++i) {
       // Emit batch->num_tasks() - 1 empty output tensors.
@@ -348,7 +377,7 @@ class BatchResource : public ResourceBase {
       // Concatenate the tasks ith input tensors into a big output tensor.
       std::vector<Tensor> to_concatenate;
       to_concatenate.reserve(batch->num_tasks());
-      for (int task_idx = 0; task_idx < batch->num_tasks(); ++task_idx) {
+      for (const int task_idx : task_order) {
         to_concatenate.push_back(batch->task(task_idx).inputs.at(i));
       }
 
@@ -426,7 +455,8 @@ class BatchResource : public ResourceBase {
     }
     OP_REQUIRES_OK_ASYNC(
         last_task_context,
-        EmitIndexTensor(last_task_context, *batch, num_input_edges),
+        EmitIndexTensor(last_task_context, *batch, task_order,
+                        num_input_edges),
         last_task_callback);
 
     // Signal done for each element of the batch. (At this point, the contexts
@@ -440,10 +470,12 @@ class BatchResource : public ResourceBase {
   // the tensor and attribute the pieces to the right batch keys. The index
   // tensor contains, for each input: [batch_key, start_offset, end_offset]
   // where start_offset and end_offset represent the range of entries in the
-  // concatenated tensors that belong to that input.
+  // concatenated tensors that belong to that input. The rows follow
+  // 'task_order', the order in which the inputs were concatenated.
   //
   // Emits the result to the output at 'output_index' using 'context'.
   static Status EmitIndexTensor(OpKernelContext* context, const Batch& batch,
+                                const std::vector<int>& task_order,
                                 int output_index) {
     const TensorShape index_shape({batch.num_tasks(), 3});
     Tensor* index = nullptr;
@@ -451,11 +483,11 @@ class BatchResource : public ResourceBase {
         context->allocate_output(output_index, index_shape, &index));
     auto index_flat = index->shaped<int64, 2>({batch.num_tasks(), 3});
     size_t offset = 0;
-    for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
-      const BatchTask& task = batch.task(task_idx);
-      index_flat(task_idx, 0) = task.guid;
-      index_flat(task_idx, 1) = offset;
-      index_flat(task_idx, 2) = offset + task.size();
+    for (int row = 0; row < batch.num_tasks(); ++row) {
+      const BatchTask& task = batch.task(task_order[row]);
+      index_flat(row, 0) = task.guid;
+      index_flat(row, 1) = offset;
+      index_flat(row, 2) = offset + task.size();
       offset += task.size();
     }
     return Status::OK();
@@ -496,6 +528,9 @@ class BatchResource : public ResourceBase {
       GUARDED_BY(batcher_queues_mu_);
 
   std::vector<int32> allowed_batch_sizes_;
+
+  // Whether to concatenate the tasks of a batch in decreasing size order.
+  bool sort_by_length_ = false;
 };
 
 class BatchKernel : public AsyncOpKernel {
@@ -515,6 +550,9 @@ class BatchKernel : public AsyncOpKernel {
                    c->GetAttr("batch_timeout_micros", &batch_timeout_micros_));
     OP_REQUIRES_OK(c, c->GetAttr("allowed_batch_sizes", &allowed_batch_sizes_));
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
+    OP_REQUIRES_OK(c, c->GetAttr("length_buckets", &length_buckets_));
+    OP_REQUIRES_OK(c, ValidateLengthBuckets());
+    OP_REQUIRES_OK(c, c->GetAttr("sort_by_length", &sort_by_length_));
   }
 
   void ComputeAsync(OpKernelContext* c, DoneCallback done) final {
@@ -524,7 +562,7 @@ class BatchKernel : public AsyncOpKernel {
           std::unique_ptr<BatchResource> new_resource;
           TF_RETURN_IF_ERROR(BatchResource::Create(
               num_batch_threads_, max_batch_size_, batch_timeout_micros_,
-              allowed_batch_sizes_, &new_resource));
+              allowed_batch_sizes_, sort_by_length_, &new_resource));
           *r = new_resource.release();
           return Status::OK();
         };
@@ -533,7 +571,8 @@ class BatchKernel : public AsyncOpKernel {
                              container_, shared_name_, &br, creator),
                          done);
     const Status status =
-        br->RegisterInput(random::New64(), c, batcher_queue_, done);
+        br->RegisterInput(random::New64(), c, batcher_queue_, length_buckets_,
+                          done);
     br->Unref();
     if (!status.ok()) {
       OP_REQUIRES_OK_ASYNC(c, status, done);
@@ -563,6 +602,22 @@ class BatchKernel : public AsyncOpKernel {
     return Status::OK();
   }
 
+  // Validates 'length_buckets_'. The entries must be positive and increase
+  // monotonically.
+  Status ValidateLengthBuckets() const {
+    for (size_t i = 0; i < length_buckets_.size(); ++i) {
+      if (length_buckets_[i] <= 0) {
+        return errors::InvalidArgument(
+            "length_buckets entries must be positive");
+      }
+      if (i > 0 && length_buckets_[i] <= length_buckets_[i - 1]) {
+        return errors::InvalidArgument(
+            "length_buckets entries must be monotonically increasing");
+      }
+    }
+    return Status::OK();
+  }
+
  private:
   string container_;
   string shared_name_;
@@ -571,6 +626,8 @@ class BatchKernel : public AsyncOpKernel {
   int32 max_batch_size_;
   int32 batch_timeout_micros_;
   std::vector<int32> allowed_batch_sizes_;
+  std::vector<int32> length_buckets_;
+  bool sort_by_length_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("Batch").Device(DEVICE_CPU), BatchKernel);
@@ -32,6 +32,8 @@ REGISTER_OP("Batch")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
     .Attr("batching_queue: string = ''")
+    .Attr("length_buckets: list(int) = []")
+    .Attr("sort_by_length: bool = false")
     .Attr("T: list(type)")
     .SetShapeFn([](shape_inference::InferenceContext* c) {
       std::vector<shape_inference::ShapeHandle> in_shapes;
@@ -69,6 +71,14 @@ start, and length of elements of each set of Tensors present in batched_tensors.
 Batched tensors are concatenated along the first dimension, and all tensors in
 in_tensors must have the first dimension of the same size.
 
+Variable-length inputs, such as token sequences, can be batched without padding
+them to a common length: feed each sequence with its length as the first
+dimension. The batched tensors then hold the packed values, and columns 1 and 2
+of batch_index are the row splits of each sequence. With length_buckets the
+sequences are batched only with others of similar length, and with
+sort_by_length they are packed from longest to shortest, which lets downstream
+kernels process roughly the real number of tokens.
+
 in_tensors: The tensors to be batched.
 num_batch_threads: Number of scheduling threads for processing batches of work.
  Determines the number of batches processed in parallel.
@@ -87,6 +97,13 @@ id: always contains a scalar with a unique ID for this invocation of Batch.
 shared_name: Concurrently running instances of batch in the same device with the
  same container and shared_name will batch their elements together. If left
  empty, the op name will be used as the shared name.
+length_buckets: Optional list of first-dimension size boundaries. If left empty,
+ does nothing. Otherwise, invocations are batched separately by the smallest
+ boundary that their first-dimension size doesn't exceed, with sizes above all
+ boundaries forming a last bucket. The entries must be positive and increase
+ monotonically.
+sort_by_length: If true, the invocations of a batch are concatenated in
+ decreasing order of their first-dimension size, as reflected by batch_index.
 T: the types of tensors to be batched.
 )doc");
 
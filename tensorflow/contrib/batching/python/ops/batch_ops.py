@@ -62,7 +62,9 @@ def _UnbatchGrad(op, grad):   # pylint: disable=invalid-name
 def batch_function(num_batch_threads, max_batch_size, batch_timeout_micros,
                    allowed_batch_sizes=None,
                    grad_timeout_micros=60 * 1000 * 1000,
-                   unbatch_timeout_micros=60 * 1000 * 1000):
+                   unbatch_timeout_micros=60 * 1000 * 1000,
+                   length_buckets=None,
+                   sort_by_length=False):
   """Batches the computation done by the decorated function.
 
   So, for example, in the following code
@@ -100,6 +102,11 @@ def batch_function(num_batch_threads, max_batch_size, batch_timeout_micros,
      documentation of the unbatch op for more details. Defaults to 60s.
     unbatch_timeout_micros: The timeout to use for unbatching. See the
      documentation of the unbatch op for more details. Defaults to 60s.
+    length_buckets: Optional list of first-dimension size boundaries, so that
+     variable-length arguments are only batched with others of similar length.
+     See the documentation of the batch op for more details.
+    sort_by_length: If True, the arguments of a batch are concatenated from
+     the largest to the smallest first dimension.
 
   Returns:
     The decorated function will return the unbatched computation output Tensors.
@@ -119,6 +126,8 @@ def batch_function(num_batch_threads, max_batch_size, batch_timeout_micros,
             batch_timeout_micros=batch_timeout_micros,
             allowed_batch_sizes=allowed_batch_sizes,
             grad_timeout_micros=grad_timeout_micros,
+            length_buckets=length_buckets,
+            sort_by_length=sort_by_length,
             shared_name=name)
         outputs = f(*batched_tensors)
         if isinstance(outputs, ops.Tensor):
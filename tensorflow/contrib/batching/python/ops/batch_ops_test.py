@@ -147,6 +147,31 @@ class BatchOpsTest(test.TestCase):
       self.assertAllEqual(empty_t[0], [])
       self.assertAllEqual(empty_t[1], [])
 
+  def testBatchSortByLength(self):
+    """Tests that variable-length inputs are packed longest first."""
+    with self.test_session() as sess:
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[None])
+      batched, index, _ = batch_ops.batch(
+          [inp], num_batch_threads=1, max_batch_size=4,
+          batch_timeout_micros=36000000, grad_timeout_micros=0,
+          batching_queue="", length_buckets=[4], sort_by_length=True)
+      thread_results = []
+
+      def worker():
+        thread_results.extend(
+            sess.run([batched, index], feed_dict={inp: [1]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      time.sleep(0.1)  # Let the worker enqueue the short input first.
+      main_results = sess.run([batched, index], feed_dict={inp: [2, 3, 4]})
+      worker_thread.join()
+
+      self.assertAllEqual(thread_results[0][0], [])
+      self.assertAllEqual(main_results[0][0], [2, 3, 4, 1])
+      # Columns 1 and 2 of the index hold the row splits of the inputs.
+      self.assertAllEqual(main_results[1][:, 1:], [[0, 3], [3, 4]])
+
   def testIllegalBatchDifferentDim0Sizes(self):
     """Tests illegally feeding tensors with different dim0 sizes."""
     with self.test_session() as sess:
@@ -17,8 +17,10 @@ limitations under the License.
 #define THIRD_PARTY_TENSORFLOW_CONTRIB_BATCHING_SHARED_BATCH_SCHEDULER_H_
 
 #include <stddef.h>
+#include <algorithm>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/contrib/batching/util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
@@ -90,7 +93,13 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
-// TODO(b/26539183): Support queue servicing policies other than round-robin.
+// When interactive and bulk traffic share the threads, the kEarliestDeadline
+// servicing policy lets tasks carry a deadline and priority (see BatchTask):
+// the threads then take the schedulable batch holding the most urgent task
+// instead of going round-robin, and queues that set an expired-tasks callback
+// hand back the tasks whose deadline passed before their batch was scheduled.
+//
+// TODO(b/26539183): Support queue servicing policies based on shares.
 // E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
 // and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
 //
@@ -113,6 +122,14 @@ class SharedBatchScheduler
     // The environment to use.
     // (Typically only overridden by test code.)
     Env* env = Env::Default();
+
+    // How the batch threads choose the queue to take the next batch from:
+    //  - kRoundRobin: cycle through the queues with a schedulable batch.
+    //  - kEarliestDeadline: take the schedulable batch that holds the task with
+    //    the earliest deadline, then the highest priority, breaking remaining
+    //    ties round-robin. This costs a scan of all the queues per batch.
+    enum class ServicingPolicy { kRoundRobin, kEarliestDeadline };
+    ServicingPolicy servicing_policy = ServicingPolicy::kRoundRobin;
   };
   // Ownership is shared between the caller of Create() and any queues created
   // via AddQueue().
@@ -157,6 +174,33 @@ class SharedBatchScheduler
     // See the class documentation above for guidelines on how to tune this
     // parameter.
     int max_enqueued_batches = 10;
+
+    // If set, the tasks whose deadline (see BatchTask::deadline_micros()) has
+    // passed when their batch is scheduled are taken out of it and handed to
+    // this callback, in a closed batch of their own, instead of being
+    // processed. The callback typically fails them with DEADLINE_EXCEEDED. If
+    // unset, late tasks are processed like any other.
+    std::function<void(std::unique_ptr<Batch<TaskType>>)>
+        expired_tasks_callback;
+
+    // If non-empty, the time that batches wait in the queue and the time they
+    // take to process are recorded with this label in the
+    // /tensorflow/serving/batching/queuing_latency and
+    // /tensorflow/serving/batching/processing_latency histograms.
+    string metrics_label;
+
+    // If positive, the queue treats 'max_batch_size' and
+    // 'batch_timeout_micros' as upper bounds, and adapts the batch size at
+    // which a batch becomes schedulable, and the timeout, to keep the 99th
+    // percentile of the batch latency (from the first task being enqueued to
+    // the end of the process-batch callback) below this many microseconds.
+    // Every 'latency_adjustment_batches' batches, the parameters are cut back
+    // in proportion to the target overshoot, or grown by an eighth of their
+    // bounds when the latency is well under the target, and the batch size is
+    // capped to what a linear fit of processing time vs. batch size predicts
+    // can be processed within the target.
+    int64 target_latency_micros = 0;
+    int latency_adjustment_batches = 100;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -172,6 +216,12 @@ class SharedBatchScheduler
   // no queues provide a batch to process, just sleeps briefly and exits.
   void ThreadLogic();
 
+  // Used by ThreadLogic() with the kEarliestDeadline policy: returns the queue
+  // whose schedulable batch is the most urgent, or queues_.end() if none has
+  // one, and drops closed empty queues along the way.
+  typename std::list<std::unique_ptr<internal::Queue<TaskType>>>::iterator
+  FindMostUrgentQueue() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const Options options_;
 
   mutex mu_;
@@ -205,6 +255,39 @@ class SharedBatchScheduler
 
 namespace internal {
 
+// How urgent a batch is, in terms of its most urgent task.
+struct BatchUrgency {
+  uint64 deadline_micros = kNoDeadlineMicros;
+  int priority = std::numeric_limits<int>::min();
+
+  // Earlier deadlines first, then higher priorities.
+  bool MoreUrgentThan(const BatchUrgency& other) const {
+    if (deadline_micros != other.deadline_micros) {
+      return deadline_micros < other.deadline_micros;
+    }
+    return priority > other.priority;
+  }
+};
+
+// Returns the histograms of SharedBatchScheduler::QueueOptions::metrics_label.
+inline monitoring::Sampler<1>* QueuingLatencySampler() {
+  static auto* sampler = monitoring::Sampler<1>::New(
+      {"/tensorflow/serving/batching/queuing_latency",
+       "Microseconds between the first task of a batch being enqueued and the "
+       "batch being scheduled.",
+       "queue"},
+      // 10us to ~42s.
+      monitoring::Buckets::Exponential(10, 2, 22));
+  return sampler;
+}
+inline monitoring::Sampler<1>* ProcessingLatencySampler() {
+  static auto* sampler = monitoring::Sampler<1>::New(
+      {"/tensorflow/serving/batching/processing_latency",
+       "Microseconds spent in the process-batch callback.", "queue"},
+      monitoring::Buckets::Exponential(10, 2, 22));
+  return sampler;
+}
+
 // A task queue for SharedBatchScheduler. Accepts tasks and accumulates them
 // into batches, and dispenses those batches to be processed via a "pull"
 // interface. The queue's behavior is governed by maximum batch size, timeout
@@ -255,10 +338,25 @@ class Queue {
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
   // returns a batch, the batch is guaranteed to be closed.
-  std::unique_ptr<Batch<TaskType>> ScheduleBatch();
-
-  // Processes a batch that has been returned earlier by ScheduleBatch().
-  void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch);
+  //
+  // If the queue has an expired-tasks callback, the tasks of the batch whose
+  // deadline has passed are moved to '*expired_tasks' instead, which can leave
+  // a null batch with non-null expired tasks. Both have to be handed to
+  // ProcessBatch() if either is non-null, along with the time the batch was
+  // started, which is returned in '*batch_start_time_micros'.
+  std::unique_ptr<Batch<TaskType>> ScheduleBatch(
+      std::unique_ptr<Batch<TaskType>>* expired_tasks,
+      uint64* batch_start_time_micros);
+
+  // Processes a batch and the expired tasks that have been returned earlier by
+  // ScheduleBatch(). Either may be null.
+  void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch,
+                    std::unique_ptr<Batch<TaskType>> expired_tasks,
+                    uint64 batch_start_time_micros);
+
+  // Returns true and sets '*urgency' if ScheduleBatch() would return a batch
+  // at this time.
+  bool PeekSchedulableBatch(BatchUrgency* urgency) const;
 
   // Determines whether the queue is empty, i.e. has no tasks waiting or being
   // processed.
@@ -284,6 +382,17 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Moves the tasks of '*batch' whose deadline is before 'now_micros' to a new
+  // batch in '*expired_tasks', leaving '*batch' null if none remain.
+  static void RemoveExpiredTasks(
+      uint64 now_micros, std::unique_ptr<Batch<TaskType>>* batch,
+      std::unique_ptr<Batch<TaskType>>* expired_tasks);
+
+  // Adapts 'batch_closing_size_' and 'batch_timeout_micros_' to
+  // 'options_.target_latency_micros' given 'latency_samples_', which it
+  // clears.
+  void AdjustBatchingParameters() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -311,6 +420,29 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ GUARDED_BY(mu_);
 
+  // The same for the closed batches in 'batches_', front to back.
+  std::deque<uint64> closed_batch_start_times_micros_ GUARDED_BY(mu_);
+
+  // Where the queuing and processing latencies are recorded, if
+  // 'options_.metrics_label' is set.
+  monitoring::SamplerCell* queuing_latency_cell_ = nullptr;
+  monitoring::SamplerCell* processing_latency_cell_ = nullptr;
+
+  // The size at which the open batch becomes schedulable, and the timeout
+  // after which it does regardless of its size. These are the
+  // 'max_batch_size' and 'batch_timeout_micros' options, unless
+  // 'options_.target_latency_micros' is set.
+  int batch_closing_size_ GUARDED_BY(mu_);
+  int64 batch_timeout_micros_ GUARDED_BY(mu_);
+
+  // The batches processed since the last AdjustBatchingParameters() call.
+  struct LatencySample {
+    size_t batch_size;
+    uint64 processing_micros;
+    uint64 latency_micros;
+  };
+  std::vector<LatencySample> latency_samples_ GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled. Used
   // to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ GUARDED_BY(mu_) = false;
@@ -407,6 +539,17 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
+  if (options.target_latency_micros > 0 &&
+      options.latency_adjustment_batches < 1) {
+    return errors::InvalidArgument(
+        "latency_adjustment_batches must be positive; was ",
+        options.latency_adjustment_batches);
+  }
 
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
@@ -449,14 +592,37 @@ template <typename TaskType>
 void SharedBatchScheduler<TaskType>::ThreadLogic() {
   // A batch to process next (or nullptr if no work to do).
   std::unique_ptr<Batch<TaskType>> batch_to_process;
+  // The tasks of that batch that are past their deadline, if any.
+  std::unique_ptr<Batch<TaskType>> expired_tasks;
+  // When the first task of the batch was enqueued.
+  uint64 batch_start_time_micros = 0;
   // The queue with which 'batch_to_process' is associated.
   internal::Queue<TaskType>* queue_for_batch = nullptr;
   {
     mutex_lock l(mu_);
 
-    const int num_queues = queues_.size();
+    if (options_.servicing_policy ==
+        Options::ServicingPolicy::kEarliestDeadline) {
+      auto most_urgent_queue = FindMostUrgentQueue();
+      if (most_urgent_queue != queues_.end()) {
+        batch_to_process = (*most_urgent_queue)->ScheduleBatch(
+            &expired_tasks, &batch_start_time_micros);
+        queue_for_batch = most_urgent_queue->get();
+        // Among equally urgent queues, the next thread starts after this one.
+        next_queue_to_schedule_ = ++most_urgent_queue;
+        if (next_queue_to_schedule_ == queues_.end()) {
+          next_queue_to_schedule_ = queues_.begin();
+        }
+      }
+    }
+
+    const int num_queues =
+        options_.servicing_policy == Options::ServicingPolicy::kRoundRobin
+            ? queues_.size()
+            : 0;
     for (int num_queues_tried = 0;
-         batch_to_process == nullptr && num_queues_tried < num_queues;
+         batch_to_process == nullptr && expired_tasks == nullptr &&
+         num_queues_tried < num_queues;
          ++num_queues_tried) {
       DCHECK(next_queue_to_schedule_ != queues_.end());
 
@@ -467,14 +633,15 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
       const bool queue_closed = (*next_queue_to_schedule_)->closed();
 
       // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
-      if (batch_to_process != nullptr) {
+      batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch(
+          &expired_tasks, &batch_start_time_micros);
+      if (batch_to_process != nullptr || expired_tasks != nullptr) {
         queue_for_batch = next_queue_to_schedule_->get();
       }
 
       // Advance 'next_queue_to_schedule_'.
       if (queue_closed && (*next_queue_to_schedule_)->IsEmpty() &&
-          batch_to_process == nullptr) {
+          queue_for_batch == nullptr) {
         // We've encountered a closed queue with no work to do. Drop it.
         DCHECK_NE(queue_for_batch, next_queue_to_schedule_->get());
         next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
@@ -487,7 +654,7 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
       }
     }
 
-    if (batch_to_process == nullptr) {
+    if (queue_for_batch == nullptr) {
       // We couldn't find any work to do. Wait until a new batch becomes
       // schedulable, or some time has elapsed, before checking again.
       const int64 kTimeoutMillis = 1;  // The smallest accepted granule of time.
@@ -496,7 +663,42 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
     }
   }
 
-  queue_for_batch->ProcessBatch(std::move(batch_to_process));
+  queue_for_batch->ProcessBatch(std::move(batch_to_process),
+                                std::move(expired_tasks),
+                                batch_start_time_micros);
+}
+
+template <typename TaskType>
+typename std::list<std::unique_ptr<internal::Queue<TaskType>>>::iterator
+SharedBatchScheduler<TaskType>::FindMostUrgentQueue() {
+  auto most_urgent_queue = queues_.end();
+  internal::BatchUrgency most_urgent;
+  // Start at 'next_queue_to_schedule_' so that ties are broken round-robin.
+  const int num_queues = queues_.size();
+  for (int num_queues_tried = 0; num_queues_tried < num_queues;
+       ++num_queues_tried) {
+    DCHECK(next_queue_to_schedule_ != queues_.end());
+    // See ThreadLogic() for why the closedness is read first.
+    const bool queue_closed = (*next_queue_to_schedule_)->closed();
+    internal::BatchUrgency urgency;
+    if ((*next_queue_to_schedule_)->PeekSchedulableBatch(&urgency)) {
+      if (most_urgent_queue == queues_.end() ||
+          urgency.MoreUrgentThan(most_urgent)) {
+        most_urgent_queue = next_queue_to_schedule_;
+        most_urgent = urgency;
+      }
+      ++next_queue_to_schedule_;
+    } else if (queue_closed && (*next_queue_to_schedule_)->IsEmpty()) {
+      // A closed queue with no work to do. Drop it.
+      next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
+    } else {
+      ++next_queue_to_schedule_;
+    }
+    if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
+      next_queue_to_schedule_ = queues_.begin();
+    }
+  }
+  return most_urgent_queue;
 }
 
 namespace internal {
@@ -509,9 +711,17 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      batch_closing_size_(options.max_batch_size),
+      batch_timeout_micros_(options.batch_timeout_micros) {
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
+  if (!options_.metrics_label.empty()) {
+    queuing_latency_cell_ =
+        QueuingLatencySampler()->GetCell(options_.metrics_label);
+    processing_latency_cell_ =
+        ProcessingLatencySampler()->GetCell(options_.metrics_label);
+  }
 }
 
 template <typename TaskType>
@@ -587,7 +797,9 @@ size_t Queue<TaskType>::SchedulingCapacity() const {
 }
 
 template <typename TaskType>
-std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch(
+    std::unique_ptr<Batch<TaskType>>* expired_tasks,
+    uint64* batch_start_time_micros) {
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
   std::unique_ptr<Batch<TaskType>> batch_to_schedule;
@@ -605,6 +817,15 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
       batches_.pop_front();
+      *batch_start_time_micros = closed_batch_start_times_micros_.front();
+      closed_batch_start_times_micros_.pop_front();
+      const uint64 now_micros = env_->NowMicros();
+      if (queuing_latency_cell_ != nullptr) {
+        queuing_latency_cell_->Add(now_micros - *batch_start_time_micros);
+      }
+      if (options_.expired_tasks_callback) {
+        RemoveExpiredTasks(now_micros, &batch_to_schedule, expired_tasks);
+      }
     } else {
       schedulable_batch_ = false;
     }
@@ -614,11 +835,37 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
 }
 
 template <typename TaskType>
-void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
-  process_batch_callback_(std::move(batch));
+void Queue<TaskType>::ProcessBatch(
+    std::unique_ptr<Batch<TaskType>> batch,
+    std::unique_ptr<Batch<TaskType>> expired_tasks,
+    uint64 batch_start_time_micros) {
+  if (expired_tasks != nullptr) {
+    options_.expired_tasks_callback(std::move(expired_tasks));
+  }
+  size_t batch_size = 0;
+  uint64 start_time_micros = 0;
+  uint64 end_time_micros = 0;
+  if (batch != nullptr) {
+    batch_size = batch->size();
+    start_time_micros = env_->NowMicros();
+    process_batch_callback_(std::move(batch));
+    end_time_micros = env_->NowMicros();
+    if (processing_latency_cell_ != nullptr) {
+      processing_latency_cell_->Add(end_time_micros - start_time_micros);
+    }
+  }
 
   {
     mutex_lock l(mu_);
+    if (options_.target_latency_micros > 0 && batch_size > 0) {
+      latency_samples_.push_back({batch_size,
+                                  end_time_micros - start_time_micros,
+                                  end_time_micros - batch_start_time_micros});
+      if (latency_samples_.size() >=
+          static_cast<size_t>(options_.latency_adjustment_batches)) {
+        AdjustBatchingParameters();
+      }
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -626,6 +873,60 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
   }
 }
 
+template <typename TaskType>
+bool Queue<TaskType>::PeekSchedulableBatch(BatchUrgency* urgency) const {
+  mutex_lock l(mu_);
+  const Batch<TaskType>* batch;
+  if (batches_.size() >= 2) {
+    batch = batches_.front().get();
+  } else if (IsOpenBatchSchedulable()) {
+    batch = batches_.back().get();
+  } else {
+    return false;
+  }
+  *urgency = BatchUrgency();
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    BatchUrgency task_urgency;
+    task_urgency.deadline_micros = batch->task(i).deadline_micros();
+    task_urgency.priority = batch->task(i).priority();
+    if (task_urgency.MoreUrgentThan(*urgency)) *urgency = task_urgency;
+  }
+  return true;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::RemoveExpiredTasks(
+    uint64 now_micros, std::unique_ptr<Batch<TaskType>>* batch,
+    std::unique_ptr<Batch<TaskType>>* expired_tasks) {
+  bool any_expired = false;
+  for (int i = 0; i < (*batch)->num_tasks() && !any_expired; ++i) {
+    any_expired = (*batch)->task(i).deadline_micros() < now_micros;
+  }
+  if (!any_expired) return;
+
+  // Batch only gives up its last task, so the tasks come out in reverse.
+  std::vector<std::unique_ptr<TaskType>> tasks;
+  while (std::unique_ptr<TaskType> task = (*batch)->RemoveTask()) {
+    tasks.push_back(std::move(task));
+  }
+  std::unique_ptr<Batch<TaskType>> remaining_tasks(new Batch<TaskType>);
+  expired_tasks->reset(new Batch<TaskType>);
+  for (auto it = tasks.rbegin(); it != tasks.rend(); ++it) {
+    if ((*it)->deadline_micros() < now_micros) {
+      (*expired_tasks)->AddTask(std::move(*it));
+    } else {
+      remaining_tasks->AddTask(std::move(*it));
+    }
+  }
+  (*expired_tasks)->Close();
+  remaining_tasks->Close();
+  if (remaining_tasks->empty()) {
+    batch->reset();
+  } else {
+    *batch = std::move(remaining_tasks);
+  }
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsEmpty() const {
   mutex_lock l(mu_);
@@ -657,6 +958,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
   batches_.back()->Close();
+  closed_batch_start_times_micros_.push_back(open_batch_start_time_micros_);
   batches_.emplace_back(new Batch<TaskType>);
 }
 
@@ -666,9 +968,71 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= options_.max_batch_size ||
+  return closed_ || open_batch->size() >= batch_closing_size_ ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros_;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::AdjustBatchingParameters() {
+  // Below this fraction of the target, the latency has room to grow.
+  constexpr double kLatencyHeadroom = 0.8;
+  // The latency overshoot is never corrected by more than halving.
+  constexpr double kMinShrinkFactor = 0.5;
+  // Growth steps, as a fraction of the bounds of the parameters.
+  constexpr double kGrowthStep = 0.125;
+
+  const double target_latency_micros = options_.target_latency_micros;
+  std::vector<uint64> latencies;
+  latencies.reserve(latency_samples_.size());
+  for (const LatencySample& sample : latency_samples_) {
+    latencies.push_back(sample.latency_micros);
+  }
+  const size_t p99_index = latencies.size() * 99 / 100;
+  std::nth_element(latencies.begin(), latencies.begin() + p99_index,
+                   latencies.end());
+  const double p99_latency_micros = latencies[p99_index];
+
+  double closing_size = batch_closing_size_;
+  double timeout_micros = batch_timeout_micros_;
+  if (p99_latency_micros > target_latency_micros) {
+    const double shrink_factor = std::max(
+        target_latency_micros / p99_latency_micros, kMinShrinkFactor);
+    closing_size *= shrink_factor;
+    timeout_micros *= shrink_factor;
+  } else if (p99_latency_micros < kLatencyHeadroom * target_latency_micros) {
+    closing_size += kGrowthStep * options_.max_batch_size;
+    timeout_micros += kGrowthStep * options_.batch_timeout_micros;
+  }
+  timeout_micros = std::min(
+      timeout_micros, static_cast<double>(options_.batch_timeout_micros));
+
+  // Least-squares fit of processing_micros = a + b * batch_size, to cap the
+  // batch size to what fits in the time left after the timeout.
+  double n = 0, sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+  for (const LatencySample& sample : latency_samples_) {
+    const double x = sample.batch_size;
+    const double y = sample.processing_micros;
+    n += 1;
+    sum_x += x;
+    sum_y += y;
+    sum_xx += x * x;
+    sum_xy += x * y;
+  }
+  const double denominator = n * sum_xx - sum_x * sum_x;
+  if (denominator > 0) {
+    const double b = (n * sum_xy - sum_x * sum_y) / denominator;
+    const double a = (sum_y - b * sum_x) / n;
+    if (b > 0) {
+      closing_size = std::min(
+          closing_size, (target_latency_micros - timeout_micros - a) / b);
+    }
+  }
+
+  batch_closing_size_ = std::max(
+      1, std::min(static_cast<int>(closing_size), options_.max_batch_size));
+  batch_timeout_micros_ = std::max<int64>(0, timeout_micros);
+  latency_samples_.clear();
 }
 
 template <typename TaskType>
@@ -28,14 +28,18 @@ namespace {
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size, uint64 deadline_micros = kNoDeadlineMicros)
+      : size_(size), deadline_micros_(deadline_micros) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  uint64 deadline_micros() const override { return deadline_micros_; }
+
  private:
   const size_t size_;
+  const uint64 deadline_micros_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
@@ -50,6 +54,15 @@ Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
   return status;
 }
 
+// Like ScheduleTask(), but the task is due at 'deadline_micros'.
+Status ScheduleTaskWithDeadline(size_t task_size, uint64 deadline_micros,
+                                BatchScheduler<FakeTask>* scheduler) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, deadline_micros));
+  Status status = scheduler->Schedule(&task);
+  CHECK_EQ(status.ok(), task == nullptr);
+  return status;
+}
+
 // Creates a thread that waits on 'start' and then advances the fake clock in
 // 'env' in a loop until 'stop' is notified. Useful for allowing objects that
 // use the clock to be destroyed.
@@ -592,6 +605,175 @@ TEST(SharedBatchSchedulerTest, QueueDestructorBlocksUntilAllTasksProcessed) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, EarliestDeadlineServicing) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<int> processed_queues;
+    Notification first_batch_scheduled, first_batch_proceed;
+    Notification all_batches_processed;
+    auto make_callback = [&](int queue_index) {
+      return [&, queue_index](std::unique_ptr<Batch<FakeTask>> batch) {
+        if (queue_index == 0) {
+          first_batch_scheduled.Notify();
+          first_batch_proceed.WaitForNotification();
+          return;
+        }
+        mutex_lock l(mu);
+        processed_queues.push_back(queue_index);
+        if (processed_queues.size() == 2) {
+          all_batches_processed.Notify();
+        }
+      };
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    options.servicing_policy = SharedBatchScheduler<
+        FakeTask>::Options::ServicingPolicy::kEarliestDeadline;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    queue_options.batch_timeout_micros = 1;
+    queue_options.max_enqueued_batches = 2;
+    std::vector<std::unique_ptr<BatchScheduler<FakeTask>>> queues(3);
+    for (int i = 0; i < 3; ++i) {
+      TF_ASSERT_OK(
+          scheduler->AddQueue(queue_options, make_callback(i), &queues[i]));
+    }
+
+    // Occupy the only batch thread with a batch from queue 0.
+    TF_ASSERT_OK(ScheduleTask(10, queues[0].get()));
+    env.AdvanceByMicroseconds(1);
+    first_batch_scheduled.WaitForNotification();
+
+    // Round-robin would service queue 1 next, but queue 2 is due sooner.
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(10, 1000, queues[1].get()));
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(10, 100, queues[2].get()));
+    env.AdvanceByMicroseconds(1);
+    first_batch_proceed.Notify();
+    all_batches_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ((std::vector<int>{2, 1}), processed_queues);
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, ExpiredTasksAreNotProcessed) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification batch_processed, expired_tasks_received;
+    auto callback =
+        [&batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+          ASSERT_TRUE(batch->IsClosed());
+          ASSERT_EQ(2, batch->num_tasks());
+          EXPECT_EQ(1, batch->task(0).size());
+          EXPECT_EQ(3, batch->task(1).size());
+          batch_processed.Notify();
+        };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    queue_options.batch_timeout_micros = 10;
+    queue_options.max_enqueued_batches = 2;
+    queue_options.expired_tasks_callback =
+        [&expired_tasks_received](std::unique_ptr<Batch<FakeTask>> expired) {
+          ASSERT_TRUE(expired->IsClosed());
+          ASSERT_EQ(1, expired->num_tasks());
+          EXPECT_EQ(2, expired->task(0).size());
+          expired_tasks_received.Notify();
+        };
+    queue_options.metrics_label = "expired_tasks_test";
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // The task of size 2 is past its deadline by the time the batch times out.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(2, 5, queue.get()));
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(3, 20, queue.get()));
+    env.AdvanceByMicroseconds(10);
+    expired_tasks_received.WaitForNotification();
+    batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, AdaptsBatchSizeToTargetLatency) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_processed, second_batch_processed;
+    // Each unit of batch size takes 500us to process.
+    auto callback = [&env, &first_batch_processed, &second_batch_processed](
+        std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      env.AdvanceByMicroseconds(500 * batch->size());
+      if (!first_batch_processed.HasBeenNotified()) {
+        EXPECT_EQ(10, batch->size());
+        first_batch_processed.Notify();
+      } else {
+        EXPECT_EQ(5, batch->size());
+        second_batch_processed.Notify();
+      }
+    };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    queue_options.batch_timeout_micros = 100;
+    queue_options.max_enqueued_batches = 2;
+    queue_options.target_latency_micros = 2500;
+    queue_options.latency_adjustment_batches = 1;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // A full batch takes 5000us, twice the target, so the queue halves the
+    // size at which it schedules batches.
+    for (int i = 0; i < 10; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    first_batch_processed.WaitForNotification();
+
+    // The clock is now frozen, so the next batch is scheduled on reaching the
+    // new size rather than on timing out.
+    for (int i = 0; i < 5; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    second_batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -47,6 +47,7 @@ namespace boosted_trees {
 using boosted_trees::learner::LearnerConfig;
 using boosted_trees::learner::LearningRateConfig;
 using boosted_trees::learner::LearningRateDropoutDrivenConfig;
+using boosted_trees::models::FlatTreeEnsemble;
 using boosted_trees::models::MultipleAdditiveTrees;
 using boosted_trees::models::DecisionTreeEnsembleResource;
 using boosted_trees::utils::DropoutUtils;
@@ -270,6 +271,8 @@ class GradientTreesPredictionOp : public OpKernel {
     // Run predictor.
     thread::ThreadPool* const worker_threads =
         context->device()->tensorflow_cpu_worker_threads()->workers;
+    const FlatTreeEnsemble* const flat_ensemble =
+        ensemble_resource->flat_tree_ensemble();
 
     if (apply_averaging_) {
       DecisionTreeEnsembleConfig adjusted =
@@ -287,8 +290,20 @@ class GradientTreesPredictionOp : public OpKernel {
         adjusted.mutable_tree_weights()->Set(
             i, weight * (num_ensembles - i + start_averaging) / num_ensembles);
       }
-      MultipleAdditiveTrees::Predict(adjusted, trees_to_include, batch_features,
-                                     worker_threads, output_predictions);
+      if (flat_ensemble != nullptr) {
+        MultipleAdditiveTrees::Predict(adjusted, *flat_ensemble,
+                                       trees_to_include, batch_features,
+                                       worker_threads, output_predictions);
+      } else {
+        MultipleAdditiveTrees::Predict(adjusted, trees_to_include,
+                                       batch_features, worker_threads,
+                                       output_predictions);
+      }
+    } else if (flat_ensemble != nullptr) {
+      MultipleAdditiveTrees::Predict(
+          ensemble_resource->decision_tree_ensemble(), *flat_ensemble,
+          trees_to_include, batch_features, worker_threads,
+          output_predictions);
     } else {
       MultipleAdditiveTrees::Predict(
           ensemble_resource->decision_tree_ensemble(), trees_to_include,
@@ -359,7 +374,8 @@ class GradientTreesPartitionExamplesOp : public OpKernel {
         (ensemble_resource->num_trees() <= 0 ||
          ensemble_resource->LastTreeMetadata()->is_finalized())
             ? empty_tree_config
-            : *ensemble_resource->LastTree();
+            : ensemble_resource->decision_tree_ensemble().trees(
+                  ensemble_resource->num_trees() - 1);
 
     // Read dense float features list;
     OpInputList dense_float_features_list;
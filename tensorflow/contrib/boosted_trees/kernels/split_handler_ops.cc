@@ -12,11 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 // =============================================================================
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "tensorflow/contrib/boosted_trees/lib/learner/common/histograms/gradient_histograms.h"
 #include "tensorflow/contrib/boosted_trees/lib/learner/common/stats/node-stats.h"
+#include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
 #include "tensorflow/contrib/boosted_trees/proto/split_info.pb.h"
 #include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"
 #include "tensorflow/core/framework/device_base.h"
@@ -34,6 +38,7 @@
 
 namespace tensorflow {
 
+using boosted_trees::learner::GradientHistograms;
 using boosted_trees::learner::SplitInfo;
 using boosted_trees::learner::stochastic::GradientStats;
 using boosted_trees::learner::stochastic::NodeStats;
@@ -652,4 +657,290 @@ REGISTER_KERNEL_BUILDER(
     Name("BuildCategoricalEqualitySplits").Device(DEVICE_CPU),
     BuildCategoricalEqualitySplitsOp);
 
+class BuildDenseHistogramSplitsOp : public BaseBuildSplitOp {
+ public:
+  explicit BuildDenseHistogramSplitsOp(OpKernelConstruction* const context)
+      : BaseBuildSplitOp(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_features", &num_features_));
+    OP_REQUIRES_OK(context, context->GetAttr("num_buckets", &num_buckets_));
+    OP_REQUIRES(context, num_buckets_ <= 256,
+                errors::InvalidArgument(
+                    "num_buckets must be at most 256, got ", num_buckets_));
+  }
+
+  void Compute(OpKernelContext* const context) override {
+    const Tensor* partition_ids_t;
+    OP_REQUIRES_OK(context, context->input("partition_ids", &partition_ids_t));
+    const auto& partition_ids = partition_ids_t->vec<int32>();
+    const int64 batch_size = partition_ids.size();
+
+    const Tensor* gradients_t;
+    OP_REQUIRES_OK(context, context->input("gradients", &gradients_t));
+    const Tensor* hessians_t;
+    OP_REQUIRES_OK(context, context->input("hessians", &hessians_t));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(gradients_t->shape()) &&
+                    gradients_t->NumElements() == batch_size &&
+                    hessians_t->shape() == gradients_t->shape(),
+                errors::InvalidArgument(
+                    "gradients and hessians must be vectors of one value per "
+                    "example, got ",
+                    gradients_t->shape().DebugString(), " and ",
+                    hessians_t->shape().DebugString()));
+    const float* gradients = gradients_t->flat<float>().data();
+    const float* hessians = hessians_t->flat<float>().data();
+
+    OpInputList bucketized_features_list;
+    OP_REQUIRES_OK(context, context->input_list("bucketized_features",
+                                                &bucketized_features_list));
+    std::vector<const uint8*> feature_buckets;
+    for (const Tensor& buckets_t : bucketized_features_list) {
+      OP_REQUIRES(context, buckets_t.NumElements() == batch_size,
+                  errors::InvalidArgument(
+                      "Expected one bucket per example, got ",
+                      buckets_t.shape().DebugString()));
+      const uint8* buckets = buckets_t.flat<uint8>().data();
+      for (int64 i = 0; i < batch_size; ++i) {
+        OP_REQUIRES(context, buckets[i] < num_buckets_,
+                    errors::InvalidArgument("Bucket ", buckets[i],
+                                            " is out of range [0, ",
+                                            num_buckets_, ")."));
+      }
+      feature_buckets.push_back(buckets);
+    }
+
+    OpInputList bucket_boundaries_list;
+    OP_REQUIRES_OK(context, context->input_list("bucket_boundaries",
+                                                &bucket_boundaries_list));
+
+    const Tensor* parent_histograms_t;
+    OP_REQUIRES_OK(context, context->input("parent_histograms",
+                                           &parent_histograms_t));
+    const Tensor* children_t;
+    OP_REQUIRES_OK(context, context->input("children_partition_ids",
+                                           &children_t));
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsMatrix(children_t->shape()) &&
+            children_t->dim_size(1) == 2 &&
+            parent_histograms_t->shape() ==
+                TensorShape({children_t->dim_size(0), num_features_,
+                             num_buckets_, 2}),
+        errors::InvalidArgument(
+            "Expected parent histograms of shape [num_parents, ",
+            num_features_, ", ", num_buckets_,
+            ", 2] and children partition IDs of shape [num_parents, 2], got ",
+            parent_histograms_t->shape().DebugString(), " and ",
+            children_t->shape().DebugString()));
+    const auto& children = children_t->matrix<int32>();
+
+    int class_id;
+    ReadClassId(context, &class_id);
+
+    // The partitions in increasing order of ID.
+    std::map<int32, int64> partition_sizes;
+    for (int64 i = 0; i < batch_size; ++i) {
+      ++partition_sizes[partition_ids(i)];
+    }
+    // When the handler is inactive, no bucket boundaries are built for it.
+    bool active = false;
+    for (const Tensor& boundaries_t : bucket_boundaries_list) {
+      active |= boundaries_t.NumElements() > 0;
+    }
+    if (!active) {
+      partition_sizes.clear();
+    }
+    const int32 num_elements = partition_sizes.size();
+    std::vector<int32> partitions;
+    std::unordered_map<int32, int32> slots;
+    for (const auto& partition : partition_sizes) {
+      slots[partition.first] = partitions.size();
+      partitions.push_back(partition.first);
+    }
+    auto slot_of = [&slots](const int32 partition_id) {
+      auto it = slots.find(partition_id);
+      return it == slots.end() ? -1 : it->second;
+    };
+
+    // Only the smaller child of each parent is built. The other one is the
+    // parent minus it, or the parent itself when it got all the examples.
+    struct DerivedHistograms {
+      int32 slot;
+      int64 parent;
+      int32 sibling_slot;
+    };
+    std::vector<DerivedHistograms> derived;
+    std::vector<bool> built(num_elements, true);
+    std::vector<bool> paired(num_elements, false);
+    for (int64 parent = 0; parent < children_t->dim_size(0); ++parent) {
+      int32 slot = slot_of(children(parent, 0));
+      int32 sibling_slot = slot_of(children(parent, 1));
+      if (slot < 0) std::swap(slot, sibling_slot);
+      if (slot < 0 || paired[slot] ||
+          (sibling_slot >= 0 && paired[sibling_slot])) {
+        continue;
+      }
+      if (sibling_slot >= 0 && partition_sizes[partitions[slot]] <
+                                   partition_sizes[partitions[sibling_slot]]) {
+        std::swap(slot, sibling_slot);
+      }
+      paired[slot] = true;
+      built[slot] = false;
+      if (sibling_slot >= 0) paired[sibling_slot] = true;
+      derived.push_back({slot, parent, sibling_slot});
+    }
+
+    std::vector<int32> example_slots(batch_size, -1);
+    std::vector<double> root_gradients(num_elements, 0.0);
+    std::vector<double> root_hessians(num_elements, 0.0);
+    for (int64 i = 0; i < batch_size; ++i) {
+      const int32 slot = slot_of(partition_ids(i));
+      if (slot < 0) continue;
+      root_gradients[slot] += gradients[i];
+      root_hessians[slot] += hessians[i];
+      if (built[slot]) example_slots[i] = slot;
+    }
+
+    thread::ThreadPool* const worker_threads =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+    GradientHistograms histograms(num_elements, num_features_, num_buckets_);
+    histograms.Build(feature_buckets, example_slots.data(), gradients,
+                     hessians, batch_size, worker_threads);
+    const float* parent_histograms = parent_histograms_t->flat<float>().data();
+    for (const DerivedHistograms& d : derived) {
+      const float* parent =
+          parent_histograms + d.parent * histograms.node_size();
+      if (d.sibling_slot >= 0) {
+        histograms.SetToDifference(d.slot, parent, d.sibling_slot);
+      } else {
+        std::copy(parent, parent + histograms.node_size(),
+                  histograms.mutable_node_histograms(d.slot));
+      }
+    }
+
+    // Finds the best bucket of each partition and feature, with the features
+    // split over the worker threads.
+    struct Candidate {
+      float gain = std::numeric_limits<float>::lowest();
+      int32 bucket = -1;
+      float left_gradient = 0;
+      float left_hessian = 0;
+    };
+    std::vector<Candidate> candidates(num_elements * num_features_);
+    auto find_splits = [this, &histograms, &bucket_boundaries_list,
+                        &root_gradients, &root_hessians, &candidates,
+                        num_elements](int64 start, int64 end) {
+      for (int64 feature = start; feature < end; ++feature) {
+        const int32 num_boundaries =
+            std::min<int64>(bucket_boundaries_list[feature].NumElements(),
+                            num_buckets_);
+        for (int32 slot = 0; slot < num_elements; ++slot) {
+          Candidate& best = candidates[slot * num_features_ + feature];
+          const float* sums = histograms.histogram(slot, feature);
+          float left_gradient = 0;
+          float left_hessian = 0;
+          for (int32 bucket = 0; bucket < num_boundaries; ++bucket) {
+            left_gradient += sums[bucket * 2];
+            left_hessian += sums[bucket * 2 + 1];
+            const NodeStats left_stats =
+                ComputeNodeStats(GradientStats(left_gradient, left_hessian));
+            const NodeStats right_stats = ComputeNodeStats(
+                GradientStats(root_gradients[slot] - left_gradient,
+                              root_hessians[slot] - left_hessian));
+            if (left_stats.gain + right_stats.gain > best.gain) {
+              best.gain = left_stats.gain + right_stats.gain;
+              best.bucket = bucket;
+              best.left_gradient = left_gradient;
+              best.left_hessian = left_hessian;
+            }
+          }
+        }
+      }
+    };
+    boosted_trees::utils::ParallelFor(num_features_,
+                                      worker_threads->NumThreads(),
+                                      worker_threads, find_splits);
+
+    Tensor* output_partition_ids_t = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output("output_partition_ids",
+                                            TensorShape({num_elements}),
+                                            &output_partition_ids_t));
+    tensorflow::TTypes<int32>::Vec output_partition_ids =
+        output_partition_ids_t->vec<int32>();
+    Tensor* gains_t = nullptr;
+    OP_REQUIRES_OK(
+        context, context->allocate_output("gains", TensorShape({num_elements}),
+                                          &gains_t));
+    tensorflow::TTypes<float>::Vec gains = gains_t->vec<float>();
+    Tensor* output_splits_t = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                "split_infos", TensorShape({num_elements}),
+                                &output_splits_t));
+    tensorflow::TTypes<string>::Vec output_splits =
+        output_splits_t->vec<string>();
+    Tensor* histograms_t = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       "histograms",
+                       TensorShape({num_elements, num_features_, num_buckets_,
+                                    2}),
+                       &histograms_t));
+    if (num_elements > 0) {
+      std::copy(histograms.node_histograms(0),
+                histograms.node_histograms(0) +
+                    num_elements * histograms.node_size(),
+                histograms_t->flat<float>().data());
+    }
+
+    for (int32 root_idx = 0; root_idx < num_elements; ++root_idx) {
+      int32 best_feature = -1;
+      for (int32 feature = 0; feature < num_features_; ++feature) {
+        const Candidate& c = candidates[root_idx * num_features_ + feature];
+        if (c.bucket >= 0 &&
+            (best_feature < 0 ||
+             c.gain >
+                 candidates[root_idx * num_features_ + best_feature].gain)) {
+          best_feature = feature;
+        }
+      }
+      const NodeStats root_stats = ComputeNodeStats(
+          GradientStats(root_gradients[root_idx], root_hessians[root_idx]));
+      SplitInfo split_info;
+      float best_gain = std::numeric_limits<float>::lowest();
+      if (best_feature >= 0) {
+        const Candidate& best =
+            candidates[root_idx * num_features_ + best_feature];
+        best_gain = best.gain;
+        auto* dense_split =
+            split_info.mutable_split_node()->mutable_dense_float_binary_split();
+        dense_split->set_feature_column(feature_column_group_id_ +
+                                        best_feature);
+        dense_split->set_threshold(
+            bucket_boundaries_list[best_feature].vec<float>()(best.bucket));
+        FillLeaf(class_id,
+                 ComputeNodeStats(
+                     GradientStats(best.left_gradient, best.left_hessian)),
+                 split_info.mutable_left_child());
+        FillLeaf(class_id,
+                 ComputeNodeStats(GradientStats(
+                     root_gradients[root_idx] - best.left_gradient,
+                     root_hessians[root_idx] - best.left_hessian)),
+                 split_info.mutable_right_child());
+      }
+      split_info.SerializeToString(&output_splits(root_idx));
+      gains(root_idx) =
+          best_gain - root_stats.gain - tree_complexity_regularization_;
+      output_partition_ids(root_idx) = partitions[root_idx];
+    }
+  }
+
+ private:
+  int32 num_features_;
+  int32 num_buckets_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("BuildDenseHistogramSplits").Device(DEVICE_CPU),
+                        BuildDenseHistogramSplitsOp);
+
 }  // namespace tensorflow
@@ -0,0 +1,68 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/learner/common/histograms/gradient_histograms.h"
+
+#include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace learner {
+
+GradientHistograms::GradientHistograms(int32 num_nodes, int32 num_features,
+                                       int32 num_buckets)
+    : num_nodes_(num_nodes),
+      num_features_(num_features),
+      num_buckets_(num_buckets),
+      sums_(num_nodes * node_size(), 0.0f) {
+  CHECK_LE(num_buckets, 256);
+}
+
+void GradientHistograms::Build(
+    const std::vector<const uint8*>& feature_buckets,
+    const int32* example_nodes, const float* gradients, const float* hessians,
+    int64 num_examples, thread::ThreadPool* thread_pool) {
+  CHECK_EQ(feature_buckets.size(), num_features_);
+  auto build_features = [this, &feature_buckets, example_nodes, gradients,
+                         hessians, num_examples](int64 start, int64 end) {
+    for (int64 feature = start; feature < end; ++feature) {
+      const uint8* buckets = feature_buckets[feature];
+      float* feature_sums = sums_.data() + feature * num_buckets_ * 2;
+      for (int64 i = 0; i < num_examples; ++i) {
+        const int32 node = example_nodes[i];
+        if (node < 0) continue;
+        DCHECK_LT(buckets[i], num_buckets_);
+        float* sums = feature_sums + node * node_size() + buckets[i] * 2;
+        sums[0] += gradients[i];
+        sums[1] += hessians[i];
+      }
+    }
+  };
+  utils::ParallelFor(num_features_, thread_pool->NumThreads(), thread_pool,
+                     build_features);
+}
+
+void GradientHistograms::SetToDifference(int32 node, const float* parent,
+                                         int32 sibling) {
+  const float* sibling_sums = node_histograms(sibling);
+  float* sums = mutable_node_histograms(node);
+  for (int64 i = 0; i < node_size(); ++i) {
+    sums[i] = parent[i] - sibling_sums[i];
+  }
+}
+
+}  // namespace learner
+}  // namespace boosted_trees
+}  // namespace tensorflow
@@ -0,0 +1,80 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_LEARNER_COMMON_HISTOGRAMS_GRADIENT_HISTOGRAMS_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_LEARNER_COMMON_HISTOGRAMS_GRADIENT_HISTOGRAMS_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace learner {
+
+// Sums of the gradients and hessians of the examples of some nodes, per
+// feature and bucket, for features bucketized to uint8 once. The sums of a
+// node are laid out [feature][bucket][gradient, hessian].
+class GradientHistograms {
+ public:
+  GradientHistograms(int32 num_nodes, int32 num_features, int32 num_buckets);
+
+  // Adds example i to the histograms of node example_nodes[i], unless that is
+  // -1. feature_buckets[f][i] is the bucket of example i for feature f, which
+  // must be smaller than num_buckets. The features are split over the threads
+  // of 'thread_pool', so that each histogram is written by a single thread.
+  void Build(const std::vector<const uint8*>& feature_buckets,
+             const int32* example_nodes, const float* gradients,
+             const float* hessians, int64 num_examples,
+             thread::ThreadPool* thread_pool);
+
+  // Sets the histograms of 'node' to 'parent', node_size() sums, minus those
+  // of 'sibling'. This holds when the examples of the parent are split
+  // between the node and its sibling, and saves building the larger child.
+  void SetToDifference(int32 node, const float* parent, int32 sibling);
+
+  // Returns the num_buckets (gradient, hessian) pairs of 'node' and
+  // 'feature'.
+  const float* histogram(int32 node, int32 feature) const {
+    return node_histograms(node) + feature * num_buckets_ * 2;
+  }
+
+  // Returns the node_size() sums of 'node'.
+  const float* node_histograms(int32 node) const {
+    return sums_.data() + node * node_size();
+  }
+  float* mutable_node_histograms(int32 node) {
+    return sums_.data() + node * node_size();
+  }
+
+  int32 num_nodes() const { return num_nodes_; }
+  int32 num_features() const { return num_features_; }
+  int32 num_buckets() const { return num_buckets_; }
+  int64 node_size() const {
+    return static_cast<int64>(num_features_) * num_buckets_ * 2;
+  }
+
+ private:
+  const int32 num_nodes_;
+  const int32 num_features_;
+  const int32 num_buckets_;
+  std::vector<float> sums_;
+};
+
+}  // namespace learner
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_LEARNER_COMMON_HISTOGRAMS_GRADIENT_HISTOGRAMS_H_
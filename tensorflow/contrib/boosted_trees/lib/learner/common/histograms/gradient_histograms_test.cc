@@ -0,0 +1,94 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/learner/common/histograms/gradient_histograms.h"
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace learner {
+namespace {
+
+class GradientHistogramsTest : public ::testing::Test {
+ protected:
+  GradientHistogramsTest()
+      : thread_pool_(tensorflow::Env::Default(), "test_pool", 2) {}
+
+  thread::ThreadPool thread_pool_;
+};
+
+TEST_F(GradientHistogramsTest, Build) {
+  // Two features with their buckets, and the node of each example.
+  const std::vector<uint8> feature0 = {0, 1, 1, 2, 0};
+  const std::vector<uint8> feature1 = {2, 2, 0, 1, 1};
+  const std::vector<int32> nodes = {0, 1, 0, -1, 0};
+  const std::vector<float> gradients = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+  const std::vector<float> hessians = {0.1f, 0.2f, 0.3f, 0.4f, 0.5f};
+
+  GradientHistograms histograms(2, 2, 3);
+  histograms.Build({feature0.data(), feature1.data()}, nodes.data(),
+                   gradients.data(), hessians.data(), 5, &thread_pool_);
+
+  const std::vector<float> node0_feature0 = {6.0f, 0.6f, 3.0f, 0.3f, 0, 0};
+  const std::vector<float> node0_feature1 = {3.0f, 0.3f, 5.0f, 0.5f, 1.0f,
+                                             0.1f};
+  const std::vector<float> node1_feature0 = {0, 0, 2.0f, 0.2f, 0, 0};
+  const std::vector<float> node1_feature1 = {0, 0, 0, 0, 2.0f, 0.2f};
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_FLOAT_EQ(node0_feature0[i], histograms.histogram(0, 0)[i]);
+    EXPECT_FLOAT_EQ(node0_feature1[i], histograms.histogram(0, 1)[i]);
+    EXPECT_FLOAT_EQ(node1_feature0[i], histograms.histogram(1, 0)[i]);
+    EXPECT_FLOAT_EQ(node1_feature1[i], histograms.histogram(1, 1)[i]);
+  }
+}
+
+TEST_F(GradientHistogramsTest, SiblingSubtraction) {
+  const std::vector<uint8> buckets = {0, 1, 1, 0, 2, 2};
+  const std::vector<float> gradients = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  const std::vector<float> hessians = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f};
+
+  // The parent holds all examples, which the children split.
+  GradientHistograms parent(1, 1, 3);
+  const std::vector<int32> parent_nodes(6, 0);
+  parent.Build({buckets.data()}, parent_nodes.data(), gradients.data(),
+               hessians.data(), 6, &thread_pool_);
+
+  // Builds the smaller child (node 0) and derives the larger one.
+  const std::vector<int32> child_nodes = {1, 0, 1, 1, 0, 1};
+  GradientHistograms children(2, 1, 3);
+  std::vector<int32> built_nodes = child_nodes;
+  for (int32& node : built_nodes) {
+    if (node != 0) node = -1;
+  }
+  children.Build({buckets.data()}, built_nodes.data(), gradients.data(),
+                 hessians.data(), 6, &thread_pool_);
+  children.SetToDifference(1, parent.node_histograms(0), 0);
+
+  GradientHistograms expected(2, 1, 3);
+  expected.Build({buckets.data()}, child_nodes.data(), gradients.data(),
+                 hessians.data(), 6, &thread_pool_);
+  for (int32 node = 0; node < 2; ++node) {
+    for (int i = 0; i < expected.node_size(); ++i) {
+      EXPECT_FLOAT_EQ(expected.node_histograms(node)[i],
+                      children.node_histograms(node)[i]);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace learner
+}  // namespace boosted_trees
+}  // namespace tensorflow
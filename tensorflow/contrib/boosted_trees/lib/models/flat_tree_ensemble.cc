@@ -0,0 +1,235 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/boosted_trees/lib/models/flat_tree_ensemble.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace models {
+
+using boosted_trees::trees::DecisionTreeConfig;
+using boosted_trees::trees::DecisionTreeEnsembleConfig;
+using boosted_trees::trees::TreeNode;
+
+namespace {
+
+// The bin of missing (NaN) values, which are routed right like NaN fails the
+// float comparisons. The ranks of thresholds are always smaller.
+constexpr uint16 kNaNBin = 65535;
+constexpr size_t kMaxQuantizedThresholds = kNaNBin - 1;
+
+}  // namespace
+
+constexpr int FlatTreeEnsemble::kBlockSize;
+
+FlatTreeEnsemble::FlatTreeEnsemble(const DecisionTreeEnsembleConfig& config,
+                                   bool quantize_thresholds) {
+  leaf_begin_.push_back(0);
+  roots_.reserve(config.trees_size());
+  depths_.reserve(config.trees_size());
+  for (const DecisionTreeConfig& tree : config.trees()) {
+    int32 depth = 0;
+    roots_.push_back(Flatten(tree, &depth));
+    depths_.push_back(depth);
+  }
+  if (quantize_thresholds) {
+    QuantizeThresholds();
+  }
+}
+
+int32 FlatTreeEnsemble::Flatten(const DecisionTreeConfig& tree,
+                                int32* depth) {
+  const int32 num_nodes = tree.nodes_size();
+  if (num_nodes == 0) {
+    return -1;
+  }
+  // Checks that the tree only has supported nodes, and that every node is
+  // reached once from the root, which bounds the routing by the depth.
+  std::vector<bool> reached(num_nodes, false);
+  std::vector<std::pair<int32, int32>> stack = {{0, 0}};
+  reached[0] = true;
+  while (!stack.empty()) {
+    const int32 node_id = stack.back().first;
+    const int32 node_depth = stack.back().second;
+    stack.pop_back();
+    *depth = std::max(*depth, node_depth);
+    const TreeNode& node = tree.nodes(node_id);
+    if (node.node_case() == TreeNode::kLeaf) {
+      if (node.leaf().has_sparse_vector()) {
+        const auto& leaf = node.leaf().sparse_vector();
+        if (leaf.index_size() != leaf.value_size()) return -1;
+      } else if (!node.leaf().has_vector()) {
+        return -1;
+      }
+      continue;
+    }
+    if (node.node_case() != TreeNode::kDenseFloatBinarySplit) {
+      return -1;
+    }
+    const auto& split = node.dense_float_binary_split();
+    for (const int32 child : {split.left_id(), split.right_id()}) {
+      if (child < 0 || child >= num_nodes || reached[child]) {
+        return -1;
+      }
+      reached[child] = true;
+      stack.emplace_back(child, node_depth + 1);
+    }
+  }
+
+  const int32 offset = features_.size();
+  for (int32 i = 0; i < num_nodes; ++i) {
+    const TreeNode& node = tree.nodes(i);
+    if (node.node_case() == TreeNode::kDenseFloatBinarySplit) {
+      const auto& split = node.dense_float_binary_split();
+      features_.push_back(split.feature_column());
+      thresholds_.push_back(split.threshold());
+      left_ids_.push_back(offset + split.left_id());
+      right_ids_.push_back(offset + split.right_id());
+      num_dense_features_ =
+          std::max(num_dense_features_, split.feature_column() + 1);
+    } else {
+      features_.push_back(0);
+      thresholds_.push_back(0);
+      left_ids_.push_back(offset + i);
+      right_ids_.push_back(offset + i);
+      if (node.node_case() == TreeNode::kLeaf) {
+        if (node.leaf().has_sparse_vector()) {
+          const auto& leaf = node.leaf().sparse_vector();
+          leaf_indices_.insert(leaf_indices_.end(), leaf.index().begin(),
+                               leaf.index().end());
+          leaf_values_.insert(leaf_values_.end(), leaf.value().begin(),
+                              leaf.value().end());
+        } else if (node.leaf().has_vector()) {
+          const auto& leaf = node.leaf().vector();
+          for (int32 j = 0; j < leaf.value_size(); ++j) {
+            leaf_indices_.push_back(j);
+          }
+          leaf_values_.insert(leaf_values_.end(), leaf.value().begin(),
+                              leaf.value().end());
+        }
+      }
+    }
+    leaf_begin_.push_back(leaf_values_.size());
+  }
+  return offset;
+}
+
+void FlatTreeEnsemble::QuantizeThresholds() {
+  // Collects the distinct thresholds of each column.
+  std::unordered_map<int32, int32> feature_of_column;
+  std::vector<std::vector<float>> thresholds;
+  std::vector<int32> columns;
+  const int32 num_nodes = features_.size();
+  for (int32 i = 0; i < num_nodes; ++i) {
+    if (left_ids_[i] == i) continue;
+    if (std::isnan(thresholds_[i])) return;
+    auto inserted = feature_of_column.emplace(features_[i], columns.size());
+    if (inserted.second) {
+      columns.push_back(features_[i]);
+      thresholds.emplace_back();
+    }
+    thresholds[inserted.first->second].push_back(thresholds_[i]);
+  }
+  for (auto& t : thresholds) {
+    std::sort(t.begin(), t.end());
+    t.erase(std::unique(t.begin(), t.end()), t.end());
+    if (t.size() > kMaxQuantizedThresholds) return;
+  }
+
+  quantized_thresholds_.resize(num_nodes, 0);
+  for (int32 i = 0; i < num_nodes; ++i) {
+    if (left_ids_[i] == i) continue;
+    const int32 feature = feature_of_column[features_[i]];
+    const auto& t = thresholds[feature];
+    quantized_thresholds_[i] =
+        std::lower_bound(t.begin(), t.end(), thresholds_[i]) - t.begin();
+    features_[i] = feature;
+  }
+  quantized_columns_ = std::move(columns);
+  column_thresholds_ = std::move(thresholds);
+  quantized_ = true;
+}
+
+void FlatTreeEnsemble::Route(int32 tree_idx, const float* const* columns,
+                             int64 column_stride, int num_examples,
+                             int32* leaves) const {
+  DCHECK(!quantized_);
+  DCHECK_LE(num_examples, kBlockSize);
+  int32 nodes[kBlockSize];
+  std::fill(nodes, nodes + num_examples, roots_[tree_idx]);
+  const int32* features = features_.data();
+  const float* thresholds = thresholds_.data();
+  const int32* left_ids = left_ids_.data();
+  const int32* right_ids = right_ids_.data();
+  for (int32 d = 0; d < depths_[tree_idx]; ++d) {
+    // The examples are independent, which lets the compiler interleave or
+    // vectorize their lookups.
+    for (int i = 0; i < num_examples; ++i) {
+      const int32 node = nodes[i];
+      const float value = columns[features[node]][i * column_stride];
+      nodes[i] = value <= thresholds[node] ? left_ids[node] : right_ids[node];
+    }
+  }
+  std::copy(nodes, nodes + num_examples, leaves);
+}
+
+void FlatTreeEnsemble::Quantize(const float* const* columns,
+                                int64 column_stride, int num_examples,
+                                uint16* bins) const {
+  DCHECK(quantized_);
+  for (int32 f = 0; f < quantized_columns_.size(); ++f) {
+    const float* column = columns[quantized_columns_[f]];
+    const std::vector<float>& t = column_thresholds_[f];
+    uint16* feature_bins = bins + f * kBlockSize;
+    for (int i = 0; i < num_examples; ++i) {
+      const float value = column[i * column_stride];
+      // Bin b <= rank k exactly when value <= t[k].
+      feature_bins[i] =
+          std::isnan(value)
+              ? kNaNBin
+              : std::lower_bound(t.begin(), t.end(), value) - t.begin();
+    }
+  }
+}
+
+void FlatTreeEnsemble::RouteQuantized(int32 tree_idx, const uint16* bins,
+                                      int num_examples, int32* leaves) const {
+  DCHECK(quantized_);
+  DCHECK_LE(num_examples, kBlockSize);
+  int32 nodes[kBlockSize];
+  std::fill(nodes, nodes + num_examples, roots_[tree_idx]);
+  const int32* features = features_.data();
+  const uint16* thresholds = quantized_thresholds_.data();
+  const int32* left_ids = left_ids_.data();
+  const int32* right_ids = right_ids_.data();
+  for (int32 d = 0; d < depths_[tree_idx]; ++d) {
+    for (int i = 0; i < num_examples; ++i) {
+      const int32 node = nodes[i];
+      const uint16 bin = bins[features[node] * kBlockSize + i];
+      nodes[i] = bin <= thresholds[node] ? left_ids[node] : right_ids[node];
+    }
+  }
+  std::copy(nodes, nodes + num_examples, leaves);
+}
+
+}  // namespace models
+}  // namespace boosted_trees
+}  // namespace tensorflow
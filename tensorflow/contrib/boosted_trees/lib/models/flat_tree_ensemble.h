@@ -0,0 +1,132 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_MODELS_FLAT_TREE_ENSEMBLE_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_MODELS_FLAT_TREE_ENSEMBLE_H_
+
+#include <vector>
+
+#include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace boosted_trees {
+namespace models {
+
+// A tree ensemble flattened for prediction. The nodes of all trees are stored
+// in parallel arrays rather than as protos, so that a block of examples can
+// be routed through a tree with one array lookup per node and example. Only
+// trees made of dense float splits and leaves are flattened; the others are
+// evaluated on their protos.
+//
+// With quantized thresholds, the thresholds of each feature are replaced by
+// their rank among the distinct thresholds of that feature, and a feature
+// value by the number of thresholds smaller than it, which routes examples
+// exactly as the float comparisons do with half the memory per value.
+//
+// This class is immutable and thread safe once created.
+class FlatTreeEnsemble {
+ public:
+  // Number of examples routed through a tree together.
+  static constexpr int kBlockSize = 16;
+
+  // Flattens the trees of 'config'. Thresholds are quantized when
+  // 'quantize_thresholds' is true and no feature has more distinct
+  // thresholds than a uint16 can rank.
+  FlatTreeEnsemble(
+      const boosted_trees::trees::DecisionTreeEnsembleConfig& config,
+      bool quantize_thresholds);
+
+  int32 num_trees() const { return roots_.size(); }
+
+  // Returns true if the tree was flattened.
+  bool IsFlattened(int32 tree_idx) const { return roots_[tree_idx] >= 0; }
+
+  bool quantized() const { return quantized_; }
+
+  // Returns the number of dense float feature columns the flattened trees
+  // split on, i.e. one more than the largest column.
+  int32 num_dense_features() const { return num_dense_features_; }
+
+  // Routes the 'num_examples' <= kBlockSize examples whose dense float
+  // features are given through the flattened tree 'tree_idx', and sets
+  // leaves[i] to the leaf of example i. Feature 'f' of example 'i' is
+  // columns[f][i * column_stride]. Requires !quantized().
+  void Route(int32 tree_idx, const float* const* columns, int64 column_stride,
+             int num_examples, int32* leaves) const;
+
+  // Quantizes the dense features of 'num_examples' <= kBlockSize examples
+  // into 'bins', which must hold num_quantized_features() * kBlockSize
+  // values. Requires quantized().
+  void Quantize(const float* const* columns, int64 column_stride,
+                int num_examples, uint16* bins) const;
+
+  // Like Route, for examples quantized by Quantize.
+  void RouteQuantized(int32 tree_idx, const uint16* bins, int num_examples,
+                      int32* leaves) const;
+
+  int32 num_quantized_features() const { return quantized_columns_.size(); }
+
+  // The logit dimensions and values of the leaf 'leaf'.
+  int32 leaf_size(int32 leaf) const {
+    return leaf_begin_[leaf + 1] - leaf_begin_[leaf];
+  }
+  const int32* leaf_indices(int32 leaf) const {
+    return leaf_indices_.data() + leaf_begin_[leaf];
+  }
+  const float* leaf_values(int32 leaf) const {
+    return leaf_values_.data() + leaf_begin_[leaf];
+  }
+
+ private:
+  // Appends the nodes of 'tree' and returns the index of its root, or -1 if
+  // the tree cannot be flattened.
+  int32 Flatten(const boosted_trees::trees::DecisionTreeConfig& tree,
+                int32* depth);
+  void QuantizeThresholds();
+
+  // Root node and depth of each tree.
+  std::vector<int32> roots_;
+  std::vector<int32> depths_;
+
+  // The nodes of all flattened trees. A leaf is its own left and right child,
+  // so that routing an example for the depth of its tree ends at a leaf.
+  std::vector<int32> features_;
+  std::vector<float> thresholds_;
+  std::vector<int32> left_ids_;
+  std::vector<int32> right_ids_;
+  // The logits of node i are at [leaf_begin_[i], leaf_begin_[i + 1]) of
+  // leaf_indices_ and leaf_values_, empty for a split.
+  std::vector<int32> leaf_begin_;
+  std::vector<int32> leaf_indices_;
+  std::vector<float> leaf_values_;
+  int32 num_dense_features_ = 0;
+
+  // Quantized thresholds. When quantized, features_ holds the index into
+  // quantized_columns_ rather than the column itself.
+  bool quantized_ = false;
+  std::vector<uint16> quantized_thresholds_;
+  // The column and sorted distinct thresholds of each quantized feature.
+  std::vector<int32> quantized_columns_;
+  std::vector<std::vector<float>> column_thresholds_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FlatTreeEnsemble);
+};
+
+}  // namespace models
+}  // namespace boosted_trees
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_LIB_MODELS_FLAT_TREE_ENSEMBLE_H_
@@ -13,6 +13,9 @@
 // limitations under the License.
 // =============================================================================
 #include "tensorflow/contrib/boosted_trees/lib/models/multiple_additive_trees.h"
+
+#include <algorithm>
+
 #include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/parallel_for.h"
@@ -21,6 +24,33 @@ namespace tensorflow {
 namespace boosted_trees {
 namespace models {
 
+namespace {
+
+// Adds the weighted logits of 'leaf_node' to the predictions of the example.
+void AddLeafPredictions(const boosted_trees::trees::TreeNode& leaf_node,
+                        const float tree_weight, const int64 example_idx,
+                        tensorflow::TTypes<float>::Matrix* output_predictions) {
+  QCHECK(leaf_node.has_leaf())
+      << "Invalid leaf node: " << leaf_node.DebugString();
+  if (leaf_node.leaf().has_sparse_vector()) {
+    const auto& leaf = leaf_node.leaf().sparse_vector();
+    QCHECK_EQ(leaf.index_size(), leaf.value_size());
+    for (size_t logit_dim = 0; logit_dim < leaf.index_size(); ++logit_dim) {
+      const float value = tree_weight * leaf.value(logit_dim);
+      (*output_predictions)(example_idx, leaf.index(logit_dim)) += value;
+    }
+  } else {
+    QCHECK(leaf_node.leaf().has_vector()) << "Unknown leaf type";
+    const auto& leaf = leaf_node.leaf().vector();
+    for (size_t i = 0; i < leaf.value_size(); ++i) {
+      const float value = tree_weight * leaf.value(i);
+      (*output_predictions)(example_idx, i) += value;
+    }
+  }
+}
+
+}  // namespace
+
 void MultipleAdditiveTrees::Predict(
     const boosted_trees::trees::DecisionTreeEnsembleConfig& config,
     const std::vector<int32>& trees_to_include,
@@ -47,26 +77,8 @@ void MultipleAdditiveTrees::Predict(
         const float tree_weight = config.tree_weights(tree_idx);
         const int leaf_idx = trees::DecisionTree::Traverse(tree, 0, example);
         QCHECK(leaf_idx >= 0) << "Invalid tree: " << tree.DebugString();
-        const auto& leaf_node = tree.nodes(leaf_idx);
-        QCHECK(leaf_node.has_leaf())
-            << "Invalid leaf node: " << leaf_node.DebugString();
-        if (leaf_node.leaf().has_sparse_vector()) {
-          const auto& leaf = leaf_node.leaf().sparse_vector();
-          QCHECK_EQ(leaf.index_size(), leaf.value_size());
-          for (size_t logit_dim = 0; logit_dim < leaf.index_size();
-               ++logit_dim) {
-            const float value = tree_weight * leaf.value(logit_dim);
-            output_predictions(example.example_idx, leaf.index(logit_dim)) +=
-                value;
-          }
-        } else {
-          QCHECK(leaf_node.leaf().has_vector()) << "Unknown leaf type";
-          const auto& leaf = leaf_node.leaf().vector();
-          for (size_t i = 0; i < leaf.value_size(); ++i) {
-            const float value = tree_weight * leaf.value(i);
-            output_predictions(example.example_idx, i) += value;
-          }
-        }
+        AddLeafPredictions(tree.nodes(leaf_idx), tree_weight,
+                           example.example_idx, &output_predictions);
       }
     }
   };
@@ -77,6 +89,82 @@ void MultipleAdditiveTrees::Predict(
                                     worker_threads, update_predictions);
 }
 
+void MultipleAdditiveTrees::Predict(
+    const boosted_trees::trees::DecisionTreeEnsembleConfig& config,
+    const FlatTreeEnsemble& flat_ensemble,
+    const std::vector<int32>& trees_to_include,
+    const boosted_trees::utils::BatchFeatures& features,
+    tensorflow::thread::ThreadPool* const worker_threads,
+    tensorflow::TTypes<float>::Matrix output_predictions) {
+  QCHECK_EQ(config.trees_size(), flat_ensemble.num_trees());
+  const std::vector<Tensor>& dense_columns =
+      features.dense_float_feature_columns();
+  std::vector<int32> flat_trees;
+  std::vector<int32> proto_trees;
+  for (const int32 tree_idx : trees_to_include) {
+    if (flat_ensemble.IsFlattened(tree_idx) &&
+        flat_ensemble.num_dense_features() <= dense_columns.size()) {
+      flat_trees.push_back(tree_idx);
+    } else {
+      proto_trees.push_back(tree_idx);
+    }
+  }
+  Predict(config, proto_trees, features, worker_threads, output_predictions);
+
+  const int64 batch_size = features.batch_size();
+  if (batch_size <= 0 || flat_trees.empty()) {
+    return;
+  }
+  // Dense float features are [batch_size, 1], so one example's value follows
+  // the other's in each column.
+  std::vector<const float*> columns(dense_columns.size());
+  for (size_t i = 0; i < dense_columns.size(); ++i) {
+    columns[i] = dense_columns[i].flat<float>().data();
+  }
+
+  auto update_predictions = [&config, &flat_ensemble, &flat_trees, &columns,
+                             &output_predictions](int64 start, int64 end) {
+    constexpr int kBlockSize = FlatTreeEnsemble::kBlockSize;
+    std::vector<const float*> block_columns(columns.size());
+    std::vector<uint16> bins(flat_ensemble.num_quantized_features() *
+                             kBlockSize);
+    int32 leaves[kBlockSize];
+    for (int64 block_start = start; block_start < end;
+         block_start += kBlockSize) {
+      const int num_examples =
+          std::min<int64>(kBlockSize, end - block_start);
+      for (size_t i = 0; i < columns.size(); ++i) {
+        block_columns[i] = columns[i] + block_start;
+      }
+      if (flat_ensemble.quantized()) {
+        flat_ensemble.Quantize(block_columns.data(), 1, num_examples,
+                               bins.data());
+      }
+      for (const int32 tree_idx : flat_trees) {
+        if (flat_ensemble.quantized()) {
+          flat_ensemble.RouteQuantized(tree_idx, bins.data(), num_examples,
+                                       leaves);
+        } else {
+          flat_ensemble.Route(tree_idx, block_columns.data(), 1, num_examples,
+                              leaves);
+        }
+        const float tree_weight = config.tree_weights(tree_idx);
+        for (int i = 0; i < num_examples; ++i) {
+          const int32 leaf = leaves[i];
+          const int32* indices = flat_ensemble.leaf_indices(leaf);
+          const float* values = flat_ensemble.leaf_values(leaf);
+          for (int32 j = 0; j < flat_ensemble.leaf_size(leaf); ++j) {
+            output_predictions(block_start + i, indices[j]) +=
+                tree_weight * values[j];
+          }
+        }
+      }
+    }
+  };
+  boosted_trees::utils::ParallelFor(batch_size, worker_threads->NumThreads(),
+                                    worker_threads, update_predictions);
+}
+
 }  // namespace models
 }  // namespace boosted_trees
 }  // namespace tensorflow
@@ -17,6 +17,7 @@
 
 #include <vector>
 
+#include "tensorflow/contrib/boosted_trees/lib/models/flat_tree_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/lib/utils/batch_features.h"
 #include "tensorflow/contrib/boosted_trees/proto/tree_config.pb.h"  // NOLINT
 #include "tensorflow/core/framework/tensor_types.h"
@@ -39,6 +40,17 @@ class MultipleAdditiveTrees {
       const boosted_trees::utils::BatchFeatures& features,
       tensorflow::thread::ThreadPool* const worker_threads,
       tensorflow::TTypes<float>::Matrix output_predictions);
+
+  // Like above, but routes blocks of examples through the trees that
+  // 'flat_ensemble', built from the trees of 'config', has flattened. The
+  // tree weights are still read from 'config'.
+  static void Predict(
+      const boosted_trees::trees::DecisionTreeEnsembleConfig& config,
+      const FlatTreeEnsemble& flat_ensemble,
+      const std::vector<int32>& trees_to_include,
+      const boosted_trees::utils::BatchFeatures& features,
+      tensorflow::thread::ThreadPool* const worker_threads,
+      tensorflow::TTypes<float>::Matrix output_predictions);
 };
 
 }  // namespace models
@@ -14,6 +14,9 @@
 // =============================================================================
 #include "tensorflow/contrib/boosted_trees/lib/models/multiple_additive_trees.h"
 
+#include <limits>
+#include <numeric>
+
 #include "tensorflow/contrib/boosted_trees/lib/testutil/batch_features_testutil.h"
 #include "tensorflow/contrib/boosted_trees/lib/testutil/random_tree_gen.h"
 #include "tensorflow/contrib/boosted_trees/resources/decision_tree_ensemble_resource.h"
@@ -268,6 +271,108 @@ TEST_F(MultipleAdditiveTreesTest, DenseLeaves) {
   }
 }
 
+// Checks that predicting with the flattened ensemble, with and without
+// quantized thresholds, matches the predictions on the protos.
+void ExpectFlatPredictionsMatch(const DecisionTreeEnsembleConfig& config,
+                                const std::vector<int32>& trees_to_include,
+                                const utils::BatchFeatures& features) {
+  tensorflow::thread::ThreadPool threads(tensorflow::Env::Default(), "test",
+                                         kNumThreadsMultiThreaded);
+  const int64 batch_size = features.batch_size();
+  Tensor expected(DT_FLOAT, {batch_size, 1});
+  MultipleAdditiveTrees::Predict(config, trees_to_include, features, &threads,
+                                 expected.matrix<float>());
+  for (const bool quantize : {false, true}) {
+    FlatTreeEnsemble flat_ensemble(config, quantize);
+    EXPECT_EQ(quantize, flat_ensemble.quantized());
+    Tensor output(DT_FLOAT, {batch_size, 1});
+    MultipleAdditiveTrees::Predict(config, flat_ensemble, trees_to_include,
+                                   features, &threads, output.matrix<float>());
+    test::ExpectClose(expected, output);
+  }
+}
+
+TEST_F(MultipleAdditiveTreesTest, FlatEnsembleDenseTrees) {
+  random::PhiloxRandom philox(1);
+  random::SimplePhilox rng(&philox);
+  testutil::RandomTreeGen tree_gen(&rng, 10, 0);
+  DecisionTreeEnsembleConfig config = tree_gen.GenerateEnsemble(6, 20);
+  // The batch is not a multiple of the block size.
+  utils::BatchFeatures features(100);
+  testutil::RandomlyInitializeBatchFeatures(&rng, 10, 0, 0, 0, &features);
+
+  FlatTreeEnsemble flat_ensemble(config, false);
+  for (int32 i = 0; i < config.trees_size(); ++i) {
+    EXPECT_TRUE(flat_ensemble.IsFlattened(i));
+  }
+  ExpectFlatPredictionsMatch(config, {0, 3, 5, 19}, features);
+  std::vector<int32> all_trees(config.trees_size());
+  std::iota(all_trees.begin(), all_trees.end(), 0);
+  ExpectFlatPredictionsMatch(config, all_trees, features);
+}
+
+TEST_F(MultipleAdditiveTreesTest, FlatEnsembleMixedTrees) {
+  random::PhiloxRandom philox(2);
+  random::SimplePhilox rng(&philox);
+  // Trees with sparse splits are evaluated on their protos.
+  testutil::RandomTreeGen tree_gen(&rng, 4, 4);
+  DecisionTreeEnsembleConfig config;
+  for (int i = 0; i < 10; ++i) {
+    *config.add_trees() = tree_gen.Generate(4);
+    config.add_tree_weights(rng.RandFloat());
+  }
+  testutil::RandomTreeGen dense_tree_gen(&rng, 4, 0);
+  *config.add_trees() = dense_tree_gen.Generate(4);
+  config.add_tree_weights(0.5f);
+  utils::BatchFeatures features(37);
+  testutil::RandomlyInitializeBatchFeatures(&rng, 4, 4, 0.5, 0.9, &features);
+
+  FlatTreeEnsemble flat_ensemble(config, false);
+  EXPECT_TRUE(flat_ensemble.IsFlattened(10));
+  std::vector<int32> all_trees(config.trees_size());
+  std::iota(all_trees.begin(), all_trees.end(), 0);
+  ExpectFlatPredictionsMatch(config, all_trees, features);
+}
+
+TEST_F(MultipleAdditiveTreesTest, FlatEnsembleThresholdsAndMissingValues) {
+  // Values equal to a threshold go left, and NaN goes right.
+  DecisionTreeEnsembleConfig config;
+  auto* tree = config.add_trees();
+  auto* dense_split = tree->add_nodes()->mutable_dense_float_binary_split();
+  dense_split->set_feature_column(1);
+  dense_split->set_threshold(5.0f);
+  dense_split->set_left_id(1);
+  dense_split->set_right_id(2);
+  dense_split = tree->add_nodes()->mutable_dense_float_binary_split();
+  dense_split->set_feature_column(1);
+  dense_split->set_threshold(-1.0f);
+  dense_split->set_left_id(3);
+  dense_split->set_right_id(4);
+  for (const float value : {0.1f, 0.2f, 0.3f}) {
+    auto* leaf = tree->add_nodes()->mutable_leaf()->mutable_sparse_vector();
+    leaf->add_index(0);
+    leaf->add_value(value);
+  }
+  config.add_tree_weights(2.0f);
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  auto dense_0 = AsTensor<float>({0.0f, 0.0f, 0.0f, 0.0f, 0.0f}, {5, 1});
+  auto dense_1 = AsTensor<float>({5.0f, -1.0f, nan, 7.0f, 2.0f}, {5, 1});
+  utils::BatchFeatures features(5);
+  TF_EXPECT_OK(features.Initialize({dense_0, dense_1}, {}, {}, {}, {}, {}, {}));
+
+  tensorflow::thread::ThreadPool threads(tensorflow::Env::Default(), "test",
+                                         kNumThreadsSingleThreaded);
+  for (const bool quantize : {false, true}) {
+    FlatTreeEnsemble flat_ensemble(config, quantize);
+    Tensor output(DT_FLOAT, {5, 1});
+    MultipleAdditiveTrees::Predict(config, flat_ensemble, {0}, features,
+                                   &threads, output.matrix<float>());
+    test::ExpectTensorEqual<float>(
+        output, AsTensor<float>({0.6f, 0.4f, 0.2f, 0.2f, 0.6f}, {5, 1}));
+  }
+}
+
 }  // namespace
 }  // namespace models
 }  // namespace boosted_trees
@@ -195,5 +195,107 @@ split_infos: A rank 1 tensor of serialized protos which contains the
     `SplitInfo`s.
 )doc");
 
+REGISTER_OP("BuildDenseHistogramSplits")
+    .Attr("num_features: int >= 1")
+    .Attr("num_buckets: int >= 1")
+    .Attr("feature_column_group_id: int")
+    .Attr("l1_regularization: float")
+    .Attr("l2_regularization: float")
+    .Attr("tree_complexity_regularization: float")
+    .Attr("min_node_weight: float")
+    .Attr("multiclass_strategy: int")
+    .Input("partition_ids: int32")
+    .Input("bucketized_features: num_features * uint8")
+    .Input("gradients: float32")
+    .Input("hessians: float32")
+    .Input("bucket_boundaries: num_features * float32")
+    .Input("parent_histograms: float32")
+    .Input("children_partition_ids: int32")
+    .Input("class_id: int32")
+    .Output("output_partition_ids: int32")
+    .Output("gains: float32")
+    .Output("split_infos: string")
+    .Output("histograms: float32")
+    .SetShapeFn([](InferenceContext* c) {
+      int num_features;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_features", &num_features));
+      int num_buckets;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_buckets", &num_buckets));
+      DimensionHandle unused_dim;
+      ShapeHandle unused_shape;
+      ShapeHandle partition_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &partition_ids_shape));
+      int input = 1;
+      for (int i = 0; i < num_features; ++i, ++input) {
+        ShapeHandle feature_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(input), 1, &feature_shape));
+        TF_RETURN_IF_ERROR(c->Merge(c->Dim(partition_ids_shape, 0),
+                                    c->Dim(feature_shape, 0), &unused_dim));
+      }
+      for (int i = 0; i < 2; ++i, ++input) {
+        ShapeHandle stats_shape;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(input), 1, &stats_shape));
+        TF_RETURN_IF_ERROR(c->Merge(c->Dim(partition_ids_shape, 0),
+                                    c->Dim(stats_shape, 0), &unused_dim));
+      }
+      for (int i = 0; i < num_features; ++i, ++input) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(input), 1, &unused_shape));
+      }
+      ShapeHandle parent_histograms_shape;
+      TF_RETURN_IF_ERROR(
+          c->WithRank(c->input(input++), 4, &parent_histograms_shape));
+      ShapeHandle children_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(input++), 2, &children_shape));
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(parent_histograms_shape, 0),
+                                  c->Dim(children_shape, 0), &unused_dim));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(children_shape, 1), 2,
+                                      &unused_dim));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(input), 0, &unused_shape));
+      DimensionHandle num_partitions = c->UnknownDim();
+      c->set_output(0, c->Vector(num_partitions));
+      c->set_output(1, c->Vector(num_partitions));
+      c->set_output(2, c->Vector(num_partitions));
+      c->set_output(3, c->MakeShape({num_partitions, num_features, num_buckets,
+                                     2}));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Find the split that has the best gain over several dense features, from
+histograms of the gradients and hessians per bucket.
+
+Each feature is bucketized to uint8 once, and the histograms of all partitions
+are built in one pass per feature, with the features split over the worker
+threads. When a partition and its sibling split a parent whose histograms are
+given, only the smaller of the two is built and the other is the difference.
+This requires the parent histograms to have been built from the same examples,
+e.g. when the whole training set is one batch.
+
+num_features: Number of dense features.
+num_buckets: Number of buckets of each feature, at most 256.
+feature_column_group_id: The dense feature column of the first feature; the
+    others follow it.
+partition_ids: A rank 1 tensor, the partition ID of each example.
+bucketized_features: Rank 1 tensors, the bucket of each example for each
+    feature. An example in bucket `b` has a value at most
+    `bucket_boundaries[b]`.
+gradients: A rank 1 tensor of per example gradients.
+hessians: A rank 1 tensor of per example hessians.
+bucket_boundaries: Rank 1 tensors, the bucket boundaries of each feature. A
+    feature without boundaries is not split on.
+parent_histograms: A rank 4 tensor of shape
+    [num_parents, num_features, num_buckets, 2], the `histograms` of the
+    parents of the partitions built by a previous layer. It may be empty.
+children_partition_ids: A rank 2 tensor of shape [num_parents, 2], the IDs of
+    the two partitions each parent was split into.
+output_partition_ids: A rank 1 tensor, the partition IDs that we created splits
+    for.
+gains: A rank 1 tensor, for the computed gain for the created splits.
+split_infos: A rank 1 tensor of serialized protos which contains the
+    `SplitInfo`s.
+histograms: A rank 4 tensor of shape
+    [num_partitions, num_features, num_buckets, 2], the gradient and hessian
+    sums of each output partition per feature and bucket.
+)doc");
+
 }  // namespace tensorflow
    // namespace tensorflow
@@ -176,6 +176,106 @@ class SplitHandlerOpsTest(test_util.TensorFlowTestCase):
     self.assertEqual(0, len(gains))
     self.assertEqual(0, len(splits))
 
+  def testMakeDenseHistogramSplit(self):
+    """Tests histogram split handler op on the data of testMakeDenseSplit."""
+    with self.test_session() as sess:
+      partitions, gains, splits, histograms = (
+          split_handler_ops.build_dense_histogram_splits(
+              num_buckets=2,
+              partition_ids=array_ops.constant([0, 0, 1], dtype=dtypes.int32),
+              bucketized_features=[
+                  array_ops.constant([0, 1, 1], dtype=dtypes.uint8),
+                  array_ops.constant([0, 0, 0], dtype=dtypes.uint8)
+              ],
+              gradients=array_ops.constant([1.2, -0.3, 4.0]),
+              hessians=array_ops.constant([0.2, 0.19, 0.13]),
+              bucket_boundaries=[[0.3, 0.52], [0.1]],
+              parent_histograms=array_ops.zeros([0, 2, 2, 2]),
+              children_partition_ids=array_ops.zeros(
+                  [0, 2], dtype=dtypes.int32),
+              l1_regularization=0.1,
+              l2_regularization=1,
+              tree_complexity_regularization=0,
+              min_node_weight=0,
+              class_id=-1,
+              feature_column_group_id=3,
+              multiclass_strategy=learner_pb2.LearnerConfig.TREE_PER_CLASS))
+      partitions, gains, splits, histograms = sess.run(
+          [partitions, gains, splits, histograms])
+    self.assertAllEqual([0, 1], partitions)
+    self.assertAllClose([[[[1.2, 0.2], [-0.3, 0.19]], [[0.9, 0.39], [0, 0]]],
+                         [[[0, 0], [4.0, 0.13]], [[4.0, 0.13], [0, 0]]]],
+                        histograms)
+
+    # The first feature splits partition 0 as in testMakeDenseSplit, while the
+    # second one has all examples in one bucket.
+    expected_left_weight = -0.91666
+    expected_left_gain = 1.0083333333333331
+    expected_right_weight = 0.1680672
+    expected_right_gain = 0.033613445378151252
+    expected_bias_gain = 0.46043165467625885
+
+    split_info = split_info_pb2.SplitInfo()
+    split_info.ParseFromString(splits[0])
+    split_node = split_info.split_node.dense_float_binary_split
+    self.assertAllClose(
+        expected_left_gain + expected_right_gain - expected_bias_gain, gains[0],
+        0.00001)
+    self.assertAllClose([expected_left_weight],
+                        split_info.left_child.vector.value, 0.00001)
+    self.assertAllClose([expected_right_weight],
+                        split_info.right_child.vector.value, 0.00001)
+    self.assertEqual(3, split_node.feature_column)
+    self.assertAllClose(0.3, split_node.threshold, 0.00001)
+
+    # Partition 1 has a single example, so no split has a gain.
+    self.assertAllClose(0.0, gains[1], 0.00001)
+
+  def testMakeDenseHistogramSplitFromParent(self):
+    """Tests that histograms derived from the parent match built ones."""
+    bucketized_features = [
+        array_ops.constant([0, 1, 1, 2, 0], dtype=dtypes.uint8),
+        array_ops.constant([2, 0, 1, 1, 0], dtype=dtypes.uint8)
+    ]
+    gradients = array_ops.constant([1.2, -0.3, 4.0, -2.0, 0.7])
+    hessians = array_ops.constant([0.2, 0.19, 0.13, 0.3, 0.25])
+    bucket_boundaries = [[0.1, 0.2, 0.3], [1.0, 2.0, 3.0]]
+
+    def build_splits(partition_ids, parent_histograms, children_partition_ids):
+      return split_handler_ops.build_dense_histogram_splits(
+          num_buckets=3,
+          partition_ids=array_ops.constant(partition_ids, dtype=dtypes.int32),
+          bucketized_features=bucketized_features,
+          gradients=gradients,
+          hessians=hessians,
+          bucket_boundaries=bucket_boundaries,
+          parent_histograms=parent_histograms,
+          children_partition_ids=children_partition_ids,
+          l1_regularization=0.1,
+          l2_regularization=1,
+          tree_complexity_regularization=0,
+          min_node_weight=0,
+          class_id=-1,
+          feature_column_group_id=0,
+          multiclass_strategy=learner_pb2.LearnerConfig.TREE_PER_CLASS)
+
+    no_parents = array_ops.zeros([0, 2, 3, 2])
+    no_children = array_ops.zeros([0, 2], dtype=dtypes.int32)
+    with self.test_session() as sess:
+      _, _, _, root_histograms = build_splits([0, 0, 0, 0, 0], no_parents,
+                                              no_children)
+      built = build_splits([1, 2, 1, 1, 2], no_parents, no_children)
+      # Partition 2 is built and partition 1 is the difference.
+      derived = build_splits([1, 2, 1, 1, 2], root_histograms,
+                             array_ops.constant([[1, 2]], dtype=dtypes.int32))
+      built, derived = sess.run([built, derived])
+    built_partitions, built_gains, _, built_histograms = built
+    partitions, gains, _, histograms = derived
+    self.assertAllEqual([1, 2], built_partitions)
+    self.assertAllEqual(built_partitions, partitions)
+    self.assertAllClose(built_gains, gains, 0.00001)
+    self.assertAllClose(built_histograms, histograms, 0.00001)
+
   def testMakeSparseSplit(self):
     """Tests split handler op."""
     with self.test_session() as sess:
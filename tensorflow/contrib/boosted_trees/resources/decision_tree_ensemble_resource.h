@@ -15,6 +15,9 @@
 #ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_RESOURCES_DECISION_TREE_ENSEMBLE_RESOURCE_H_
 #define THIRD_PARTY_TENSORFLOW_CONTRIB_BOOSTED_TREES_RESOURCES_DECISION_TREE_ENSEMBLE_RESOURCE_H_
 
+#include <memory>
+
+#include "tensorflow/contrib/boosted_trees/lib/models/flat_tree_ensemble.h"
 #include "tensorflow/contrib/boosted_trees/lib/trees/decision_tree.h"
 #include "tensorflow/contrib/boosted_trees/resources/stamped_resource.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -46,10 +49,21 @@ class DecisionTreeEnsembleResource : public StampedResource {
 
   int32 num_trees() const { return decision_tree_ensemble_->trees_size(); }
 
+  // Returns the ensemble flattened for prediction when it was loaded, or
+  // nullptr once its trees have been modified.
+  const FlatTreeEnsemble* flat_tree_ensemble() const {
+    return flat_tree_ensemble_.get();
+  }
+
   bool InitFromSerialized(const string& serialized, const int64 stamp_token) {
     CHECK_EQ(stamp(), -1) << "Must Reset before Init.";
     if (ParseProtoUnlimited(decision_tree_ensemble_, serialized)) {
       set_stamp(stamp_token);
+      // Quantizing a block of examples costs a binary search per feature,
+      // which only pays off when it is shared by enough trees.
+      flat_tree_ensemble_.reset(new FlatTreeEnsemble(
+          *decision_tree_ensemble_,
+          decision_tree_ensemble_->trees_size() >= kMinTreesToQuantize));
       return true;
     }
     return false;
@@ -74,6 +88,7 @@ class DecisionTreeEnsembleResource : public StampedResource {
   }
 
   boosted_trees::trees::DecisionTreeConfig* AddNewTree(const float weight) {
+    flat_tree_ensemble_.reset();
     // Adding a tree as well as a weight and a tree_metadata.
     decision_tree_ensemble_->add_tree_weights(weight);
     boosted_trees::trees::DecisionTreeMetadata* const metadata =
@@ -84,6 +99,7 @@ class DecisionTreeEnsembleResource : public StampedResource {
 
   void RemoveLastTree() {
     QCHECK_GT(decision_tree_ensemble_->trees_size(), 0);
+    flat_tree_ensemble_.reset();
     decision_tree_ensemble_->mutable_trees()->RemoveLast();
     decision_tree_ensemble_->mutable_tree_weights()->RemoveLast();
     decision_tree_ensemble_->mutable_tree_metadata()->RemoveLast();
@@ -92,6 +108,7 @@ class DecisionTreeEnsembleResource : public StampedResource {
   boosted_trees::trees::DecisionTreeConfig* LastTree() {
     const int32 tree_size = decision_tree_ensemble_->trees_size();
     QCHECK_GT(tree_size, 0);
+    flat_tree_ensemble_.reset();
     return decision_tree_ensemble_->mutable_trees(tree_size - 1);
   }
 
@@ -130,6 +147,7 @@ class DecisionTreeEnsembleResource : public StampedResource {
   virtual void Reset() {
     // Reset stamp.
     set_stamp(-1);
+    flat_tree_ensemble_.reset();
 
     // Clear tree ensemle.
     arena_.Reset();
@@ -141,9 +159,12 @@ class DecisionTreeEnsembleResource : public StampedResource {
   mutex* get_mutex() { return &mu_; }
 
  protected:
+  static constexpr int32 kMinTreesToQuantize = 64;
+
   protobuf::Arena arena_;
   mutex mu_;
   boosted_trees::trees::DecisionTreeEnsembleConfig* decision_tree_ensemble_;
+  std::unique_ptr<FlatTreeEnsemble> flat_tree_ensemble_;
 };
 
 }  // namespace models
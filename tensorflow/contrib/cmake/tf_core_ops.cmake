@@ -18,6 +18,7 @@ set(tf_op_lib_names
     "bitwise_ops"
     "candidate_sampling_ops"
     "checkpoint_ops"
+    "collective_ops"
     "control_flow_ops"
     "ctc_ops"
     "data_flow_ops"
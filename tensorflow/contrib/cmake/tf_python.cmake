@@ -592,6 +592,9 @@ if(WIN32)
         "${tensorflow_source_dir}/tensorflow/contrib/nearest_neighbor/kernels/heap.h"
         "${tensorflow_source_dir}/tensorflow/contrib/nearest_neighbor/kernels/hyperplane_lsh_probes.h"
         "${tensorflow_source_dir}/tensorflow/contrib/nearest_neighbor/kernels/hyperplane_lsh_probes.cc"
+        "${tensorflow_source_dir}/tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+        "${tensorflow_source_dir}/tensorflow/contrib/nearest_neighbor/kernels/ivf_index.cc"
+        "${tensorflow_source_dir}/tensorflow/contrib/nearest_neighbor/kernels/ivf_index_ops.cc"
         "${tensorflow_source_dir}/tensorflow/contrib/nearest_neighbor/ops/nearest_neighbor_ops.cc"
     )
 
@@ -19,8 +19,11 @@ limitations under the License.
 #include <cmath>
 #include <functional>
 #include <limits>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_set>
+#include <utility>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/device_base.h"
@@ -447,6 +450,77 @@ void RestoreParams(const OpInputList params_input,
   }
 }
 
+using perftools::gputools::dnn::RnnSequenceTensorDescriptor;
+using perftools::gputools::dnn::RnnStateTensorDescriptor;
+
+// The descriptors of the input, hidden state and output tensors of a RNN
+// model for one sequence length and batch size.
+struct CudnnRnnTensorDescriptors {
+  std::unique_ptr<RnnSequenceTensorDescriptor> input_desc;
+  std::unique_ptr<RnnStateTensorDescriptor> hidden_state_desc;
+  std::unique_ptr<RnnSequenceTensorDescriptor> output_desc;
+};
+
+// Caches the tensor descriptors of a RNN kernel by sequence length and batch
+// size, the only shapes that may change between the calls of a kernel, so
+// that the per-timestep descriptors are not re-created on every step. When it
+// is full the cache is cleared, which bounds its size when the sequence
+// length varies a lot; descriptors handed out stay valid while they are used.
+// This class is not thread-safe.
+class CudnnRnnTensorDescriptorCache {
+ public:
+  template <typename T>
+  Status Get(perftools::gputools::StreamExecutor* executor,
+             const CudnnModelShapes& model_shapes,
+             std::shared_ptr<const CudnnRnnTensorDescriptors>* descs) {
+    const auto key =
+        std::make_pair(model_shapes.seq_length, model_shapes.batch_size);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      *descs = it->second;
+      return Status::OK();
+    }
+    const auto data_type = ToDataType<T>::value;
+    const auto& input_shape = model_shapes.input_shape;
+    const auto& hidden_state_shape = model_shapes.hidden_state_shape;
+    const auto& output_shape = model_shapes.output_shape;
+    std::shared_ptr<CudnnRnnTensorDescriptors> created(
+        new CudnnRnnTensorDescriptors);
+    auto input_desc_s = executor->createRnnSequenceTensorDescriptor(
+        input_shape.dim_size(0), input_shape.dim_size(1),
+        input_shape.dim_size(2), data_type);
+    TF_RETURN_IF_ERROR(FromExecutorStatus(input_desc_s));
+    created->input_desc = input_desc_s.ConsumeValueOrDie();
+
+    auto hidden_state_desc_s = executor->createRnnStateTensorDescriptor(
+        hidden_state_shape.dim_size(0), hidden_state_shape.dim_size(1),
+        hidden_state_shape.dim_size(2), data_type);
+    TF_RETURN_IF_ERROR(FromExecutorStatus(hidden_state_desc_s));
+    created->hidden_state_desc = hidden_state_desc_s.ConsumeValueOrDie();
+
+    auto output_desc_s = executor->createRnnSequenceTensorDescriptor(
+        output_shape.dim_size(0), output_shape.dim_size(1),
+        output_shape.dim_size(2), data_type);
+    TF_RETURN_IF_ERROR(FromExecutorStatus(output_desc_s));
+    created->output_desc = output_desc_s.ConsumeValueOrDie();
+
+    if (cache_.size() >= kMaxCachedShapes) {
+      cache_.clear();
+    }
+    cache_[key] = created;
+    *descs = std::move(created);
+    return Status::OK();
+  }
+
+ private:
+  static const size_t kMaxCachedShapes = 64;
+
+  // Keyed by sequence length and batch size.
+  std::map<std::pair<int, int>,
+           std::shared_ptr<const CudnnRnnTensorDescriptors>>
+      cache_;
+};
+
 }  // namespace
 
 // Note: all following kernels depend on a RnnDescriptor instance, which
@@ -783,7 +857,6 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     OP_REQUIRES_OK(context,
                    ExtractForwardInput(context, model_types(), &input, &input_h,
                                        &input_c, &params, &model_shapes));
-    const auto& input_shape = model_shapes.input_shape;
     const auto& hidden_state_shape = model_shapes.hidden_state_shape;
     const auto& output_shape = model_shapes.output_shape;
 
@@ -808,9 +881,8 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     OP_REQUIRES_OK(context,
                    ToRNNInputMode(rnn_input_mode(), model_shapes.num_units,
                                   model_shapes.input_size, &input_mode));
-    // TODO(zhengxq): cache the descriptor so we don't have to create them all
-    // the time.
     auto data_type = ToDataType<T>::value;
+    std::shared_ptr<const CudnnRnnTensorDescriptors> descs;
     {
       mutex_lock l(mu_);
       if (model_shapes_ == nullptr) {
@@ -833,25 +905,12 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
         OP_REQUIRES_OK(context, FromExecutorStatus(rnn_desc_s));
         rnn_desc_ = std::move(rnn_desc_s.ConsumeValueOrDie());
       }
+      OP_REQUIRES_OK(context, tensor_desc_cache_.Get<T>(executor, model_shapes,
+                                                         &descs));
     }
-
-    auto input_desc_s = executor->createRnnSequenceTensorDescriptor(
-        input_shape.dim_size(0), input_shape.dim_size(1),
-        input_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(input_desc_s));
-    auto input_desc = input_desc_s.ConsumeValueOrDie();
-
-    auto hidden_state_desc_s = executor->createRnnStateTensorDescriptor(
-        hidden_state_shape.dim_size(0), hidden_state_shape.dim_size(1),
-        hidden_state_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(hidden_state_desc_s));
-    auto hidden_state_desc = hidden_state_desc_s.ConsumeValueOrDie();
-
-    auto output_desc_s = executor->createRnnSequenceTensorDescriptor(
-        output_shape.dim_size(0), output_shape.dim_size(1),
-        output_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(output_desc_s));
-    auto output_desc = output_desc_s.ConsumeValueOrDie();
+    const auto& input_desc = descs->input_desc;
+    const auto& hidden_state_desc = descs->hidden_state_desc;
+    const auto& output_desc = descs->output_desc;
 
     auto input_data = AsDeviceMemory<T>(input);
     auto input_h_data = AsDeviceMemory<T>(input_h);
@@ -903,6 +962,7 @@ class CudnnRNNForwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
   std::unique_ptr<RnnDescriptor> rnn_desc_ GUARDED_BY(mu_);
   std::unique_ptr<CudnnRNNPersistentSpaceAllocator> dropout_state_allocator_
       GUARDED_BY(mu_);
+  CudnnRnnTensorDescriptorCache tensor_desc_cache_ GUARDED_BY(mu_);
 };
 
 #define REGISTER_GPU(T)                                           \
@@ -934,7 +994,6 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
                    ExtractForwardInput(context, model_types(), &input, &input_h,
                                        &input_c, &params, &model_shapes));
 
-    const auto& input_shape = model_shapes.input_shape;
     const auto& hidden_state_shape = model_shapes.hidden_state_shape;
     const auto& output_shape = model_shapes.output_shape;
 
@@ -1022,8 +1081,7 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
     OP_REQUIRES_OK(context,
                    ToRNNInputMode(rnn_input_mode(), model_shapes.num_units,
                                   model_shapes.input_size, &input_mode));
-    // TODO(zhengxq): cache the descriptor so we don't have to create them all
-    // the time.
+    std::shared_ptr<const CudnnRnnTensorDescriptors> descs;
     {
       mutex_lock l(mu_);
       if (model_shapes_ == nullptr) {
@@ -1047,25 +1105,12 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
         OP_REQUIRES_OK(context, FromExecutorStatus(rnn_desc_s));
         rnn_desc_ = std::move(rnn_desc_s.ConsumeValueOrDie());
       }
+      OP_REQUIRES_OK(context, tensor_desc_cache_.Get<T>(executor, model_shapes,
+                                                         &descs));
     }
-
-    auto input_desc_s = executor->createRnnSequenceTensorDescriptor(
-        input_shape.dim_size(0), input_shape.dim_size(1),
-        input_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(input_desc_s));
-    auto input_desc = input_desc_s.ConsumeValueOrDie();
-
-    auto hidden_state_desc_s = executor->createRnnStateTensorDescriptor(
-        hidden_state_shape.dim_size(0), hidden_state_shape.dim_size(1),
-        hidden_state_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(hidden_state_desc_s));
-    auto hidden_state_desc = hidden_state_desc_s.ConsumeValueOrDie();
-
-    auto output_desc_s = executor->createRnnSequenceTensorDescriptor(
-        output_shape.dim_size(0), output_shape.dim_size(1),
-        output_shape.dim_size(2), data_type);
-    OP_REQUIRES_OK(context, FromExecutorStatus(output_desc_s));
-    auto output_desc = output_desc_s.ConsumeValueOrDie();
+    const auto& input_desc = descs->input_desc;
+    const auto& hidden_state_desc = descs->hidden_state_desc;
+    const auto& output_desc = descs->output_desc;
 
     auto input_data = AsDeviceMemory<T>(input);
     auto input_h_data = AsDeviceMemory<T>(input_h);
@@ -1123,6 +1168,7 @@ class CudnnRNNBackwardOp<GPUDevice, T> : public CudnnRNNKernelCommon {
   std::unique_ptr<RnnDescriptor> rnn_desc_ GUARDED_BY(mu_);
   std::unique_ptr<CudnnRNNPersistentSpaceAllocator> dropout_state_allocator_
       GUARDED_BY(mu_);
+  CudnnRnnTensorDescriptorCache tensor_desc_cache_ GUARDED_BY(mu_);
 };
 
 #define REGISTER_GPU(T)                                                   \
@@ -21,6 +21,10 @@ See the @{$datasets$Importing Data} Programmer's Guide for an overview.
 @@Iterator
 @@TFRecordDataset
 @@FixedLengthRecordDataset
+@@ColumnarDataset
+@@ShuffledFixedLengthRecordDataset
+@@IndexedTFRecordDataset
+@@RemoteDataset
 @@TextLineDataset
 
 @@batch_and_drop_remainder
@@ -32,12 +36,15 @@ See the @{$datasets$Importing Data} Programmer's Guide for an overview.
 @@make_saveable_from_iterator
 @@read_batch_features
 @@unbatch
+@@write_columnar_file
 @@parallel_interleave
 @@rejection_resample
 @@scan
 @@sloppy_interleave
 
 @@get_single_element
+
+@@AUTOTUNE
 """
 
 from __future__ import absolute_import
@@ -50,7 +57,9 @@ from tensorflow.contrib.data.python.ops.batching import batch_and_drop_remainder
 from tensorflow.contrib.data.python.ops.batching import dense_to_sparse_batch
 from tensorflow.contrib.data.python.ops.batching import padded_batch_and_drop_remainder
 from tensorflow.contrib.data.python.ops.batching import unbatch
+from tensorflow.contrib.data.python.ops.columnar_writer import write_columnar_file
 from tensorflow.contrib.data.python.ops.counter import Counter
+from tensorflow.contrib.data.python.ops.dataset_ops import AUTOTUNE
 from tensorflow.contrib.data.python.ops.dataset_ops import Dataset
 from tensorflow.contrib.data.python.ops.dataset_ops import get_single_element
 from tensorflow.contrib.data.python.ops.enumerate_ops import enumerate_dataset
@@ -59,11 +68,15 @@ from tensorflow.contrib.data.python.ops.grouping import group_by_window
 from tensorflow.contrib.data.python.ops.interleave_ops import parallel_interleave
 from tensorflow.contrib.data.python.ops.interleave_ops import sloppy_interleave
 from tensorflow.contrib.data.python.ops.iterator_ops import make_saveable_from_iterator
+from tensorflow.contrib.data.python.ops.readers import ColumnarDataset
 from tensorflow.contrib.data.python.ops.readers import FixedLengthRecordDataset
+from tensorflow.contrib.data.python.ops.readers import IndexedTFRecordDataset
 from tensorflow.contrib.data.python.ops.readers import read_batch_features
+from tensorflow.contrib.data.python.ops.readers import ShuffledFixedLengthRecordDataset
 from tensorflow.contrib.data.python.ops.readers import SqlDataset
 from tensorflow.contrib.data.python.ops.readers import TextLineDataset
 from tensorflow.contrib.data.python.ops.readers import TFRecordDataset
+from tensorflow.contrib.data.python.ops.remote_ops import RemoteDataset
 from tensorflow.contrib.data.python.ops.resampling import rejection_resample
 from tensorflow.contrib.data.python.ops.scan_ops import scan
 from tensorflow.contrib.data.python.ops.shuffle_ops import shuffle_and_repeat
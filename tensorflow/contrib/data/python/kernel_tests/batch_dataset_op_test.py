@@ -577,7 +577,8 @@ class BatchDatasetTest(test.TestCase):
     self.assertEqual([None], dataset.output_shapes[1][0].as_list())
     self.assertEqual([None, 30], dataset.output_shapes[1][1].as_list())
 
-  def _testBatchAndMapDatasetHelper(self, num_parallel_batches=1):
+  def _testBatchAndMapDatasetHelper(self, num_parallel_batches=None,
+                                    num_parallel_calls=None):
     """Test a dataset that maps a TF function across its input elements."""
     # The pipeline is TensorSliceDataset ->
     # RepeatDataset(count) -> BatchAndMapDataset(square_3, batch_size).
@@ -596,7 +597,8 @@ class BatchDatasetTest(test.TestCase):
             batching.map_and_batch(
                 map_func=_map_fn,
                 batch_size=batch_size,
-                num_parallel_batches=num_parallel_batches))
+                num_parallel_batches=num_parallel_batches,
+                num_parallel_calls=num_parallel_calls))
         .make_initializable_iterator())
     init_op = iterator.initializer
     get_next = iterator.get_next()
@@ -653,6 +655,12 @@ class BatchDatasetTest(test.TestCase):
   def testBatchAndMapDatasetWithParallelBatching(self):
     return self._testBatchAndMapDatasetHelper(num_parallel_batches=10)
 
+  def testBatchAndMapDatasetWithFewParallelCalls(self):
+    return self._testBatchAndMapDatasetHelper(num_parallel_calls=3)
+
+  def testBatchAndMapDatasetWithManyParallelCalls(self):
+    return self._testBatchAndMapDatasetHelper(num_parallel_calls=40)
+
   def testMapAndBatchSparse(self):
 
     def _sparse(i):
@@ -114,14 +114,15 @@ class FilesystemCacheDatasetTest(test.TestCase):
         sess.run(get_next)
 
   def testConcurrentWriters(self):
-    components = (np.array([1, 2, 3, 4]), np.array([5, 6, 7, 8]),
-                  np.array([9.0, 10.0, 11.0, 12.0]))
+    # Two shards of a pipeline write the same cache concurrently.
+    components = (np.array([1, 2, 3, 4, 5, 6]), np.array(
+        ["a", "b", "c", "d", "e", "f"]))
     filename_placeholder = array_ops.placeholder(dtypes.string, shape=[])
 
     cache_dataset1 = (dataset_ops.Dataset.from_tensor_slices(components)
-                      .cache(filename_placeholder))
+                      .shard(2, 0).cache(filename_placeholder))
     cache_dataset2 = (dataset_ops.Dataset.from_tensor_slices(components)
-                      .cache(filename_placeholder))
+                      .shard(2, 1).cache(filename_placeholder))
 
     iterator1 = cache_dataset1.make_initializable_iterator()
     iterator2 = cache_dataset2.make_initializable_iterator()
@@ -134,14 +135,57 @@ class FilesystemCacheDatasetTest(test.TestCase):
     with self.test_session() as sess:
       sess.run(
           init_cache_op1, feed_dict={filename_placeholder: self.cache_prefix})
-      sess.run(get_next1)  # this should succeed
-
       sess.run(
           init_cache_op2, feed_dict={filename_placeholder: self.cache_prefix})
-      with self.assertRaises(errors.AlreadyExistsError):
+      written = []
+      for _ in range(3):
+        written.append(sess.run(get_next1))
+        written.append(sess.run(get_next2))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next1)
+      with self.assertRaises(errors.OutOfRangeError):
         sess.run(get_next2)
 
-      sess.run(get_next1)  # this should continue to succeed
+      # Once both writers have finished, the cache holds the elements of
+      # both shards.
+      sess.run(
+          init_cache_op1, feed_dict={filename_placeholder: self.cache_prefix})
+      read = []
+      for _ in range(6):
+        read.append(sess.run(get_next1))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next1)
+      self.assertEqual(sorted((x, y) for x, y in written),
+                       sorted((x, y) for x, y in read))
+
+  def testAbandonedWriter(self):
+    dataset = dataset_ops.Dataset.range(10)
+    filename_placeholder = array_ops.placeholder(dtypes.string, shape=[])
+    cache_dataset = dataset.cache(filename_placeholder)
+    iterator = cache_dataset.make_initializable_iterator()
+    get_next = iterator.get_next()
+
+    with self.test_session() as sess:
+      # A writer that does not finish its epoch leaves no cache behind.
+      sess.run(
+          iterator.initializer,
+          feed_dict={filename_placeholder: self.cache_prefix})
+      self.assertEqual(0, sess.run(get_next))
+      sess.run(
+          iterator.initializer,
+          feed_dict={filename_placeholder: self.cache_prefix})
+      for i in range(10):
+        self.assertEqual(i, sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+      sess.run(
+          iterator.initializer,
+          feed_dict={filename_placeholder: self.cache_prefix})
+      for i in range(10):
+        self.assertEqual(i, sess.run(get_next))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
 
   def testConcurrentReaders(self):
     components = (np.array([1, 2, 3, 4]), np.array([5, 6, 7, 8]),
@@ -26,10 +26,13 @@ from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import iterator_ops
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
 from tensorflow.python.framework import function
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import resource_variable_ops
+from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 
 
@@ -108,5 +111,59 @@ class StagingAreaOpsTest(test.TestCase):
                              "/job:localhost/replica:0/task:0/gpu:0")
 
 
+class PrefetchToDeviceTest(test.TestCase):
+
+  def _prefetch_to_device_helper(self, device):
+    with ops.device("/cpu:0"):
+      dataset = dataset_ops.Dataset.range(10).map(
+          lambda x: (x, string_ops.as_string(x))).batch(3)
+    iterator = prefetching_ops.prefetch_to_device(
+        dataset, device, buffer_size=2)
+    values, strings = iterator.get_next()
+    self.assertEqual(dtypes.int64, values.dtype)
+    self.assertEqual(dtypes.string, strings.dtype)
+    self.assertEqual([None], values.shape.as_list())
+
+    config = config_pb2.ConfigProto(allow_soft_placement=False)
+    with self.test_session(config=config) as sess:
+      for _ in range(2):
+        sess.run(iterator.initializer)
+        for i in range(0, 10, 3):
+          expected = list(range(i, min(i + 3, 10)))
+          values_val, strings_val = sess.run([values, strings])
+          self.assertAllEqual(expected, values_val)
+          self.assertAllEqual([str(x).encode() for x in expected],
+                              strings_val)
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(values)
+
+  def testPrefetchToCPU(self):
+    self._prefetch_to_device_helper("/cpu:0")
+
+  def testPrefetchToGPU(self):
+    if not test_util.is_gpu_available():
+      self.skipTest("No GPU available")
+
+    self._prefetch_to_device_helper("/gpu:0")
+
+  def testUninitialized(self):
+    iterator = prefetching_ops.prefetch_to_device(
+        dataset_ops.Dataset.range(10), "/cpu:0")
+    with self.test_session() as sess:
+      with self.assertRaises(errors.FailedPreconditionError):
+        sess.run(iterator.get_next())
+
+  def testError(self):
+    dataset = dataset_ops.Dataset.from_tensor_slices([1.0, 0.0, 2.0]).map(
+        lambda x: array_ops.check_numerics(1.0 / x, "error"))
+    iterator = prefetching_ops.prefetch_to_device(dataset, "/cpu:0")
+    get_next = iterator.get_next()
+    with self.test_session() as sess:
+      sess.run(iterator.initializer)
+      self.assertEqual(1.0, sess.run(get_next))
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+
+
 if __name__ == "__main__":
   test.main()
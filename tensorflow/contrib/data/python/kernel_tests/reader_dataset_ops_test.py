@@ -21,7 +21,10 @@ import gzip
 import os
 import zlib
 
+import numpy as np
+
 from tensorflow.contrib.data.python.kernel_tests import dataset_serialization_test_base
+from tensorflow.contrib.data.python.ops import columnar_writer
 from tensorflow.contrib.data.python.ops import readers
 from tensorflow.core.example import example_pb2
 from tensorflow.core.example import feature_pb2
@@ -323,6 +326,84 @@ class FixedLengthRecordDatasetSerializationTest(
                         num_outputs)
 
 
+class ShuffledFixedLengthRecordDatasetTest(FixedLengthRecordReaderTestBase):
+
+  def _allRecords(self):
+    return [self._record(f, r) for f in range(self._num_files)
+            for r in range(self._num_records)]
+
+  def _readAll(self, sess, get_next):
+    records = []
+    while True:
+      try:
+        records.append(sess.run(get_next))
+      except errors.OutOfRangeError:
+        return records
+
+  def testShuffledRecords(self):
+    filenames = self._createFiles()
+    dataset = readers.ShuffledFixedLengthRecordDataset(
+        filenames, self._record_bytes, self._header_bytes, self._footer_bytes,
+        seed=37, num_parallel_reads=3).repeat(2)
+    get_next = dataset.make_one_shot_iterator().get_next()
+
+    with self.test_session() as sess:
+      records = self._readAll(sess, get_next)
+    num_records = self._num_files * self._num_records
+    first_epoch = records[:num_records]
+    second_epoch = records[num_records:]
+    self.assertItemsEqual(self._allRecords(), first_epoch)
+    self.assertItemsEqual(self._allRecords(), second_epoch)
+    self.assertNotEqual(self._allRecords(), first_epoch)
+    self.assertNotEqual(first_epoch, second_epoch)
+
+  def testFixedSeed(self):
+    filenames = self._createFiles()
+
+    def read(seed, reshuffle_each_iteration):
+      dataset = readers.ShuffledFixedLengthRecordDataset(
+          filenames, self._record_bytes, self._header_bytes,
+          self._footer_bytes, seed=seed,
+          reshuffle_each_iteration=reshuffle_each_iteration).repeat(2)
+      get_next = dataset.make_one_shot_iterator().get_next()
+      with self.test_session() as sess:
+        return self._readAll(sess, get_next)
+
+    records = read(seed=37, reshuffle_each_iteration=False)
+    num_records = self._num_files * self._num_records
+    self.assertEqual(records[:num_records], records[num_records:])
+    self.assertEqual(records, read(seed=37, reshuffle_each_iteration=False))
+
+  def testInvalidFileSize(self):
+    filenames = self._createFiles()
+    dataset = readers.ShuffledFixedLengthRecordDataset(
+        filenames, self._record_bytes + 1, self._header_bytes,
+        self._footer_bytes)
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaises(errors.DataLossError):
+        sess.run(get_next)
+
+
+class ShuffledFixedLengthRecordDatasetSerializationTest(
+    FixedLengthRecordReaderTestBase,
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_iterator_graph(self, num_epochs):
+    filenames = self._createFiles()
+    return readers.ShuffledFixedLengthRecordDataset(
+        filenames, self._record_bytes, self._header_bytes,
+        self._footer_bytes, seed=37,
+        reshuffle_each_iteration=False).repeat(num_epochs)
+
+  def testShuffledFixedLengthRecordCore(self):
+    num_epochs = 5
+    num_outputs = num_epochs * self._num_files * self._num_records
+    self.run_core_tests(lambda: self._build_iterator_graph(num_epochs),
+                        lambda: self._build_iterator_graph(num_epochs * 2),
+                        num_outputs)
+
+
 class TFRecordDatasetTestBase(test.TestCase):
 
   def setUp(self):
@@ -554,6 +635,241 @@ class TFRecordDatasetSerializationTest(
         lambda: self._build_iterator_graph(num_epochs * 2), num_outputs)
 
 
+class IndexedTFRecordDatasetTestBase(test.TestCase):
+
+  def setUp(self):
+    super(IndexedTFRecordDatasetTestBase, self).setUp()
+    self._num_files = 2
+    self._num_records = 7
+    self.test_filenames = self._createFiles()
+
+  def _record(self, f, r):
+    return compat.as_bytes("Record %d of file %d" % (r, f))
+
+  def _createFiles(self):
+    filenames = []
+    for i in range(self._num_files):
+      fn = os.path.join(self.get_temp_dir(), "indexed_tf_record.%d.txt" % i)
+      filenames.append(fn)
+      writer = python_io.TFRecordWriter(fn, write_index=True)
+      for j in range(self._num_records):
+        writer.write(self._record(i, j))
+      writer.close()
+    return filenames
+
+
+class IndexedTFRecordDatasetTest(IndexedTFRecordDatasetTestBase):
+
+  def _readAll(self, dataset):
+    get_next = dataset.make_one_shot_iterator().get_next()
+    records = []
+    with self.test_session() as sess:
+      while True:
+        try:
+          records.append(sess.run(get_next))
+        except errors.OutOfRangeError:
+          break
+    return records
+
+  def testReadAllRecords(self):
+    for buffer_size in [0, None]:
+      records = self._readAll(readers.IndexedTFRecordDataset(
+          self.test_filenames, buffer_size=buffer_size))
+      self.assertAllEqual([
+          self._record(f, r)
+          for f in range(self._num_files)
+          for r in range(self._num_records)
+      ], records)
+
+  def testReadShards(self):
+    num_shards = 3
+    all_records = []
+    for shard_index in range(num_shards):
+      records = self._readAll(readers.IndexedTFRecordDataset(
+          self.test_filenames, num_shards=num_shards, shard_index=shard_index))
+      # Each shard holds a contiguous range of the records of each file.
+      expected = []
+      for f in range(self._num_files):
+        begin = self._num_records * shard_index // num_shards
+        end = self._num_records * (shard_index + 1) // num_shards
+        expected.extend(self._record(f, r) for r in range(begin, end))
+      self.assertAllEqual(expected, records)
+      all_records.extend(records)
+    self.assertEqual(self._num_files * self._num_records, len(all_records))
+
+  def testSkipCorruptedRecords(self):
+    # Corrupt the data of record 2 of file 0, which follows two records of a
+    # 12 byte header, 20 bytes of data and a 4 byte footer.
+    corrupt_offset = 2 * (12 + 20 + 4) + 12
+    with open(self.test_filenames[0], "rb") as f:
+      contents = bytearray(f.read())
+    contents[corrupt_offset] ^= 1
+    with open(self.test_filenames[0], "wb") as f:
+      f.write(bytes(contents))
+
+    get_next = readers.IndexedTFRecordDataset(
+        self.test_filenames).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      for r in range(2):
+        self.assertAllEqual(self._record(0, r), sess.run(get_next))
+      with self.assertRaises(errors.DataLossError):
+        sess.run(get_next)
+
+    records = self._readAll(readers.IndexedTFRecordDataset(
+        self.test_filenames, skip_corrupted_records=True))
+    self.assertAllEqual([
+        self._record(f, r)
+        for f in range(self._num_files)
+        for r in range(self._num_records)
+        if (f, r) != (0, 2)
+    ], records)
+
+  def testMissingIndex(self):
+    fn = os.path.join(self.get_temp_dir(), "unindexed_tf_record.txt")
+    writer = python_io.TFRecordWriter(fn)
+    writer.write(self._record(0, 0))
+    writer.close()
+    get_next = readers.IndexedTFRecordDataset(
+        [fn]).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaises(errors.NotFoundError):
+        sess.run(get_next)
+
+
+class IndexedTFRecordDatasetSerializationTest(
+    IndexedTFRecordDatasetTestBase,
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_iterator_graph(self, num_epochs):
+    return readers.IndexedTFRecordDataset(
+        self.test_filenames, num_shards=2, shard_index=1).repeat(num_epochs)
+
+  def testIndexedTFRecordCore(self):
+    num_epochs = 5
+    num_outputs = num_epochs * self._num_files * (self._num_records -
+                                                  self._num_records // 2)
+    self.run_core_tests(lambda: self._build_iterator_graph(num_epochs),
+                        lambda: self._build_iterator_graph(num_epochs * 2),
+                        num_outputs)
+
+
+class ColumnarDatasetTestBase(test.TestCase):
+
+  def setUp(self):
+    super(ColumnarDatasetTestBase, self).setUp()
+    self._num_files = 2
+    self._num_rows = 10
+    self._row_group_size = 4
+    self.test_filenames = self._createFiles()
+
+  def _columns(self, f):
+    rows = np.arange(self._num_rows)
+    return {
+        "id": (rows + 100 * f).astype(np.int64),
+        "embedding": np.stack([rows * 0.5, -rows * 0.5], axis=1).astype(
+            np.float32),
+        "name": np.array(["file %d row %d" % (f, r) for r in rows],
+                         dtype=object),
+    }
+
+  def _createFiles(self):
+    filenames = []
+    for i in range(self._num_files):
+      fn = os.path.join(self.get_temp_dir(), "columnar.%d" % i)
+      filenames.append(fn)
+      columnar_writer.write_columnar_file(fn, self._columns(i),
+                                          self._row_group_size)
+    return filenames
+
+
+class ColumnarDatasetTest(ColumnarDatasetTestBase):
+
+  def testReadAllColumns(self):
+    dataset = readers.ColumnarDataset(
+        self.test_filenames,
+        {"id": dtypes.int64, "embedding": dtypes.float32,
+         "name": dtypes.string},
+        shapes={"id": [], "embedding": [2], "name": []})
+    self.assertEqual([None, 2], dataset.output_shapes["embedding"].as_list())
+    get_next = dataset.make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      for f in range(self._num_files):
+        columns = self._columns(f)
+        for start in range(0, self._num_rows, self._row_group_size):
+          end = min(start + self._row_group_size, self._num_rows)
+          row_group = sess.run(get_next)
+          self.assertAllEqual(columns["id"][start:end], row_group["id"])
+          self.assertAllEqual(columns["embedding"][start:end],
+                              row_group["embedding"])
+          self.assertAllEqual(
+              [compat.as_bytes(v) for v in columns["name"][start:end]],
+              row_group["name"])
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(get_next)
+
+  def testReadSomeColumns(self):
+    # Only the requested column is read.
+    get_next = readers.ColumnarDataset(
+        self.test_filenames[1],
+        {"id": dtypes.int64}).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      ids = []
+      while True:
+        try:
+          row_group = sess.run(get_next)
+        except errors.OutOfRangeError:
+          break
+        self.assertEqual(["id"], list(row_group.keys()))
+        ids.extend(row_group["id"])
+      self.assertAllEqual(self._columns(1)["id"], ids)
+
+  def testMissingColumn(self):
+    get_next = readers.ColumnarDataset(
+        self.test_filenames,
+        {"missing": dtypes.int64}).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+
+  def testWrongType(self):
+    get_next = readers.ColumnarDataset(
+        self.test_filenames,
+        {"id": dtypes.float32}).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(get_next)
+
+  def testTruncatedFile(self):
+    with open(self.test_filenames[0], "rb") as f:
+      contents = f.read()
+    with open(self.test_filenames[0], "wb") as f:
+      f.write(contents[:-1])
+    get_next = readers.ColumnarDataset(
+        self.test_filenames,
+        {"id": dtypes.int64}).make_one_shot_iterator().get_next()
+    with self.test_session() as sess:
+      with self.assertRaises(errors.DataLossError):
+        sess.run(get_next)
+
+
+class ColumnarDatasetSerializationTest(
+    ColumnarDatasetTestBase,
+    dataset_serialization_test_base.DatasetSerializationTestBase):
+
+  def _build_iterator_graph(self, num_epochs):
+    return readers.ColumnarDataset(
+        self.test_filenames,
+        {"id": dtypes.int64, "name": dtypes.string}).repeat(num_epochs)
+
+  def testColumnarCore(self):
+    num_epochs = 5
+    num_row_groups = -(-self._num_rows // self._row_group_size)
+    num_outputs = num_epochs * self._num_files * num_row_groups
+    self.run_core_tests(lambda: self._build_iterator_graph(num_epochs),
+                        lambda: self._build_iterator_graph(num_epochs * 2),
+                        num_outputs)
+
+
 class ReadBatchFeaturesTest(test.TestCase):
 
   def setUp(self):
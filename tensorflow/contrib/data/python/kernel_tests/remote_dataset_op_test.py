@@ -0,0 +1,129 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the experimental input pipeline ops that run on remote workers."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.contrib.data.python.ops import dataset_ops
+from tensorflow.contrib.data.python.ops import remote_ops
+from tensorflow.python.client import session
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
+from tensorflow.python.platform import test
+
+
+class RemoteDatasetTest(test.TestCase):
+
+  def setUp(self):
+    self._workers, _ = test_util.create_local_cluster(3, 1)
+    self._data_workers = [
+        "/job:worker/replica:0/task:%d/cpu:0" % i for i in (1, 2)
+    ]
+
+  def _getAll(self, get_next):
+    elements = []
+    with session.Session(self._workers[0].target) as sess:
+      while True:
+        try:
+          elements.append(sess.run(get_next))
+        except errors.OutOfRangeError:
+          break
+    return elements
+
+  def testShardedDatasets(self):
+
+    def dataset_fn(worker_index):
+      return dataset_ops.Dataset.range(20).shard(2, worker_index).map(
+          lambda x: (x, x * 2)).batch(3)
+
+    with ops.device("/job:worker/replica:0/task:0/cpu:0"):
+      dataset = remote_ops.RemoteDataset(dataset_fn, self._data_workers)
+      get_next = dataset.make_one_shot_iterator().get_next()
+    self.assertEqual([None], get_next[0].shape.as_list())
+
+    batches = self._getAll(get_next)
+    self.assertEqual(8, len(batches))
+    values = sorted(x for batch in batches for x in batch[0])
+    self.assertEqual(list(range(20)), values)
+    for batch in batches:
+      self.assertAllEqual(batch[0] * 2, batch[1])
+
+  def testWorkersEndAtDifferentTimes(self):
+
+    def dataset_fn(worker_index):
+      return dataset_ops.Dataset.range(worker_index * 10, worker_index * 10 +
+                                       (1 + worker_index * 9))
+
+    with ops.device("/job:worker/replica:0/task:0/cpu:0"):
+      dataset = remote_ops.RemoteDataset(
+          dataset_fn, self._data_workers, buffer_size=4)
+      get_next = dataset.make_one_shot_iterator().get_next()
+
+    self.assertEqual([0] + list(range(10, 20)), sorted(self._getAll(get_next)))
+
+  def testReinitialize(self):
+
+    def dataset_fn(worker_index):
+      return dataset_ops.Dataset.range(3).map(lambda x: x + 3 * worker_index)
+
+    with ops.device("/job:worker/replica:0/task:0/cpu:0"):
+      dataset = remote_ops.RemoteDataset(dataset_fn, self._data_workers)
+      iterator = dataset.make_initializable_iterator()
+      get_next = iterator.get_next()
+
+    with session.Session(self._workers[0].target) as sess:
+      for _ in range(2):
+        sess.run(iterator.initializer)
+        elements = []
+        for _ in range(6):
+          elements.append(sess.run(get_next))
+        self.assertEqual(list(range(6)), sorted(elements))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(get_next)
+
+  def testWorkerError(self):
+
+    def dataset_fn(worker_index):
+      dataset = dataset_ops.Dataset.from_tensor_slices([1.0, 0.0])
+      if worker_index == 1:
+        dataset = dataset.map(
+            lambda x: array_ops.check_numerics(1.0 / x, "error"))
+      return dataset
+
+    with ops.device("/job:worker/replica:0/task:0/cpu:0"):
+      dataset = remote_ops.RemoteDataset(dataset_fn, self._data_workers)
+      get_next = dataset.make_one_shot_iterator().get_next()
+
+    with session.Session(self._workers[0].target) as sess:
+      with self.assertRaisesRegexp(errors.InvalidArgumentError, "error"):
+        for _ in range(4):
+          sess.run(get_next)
+
+  def testDifferentTypes(self):
+
+    def dataset_fn(worker_index):
+      if worker_index == 0:
+        return dataset_ops.Dataset.range(3)
+      return dataset_ops.Dataset.from_tensor_slices([1.0])
+
+    with self.assertRaisesRegexp(ValueError, "different types"):
+      remote_ops.RemoteDataset(dataset_fn, self._data_workers)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -19,6 +19,7 @@ from __future__ import print_function
 
 import numpy as np
 
+from tensorflow.contrib.data.python.ops import dataset_ops as contrib_dataset_ops
 from tensorflow.contrib.data.python.ops import stats_ops
 from tensorflow.core.framework import summary_pb2
 from tensorflow.python.data.ops import dataset_ops
@@ -93,6 +94,38 @@ class StatsDatasetTest(test.TestCase):
         sess.run(next_element)
       self._assertSummaryHasCount(sess.run(summary_t), "record_latency", 100.0)
 
+  def testPipelineStats(self):
+    dataset = dataset_ops.Dataset.range(100).map(lambda x: x * x).prefetch(1)
+    iterator = dataset.make_initializable_iterator()
+    stats_aggregator = stats_ops.StatsAggregator()
+    stats_aggregator_subscriber = stats_aggregator.subscribe(iterator)
+    next_element = iterator.get_next()
+    summary_t = stats_aggregator.get_summary()
+
+    with self.test_session() as sess:
+      sess.run([iterator.initializer, stats_aggregator_subscriber])
+      for i in range(100):
+        self.assertEqual(i * i, sess.run(next_element))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+      summary_str = sess.run(summary_t)
+      for stage in ["Iterator::Prefetch", "Iterator::Prefetch::Map",
+                    "Iterator::Prefetch::Map::Range"]:
+        self._assertSummaryHasCount(summary_str, stage + "::get_next_usecs",
+                                    100.0)
+        self._assertSummaryHasCount(summary_str, stage + "::input_wait_usecs",
+                                    100.0)
+      self._assertSummaryHasCount(
+          summary_str, "Iterator::Prefetch::buffer_utilization", 101.0)
+      summary_proto = summary_pb2.Summary()
+      summary_proto.ParseFromString(summary_str)
+      pipeline = [v for v in summary_proto.value if v.tag == "pipeline"]
+      self.assertEqual(1, len(pipeline))
+      self.assertEqual("text", pipeline[0].metadata.plugin_data.plugin_name)
+      table = pipeline[0].tensor.string_val[0].decode("utf-8")
+      self.assertIn("Iterator::Prefetch::Map::Range", table)
+      self.assertIn("(bottleneck)", table)
+
   def testReinitialize(self):
     dataset = dataset_ops.Dataset.range(100).apply(
         stats_ops.latency_stats("record_latency"))
@@ -208,6 +241,40 @@ class StatsDatasetTest(test.TestCase):
       with self.assertRaises(errors.FailedPreconditionError):
         sess.run(stats_aggregator_1.subscribe(iterator))
 
+  def testAutotuneStats(self):
+    dataset = dataset_ops.Dataset.range(100).map(
+        lambda x: x * x,
+        num_parallel_calls=contrib_dataset_ops.AUTOTUNE).prefetch(
+            contrib_dataset_ops.AUTOTUNE)
+    iterator = dataset.make_initializable_iterator()
+    stats_aggregator = stats_ops.StatsAggregator()
+    stats_aggregator_subscriber = stats_aggregator.subscribe(iterator)
+    next_element = iterator.get_next()
+    summary_t = stats_aggregator.get_summary()
+
+    with self.test_session() as sess:
+      sess.run([iterator.initializer, stats_aggregator_subscriber])
+      for i in range(100):
+        self.assertEqual(i * i, sess.run(next_element))
+      with self.assertRaises(errors.OutOfRangeError):
+        sess.run(next_element)
+      # The autotuners record their state once per window of 32 elements.
+      summary_str = sess.run(summary_t)
+      for prefix in ["Iterator::Prefetch", "Iterator::Prefetch::ParallelMap"]:
+        self._assertSummaryHasCount(
+            summary_str, prefix + "::autotune_target", 3.0)
+        self._assertSummaryHasCount(
+            summary_str, prefix + "::autotune_wait_fraction", 3.0)
+
+  def testAutotuneInvalidValue(self):
+    dataset = dataset_ops.Dataset.range(10).prefetch(-2)
+    iterator = dataset.make_initializable_iterator()
+
+    with self.test_session() as sess:
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "buffer_size must be > 0"):
+        sess.run(iterator.initializer)
+
 
 if __name__ == "__main__":
   test.main()
@@ -350,27 +350,46 @@ class _RestructuredDataset(dataset_ops.Dataset):
 class _MapAndBatchDataset(dataset_ops.MapDataset):
   """A `Dataset` that maps a function over a batch of elements."""
 
-  def __init__(self, input_dataset, map_func, batch_size, num_parallel_batches):
+  def __init__(self, input_dataset, map_func, batch_size, num_parallel_batches,
+               num_parallel_calls=None):
     """See `Dataset.map()` for details."""
     super(_MapAndBatchDataset, self).__init__(input_dataset, map_func)
     self._batch_size = ops.convert_to_tensor(
         batch_size, dtype=dtypes.int64, name="batch_size")
-    self._num_parallel_batches = ops.convert_to_tensor(
-        num_parallel_batches, dtype=dtypes.int64, name="num_parallel_batches")
+    if num_parallel_calls is None:
+      self._num_parallel_batches = ops.convert_to_tensor(
+          num_parallel_batches, dtype=dtypes.int64,
+          name="num_parallel_batches")
+      self._num_parallel_calls = None
+    else:
+      self._num_parallel_batches = None
+      self._num_parallel_calls = ops.convert_to_tensor(
+          num_parallel_calls, dtype=dtypes.int64, name="num_parallel_calls")
 
   def _as_variant_tensor(self):
     # pylint: disable=protected-access
     input_resource = self._input_dataset._as_variant_tensor()
+    output_types = nest.flatten(
+        sparse.as_dense_types(self.output_types, self.output_classes))
+    output_shapes = nest.flatten(
+        sparse.as_dense_shapes(self.output_shapes, self.output_classes))
+    if self._num_parallel_calls is not None:
+      return gen_dataset_ops.map_and_batch_dataset_v2(
+          input_resource,
+          self._map_func.captured_inputs,
+          f=self._map_func,
+          batch_size=self._batch_size,
+          num_parallel_calls=self._num_parallel_calls,
+          output_types=output_types,
+          output_shapes=output_shapes)
     return gen_dataset_ops.map_and_batch_dataset(
         input_resource,
         self._map_func.captured_inputs,
         f=self._map_func,
         batch_size=self._batch_size,
         num_parallel_batches=self._num_parallel_batches,
-        output_types=nest.flatten(
-            sparse.as_dense_types(self.output_types, self.output_classes)),
-        output_shapes=nest.flatten(
-            sparse.as_dense_shapes(self.output_shapes, self.output_classes)))
+        output_types=output_types,
+        output_shapes=output_shapes)
     # pylint: enable=protected-access
 
   @property
@@ -386,7 +405,8 @@ class _MapAndBatchDataset(dataset_ops.MapDataset):
     return self._output_types
 
 
-def map_and_batch(map_func, batch_size, num_parallel_batches=1):
+def map_and_batch(map_func, batch_size, num_parallel_batches=None,
+                  num_parallel_calls=None):
   """Fused implementation of `map` and `batch`.
 
   Maps `map_func` across `batch_size` consecutive elements of this dataset
@@ -402,18 +422,34 @@ def map_and_batch(map_func, batch_size, num_parallel_batches=1):
       nested structure of tensors.
     batch_size: A `tf.int64` scalar `tf.Tensor`, representing the number of
       consecutive elements of this dataset to combine in a single batch.
-    num_parallel_batches: A `tf.int64` scalar `tf.Tensor`, representing the
-      number of batches to create in parallel. On one hand, higher values can
-      help mitigate the effect of stragglers. On the other hand, higher values
-      can increasing contention if CPU is scarce.
+    num_parallel_batches: (Optional.) A `tf.int64` scalar `tf.Tensor`,
+      representing the number of batches to create in parallel, with
+      `batch_size` invocations of `map_func` each. On one hand, higher values
+      can help mitigate the effect of stragglers. On the other hand, higher
+      values can increasing contention if CPU is scarce. Defaults to 1 if
+      `num_parallel_calls` is not set.
+    num_parallel_calls: (Optional.) A `tf.int64` scalar `tf.Tensor`,
+      representing the maximum number of invocations of `map_func` in flight,
+      independently of `batch_size`. The invocations may span several batches,
+      and at least two batches are produced at once. Must not be set together
+      with `num_parallel_batches`.
 
   Returns:
     A `Dataset` transformation function, which can be passed to
     @{tf.contrib.data.Dataset.apply}.
+
+  Raises:
+    ValueError: If both `num_parallel_batches` and `num_parallel_calls` are
+      set.
   """
+  if num_parallel_batches is not None and num_parallel_calls is not None:
+    raise ValueError("At most one of `num_parallel_batches` and "
+                     "`num_parallel_calls` may be set.")
+  if num_parallel_batches is None and num_parallel_calls is None:
+    num_parallel_batches = 1
 
   def _apply_fn(dataset):
     return _MapAndBatchDataset(dataset, map_func, batch_size,
-                               num_parallel_batches)
+                               num_parallel_batches, num_parallel_calls)
 
   return _apply_fn
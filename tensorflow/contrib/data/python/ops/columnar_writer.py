@@ -0,0 +1,117 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Writer of the columnar files read by `ColumnarDataset`."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import struct
+
+import numpy as np
+
+from tensorflow.core.util import columnar_file_pb2
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import tensor_shape
+from tensorflow.python.lib.io import file_io
+from tensorflow.python.util import compat
+
+# The magic number at the end of a columnar file ("tfcolumn"). See
+# tensorflow/core/util/columnar_file.proto for the format.
+_COLUMNAR_FILE_MAGIC = 0x6e6d756c6f636674
+
+
+def _encode_varint(value):
+  """Returns the bytes of `value` as a varint."""
+  encoded = bytearray()
+  while value >= 0x80:
+    encoded.append((value & 0x7f) | 0x80)
+    value >>= 7
+  encoded.append(value)
+  return bytes(encoded)
+
+
+def _column_dtype(array):
+  if array.dtype.kind in ("S", "U", "O"):
+    return dtypes.string
+  return dtypes.as_dtype(array.dtype)
+
+
+def _encode_chunk(values, dtype):
+  """Returns the bytes of the chunk of the column `values` of type `dtype`."""
+  if dtype == dtypes.string:
+    values = [compat.as_bytes(v) for v in values.flat]
+    return b"".join([_encode_varint(len(v)) for v in values] + values)
+  return np.ascontiguousarray(
+      values, dtype=values.dtype.newbyteorder("<")).tobytes()
+
+
+def write_columnar_file(filename, columns, row_group_size):
+  """Writes a table of named columns to a columnar file.
+
+  The file stores the values of each column in each row group contiguously,
+  so that a `tf.contrib.data.ColumnarDataset` reads only the columns it needs,
+  and decodes each row group of a column straight into a batch.
+
+  Args:
+    filename: The name of the file to write.
+    columns: A dictionary mapping the name of each column to an array-like
+      of its values, with one element per row. Every column must have the same
+      number of rows, and strings, numbers or booleans of the same shape in
+      every row.
+    row_group_size: The number of rows in each row group, except the last
+      one which may be smaller. `ColumnarDataset` emits a row group per
+      element, so this is typically the batch size.
+
+  Raises:
+    ValueError: If `columns` is empty, the columns have different numbers of
+      rows, or `row_group_size` is not positive.
+  """
+  if not columns:
+    raise ValueError("At least one column must be written.")
+  if row_group_size <= 0:
+    raise ValueError("row_group_size must be positive, but is %d." %
+                     row_group_size)
+  names = sorted(columns)
+  arrays = [np.asarray(columns[name]) for name in names]
+  num_rows = len(arrays[0])
+  for name, array in zip(names, arrays):
+    if len(array) != num_rows:
+      raise ValueError("Column %s has %d rows, but column %s has %d." %
+                       (name, len(array), names[0], num_rows))
+
+  metadata = columnar_file_pb2.ColumnarFileMetadata()
+  column_dtypes = []
+  for name, array in zip(names, arrays):
+    column = metadata.columns.add()
+    column.name = name
+    column_dtypes.append(_column_dtype(array))
+    column.dtype = column_dtypes[-1].as_datatype_enum
+    column.shape.CopyFrom(tensor_shape.TensorShape(array.shape[1:]).as_proto())
+
+  with file_io.FileIO(filename, "wb") as f:
+    offset = 0
+    for start in range(0, num_rows, row_group_size):
+      row_group = metadata.row_groups.add()
+      row_group.num_rows = min(row_group_size, num_rows - start)
+      for array, dtype in zip(arrays, column_dtypes):
+        chunk = _encode_chunk(array[start:start + row_group.num_rows], dtype)
+        f.write(chunk)
+        column_chunk = row_group.chunks.add()
+        column_chunk.offset = offset
+        column_chunk.size = len(chunk)
+        offset += len(chunk)
+    serialized_metadata = metadata.SerializeToString()
+    f.write(serialized_metadata)
+    f.write(struct.pack("<QQ", len(serialized_metadata), _COLUMNAR_FILE_MAGIC))
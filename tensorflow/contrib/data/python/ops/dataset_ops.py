@@ -27,6 +27,14 @@ from tensorflow.python.ops import gen_dataset_ops
 from tensorflow.python.ops import gen_io_ops
 from tensorflow.python.util import deprecation
 
+# The value of the `buffer_size` argument of `Dataset.prefetch()` and the
+# `num_parallel_calls` argument of `Dataset.map()` that lets each iterator
+# choose it at runtime, growing it while the consumer of the iterator waits
+# for elements. The number of parallel calls is bounded by the environment
+# variable TF_DATA_AUTOTUNE_CPU_BUDGET (by default, the number of CPUs) and
+# the memory of a prefetch buffer by TF_DATA_AUTOTUNE_RAM_BUDGET_MB (by
+# default, 1024).
+AUTOTUNE = -1
 
 class Dataset(dataset_ops.Dataset):
   """Represents a potentially large set of elements.
@@ -317,9 +325,12 @@ class Dataset(dataset_ops.Dataset):
     """Caches the elements in this dataset.
 
     Args:
-      filename: A `tf.string` scalar `tf.Tensor`, representing the name of a
-        directory on the filesystem to use for caching tensors in this Dataset.
+      filename: A `tf.string` scalar `tf.Tensor`, representing the prefix of
+        the files on the filesystem to use for caching tensors in this Dataset.
         If a filename is not provided, the dataset will be cached in memory.
+        Iterators over the shards of a pipeline may write the same cache
+        concurrently, and iterators that read an existing cache memory-map
+        its files.
 
     Returns:
       A `Dataset`.
@@ -19,6 +19,10 @@ from __future__ import print_function
 
 from tensorflow.contrib.data.python.ops import gen_prefetching_ops
 from tensorflow.contrib.util import loader
+from tensorflow.python.data.util import nest
+from tensorflow.python.data.util import sparse
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_dataset_ops
 from tensorflow.python.platform import resource_loader
 
 _prefetching_ops = loader.load_op_library(
@@ -53,3 +57,108 @@ def function_buffering_resource_get_next(function_buffer_resource,
       function_buffer_resource=function_buffer_resource,
       output_types=output_types,
       name=name)
+
+
+class DevicePrefetchIterator(object):
+  """An iterator that prefetches the elements of a dataset to a device.
+
+  Use `prefetch_to_device()` to create one.
+  """
+
+  def __init__(self, dataset, device, buffer_size, shared_name):
+    self._output_classes = dataset.output_classes
+    self._output_types = dataset.output_types
+    self._output_shapes = dataset.output_shapes
+    # The dataset itself runs on the host, in the device scope of the caller.
+    dataset_variant = dataset._as_variant_tensor()  # pylint: disable=protected-access
+    with ops.device(device):
+      self._iterator_resource = gen_dataset_ops.device_prefetch_iterator(
+          buffer_size=buffer_size,
+          output_types=nest.flatten(
+              sparse.as_dense_types(self._output_types, self._output_classes)),
+          output_shapes=nest.flatten(
+              sparse.as_dense_shapes(self._output_shapes,
+                                     self._output_classes)),
+          shared_name=shared_name)
+      self._initializer = gen_dataset_ops.make_device_prefetch_iterator(
+          dataset_variant, self._iterator_resource)
+
+  @property
+  def initializer(self):
+    """A `tf.Operation` that should be run to initialize this iterator."""
+    return self._initializer
+
+  @property
+  def output_classes(self):
+    return self._output_classes
+
+  @property
+  def output_shapes(self):
+    return self._output_shapes
+
+  @property
+  def output_types(self):
+    return self._output_types
+
+  def get_next(self, name=None):
+    """Returns a nested structure of `tf.Tensor`s containing the next element.
+
+    The tensors are on the device of the iterator, except the components of a
+    type that is always kept in host memory, such as `tf.string`.
+
+    Args:
+      name: (Optional.) A name for the created operation.
+
+    Returns:
+      A nested structure of `tf.Tensor` objects.
+    """
+    with ops.colocate_with(self._iterator_resource):
+      flat_ret = gen_dataset_ops.device_prefetch_iterator_get_next(
+          self._iterator_resource,
+          output_types=nest.flatten(
+              sparse.as_dense_types(self._output_types, self._output_classes)),
+          output_shapes=nest.flatten(
+              sparse.as_dense_shapes(self._output_shapes,
+                                     self._output_classes)),
+          name=name)
+    return sparse.deserialize_sparse_tensors(
+        nest.pack_sequence_as(self._output_types, flat_ret),
+        self._output_types, self._output_shapes, self._output_classes)
+
+
+def prefetch_to_device(dataset, device, buffer_size=1, shared_name=None):
+  """Creates an iterator that prefetches the elements of `dataset` to `device`.
+
+  The iterator runs `dataset` on the host, and copies its elements to
+  `device` asynchronously, up to `buffer_size` elements ahead of the
+  consumer. On a GPU, the batches built by `Dataset.batch()` and
+  `Dataset.padded_batch()` are allocated in pinned host memory, and the
+  copies run on the host-to-device stream of the GPU, so that `get_next()`
+  returns tensors that are already in GPU memory. It must therefore be the
+  last stage of an input pipeline:
+
+  ```python
+  dataset = ...  # Runs on the CPU.
+  dataset = dataset.batch(32)
+  iterator = prefetch_to_device(dataset, "/gpu:0", buffer_size=2)
+  # ...
+  sess.run(iterator.initializer)
+  images, labels = iterator.get_next()  # On "/gpu:0".
+  ```
+
+  Args:
+    dataset: A `tf.data.Dataset`.
+    device: A string. The name of the device to prefetch the elements to.
+    buffer_size: (Optional.) The number of elements to buffer on `device`.
+      Defaults to 1.
+    shared_name: (Optional.) If non-empty, the returned iterator will be
+      shared under the given name across multiple sessions that share the
+      same devices (e.g. when using a remote server).
+
+  Returns:
+    A `DevicePrefetchIterator`, which must be initialized by running its
+    `initializer` before calling its `get_next()`.
+  """
+  if shared_name is None:
+    shared_name = ""
+  return DevicePrefetchIterator(dataset, device, buffer_size, shared_name)
@@ -21,8 +21,10 @@ from tensorflow.contrib.data.python.ops import dataset_ops as contrib_dataset_op
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import readers
 from tensorflow.python.data.util import nest
+from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
+from tensorflow.python.framework import random_seed
 from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import gen_dataset_ops
 from tensorflow.python.ops import parsing_ops
@@ -97,6 +99,258 @@ class FixedLengthRecordDataset(contrib_dataset_ops.Dataset):
     super(FixedLengthRecordDataset, self).__init__(dataset)
 
 
+class ShuffledFixedLengthRecordDataset(contrib_dataset_ops.Dataset):
+  """A `Dataset` of the fixed-length records of binary files, in random order.
+
+  `FixedLengthRecordDataset(...).shuffle(buffer_size)` keeps `buffer_size`
+  records in memory, and only mixes records that are less than about
+  `buffer_size` records apart. This dataset instead shuffles the indices of
+  all the records of all the files and reads each record from its offset, so
+  that the records are in a uniformly random order, for the memory cost of 8
+  bytes per record. It is best suited to files that support fast random
+  access, and reads `num_parallel_reads` records concurrently to hide their
+  latency.
+  """
+
+  def __init__(self,
+               filenames,
+               record_bytes,
+               header_bytes=None,
+               footer_bytes=None,
+               seed=None,
+               num_parallel_reads=None,
+               reshuffle_each_iteration=None):
+    """Creates a `ShuffledFixedLengthRecordDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      record_bytes: A `tf.int64` scalar representing the number of bytes in
+        each record.
+      header_bytes: (Optional.) A `tf.int64` scalar representing the number of
+        bytes to skip at the start of a file.
+      footer_bytes: (Optional.) A `tf.int64` scalar representing the number of
+        bytes to ignore at the end of a file.
+      seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the
+        random seed that will be used to create the distribution. See
+        @{tf.set_random_seed} for behavior.
+      num_parallel_reads: (Optional.) A `tf.int64` scalar representing the
+        number of records to read concurrently. Defaults to 16.
+      reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
+        that the dataset should be pseudorandomly reshuffled each time it is
+        iterated over. (Defaults to `True`.)
+    """
+    dataset = _ShuffledFixedLengthRecordDataset(
+        filenames, record_bytes, header_bytes, footer_bytes, seed,
+        num_parallel_reads, reshuffle_each_iteration)
+    super(ShuffledFixedLengthRecordDataset, self).__init__(dataset)
+
+
+class _ShuffledFixedLengthRecordDataset(dataset_ops.Dataset):
+  """A `Dataset` of the fixed-length records of binary files, in random order.
+  """
+
+  def __init__(self, filenames, record_bytes, header_bytes, footer_bytes, seed,
+               num_parallel_reads, reshuffle_each_iteration):
+    """See `ShuffledFixedLengthRecordDataset()` for details."""
+    super(_ShuffledFixedLengthRecordDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+    self._record_bytes = ops.convert_to_tensor(
+        record_bytes, dtype=dtypes.int64, name="record_bytes")
+    self._header_bytes = _convert_optional_param_to_tensor(
+        "header_bytes", header_bytes, 0)
+    self._footer_bytes = _convert_optional_param_to_tensor(
+        "footer_bytes", footer_bytes, 0)
+    self._num_parallel_reads = _convert_optional_param_to_tensor(
+        "num_parallel_reads", num_parallel_reads, 16)
+    seed, seed2 = random_seed.get_seed(seed)
+    self._seed = _convert_optional_param_to_tensor("seed", seed, 0)
+    self._seed2 = _convert_optional_param_to_tensor("seed2", seed2, 0)
+    if reshuffle_each_iteration is None:
+      self._reshuffle_each_iteration = True
+    else:
+      self._reshuffle_each_iteration = reshuffle_each_iteration
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.shuffled_fixed_length_record_dataset(
+        self._filenames,
+        self._header_bytes,
+        self._record_bytes,
+        self._footer_bytes,
+        self._seed,
+        self._seed2,
+        self._num_parallel_reads,
+        reshuffle_each_iteration=self._reshuffle_each_iteration)
+
+  @property
+  def output_classes(self):
+    return ops.Tensor
+
+  @property
+  def output_shapes(self):
+    return tensor_shape.scalar()
+
+  @property
+  def output_types(self):
+    return dtypes.string
+
+
+class ColumnarDataset(contrib_dataset_ops.Dataset):
+  """A `Dataset` of the row groups of columnar files.
+
+  A columnar file, as written by `tf.contrib.data.write_columnar_file`, stores
+  a table of named columns, whose rows are split into row groups. Each element
+  of this dataset is a dictionary that maps the name of each requested column
+  to a batch of its values in a row group. Only the requested columns are
+  read, each row group of a column is decoded straight into its batch, and
+  the next row group is read in the background.
+  """
+
+  def __init__(self, filenames, columns, shapes=None):
+    """Creates a `ColumnarDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      columns: A dictionary mapping the name of each column to read to its
+        `tf.DType`.
+      shapes: (Optional.) A dictionary mapping the names of some of the
+        columns to the `tf.TensorShape` of their value in a row. The shapes of
+        the other columns are unknown.
+    """
+    dataset = _ColumnarDataset(filenames, columns, shapes)
+    super(ColumnarDataset, self).__init__(dataset)
+
+
+class _ColumnarDataset(dataset_ops.Dataset):
+  """A `Dataset` of the row groups of columnar files."""
+
+  def __init__(self, filenames, columns, shapes):
+    """See `ColumnarDataset()` for details."""
+    super(_ColumnarDataset, self).__init__()
+    if not columns:
+      raise ValueError("At least one column must be read.")
+    shapes = shapes or {}
+    for name in shapes:
+      if name not in columns:
+        raise ValueError("Shape of unknown column %s." % name)
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+    names = sorted(columns)
+    self._columns = ops.convert_to_tensor(
+        names, dtype=dtypes.string, name="columns")
+    self._output_types = {
+        name: dtypes.as_dtype(columns[name]) for name in names
+    }
+    self._output_shapes = {
+        name: tensor_shape.vector(None).concatenate(
+            tensor_shape.as_shape(shapes[name]) if name in shapes else
+            tensor_shape.unknown_shape()) for name in names
+    }
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.columnar_dataset(
+        self._filenames,
+        self._columns,
+        output_types=nest.flatten(self.output_types),
+        output_shapes=nest.flatten(self.output_shapes))
+
+  @property
+  def output_classes(self):
+    return {name: ops.Tensor for name in self._output_types}
+
+  @property
+  def output_shapes(self):
+    return self._output_shapes
+
+  @property
+  def output_types(self):
+    return self._output_types
+
+
+class IndexedTFRecordDataset(contrib_dataset_ops.Dataset):
+  """A `Dataset` of a range of the records of indexed TFRecord files.
+
+  The files must be uncompressed, and written by a `tf.python_io.TFRecordWriter`
+  with `write_index=True`. The records of each file are split into
+  `num_shards` contiguous ranges, and the dataset reads the range at
+  `shard_index` of each file, seeking to its first record using the index
+  instead of reading the records before it.
+  """
+
+  def __init__(self,
+               filenames,
+               num_shards=1,
+               shard_index=0,
+               buffer_size=None,
+               skip_corrupted_records=False):
+    """Creates an `IndexedTFRecordDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      num_shards: (Optional.) A `tf.int64` scalar representing the number of
+        ranges that the records of each file are split into.
+      shard_index: (Optional.) A `tf.int64` scalar representing the range of
+        each file to read, in `[0, num_shards)`.
+      buffer_size: (Optional.) A `tf.int64` scalar representing the number of
+        bytes in the read buffer. 0 means no buffering.
+      skip_corrupted_records: (Optional.) A boolean, which if true indicates
+        that corrupted records should be logged and skipped, resuming at the
+        indexed offset of the next record. Otherwise, a corrupted record
+        raises a `tf.errors.DataLossError`.
+    """
+    dataset = _IndexedTFRecordDataset(filenames, num_shards, shard_index,
+                                      buffer_size, skip_corrupted_records)
+    super(IndexedTFRecordDataset, self).__init__(dataset)
+
+
+class _IndexedTFRecordDataset(dataset_ops.Dataset):
+  """A `Dataset` of a range of the records of indexed TFRecord files."""
+
+  def __init__(self, filenames, num_shards, shard_index, buffer_size,
+               skip_corrupted_records):
+    """See `IndexedTFRecordDataset()` for details."""
+    super(_IndexedTFRecordDataset, self).__init__()
+    self._filenames = ops.convert_to_tensor(
+        filenames, dtype=dtypes.string, name="filenames")
+    self._num_shards = ops.convert_to_tensor(
+        num_shards, dtype=dtypes.int64, name="num_shards")
+    self._shard_index = ops.convert_to_tensor(
+        shard_index, dtype=dtypes.int64, name="shard_index")
+    self._buffer_size = _convert_optional_param_to_tensor(
+        "buffer_size", buffer_size, 256 * 1024)
+    self._skip_corrupted_records = skip_corrupted_records
+
+  def _as_variant_tensor(self):
+    return gen_dataset_ops.indexed_tf_record_dataset(
+        self._filenames,
+        self._num_shards,
+        self._shard_index,
+        self._buffer_size,
+        skip_corrupted_records=self._skip_corrupted_records)
+
+  @property
+  def output_classes(self):
+    return ops.Tensor
+
+  @property
+  def output_shapes(self):
+    return tensor_shape.scalar()
+
+  @property
+  def output_types(self):
+    return dtypes.string
+
+
+def _convert_optional_param_to_tensor(argument_name, argument_value,
+                                      argument_default):
+  if argument_value is not None:
+    return ops.convert_to_tensor(
+        argument_value, dtype=dtypes.int64, name=argument_name)
+  else:
+    return constant_op.constant(
+        argument_default, dtype=dtypes.int64, name=argument_name)
+
+
 def read_batch_features(file_pattern,
                         batch_size,
                         features,
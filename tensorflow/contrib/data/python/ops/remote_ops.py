@@ -0,0 +1,132 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Datasets that run on remote workers."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.util import nest
+from tensorflow.python.data.util import sparse
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import function
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_dataset_ops
+
+
+class RemoteDataset(dataset_ops.Dataset):
+  """A `Dataset` whose elements are produced by datasets on remote workers.
+
+  Use it to move input preprocessing, e.g. image decoding and augmentation,
+  from the hosts of the accelerators to a pool of CPU-only TensorFlow servers
+  of the same cluster. `dataset_fn(i)` builds the dataset that `workers[i]`
+  runs: it is serialized into a `GraphDef` when the `RemoteDataset` is
+  created, sent to the worker by the first call for its elements, and run
+  there by an iterator that lives as long as the iterator of the
+  `RemoteDataset`.
+
+  The elements are transferred by function calls over the worker service of
+  the cluster. Up to `buffer_size` calls are in flight on each worker, and
+  each call goes to the worker with the fewest calls in flight, so that a
+  slower worker produces fewer elements instead of stalling the consumer.
+  Since every call carries one element, `dataset_fn` should batch its
+  elements. For example:
+
+  ```python
+  workers = ["/job:data/task:%d/cpu:0" % i for i in range(4)]
+
+  def dataset_fn(worker_index):
+    filenames = tf.data.Dataset.list_files(pattern).shard(
+        len(workers), worker_index)
+    dataset = tf.data.TFRecordDataset(filenames).map(decode_and_augment)
+    return dataset.batch(32).repeat()
+
+  dataset = tf.contrib.data.RemoteDataset(dataset_fn, workers)
+  images, labels = dataset.make_one_shot_iterator().get_next()
+  ```
+
+  The datasets must be serializable as for checkpointing iterators, so their
+  functions must be stateless. The elements are produced in the order they
+  arrive from the workers, and the `RemoteDataset` ends once the datasets of
+  all the workers have ended.
+  """
+
+  def __init__(self, dataset_fn, workers, buffer_size=2):
+    """Creates a `RemoteDataset`.
+
+    Args:
+      dataset_fn: A function that takes the index of a worker and returns the
+        `tf.data.Dataset` to run on that worker. The datasets of all the
+        workers must have the same types, and shapes that are compatible with
+        those of the dataset of worker 0.
+      workers: A list of the names of the CPU devices to run the datasets on.
+      buffer_size: (Optional.) The number of elements that can be in flight
+        from each worker. Defaults to 2.
+
+    Raises:
+      ValueError: If `workers` is empty or the datasets do not have the same
+        types.
+    """
+    super(RemoteDataset, self).__init__()
+    self._workers = list(workers)
+    if not self._workers:
+      raise ValueError("`workers` must not be empty.")
+    self._datasets = [dataset_fn(i) for i in range(len(self._workers))]
+    first = self._datasets[0]
+    for i, dataset in enumerate(self._datasets[1:]):
+      if (dataset.output_types != first.output_types or
+          dataset.output_classes != first.output_classes):
+        raise ValueError(
+            "The dataset of worker %d has different types than the dataset "
+            "of worker 0: %s vs. %s." %
+            (i + 1, dataset.output_types, first.output_types))
+    self._buffer_size = ops.convert_to_tensor(
+        buffer_size, dtype=dtypes.int64, name="buffer_size")
+
+  def _as_variant_tensor(self):
+    flat_types = nest.flatten(
+        sparse.as_dense_types(self.output_types, self.output_classes))
+    flat_shapes = nest.flatten(
+        sparse.as_dense_shapes(self.output_shapes, self.output_classes))
+
+    @function.Defun(dtypes.string, dtypes.string)
+    def _get_next(graph, iterator_id):
+      return gen_dataset_ops.dataset_service_get_next(
+          graph, iterator_id, output_types=flat_types,
+          output_shapes=flat_shapes)
+
+    graph_defs = [
+        gen_dataset_ops.dataset_to_graph(dataset._as_variant_tensor())  # pylint: disable=protected-access
+        for dataset in self._datasets
+    ]
+    return gen_dataset_ops.remote_dataset(
+        graph_defs,
+        self._workers,
+        self._buffer_size,
+        f=_get_next,
+        output_types=flat_types,
+        output_shapes=flat_shapes)
+
+  @property
+  def output_classes(self):
+    return self._datasets[0].output_classes
+
+  @property
+  def output_shapes(self):
+    return self._datasets[0].output_shapes
+
+  @property
+  def output_types(self):
+    return self._datasets[0].output_types
@@ -34,6 +34,7 @@
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -56,6 +57,11 @@ const int64 kDefaultL3CachePerCpu = 1 << 20;
 const int64 kNearestNeighborsCentersMaxBlockSize = 1024;
 const int64 kNearestNeighborsPointsMinBlockSize = 16;
 
+// The number of points whose distances to a sampled point are updated in one
+// unit of work of KmeansPlusPlusInitializationOp. The potential is summed per
+// unit in a fixed order, so it does not depend on the number of threads.
+const int64 kKmeansPlusPlusPointsPerUnit = 4096;
+
 // Returns the smallest multiple of a that is not smaller than b.
 int64 NextMultiple(int64 a, int64 b) {
   const int64 remainder = b % a;
@@ -146,6 +152,38 @@ class KmeansPlusPlusInitializationOp : public OpKernel {
     min_distances.fill(std::numeric_limits<float>::infinity());
     Eigen::VectorXf min_distances_cumsum(num_points);
 
+    // Sets new_min_distances to the minimum of min_distances and the distances
+    // to the point at sampled_index, sharded over the points, and returns the
+    // sum of new_min_distances. new_min_distances may be &min_distances.
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64 num_units =
+        CeilOfRatio(num_points, kKmeansPlusPlusPointsPerUnit);
+    std::vector<float> unit_potentials(num_units);
+    auto update_min_distances = [&](int64 sampled_index,
+                                    Eigen::VectorXf* new_min_distances) {
+      auto work = [&](int64 start, int64 limit) {
+        for (; start < limit; ++start) {
+          const int64 start_row = start * kKmeansPlusPlusPointsPerUnit;
+          const int64 num_rows = std::min(kKmeansPlusPlusPointsPerUnit,
+                                          num_points - start_row);
+          auto new_min_distances_shard =
+              new_min_distances->segment(start_row, num_rows);
+          new_min_distances_shard =
+              min_distances.segment(start_row, num_rows)
+                  .cwiseMin(GetHalfSquaredDistancesToY(
+                      points.middleRows(start_row, num_rows),
+                      points_half_squared_norm.segment(start_row, num_rows),
+                      points.row(sampled_index),
+                      points_half_squared_norm(sampled_index)));
+          unit_potentials[start] = new_min_distances_shard.sum();
+        }
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, num_units,
+            kKmeansPlusPlusPointsPerUnit * (2 * point_dimensions + 3), work);
+      return std::accumulate(unit_potentials.begin(), unit_potentials.end(),
+                             0.0f);
+    };
+
     auto draw_one_sample = [&]() -> int64 {
       if (sampled_indices.empty()) return rng.Uniform64(num_points);
       int64 index = 0;
@@ -164,23 +202,19 @@ class KmeansPlusPlusInitializationOp : public OpKernel {
 
     auto sample_one_point = [&]() {
       const int64 sampled_index = draw_one_sample();
-      min_distances = min_distances.cwiseMin(GetHalfSquaredDistancesToY(
-          points, points_half_squared_norm, points.row(sampled_index),
-          points_half_squared_norm(sampled_index)));
+      update_min_distances(sampled_index, &min_distances);
       return sampled_index;
     };
 
+    Eigen::VectorXf best_new_min_distances(num_points);
+    Eigen::VectorXf new_min_distances(num_points);
     auto sample_one_point_with_retries = [&]() {
-      Eigen::VectorXf best_new_min_distances(num_points);
       float best_potential = std::numeric_limits<float>::infinity();
       int64 best_sampled_index = 0;
       for (int i = 1 + num_retries_per_sample; i > 0; --i) {
         const int64 sampled_index = draw_one_sample();
-        Eigen::VectorXf new_min_distances =
-            min_distances.cwiseMin(GetHalfSquaredDistancesToY(
-                points, points_half_squared_norm, points.row(sampled_index),
-                points_half_squared_norm(sampled_index)));
-        const float potential = new_min_distances.sum();
+        const float potential =
+            update_min_distances(sampled_index, &new_min_distances);
         if (potential < best_potential) {
           best_potential = potential;
           best_sampled_index = sampled_index;
@@ -208,7 +242,6 @@ class KmeansPlusPlusInitializationOp : public OpKernel {
   // Returns a column vector with the i-th element set to half the squared
   // euclidean distance between the i-th row of xs, and y. Precomputed norms for
   // each row of xs and y must be provided for efficiency.
-  // TODO(ands): Parallelize this for large xs.
   static Eigen::VectorXf GetHalfSquaredDistancesToY(
       const Eigen::Ref<const MatrixXfRowMajor>& xs,
       const Eigen::Ref<const Eigen::VectorXf>& xs_half_squared_norm,
@@ -14,24 +14,20 @@
 // ==============================================================================
 
 // TensorFlow kernels and Ops for constructing WALS normal equations.
-// TODO(agarwal,rmlarsen): Add security checks to the code.
 
 #include <algorithm>
+#include <functional>
 #include <numeric>
 #include <vector>
 
-// This is only used for std::this_thread::get_id()
-#include <thread>  // NOLINT
-
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
-#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
-#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 using tensorflow::DEVICE_CPU;
 using tensorflow::DT_BOOL;
@@ -40,6 +36,7 @@ using tensorflow::DT_INT64;
 using tensorflow::OpKernel;
 using tensorflow::OpKernelConstruction;
 using tensorflow::OpKernelContext;
+using tensorflow::Status;
 using tensorflow::Tensor;
 using tensorflow::TensorShape;
 using tensorflow::TensorShapeUtils;
@@ -58,6 +55,151 @@ typedef Eigen::Map<
     const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor>>
     ConstEigenMatrixFloatMap;
 
+typedef Eigen::Map<Eigen::VectorXf> EigenVectorFloatMap;
+
+namespace {
+
+// Validates the inputs shared by the WALS ops: factors, factor_weights,
+// unobserved_weights, input_weights, input_indices, input_values,
+// input_block_size and input_is_transpose.
+Status ValidateWALSInputs(OpKernelContext* context) {
+  const Tensor& factors = context->input(0);
+  const Tensor& factor_weights = context->input(1);
+  const Tensor& unobserved_weights = context->input(2);
+  const Tensor& input_weights = context->input(3);
+  const Tensor& input_indices = context->input(4);
+  const Tensor& input_values = context->input(5);
+  const Tensor& input_block_size = context->input(6);
+  const Tensor& input_is_transpose = context->input(7);
+
+  if (!TensorShapeUtils::IsMatrix(factors.shape())) {
+    return InvalidArgument("Input factors should be a matrix.");
+  }
+  if (!TensorShapeUtils::IsVector(factor_weights.shape())) {
+    return InvalidArgument("Input factor_weights should be a vector.");
+  }
+  if (!TensorShapeUtils::IsScalar(unobserved_weights.shape())) {
+    return InvalidArgument("Input unobserved_weights should be a scalar.");
+  }
+  if (!TensorShapeUtils::IsVector(input_weights.shape())) {
+    return InvalidArgument("Input input_weights should be a vector.");
+  }
+  if (!TensorShapeUtils::IsMatrix(input_indices.shape())) {
+    return InvalidArgument("Input input_indices should be a matrix.");
+  }
+  if (!TensorShapeUtils::IsVector(input_values.shape())) {
+    return InvalidArgument("Input input_values should be a vector");
+  }
+  if (!TensorShapeUtils::IsScalar(input_block_size.shape())) {
+    return InvalidArgument("Input input_block_size should be a scalar.");
+  }
+  if (!TensorShapeUtils::IsScalar(input_is_transpose.shape())) {
+    return InvalidArgument("Input input_is_transpose should be a scalar.");
+  }
+  const int64 num_nonzero_elements = input_indices.dim_size(0);
+  if (input_indices.dim_size(1) != 2 ||
+      input_values.dim_size(0) != num_nonzero_elements) {
+    return InvalidArgument(
+        "Input input_indices should be a num_values x 2 matrix, got ",
+        input_indices.shape().DebugString(), " for ",
+        input_values.dim_size(0), " values.");
+  }
+
+  // The kernels write the rows they solve for by input index, so the
+  // indices must be in range.
+  const int64 block_size = input_block_size.scalar<int64>()();
+  const int64 factors_size = factors.dim_size(0);
+  if (input_weights.dim_size(0) < block_size ||
+      factor_weights.dim_size(0) < factors_size) {
+    return InvalidArgument("Inputs input_weights and factor_weights should "
+                           "have a weight per input and factor row.");
+  }
+  const bool is_transpose = input_is_transpose.scalar<bool>()();
+  const auto& indices = input_indices.matrix<int64>();
+  for (int64 i = 0; i < num_nonzero_elements; ++i) {
+    const int64 input_index = indices(i, is_transpose ? 1 : 0);
+    const int64 factor_index = indices(i, is_transpose ? 0 : 1);
+    if (input_index < 0 || input_index >= block_size || factor_index < 0 ||
+        factor_index >= factors_size) {
+      return InvalidArgument("Input index (", indices(i, 0), ", ",
+                             indices(i, 1), ") is out of range for ",
+                             block_size, " inputs and ", factors_size,
+                             " factors.");
+    }
+  }
+  return Status::OK();
+}
+
+// The non-zero entries of the sparse input grouped by input index. The
+// entries of a group are accumulated into the normal equations of one input
+// row, so the groups can be processed in parallel without locking.
+class WALSInputGroups {
+ public:
+  explicit WALSInputGroups(OpKernelContext* context)
+      : indices_mat_(context->input(4).matrix<int64>().data(), 2,
+                     context->input(4).dim_size(0)),
+        is_transpose_(context->input(7).scalar<bool>()()),
+        perm_(context->input(4).dim_size(0)) {
+    const int64 num_nonzero_elements = perm_.size();
+    // TODO(rmlarsen): In principle, we should be using the SparseTensor class
+    // and machinery for iterating over groups, but the fact that class
+    // SparseTensor makes a complete copy of the matrix makes me reluctant to
+    // use it.
+    std::iota(perm_.begin(), perm_.end(), 0);
+    // Compute a permutation such that input_index(perm_[i]) is sorted, use
+    // stable_sort to preserve spatial locality.
+    std::stable_sort(perm_.begin(), perm_.end(), [this](int64 i, int64 j) {
+      return input_index(i) < input_index(j);
+    });
+
+    // Compute the start and end of runs with identical input_index.
+    int64 start = 0;
+    int64 end = 0;
+    while (end < num_nonzero_elements) {
+      start = end;
+      while (end < num_nonzero_elements &&
+             input_index(perm_[start]) == input_index(perm_[end])) {
+        ++end;
+      }
+      groups_.emplace_back(start, end);
+    }
+  }
+
+  int64 input_index(int64 i) const {
+    return is_transpose_ ? indices_mat_(1, i) : indices_mat_(0, i);
+  }
+  int64 factor_index(int64 i) const {
+    return is_transpose_ ? indices_mat_(0, i) : indices_mat_(1, i);
+  }
+
+  // The entries of group g are perm()[groups()[g].first] up to
+  // perm()[groups()[g].second].
+  const std::vector<int64>& perm() const { return perm_; }
+  const std::vector<std::pair<int64, int64>>& groups() const {
+    return groups_;
+  }
+
+  // Runs work(begin, end) over ranges of groups on the intra-op threads,
+  // given the cost of a group per non-zero entry and the cost per group.
+  void ParallelFor(OpKernelContext* context, int64 cost_per_entry,
+                   int64 cost_per_group,
+                   const std::function<void(int64, int64)>& work) const {
+    if (groups_.empty()) return;
+    const int64 entries_per_group = perm_.size() / groups_.size() + 1;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, groups_.size(),
+          entries_per_group * cost_per_entry + cost_per_group, work);
+  }
+
+ private:
+  ConstEigenMatrixInt64Map indices_mat_;
+  const bool is_transpose_;
+  std::vector<int64> perm_;
+  std::vector<std::pair<int64, int64>> groups_;
+};
+
+}  // namespace
+
 class WALSComputePartialLhsAndRhsOp : public OpKernel {
  public:
   explicit WALSComputePartialLhsAndRhsOp(OpKernelConstruction* context)
@@ -69,37 +211,16 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
   }
 
   void Compute(OpKernelContext* context) override {
+    OP_REQUIRES_OK(context, ValidateWALSInputs(context));
     const Tensor& factors = context->input(0);
     const Tensor& factor_weights = context->input(1);
     const Tensor& unobserved_weights = context->input(2);
     const Tensor& input_weights = context->input(3);
-    const Tensor& input_indices = context->input(4);
     const Tensor& input_values = context->input(5);
     const Tensor& input_block_size = context->input(6);
-    const Tensor& input_is_transpose = context->input(7);
-
-    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(factors.shape()),
-                InvalidArgument("Input factors should be a matrix."));
-    OP_REQUIRES(context, TensorShapeUtils::IsVector(factor_weights.shape()),
-                InvalidArgument("Input factor_weights should be a vector."));
-    OP_REQUIRES(
-        context, TensorShapeUtils::IsScalar(unobserved_weights.shape()),
-        InvalidArgument("Input unobserved_weights should be a scalar."));
-    OP_REQUIRES(context, TensorShapeUtils::IsVector(input_weights.shape()),
-                InvalidArgument("Input input_weights should be a vector."));
-    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(input_indices.shape()),
-                InvalidArgument("Input input_indices should be a matrix."));
-    OP_REQUIRES(context, TensorShapeUtils::IsVector(input_values.shape()),
-                InvalidArgument("Input input_values should be a vector"));
-    OP_REQUIRES(context, TensorShapeUtils::IsScalar(input_block_size.shape()),
-                InvalidArgument("Input input_block_size should be a scalar."));
-    OP_REQUIRES(
-        context, TensorShapeUtils::IsScalar(input_is_transpose.shape()),
-        InvalidArgument("Input input_is_transpose should be a scalar."));
 
     const int64 factor_dim = factors.dim_size(1);
     const int64 factors_size = factors.dim_size(0);
-    const int64 num_nonzero_elements = input_indices.dim_size(0);
     const int64 block_size = input_block_size.scalar<int64>()();
     const auto& factor_weights_vec = factor_weights.vec<float>();
     const auto& input_weights_vec = input_weights.vec<float>();
@@ -108,8 +229,6 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
 
     ConstEigenMatrixFloatMap factors_mat(factors.matrix<float>().data(),
                                          factor_dim, factors_size);
-    ConstEigenMatrixInt64Map indices_mat(input_indices.matrix<int64>().data(),
-                                         2, num_nonzero_elements);
 
     Tensor* output_lhs_tensor;
     OP_REQUIRES_OK(context,
@@ -125,142 +244,180 @@ class WALSComputePartialLhsAndRhsOp : public OpKernel {
     EigenMatrixFloatMap rhs_mat(output_rhs_tensor->matrix<float>().data(),
                                 factor_dim, block_size);
     rhs_mat.setZero();
-    const bool is_transpose = input_is_transpose.scalar<bool>()();
-
-    auto get_input_index = [is_transpose, &indices_mat](int64 i) {
-      return is_transpose ? indices_mat(1, i) : indices_mat(0, i);
-    };
-    auto get_factor_index = [is_transpose, &indices_mat](int64 i) {
-      return is_transpose ? indices_mat(0, i) : indices_mat(1, i);
-    };
-
-    // TODO(rmlarsen): In principle, we should be using the SparseTensor class
-    // and machinery for iterating over groups, but the fact that class
-    // SparseTensor makes a complete copy of the matrix makes me reluctant to
-    // use it.
-    std::vector<int64> perm(num_nonzero_elements);
-    std::iota(perm.begin(), perm.end(), 0);
-
-    typedef std::pair<int64, int64> Shard;
-    std::vector<Shard> shards;
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
-    int64 shard_total = 0;
-    // Compute a permutation such that get_input_index(perm[i]) is sorted, use
-    // stable_sort to preserve spatial locality.
-    std::stable_sort(perm.begin(), perm.end(),
-                     [&get_input_index](int64 i, int64 j) {
-                       return get_input_index(i) < get_input_index(j);
-                     });
 
-    // Compute the start and end of runs with identical input_index.
-    // These are the shards of work that can be processed in parallel
-    // without locking.
-    int64 start = 0;
-    int64 end = 0;
-    while (end < num_nonzero_elements) {
-      start = end;
-      while (end < num_nonzero_elements &&
-             get_input_index(perm[start]) == get_input_index(perm[end])) {
-        ++end;
-      }
-      shards.emplace_back(start, end);
-      shard_total += end - start;
-    }
-    CHECK_EQ(shard_total, num_nonzero_elements);
-    CHECK_LE(shards.size(), num_nonzero_elements);
-    CHECK_GT(shards.size(), 0);
+    const WALSInputGroups input_groups(context);
+    const std::vector<int64>& perm = input_groups.perm();
 
     // Batch the rank-one updates into a rank-k update to lower memory traffic
     const int kMaxBatchSize = 128;
 
-    // Since we do not have an easy way of generating thread id's within the
-    // range [0,num_threads), we can instead call out to an std::unordered_map
-    // of matrices and initialize the matrix on the first call.
-    // However, this might have a performance penalty, as memory allocation can
-    // cause the OS kernel to enter a critical section and temporarily disable
-    // parallelism, and the unordered_map must be protected with a read/write
-    // mutex.
-    //
-    // TODO(jpoulson): Simplify after the thread rank can be queried
-    std::unordered_map<size_t, Eigen::MatrixXf> factor_batch_map;
-    mutex map_mutex;
-
-    BlockingCounter counter(shards.size());
-    // Lambda encapsulating the per-shard computation.
-    auto work = [&](const Shard& shard) {
-      const std::thread::id thread_id = std::this_thread::get_id();
-      const size_t id_hash = std::hash<std::thread::id>()(thread_id);
-      // If this thread's unique factors_mat.rows() x kMaxBatchSize
-      // batching matrix has not yet been created, then emplace it into the
-      // map using the hash of the thread id as the key.
-      //
-      // TODO(jpoulson): Switch to try_emplace once C++17 is supported
-      map_mutex.lock();
-      const auto key_count = factor_batch_map.count(id_hash);
-      map_mutex.unlock();
-      if (!key_count) {
-        map_mutex.lock();
-        factor_batch_map.emplace(
-            std::piecewise_construct, std::forward_as_tuple(id_hash),
-            std::forward_as_tuple(factors_mat.rows(), kMaxBatchSize));
-        map_mutex.unlock();
-      }
-      map_mutex.lock();
-      auto& factor_batch = factor_batch_map[id_hash];
-      map_mutex.unlock();
-
-      CHECK_GE(shard.first, 0);
-      CHECK_LE(shard.second, perm.size());
-      CHECK_LE(shard.first, shard.second);
-      const int64 input_index = get_input_index(perm[shard.first]);
-      // Accumulate the rhs and lhs terms in the normal equations
-      // for the non-zero elements in the row or column of the sparse matrix
-      // corresponding to input_index.
-      int num_batched = 0;
-      EigenMatrixFloatMap lhs_mat(output_lhs_tensor->flat<float>().data() +
-                                      input_index * factor_dim * factor_dim,
-                                  factor_dim, factor_dim);
-      auto lhs_symm = lhs_mat.selfadjointView<Eigen::Lower>();
-      for (int64 p = shard.first; p < shard.second; ++p) {
-        const int64 i = perm[p];
-        // Check that all entries in the shard have the same input index.
-        CHECK_EQ(input_index, get_input_index(i));
-        const int64 factor_index = get_factor_index(i);
-        const float input_value = input_values_vec(i);
-        const float weight =
-            input_weights_vec(input_index) * factor_weights_vec(factor_index);
-        CHECK_GE(weight, 0);
-        factor_batch.col(num_batched) =
-            factors_mat.col(factor_index) * std::sqrt(weight);
-        ++num_batched;
-        if (num_batched == kMaxBatchSize) {
-          lhs_symm.rankUpdate(factor_batch);
-          num_batched = 0;
-        }
+    // Accumulates the normal equations of the groups [begin, end). Each range
+    // of groups runs on a single thread, which owns its batching matrix.
+    auto work = [&](int64 begin, int64 end) {
+      Eigen::MatrixXf factor_batch(factor_dim, kMaxBatchSize);
+      for (int64 g = begin; g < end; ++g) {
+        const auto& group = input_groups.groups()[g];
+        const int64 input_index = input_groups.input_index(perm[group.first]);
+        // Accumulate the rhs and lhs terms in the normal equations
+        // for the non-zero elements in the row or column of the sparse matrix
+        // corresponding to input_index.
+        int num_batched = 0;
+        EigenMatrixFloatMap lhs_mat(output_lhs_tensor->flat<float>().data() +
+                                        input_index * factor_dim * factor_dim,
+                                    factor_dim, factor_dim);
+        auto lhs_symm = lhs_mat.selfadjointView<Eigen::Lower>();
+        for (int64 p = group.first; p < group.second; ++p) {
+          const int64 i = perm[p];
+          const int64 factor_index = input_groups.factor_index(i);
+          const float input_value = input_values_vec(i);
+          const float weight =
+              input_weights_vec(input_index) * factor_weights_vec(factor_index);
+          CHECK_GE(weight, 0);
+          factor_batch.col(num_batched) =
+              factors_mat.col(factor_index) * std::sqrt(weight);
+          ++num_batched;
+          if (num_batched == kMaxBatchSize) {
+            lhs_symm.rankUpdate(factor_batch);
+            num_batched = 0;
+          }
 
-        rhs_mat.col(input_index) +=
-            input_value * (w_0 + weight) * factors_mat.col(factor_index);
-      }
-      if (num_batched != 0) {
-        auto factor_block =
-            factor_batch.block(0, 0, factors_mat.rows(), num_batched);
-        lhs_symm.rankUpdate(factor_block);
+          rhs_mat.col(input_index) +=
+              input_value * (w_0 + weight) * factors_mat.col(factor_index);
+        }
+        if (num_batched != 0) {
+          auto factor_block =
+              factor_batch.block(0, 0, factor_dim, num_batched);
+          lhs_symm.rankUpdate(factor_block);
+        }
+        // Copy lower triangular to upper triangular part of normal equation
+        // matrix.
+        lhs_mat = lhs_symm;
       }
-      // Copy lower triangular to upper triangular part of normal equation
-      // matrix.
-      lhs_mat = lhs_symm;
-      counter.DecrementCount();
     };
-    for (size_t i = 1; i < shards.size(); ++i) {
-      worker_threads.workers->Schedule(std::bind(work, shards[i]));
-    }
-    // Inline execute the 1st shard.
-    work(shards[0]);
-    counter.Wait();
+    input_groups.ParallelFor(context, factor_dim * factor_dim, 0, work);
   }
 };
 
 REGISTER_KERNEL_BUILDER(Name("WALSComputePartialLhsAndRhs").Device(DEVICE_CPU),
                         WALSComputePartialLhsAndRhsOp);
 
+// Solves the normal equations of each input row with a few steps of the
+// conjugate gradient method. The system of row i is
+//   (lhs + sum_j weight_ij * f_j * f_j^T) x_i = rhs_i
+// where j runs over the non-zero entries of row i, and is applied as
+// lhs * x + F_i * (F_i^T * x) with the scaled factors F_i of the row, so the
+// k x k matrix of the row is never formed.
+class WALSSolveConjugateGradientOp : public OpKernel {
+ public:
+  explicit WALSSolveConjugateGradientOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->MatchSignature(
+                                {DT_FLOAT, DT_FLOAT, DT_FLOAT, DT_FLOAT,
+                                 DT_INT64, DT_FLOAT, DT_INT64, DT_BOOL,
+                                 DT_FLOAT},
+                                {DT_FLOAT}));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("num_iterations", &num_iterations_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    OP_REQUIRES_OK(context, ValidateWALSInputs(context));
+    const Tensor& factors = context->input(0);
+    const Tensor& factor_weights = context->input(1);
+    const Tensor& unobserved_weights = context->input(2);
+    const Tensor& input_weights = context->input(3);
+    const Tensor& input_values = context->input(5);
+    const Tensor& input_block_size = context->input(6);
+    const Tensor& lhs = context->input(8);
+
+    const int64 factor_dim = factors.dim_size(1);
+    const int64 factors_size = factors.dim_size(0);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsSquareMatrix(lhs.shape()) &&
+                    lhs.dim_size(0) == factor_dim,
+                InvalidArgument("Input lhs should be a ", factor_dim, " x ",
+                                factor_dim, " matrix, got ",
+                                lhs.shape().DebugString()));
+    const int64 block_size = input_block_size.scalar<int64>()();
+    const auto& factor_weights_vec = factor_weights.vec<float>();
+    const auto& input_weights_vec = input_weights.vec<float>();
+    const float w_0 = unobserved_weights.scalar<float>()();
+    const auto& input_values_vec = input_values.vec<float>();
+
+    ConstEigenMatrixFloatMap factors_mat(factors.matrix<float>().data(),
+                                         factor_dim, factors_size);
+    ConstEigenMatrixFloatMap lhs_mat(lhs.matrix<float>().data(), factor_dim,
+                                     factor_dim);
+
+    Tensor* output_tensor;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({block_size, factor_dim}),
+                                &output_tensor));
+    EigenMatrixFloatMap solution_mat(output_tensor->matrix<float>().data(),
+                                     factor_dim, block_size);
+    // Rows without entries solve lhs * x = 0.
+    solution_mat.setZero();
+
+    const WALSInputGroups input_groups(context);
+    const std::vector<int64>& perm = input_groups.perm();
+    const int num_iterations = num_iterations_;
+
+    auto work = [&](int64 begin, int64 end) {
+      Eigen::MatrixXf row_factors(factor_dim, 0);
+      Eigen::VectorXf r(factor_dim);
+      Eigen::VectorXf p(factor_dim);
+      Eigen::VectorXf ap(factor_dim);
+      Eigen::VectorXf fp;
+      for (int64 g = begin; g < end; ++g) {
+        const auto& group = input_groups.groups()[g];
+        const int64 input_index = input_groups.input_index(perm[group.first]);
+        const int64 num_entries = group.second - group.first;
+        if (row_factors.cols() < num_entries) {
+          row_factors.resize(factor_dim, num_entries);
+        }
+        r.setZero();
+        for (int64 e = 0; e < num_entries; ++e) {
+          const int64 i = perm[group.first + e];
+          const int64 factor_index = input_groups.factor_index(i);
+          const float weight =
+              input_weights_vec(input_index) * factor_weights_vec(factor_index);
+          CHECK_GE(weight, 0);
+          row_factors.col(e) =
+              factors_mat.col(factor_index) * std::sqrt(weight);
+          r += input_values_vec(i) * (w_0 + weight) *
+               factors_mat.col(factor_index);
+        }
+        auto f = row_factors.leftCols(num_entries);
+
+        // Starting from x = 0, the residual is the rhs.
+        EigenVectorFloatMap x(solution_mat.col(input_index).data(),
+                              factor_dim);
+        p = r;
+        float r_norm = r.squaredNorm();
+        for (int it = 0; it < num_iterations && r_norm > 0; ++it) {
+          fp.noalias() = f.transpose() * p;
+          ap.noalias() = lhs_mat * p;
+          ap.noalias() += f * fp;
+          const float p_ap = p.dot(ap);
+          if (!(p_ap > 0)) break;
+          const float alpha = r_norm / p_ap;
+          x += alpha * p;
+          r -= alpha * ap;
+          const float new_r_norm = r.squaredNorm();
+          p = r + (new_r_norm / r_norm) * p;
+          r_norm = new_r_norm;
+        }
+      }
+    };
+    input_groups.ParallelFor(context, 2 * num_iterations * factor_dim,
+                             num_iterations * factor_dim * factor_dim, work);
+  }
+
+ private:
+  int num_iterations_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("WALSSolveConjugateGradient").Device(DEVICE_CPU),
+                        WALSSolveConjugateGradientOp);
+
 }  // namespace tensorflow
@@ -45,6 +45,42 @@ partial_lhs: 3-D tensor with size input_block_size x k x k.
 partial_rhs: Matrix with size input_block_size x k.
 )");
 
+REGISTER_OP("WALSSolveConjugateGradient")
+    .Input("factors: float32")
+    .Input("factor_weights: float32")
+    .Input("unobserved_weights: float32")
+    .Input("input_weights: float32")
+    .Input("input_indices: int64")
+    .Input("input_values: float32")
+    .Input("input_block_size: int64")
+    .Input("input_is_transpose: bool")
+    .Input("lhs: float32")
+    .Output("solution: float32")
+    .Attr("num_iterations: int >= 1")
+    .SetShapeFn(shape_inference::UnknownShape)
+    .Doc(R"(
+Solves the WALS normal equations with the conjugate gradient method.
+
+Solves lhs + partial_lhs[i] times solution[i] equals partial_rhs[i] for every
+input row i, where partial_lhs and partial_rhs are the outputs of
+WALSComputePartialLhsAndRhs for the same inputs, without forming partial_lhs.
+The iterations start from zero and run for at most num_iterations steps, which
+is exact up to rounding with k steps.
+
+factors: Matrix of size m * k.
+factor_weights: Vector of size m. Corresponds to column weights
+unobserved_weights: Scalar. Weight for unobserved input entries.
+input_weights: Vector of size n. Corresponds to row weights.
+input_indices: Indices for the input SparseTensor.
+input_values: Values for the input SparseTensor.
+input_block_size: Scalar. Number of rows spanned by input.
+input_is_transpose: If true, logically transposes the input for processing.
+lhs: Matrix of size k * k, the part of the left-hand sides shared by all rows.
+  It has to be symmetric positive definite.
+solution: Matrix with size input_block_size x k.
+num_iterations: The maximum number of conjugate gradient steps per row.
+)");
+
 REGISTER_OP("MaskedMatmul")
     .Input("a: float32")
     .Input("b: float32")
@@ -78,6 +78,29 @@ class WalsSolverOpsTest(test.TestCase):
                                               [0.160400, 0.220000, 0.279600],
                                               [0.492800, 0.563200, 0.633600]])
 
+  def testWalsSolveConjugateGradient(self):
+    sparse_block = SparseBlock3x3()
+    lhs = np.array([[0.2, 0.01, 0.0], [0.01, 0.3, 0.02],
+                    [0.0, 0.02, 0.4]]).astype(np.float32)
+    with self.test_session():
+      [partial_lhs,
+       partial_rhs] = gen_factorization_ops.wals_compute_partial_lhs_and_rhs(
+           self._column_factors, self._column_weights, self._unobserved_weights,
+           self._row_weights, sparse_block.indices, sparse_block.values,
+           sparse_block.dense_shape[0], False)
+      solution = gen_factorization_ops.wals_solve_conjugate_gradient(
+          self._column_factors, self._column_weights, self._unobserved_weights,
+          self._row_weights, sparse_block.indices, sparse_block.values,
+          sparse_block.dense_shape[0], False, lhs, num_iterations=3)
+      partial_lhs, partial_rhs, solution = (
+          partial_lhs.eval(), partial_rhs.eval(), solution.eval())
+      for i in range(4):
+        self.assertAllClose(
+            solution[i],
+            np.linalg.solve(lhs + partial_lhs[i], partial_rhs[i]),
+            rtol=1e-4,
+            atol=1e-5)
+
 
 if __name__ == "__main__":
   test.main()
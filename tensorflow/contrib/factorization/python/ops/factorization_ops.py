@@ -196,7 +196,8 @@ class WALSModel(object):
                row_weights=1,
                col_weights=1,
                use_factors_weights_cache=True,
-               use_gramian_cache=True):
+               use_gramian_cache=True,
+               num_cg_iterations=None):
     """Creates model for WALS matrix factorization.
 
     Args:
@@ -238,6 +239,12 @@ class WALSModel(object):
         weights cache to take effect.
       use_gramian_cache: When True, the Gramians will be cached on the workers
         before the updates start. Defaults to True.
+      num_cg_iterations: If set, the weighted updates solve the normal
+        equations with at most this many conjugate gradient steps from zero
+        instead of forming and factorizing a n_components x n_components
+        system per row, which is cheaper for large n_components. With
+        n_components steps the solution is exact up to rounding. If None, the
+        systems are solved with a Cholesky factorization.
     """
     self._input_rows = input_rows
     self._input_cols = input_cols
@@ -256,6 +263,7 @@ class WALSModel(object):
         col_weights, self._input_cols, self._num_col_shards, "col_weights")
     self._use_factors_weights_cache = use_factors_weights_cache
     self._use_gramian_cache = use_gramian_cache
+    self._num_cg_iterations = num_cg_iterations
     self._row_factors = self._create_factors(
         self._input_rows, self._n_components, self._num_row_shards, row_init,
         "row_factors")
@@ -910,21 +918,38 @@ class WALSModel(object):
 
       col_weights = embedding_ops.embedding_lookup(
           col_wt, gather_indices, partition_strategy="div")
-      partial_lhs, total_rhs = (
-          gen_factorization_ops.wals_compute_partial_lhs_and_rhs(
-              right,
-              col_weights,
-              self._unobserved_weight,
-              row_weights_slice,
-              new_sp_input.indices,
-              new_sp_input.values,
-              num_rows,
-              transpose_input,
-              name="wals_compute_partial_lhs_rhs"))
-      total_lhs = array_ops.expand_dims(total_lhs, 0) + partial_lhs
-      total_rhs = array_ops.expand_dims(total_rhs, -1)
-      new_left_values = array_ops.squeeze(
-          linalg_ops.matrix_solve(total_lhs, total_rhs), [2])
+      if self._num_cg_iterations is not None:
+        new_left_values = gen_factorization_ops.wals_solve_conjugate_gradient(
+            right,
+            col_weights,
+            self._unobserved_weight,
+            row_weights_slice,
+            new_sp_input.indices,
+            new_sp_input.values,
+            num_rows,
+            transpose_input,
+            total_lhs,
+            num_iterations=self._num_cg_iterations,
+            name="wals_solve_conjugate_gradient")
+      else:
+        partial_lhs, total_rhs = (
+            gen_factorization_ops.wals_compute_partial_lhs_and_rhs(
+                right,
+                col_weights,
+                self._unobserved_weight,
+                row_weights_slice,
+                new_sp_input.indices,
+                new_sp_input.values,
+                num_rows,
+                transpose_input,
+                name="wals_compute_partial_lhs_rhs"))
+        total_lhs = array_ops.expand_dims(total_lhs, 0) + partial_lhs
+        total_rhs = array_ops.expand_dims(total_rhs, -1)
+        # The systems are symmetric positive definite, and the batch of
+        # factorizations is sharded over the intra-op threads.
+        new_left_values = array_ops.squeeze(
+            linalg_ops.cholesky_solve(
+                linalg_ops.cholesky(total_lhs), total_rhs), [2])
 
     update_op_name = "row_update" if update_row_factors else "col_update"
     update_op = self.scatter_update(
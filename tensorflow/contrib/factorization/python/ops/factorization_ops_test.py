@@ -698,7 +698,9 @@ class WalsModelTest(test.TestCase):
 
   # Trains a WALS model for a low-rank matrix and make sure the product of
   # factors is close to the original input.
-  def _run_test_train_full_low_rank_wals(self, use_factors_weights_cache):
+  def _run_test_train_full_low_rank_wals(self,
+                                         use_factors_weights_cache,
+                                         num_cg_iterations=None):
     rows = 15
     cols = 11
     dims = 3
@@ -716,7 +718,8 @@ class WalsModelTest(test.TestCase):
           regularization=1e-5,
           row_weights=0,
           col_weights=[0] * cols,
-          use_factors_weights_cache=use_factors_weights_cache)
+          use_factors_weights_cache=use_factors_weights_cache,
+          num_cg_iterations=num_cg_iterations)
       self.simple_train(model, inp, 25)
       row_factor = model.row_factors[0].eval()
       col_factor = model.col_factors[0].eval()
@@ -798,6 +801,9 @@ class WalsModelTest(test.TestCase):
   def test_train_full_low_rank_wals_without_cache(self):
     self._run_test_train_full_low_rank_wals(False)
 
+  def test_train_full_low_rank_wals_conjugate_gradient(self):
+    self._run_test_train_full_low_rank_wals(True, num_cg_iterations=3)
+
   def test_train_matrix_completion_wals_with_cache(self):
     self._run_test_train_matrix_completion_wals(True)
 
@@ -504,8 +504,10 @@ void LaunchFusedConv2DBiasActivationOp<GPUDevice, T, BiasType, ScaleType>::
   };
 
   dnn::AlgorithmConfig algorithm_config;
-  if (cudnn_use_autotune && !AutoTuneConvBiasActivation::GetInstance()->Find(
-                                fused_conv_parameters, &algorithm_config)) {
+  if (cudnn_use_autotune &&
+      !AutoTuneConvBiasActivation::GetInstance()->Find(
+          fused_conv_parameters, AutoTuneCacheDeviceKey(stream),
+          &algorithm_config)) {
     std::vector<dnn::AlgorithmDesc> algorithms;
     CHECK(stream->parent()->GetConvolveAlgorithms(
         fused_conv_parameters.ShouldIncludeWinogradNonfusedAlgo<T>(),
@@ -551,8 +553,9 @@ void LaunchFusedConv2DBiasActivationOp<GPUDevice, T, BiasType, ScaleType>::
       algorithm_config.set_algorithm_no_scratch(
           best_result_no_scratch.algorithm());
     }
-    AutoTuneConvBiasActivation::GetInstance()->Insert(fused_conv_parameters,
-                                                      algorithm_config);
+    AutoTuneConvBiasActivation::GetInstance()->Insert(
+        fused_conv_parameters, AutoTuneCacheDeviceKey(stream),
+        algorithm_config);
   }
 
   CudnnScratchAllocator scratch_allocator(ConvolveScratchSize, ctx);
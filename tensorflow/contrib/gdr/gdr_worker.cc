@@ -46,7 +46,7 @@ GdrWorker::GdrWorker(WorkerEnv* worker_env,
 void GdrWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                     const RecvTensorRequest* request,
                                     ::grpc::ByteBuffer* response,
-                                    StatusCallback done) {
+                                    int64 enqueue_micros, StatusCallback done) {
   const int64 step_id = request->step_id();
   const string& key = request->rendezvous_key();
   TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
@@ -34,6 +34,7 @@ class GdrWorker : public GrpcWorker {
   virtual void GrpcRecvTensorAsync(CallOptions* opts,
                                    const RecvTensorRequest* request,
                                    ::grpc::ByteBuffer* response,
+                                   int64 enqueue_micros,
                                    StatusCallback done) override;
 
  private:
@@ -74,6 +74,17 @@ typedef struct {
   TfLiteFusedActivation activation;
 } TfLiteDepthwiseConvParams;
 
+typedef struct {
+  TfLitePadding padding;
+  int stride_width;
+  int stride_height;
+  int depth_multiplier;
+  // Applied to the output of the depthwise convolution, before the pointwise
+  // one.
+  TfLiteFusedActivation depthwise_activation;
+  TfLiteFusedActivation activation;
+} TfLiteDepthwiseSeparableConvParams;
+
 typedef struct {
   int rank;
   TfLiteFusedActivation activation;
@@ -83,7 +94,11 @@ typedef struct {
   TfLiteFusedActivation activation;
 } TfLiteRNNParams;
 
-typedef struct { TfLiteFusedActivation activation; } TfLiteFullyConnectedParams;
+typedef struct {
+  TfLiteFusedActivation activation;
+  // The weights are symmetrically quantized int8 values in a uint8 tensor.
+  bool weights_only_quantized;
+} TfLiteFullyConnectedParams;
 
 typedef enum {
   kTfLiteLshProjectionUnknown = 0,
@@ -123,6 +138,8 @@ typedef struct {
   TfLiteFusedActivation activation;
   float cell_clip;
   float proj_clip;
+  // The weights are symmetrically quantized int8 values in uint8 tensors.
+  bool weights_only_quantized;
 } TfLiteLSTMParams;
 
 typedef struct {
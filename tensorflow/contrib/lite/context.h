@@ -150,14 +150,23 @@ typedef union {
 // Memory allocation strategies. kTfLiteMmapRo is for read-only memory-mapped
 // data (or data externally allocated). kTfLiteArenaRw is arena allocated
 // data. kTfLiteDynamic is for tensors that are allocated during evaluation.
+// kTfLiteCustom is for read-write memory owned by the caller, see
+// Interpreter::SetCustomAllocationForTensor().
 typedef enum {
   kTfLiteMemNone = 0,
   kTfLiteMmapRo,
   kTfLiteArenaRw,
   kTfLiteArenaRwPersistent,
   kTfLiteDynamic,
+  kTfLiteCustom,
 } TfLiteAllocationType;
 
+// A caller-owned buffer that backs a kTfLiteCustom tensor.
+typedef struct {
+  void* data;
+  size_t bytes;
+} TfLiteCustomAllocation;
+
 // An tensor in the interpreter system which is a wrapper around a buffer of
 // data including a dimensionality (or NULL if not currently defined).
 typedef struct {
@@ -204,6 +213,11 @@ void TfLiteTensorReset(TfLiteType type, const char* name, TfLiteIntArray* dims,
 // Resize the allocated data of a (dynamic) tensor.
 void TfLiteTensorRealloc(size_t num_bytes, TfLiteTensor* tensor);
 
+// Forward declarations for the TfLiteContext functions that use them.
+struct TfLiteNode;
+struct TfLiteRegistration;
+struct TfLiteDelegate;
+
 typedef struct TfLiteContext {
   // Number of tensors in the context.
   int tensors_size;
@@ -226,15 +240,37 @@ typedef struct TfLiteContext {
   TfLiteStatus (*AddTensors)(struct TfLiteContext*, int tensors_to_add,
                              int* first_new_tensor_index);
 
+  // Get the indices of the nodes in the order they run. The array is owned
+  // by the interpreter and stays valid until the graph is modified.
+  TfLiteStatus (*GetExecutionPlan)(struct TfLiteContext* context,
+                                   TfLiteIntArray** execution_plan);
+
+  // Get a node and its registration by node index. The pointers stay valid
+  // until nodes are added to the graph.
+  TfLiteStatus (*GetNodeAndRegistration)(
+      struct TfLiteContext*, int node_index, struct TfLiteNode** node,
+      struct TfLiteRegistration** registration);
+
+  // Replace the nodes in `nodes_to_replace` with delegate kernels. The nodes
+  // are grouped into independent subgraphs, and each subgraph becomes one
+  // node that runs `registration`. Its `init` receives a TfLiteDelegateParams
+  // describing the subgraph as `buffer`. Only available from within
+  // TfLiteDelegate::Prepare().
+  TfLiteStatus (*ReplaceSubgraphsWithDelegateKernels)(
+      struct TfLiteContext*, struct TfLiteRegistration registration,
+      const TfLiteIntArray* nodes_to_replace, struct TfLiteDelegate* delegate);
+
   // TODO(ahentz): we should create a more general mechanism for this sort of
   // library-global objects.
   void* gemm_context;
+  // The thread pool shared by all kernels, see kernels/thread_pool_support.h.
+  void* thread_pool_context;
 } TfLiteContext;
 
 // A structure representing an instance of a node.
 // This structure only exhibits the inputs, outputs and user defined data, not
 // other features like the type.
-typedef struct {
+typedef struct TfLiteNode {
   // Inputs to this node expressed as indices into the simulator's tensors.
   TfLiteIntArray* inputs;
 
@@ -253,7 +289,7 @@ typedef struct {
   void* builtin_data;
 } TfLiteNode;
 
-typedef struct {
+typedef struct TfLiteRegistration {
   // Initializes the op from serialized data.
   // If a built-in op:
   //   `buffer` is the op's params data (TfLiteLSTMParams*).
@@ -276,7 +312,9 @@ typedef struct {
 
   // prepare is called when the inputs this node depends on have been resized.
   // context->ResizeTensor() can be called to request output tensors to be
-  // resized.
+  // resized. It is not called again while the types and shapes of the inputs
+  // stay the same, so it must not depend on the contents of non-constant
+  // inputs.
   //
   // Returns kTfLiteOk on success.
   TfLiteStatus (*prepare)(TfLiteContext* context, TfLiteNode* node);
@@ -292,6 +330,33 @@ typedef struct {
   int32_t builtin_code;
 } TfLiteRegistration;
 
+// A backend, such as an accelerator, that runs parts of the graph in place of
+// the builtin kernels.
+typedef struct TfLiteDelegate {
+  // Data that the delegate needs to identify itself. It is owned by the
+  // delegate and is not freed by the interpreter.
+  void* data_;
+
+  // Called by Interpreter::ModifyGraphWithDelegate(). The delegate inspects
+  // the graph with GetExecutionPlan() and GetNodeAndRegistration(), and claims
+  // the nodes it supports with ReplaceSubgraphsWithDelegateKernels(). Nodes
+  // it doesn't claim keep running on their own kernels.
+  TfLiteStatus (*Prepare)(TfLiteContext* context,
+                          struct TfLiteDelegate* delegate);
+} TfLiteDelegate;
+
+// The subgraph handed to a delegate kernel. This is passed as `buffer` to
+// the `init` of the registration given to ReplaceSubgraphsWithDelegateKernels.
+typedef struct {
+  TfLiteDelegate* delegate;
+  // The nodes the kernel runs, in execution order.
+  TfLiteIntArray* nodes_to_replace;
+  // The tensors the subgraph reads from the rest of the graph.
+  TfLiteIntArray* input_tensors;
+  // The tensors the subgraph produces for the rest of the graph.
+  TfLiteIntArray* output_tensors;
+} TfLiteDelegateParams;
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,164 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/graph_info.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace tflite {
+
+namespace {
+
+// Returns whether 'tensor_index' is a real tensor of a graph with
+// 'num_tensors' tensors, rather than an omitted optional input.
+bool IsValidTensor(int tensor_index, int num_tensors) {
+  return tensor_index != kOptionalTensor && tensor_index >= 0 &&
+         tensor_index < num_tensors;
+}
+
+void AddUnique(int value, std::vector<int>* values) {
+  if (std::find(values->begin(), values->end(), value) == values->end()) {
+    values->push_back(value);
+  }
+}
+
+}  // namespace
+
+TfLiteStatus PartitionGraphIntoIndependentSubgraphs(
+    const GraphInfo& info, const TfLiteIntArray* nodes_to_partition,
+    std::vector<Subgraph>* subgraphs) {
+  const int num_nodes = info.num_nodes();
+  const int num_tensors = info.num_tensors();
+  subgraphs->clear();
+
+  // Map the node indices to positions in the execution plan.
+  std::unordered_map<int, int> position_of_node;
+  for (int i = 0; i < num_nodes; ++i) {
+    position_of_node[info.node_index(i)] = i;
+  }
+  std::vector<Subgraph::Type> node_type(num_nodes, Subgraph::kTfNonPartition);
+  for (int i = 0; i < nodes_to_partition->size; ++i) {
+    auto it = position_of_node.find(nodes_to_partition->data[i]);
+    if (it == position_of_node.end()) return kTfLiteError;
+    node_type[it->second] = Subgraph::kTfPartition;
+  }
+
+  // Tensors that no node of the plan produces, like graph inputs and
+  // constants, are available from the start.
+  std::vector<bool> tensor_ready(num_tensors, true);
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteIntArray* outputs = info.node(i).outputs;
+    for (int j = 0; j < outputs->size; ++j) {
+      if (!IsValidTensor(outputs->data[j], num_tensors)) return kTfLiteError;
+      tensor_ready[outputs->data[j]] = false;
+    }
+  }
+
+  // Build subgraphs of alternating types. Each one takes every remaining node
+  // of its type whose inputs are ready, so it only waits for the subgraphs
+  // before it. Because the execution plan is in dependency order, a single
+  // pass over it finds all of them.
+  std::vector<int> node_subgraph(num_nodes, -1);
+  std::vector<std::vector<int>> subgraph_positions;
+  int num_remaining = num_nodes;
+  int num_empty_in_a_row = 0;
+  Subgraph::Type type = node_type.empty() ? Subgraph::kTfNonPartition
+                                          : node_type[0];
+  while (num_remaining > 0) {
+    Subgraph subgraph;
+    subgraph.type = type;
+    std::vector<int> positions;
+    for (int i = 0; i < num_nodes; ++i) {
+      if (node_subgraph[i] != -1 || node_type[i] != type) continue;
+      const TfLiteNode& node = info.node(i);
+      bool ready = true;
+      for (int j = 0; j < node.inputs->size; ++j) {
+        const int tensor_index = node.inputs->data[j];
+        if (tensor_index == kOptionalTensor) continue;
+        if (!IsValidTensor(tensor_index, num_tensors)) return kTfLiteError;
+        if (!tensor_ready[tensor_index]) {
+          ready = false;
+          break;
+        }
+      }
+      if (!ready) continue;
+      node_subgraph[i] = subgraphs->size();
+      subgraph.nodes.push_back(info.node_index(i));
+      positions.push_back(i);
+      for (int j = 0; j < node.outputs->size; ++j) {
+        tensor_ready[node.outputs->data[j]] = true;
+      }
+      --num_remaining;
+    }
+
+    if (subgraph.nodes.empty()) {
+      // Neither type can make progress, so the plan reads tensors before
+      // they are produced.
+      if (++num_empty_in_a_row == 2) return kTfLiteError;
+    } else {
+      num_empty_in_a_row = 0;
+      subgraphs->push_back(std::move(subgraph));
+      subgraph_positions.push_back(std::move(positions));
+    }
+    type = type == Subgraph::kTfPartition ? Subgraph::kTfNonPartition
+                                          : Subgraph::kTfPartition;
+  }
+
+  // Find the tensors that cross subgraph boundaries.
+  std::vector<int> tensor_producer(num_tensors, -1);
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteIntArray* outputs = info.node(i).outputs;
+    for (int j = 0; j < outputs->size; ++j) {
+      tensor_producer[outputs->data[j]] = node_subgraph[i];
+    }
+  }
+  std::vector<bool> tensor_read_elsewhere(num_tensors, false);
+  for (int index : info.outputs()) {
+    if (IsValidTensor(index, num_tensors)) tensor_read_elsewhere[index] = true;
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteIntArray* inputs = info.node(i).inputs;
+    for (int j = 0; j < inputs->size; ++j) {
+      const int tensor_index = inputs->data[j];
+      if (tensor_index == kOptionalTensor) continue;
+      if (tensor_producer[tensor_index] != node_subgraph[i]) {
+        tensor_read_elsewhere[tensor_index] = true;
+      }
+    }
+  }
+
+  for (int s = 0; s < subgraphs->size(); ++s) {
+    Subgraph& subgraph = (*subgraphs)[s];
+    for (int position : subgraph_positions[s]) {
+      const TfLiteNode& node = info.node(position);
+      for (int j = 0; j < node.inputs->size; ++j) {
+        const int tensor_index = node.inputs->data[j];
+        if (tensor_index != kOptionalTensor &&
+            tensor_producer[tensor_index] != s) {
+          AddUnique(tensor_index, &subgraph.input_tensors);
+        }
+      }
+      for (int j = 0; j < node.outputs->size; ++j) {
+        const int tensor_index = node.outputs->data[j];
+        if (tensor_read_elsewhere[tensor_index]) {
+          AddUnique(tensor_index, &subgraph.output_tensors);
+        }
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
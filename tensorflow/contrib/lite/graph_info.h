@@ -0,0 +1,81 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_GRAPH_INFO_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_GRAPH_INFO_H_
+
+#include <vector>
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+
+// Basic information about an inference graph, where execution nodes
+// are connected via tensors.
+class GraphInfo {
+ public:
+  virtual ~GraphInfo() {}
+
+  // Total number of tensors in the graph.
+  virtual int num_tensors() const = 0;
+
+  // Number of nodes in the execution plan.
+  virtual int num_nodes() const = 0;
+
+  // Returns the i-th node of the execution plan, for 0 <= i < num_nodes().
+  virtual const TfLiteNode& node(int i) const = 0;
+
+  // Returns the index of the i-th node of the execution plan, as used by
+  // Interpreter::node_and_registration().
+  virtual int node_index(int i) const = 0;
+
+  // Returns the indices of the input tensors of the graph.
+  virtual const std::vector<int>& inputs() const = 0;
+
+  // Returns the indices of the output tensors of the graph.
+  virtual const std::vector<int>& outputs() const = 0;
+};
+
+// A set of nodes that runs as one unit, together with the tensors it reads
+// from and writes to the rest of the graph.
+struct Subgraph {
+  enum Type {
+    // Nodes that stay with their own kernels.
+    kTfNonPartition,
+    // Nodes that were selected for partitioning, e.g. by a delegate.
+    kTfPartition,
+  };
+  Type type = kTfNonPartition;
+  // Node indices, in execution order.
+  std::vector<int> nodes;
+  // Tensors read by the nodes but not produced by any of them, in the order
+  // they are first read. Optional tensors are left out.
+  std::vector<int> input_tensors;
+  // Tensors produced by the nodes that are read by other subgraphs or are
+  // outputs of the graph, in the order they are produced.
+  std::vector<int> output_tensors;
+};
+
+// Splits the execution plan of 'info' into alternating kTfNonPartition and
+// kTfPartition subgraphs, where the kTfPartition ones hold exactly the nodes
+// listed in 'nodes_to_partition'. Each subgraph only depends on the ones
+// before it, so running them in order is equivalent to running the original
+// plan, and the kTfPartition subgraphs are as large as that allows.
+TfLiteStatus PartitionGraphIntoIndependentSubgraphs(
+    const GraphInfo& info, const TfLiteIntArray* nodes_to_partition,
+    std::vector<Subgraph>* subgraphs);
+
+}  // namespace tflite
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_GRAPH_INFO_H_
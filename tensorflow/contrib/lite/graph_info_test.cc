@@ -0,0 +1,201 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/graph_info.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+
+TfLiteIntArray* ConvertVector(const std::vector<int>& x) {
+  TfLiteIntArray* lite = TfLiteIntArrayCreate(x.size());
+  for (size_t i = 0; i < x.size(); i++) lite->data[i] = x[i];
+  return lite;
+}
+
+// A graph whose execution plan runs its nodes in the order they were added.
+class SimpleTestGraph : public GraphInfo {
+ public:
+  explicit SimpleTestGraph(int num_tensors) : num_tensors_(num_tensors) {}
+  ~SimpleTestGraph() override {
+    for (auto& node : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+    }
+  }
+
+  int num_tensors() const override { return num_tensors_; }
+  int num_nodes() const override { return nodes_.size(); }
+  const TfLiteNode& node(int i) const override { return nodes_[i]; }
+  int node_index(int i) const override { return i; }
+  const std::vector<int>& inputs() const override { return inputs_; }
+  const std::vector<int>& outputs() const override { return outputs_; }
+
+  void AddNode(const std::vector<int>& inputs,
+               const std::vector<int>& outputs) {
+    TfLiteNode node = {};
+    node.inputs = ConvertVector(inputs);
+    node.outputs = ConvertVector(outputs);
+    nodes_.push_back(node);
+  }
+
+  std::vector<int>* mutable_inputs() { return &inputs_; }
+  std::vector<int>* mutable_outputs() { return &outputs_; }
+
+ private:
+  int num_tensors_;
+  std::vector<TfLiteNode> nodes_;
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+};
+
+std::vector<Subgraph> Partition(const GraphInfo& graph,
+                                const std::vector<int>& nodes) {
+  TfLiteIntArray* nodes_to_partition = ConvertVector(nodes);
+  std::vector<Subgraph> subgraphs;
+  EXPECT_EQ(PartitionGraphIntoIndependentSubgraphs(graph, nodes_to_partition,
+                                                   &subgraphs),
+            kTfLiteOk);
+  TfLiteIntArrayFree(nodes_to_partition);
+  return subgraphs;
+}
+
+TEST(PartitionTest, EmptyGraph) {
+  SimpleTestGraph graph(0);
+  EXPECT_TRUE(Partition(graph, {}).empty());
+}
+
+// t0 -> n0 -> t1 -> n1 -> t2 -> n2 -> t3, with n0 and n1 claimed.
+TEST(PartitionTest, Chain) {
+  SimpleTestGraph graph(4);
+  graph.AddNode({0}, {1});
+  graph.AddNode({1}, {2});
+  graph.AddNode({2}, {3});
+  *graph.mutable_inputs() = {0};
+  *graph.mutable_outputs() = {3};
+
+  std::vector<Subgraph> subgraphs = Partition(graph, {0, 1});
+  ASSERT_EQ(subgraphs.size(), 2);
+  EXPECT_EQ(subgraphs[0].type, Subgraph::kTfPartition);
+  EXPECT_THAT(subgraphs[0].nodes, ElementsAre(0, 1));
+  EXPECT_THAT(subgraphs[0].input_tensors, ElementsAre(0));
+  EXPECT_THAT(subgraphs[0].output_tensors, ElementsAre(2));
+  EXPECT_EQ(subgraphs[1].type, Subgraph::kTfNonPartition);
+  EXPECT_THAT(subgraphs[1].nodes, ElementsAre(2));
+  EXPECT_THAT(subgraphs[1].input_tensors, ElementsAre(2));
+  EXPECT_THAT(subgraphs[1].output_tensors, ElementsAre(3));
+}
+
+TEST(PartitionTest, WholeGraph) {
+  SimpleTestGraph graph(3);
+  graph.AddNode({0}, {1});
+  graph.AddNode({1}, {2});
+  *graph.mutable_inputs() = {0};
+  *graph.mutable_outputs() = {2};
+
+  std::vector<Subgraph> subgraphs = Partition(graph, {0, 1});
+  ASSERT_EQ(subgraphs.size(), 1);
+  EXPECT_EQ(subgraphs[0].type, Subgraph::kTfPartition);
+  EXPECT_THAT(subgraphs[0].nodes, ElementsAre(0, 1));
+  EXPECT_THAT(subgraphs[0].input_tensors, ElementsAre(0));
+  EXPECT_THAT(subgraphs[0].output_tensors, ElementsAre(2));
+}
+
+// Two branches that join in n3, where n0 and n2 are claimed and n1 is not.
+//   t0 -> n0 -> t1
+//   t0 -> n1 -> t2 -> n2 -> t3
+//   t1, t3 -> n3 -> t4
+// The claimed nodes end up in different subgraphs, since n2 waits for n1.
+TEST(PartitionTest, ClaimedNodesSplitByDependency) {
+  SimpleTestGraph graph(5);
+  graph.AddNode({0}, {1});
+  graph.AddNode({0}, {2});
+  graph.AddNode({2}, {3});
+  graph.AddNode({1, 3}, {4});
+  *graph.mutable_inputs() = {0};
+  *graph.mutable_outputs() = {4};
+
+  std::vector<Subgraph> subgraphs = Partition(graph, {0, 2});
+  ASSERT_EQ(subgraphs.size(), 4);
+  EXPECT_EQ(subgraphs[0].type, Subgraph::kTfPartition);
+  EXPECT_THAT(subgraphs[0].nodes, ElementsAre(0));
+  EXPECT_THAT(subgraphs[0].output_tensors, ElementsAre(1));
+  EXPECT_EQ(subgraphs[1].type, Subgraph::kTfNonPartition);
+  EXPECT_THAT(subgraphs[1].nodes, ElementsAre(1));
+  EXPECT_EQ(subgraphs[2].type, Subgraph::kTfPartition);
+  EXPECT_THAT(subgraphs[2].nodes, ElementsAre(2));
+  EXPECT_EQ(subgraphs[3].type, Subgraph::kTfNonPartition);
+  EXPECT_THAT(subgraphs[3].nodes, ElementsAre(3));
+  EXPECT_THAT(subgraphs[3].input_tensors, ElementsAre(1, 3));
+}
+
+// A claimed node whose input comes from an unclaimed node must wait for it,
+// while claimed nodes that don't are grouped together up front.
+//   t0 -> n0 -> t1 -> n1 -> t2
+//   t0 -> n2 -> t3
+TEST(PartitionTest, ReadyNodesAreGrouped) {
+  SimpleTestGraph graph(4);
+  graph.AddNode({0}, {1});
+  graph.AddNode({1}, {2});
+  graph.AddNode({0}, {3});
+  *graph.mutable_inputs() = {0};
+  *graph.mutable_outputs() = {2, 3};
+
+  std::vector<Subgraph> subgraphs = Partition(graph, {0, 2});
+  ASSERT_EQ(subgraphs.size(), 2);
+  EXPECT_EQ(subgraphs[0].type, Subgraph::kTfPartition);
+  EXPECT_THAT(subgraphs[0].nodes, ElementsAre(0, 2));
+  EXPECT_THAT(subgraphs[0].input_tensors, ElementsAre(0));
+  EXPECT_THAT(subgraphs[0].output_tensors, ElementsAre(1, 3));
+  EXPECT_EQ(subgraphs[1].type, Subgraph::kTfNonPartition);
+  EXPECT_THAT(subgraphs[1].nodes, ElementsAre(1));
+}
+
+TEST(PartitionTest, OptionalAndConstantInputs) {
+  // t1 is a constant, and the second input of n0 is omitted.
+  SimpleTestGraph graph(3);
+  graph.AddNode({0, kOptionalTensor, 1}, {2});
+  *graph.mutable_inputs() = {0};
+  *graph.mutable_outputs() = {2};
+
+  std::vector<Subgraph> subgraphs = Partition(graph, {0});
+  ASSERT_EQ(subgraphs.size(), 1);
+  EXPECT_THAT(subgraphs[0].input_tensors, ElementsAre(0, 1));
+  EXPECT_THAT(subgraphs[0].output_tensors, ElementsAre(2));
+}
+
+TEST(PartitionTest, UnknownNode) {
+  SimpleTestGraph graph(2);
+  graph.AddNode({0}, {1});
+  TfLiteIntArray* nodes_to_partition = ConvertVector({3});
+  std::vector<Subgraph> subgraphs;
+  EXPECT_EQ(PartitionGraphIntoIndependentSubgraphs(graph, nodes_to_partition,
+                                                   &subgraphs),
+            kTfLiteError);
+  TfLiteIntArrayFree(nodes_to_partition);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,13 +14,16 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/contrib/lite/interpreter.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <cstdint>
 #include <cstring>
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/error_reporter.h"
+#include "tensorflow/contrib/lite/graph_info.h"
 #include "tensorflow/contrib/lite/kernels/gemm_support.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 #include "tensorflow/contrib/lite/nnapi_delegate.h"
 
 namespace {
@@ -38,15 +41,25 @@ namespace tflite {
 Interpreter::Interpreter(ErrorReporter* error_reporter)
     : arena_(kDefaultArenaAlignment),
       persistent_arena_(kDefaultArenaAlignment),
+      plan_cache_(nullptr, TfLiteIntArrayFree),
+      memory_planner_(new ExecutionOrderMemoryPlanner),
       error_reporter_(error_reporter ? error_reporter
                                      : DefaultErrorReporter()) {
   context_.impl_ = static_cast<void*>(this);
   context_.ResizeTensor = ResizeTensor;
   context_.ReportError = ReportError;
   context_.AddTensors = AddTensors;
+  context_.GetExecutionPlan = GetExecutionPlan;
+  context_.GetNodeAndRegistration = GetNodeAndRegistration;
+  context_.ReplaceSubgraphsWithDelegateKernels =
+      ForbiddenReplaceSubgraphsWithDelegateKernels;
   context_.tensors = nullptr;
   context_.tensors_size = 0;
   context_.gemm_context = nullptr;
+  context_.thread_pool_context = nullptr;
+  // All kernels of this interpreter share one thread pool, which lives as long
+  // as the interpreter.
+  thread_pool_support::IncrementUsageCounter(&context_);
   // Reserve some space for the tensors to avoid excessive resizing.
   tensors_.reserve(kSlotsToReserve);
   nodes_and_registration_.reserve(kSlotsToReserve);
@@ -68,6 +81,8 @@ Interpreter::~Interpreter() {
   for (int i = 0; i < context_.tensors_size; i++) {
     TfLiteTensorFree(&context_.tensors[i]);
   }
+
+  thread_pool_support::DecrementUsageCounter(&context_);
 }
 
 TfLiteStatus Interpreter::SetInputs(std::vector<int> inputs) {
@@ -128,12 +143,47 @@ TfLiteStatus Interpreter::BytesRequired(TfLiteType type, const int* dims,
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::PrepareNodeIfInputsChanged(
+    int node_index, const TfLiteRegistration& op_reg, TfLiteNode* node) {
+  // A node's Prepare() only depends on its parameters and on the types and
+  // shapes of its inputs, which are summarized here.
+  std::vector<int> inputs;
+  inputs.push_back(node->inputs->size);
+  for (int i = 0; i < node->inputs->size; ++i) {
+    const int tensor_index = node->inputs->data[i];
+    if (tensor_index == kOptionalTensor) {
+      inputs.push_back(kOptionalTensor);
+      continue;
+    }
+    const TfLiteTensor& tensor = context_.tensors[tensor_index];
+    inputs.push_back(tensor.type);
+    inputs.push_back(tensor.allocation_type);
+    const int num_dims = tensor.dims ? tensor.dims->size : 0;
+    inputs.push_back(num_dims);
+    for (int d = 0; d < num_dims; ++d) {
+      inputs.push_back(tensor.dims->data[d]);
+    }
+  }
+
+  if (node_index >= prepared_inputs_.size()) {
+    prepared_inputs_.resize(nodes_and_registration_.size());
+  }
+  std::vector<int>& prepared_inputs = prepared_inputs_[node_index];
+  if (prepared_inputs == inputs) {
+    return kTfLiteOk;
+  }
+  prepared_inputs.clear();
+  TF_LITE_ENSURE_STATUS(OpPrepare(op_reg, node));
+  prepared_inputs = std::move(inputs);
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::AllocateTensorsWhoseSizesAreKnown() {
   if (!consistent_) {
     ReportError(&context_, "AllocateTensors() called on inconsistent model.");
     return kTfLiteError;
   }
-  if (next_allocate_node_id_ == nodes_and_registration_.size() && invokable_) {
+  if (next_allocate_node_id_ == execution_plan_.size() && invokable_) {
     return kTfLiteOk;
   }
   allocs_and_refcounts_.resize(context_.tensors_size);
@@ -141,21 +191,7 @@ TfLiteStatus Interpreter::AllocateTensorsWhoseSizesAreKnown() {
   int new_next_allocate_node_id = next_allocate_node_id_;
   invokable_ = false;
 
-  // Allocate graph input nodes.
   if (next_allocate_node_id_ == 0) {
-    for (int i = 0; i < inputs_.size(); ++i) {
-      int tensor_index = inputs_[i];
-      if (tensor_index == kOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor& tensor = context_.tensors[tensor_index];
-      if (tensor.allocation_type == kTfLiteArenaRw) {
-        TF_LITE_ENSURE_OK(
-            &context_,
-            arena_.Allocate(&context_, kDefaultTensorAlignment, tensor.bytes,
-                            &allocs_and_refcounts_[tensor_index].alloc));
-      }
-    }
     // Add 1 to output tensors, so they will not get overwritten.
     for (int i = 0; i < outputs_.size(); ++i) {
       allocs_and_refcounts_[outputs_[i]].count++;
@@ -164,12 +200,14 @@ TfLiteStatus Interpreter::AllocateTensorsWhoseSizesAreKnown() {
 
   // Count references to node input tensors, and resize node-referenced tensors
   // until we encounter a node that has a dynamic output tensor.
-  for (int k = next_allocate_node_id_; k < nodes_and_registration_.size();
-       k++) {
+  for (int k = next_allocate_node_id_; k < execution_plan_.size(); k++) {
     new_next_allocate_node_id++;
-    TfLiteNode& node = nodes_and_registration_[k].first;
-    const TfLiteRegistration& registration = nodes_and_registration_[k].second;
-    if (OpPrepare(registration, &node) == kTfLiteError) {
+    const int node_index = execution_plan_[k];
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    if (PrepareNodeIfInputsChanged(node_index, registration, &node) ==
+        kTfLiteError) {
       return kTfLiteError;
     }
 
@@ -198,7 +236,7 @@ TfLiteStatus Interpreter::AllocateTensorsWhoseSizesAreKnown() {
 
   // Allocate graph persistent outputs, e.g. RNN cell states, etc.
   for (int k = next_allocate_node_id_; k < new_next_allocate_node_id; k++) {
-    TfLiteNode& node = nodes_and_registration_[k].first;
+    TfLiteNode& node = nodes_and_registration_[execution_plan_[k]].first;
 
     // Go through output tensors and allocate the persistent ones first.
     TfLiteIntArray* node_outputs = node.outputs;
@@ -214,69 +252,97 @@ TfLiteStatus Interpreter::AllocateTensorsWhoseSizesAreKnown() {
     }
   }
 
-  // Go through the graph in execution order.
-  for (int k = next_allocate_node_id_; k < new_next_allocate_node_id; k++) {
-    TfLiteNode& node = nodes_and_registration_[k].first;
+  // Compute the lifetimes of the arena tensors by going through the graph in
+  // execution order. A lifetime spans the nodes from the one that produces
+  // the tensor to the last one that reads it, and tensors whose reference
+  // count never drops to zero stay live for the rest of the graph. Tensors
+  // still live from an earlier call keep their offsets.
+  const int first_node = next_allocate_node_id_;
+  std::vector<int> planned_slot(context_.tensors_size, -1);
+  std::vector<int> placed_slot(context_.tensors_size, -1);
+  std::vector<BufferLifetime> placed;
+  std::vector<int> placed_tensors;
+  for (int i = 0; i < context_.tensors_size; ++i) {
+    const ArenaAlloc& alloc = allocs_and_refcounts_[i].alloc;
+    if (allocs_and_refcounts_[i].live) {
+      placed_slot[i] = placed.size();
+      placed.emplace_back(alloc.size, first_node,
+                          BufferLifetime::kBufferLiveForever);
+      placed.back().offset = alloc.offset;
+      placed_tensors.push_back(i);
+    }
+  }
+  std::vector<BufferLifetime> planned;
+  std::vector<int> planned_tensors;
+  auto allocate = [&](int tensor_index, int first_use, int last_use) {
+    if (context_.tensors[tensor_index].allocation_type == kTfLiteArenaRw) {
+      planned_slot[tensor_index] = planned.size();
+      planned.emplace_back(context_.tensors[tensor_index].bytes, first_use,
+                           last_use);
+      planned_tensors.push_back(tensor_index);
+    }
+  };
+  auto release = [&](int tensor_index, int last_use) {
+    allocs_and_refcounts_[tensor_index].count--;
+    if (context_.tensors[tensor_index].allocation_type == kTfLiteArenaRw &&
+        allocs_and_refcounts_[tensor_index].count == 0) {
+      if (planned_slot[tensor_index] >= 0) {
+        planned[planned_slot[tensor_index]].last_use = last_use;
+      } else if (placed_slot[tensor_index] >= 0) {
+        placed[placed_slot[tensor_index]].last_use = last_use;
+      }
+    }
+  };
 
-    // First allocate output tensors.
+  // Graph inputs are allocated before the first node.
+  if (first_node == 0) {
+    for (int i = 0; i < inputs_.size(); ++i) {
+      int tensor_index = inputs_[i];
+      if (tensor_index != kOptionalTensor) {
+        allocate(tensor_index, first_node, BufferLifetime::kBufferLiveForever);
+      }
+    }
+  }
+  for (int k = first_node; k < new_next_allocate_node_id; k++) {
+    TfLiteNode& node = nodes_and_registration_[execution_plan_[k]].first;
+
+    // Output tensors live until their last reader, while temporaries are only
+    // needed by the node itself. Both overlap with the node's inputs.
     TfLiteIntArray* node_outputs = node.outputs;
     for (int i = 0; i < node_outputs->size; ++i) {
-      int tensor_index = node_outputs->data[i];
-      TfLiteTensor& tensor = context_.tensors[tensor_index];
-      if (tensor.allocation_type == kTfLiteArenaRw) {
-        TF_LITE_ENSURE_OK(
-            &context_,
-            arena_.Allocate(&context_, kDefaultTensorAlignment, tensor.bytes,
-                            &allocs_and_refcounts_[tensor_index].alloc));
-      }
+      allocate(node_outputs->data[i], k, BufferLifetime::kBufferLiveForever);
     }
-    // Then the temporaries, in two passes. First allocate them all, them
-    // deallocate them.
     TfLiteIntArray* node_temporaries = node.temporaries;
     for (int i = 0; i < node_temporaries->size; ++i) {
-      int tensor_index = node_temporaries->data[i];
-      TfLiteTensor& tensor = context_.tensors[tensor_index];
-      if (tensor.allocation_type == kTfLiteArenaRw) {
-        TF_LITE_ENSURE_OK(
-            &context_,
-            arena_.Allocate(&context_, kDefaultTensorAlignment, tensor.bytes,
-                            &allocs_and_refcounts_[tensor_index].alloc));
-      }
-    }
-    for (int i = 0; i < node_temporaries->size; ++i) {
-      int tensor_index = node_temporaries->data[i];
-      TfLiteTensor& tensor = context_.tensors[tensor_index];
-      allocs_and_refcounts_[tensor_index].count--;
-      if (tensor.allocation_type == kTfLiteArenaRw &&
-          allocs_and_refcounts_[tensor_index].count == 0) {
-        TF_LITE_ENSURE_OK(
-            &context_,
-            arena_.Deallocate(&context_,
-                              allocs_and_refcounts_[tensor_index].alloc));
-      }
+      allocate(node_temporaries->data[i], k, k);
     }
 
-    // Then process the node's inputs.
     TfLiteIntArray* node_inputs = node.inputs;
     for (int i = 0; i < node_inputs->size; ++i) {
       int tensor_index = node_inputs->data[i];
-      if (tensor_index == kOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor& tensor = context_.tensors[tensor_index];
-
-      // Decrease reference count and deallocate if not needed anymore.
-      allocs_and_refcounts_[tensor_index].count--;
-      if (tensor.allocation_type == kTfLiteArenaRw &&
-          allocs_and_refcounts_[tensor_index].count == 0) {
-        TF_LITE_ENSURE_OK(
-            &context_,
-            arena_.Deallocate(&context_,
-                              allocs_and_refcounts_[tensor_index].alloc));
+      if (tensor_index != kOptionalTensor) {
+        release(tensor_index, k);
       }
     }
   }
 
+  TF_LITE_ENSURE_OK(&context_,
+                    memory_planner_->PlanOffsets(&context_,
+                                                 kDefaultTensorAlignment,
+                                                 placed, &planned));
+  for (int i = 0; i < planned.size(); ++i) {
+    ArenaAllocRefCount& alloc = allocs_and_refcounts_[planned_tensors[i]];
+    TF_LITE_ENSURE_OK(&context_,
+                      arena_.AllocateAt(&context_, kDefaultTensorAlignment,
+                                        planned[i].offset, planned[i].size,
+                                        &alloc.alloc));
+    alloc.live = planned[i].last_use == BufferLifetime::kBufferLiveForever;
+  }
+  for (int i = 0; i < placed.size(); ++i) {
+    allocs_and_refcounts_[placed_tensors[i]].live =
+        placed[i].last_use == BufferLifetime::kBufferLiveForever;
+  }
+
   // Resize the buffer and commit the arena.
   TF_LITE_ENSURE_OK(&context_, arena_.Commit(&context_));
   TF_LITE_ENSURE_OK(&context_, persistent_arena_.Commit(&context_));
@@ -297,6 +363,7 @@ TfLiteStatus Interpreter::AllocateTensorsWhoseSizesAreKnown() {
               &context_, allocs_and_refcounts_[i].alloc, &tensor.data.raw));
     }
   }
+  TF_LITE_ENSURE_STATUS(CheckCustomAllocations());
 
   invokable_ = true;
   next_allocate_node_id_ = new_next_allocate_node_id;
@@ -334,7 +401,8 @@ TfLiteStatus Interpreter::AddNodeWithParameters(
       &context_,
       CheckTensorIndices("node outputs", outputs.data(), outputs.size()));
 
-  if (node_index) *node_index = nodes_and_registration_.size();
+  int new_node_index = nodes_and_registration_.size();
+  if (node_index) *node_index = new_node_index;
   nodes_and_registration_.resize(nodes_and_registration_.size() + 1);
   auto& node_and_reg = nodes_and_registration_.back();
   TfLiteNode& node = node_and_reg.first;
@@ -357,6 +425,7 @@ TfLiteStatus Interpreter::AddNodeWithParameters(
   }
   node.builtin_data = builtin_data_deleter.release();
   node_and_reg.second = *registration;
+  execution_plan_.push_back(new_node_index);
   return kTfLiteOk;
 }
 
@@ -387,7 +456,7 @@ TfLiteStatus Interpreter::Invoke() {
     if (AllocateTensorsWhoseSizesAreKnown() == kTfLiteError) {
       return kTfLiteError;
     }
-    if (next_allocate_node_id_ == nodes_and_registration_.size()) {
+    if (next_allocate_node_id_ == execution_plan_.size()) {
       TF_LITE_ENSURE_OK(&context_, nnapi_delegate_->Invoke(this));
       return kTfLiteOk;
     } else {
@@ -400,7 +469,7 @@ TfLiteStatus Interpreter::Invoke() {
     }
   }
 
-  for (int i = 0; i < nodes_and_registration_.size(); i++) {
+  for (int i = 0; i < execution_plan_.size(); i++) {
     // Ensure we have allocated up to this node. The point of this is to
     // allocate as much as possible before running any evaluation, but
     // dynamic shapes can prevent this from being possible.
@@ -409,11 +478,15 @@ TfLiteStatus Interpreter::Invoke() {
         return kTfLiteError;
       }
     }
-    TfLiteNode& node = nodes_and_registration_[i].first;
-    const TfLiteRegistration& registration = nodes_and_registration_[i].second;
+    const int node_index = execution_plan_[i];
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    if (profiler_) profiler_->BeginNode(node_index, node, registration);
     if (OpInvoke(registration, &node) == kTfLiteError) {
       status = kTfLiteError;
     }
+    if (profiler_) profiler_->EndNode(node_index, node, registration);
   }
   return status;
 }
@@ -465,6 +538,180 @@ TfLiteStatus Interpreter::AddTensors(TfLiteContext* context, int tensors_to_add,
       ->AddTensors(tensors_to_add, first_new_tensor_index);
 }
 
+TfLiteStatus Interpreter::GetExecutionPlan(TfLiteIntArray** execution_plan) {
+  TF_LITE_ENSURE(&context_, execution_plan != nullptr);
+  plan_cache_.reset(convertVectorToTfLiteIntArray(execution_plan_));
+  *execution_plan = plan_cache_.get();
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::GetExecutionPlan(TfLiteContext* context,
+                                           TfLiteIntArray** execution_plan) {
+  // Note here that context->impl_ is recovering the this pointer for an
+  // instance of Interpreter to call into the member function GetExecutionPlan
+  // (this function is static).
+  return static_cast<Interpreter*>(context->impl_)
+      ->GetExecutionPlan(execution_plan);
+}
+
+TfLiteStatus Interpreter::GetNodeAndRegistration(
+    int node_index, TfLiteNode** node, TfLiteRegistration** registration) {
+  TF_LITE_ENSURE(&context_, node_index < nodes_size() && node_index >= 0);
+  TF_LITE_ENSURE(&context_, node != nullptr && registration != nullptr);
+  *node = &nodes_and_registration_[node_index].first;
+  *registration = &nodes_and_registration_[node_index].second;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::GetNodeAndRegistration(
+    TfLiteContext* context, int node_index, TfLiteNode** node,
+    TfLiteRegistration** registration) {
+  return static_cast<Interpreter*>(context->impl_)
+      ->GetNodeAndRegistration(node_index, node, registration);
+}
+
+namespace {
+
+// Shows the execution plan of an Interpreter to the graph partitioning.
+class InterpreterInfo : public GraphInfo {
+ public:
+  explicit InterpreterInfo(Interpreter* interpreter)
+      : interpreter_(interpreter) {}
+
+  int num_tensors() const override { return interpreter_->tensors_size(); }
+  int num_nodes() const override {
+    return interpreter_->execution_plan().size();
+  }
+  const TfLiteNode& node(int i) const override {
+    return interpreter_->node_and_registration(node_index(i))->first;
+  }
+  int node_index(int i) const override {
+    return interpreter_->execution_plan()[i];
+  }
+  const std::vector<int>& inputs() const override {
+    return interpreter_->inputs();
+  }
+  const std::vector<int>& outputs() const override {
+    return interpreter_->outputs();
+  }
+
+ private:
+  Interpreter* interpreter_;
+};
+
+// Creates the TfLiteDelegateParams of 'subgraph' in a single malloc()ed
+// block, so that the node that owns it can release it with free() like any
+// other builtin_data.
+TfLiteDelegateParams* CreateDelegateParams(TfLiteDelegate* delegate,
+                                           const Subgraph& subgraph) {
+  auto array_bytes = [](const std::vector<int>& values) {
+    return sizeof(TfLiteIntArray) + sizeof(int) * values.size();
+  };
+  const size_t allocation_size =
+      sizeof(TfLiteDelegateParams) + array_bytes(subgraph.nodes) +
+      array_bytes(subgraph.input_tensors) +
+      array_bytes(subgraph.output_tensors);
+  char* allocation = static_cast<char*>(malloc(allocation_size));
+  TfLiteDelegateParams* params =
+      reinterpret_cast<TfLiteDelegateParams*>(allocation);
+  allocation += sizeof(TfLiteDelegateParams);
+
+  auto copy_array = [&allocation, &array_bytes](
+                        const std::vector<int>& values) {
+    TfLiteIntArray* array = reinterpret_cast<TfLiteIntArray*>(allocation);
+    array->size = values.size();
+    for (int i = 0; i < values.size(); ++i) array->data[i] = values[i];
+    allocation += array_bytes(values);
+    return array;
+  };
+  params->delegate = delegate;
+  params->nodes_to_replace = copy_array(subgraph.nodes);
+  params->input_tensors = copy_array(subgraph.input_tensors);
+  params->output_tensors = copy_array(subgraph.output_tensors);
+  return params;
+}
+
+}  // namespace
+
+TfLiteStatus Interpreter::ReplaceSubgraphsWithDelegateKernels(
+    TfLiteRegistration registration, const TfLiteIntArray* nodes_to_replace,
+    TfLiteDelegate* delegate) {
+  // Split the plan into subgraphs that are either fully claimed by the
+  // delegate or fully left to their own kernels.
+  std::vector<Subgraph> subgraphs;
+  if (PartitionGraphIntoIndependentSubgraphs(InterpreterInfo(this),
+                                             nodes_to_replace,
+                                             &subgraphs) != kTfLiteOk) {
+    ReportError(&context_,
+                "Nodes to replace are not a valid part of the execution "
+                "plan.\n");
+    return kTfLiteError;
+  }
+
+  std::vector<int> new_plan;
+  for (const Subgraph& subgraph : subgraphs) {
+    if (subgraph.type == Subgraph::kTfNonPartition) {
+      new_plan.insert(new_plan.end(), subgraph.nodes.begin(),
+                      subgraph.nodes.end());
+      continue;
+    }
+    // The delegate kernel takes ownership of the params through its
+    // builtin_data, and sees them as the 'buffer' of its init.
+    int node_index;
+    TF_LITE_ENSURE_OK(
+        &context_,
+        AddNodeWithParameters(subgraph.input_tensors, subgraph.output_tensors,
+                              nullptr, 0,
+                              CreateDelegateParams(delegate, subgraph),
+                              &registration, &node_index));
+    new_plan.push_back(node_index);
+  }
+  execution_plan_ = std::move(new_plan);
+  next_allocate_node_id_ = 0;
+  invokable_ = false;
+  InvalidatePreparedNodes();
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::ReplaceSubgraphsWithDelegateKernels(
+    TfLiteContext* context, TfLiteRegistration registration,
+    const TfLiteIntArray* nodes_to_replace, TfLiteDelegate* delegate) {
+  return static_cast<Interpreter*>(context->impl_)
+      ->ReplaceSubgraphsWithDelegateKernels(registration, nodes_to_replace,
+                                            delegate);
+}
+
+TfLiteStatus Interpreter::ForbiddenReplaceSubgraphsWithDelegateKernels(
+    TfLiteContext* context, TfLiteRegistration registration,
+    const TfLiteIntArray* nodes_to_replace, TfLiteDelegate* delegate) {
+  ReportError(context,
+              "ReplaceSubgraphsWithDelegateKernels() can only be called "
+              "from TfLiteDelegate::Prepare().\n");
+  return kTfLiteError;
+}
+
+TfLiteStatus Interpreter::SetExecutionPlan(const std::vector<int>& new_plan) {
+  for (int node_index : new_plan) {
+    TF_LITE_ENSURE(&context_, node_index >= 0 && node_index < nodes_size());
+  }
+  execution_plan_ = new_plan;
+  next_allocate_node_id_ = 0;
+  invokable_ = false;
+  InvalidatePreparedNodes();
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
+  TF_LITE_ENSURE(&context_, delegate != nullptr && delegate->Prepare);
+  // Nodes may only be replaced while the delegate looks at the graph.
+  context_.ReplaceSubgraphsWithDelegateKernels =
+      ReplaceSubgraphsWithDelegateKernels;
+  TfLiteStatus status = delegate->Prepare(&context_, delegate);
+  context_.ReplaceSubgraphsWithDelegateKernels =
+      ForbiddenReplaceSubgraphsWithDelegateKernels;
+  return status;
+}
+
 TfLiteStatus Interpreter::SetTensorParametersReadOnly(
     int tensor_index, TfLiteType type, const char* name,
     const std::vector<int>& dims, TfLiteQuantizationParams quantization,
@@ -481,6 +728,8 @@ TfLiteStatus Interpreter::SetTensorParametersReadOnly(
     TF_LITE_ENSURE_EQ(&context_, required_bytes, bytes);
   }
   invokable_ = false;
+  InvalidatePreparedNodes();
+  custom_allocations_.erase(tensor_index);
   TfLiteTensorReset(type, name, convertVectorToTfLiteIntArray(dims),
                     quantization, const_cast<char*>(buffer), bytes,
                     kTfLiteMmapRo, allocation, &context_.tensors[tensor_index]);
@@ -495,6 +744,7 @@ TfLiteStatus Interpreter::SetTensorParametersReadWrite(
     int tensor_index, TfLiteType type, const char* name,
     const std::vector<int>& dims, TfLiteQuantizationParams quantization) {
   invokable_ = false;
+  InvalidatePreparedNodes();
   TF_LITE_ENSURE(&context_,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
   size_t required_bytes = 0;
@@ -506,6 +756,7 @@ TfLiteStatus Interpreter::SetTensorParametersReadWrite(
     TF_LITE_ENSURE_OK(&context_, BytesRequired(type, dims.data(), dims.size(),
                                                &required_bytes));
   }
+  custom_allocations_.erase(tensor_index);
   TfLiteTensorReset(type, name, convertVectorToTfLiteIntArray(dims),
                     quantization,
                     /*buffer=*/nullptr, required_bytes,
@@ -517,8 +768,11 @@ TfLiteStatus Interpreter::SetTensorParametersReadWrite(
 TfLiteStatus Interpreter::ResizeTensorImpl(TfLiteTensor* tensor,
                                            TfLiteIntArray* new_size) {
   // Note that in theory we could resize kTfLiteArenaRwPersistent tensors too.
+  // kTfLiteCustom tensors keep their buffer, which is checked against the new
+  // size before the next Invoke().
   if (tensor->allocation_type == kTfLiteArenaRw ||
-      tensor->allocation_type == kTfLiteDynamic) {
+      tensor->allocation_type == kTfLiteDynamic ||
+      tensor->allocation_type == kTfLiteCustom) {
     if (tensor->type != kTfLiteString) {
       size_t bytesRequired;
       TfLiteStatus status = BytesRequired(tensor->type, new_size->data,
@@ -532,7 +786,7 @@ TfLiteStatus Interpreter::ResizeTensorImpl(TfLiteTensor* tensor,
     if (tensor->dims) TfLiteIntArrayFree(tensor->dims);
     tensor->dims = new_size;
 
-    if (tensor->allocation_type != kTfLiteDynamic) {
+    if (tensor->allocation_type == kTfLiteArenaRw) {
       tensor->data.raw = nullptr;
     }
   } else {
@@ -545,6 +799,73 @@ TfLiteStatus Interpreter::ResizeTensorImpl(TfLiteTensor* tensor,
   return kTfLiteOk;
 }
 
+TfLiteStatus Interpreter::SetCustomAllocationForTensor(
+    int tensor_index, const TfLiteCustomAllocation& allocation) {
+  TF_LITE_ENSURE(&context_,
+                 tensor_index < context_.tensors_size && tensor_index >= 0);
+  if (std::find(inputs_.begin(), inputs_.end(), tensor_index) ==
+          inputs_.end() &&
+      std::find(outputs_.begin(), outputs_.end(), tensor_index) ==
+          outputs_.end()) {
+    ReportError(&context_,
+                "Only inputs and outputs can use custom allocations.\n");
+    return kTfLiteError;
+  }
+  TfLiteTensor& tensor = context_.tensors[tensor_index];
+  TF_LITE_ENSURE(&context_, tensor.allocation_type == kTfLiteArenaRw ||
+                                tensor.allocation_type == kTfLiteCustom);
+
+  if (allocation.data == nullptr) {
+    if (tensor.allocation_type == kTfLiteCustom) {
+      tensor.allocation_type = kTfLiteArenaRw;
+      tensor.data.raw = nullptr;
+      custom_allocations_.erase(tensor_index);
+      invokable_ = false;
+    }
+    return kTfLiteOk;
+  }
+
+  const uintptr_t address = reinterpret_cast<uintptr_t>(allocation.data);
+  TF_LITE_ENSURE(&context_, address % kDefaultTensorAlignment == 0);
+  if (allocation.bytes < tensor.bytes) {
+    ReportError(&context_,
+                "Custom allocation of %d bytes is too small for tensor %d of "
+                "%d bytes.\n",
+                static_cast<int>(allocation.bytes), tensor_index,
+                static_cast<int>(tensor.bytes));
+    return kTfLiteError;
+  }
+  // The arena plan doesn't need to change: the tensor keeps its slot until
+  // the next AllocateTensors(), but no longer uses it.
+  tensor.allocation_type = kTfLiteCustom;
+  tensor.data.raw = static_cast<char*>(allocation.data);
+  custom_allocations_[tensor_index] = allocation;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::CheckCustomAllocations() {
+  for (const auto& tensor_and_allocation : custom_allocations_) {
+    const int tensor_index = tensor_and_allocation.first;
+    const TfLiteTensor& tensor = context_.tensors[tensor_index];
+    if (tensor.allocation_type != kTfLiteCustom) {
+      ReportError(&context_,
+                  "Tensor %d has a custom allocation, but its kernel "
+                  "changed how it is allocated.\n",
+                  tensor_index);
+      return kTfLiteError;
+    }
+    if (tensor_and_allocation.second.bytes < tensor.bytes) {
+      ReportError(&context_,
+                  "Custom allocation of %d bytes is too small for tensor %d "
+                  "of %d bytes.\n",
+                  static_cast<int>(tensor_and_allocation.second.bytes),
+                  tensor_index, static_cast<int>(tensor.bytes));
+      return kTfLiteError;
+    }
+  }
+  return kTfLiteOk;
+}
+
 void Interpreter::UseNNAPI(bool enable) {
   // TODO(aselle): This is a workaround for finding if NNAPI exists.
   // We also need to make sure getLibraryHandle() is renamed to be NNAPI
@@ -562,6 +883,15 @@ void Interpreter::SetNumThreads(int num_threads) {
   // don't use it. We should implement some dynamic mechanism for this sort of
   // library-specific initialization.
   tflite::gemm_support::SetMaxNumThreads(&context_, num_threads);
+  tflite::thread_pool_support::SetNumThreads(&context_, num_threads);
+}
+
+void Interpreter::SetMemoryPlanner(std::unique_ptr<MemoryPlanner> planner) {
+  if (planner) {
+    memory_planner_ = std::move(planner);
+  } else {
+    memory_planner_.reset(new ExecutionOrderMemoryPlanner);
+  }
 }
 
 }  // namespace tflite
@@ -19,10 +19,14 @@ limitations under the License.
 
 #include <cstdio>
 #include <cstdlib>
+#include <map>
+#include <memory>
 #include <vector>
 #include "tensorflow/contrib/lite/allocation.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/error_reporter.h"
+#include "tensorflow/contrib/lite/memory_planner.h"
+#include "tensorflow/contrib/lite/profiler.h"
 #include "tensorflow/contrib/lite/simple_memory_arena.h"
 
 namespace tflite {
@@ -50,10 +54,13 @@ constexpr TfLiteType typeToTfLiteType<unsigned char>() {
 }
 
 struct ArenaAllocRefCount {
-  ArenaAllocRefCount() : alloc(), count(0) {}
+  ArenaAllocRefCount() : alloc(), count(0), live(false) {}
 
   ArenaAlloc alloc;
   int count;
+  // Whether 'alloc' must be preserved when planning the nodes that follow a
+  // dynamic tensor.
+  bool live;
 };
 
 // Forward declare since NNAPIDelegate uses Interpreter.
@@ -173,6 +180,15 @@ class Interpreter {
   // Return the number of ops in the model.
   int nodes_size() const { return nodes_and_registration_.size(); }
 
+  // Return the indices of the nodes in the order they run. Nodes replaced by
+  // a delegate kernel are no longer part of it.
+  const std::vector<int>& execution_plan() const { return execution_plan_; }
+
+  // Overwrite the order in which nodes run. Every entry must be a valid node
+  // index, and the plan must read every tensor after it is produced.
+  // WARNING: this is an experimental API, meant for testing and delegates.
+  TfLiteStatus SetExecutionPlan(const std::vector<int>& new_plan);
+
   // Get a tensor data structure.
   // TODO(aselle): Create a safe ArrayHandle interface to avoid exposing this
   // read/write access to structure
@@ -217,6 +233,18 @@ class Interpreter {
     return typed_tensor<T>(outputs_[index]);
   }
 
+  // Bind caller-owned memory to an input or output tensor, so that it is read
+  // or written in place instead of being copied through the arena. The tensor
+  // becomes kTfLiteCustom. 'allocation.data' must be aligned to 4 bytes and
+  // stay valid while bound; for an AHardwareBuffer or an mmapped region this is
+  // the CPU address from AHardwareBuffer_lock() or mmap(). Rebinding a tensor
+  // to another buffer takes effect right away. 'allocation.bytes' is checked
+  // against the size of the tensor here and again whenever AllocateTensors()
+  // or Invoke() resize it. Binding a null 'allocation.data' returns the tensor
+  // to the arena, which takes effect on the next AllocateTensors().
+  TfLiteStatus SetCustomAllocationForTensor(
+      int tensor_index, const TfLiteCustomAllocation& allocation);
+
   // Change the dimensionality of a given tensor. Note, this is only acceptable
   // for tensor indices that are inputs.
   // Returns status of failure or success.
@@ -229,6 +257,8 @@ class Interpreter {
   // Update allocations for all tensors. This will redim dependent tensors using
   // the input tensor dimensionality as given. This is relatively expensive.
   // If you know that your sizes are not changing, you need not call this.
+  // Only the nodes whose input shapes or types changed since they were last
+  // prepared are prepared again, and the arena keeps its largest buffer.
 
   // Returns status of success or failure.
   TfLiteStatus AllocateTensors();
@@ -244,9 +274,35 @@ class Interpreter {
   // Enable or disable the NN API (true to enable)
   void UseNNAPI(bool enable);
 
+  // Let 'delegate' claim the parts of the graph it supports. Each group of
+  // claimed nodes that can run as a unit is replaced by a single delegate
+  // kernel node, and the remaining nodes keep their own kernels. The
+  // delegate must outlive the interpreter. AllocateTensors() must be called
+  // again before the next Invoke().
+  TfLiteStatus ModifyGraphWithDelegate(TfLiteDelegate* delegate);
+
   // Set the number of threads available to the interpreter.
   void SetNumThreads(int num_threads);
 
+  // Set the planner that lays out kTfLiteArenaRw tensors in the arena, or
+  // restore the default ExecutionOrderMemoryPlanner if 'planner' is null.
+  // Takes effect on the next call to AllocateTensors().
+  void SetMemoryPlanner(std::unique_ptr<MemoryPlanner> planner);
+
+  // Set a profiler that is told when each node starts and finishes in
+  // Invoke(), or stop profiling if 'profiler' is null. The profiler must
+  // outlive the interpreter or be unset first. Nodes run by the NN API are
+  // not reported individually.
+  void SetProfiler(Profiler* profiler) { profiler_ = profiler; }
+  Profiler* GetProfiler() const { return profiler_; }
+
+  // Returns the number of bytes reserved in the memory arenas for
+  // kTfLiteArenaRw and kTfLiteArenaRwPersistent tensors, as laid out by the
+  // last AllocateTensors() (or Invoke(), for dynamically sized tensors).
+  size_t ArenaHighWaterMark() const {
+    return arena_.high_water_mark() + persistent_arena_.high_water_mark();
+  }
+
  private:
   // Give 'op_reg' a chance to initialize itself using the contents of
   // 'buffer'.
@@ -280,6 +336,16 @@ class Interpreter {
   // we encounter a node that has a dynamic output tensor.
   TfLiteStatus AllocateTensorsWhoseSizesAreKnown();
 
+  // Prepare 'node' unless it was already prepared for inputs of the same
+  // types and shapes.
+  TfLiteStatus PrepareNodeIfInputsChanged(int node_index,
+                                          const TfLiteRegistration& op_reg,
+                                          TfLiteNode* node);
+
+  // Forget which nodes have been prepared, so that all of them are prepared
+  // again by the next allocation.
+  void InvalidatePreparedNodes() { prepared_inputs_.clear(); }
+
   // Tensors needed by the interpreter. Use `AddTensors` to add more blank
   // tensor entries. Note, `tensors_.data()` needs to be synchronized to the
   // `context_` whenever this std::vector is reallocated. Currently this
@@ -315,6 +381,33 @@ class Interpreter {
   static TfLiteStatus AddTensors(TfLiteContext* context, int tensors_to_add,
                                  int* first_new_tensor_index);
 
+  // Entry point for C API GetExecutionPlan.
+  static TfLiteStatus GetExecutionPlan(TfLiteContext* context,
+                                       TfLiteIntArray** execution_plan);
+  TfLiteStatus GetExecutionPlan(TfLiteIntArray** execution_plan);
+
+  // Entry point for C API GetNodeAndRegistration.
+  static TfLiteStatus GetNodeAndRegistration(
+      TfLiteContext* context, int node_index, TfLiteNode** node,
+      TfLiteRegistration** registration);
+  TfLiteStatus GetNodeAndRegistration(int node_index, TfLiteNode** node,
+                                      TfLiteRegistration** registration);
+
+  // Entry point for C API ReplaceSubgraphsWithDelegateKernels, while a
+  // delegate is being prepared.
+  static TfLiteStatus ReplaceSubgraphsWithDelegateKernels(
+      TfLiteContext* context, TfLiteRegistration registration,
+      const TfLiteIntArray* nodes_to_replace, TfLiteDelegate* delegate);
+  TfLiteStatus ReplaceSubgraphsWithDelegateKernels(
+      TfLiteRegistration registration, const TfLiteIntArray* nodes_to_replace,
+      TfLiteDelegate* delegate);
+
+  // Entry point for C API ReplaceSubgraphsWithDelegateKernels at any other
+  // time, which reports an error.
+  static TfLiteStatus ForbiddenReplaceSubgraphsWithDelegateKernels(
+      TfLiteContext* context, TfLiteRegistration registration,
+      const TfLiteIntArray* nodes_to_replace, TfLiteDelegate* delegate);
+
   // A pure C data structure used to communicate with the pure C plugin
   // interface. To avoid copying tensor metadata, this is also the definitive
   // structure to store tensors.
@@ -325,6 +418,12 @@ class Interpreter {
   std::vector<std::pair<TfLiteNode, TfLiteRegistration>>
       nodes_and_registration_;
 
+  // Indices of the nodes in nodes_and_registration_, in the order they run.
+  std::vector<int> execution_plan_;
+
+  // A copy of execution_plan_ handed out through GetExecutionPlan().
+  std::unique_ptr<TfLiteIntArray, void (*)(TfLiteIntArray*)> plan_cache_;
+
   // Raw memory buffer that is allocated for all temporary and graph outputs.
   // that are declared kTfLiteArenaRw.
   SimpleMemoryArena arena_;
@@ -333,9 +432,24 @@ class Interpreter {
   // declared as kTfLiteArenaRwPersistent.
   SimpleMemoryArena persistent_arena_;
 
+  // Checks that every kTfLiteCustom tensor still fits in its buffer.
+  TfLiteStatus CheckCustomAllocations();
+
   // Stores allocation and reference counts of all tensors.
   std::vector<ArenaAllocRefCount> allocs_and_refcounts_;
 
+  // For each node index, the types, allocation types and dimensions of the
+  // node's inputs when it was last prepared successfully, or an empty vector
+  // if it needs to be prepared. Resizing the inputs of a model only prepares
+  // again the nodes that are affected by the new shapes.
+  std::vector<std::vector<int>> prepared_inputs_;
+
+  // The caller-owned buffers bound to kTfLiteCustom tensors, by tensor index.
+  std::map<int, TfLiteCustomAllocation> custom_allocations_;
+
+  // Assigns arena offsets to tensors from their lifetimes.
+  std::unique_ptr<MemoryPlanner> memory_planner_;
+
   // Whether the model is consistent. That is to say if the inputs and outputs
   // of every node and the global inputs and outputs are valid indexes into
   // the tensor array.
@@ -356,7 +470,7 @@ class Interpreter {
   // The error reporter delegate that tflite will forward queries errors to.
   ErrorReporter* error_reporter_;
 
-  // Next node to allocate output tensors.
+  // Position in execution_plan_ of the next node to allocate output tensors.
   // During Invoke(), Interpreter will allocate input tensors first, which are
   // known to be fixed size. Then it will allocate outputs from nodes as many
   // as possible. When there is a node that produces dynamic sized tensor.
@@ -368,6 +482,9 @@ class Interpreter {
 
   // Whether to delegate to NN API
   std::unique_ptr<NNAPIDelegate> nnapi_delegate_;
+
+  // Receives the per-node events of Invoke(), if set. Not owned.
+  Profiler* profiler_ = nullptr;
 };
 
 }  // namespace tflite
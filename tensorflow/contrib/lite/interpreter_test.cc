@@ -249,6 +249,169 @@ TEST(BasicInterpreter, CheckArenaAllocation) {
   ASSERT_LT(interpreter.tensor(9)->data.raw, interpreter.tensor(5)->data.raw);
 }
 
+TEST(BasicInterpreter, CheckMemoryPlanner) {
+  // A chain of three nodes where the first tensor leaves a hole in execution
+  // order that the third can't use.
+  auto build = [](Interpreter* interpreter) {
+    ASSERT_EQ(interpreter->AddTensors(4), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    std::vector<int> sizes{16, 32, 48, 4};
+    for (int i = 0; i < sizes.size(); ++i) {
+      interpreter->SetTensorParametersReadWrite(i, kTfLiteUInt8, "",
+                                                {sizes[i]}, quant);
+    }
+    interpreter->SetInputs({0});
+    interpreter->SetOutputs({3});
+    interpreter->AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg);
+    interpreter->AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg);
+    interpreter->AddNodeWithParameters({2}, {3}, nullptr, 0, nullptr, &reg);
+  };
+
+  Interpreter in_order;
+  build(&in_order);
+  ASSERT_EQ(in_order.AllocateTensors(), kTfLiteOk);
+  char* base = in_order.tensor(0)->data.raw;
+  ASSERT_EQ(in_order.tensor(1)->data.raw, base + 16);
+  ASSERT_EQ(in_order.tensor(2)->data.raw, base + 48);
+  ASSERT_EQ(in_order.tensor(3)->data.raw, base);
+
+  Interpreter by_size;
+  build(&by_size);
+  by_size.SetMemoryPlanner(
+      std::unique_ptr<MemoryPlanner>(new GreedyBySizeMemoryPlanner));
+  ASSERT_EQ(by_size.AllocateTensors(), kTfLiteOk);
+  base = by_size.tensor(2)->data.raw;
+  ASSERT_EQ(by_size.tensor(0)->data.raw, base);
+  ASSERT_EQ(by_size.tensor(1)->data.raw, base + 48);
+  ASSERT_EQ(by_size.tensor(3)->data.raw, base + 48);
+}
+
+// Records the node index and builtin code of every profiler event.
+class RecordingProfiler : public Profiler {
+ public:
+  void BeginNode(int node_index, const TfLiteNode& node,
+                 const TfLiteRegistration& registration) override {
+    events.push_back({node_index, registration.builtin_code, true});
+  }
+  void EndNode(int node_index, const TfLiteNode& node,
+               const TfLiteRegistration& registration) override {
+    events.push_back({node_index, registration.builtin_code, false});
+  }
+
+  struct Event {
+    int node_index;
+    int builtin_code;
+    bool begin;
+  };
+  std::vector<Event> events;
+};
+
+TEST(BasicInterpreter, ProfilerSeesEachNode) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 3; ++i) {
+    interpreter.SetTensorParametersReadWrite(i, kTfLiteUInt8, "",
+                                             {16 * (i + 1)}, quant);
+  }
+  interpreter.SetInputs({0});
+  interpreter.SetOutputs({2});
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.invoke = [](TfLiteContext*, TfLiteNode*) { return kTfLiteOk; };
+  reg.builtin_code = 7;
+  interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg);
+  reg.builtin_code = 9;
+  interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  // All three tensors are live while the second node runs.
+  EXPECT_EQ(interpreter.ArenaHighWaterMark(), 16 + 32 + 48);
+
+  RecordingProfiler profiler;
+  interpreter.SetProfiler(&profiler);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  ASSERT_EQ(profiler.events.size(), 4);
+  EXPECT_EQ(profiler.events[0].node_index, 0);
+  EXPECT_EQ(profiler.events[0].builtin_code, 7);
+  EXPECT_TRUE(profiler.events[0].begin);
+  EXPECT_EQ(profiler.events[1].node_index, 0);
+  EXPECT_FALSE(profiler.events[1].begin);
+  EXPECT_EQ(profiler.events[2].node_index, 1);
+  EXPECT_EQ(profiler.events[2].builtin_code, 9);
+  EXPECT_TRUE(profiler.events[2].begin);
+  EXPECT_EQ(profiler.events[3].node_index, 1);
+  EXPECT_FALSE(profiler.events[3].begin);
+
+  // Nothing is recorded once the profiler is unset.
+  interpreter.SetProfiler(nullptr);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(profiler.events.size(), 4);
+}
+
+TEST(BasicInterpreter, ResizeOnlyPreparesAffectedNodes) {
+  // Two independent nodes that copy the shape of their input to their output
+  // and count how many times they were prepared.
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(4), kTfLiteOk);
+  TfLiteQuantizationParams quant;
+  for (int i = 0; i < 4; ++i) {
+    interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {3},
+                                             quant);
+  }
+  interpreter.SetInputs({0, 1});
+  interpreter.SetOutputs({2, 3});
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.init = [](TfLiteContext*, const char*, size_t) -> void* {
+    return new int(0);
+  };
+  reg.free = [](TfLiteContext*, void* buffer) {
+    delete reinterpret_cast<int*>(buffer);
+  };
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++*reinterpret_cast<int*>(node->user_data);
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext*, TfLiteNode*) { return kTfLiteOk; };
+  interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr, &reg);
+  interpreter.AddNodeWithParameters({1}, {3}, nullptr, 0, nullptr, &reg);
+  auto prepare_count = [&interpreter](int node_index) {
+    return *reinterpret_cast<int*>(
+        interpreter.node_and_registration(node_index)->first.user_data);
+  };
+
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count(0), 1);
+  EXPECT_EQ(prepare_count(1), 1);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {6}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count(0), 2);
+  EXPECT_EQ(prepare_count(1), 1);
+  EXPECT_EQ(interpreter.tensor(2)->dims->data[0], 6);
+  EXPECT_EQ(interpreter.tensor(2)->bytes, 6 * sizeof(float));
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+
+  // Nothing is prepared again for unchanged shapes, and the arena buffer is
+  // reused when the model shrinks.
+  char* buffer = interpreter.tensor(0)->data.raw;
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {6}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count(0), 3);
+  EXPECT_EQ(prepare_count(1), 1);
+  EXPECT_EQ(interpreter.tensor(0)->data.raw, buffer);
+
+  // Changing the parameters of a tensor prepares all the nodes again.
+  interpreter.SetTensorParametersReadWrite(1, kTfLiteFloat32, "", {3}, quant);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(prepare_count(0), 4);
+  EXPECT_EQ(prepare_count(1), 2);
+}
+
 TEST(BasicInterpreter, BufferAccess) {
   Interpreter interpreter;
   ASSERT_EQ(interpreter.AddTensors(1), kTfLiteOk);
@@ -489,6 +652,307 @@ TEST(BasicInterpreter, AllocateTwice) {
   ASSERT_EQ(old_tensor1_ptr, interpreter.tensor(1)->data.raw);
 }
 
+// Builds t0 -> n0 -> t1 -> n1 -> t2 -> n2 -> t3, where every node adds one to
+// its input and a delegate can run the nodes whose builtin_code is kSupported.
+class TestDelegate : public ::testing::Test {
+ protected:
+  static constexpr int kSupported = 1;
+  static constexpr int kUnsupported = 2;
+
+  void SetUp() override {
+    ASSERT_EQ(interpreter_.AddTensors(4), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({3}), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", {3}, quant),
+                kTfLiteOk);
+    }
+    TfLiteRegistration reg = AddOneRegistration();
+    reg.builtin_code = kSupported;
+    ASSERT_EQ(
+        interpreter_.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+        kTfLiteOk);
+    ASSERT_EQ(
+        interpreter_.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg),
+        kTfLiteOk);
+    reg.builtin_code = kUnsupported;
+    ASSERT_EQ(
+        interpreter_.AddNodeWithParameters({2}, {3}, nullptr, 0, nullptr, &reg),
+        kTfLiteOk);
+  }
+
+  // Resizes the outputs of a node like its first input, and sets them to the
+  // input plus the number of nodes the kernel stands for, which is kept in
+  // user_data.
+  static TfLiteRegistration AddOneRegistration() {
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input->dims));
+    };
+    reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      const float increment =
+          node->user_data ? *reinterpret_cast<int*>(node->user_data) : 1;
+      for (int i = 0; i < input->dims->data[0]; ++i) {
+        output->data.f[i] = input->data.f[i] + increment;
+      }
+      return kTfLiteOk;
+    };
+    return reg;
+  }
+
+  // Claims all nodes with kSupported. The delegate kernel checks the
+  // subgraph it was given and remembers its size.
+  static TfLiteStatus Prepare(TfLiteContext* context,
+                              TfLiteDelegate* delegate) {
+    TfLiteIntArray* plan;
+    TF_LITE_ENSURE_STATUS(context->GetExecutionPlan(context, &plan));
+    std::vector<int> supported;
+    for (int i = 0; i < plan->size; ++i) {
+      TfLiteNode* node;
+      TfLiteRegistration* registration;
+      TF_LITE_ENSURE_STATUS(context->GetNodeAndRegistration(
+          context, plan->data[i], &node, &registration));
+      if (registration->builtin_code == kSupported) {
+        supported.push_back(plan->data[i]);
+      }
+    }
+    TfLiteIntArray* nodes_to_replace = TfLiteIntArrayCreate(supported.size());
+    for (int i = 0; i < supported.size(); ++i) {
+      nodes_to_replace->data[i] = supported[i];
+    }
+
+    TfLiteRegistration delegate_kernel = AddOneRegistration();
+    delegate_kernel.init = [](TfLiteContext* context, const char* buffer,
+                              size_t length) -> void* {
+      auto* params = reinterpret_cast<const TfLiteDelegateParams*>(buffer);
+      EXPECT_EQ(params->delegate->data_, &kSupported);
+      EXPECT_EQ(params->input_tensors->size, 1);
+      EXPECT_EQ(params->input_tensors->data[0], 0);
+      EXPECT_EQ(params->output_tensors->size, 1);
+      EXPECT_EQ(params->output_tensors->data[0], 2);
+      return new int(params->nodes_to_replace->size);
+    };
+    delegate_kernel.free = [](TfLiteContext* context, void* buffer) {
+      delete reinterpret_cast<int*>(buffer);
+    };
+    TfLiteStatus status = context->ReplaceSubgraphsWithDelegateKernels(
+        context, delegate_kernel, nodes_to_replace, delegate);
+    TfLiteIntArrayFree(nodes_to_replace);
+    return status;
+  }
+
+  Interpreter interpreter_;
+};
+
+constexpr int TestDelegate::kSupported;
+constexpr int TestDelegate::kUnsupported;
+
+TEST_F(TestDelegate, ReplacesSupportedNodes) {
+  TfLiteDelegate delegate = {const_cast<int*>(&kSupported), Prepare};
+  ASSERT_EQ(interpreter_.execution_plan().size(), 3);
+  ASSERT_EQ(interpreter_.ModifyGraphWithDelegate(&delegate), kTfLiteOk);
+
+  // The two supported nodes became one new node, followed by the third one.
+  ASSERT_EQ(interpreter_.nodes_size(), 4);
+  ASSERT_EQ(interpreter_.execution_plan().size(), 2);
+  EXPECT_EQ(interpreter_.execution_plan()[0], 3);
+  EXPECT_EQ(interpreter_.execution_plan()[1], 2);
+
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    interpreter_.typed_tensor<float>(0)[i] = i;
+  }
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter_.typed_tensor<float>(3)[i], i + 3);
+  }
+}
+
+TEST_F(TestDelegate, ClaimingNothingKeepsPlan) {
+  TfLiteDelegate delegate = {nullptr, [](TfLiteContext* context,
+                                         TfLiteDelegate* delegate) {
+    TfLiteIntArray* nodes_to_replace = TfLiteIntArrayCreate(0);
+    TfLiteStatus status = context->ReplaceSubgraphsWithDelegateKernels(
+        context, AddOneRegistration(), nodes_to_replace, delegate);
+    TfLiteIntArrayFree(nodes_to_replace);
+    return status;
+  }};
+  ASSERT_EQ(interpreter_.ModifyGraphWithDelegate(&delegate), kTfLiteOk);
+  EXPECT_EQ(interpreter_.nodes_size(), 3);
+  EXPECT_EQ(interpreter_.execution_plan(), std::vector<int>({0, 1, 2}));
+
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+}
+
+TEST_F(TestDelegate, ReplacingOutsidePrepareFails) {
+  TfLiteContext* context = nullptr;
+  TfLiteDelegate delegate = {&context, [](TfLiteContext* context,
+                                          TfLiteDelegate* delegate) {
+    *reinterpret_cast<TfLiteContext**>(delegate->data_) = context;
+    return kTfLiteOk;
+  }};
+  ASSERT_EQ(interpreter_.ModifyGraphWithDelegate(&delegate), kTfLiteOk);
+  ASSERT_NE(context, nullptr);
+
+  TfLiteIntArray* nodes_to_replace = TfLiteIntArrayCreate(1);
+  nodes_to_replace->data[0] = 0;
+  EXPECT_EQ(context->ReplaceSubgraphsWithDelegateKernels(
+                context, AddOneRegistration(), nodes_to_replace, &delegate),
+            kTfLiteError);
+  TfLiteIntArrayFree(nodes_to_replace);
+  EXPECT_EQ(interpreter_.execution_plan().size(), 3);
+}
+
+TEST_F(TestDelegate, SetExecutionPlan) {
+  EXPECT_NE(interpreter_.SetExecutionPlan({0, 5}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.SetExecutionPlan({0, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+}
+
+// Builds t0 -> n0 -> t1 -> n1 -> t2, where every node doubles its input, and
+// keeps caller-owned buffers that can be bound to the input and the output.
+class TestCustomAllocation : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(interpreter_.AddTensors(3), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({2}), kTfLiteOk);
+    TfLiteQuantizationParams quant;
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", {4}, quant),
+                kTfLiteOk);
+    }
+    TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+    reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+      TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      return context->ResizeTensor(context, output,
+                                   TfLiteIntArrayCopy(input->dims));
+    };
+    reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      for (int i = 0; i < input->dims->data[0]; ++i) {
+        output->data.f[i] = 2 * input->data.f[i];
+      }
+      return kTfLiteOk;
+    };
+    ASSERT_EQ(
+        interpreter_.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+        kTfLiteOk);
+    ASSERT_EQ(
+        interpreter_.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg),
+        kTfLiteOk);
+  }
+
+  TfLiteCustomAllocation Allocation(float* buffer, int num_floats) {
+    return {buffer, num_floats * sizeof(float)};
+  }
+
+  Interpreter interpreter_;
+  float input_[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  float output_[8] = {};
+  float other_output_[8] = {};
+};
+
+TEST_F(TestCustomAllocation, ReadsAndWritesInPlace) {
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter_.SetCustomAllocationForTensor(0, Allocation(input_, 4)),
+            kTfLiteOk);
+  ASSERT_EQ(
+      interpreter_.SetCustomAllocationForTensor(2, Allocation(output_, 4)),
+      kTfLiteOk);
+  EXPECT_EQ(interpreter_.tensor(0)->allocation_type, kTfLiteCustom);
+  EXPECT_EQ(interpreter_.typed_tensor<float>(0), input_);
+  EXPECT_EQ(interpreter_.typed_tensor<float>(2), output_);
+
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(output_[i], 4 * input_[i]);
+
+  // Rebinding doesn't need another AllocateTensors().
+  ASSERT_EQ(interpreter_.SetCustomAllocationForTensor(
+                2, Allocation(other_output_, 4)),
+            kTfLiteOk);
+  input_[0] = 10;
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_EQ(other_output_[0], 40);
+  EXPECT_EQ(output_[0], 4);
+
+  // AllocateTensors() keeps the bound buffers.
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter_.typed_tensor<float>(0), input_);
+  EXPECT_EQ(interpreter_.typed_tensor<float>(2), other_output_);
+}
+
+TEST_F(TestCustomAllocation, RejectsInvalidAllocations) {
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  // Only inputs and outputs can be bound.
+  EXPECT_NE(interpreter_.SetCustomAllocationForTensor(1, Allocation(input_, 4)),
+            kTfLiteOk);
+  EXPECT_NE(interpreter_.SetCustomAllocationForTensor(3, Allocation(input_, 4)),
+            kTfLiteOk);
+  // Too small.
+  EXPECT_NE(interpreter_.SetCustomAllocationForTensor(0, Allocation(input_, 3)),
+            kTfLiteOk);
+  // Misaligned.
+  TfLiteCustomAllocation misaligned = {reinterpret_cast<char*>(input_) + 1,
+                                       4 * sizeof(float)};
+  EXPECT_NE(interpreter_.SetCustomAllocationForTensor(0, misaligned),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter_.tensor(0)->allocation_type, kTfLiteArenaRw);
+}
+
+TEST_F(TestCustomAllocation, ChecksSizeAfterResize) {
+  ASSERT_EQ(interpreter_.SetCustomAllocationForTensor(0, Allocation(input_, 8)),
+            kTfLiteOk);
+  ASSERT_EQ(
+      interpreter_.SetCustomAllocationForTensor(2, Allocation(output_, 4)),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+
+  // The output buffer is too small for the new shape.
+  ASSERT_EQ(interpreter_.ResizeInputTensor(0, {8}), kTfLiteOk);
+  EXPECT_EQ(interpreter_.typed_tensor<float>(0), input_);
+  EXPECT_NE(interpreter_.AllocateTensors(), kTfLiteOk);
+  EXPECT_NE(interpreter_.Invoke(), kTfLiteOk);
+
+  ASSERT_EQ(
+      interpreter_.SetCustomAllocationForTensor(2, Allocation(output_, 8)),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 8; ++i) EXPECT_EQ(output_[i], 4 * input_[i]);
+}
+
+TEST_F(TestCustomAllocation, UnbindReturnsToArena) {
+  ASSERT_EQ(
+      interpreter_.SetCustomAllocationForTensor(2, Allocation(output_, 4)),
+      kTfLiteOk);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(interpreter_.SetCustomAllocationForTensor(2, {nullptr, 0}),
+            kTfLiteOk);
+  EXPECT_EQ(interpreter_.tensor(2)->allocation_type, kTfLiteArenaRw);
+  // The tensor needs its arena memory back before the next Invoke().
+  EXPECT_NE(interpreter_.Invoke(), kTfLiteOk);
+
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  ASSERT_NE(interpreter_.typed_tensor<float>(2), nullptr);
+  EXPECT_NE(interpreter_.typed_tensor<float>(2), output_);
+  for (int i = 0; i < 4; ++i) interpreter_.typed_tensor<float>(0)[i] = i;
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_EQ(interpreter_.typed_tensor<float>(2)[3], 12);
+}
+
 struct TestErrorReporter : public ErrorReporter {
   int Report(const char* format, va_list args) override {
     char buffer[1024];
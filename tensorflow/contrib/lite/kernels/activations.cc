@@ -22,12 +22,14 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/multithreaded_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -123,16 +125,30 @@ TfLiteStatus SoftmaxPrepare(TfLiteContext* context, TfLiteNode* node) {
                                TfLiteIntArrayCopy(input->dims));
 }
 
+// Sets every element of 'output' to fn() of the matching element of 'input',
+// splitting the elements over the threads of the context's ThreadPool.
+// 'cost_per_element' is a rough count of the arithmetic done by fn().
+template <typename ElementFn>
+void EvalElementWiseFloat(TfLiteContext* context, TfLiteTensor* input,
+                          TfLiteTensor* output, int cost_per_element,
+                          const ElementFn& fn) {
+  const int elements = input->bytes / sizeof(float);
+  const float* in = input->data.f;
+  float* out = output->data.f;
+  thread_pool_support::GetFromContext(context)->ParallelFor(
+      elements, multithreaded_ops::MinBlockSize(cost_per_element),
+      [in, out, &fn](int start, int end) {
+        for (int i = start; i < end; ++i) out[i] = fn(in[i]);
+      });
+}
+
 TfLiteStatus ReluEval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* input = GetInput(context, node, 0);
   TfLiteTensor* output = GetOutput(context, node, 0);
   switch (input->type) {
     case kTfLiteFloat32: {
-      size_t elements = input->bytes / sizeof(float);
-      float* in = input->data.f;
-      float* in_end = in + elements;
-      float* out = output->data.f;
-      for (; in < in_end; in++, out++) *out = std::max(0.f, *in);
+      EvalElementWiseFloat(context, input, output, 1,
+                           [](float x) { return std::max(0.f, x); });
       return kTfLiteOk;
     }
     break;
@@ -147,13 +163,9 @@ TfLiteStatus Relu1Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output = GetOutput(context, node, 0);
   switch (input->type) {
     case kTfLiteFloat32: {
-      size_t elements = input->bytes / sizeof(float);
-      float* in = input->data.f;
-      float* in_end = in + elements;
-      float* out = output->data.f;
-      for (; in < in_end; in++, out++) {
-        *out = std::min(std::max(-1.f, *in), 1.f);
-      }
+      EvalElementWiseFloat(context, input, output, 1, [](float x) {
+        return std::min(std::max(-1.f, x), 1.f);
+      });
       return kTfLiteOk;
     } break;
     default:
@@ -167,11 +179,9 @@ TfLiteStatus Relu6Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output = GetOutput(context, node, 0);
   switch (input->type) {
     case kTfLiteFloat32: {
-      size_t elements = input->bytes / sizeof(float);
-      float* in = input->data.f;
-      float* in_end = in + elements;
-      float* out = output->data.f;
-      for (; in < in_end; in++, out++) *out = std::min(std::max(0.f, *in), 6.f);
+      EvalElementWiseFloat(context, input, output, 1, [](float x) {
+        return std::min(std::max(0.f, x), 6.f);
+      });
       return kTfLiteOk;
     }
     break;
@@ -186,11 +196,8 @@ TfLiteStatus TanhEval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output = GetOutput(context, node, 0);
   switch (input->type) {
     case kTfLiteFloat32: {
-      size_t elements = input->bytes / sizeof(float);
-      float* in = input->data.f;
-      float* in_end = in + elements;
-      float* out = output->data.f;
-      for (; in < in_end; in++, out++) *out = std::tanh(*in);
+      EvalElementWiseFloat(context, input, output, 16,
+                           [](float x) { return std::tanh(x); });
       return kTfLiteOk;
     }
     break;
@@ -208,11 +215,9 @@ TfLiteStatus SigmoidEval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* output = GetOutput(context, node, 0);
   switch (input->type) {
     case kTfLiteFloat32: {
-      size_t elements = input->bytes / sizeof(float);
-      float* in = input->data.f;
-      float* in_end = in + elements;
-      float* out = output->data.f;
-      for (; in < in_end; in++, out++) *out = 1.f / (1.f + std::exp(-*in));
+      EvalElementWiseFloat(context, input, output, 16, [](float x) {
+        return 1.f / (1.f + std::exp(-x));
+      });
       break;
     }
     case kTfLiteUInt8: {
@@ -230,17 +235,11 @@ TfLiteStatus SigmoidEval(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
 
-// Takes a 2D tensor and perform softmax along the second dimension.
-void Softmax2DFloat(TfLiteTensor* input, TfLiteTensor* output,
-                    TfLiteSoftmaxParams* params) {
-  const int batch_size = input->dims->data[0];
-  const int input_size = input->dims->data[1];
-  float* in = input->data.f;
-  float* out = output->data.f;
-  TF_LITE_ASSERT(input_size > 0);
-
-  // For each batch
-  for (int b = 0; b < batch_size; b++) {
+// Performs softmax on each of the rows of 'in', which hold 'input_size'
+// values each.
+void Softmax2DFloatRows(const float* in, float* out, int num_rows,
+                        int input_size, float beta) {
+  for (int b = 0; b < num_rows; b++) {
     // Find the max coeff.
     float max_coeff = in[0];
     for (int i = 1; i < input_size; i++) {
@@ -250,7 +249,7 @@ void Softmax2DFloat(TfLiteTensor* input, TfLiteTensor* output,
     // Compute the normalized sum of exps.
     float exp_sum = 0.0;
     for (int i = 0; i < input_size; i++) {
-      out[i] = std::exp((in[i] - max_coeff) * params->beta);
+      out[i] = std::exp((in[i] - max_coeff) * beta);
       exp_sum += out[i];
     }
 
@@ -266,6 +265,24 @@ void Softmax2DFloat(TfLiteTensor* input, TfLiteTensor* output,
   }
 }
 
+// Takes a 2D tensor and perform softmax along the second dimension.
+void Softmax2DFloat(TfLiteContext* context, TfLiteTensor* input,
+                    TfLiteTensor* output, TfLiteSoftmaxParams* params) {
+  const int batch_size = input->dims->data[0];
+  const int input_size = input->dims->data[1];
+  const float* in = input->data.f;
+  float* out = output->data.f;
+  TF_LITE_ASSERT(input_size > 0);
+
+  // Each batch is normalized on its own, so batches are split across threads.
+  thread_pool_support::GetFromContext(context)->ParallelFor(
+      batch_size, multithreaded_ops::MinBlockSize(16 * input_size),
+      [&](int start, int end) {
+        Softmax2DFloatRows(in + start * input_size, out + start * input_size,
+                           end - start, input_size, params->beta);
+      });
+}
+
 void Softmax2DQuantized(TfLiteTensor* input, TfLiteTensor* output,
                         TfLiteSoftmaxParams* params, OpData* data) {
   // TODO(ahentz): this is arguably a dirty trick. Since the implementation
@@ -282,11 +299,12 @@ void Softmax2DQuantized(TfLiteTensor* input, TfLiteTensor* output,
 }
 
 // Takes a 4D tensor and perform softmax along the forth dimension.
-void Softmax4DFloat(TfLiteTensor* input, TfLiteTensor* output,
-                    TfLiteSoftmaxParams* params) {
-  optimized_ops::Softmax(GetTensorData<float>(input), GetTensorDims(input),
-                         params->beta, GetTensorData<float>(output),
-                         GetTensorDims(output));
+void Softmax4DFloat(TfLiteContext* context, TfLiteTensor* input,
+                    TfLiteTensor* output, TfLiteSoftmaxParams* params) {
+  multithreaded_ops::Softmax(thread_pool_support::GetFromContext(context),
+                             GetTensorData<float>(input), GetTensorDims(input),
+                             params->beta, GetTensorData<float>(output),
+                             GetTensorDims(output));
 }
 
 void Softmax4DQuantized(TfLiteTensor* input, TfLiteTensor* output,
@@ -309,11 +327,11 @@ TfLiteStatus SoftmaxEval(TfLiteContext* context, TfLiteNode* node) {
   switch (input->type) {
     case kTfLiteFloat32: {
       if (NumDimensions(input) == 2) {
-        Softmax2DFloat(input, output, params);
+        Softmax2DFloat(context, input, output, params);
         return kTfLiteOk;
       }
       if (NumDimensions(input) == 4) {
-        Softmax4DFloat(input, output, params);
+        Softmax4DFloat(context, input, output, params);
         return kTfLiteOk;
       }
       context->ReportError(context,
@@ -14,12 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/multithreaded_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -73,7 +75,12 @@ void EvalAddFloat(TfLiteContext* context, TfLiteNode* node,
     if (kernel_type == kReference) {
       TF_LITE_ADD(reference_ops);
     } else {
-      TF_LITE_ADD(optimized_ops);
+      multithreaded_ops::Add(
+          thread_pool_support::GetFromContext(context),
+          GetTensorData<float>(input1), GetTensorDims(input1),
+          GetTensorData<float>(input2), GetTensorDims(input2),
+          output_activation_min, output_activation_max,
+          GetTensorData<float>(output), GetTensorDims(output));
   }
 #undef TF_LITE_ADD
 }
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 #include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -339,6 +340,7 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
         GetTensorData<float>(im2col), GetTensorDims(im2col));
   } else {
     multithreaded_ops::Conv(
+        thread_pool_support::GetFromContext(context),
         GetTensorData<float>(input), GetTensorDims(input), filter_data,
         GetTensorDims(filter), GetTensorData<float>(bias), GetTensorDims(bias),
         params->stride_width, params->stride_height, data->padding.width,
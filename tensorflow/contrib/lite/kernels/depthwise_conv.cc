@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/depthwiseconv_float.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/depthwiseconv_uint8.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/multithreaded_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/depthwiseconv_float.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/depthwiseconv_uint8.h"
@@ -31,6 +32,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 #include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -175,22 +177,24 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   CalculateActivationRangeFloat(params->activation, &output_activation_min,
                                 &output_activation_max);
 
-  void (*depthwise_conv)(const float*, const Dims<4>&, const float*,
-                         const Dims<4>&, const float*, const Dims<4>&, int, int,
-                         int, int, int, float, float, float*, const Dims<4>&);
   if (kernel_type == kReference) {
-    depthwise_conv = &reference_ops::DepthwiseConv;
+    reference_ops::DepthwiseConv(
+        GetTensorData<float>(input), GetTensorDims(input),
+        GetTensorData<float>(filter), GetTensorDims(filter),
+        GetTensorData<float>(bias), GetTensorDims(bias), params->stride_width,
+        params->stride_height, data->padding.width, data->padding.height,
+        params->depth_multiplier, output_activation_min, output_activation_max,
+        GetTensorData<float>(output), GetTensorDims(output));
   } else {
-    depthwise_conv = &optimized_ops::DepthwiseConv;
+    multithreaded_ops::DepthwiseConv(
+        thread_pool_support::GetFromContext(context),
+        GetTensorData<float>(input), GetTensorDims(input),
+        GetTensorData<float>(filter), GetTensorDims(filter),
+        GetTensorData<float>(bias), GetTensorDims(bias), params->stride_width,
+        params->stride_height, data->padding.width, data->padding.height,
+        params->depth_multiplier, output_activation_min, output_activation_max,
+        GetTensorData<float>(output), GetTensorDims(output));
   }
-
-  depthwise_conv(
-      GetTensorData<float>(input), GetTensorDims(input),
-      GetTensorData<float>(filter), GetTensorDims(filter),
-      GetTensorData<float>(bias), GetTensorDims(bias), params->stride_width,
-      params->stride_height, data->padding.width, data->padding.height,
-      params->depth_multiplier, output_activation_min, output_activation_max,
-      GetTensorData<float>(output), GetTensorDims(output));
 }
 
 template <KernelType kernel_type>
@@ -0,0 +1,231 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/builtin_op_data.h"
+#include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/multithreaded_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/tensor.h"
+#include "tensorflow/contrib/lite/kernels/kernel_util.h"
+#include "tensorflow/contrib/lite/kernels/op_macros.h"
+#include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
+
+namespace tflite {
+namespace ops {
+namespace builtin {
+namespace depthwise_separable_conv {
+
+// A DEPTHWISE_CONV_2D followed by a 1x1 CONV_2D with stride 1, as produced by
+// toco when fusing depthwise-separable blocks. The intermediate activations
+// are not stored in a tensor.
+constexpr int kInputTensor = 0;
+constexpr int kDepthwiseFilterTensor = 1;
+constexpr int kDepthwiseBiasTensor = 2;
+constexpr int kPointwiseFilterTensor = 3;
+constexpr int kPointwiseBiasTensor = 4;
+constexpr int kOutputTensor = 0;
+
+// This file has three implementation of DepthwiseSeparableConv.
+enum KernelType {
+  kReference,
+  kGenericOptimized,  // Neon-free
+  kNeonOptimized,
+};
+
+struct OpData {
+  TfLitePaddingValues padding;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  // This is a builtin op, so we don't use the contents in 'buffer', if any.
+  // Instead, we allocate a new object to carry information from Prepare() to
+  // Eval().
+  return new OpData;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  auto* params =
+      reinterpret_cast<TfLiteDepthwiseSeparableConvParams*>(node->builtin_data);
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 5);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  TfLiteTensor* depthwise_filter =
+      GetInput(context, node, kDepthwiseFilterTensor);
+  TfLiteTensor* depthwise_bias = GetInput(context, node, kDepthwiseBiasTensor);
+  TfLiteTensor* pointwise_filter =
+      GetInput(context, node, kPointwiseFilterTensor);
+  TfLiteTensor* pointwise_bias = GetInput(context, node, kPointwiseBiasTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+
+  // Only float is supported: quantized models keep the two convolutions
+  // separate, because the intermediate values need their own quantization.
+  TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, depthwise_filter->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, depthwise_bias->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, pointwise_filter->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, pointwise_bias->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, output->type, kTfLiteFloat32);
+
+  TF_LITE_ENSURE_EQ(context, NumDimensions(input), 4);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(depthwise_filter), 4);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(pointwise_filter), 4);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(depthwise_bias), 1);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(pointwise_bias), 1);
+
+  // The parameter 'depth_multiplier' is redundant, so we check here to make
+  // sure it is consistent with the given dimensions.
+  const int depthwise_channels = SizeOfDimension(depthwise_filter, 3);
+  TF_LITE_ENSURE_EQ(context,
+                    params->depth_multiplier * SizeOfDimension(input, 3),
+                    depthwise_channels);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(depthwise_bias, 0),
+                    depthwise_channels);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(pointwise_filter, 1), 1);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(pointwise_filter, 2), 1);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(pointwise_filter, 3),
+                    depthwise_channels);
+  const int channels_out = SizeOfDimension(pointwise_filter, 0);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(pointwise_bias, 0), channels_out);
+
+  int width = SizeOfDimension(input, 2);
+  int height = SizeOfDimension(input, 1);
+  int filter_width = SizeOfDimension(depthwise_filter, 2);
+  int filter_height = SizeOfDimension(depthwise_filter, 1);
+  int batches = SizeOfDimension(input, 0);
+
+  // Matching GetWindowedOutputSize in TensorFlow.
+  auto padding = params->padding;
+  auto compute_out_size = [padding](int imageSize, int filterSize,
+                                    int stride) -> int {
+    return padding == kTfLitePaddingSame
+               ? (imageSize + stride - 1) / stride
+               : padding == kTfLitePaddingValid
+                     ? (imageSize - filterSize + stride) / stride
+                     : 0;
+  };
+
+  int out_width = compute_out_size(width, filter_width, params->stride_width);
+  int out_height =
+      compute_out_size(height, filter_height, params->stride_height);
+
+  data->padding.height =
+      ComputePadding(params->stride_height, height, filter_height, out_height);
+  data->padding.width =
+      ComputePadding(params->stride_width, width, filter_width, out_width);
+
+  TfLiteIntArray* outputSize = TfLiteIntArrayCreate(4);
+  outputSize->data[0] = batches;
+  outputSize->data[1] = out_height;
+  outputSize->data[2] = out_width;
+  outputSize->data[3] = channels_out;
+  return context->ResizeTensor(context, output, outputSize);
+}
+
+template <KernelType kernel_type>
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  auto* params =
+      reinterpret_cast<TfLiteDepthwiseSeparableConvParams*>(node->builtin_data);
+  OpData* data = reinterpret_cast<OpData*>(node->user_data);
+
+  TfLiteTensor* input = GetInput(context, node, kInputTensor);
+  TfLiteTensor* depthwise_filter =
+      GetInput(context, node, kDepthwiseFilterTensor);
+  TfLiteTensor* depthwise_bias = GetInput(context, node, kDepthwiseBiasTensor);
+  TfLiteTensor* pointwise_filter =
+      GetInput(context, node, kPointwiseFilterTensor);
+  TfLiteTensor* pointwise_bias = GetInput(context, node, kPointwiseBiasTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+
+  float depthwise_activation_min, depthwise_activation_max;
+  CalculateActivationRangeFloat(params->depthwise_activation,
+                                &depthwise_activation_min,
+                                &depthwise_activation_max);
+  float output_activation_min, output_activation_max;
+  CalculateActivationRangeFloat(params->activation, &output_activation_min,
+                                &output_activation_max);
+
+  if (kernel_type == kReference) {
+    reference_ops::DepthwiseSeparableConv(
+        GetTensorData<float>(input), GetTensorDims(input),
+        GetTensorData<float>(depthwise_filter), GetTensorDims(depthwise_filter),
+        GetTensorData<float>(depthwise_bias), GetTensorDims(depthwise_bias),
+        GetTensorData<float>(pointwise_filter), GetTensorDims(pointwise_filter),
+        GetTensorData<float>(pointwise_bias), GetTensorDims(pointwise_bias),
+        params->stride_width, params->stride_height, data->padding.width,
+        data->padding.height, params->depth_multiplier,
+        depthwise_activation_min, depthwise_activation_max,
+        output_activation_min, output_activation_max,
+        GetTensorData<float>(output), GetTensorDims(output));
+  } else {
+    multithreaded_ops::DepthwiseSeparableConv(
+        thread_pool_support::GetFromContext(context),
+        GetTensorData<float>(input), GetTensorDims(input),
+        GetTensorData<float>(depthwise_filter), GetTensorDims(depthwise_filter),
+        GetTensorData<float>(depthwise_bias), GetTensorDims(depthwise_bias),
+        GetTensorData<float>(pointwise_filter), GetTensorDims(pointwise_filter),
+        GetTensorData<float>(pointwise_bias), GetTensorDims(pointwise_bias),
+        params->stride_width, params->stride_height, data->padding.width,
+        data->padding.height, params->depth_multiplier,
+        depthwise_activation_min, depthwise_activation_max,
+        output_activation_min, output_activation_max,
+        GetTensorData<float>(output), GetTensorDims(output));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace depthwise_separable_conv
+
+TfLiteRegistration* Register_DEPTHWISE_SEPARABLE_CONVOLUTION_REF() {
+  static TfLiteRegistration r = {
+      depthwise_separable_conv::Init, depthwise_separable_conv::Free,
+      depthwise_separable_conv::Prepare,
+      depthwise_separable_conv::Eval<depthwise_separable_conv::kReference>};
+  return &r;
+}
+
+TfLiteRegistration* Register_DEPTHWISE_SEPARABLE_CONVOLUTION_GENERIC_OPT() {
+  static TfLiteRegistration r = {
+      depthwise_separable_conv::Init, depthwise_separable_conv::Free,
+      depthwise_separable_conv::Prepare,
+      depthwise_separable_conv::Eval<
+          depthwise_separable_conv::kGenericOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_DEPTHWISE_SEPARABLE_CONVOLUTION_NEON_OPT() {
+  static TfLiteRegistration r = {
+      depthwise_separable_conv::Init, depthwise_separable_conv::Free,
+      depthwise_separable_conv::Prepare,
+      depthwise_separable_conv::Eval<depthwise_separable_conv::kNeonOptimized>};
+  return &r;
+}
+
+TfLiteRegistration* Register_DEPTHWISE_SEPARABLE_CONV_2D() {
+#ifdef USE_NEON
+  return Register_DEPTHWISE_SEPARABLE_CONVOLUTION_NEON_OPT();
+#else
+  return Register_DEPTHWISE_SEPARABLE_CONVOLUTION_GENERIC_OPT();
+#endif
+}
+
+}  // namespace builtin
+}  // namespace ops
+}  // namespace tflite
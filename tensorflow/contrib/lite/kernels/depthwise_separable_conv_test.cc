@@ -0,0 +1,148 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdarg>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/kernels/register.h"
+#include "tensorflow/contrib/lite/kernels/test_util.h"
+#include "tensorflow/contrib/lite/model.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class DepthwiseSeparableConvolutionOpModel : public SingleOpModel {
+ public:
+  DepthwiseSeparableConvolutionOpModel(
+      const TensorData& input, const TensorData& depthwise_filter,
+      const TensorData& pointwise_filter, const TensorData& output,
+      ActivationFunctionType depthwise_activation,
+      ActivationFunctionType activation) {
+    input_ = AddInput(input);
+    depthwise_filter_ = AddInput(depthwise_filter);
+    depthwise_bias_ =
+        AddInput({TensorType_FLOAT32, {GetShape(depthwise_filter_)[3]}});
+    pointwise_filter_ = AddInput(pointwise_filter);
+    pointwise_bias_ =
+        AddInput({TensorType_FLOAT32, {GetShape(pointwise_filter_)[0]}});
+    output_ = AddOutput(output);
+
+    int input_depth = GetShape(input_)[3];
+    int depthwise_depth = GetShape(depthwise_filter_)[3];
+    int depth_mul = depthwise_depth / input_depth;
+
+    SetBuiltinOp(BuiltinOperator_DEPTHWISE_SEPARABLE_CONV_2D,
+                 BuiltinOptions_DepthwiseSeparableConv2DOptions,
+                 CreateDepthwiseSeparableConv2DOptions(
+                     builder_, Padding_VALID, 1, 1, depth_mul,
+                     depthwise_activation, activation)
+                     .Union());
+
+    BuildInterpreter({GetShape(input_), GetShape(depthwise_filter_),
+                      GetShape(depthwise_bias_), GetShape(pointwise_filter_),
+                      GetShape(pointwise_bias_)});
+  }
+
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+  void SetDepthwiseFilter(std::initializer_list<float> f) {
+    PopulateTensor(depthwise_filter_, f);
+  }
+  void SetDepthwiseBias(std::initializer_list<float> f) {
+    PopulateTensor(depthwise_bias_, f);
+  }
+  void SetPointwiseFilter(std::initializer_list<float> f) {
+    PopulateTensor(pointwise_filter_, f);
+  }
+  void SetPointwiseBias(std::initializer_list<float> f) {
+    PopulateTensor(pointwise_bias_, f);
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int depthwise_filter_;
+  int depthwise_bias_;
+  int pointwise_filter_;
+  int pointwise_bias_;
+  int output_;
+};
+
+// Uses the inputs of DepthwiseConvolutionOpTest.SimpleTest, whose depthwise
+// output is {71, -34, 99, -20, 91, -26, 127, -4}.
+void SetSimpleInputs(DepthwiseSeparableConvolutionOpModel* m) {
+  m->SetInput({
+      1, 2, 7, 8,    // column 1
+      3, 4, 9, 10,   // column 2
+      5, 6, 11, 12,  // column 3
+  });
+  m->SetDepthwiseFilter({
+      1, 2, 3, 4,        //
+      -9, 10, -11, 12,   //
+      5, 6, 7, 8,        //
+      13, -14, 15, -16,  //
+  });
+  m->SetDepthwiseBias({1, 2, 3, 4});
+  m->SetPointwiseFilter({
+      1, 1, 0, 0,   //
+      0, 0, 1, -1,  //
+  });
+  m->SetPointwiseBias({0.5, -7});
+}
+
+TEST(DepthwiseSeparableConvolutionOpTest, SimpleTest) {
+  DepthwiseSeparableConvolutionOpModel m(
+      {TensorType_FLOAT32, {1, 3, 2, 2}}, {TensorType_FLOAT32, {1, 2, 2, 4}},
+      {TensorType_FLOAT32, {2, 1, 1, 4}}, {TensorType_FLOAT32, {}},
+      ActivationFunctionType_NONE, ActivationFunctionType_NONE);
+  SetSimpleInputs(&m);
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 2, 1, 2}));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 37.5, 112,  //
+                                 65.5, 124,  //
+                             }));
+}
+
+TEST(DepthwiseSeparableConvolutionOpTest, ActivationsTest) {
+  DepthwiseSeparableConvolutionOpModel m(
+      {TensorType_FLOAT32, {1, 3, 2, 2}}, {TensorType_FLOAT32, {1, 2, 2, 4}},
+      {TensorType_FLOAT32, {2, 1, 1, 4}}, {TensorType_FLOAT32, {}},
+      ActivationFunctionType_RELU6, ActivationFunctionType_RELU);
+  SetSimpleInputs(&m);
+
+  m.Invoke();
+
+  // The depthwise output is clamped to {6, 0, 6, 0} for both pixels.
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 6.5, 0,  //
+                                 6.5, 0,  //
+                             }));
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
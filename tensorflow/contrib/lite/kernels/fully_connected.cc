@@ -55,6 +55,8 @@ struct OpData {
   // uint8_t these would be 0 and 255.
   int32_t output_activation_min;
   int32_t output_activation_max;
+  // Index of the first temporary tensor of the hybrid kernel.
+  int scratch_tensor_index;
 };
 
 constexpr int kInputTensor = 0;
@@ -62,12 +64,21 @@ constexpr int kWeightsTensor = 1;
 constexpr int kBiasTensor = 2;
 constexpr int kOutputTensor = 0;
 
+// Temporaries of the hybrid kernel, whose weights are quantized: the quantized
+// input and the scaling factors of its batches.
+constexpr int kInputQuantizedTemporary = 0;
+constexpr int kScalingFactorsTemporary = 1;
+constexpr int kNumHybridTemporaries = 2;
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // This is a builtin op, so we don't use the contents in 'buffer', if any.
   // Instead, we allocate a new object to carry information from Prepare() to
   // Eval().
   gemm_support::IncrementUsageCounter(context);
-  return new OpData;
+  auto* data = new OpData;
+  context->AddTensors(context, kNumHybridTemporaries,
+                      &data->scratch_tensor_index);
+  return data;
 }
 
 void Free(TfLiteContext* context, void* buffer) {
@@ -121,6 +132,35 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                   &data->output_activation_max);
   }
 
+  // The hybrid kernel quantizes each batch of the float input on the fly.
+  if (params->weights_only_quantized) {
+    TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, filter->type, kTfLiteUInt8);
+
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(kNumHybridTemporaries);
+    for (int i = 0; i < kNumHybridTemporaries; ++i) {
+      node->temporaries->data[i] = data->scratch_tensor_index + i;
+    }
+
+    TfLiteTensor* input_quantized =
+        GetTemporary(context, node, kInputQuantizedTemporary);
+    input_quantized->type = kTfLiteUInt8;
+    input_quantized->allocation_type = kTfLiteArenaRw;
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, input_quantized,
+                                            TfLiteIntArrayCopy(input->dims)));
+
+    TfLiteTensor* scaling_factors =
+        GetTemporary(context, node, kScalingFactorsTemporary);
+    scaling_factors->type = kTfLiteFloat32;
+    scaling_factors->allocation_type = kTfLiteArenaRw;
+    TfLiteIntArray* scaling_factors_size = TfLiteIntArrayCreate(1);
+    scaling_factors_size->data[0] = batch_size;
+    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scaling_factors,
+                                                     scaling_factors_size));
+  }
+
   // Resize output.
   TfLiteIntArray* output_size_array = TfLiteIntArrayCreate(2);
   output_size_array->data[0] = batch_size;
@@ -163,6 +203,55 @@ TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// The weights hold int8 values, which are multiplied with the input quantized
+// to int8, and the results are scaled back to float.
+TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
+                        TfLiteFullyConnectedParams* params, OpData* data,
+                        TfLiteTensor* input, TfLiteTensor* filter,
+                        TfLiteTensor* bias, TfLiteTensor* output) {
+  int total_input_size = 1;
+  for (int i = 0; i < input->dims->size; i++) {
+    total_input_size *= input->dims->data[i];
+  }
+
+  const int input_size = filter->dims->data[1];
+  const int batch_size = total_input_size / filter->dims->data[1];
+  const int num_units = filter->dims->data[0];
+
+  // Output = bias if bias tensor exists.
+  if (bias) {
+    tensor_utils::VectorBatchVectorAssign(bias->data.f, num_units, batch_size,
+                                          output->data.f);
+  } else {
+    tensor_utils::ZeroVector(output->data.f, batch_size * num_units);
+  }
+
+  // Quantize each batch of the input, and fold the scale of the weights into
+  // its scaling factor.
+  int8_t* quantized_input_ptr = reinterpret_cast<int8_t*>(
+      GetTemporary(context, node, kInputQuantizedTemporary)->data.uint8);
+  float* scaling_factors_ptr =
+      GetTemporary(context, node, kScalingFactorsTemporary)->data.f;
+  for (int b = 0; b < batch_size; ++b) {
+    tensor_utils::SymmetricQuantizeFloats(
+        input->data.f + b * input_size, input_size,
+        quantized_input_ptr + b * input_size, &scaling_factors_ptr[b]);
+    scaling_factors_ptr[b] *= filter->params.scale;
+  }
+
+  // Compute output += weight * input
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      reinterpret_cast<const int8_t*>(filter->data.uint8), num_units,
+      input_size, quantized_input_ptr, scaling_factors_ptr, batch_size,
+      output->data.f, /*result_stride=*/1);
+
+  // Apply activation function
+  tensor_utils::ApplyActivationToVector(output->data.f, batch_size * num_units,
+                                        params->activation, output->data.f);
+
+  return kTfLiteOk;
+}
+
 #define TF_LITE_MACRO_DISPATCH(macro_name, params, target_namespace) \
   if (params->activation == kTfLiteActNone) {                        \
     macro_name(target_namespace, kNone);                             \
@@ -247,6 +336,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   switch (input->type) {  // Already know in/out types are same.
     case kTfLiteFloat32:
+      if (params->weights_only_quantized) {
+        return EvalHybrid(context, node, params, data, input, filter, bias,
+                          output);
+      }
       return EvalFloat<kernel_type>(context, node, params, data, input, filter,
                                     bias, output);
     case kTfLiteUInt8:
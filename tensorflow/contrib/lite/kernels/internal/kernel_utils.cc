@@ -0,0 +1,354 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/internal/kernel_utils.h"
+
+#include "tensorflow/contrib/lite/kernels/activation_functor.h"
+#include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
+
+namespace tflite {
+namespace kernel_utils {
+
+namespace {
+
+// Applies the activations to the gates of every batch and cell, updates the
+// cell state and computes the gated output, keeping the intermediate values
+// in registers. The gate scratch buffers already hold the gate inputs.
+void UpdateCellsAndGatedOutput(
+    const float* cell_to_input_weights_ptr,
+    const float* cell_to_forget_weights_ptr,
+    const float* cell_to_output_weights_ptr, const TfLiteLSTMParams* params,
+    int n_batch, int n_cell, bool use_cifg, const float* input_gate_scratch,
+    const float* forget_gate_scratch, const float* cell_scratch,
+    const float* output_gate_scratch, float* cell_state_ptr,
+    float* gated_output) {
+  const bool use_peephole = (cell_to_output_weights_ptr != nullptr);
+  const ActivationFunctor sigmoid(kTfLiteActSigmoid);
+  const ActivationFunctor activation(params->activation);
+  for (int b = 0; b < n_batch; ++b) {
+    for (int c = 0; c < n_cell; ++c) {
+      const int index = b * n_cell + c;
+      const float cell = cell_state_ptr[index];
+
+      float forget_gate = forget_gate_scratch[index];
+      if (use_peephole) forget_gate += cell_to_forget_weights_ptr[c] * cell;
+      forget_gate = sigmoid(forget_gate);
+
+      float input_gate;
+      if (use_cifg) {
+        input_gate = 1.0f - forget_gate;
+      } else {
+        input_gate = input_gate_scratch[index];
+        if (use_peephole) input_gate += cell_to_input_weights_ptr[c] * cell;
+        input_gate = sigmoid(input_gate);
+      }
+
+      float new_cell = forget_gate * cell;
+      new_cell += activation(cell_scratch[index]) * input_gate;
+      if (params->cell_clip > 0.0) {
+        new_cell = tensor_utils::Clip(new_cell, params->cell_clip);
+      }
+      cell_state_ptr[index] = new_cell;
+
+      float output_gate = output_gate_scratch[index];
+      if (use_peephole) output_gate += cell_to_output_weights_ptr[c] * new_cell;
+      output_gate = sigmoid(output_gate);
+      gated_output[index] = output_gate * activation(new_cell);
+    }
+  }
+}
+
+// Quantizes the 'n_batch' vectors of 'v_size' elements each in 'vectors'
+// into 'quantized_vectors', and sets 'product_scaling_factors' to their
+// scaling factors multiplied by 'matrix_scale'.
+void QuantizeBatchVectors(const float* vectors, int n_batch, int v_size,
+                          float matrix_scale, int8_t* quantized_vectors,
+                          float* product_scaling_factors) {
+  for (int b = 0; b < n_batch; ++b) {
+    tensor_utils::SymmetricQuantizeFloats(
+        vectors + b * v_size, v_size, quantized_vectors + b * v_size,
+        &product_scaling_factors[b]);
+    product_scaling_factors[b] *= matrix_scale;
+  }
+}
+
+// Accumulates 'matrix' * 'quantized_vectors' in 'result', where
+// 'scaling_factors' are those of the vectors alone, i.e. they were quantized
+// with a 'matrix_scale' of 1. This lets them be shared by several matrices.
+void QuantizedMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, float matrix_scale, int m_rows, int m_cols,
+    const int8_t* quantized_vectors, const float* scaling_factors, int n_batch,
+    float* product_scaling_factors, float* result) {
+  for (int b = 0; b < n_batch; ++b) {
+    product_scaling_factors[b] = scaling_factors[b] * matrix_scale;
+  }
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      matrix, m_rows, m_cols, quantized_vectors, product_scaling_factors,
+      n_batch, result, /*result_stride=*/1);
+}
+
+}  // namespace
+
+void LstmStep(
+    const float* input_ptr_batch, const float* input_to_input_weights_ptr,
+    const float* input_to_forget_weights_ptr,
+    const float* input_to_cell_weights_ptr,
+    const float* input_to_output_weights_ptr,
+    const float* recurrent_to_input_weights_ptr,
+    const float* recurrent_to_forget_weights_ptr,
+    const float* recurrent_to_cell_weights_ptr,
+    const float* recurrent_to_output_weights_ptr,
+    const float* cell_to_input_weights_ptr,
+    const float* cell_to_forget_weights_ptr,
+    const float* cell_to_output_weights_ptr, const float* input_gate_bias_ptr,
+    const float* forget_gate_bias_ptr, const float* cell_bias_ptr,
+    const float* output_gate_bias_ptr, const float* projection_weights_ptr,
+    const float* projection_bias_ptr, const TfLiteLSTMParams* params,
+    int n_batch, int n_cell, int n_input, int n_output,
+    float* output_state_ptr, float* cell_state_ptr, float* input_gate_scratch,
+    float* forget_gate_scratch, float* cell_scratch,
+    float* output_gate_scratch, float* output_ptr_batch) {
+  // Since we have already checked that weights are all there or none, we can
+  // check the existense of only one to the get the condition.
+  const bool use_cifg = (input_to_input_weights_ptr == nullptr);
+  const bool use_projection = (projection_weights_ptr != nullptr);
+
+  // Initialize the gates with their bias, then accumulate input_weight * input
+  // and recurrent_weight * output_state for all of them at once.
+  const float* input_weights[4];
+  const float* recurrent_weights[4];
+  float* gates[4];
+  int n_gates = 0;
+  auto add_gate = [&](const float* input_to_gate,
+                      const float* recurrent_to_gate, const float* bias,
+                      float* gate_scratch) {
+    tensor_utils::VectorBatchVectorAssign(bias, n_cell, n_batch, gate_scratch);
+    input_weights[n_gates] = input_to_gate;
+    recurrent_weights[n_gates] = recurrent_to_gate;
+    gates[n_gates] = gate_scratch;
+    ++n_gates;
+  };
+  if (!use_cifg) {
+    add_gate(input_to_input_weights_ptr, recurrent_to_input_weights_ptr,
+             input_gate_bias_ptr, input_gate_scratch);
+  }
+  add_gate(input_to_forget_weights_ptr, recurrent_to_forget_weights_ptr,
+           forget_gate_bias_ptr, forget_gate_scratch);
+  add_gate(input_to_cell_weights_ptr, recurrent_to_cell_weights_ptr,
+           cell_bias_ptr, cell_scratch);
+  add_gate(input_to_output_weights_ptr, recurrent_to_output_weights_ptr,
+           output_gate_bias_ptr, output_gate_scratch);
+  tensor_utils::MultiMatrixBatchVectorMultiplyAccumulate(
+      input_weights, n_gates, n_cell, n_input, input_ptr_batch, n_batch, gates);
+  tensor_utils::MultiMatrixBatchVectorMultiplyAccumulate(
+      recurrent_weights, n_gates, n_cell, n_output, output_state_ptr, n_batch,
+      gates);
+
+  // Without a projection, the gated cells are the output.
+  float* gated_output = use_projection ? output_gate_scratch : output_ptr_batch;
+  UpdateCellsAndGatedOutput(
+      cell_to_input_weights_ptr, cell_to_forget_weights_ptr,
+      cell_to_output_weights_ptr, params, n_batch, n_cell, use_cifg,
+      input_gate_scratch, forget_gate_scratch, cell_scratch,
+      output_gate_scratch, cell_state_ptr, gated_output);
+
+  // For each batch: update the projection and output_state.
+  if (use_projection) {
+    if (projection_bias_ptr != nullptr) {
+      tensor_utils::VectorBatchVectorAssign(projection_bias_ptr, n_output,
+                                            n_batch, output_ptr_batch);
+    } else {
+      tensor_utils::ZeroVector(output_ptr_batch, n_batch * n_output);
+    }
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        projection_weights_ptr, n_output, n_cell, gated_output, n_batch,
+        output_ptr_batch, /*result_stride=*/1);
+    if (params->proj_clip > 0.0) {
+      tensor_utils::ClipVector(output_ptr_batch, n_batch * n_output,
+                               params->proj_clip, output_ptr_batch);
+    }
+  }
+  tensor_utils::CopyVector(output_ptr_batch, n_batch * n_output,
+                           output_state_ptr);
+}
+
+void HybridLstmStep(
+    const float* input_ptr_batch, const int8_t* input_to_input_weights_ptr,
+    float input_to_input_weights_scale,
+    const int8_t* input_to_forget_weights_ptr,
+    float input_to_forget_weights_scale,
+    const int8_t* input_to_cell_weights_ptr, float input_to_cell_weights_scale,
+    const int8_t* input_to_output_weights_ptr,
+    float input_to_output_weights_scale,
+    const int8_t* recurrent_to_input_weights_ptr,
+    float recurrent_to_input_weights_scale,
+    const int8_t* recurrent_to_forget_weights_ptr,
+    float recurrent_to_forget_weights_scale,
+    const int8_t* recurrent_to_cell_weights_ptr,
+    float recurrent_to_cell_weights_scale,
+    const int8_t* recurrent_to_output_weights_ptr,
+    float recurrent_to_output_weights_scale,
+    const float* cell_to_input_weights_ptr,
+    const float* cell_to_forget_weights_ptr,
+    const float* cell_to_output_weights_ptr, const float* input_gate_bias_ptr,
+    const float* forget_gate_bias_ptr, const float* cell_bias_ptr,
+    const float* output_gate_bias_ptr, const int8_t* projection_weights_ptr,
+    float projection_weights_scale, const float* projection_bias_ptr,
+    const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
+    int n_output, float* output_state_ptr, float* cell_state_ptr,
+    float* input_gate_scratch, float* forget_gate_scratch, float* cell_scratch,
+    float* output_gate_scratch, float* scaling_factors,
+    float* product_scaling_factors, int8_t* quantized_scratch,
+    float* output_ptr_batch) {
+  const bool use_cifg = (input_to_input_weights_ptr == nullptr);
+  const bool use_projection = (projection_weights_ptr != nullptr);
+
+  // Initialize the gates with their bias.
+  if (!use_cifg) {
+    tensor_utils::VectorBatchVectorAssign(input_gate_bias_ptr, n_cell, n_batch,
+                                          input_gate_scratch);
+  }
+  tensor_utils::VectorBatchVectorAssign(forget_gate_bias_ptr, n_cell, n_batch,
+                                        forget_gate_scratch);
+  tensor_utils::VectorBatchVectorAssign(cell_bias_ptr, n_cell, n_batch,
+                                        cell_scratch);
+  tensor_utils::VectorBatchVectorAssign(output_gate_bias_ptr, n_cell, n_batch,
+                                        output_gate_scratch);
+
+  // Quantize the input once, and accumulate input_weight * input for all the
+  // gates. The same is then done for the output_state.
+  QuantizeBatchVectors(input_ptr_batch, n_batch, n_input, 1.0f,
+                       quantized_scratch, scaling_factors);
+  if (!use_cifg) {
+    QuantizedMatrixBatchVectorMultiplyAccumulate(
+        input_to_input_weights_ptr, input_to_input_weights_scale, n_cell,
+        n_input, quantized_scratch, scaling_factors, n_batch,
+        product_scaling_factors, input_gate_scratch);
+  }
+  QuantizedMatrixBatchVectorMultiplyAccumulate(
+      input_to_forget_weights_ptr, input_to_forget_weights_scale, n_cell,
+      n_input, quantized_scratch, scaling_factors, n_batch,
+      product_scaling_factors, forget_gate_scratch);
+  QuantizedMatrixBatchVectorMultiplyAccumulate(
+      input_to_cell_weights_ptr, input_to_cell_weights_scale, n_cell, n_input,
+      quantized_scratch, scaling_factors, n_batch, product_scaling_factors,
+      cell_scratch);
+  QuantizedMatrixBatchVectorMultiplyAccumulate(
+      input_to_output_weights_ptr, input_to_output_weights_scale, n_cell,
+      n_input, quantized_scratch, scaling_factors, n_batch,
+      product_scaling_factors, output_gate_scratch);
+
+  QuantizeBatchVectors(output_state_ptr, n_batch, n_output, 1.0f,
+                       quantized_scratch, scaling_factors);
+  if (!use_cifg) {
+    QuantizedMatrixBatchVectorMultiplyAccumulate(
+        recurrent_to_input_weights_ptr, recurrent_to_input_weights_scale,
+        n_cell, n_output, quantized_scratch, scaling_factors, n_batch,
+        product_scaling_factors, input_gate_scratch);
+  }
+  QuantizedMatrixBatchVectorMultiplyAccumulate(
+      recurrent_to_forget_weights_ptr, recurrent_to_forget_weights_scale,
+      n_cell, n_output, quantized_scratch, scaling_factors, n_batch,
+      product_scaling_factors, forget_gate_scratch);
+  QuantizedMatrixBatchVectorMultiplyAccumulate(
+      recurrent_to_cell_weights_ptr, recurrent_to_cell_weights_scale, n_cell,
+      n_output, quantized_scratch, scaling_factors, n_batch,
+      product_scaling_factors, cell_scratch);
+  QuantizedMatrixBatchVectorMultiplyAccumulate(
+      recurrent_to_output_weights_ptr, recurrent_to_output_weights_scale,
+      n_cell, n_output, quantized_scratch, scaling_factors, n_batch,
+      product_scaling_factors, output_gate_scratch);
+
+  // Without a projection, the gated cells are the output.
+  float* gated_output = use_projection ? output_gate_scratch : output_ptr_batch;
+  UpdateCellsAndGatedOutput(
+      cell_to_input_weights_ptr, cell_to_forget_weights_ptr,
+      cell_to_output_weights_ptr, params, n_batch, n_cell, use_cifg,
+      input_gate_scratch, forget_gate_scratch, cell_scratch,
+      output_gate_scratch, cell_state_ptr, gated_output);
+
+  // For each batch: update the projection and output_state.
+  if (use_projection) {
+    if (projection_bias_ptr != nullptr) {
+      tensor_utils::VectorBatchVectorAssign(projection_bias_ptr, n_output,
+                                            n_batch, output_ptr_batch);
+    } else {
+      tensor_utils::ZeroVector(output_ptr_batch, n_batch * n_output);
+    }
+    QuantizeBatchVectors(gated_output, n_batch, n_cell,
+                         projection_weights_scale, quantized_scratch,
+                         product_scaling_factors);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        projection_weights_ptr, n_output, n_cell, quantized_scratch,
+        product_scaling_factors, n_batch, output_ptr_batch,
+        /*result_stride=*/1);
+    if (params->proj_clip > 0.0) {
+      tensor_utils::ClipVector(output_ptr_batch, n_batch * n_output,
+                               params->proj_clip, output_ptr_batch);
+    }
+  }
+  tensor_utils::CopyVector(output_ptr_batch, n_batch * n_output,
+                           output_state_ptr);
+}
+
+void SvdfStep(const float* input_ptr_batch, const float* weights_feature_ptr,
+              const float* weights_time_ptr, const float* bias_ptr,
+              const TfLiteSVDFParams* params, int n_batch, int input_size,
+              int num_filters, int memory_size, float* state_ptr_batch,
+              float* output_ptr_batch) {
+  const int rank = params->rank;
+  const int num_units = num_filters / rank;
+
+  // Clear the activation (state left most column).
+  for (int b = 0; b < n_batch; b++) {
+    float* state_ptr = state_ptr_batch + b * memory_size * num_filters;
+    for (int f = 0; f < num_filters; f++) {
+      state_ptr[f * memory_size + memory_size - 1] = 0.0;
+    }
+  }
+
+  // Compute conv1d(inputs, weights_feature).
+  // The state left most column is used to save current cycle activation. This
+  // is achieved by starting at state_ptr_batch[memory_size - 1] and having the
+  // stride equal to memory_size.
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      weights_feature_ptr, num_filters, input_size, input_ptr_batch, n_batch,
+      &state_ptr_batch[memory_size - 1], memory_size);
+
+  // For each filter: compute matmul(state, weights_time), add it to the unit
+  // it is reduced into, and shift the state left while it is still hot.
+  for (int b = 0; b < n_batch; b++) {
+    float* output_ptr = output_ptr_batch + b * num_units;
+    if (bias_ptr) {
+      tensor_utils::CopyVector(bias_ptr, num_units, output_ptr);
+    } else {
+      tensor_utils::ZeroVector(output_ptr, num_units);
+    }
+    float* state_ptr = state_ptr_batch + b * memory_size * num_filters;
+    const float* weights_time_ptr_filter = weights_time_ptr;
+    for (int f = 0; f < num_filters; f++) {
+      output_ptr[f / rank] += tensor_utils::VectorVectorDotProduct(
+          weights_time_ptr_filter, state_ptr, memory_size);
+      tensor_utils::VectorShiftLeft(state_ptr, memory_size,
+                                    /*shift_value=*/0.0);
+      weights_time_ptr_filter += memory_size;
+      state_ptr += memory_size;
+    }
+    tensor_utils::ApplyActivationToVector(output_ptr, num_units,
+                                          params->activation, output_ptr);
+  }
+}
+
+}  // namespace kernel_utils
+}  // namespace tflite
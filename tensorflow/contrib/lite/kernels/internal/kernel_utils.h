@@ -0,0 +1,110 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_KERNEL_UTILS_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_KERNEL_UTILS_H_
+
+#include <cstdint>
+
+#include "tensorflow/contrib/lite/builtin_op_data.h"
+
+namespace tflite {
+namespace kernel_utils {
+
+// Performs one time step of an LSTM cell for 'n_batch' inputs of 'n_input'
+// elements each. The input-to-gate and recurrent-to-gate weights of all gates
+// are multiplied in one pass over each vector, and the activations, the cell
+// update and the output gate are then applied to every cell in a single pass.
+// This gives the same results as composing the tensor_utils functions one
+// gate at a time.
+//
+// The input gate weights and bias are null for a CIFG LSTM, the peephole
+// weights are null when not used, and so are the projection weights and bias.
+// 'output_state_ptr' and 'cell_state_ptr' are read and updated in place. The
+// scratch buffers hold 'n_batch * n_cell' elements each; 'input_gate_scratch'
+// isn't used for a CIFG LSTM. 'output_ptr_batch' receives 'n_batch' rows of
+// 'n_output' elements.
+void LstmStep(
+    const float* input_ptr_batch, const float* input_to_input_weights_ptr,
+    const float* input_to_forget_weights_ptr,
+    const float* input_to_cell_weights_ptr,
+    const float* input_to_output_weights_ptr,
+    const float* recurrent_to_input_weights_ptr,
+    const float* recurrent_to_forget_weights_ptr,
+    const float* recurrent_to_cell_weights_ptr,
+    const float* recurrent_to_output_weights_ptr,
+    const float* cell_to_input_weights_ptr,
+    const float* cell_to_forget_weights_ptr,
+    const float* cell_to_output_weights_ptr, const float* input_gate_bias_ptr,
+    const float* forget_gate_bias_ptr, const float* cell_bias_ptr,
+    const float* output_gate_bias_ptr, const float* projection_weights_ptr,
+    const float* projection_bias_ptr, const TfLiteLSTMParams* params,
+    int n_batch, int n_cell, int n_input, int n_output,
+    float* output_state_ptr, float* cell_state_ptr, float* input_gate_scratch,
+    float* forget_gate_scratch, float* cell_scratch,
+    float* output_gate_scratch, float* output_ptr_batch);
+
+// Same as LstmStep(), for the hybrid LSTM whose weight matrices hold int8
+// values, each with its own scale, while the peephole weights, the biases and
+// the activations are float. The input, the output_state and the gated output
+// are quantized on the fly into 'quantized_scratch', which holds the largest
+// of 'n_batch * n_input', 'n_batch * n_output' and 'n_batch * n_cell'
+// elements. 'scaling_factors' and 'product_scaling_factors' hold 'n_batch'
+// elements each.
+void HybridLstmStep(
+    const float* input_ptr_batch, const int8_t* input_to_input_weights_ptr,
+    float input_to_input_weights_scale,
+    const int8_t* input_to_forget_weights_ptr,
+    float input_to_forget_weights_scale,
+    const int8_t* input_to_cell_weights_ptr, float input_to_cell_weights_scale,
+    const int8_t* input_to_output_weights_ptr,
+    float input_to_output_weights_scale,
+    const int8_t* recurrent_to_input_weights_ptr,
+    float recurrent_to_input_weights_scale,
+    const int8_t* recurrent_to_forget_weights_ptr,
+    float recurrent_to_forget_weights_scale,
+    const int8_t* recurrent_to_cell_weights_ptr,
+    float recurrent_to_cell_weights_scale,
+    const int8_t* recurrent_to_output_weights_ptr,
+    float recurrent_to_output_weights_scale,
+    const float* cell_to_input_weights_ptr,
+    const float* cell_to_forget_weights_ptr,
+    const float* cell_to_output_weights_ptr, const float* input_gate_bias_ptr,
+    const float* forget_gate_bias_ptr, const float* cell_bias_ptr,
+    const float* output_gate_bias_ptr, const int8_t* projection_weights_ptr,
+    float projection_weights_scale, const float* projection_bias_ptr,
+    const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
+    int n_output, float* output_state_ptr, float* cell_state_ptr,
+    float* input_gate_scratch, float* forget_gate_scratch, float* cell_scratch,
+    float* output_gate_scratch, float* scaling_factors,
+    float* product_scaling_factors, int8_t* quantized_scratch,
+    float* output_ptr_batch);
+
+// Performs one time step of an SVDF layer for 'n_batch' inputs of
+// 'input_size' elements each. 'state_ptr_batch' holds 'memory_size' elements
+// for each of the 'num_filters' filters of every batch, and is shifted left in
+// place. Each filter is reduced into its unit while its memory is still in
+// cache, so no scratch buffer is needed. 'bias_ptr' may be null.
+// 'output_ptr_batch' receives 'n_batch' rows of 'num_filters / params->rank'
+// elements.
+void SvdfStep(const float* input_ptr_batch, const float* weights_feature_ptr,
+              const float* weights_time_ptr, const float* bias_ptr,
+              const TfLiteSVDFParams* params, int n_batch, int input_size,
+              int num_filters, int memory_size, float* state_ptr_batch,
+              float* output_ptr_batch);
+
+}  // namespace kernel_utils
+}  // namespace tflite
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_KERNEL_UTILS_H_
@@ -0,0 +1,371 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/internal/kernel_utils.h"
+#include <gmock/gmock.h>
+#include "tensorflow/contrib/lite/builtin_op_data.h"
+#include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
+#include "tensorflow/contrib/lite/kernels/test_util.h"
+
+namespace tflite {
+namespace kernel_utils {
+namespace {
+
+using tensor_utils::ApplyActivationToVector;
+using tensor_utils::ApplySigmoidToVector;
+using tensor_utils::BatchVectorBatchVectorDotProduct;
+using tensor_utils::ClipVector;
+using tensor_utils::CopyVector;
+using tensor_utils::MatrixBatchVectorMultiplyAccumulate;
+using tensor_utils::ReductionSumVector;
+using tensor_utils::Sub1Vector;
+using tensor_utils::SymmetricQuantizeFloats;
+using tensor_utils::VectorBatchVectorAssign;
+using tensor_utils::VectorBatchVectorCwiseProductAccumulate;
+using tensor_utils::VectorShiftLeft;
+using tensor_utils::VectorVectorCwiseProduct;
+using tensor_utils::VectorVectorCwiseProductAccumulate;
+
+// Returns 'size' deterministic values in [-1, 1).
+std::vector<float> Values(int size, int seed) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) {
+    values[i] = ((seed * 37 + i * 13) % 64) / 32.0f - 1.0f;
+  }
+  return values;
+}
+
+// Weights, biases and state of an LSTM cell, with empty vectors for the
+// tensors that aren't used.
+struct LstmData {
+  LstmData(int n_batch, int n_input, int n_cell, int n_output, bool use_cifg,
+           bool use_peephole, bool use_projection)
+      : n_batch(n_batch), n_input(n_input), n_cell(n_cell), n_output(n_output) {
+    int seed = 0;
+    for (int g = 0; g < 4; ++g) {
+      const bool used = !(use_cifg && g == 0);
+      if (used) {
+        input_weights[g] = Values(n_cell * n_input, ++seed);
+        recurrent_weights[g] = Values(n_cell * n_output, ++seed);
+        bias[g] = Values(n_cell, ++seed);
+      }
+      if (used && use_peephole) cell_weights[g] = Values(n_cell, ++seed);
+    }
+    if (use_projection) {
+      projection_weights = Values(n_output * n_cell, ++seed);
+      projection_bias = Values(n_output, ++seed);
+    }
+    output_state = Values(n_batch * n_output, ++seed);
+    cell_state = Values(n_batch * n_cell, ++seed);
+  }
+
+  static const float* Data(const std::vector<float>& v) {
+    return v.empty() ? nullptr : v.data();
+  }
+
+  int n_batch, n_input, n_cell, n_output;
+  // Indexed by gate: input, forget, cell and output.
+  std::vector<float> input_weights[4];
+  std::vector<float> recurrent_weights[4];
+  std::vector<float> cell_weights[4];
+  std::vector<float> bias[4];
+  std::vector<float> projection_weights;
+  std::vector<float> projection_bias;
+  std::vector<float> output_state;
+  std::vector<float> cell_state;
+};
+
+// Runs LstmStep() on 'data', updating its state, and returns the output.
+std::vector<float> RunLstmStep(const std::vector<float>& input,
+                               const TfLiteLSTMParams& params, LstmData* data) {
+  std::vector<std::vector<float>> scratch(
+      4, std::vector<float>(data->n_batch * data->n_cell));
+  std::vector<float> output(data->n_batch * data->n_output);
+  auto d = &LstmData::Data;
+  LstmStep(input.data(), d(data->input_weights[0]),
+           d(data->input_weights[1]), d(data->input_weights[2]),
+           d(data->input_weights[3]), d(data->recurrent_weights[0]),
+           d(data->recurrent_weights[1]), d(data->recurrent_weights[2]),
+           d(data->recurrent_weights[3]), d(data->cell_weights[0]),
+           d(data->cell_weights[1]), d(data->cell_weights[3]),
+           d(data->bias[0]), d(data->bias[1]), d(data->bias[2]),
+           d(data->bias[3]), d(data->projection_weights),
+           d(data->projection_bias), &params, data->n_batch, data->n_cell,
+           data->n_input, data->n_output, data->output_state.data(),
+           data->cell_state.data(), scratch[0].data(), scratch[1].data(),
+           scratch[2].data(), scratch[3].data(), output.data());
+  return output;
+}
+
+// Symmetrically quantized weights, with a null pointer for empty vectors.
+struct QuantizedWeights {
+  explicit QuantizedWeights(const std::vector<float>& values)
+      : quantized(values.size()), scale(1.0f) {
+    if (!values.empty()) {
+      SymmetricQuantizeFloats(values.data(), values.size(), quantized.data(),
+                              &scale);
+    }
+  }
+  const int8_t* data() const {
+    return quantized.empty() ? nullptr : quantized.data();
+  }
+
+  std::vector<int8_t> quantized;
+  float scale;
+};
+
+// Runs HybridLstmStep() on 'data' with its weights quantized, updating its
+// state, and returns the output.
+std::vector<float> RunHybridLstmStep(const std::vector<float>& input,
+                                     const TfLiteLSTMParams& params,
+                                     LstmData* data) {
+  std::vector<QuantizedWeights> input_weights, recurrent_weights;
+  for (int g = 0; g < 4; ++g) {
+    input_weights.emplace_back(data->input_weights[g]);
+    recurrent_weights.emplace_back(data->recurrent_weights[g]);
+  }
+  const QuantizedWeights projection_weights(data->projection_weights);
+  std::vector<std::vector<float>> scratch(
+      4, std::vector<float>(data->n_batch * data->n_cell));
+  std::vector<float> scaling_factors(data->n_batch);
+  std::vector<float> product_scaling_factors(data->n_batch);
+  std::vector<int8_t> quantized_scratch(
+      data->n_batch *
+      std::max(data->n_input, std::max(data->n_output, data->n_cell)));
+  std::vector<float> output(data->n_batch * data->n_output);
+  auto d = &LstmData::Data;
+  HybridLstmStep(
+      input.data(), input_weights[0].data(), input_weights[0].scale,
+      input_weights[1].data(), input_weights[1].scale, input_weights[2].data(),
+      input_weights[2].scale, input_weights[3].data(), input_weights[3].scale,
+      recurrent_weights[0].data(), recurrent_weights[0].scale,
+      recurrent_weights[1].data(), recurrent_weights[1].scale,
+      recurrent_weights[2].data(), recurrent_weights[2].scale,
+      recurrent_weights[3].data(), recurrent_weights[3].scale,
+      d(data->cell_weights[0]), d(data->cell_weights[1]),
+      d(data->cell_weights[3]), d(data->bias[0]), d(data->bias[1]),
+      d(data->bias[2]), d(data->bias[3]), projection_weights.data(),
+      projection_weights.scale, d(data->projection_bias), &params,
+      data->n_batch, data->n_cell, data->n_input, data->n_output,
+      data->output_state.data(), data->cell_state.data(), scratch[0].data(),
+      scratch[1].data(), scratch[2].data(), scratch[3].data(),
+      scaling_factors.data(), product_scaling_factors.data(),
+      quantized_scratch.data(), output.data());
+  return output;
+}
+
+// The same step, with one tensor_utils call per gate and operation.
+std::vector<float> RunReferenceLstmStep(const std::vector<float>& input,
+                                        const TfLiteLSTMParams& params,
+                                        LstmData* data) {
+  const int n_batch = data->n_batch;
+  const int n_cell = data->n_cell;
+  const int n_output = data->n_output;
+  const bool use_cifg = data->input_weights[0].empty();
+  const bool use_peephole = !data->cell_weights[3].empty();
+  std::vector<std::vector<float>> gates(4,
+                                        std::vector<float>(n_batch * n_cell));
+  for (int g = use_cifg ? 1 : 0; g < 4; ++g) {
+    VectorBatchVectorAssign(data->bias[g].data(), n_cell, n_batch,
+                            gates[g].data());
+    MatrixBatchVectorMultiplyAccumulate(data->input_weights[g].data(), n_cell,
+                                        data->n_input, input.data(), n_batch,
+                                        gates[g].data(), /*result_stride=*/1);
+  }
+  for (int g = use_cifg ? 1 : 0; g < 4; ++g) {
+    MatrixBatchVectorMultiplyAccumulate(
+        data->recurrent_weights[g].data(), n_cell, n_output,
+        data->output_state.data(), n_batch, gates[g].data(),
+        /*result_stride=*/1);
+  }
+  float* cell_state = data->cell_state.data();
+  for (int g : {0, 1}) {
+    if (use_cifg && g == 0) continue;
+    if (use_peephole) {
+      VectorBatchVectorCwiseProductAccumulate(data->cell_weights[g].data(),
+                                              n_cell, cell_state, n_batch,
+                                              gates[g].data());
+    }
+    ApplySigmoidToVector(gates[g].data(), n_cell * n_batch, gates[g].data());
+  }
+  const int size = n_batch * n_cell;
+  VectorVectorCwiseProduct(gates[1].data(), cell_state, size, cell_state);
+  ApplyActivationToVector(gates[2].data(), size, params.activation,
+                          gates[2].data());
+  if (use_cifg) Sub1Vector(gates[1].data(), size, gates[0].data());
+  VectorVectorCwiseProductAccumulate(gates[2].data(), gates[0].data(), size,
+                                     cell_state);
+  if (params.cell_clip > 0.0) {
+    ClipVector(cell_state, size, params.cell_clip, cell_state);
+  }
+  if (use_peephole) {
+    VectorBatchVectorCwiseProductAccumulate(data->cell_weights[3].data(),
+                                            n_cell, cell_state, n_batch,
+                                            gates[3].data());
+  }
+  ApplySigmoidToVector(gates[3].data(), size, gates[3].data());
+  ApplyActivationToVector(cell_state, size, params.activation,
+                          gates[2].data());
+  VectorVectorCwiseProduct(gates[3].data(), gates[2].data(), size,
+                           gates[3].data());
+
+  std::vector<float> output(n_batch * n_output);
+  if (!data->projection_weights.empty()) {
+    VectorBatchVectorAssign(data->projection_bias.data(), n_output, n_batch,
+                            output.data());
+    MatrixBatchVectorMultiplyAccumulate(data->projection_weights.data(),
+                                        n_output, n_cell, gates[3].data(),
+                                        n_batch, output.data(),
+                                        /*result_stride=*/1);
+    if (params.proj_clip > 0.0) {
+      ClipVector(output.data(), output.size(), params.proj_clip,
+                 output.data());
+    }
+  } else {
+    CopyVector(gates[3].data(), output.size(), output.data());
+  }
+  CopyVector(output.data(), output.size(), data->output_state.data());
+  return output;
+}
+
+void ExpectLstmStepMatchesReference(bool use_cifg, bool use_peephole,
+                                    bool use_projection) {
+  const int n_batch = 2;
+  const int n_input = 5;
+  const int n_cell = 7;
+  const int n_output = use_projection ? 3 : n_cell;
+  TfLiteLSTMParams params = {kTfLiteActTanh, /*cell_clip=*/0.8,
+                             /*proj_clip=*/use_projection ? 0.9f : 0.0f};
+  LstmData data(n_batch, n_input, n_cell, n_output, use_cifg, use_peephole,
+                use_projection);
+  LstmData reference_data = data;
+  // Run a few steps, so that the state is carried over.
+  for (int step = 0; step < 3; ++step) {
+    const std::vector<float> input = Values(n_batch * n_input, 100 + step);
+    const std::vector<float> expected =
+        RunReferenceLstmStep(input, params, &reference_data);
+    EXPECT_THAT(RunLstmStep(input, params, &data),
+                ElementsAreArray(ArrayFloatNear(expected)));
+    EXPECT_THAT(data.cell_state,
+                ElementsAreArray(ArrayFloatNear(reference_data.cell_state)));
+    EXPECT_THAT(data.output_state,
+                ElementsAreArray(ArrayFloatNear(reference_data.output_state)));
+  }
+}
+
+// The hybrid step only differs from the float one by the quantization error.
+void ExpectHybridLstmStepMatchesFloat(bool use_cifg, bool use_peephole,
+                                      bool use_projection) {
+  const int n_batch = 2;
+  const int n_input = 18;
+  const int n_cell = 7;
+  const int n_output = use_projection ? 3 : n_cell;
+  TfLiteLSTMParams params = {kTfLiteActTanh, /*cell_clip=*/0.8,
+                             /*proj_clip=*/use_projection ? 0.9f : 0.0f};
+  LstmData data(n_batch, n_input, n_cell, n_output, use_cifg, use_peephole,
+                use_projection);
+  LstmData float_data = data;
+  for (int step = 0; step < 3; ++step) {
+    const std::vector<float> input = Values(n_batch * n_input, 100 + step);
+    const std::vector<float> expected =
+        RunLstmStep(input, params, &float_data);
+    EXPECT_THAT(RunHybridLstmStep(input, params, &data),
+                ElementsAreArray(ArrayFloatNear(expected, 0.05)));
+    EXPECT_THAT(data.cell_state,
+                ElementsAreArray(ArrayFloatNear(float_data.cell_state, 0.05)));
+  }
+}
+
+TEST(KernelUtilsTest, LstmStep) {
+  ExpectLstmStepMatchesReference(/*use_cifg=*/false, /*use_peephole=*/false,
+                                 /*use_projection=*/false);
+}
+
+TEST(KernelUtilsTest, LstmStepWithCifgPeepholeAndProjection) {
+  ExpectLstmStepMatchesReference(/*use_cifg=*/true, /*use_peephole=*/true,
+                                 /*use_projection=*/true);
+}
+
+TEST(KernelUtilsTest, LstmStepWithPeepholeAndProjection) {
+  ExpectLstmStepMatchesReference(/*use_cifg=*/false, /*use_peephole=*/true,
+                                 /*use_projection=*/true);
+}
+
+TEST(KernelUtilsTest, HybridLstmStep) {
+  ExpectHybridLstmStepMatchesFloat(/*use_cifg=*/false, /*use_peephole=*/false,
+                                   /*use_projection=*/false);
+}
+
+TEST(KernelUtilsTest, HybridLstmStepWithCifgPeepholeAndProjection) {
+  ExpectHybridLstmStepMatchesFloat(/*use_cifg=*/true, /*use_peephole=*/true,
+                                   /*use_projection=*/true);
+}
+
+TEST(KernelUtilsTest, SvdfStep) {
+  const int n_batch = 2;
+  const int input_size = 3;
+  const int rank = 2;
+  const int num_units = 3;
+  const int num_filters = rank * num_units;
+  const int memory_size = 5;
+  TfLiteSVDFParams params = {rank, kTfLiteActRelu};
+  const std::vector<float> weights_feature =
+      Values(num_filters * input_size, 1);
+  const std::vector<float> weights_time = Values(num_filters * memory_size, 2);
+  const std::vector<float> bias = Values(num_units, 3);
+  std::vector<float> state(n_batch * num_filters * memory_size, 0.0);
+  std::vector<float> reference_state = state;
+
+  for (int step = 0; step < 4; ++step) {
+    const std::vector<float> input = Values(n_batch * input_size, 10 + step);
+    std::vector<float> output(n_batch * num_units);
+    SvdfStep(input.data(), weights_feature.data(), weights_time.data(),
+             bias.data(), &params, n_batch, input_size, num_filters,
+             memory_size, state.data(), output.data());
+
+    // The same step, with a scratch buffer for the filter outputs.
+    for (int b = 0; b < n_batch; ++b) {
+      for (int f = 0; f < num_filters; ++f) {
+        reference_state[(b * num_filters + f + 1) * memory_size - 1] = 0;
+      }
+    }
+    MatrixBatchVectorMultiplyAccumulate(
+        weights_feature.data(), num_filters, input_size, input.data(), n_batch,
+        &reference_state[memory_size - 1], memory_size);
+    std::vector<float> scratch(n_batch * num_filters);
+    std::vector<float> expected(n_batch * num_units);
+    VectorBatchVectorAssign(bias.data(), num_units, n_batch, expected.data());
+    for (int b = 0; b < n_batch; ++b) {
+      float* state_ptr = &reference_state[b * num_filters * memory_size];
+      BatchVectorBatchVectorDotProduct(weights_time.data(), state_ptr,
+                                       memory_size, num_filters,
+                                       &scratch[b * num_filters],
+                                       /*result_stride=*/1);
+      ReductionSumVector(&scratch[b * num_filters], &expected[b * num_units],
+                         num_units, rank);
+      ApplyActivationToVector(&expected[b * num_units], num_units,
+                              params.activation, &expected[b * num_units]);
+      for (int f = 0; f < num_filters; ++f) {
+        VectorShiftLeft(state_ptr + f * memory_size, memory_size, 0.0);
+      }
+    }
+
+    EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(expected)));
+    EXPECT_THAT(state, ElementsAreArray(ArrayFloatNear(reference_state)));
+  }
+}
+
+}  // namespace
+}  // namespace kernel_utils
+}  // namespace tflite
@@ -0,0 +1,336 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_MULTITHREADED_OPS_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_MULTITHREADED_OPS_H_
+
+#include <algorithm>
+
+#include "tensorflow/contrib/lite/kernels/internal/optimized/depthwiseconv_float.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/contrib/lite/kernels/internal/types.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
+
+namespace tflite {
+namespace multithreaded_ops {
+
+// These ops split their output into independent slices and run the
+// single-threaded optimized_ops implementation on each slice, on the threads
+// of 'thread_pool'. Every output value is computed exactly as in
+// optimized_ops, so results don't depend on the number of threads. Passing a
+// null pool, or a pool with one thread, runs optimized_ops directly.
+
+// The least amount of work, in multiply-adds or element visits, worth handing
+// to one thread.
+constexpr int kMinCostPerThread = 1 << 15;
+
+inline int MinBlockSize(int cost_per_item) {
+  return std::max(1, kMinCostPerThread / std::max(1, cost_per_item));
+}
+
+inline bool IsSingleThreaded(ThreadPool* thread_pool) {
+  return thread_pool == nullptr || thread_pool->NumThreads() <= 1;
+}
+
+inline Dims<4> PackedDims(int depth, int width, int height, int batches) {
+  Dims<4> dims;
+  dims.sizes[0] = depth;
+  dims.sizes[1] = width;
+  dims.sizes[2] = height;
+  dims.sizes[3] = batches;
+  dims.strides[0] = 1;
+  for (int d = 1; d < 4; ++d) {
+    dims.strides[d] = dims.strides[d - 1] * dims.sizes[d - 1];
+  }
+  return dims;
+}
+
+// Describes the part of a windowed op (convolution or pooling) that produces
+// output rows [output_row, output_row + output_dims.sizes[2]) of one batch:
+// the input rows it reads, starting at 'input_offset', and the top padding
+// that makes the slice line up with the full op. The padding is negative when
+// the slice starts below the last input row.
+struct RowSlice {
+  int input_offset;
+  Dims<4> input_dims;
+  int pad_height;
+  int output_offset;
+  Dims<4> output_dims;
+};
+
+inline RowSlice MakeRowSlice(const Dims<4>& input_dims,
+                             const Dims<4>& output_dims, int stride_height,
+                             int pad_height, int window_height, int batch,
+                             int output_row, int num_output_rows) {
+  const int input_height = ArraySize(input_dims, 2);
+  const int first_input_row = output_row * stride_height - pad_height;
+  const int last_input_row =
+      (output_row + num_output_rows - 1) * stride_height - pad_height +
+      window_height - 1;
+  const int input_start =
+      std::min(std::max(first_input_row, 0), input_height - 1);
+  const int input_end = std::max(std::min(last_input_row + 1, input_height),
+                                 input_start + 1);
+
+  RowSlice slice;
+  slice.input_offset =
+      batch * input_dims.strides[3] + input_start * input_dims.strides[2];
+  slice.input_dims = input_dims;
+  slice.input_dims.sizes[2] = input_end - input_start;
+  slice.input_dims.sizes[3] = 1;
+  slice.pad_height = input_start - first_input_row;
+  slice.output_offset =
+      batch * output_dims.strides[3] + output_row * output_dims.strides[2];
+  slice.output_dims = output_dims;
+  slice.output_dims.sizes[2] = num_output_rows;
+  slice.output_dims.sizes[3] = 1;
+  return slice;
+}
+
+// Calls fn(slice) for slices of consecutive output rows within a batch,
+// spread over the threads of 'thread_pool'.
+template <typename SliceFn>
+void ForEachRowSlice(ThreadPool* thread_pool, const Dims<4>& input_dims,
+                     const Dims<4>& output_dims, int stride_height,
+                     int pad_height, int window_height, int cost_per_row,
+                     const SliceFn& fn) {
+  const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
+  const int output_height = ArraySize(output_dims, 2);
+  thread_pool->ParallelFor(
+      batches * output_height, MinBlockSize(cost_per_row),
+      [&](int start, int end) {
+        while (start < end) {
+          const int batch = start / output_height;
+          const int row = start % output_height;
+          const int num_rows = std::min(end - start, output_height - row);
+          fn(MakeRowSlice(input_dims, output_dims, stride_height, pad_height,
+                          window_height, batch, row, num_rows));
+          start += num_rows;
+        }
+      });
+}
+
+inline void DepthwiseConv(ThreadPool* thread_pool, const float* input_data,
+                          const Dims<4>& input_dims, const float* filter_data,
+                          const Dims<4>& filter_dims, const float* bias_data,
+                          const Dims<4>& bias_dims, int stride_width,
+                          int stride_height, int pad_width, int pad_height,
+                          int depth_multiplier, float output_activation_min,
+                          float output_activation_max, float* output_data,
+                          const Dims<4>& output_dims) {
+  if (IsSingleThreaded(thread_pool)) {
+    optimized_ops::DepthwiseConv(
+        input_data, input_dims, filter_data, filter_dims, bias_data, bias_dims,
+        stride_width, stride_height, pad_width, pad_height, depth_multiplier,
+        output_activation_min, output_activation_max, output_data,
+        output_dims);
+    return;
+  }
+  const int filter_height = ArraySize(filter_dims, 2);
+  const int cost_per_row = ArraySize(output_dims, 1) *
+                           ArraySize(output_dims, 0) * filter_height *
+                           ArraySize(filter_dims, 1);
+  ForEachRowSlice(
+      thread_pool, input_dims, output_dims, stride_height, pad_height,
+      filter_height, cost_per_row, [&](const RowSlice& slice) {
+        optimized_ops::DepthwiseConv(
+            input_data + slice.input_offset, slice.input_dims, filter_data,
+            filter_dims, bias_data, bias_dims, stride_width, stride_height,
+            pad_width, slice.pad_height, depth_multiplier,
+            output_activation_min, output_activation_max,
+            output_data + slice.output_offset, slice.output_dims);
+      });
+}
+
+inline void DepthwiseSeparableConv(
+    ThreadPool* thread_pool, const float* input_data,
+    const Dims<4>& input_dims, const float* depthwise_filter_data,
+    const Dims<4>& depthwise_filter_dims, const float* depthwise_bias_data,
+    const Dims<4>& depthwise_bias_dims, const float* pointwise_filter_data,
+    const Dims<4>& pointwise_filter_dims, const float* pointwise_bias_data,
+    const Dims<4>& pointwise_bias_dims, int stride_width, int stride_height,
+    int pad_width, int pad_height, int depth_multiplier,
+    float depthwise_activation_min, float depthwise_activation_max,
+    float output_activation_min, float output_activation_max,
+    float* output_data, const Dims<4>& output_dims) {
+  if (IsSingleThreaded(thread_pool)) {
+    optimized_ops::DepthwiseSeparableConv(
+        input_data, input_dims, depthwise_filter_data, depthwise_filter_dims,
+        depthwise_bias_data, depthwise_bias_dims, pointwise_filter_data,
+        pointwise_filter_dims, pointwise_bias_data, pointwise_bias_dims,
+        stride_width, stride_height, pad_width, pad_height, depth_multiplier,
+        depthwise_activation_min, depthwise_activation_max,
+        output_activation_min, output_activation_max, output_data,
+        output_dims);
+    return;
+  }
+  const int filter_height = ArraySize(depthwise_filter_dims, 2);
+  const int depthwise_depth = ArraySize(depthwise_filter_dims, 0);
+  const int cost_per_row =
+      ArraySize(output_dims, 1) * depthwise_depth *
+      (filter_height * ArraySize(depthwise_filter_dims, 1) +
+       ArraySize(output_dims, 0));
+  ForEachRowSlice(
+      thread_pool, input_dims, output_dims, stride_height, pad_height,
+      filter_height, cost_per_row, [&](const RowSlice& slice) {
+        optimized_ops::DepthwiseSeparableConv(
+            input_data + slice.input_offset, slice.input_dims,
+            depthwise_filter_data, depthwise_filter_dims, depthwise_bias_data,
+            depthwise_bias_dims, pointwise_filter_data, pointwise_filter_dims,
+            pointwise_bias_data, pointwise_bias_dims, stride_width,
+            stride_height, pad_width, slice.pad_height, depth_multiplier,
+            depthwise_activation_min, depthwise_activation_max,
+            output_activation_min, output_activation_max,
+            output_data + slice.output_offset, slice.output_dims);
+      });
+}
+
+// Pooling ops share a signature, so they are split in the same way.
+typedef void (*FloatPoolFunction)(const float*, const Dims<4>&, int, int, int,
+                                  int, int, int, float, float, float*,
+                                  const Dims<4>&);
+
+inline void Pool(FloatPoolFunction pool, ThreadPool* thread_pool,
+                 const float* input_data, const Dims<4>& input_dims,
+                 int stride_width, int stride_height, int pad_width,
+                 int pad_height, int kwidth, int kheight,
+                 float output_activation_min, float output_activation_max,
+                 float* output_data, const Dims<4>& output_dims) {
+  if (IsSingleThreaded(thread_pool)) {
+    pool(input_data, input_dims, stride_width, stride_height, pad_width,
+         pad_height, kwidth, kheight, output_activation_min,
+         output_activation_max, output_data, output_dims);
+    return;
+  }
+  const int cost_per_row =
+      ArraySize(output_dims, 1) * ArraySize(output_dims, 0) * kwidth * kheight;
+  ForEachRowSlice(thread_pool, input_dims, output_dims, stride_height,
+                  pad_height, kheight, cost_per_row,
+                  [&](const RowSlice& slice) {
+                    pool(input_data + slice.input_offset, slice.input_dims,
+                         stride_width, stride_height, pad_width,
+                         slice.pad_height, kwidth, kheight,
+                         output_activation_min, output_activation_max,
+                         output_data + slice.output_offset, slice.output_dims);
+                  });
+}
+
+inline void AveragePool(ThreadPool* thread_pool, const float* input_data,
+                        const Dims<4>& input_dims, int stride_width,
+                        int stride_height, int pad_width, int pad_height,
+                        int kwidth, int kheight, float output_activation_min,
+                        float output_activation_max, float* output_data,
+                        const Dims<4>& output_dims) {
+  Pool(&optimized_ops::AveragePool, thread_pool, input_data, input_dims,
+       stride_width, stride_height, pad_width, pad_height, kwidth, kheight,
+       output_activation_min, output_activation_max, output_data, output_dims);
+}
+
+inline void MaxPool(ThreadPool* thread_pool, const float* input_data,
+                    const Dims<4>& input_dims, int stride_width,
+                    int stride_height, int pad_width, int pad_height,
+                    int kwidth, int kheight, float output_activation_min,
+                    float output_activation_max, float* output_data,
+                    const Dims<4>& output_dims) {
+  Pool(&optimized_ops::MaxPool, thread_pool, input_data, input_dims,
+       stride_width, stride_height, pad_width, pad_height, kwidth, kheight,
+       output_activation_min, output_activation_max, output_data, output_dims);
+}
+
+inline void L2Pool(ThreadPool* thread_pool, const float* input_data,
+                   const Dims<4>& input_dims, int stride_width,
+                   int stride_height, int pad_width, int pad_height,
+                   int filter_width, int filter_height,
+                   float output_activation_min, float output_activation_max,
+                   float* output_data, const Dims<4>& output_dims) {
+  Pool(&optimized_ops::L2Pool, thread_pool, input_data, input_dims,
+       stride_width, stride_height, pad_width, pad_height, filter_width,
+       filter_height, output_activation_min, output_activation_max,
+       output_data, output_dims);
+}
+
+// Element-wise ops on packed arrays are split into flat ranges.
+typedef void (*FloatBinaryFunction)(const float*, const Dims<4>&, const float*,
+                                    const Dims<4>&, float, float, float*,
+                                    const Dims<4>&);
+
+inline void ElementWise(FloatBinaryFunction op, ThreadPool* thread_pool,
+                        const float* input1_data, const Dims<4>& input1_dims,
+                        const float* input2_data, const Dims<4>& input2_dims,
+                        float output_activation_min,
+                        float output_activation_max, float* output_data,
+                        const Dims<4>& output_dims) {
+  if (IsSingleThreaded(thread_pool)) {
+    op(input1_data, input1_dims, input2_data, input2_dims,
+       output_activation_min, output_activation_max, output_data,
+       output_dims);
+    return;
+  }
+  TFLITE_DCHECK(IsPackedWithoutStrides(input1_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(input2_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(output_dims));
+  const int size = RequiredBufferSizeForDims(output_dims);
+  thread_pool->ParallelFor(size, MinBlockSize(1), [&](int start, int end) {
+    const Dims<4> dims = PackedDims(end - start, 1, 1, 1);
+    op(input1_data + start, dims, input2_data + start, dims,
+       output_activation_min, output_activation_max, output_data + start,
+       dims);
+  });
+}
+
+inline void Add(ThreadPool* thread_pool, const float* input1_data,
+                const Dims<4>& input1_dims, const float* input2_data,
+                const Dims<4>& input2_dims, float output_activation_min,
+                float output_activation_max, float* output_data,
+                const Dims<4>& output_dims) {
+  ElementWise(&optimized_ops::Add, thread_pool, input1_data, input1_dims,
+              input2_data, input2_dims, output_activation_min,
+              output_activation_max, output_data, output_dims);
+}
+
+inline void Mul(ThreadPool* thread_pool, const float* input1_data,
+                const Dims<4>& input1_dims, const float* input2_data,
+                const Dims<4>& input2_dims, float output_activation_min,
+                float output_activation_max, float* output_data,
+                const Dims<4>& output_dims) {
+  ElementWise(&optimized_ops::Mul, thread_pool, input1_data, input1_dims,
+              input2_data, input2_dims, output_activation_min,
+              output_activation_max, output_data, output_dims);
+}
+
+// Softmax is computed independently for every pixel, over the depth.
+inline void Softmax(ThreadPool* thread_pool, const float* input_data,
+                    const Dims<4>& input_dims, float beta, float* output_data,
+                    const Dims<4>& output_dims) {
+  if (IsSingleThreaded(thread_pool)) {
+    optimized_ops::Softmax(input_data, input_dims, beta, output_data,
+                           output_dims);
+    return;
+  }
+  TFLITE_DCHECK(IsPackedWithoutStrides(input_dims));
+  TFLITE_DCHECK(IsPackedWithoutStrides(output_dims));
+  const int depth = MatchingArraySize(input_dims, 0, output_dims, 0);
+  const int num_pixels = RequiredBufferSizeForDims(output_dims) / depth;
+  thread_pool->ParallelFor(
+      num_pixels, MinBlockSize(depth), [&](int start, int end) {
+        const Dims<4> dims = PackedDims(depth, end - start, 1, 1);
+        optimized_ops::Softmax(input_data + start * depth, dims, beta,
+                               output_data + start * depth, dims);
+      });
+}
+
+}  // namespace multithreaded_ops
+}  // namespace tflite
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_OPTIMIZED_MULTITHREADED_OPS_H_
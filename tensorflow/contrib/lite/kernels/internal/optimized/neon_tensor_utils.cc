@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <string.h>
+#include <algorithm>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
@@ -22,6 +23,7 @@ limitations under the License.
 
 #include <arm_neon.h>
 #define kFloatWeightsPerNeonLane 4
+#define kInt8WeightsPerNeonLane 16
 
 namespace tflite {
 namespace tensor_utils {
@@ -112,6 +114,95 @@ void NeonMatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
   delete[] vector_cache_float32x4;
 }
 
+void NeonMultiMatrixBatchVectorMultiplyAccumulate(
+    const float* const* matrices, int n_matrices, int m_rows, int m_cols,
+    const float* vector, int n_batch, float* const* results) {
+  // If v_size is not divisible by kWeightsPerNeonLane, we cannot use the main
+  // vectorized loop, and we need to process sequentially. postamble_start shows
+  // the start index where this should happen.
+  const int postamble_start =
+      m_cols - (m_cols & (kFloatWeightsPerNeonLane - 1));
+
+  // Every chunk of the vector is loaded once and multiplied with the same row
+  // of up to four matrices, which all accumulate in registers.
+  const int kMaxMatricesPerPass = 4;
+  for (int first = 0; first < n_matrices; first += kMaxMatricesPerPass) {
+    const int n = std::min(kMaxMatricesPerPass, n_matrices - first);
+    for (int b = 0; b < n_batch; b++) {
+      const float* vector_in_batch = vector + b * m_cols;
+      for (int r = 0; r < m_rows; r++) {
+        const float* matrix_ptr[kMaxMatricesPerPass];
+        float32x4_t acc_32x4[kMaxMatricesPerPass];
+        for (int i = 0; i < n; i++) {
+          matrix_ptr[i] = matrices[first + i] + r * m_cols;
+          acc_32x4[i] = vmovq_n_f32(0.0);
+        }
+        for (int c = 0; c < postamble_start; c += kFloatWeightsPerNeonLane) {
+          const float32x4_t vector_f32x4 = vld1q_f32(vector_in_batch + c);
+          for (int i = 0; i < n; i++) {
+            acc_32x4[i] = vmlaq_f32(acc_32x4[i], vld1q_f32(matrix_ptr[i] + c),
+                                    vector_f32x4);
+          }
+        }
+        // Add up the lanes as NeonMatrixBatchVectorMultiplyAccumulate() does,
+        // so that both give the same results.
+        for (int i = 0; i < n; i++) {
+          float* result = results[first + i] + b * m_rows + r;
+          *result +=
+              (vgetq_lane_f32(acc_32x4[i], 0) + vgetq_lane_f32(acc_32x4[i], 1) +
+               vgetq_lane_f32(acc_32x4[i], 2) + vgetq_lane_f32(acc_32x4[i], 3));
+          for (int c = postamble_start; c < m_cols; c++) {
+            *result += matrix_ptr[i][c] * vector_in_batch[c];
+          }
+        }
+      }
+    }
+  }
+}
+
+void NeonMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride) {
+  // If m_cols is not divisible by kInt8WeightsPerNeonLane, we cannot use the
+  // main vectorized loop, and we need to process sequentially.
+  // postamble_start shows the start index where this should happen.
+  const int postamble_start =
+      m_cols - (m_cols & (kInt8WeightsPerNeonLane - 1));
+
+  float* result_in_batch = result;
+  for (int b = 0; b < n_batch; b++) {
+    const float batch_scaling_factor = scaling_factors[b];
+    const int8_t* vector_in_batch = vectors + b * m_cols;
+    const int8_t* matrix_ptr = matrix;
+    for (int r = 0; r < m_rows; r++) {
+      // Values are in [-127, 127], so the sum of two products fits in int16
+      // and is then pairwise added into the int32 accumulator.
+      int32x4_t dotprod_32x4 = vmovq_n_s32(0);
+      for (int c = 0; c < postamble_start; c += kInt8WeightsPerNeonLane) {
+        const int8x16_t matrix_8x16 = vld1q_s8(matrix_ptr + c);
+        const int8x16_t vector_8x16 = vld1q_s8(vector_in_batch + c);
+        int16x8_t prod_16x8 =
+            vmull_s8(vget_low_s8(matrix_8x16), vget_low_s8(vector_8x16));
+        prod_16x8 = vmlal_s8(prod_16x8, vget_high_s8(matrix_8x16),
+                             vget_high_s8(vector_8x16));
+        dotprod_32x4 = vpadalq_s16(dotprod_32x4, prod_16x8);
+      }
+      int32_t dotprod = vgetq_lane_s32(dotprod_32x4, 0) +
+                        vgetq_lane_s32(dotprod_32x4, 1) +
+                        vgetq_lane_s32(dotprod_32x4, 2) +
+                        vgetq_lane_s32(dotprod_32x4, 3);
+      // Postamble loop.
+      for (int c = postamble_start; c < m_cols; c++) {
+        dotprod += static_cast<int32_t>(matrix_ptr[c]) * vector_in_batch[c];
+      }
+      *result_in_batch += dotprod * batch_scaling_factor;
+      result_in_batch += result_stride;
+      matrix_ptr += m_cols;
+    }
+  }
+}
+
 void NeonVectorVectorCwiseProduct(const float* vector1, const float* vector2,
                                   int v_size, float* result) {
   // If v_size is not divisible by kWeightsPerNeonLane, we cannot use the main
@@ -32,6 +32,30 @@ void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                    vector, n_batch, result, result_stride);
 }
 
+void MultiMatrixBatchVectorMultiplyAccumulate(const float* const* matrices,
+                                              int n_matrices, int m_rows,
+                                              int m_cols, const float* vector,
+                                              int n_batch,
+                                              float* const* results) {
+  NEON_OR_PORTABLE(MultiMatrixBatchVectorMultiplyAccumulate, matrices,
+                   n_matrices, m_rows, m_cols, vector, n_batch, results);
+}
+
+void SymmetricQuantizeFloats(const float* values, int size,
+                             int8_t* quantized_values, float* scaling_factor) {
+  PortableSymmetricQuantizeFloats(values, size, quantized_values,
+                                  scaling_factor);
+}
+
+void MatrixBatchVectorMultiplyAccumulate(const int8_t* matrix, int m_rows,
+                                         int m_cols, const int8_t* vectors,
+                                         const float* scaling_factors,
+                                         int n_batch, float* result,
+                                         int result_stride) {
+  NEON_OR_PORTABLE(MatrixBatchVectorMultiplyAccumulate, matrix, m_rows, m_cols,
+                   vectors, scaling_factors, n_batch, result, result_stride);
+}
+
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result) {
   NEON_OR_PORTABLE(VectorVectorCwiseProduct, vector1, vector2, v_size, result);
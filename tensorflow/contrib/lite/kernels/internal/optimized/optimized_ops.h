@@ -30,6 +30,7 @@ limitations under the License.
 #include "fixedpoint/fixedpoint.h"
 #include "public/gemmlowp.h"
 #include "tensorflow/contrib/lite/kernels/internal/common.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/depthwiseconv_float.h"
 #include "tensorflow/contrib/lite/kernels/internal/round.h"
 #include "tensorflow/contrib/lite/kernels/internal/types.h"
 
@@ -834,6 +835,103 @@ void Conv(const float* input_data, const Dims<4>& input_dims,
            output_dims, im2col_data, im2col_dims);
 }
 
+// A DepthwiseConv followed by a 1x1 Conv with stride 1, as found in
+// depthwise-separable blocks. The depthwise output is computed one tile of
+// pixels at a time in a local buffer, which the pointwise filter is applied
+// to while it is still in cache, so the intermediate activations are never
+// written to memory.
+inline void DepthwiseSeparableConv(
+    const float* input_data, const Dims<4>& input_dims,
+    const float* depthwise_filter_data, const Dims<4>& depthwise_filter_dims,
+    const float* depthwise_bias_data, const Dims<4>& depthwise_bias_dims,
+    const float* pointwise_filter_data, const Dims<4>& pointwise_filter_dims,
+    const float* pointwise_bias_data, const Dims<4>& pointwise_bias_dims,
+    int stride_width, int stride_height, int pad_width, int pad_height,
+    int depth_multiplier, float depthwise_activation_min,
+    float depthwise_activation_max, float output_activation_min,
+    float output_activation_max, float* output_data,
+    const Dims<4>& output_dims) {
+  gemmlowp::ScopedProfilingLabel label("DepthwiseSeparableConv");
+  const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
+  const int input_height = ArraySize(input_dims, 2);
+  const int input_width = ArraySize(input_dims, 1);
+  const int input_depth = ArraySize(input_dims, 0);
+  const int depthwise_depth = MatchingArraySize(
+      depthwise_filter_dims, 0, pointwise_filter_dims, 0);
+  const int filter_height = ArraySize(depthwise_filter_dims, 2);
+  const int filter_width = ArraySize(depthwise_filter_dims, 1);
+  const int output_depth =
+      MatchingArraySize(pointwise_filter_dims, 3, output_dims, 0);
+  const int output_height = ArraySize(output_dims, 2);
+  const int output_width = ArraySize(output_dims, 1);
+  TFLITE_DCHECK_EQ(depthwise_depth, input_depth * depth_multiplier);
+  TFLITE_DCHECK_EQ(ArraySize(pointwise_filter_dims, 1), 1);
+  TFLITE_DCHECK_EQ(ArraySize(pointwise_filter_dims, 2), 1);
+  TFLITE_DCHECK_EQ(ArraySize(depthwise_bias_dims, 0), depthwise_depth);
+  TFLITE_DCHECK_EQ(ArraySize(pointwise_bias_dims, 0), output_depth);
+  TFLITE_DCHECK_EQ(output_dims.strides[1], output_depth);
+
+  static const int kAccBufferMaxSize = 2048;
+  float acc_buffer[kAccBufferMaxSize];
+  TFLITE_DCHECK_GE(kAccBufferMaxSize, depthwise_depth);
+  const int kOutputPixelsInAccBuffer = kAccBufferMaxSize / depthwise_depth;
+
+  const FloatDepthwiseConvRowAccumFunc row_accum_func =
+      GetFloatDepthwiseConvRowAccumFunc(stride_width, input_depth,
+                                        depth_multiplier);
+  const auto pointwise_filter_matrix_map =
+      MapAsMatrixWithLastDimAsCols(pointwise_filter_data,
+                                   pointwise_filter_dims);
+  const VectorMap<const float> pointwise_bias_map(pointwise_bias_data,
+                                                  output_depth, 1);
+
+  for (int b = 0; b < batches; ++b) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      const int filter_y_start = std::max(0, -in_y_origin);
+      const int filter_y_end =
+          std::min(filter_height, input_height - in_y_origin);
+      for (int out_x_buffer_start = 0; out_x_buffer_start < output_width;
+           out_x_buffer_start += kOutputPixelsInAccBuffer) {
+        const int out_x_buffer_end = std::min(
+            output_width, out_x_buffer_start + kOutputPixelsInAccBuffer);
+        const int num_output_pixels = out_x_buffer_end - out_x_buffer_start;
+        DepthwiseConvInitAccBuffer(num_output_pixels, depthwise_depth,
+                                   depthwise_bias_data, acc_buffer);
+        for (int filter_y = filter_y_start; filter_y < filter_y_end;
+             ++filter_y) {
+          const int in_y = in_y_origin + filter_y;
+          const float* filter_row_data =
+              depthwise_filter_data +
+              filter_y * depthwise_filter_dims.strides[2];
+          row_accum_func(stride_width, input_depth, input_width,
+                         input_data + in_y * input_dims.strides[2] +
+                             b * input_dims.strides[3],
+                         pad_width, depth_multiplier, filter_width,
+                         filter_row_data, out_x_buffer_start,
+                         out_x_buffer_end, depthwise_depth, acc_buffer);
+        }
+
+        // Both tiles are matrices with one column per pixel: depthwise_depth
+        // rows in the buffer, output_depth rows in the output.
+        MatrixMap<float> acc_matrix_map(acc_buffer, depthwise_depth,
+                                        num_output_pixels);
+        acc_matrix_map = acc_matrix_map.cwiseMax(depthwise_activation_min)
+                             .cwiseMin(depthwise_activation_max);
+        MatrixMap<float> output_matrix_map(
+            output_data + Offset(output_dims, 0, out_x_buffer_start, out_y, b),
+            output_depth, num_output_pixels);
+        Gemm(pointwise_filter_matrix_map.transpose(), acc_matrix_map,
+             &output_matrix_map);
+        output_matrix_map =
+            (output_matrix_map.colwise() + pointwise_bias_map)
+                .cwiseMax(output_activation_min)
+                .cwiseMin(output_activation_max);
+      }
+    }
+  }
+}
+
 inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
                  int32 input_offset, const uint8* filter_data,
                  const Dims<4>& filter_dims, int32 filter_offset,
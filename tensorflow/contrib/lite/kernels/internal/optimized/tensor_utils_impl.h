@@ -17,6 +17,8 @@ limitations under the License.
 
 // TDOD(ghodrat): Remove this header file and the dependency to internal data
 // structure.
+#include <cstdint>
+
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 
 #ifndef USE_NEON
@@ -40,6 +42,30 @@ void NeonMatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                              int n_batch, float* result,
                                              int result_stride);
 
+// Multiply several matrices of the same size by a batch vector in one pass.
+void PortableMultiMatrixBatchVectorMultiplyAccumulate(
+    const float* const* matrices, int n_matrices, int m_rows, int m_cols,
+    const float* vector, int n_batch, float* const* results);
+void NeonMultiMatrixBatchVectorMultiplyAccumulate(
+    const float* const* matrices, int n_matrices, int m_rows, int m_cols,
+    const float* vector, int n_batch, float* const* results);
+
+// Quantize a float vector symmetrically to int8.
+void PortableSymmetricQuantizeFloats(const float* values, int size,
+                                     int8_t* quantized_values,
+                                     float* scaling_factor);
+
+// Multiply a symmetrically quantized matrix by quantized batch vectors, and
+// accumulate the scaled results in a float batch-size vector.
+void PortableMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride);
+void NeonMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride);
+
 // Cwise product of two vectors.
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
@@ -45,6 +48,79 @@ void PortableMatrixBatchVectorMultiplyAccumulate(const float* matrix,
   }
 }
 
+void PortableMultiMatrixBatchVectorMultiplyAccumulate(
+    const float* const* matrices, int n_matrices, int m_rows, int m_cols,
+    const float* vector, int n_batch, float* const* results) {
+  constexpr int kMaxMatricesPerPass = 4;
+  for (int first = 0; first < n_matrices; first += kMaxMatricesPerPass) {
+    const int n = std::min(kMaxMatricesPerPass, n_matrices - first);
+    for (int b = 0; b < n_batch; b++) {
+      const float* vector_in_batch = vector + b * m_cols;
+      for (int r = 0; r < m_rows; r++) {
+        // Accumulate in the same order as
+        // PortableMatrixBatchVectorMultiplyAccumulate().
+        float acc[kMaxMatricesPerPass];
+        for (int i = 0; i < n; i++) {
+          acc[i] = results[first + i][b * m_rows + r];
+        }
+        for (int c = 0; c < m_cols; c++) {
+          const float v = vector_in_batch[c];
+          for (int i = 0; i < n; i++) {
+            acc[i] += matrices[first + i][r * m_cols + c] * v;
+          }
+        }
+        for (int i = 0; i < n; i++) {
+          results[first + i][b * m_rows + r] = acc[i];
+        }
+      }
+    }
+  }
+}
+
+void PortableSymmetricQuantizeFloats(const float* values, int size,
+                                     int8_t* quantized_values,
+                                     float* scaling_factor) {
+  constexpr int kScale = 127;
+  float abs_max = 0.0f;
+  for (int i = 0; i < size; i++) {
+    abs_max = std::max(abs_max, std::abs(values[i]));
+  }
+  if (abs_max == 0.0f) {
+    memset(quantized_values, 0, size * sizeof(int8_t));
+    *scaling_factor = 1.0f;
+    return;
+  }
+  *scaling_factor = abs_max / kScale;
+  const float scaling_factor_inv = kScale / abs_max;
+  for (int i = 0; i < size; i++) {
+    const int32_t quantized_value =
+        static_cast<int32_t>(std::round(values[i] * scaling_factor_inv));
+    // Clamp, in case rounding pushed the value just outside the range.
+    quantized_values[i] = static_cast<int8_t>(
+        std::min(kScale, std::max(-kScale, quantized_value)));
+  }
+}
+
+void PortableMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride) {
+  float* result_in_batch = result;
+  for (int b = 0; b < n_batch; b++) {
+    const float batch_scaling_factor = scaling_factors[b];
+    const int8_t* matrix_ptr = matrix;
+    for (int r = 0; r < m_rows; r++) {
+      const int8_t* vector_in_batch = vectors + b * m_cols;
+      int32_t dotprod = 0;
+      for (int c = 0; c < m_cols; c++) {
+        dotprod += static_cast<int32_t>(*matrix_ptr++) * *vector_in_batch++;
+      }
+      *result_in_batch += dotprod * batch_scaling_factor;
+      result_in_batch += result_stride;
+    }
+  }
+}
+
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
                                       float* result) {
@@ -17,6 +17,8 @@ limitations under the License.
 
 // TDOD(ghodrat): Remove this header file and the dependency to internal data
 // structure.
+#include <cstdint>
+
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 
 namespace tflite {
@@ -33,6 +35,23 @@ void PortableMatrixBatchVectorMultiplyAccumulate(const float* matrix,
                                                  int n_batch, float* result,
                                                  int result_stride);
 
+// Multiply several matrices of the same size by a batch vector in one pass.
+void PortableMultiMatrixBatchVectorMultiplyAccumulate(
+    const float* const* matrices, int n_matrices, int m_rows, int m_cols,
+    const float* vector, int n_batch, float* const* results);
+
+// Quantize a float vector symmetrically to int8.
+void PortableSymmetricQuantizeFloats(const float* values, int size,
+                                     int8_t* quantized_values,
+                                     float* scaling_factor);
+
+// Multiply a symmetrically quantized matrix by quantized batch vectors, and
+// accumulate the scaled results in a float batch-size vector.
+void PortableMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* matrix, int m_rows, int m_cols, const int8_t* vectors,
+    const float* scaling_factors, int n_batch, float* result,
+    int result_stride);
+
 // Cwise product of two vectors.
 void PortableVectorVectorCwiseProduct(const float* vector1,
                                       const float* vector2, int v_size,
@@ -111,6 +130,31 @@ void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                               n_batch, result, result_stride);
 }
 
+void MultiMatrixBatchVectorMultiplyAccumulate(const float* const* matrices,
+                                              int n_matrices, int m_rows,
+                                              int m_cols, const float* vector,
+                                              int n_batch,
+                                              float* const* results) {
+  PortableMultiMatrixBatchVectorMultiplyAccumulate(
+      matrices, n_matrices, m_rows, m_cols, vector, n_batch, results);
+}
+
+void SymmetricQuantizeFloats(const float* values, int size,
+                             int8_t* quantized_values, float* scaling_factor) {
+  PortableSymmetricQuantizeFloats(values, size, quantized_values,
+                                  scaling_factor);
+}
+
+void MatrixBatchVectorMultiplyAccumulate(const int8_t* matrix, int m_rows,
+                                         int m_cols, const int8_t* vectors,
+                                         const float* scaling_factors,
+                                         int n_batch, float* result,
+                                         int result_stride) {
+  PortableMatrixBatchVectorMultiplyAccumulate(matrix, m_rows, m_cols, vectors,
+                                              scaling_factors, n_batch, result,
+                                              result_stride);
+}
+
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result) {
   PortableVectorVectorCwiseProduct(vector1, vector2, v_size, result);
@@ -22,6 +22,7 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <type_traits>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
 #include "fixedpoint/fixedpoint.h"
@@ -245,6 +246,87 @@ void Conv(const float* input_data, const Dims<4>& input_dims,
            output_dims, im2col_data, im2col_dims);
 }
 
+// A DepthwiseConv followed by a 1x1 Conv with stride 1. Computes the
+// depthwise output of one pixel at a time, then the pointwise outputs from it.
+inline void DepthwiseSeparableConv(
+    const float* input_data, const Dims<4>& input_dims,
+    const float* depthwise_filter_data, const Dims<4>& depthwise_filter_dims,
+    const float* depthwise_bias_data, const Dims<4>& depthwise_bias_dims,
+    const float* pointwise_filter_data, const Dims<4>& pointwise_filter_dims,
+    const float* pointwise_bias_data, const Dims<4>& pointwise_bias_dims,
+    int stride_width, int stride_height, int pad_width, int pad_height,
+    int depth_multiplier, float depthwise_activation_min,
+    float depthwise_activation_max, float output_activation_min,
+    float output_activation_max, float* output_data,
+    const Dims<4>& output_dims) {
+  const int batches = MatchingArraySize(input_dims, 3, output_dims, 3);
+  const int input_height = ArraySize(input_dims, 2);
+  const int input_width = ArraySize(input_dims, 1);
+  const int input_depth = ArraySize(input_dims, 0);
+  const int depthwise_depth = MatchingArraySize(
+      depthwise_filter_dims, 0, pointwise_filter_dims, 0);
+  const int filter_height = ArraySize(depthwise_filter_dims, 2);
+  const int filter_width = ArraySize(depthwise_filter_dims, 1);
+  const int output_depth =
+      MatchingArraySize(pointwise_filter_dims, 3, output_dims, 0);
+  const int output_height = ArraySize(output_dims, 2);
+  const int output_width = ArraySize(output_dims, 1);
+  TFLITE_DCHECK(depthwise_depth == input_depth * depth_multiplier);
+  TFLITE_DCHECK_EQ(ArraySize(pointwise_filter_dims, 1), 1);
+  TFLITE_DCHECK_EQ(ArraySize(pointwise_filter_dims, 2), 1);
+
+  std::vector<float> depthwise_values(depthwise_depth);
+  for (int b = 0; b < batches; ++b) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = (out_x * stride_width) - pad_width;
+        const int in_y_origin = (out_y * stride_height) - pad_height;
+        for (int ic = 0; ic < input_depth; ++ic) {
+          for (int m = 0; m < depth_multiplier; m++) {
+            const int dc = m + ic * depth_multiplier;
+            float total = 0.f;
+            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+              for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                const int in_x = in_x_origin + filter_x;
+                const int in_y = in_y_origin + filter_y;
+                // If the location is outside the bounds of the input image,
+                // use zero as a default value.
+                if ((in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                    (in_y < input_height)) {
+                  float input_value =
+                      input_data[Offset(input_dims, ic, in_x, in_y, b)];
+                  float filter_value = depthwise_filter_data[Offset(
+                      depthwise_filter_dims, dc, filter_x, filter_y, 0)];
+                  total += (input_value * filter_value);
+                }
+              }
+            }
+            const float bias_value =
+                depthwise_bias_data[Offset(depthwise_bias_dims, dc, 0, 0, 0)];
+            depthwise_values[dc] = ActivationFunctionWithMinMax(
+                total + bias_value, depthwise_activation_min,
+                depthwise_activation_max);
+          }
+        }
+        for (int oc = 0; oc < output_depth; ++oc) {
+          float total = 0.f;
+          for (int dc = 0; dc < depthwise_depth; ++dc) {
+            total += depthwise_values[dc] *
+                     pointwise_filter_data[Offset(pointwise_filter_dims, dc, 0,
+                                                  0, oc)];
+          }
+          const float bias_value =
+              pointwise_bias_data[Offset(pointwise_bias_dims, oc, 0, 0, 0)];
+          output_data[Offset(output_dims, oc, out_x, out_y, b)] =
+              ActivationFunctionWithMinMax(total + bias_value,
+                                           output_activation_min,
+                                           output_activation_max);
+        }
+      }
+    }
+  }
+}
+
 inline void Conv(const uint8* input_data, const Dims<4>& input_dims,
                  int32 input_offset, const uint8* filter_data,
                  const Dims<4>& filter_dims, int32 filter_offset,
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_TENSOR_UTILS_H_
 #define THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_INTERNAL_TENSOR_UTILS_H_
 
+#include <cstdint>
+
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 
 namespace tflite {
@@ -34,6 +36,34 @@ void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                          int n_batch, float* result,
                                          int result_stride);
 
+// Multiply 'n_matrices' matrices of the same size by the same batch vector,
+// and accumulate the results of matrices[i] in results[i], arranged like in
+// MatrixBatchVectorMultiplyAccumulate() with result_stride = 1. The matrices
+// are processed together, so every part of the vector is loaded once for up to
+// four of them, e.g. for the four gates of an LSTM cell.
+void MultiMatrixBatchVectorMultiplyAccumulate(const float* const* matrices,
+                                              int n_matrices, int m_rows,
+                                              int m_cols, const float* vector,
+                                              int n_batch,
+                                              float* const* results);
+
+// Quantize 'size' float values symmetrically to int8 in [-127, 127], so that
+// values[i] ~= quantized_values[i] * scaling_factor. A vector of zeros gets a
+// scaling factor of 1.
+void SymmetricQuantizeFloats(const float* values, int size,
+                             int8_t* quantized_values, float* scaling_factor);
+
+// Same as the float MatrixBatchVectorMultiplyAccumulate() above, for a matrix
+// and batch vectors that were quantized with SymmetricQuantizeFloats(). The
+// products are accumulated in int32 and each batch is scaled back to float
+// with scaling_factors[b], i.e. the product of the matrix and batch vector
+// scaling factors, before it's added to the result.
+void MatrixBatchVectorMultiplyAccumulate(const int8_t* matrix, int m_rows,
+                                         int m_cols, const int8_t* vectors,
+                                         const float* scaling_factors,
+                                         int n_batch, float* result,
+                                         int result_stride);
+
 // Cwise product of two vectors.
 void VectorVectorCwiseProduct(const float* vector1, const float* vector2,
                               int v_size, float* result);
@@ -58,6 +58,97 @@ TEST(uKernels, MatrixBatchVectorMultiplyAccumulateTest) {
                                                -1., 3., 7., 3., 23., 3.})));
 }
 
+TEST(uKernels, MultiMatrixBatchVectorMultiplyAccumulateTest) {
+  // Five matrices, so that they don't all fit in one pass, and a number of
+  // columns that leaves a remainder after the vectorized loop.
+  constexpr int kMatrices = 5;
+  constexpr int kRow = 3;
+  constexpr int kCol = 6;
+  constexpr int kBatch = 2;
+  std::vector<std::vector<float>> matrices(kMatrices);
+  const float* matrix_ptrs[kMatrices];
+  for (int i = 0; i < kMatrices; ++i) {
+    for (int j = 0; j < kRow * kCol; ++j) {
+      matrices[i].push_back(0.25 * ((i * 7 + j * 3) % 11) - 1.0);
+    }
+    matrix_ptrs[i] = matrices[i].data();
+  }
+  static float vector[kCol * kBatch] = {1.0, -1.0, 0.5, 2.0, -0.5, 1.5,  //
+                                        2.0, 0.0,  -2.0, 1.0, 3.0, -1.0};
+
+  std::vector<std::vector<float>> outputs(kMatrices);
+  std::vector<std::vector<float>> expected(kMatrices);
+  float* output_ptrs[kMatrices];
+  for (int i = 0; i < kMatrices; ++i) {
+    outputs[i].assign(kRow * kBatch, i);
+    expected[i].assign(kRow * kBatch, i);
+    output_ptrs[i] = outputs[i].data();
+    MatrixBatchVectorMultiplyAccumulate(matrix_ptrs[i], kRow, kCol, vector,
+                                        kBatch, expected[i].data(),
+                                        /*result_stride=*/1);
+  }
+  MultiMatrixBatchVectorMultiplyAccumulate(matrix_ptrs, kMatrices, kRow, kCol,
+                                           vector, kBatch, output_ptrs);
+  for (int i = 0; i < kMatrices; ++i) {
+    EXPECT_THAT(outputs[i], ElementsAreArray(ArrayFloatNear(expected[i])))
+        << "matrix " << i;
+  }
+}
+
+TEST(uKernels, SymmetricQuantizeFloatsTest) {
+  constexpr int kVectorSize = 5;
+  static float input[kVectorSize] = {-12.7, 0.0, 2.54, -0.06, 6.36};
+  std::vector<int8_t> output(kVectorSize);
+  float scaling_factor;
+  SymmetricQuantizeFloats(input, kVectorSize, output.data(), &scaling_factor);
+  EXPECT_FLOAT_EQ(scaling_factor, 0.1);
+  EXPECT_THAT(output, testing::ElementsAreArray({-127, 0, 25, -1, 64}));
+
+  static float zeros[kVectorSize] = {0.0, 0.0, 0.0, 0.0, 0.0};
+  SymmetricQuantizeFloats(zeros, kVectorSize, output.data(), &scaling_factor);
+  EXPECT_FLOAT_EQ(scaling_factor, 1.0);
+  EXPECT_THAT(output, testing::ElementsAreArray({0, 0, 0, 0, 0}));
+}
+
+TEST(uKernels, QuantMatrixBatchVectorMultiplyAccumulateTest) {
+  // More columns than fit in a NEON register, so that both the vectorized
+  // loop and the postamble are used.
+  constexpr int kRow = 3;
+  constexpr int kCol = 20;
+  constexpr int kBatch = 2;
+  std::vector<float> matrix(kRow * kCol);
+  std::vector<float> vector(kCol * kBatch);
+  for (int i = 0; i < kRow * kCol; i++) {
+    matrix[i] = (i % 7 - 3) * 0.25;
+  }
+  for (int i = 0; i < kCol * kBatch; i++) {
+    vector[i] = (i % 5 - 2) * (i < kCol ? 0.5 : -1.5);
+  }
+
+  std::vector<int8_t> quantized_matrix(kRow * kCol);
+  float matrix_scaling_factor;
+  SymmetricQuantizeFloats(matrix.data(), kRow * kCol, quantized_matrix.data(),
+                          &matrix_scaling_factor);
+  std::vector<int8_t> quantized_vector(kCol * kBatch);
+  float scaling_factors[kBatch];
+  for (int b = 0; b < kBatch; b++) {
+    SymmetricQuantizeFloats(vector.data() + b * kCol, kCol,
+                            quantized_vector.data() + b * kCol,
+                            &scaling_factors[b]);
+    scaling_factors[b] *= matrix_scaling_factor;
+  }
+
+  std::vector<float> expected(kRow * kBatch * 2, 3.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix.data(), kRow, kCol, vector.data(),
+                                      kBatch, expected.data(),
+                                      /*result_stride=*/2);
+  std::vector<float> output(kRow * kBatch * 2, 3.0);
+  MatrixBatchVectorMultiplyAccumulate(
+      quantized_matrix.data(), kRow, kCol, quantized_vector.data(),
+      scaling_factors, kBatch, output.data(), /*result_stride=*/2);
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(expected, 0.05)));
+}
+
 TEST(uKernels, VectorVectorCwiseProductTest) {
   constexpr int kVectorSize = 10;
   static float input1[kVectorSize] = {0.0,  -0.5, 1.0,  -1.5, 2.0,
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <unistd.h>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
 #include "tensorflow/contrib/lite/kernels/activation_functor.h"
+#include "tensorflow/contrib/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
@@ -33,7 +35,8 @@ namespace ops {
 namespace builtin {
 namespace lstm {
 
-// Input Tensors of size {n_batch, n_input}
+// Input Tensors of size {n_batch, n_input}, or {max_time, n_batch, n_input}
+// for a whole sequence.
 constexpr int kInputTensor = 0;
 
 // Input weight tensors of size: {n_cell, n_input}
@@ -64,12 +67,48 @@ constexpr int kProjectionWeightsTensor = 16;  // Optional
 // Projection bias tensor of size {n_output}
 constexpr int kProjectionBiasTensor = 17;  // Optional
 
-// Output tensors.
+// Sequence length tensor of size {n_batch}, only for a sequence input. Once a
+// batch reaches its length, its output is zero and its state is kept.
+constexpr int kSequenceLengthTensor = 18;  // Optional
+
+// Output tensors. The output is {n_batch, n_output}, or
+// {max_time, n_batch, n_output} for a sequence.
 constexpr int kScratchBufferTensor = 0;
 constexpr int kOutputStateTensor = 1;
 constexpr int kCellStateTensor = 2;
 constexpr int kOutputTensor = 3;
 
+// Temporaries of the hybrid LSTM, whose weights are quantized: the quantized
+// input, output_state or gated output, and the scaling factors of their
+// batches alone and multiplied by those of the weights.
+constexpr int kQuantizedScratchTemporary = 0;
+constexpr int kScalingFactorsTemporary = 1;
+constexpr int kProductScalingFactorsTemporary = 2;
+constexpr int kNumHybridTemporaries = 3;
+
+struct OpData {
+  // Index of the first hybrid temporary tensor.
+  int scratch_tensor_index;
+};
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  auto* data = new OpData;
+  context->AddTensors(context, kNumHybridTemporaries,
+                      &data->scratch_tensor_index);
+  return data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+// Returns the sequence length tensor, or null if there is none.
+TfLiteTensor* GetSequenceLengthTensor(TfLiteContext* context,
+                                      TfLiteNode* node) {
+  if (node->inputs->size <= kSequenceLengthTensor) return nullptr;
+  return GetOptionalInputTensor(context, node, kSequenceLengthTensor);
+}
+
 // Check that input tensor dimensions matches with each other.
 TfLiteStatus CheckInputTensorDimensions(TfLiteContext* context,
                                         TfLiteNode* node, int n_input,
@@ -223,15 +262,25 @@ TfLiteStatus CheckInputTensorDimensions(TfLiteContext* context,
 // tensors. Also check that the size of the input tensors match each other.
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   // Check we have all the inputs and outputs we need.
-  TF_LITE_ENSURE_EQ(context, node->inputs->size, 18);
+  TF_LITE_ENSURE(context, node->inputs->size == 18 || node->inputs->size == 19);
   TF_LITE_ENSURE_EQ(context, node->outputs->size, 4);
 
   // Inferring batch size, number of outputs and number of cells from the
   // input tensors.
   TfLiteTensor* input = GetInput(context, node, kInputTensor);
-  TF_LITE_ENSURE(context, input->dims->size > 1);
-  const int n_batch = input->dims->data[0];
-  const int n_input = input->dims->data[1];
+  TF_LITE_ENSURE(context, input->dims->size == 2 || input->dims->size == 3);
+  const bool is_sequence = (input->dims->size == 3);
+  const int max_time = is_sequence ? input->dims->data[0] : 1;
+  const int n_batch = input->dims->data[is_sequence ? 1 : 0];
+  const int n_input = input->dims->data[is_sequence ? 2 : 1];
+
+  TfLiteTensor* sequence_length = GetSequenceLengthTensor(context, node);
+  if (sequence_length) {
+    TF_LITE_ENSURE(context, is_sequence);
+    TF_LITE_ENSURE_EQ(context, sequence_length->type, kTfLiteInt32);
+    TF_LITE_ENSURE_EQ(context, sequence_length->dims->size, 1);
+    TF_LITE_ENSURE_EQ(context, sequence_length->dims->data[0], n_batch);
+  }
 
   TfLiteTensor* input_to_output_weights =
       GetInput(context, node, kInputToOutputWeightsTensor);
@@ -258,9 +307,17 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* scratch_buffer = GetOutput(context, node, kScratchBufferTensor);
 
   // Resize the output and output_state tensors.
-  TfLiteIntArray* output_size = TfLiteIntArrayCreate(2);
-  output_size->data[0] = n_batch;
-  output_size->data[1] = n_output;
+  TfLiteIntArray* output_size;
+  if (is_sequence) {
+    output_size = TfLiteIntArrayCreate(3);
+    output_size->data[0] = max_time;
+    output_size->data[1] = n_batch;
+    output_size->data[2] = n_output;
+  } else {
+    output_size = TfLiteIntArrayCreate(2);
+    output_size->data[0] = n_batch;
+    output_size->data[1] = n_output;
+  }
   TF_LITE_ENSURE_OK(context,
                     context->ResizeTensor(context, output, output_size));
 
@@ -299,6 +356,50 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                      scratch_buffer_size));
   }
+
+  auto* params = reinterpret_cast<TfLiteLSTMParams*>(node->builtin_data);
+  if (params->weights_only_quantized) {
+    TF_LITE_ENSURE_EQ(context, input->type, kTfLiteFloat32);
+    for (int i : {kInputToInputWeightsTensor, kInputToForgetWeightsTensor,
+                  kInputToCellWeightsTensor, kInputToOutputWeightsTensor,
+                  kRecurrentToInputWeightsTensor,
+                  kRecurrentToForgetWeightsTensor,
+                  kRecurrentToCellWeightsTensor,
+                  kRecurrentToOutputWeightsTensor, kProjectionWeightsTensor}) {
+      TfLiteTensor* weights = GetOptionalInputTensor(context, node, i);
+      if (weights) TF_LITE_ENSURE_EQ(context, weights->type, kTfLiteUInt8);
+    }
+
+    OpData* data = reinterpret_cast<OpData*>(node->user_data);
+    TfLiteIntArrayFree(node->temporaries);
+    node->temporaries = TfLiteIntArrayCreate(kNumHybridTemporaries);
+    for (int i = 0; i < kNumHybridTemporaries; ++i) {
+      node->temporaries->data[i] = data->scratch_tensor_index + i;
+    }
+
+    TfLiteTensor* quantized_scratch =
+        GetTemporary(context, node, kQuantizedScratchTemporary);
+    quantized_scratch->type = kTfLiteUInt8;
+    quantized_scratch->allocation_type = kTfLiteArenaRw;
+    TfLiteIntArray* quantized_scratch_size = TfLiteIntArrayCreate(2);
+    quantized_scratch_size->data[0] = n_batch;
+    quantized_scratch_size->data[1] = std::max(n_input, std::max(n_output,
+                                                                 n_cell));
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, quantized_scratch,
+                                            quantized_scratch_size));
+
+    for (int i : {kScalingFactorsTemporary, kProductScalingFactorsTemporary}) {
+      TfLiteTensor* scaling_factors = GetTemporary(context, node, i);
+      scaling_factors->type = kTfLiteFloat32;
+      scaling_factors->allocation_type = kTfLiteArenaRw;
+      TfLiteIntArray* scaling_factors_size = TfLiteIntArrayCreate(1);
+      scaling_factors_size->data[0] = n_batch;
+      TF_LITE_ENSURE_OK(context,
+                        context->ResizeTensor(context, scaling_factors,
+                                              scaling_factors_size));
+    }
+  }
   return kTfLiteOk;
 }
 
@@ -349,8 +450,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TfLiteTensor* cell_state = GetOutput(context, node, kCellStateTensor);
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
 
-  const int n_batch = input->dims->data[0];
-  const int n_input = input->dims->data[1];
+  const bool is_sequence = (input->dims->size == 3);
+  const int max_time = is_sequence ? input->dims->data[0] : 1;
+  const int n_batch = input->dims->data[is_sequence ? 1 : 0];
+  const int n_input = input->dims->data[is_sequence ? 2 : 1];
   // n_cell and n_output will be the same size when there is no projection.
   const int n_cell = input_to_output_weights->dims->data[0];
   const int n_output = recurrent_to_output_weights->dims->data[1];
@@ -358,7 +461,6 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   // Since we have already checked that weights are all there or none, we can
   // check the existense of only one to the get the condition.
   const bool use_cifg = (input_to_input_weights == nullptr);
-  const bool use_peephole = (cell_to_output_weights != nullptr);
 
   // Index the scratch buffers pointers to the global scratch buffer.
   TfLiteTensor* scratch_buffer = GetOutput(context, node, kScratchBufferTensor);
@@ -377,127 +479,96 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
     output_gate_scratch = scratch_buffer->data.f + 3 * n_cell * n_batch;
   }
 
-  // Initialize scratch buffers with bias.
-  if (!use_cifg) {
-    tensor_utils::VectorBatchVectorAssign(input_gate_bias->data.f, n_cell,
-                                          n_batch, input_gate_scratch);
-  }
-  tensor_utils::VectorBatchVectorAssign(forget_gate_bias->data.f, n_cell,
-                                        n_batch, forget_gate_scratch);
-  tensor_utils::VectorBatchVectorAssign(cell_bias->data.f, n_cell, n_batch,
-                                        cell_scratch);
-  tensor_utils::VectorBatchVectorAssign(output_gate_bias->data.f, n_cell,
-                                        n_batch, output_gate_scratch);
-
-  // For each batch and cell: compute input_weight * input.
-  if (!use_cifg) {
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        input_to_input_weights->data.f, n_cell, n_input, input->data.f, n_batch,
-        input_gate_scratch, /*result_stride=*/1);
-  }
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_to_forget_weights->data.f, n_cell, n_input, input->data.f, n_batch,
-      forget_gate_scratch, /*result_stride=*/1);
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_to_cell_weights->data.f, n_cell, n_input, input->data.f, n_batch,
-      cell_scratch, /*result_stride=*/1);
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      input_to_output_weights->data.f, n_cell, n_input, input->data.f, n_batch,
-      output_gate_scratch, /*result_stride=*/1);
-
-  // For each batch and cell: compute recurrent_weight * output_state.
-  if (!use_cifg) {
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        recurrent_to_input_weights->data.f, n_cell, n_output,
-        output_state->data.f, n_batch, input_gate_scratch, /*result_stride=*/1);
-  }
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      recurrent_to_forget_weights->data.f, n_cell, n_output,
-      output_state->data.f, n_batch, forget_gate_scratch, /*result_stride=*/1);
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      recurrent_to_cell_weights->data.f, n_cell, n_output, output_state->data.f,
-      n_batch, cell_scratch, /*result_stride=*/1);
-  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-      recurrent_to_output_weights->data.f, n_cell, n_output,
-      output_state->data.f, n_batch, output_gate_scratch, /*result_stride=*/1);
-
-  // For each batch and cell: update input gate.
-  if (!use_cifg) {
-    if (use_peephole) {
-      tensor_utils::VectorBatchVectorCwiseProductAccumulate(
-          cell_to_input_weights->data.f, n_cell, cell_state->data.f, n_batch,
-          input_gate_scratch);
+  auto optional_data = [](TfLiteTensor* tensor) -> const float* {
+    return tensor ? tensor->data.f : nullptr;
+  };
+  // The quantized weights hold int8 values in uint8 tensors.
+  auto optional_int8 = [](TfLiteTensor* tensor) -> const int8_t* {
+    return tensor ? reinterpret_cast<const int8_t*>(tensor->data.uint8)
+                  : nullptr;
+  };
+  auto scale = [](TfLiteTensor* tensor) {
+    return tensor ? tensor->params.scale : 1.0f;
+  };
+  // Runs one time step for 'step_batch' batches starting at 'first_batch'.
+  auto step = [&](int t, int first_batch, int step_batch) {
+    if (params->weights_only_quantized) {
+      kernel_utils::HybridLstmStep(
+          input->data.f + (t * n_batch + first_batch) * n_input,
+          optional_int8(input_to_input_weights), scale(input_to_input_weights),
+          optional_int8(input_to_forget_weights),
+          scale(input_to_forget_weights), optional_int8(input_to_cell_weights),
+          scale(input_to_cell_weights), optional_int8(input_to_output_weights),
+          scale(input_to_output_weights),
+          optional_int8(recurrent_to_input_weights),
+          scale(recurrent_to_input_weights),
+          optional_int8(recurrent_to_forget_weights),
+          scale(recurrent_to_forget_weights),
+          optional_int8(recurrent_to_cell_weights),
+          scale(recurrent_to_cell_weights),
+          optional_int8(recurrent_to_output_weights),
+          scale(recurrent_to_output_weights),
+          optional_data(cell_to_input_weights),
+          optional_data(cell_to_forget_weights),
+          optional_data(cell_to_output_weights),
+          optional_data(input_gate_bias), forget_gate_bias->data.f,
+          cell_bias->data.f, output_gate_bias->data.f,
+          optional_int8(projection_weights), scale(projection_weights),
+          optional_data(projection_bias), params, step_batch, n_cell, n_input,
+          n_output, output_state->data.f + first_batch * n_output,
+          cell_state->data.f + first_batch * n_cell, input_gate_scratch,
+          forget_gate_scratch, cell_scratch, output_gate_scratch,
+          GetTemporary(context, node, kScalingFactorsTemporary)->data.f,
+          GetTemporary(context, node, kProductScalingFactorsTemporary)->data.f,
+          reinterpret_cast<int8_t*>(
+              GetTemporary(context, node, kQuantizedScratchTemporary)
+                  ->data.uint8),
+          output->data.f + (t * n_batch + first_batch) * n_output);
+      return;
     }
-    tensor_utils::ApplySigmoidToVector(input_gate_scratch, n_cell * n_batch,
-                                       input_gate_scratch);
-  }
-
-  // For each batch and cell: update forget gate.
-  if (use_peephole) {
-    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
-        cell_to_forget_weights->data.f, n_cell, cell_state->data.f, n_batch,
-        forget_gate_scratch);
-  }
-  tensor_utils::ApplySigmoidToVector(forget_gate_scratch, n_cell * n_batch,
-                                     forget_gate_scratch);
-
-  // For each batch and cell: update the cell.
-  tensor_utils::VectorVectorCwiseProduct(forget_gate_scratch,
-                                         cell_state->data.f, n_batch * n_cell,
-                                         cell_state->data.f);
-  tensor_utils::ApplyActivationToVector(cell_scratch, n_batch * n_cell,
-                                        params->activation, cell_scratch);
-  if (use_cifg) {
-    tensor_utils::Sub1Vector(forget_gate_scratch, n_batch * n_cell,
-                             forget_gate_scratch);
-    tensor_utils::VectorVectorCwiseProductAccumulate(
-        cell_scratch, forget_gate_scratch, n_batch * n_cell,
-        cell_state->data.f);
-  } else {
-    tensor_utils::VectorVectorCwiseProductAccumulate(
-        cell_scratch, input_gate_scratch, n_batch * n_cell, cell_state->data.f);
-  }
-  if (params->cell_clip > 0.0) {
-    tensor_utils::ClipVector(cell_state->data.f, n_batch * n_cell,
-                             params->cell_clip, cell_state->data.f);
-  }
-
-  // For each batch and cell: update the output gate.
-  if (use_peephole) {
-    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
-        cell_to_output_weights->data.f, n_cell, cell_state->data.f, n_batch,
-        output_gate_scratch);
-  }
-  tensor_utils::ApplySigmoidToVector(output_gate_scratch, n_batch * n_cell,
-                                     output_gate_scratch);
-  tensor_utils::ApplyActivationToVector(cell_state->data.f, n_batch * n_cell,
-                                        params->activation, cell_scratch);
-  tensor_utils::VectorVectorCwiseProduct(output_gate_scratch, cell_scratch,
-                                         n_batch * n_cell, output_gate_scratch);
-
-  // For each batch: update the projection and output_state.
-  const bool use_projection_weight = (projection_weights != nullptr);
-  const bool use_projection_bias = (projection_bias != nullptr);
-  if (use_projection_weight) {
-    if (use_projection_bias) {
-      tensor_utils::VectorBatchVectorAssign(projection_bias->data.f, n_output,
-                                            n_batch, output->data.f);
-    } else {
-      tensor_utils::ZeroVector(output->data.f, n_batch * n_output);
+    kernel_utils::LstmStep(
+        input->data.f + (t * n_batch + first_batch) * n_input,
+        optional_data(input_to_input_weights), input_to_forget_weights->data.f,
+        input_to_cell_weights->data.f, input_to_output_weights->data.f,
+        optional_data(recurrent_to_input_weights),
+        recurrent_to_forget_weights->data.f, recurrent_to_cell_weights->data.f,
+        recurrent_to_output_weights->data.f,
+        optional_data(cell_to_input_weights),
+        optional_data(cell_to_forget_weights),
+        optional_data(cell_to_output_weights), optional_data(input_gate_bias),
+        forget_gate_bias->data.f, cell_bias->data.f, output_gate_bias->data.f,
+        optional_data(projection_weights), optional_data(projection_bias),
+        params, step_batch, n_cell, n_input, n_output,
+        output_state->data.f + first_batch * n_output,
+        cell_state->data.f + first_batch * n_cell, input_gate_scratch,
+        forget_gate_scratch, cell_scratch, output_gate_scratch,
+        output->data.f + (t * n_batch + first_batch) * n_output);
+  };
+
+  TfLiteTensor* sequence_length = GetSequenceLengthTensor(context, node);
+  for (int t = 0; t < max_time; ++t) {
+    int n_active = n_batch;
+    if (sequence_length) {
+      n_active = 0;
+      for (int b = 0; b < n_batch; ++b) {
+        if (t < sequence_length->data.i32[b]) ++n_active;
+      }
     }
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        projection_weights->data.f, n_output, n_cell, output_gate_scratch,
-        n_batch, output->data.f, /*result_stride=*/1);
-    if (params->proj_clip > 0.0) {
-      tensor_utils::ClipVector(output->data.f, n_batch * n_output,
-                               params->proj_clip, output->data.f);
+    if (n_active == n_batch) {
+      step(t, 0, n_batch);
+      continue;
+    }
+    // Step the batches that are still running one at a time, and give the
+    // others a zero output.
+    for (int b = 0; b < n_batch; ++b) {
+      if (t < sequence_length->data.i32[b]) {
+        step(t, b, 1);
+      } else {
+        tensor_utils::ZeroVector(
+            output->data.f + (t * n_batch + b) * n_output, n_output);
+      }
     }
-  } else {
-    tensor_utils::CopyVector(output_gate_scratch, n_batch * n_output,
-                             output->data.f);
   }
-  tensor_utils::CopyVector(output->data.f, n_batch * n_output,
-                           output_state->data.f);
 
   return kTfLiteOk;
 }
@@ -505,8 +576,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 }  // namespace lstm
 
 TfLiteRegistration* Register_LSTM() {
-  static TfLiteRegistration r = {/*init=*/nullptr, /*free=*/nullptr,
-                                 lstm::Prepare, lstm::Eval};
+  static TfLiteRegistration r = {lstm::Init, lstm::Free, lstm::Prepare,
+                                 lstm::Eval};
   return &r;
 }
 
@@ -35,7 +35,8 @@ class LSTMOpModel : public SingleOpModel {
   LSTMOpModel(int n_batch, int n_input, int n_cell, int n_output, bool use_cifg,
               bool use_peephole, bool use_projection_weights,
               bool use_projection_bias, float cell_clip, float proj_clip,
-              const std::vector<std::vector<int>>& input_shapes)
+              const std::vector<std::vector<int>>& input_shapes,
+              bool use_sequence_length = false)
       : n_batch_(n_batch),
         n_input_(n_input),
         n_cell_(n_cell),
@@ -97,6 +98,10 @@ class LSTMOpModel : public SingleOpModel {
       projection_bias_ = AddNullInput();
     }
 
+    if (use_sequence_length) {
+      sequence_length_ = AddInput(TensorType_INT32);
+    }
+
     scratch_buffer_ = AddOutput(TensorType_FLOAT32);
     // TODO(ghodrat): Modify these states when we have a permanent solution for
     // persistent buffer.
@@ -179,6 +184,10 @@ class LSTMOpModel : public SingleOpModel {
     PopulateTensor(projection_bias_, f);
   }
 
+  void SetSequenceLength(std::initializer_list<int> f) {
+    PopulateTensor(sequence_length_, f);
+  }
+
   void ResetOutputState() {
     const int zero_buffer_size = n_cell_ * n_batch_;
     std::unique_ptr<float[]> zero_buffer(new float[zero_buffer_size]);
@@ -230,6 +239,8 @@ class LSTMOpModel : public SingleOpModel {
   int projection_weights_;
   int projection_bias_;
 
+  int sequence_length_;
+
   int output_;
   int output_state_;
   int cell_state_;
@@ -351,6 +362,112 @@ TEST(LSTMOpTest, BlackBoxTestNoCifgNoPeepholeNoProjectionNoClipping) {
   }
 }
 
+TEST(LSTMOpTest, SequenceWithSequenceLength) {
+  const int n_batch = 2;
+  const int max_time = 3;
+  const int n_input = 2;
+  // n_cell and n_output have the same size when there is no projection.
+  const int n_cell = 4;
+  const int n_output = 4;
+
+  LSTMOpModel lstm(n_batch, n_input, n_cell, n_output,
+                   /*use_cifg=*/false, /*use_peephole=*/false,
+                   /*use_projection_weights=*/false,
+                   /*use_projection_bias=*/false,
+                   /*cell_clip=*/0.0, /*proj_clip=*/0.0,
+                   {
+                       {max_time, n_batch, n_input},  // input tensor
+
+                       {n_cell, n_input},  // input_to_input_weight tensor
+                       {n_cell, n_input},  // input_to_forget_weight tensor
+                       {n_cell, n_input},  // input_to_cell_weight tensor
+                       {n_cell, n_input},  // input_to_output_weight tensor
+
+                       {n_cell, n_output},  // recurrent_to_input_weight tensor
+                       {n_cell, n_output},  // recurrent_to_forget_weight tensor
+                       {n_cell, n_output},  // recurrent_to_cell_weight tensor
+                       {n_cell, n_output},  // recurrent_to_output_weight tensor
+
+                       {0},  // cell_to_input_weight tensor
+                       {0},  // cell_to_forget_weight tensor
+                       {0},  // cell_to_output_weight tensor
+
+                       {n_cell},  // input_gate_bias tensor
+                       {n_cell},  // forget_gate_bias tensor
+                       {n_cell},  // cell_bias tensor
+                       {n_cell},  // output_gate_bias tensor
+
+                       {0, 0},  // projection_weight tensor
+                       {0},     // projection_bias tensor
+                       {n_batch},  // sequence_length tensor
+                   },
+                   /*use_sequence_length=*/true);
+
+  lstm.SetInputToInputWeights({-0.45018822, -0.02338299, -0.0870589,
+                               -0.34550029, 0.04266912, -0.15680569,
+                               -0.34856534, 0.43890524});
+
+  lstm.SetInputToCellWeights({-0.50013041, 0.1370284, 0.11810488, 0.2013163,
+                              -0.20583314, 0.44344562, 0.22077113,
+                              -0.29909778});
+
+  lstm.SetInputToForgetWeights({0.09701663, 0.20334584, -0.50592935,
+                                -0.31343272, -0.40032279, 0.44781327,
+                                0.01387155, -0.35593212});
+
+  lstm.SetInputToOutputWeights({-0.25065863, -0.28290087, 0.04613829,
+                                0.40525138, 0.44272184, 0.03897077, -0.1556896,
+                                0.19487578});
+
+  lstm.SetInputGateBias({0., 0., 0., 0.});
+
+  lstm.SetCellBias({0., 0., 0., 0.});
+
+  lstm.SetForgetGateBias({1., 1., 1., 1.});
+
+  lstm.SetOutputGateBias({0., 0., 0., 0.});
+
+  lstm.SetRecurrentToInputWeights(
+      {-0.0063535, -0.2042388, 0.31454784, -0.35746509, 0.28902304, 0.08183324,
+       -0.16555229, 0.02286911, -0.13566875, 0.03034258, 0.48091322,
+       -0.12528998, 0.24077177, -0.51332325, -0.33502164, 0.10629296});
+
+  lstm.SetRecurrentToCellWeights(
+      {-0.3407414, 0.24443203, -0.2078532, 0.26320225, 0.05695659, -0.00123841,
+       -0.4744786, -0.35869038, -0.06418842, -0.13502428, -0.501764, 0.22830659,
+       -0.46367589, 0.26016325, -0.03894562, -0.16368064});
+
+  lstm.SetRecurrentToForgetWeights(
+      {-0.48684245, -0.06655136, 0.42224967, 0.2112639, 0.27654213, 0.20864892,
+       -0.07646349, 0.45877004, 0.00141793, -0.14609534, 0.36447752, 0.09196436,
+       0.28053468, 0.01560611, -0.20127171, -0.01140004});
+
+  lstm.SetRecurrentToOutputWeights(
+      {0.43385774, -0.17194885, 0.2718237, 0.09215671, 0.24107647, -0.39835793,
+       0.18212086, 0.01301402, 0.48572797, -0.50656658, 0.20047462, -0.20607421,
+       -0.51818722, -0.15390486, 0.0468148, 0.39922136});
+
+  // Both batches see the same inputs as in the test above, but the second one
+  // stops after two steps.
+  lstm.SetSequenceLength({3, 2});
+  static float lstm_input[] = {2., 3., 2., 3.,  //
+                               3., 4., 3., 4.,  //
+                               1., 1., 1., 1.};
+  lstm.SetInput(0, lstm_input, lstm_input + max_time * n_batch * n_input);
+  lstm.ResetCellState();
+  lstm.ResetOutputState();
+  lstm.Invoke();
+
+  EXPECT_THAT(lstm.GetOutput(),
+              ElementsAreArray(ArrayFloatNear(
+                  {-0.02973187, 0.1229473,   0.20885126,  -0.15358765,  //
+                   -0.02973187, 0.1229473,   0.20885126,  -0.15358765,  //
+                   -0.03716109, 0.12507336,  0.41193449,  -0.20860538,  //
+                   -0.03716109, 0.12507336,  0.41193449,  -0.20860538,  //
+                   -0.15053082, 0.09120187,  0.24278517,  -0.12222792,  //
+                   0.,          0.,          0.,          0.})));
+}
+
 TEST(LSTMOpTest, BlackBoxTestWithCifgWithPeepholeNoProjectionNoClipping) {
   const int n_batch = 1;
   const int n_input = 2;
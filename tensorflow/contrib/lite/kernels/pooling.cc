@@ -22,12 +22,14 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/builtin_op_data.h"
 #include "tensorflow/contrib/lite/context.h"
+#include "tensorflow/contrib/lite/kernels/internal/optimized/multithreaded_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/reference/reference_ops.h"
 #include "tensorflow/contrib/lite/kernels/internal/tensor.h"
 #include "tensorflow/contrib/lite/kernels/kernel_util.h"
 #include "tensorflow/contrib/lite/kernels/op_macros.h"
 #include "tensorflow/contrib/lite/kernels/padding.h"
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
 
 namespace tflite {
 namespace ops {
@@ -135,7 +137,13 @@ void AverageEvalFloat(TfLiteContext* context, TfLiteNode* node,
   if (kernel_type == kReference) {
     TF_LITE_AVERAGE_POOL(reference_ops);
   } else {
-    TF_LITE_AVERAGE_POOL(optimized_ops);
+    multithreaded_ops::AveragePool(
+        thread_pool_support::GetFromContext(context),
+        GetTensorData<float>(input), GetTensorDims(input),
+        params->stride_width, params->stride_height, data->padding.width,
+        data->padding.height, params->filter_width, params->filter_height,
+        activation_min, activation_max, GetTensorData<float>(output),
+        GetTensorDims(output));
   }
 #undef TF_LITE_AVERAGE_POOL
 }
@@ -179,7 +187,13 @@ void MaxEvalFloat(TfLiteContext* context, TfLiteNode* node,
   if (kernel_type == kReference) {
     TF_LITE_MAX_POOL(reference_ops);
   } else {
-    TF_LITE_MAX_POOL(optimized_ops);
+    multithreaded_ops::MaxPool(
+        thread_pool_support::GetFromContext(context),
+        GetTensorData<float>(input), GetTensorDims(input),
+        params->stride_width, params->stride_height, data->padding.width,
+        data->padding.height, params->filter_width, params->filter_height,
+        activation_min, activation_max, GetTensorData<float>(output),
+        GetTensorDims(output));
   }
 #undef TF_LITE_MAX_POOL
 }
@@ -223,7 +237,13 @@ void L2EvalFloat(TfLiteContext* context, TfLiteNode* node,
   if (kernel_type == kReference) {
     TF_LITE_L2_POOL(reference_ops);
   } else {
-    TF_LITE_L2_POOL(optimized_ops);
+    multithreaded_ops::L2Pool(
+        thread_pool_support::GetFromContext(context),
+        GetTensorData<float>(input), GetTensorDims(input),
+        params->stride_width, params->stride_height, data->padding.width,
+        data->padding.height, params->filter_width, params->filter_height,
+        activation_min, activation_max, GetTensorData<float>(output),
+        GetTensorDims(output));
   }
 #undef TF_LITE_L2_POOL
 }
@@ -21,6 +21,7 @@ limitations under the License.
 #include <gtest/gtest.h>
 
 #include "tensorflow/contrib/lite/interpreter.h"
+#include "tensorflow/contrib/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/contrib/lite/kernels/register.h"
 #include "tensorflow/contrib/lite/model.h"
 #include "tensorflow/contrib/lite/string_util.h"
@@ -112,6 +113,22 @@ class SingleOpModel {
     PopulateTensor(index, 0, q.data(), q.data() + q.size());
   }
 
+  // Quantize the data symmetrically to int8 values, as the weights of hybrid
+  // kernels are, store them in the uint8 tensor and set its scale.
+  void SymmetricQuantizeAndPopulate(int index,
+                                    std::initializer_list<float> data) {
+    std::vector<float> values(data);
+    std::vector<int8_t> q(values.size());
+    float scale;
+    tensor_utils::SymmetricQuantizeFloats(values.data(), values.size(),
+                                          q.data(), &scale);
+    TfLiteTensor* t = interpreter_->tensor(index);
+    t->params.scale = scale;
+    t->params.zero_point = 0;
+    uint8_t* begin = reinterpret_cast<uint8_t*>(q.data());
+    PopulateTensor(index, 0, begin, begin + q.size());
+  }
+
   const std::vector<int>& GetShape(int id) { return tensor_data_.at(id).shape; }
 
   float GetScale(int id) { return tensor_data_.at(id).scale; }
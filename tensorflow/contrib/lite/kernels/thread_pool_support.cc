@@ -0,0 +1,181 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/contrib/lite/kernels/op_macros.h"
+
+namespace tflite {
+
+ThreadPool::ThreadPool(int num_threads)
+    : num_threads_(std::max(1, num_threads)) {
+  if (num_threads_ > 1) {
+    workers_.reserve(num_threads_);
+    for (int i = 0; i < num_threads_; ++i) {
+      workers_.emplace_back([this]() { WorkerLoop(); });
+    }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> fn) {
+  if (workers_.empty()) {
+    fn();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(fn));
+  }
+  work_available_.notify_one();
+}
+
+int ThreadPool::CurrentThreadId() const {
+  const std::thread::id id = std::this_thread::get_id();
+  for (int i = 0; i < workers_.size(); ++i) {
+    if (workers_[i].get_id() == id) return i;
+  }
+  return -1;
+}
+
+void ThreadPool::ParallelFor(int n, int min_block_size,
+                             const std::function<void(int, int)>& fn) {
+  if (n <= 0) return;
+  const int max_blocks = (n + std::max(1, min_block_size) - 1) /
+                         std::max(1, min_block_size);
+  const int num_blocks = std::min(num_threads_, max_blocks);
+  if (num_blocks <= 1 || workers_.empty()) {
+    fn(0, n);
+    return;
+  }
+
+  const int block_size = (n + num_blocks - 1) / num_blocks;
+  std::mutex done_mutex;
+  std::condition_variable done;
+  int pending = 0;
+  for (int start = block_size; start < n; start += block_size) {
+    const int end = std::min(n, start + block_size);
+    {
+      std::lock_guard<std::mutex> lock(done_mutex);
+      ++pending;
+    }
+    Schedule([&fn, &done_mutex, &done, &pending, start, end]() {
+      fn(start, end);
+      std::lock_guard<std::mutex> lock(done_mutex);
+      if (--pending == 0) done.notify_one();
+    });
+  }
+  fn(0, block_size);
+
+  std::unique_lock<std::mutex> lock(done_mutex);
+  done.wait(lock, [&pending]() { return pending == 0; });
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> fn;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock,
+                           [this]() { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) return;
+      fn = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    fn();
+  }
+}
+
+namespace thread_pool_support {
+namespace {
+
+// The number of threads used until SetNumThreads() is called. This matches the
+// pool that the multithreaded EigenTensor convolution used to own.
+constexpr int kDefaultNumThreads = 4;
+
+struct RefCountedThreadPool {
+  std::unique_ptr<ThreadPool> thread_pool_;
+  int num_threads_ = kDefaultNumThreads;
+  int num_references_ = 0;
+};
+
+}  // namespace
+
+void IncrementUsageCounter(TfLiteContext* context) {
+  auto* ptr =
+      reinterpret_cast<RefCountedThreadPool*>(context->thread_pool_context);
+  if (ptr == nullptr) {
+    ptr = new RefCountedThreadPool;
+    context->thread_pool_context = ptr;
+  }
+  ptr->num_references_++;
+}
+
+void DecrementUsageCounter(TfLiteContext* context) {
+  auto* ptr =
+      reinterpret_cast<RefCountedThreadPool*>(context->thread_pool_context);
+  if (ptr == nullptr) {
+    TF_LITE_FATAL(
+        "Call to DecrementUsageCounter() not preceded by "
+        "IncrementUsageCounter()");
+  }
+  if (--ptr->num_references_ == 0) {
+    delete ptr;
+    context->thread_pool_context = nullptr;
+  }
+}
+
+ThreadPool* GetFromContext(TfLiteContext* context) {
+  auto* ptr =
+      reinterpret_cast<RefCountedThreadPool*>(context->thread_pool_context);
+  if (ptr == nullptr) {
+    TF_LITE_FATAL(
+        "Call to GetFromContext() not preceded by IncrementUsageCounter()");
+  }
+  if (!ptr->thread_pool_) {
+    ptr->thread_pool_.reset(new ThreadPool(ptr->num_threads_));
+  }
+  return ptr->thread_pool_.get();
+}
+
+void SetNumThreads(TfLiteContext* context, int num_threads) {
+  IncrementUsageCounter(context);
+  auto* ptr =
+      reinterpret_cast<RefCountedThreadPool*>(context->thread_pool_context);
+  if (num_threads < 1) {
+    num_threads = kDefaultNumThreads;
+  }
+  if (ptr->num_threads_ != num_threads) {
+    ptr->num_threads_ = num_threads;
+    ptr->thread_pool_.reset();
+  }
+  DecrementUsageCounter(context);
+}
+
+}  // namespace thread_pool_support
+}  // namespace tflite
@@ -0,0 +1,92 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_THREAD_POOL_SUPPORT_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_THREAD_POOL_SUPPORT_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+
+// A fixed-size pool of worker threads on which kernels split their work.
+// A pool for N threads starts N workers if N > 1, and none otherwise, in which
+// case all work runs on the calling thread.
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int NumThreads() const { return num_threads_; }
+
+  // Runs 'fn' on one of the workers, or right away if there are none.
+  void Schedule(std::function<void()> fn);
+
+  // Returns the index of the calling worker thread, or -1 if the caller is not
+  // one of the workers.
+  int CurrentThreadId() const;
+
+  // Splits [0, n) into at most NumThreads() contiguous blocks of at least
+  // 'min_block_size' items, and calls fn(start, end) for each of them. One of
+  // the blocks runs on the calling thread, and this returns once all of them
+  // are done. Must not be called from one of the workers.
+  void ParallelFor(int n, int min_block_size,
+                   const std::function<void(int, int)>& fn);
+
+ private:
+  void WorkerLoop();
+
+  const int num_threads_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::deque<std::function<void()>> queue_;
+  bool stopping_ = false;
+};
+
+namespace thread_pool_support {
+
+// Returns the ThreadPool stored in 'context', allowing all the kernels that
+// share a TfLiteContext to share a single set of threads. The Interpreter
+// holds a usage counter for its whole lifetime, so kernels can call this from
+// Eval() without calling IncrementUsageCounter() themselves. The workers are
+// started on the first call.
+ThreadPool* GetFromContext(TfLiteContext* context);
+
+// Let the framework know that the ThreadPool stored in 'context' will be used.
+// If necessary the pool settings are created and placed in 'context'.
+void IncrementUsageCounter(TfLiteContext* context);
+
+// Let the framework know that the ThreadPool stored in 'context' is no longer
+// used. If there are no more usages the pool is deleted.
+void DecrementUsageCounter(TfLiteContext* context);
+
+// Set the number of threads used by the ThreadPool stored in 'context', or
+// restore the default if 'num_threads' is not positive. The workers of any
+// existing pool are stopped and restarted on the next use.
+void SetNumThreads(TfLiteContext* context, int num_threads);
+
+}  // namespace thread_pool_support
+}  // namespace tflite
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_KERNELS_THREAD_POOL_SUPPORT_H_
@@ -0,0 +1,115 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/kernels/thread_pool_support.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+// Checks that ParallelFor() calls its function exactly once for every item.
+void ExpectCoversRange(ThreadPool* pool, int n, int min_block_size) {
+  std::vector<std::atomic<int>> visits(n);
+  for (auto& count : visits) count = 0;
+  std::atomic<int> num_blocks(0);
+  pool->ParallelFor(n, min_block_size, [&](int start, int end) {
+    EXPECT_LT(start, end);
+    EXPECT_GE(end - start, std::min(n, min_block_size) / 2);
+    ++num_blocks;
+    for (int i = start; i < end; ++i) ++visits[i];
+  });
+  for (int i = 0; i < n; ++i) {
+    EXPECT_EQ(visits[i], 1) << "item " << i;
+  }
+  EXPECT_LE(num_blocks, pool->NumThreads());
+}
+
+TEST(ThreadPoolTest, ParallelForCoversRange) {
+  for (int num_threads : {1, 2, 3, 4}) {
+    ThreadPool pool(num_threads);
+    EXPECT_EQ(pool.NumThreads(), num_threads);
+    for (int n : {1, 2, 7, 100, 1001}) {
+      for (int min_block_size : {1, 10, 1000}) {
+        ExpectCoversRange(&pool, n, min_block_size);
+      }
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForSplitsWork) {
+  ThreadPool pool(4);
+  std::atomic<int> num_blocks(0);
+  pool.ParallelFor(100, 1, [&](int start, int end) { ++num_blocks; });
+  EXPECT_EQ(num_blocks, 4);
+
+  num_blocks = 0;
+  pool.ParallelFor(100, 60, [&](int start, int end) { ++num_blocks; });
+  EXPECT_EQ(num_blocks, 2);
+}
+
+TEST(ThreadPoolTest, Schedule) {
+  std::atomic<int> count(0);
+  {
+    ThreadPool pool(3);
+    for (int i = 0; i < 100; ++i) {
+      pool.Schedule([&count, &pool]() {
+        EXPECT_GE(pool.CurrentThreadId(), 0);
+        ++count;
+      });
+    }
+    EXPECT_EQ(pool.CurrentThreadId(), -1);
+  }
+  // The destructor runs all the functions that were already scheduled.
+  EXPECT_EQ(count, 100);
+
+  ThreadPool inline_pool(1);
+  inline_pool.Schedule([&count]() { ++count; });
+  EXPECT_EQ(count, 101);
+}
+
+TEST(ThreadPoolSupportTest, SharedThroughContext) {
+  TfLiteContext context;
+  context.thread_pool_context = nullptr;
+  thread_pool_support::IncrementUsageCounter(&context);
+  thread_pool_support::IncrementUsageCounter(&context);
+
+  ThreadPool* pool = thread_pool_support::GetFromContext(&context);
+  EXPECT_EQ(pool->NumThreads(), 4);
+  EXPECT_EQ(thread_pool_support::GetFromContext(&context), pool);
+
+  thread_pool_support::SetNumThreads(&context, 2);
+  EXPECT_EQ(thread_pool_support::GetFromContext(&context)->NumThreads(), 2);
+  thread_pool_support::SetNumThreads(&context, -1);
+  EXPECT_EQ(thread_pool_support::GetFromContext(&context)->NumThreads(), 4);
+
+  thread_pool_support::DecrementUsageCounter(&context);
+  EXPECT_NE(context.thread_pool_context, nullptr);
+  thread_pool_support::DecrementUsageCounter(&context);
+  EXPECT_EQ(context.thread_pool_context, nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
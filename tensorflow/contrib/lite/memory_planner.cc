@@ -0,0 +1,129 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/memory_planner.h"
+
+#include <algorithm>
+
+namespace tflite {
+
+constexpr int BufferLifetime::kBufferLiveForever;
+
+namespace {
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
+// Places the buffers in the given order. Each buffer goes into the smallest
+// gap between the buffers placed before it that are live at the same time,
+// or after all of them if no gap is large enough.
+TfLiteStatus PlaceInOrder(TfLiteContext* context, size_t alignment,
+                          const std::vector<BufferLifetime>& placed,
+                          const std::vector<int>& order,
+                          std::vector<BufferLifetime>* buffers) {
+  TF_LITE_ENSURE(context, alignment > 0);
+  std::vector<const BufferLifetime*> done;
+  done.reserve(placed.size() + buffers->size());
+  for (const BufferLifetime& buffer : placed) {
+    done.push_back(&buffer);
+  }
+
+  std::vector<const BufferLifetime*> live;
+  for (int index : order) {
+    BufferLifetime& buffer = (*buffers)[index];
+    TF_LITE_ENSURE(context, buffer.first_use <= buffer.last_use);
+
+    live.clear();
+    for (const BufferLifetime* other : done) {
+      if (other->OverlapsWith(buffer)) {
+        live.push_back(other);
+      }
+    }
+    std::sort(live.begin(), live.end(),
+              [](const BufferLifetime* a, const BufferLifetime* b) {
+                return a->offset < b->offset;
+              });
+
+    // Go through the live buffers by offset and look at the gaps between
+    // them. Live buffers may overlap each other when their own lifetimes
+    // don't, so the end of a gap is the furthest end seen so far.
+    size_t best_offset = 0;
+    size_t best_offset_fit = std::numeric_limits<size_t>::max();
+    size_t current_offset = 0;
+    for (const BufferLifetime* other : live) {
+      size_t aligned_current_offset = AlignTo(alignment, current_offset);
+      if (aligned_current_offset + buffer.size <= other->offset &&
+          other->offset - current_offset < best_offset_fit) {
+        best_offset = aligned_current_offset;
+        best_offset_fit = other->offset - current_offset;
+      }
+      current_offset = std::max(current_offset, other->offset + other->size);
+    }
+    if (best_offset_fit == std::numeric_limits<size_t>::max()) {
+      best_offset = AlignTo(alignment, current_offset);
+    }
+
+    buffer.offset = best_offset;
+    done.push_back(&buffer);
+  }
+  return kTfLiteOk;
+}
+
+std::vector<int> Iota(int size) {
+  std::vector<int> order(size);
+  for (int i = 0; i < size; ++i) {
+    order[i] = i;
+  }
+  return order;
+}
+
+}  // namespace
+
+TfLiteStatus ExecutionOrderMemoryPlanner::PlanOffsets(
+    TfLiteContext* context, size_t alignment,
+    const std::vector<BufferLifetime>& placed,
+    std::vector<BufferLifetime>* buffers) {
+  // Buffers that are first used by the same step keep their relative order.
+  std::vector<int> order = Iota(buffers->size());
+  std::stable_sort(order.begin(), order.end(), [buffers](int a, int b) {
+    return (*buffers)[a].first_use < (*buffers)[b].first_use;
+  });
+  return PlaceInOrder(context, alignment, placed, order, buffers);
+}
+
+TfLiteStatus GreedyBySizeMemoryPlanner::PlanOffsets(
+    TfLiteContext* context, size_t alignment,
+    const std::vector<BufferLifetime>& placed,
+    std::vector<BufferLifetime>* buffers) {
+  std::vector<int> order = Iota(buffers->size());
+  std::stable_sort(order.begin(), order.end(), [buffers](int a, int b) {
+    const BufferLifetime& lhs = (*buffers)[a];
+    const BufferLifetime& rhs = (*buffers)[b];
+    if (lhs.size != rhs.size) return lhs.size > rhs.size;
+    return lhs.first_use < rhs.first_use;
+  });
+  return PlaceInOrder(context, alignment, placed, order, buffers);
+}
+
+size_t RequiredArenaSize(const std::vector<BufferLifetime>& buffers) {
+  size_t size = 0;
+  for (const BufferLifetime& buffer : buffers) {
+    size = std::max(size, buffer.offset + buffer.size);
+  }
+  return size;
+}
+
+}  // namespace tflite
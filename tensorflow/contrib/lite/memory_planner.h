@@ -0,0 +1,90 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_MEMORY_PLANNER_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_MEMORY_PLANNER_H_
+
+#include <limits>
+#include <vector>
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+
+// A buffer in the memory arena that must stay valid from execution step
+// 'first_use' through 'last_use', inclusive. Buffers that are never released
+// have a 'last_use' of kBufferLiveForever.
+struct BufferLifetime {
+  static constexpr int kBufferLiveForever = std::numeric_limits<int>::max();
+
+  BufferLifetime() : size(0), first_use(0), last_use(0), offset(0) {}
+  BufferLifetime(size_t size, int first_use, int last_use)
+      : size(size), first_use(first_use), last_use(last_use), offset(0) {}
+
+  // Whether the two buffers need memory at the same time.
+  bool OverlapsWith(const BufferLifetime& other) const {
+    return first_use <= other.last_use && other.first_use <= last_use;
+  }
+
+  size_t size;
+  int first_use;
+  int last_use;
+  // The offset of the buffer from the start of the arena. This is an input
+  // for already placed buffers and an output for buffers being planned.
+  size_t offset;
+};
+
+// A memory planner assigns arena offsets to buffers whose lifetimes are known
+// up front, such that no two buffers that are live at the same time share
+// memory. Planners differ in how tightly they pack the buffers, which
+// determines the size of the arena.
+class MemoryPlanner {
+ public:
+  virtual ~MemoryPlanner() {}
+
+  // Sets the offset of every buffer in 'buffers' to a multiple of
+  // 'alignment'. Buffers in 'placed' keep their offsets and must not be
+  // overlapped by any new buffer that is live at the same time.
+  virtual TfLiteStatus PlanOffsets(TfLiteContext* context, size_t alignment,
+                                   const std::vector<BufferLifetime>& placed,
+                                   std::vector<BufferLifetime>* buffers) = 0;
+};
+
+// Places buffers in the order they are first used, each in the smallest gap
+// between the buffers that are live at that point. This is the layout that
+// allocating and deallocating in execution order from a SimpleMemoryArena
+// produces.
+class ExecutionOrderMemoryPlanner : public MemoryPlanner {
+ public:
+  TfLiteStatus PlanOffsets(TfLiteContext* context, size_t alignment,
+                           const std::vector<BufferLifetime>& placed,
+                           std::vector<BufferLifetime>* buffers) override;
+};
+
+// Places the largest buffers first, each in the smallest gap between the
+// already placed buffers whose lifetimes overlap with it. Since small buffers
+// fill the holes left between large ones, this usually needs a smaller arena
+// than planning in execution order, at O(n^2) planning cost.
+class GreedyBySizeMemoryPlanner : public MemoryPlanner {
+ public:
+  TfLiteStatus PlanOffsets(TfLiteContext* context, size_t alignment,
+                           const std::vector<BufferLifetime>& placed,
+                           std::vector<BufferLifetime>* buffers) override;
+};
+
+// Returns the arena size needed by 'buffers', i.e. the end of the last one.
+size_t RequiredArenaSize(const std::vector<BufferLifetime>& buffers);
+
+}  // namespace tflite
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_MEMORY_PLANNER_H_
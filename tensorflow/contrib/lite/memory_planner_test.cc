@@ -0,0 +1,151 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/contrib/lite/memory_planner.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+constexpr int kForever = BufferLifetime::kBufferLiveForever;
+
+void ReportError(TfLiteContext* context, const char* format, ...) {}
+
+// Returns whether any two buffers that are live at the same time share memory.
+bool HasConflicts(const std::vector<BufferLifetime>& buffers) {
+  for (int i = 0; i < buffers.size(); ++i) {
+    for (int j = i + 1; j < buffers.size(); ++j) {
+      const BufferLifetime& a = buffers[i];
+      const BufferLifetime& b = buffers[j];
+      if (a.OverlapsWith(b) && a.offset < b.offset + b.size &&
+          b.offset < a.offset + a.size) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+class MemoryPlannerTest : public ::testing::Test {
+ protected:
+  MemoryPlannerTest() { context_.ReportError = ReportError; }
+
+  TfLiteContext context_;
+};
+
+// The same allocations as SimpleMemoryArenaTest.BasicArenaOperations, which
+// planning in execution order must lay out identically.
+TEST_F(MemoryPlannerTest, ExecutionOrderMatchesArena) {
+  std::vector<BufferLifetime> buffers = {
+      {2047, 0, 0},       {2047, 0, 1},       {2047, 0, kForever},
+      {1023, 1, kForever}, {2047, 1, kForever}, {1023, 2, kForever},
+  };
+  ExecutionOrderMemoryPlanner planner;
+  ASSERT_EQ(planner.PlanOffsets(&context_, 32, {}, &buffers), kTfLiteOk);
+
+  EXPECT_EQ(buffers[0].offset, 0);
+  EXPECT_EQ(buffers[1].offset, 2048);
+  EXPECT_EQ(buffers[2].offset, 4096);
+  EXPECT_EQ(buffers[3].offset, 0);
+  EXPECT_EQ(buffers[4].offset, 6144);
+  EXPECT_EQ(buffers[5].offset, 1024);
+  EXPECT_FALSE(HasConflicts(buffers));
+}
+
+TEST_F(MemoryPlannerTest, GreedyBySizeAvoidsFragmentation) {
+  // In execution order the first buffer leaves a hole that is too small for
+  // the last one.
+  std::vector<BufferLifetime> in_order = {
+      {16, 0, 1}, {32, 0, 2}, {48, 2, 3},
+  };
+  std::vector<BufferLifetime> by_size = in_order;
+
+  ExecutionOrderMemoryPlanner execution_order_planner;
+  ASSERT_EQ(execution_order_planner.PlanOffsets(&context_, 4, {}, &in_order),
+            kTfLiteOk);
+  EXPECT_EQ(in_order[0].offset, 0);
+  EXPECT_EQ(in_order[1].offset, 16);
+  EXPECT_EQ(in_order[2].offset, 48);
+  EXPECT_EQ(RequiredArenaSize(in_order), 96);
+
+  GreedyBySizeMemoryPlanner greedy_planner;
+  ASSERT_EQ(greedy_planner.PlanOffsets(&context_, 4, {}, &by_size), kTfLiteOk);
+  EXPECT_EQ(by_size[0].offset, 0);
+  EXPECT_EQ(by_size[1].offset, 48);
+  EXPECT_EQ(by_size[2].offset, 0);
+  EXPECT_EQ(RequiredArenaSize(by_size), 80);
+  EXPECT_FALSE(HasConflicts(by_size));
+}
+
+TEST_F(MemoryPlannerTest, RespectsPlacedBuffers) {
+  std::vector<BufferLifetime> placed = {{64, 0, 3}};
+  std::vector<BufferLifetime> buffers = {{30, 1, 1}, {30, 4, 4}, {8, 2, 5}};
+
+  GreedyBySizeMemoryPlanner planner;
+  ASSERT_EQ(planner.PlanOffsets(&context_, 16, placed, &buffers), kTfLiteOk);
+
+  // Only buffers that are live with the placed one have to go after it.
+  EXPECT_EQ(buffers[0].offset, 64);
+  EXPECT_EQ(buffers[1].offset, 0);
+  EXPECT_EQ(buffers[2].offset, 64);
+  EXPECT_EQ(placed[0].offset, 0);
+
+  std::vector<BufferLifetime> all = placed;
+  all.insert(all.end(), buffers.begin(), buffers.end());
+  EXPECT_FALSE(HasConflicts(all));
+}
+
+TEST_F(MemoryPlannerTest, RandomLifetimesDoNotConflict) {
+  std::vector<BufferLifetime> buffers;
+  unsigned int seed = 1;
+  for (int i = 0; i < 200; ++i) {
+    seed = seed * 1103515245 + 12345;
+    int first_use = (seed >> 8) % 50;
+    seed = seed * 1103515245 + 12345;
+    int last_use = first_use + (seed >> 8) % 10;
+    seed = seed * 1103515245 + 12345;
+    buffers.emplace_back(1 + (seed >> 8) % 1000, first_use, last_use);
+  }
+  std::vector<BufferLifetime> by_size = buffers;
+
+  ExecutionOrderMemoryPlanner execution_order_planner;
+  ASSERT_EQ(execution_order_planner.PlanOffsets(&context_, 4, {}, &buffers),
+            kTfLiteOk);
+  EXPECT_FALSE(HasConflicts(buffers));
+
+  GreedyBySizeMemoryPlanner greedy_planner;
+  ASSERT_EQ(greedy_planner.PlanOffsets(&context_, 4, {}, &by_size), kTfLiteOk);
+  EXPECT_FALSE(HasConflicts(by_size));
+  for (const BufferLifetime& buffer : by_size) {
+    EXPECT_EQ(buffer.offset % 4, 0);
+  }
+}
+
+TEST_F(MemoryPlannerTest, InvalidLifetime) {
+  std::vector<BufferLifetime> buffers = {{16, 2, 1}};
+  GreedyBySizeMemoryPlanner planner;
+  EXPECT_EQ(planner.PlanOffsets(&context_, 4, {}, &buffers), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::tflite::LogToStderr();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -16,6 +16,7 @@ limitations under the License.
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -200,9 +201,11 @@ void FlatBufferIntVectorToArray(int max_size_of_buffer,
 // POD structure that doesn't require constructors to run. The reason we do
 // this, is that Interpreter's C extension part will take ownership and wants
 // to use malloc() and free().
+// The size of the structure is stored in 'size'.
 template <class T>
-T* MallocPOD() {
+T* MallocPOD(size_t* size) {
   static_assert(std::is_pod<T>::value, "Builtin data structure must be POD.");
+  *size = sizeof(T);
   return static_cast<T*>(malloc(sizeof(T)));
 }
 
@@ -210,12 +213,13 @@ T* MallocPOD() {
 //
 // This handles builtin data explicitly as there are flatbuffer schemas.
 //
-// Returns memory that must be feed.
+// Returns memory that must be feed, whose size is stored in
+// 'builtin_data_size'.
 //
 // TODO(nupurgarg): Pass in void ** and return TfLiteStatus to ensure program
 // crashes if error reporter is called.
 void* ParseOpData(const Operator* op, BuiltinOperator op_type,
-                  ErrorReporter* error_reporter) {
+                  ErrorReporter* error_reporter, size_t* builtin_data_size) {
   auto parse_padding = [](Padding padding) {
     switch (padding) {
       case Padding_SAME:
@@ -265,6 +269,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
   };
 
   void* builtin_data = nullptr;
+  *builtin_data_size = 0;
   switch (op_type) {
     case BuiltinOperator_CALL:
       // TODO(aselle): Implement call in BuiltinOptions, but nullptrs are
@@ -273,7 +278,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
     case BuiltinOperator_CUSTOM:
       break;
     case BuiltinOperator_CONV_2D: {
-      TfLiteConvParams* params = MallocPOD<TfLiteConvParams>();
+      TfLiteConvParams* params = MallocPOD<TfLiteConvParams>(builtin_data_size);
       if (auto* conv_params = op->builtin_options_as_Conv2DOptions()) {
         params->padding = parse_padding(conv_params->padding());
         params->stride_width = conv_params->stride_w();
@@ -293,7 +298,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     case BuiltinOperator_LSH_PROJECTION: {
       TfLiteLSHProjectionParams* params =
-          MallocPOD<TfLiteLSHProjectionParams>();
+          MallocPOD<TfLiteLSHProjectionParams>(builtin_data_size);
       if (auto* lshParams = op->builtin_options_as_LSHProjectionOptions()) {
         params->type = parseLSHProjectionType(lshParams->type());
       }
@@ -303,7 +308,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
     case BuiltinOperator_AVERAGE_POOL_2D:
     case BuiltinOperator_MAX_POOL_2D:
     case BuiltinOperator_L2_POOL_2D: {
-      TfLitePoolParams* params = MallocPOD<TfLitePoolParams>();
+      TfLitePoolParams* params = MallocPOD<TfLitePoolParams>(builtin_data_size);
       if (auto* pool_params = op->builtin_options_as_Pool2DOptions()) {
         params->padding = parse_padding(pool_params->padding());
         params->stride_width = pool_params->stride_w();
@@ -318,7 +323,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
     }
     case BuiltinOperator_DEPTHWISE_CONV_2D: {
       TfLiteDepthwiseConvParams* params =
-          MallocPOD<TfLiteDepthwiseConvParams>();
+          MallocPOD<TfLiteDepthwiseConvParams>(builtin_data_size);
       if (auto* conv_params = op->builtin_options_as_DepthwiseConv2DOptions()) {
         params->padding = parse_padding(conv_params->padding());
         params->stride_width = conv_params->stride_w();
@@ -330,8 +335,25 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       builtin_data = reinterpret_cast<void*>(params);
       break;
     }
+    case BuiltinOperator_DEPTHWISE_SEPARABLE_CONV_2D: {
+      auto* params =
+          MallocPOD<TfLiteDepthwiseSeparableConvParams>(builtin_data_size);
+      if (auto* conv_params =
+              op->builtin_options_as_DepthwiseSeparableConv2DOptions()) {
+        params->padding = parse_padding(conv_params->padding());
+        params->stride_width = conv_params->stride_w();
+        params->stride_height = conv_params->stride_h();
+        params->depth_multiplier = conv_params->depth_multiplier();
+        params->depthwise_activation =
+            parse_activation(conv_params->depthwise_activation_function());
+        params->activation =
+            parse_activation(conv_params->fused_activation_function());
+      }
+      builtin_data = reinterpret_cast<void*>(params);
+      break;
+    }
     case BuiltinOperator_SVDF: {
-      TfLiteSVDFParams* params = MallocPOD<TfLiteSVDFParams>();
+      TfLiteSVDFParams* params = MallocPOD<TfLiteSVDFParams>(builtin_data_size);
       if (auto* svdf_params = op->builtin_options_as_SVDFOptions()) {
         params->rank = svdf_params->rank();
         params->activation =
@@ -341,7 +363,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_RNN: {
-      TfLiteRNNParams* params = MallocPOD<TfLiteRNNParams>();
+      TfLiteRNNParams* params = MallocPOD<TfLiteRNNParams>(builtin_data_size);
       if (auto* rnn_params = op->builtin_options_as_RNNOptions()) {
         params->activation =
             parse_activation(rnn_params->fused_activation_function());
@@ -354,7 +376,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     case BuiltinOperator_EMBEDDING_LOOKUP_SPARSE: {
       TfLiteEmbeddingLookupSparseParams* params =
-          MallocPOD<TfLiteEmbeddingLookupSparseParams>();
+          MallocPOD<TfLiteEmbeddingLookupSparseParams>(builtin_data_size);
       if (auto* embedding_params =
               op->builtin_options_as_EmbeddingLookupSparseOptions()) {
         params->combiner = parseCombinerType(embedding_params->combiner());
@@ -364,11 +386,13 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
     }
     case BuiltinOperator_FULLY_CONNECTED: {
       TfLiteFullyConnectedParams* params =
-          MallocPOD<TfLiteFullyConnectedParams>();
+          MallocPOD<TfLiteFullyConnectedParams>(builtin_data_size);
       if (auto* fully_connected_params =
               op->builtin_options_as_FullyConnectedOptions()) {
         params->activation = parse_activation(
             fully_connected_params->fused_activation_function());
+        params->weights_only_quantized =
+            fully_connected_params->weights_only_quantized();
       }
       builtin_data = reinterpret_cast<void*>(params);
       break;
@@ -377,7 +401,8 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       // no-op.
       break;
     case BuiltinOperator_SOFTMAX: {
-      TfLiteSoftmaxParams* params = MallocPOD<TfLiteSoftmaxParams>();
+      TfLiteSoftmaxParams* params =
+          MallocPOD<TfLiteSoftmaxParams>(builtin_data_size);
       if (auto* softmax_params = op->builtin_options_as_SoftmaxOptions()) {
         params->beta = softmax_params->beta();
       }
@@ -386,7 +411,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
     }
     case BuiltinOperator_CONCATENATION: {
       TfLiteConcatenationParams* params =
-          MallocPOD<TfLiteConcatenationParams>();
+          MallocPOD<TfLiteConcatenationParams>(builtin_data_size);
       if (auto* concatenation_params =
               op->builtin_options_as_ConcatenationOptions()) {
         params->activation =
@@ -397,7 +422,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_MUL: {
-      auto* params = MallocPOD<TfLiteMulParams>();
+      auto* params = MallocPOD<TfLiteMulParams>(builtin_data_size);
       if (auto* schema_params = op->builtin_options_as_MulOptions()) {
         params->activation =
             parse_activation(schema_params->fused_activation_function());
@@ -406,7 +431,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_ADD: {
-      auto* params = MallocPOD<TfLiteAddParams>();
+      auto* params = MallocPOD<TfLiteAddParams>(builtin_data_size);
       if (auto* schema_params = op->builtin_options_as_AddOptions()) {
         params->activation =
             parse_activation(schema_params->fused_activation_function());
@@ -415,7 +440,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_L2_NORMALIZATION: {
-      auto* params = MallocPOD<TfLiteL2NormParams>();
+      auto* params = MallocPOD<TfLiteL2NormParams>(builtin_data_size);
       if (auto* schema_params = op->builtin_options_as_L2NormOptions()) {
         params->activation =
             parse_activation(schema_params->fused_activation_function());
@@ -424,7 +449,8 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_LOCAL_RESPONSE_NORMALIZATION: {
-      auto* params = MallocPOD<TfLiteLocalResponseNormParams>();
+      auto* params =
+          MallocPOD<TfLiteLocalResponseNormParams>(builtin_data_size);
       if (auto* schema_params =
               op->builtin_options_as_LocalResponseNormalizationOptions()) {
         params->radius = schema_params->radius();
@@ -436,18 +462,19 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_LSTM: {
-      TfLiteLSTMParams* params = MallocPOD<TfLiteLSTMParams>();
+      TfLiteLSTMParams* params = MallocPOD<TfLiteLSTMParams>(builtin_data_size);
       if (auto* lstm_params = op->builtin_options_as_LSTMOptions()) {
         params->activation =
             parse_activation(lstm_params->fused_activation_function());
         params->cell_clip = lstm_params->cell_clip();
         params->proj_clip = lstm_params->proj_clip();
+        params->weights_only_quantized = lstm_params->weights_only_quantized();
       }
       builtin_data = reinterpret_cast<void*>(params);
       break;
     }
     case BuiltinOperator_RESIZE_BILINEAR: {
-      auto* params = MallocPOD<TfLiteResizeBilinearParams>();
+      auto* params = MallocPOD<TfLiteResizeBilinearParams>(builtin_data_size);
       if (auto* schema_params =
               op->builtin_options_as_ResizeBilinearOptions()) {
         params->new_height = schema_params->new_height();
@@ -457,7 +484,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_PAD: {
-      auto* params = MallocPOD<TfLitePadParams>();
+      auto* params = MallocPOD<TfLitePadParams>(builtin_data_size);
       if (auto* schema_params = op->builtin_options_as_PadOptions()) {
         auto* before_padding = schema_params->before_padding();
         FlatBufferIntVectorToArray(sizeof(params->before_padding),
@@ -479,7 +506,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_RESHAPE: {
-      auto* params = MallocPOD<TfLiteReshapeParams>();
+      auto* params = MallocPOD<TfLiteReshapeParams>(builtin_data_size);
       if (auto* schema_params = op->builtin_options_as_ReshapeOptions()) {
         auto* new_shape = schema_params->new_shape();
         FlatBufferIntVectorToArray(sizeof(params->shape), new_shape,
@@ -490,7 +517,8 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_SKIP_GRAM: {
-      TfLiteSkipGramParams* params = MallocPOD<TfLiteSkipGramParams>();
+      TfLiteSkipGramParams* params =
+          MallocPOD<TfLiteSkipGramParams>(builtin_data_size);
       if (auto* skip_gram_params = op->builtin_options_as_SkipGramOptions()) {
         params->ngram_size = skip_gram_params->ngram_size();
         params->max_skip_size = skip_gram_params->max_skip_size();
@@ -500,7 +528,7 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
       break;
     }
     case BuiltinOperator_SPACE_TO_DEPTH: {
-      auto* params = MallocPOD<TfLiteSpaceToDepthParams>();
+      auto* params = MallocPOD<TfLiteSpaceToDepthParams>(builtin_data_size);
       if (auto* schema_params = op->builtin_options_as_SpaceToDepthOptions()) {
         params->block_size = schema_params->block_size();
       }
@@ -514,9 +542,10 @@ void* ParseOpData(const Operator* op, BuiltinOperator op_type,
 }  // namespace
 
 TfLiteStatus InterpreterBuilder::ParseNodes(
-    const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
-    Interpreter* interpreter) {
+    const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators) {
   TfLiteStatus status = kTfLiteOk;
+  parsed_nodes_.clear();
+  parsed_nodes_.reserve(operators->Length());
   for (int i = 0; i < operators->Length(); ++i) {
     const auto* op = operators->Get(i);
     int index = op->opcode_index();
@@ -541,18 +570,25 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
           "Found builtin operator %s with custom options.\n",
           EnumNameBuiltinOperator(op_type));
     }
+    ParsedNode node;
+    node.inputs = FlatBufferIntArrayToVector(op->inputs());
+    node.outputs = FlatBufferIntArrayToVector(op->outputs());
+    node.registration = reg;
     if (op->custom_options()) {
-      interpreter->AddNodeWithParameters(
-          FlatBufferIntArrayToVector(op->inputs()),
-          FlatBufferIntArrayToVector(op->outputs()),
-          reinterpret_cast<const char*>(op->custom_options()->data()),
-          op->custom_options()->size(), nullptr, reg);
+      node.custom_options =
+          reinterpret_cast<const char*>(op->custom_options()->data());
+      node.custom_options_size = op->custom_options()->size();
     } else {
-      interpreter->AddNodeWithParameters(
-          FlatBufferIntArrayToVector(op->inputs()),
-          FlatBufferIntArrayToVector(op->outputs()), nullptr, 0,
-          ParseOpData(op, op_type, error_reporter_), reg);
+      size_t builtin_data_size;
+      void* builtin_data =
+          ParseOpData(op, op_type, error_reporter_, &builtin_data_size);
+      if (builtin_data) {
+        const char* bytes = static_cast<const char*>(builtin_data);
+        node.builtin_data.assign(bytes, bytes + builtin_data_size);
+        free(builtin_data);
+      }
     }
+    parsed_nodes_.push_back(std::move(node));
   }
 
   return status;
@@ -560,8 +596,7 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
 
 TfLiteStatus InterpreterBuilder::ParseTensors(
     const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
-    const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
-    Interpreter* interpreter) {
+    const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors) {
   TfLiteStatus status = kTfLiteOk;
 
   // A little helper to get the names of inputs and outputs. Note that they
@@ -572,11 +607,15 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     return kEmptyTensorName;
   };
 
+  parsed_tensors_.clear();
+  parsed_tensors_.resize(tensors->Length());
   for (int i = 0; i < tensors->Length(); ++i) {
     const auto* tensor = tensors->Get(i);
-    std::vector<int> dims = FlatBufferIntArrayToVector(tensor->shape());
+    ParsedTensor& parsed_tensor = parsed_tensors_[i];
+    parsed_tensor.dims = FlatBufferIntArrayToVector(tensor->shape());
+    parsed_tensor.name = get_name(tensor);
 
-    TfLiteQuantizationParams quantization;
+    TfLiteQuantizationParams& quantization = parsed_tensor.quantization;
     quantization.scale = 0;
     quantization.zero_point = 0;
     auto* q_params = tensor->quantization();
@@ -590,7 +629,7 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
         quantization.zero_point = q_params->zero_point()->Get(0);
     }
 
-    TfLiteType type;
+    TfLiteType& type = parsed_tensor.type;
     switch (tensor->type()) {
       case TensorType_FLOAT32:
         type = kTfLiteFloat32;
@@ -638,28 +677,94 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
       }
       return kTfLiteOk;
     };
-    size_t buffer_size = 0;
-    const char* buffer_ptr;
-    TF_LITE_ENSURE_STATUS(get_readonly_data(&buffer_ptr, &buffer_size));
+    TF_LITE_ENSURE_STATUS(get_readonly_data(&parsed_tensor.buffer,
+                                            &parsed_tensor.buffer_size));
+  }
+
+  return status;
+}
+
+TfLiteStatus InterpreterBuilder::ParseModel() {
+  if (parsed_) return kTfLiteOk;
+
+  if (model_->version() != TFLITE_SCHEMA_VERSION) {
+    error_reporter_->Report(
+        "Model provided is schema version %d not equal "
+        "to supported version %d.\n",
+        model_->version(), TFLITE_SCHEMA_VERSION);
+    return kTfLiteError;
+  }
+
+  flatbuffer_op_index_to_registration_.clear();
+  flatbuffer_op_index_to_registration_types_.clear();
+  if (BuildLocalIndexToRegistrationMapping() != kTfLiteOk) {
+    error_reporter_->Report("Registration failed.\n");
+    return kTfLiteError;
+  }
+
+  // Flatbuffer model schemas define a list of opcodes independent of the graph.
+  // We first map those to registrations. This reduces string lookups for custom
+  // ops since we only do it once per custom op rather than once per custom op
+  // invocation in the model graph.
+  auto* subgraphs = model_->subgraphs();
+  auto* buffers = model_->buffers();
+  if (subgraphs->size() != 1) {
+    error_reporter_->Report("Only 1 subgraph is currently supported.\n");
+    return kTfLiteError;
+  }
+  const tflite::SubGraph* subgraph = (*subgraphs)[0];
+  auto operators = subgraph->operators();
+  auto tensors = subgraph->tensors();
+  if (!operators || !tensors || !buffers) {
+    error_reporter_->Report(
+        "Did not get operators, tensors, or buffers in input flat buffer.\n");
+    return kTfLiteError;
+  }
+
+  parsed_inputs_ = FlatBufferIntArrayToVector(subgraph->inputs());
+  parsed_outputs_ = FlatBufferIntArrayToVector(subgraph->outputs());
+  TF_LITE_ENSURE_STATUS(ParseNodes(operators));
+  TF_LITE_ENSURE_STATUS(ParseTensors(buffers, tensors));
+  parsed_ = true;
+  return kTfLiteOk;
+}
+
+TfLiteStatus InterpreterBuilder::AddParsedNodes(Interpreter* interpreter) {
+  for (const ParsedNode& node : parsed_nodes_) {
+    void* builtin_data = nullptr;
+    if (!node.builtin_data.empty()) {
+      builtin_data = malloc(node.builtin_data.size());
+      memcpy(builtin_data, node.builtin_data.data(), node.builtin_data.size());
+    }
+    interpreter->AddNodeWithParameters(
+        node.inputs, node.outputs, node.custom_options,
+        node.custom_options_size, builtin_data, node.registration);
+  }
+  return kTfLiteOk;
+}
 
-    if (buffer_ptr) {
+TfLiteStatus InterpreterBuilder::AddParsedTensors(Interpreter* interpreter) {
+  TfLiteStatus status = kTfLiteOk;
+  for (int i = 0; i < parsed_tensors_.size(); ++i) {
+    const ParsedTensor& tensor = parsed_tensors_[i];
+    if (tensor.buffer) {
       if (interpreter->SetTensorParametersReadOnly(
-              i, type, get_name(tensor), dims, quantization, buffer_ptr,
-              buffer_size, allocation_) != kTfLiteOk) {
+              i, tensor.type, tensor.name, tensor.dims, tensor.quantization,
+              tensor.buffer, tensor.buffer_size, allocation_) != kTfLiteOk) {
         error_reporter_->Report("Tensor %d is invalidly specified in schema.\n",
                                 i);
         status = kTfLiteError;
       }
     } else {
       if (interpreter->SetTensorParametersReadWrite(
-              i, type, get_name(tensor), dims, quantization) != kTfLiteOk) {
+              i, tensor.type, tensor.name, tensor.dims,
+              tensor.quantization) != kTfLiteOk) {
         error_reporter_->Report("Tensor %d is invalidly specified in schema.\n",
                                 i);
         status = kTfLiteError;
       }
     }
   }
-
   return status;
 }
 
@@ -683,51 +788,21 @@ TfLiteStatus InterpreterBuilder::operator()(
     return cleanup_and_error();
   }
 
-  if (model_->version() != TFLITE_SCHEMA_VERSION) {
-    error_reporter_->Report(
-        "Model provided is schema version %d not equal "
-        "to supported version %d.\n",
-        model_->version(), TFLITE_SCHEMA_VERSION);
-    return cleanup_and_error();
-  }
-
-  if (BuildLocalIndexToRegistrationMapping() != kTfLiteOk) {
-    error_reporter_->Report("Registration failed.\n");
-    return cleanup_and_error();
-  }
+  if (ParseModel() != kTfLiteOk) return cleanup_and_error();
 
-  // Flatbuffer model schemas define a list of opcodes independent of the graph.
-  // We first map those to registrations. This reduces string lookups for custom
-  // ops since we only do it once per custom op rather than once per custom op
-  // invocation in the model graph.
-  // Construct interpreter with correct number of tensors and operators.
-  auto* subgraphs = model_->subgraphs();
-  auto* buffers = model_->buffers();
-  if (subgraphs->size() != 1) {
-    error_reporter_->Report("Only 1 subgraph is currently supported.\n");
-    return cleanup_and_error();
-  }
-  const tflite::SubGraph* subgraph = (*subgraphs)[0];
-  auto operators = subgraph->operators();
-  auto tensors = subgraph->tensors();
-  if (!operators || !tensors || !buffers) {
-    error_reporter_->Report(
-        "Did not get operators, tensors, or buffers in input flat buffer.\n");
-    return cleanup_and_error();
-  }
   interpreter->reset(new Interpreter(error_reporter_));
-  if ((**interpreter).AddTensors(tensors->Length()) != kTfLiteOk) {
+  if ((**interpreter).AddTensors(parsed_tensors_.size()) != kTfLiteOk) {
     return cleanup_and_error();
   }
 
   // Parse inputs/outputs
-  (**interpreter).SetInputs(FlatBufferIntArrayToVector(subgraph->inputs()));
-  (**interpreter).SetOutputs(FlatBufferIntArrayToVector(subgraph->outputs()));
+  (**interpreter).SetInputs(parsed_inputs_);
+  (**interpreter).SetOutputs(parsed_outputs_);
 
   // Finally setup nodes and tensors
-  if (ParseNodes(operators, interpreter->get()) != kTfLiteOk)
+  if (AddParsedNodes(interpreter->get()) != kTfLiteOk)
     return cleanup_and_error();
-  if (ParseTensors(buffers, tensors, interpreter->get()) != kTfLiteOk)
+  if (AddParsedTensors(interpreter->get()) != kTfLiteOk)
     return cleanup_and_error();
 
   return kTfLiteOk;
@@ -138,6 +138,13 @@ class OpResolver {
 // Returns a kTfLiteOk when successful and sets interpreter to a valid
 // Interpreter. Note: the user must ensure the model lifetime is at least as
 // long as interpreter's lifetime.
+//
+// The builder can be called repeatedly to make several interpreters for the
+// same model, e.g. one per thread. The first call resolves the op
+// registrations and parses the nodes and tensors of the flatbuffer; the
+// following calls reuse that work. The read-only tensors (weights) of all
+// the interpreters point into the model's buffer rather than being copied.
+// The builder itself must not be called from several threads at once.
 class InterpreterBuilder {
  public:
   InterpreterBuilder(const FlatBufferModel& model,
@@ -153,14 +160,41 @@ class InterpreterBuilder {
   TfLiteStatus operator()(std::unique_ptr<Interpreter>* interpreter);
 
  private:
+  // A node of the model, ready to be added to an interpreter.
+  struct ParsedNode {
+    std::vector<int> inputs;
+    std::vector<int> outputs;
+    const char* custom_options = nullptr;
+    size_t custom_options_size = 0;
+    // A copy of the builtin data, which every interpreter gets its own
+    // malloc()ed copy of, as it takes ownership of it.
+    std::vector<char> builtin_data;
+    const TfLiteRegistration* registration = nullptr;
+  };
+
+  // A tensor of the model. 'buffer' points into the model for read-only
+  // tensors, and is null otherwise.
+  struct ParsedTensor {
+    TfLiteType type;
+    std::vector<int> dims;
+    TfLiteQuantizationParams quantization;
+    const char* name;
+    const char* buffer = nullptr;
+    size_t buffer_size = 0;
+  };
+
   TfLiteStatus BuildLocalIndexToRegistrationMapping();
+  // Parses the model into parsed_inputs_, parsed_nodes_ etc. the first time
+  // it's called.
+  TfLiteStatus ParseModel();
   TfLiteStatus ParseNodes(
-      const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
-      Interpreter* interpreter);
+      const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators);
   TfLiteStatus ParseTensors(
       const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
-      const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
-      Interpreter* interpreter);
+      const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors);
+  // Adds the parsed nodes and tensors to 'interpreter'.
+  TfLiteStatus AddParsedNodes(Interpreter* interpreter);
+  TfLiteStatus AddParsedTensors(Interpreter* interpreter);
 
   const ::tflite::Model* model_;
   const OpResolver& op_resolver_;
@@ -169,6 +203,12 @@ class InterpreterBuilder {
   std::vector<TfLiteRegistration*> flatbuffer_op_index_to_registration_;
   std::vector<BuiltinOperator> flatbuffer_op_index_to_registration_types_;
   const Allocation* allocation_ = nullptr;
+
+  bool parsed_ = false;
+  std::vector<int> parsed_inputs_;
+  std::vector<int> parsed_outputs_;
+  std::vector<ParsedNode> parsed_nodes_;
+  std::vector<ParsedTensor> parsed_tensors_;
 };
 
 }  // namespace tflite
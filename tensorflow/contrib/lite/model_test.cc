@@ -194,6 +194,37 @@ TEST(BasicFlatBufferModel, TestModelInInterpreter) {
   }
 }
 
+// Interpreters made by the same builder share the read-only tensors of the
+// model.
+TEST(BasicFlatBufferModel, TestMultipleInterpretersFromOneBuilder) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/contrib/lite/testdata/test_model.bin");
+  ASSERT_TRUE(model);
+  TrivialResolver resolver(&dummy_reg);
+  InterpreterBuilder builder(*model, resolver);
+  std::unique_ptr<Interpreter> interpreter1;
+  std::unique_ptr<Interpreter> interpreter2;
+  ASSERT_EQ(builder(&interpreter1), kTfLiteOk);
+  ASSERT_EQ(builder(&interpreter2), kTfLiteOk);
+  ASSERT_NE(interpreter1, nullptr);
+  ASSERT_NE(interpreter2, nullptr);
+  ASSERT_NE(interpreter1.get(), interpreter2.get());
+
+  for (Interpreter* interpreter : {interpreter1.get(), interpreter2.get()}) {
+    ASSERT_EQ(interpreter->tensors_size(), 4);
+    ASSERT_EQ(interpreter->nodes_size(), 2);
+    EXPECT_EQ(interpreter->inputs(), std::vector<int>({0, 1}));
+    EXPECT_EQ(interpreter->outputs(), std::vector<int>({2, 3}));
+    EXPECT_EQ(std::string(interpreter->GetInputName(0)), "input0");
+    EXPECT_EQ(interpreter->tensor(0)->allocation_type, kTfLiteMmapRo);
+    EXPECT_EQ(interpreter->tensor(1)->allocation_type, kTfLiteArenaRw);
+  }
+  EXPECT_EQ(interpreter1->tensor(0)->data.raw,
+            interpreter2->tensor(0)->data.raw);
+  EXPECT_EQ(interpreter1->node_and_registration(1)->second, dummy_reg);
+  EXPECT_EQ(interpreter2->node_and_registration(1)->second, dummy_reg);
+}
+
 // This tests on a flatbuffer that defines a shape of 2 to be a memory mapped
 // buffer. But the buffer is provided to be only 1 element.
 TEST(BasicFlatBufferModel, TestBrokenMmap) {
@@ -192,6 +192,10 @@ void AddOpsAndParams(tflite::Interpreter* interpreter,
 
     auto add_fully_connected_params = [&add_scalar_int32](void* data) {
       auto builtin = reinterpret_cast<TfLiteFullyConnectedParams*>(data);
+      if (builtin->weights_only_quantized) {
+        FATAL("FullyConnected with quantized weights is not supported in "
+              "NNAPI");
+      }
       add_scalar_int32(builtin->activation);
     };
 
@@ -305,6 +309,7 @@ void AddOpsAndParams(tflite::Interpreter* interpreter,
       case tflite::BuiltinOperator_CALL:
       case tflite::BuiltinOperator_SKIP_GRAM:
       case tflite::BuiltinOperator_RELU1:
+      case tflite::BuiltinOperator_DEPTHWISE_SEPARABLE_CONV_2D:
         FATAL("Op code %d is currently not delegated to NNAPI", builtin);
         nn_op_type = -1;  // set to invalid
         break;
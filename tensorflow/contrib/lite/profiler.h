@@ -0,0 +1,43 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_PROFILER_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_PROFILER_H_
+
+#include "tensorflow/contrib/lite/context.h"
+
+namespace tflite {
+
+// Receives an event before and after each node runs in Interpreter::Invoke().
+// Implementations typically read a clock in both calls and attribute the
+// elapsed time to 'registration.builtin_code'. The events are delivered on
+// the thread calling Invoke(), in execution order, and must be cheap: they
+// are on the critical path of every node.
+class Profiler {
+ public:
+  virtual ~Profiler() {}
+
+  // Called right before the node with index 'node_index' is invoked.
+  virtual void BeginNode(int node_index, const TfLiteNode& node,
+                         const TfLiteRegistration& registration) = 0;
+
+  // Called right after the node with index 'node_index' has been invoked,
+  // whether or not it succeeded.
+  virtual void EndNode(int node_index, const TfLiteNode& node,
+                       const TfLiteRegistration& registration) = 0;
+};
+
+}  // namespace tflite
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_LITE_PROFILER_H_
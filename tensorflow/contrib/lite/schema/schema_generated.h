@@ -37,6 +37,9 @@ struct Pool2DOptionsT;
 struct DepthwiseConv2DOptions;
 struct DepthwiseConv2DOptionsT;
 
+struct DepthwiseSeparableConv2DOptions;
+struct DepthwiseSeparableConv2DOptionsT;
+
 struct ConcatEmbeddingsOptions;
 struct ConcatEmbeddingsOptionsT;
 
@@ -171,11 +174,12 @@ enum BuiltinOperator {
   BuiltinOperator_CUSTOM = 32,
   BuiltinOperator_EMBEDDING_LOOKUP_SPARSE = 33,
   BuiltinOperator_PAD = 34,
+  BuiltinOperator_DEPTHWISE_SEPARABLE_CONV_2D = 35,
   BuiltinOperator_MIN = BuiltinOperator_ADD,
-  BuiltinOperator_MAX = BuiltinOperator_PAD
+  BuiltinOperator_MAX = BuiltinOperator_DEPTHWISE_SEPARABLE_CONV_2D
 };
 
-inline BuiltinOperator (&EnumValuesBuiltinOperator())[32] {
+inline BuiltinOperator (&EnumValuesBuiltinOperator())[33] {
   static BuiltinOperator values[] = {
       BuiltinOperator_ADD,
       BuiltinOperator_AVERAGE_POOL_2D,
@@ -208,7 +212,8 @@ inline BuiltinOperator (&EnumValuesBuiltinOperator())[32] {
       BuiltinOperator_CALL,
       BuiltinOperator_CUSTOM,
       BuiltinOperator_EMBEDDING_LOOKUP_SPARSE,
-      BuiltinOperator_PAD};
+      BuiltinOperator_PAD,
+      BuiltinOperator_DEPTHWISE_SEPARABLE_CONV_2D};
   return values;
 }
 
@@ -248,6 +253,7 @@ inline const char **EnumNamesBuiltinOperator() {
                                 "CUSTOM",
                                 "EMBEDDING_LOOKUP_SPARSE",
                                 "PAD",
+                                "DEPTHWISE_SEPARABLE_CONV_2D",
                                 nullptr};
   return names;
 }
@@ -281,11 +287,12 @@ enum BuiltinOptions {
   BuiltinOptions_EmbeddingLookupSparseOptions = 20,
   BuiltinOptions_MulOptions = 21,
   BuiltinOptions_PadOptions = 22,
+  BuiltinOptions_DepthwiseSeparableConv2DOptions = 23,
   BuiltinOptions_MIN = BuiltinOptions_NONE,
-  BuiltinOptions_MAX = BuiltinOptions_PadOptions
+  BuiltinOptions_MAX = BuiltinOptions_DepthwiseSeparableConv2DOptions
 };
 
-inline BuiltinOptions (&EnumValuesBuiltinOptions())[23] {
+inline BuiltinOptions (&EnumValuesBuiltinOptions())[24] {
   static BuiltinOptions values[] = {
       BuiltinOptions_NONE,
       BuiltinOptions_Conv2DOptions,
@@ -309,7 +316,8 @@ inline BuiltinOptions (&EnumValuesBuiltinOptions())[23] {
       BuiltinOptions_SpaceToDepthOptions,
       BuiltinOptions_EmbeddingLookupSparseOptions,
       BuiltinOptions_MulOptions,
-      BuiltinOptions_PadOptions};
+      BuiltinOptions_PadOptions,
+      BuiltinOptions_DepthwiseSeparableConv2DOptions};
   return values;
 }
 
@@ -337,6 +345,7 @@ inline const char **EnumNamesBuiltinOptions() {
                                 "EmbeddingLookupSparseOptions",
                                 "MulOptions",
                                 "PadOptions",
+                                "DepthwiseSeparableConv2DOptions",
                                 nullptr};
   return names;
 }
@@ -465,6 +474,12 @@ struct BuiltinOptionsTraits<PadOptions> {
   static const BuiltinOptions enum_value = BuiltinOptions_PadOptions;
 };
 
+template <>
+struct BuiltinOptionsTraits<DepthwiseSeparableConv2DOptions> {
+  static const BuiltinOptions enum_value =
+      BuiltinOptions_DepthwiseSeparableConv2DOptions;
+};
+
 struct BuiltinOptionsUnion {
   BuiltinOptions type;
   void *value;
@@ -732,6 +747,18 @@ struct BuiltinOptionsUnion {
                ? reinterpret_cast<const PadOptionsT *>(value)
                : nullptr;
   }
+  DepthwiseSeparableConv2DOptionsT *AsDepthwiseSeparableConv2DOptions() {
+    return type == BuiltinOptions_DepthwiseSeparableConv2DOptions
+               ? reinterpret_cast<DepthwiseSeparableConv2DOptionsT *>(value)
+               : nullptr;
+  }
+  const DepthwiseSeparableConv2DOptionsT *AsDepthwiseSeparableConv2DOptions()
+      const {
+    return type == BuiltinOptions_DepthwiseSeparableConv2DOptions
+               ? reinterpret_cast<const DepthwiseSeparableConv2DOptionsT *>(
+                     value)
+               : nullptr;
+  }
 };
 
 bool VerifyBuiltinOptions(flatbuffers::Verifier &verifier, const void *obj,
@@ -1396,6 +1423,141 @@ flatbuffers::Offset<DepthwiseConv2DOptions> CreateDepthwiseConv2DOptions(
     flatbuffers::FlatBufferBuilder &_fbb, const DepthwiseConv2DOptionsT *_o,
     const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct DepthwiseSeparableConv2DOptionsT : public flatbuffers::NativeTable {
+  typedef DepthwiseSeparableConv2DOptions TableType;
+  Padding padding;
+  int32_t stride_w;
+  int32_t stride_h;
+  int32_t depth_multiplier;
+  ActivationFunctionType depthwise_activation_function;
+  ActivationFunctionType fused_activation_function;
+  DepthwiseSeparableConv2DOptionsT()
+      : padding(Padding_SAME),
+        stride_w(0),
+        stride_h(0),
+        depth_multiplier(0),
+        depthwise_activation_function(ActivationFunctionType_NONE),
+        fused_activation_function(ActivationFunctionType_NONE) {}
+};
+
+struct DepthwiseSeparableConv2DOptions FLATBUFFERS_FINAL_CLASS
+    : private flatbuffers::Table {
+  typedef DepthwiseSeparableConv2DOptionsT NativeTableType;
+  enum {
+    VT_PADDING = 4,
+    VT_STRIDE_W = 6,
+    VT_STRIDE_H = 8,
+    VT_DEPTH_MULTIPLIER = 10,
+    VT_DEPTHWISE_ACTIVATION_FUNCTION = 12,
+    VT_FUSED_ACTIVATION_FUNCTION = 14
+  };
+  Padding padding() const {
+    return static_cast<Padding>(GetField<int8_t>(VT_PADDING, 0));
+  }
+  int32_t stride_w() const { return GetField<int32_t>(VT_STRIDE_W, 0); }
+  int32_t stride_h() const { return GetField<int32_t>(VT_STRIDE_H, 0); }
+  int32_t depth_multiplier() const {
+    return GetField<int32_t>(VT_DEPTH_MULTIPLIER, 0);
+  }
+  ActivationFunctionType depthwise_activation_function() const {
+    return static_cast<ActivationFunctionType>(
+        GetField<int8_t>(VT_DEPTHWISE_ACTIVATION_FUNCTION, 0));
+  }
+  ActivationFunctionType fused_activation_function() const {
+    return static_cast<ActivationFunctionType>(
+        GetField<int8_t>(VT_FUSED_ACTIVATION_FUNCTION, 0));
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyField<int8_t>(verifier, VT_PADDING) &&
+           VerifyField<int32_t>(verifier, VT_STRIDE_W) &&
+           VerifyField<int32_t>(verifier, VT_STRIDE_H) &&
+           VerifyField<int32_t>(verifier, VT_DEPTH_MULTIPLIER) &&
+           VerifyField<int8_t>(verifier, VT_DEPTHWISE_ACTIVATION_FUNCTION) &&
+           VerifyField<int8_t>(verifier, VT_FUSED_ACTIVATION_FUNCTION) &&
+           verifier.EndTable();
+  }
+  DepthwiseSeparableConv2DOptionsT *UnPack(
+      const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(
+      DepthwiseSeparableConv2DOptionsT *_o,
+      const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<DepthwiseSeparableConv2DOptions> Pack(
+      flatbuffers::FlatBufferBuilder &_fbb,
+      const DepthwiseSeparableConv2DOptionsT *_o,
+      const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct DepthwiseSeparableConv2DOptionsBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_padding(Padding padding) {
+    fbb_.AddElement<int8_t>(DepthwiseSeparableConv2DOptions::VT_PADDING,
+                            static_cast<int8_t>(padding), 0);
+  }
+  void add_stride_w(int32_t stride_w) {
+    fbb_.AddElement<int32_t>(DepthwiseSeparableConv2DOptions::VT_STRIDE_W,
+                             stride_w, 0);
+  }
+  void add_stride_h(int32_t stride_h) {
+    fbb_.AddElement<int32_t>(DepthwiseSeparableConv2DOptions::VT_STRIDE_H,
+                             stride_h, 0);
+  }
+  void add_depth_multiplier(int32_t depth_multiplier) {
+    fbb_.AddElement<int32_t>(
+        DepthwiseSeparableConv2DOptions::VT_DEPTH_MULTIPLIER, depth_multiplier,
+        0);
+  }
+  void add_depthwise_activation_function(
+      ActivationFunctionType depthwise_activation_function) {
+    fbb_.AddElement<int8_t>(
+        DepthwiseSeparableConv2DOptions::VT_DEPTHWISE_ACTIVATION_FUNCTION,
+        static_cast<int8_t>(depthwise_activation_function), 0);
+  }
+  void add_fused_activation_function(
+      ActivationFunctionType fused_activation_function) {
+    fbb_.AddElement<int8_t>(
+        DepthwiseSeparableConv2DOptions::VT_FUSED_ACTIVATION_FUNCTION,
+        static_cast<int8_t>(fused_activation_function), 0);
+  }
+  explicit DepthwiseSeparableConv2DOptionsBuilder(
+      flatbuffers::FlatBufferBuilder &_fbb)
+      : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  DepthwiseSeparableConv2DOptionsBuilder &operator=(
+      const DepthwiseSeparableConv2DOptionsBuilder &);
+  flatbuffers::Offset<DepthwiseSeparableConv2DOptions> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<DepthwiseSeparableConv2DOptions>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<DepthwiseSeparableConv2DOptions>
+CreateDepthwiseSeparableConv2DOptions(
+    flatbuffers::FlatBufferBuilder &_fbb, Padding padding = Padding_SAME,
+    int32_t stride_w = 0, int32_t stride_h = 0, int32_t depth_multiplier = 0,
+    ActivationFunctionType depthwise_activation_function =
+        ActivationFunctionType_NONE,
+    ActivationFunctionType fused_activation_function =
+        ActivationFunctionType_NONE) {
+  DepthwiseSeparableConv2DOptionsBuilder builder_(_fbb);
+  builder_.add_depth_multiplier(depth_multiplier);
+  builder_.add_stride_h(stride_h);
+  builder_.add_stride_w(stride_w);
+  builder_.add_fused_activation_function(fused_activation_function);
+  builder_.add_depthwise_activation_function(depthwise_activation_function);
+  builder_.add_padding(padding);
+  return builder_.Finish();
+}
+
+flatbuffers::Offset<DepthwiseSeparableConv2DOptions>
+CreateDepthwiseSeparableConv2DOptions(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const DepthwiseSeparableConv2DOptionsT *_o,
+    const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 struct ConcatEmbeddingsOptionsT : public flatbuffers::NativeTable {
   typedef ConcatEmbeddingsOptions TableType;
   int32_t num_channels;
@@ -1695,21 +1857,27 @@ flatbuffers::Offset<RNNOptions> CreateRNNOptions(
 struct FullyConnectedOptionsT : public flatbuffers::NativeTable {
   typedef FullyConnectedOptions TableType;
   ActivationFunctionType fused_activation_function;
+  bool weights_only_quantized;
   FullyConnectedOptionsT()
-      : fused_activation_function(ActivationFunctionType_NONE) {}
+      : fused_activation_function(ActivationFunctionType_NONE),
+        weights_only_quantized(false) {}
 };
 
 struct FullyConnectedOptions FLATBUFFERS_FINAL_CLASS
     : private flatbuffers::Table {
   typedef FullyConnectedOptionsT NativeTableType;
-  enum { VT_FUSED_ACTIVATION_FUNCTION = 4 };
+  enum { VT_FUSED_ACTIVATION_FUNCTION = 4, VT_WEIGHTS_ONLY_QUANTIZED = 6 };
   ActivationFunctionType fused_activation_function() const {
     return static_cast<ActivationFunctionType>(
         GetField<int8_t>(VT_FUSED_ACTIVATION_FUNCTION, 0));
   }
+  bool weights_only_quantized() const {
+    return GetField<uint8_t>(VT_WEIGHTS_ONLY_QUANTIZED, 0) != 0;
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int8_t>(verifier, VT_FUSED_ACTIVATION_FUNCTION) &&
+           VerifyField<uint8_t>(verifier, VT_WEIGHTS_ONLY_QUANTIZED) &&
            verifier.EndTable();
   }
   FullyConnectedOptionsT *UnPack(
@@ -1730,6 +1898,10 @@ struct FullyConnectedOptionsBuilder {
     fbb_.AddElement<int8_t>(FullyConnectedOptions::VT_FUSED_ACTIVATION_FUNCTION,
                             static_cast<int8_t>(fused_activation_function), 0);
   }
+  void add_weights_only_quantized(bool weights_only_quantized) {
+    fbb_.AddElement<uint8_t>(FullyConnectedOptions::VT_WEIGHTS_ONLY_QUANTIZED,
+                             static_cast<uint8_t>(weights_only_quantized), 0);
+  }
   explicit FullyConnectedOptionsBuilder(flatbuffers::FlatBufferBuilder &_fbb)
       : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -1745,8 +1917,10 @@ struct FullyConnectedOptionsBuilder {
 inline flatbuffers::Offset<FullyConnectedOptions> CreateFullyConnectedOptions(
     flatbuffers::FlatBufferBuilder &_fbb,
     ActivationFunctionType fused_activation_function =
-        ActivationFunctionType_NONE) {
+        ActivationFunctionType_NONE,
+    bool weights_only_quantized = false) {
   FullyConnectedOptionsBuilder builder_(_fbb);
+  builder_.add_weights_only_quantized(weights_only_quantized);
   builder_.add_fused_activation_function(fused_activation_function);
   return builder_.Finish();
 }
@@ -2153,26 +2327,38 @@ struct LSTMOptionsT : public flatbuffers::NativeTable {
   ActivationFunctionType fused_activation_function;
   float cell_clip;
   float proj_clip;
+  bool weights_only_quantized;
   LSTMOptionsT()
       : fused_activation_function(ActivationFunctionType_NONE),
         cell_clip(0.0f),
-        proj_clip(0.0f) {}
+        proj_clip(0.0f),
+        weights_only_quantized(false) {}
 };
 
 struct LSTMOptions FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   typedef LSTMOptionsT NativeTableType;
-  enum { VT_FUSED_ACTIVATION_FUNCTION = 4, VT_CELL_CLIP = 6, VT_PROJ_CLIP = 8 };
+  enum {
+    VT_FUSED_ACTIVATION_FUNCTION = 4,
+    VT_CELL_CLIP = 6,
+    VT_PROJ_CLIP = 8,
+    VT_WEIGHTS_ONLY_QUANTIZED = 10
+  };
   ActivationFunctionType fused_activation_function() const {
     return static_cast<ActivationFunctionType>(
         GetField<int8_t>(VT_FUSED_ACTIVATION_FUNCTION, 0));
   }
   float cell_clip() const { return GetField<float>(VT_CELL_CLIP, 0.0f); }
   float proj_clip() const { return GetField<float>(VT_PROJ_CLIP, 0.0f); }
+  bool weights_only_quantized() const {
+    return GetField<uint8_t>(VT_WEIGHTS_ONLY_QUANTIZED, 0) != 0;
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int8_t>(verifier, VT_FUSED_ACTIVATION_FUNCTION) &&
            VerifyField<float>(verifier, VT_CELL_CLIP) &&
-           VerifyField<float>(verifier, VT_PROJ_CLIP) && verifier.EndTable();
+           VerifyField<float>(verifier, VT_PROJ_CLIP) &&
+           VerifyField<uint8_t>(verifier, VT_WEIGHTS_ONLY_QUANTIZED) &&
+           verifier.EndTable();
   }
   LSTMOptionsT *UnPack(
       const flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -2198,6 +2384,10 @@ struct LSTMOptionsBuilder {
   void add_proj_clip(float proj_clip) {
     fbb_.AddElement<float>(LSTMOptions::VT_PROJ_CLIP, proj_clip, 0.0f);
   }
+  void add_weights_only_quantized(bool weights_only_quantized) {
+    fbb_.AddElement<uint8_t>(LSTMOptions::VT_WEIGHTS_ONLY_QUANTIZED,
+                             static_cast<uint8_t>(weights_only_quantized), 0);
+  }
   explicit LSTMOptionsBuilder(flatbuffers::FlatBufferBuilder &_fbb)
       : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -2214,10 +2404,12 @@ inline flatbuffers::Offset<LSTMOptions> CreateLSTMOptions(
     flatbuffers::FlatBufferBuilder &_fbb,
     ActivationFunctionType fused_activation_function =
         ActivationFunctionType_NONE,
-    float cell_clip = 0.0f, float proj_clip = 0.0f) {
+    float cell_clip = 0.0f, float proj_clip = 0.0f,
+    bool weights_only_quantized = false) {
   LSTMOptionsBuilder builder_(_fbb);
   builder_.add_proj_clip(proj_clip);
   builder_.add_cell_clip(cell_clip);
+  builder_.add_weights_only_quantized(weights_only_quantized);
   builder_.add_fused_activation_function(fused_activation_function);
   return builder_.Finish();
 }
@@ -2915,6 +3107,14 @@ struct Operator FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
                ? static_cast<const PadOptions *>(builtin_options())
                : nullptr;
   }
+  const DepthwiseSeparableConv2DOptions *
+  builtin_options_as_DepthwiseSeparableConv2DOptions() const {
+    return builtin_options_type() ==
+                   BuiltinOptions_DepthwiseSeparableConv2DOptions
+               ? static_cast<const DepthwiseSeparableConv2DOptions *>(
+                     builtin_options())
+               : nullptr;
+  }
   const flatbuffers::Vector<uint8_t> *custom_options() const {
     return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_CUSTOM_OPTIONS);
   }
@@ -3071,6 +3271,12 @@ inline const PadOptions *Operator::builtin_options_as<PadOptions>() const {
   return builtin_options_as_PadOptions();
 }
 
+template <>
+inline const DepthwiseSeparableConv2DOptions *
+Operator::builtin_options_as<DepthwiseSeparableConv2DOptions>() const {
+  return builtin_options_as_DepthwiseSeparableConv2DOptions();
+}
+
 struct OperatorBuilder {
   flatbuffers::FlatBufferBuilder &fbb_;
   flatbuffers::uoffset_t start_;
@@ -3806,6 +4012,77 @@ inline flatbuffers::Offset<DepthwiseConv2DOptions> CreateDepthwiseConv2DOptions(
                                               _fused_activation_function);
 }
 
+inline DepthwiseSeparableConv2DOptionsT *
+DepthwiseSeparableConv2DOptions::UnPack(
+    const flatbuffers::resolver_function_t *_resolver) const {
+  auto _o = new DepthwiseSeparableConv2DOptionsT();
+  UnPackTo(_o, _resolver);
+  return _o;
+}
+
+inline void DepthwiseSeparableConv2DOptions::UnPackTo(
+    DepthwiseSeparableConv2DOptionsT *_o,
+    const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  {
+    auto _e = padding();
+    _o->padding = _e;
+  };
+  {
+    auto _e = stride_w();
+    _o->stride_w = _e;
+  };
+  {
+    auto _e = stride_h();
+    _o->stride_h = _e;
+  };
+  {
+    auto _e = depth_multiplier();
+    _o->depth_multiplier = _e;
+  };
+  {
+    auto _e = depthwise_activation_function();
+    _o->depthwise_activation_function = _e;
+  };
+  {
+    auto _e = fused_activation_function();
+    _o->fused_activation_function = _e;
+  };
+}
+
+inline flatbuffers::Offset<DepthwiseSeparableConv2DOptions>
+DepthwiseSeparableConv2DOptions::Pack(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const DepthwiseSeparableConv2DOptionsT *_o,
+    const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateDepthwiseSeparableConv2DOptions(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<DepthwiseSeparableConv2DOptions>
+CreateDepthwiseSeparableConv2DOptions(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const DepthwiseSeparableConv2DOptionsT *_o,
+    const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs {
+    flatbuffers::FlatBufferBuilder *__fbb;
+    const DepthwiseSeparableConv2DOptionsT *__o;
+    const flatbuffers::rehasher_function_t *__rehasher;
+  } _va = {&_fbb, _o, _rehasher};
+  (void)_va;
+  auto _padding = _o->padding;
+  auto _stride_w = _o->stride_w;
+  auto _stride_h = _o->stride_h;
+  auto _depth_multiplier = _o->depth_multiplier;
+  auto _depthwise_activation_function = _o->depthwise_activation_function;
+  auto _fused_activation_function = _o->fused_activation_function;
+  return tflite::CreateDepthwiseSeparableConv2DOptions(
+      _fbb, _padding, _stride_w, _stride_h, _depth_multiplier,
+      _depthwise_activation_function, _fused_activation_function);
+}
+
 inline ConcatEmbeddingsOptionsT *ConcatEmbeddingsOptions::UnPack(
     const flatbuffers::resolver_function_t *_resolver) const {
   auto _o = new ConcatEmbeddingsOptionsT();
@@ -4011,6 +4288,10 @@ inline void FullyConnectedOptions::UnPackTo(
     auto _e = fused_activation_function();
     _o->fused_activation_function = _e;
   };
+  {
+    auto _e = weights_only_quantized();
+    _o->weights_only_quantized = _e;
+  };
 }
 
 inline flatbuffers::Offset<FullyConnectedOptions> FullyConnectedOptions::Pack(
@@ -4031,7 +4312,9 @@ inline flatbuffers::Offset<FullyConnectedOptions> CreateFullyConnectedOptions(
   } _va = {&_fbb, _o, _rehasher};
   (void)_va;
   auto _fused_activation_function = _o->fused_activation_function;
-  return tflite::CreateFullyConnectedOptions(_fbb, _fused_activation_function);
+  auto _weights_only_quantized = _o->weights_only_quantized;
+  return tflite::CreateFullyConnectedOptions(_fbb, _fused_activation_function,
+                                             _weights_only_quantized);
 }
 
 inline SoftmaxOptionsT *SoftmaxOptions::UnPack(
@@ -4316,6 +4599,10 @@ inline void LSTMOptions::UnPackTo(
     auto _e = proj_clip();
     _o->proj_clip = _e;
   };
+  {
+    auto _e = weights_only_quantized();
+    _o->weights_only_quantized = _e;
+  };
 }
 
 inline flatbuffers::Offset<LSTMOptions> LSTMOptions::Pack(
@@ -4338,8 +4625,9 @@ inline flatbuffers::Offset<LSTMOptions> CreateLSTMOptions(
   auto _fused_activation_function = _o->fused_activation_function;
   auto _cell_clip = _o->cell_clip;
   auto _proj_clip = _o->proj_clip;
+  auto _weights_only_quantized = _o->weights_only_quantized;
   return tflite::CreateLSTMOptions(_fbb, _fused_activation_function, _cell_clip,
-                                   _proj_clip);
+                                   _proj_clip, _weights_only_quantized);
 }
 
 inline ResizeBilinearOptionsT *ResizeBilinearOptions::UnPack(
@@ -5131,6 +5419,10 @@ inline bool VerifyBuiltinOptions(flatbuffers::Verifier &verifier,
       auto ptr = reinterpret_cast<const PadOptions *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case BuiltinOptions_DepthwiseSeparableConv2DOptions: {
+      auto ptr = reinterpret_cast<const DepthwiseSeparableConv2DOptions *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default:
       return false;
   }
@@ -5243,6 +5535,10 @@ inline void *BuiltinOptionsUnion::UnPack(
       auto ptr = reinterpret_cast<const PadOptions *>(obj);
       return ptr->UnPack(resolver);
     }
+    case BuiltinOptions_DepthwiseSeparableConv2DOptions: {
+      auto ptr = reinterpret_cast<const DepthwiseSeparableConv2DOptions *>(obj);
+      return ptr->UnPack(resolver);
+    }
     default:
       return nullptr;
   }
@@ -5342,6 +5638,12 @@ inline flatbuffers::Offset<void> BuiltinOptionsUnion::Pack(
       auto ptr = reinterpret_cast<const PadOptionsT *>(value);
       return CreatePadOptions(_fbb, ptr, _rehasher).Union();
     }
+    case BuiltinOptions_DepthwiseSeparableConv2DOptions: {
+      auto ptr = reinterpret_cast<const DepthwiseSeparableConv2DOptionsT *>(
+          value);
+      return CreateDepthwiseSeparableConv2DOptions(_fbb, ptr, _rehasher)
+          .Union();
+    }
     default:
       return 0;
   }
@@ -5451,6 +5753,11 @@ inline BuiltinOptionsUnion::BuiltinOptionsUnion(const BuiltinOptionsUnion &u)
       value = new PadOptionsT(*reinterpret_cast<PadOptionsT *>(u.value));
       break;
     }
+    case BuiltinOptions_DepthwiseSeparableConv2DOptions: {
+      value = new DepthwiseSeparableConv2DOptionsT(
+          *reinterpret_cast<DepthwiseSeparableConv2DOptionsT *>(u.value));
+      break;
+    }
     default:
       break;
   }
@@ -5568,6 +5875,11 @@ inline void BuiltinOptionsUnion::Reset() {
       delete ptr;
       break;
     }
+    case BuiltinOptions_DepthwiseSeparableConv2DOptions: {
+      auto ptr = reinterpret_cast<DepthwiseSeparableConv2DOptionsT *>(value);
+      delete ptr;
+      break;
+    }
     default:
       break;
   }
@@ -90,6 +90,19 @@ TfLiteStatus SimpleMemoryArena::Deallocate(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::AllocateAt(TfLiteContext* context,
+                                           size_t alignment, size_t offset,
+                                           size_t size, ArenaAlloc* new_alloc) {
+  TF_LITE_ENSURE(context, alignment < arena_alignment_);
+  TF_LITE_ENSURE(context, offset % alignment == 0);
+
+  high_water_mark_ = std::max(high_water_mark_, offset + size);
+
+  new_alloc->offset = offset;
+  new_alloc->size = size;
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
   size_t required_size = RequiredBufferSize();
   if (required_size > underlying_buffer_size_) {
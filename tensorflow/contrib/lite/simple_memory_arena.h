@@ -54,6 +54,12 @@ class SimpleMemoryArena {
 
   TfLiteStatus Deallocate(TfLiteContext* context, const ArenaAlloc& alloc);
 
+  // Records an alloc at an offset chosen by a MemoryPlanner, which keeps it
+  // clear of the other allocs that are live at the same time. Such allocs only
+  // grow the arena: they are not seen by Allocate() and are not deallocated.
+  TfLiteStatus AllocateAt(TfLiteContext* context, size_t alignment,
+                          size_t offset, size_t size, ArenaAlloc* new_alloc);
+
   inline size_t RequiredBufferSize() {
     // Add in a small amount of padding to reduce the chance of resize events
     // for small allocations.
@@ -61,6 +67,9 @@ class SimpleMemoryArena {
     return arena_alignment_ + high_water_mark_ + padding;
   }
 
+  // The number of bytes spanned by the allocs made so far.
+  size_t high_water_mark() const { return high_water_mark_; }
+
   TfLiteStatus Commit(TfLiteContext* context);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context, const ArenaAlloc& alloc,
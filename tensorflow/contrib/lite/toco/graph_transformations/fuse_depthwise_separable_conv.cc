@@ -0,0 +1,104 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace toco {
+
+// Fuses a float DepthwiseConv with the 1x1, stride 1 Conv consuming its
+// output into a DepthwiseSeparableConv operator, which computes both without
+// storing the intermediate array. The fused activation functions of both
+// operators are kept. This has to run after FuseActivationFunctions and
+// EnsureBiasVectors, once all shapes are known.
+bool FuseDepthwiseSeparableConv::Run(Model* model, std::size_t op_index) {
+  auto* depthwise_op = model->operators[op_index].get();
+  if (depthwise_op->type != OperatorType::kDepthwiseConv) {
+    return false;
+  }
+  if (depthwise_op->inputs.size() != 3) {
+    return false;
+  }
+  const string& intermediate_name = depthwise_op->outputs[0];
+  const auto& intermediate_array = model->GetArray(intermediate_name);
+  if (intermediate_array.data_type != ArrayDataType::kFloat ||
+      !IsDiscardableArray(*model, intermediate_name) ||
+      CountOpsWithInput(*model, intermediate_name) != 1) {
+    return false;
+  }
+
+  Operator* pointwise_op = GetOpWithInput(*model, intermediate_name);
+  if (!pointwise_op || pointwise_op->type != OperatorType::kConv) {
+    return false;
+  }
+  auto* conv_op = static_cast<ConvOperator*>(pointwise_op);
+  if (conv_op->inputs.size() != 3 || conv_op->outputs.size() != 1 ||
+      conv_op->inputs[0] != intermediate_name) {
+    return false;
+  }
+  if (conv_op->stride_width != 1 || conv_op->stride_height != 1 ||
+      conv_op->dilation_rate != 1) {
+    return false;
+  }
+  const auto& pointwise_weights_array = model->GetArray(conv_op->inputs[1]);
+  if (!pointwise_weights_array.has_shape() ||
+      !IsConstantParameterArray(*model, conv_op->inputs[1])) {
+    return false;
+  }
+  const auto& pointwise_weights_shape = pointwise_weights_array.shape();
+  if (pointwise_weights_shape.dimensions_count() != 4 ||
+      pointwise_weights_shape.dims(1) != 1 ||
+      pointwise_weights_shape.dims(2) != 1) {
+    AddMessageF(
+        "Not fusing %s into the preceding %s because it isn't a 1x1 "
+        "convolution",
+        LogName(*conv_op), LogName(*depthwise_op));
+    return false;
+  }
+
+  auto* depthwise_conv_op = static_cast<DepthwiseConvOperator*>(depthwise_op);
+  auto* fused_op = new DepthwiseSeparableConvOperator;
+  fused_op->inputs = {depthwise_conv_op->inputs[0],
+                      depthwise_conv_op->inputs[1],
+                      depthwise_conv_op->inputs[2], conv_op->inputs[1],
+                      conv_op->inputs[2]};
+  fused_op->outputs = {conv_op->outputs[0]};
+  fused_op->padding.type = depthwise_conv_op->padding.type;
+  fused_op->padding.fixed = std::move(depthwise_conv_op->padding.fixed);
+  fused_op->stride_width = depthwise_conv_op->stride_width;
+  fused_op->stride_height = depthwise_conv_op->stride_height;
+  fused_op->depth_multiplier = depthwise_conv_op->depth_multiplier;
+  fused_op->depthwise_fused_activation_function =
+      depthwise_conv_op->fused_activation_function;
+  fused_op->fused_activation_function = conv_op->fused_activation_function;
+
+  AddMessageF("Fusing %s and the following %s into %s",
+              LogName(*depthwise_conv_op), LogName(*conv_op),
+              LogName(*fused_op));
+
+  // The fused op takes the place of the DepthwiseConv, where all of its
+  // inputs are available, and the Conv is removed.
+  model->arrays.erase(intermediate_name);
+  model->operators.erase(FindOp(*model, conv_op));
+  FindOp(*model, depthwise_conv_op)->reset(fused_op);
+  return true;
+}
+
+}  // namespace toco
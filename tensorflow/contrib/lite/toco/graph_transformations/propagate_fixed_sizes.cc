@@ -208,6 +208,39 @@ void ProcessDepthwiseConvOperator(Model* model, DepthwiseConvOperator* op) {
                    &op->padding.GetOrCreateFixedPadding());
 }
 
+void ProcessDepthwiseSeparableConvOperator(
+    Model* model, DepthwiseSeparableConvOperator* op) {
+  const auto& input_array = *model->arrays[op->inputs[0]];
+  const auto& depthwise_weights_array = *model->arrays[op->inputs[1]];
+  const auto& pointwise_weights_array = *model->arrays[op->inputs[3]];
+  // Yield until input and weights dims have been resolved.
+  if (!input_array.has_shape() || !depthwise_weights_array.has_shape() ||
+      !pointwise_weights_array.has_shape()) {
+    return;
+  }
+  const auto& input_shape = input_array.shape();
+  CHECK_EQ(input_shape.dimensions_count(), 4);
+  const auto& depthwise_weights_shape = depthwise_weights_array.shape();
+  CHECK_EQ(depthwise_weights_shape.dimensions_count(), 4);
+  const auto& pointwise_weights_shape = pointwise_weights_array.shape();
+  CHECK_EQ(pointwise_weights_shape.dimensions_count(), 4);
+
+  // This operator is only created from a DepthwiseConv whose
+  // depth_multiplier was already resolved.
+  const int depthwise_depth = depthwise_weights_shape.dims(3);
+  QCHECK_EQ(depthwise_depth, input_shape.dims(3) * op->depth_multiplier)
+      << "input/output depths and depth_multiplier don't match";
+  CHECK_EQ(pointwise_weights_shape.dims(3), depthwise_depth);
+
+  const int kheight = depthwise_weights_shape.dims(1);
+  const int kwidth = depthwise_weights_shape.dims(2);
+  ComputeConvSizes(input_shape, pointwise_weights_shape.dims(0), kwidth,
+                   kheight, op->stride_width, op->stride_height,
+                   op->padding.type,
+                   model->GetArray(op->outputs[0]).mutable_shape(),
+                   &op->padding.GetOrCreateFixedPadding());
+}
+
 void ProcessDepthToSpaceOperator(Model* model, DepthToSpaceOperator* op) {
   const auto& input_array = *model->arrays[op->inputs[0]];
   // Yield until input dims have been resolved.
@@ -1002,6 +1035,10 @@ bool PropagateFixedSizes::Run(Model* model, std::size_t op_index) {
       ProcessDepthwiseConvOperator(model,
                                    static_cast<DepthwiseConvOperator*>(op));
       break;
+    case OperatorType::kDepthwiseSeparableConv:
+      ProcessDepthwiseSeparableConvOperator(
+          model, static_cast<DepthwiseSeparableConvOperator*>(op));
+      break;
     case OperatorType::kDepthToSpace:
       ProcessDepthToSpaceOperator(model,
                                   static_cast<DepthToSpaceOperator*>(op));
@@ -0,0 +1,96 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace toco {
+
+namespace {
+
+// Weights smaller than this aren't worth quantizing: they barely affect the
+// size of the model, and the float kernel is as fast for them.
+constexpr int kMinWeightsSizeToQuantize = 1024;
+
+}  // namespace
+
+// Quantizes the constant weights of FullyConnected operators with float
+// inputs, for the hybrid TF Lite kernels, without quantizing the activations.
+// The weights are quantized symmetrically to int8 values in [-127, 127], which
+// are stored in an uint8 array whose quantization params have a zero_point of
+// 0, and the operator is marked as weights_only_quantized.
+bool QuantizeWeights::Run(Model* model, std::size_t op_index) {
+  auto* op = model->operators[op_index].get();
+  if (op->type != OperatorType::kFullyConnected) {
+    return false;
+  }
+  auto* fc_op = static_cast<FullyConnectedOperator*>(op);
+  if (fc_op->weights_only_quantized) {
+    return false;
+  }
+  if (model->GetArray(fc_op->inputs[0]).data_type != ArrayDataType::kFloat) {
+    return false;
+  }
+  const string& weights_name = fc_op->inputs[1];
+  if (!IsConstantParameterArray(*model, weights_name) ||
+      CountOpsWithInput(*model, weights_name) != 1) {
+    return false;
+  }
+  auto& weights_array = model->GetArray(weights_name);
+  if (weights_array.data_type != ArrayDataType::kFloat ||
+      weights_array.quantization_params) {
+    return false;
+  }
+  const auto& float_data =
+      weights_array.GetBuffer<ArrayDataType::kFloat>().data;
+  if (float_data.size() < kMinWeightsSizeToQuantize) {
+    return false;
+  }
+
+  float abs_max = 0.f;
+  for (const float value : float_data) {
+    abs_max = std::max(abs_max, std::abs(value));
+  }
+  const double scale = abs_max > 0.f ? abs_max / 127. : 1.;
+  std::unique_ptr<Buffer<ArrayDataType::kUint8>> quantized_buffer(
+      new Buffer<ArrayDataType::kUint8>);
+  quantized_buffer->data.resize(float_data.size());
+  for (std::size_t i = 0; i < float_data.size(); i++) {
+    const int32 rounded_val =
+        static_cast<int32>(std::round(float_data[i] / scale));
+    const int8 quantized_val =
+        static_cast<int8>(std::min(127, std::max(-127, rounded_val)));
+    quantized_buffer->data[i] = static_cast<uint8>(quantized_val);
+  }
+
+  auto& quantization_params = weights_array.GetOrCreateQuantizationParams();
+  quantization_params.scale = scale;
+  quantization_params.zero_point = 0;
+  weights_array.buffer = std::move(quantized_buffer);
+  weights_array.data_type = ArrayDataType::kUint8;
+  fc_op->weights_only_quantized = true;
+  AddMessageF("Quantized the weights %s of %s", weights_name,
+              LogName(*fc_op));
+  return true;
+}
+
+}  // namespace toco
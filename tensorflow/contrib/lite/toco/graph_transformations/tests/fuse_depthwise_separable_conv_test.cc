@@ -0,0 +1,141 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+
+namespace toco {
+
+class FuseDepthwiseSeparableConvTest : public ::testing::Test {
+ protected:
+  FuseDepthwiseSeparableConvTest() {}
+
+  void AddConstantArray(Model* model, const string& name,
+                        const std::vector<int>& dims) {
+    Array& array = model->GetOrCreateArray(name);
+    array.data_type = ArrayDataType::kFloat;
+    *array.mutable_shape()->mutable_dims() = dims;
+    array.GetMutableBuffer<ArrayDataType::kFloat>().data.resize(
+        RequiredBufferSizeForShape(array.shape()), 1.f);
+  }
+
+  // Prepare a TOCO model with a 3x3 DepthwiseConv on a 8x8x4 input, followed
+  // by a Conv with 'pointwise_size' x 'pointwise_size' weights and the given
+  // stride, producing 16 channels.
+  void PrepareModel(Model* model, int pointwise_size, int pointwise_stride) {
+    Array& input_array = model->GetOrCreateArray("input");
+    input_array.data_type = ArrayDataType::kFloat;
+    *input_array.mutable_shape()->mutable_dims() = {1, 8, 8, 4};
+    AddConstantArray(model, "dw_weights", {1, 3, 3, 4});
+    AddConstantArray(model, "dw_bias", {4});
+    AddConstantArray(model, "pw_weights",
+                     {16, pointwise_size, pointwise_size, 4});
+    AddConstantArray(model, "pw_bias", {16});
+
+    auto* depthwise_op = new DepthwiseConvOperator;
+    depthwise_op->inputs = {"input", "dw_weights", "dw_bias"};
+    depthwise_op->outputs = {"depthwise"};
+    depthwise_op->padding.type = PaddingType::kSame;
+    depthwise_op->stride_width = 1;
+    depthwise_op->stride_height = 1;
+    depthwise_op->depth_multiplier = 1;
+    depthwise_op->fused_activation_function =
+        FusedActivationFunctionType::kRelu6;
+    Array& depthwise_array = model->GetOrCreateArray("depthwise");
+    depthwise_array.data_type = ArrayDataType::kFloat;
+    *depthwise_array.mutable_shape()->mutable_dims() = {1, 8, 8, 4};
+    model->operators.push_back(std::unique_ptr<Operator>(depthwise_op));
+
+    auto* conv_op = new ConvOperator;
+    conv_op->inputs = {"depthwise", "pw_weights", "pw_bias"};
+    conv_op->outputs = {"output"};
+    conv_op->padding.type = PaddingType::kSame;
+    conv_op->stride_width = pointwise_stride;
+    conv_op->stride_height = pointwise_stride;
+    conv_op->fused_activation_function = FusedActivationFunctionType::kRelu;
+    Array& output_array = model->GetOrCreateArray("output");
+    output_array.data_type = ArrayDataType::kFloat;
+    model->operators.push_back(std::unique_ptr<Operator>(conv_op));
+    model->flags.add_output_arrays("output");
+  }
+};
+
+TEST_F(FuseDepthwiseSeparableConvTest, FusesPointwiseConv) {
+  Model model;
+  PrepareModel(&model, /*pointwise_size=*/1, /*pointwise_stride=*/1);
+
+  GraphTransformationsSet graph_transformation_set;
+  graph_transformation_set.Add(new toco::FuseDepthwiseSeparableConv);
+  EXPECT_TRUE((*graph_transformation_set.begin())->Run(&model, 0));
+
+  ASSERT_EQ(model.operators.size(), 1);
+  ASSERT_EQ(model.operators[0]->type, OperatorType::kDepthwiseSeparableConv);
+  const auto* fused_op = static_cast<const DepthwiseSeparableConvOperator*>(
+      model.operators[0].get());
+  EXPECT_THAT(fused_op->inputs,
+              ::testing::ElementsAre("input", "dw_weights", "dw_bias",
+                                     "pw_weights", "pw_bias"));
+  EXPECT_THAT(fused_op->outputs, ::testing::ElementsAre("output"));
+  EXPECT_EQ(fused_op->padding.type, PaddingType::kSame);
+  EXPECT_EQ(fused_op->depth_multiplier, 1);
+  EXPECT_EQ(fused_op->depthwise_fused_activation_function,
+            FusedActivationFunctionType::kRelu6);
+  EXPECT_EQ(fused_op->fused_activation_function,
+            FusedActivationFunctionType::kRelu);
+  EXPECT_FALSE(model.arrays.count("depthwise"));
+}
+
+TEST_F(FuseDepthwiseSeparableConvTest, KeepsSpatialConv) {
+  Model model;
+  PrepareModel(&model, /*pointwise_size=*/3, /*pointwise_stride=*/1);
+
+  GraphTransformationsSet graph_transformation_set;
+  graph_transformation_set.Add(new toco::FuseDepthwiseSeparableConv);
+  EXPECT_FALSE((*graph_transformation_set.begin())->Run(&model, 0));
+  EXPECT_EQ(model.operators.size(), 2);
+}
+
+TEST_F(FuseDepthwiseSeparableConvTest, KeepsStridedConv) {
+  Model model;
+  PrepareModel(&model, /*pointwise_size=*/1, /*pointwise_stride=*/2);
+
+  GraphTransformationsSet graph_transformation_set;
+  graph_transformation_set.Add(new toco::FuseDepthwiseSeparableConv);
+  EXPECT_FALSE((*graph_transformation_set.begin())->Run(&model, 0));
+  EXPECT_EQ(model.operators.size(), 2);
+}
+
+TEST_F(FuseDepthwiseSeparableConvTest, KeepsSharedIntermediateArray) {
+  Model model;
+  PrepareModel(&model, /*pointwise_size=*/1, /*pointwise_stride=*/1);
+  auto* relu_op = new ReluOperator;
+  relu_op->inputs = {"depthwise"};
+  relu_op->outputs = {"other_output"};
+  model.GetOrCreateArray("other_output").data_type = ArrayDataType::kFloat;
+  model.operators.push_back(std::unique_ptr<Operator>(relu_op));
+
+  GraphTransformationsSet graph_transformation_set;
+  graph_transformation_set.Add(new toco::FuseDepthwiseSeparableConv);
+  EXPECT_FALSE((*graph_transformation_set.begin())->Run(&model, 0));
+  EXPECT_EQ(model.operators.size(), 3);
+}
+
+}  // namespace toco
@@ -0,0 +1,98 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/contrib/lite/toco/graph_transformations/graph_transformations.h"
+#include "tensorflow/contrib/lite/toco/model.h"
+#include "tensorflow/contrib/lite/toco/tooling_util.h"
+
+namespace toco {
+
+class QuantizeWeightsTest : public ::testing::Test {
+ protected:
+  QuantizeWeightsTest() {}
+
+  // Prepare a TOCO model with one FullyConnected operator whose constant
+  // weights have 'num_units' rows of 32 elements.
+  void PrepareModel(Model* model, int num_units) {
+    const int kInputSize = 32;
+    Array& input_array = model->GetOrCreateArray("input");
+    input_array.data_type = ArrayDataType::kFloat;
+    *input_array.mutable_shape()->mutable_dims() = {1, kInputSize};
+
+    Array& weights_array = model->GetOrCreateArray("weights");
+    weights_array.data_type = ArrayDataType::kFloat;
+    *weights_array.mutable_shape()->mutable_dims() = {num_units, kInputSize};
+    auto& weights_data =
+        weights_array.GetMutableBuffer<ArrayDataType::kFloat>().data;
+    weights_data.resize(num_units * kInputSize);
+    for (int i = 0; i < weights_data.size(); i++) {
+      weights_data[i] = (i % 9 - 4) * 0.5f;
+    }
+
+    auto* fc_op = new FullyConnectedOperator;
+    fc_op->inputs = {"input", "weights"};
+    fc_op->outputs = {"output"};
+    Array& output_array = model->GetOrCreateArray("output");
+    output_array.data_type = ArrayDataType::kFloat;
+    *output_array.mutable_shape()->mutable_dims() = {1, num_units};
+    model->operators.push_back(std::unique_ptr<Operator>(fc_op));
+  }
+};
+
+TEST_F(QuantizeWeightsTest, QuantizesLargeWeights) {
+  Model model;
+  PrepareModel(&model, /*num_units=*/64);
+
+  GraphTransformationsSet graph_transformation_set;
+  graph_transformation_set.Add(new toco::QuantizeWeights);
+  EXPECT_TRUE((*graph_transformation_set.begin())->Run(&model, 0));
+
+  const auto* fc_op =
+      static_cast<const FullyConnectedOperator*>(model.operators[0].get());
+  EXPECT_TRUE(fc_op->weights_only_quantized);
+  const Array& weights_array = model.GetArray("weights");
+  EXPECT_EQ(weights_array.data_type, ArrayDataType::kUint8);
+  EXPECT_FLOAT_EQ(weights_array.quantization_params->scale, 2.0 / 127);
+  EXPECT_EQ(weights_array.quantization_params->zero_point, 0);
+  // The uint8 values hold the int8 values round(w / scale).
+  const auto& data = weights_array.GetBuffer<ArrayDataType::kUint8>().data;
+  EXPECT_EQ(static_cast<int8>(data[0]), -127);
+  EXPECT_EQ(static_cast<int8>(data[3]), -32);
+  EXPECT_EQ(static_cast<int8>(data[4]), 0);
+  EXPECT_EQ(static_cast<int8>(data[8]), 127);
+  // The activations stay float.
+  EXPECT_EQ(model.GetArray("input").data_type, ArrayDataType::kFloat);
+  EXPECT_EQ(model.GetArray("output").data_type, ArrayDataType::kFloat);
+
+  // Running it again does nothing.
+  EXPECT_FALSE((*graph_transformation_set.begin())->Run(&model, 0));
+}
+
+TEST_F(QuantizeWeightsTest, KeepsSmallWeightsFloat) {
+  Model model;
+  PrepareModel(&model, /*num_units=*/4);
+
+  GraphTransformationsSet graph_transformation_set;
+  graph_transformation_set.Add(new toco::QuantizeWeights);
+  EXPECT_FALSE((*graph_transformation_set.begin())->Run(&model, 0));
+  EXPECT_EQ(model.GetArray("weights").data_type, ArrayDataType::kFloat);
+}
+
+}  // namespace toco
@@ -37,6 +37,7 @@ enum class OperatorType {
   kConv,
   kConcatenation,
   kDepthwiseConv,
+  kDepthwiseSeparableConv,
   kDepthToSpace,
   kSpaceToDepth,
   kDequantize,
@@ -334,6 +335,33 @@ struct DepthwiseConvOperator : Operator {
   int depth_multiplier = 0;
 };
 
+// A DepthwiseConv followed by a 1x1 Conv with stride 1, as found in
+// MobileNet-style depthwise-separable blocks. Produced by the
+// FuseDepthwiseSeparableConv graph transformation, so that both convolutions
+// run in a single kernel without storing the intermediate array.
+//
+// Inputs:
+//   inputs[0]: required: the input activations array
+//   inputs[1]: required: the DepthwiseConv weights
+//   inputs[2]: required: the DepthwiseConv bias vector
+//   inputs[3]: required: the 1x1 Conv weights
+//   inputs[4]: required: the 1x1 Conv bias vector
+//
+// The inherited fused_activation_function applies to the output of the 1x1
+// Conv, and depthwise_fused_activation_function to the DepthwiseConv output.
+//
+// TensorFlow equivalent: none. It's only useful for TF Lite.
+struct DepthwiseSeparableConvOperator : Operator {
+  DepthwiseSeparableConvOperator()
+      : Operator(OperatorType::kDepthwiseSeparableConv) {}
+  Padding padding;
+  int stride_height = 0;
+  int stride_width = 0;
+  int depth_multiplier = 0;
+  FusedActivationFunctionType depthwise_fused_activation_function =
+      FusedActivationFunctionType::kNone;
+};
+
 // Depth-to-space transform operator.
 //
 // Inputs:
@@ -368,6 +396,9 @@ struct SpaceToDepthOperator : Operator {
 // input activations as a matrix, followed by a MatMul node.
 struct FullyConnectedOperator : Operator {
   FullyConnectedOperator() : Operator(OperatorType::kFullyConnected) {}
+  // Whether the weights hold symmetrically quantized int8 values in an uint8
+  // array, while the input activations are float. See QuantizeWeights.
+  bool weights_only_quantized = false;
 };
 
 // Dequantization operator, converting a quantized array of integers with
@@ -110,6 +110,41 @@ class DepthwiseConvolution
   }
 };
 
+class DepthwiseSeparableConvolution
+    : public BuiltinOperator<
+          DepthwiseSeparableConvOperator,
+          ::tflite::DepthwiseSeparableConv2DOptions,
+          ::tflite::BuiltinOptions_DepthwiseSeparableConv2DOptions> {
+ public:
+  using BuiltinOperator::BuiltinOperator;
+
+  flatbuffers::Offset<TfLiteOptions> WriteOptions(
+      const TocoOperator& op,
+      flatbuffers::FlatBufferBuilder* builder) const override {
+    auto padding = Padding::Serialize(op.padding.type);
+    auto depthwise_activation_function =
+        ActivationFunction::Serialize(op.depthwise_fused_activation_function);
+    auto activation_function =
+        ActivationFunction::Serialize(op.fused_activation_function);
+    return ::tflite::CreateDepthwiseSeparableConv2DOptions(
+        *builder, padding, op.stride_width, op.stride_height,
+        op.depth_multiplier, depthwise_activation_function,
+        activation_function);
+  }
+
+  void ReadOptions(const TfLiteOptions& options,
+                   TocoOperator* op) const override {
+    op->padding.type = Padding::Deserialize(options.padding());
+    op->stride_width = options.stride_w();
+    op->stride_height = options.stride_h();
+    op->depth_multiplier = options.depth_multiplier();
+    op->depthwise_fused_activation_function = ActivationFunction::Deserialize(
+        options.depthwise_activation_function());
+    op->fused_activation_function =
+        ActivationFunction::Deserialize(options.fused_activation_function());
+  }
+};
+
 class Add : public BuiltinOperator<AddOperator, ::tflite::AddOptions,
                                    ::tflite::BuiltinOptions_AddOptions> {
  public:
@@ -201,13 +236,15 @@ class FullyConnected
       flatbuffers::FlatBufferBuilder* builder) const override {
     auto activation_function =
         ActivationFunction::Serialize(op.fused_activation_function);
-    return ::tflite::CreateFullyConnectedOptions(*builder, activation_function);
+    return ::tflite::CreateFullyConnectedOptions(*builder, activation_function,
+                                                 op.weights_only_quantized);
   }
 
   void ReadOptions(const TfLiteOptions& options,
                    TocoOperator* op) const override {
     op->fused_activation_function =
         ActivationFunction::Deserialize(options.fused_activation_function());
+    op->weights_only_quantized = options.weights_only_quantized();
   }
 };
 
@@ -562,6 +599,9 @@ std::vector<std::unique_ptr<BaseOperator>> BuildOperatorList() {
   ops.emplace_back(
       new DepthwiseConvolution(::tflite::BuiltinOperator_DEPTHWISE_CONV_2D,
                                OperatorType::kDepthwiseConv));
+  ops.emplace_back(new DepthwiseSeparableConvolution(
+      ::tflite::BuiltinOperator_DEPTHWISE_SEPARABLE_CONV_2D,
+      OperatorType::kDepthwiseSeparableConv));
   ops.emplace_back(new FullyConnected(::tflite::BuiltinOperator_FULLY_CONNECTED,
                                       OperatorType::kFullyConnected));
   ops.emplace_back(
@@ -161,10 +161,12 @@ TEST_F(OperatorTest, CustomFakeQuant) {
 TEST_F(OperatorTest, CustomFullyConnected) {
   FullyConnectedOperator op;
   op.fused_activation_function = FusedActivationFunctionType::kRelu6;
+  op.weights_only_quantized = true;
   auto output_toco_op = SerializeAndDeserialize(
       GetOperator("FULLY_CONNECTED", OperatorType::kFullyConnected), op);
   EXPECT_EQ(op.fused_activation_function,
             output_toco_op->fused_activation_function);
+  EXPECT_EQ(op.weights_only_quantized, output_toco_op->weights_only_quantized);
 }
 
 TEST_F(OperatorTest, BuiltinL2Pool) {
@@ -308,6 +310,28 @@ TEST_F(OperatorTest, BuiltinDepthwiseConvolution) {
             output_toco_op->fused_activation_function);
 }
 
+TEST_F(OperatorTest, BuiltinDepthwiseSeparableConvolution) {
+  DepthwiseSeparableConvOperator op;
+  op.stride_width = 123;
+  op.stride_height = 124;
+  op.padding.type = PaddingType::kValid;
+  op.depth_multiplier = 6;
+  op.depthwise_fused_activation_function = FusedActivationFunctionType::kRelu6;
+  op.fused_activation_function = FusedActivationFunctionType::kRelu;
+  auto output_toco_op = SerializeAndDeserialize(
+      GetOperator("DEPTHWISE_SEPARABLE_CONV_2D",
+                  OperatorType::kDepthwiseSeparableConv),
+      op);
+  EXPECT_EQ(op.stride_width, output_toco_op->stride_width);
+  EXPECT_EQ(op.stride_height, output_toco_op->stride_height);
+  EXPECT_EQ(op.padding.type, output_toco_op->padding.type);
+  EXPECT_EQ(op.depth_multiplier, output_toco_op->depth_multiplier);
+  EXPECT_EQ(op.depthwise_fused_activation_function,
+            output_toco_op->depthwise_fused_activation_function);
+  EXPECT_EQ(op.fused_activation_function,
+            output_toco_op->fused_activation_function);
+}
+
 TEST_F(OperatorTest, BuiltinL2Norm) {
   L2NormalizationOperator op;
   op.fused_activation_function = FusedActivationFunctionType::kRelu6;
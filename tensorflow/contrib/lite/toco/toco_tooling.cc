@@ -246,6 +246,17 @@ void Transform(const TocoFlags& toco_flags, Model* model) {
 
     RunGraphTransformations(model, "dequantization graph transformations",
                             dequantization_transformations);
+    if (output_format == TFLITE) {
+      // The fused TF Lite kernel is float only, so this runs once the
+      // activations are known not to be quantized.
+      RunGraphTransformations(model, "float operator fusion transformations",
+                              {new FuseDepthwiseSeparableConv});
+    }
+    if (toco_flags.quantize_weights() && output_format == TFLITE) {
+      RunGraphTransformations(model,
+                              "weights quantization graph transformations",
+                              {new QuantizeWeights});
+    }
   }
 
   LogDump(kLogLevelModelChanged, "AFTER TRANSFORMATIONS", *model);
@@ -202,6 +202,7 @@ const char* OperatorTypeName(OperatorType type) {
     HANDLE_OPERATORTYPENAME_CASE(Conv)
     HANDLE_OPERATORTYPENAME_CASE(Concatenation)
     HANDLE_OPERATORTYPENAME_CASE(DepthwiseConv)
+    HANDLE_OPERATORTYPENAME_CASE(DepthwiseSeparableConv)
     HANDLE_OPERATORTYPENAME_CASE(DepthToSpace)
     HANDLE_OPERATORTYPENAME_CASE(SpaceToDepth)
     HANDLE_OPERATORTYPENAME_CASE(FullyConnected)
@@ -1358,6 +1359,27 @@ bool EstimateArithmeticOpsCount(const Model& model, int64* result) {
         }
         break;
       }
+      case OperatorType::kDepthwiseSeparableConv: {
+        const auto& output_array = model.GetArray(op->outputs[0]);
+        const auto& depthwise_weights_array = model.GetArray(op->inputs[1]);
+        const auto& pointwise_weights_array = model.GetArray(op->inputs[3]);
+        if (!output_array.has_shape() || !depthwise_weights_array.has_shape() ||
+            !pointwise_weights_array.has_shape()) {
+          return false;
+        }
+        int cols = 1;
+        for (int i = 0; i < output_array.shape().dimensions_count() - 1; i++) {
+          cols *= output_array.shape().dims(i);
+        }
+        // Both convolutions, plus one op per value for each bias vector.
+        const int64 cost_per_col =
+            2 * RequiredBufferSizeForShape(depthwise_weights_array.shape()) +
+            2 * RequiredBufferSizeForShape(pointwise_weights_array.shape()) +
+            depthwise_weights_array.shape().dims(3) +
+            output_array.shape().dims(3);
+        total += cost_per_col * cols;
+        break;
+      }
       case OperatorType::kAdd:
       case OperatorType::kSub:
       case OperatorType::kMul: {
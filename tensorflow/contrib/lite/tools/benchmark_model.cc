@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -23,6 +27,7 @@ limitations under the License.
 
 #include "tensorflow/contrib/lite/kernels/register.h"
 #include "tensorflow/contrib/lite/model.h"
+#include "tensorflow/contrib/lite/profiler.h"
 #include "tensorflow/contrib/lite/string_util.h"
 #include "tensorflow/contrib/lite/tools/mutable_op_resolver.h"
 
@@ -83,8 +88,160 @@ void InitImpl(const std::string& graph, const std::vector<int>& sizes,
   }
 }
 
+// Splits a comma separated list of integers such as "1,224,224,3".
+std::vector<int> ParseIntList(const std::string& list) {
+  std::vector<int> values;
+  size_t start = 0;
+  while (start < list.size()) {
+    size_t end = list.find(',', start);
+    if (end == std::string::npos) end = list.size();
+    values.push_back(std::atoi(list.substr(start, end - start).c_str()));
+    start = end + 1;
+  }
+  return values;
+}
+
+// Returns the value of "--<name>=<value>" if 'arg' is that flag.
+bool ParseFlag(const char* arg, const char* name, std::string* value) {
+  const size_t name_length = strlen(name);
+  if (strncmp(arg, "--", 2) != 0 || strncmp(arg + 2, name, name_length) != 0 ||
+      arg[2 + name_length] != '=') {
+    return false;
+  }
+  *value = arg + 3 + name_length;
+  return true;
+}
+
+// Accumulates the time spent in the nodes of each builtin operator type.
+class OpTypeProfiler : public tflite::Profiler {
+ public:
+  struct Stats {
+    double total_us = 0;
+    int num_nodes = 0;
+  };
+
+  void BeginNode(int node_index, const TfLiteNode& node,
+                 const TfLiteRegistration& registration) override {
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  void EndNode(int node_index, const TfLiteNode& node,
+               const TfLiteRegistration& registration) override {
+    const auto end = std::chrono::steady_clock::now();
+    Stats& stats = stats_[registration.builtin_code];
+    stats.total_us +=
+        std::chrono::duration<double, std::micro>(end - start_).count();
+    stats.num_nodes++;
+  }
+
+  // Maps builtin codes to the statistics of their nodes.
+  const std::map<int, Stats>& stats() const { return stats_; }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  std::map<int, Stats> stats_;
+};
+
+std::string OpTypeName(int builtin_code) {
+  if (builtin_code < tflite::BuiltinOperator_MIN ||
+      builtin_code > tflite::BuiltinOperator_MAX) {
+    return "UNKNOWN(" + std::to_string(builtin_code) + ")";
+  }
+  return tflite::EnumNameBuiltinOperator(
+      static_cast<tflite::BuiltinOperator>(builtin_code));
+}
+
+// Runs the model 'num_runs' times and returns the average time of one run, in
+// microseconds.
+double TimeInvoke(int num_runs) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_runs; ++i) {
+    CHECK(interpreter->Invoke() == kTfLiteOk);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         num_runs;
+}
+
+// Logs the average time per run spent in each operator type, most expensive
+// first.
+void LogOpTypeProfile(const OpTypeProfiler& profiler, int num_runs) {
+  std::vector<std::pair<int, OpTypeProfiler::Stats>> stats(
+      profiler.stats().begin(), profiler.stats().end());
+  std::sort(stats.begin(), stats.end(),
+            [](const std::pair<int, OpTypeProfiler::Stats>& a,
+               const std::pair<int, OpTypeProfiler::Stats>& b) {
+              return a.second.total_us > b.second.total_us;
+            });
+  double total_us = 0;
+  for (const auto& entry : stats) total_us += entry.second.total_us;
+  for (const auto& entry : stats) {
+    const OpTypeProfiler::Stats& op_stats = entry.second;
+    LOG(INFO) << "  " << OpTypeName(entry.first) << ": "
+              << op_stats.total_us / num_runs << " us per run, "
+              << op_stats.num_nodes / num_runs << " nodes, "
+              << 100 * op_stats.total_us / total_us << "%\n";
+  }
+}
+
 int Main(int argc, char** argv) {
-  InitImpl("", {}, "", 1);
+  std::string graph;
+  std::string input_layer_shape = "1,224,224,3";
+  std::string input_layer_type = "float";
+  std::string num_threads_list = "1,2,4";
+  std::string num_runs = "50";
+  std::string num_warmup_runs = "1";
+  std::string profile_ops = "true";
+  for (int i = 1; i < argc; ++i) {
+    if (!ParseFlag(argv[i], "graph", &graph) &&
+        !ParseFlag(argv[i], "input_layer_shape", &input_layer_shape) &&
+        !ParseFlag(argv[i], "input_layer_type", &input_layer_type) &&
+        !ParseFlag(argv[i], "num_threads", &num_threads_list) &&
+        !ParseFlag(argv[i], "num_runs", &num_runs) &&
+        !ParseFlag(argv[i], "num_warmup_runs", &num_warmup_runs) &&
+        !ParseFlag(argv[i], "profile_ops", &profile_ops)) {
+      LOG(ERROR) << "Unknown flag " << argv[i] << "\n";
+      LOG(ERROR) << "usage: " << argv[0]
+                 << " --graph=<model.tflite> [--input_layer_shape=1,224,224,3]"
+                    " [--input_layer_type=float] [--num_threads=1,2,4]"
+                    " [--num_runs=50] [--num_warmup_runs=1]"
+                    " [--profile_ops=true]\n";
+      return 1;
+    }
+  }
+  if (graph.empty()) {
+    LOG(ERROR) << "--graph is required\n";
+    return 1;
+  }
+
+  const std::vector<int> sizes = ParseIntList(input_layer_shape);
+  const int runs = std::max(1, std::atoi(num_runs.c_str()));
+  // The first runs allocate scratch buffers, start the worker threads and
+  // warm up the caches, so they are timed separately.
+  const int warmup_runs = std::max(1, std::atoi(num_warmup_runs.c_str()));
+  for (int num_threads : ParseIntList(num_threads_list)) {
+    InitImpl(graph, sizes, input_layer_type, num_threads);
+    const double warmup_us = TimeInvoke(warmup_runs);
+    const double average_us = TimeInvoke(runs);
+    LOG(INFO) << "num_threads=" << num_threads
+              << " warm-up inference time: " << warmup_us
+              << " us, steady-state average inference time: " << average_us
+              << " us\n";
+    // Dynamically sized tensors are only placed in the arena by Invoke().
+    LOG(INFO) << "memory arena high-water mark: "
+              << interpreter->ArenaHighWaterMark() << " bytes\n";
+
+    if (profile_ops == "true") {
+      // Profiled separately so that the clock reads around every node don't
+      // skew the overall averages above.
+      OpTypeProfiler profiler;
+      interpreter->SetProfiler(&profiler);
+      TimeInvoke(runs);
+      interpreter->SetProfiler(nullptr);
+      LOG(INFO) << "average time per operator type:\n";
+      LogOpTypeProfile(profiler, runs);
+    }
+  }
   return 0;
 }
 
@@ -821,6 +821,40 @@ class MutableDenseHashTableOpTest(test.TestCase):
       self.assertAllEqual([[0, 1, 2, 3], [3, 4, 5, 6], [-1, -2, -3, -4]],
                           result)
 
+  def testOnGpu(self):
+    if not test.is_gpu_available(cuda_only=True):
+      return
+    with self.test_session(force_gpu=True):
+      keys = constant_op.constant([11, 12, 13], dtypes.int64)
+      values = constant_op.constant([[0, 1], [2, 3], [4, 5]], dtypes.float32)
+      default_value = constant_op.constant([-1, -2], dtypes.float32)
+      table = lookup.MutableDenseHashTable(
+          dtypes.int64,
+          dtypes.float32,
+          default_value=default_value,
+          empty_key=0,
+          initial_num_buckets=4)
+      self.assertAllEqual(0, table.size().eval())
+
+      table.insert(keys, values).run()
+      self.assertAllEqual(3, table.size().eval())
+      self.assertAllEqual(4, len(table.export()[0].eval()))
+
+      # Grows the table and overwrites a value.
+      table.insert(
+          constant_op.constant([12], dtypes.int64),
+          constant_op.constant([[6, 7]], dtypes.float32)).run()
+      self.assertAllEqual(3, table.size().eval())
+      self.assertAllEqual(8, len(table.export()[0].eval()))
+      output = table.lookup(constant_op.constant([11, 12, 15, 0],
+                                                 dtypes.int64))
+      self.assertAllEqual([[0, 1], [6, 7], [-1, -2], [-1, -2]], output.eval())
+
+      with self.assertRaisesOpError("empty_key"):
+        table.insert(
+            constant_op.constant([0], dtypes.int64),
+            constant_op.constant([[8, 9]], dtypes.float32)).run()
+
   def testVectorKeys(self):
     with self.test_session():
       keys = constant_op.constant([[0, 1], [1, 2], [1, 3]], dtypes.int64)
@@ -1039,8 +1039,10 @@ class MPIAllreduceOp : public AsyncOpKernel {
     record.on_gpu = IsGPUDevice<Device>();
     record.dtype = input_tensor->dtype();
 
+    // Two chunks of the ring, see RingAllreduce.
     const size_t temp_size =
-        (input_tensor->NumElements() + mpi_global.size - 1) / mpi_global.size;
+        2 * RingAllreduceChunkSize(input_tensor->NumElements(),
+                                   mpi_global.size);
     TensorShape temp_shape;
     temp_shape.AddDim(temp_size);
     OP_REQUIRES_OK_ASYNC(context,
@@ -18,6 +18,8 @@ limitations under the License.
 
 #ifdef TENSORFLOW_USE_MPI
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/shape_inference.h"
@@ -35,6 +37,11 @@ limitations under the License.
 
 #define TAG_TENSOR 12
 
+// The largest number of elements sent in one message of the ring allreduce.
+// Segments are sent in chunks of this size, so that the accumulation of one
+// chunk overlaps the transfer of the next one.
+#define RING_CHUNK_ELEMENTS (256 * 1024)
+
 namespace tensorflow {
 namespace contrib {
 namespace mpi {
@@ -73,6 +80,15 @@ void AccumulateTensorData(T* destination, T* source, size_t size);
 cudaStream_t CudaStreamForMPI();
 #endif
 
+// Returns the number of elements in a chunk of the ring allreduce of
+// 'num_elements' elements over 'n' ranks. The temp tensor of RingAllreduce
+// holds two chunks.
+inline size_t RingAllreduceChunkSize(size_t num_elements, int n) {
+  const size_t segment_size = (num_elements + n - 1) / n;
+  return std::max<size_t>(
+      1, std::min<size_t>(RING_CHUNK_ELEMENTS, segment_size));
+}
+
 /* Perform a ring allreduce on the data. Allocate the necessary output tensor
  * and store it in the output parameter.
  *
@@ -151,6 +167,11 @@ cudaStream_t CudaStreamForMPI();
  * bytes of data, and the performance of the allreduce (assuming no latency in
  * connections) is constrained by the slowest interconnect between the nodes.
  *
+ * In the scatter-reduce, segments are sent as chunks of RingAllreduceChunkSize
+ * elements, received alternately into the two halves of 'temp', so that a
+ * chunk is accumulated while the next one is in flight. Device buffers are
+ * passed to MPI directly, which requires a CUDA-aware MPI for GPU tensors.
+ *
  */
 template <typename Device, typename T>
 Status RingAllreduce(OpKernelContext* context, const Tensor* input,
@@ -183,7 +204,11 @@ Status RingAllreduce(OpKernelContext* context, const Tensor* input,
 
   assert(segment_starts[n - 1] + segment_sizes[n - 1] == elements_to_reduce);
 
-  T* segment_recv = (T*)temp->tensor_data().data();
+  // Chunks are received alternately into the two halves of temp.
+  const size_t chunk_size = RingAllreduceChunkSize(elements_to_reduce, n);
+  T* chunk_recv[2];
+  chunk_recv[0] = (T*)temp->tensor_data().data();
+  chunk_recv[1] = chunk_recv[0] + chunk_size;
 
   // Receive from your left neighbor with wrap-around
   const size_t recv_from = ((r - 1) + n) % n;
@@ -192,7 +217,9 @@ Status RingAllreduce(OpKernelContext* context, const Tensor* input,
   const size_t send_to = (r + 1) % n;
 
   MPI_Status recv_status;
-  MPI_Request recv_req;
+  MPI_Request recv_reqs[2];
+  std::vector<MPI_Request> send_reqs;
+  std::vector<MPI_Status> send_statuses;
 
   // Now start ring. At every step, for every rank, we iterate through
   // segments with wraparound and send and recv from our neighbors and reduce
@@ -203,23 +230,54 @@ Status RingAllreduce(OpKernelContext* context, const Tensor* input,
     const size_t recv_seg_id = ((r - i - 1) + n) % n;
 
     T* segment_send = &(buffer[segment_starts[send_seg_id]]);
-
-    MPI_REQUIRES_OK(MPI_Irecv(segment_recv, segment_sizes[recv_seg_id],
-                              MPIType<T>(), recv_from, TAG_TENSOR,
-                              MPI_COMM_WORLD, &recv_req));
-
-    MPI_REQUIRES_OK(MPI_Send(segment_send, segment_sizes[send_seg_id],
-                             MPIType<T>(), send_to, TAG_TENSOR,
-                             MPI_COMM_WORLD));
-
     T* segment_update = &(buffer[segment_starts[recv_seg_id]]);
-
-    // Wait for recv to complete before reduction
-    MPI_REQUIRES_OK(MPI_Wait(&recv_req, &recv_status));
-
+    const size_t send_seg_size = segment_sizes[send_seg_id];
     const size_t recv_seg_size = segment_sizes[recv_seg_id];
-    AccumulateTensorData<Device, T>(segment_update, segment_recv,
-                                    recv_seg_size);
+    const size_t num_send_chunks =
+        (send_seg_size + chunk_size - 1) / chunk_size;
+    const size_t num_recv_chunks =
+        (recv_seg_size + chunk_size - 1) / chunk_size;
+    auto recv_chunk_size = [&](size_t c) {
+      return std::min(chunk_size, recv_seg_size - c * chunk_size);
+    };
+
+    // Keep the receives of two chunks outstanding.
+    for (size_t c = 0; c < 2 && c < num_recv_chunks; ++c) {
+      MPI_REQUIRES_OK(MPI_Irecv(chunk_recv[c], recv_chunk_size(c),
+                                MPIType<T>(), recv_from, TAG_TENSOR,
+                                MPI_COMM_WORLD, &recv_reqs[c]));
+    }
+
+    // The segment to send was fully accumulated in the previous step, so all
+    // of its chunks can be sent at once.
+    send_reqs.resize(num_send_chunks);
+    send_statuses.resize(num_send_chunks);
+    for (size_t c = 0; c < num_send_chunks; ++c) {
+      const size_t offset = c * chunk_size;
+      MPI_REQUIRES_OK(MPI_Isend(
+          segment_send + offset, std::min(chunk_size, send_seg_size - offset),
+          MPIType<T>(), send_to, TAG_TENSOR, MPI_COMM_WORLD, &send_reqs[c]));
+    }
+
+    for (size_t c = 0; c < num_recv_chunks; ++c) {
+      // Wait for recv to complete before reduction
+      MPI_REQUIRES_OK(MPI_Wait(&recv_reqs[c % 2], &recv_status));
+      AccumulateTensorData<Device, T>(segment_update + c * chunk_size,
+                                      chunk_recv[c % 2], recv_chunk_size(c));
+      // The accumulation is synchronous, so the half of temp it read from can
+      // receive the chunk after next.
+      if (c + 2 < num_recv_chunks) {
+        MPI_REQUIRES_OK(MPI_Irecv(chunk_recv[c % 2], recv_chunk_size(c + 2),
+                                  MPIType<T>(), recv_from, TAG_TENSOR,
+                                  MPI_COMM_WORLD, &recv_reqs[c % 2]));
+      }
+    }
+
+    // Complete the sends before their requests are reused.
+    if (num_send_chunks > 0) {
+      MPI_REQUIRES_OK(MPI_Waitall(num_send_chunks, send_reqs.data(),
+                                  send_statuses.data()));
+    }
   }
 
   // Now start pipelined ring allgather. At every step, for every rank, we
@@ -24,11 +24,17 @@ from tensorflow.contrib.util import loader
 from tensorflow.python.eager import context
 from tensorflow.python.framework import device
 from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
 from tensorflow.python.platform import resource_loader
 
 _nccl_ops_so = loader.load_op_library(
     resource_loader.get_path_to_datafile('_nccl_ops.so'))
 
+# The default size of the buckets of all_sum_bucketed. Buckets this large
+# amortize the launch latency of the collective while leaving enough of them
+# to overlap with the computation of the remaining gradients.
+_DEFAULT_BUCKET_BYTES = 16 << 20
+
 
 def all_sum(tensors):
   """Returns a list of tensors with the all-reduce sum across `tensors`.
@@ -76,6 +82,70 @@ def _all_sum_grad(op, grad):
         shared_name=shared_name)
 
 
+def all_sum_bucketed(tensor_lists, bucket_bytes=_DEFAULT_BUCKET_BYTES):
+  """Returns the all-reduce sums of many tensors, fused into few collectives.
+
+  Consecutive tensors of the same dtype are flattened and concatenated into
+  buckets of up to `bucket_bytes` bytes, and each bucket is summed with one
+  NcclAllReduce, in a name scope `nccl_bucket_<i>` so that the time of every
+  bucket shows up separately in the step stats. A bucket only depends on its
+  own tensors, so when `tensor_lists` holds gradients in the order in which
+  backprop produces them (e.g. the variables of the last layer first), the
+  reduction of the first buckets overlaps the computation of the rest.
+
+  Tensors with an unknown number of elements are reduced on their own.
+
+  Args:
+    tensor_lists: A list with one list of tensors per device. The lists must
+      have the same length, and their i-th tensors the same shape and dtype.
+      The tensors of each list must be assigned to the same GPU device.
+    bucket_bytes: The largest size in bytes of a fused bucket. A tensor larger
+      than this is reduced in a bucket of its own.
+
+  Returns:
+    A list with one list of tensors per device, where tensor j of list i is
+    the sum of the j-th tensors of all lists, on the device of list i.
+
+  Raises:
+    ValueError: If the lists are empty, or their shapes or devices differ.
+  """
+  if not tensor_lists or not tensor_lists[0]:
+    raise ValueError('Must pass >0 tensors to all reduce operations')
+  _check_graph_mode()
+  first = tensor_lists[0]
+  for tensors in tensor_lists:
+    if len(tensors) != len(first):
+      raise ValueError('All tensor lists must have the same length')
+    for t, f in zip(tensors, first):
+      _check_device(t, expected=tensors[0].device)
+      if t.dtype != f.dtype or not t.shape.is_compatible_with(f.shape):
+        raise ValueError('Tensors %s and %s differ in shape or dtype' %
+                         (t.name, f.name))
+
+  res = [[None] * len(first) for _ in tensor_lists]
+  for bucket_index, bucket in enumerate(_buckets(first, bucket_bytes)):
+    with ops.name_scope('nccl_bucket_%d' % bucket_index):
+      if len(bucket) == 1:
+        i = bucket[0]
+        reduced = _apply_all_reduce('sum', [l[i] for l in tensor_lists])
+        for r, result in zip(reduced, res):
+          result[i] = r
+        continue
+      flat = []
+      for tensors in tensor_lists:
+        with ops.device(tensors[0].device):
+          flat.append(
+              array_ops.concat(
+                  [array_ops.reshape(tensors[i], [-1]) for i in bucket], 0))
+      reduced = _apply_all_reduce('sum', flat)
+      sizes = [first[i].shape.num_elements() for i in bucket]
+      for r, result in zip(reduced, res):
+        with ops.device(r.device):
+          for i, part in zip(bucket, array_ops.split(r, sizes)):
+            result[i] = array_ops.reshape(part, first[i].shape.as_list())
+  return res
+
+
 def all_prod(tensors):
   """Returns a list of tensors with the all-reduce product across `tensors`.
 
@@ -246,6 +316,28 @@ def _apply_reduce(reduction, tensors):
   return result
 
 
+def _buckets(tensors, bucket_bytes):
+  """Yields lists of the indices of consecutive tensors to fuse."""
+  bucket = []
+  bucket_size = 0
+  for i, t in enumerate(tensors):
+    num_elements = t.shape.num_elements()
+    size = None if num_elements is None else num_elements * t.dtype.size
+    if bucket and (size is None or t.dtype != tensors[bucket[0]].dtype or
+                   bucket_size + size > bucket_bytes):
+      yield bucket
+      bucket = []
+      bucket_size = 0
+    bucket.append(i)
+    if size is None:
+      yield bucket
+      bucket = []
+    else:
+      bucket_size += size
+  if bucket:
+    yield bucket
+
+
 _lock = threading.Lock()
 _shared_name_counter = 0
 
@@ -41,6 +41,24 @@ def _NcclAllReduce(nccl_fun, tensors, devices):
   return nccl_fun(_DeviceTensors(tensors, devices))
 
 
+def _NcclAllSumBucketed(tensors, devices):
+  # Reduces three slices of each tensor, the first two of which share a bucket
+  # for 4 byte dtypes, and reassembles the results.
+  tensor_lists = []
+  for t in _DeviceTensors(tensors, devices):
+    with ops.device(t.device):
+      tensor_lists.append([t[0], t[1:2], array_ops.reshape(t[2:], [-1])])
+  res = []
+  for r in nccl.all_sum_bucketed(tensor_lists, bucket_bytes=40):
+    with ops.device(r[0].device):
+      res.append(
+          array_ops.concat([
+              array_ops.expand_dims(r[0], 0), r[1],
+              array_ops.expand_dims(r[2], 0)
+          ], 0))
+  return res
+
+
 def _NcclReduce(nccl_fun, tensors, devices):
   receiver = np.random.randint(0, len(devices))
   with ops.device(devices[receiver]):
@@ -143,6 +161,53 @@ class AllReduceTest(NcclTestCase):
     with self.assertRaisesRegexp(ValueError, 'Must pass >0 tensors'):
       nccl.all_sum([])
 
+  def testAllSumBucketed(self):
+    self._Test(_NcclAllSumBucketed, lambda x, y: x + y)
+
+  def testAllSumBucketedGrad(self):
+    self._TestGradient(_NcclAllSumBucketed, lambda x, y: x + y)
+
+  def testAllSumBucketedBuckets(self):
+    devices = ['/device:GPU:0', '/device:GPU:1']
+    with ops.Graph().as_default() as g:
+      tensor_lists = []
+      for d in devices:
+        with ops.device(d):
+          tensor_lists.append([
+              array_ops.zeros([4], dtype=np.float32),
+              array_ops.zeros([2, 2], dtype=np.float32),
+              array_ops.zeros([4], dtype=np.float64),
+              array_ops.placeholder(np.float64),
+              array_ops.zeros([2], dtype=np.float64),
+          ])
+      res = nccl.all_sum_bucketed(tensor_lists, bucket_bytes=32)
+      for r, tensors in zip(res, tensor_lists):
+        self.assertEqual([t.get_shape() for t in tensors],
+                         [t.get_shape() for t in r])
+      # The float32 tensors share the first bucket, and the float64 ones are
+      # separated by the placeholder of unknown shape.
+      all_reduces = [
+          op.name for op in g.get_operations() if op.type == 'NcclAllReduce'
+      ]
+      self.assertEqual(len(devices) * 4, len(all_reduces))
+      for i in range(4):
+        self.assertEqual(
+            len(devices),
+            len([n for n in all_reduces
+                 if n.startswith('nccl_bucket_%d/' % i)]))
+
+  def testAllSumBucketedErrors(self):
+    with ops.device('/device:GPU:0'):
+      a = array_ops.zeros([3])
+    with ops.device('/device:GPU:1'):
+      b = array_ops.zeros([4])
+    with self.assertRaisesRegexp(ValueError, 'Must pass >0 tensors'):
+      nccl.all_sum_bucketed([])
+    with self.assertRaisesRegexp(ValueError, 'same length'):
+      nccl.all_sum_bucketed([[a], [b, b]])
+    with self.assertRaisesRegexp(ValueError, 'differ in shape'):
+      nccl.all_sum_bucketed([[a], [b]])
+
 
 class SingleReduceTest(NcclTestCase):
 
@@ -0,0 +1,248 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace nearest_neighbor {
+namespace {
+
+// The file starts with kMagic, the dimension and the number of lists, then
+// holds the int64 list sizes and ids and the float centroids, squared norms
+// and vectors, with the lists in order. The int64 sections come first so
+// that every section of the mapped file is aligned.
+const char kMagic[8] = {'T', 'F', 'I', 'V', 'F', 'v', '0', '1'};
+
+template <typename T>
+Status AppendArray(WritableFile* file, const T* data, int64 size) {
+  if (size == 0) return Status::OK();
+  return file->Append(
+      StringPiece(reinterpret_cast<const char*>(data), size * sizeof(T)));
+}
+
+// Returns the next 'size' elements of the mapped file at *offset.
+template <typename T>
+Status ReadArray(ReadOnlyMemoryRegion* region, int64 size, uint64* offset,
+                 const T** data) {
+  if (size < 0 ||
+      static_cast<uint64>(size) > (region->length() - *offset) / sizeof(T)) {
+    return errors::DataLoss("Truncated IVF index file.");
+  }
+  const uint64 bytes = static_cast<uint64>(size) * sizeof(T);
+  *data = reinterpret_cast<const T*>(static_cast<const char*>(region->data()) +
+                                     *offset);
+  *offset += bytes;
+  return Status::OK();
+}
+
+}  // namespace
+
+IVFIndex::IVFIndex(const Eigen::Ref<const Matrix>& centroids)
+    : centroids_(centroids), lists_(centroids.rows()) {
+  UpdateCentroidNorms();
+}
+
+void IVFIndex::UpdateCentroidNorms() {
+  centroid_squared_norms_ = centroids_.rowwise().squaredNorm();
+}
+
+int64 IVFIndex::size() const {
+  int64 size = 0;
+  for (const List& list : lists_) {
+    size += list.size;
+  }
+  return size;
+}
+
+void IVFIndex::Add(const int64* ids, const Eigen::Ref<const Matrix>& vectors) {
+  const int64 num_vectors = vectors.rows();
+  if (num_vectors == 0 || num_lists() == 0) return;
+  // The nearest centroid minimizes |c|^2 - 2 <v, c>.
+  const Matrix scores =
+      (-2 * vectors * centroids_.transpose()).rowwise() +
+      centroid_squared_norms_.transpose();
+  for (int64 i = 0; i < num_vectors; ++i) {
+    Eigen::Index nearest;
+    scores.row(i).minCoeff(&nearest);
+    List& list = lists_[nearest];
+    if (!list.owned) {
+      list.owned_ids.assign(list.ids, list.ids + list.size);
+      list.owned_vectors.assign(list.vectors,
+                                list.vectors + list.size * dim());
+      list.owned_squared_norms.assign(list.squared_norms,
+                                      list.squared_norms + list.size);
+      list.owned = true;
+    }
+    list.owned_ids.push_back(ids[i]);
+    list.owned_vectors.insert(list.owned_vectors.end(), vectors.row(i).data(),
+                              vectors.row(i).data() + dim());
+    list.owned_squared_norms.push_back(vectors.row(i).squaredNorm());
+    ++list.size;
+  }
+  for (List& list : lists_) {
+    if (!list.owned) continue;
+    list.ids = list.owned_ids.data();
+    list.vectors = list.owned_vectors.data();
+    list.squared_norms = list.owned_squared_norms.data();
+  }
+}
+
+void IVFIndex::Search(const Eigen::Ref<const Matrix>& queries, int64 k,
+                      int64 num_probes, int64* ids, float* distances) const {
+  const int64 num_queries = queries.rows();
+  num_probes = std::min(num_probes, num_lists());
+  std::fill(ids, ids + num_queries * k, -1);
+  std::fill(distances, distances + num_queries * k,
+            std::numeric_limits<float>::infinity());
+  if (num_queries == 0 || k == 0 || num_probes <= 0) return;
+
+  // Scores the centroids of all queries with one matrix product.
+  const Matrix centroid_scores =
+      (-2 * queries * centroids_.transpose()).rowwise() +
+      centroid_squared_norms_.transpose();
+  std::vector<int64> probes(num_lists());
+  // A max-heap of the k nearest candidates so far.
+  using Candidate = std::pair<float, int64>;
+  std::priority_queue<Candidate> nearest;
+  Eigen::VectorXf scores;
+  for (int64 q = 0; q < num_queries; ++q) {
+    const auto query = queries.row(q);
+    std::iota(probes.begin(), probes.end(), 0);
+    std::partial_sort(probes.begin(), probes.begin() + num_probes,
+                      probes.end(), [&centroid_scores, q](int64 a, int64 b) {
+                        return centroid_scores(q, a) < centroid_scores(q, b);
+                      });
+    for (int64 p = 0; p < num_probes; ++p) {
+      const List& list = lists_[probes[p]];
+      if (list.size == 0) continue;
+      // The distance to v is |v|^2 - 2 <v, q> + |q|^2, where the last term
+      // is the same for all candidates.
+      const ConstMatrixMap vectors(list.vectors, list.size, dim());
+      scores.noalias() = vectors * query.transpose();
+      for (int64 i = 0; i < list.size; ++i) {
+        const float score = list.squared_norms[i] - 2 * scores(i);
+        if (nearest.size() < static_cast<size_t>(k)) {
+          nearest.emplace(score, list.ids[i]);
+        } else if (score < nearest.top().first) {
+          nearest.pop();
+          nearest.emplace(score, list.ids[i]);
+        }
+      }
+    }
+    const float query_squared_norm = query.squaredNorm();
+    for (int64 j = nearest.size() - 1; j >= 0; --j) {
+      ids[q * k + j] = nearest.top().second;
+      distances[q * k + j] =
+          std::max(0.0f, nearest.top().first + query_squared_norm);
+      nearest.pop();
+    }
+  }
+}
+
+Status IVFIndex::Save(Env* env, const string& filename) const {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  const int64 header[2] = {dim(), num_lists()};
+  TF_RETURN_IF_ERROR(AppendArray(file.get(), kMagic, sizeof(kMagic)));
+  TF_RETURN_IF_ERROR(AppendArray(file.get(), header, 2));
+  for (const List& list : lists_) {
+    TF_RETURN_IF_ERROR(AppendArray(file.get(), &list.size, 1));
+  }
+  for (const List& list : lists_) {
+    TF_RETURN_IF_ERROR(AppendArray(file.get(), list.ids, list.size));
+  }
+  TF_RETURN_IF_ERROR(
+      AppendArray(file.get(), centroids_.data(), centroids_.size()));
+  for (const List& list : lists_) {
+    TF_RETURN_IF_ERROR(
+        AppendArray(file.get(), list.squared_norms, list.size));
+  }
+  for (const List& list : lists_) {
+    TF_RETURN_IF_ERROR(
+        AppendArray(file.get(), list.vectors, list.size * dim()));
+  }
+  return file->Close();
+}
+
+Status IVFIndex::Load(Env* env, const string& filename,
+                      std::unique_ptr<IVFIndex>* index) {
+  std::unique_ptr<IVFIndex> loaded(new IVFIndex);
+  TF_RETURN_IF_ERROR(
+      env->NewReadOnlyMemoryRegionFromFile(filename, &loaded->region_));
+  ReadOnlyMemoryRegion* region = loaded->region_.get();
+  uint64 offset = 0;
+  const char* magic;
+  TF_RETURN_IF_ERROR(ReadArray(region, sizeof(kMagic), &offset, &magic));
+  if (!std::equal(kMagic, kMagic + sizeof(kMagic), magic)) {
+    return errors::DataLoss(filename, " is not an IVF index file.");
+  }
+  const int64* header;
+  TF_RETURN_IF_ERROR(ReadArray(region, 2, &offset, &header));
+  const int64 dim = header[0];
+  const int64 num_lists = header[1];
+  if (dim < 0 || num_lists < 0 ||
+      (dim > 0 && num_lists > std::numeric_limits<int64>::max() / dim)) {
+    return errors::DataLoss("Invalid IVF index file ", filename);
+  }
+  const int64* list_sizes;
+  TF_RETURN_IF_ERROR(ReadArray(region, num_lists, &offset, &list_sizes));
+  int64 total_size = 0;
+  for (int64 l = 0; l < num_lists; ++l) {
+    if (list_sizes[l] < 0 ||
+        list_sizes[l] > std::numeric_limits<int64>::max() - total_size) {
+      return errors::DataLoss("Invalid IVF index file ", filename);
+    }
+    total_size += list_sizes[l];
+  }
+  const int64* ids;
+  const float* centroids;
+  const float* squared_norms;
+  const float* vectors;
+  TF_RETURN_IF_ERROR(ReadArray(region, total_size, &offset, &ids));
+  TF_RETURN_IF_ERROR(ReadArray(region, num_lists * dim, &offset, &centroids));
+  TF_RETURN_IF_ERROR(ReadArray(region, total_size, &offset, &squared_norms));
+  if (dim > 0 && total_size > std::numeric_limits<int64>::max() / dim) {
+    return errors::DataLoss("Invalid IVF index file ", filename);
+  }
+  TF_RETURN_IF_ERROR(ReadArray(region, total_size * dim, &offset, &vectors));
+
+  loaded->centroids_ = ConstMatrixMap(centroids, num_lists, dim);
+  loaded->UpdateCentroidNorms();
+  loaded->lists_.resize(num_lists);
+  for (int64 l = 0; l < num_lists; ++l) {
+    List& list = loaded->lists_[l];
+    list.size = list_sizes[l];
+    list.ids = ids;
+    list.squared_norms = squared_norms;
+    list.vectors = vectors;
+    list.owned = false;
+    ids += list.size;
+    squared_norms += list.size;
+    vectors += list.size * dim;
+  }
+  *index = std::move(loaded);
+  return Status::OK();
+}
+
+}  // namespace nearest_neighbor
+}  // namespace tensorflow
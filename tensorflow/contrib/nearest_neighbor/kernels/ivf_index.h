@@ -0,0 +1,103 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
+
+#include <memory>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace nearest_neighbor {
+
+// An inverted file (IVF) index for approximate nearest neighbor search under
+// the squared euclidean distance. Every vector is stored in the list of its
+// nearest centroid, and a query only scores the vectors in the lists of its
+// num_probes nearest centroids, exactly.
+//
+// Save() writes the index to a file that Load() memory-maps. The lists of a
+// loaded index are then scored in place, and a list is only copied into
+// memory when vectors are added to it.
+class IVFIndex {
+ public:
+  using Matrix =
+      Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  using ConstMatrixMap = Eigen::Map<const Matrix>;
+
+  // Creates an empty index with one list per row of 'centroids'.
+  explicit IVFIndex(const Eigen::Ref<const Matrix>& centroids);
+
+  // Loads the index that Save() wrote to 'filename' by memory-mapping it.
+  static Status Load(Env* env, const string& filename,
+                     std::unique_ptr<IVFIndex>* index);
+
+  // Writes the index to 'filename'.
+  Status Save(Env* env, const string& filename) const;
+
+  int64 dim() const { return centroids_.cols(); }
+  int64 num_lists() const { return centroids_.rows(); }
+
+  // Returns the number of stored vectors.
+  int64 size() const;
+
+  // Adds the rows of 'vectors', where row i has id ids[i].
+  void Add(const int64* ids, const Eigen::Ref<const Matrix>& vectors);
+
+  // For each row i of 'queries', sets row i of the k-column row-major
+  // matrices 'ids' and 'distances' to the ids and squared distances of its k
+  // nearest vectors in the lists of its 'num_probes' nearest centroids,
+  // nearest first. Rows with fewer than k candidates are padded with id -1
+  // and an infinite distance. Concurrent calls are safe, but not concurrent
+  // with Add().
+  void Search(const Eigen::Ref<const Matrix>& queries, int64 k,
+              int64 num_probes, int64* ids, float* distances) const;
+
+ private:
+  // The vectors of one centroid. The pointers refer either to the owned
+  // vectors or, for a list that was loaded and not added to since, to the
+  // memory-mapped file.
+  struct List {
+    int64 size = 0;
+    const int64* ids = nullptr;
+    const float* vectors = nullptr;
+    const float* squared_norms = nullptr;
+    bool owned = true;
+    std::vector<int64> owned_ids;
+    std::vector<float> owned_vectors;
+    std::vector<float> owned_squared_norms;
+  };
+
+  IVFIndex() {}
+
+  // Sets the squared norms of the centroids after they changed.
+  void UpdateCentroidNorms();
+
+  // The file of a loaded index, which outlives the lists that point into it.
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  Matrix centroids_;
+  Eigen::VectorXf centroid_squared_norms_;
+  std::vector<List> lists_;
+};
+
+}  // namespace nearest_neighbor
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_NEAREST_NEIGHBOR_KERNELS_IVF_INDEX_H_
@@ -0,0 +1,274 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+using errors::FailedPrecondition;
+using errors::InvalidArgument;
+
+using nearest_neighbor::IVFIndex;
+
+// Holds the IVFIndex that the Create and Load ops set and the other ops use.
+class IVFIndexResource : public ResourceBase {
+ public:
+  string DebugString() override { return "IVFIndexResource"; }
+
+  tensorflow::mutex* mutex() { return &mu_; }
+
+  // The index, or nullptr before it is created or loaded. Requires mutex().
+  IVFIndex* index() { return index_.get(); }
+  void set_index(std::unique_ptr<IVFIndex> index) { index_ = std::move(index); }
+
+ private:
+  tensorflow::mutex mu_;
+  std::unique_ptr<IVFIndex> index_;
+};
+
+REGISTER_RESOURCE_HANDLE_KERNEL(IVFIndexResource);
+
+namespace {
+
+Status LookupOrCreateIVFIndexResource(OpKernelContext* context,
+                                      IVFIndexResource** resource) {
+  return LookupOrCreateResource<IVFIndexResource>(
+      context, HandleFromInput(context, 0), resource,
+      [](IVFIndexResource** resource) {
+        *resource = new IVFIndexResource;
+        return Status::OK();
+      });
+}
+
+Status CheckInitialized(IVFIndexResource* resource) {
+  if (resource->index() == nullptr) {
+    return FailedPrecondition("The IVF index has not been created or loaded.");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+class CreateIVFIndexOp : public OpKernel {
+ public:
+  explicit CreateIVFIndexOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& centroids_tensor = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(centroids_tensor.shape()),
+                InvalidArgument("Need a two-dimensional centroids tensor, got ",
+                                centroids_tensor.dims(), " dimensions."));
+    OP_REQUIRES(context, centroids_tensor.dim_size(0) > 0,
+                InvalidArgument("Need at least one centroid."));
+    std::unique_ptr<IVFIndex> index(new IVFIndex(IVFIndex::ConstMatrixMap(
+        centroids_tensor.matrix<float>().data(), centroids_tensor.dim_size(0),
+        centroids_tensor.dim_size(1))));
+
+    IVFIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupOrCreateIVFIndexResource(context, &resource));
+    core::ScopedUnref unref_me(resource);
+    mutex_lock l(*resource->mutex());
+    resource->set_index(std::move(index));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("CreateIVFIndex").Device(DEVICE_CPU),
+                        CreateIVFIndexOp);
+
+class LoadIVFIndexOp : public OpKernel {
+ public:
+  explicit LoadIVFIndexOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& filename_tensor = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(filename_tensor.shape()),
+                InvalidArgument("Need a scalar filename tensor, got ",
+                                filename_tensor.dims(), " dimensions."));
+    std::unique_ptr<IVFIndex> index;
+    OP_REQUIRES_OK(context,
+                   IVFIndex::Load(context->env(),
+                                  filename_tensor.scalar<string>()(), &index));
+
+    IVFIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupOrCreateIVFIndexResource(context, &resource));
+    core::ScopedUnref unref_me(resource);
+    mutex_lock l(*resource->mutex());
+    resource->set_index(std::move(index));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("LoadIVFIndex").Device(DEVICE_CPU),
+                        LoadIVFIndexOp);
+
+class SaveIVFIndexOp : public OpKernel {
+ public:
+  explicit SaveIVFIndexOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& filename_tensor = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(filename_tensor.shape()),
+                InvalidArgument("Need a scalar filename tensor, got ",
+                                filename_tensor.dims(), " dimensions."));
+    IVFIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+    tf_shared_lock l(*resource->mutex());
+    OP_REQUIRES_OK(context, CheckInitialized(resource));
+    OP_REQUIRES_OK(context,
+                   resource->index()->Save(context->env(),
+                                           filename_tensor.scalar<string>()()));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("SaveIVFIndex").Device(DEVICE_CPU),
+                        SaveIVFIndexOp);
+
+class IVFIndexAddOp : public OpKernel {
+ public:
+  explicit IVFIndexAddOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& ids_tensor = context->input(1);
+    const Tensor& vectors_tensor = context->input(2);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids_tensor.shape()),
+                InvalidArgument("Need a one-dimensional ids tensor, got ",
+                                ids_tensor.dims(), " dimensions."));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(vectors_tensor.shape()),
+                InvalidArgument("Need a two-dimensional vectors tensor, got ",
+                                vectors_tensor.dims(), " dimensions."));
+    OP_REQUIRES(context, ids_tensor.dim_size(0) == vectors_tensor.dim_size(0),
+                InvalidArgument("Need an id per vector, got ",
+                                ids_tensor.dim_size(0), " ids and ",
+                                vectors_tensor.dim_size(0), " vectors."));
+
+    IVFIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+    mutex_lock l(*resource->mutex());
+    OP_REQUIRES_OK(context, CheckInitialized(resource));
+    IVFIndex* index = resource->index();
+    OP_REQUIRES(context, vectors_tensor.dim_size(1) == index->dim(),
+                InvalidArgument("Need vectors of dimension ", index->dim(),
+                                ", got ", vectors_tensor.dim_size(1), "."));
+    index->Add(ids_tensor.vec<int64>().data(),
+               IVFIndex::ConstMatrixMap(vectors_tensor.matrix<float>().data(),
+                                        vectors_tensor.dim_size(0),
+                                        vectors_tensor.dim_size(1)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("IVFIndexAdd").Device(DEVICE_CPU), IVFIndexAddOp);
+
+class IVFIndexSearchOp : public OpKernel {
+ public:
+  explicit IVFIndexSearchOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& queries_tensor = context->input(1);
+    const Tensor& k_tensor = context->input(2);
+    const Tensor& num_probes_tensor = context->input(3);
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(queries_tensor.shape()),
+                InvalidArgument("Need a two-dimensional queries tensor, got ",
+                                queries_tensor.dims(), " dimensions."));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(k_tensor.shape()),
+                InvalidArgument("Need a scalar k tensor, got ",
+                                k_tensor.dims(), " dimensions."));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(num_probes_tensor.shape()),
+                InvalidArgument("Need a scalar num_probes tensor, got ",
+                                num_probes_tensor.dims(), " dimensions."));
+    const int64 k = k_tensor.scalar<int32>()();
+    const int64 num_probes = num_probes_tensor.scalar<int32>()();
+    OP_REQUIRES(context, k >= 1,
+                InvalidArgument("k must be at least 1 but got ", k, "."));
+    OP_REQUIRES(context, num_probes >= 1,
+                InvalidArgument("num_probes must be at least 1 but got ",
+                                num_probes, "."));
+
+    IVFIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+    tf_shared_lock l(*resource->mutex());
+    OP_REQUIRES_OK(context, CheckInitialized(resource));
+    const IVFIndex* index = resource->index();
+    const int64 num_queries = queries_tensor.dim_size(0);
+    const int64 dim = queries_tensor.dim_size(1);
+    OP_REQUIRES(context, dim == index->dim(),
+                InvalidArgument("Need queries of dimension ", index->dim(),
+                                ", got ", dim, "."));
+
+    Tensor* ids_tensor;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({num_queries, k}), &ids_tensor));
+    Tensor* distances_tensor;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, TensorShape({num_queries, k}),
+                                            &distances_tensor));
+    const IVFIndex::ConstMatrixMap queries(
+        queries_tensor.matrix<float>().data(), num_queries, dim);
+    int64* ids = ids_tensor->matrix<int64>().data();
+    float* distances = distances_tensor->matrix<float>().data();
+
+    // Each query scores the centroids and about num_probes / num_lists of the
+    // stored vectors.
+    const int64 num_lists = index->num_lists();
+    const int64 cost_per_query =
+        (num_lists + num_probes * (index->size() / num_lists + 1)) * dim;
+    auto work = [&](int64 start, int64 limit) {
+      index->Search(queries.middleRows(start, limit - start), k, num_probes,
+                    ids + start * k, distances + start * k);
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_queries,
+          cost_per_query, work);
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("IVFIndexSearch").Device(DEVICE_CPU),
+                        IVFIndexSearchOp);
+
+class IVFIndexSizeOp : public OpKernel {
+ public:
+  explicit IVFIndexSizeOp(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    IVFIndexResource* resource;
+    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
+                                           &resource));
+    core::ScopedUnref unref_me(resource);
+    tf_shared_lock l(*resource->mutex());
+    OP_REQUIRES_OK(context, CheckInitialized(resource));
+    Tensor* size_tensor;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({}), &size_tensor));
+    size_tensor->scalar<int64>()() = resource->index()->size();
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("IVFIndexSize").Device(DEVICE_CPU),
+                        IVFIndexSizeOp);
+
+}  // namespace tensorflow
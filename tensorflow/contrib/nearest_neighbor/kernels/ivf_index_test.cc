@@ -0,0 +1,148 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/contrib/nearest_neighbor/kernels/ivf_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace {
+
+using tensorflow::Env;
+using tensorflow::int64;
+using tensorflow::nearest_neighbor::IVFIndex;
+
+// Returns the indices of the k rows of 'vectors' nearest to 'query'.
+std::vector<int64> BruteForceNearest(const IVFIndex::Matrix& vectors,
+                                     const Eigen::RowVectorXf& query,
+                                     int64 k) {
+  std::vector<int64> order(vectors.rows());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int64 a, int64 b) {
+    return (vectors.row(a) - query).squaredNorm() <
+           (vectors.row(b) - query).squaredNorm();
+  });
+  order.resize(k);
+  return order;
+}
+
+void ExpectSearchIsExact(const IVFIndex& index,
+                         const IVFIndex::Matrix& vectors,
+                         const IVFIndex::Matrix& queries, int64 k) {
+  std::vector<int64> ids(queries.rows() * k);
+  std::vector<float> distances(queries.rows() * k);
+  index.Search(queries, k, index.num_lists(), ids.data(), distances.data());
+  for (int q = 0; q < queries.rows(); ++q) {
+    const std::vector<int64> expected =
+        BruteForceNearest(vectors, queries.row(q), k);
+    for (int j = 0; j < k; ++j) {
+      // The ids are the row indices plus 100.
+      EXPECT_EQ(expected[j] + 100, ids[q * k + j]) << q << " " << j;
+      EXPECT_NEAR((vectors.row(expected[j]) - queries.row(q)).squaredNorm(),
+                  distances[q * k + j], 1e-3);
+    }
+  }
+}
+
+class IVFIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    centroids_ = IVFIndex::Matrix::Random(8, 5);
+    vectors_ = IVFIndex::Matrix::Random(200, 5);
+    queries_ = IVFIndex::Matrix::Random(10, 5);
+    ids_.resize(vectors_.rows());
+    std::iota(ids_.begin(), ids_.end(), 100);
+  }
+
+  IVFIndex::Matrix centroids_;
+  IVFIndex::Matrix vectors_;
+  IVFIndex::Matrix queries_;
+  std::vector<int64> ids_;
+};
+
+TEST_F(IVFIndexTest, SearchAllListsIsExact) {
+  IVFIndex index(centroids_);
+  index.Add(ids_.data(), vectors_.topRows(120));
+  index.Add(ids_.data() + 120, vectors_.bottomRows(80));
+  EXPECT_EQ(200, index.size());
+  ExpectSearchIsExact(index, vectors_, queries_, 7);
+}
+
+TEST_F(IVFIndexTest, SearchOneList) {
+  IVFIndex index(centroids_);
+  index.Add(ids_.data(), vectors_);
+  // A vector is in the list of its nearest centroid, so probing one list
+  // finds a stored vector itself.
+  std::vector<int64> ids(vectors_.rows());
+  std::vector<float> distances(vectors_.rows());
+  index.Search(vectors_, 1, 1, ids.data(), distances.data());
+  for (int i = 0; i < vectors_.rows(); ++i) {
+    EXPECT_EQ(ids_[i], ids[i]);
+    EXPECT_NEAR(0, distances[i], 1e-4);
+  }
+}
+
+TEST_F(IVFIndexTest, PadsMissingNeighbors) {
+  IVFIndex index(centroids_);
+  index.Add(ids_.data(), vectors_.topRows(2));
+  std::vector<int64> ids(4);
+  std::vector<float> distances(4);
+  index.Search(queries_.topRows(1), 4, index.num_lists(), ids.data(),
+               distances.data());
+  EXPECT_NE(-1, ids[0]);
+  EXPECT_NE(-1, ids[1]);
+  EXPECT_EQ(-1, ids[2]);
+  EXPECT_EQ(-1, ids[3]);
+  EXPECT_EQ(std::numeric_limits<float>::infinity(), distances[3]);
+}
+
+TEST_F(IVFIndexTest, SaveAndLoad) {
+  Env* env = Env::Default();
+  const tensorflow::string filename =
+      tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), "ivf_index");
+  {
+    IVFIndex index(centroids_);
+    index.Add(ids_.data(), vectors_.topRows(150));
+    TF_ASSERT_OK(index.Save(env, filename));
+  }
+  std::unique_ptr<IVFIndex> loaded;
+  TF_ASSERT_OK(IVFIndex::Load(env, filename, &loaded));
+  EXPECT_EQ(5, loaded->dim());
+  EXPECT_EQ(8, loaded->num_lists());
+  EXPECT_EQ(150, loaded->size());
+  ExpectSearchIsExact(*loaded, vectors_.topRows(150), queries_, 5);
+
+  // Adding copies the lists it changes out of the mapped file.
+  loaded->Add(ids_.data() + 150, vectors_.bottomRows(50));
+  EXPECT_EQ(200, loaded->size());
+  ExpectSearchIsExact(*loaded, vectors_, queries_, 5);
+}
+
+TEST_F(IVFIndexTest, LoadRejectsOtherFiles) {
+  Env* env = Env::Default();
+  const tensorflow::string filename =
+      tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), "not_an_index");
+  TF_ASSERT_OK(WriteStringToFile(env, filename, "not an index file"));
+  std::unique_ptr<IVFIndex> loaded;
+  EXPECT_FALSE(IVFIndex::Load(env, filename, &loaded).ok());
+}
+
+}  // namespace
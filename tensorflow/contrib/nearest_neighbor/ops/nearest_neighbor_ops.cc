@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/shape_inference.h"
 
 namespace tensorflow {
 
@@ -46,4 +49,109 @@ probes: the output matrix of probes. Size `batch_size` times `num_probes`.
 table_ids: the output matrix of tables ids. Size `batch_size` times `num_probes`.
 )doc");
 
+REGISTER_RESOURCE_HANDLE_OP(IVFIndexResource);
+
+REGISTER_OP("CreateIVFIndex")
+    .Input("index_handle: resource")
+    .Input("centroids: float")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+Sets the index to an empty inverted file index.
+
+The index has one list per centroid, and a vector added to it is stored in the
+list of its nearest centroid. The centroids usually come from k-means over a
+sample of the vectors.
+
+index_handle: the handle of the index.
+centroids: a matrix of size `num_lists` times `dim` with the list centroids.
+)doc");
+
+REGISTER_OP("LoadIVFIndex")
+    .Input("index_handle: resource")
+    .Input("filename: string")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+Sets the index to the one saved in a file by memory-mapping the file.
+
+The stored vectors are searched in place, so the file must not change while
+the index uses it. The lists that vectors are added to are copied into memory.
+
+index_handle: the handle of the index.
+filename: the file written by SaveIVFIndex.
+)doc");
+
+REGISTER_OP("SaveIVFIndex")
+    .Input("index_handle: resource")
+    .Input("filename: string")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+Writes the index to a file that LoadIVFIndex can load.
+
+index_handle: the handle of the index.
+filename: the file to write.
+)doc");
+
+REGISTER_OP("IVFIndexAdd")
+    .Input("index_handle: resource")
+    .Input("ids: int64")
+    .Input("vectors: float")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+Adds vectors to the index.
+
+index_handle: the handle of the index.
+ids: a vector of size `num_vectors` with the ids the searches return.
+vectors: a matrix of size `num_vectors` times `dim`.
+)doc");
+
+REGISTER_OP("IVFIndexSearch")
+    .Input("index_handle: resource")
+    .Input("queries: float")
+    .Input("k: int32")
+    .Input("num_probes: int32")
+    .Output("ids: int64")
+    .Output("distances: float")
+    .SetIsStateful()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle queries;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &queries));
+      shape_inference::DimensionHandle k;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(2, &k));
+      shape_inference::ShapeHandle output =
+          c->Matrix(c->Dim(queries, 0), k);
+      c->set_output(0, output);
+      c->set_output(1, output);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Finds the approximate k nearest neighbors of a batch of queries.
+
+Every query scores exactly the vectors in the lists of its `num_probes` nearest
+centroids, under the squared euclidean distance. Queries with fewer than `k`
+candidates are padded with id -1 and an infinite distance.
+
+index_handle: the handle of the index.
+queries: a matrix of size `batch_size` times `dim`.
+k: the number of neighbors per query.
+num_probes: the number of lists to search per query.
+ids: the ids of the neighbors, nearest first. Size `batch_size` times `k`.
+distances: the squared distances of the neighbors. Size `batch_size` times `k`.
+)doc");
+
+REGISTER_OP("IVFIndexSize")
+    .Input("index_handle: resource")
+    .Output("size: int64")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Returns the number of vectors in the index.
+
+index_handle: the handle of the index.
+size: the number of vectors.
+)doc");
+
 }  // namespace tensorflow
@@ -0,0 +1,88 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+"""Tests for the IVF index ops."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+import numpy as np
+
+from tensorflow.contrib.nearest_neighbor.python.ops.nearest_neighbor_ops import IVFIndex
+from tensorflow.python.framework import errors
+from tensorflow.python.platform import test
+
+
+class IVFIndexTest(test.TestCase):
+
+  def setUp(self):
+    np.random.seed(0)
+    self._centroids = np.random.rand(4, 3).astype(np.float32)
+    self._vectors = np.random.rand(50, 3).astype(np.float32)
+    self._ids = np.arange(50, dtype=np.int64) + 1000
+    self._queries = np.random.rand(6, 3).astype(np.float32)
+
+  def _brute_force(self, vectors, ids, k):
+    distances = np.sum(
+        (self._queries[:, np.newaxis, :] - vectors[np.newaxis, :, :])**2,
+        axis=2)
+    order = np.argsort(distances, axis=1)[:, :k]
+    return ids[order], np.sort(distances, axis=1)[:, :k]
+
+  def testSearchAllLists(self):
+    with self.test_session() as sess:
+      index = IVFIndex("search_all_lists")
+      sess.run(index.create(self._centroids))
+      sess.run(index.add(self._ids, self._vectors))
+      self.assertEqual(50, sess.run(index.size()))
+      ids, distances = sess.run(index.search(self._queries, 5, 4))
+      expected_ids, expected_distances = self._brute_force(
+          self._vectors, self._ids, 5)
+      self.assertAllEqual(expected_ids, ids)
+      self.assertAllClose(expected_distances, distances, atol=1e-5)
+
+  def testSaveAndLoad(self):
+    filename = os.path.join(self.get_temp_dir(), "ivf_index")
+    with self.test_session() as sess:
+      index = IVFIndex("saved")
+      sess.run(index.create(self._centroids))
+      sess.run(index.add(self._ids[:30], self._vectors[:30]))
+      sess.run(index.save(filename))
+      loaded = IVFIndex("loaded")
+      sess.run(loaded.load(filename))
+      sess.run(loaded.add(self._ids[30:], self._vectors[30:]))
+      ids, _ = sess.run(loaded.search(self._queries, 3, 4))
+      expected_ids, _ = self._brute_force(self._vectors, self._ids, 3)
+      self.assertAllEqual(expected_ids, ids)
+
+  def testUninitialized(self):
+    with self.test_session() as sess:
+      index = IVFIndex("uninitialized")
+      with self.assertRaisesOpError("has not been created or loaded"):
+        sess.run(index.size())
+
+  def testWrongDimension(self):
+    with self.test_session() as sess:
+      index = IVFIndex("wrong_dimension")
+      sess.run(index.create(self._centroids))
+      with self.assertRaises(errors.InvalidArgumentError):
+        sess.run(index.search(self._queries[:, :2], 1, 1))
+
+
+if __name__ == "__main__":
+  test.main()
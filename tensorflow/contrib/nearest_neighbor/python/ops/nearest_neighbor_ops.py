@@ -62,3 +62,77 @@ def hyperplane_lsh_probes(point_hyperplane_product,
                                                      name=name)
 
 ops.NotDifferentiable("HyperplaneLSHProbes")
+
+
+class IVFIndex(object):
+  """An inverted file index for approximate nearest neighbor search.
+
+  Every vector is stored in the list of its nearest centroid, and a query
+  scores exactly the vectors in the lists of its `num_probes` nearest
+  centroids, under the squared euclidean distance. The centroids usually come
+  from k-means over a sample of the vectors.
+
+  The index lives in a resource shared by the ops below, so one graph can
+  build it with `create` and `add`, write it with `save`, and a serving graph
+  can `load` it, which memory-maps the file, and `search` it.
+  """
+
+  def __init__(self, name, container=""):
+    """Creates a handle to the index.
+
+    Args:
+      name: the shared name of the index. Handles with the same name in the
+        same container refer to the same index.
+      container: the resource container of the index.
+    """
+    with ops.name_scope(name, "IVFIndex") as scope:
+      self._handle = _nearest_neighbor_ops.ivf_index_resource_handle_op(
+          container=container, shared_name=name, name=scope)
+
+  @property
+  def handle(self):
+    return self._handle
+
+  def create(self, centroids, name=None):
+    """Returns an op that sets the index to an empty one with `centroids`."""
+    return _nearest_neighbor_ops.create_ivf_index(
+        self._handle, centroids, name=name)
+
+  def load(self, filename, name=None):
+    """Returns an op that sets the index to the one saved in `filename`."""
+    return _nearest_neighbor_ops.load_ivf_index(
+        self._handle, filename, name=name)
+
+  def save(self, filename, name=None):
+    """Returns an op that writes the index to `filename`."""
+    return _nearest_neighbor_ops.save_ivf_index(
+        self._handle, filename, name=name)
+
+  def add(self, ids, vectors, name=None):
+    """Returns an op that adds the rows of `vectors` with the given `ids`."""
+    return _nearest_neighbor_ops.ivf_index_add(
+        self._handle, ids, vectors, name=name)
+
+  def search(self, queries, k, num_probes, name=None):
+    """Finds the approximate `k` nearest neighbors of the rows of `queries`.
+
+    Args:
+      queries: a matrix of size `batch_size` times `dim`.
+      k: the number of neighbors per query.
+      num_probes: the number of lists to search per query.
+      name: A name prefix for the returned tensors (optional).
+
+    Returns:
+      ids: the ids of the neighbors, nearest first. Size `batch_size` times
+        `k`, padded with -1 for queries with fewer than `k` candidates.
+      distances: the squared distances of the neighbors, padded with infinity.
+    """
+    return _nearest_neighbor_ops.ivf_index_search(
+        self._handle, queries, k, num_probes, name=name)
+
+  def size(self, name=None):
+    """Returns the number of vectors in the index."""
+    return _nearest_neighbor_ops.ivf_index_size(self._handle, name=name)
+
+
+ops.NotDifferentiable("IVFIndexSearch")
@@ -65,6 +65,22 @@ class NadamOptimizer(adam.AdamOptimizer):
         use_locking=self._use_locking,
         use_nesterov=True)
 
+  def _resource_apply_multi(self, grads, var_list):
+    dtype = grads[0].dtype.base_dtype
+    return training_ops.resource_multi_apply_adam(
+        [var.handle for var in var_list],
+        [self.get_slot(var, "m").handle for var in var_list],
+        [self.get_slot(var, "v").handle for var in var_list],
+        math_ops.cast(self._beta1_power, dtype),
+        math_ops.cast(self._beta2_power, dtype),
+        math_ops.cast(self._lr_t, dtype),
+        math_ops.cast(self._beta1_t, dtype),
+        math_ops.cast(self._beta2_t, dtype),
+        math_ops.cast(self._epsilon_t, dtype),
+        grads,
+        use_locking=self._use_locking,
+        use_nesterov=True)
+
   def _apply_sparse_shared(self, grad, var, indices, scatter_add):
     beta1_power = math_ops.cast(self._beta1_power, var.dtype.base_dtype)
     beta2_power = math_ops.cast(self._beta2_power, var.dtype.base_dtype)
@@ -12,11 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 // =============================================================================
+#include <algorithm>
 #include <functional>
 #include "tensorflow/contrib/decision_trees/proto/generic_tree_model.pb.h"
 #include "tensorflow/contrib/decision_trees/proto/generic_tree_model_extensions.pb.h"
 #include "tensorflow/contrib/tensor_forest/kernels/data_spec.h"
 #include "tensorflow/contrib/tensor_forest/kernels/v4/decision-tree-resource.h"
+#include "tensorflow/contrib/tensor_forest/kernels/v4/flat_decision_tree.h"
 #include "tensorflow/contrib/tensor_forest/kernels/v4/input_data.h"
 #include "tensorflow/contrib/tensor_forest/proto/tensor_forest_params.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -157,6 +159,41 @@ void TraverseTree(const DecisionTreeResource* tree_resource,
   }
 }
 
+// Returns the flattened tree if it can route 'data', which needs the dense
+// features it tests, or nullptr.
+const FlatDecisionTree* GetFlatTree(
+    DecisionTreeResource* tree_resource,
+    const tensorforest::TensorForestDataSpec& input_spec,
+    const TensorDataSet& data) {
+  const FlatDecisionTree* flat_tree = tree_resource->GetFlatTree();
+  const Tensor& dense = data.original_tensor();
+  if (flat_tree == nullptr || dense.dims() != 2 ||
+      flat_tree->num_features() > input_spec.dense_features_size() ||
+      flat_tree->num_features() > dense.dim_size(1)) {
+    return nullptr;
+  }
+  return flat_tree;
+}
+
+// Like TraverseTree, routing blocks of examples through the flattened tree.
+void TraverseFlatTree(const FlatDecisionTree& flat_tree,
+                      const TensorDataSet& data, int32 start, int32 end,
+                      const std::function<void(int32, int32)>& set_leaf_id) {
+  const Tensor& dense = data.original_tensor();
+  const int64 num_columns = dense.dim_size(1);
+  const float* values = dense.flat<float>().data();
+  int32 leaves[FlatDecisionTree::kBlockSize];
+  const int32 block_size = FlatDecisionTree::kBlockSize;
+  for (int32 block = start; block < end; block += block_size) {
+    const int num_examples = std::min(block_size, end - block);
+    flat_tree.Route(values + block * num_columns, num_columns, num_examples,
+                    leaves);
+    for (int i = 0; i < num_examples; ++i) {
+      set_leaf_id(block + i, leaves[i]);
+    }
+  }
+}
+
 // Op for tree inference.
 class TreePredictionsV4Op : public OpKernel {
  public:
@@ -201,19 +238,30 @@ class TreePredictionsV4Op : public OpKernel {
 
     std::vector<TreePath> tree_paths(
         param_proto_.inference_tree_paths() ? num_data : 0);
+    // Paths are only recorded by the proto traversal.
+    const FlatDecisionTree* flat_tree =
+        param_proto_.inference_tree_paths()
+            ? nullptr
+            : GetFlatTree(decision_tree_resource, input_spec_, *data_set);
 
     auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
     int num_threads = worker_threads->num_threads;
     const int64 costPerTraverse = 500;
-    auto traverse = [this, &out, &data_set, decision_tree_resource, num_data,
-                     &tree_paths](int64 start, int64 end) {
+    auto traverse = [this, &out, &data_set, decision_tree_resource, flat_tree,
+                     num_data, &tree_paths](int64 start, int64 end) {
       CHECK(start <= end);
       CHECK(end <= num_data);
+      auto set_output_value =
+          std::bind(&TreePredictionsV4Op::set_output_value, this,
+                    std::placeholders::_1, std::placeholders::_2,
+                    decision_tree_resource, &out);
+      if (flat_tree != nullptr) {
+        TraverseFlatTree(*flat_tree, *data_set, static_cast<int32>(start),
+                         static_cast<int32>(end), set_output_value);
+        return;
+      }
       TraverseTree(decision_tree_resource, data_set, static_cast<int32>(start),
-                   static_cast<int32>(end),
-                   std::bind(&TreePredictionsV4Op::set_output_value, this,
-                             std::placeholders::_1, std::placeholders::_2,
-                             decision_tree_resource, &out),
+                   static_cast<int32>(end), set_output_value,
                    param_proto_.inference_tree_paths() ? &tree_paths : nullptr);
     };
     Shard(num_threads, worker_threads->workers, num_data, costPerTraverse,
@@ -300,14 +348,21 @@ class TraverseTreeV4Op : public OpKernel {
     auto leaf_ids = output_predictions->tensor<int32, 1>();
 
     auto set_leaf_ids = [&leaf_ids](int32 i, int32 id) { leaf_ids(i) = id; };
+    const FlatDecisionTree* flat_tree =
+        GetFlatTree(decision_tree_resource, input_spec_, *data_set);
 
     auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
     int num_threads = worker_threads->num_threads;
     const int64 costPerTraverse = 500;
     auto traverse = [this, &set_leaf_ids, &data_set, decision_tree_resource,
-                     num_data](int64 start, int64 end) {
+                     flat_tree, num_data](int64 start, int64 end) {
       CHECK(start <= end);
       CHECK(end <= num_data);
+      if (flat_tree != nullptr) {
+        TraverseFlatTree(*flat_tree, *data_set, static_cast<int32>(start),
+                         static_cast<int32>(end), set_leaf_ids);
+        return;
+      }
       TraverseTree(decision_tree_resource, data_set, static_cast<int32>(start),
                    static_cast<int32>(end), set_leaf_ids, nullptr);
     };
@@ -78,9 +78,13 @@ void DecisionTreeResource::SplitNode(int32 node_id, SplitCandidate* best,
     node_evaluators_.emplace_back(nullptr);
   }
   node_evaluators_[node_id] = CreateDecisionNodeEvaluator(*node);
+  flat_tree_.reset();
+  flat_tree_built_ = false;
 }
 
 void DecisionTreeResource::MaybeInitialize() {
+  flat_tree_.reset();
+  flat_tree_built_ = false;
   DecisionTree* tree = decision_tree_->mutable_decision_tree();
   if (tree->nodes_size() == 0) {
     model_op_->InitModel(tree->add_nodes()->mutable_leaf());
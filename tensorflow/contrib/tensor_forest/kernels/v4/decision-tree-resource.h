@@ -17,6 +17,7 @@
 
 #include "tensorflow/contrib/decision_trees/proto/generic_tree_model.pb.h"
 #include "tensorflow/contrib/tensor_forest/kernels/v4/decision_node_evaluator.h"
+#include "tensorflow/contrib/tensor_forest/kernels/v4/flat_decision_tree.h"
 #include "tensorflow/contrib/tensor_forest/kernels/v4/input_data.h"
 #include "tensorflow/contrib/tensor_forest/kernels/v4/leaf_model_operators.h"
 #include "tensorflow/contrib/tensor_forest/proto/fertile_stats.pb.h"
@@ -46,9 +47,22 @@ class DecisionTreeResource : public ResourceBase {
   }
 
   decision_trees::Model* mutable_decision_tree() {
+    flat_tree_.reset();
+    flat_tree_built_ = false;
     return decision_tree_.get();
   }
 
+  // Returns the tree flattened for inference, or nullptr if it cannot be
+  // flattened. It is built on the first call after the tree structure
+  // changed, so the caller needs to hold the mutex lock.
+  const FlatDecisionTree* GetFlatTree() {
+    if (!flat_tree_built_) {
+      flat_tree_ = FlatDecisionTree::Create(decision_tree_->decision_tree());
+      flat_tree_built_ = true;
+    }
+    return flat_tree_.get();
+  }
+
   const decision_trees::Leaf& get_leaf(int32 id) const {
     return decision_tree_->decision_tree().nodes(id).leaf();
   }
@@ -61,6 +75,8 @@ class DecisionTreeResource : public ResourceBase {
   // Caller needs to hold the mutex lock while calling this.
   void Reset() {
     decision_tree_.reset(new decision_trees::Model());
+    flat_tree_.reset();
+    flat_tree_built_ = false;
   }
 
   mutex* get_mutex() { return &mu_; }
@@ -82,6 +98,8 @@ class DecisionTreeResource : public ResourceBase {
   std::unique_ptr<decision_trees::Model> decision_tree_;
   std::shared_ptr<LeafModelOperator> model_op_;
   std::vector<std::unique_ptr<DecisionNodeEvaluator>> node_evaluators_;
+  std::unique_ptr<FlatDecisionTree> flat_tree_;
+  bool flat_tree_built_ = false;
 };
 
 
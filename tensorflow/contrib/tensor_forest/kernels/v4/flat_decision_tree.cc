@@ -0,0 +1,117 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/tensor_forest/kernels/v4/flat_decision_tree.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace tensorforest {
+
+constexpr int FlatDecisionTree::kBlockSize;
+
+std::unique_ptr<FlatDecisionTree> FlatDecisionTree::Create(
+    const decision_trees::DecisionTree& tree) {
+  const int32 num_nodes = tree.nodes_size();
+  if (num_nodes == 0) {
+    return nullptr;
+  }
+  std::unique_ptr<FlatDecisionTree> flat(new FlatDecisionTree);
+  flat->features_.resize(num_nodes, 0);
+  flat->thresholds_.resize(num_nodes, 0);
+  flat->include_equals_.resize(num_nodes, 0);
+  flat->left_ids_.resize(num_nodes);
+  flat->right_ids_.resize(num_nodes);
+
+  // Walks the tree from the root, which also checks that every node is
+  // reached once, so that the depth bounds the routing.
+  std::vector<bool> reached(num_nodes, false);
+  std::vector<std::pair<int32, int32>> stack = {{0, 0}};
+  reached[0] = true;
+  while (!stack.empty()) {
+    const int32 id = stack.back().first;
+    const int32 depth = stack.back().second;
+    stack.pop_back();
+    flat->depth_ = std::max(flat->depth_, depth);
+    const decision_trees::TreeNode& node = tree.nodes(id);
+    if (node.has_leaf()) {
+      flat->left_ids_[id] = id;
+      flat->right_ids_[id] = id;
+      continue;
+    }
+    if (!node.has_binary_node()) {
+      return nullptr;
+    }
+    const decision_trees::BinaryNode& binary_node = node.binary_node();
+    if (!binary_node.has_inequality_left_child_test()) {
+      return nullptr;
+    }
+    const decision_trees::InequalityTest& test =
+        binary_node.inequality_left_child_test();
+    int32 feature;
+    if (test.has_oblique() ||
+        !strings::safe_strto32(test.feature_id().id().value(), &feature) ||
+        feature < 0) {
+      return nullptr;
+    }
+    flat->features_[id] = feature;
+    flat->thresholds_[id] = test.threshold().float_value();
+    flat->include_equals_[id] =
+        test.type() == decision_trees::InequalityTest::LESS_OR_EQUAL;
+    flat->num_features_ = std::max(flat->num_features_, feature + 1);
+    const int32 left = binary_node.left_child_id().value();
+    const int32 right = binary_node.right_child_id().value();
+    for (const int32 child : {left, right}) {
+      if (child < 0 || child >= num_nodes || reached[child] ||
+          tree.nodes(child).node_id().value() != child) {
+        return nullptr;
+      }
+      reached[child] = true;
+      stack.emplace_back(child, depth + 1);
+    }
+    flat->left_ids_[id] = left;
+    flat->right_ids_[id] = right;
+  }
+  return flat;
+}
+
+void FlatDecisionTree::Route(const float* data, int64 num_columns,
+                             int num_examples, int32* leaves) const {
+  DCHECK_LE(num_examples, kBlockSize);
+  DCHECK_GE(num_columns, num_features_);
+  int32 nodes[kBlockSize] = {0};
+  const int32* features = features_.data();
+  const float* thresholds = thresholds_.data();
+  const int32* include_equals = include_equals_.data();
+  const int32* left_ids = left_ids_.data();
+  const int32* right_ids = right_ids_.data();
+  for (int32 d = 0; d < depth_; ++d) {
+    for (int i = 0; i < num_examples; ++i) {
+      const int32 node = nodes[i];
+      const float value = data[i * num_columns + features[node]];
+      const float threshold = thresholds[node];
+      const bool left =
+          (value < threshold) | (include_equals[node] & (value == threshold));
+      nodes[i] = left ? left_ids[node] : right_ids[node];
+    }
+  }
+  std::copy(nodes, nodes + num_examples, leaves);
+}
+
+}  // namespace tensorforest
+}  // namespace tensorflow
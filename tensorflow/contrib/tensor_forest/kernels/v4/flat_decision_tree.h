@@ -0,0 +1,68 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#ifndef THIRD_PARTY_TENSORFLOW_CONTRIB_TENSOR_FOREST_KERNELS_V4_FLAT_DECISION_TREE_H_
+#define THIRD_PARTY_TENSORFLOW_CONTRIB_TENSOR_FOREST_KERNELS_V4_FLAT_DECISION_TREE_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/contrib/decision_trees/proto/generic_tree_model.pb.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace tensorforest {
+
+// A decision tree flattened for inference. The nodes are stored in parallel
+// arrays instead of protos and evaluators, and a block of examples is routed
+// through the tree one level at a time, which keeps the upper levels of the
+// tree in cache and lets the compiler interleave the examples. Only trees
+// whose decisions are all inequality tests on a single feature are flattened.
+class FlatDecisionTree {
+ public:
+  // Number of examples routed through the tree together.
+  static constexpr int kBlockSize = 16;
+
+  // Returns the flattened 'tree', or nullptr if it has other decisions.
+  static std::unique_ptr<FlatDecisionTree> Create(
+      const decision_trees::DecisionTree& tree);
+
+  // Returns one more than the largest feature the tree tests.
+  int32 num_features() const { return num_features_; }
+
+  // Routes the 'num_examples' <= kBlockSize rows of 'data', a row-major
+  // matrix with 'num_columns' >= num_features() columns, and sets leaves[i]
+  // to the node id of the leaf of row i.
+  void Route(const float* data, int64 num_columns, int num_examples,
+             int32* leaves) const;
+
+ private:
+  FlatDecisionTree() {}
+
+  // The nodes, indexed by node id. A leaf is its own left and right child,
+  // so that routing a row for the depth of the tree ends at its leaf.
+  std::vector<int32> features_;
+  std::vector<float> thresholds_;
+  // 1 if the test is '<=' as opposed to '<'.
+  std::vector<int32> include_equals_;
+  std::vector<int32> left_ids_;
+  std::vector<int32> right_ids_;
+  int32 depth_ = 0;
+  int32 num_features_ = 0;
+};
+
+}  // namespace tensorforest
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CONTRIB_TENSOR_FOREST_KERNELS_V4_FLAT_DECISION_TREE_H_
@@ -0,0 +1,158 @@
+// Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// =============================================================================
+#include "tensorflow/contrib/tensor_forest/kernels/v4/flat_decision_tree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/contrib/decision_trees/proto/generic_tree_model.pb.h"
+#include "tensorflow/contrib/tensor_forest/kernels/v4/decision_node_evaluator.h"
+#include "tensorflow/contrib/tensor_forest/kernels/v4/test_utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using tensorflow::decision_trees::DecisionTree;
+using tensorflow::decision_trees::InequalityTest;
+using tensorflow::decision_trees::TreeNode;
+using tensorflow::tensorforest::CreateDecisionNodeEvaluator;
+using tensorflow::tensorforest::FlatDecisionTree;
+using tensorflow::tensorforest::TensorDataSet;
+using tensorflow::tensorforest::TestableDataSet;
+
+// Adds a leaf, or a test on 'feature' if 'left' and 'right' are set.
+void AddNode(DecisionTree* tree, int32 feature, float threshold,
+             InequalityTest::Type type, int32 left, int32 right) {
+  TreeNode* node = tree->add_nodes();
+  node->mutable_node_id()->set_value(tree->nodes_size() - 1);
+  if (left < 0) {
+    node->mutable_leaf();
+    return;
+  }
+  auto* binary_node = node->mutable_binary_node();
+  binary_node->mutable_left_child_id()->set_value(left);
+  binary_node->mutable_right_child_id()->set_value(right);
+  auto* test = binary_node->mutable_inequality_left_child_test();
+  test->mutable_feature_id()->mutable_id()->set_value(
+      strings::StrCat(feature));
+  test->mutable_threshold()->set_float_value(threshold);
+  test->set_type(type);
+}
+
+void AddLeaf(DecisionTree* tree) {
+  AddNode(tree, 0, 0, InequalityTest::LESS_OR_EQUAL, -1, -1);
+}
+
+// Routes example 'i' through 'tree' with the proto evaluators.
+int32 RouteWithEvaluators(const DecisionTree& tree,
+                          const std::unique_ptr<TensorDataSet>& data,
+                          int i) {
+  int32 id = 0;
+  while (!tree.nodes(id).has_leaf()) {
+    id = CreateDecisionNodeEvaluator(tree.nodes(id))->Decide(data, i);
+  }
+  return id;
+}
+
+TEST(FlatDecisionTreeTest, MatchesEvaluators) {
+  DecisionTree tree;
+  AddNode(&tree, 0, 3.0, InequalityTest::LESS_OR_EQUAL, 1, 2);
+  AddNode(&tree, 1, 1.0, InequalityTest::LESS_THAN, 3, 4);
+  AddNode(&tree, 2, 5.0, InequalityTest::LESS_OR_EQUAL, 5, 6);
+  AddLeaf(&tree);
+  AddLeaf(&tree);
+  AddLeaf(&tree);
+  AddNode(&tree, 1, 2.0, InequalityTest::LESS_THAN, 7, 8);
+  AddLeaf(&tree);
+  AddLeaf(&tree);
+
+  std::unique_ptr<FlatDecisionTree> flat = FlatDecisionTree::Create(tree);
+  ASSERT_NE(flat, nullptr);
+  EXPECT_EQ(flat->num_features(), 3);
+
+  // Rows of 4 columns, covering both sides of and the ties with every
+  // threshold as well as NaN, over more than one block.
+  const std::vector<float> values = {0.0, 1.0, 2.0, 3.0, 5.0, NAN};
+  std::vector<float> data;
+  for (int i = 0; i < 40; ++i) {
+    data.push_back(values[i % 6]);
+    data.push_back(values[(i / 6) % 6]);
+    data.push_back(values[(i * 5) % 6]);
+    data.push_back(-1.0);
+  }
+  const int num_rows = data.size() / 4;
+  std::unique_ptr<TensorDataSet> data_set(new TestableDataSet(data, 4));
+
+  for (int start = 0; start < num_rows; start += FlatDecisionTree::kBlockSize) {
+    const int n = std::min(FlatDecisionTree::kBlockSize, num_rows - start);
+    int32 leaves[FlatDecisionTree::kBlockSize];
+    flat->Route(data.data() + start * 4, 4, n, leaves);
+    for (int i = 0; i < n; ++i) {
+      EXPECT_EQ(leaves[i], RouteWithEvaluators(tree, data_set, start + i))
+          << "row " << start + i;
+    }
+  }
+}
+
+TEST(FlatDecisionTreeTest, SingleLeaf) {
+  DecisionTree tree;
+  AddLeaf(&tree);
+  std::unique_ptr<FlatDecisionTree> flat = FlatDecisionTree::Create(tree);
+  ASSERT_NE(flat, nullptr);
+  EXPECT_EQ(flat->num_features(), 0);
+
+  const std::vector<float> data = {1.0, 2.0, 3.0};
+  int32 leaves[3];
+  flat->Route(data.data(), 1, 3, leaves);
+  EXPECT_EQ(leaves[0], 0);
+  EXPECT_EQ(leaves[1], 0);
+  EXPECT_EQ(leaves[2], 0);
+}
+
+TEST(FlatDecisionTreeTest, UnsupportedTrees) {
+  DecisionTree oblique;
+  AddNode(&oblique, 0, 1.0, InequalityTest::LESS_OR_EQUAL, 1, 2);
+  AddLeaf(&oblique);
+  AddLeaf(&oblique);
+  oblique.mutable_nodes(0)
+      ->mutable_binary_node()
+      ->mutable_inequality_left_child_test()
+      ->mutable_oblique()
+      ->add_weights(1.0);
+  EXPECT_EQ(FlatDecisionTree::Create(oblique), nullptr);
+
+  DecisionTree matching;
+  AddNode(&matching, 0, 1.0, InequalityTest::LESS_OR_EQUAL, 1, 2);
+  AddLeaf(&matching);
+  AddLeaf(&matching);
+  matching.mutable_nodes(0)
+      ->mutable_binary_node()
+      ->mutable_custom_left_child_test();
+  EXPECT_EQ(FlatDecisionTree::Create(matching), nullptr);
+
+  DecisionTree bad_child;
+  AddNode(&bad_child, 0, 1.0, InequalityTest::LESS_OR_EQUAL, 1, 5);
+  AddLeaf(&bad_child);
+  AddLeaf(&bad_child);
+  EXPECT_EQ(FlatDecisionTree::Create(bad_child), nullptr);
+
+  EXPECT_EQ(FlatDecisionTree::Create(DecisionTree()), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
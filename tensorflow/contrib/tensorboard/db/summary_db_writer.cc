@@ -41,6 +41,9 @@ const int kIdCollisionDelayMicros = 10;
 const int kMaxIdCollisions = 21;  // sum(2**i*10µs for i in range(21))~=21s
 const int64 kAbsent = 0LL;
 const int64 kReserved = 0x7fffffffffffffffLL;
+// Writes are grouped into transactions of up to this many writes or this age.
+const int kMaxWritesPerTransaction = 1000;
+const uint64 kMaxTransactionMicros = 1000000;
 
 double GetWallTime(Env* env) {
   // TODO(@jart): Follow precise definitions for time laid out in schema.
@@ -522,6 +525,13 @@ class RunWriter {
   SqliteStatement insert_tensor_;
 };
 
+/// \brief SummaryWriterInterface that inserts into a SQLite database.
+///
+/// Writes are grouped into transactions, which are committed after
+/// kMaxWritesPerTransaction writes, by the first write after the
+/// transaction got kMaxTransactionMicros old, and on Flush(). This
+/// saves a journal sync per row, but uncommitted rows are lost if the
+/// process dies without flushing.
 class SummaryDbWriter : public SummaryWriterInterface {
  public:
   SummaryDbWriter(Env* env, std::shared_ptr<Sqlite> db,
@@ -529,10 +539,22 @@ class SummaryDbWriter : public SummaryWriterInterface {
                   const string& user_name)
       : SummaryWriterInterface(),
         env_{env},
-        run_writer_{env, std::move(db), experiment_name, run_name, user_name} {}
-  ~SummaryDbWriter() override {}
+        run_writer_{env, db, experiment_name, run_name, user_name},
+        begin_{db->Prepare("BEGIN")},
+        commit_{db->Prepare("COMMIT")} {}
 
-  Status Flush() override { return Status::OK(); }
+  ~SummaryDbWriter() override {
+    mutex_lock ml(mu_);
+    Status s = Commit();
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to commit summaries: " << s.ToString();
+    }
+  }
+
+  Status Flush() override {
+    mutex_lock ml(mu_);
+    return Commit();
+  }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
                      const string& serialized_metadata) override {
@@ -543,8 +565,10 @@ class SummaryDbWriter : public SummaryWriterInterface {
     }
     double now = GetWallTime(env_);
     int64 tag_id;
+    TF_RETURN_IF_ERROR(BeginWrite());
     TF_RETURN_IF_ERROR(run_writer_.GetTagId(now, tag, metadata, &tag_id));
-    return run_writer_.InsertTensor(tag_id, global_step, now, t);
+    TF_RETURN_IF_ERROR(run_writer_.InsertTensor(tag_id, global_step, now, t));
+    return EndWrite();
   }
 
   Status WriteScalar(int64 global_step, Tensor t, const string& tag) override {
@@ -556,17 +580,22 @@ class SummaryDbWriter : public SummaryWriterInterface {
 
   Status WriteGraph(int64 global_step, std::unique_ptr<GraphDef> g) override {
     mutex_lock ml(mu_);
-    return run_writer_.InsertGraph(std::move(g), GetWallTime(env_));
+    TF_RETURN_IF_ERROR(BeginWrite());
+    TF_RETURN_IF_ERROR(
+        run_writer_.InsertGraph(std::move(g), GetWallTime(env_)));
+    return EndWrite();
   }
 
   Status WriteEvent(std::unique_ptr<Event> e) override {
     switch (e->what_case()) {
       case Event::WhatCase::kSummary: {
         mutex_lock ml(mu_);
+        TF_RETURN_IF_ERROR(BeginWrite());
         Status s;
         for (const auto& value : e->summary().value()) {
           s.Update(WriteSummary(e.get(), value));
         }
+        s.Update(EndWrite());
         return s;
       }
       case Event::WhatCase::kGraphDef: {
@@ -575,7 +604,10 @@ class SummaryDbWriter : public SummaryWriterInterface {
         if (!ParseProtoUnlimited(graph.get(), e->graph_def())) {
           return errors::DataLoss("parse event.graph_def failed");
         }
-        return run_writer_.InsertGraph(std::move(graph), e->wall_time());
+        TF_RETURN_IF_ERROR(BeginWrite());
+        TF_RETURN_IF_ERROR(
+            run_writer_.InsertGraph(std::move(graph), e->wall_time()));
+        return EndWrite();
       }
       default:
         // TODO(@jart): Handle other stuff.
@@ -607,6 +639,32 @@ class SummaryDbWriter : public SummaryWriterInterface {
   string DebugString() override { return "SummaryDbWriter"; }
 
  private:
+  // Opens a transaction for the following write, unless one is open.
+  Status BeginWrite() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (in_transaction_) return Status::OK();
+    TF_RETURN_IF_ERROR(begin_.StepAndReset());
+    in_transaction_ = true;
+    transaction_start_micros_ = env_->NowMicros();
+    return Status::OK();
+  }
+
+  // Commits the transaction once it is big or old enough.
+  Status EndWrite() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (++num_uncommitted_writes_ >= kMaxWritesPerTransaction ||
+        env_->NowMicros() - transaction_start_micros_ >=
+            kMaxTransactionMicros) {
+      return Commit();
+    }
+    return Status::OK();
+  }
+
+  Status Commit() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!in_transaction_) return Status::OK();
+    in_transaction_ = false;
+    num_uncommitted_writes_ = 0;
+    return commit_.StepAndReset();
+  }
+
   Status WriteSummary(const Event* e, const Summary::Value& summary)
       EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     switch (summary.value_case()) {
@@ -627,6 +685,11 @@ class SummaryDbWriter : public SummaryWriterInterface {
   mutex mu_;
   Env* env_;
   RunWriter run_writer_ GUARDED_BY(mu_);
+  SqliteStatement begin_ GUARDED_BY(mu_);
+  SqliteStatement commit_ GUARDED_BY(mu_);
+  bool in_transaction_ GUARDED_BY(mu_) = false;
+  int num_uncommitted_writes_ GUARDED_BY(mu_) = 0;
+  uint64 transaction_start_micros_ GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace
@@ -347,6 +347,18 @@ TEST_F(SummaryDbWriterTest, UsesIdsTable) {
                      QueryInt("SELECT tag_id FROM Tags"), ")")));
 }
 
+TEST_F(SummaryDbWriterTest, Flush_CommitsTransaction) {
+  TF_ASSERT_OK(CreateSummaryDbWriter(db_, "", "", "", &env_, &writer_));
+  for (int i = 0; i < 10; ++i) {
+    TF_ASSERT_OK(writer_->WriteScalar(i, MakeScalarInt64(i), "t"));
+  }
+  TF_ASSERT_OK(writer_->Flush());
+  ASSERT_EQ(10LL, QueryInt("SELECT COUNT(*) FROM Tensors"));
+  // BEGIN fails inside of an open transaction.
+  TF_ASSERT_OK(db_->Prepare("BEGIN").StepAndReset());
+  TF_ASSERT_OK(db_->Prepare("COMMIT").StepAndReset());
+}
+
 TEST_F(SummaryDbWriterTest, SetsRunFinishedTime) {
   SummaryMetadata metadata;
   TF_ASSERT_OK(CreateSummaryDbWriter(db_, "mad-science", "train", "jart", &env_,
@@ -46,6 +46,16 @@ uint32_t NameHash(const string& name) {
   return Hash32(name.data(), name.size(), 0x1234ABCD);
 }
 
+// allocator of the memory registered for RDMA buffers
+Allocator* RdmaHostAllocator() {
+#if GOOGLE_CUDA
+  // pinned, so that GPU tensors can be copied straight from/to the buffers
+  return ProcessState::singleton()->GetCUDAHostAllocator(0);
+#else
+  return cpu_allocator();
+#endif
+}
+
 // convenience function for printing message
 string MessageTypeToString(RdmaMessageType rmt) {
   switch (rmt) {
@@ -415,6 +425,8 @@ RdmaAdapter::RdmaAdapter(const WorkerEnv* worker_env)
     : context_(open_device(set_device())),
       params_(params_init(context_)),
       pd_(alloc_protection_domain(context_)),
+      memory_pool_(new RdmaMemoryPool(
+          pd_, RdmaHostAllocator())),
       worker_env_(worker_env) {
   event_channel_ = ibv_create_comp_channel(context_);
   CHECK(event_channel_) << "Failed to create completion channel";
@@ -429,6 +441,8 @@ RdmaAdapter::~RdmaAdapter() {
   CHECK(!ibv_destroy_cq(cq_)) << "Failed to destroy CQ";
   CHECK(!ibv_destroy_comp_channel(event_channel_))
       << "Failed to destroy channel";
+  // The memory regions must be deregistered before the PD is deallocated.
+  memory_pool_.reset();
   CHECK(!ibv_dealloc_pd(pd_)) << "Failed to deallocate PD";
   CHECK(!ibv_close_device(context_)) << "Failed to release context";
 }
@@ -892,17 +906,60 @@ void RdmaChannel::Connect(const RdmaAddress& remoteAddr) {
   }
 }
 
+RdmaMemoryPool::RdmaMemoryPool(ibv_pd* pd, Allocator* allocator)
+    : pd_(pd), allocator_(allocator) {}
+
+RdmaMemoryPool::~RdmaMemoryPool() {
+  for (const auto& p : blocks_) {
+    CHECK(!ibv_dereg_mr(p.second.mr)) << "ibv_dereg_mr failed";
+    allocator_->DeallocateRaw(p.first);
+  }
+}
+
+size_t RdmaMemoryPool::SizeClass(size_t size) {
+  size_t block_size = kMinBlockSize;
+  while (block_size < size) block_size <<= 1;
+  return block_size;
+}
+
+void* RdmaMemoryPool::Allocate(size_t size, ibv_mr** mr) {
+  const size_t block_size = SizeClass(size);
+  mutex_lock l(mu_);
+  std::vector<void*>& free_blocks = free_[block_size];
+  if (!free_blocks.empty()) {
+    void* buffer = free_blocks.back();
+    free_blocks.pop_back();
+    *mr = blocks_[buffer].mr;
+    return buffer;
+  }
+  void* buffer =
+      allocator_->AllocateRaw(Allocator::kAllocatorAlignment, block_size);
+  CHECK(buffer) << "Failed to allocate " << block_size << " bytes";
+  *mr = ibv_reg_mr(pd_, buffer, block_size,
+                   IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
+  CHECK(*mr) << "Failed to register memory region";
+  blocks_[buffer] = {block_size, *mr};
+  VLOG(2) << "Registered RDMA block of " << block_size << " bytes";
+  return buffer;
+}
+
+void RdmaMemoryPool::Deallocate(void* buffer) {
+  mutex_lock l(mu_);
+  auto it = blocks_.find(buffer);
+  CHECK(it != blocks_.end()) << "Buffer not allocated by the RDMA pool";
+  free_[it->second.size].push_back(buffer);
+}
+
 RdmaBuffer::RdmaBuffer(RdmaChannel* channel, string name)
     : channel_(channel), name_(name) {}
 
-RdmaBuffer::~RdmaBuffer() {
-  CHECK(!ibv_dereg_mr(self_)) << "ibv_dereg_mr failed";
-  FreeBuffer();
-}
+RdmaBuffer::~RdmaBuffer() { FreeBuffer(); }
 
 void RdmaBuffer::FreeBuffer() {
   if ((buffer_ != nullptr) && buffer_on_host_) {
-    free(buffer_);
+    channel_->adapter_->memory_pool_->Deallocate(buffer_);
+    buffer_ = nullptr;
+    self_ = nullptr;
   }
   // TODO
   // release buffer if it is on device.
@@ -911,7 +968,8 @@ void RdmaBuffer::FreeBuffer() {
 
 // Allocate CPU memory for the Rdma buffer
 // Args:
-//   size: to-be-allocated memory size
+//   size: to-be-allocated memory size; the buffer gets the whole size class
+//     of "size" (see RdmaMemoryPool::SizeClass()).
 //   lock: whether or not mutex_lock the process to protect concurrency.
 // Returns:
 //   None
@@ -921,15 +979,11 @@ void RdmaBuffer::CreateCPUBuffer(size_t size, bool lock) {
     mu_.lock();
   }
   if (local_status_ != none) {
-    // delete existing buffer
-    CHECK(!ibv_dereg_mr(self_)) << "ibv_dereg_mr failed";
+    // return the existing buffer to the pool
     FreeBuffer();
   }
-  size_ = size;
-  buffer_ = malloc(size_);
-  self_ = ibv_reg_mr(channel_->adapter_->pd_, buffer_, size_,
-                     IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_WRITE);
-  CHECK(self_) << "Failed to register memory region";
+  size_ = RdmaMemoryPool::SizeClass(size);
+  buffer_ = channel_->adapter_->memory_pool_->Allocate(size_, &self_);
   buffer_on_host_ = true;
   local_status_ = idle;
   if (lock) {
@@ -1218,6 +1272,9 @@ void RdmaTensorBuffer::PostCopyOperations(
     // no longer used: put back the key since it is not sent;
     // ask the remote to create the same buffer
     rm.type_ = RDMA_MESSAGE_BUFFER_REQUEST;
+    // The remote creates a buffer of the same size class, so that tensors
+    // whose size stays within it are written without renegotiating.
+    rm.buffer_size_ = size_;
     rm.remote_addr_ = reinterpret_cast<uint64_t>(buffer_);
     rm.rkey_ = self_->rkey;
     string message = RdmaMessage::CreateMessage(rm);
@@ -1230,7 +1287,8 @@ void RdmaTensorBuffer::PostCopyOperations(
     // local/remote_status_ won't be set back to idle
     // unitl Write() is successful
     mu_.unlock();
-    if (!((buffer_size == size_ && rm.data_type_ != DT_STRING) ||
+    if (!((RdmaMemoryPool::SizeClass(buffer_size) == size_ &&
+           rm.data_type_ != DT_STRING) ||
           (buffer_size <= size_ && rm.data_type_ == DT_STRING))) {
       VLOG(2) << "Tensor and buffer size do not agree,"
               << " buffer_size = " << size_
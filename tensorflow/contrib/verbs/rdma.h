@@ -28,11 +28,13 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
@@ -90,6 +92,48 @@ enum RdmaMessageType {
   RDMA_MESSAGE_TENSOR_WRITE
 };
 class RdmaBuffer;
+
+// A pool of registered memory regions, shared by all the buffers of an
+// adapter. Blocks are rounded up to a power-of-two size class and are
+// registered once, when first allocated; freed blocks are kept registered
+// and handed out again to the next buffer of the same class, whatever its
+// channel or step. With CUDA the memory comes from the ProcessState CUDA
+// host allocator, so it is pinned.
+class RdmaMemoryPool {
+ public:
+  RdmaMemoryPool(ibv_pd* pd, Allocator* allocator);
+  ~RdmaMemoryPool();
+
+  // Returns a registered block of at least "size" bytes, whose actual size
+  // is SizeClass(size), and sets "*mr" to its memory region.
+  void* Allocate(size_t size, ibv_mr** mr);
+
+  // Returns "buffer", obtained from Allocate(), to the pool. The block
+  // stays registered.
+  void Deallocate(void* buffer);
+
+  // Returns the size of the blocks Allocate(size) hands out.
+  static size_t SizeClass(size_t size);
+
+ private:
+  struct Block {
+    size_t size;
+    ibv_mr* mr;
+  };
+
+  static const size_t kMinBlockSize = 4096;
+
+  ibv_pd* const pd_;           // Not owned.
+  Allocator* const allocator_;  // Not owned.
+  mutex mu_;
+  // All the blocks of the pool, in use or not.
+  std::unordered_map<void*, Block> blocks_ GUARDED_BY(mu_);
+  // Free blocks by size class.
+  std::unordered_map<size_t, std::vector<void*>> free_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaMemoryPool);
+};
+
 // Class that represents the Rdma Adapter.
 // Responsible for creation of the completion queue, and handling
 // of work completions.
@@ -123,6 +167,8 @@ class RdmaAdapter {
   ibv_cq* cq_;
   // Pre-allocated work completions array used for polling
   ibv_wc wc_[MAX_CONCURRENT_WRITES * 2];
+  // Registered memory of the buffers of all channels.
+  std::unique_ptr<RdmaMemoryPool> memory_pool_;
   // worker env for thread
   const WorkerEnv* worker_env_;
   // thread for cq.
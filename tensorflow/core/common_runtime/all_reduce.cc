@@ -0,0 +1,483 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/all_reduce.h"
+
+#include <algorithm>
+#include <map>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace {
+
+typedef NodeBuilder::NodeOut NodeOut;
+
+const string& DeviceOf(const NodeOut& out) {
+  return out.node->assigned_device_name();
+}
+
+// Adds the nodes of one all-reduce to a graph.
+class AllReduceBuilder {
+ public:
+  AllReduceBuilder(const AllReduceOptions& options,
+                   const DeviceSet* device_set, Graph* graph)
+      : options_(options), device_set_(device_set), graph_(graph) {}
+
+  // Returns a builder for a node of type "op", named after the all-reduce.
+  NodeBuilder Builder(const string& op) {
+    return NodeBuilder(graph_->NewName(strings::StrCat(options_.name, "/", op)),
+                       op);
+  }
+
+  // Adds the node of "builder" to the graph on "device".
+  Status Finalize(NodeBuilder* builder, const string& device, Node** node) {
+    TF_RETURN_IF_ERROR(builder->Device(device).Finalize(graph_, node));
+    (*node)->set_assigned_device_name(device);
+    return Status::OK();
+  }
+
+  Status Unary(const string& op, const NodeOut& x, const string& device,
+               NodeOut* y) {
+    NodeBuilder builder = Builder(op).Input(x);
+    Node* node;
+    TF_RETURN_IF_ERROR(Finalize(&builder, device, &node));
+    *y = NodeOut(node);
+    return Status::OK();
+  }
+
+  Status Binary(const string& op, const NodeOut& x, const NodeOut& y,
+                const string& device, NodeOut* z) {
+    NodeBuilder builder = Builder(op).Input(x).Input(y);
+    Node* node;
+    TF_RETURN_IF_ERROR(Finalize(&builder, device, &node));
+    *z = NodeOut(node);
+    return Status::OK();
+  }
+
+  // Adds an int32 constant of shape "shape" (a scalar if empty).
+  Status IntConst(gtl::ArraySlice<int32> values, const TensorShape& shape,
+                  const string& device, NodeOut* out) {
+    Tensor tensor(DT_INT32, shape);
+    std::copy(values.begin(), values.end(), tensor.flat<int32>().data());
+    NodeBuilder builder =
+        Builder("Const").Attr("dtype", DT_INT32).Attr("value", tensor);
+    Node* node;
+    TF_RETURN_IF_ERROR(Finalize(&builder, device, &node));
+    *out = NodeOut(node);
+    return Status::OK();
+  }
+
+  Status Scalar(int32 value, const string& device, NodeOut* out) {
+    return IntConst({value}, TensorShape({}), device, out);
+  }
+
+  Status Vector(gtl::ArraySlice<int32> values, const string& device,
+                NodeOut* out) {
+    return IntConst(values, TensorShape({static_cast<int64>(values.size())}),
+                    device, out);
+  }
+
+  // Returns the CPU of the task of "device", which takes the int32 shape
+  // computations of the tensors on "device".
+  string HostOf(const string& device) {
+    string task, local;
+    if (device_set_ == nullptr ||
+        !DeviceNameUtils::SplitDeviceName(device, &task, &local)) {
+      return device;
+    }
+    const string host = strings::StrCat(task, "/device:CPU:0");
+    return device_set_->FindDeviceByName(host) != nullptr ? host : device;
+  }
+
+  Status Ring(const std::vector<NodeOut>& inputs,
+              std::vector<NodeOut>* outputs);
+
+  Status Hierarchical(const std::vector<NodeOut>& inputs,
+                      std::vector<NodeOut>* outputs);
+
+  // Applies options_.final_op to every output of a reduction of "n" inputs.
+  Status Finish(int n, std::vector<NodeOut>* outputs);
+
+ private:
+  const AllReduceOptions& options_;
+  const DeviceSet* const device_set_;  // Not owned.
+  Graph* const graph_;                 // Not owned.
+};
+
+Status AllReduceBuilder::Ring(const std::vector<NodeOut>& inputs,
+                              std::vector<NodeOut>* outputs) {
+  const int n = inputs.size();
+  if (n == 1) {
+    *outputs = inputs;
+    return Status::OK();
+  }
+
+  // Flattens each tensor, pads it to a multiple of "n" elements and splits
+  // it in "n" chunks.
+  std::vector<NodeOut> sizes(n), shapes(n);
+  std::vector<std::vector<NodeOut>> chunks(n, std::vector<NodeOut>(n));
+  for (int i = 0; i < n; ++i) {
+    const string& device = DeviceOf(inputs[i]);
+    const string host = HostOf(device);
+    NodeOut minus_one, flat;
+    TF_RETURN_IF_ERROR(Vector({-1}, host, &minus_one));
+    TF_RETURN_IF_ERROR(Binary("Reshape", inputs[i], minus_one, device, &flat));
+    TF_RETURN_IF_ERROR(Unary("Size", inputs[i], device, &sizes[i]));
+    TF_RETURN_IF_ERROR(Unary("Shape", inputs[i], device, &shapes[i]));
+
+    // The padding is (-size) mod n elements at the end.
+    NodeOut neg_size, num, pad, zero, paddings_shape, paddings;
+    TF_RETURN_IF_ERROR(Unary("Neg", sizes[i], host, &neg_size));
+    TF_RETURN_IF_ERROR(Scalar(n, host, &num));
+    TF_RETURN_IF_ERROR(Binary("FloorMod", neg_size, num, host, &pad));
+    TF_RETURN_IF_ERROR(Scalar(0, host, &zero));
+    Node* pack;
+    NodeBuilder pack_builder =
+        Builder("Pack").Input(std::vector<NodeOut>{zero, pad});
+    TF_RETURN_IF_ERROR(Finalize(&pack_builder, host, &pack));
+    TF_RETURN_IF_ERROR(Vector({1, 2}, host, &paddings_shape));
+    TF_RETURN_IF_ERROR(
+        Binary("Reshape", NodeOut(pack), paddings_shape, host, &paddings));
+    NodeOut padded, axis;
+    TF_RETURN_IF_ERROR(Binary("Pad", flat, paddings, device, &padded));
+    TF_RETURN_IF_ERROR(Scalar(0, host, &axis));
+    Node* split;
+    NodeBuilder split_builder =
+        Builder("Split").Input(axis).Input(padded).Attr("num_split", n);
+    TF_RETURN_IF_ERROR(Finalize(&split_builder, device, &split));
+    for (int c = 0; c < n; ++c) {
+      chunks[i][c] = NodeOut(split, c);
+    }
+  }
+
+  // Reduce-scatter: in step "s", device i passes its partial reduction of
+  // chunk (i - s) mod n to the next device, which merges its own chunk into
+  // it. Afterwards device i holds the reduction of chunk (i + 1) mod n.
+  for (int s = 0; s < n - 1; ++s) {
+    for (int i = 0; i < n; ++i) {
+      const int next = (i + 1) % n;
+      const int c = ((i - s) % n + n) % n;
+      TF_RETURN_IF_ERROR(Binary(options_.merge_op, chunks[i][c],
+                                chunks[next][c], DeviceOf(inputs[next]),
+                                &chunks[next][c]));
+    }
+  }
+
+  // All-gather: in step "s", device i passes the reduced chunk
+  // (i + 1 - s) mod n to the next device.
+  for (int s = 0; s < n - 1; ++s) {
+    for (int i = 0; i < n; ++i) {
+      const int next = (i + 1) % n;
+      const int c = ((i + 1 - s) % n + n) % n;
+      TF_RETURN_IF_ERROR(Unary("Identity", chunks[i][c],
+                                DeviceOf(inputs[next]), &chunks[next][c]));
+    }
+  }
+
+  // Concatenates the chunks, strips the padding and restores the shape.
+  outputs->resize(n);
+  for (int i = 0; i < n; ++i) {
+    const string& device = DeviceOf(inputs[i]);
+    const string host = HostOf(device);
+    NodeOut axis, begin, one, size;
+    TF_RETURN_IF_ERROR(Scalar(0, host, &axis));
+    Node* concat;
+    NodeBuilder concat_builder = Builder("ConcatV2").Input(chunks[i]).Input(axis);
+    TF_RETURN_IF_ERROR(Finalize(&concat_builder, device, &concat));
+    TF_RETURN_IF_ERROR(Vector({0}, host, &begin));
+    TF_RETURN_IF_ERROR(Vector({1}, host, &one));
+    TF_RETURN_IF_ERROR(Binary("Reshape", sizes[i], one, host, &size));
+    Node* slice;
+    NodeBuilder slice_builder =
+        Builder("Slice").Input(NodeOut(concat)).Input(begin).Input(size);
+    TF_RETURN_IF_ERROR(Finalize(&slice_builder, device, &slice));
+    TF_RETURN_IF_ERROR(
+        Binary("Reshape", NodeOut(slice), shapes[i], device, &(*outputs)[i]));
+  }
+  return Status::OK();
+}
+
+Status AllReduceBuilder::Hierarchical(const std::vector<NodeOut>& inputs,
+                                      std::vector<NodeOut>* outputs) {
+  // Groups the inputs by task; the first device of each task leads it.
+  std::map<string, std::vector<int>> by_task;
+  for (int i = 0; i < inputs.size(); ++i) {
+    string task, local;
+    if (!DeviceNameUtils::SplitDeviceName(DeviceOf(inputs[i]), &task,
+                                          &local)) {
+      task = DeviceOf(inputs[i]);
+    }
+    by_task[task].push_back(i);
+  }
+
+  std::vector<NodeOut> partial;
+  partial.reserve(by_task.size());
+  for (const auto& task : by_task) {
+    const std::vector<int>& members = task.second;
+    const string& leader = DeviceOf(inputs[members[0]]);
+    NodeOut acc = inputs[members[0]];
+    for (int k = 1; k < members.size(); ++k) {
+      TF_RETURN_IF_ERROR(
+          Binary(options_.merge_op, acc, inputs[members[k]], leader, &acc));
+    }
+    partial.push_back(acc);
+  }
+
+  std::vector<NodeOut> reduced;
+  TF_RETURN_IF_ERROR(Ring(partial, &reduced));
+
+  outputs->resize(inputs.size());
+  int t = 0;
+  for (const auto& task : by_task) {
+    const std::vector<int>& members = task.second;
+    (*outputs)[members[0]] = reduced[t];
+    for (int k = 1; k < members.size(); ++k) {
+      TF_RETURN_IF_ERROR(Unary("Identity", reduced[t],
+                               DeviceOf(inputs[members[k]]),
+                               &(*outputs)[members[k]]));
+    }
+    ++t;
+  }
+  return Status::OK();
+}
+
+Status AllReduceBuilder::Finish(int n, std::vector<NodeOut>* outputs) {
+  if (options_.final_op == "Id") {
+    return Status::OK();
+  }
+  if (options_.final_op != "Div") {
+    return errors::InvalidArgument("Unsupported all-reduce final_op: ",
+                                   options_.final_op);
+  }
+  for (NodeOut& out : *outputs) {
+    const string& device = DeviceOf(out);
+    const string host = HostOf(device);
+    NodeOut num;
+    TF_RETURN_IF_ERROR(Scalar(n, host, &num));
+    Node* cast;
+    NodeBuilder cast_builder =
+        Builder("Cast").Input(num).Attr("DstT", out.node->output_type(out.index));
+    TF_RETURN_IF_ERROR(Finalize(&cast_builder, host, &cast));
+    TF_RETURN_IF_ERROR(Binary("Div", out, NodeOut(cast), device, &out));
+  }
+  return Status::OK();
+}
+
+// Returns the positions of "inputs" ordered by the name of their device.
+std::vector<int> RingOrder(const std::vector<NodeOut>& inputs) {
+  std::vector<int> order(inputs.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&inputs](int a, int b) {
+    return DeviceOf(inputs[a]) < DeviceOf(inputs[b]);
+  });
+  return order;
+}
+
+Status ValidateInputs(const std::vector<NodeOut>& inputs) {
+  if (inputs.empty()) {
+    return errors::InvalidArgument("All-reduce of no inputs");
+  }
+  for (const NodeOut& in : inputs) {
+    if (in.node == nullptr || in.error) {
+      return errors::InvalidArgument("Invalid all-reduce input");
+    }
+    if (!in.node->has_assigned_device_name()) {
+      return errors::InvalidArgument("All-reduce input ", in.node->name(),
+                                     " has no assigned device");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status BuildRingAllReduce(const AllReduceOptions& options,
+                          const DeviceSet* device_set,
+                          const std::vector<NodeOut>& inputs, Graph* graph,
+                          std::vector<NodeOut>* outputs) {
+  TF_RETURN_IF_ERROR(ValidateInputs(inputs));
+  const std::vector<int> order = RingOrder(inputs);
+  std::vector<NodeOut> ring;
+  ring.reserve(inputs.size());
+  for (int i : order) ring.push_back(inputs[i]);
+
+  AllReduceBuilder builder(options, device_set, graph);
+  std::vector<NodeOut> reduced;
+  TF_RETURN_IF_ERROR(builder.Ring(ring, &reduced));
+  outputs->resize(inputs.size());
+  for (int k = 0; k < order.size(); ++k) {
+    (*outputs)[order[k]] = reduced[k];
+  }
+  return builder.Finish(inputs.size(), outputs);
+}
+
+Status BuildHierarchicalAllReduce(const AllReduceOptions& options,
+                                  const DeviceSet* device_set,
+                                  const std::vector<NodeOut>& inputs,
+                                  Graph* graph,
+                                  std::vector<NodeOut>* outputs) {
+  TF_RETURN_IF_ERROR(ValidateInputs(inputs));
+  const std::vector<int> order = RingOrder(inputs);
+  std::vector<NodeOut> sorted;
+  sorted.reserve(inputs.size());
+  for (int i : order) sorted.push_back(inputs[i]);
+
+  AllReduceBuilder builder(options, device_set, graph);
+  std::vector<NodeOut> reduced;
+  TF_RETURN_IF_ERROR(builder.Hierarchical(sorted, &reduced));
+  outputs->resize(inputs.size());
+  for (int k = 0; k < order.size(); ++k) {
+    (*outputs)[order[k]] = reduced[k];
+  }
+  return builder.Finish(inputs.size(), outputs);
+}
+
+namespace {
+
+// Replaces every group of "CollectiveAllReduce" placeholders, identified by
+// their "group_key" attr, with the all-reduce their "algorithm" attr asks
+// for. Runs after placement, since the algorithms depend on the devices of
+// the group; each placeholder is replaced by an Identity with its name on
+// its device, so fetches and consumers are unaffected.
+class CollectiveAllReducePass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr) {
+      return Status::OK();
+    }
+    Graph* g = options.graph->get();
+    if (g == nullptr) {
+      return errors::Internal(
+          "CollectiveAllReduce rewriting should happen before partitioning "
+          "and a graph should be available.");
+    }
+
+    std::map<string, std::vector<Node*>> groups;
+    for (Node* n : g->op_nodes()) {
+      if (n->type_string() == "CollectiveAllReduce") {
+        string group_key;
+        TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "group_key", &group_key));
+        groups[group_key].push_back(n);
+      }
+    }
+    for (const auto& group : groups) {
+      TF_RETURN_IF_ERROR(RewriteGroup(group.first, group.second,
+                                      options.device_set, g));
+    }
+    return Status::OK();
+  }
+
+ private:
+  Status RewriteGroup(const string& group_key, const std::vector<Node*>& nodes,
+                      const DeviceSet* device_set, Graph* g) {
+    const Node* first = nodes[0];
+    int group_size;
+    AllReduceOptions options;
+    string algorithm;
+    TF_RETURN_IF_ERROR(GetNodeAttr(first->attrs(), "group_size", &group_size));
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(first->attrs(), "merge_op", &options.merge_op));
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(first->attrs(), "final_op", &options.final_op));
+    TF_RETURN_IF_ERROR(GetNodeAttr(first->attrs(), "algorithm", &algorithm));
+    if (group_size != nodes.size()) {
+      return errors::InvalidArgument(
+          "CollectiveAllReduce group ", group_key, " has group_size ",
+          group_size, " but ", nodes.size(), " nodes");
+    }
+    if (group_size == 1) {
+      // The kernel handles groups of one.
+      return Status::OK();
+    }
+    options.name = strings::StrCat(group_key, "/CollectiveAllReduce");
+
+    std::vector<NodeOut> inputs;
+    inputs.reserve(nodes.size());
+    for (const Node* n : nodes) {
+      for (const string& attr : {"merge_op", "final_op", "algorithm"}) {
+        string a, b;
+        TF_RETURN_IF_ERROR(GetNodeAttr(first->attrs(), attr, &a));
+        TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), attr, &b));
+        if (a != b) {
+          return errors::InvalidArgument(
+              "CollectiveAllReduce nodes ", first->name(), " and ", n->name(),
+              " of group ", group_key, " have different ", attr, " attrs");
+        }
+      }
+      if (!n->has_assigned_device_name()) {
+        return errors::Internal("CollectiveAllReduce ", n->name(),
+                                " has not been placed");
+      }
+      const Edge* input;
+      TF_RETURN_IF_ERROR(n->input_edge(0, &input));
+      // The control inputs of a placeholder gate the tensor it contributes.
+      Node* gate;
+      TF_RETURN_IF_ERROR(
+          NodeBuilder(g->NewName(strings::StrCat(options.name, "/Identity")),
+                      "Identity")
+              .Input(input->src(), input->src_output())
+              .Device(n->assigned_device_name())
+              .Finalize(g, &gate));
+      gate->set_assigned_device_name(n->assigned_device_name());
+      for (const Edge* e : n->in_edges()) {
+        if (e->IsControlEdge()) {
+          g->AddControlEdge(e->src(), gate);
+        }
+      }
+      inputs.emplace_back(gate);
+    }
+
+    std::vector<NodeOut> outputs;
+    if (algorithm == "ring") {
+      TF_RETURN_IF_ERROR(
+          BuildRingAllReduce(options, device_set, inputs, g, &outputs));
+    } else {
+      TF_RETURN_IF_ERROR(
+          BuildHierarchicalAllReduce(options, device_set, inputs, g, &outputs));
+    }
+
+    for (int i = 0; i < nodes.size(); ++i) {
+      Node* n = nodes[i];
+      Node* replacement;
+      TF_RETURN_IF_ERROR(NodeBuilder(n->name(), "Identity")
+                             .Input(outputs[i])
+                             .Device(n->assigned_device_name())
+                             .Finalize(g, &replacement));
+      replacement->set_assigned_device_name(n->assigned_device_name());
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge()) {
+          g->AddControlEdge(replacement, e->dst());
+        } else {
+          g->AddEdge(replacement, 0, e->dst(), e->dst_input());
+        }
+      }
+      g->RemoveNode(n);
+    }
+    return Status::OK();
+  }
+};
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PLACEMENT, 0,
+                      CollectiveAllReducePass);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,73 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_ALL_REDUCE_H_
+#define TENSORFLOW_COMMON_RUNTIME_ALL_REDUCE_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Builders of all-reduce subgraphs over placed graphs, after the algorithms
+// of tensorflow/contrib/all_reduce. The subgraphs only use ordinary ops with
+// an assigned device, so the transfers between devices become Send/Recv
+// pairs when the graph is partitioned and use whatever rendezvous the
+// workers are configured with (gRPC, verbs, GDR, ...).
+//
+// Every input must be the output of a node that has an assigned device.
+// On success "*outputs" has one output per input, on the device of that
+// input, holding the reduction of all inputs. All inputs must have the same
+// dtype and shape.
+struct AllReduceOptions {
+  // Prefix of the names of the nodes added to the graph.
+  string name = "AllReduce";
+  // Binary op that reduces two tensors, e.g. "Add" or "Maximum".
+  string merge_op = "Add";
+  // "Id", or "Div" to divide the reduction by the number of inputs.
+  string final_op = "Id";
+};
+
+// The devices of "inputs", ordered by name, form a ring. Each tensor is
+// split in as many chunks as there are inputs; the chunks are reduced
+// around the ring and the reduced chunks are then passed around the ring
+// again, so that every device sends and receives about twice the size of
+// one tensor whatever the number of devices.
+//
+// "device_set" is used to find the host CPU of each device, on which the
+// small int32 shape computations are placed. It may be nullptr, in which
+// case they are placed with the data.
+Status BuildRingAllReduce(const AllReduceOptions& options,
+                          const DeviceSet* device_set,
+                          const std::vector<NodeBuilder::NodeOut>& inputs,
+                          Graph* graph,
+                          std::vector<NodeBuilder::NodeOut>* outputs);
+
+// The inputs of the devices of each task are first reduced on one device of
+// the task, the results are all-reduced with BuildRingAllReduce() and then
+// copied to the other devices of their task. Only one tensor per task
+// crosses the network in each direction of the ring.
+Status BuildHierarchicalAllReduce(
+    const AllReduceOptions& options, const DeviceSet* device_set,
+    const std::vector<NodeBuilder::NodeOut>& inputs, Graph* graph,
+    std::vector<NodeBuilder::NodeOut>* outputs);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_ALL_REDUCE_H_
@@ -0,0 +1,124 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/all_reduce.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+const int kNumDevices = 3;
+
+string CpuName(int i) {
+  return strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i);
+}
+
+// Builds a graph with one CollectiveAllReduce per device, reducing a tensor
+// of shape {5} whose elements on device i are i + 1, and runs it.
+Status RunAllReduce(const string& algorithm, const string& final_op,
+                    int group_size, std::vector<Tensor>* outputs) {
+  Graph graph(OpRegistry::Global());
+  std::vector<string> fetches;
+  for (int i = 0; i < kNumDevices; ++i) {
+    Tensor value(DT_FLOAT, TensorShape({5}));
+    test::FillFn<float>(&value, [i](int j) { return (i + 1) * (j + 1); });
+    Node* input = test::graph::Constant(&graph, value);
+    input->set_assigned_device_name(CpuName(i));
+    Node* reduce;
+    TF_RETURN_IF_ERROR(
+        NodeBuilder(strings::StrCat("reduce", i), "CollectiveAllReduce")
+            .Input(input)
+            .Attr("group_key", "g")
+            .Attr("group_size", group_size)
+            .Attr("final_op", final_op)
+            .Attr("algorithm", algorithm)
+            .Device(CpuName(i))
+            .Finalize(&graph, &reduce));
+    fetches.push_back(strings::StrCat(reduce->name(), ":0"));
+  }
+  GraphDef def;
+  test::graph::ToGraphDef(&graph, &def);
+
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = kNumDevices;
+  std::unique_ptr<Session> session(NewSession(options));
+  TF_RETURN_IF_ERROR(session->Create(def));
+  return session->Run({}, fetches, {}, outputs);
+}
+
+TEST(CollectiveAllReduceTest, Ring) {
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(RunAllReduce("ring", "Id", kNumDevices, &outputs));
+  ASSERT_EQ(kNumDevices, outputs.size());
+  // 1 + 2 + 3 times (j + 1).
+  Tensor expected(DT_FLOAT, TensorShape({5}));
+  test::FillValues<float>(&expected, {6, 12, 18, 24, 30});
+  for (const Tensor& t : outputs) {
+    test::ExpectTensorEqual<float>(expected, t);
+  }
+}
+
+TEST(CollectiveAllReduceTest, HierarchicalMean) {
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(RunAllReduce("hierarchical", "Div", kNumDevices, &outputs));
+  ASSERT_EQ(kNumDevices, outputs.size());
+  Tensor expected(DT_FLOAT, TensorShape({5}));
+  test::FillValues<float>(&expected, {2, 4, 6, 8, 10});
+  for (const Tensor& t : outputs) {
+    test::ExpectTensorEqual<float>(expected, t);
+  }
+}
+
+TEST(CollectiveAllReduceTest, WrongGroupSize) {
+  std::vector<Tensor> outputs;
+  Status s = RunAllReduce("ring", "Id", kNumDevices + 1, &outputs);
+  EXPECT_EQ(error::INVALID_ARGUMENT, s.code()) << s;
+}
+
+TEST(CollectiveAllReduceTest, BuildRingAllReduceKeepsInputOrder) {
+  Graph graph(OpRegistry::Global());
+  std::vector<NodeBuilder::NodeOut> inputs;
+  // Devices in reverse order of their names.
+  for (int i = kNumDevices - 1; i >= 0; --i) {
+    Node* input = test::graph::Constant(&graph, test::AsScalar<float>(i));
+    input->set_assigned_device_name(CpuName(i));
+    inputs.emplace_back(input);
+  }
+  std::vector<NodeBuilder::NodeOut> outputs;
+  TF_ASSERT_OK(BuildRingAllReduce(AllReduceOptions(), nullptr, inputs, &graph,
+                                  &outputs));
+  ASSERT_EQ(inputs.size(), outputs.size());
+  for (int i = 0; i < inputs.size(); ++i) {
+    EXPECT_EQ(inputs[i].node->assigned_device_name(),
+              outputs[i].node->assigned_device_name());
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,24 +15,73 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/allocator_retry.h"
+#include "tensorflow/core/framework/memory_annotation.h"
 #include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Gives each BFCAllocator a distinct key for the thread-local map of thread
+// caches, so that a new allocator at the address of a deleted one does not
+// find the old allocator's caches.
+std::atomic<int64> next_bfc_allocator_id(0);
+
+auto* allocator_bytes_in_use = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/allocator/bytes_in_use",
+    "The number of bytes allocated from each BFC allocator.", "allocator");
+
+auto* allocator_peak_bytes_in_use = monitoring::Gauge<int64, 1>::New(
+    "/tensorflow/core/allocator/peak_bytes_in_use",
+    "The largest number of bytes allocated from each BFC allocator at once.",
+    "allocator");
+
+// Returns the fraction of "free_bytes" that is not in the largest free
+// chunk.
+double FragmentationRatio(int64 free_bytes, int64 largest_free_bytes) {
+  if (free_bytes <= 0) return 0;
+  return 1.0 - static_cast<double>(largest_free_bytes) / free_bytes;
+}
+
+}  // namespace
+
+// The small free chunks cached for one thread, and the frees that thread
+// has buffered. Cached chunks are still in use as far as the bins are
+// concerned. The thread that owns the cache is the only one that uses it,
+// except when the caches are drained or measured under lock_, so mu is
+// almost never contended.
+struct BFCAllocator::ThreadCache {
+  static const int kNumSizes = kMaxThreadCacheChunkSize / kMinAllocationSize;
+
+  mutex mu;
+  // free_chunks[i] holds the cached chunks of (i + 1) * kMinAllocationSize
+  // bytes.
+  std::vector<void*> free_chunks[kNumSizes] GUARDED_BY(mu);
+  size_t cached_bytes GUARDED_BY(mu) = 0;
+  std::vector<void*> pending_frees GUARDED_BY(mu);
+};
+
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name)
     : suballocator_(sub_allocator),
       name_(name),
       free_chunks_list_(kInvalidChunkHandle),
-      next_allocation_id_(1) {
+      next_allocation_id_(1),
+      bytes_in_use_cell_(allocator_bytes_in_use->GetCell(name)),
+      peak_bytes_in_use_cell_(allocator_peak_bytes_in_use->GetCell(name)),
+      id_(next_bfc_allocator_id.fetch_add(1)) {
   if (allow_growth) {
     // 1MiB smallest initial allocation, unless total memory available
     // is less.
@@ -160,6 +209,10 @@ bool BFCAllocator::Extend(size_t rounded_bytes) {
   // Insert the chunk into the right bin.
   InsertFreeChunkIntoBin(h);
 
+  ++stats_.num_region_extensions;
+  stats_.bytes_reserved = total_region_allocated_bytes_;
+  MaybeRecordEvent(AllocatorTimelineEvent::EXTEND, bytes);
+
   // Invoke visitors on newly allocated region.
   for (const auto& visitor : region_visitors_) {
     visitor(mem_addr, bytes);
@@ -186,6 +239,73 @@ void BFCAllocator::DeallocateChunk(ChunkHandle h) {
   free_chunks_list_ = h;
 }
 
+void BFCAllocator::EnableThreadCache(size_t max_bytes_per_thread) {
+  thread_cache_bytes_ = max_bytes_per_thread;
+}
+
+BFCAllocator::ThreadCache* BFCAllocator::GetThreadCache() {
+  static thread_local gtl::FlatMap<int64, ThreadCache*> caches;
+  ThreadCache*& cache = caches[id_];
+  if (cache == nullptr) {
+    cache = new ThreadCache;
+    mutex_lock l(lock_);
+    thread_caches_.emplace_back(cache);
+  }
+  return cache;
+}
+
+void BFCAllocator::FlushPendingFree(void* ptr, ThreadCache* cache) {
+  BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
+  CHECK(h != kInvalidChunkHandle);
+  Chunk* c = ChunkFromHandle(h);
+  if (c->size <= kMaxThreadCacheChunkSize) {
+    mutex_lock l(cache->mu);
+    if (cache->cached_bytes + c->size <= thread_cache_bytes_) {
+      // The chunk stays in use. Give it the id and requested size that its
+      // next allocation from the cache will report.
+      c->allocation_id = next_allocation_id_++;
+      c->requested_size = c->size;
+      c->annotation = MemoryAnnotation::kNone;
+      cache->free_chunks[c->size / kMinAllocationSize - 1].push_back(ptr);
+      cache->cached_bytes += c->size;
+      return;
+    }
+  }
+  FreeAndMaybeCoalesce(h);
+}
+
+void BFCAllocator::DrainThreadCaches() {
+  std::vector<void*> ptrs;
+  for (const auto& cache : thread_caches_) {
+    mutex_lock l(cache->mu);
+    for (auto& chunks : cache->free_chunks) {
+      ptrs.insert(ptrs.end(), chunks.begin(), chunks.end());
+      chunks.clear();
+    }
+    cache->cached_bytes = 0;
+    ptrs.insert(ptrs.end(), cache->pending_frees.begin(),
+                cache->pending_frees.end());
+    cache->pending_frees.clear();
+  }
+  for (void* ptr : ptrs) {
+    BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
+    CHECK(h != kInvalidChunkHandle);
+    FreeAndMaybeCoalesce(h);
+  }
+}
+
+size_t BFCAllocator::ThreadCacheBytes() {
+  size_t bytes = 0;
+  for (const auto& cache : thread_caches_) {
+    mutex_lock l(cache->mu);
+    bytes += cache->cached_bytes;
+    for (void* ptr : cache->pending_frees) {
+      bytes += ChunkFromHandle(region_manager_.get_handle(ptr))->size;
+    }
+  }
+  return bytes;
+}
+
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes) {
   // Fast path: Try once to allocate without getting the retry_helper_ involved
   void* r = AllocateRawInternal(unused_alignment, num_bytes, false);
@@ -249,6 +369,22 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  // Small chunks freed earlier on this thread can be reused without
+  // taking lock_.
+  if (thread_cache_bytes_ > 0 && rounded_bytes <= kMaxThreadCacheChunkSize) {
+    ThreadCache* cache = GetThreadCache();
+    mutex_lock l(cache->mu);
+    std::vector<void*>& chunks =
+        cache->free_chunks[rounded_bytes / kMinAllocationSize - 1];
+    if (!chunks.empty()) {
+      void* ptr = chunks.back();
+      chunks.pop_back();
+      cache->cached_bytes -= rounded_bytes;
+      num_thread_cache_allocs_.fetch_add(1, std::memory_order_relaxed);
+      return ptr;
+    }
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
@@ -266,6 +402,15 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Return the memory held by thread caches to the bins before giving up.
+  if (!thread_caches_.empty()) {
+    DrainThreadCaches();
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   // We searched all bins for an existing free chunk to use and
   // couldn't find one.  This means we must have run out of memory,
   // Dump the memory log for analysis.
@@ -313,14 +458,22 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         // Assign a unique id and increment the id counter, marking the
         // chunk as being in use.
         chunk->allocation_id = next_allocation_id_++;
+        chunk->annotation = MemoryAnnotation::Current();
 
         // Update stats.
         ++stats_.num_allocs;
         stats_.bytes_in_use += chunk->size;
-        stats_.max_bytes_in_use =
-            std::max(stats_.max_bytes_in_use, stats_.bytes_in_use);
+        bytes_in_use_cell_->Set(stats_.bytes_in_use);
+        if (stats_.bytes_in_use > stats_.max_bytes_in_use) {
+          stats_.max_bytes_in_use = stats_.bytes_in_use;
+          stats_.fragmentation_at_peak = FragmentationRatio(
+              total_region_allocated_bytes_ - stats_.bytes_in_use,
+              LargestFreeChunkSize());
+          peak_bytes_in_use_cell_->Set(stats_.max_bytes_in_use);
+        }
         stats_.max_alloc_size =
             std::max<std::size_t>(stats_.max_alloc_size, chunk->size);
+        MaybeRecordEvent(AllocatorTimelineEvent::ALLOCATE, chunk->size);
 
         VLOG(4) << "Returning: " << chunk->ptr;
         if (VLOG_IS_ON(4)) {
@@ -367,6 +520,10 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 
   // Add the newly free chunk to the free bin.
   InsertFreeChunkIntoBin(h_new_chunk);
+
+  ++stats_.num_chunk_splits;
+  MaybeRecordEvent(AllocatorTimelineEvent::SPLIT,
+                   ChunkFromHandle(h_new_chunk)->size);
 }
 
 void BFCAllocator::DeallocateRaw(void* ptr) {
@@ -379,6 +536,25 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     LOG(ERROR) << "tried to deallocate nullptr";
     return;
   }
+
+  if (thread_cache_bytes_ > 0) {
+    // Buffer the free, and only take lock_ once for every kMaxPendingFrees
+    // of them.
+    ThreadCache* cache = GetThreadCache();
+    std::vector<void*> ptrs;
+    {
+      mutex_lock l(cache->mu);
+      cache->pending_frees.push_back(ptr);
+      if (cache->pending_frees.size() < kMaxPendingFrees) return;
+      ptrs.swap(cache->pending_frees);
+    }
+    mutex_lock l(lock_);
+    for (void* p : ptrs) {
+      FlushPendingFree(p, cache);
+    }
+    return;
+  }
+
   mutex_lock l(lock_);
 
   // Find the chunk from the ptr.
@@ -422,6 +598,9 @@ void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
   c1->size += c2->size;
 
   DeleteChunk(h2);
+
+  ++stats_.num_chunk_merges;
+  MaybeRecordEvent(AllocatorTimelineEvent::MERGE, c1->size);
 }
 
 void BFCAllocator::DeleteChunk(ChunkHandle h) {
@@ -464,10 +643,14 @@ void BFCAllocator::FreeAndMaybeCoalesce(BFCAllocator::ChunkHandle h) {
   CHECK(c->in_use() && (c->bin_num == kInvalidBinNum));
 
   // Mark the chunk as no longer in use
+  const int64 freed_allocation_id = c->allocation_id;
+  const uint32 freed_annotation = c->annotation;
   c->allocation_id = -1;
 
   // Updates the stats.
+  const size_t freed_bytes = c->size;
   stats_.bytes_in_use -= c->size;
+  bytes_in_use_cell_->Set(stats_.bytes_in_use);
 
   // This chunk is no longer in-use, consider coalescing the chunk
   // with adjacent chunks.
@@ -506,6 +689,8 @@ void BFCAllocator::FreeAndMaybeCoalesce(BFCAllocator::ChunkHandle h) {
   }
 
   InsertFreeChunkIntoBin(chunk_to_reassign);
+  MaybeRecordEvent(AllocatorTimelineEvent::DEALLOCATE, freed_bytes,
+                   freed_allocation_id, freed_annotation);
 }
 
 void BFCAllocator::AddAllocVisitor(Visitor visitor) {
@@ -686,9 +871,128 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
   LOG(INFO) << "Stats: \n" << stats_.DebugString();
 }
 
+size_t BFCAllocator::LargestFreeChunkSize() {
+  // Chunks in a bin are sorted by size, and all chunks of a bin are larger
+  // than those of the bins below it.
+  for (BinNum b = kNumBins - 1; b >= 0; --b) {
+    const Bin::FreeChunkSet& free_chunks = BinFromIndex(b)->free_chunks;
+    if (!free_chunks.empty()) {
+      return ChunkFromHandle(*free_chunks.rbegin())->size;
+    }
+  }
+  return 0;
+}
+
+void BFCAllocator::RecordEvent(AllocatorTimelineEvent::Type type,
+                               size_t bytes, int64 allocation_id,
+                               uint32 annotation) {
+  TimelineEvent& event =
+      timeline_events_[next_timeline_event_++ % kMaxTimelineEvents];
+  event.type = type;
+  event.micros = Env::Default()->NowMicros();
+  event.bytes = bytes;
+  event.bytes_in_use = stats_.bytes_in_use;
+  event.bytes_reserved = total_region_allocated_bytes_;
+  event.largest_free_bytes = LargestFreeChunkSize();
+  event.next_allocation_id = next_allocation_id_;
+  event.allocation_id = allocation_id;
+  event.annotation = annotation;
+}
+
+int64 BFCAllocator::StartTimeline() {
+  mutex_lock l(lock_);
+  if (num_timeline_recorders_++ == 0) {
+    timeline_events_.resize(kMaxTimelineEvents);
+  }
+  return next_timeline_event_;
+}
+
+void BFCAllocator::StopTimeline(int64 cursor, AllocatorTimeline* timeline) {
+  mutex_lock l(lock_);
+  CHECK_GT(num_timeline_recorders_, 0);
+  const int64 first =
+      std::max(cursor, next_timeline_event_ - kMaxTimelineEvents);
+  timeline->set_allocator_name(name_);
+  timeline->set_num_dropped_events(first - cursor);
+  const TimelineEvent* peak = nullptr;
+  int64 peak_index = -1;
+  for (int64 i = first; i < next_timeline_event_; ++i) {
+    const TimelineEvent& event = timeline_events_[i % kMaxTimelineEvents];
+    AllocatorTimelineEvent* e = timeline->add_events();
+    e->set_type(event.type);
+    e->set_micros(event.micros);
+    e->set_bytes(event.bytes);
+    e->set_bytes_in_use(event.bytes_in_use);
+    e->set_bytes_reserved(event.bytes_reserved);
+    e->set_largest_free_bytes(event.largest_free_bytes);
+    if (peak == nullptr || event.bytes_in_use > peak->bytes_in_use) {
+      peak = &event;
+      peak_index = i;
+    }
+  }
+  if (peak != nullptr) {
+    timeline->set_peak_bytes_in_use(peak->bytes_in_use);
+    timeline->set_fragmentation_at_peak(
+        FragmentationRatio(peak->bytes_reserved - peak->bytes_in_use,
+                           peak->largest_free_bytes));
+    AddLiveAtPeak(*peak, peak_index, next_timeline_event_, timeline);
+  } else {
+    timeline->set_peak_bytes_in_use(stats_.bytes_in_use);
+  }
+  if (--num_timeline_recorders_ == 0) {
+    std::vector<TimelineEvent>().swap(timeline_events_);
+  }
+}
+
+void BFCAllocator::AddLiveAtPeak(const TimelineEvent& peak, int64 peak_index,
+                                 int64 end, AllocatorTimeline* timeline) {
+  // Allocation ids increase, so a chunk was live at the peak iff its id had
+  // been handed out by then and it was either freed after the peak or is
+  // still in use.
+  gtl::FlatMap<uint32, std::pair<int64, int64>> held;  // bytes, allocations
+  auto add = [&peak, &held](int64 allocation_id, uint32 annotation,
+                            int64 bytes) {
+    if (allocation_id < 0 || allocation_id >= peak.next_allocation_id) return;
+    std::pair<int64, int64>& h = held[annotation];
+    h.first += bytes;
+    ++h.second;
+  };
+  for (int64 i = peak_index + 1; i < end; ++i) {
+    const TimelineEvent& event = timeline_events_[i % kMaxTimelineEvents];
+    if (event.type == AllocatorTimelineEvent::DEALLOCATE) {
+      add(event.allocation_id, event.annotation, event.bytes);
+    }
+  }
+  for (const Chunk& c : chunks_) {
+    if (c.in_use()) add(c.allocation_id, c.annotation, c.size);
+  }
+
+  std::vector<std::pair<uint32, std::pair<int64, int64>>> sorted;
+  sorted.reserve(held.size());
+  for (const auto& h : held) {
+    sorted.emplace_back(h.first, h.second);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<uint32, std::pair<int64, int64>>& a,
+               const std::pair<uint32, std::pair<int64, int64>>& b) {
+              if (a.second.first != b.second.first) {
+                return a.second.first > b.second.first;
+              }
+              return a.first < b.first;
+            });
+  for (const auto& h : sorted) {
+    AllocationsAtPeak* live = timeline->add_live_at_peak();
+    live->set_op_name(MemoryAnnotation::OpName(h.first));
+    live->set_bytes(h.second.first);
+    live->set_num_allocations(h.second.second);
+  }
+}
+
 void BFCAllocator::GetStats(AllocatorStats* stats) {
   mutex_lock l(lock_);
   *stats = stats_;
+  stats->num_allocs += num_thread_cache_allocs_.load(std::memory_order_relaxed);
+  stats->bytes_in_use -= ThreadCacheBytes();
 }
 
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
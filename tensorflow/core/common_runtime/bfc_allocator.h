@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMMON_RUNTIME_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -24,7 +25,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/visitable_allocator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -70,13 +73,91 @@ class BFCAllocator : public VisitableAllocator {
 
   void GetStats(AllocatorStats* stats) override;
 
+  // Records allocations, frees, chunk splits and merges and region
+  // extensions, with the state of the allocator after each, in a buffer of
+  // the last kMaxTimelineEvents events. StopTimeline() also reports which
+  // ops, as named by the MemoryAnnotation of the allocating thread, held the
+  // memory that was in use at the peak of the recorded events. Chunks handed
+  // out by the thread caches are not attributed.
+  int64 StartTimeline() override;
+  void StopTimeline(int64 cursor, AllocatorTimeline* timeline) override;
+
+  // Puts a cache of small free chunks in front of the bins on each thread
+  // that allocates or frees memory, holding at most "max_bytes_per_thread"
+  // bytes. Allocations of up to kMaxThreadCacheChunkSize bytes that find a
+  // chunk of the right size in their thread's cache do not take lock_.
+  // Frees are buffered on each thread and handed back to the allocator
+  // kMaxPendingFrees at a time, at which point small chunks go to the
+  // freeing thread's cache and the others back to the bins. All caches are
+  // returned to the bins before an allocation fails. Chunks held by the
+  // caches are not reported in GetStats()'s bytes_in_use, and
+  // RequestedSize() of a chunk allocated from a cache is the chunk's size.
+  //
+  // Must be called before the first allocation.
+  void EnableThreadCache(size_t max_bytes_per_thread);
+
  private:
   struct Bin;
+  struct ThreadCache;
 
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure);
   void DeallocateRawInternal(void* ptr);
 
+  static const size_t kMaxThreadCacheChunkSize = 4096;
+  static const int kMaxPendingFrees = 32;
+
+  // Returns the calling thread's cache, creating it if needed.
+  ThreadCache* GetThreadCache() LOCKS_EXCLUDED(lock_);
+
+  // Frees "ptr", which was buffered in "cache", to "cache" if it is small
+  // enough and "cache" has room, or to the bins otherwise.
+  void FlushPendingFree(void* ptr, ThreadCache* cache)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the chunks held or buffered by all thread caches to the bins.
+  void DrainThreadCaches() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the number of bytes held or buffered by all thread caches.
+  size_t ThreadCacheBytes() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  static const int64 kMaxTimelineEvents = 1 << 16;
+
+  struct TimelineEvent {
+    AllocatorTimelineEvent::Type type;
+    int64 micros;
+    int64 bytes;
+    int64 bytes_in_use;
+    int64 bytes_reserved;
+    int64 largest_free_bytes;
+    // next_allocation_id_ after the event.
+    int64 next_allocation_id;
+    // The allocation id and annotation of the chunk, for DEALLOCATE.
+    int64 allocation_id;
+    uint32 annotation;
+  };
+
+  // Appends an event to the timeline if a timeline is being recorded.
+  void MaybeRecordEvent(AllocatorTimelineEvent::Type type, size_t bytes,
+                        int64 allocation_id = -1, uint32 annotation = 0)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    if (num_timeline_recorders_ > 0) {
+      RecordEvent(type, bytes, allocation_id, annotation);
+    }
+  }
+  void RecordEvent(AllocatorTimelineEvent::Type type, size_t bytes,
+                   int64 allocation_id, uint32 annotation)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Fills in 'timeline->live_at_peak' with the chunks that were in use at
+  // 'peak', given the events recorded after it in [peak_index + 1, end).
+  void AddLiveAtPeak(const TimelineEvent& peak, int64 peak_index, int64 end,
+                     AllocatorTimeline* timeline)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the size of the largest free chunk in the bins.
+  size_t LargestFreeChunkSize() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   typedef size_t ChunkHandle;
@@ -107,6 +188,9 @@ class BFCAllocator : public VisitableAllocator {
     int64 allocation_id = -1;
     void* ptr = nullptr;  // pointer to granted subbuffer.
 
+    // The MemoryAnnotation of the thread that allocated the chunk.
+    uint32 annotation = 0;
+
     // If not kInvalidChunkHandle, the memory referred to by 'prev' is directly
     // preceding the memory used by this chunk.  E.g., It should start
     // at 'ptr - prev->size'
@@ -431,6 +515,25 @@ class BFCAllocator : public VisitableAllocator {
   // Stats.
   AllocatorStats stats_ GUARDED_BY(lock_);
 
+  // The cells of the process-wide bytes-in-use gauges labelled with name_.
+  monitoring::GaugeCell<int64>* const bytes_in_use_cell_;
+  monitoring::GaugeCell<int64>* const peak_bytes_in_use_cell_;
+
+  // The number of outstanding StartTimeline() cursors, and the ring buffer
+  // of the last kMaxTimelineEvents events. Event i is stored at
+  // timeline_events_[i % kMaxTimelineEvents].
+  int num_timeline_recorders_ GUARDED_BY(lock_) = 0;
+  int64 next_timeline_event_ GUARDED_BY(lock_) = 0;
+  std::vector<TimelineEvent> timeline_events_ GUARDED_BY(lock_);
+
+  // Thread caches, enabled if thread_cache_bytes_ > 0. Each thread finds
+  // its cache through a thread-local map keyed by id_.
+  size_t thread_cache_bytes_ = 0;
+  const int64 id_;
+  std::vector<std::unique_ptr<ThreadCache>> thread_caches_ GUARDED_BY(lock_);
+  // The number of allocations served by thread caches.
+  std::atomic<int64> num_thread_cache_allocs_{0};
+
   friend class GPUBFCAllocatorPrivateMethodsTest;
   TF_DISALLOW_COPY_AND_ASSIGN(BFCAllocator);
 };
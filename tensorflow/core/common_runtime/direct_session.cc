@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <atomic>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/constant_folding.h"
@@ -27,6 +28,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/sampled_step_profile.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb_text.h"
@@ -50,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/prometheus_exporter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -70,6 +74,9 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// Used when ExecutorOptions::sampled_profiling_max_records is 0.
+constexpr int kDefaultSampledProfilingMaxRecords = 4096;
+
 int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options) {
   const int32 t = options.config.inter_op_parallelism_threads();
   if (t != 0) return t;
@@ -88,17 +95,23 @@ Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
     thread::ThreadPool** pool, bool* owned) {
+  ThreadOptions thread_options;
+  TF_RETURN_IF_ERROR(ThreadOptionsFromAffinity(thread_pool_options.affinity(),
+                                               &thread_options));
   int32 num_threads = thread_pool_options.num_threads();
   if (num_threads == 0) {
-    num_threads = NumInterOpThreadsFromSessionOptions(options);
+    num_threads = thread_options.cpu_affinity.empty()
+                      ? NumInterOpThreadsFromSessionOptions(options)
+                      : static_cast<int32>(thread_options.cpu_affinity.size());
   }
   const string& name = thread_pool_options.global_name();
   if (name.empty()) {
     // Session-local threadpool.
     VLOG(1) << "Direct session inter op parallelism threads for pool "
             << pool_number << ": " << num_threads;
-    *pool = new thread::ThreadPool(
-        options.env, strings::StrCat("Compute", pool_number), num_threads);
+    *pool = new thread::ThreadPool(options.env, thread_options,
+                                   strings::StrCat("Compute", pool_number),
+                                   num_threads);
     *owned = true;
     return Status::OK();
   }
@@ -113,7 +126,8 @@ Status NewThreadPoolFromThreadPoolOptions(
   if (mvalue->second == nullptr) {
     mvalue->first = thread_pool_options.num_threads();
     mvalue->second = new thread::ThreadPool(
-        options.env, strings::StrCat("Compute", pool_number), num_threads);
+        options.env, thread_options, strings::StrCat("Compute", pool_number),
+        num_threads);
   } else {
     if (mvalue->first != thread_pool_options.num_threads()) {
       return errors::InvalidArgument(
@@ -146,6 +160,30 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// If TF_PROMETHEUS_METRICS_PATH is set, starts writing the metrics of the
+// process to it in the Prometheus text format every
+// TF_PROMETHEUS_METRICS_INTERVAL_SECS seconds (60 by default), for the
+// lifetime of the process. Only the first call has an effect.
+void MaybeStartPrometheusWriter(Env* env) {
+  static monitoring::PeriodicPrometheusWriter* writer = [env]() {
+    const char* path = getenv("TF_PROMETHEUS_METRICS_PATH");
+    if (path == nullptr || *path == '\0') {
+      return static_cast<monitoring::PeriodicPrometheusWriter*>(nullptr);
+    }
+    int64 interval_secs = 60;
+    const Status s = ReadInt64FromEnvVar("TF_PROMETHEUS_METRICS_INTERVAL_SECS",
+                                         60, &interval_secs);
+    if (!s.ok() || interval_secs <= 0) {
+      LOG(ERROR) << "Not writing metrics to " << path
+                 << ": invalid TF_PROMETHEUS_METRICS_INTERVAL_SECS " << s;
+      return static_cast<monitoring::PeriodicPrometheusWriter*>(nullptr);
+    }
+    return new monitoring::PeriodicPrometheusWriter(
+        env, path, interval_secs * 1000000);
+  }();
+  (void)writer;
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -169,6 +207,7 @@ class DirectSessionFactory : public SessionFactory {
       return nullptr;
     }
 
+    MaybeStartPrometheusWriter(options.env);
     DirectSession* session =
         new DirectSession(options, new DeviceMgr(devices), this);
     {
@@ -300,6 +339,7 @@ DirectSession::DirectSession(const SessionOptions& options,
     devices_.push_back(d);
     device_set_.AddDevice(d);
     d->op_segment()->AddHold(session_handle_);
+    if (d->device_type() == DEVICE_GPU) has_gpu_devices_ = true;
 
     // The first device added is special: it is the 'client device' (a
     // CPU device) from which we feed and fetch Tensors.
@@ -452,20 +492,11 @@ Status DirectSession::Run(const RunOptions& run_options,
     input_tensor_names.push_back(it.first);
   }
 
-  if (run_options.inter_op_thread_pool() < 0 ||
-      run_options.inter_op_thread_pool() >= thread_pools_.size()) {
-    return errors::InvalidArgument("Invalid inter_op_thread_pool: ",
-                                   run_options.inter_op_thread_pool());
-  }
-  thread::ThreadPool* pool =
-      thread_pools_[run_options.inter_op_thread_pool()].first;
-
   // Check if we already have an executor for these arguments.
   ExecutorsAndKeys* executors_and_keys;
   RunStateArgs run_state_args(run_options.debug_options());
 
-  Executor::Args args;
-  args.step_id = step_id_counter_.fetch_add(1);
+  const int64 step_id = step_id_counter_.fetch_add(1);
 
   TF_RETURN_IF_ERROR(
       GetOrCreateExecutors(input_tensor_names, output_names, target_nodes,
@@ -475,7 +506,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   std::unique_ptr<DebuggerStateInterface> debugger_state;
   if (!run_options.debug_options().debug_tensor_watch_opts().empty()) {
     TF_RETURN_IF_ERROR(CreateDebuggerState(
-        run_options.debug_options(), args.step_id, executor_step_count,
+        run_options.debug_options(), step_id, executor_step_count,
         input_tensor_names, output_names, target_nodes, &debugger_state));
   }
 
@@ -502,20 +533,95 @@ Status DirectSession::Run(const RunOptions& run_options,
     return s;
   }
 
+  TF_RETURN_IF_ERROR(RunInternal(step_id, executor_step_count, run_options,
+                                 &call_frame, executors_and_keys,
+                                 run_state_args.handle, output_names,
+                                 run_metadata));
+
+  // Receive outputs.
+  if (outputs) {
+    std::vector<Tensor> sorted_outputs;
+    const Status s = call_frame.ConsumeRetvals(&sorted_outputs);
+    if (errors::IsInternal(s)) {
+      return errors::InvalidArgument(s.error_message());
+    } else if (!s.ok()) {
+      return s;
+    }
+    const bool unique_outputs =
+        output_names.size() == executors_and_keys->output_name_to_index.size();
+    // first_indices[i] = j implies that j is the smallest value for which
+    // output_names[i] == output_names[j].
+    std::vector<int> first_indices;
+    if (!unique_outputs) {
+      first_indices.resize(output_names.size());
+      for (int i = 0; i < output_names.size(); ++i) {
+        for (int j = 0; j <= i; ++j) {
+          if (output_names[i] == output_names[j]) {
+            first_indices[i] = j;
+            break;
+          }
+        }
+      }
+    }
+    outputs->clear();
+    outputs->reserve(sorted_outputs.size());
+    for (int i = 0; i < output_names.size(); ++i) {
+      const string& output_name = output_names[i];
+      if (first_indices.empty() || first_indices[i] == i) {
+        outputs->emplace_back(
+            std::move(sorted_outputs[executors_and_keys
+                                         ->output_name_to_index[output_name]]));
+      } else {
+        outputs->push_back((*outputs)[first_indices[i]]);
+      }
+    }
+  }
+
+  return Status::OK();
+}
+
+Status DirectSession::RunInternal(int64 step_id, int64 executor_step_count,
+                                  const RunOptions& run_options,
+                                  CallFrameInterface* call_frame,
+                                  ExecutorsAndKeys* executors_and_keys,
+                                  const string& handle,
+                                  const std::vector<string>& output_names,
+                                  RunMetadata* run_metadata) {
+  if (run_options.inter_op_thread_pool() < 0 ||
+      run_options.inter_op_thread_pool() >= thread_pools_.size()) {
+    return errors::InvalidArgument("Invalid inter_op_thread_pool: ",
+                                   run_options.inter_op_thread_pool());
+  }
+  thread::ThreadPool* pool =
+      thread_pools_[run_options.inter_op_thread_pool()].first;
+
+  Executor::Args args;
+  args.step_id = step_id;
+
+  // The arena each executor allocates from in this step. Declared before
+  // run_state so that it outlives the executors if the step times out.
+  std::vector<StepArena*> step_arenas;
+
   // Create a run state and start execution.
   RunState run_state(args.step_id, &devices_);
   run_state.rendez = new IntraProcessRendezvous(device_mgr_.get());
   CancellationManager step_cancellation_manager;
-  args.call_frame = &call_frame;
+  args.call_frame = call_frame;
 
   // Start parallel Executors.
   const size_t num_executors = executors_and_keys->items.size();
   ExecutorBarrier* barrier = new ExecutorBarrier(
-      num_executors, run_state.rendez, [&run_state](const Status& ret) {
+      num_executors, run_state.rendez,
+      [&run_state, &step_arenas, executors_and_keys](const Status& ret) {
         {
           mutex_lock l(run_state.mu_);
           run_state.status.Update(ret);
         }
+        for (size_t i = 0; i < step_arenas.size(); ++i) {
+          StepMemoryPlanner* planner =
+              executors_and_keys->items[i].memory_planner.get();
+          if (planner != nullptr) planner->EndStep(step_arenas[i]);
+        }
         run_state.executors_done.Notify();
       });
 
@@ -526,7 +632,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   args.tensor_store = &run_state.tensor_store;
   args.step_container = &run_state.step_container;
   if (LogMemory::IsEnabled()) {
-    LogMemory::RecordStep(args.step_id, run_state_args.handle);
+    LogMemory::RecordStep(args.step_id, handle);
   }
   args.sync_on_finish = sync_on_finish_;
 
@@ -545,22 +651,49 @@ Status DirectSession::Run(const RunOptions& run_options,
     }
   }
   if (do_trace || update_cost_model ||
-      run_options.report_tensor_allocations_upon_oom()) {
+      run_options.report_tensor_allocations_upon_oom() ||
+      run_options.record_allocator_timelines()) {
     run_state.collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
-  }
-
+    args.collect_cpu_counters =
+        run_options.trace_level() >= RunOptions::HARDWARE_TRACE;
+  }
+
+  // Steps that do not collect StepStats may instead be sampled for the
+  // process-wide op latency histograms.
+  std::unique_ptr<SampledStepProfile> sampled_profile;
+  const ExecutorOptions& executor_options = options_.config.executor_options();
+  if (args.stats_collector == nullptr &&
+      executor_options.sampled_profiling_step_period() > 0 &&
+      executor_step_count %
+              executor_options.sampled_profiling_step_period() ==
+          0) {
+    const int max_records = executor_options.sampled_profiling_max_records();
+    sampled_profile.reset(new SampledStepProfile(
+        executor_options.sampled_profiling_node_period(),
+        max_records > 0 ? max_records : kDefaultSampledProfilingMaxRecords));
+    args.sampled_profile = sampled_profile.get();
+  }
+
+  // FULL_TRACE steps on GPUs also trace the kernels, on a best-effort basis:
+  // failing to start the tracer is only an error for HARDWARE_TRACE.
   std::unique_ptr<DeviceTracer> tracer;
-  if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
+  const bool hardware_trace =
+      run_options.trace_level() >= RunOptions::HARDWARE_TRACE;
+  if (hardware_trace || (run_options.trace_level() == RunOptions::FULL_TRACE &&
+                         has_gpu_devices_)) {
     tracer = CreateDeviceTracer();
     // tracer may be NULL on platforms without accelerators.
     if (tracer) {
       Status s = tracer->Start();
-      if (!s.ok()) {
+      if (!s.ok() && hardware_trace) {
         run_state.executors_done.Notify();
         delete barrier;
         return s;
+      } else if (!s.ok()) {
+        VLOG(1) << "Not tracing the kernels of a FULL_TRACE step: " << s;
+        tracer.reset();
       }
     }
   }
@@ -586,7 +719,35 @@ Status DirectSession::Run(const RunOptions& run_options,
                                            pool](Executor::Args::Closure c) {
     SchedClosure(pool, std::move(c));
   };
+  // Start recording the timelines of the default allocators of the devices
+  // that run this step. Allocators that do not support timelines are
+  // skipped.
+  struct RecordedTimeline {
+    string device;
+    Allocator* allocator;
+    int64 cursor;
+  };
+  std::vector<RecordedTimeline> timelines;
+  if (run_options.record_allocator_timelines()) {
+    std::unordered_set<Allocator*> seen;
+    for (const auto& item : executors_and_keys->items) {
+      Allocator* allocator = item.device->GetAllocator(AllocatorAttributes());
+      if (!seen.insert(allocator).second) continue;
+      const int64 cursor = allocator->StartTimeline();
+      if (cursor >= 0) {
+        timelines.push_back({item.device->name(), allocator, cursor});
+      }
+    }
+  }
+
+  step_arenas.reserve(num_executors);
   for (const auto& item : executors_and_keys->items) {
+    step_arenas.push_back(item.memory_planner == nullptr
+                              ? nullptr
+                              : item.memory_planner->BeginStep());
+  }
+  for (size_t i = 0; i < num_executors; ++i) {
+    const auto& item = executors_and_keys->items[i];
     // TODO(zhengxq): support partial run.
     // TODO(zhengxq): if the device picks its own threadpool, we need to assign
     //     less threads to the main compute pool by default.
@@ -599,6 +760,7 @@ Status DirectSession::Run(const RunOptions& run_options,
         SchedClosure(device_thread_pool, std::move(c));
       };
     }
+    args.step_arena = step_arenas[i];
     item.executor->RunAsync(args, barrier->Get());
   }
 
@@ -607,6 +769,12 @@ Status DirectSession::Run(const RunOptions& run_options,
                           ? run_options.timeout_in_ms()
                           : operation_timeout_in_ms_);
 
+  for (const RecordedTimeline& t : timelines) {
+    AllocatorTimeline timeline;
+    t.allocator->StopTimeline(t.cursor, &timeline);
+    args.stats_collector->SaveAllocatorTimeline(t.device, &timeline);
+  }
+
   if (!cancellation_manager_->DeregisterCallback(cancellation_token)) {
     // The step has been cancelled: make sure we don't attempt to receive the
     // outputs as this would make it block forever.
@@ -619,50 +787,15 @@ Status DirectSession::Run(const RunOptions& run_options,
     TF_RETURN_IF_ERROR(tracer->Collect(args.stats_collector));
   }
 
+  if (sampled_profile) {
+    sampled_profile->Flush();
+  }
+
   {
     mutex_lock l(run_state.mu_);
     TF_RETURN_IF_ERROR(run_state.status);
   }
 
-  // Receive outputs.
-  if (outputs) {
-    std::vector<Tensor> sorted_outputs;
-    const Status s = call_frame.ConsumeRetvals(&sorted_outputs);
-    if (errors::IsInternal(s)) {
-      return errors::InvalidArgument(s.error_message());
-    } else if (!s.ok()) {
-      return s;
-    }
-    const bool unique_outputs =
-        output_names.size() == executors_and_keys->output_name_to_index.size();
-    // first_indices[i] = j implies that j is the smallest value for which
-    // output_names[i] == output_names[j].
-    std::vector<int> first_indices;
-    if (!unique_outputs) {
-      first_indices.resize(output_names.size());
-      for (int i = 0; i < output_names.size(); ++i) {
-        for (int j = 0; j <= i; ++j) {
-          if (output_names[i] == output_names[j]) {
-            first_indices[i] = j;
-            break;
-          }
-        }
-      }
-    }
-    outputs->clear();
-    outputs->reserve(sorted_outputs.size());
-    for (int i = 0; i < output_names.size(); ++i) {
-      const string& output_name = output_names[i];
-      if (first_indices.empty() || first_indices[i] == i) {
-        outputs->emplace_back(
-            std::move(sorted_outputs[executors_and_keys
-                                         ->output_name_to_index[output_name]]));
-      } else {
-        outputs->push_back((*outputs)[first_indices[i]]);
-      }
-    }
-  }
-
   // Save the output tensors of this run we choose to keep.
   TF_RETURN_IF_ERROR(
       run_state.tensor_store.SaveTensors(output_names, &session_state_));
@@ -705,6 +838,132 @@ Status DirectSession::Run(const RunOptions& run_options,
   return Status::OK();
 }
 
+
+Status DirectSession::MakeCallable(const RunOptions& run_options,
+                                   const std::vector<string>& feed_names,
+                                   const std::vector<string>& fetch_names,
+                                   const std::vector<string>& target_names,
+                                   CallableHandle* out_handle) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  {
+    mutex_lock l(graph_def_lock_);
+    if (!graph_created_) {
+      return errors::InvalidArgument(
+          "Session was not created with a graph before MakeCallable()!");
+    }
+  }
+  if (!run_options.debug_options().debug_tensor_watch_opts().empty()) {
+    return errors::Unimplemented(
+        "Debug tensor watches are not supported by MakeCallable().");
+  }
+
+  std::shared_ptr<Callable> callable(new Callable);
+  RunStateArgs run_state_args(run_options.debug_options());
+  TF_RETURN_IF_ERROR(GetOrCreateExecutors(feed_names, fetch_names,
+                                          target_names,
+                                          &callable->executors_and_keys,
+                                          &run_state_args));
+  const ExecutorsAndKeys* ek = callable->executors_and_keys;
+  callable->run_options = run_options;
+  callable->handle = run_state_args.handle;
+  callable->feed_indices.reserve(feed_names.size());
+  for (const string& name : feed_names) {
+    callable->feed_indices.push_back(ek->input_name_to_index.at(name));
+  }
+  callable->fetch_indices.reserve(fetch_names.size());
+  for (const string& name : fetch_names) {
+    callable->fetch_indices.push_back(ek->output_name_to_index.at(name));
+  }
+  callable->fetch_names = fetch_names;
+
+  mutex_lock l(callables_lock_);
+  *out_handle = next_callable_handle_++;
+  callables_[*out_handle] = std::move(callable);
+  return Status::OK();
+}
+
+Status DirectSession::RunCallable(CallableHandle handle,
+                                  const std::vector<Tensor>& feed_tensors,
+                                  std::vector<Tensor>* fetch_tensors,
+                                  RunMetadata* run_metadata) {
+  TF_RETURN_IF_ERROR(CheckNotClosed());
+  direct_session_runs->GetCell()->IncrementBy(1);
+  std::shared_ptr<Callable> callable;
+  {
+    mutex_lock l(callables_lock_);
+    auto it = callables_.find(handle);
+    if (it == callables_.end()) {
+      return errors::InvalidArgument(
+          "Attempted to run callable with invalid handle: ", handle);
+    }
+    callable = it->second;
+  }
+  if (feed_tensors.size() != callable->feed_indices.size()) {
+    return errors::InvalidArgument(
+        "Invalid number of feed tensors: expected ",
+        callable->feed_indices.size(), ", got ", feed_tensors.size());
+  }
+
+  ExecutorsAndKeys* executors_and_keys = callable->executors_and_keys;
+  const int64 step_id = step_id_counter_.fetch_add(1);
+  const int64 executor_step_count = executors_and_keys->step_count.fetch_add(1);
+
+  // The call frame is per step, so that a callable may be run concurrently
+  // from several threads.
+  FunctionCallFrame call_frame(executors_and_keys->input_types,
+                               executors_and_keys->output_types);
+  gtl::InlinedVector<Tensor, 4> feed_args(
+      executors_and_keys->input_types.size());
+  for (size_t i = 0; i < feed_tensors.size(); ++i) {
+    const Tensor& feed = feed_tensors[i];
+    if (feed.dtype() == DT_RESOURCE) {
+      TF_RETURN_IF_ERROR(ResourceHandleToInputTensor(
+          feed, &feed_args[callable->feed_indices[i]]));
+    } else {
+      feed_args[callable->feed_indices[i]] = feed;
+    }
+  }
+  Status s = call_frame.SetArgs(feed_args);
+  if (errors::IsInternal(s)) {
+    return errors::InvalidArgument(s.error_message());
+  } else if (!s.ok()) {
+    return s;
+  }
+
+  RunMetadata unused_run_metadata;
+  TF_RETURN_IF_ERROR(RunInternal(
+      step_id, executor_step_count, callable->run_options, &call_frame,
+      executors_and_keys, callable->handle, callable->fetch_names,
+      run_metadata != nullptr ? run_metadata : &unused_run_metadata));
+
+  if (fetch_tensors) {
+    std::vector<Tensor> sorted_outputs;
+    s = call_frame.ConsumeRetvals(&sorted_outputs);
+    if (errors::IsInternal(s)) {
+      return errors::InvalidArgument(s.error_message());
+    } else if (!s.ok()) {
+      return s;
+    }
+    // Aliased fetches share a retval, so the tensors are copied rather than
+    // moved out of 'sorted_outputs'.
+    fetch_tensors->clear();
+    fetch_tensors->reserve(callable->fetch_indices.size());
+    for (const int index : callable->fetch_indices) {
+      fetch_tensors->push_back(sorted_outputs[index]);
+    }
+  }
+  return Status::OK();
+}
+
+Status DirectSession::ReleaseCallable(CallableHandle handle) {
+  mutex_lock l(callables_lock_);
+  if (callables_.erase(handle) == 0) {
+    return errors::InvalidArgument(
+        "Attempted to release callable with invalid handle: ", handle);
+  }
+  return Status::OK();
+}
+
 Status DirectSession::PRunSetup(const std::vector<string>& input_names,
                                 const std::vector<string>& output_names,
                                 const std::vector<string>& target_nodes,
@@ -1200,6 +1459,18 @@ Status DirectSession::GetOrCreateExecutors(
     auto opseg = device->op_segment();
     params.create_kernel = [this, lib, opseg](const NodeDef& ndef,
                                               OpKernel** kernel) {
+      auto create_fn = [lib, &ndef](OpKernel** kernel) {
+        return lib->CreateKernel(ndef, kernel);
+      };
+      // Stateless kernels that only depend on "ndef" are shared with the
+      // other executors of this session that run an identical node, e.g.
+      // when several feed/fetch signatures prune the same graph.
+      if (OpSegment::ShouldShareKernel(lib, ndef)) {
+        return opseg->FindOrCreateShared(
+            session_handle_,
+            OpSegment::SharedKernelKey(ndef, lib->graph_def_version()),
+            kernel, create_fn);
+      }
       // We do not share the kernel via the OpSegment if the node is
       // stateless, or a function.
       // NOTE(mrry): We must not share function kernels (implemented
@@ -1210,9 +1481,6 @@ Status DirectSession::GetOrCreateExecutors(
           lib->GetFunctionLibraryDefinition()->Find(ndef.op()) != nullptr) {
         return lib->CreateKernel(ndef, kernel);
       }
-      auto create_fn = [lib, &ndef](OpKernel** kernel) {
-        return lib->CreateKernel(ndef, kernel);
-      };
       // Kernels created for subgraph nodes need to be cached.  On
       // cache miss, create_fn() is invoked to create a kernel based
       // on the function library here + global op registry.
@@ -1220,12 +1488,22 @@ Status DirectSession::GetOrCreateExecutors(
                                  create_fn);
     };
     params.delete_kernel = [lib](OpKernel* kernel) {
-      // If the node is stateful, opseg owns it. Otherwise, delete it.
-      if (kernel && !lib->IsStateful(kernel->type_string())) {
+      // If the node is stateful or shared, opseg owns it. Otherwise, delete
+      // it.
+      if (kernel && !lib->IsStateful(kernel->type_string()) &&
+          !OpSegment::ShouldShareKernel(lib, kernel->def())) {
         delete kernel;
       }
     };
+    params.create_kernel_pool = thread_pools_[0].first;
     params.node_outputs_cb = node_outputs_callback_;
+    params.num_work_stealing_lanes =
+        NumWorkStealingLanes(options_.config.executor_options(),
+                             thread_pools_[0].first->NumThreads());
+    params.inline_cost_threshold_usecs =
+        options_.config.executor_options().inline_cost_threshold_usecs();
+    params.allow_static_plan =
+        options_.config.executor_options().use_static_plan();
 
     optimizer.Optimize(lib, options_.env, device, &iter->second,
                        /*shape_map=*/nullptr);
@@ -1243,6 +1521,12 @@ Status DirectSession::GetOrCreateExecutors(
     item->graph = partition_graph.get();
     item->executor = nullptr;
     item->device = device;
+    if (options_.config.executor_options().use_step_memory_plan() &&
+        device->device_type() == DEVICE_CPU) {
+      item->memory_planner.reset(new StepMemoryPlanner(
+          device->GetAllocator(AllocatorAttributes()),
+          partition_graph->num_node_ids()));
+    }
     Executor* executor;
     TF_RETURN_IF_ERROR(
         NewLocalExecutor(params, partition_graph.release(), &executor));
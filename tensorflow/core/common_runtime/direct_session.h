@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/session_state.h"
@@ -91,6 +92,17 @@ class DirectSession : public Session {
                             const std::vector<string>& output_names,
                             std::vector<Tensor>* outputs) override;
 
+  ::tensorflow::Status MakeCallable(const RunOptions& run_options,
+                                    const std::vector<string>& feed_names,
+                                    const std::vector<string>& fetch_names,
+                                    const std::vector<string>& target_names,
+                                    CallableHandle* out_handle) override;
+  ::tensorflow::Status RunCallable(CallableHandle handle,
+                                   const std::vector<Tensor>& feed_tensors,
+                                   std::vector<Tensor>* fetch_tensors,
+                                   RunMetadata* run_metadata) override;
+  ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
+
   // Reset clears 'containers' from the device_mgr of the DirectSession.
   // If 'containers' is empty, then Reset clears the default container.
   ::tensorflow::Status Reset(const std::vector<string>& containers);
@@ -115,6 +127,8 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+    // Set if ExecutorOptions::use_step_memory_plan is enabled.
+    std::unique_ptr<StepMemoryPlanner> memory_planner;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -198,6 +212,18 @@ class DirectSession : public Session {
       gtl::ArraySlice<string> target_nodes,
       ExecutorsAndKeys** executors_and_keys, RunStateArgs* run_state_args);
 
+  // Runs one step of 'executors_and_keys' with its feeds and fetches in
+  // 'call_frame'. Shared by Run() and RunCallable(); 'handle' names the
+  // step for memory logging and 'output_names' are the fetches whose
+  // tensors are kept in the session state.
+  ::tensorflow::Status RunInternal(int64 step_id, int64 executor_step_count,
+                                   const RunOptions& run_options,
+                                   CallFrameInterface* call_frame,
+                                   ExecutorsAndKeys* executors_and_keys,
+                                   const string& handle,
+                                   const std::vector<string>& output_names,
+                                   RunMetadata* run_metadata);
+
   // Creates several graphs given the existing graph_def_ and the
   // input feeds and fetches, given 'devices'. The graphs share a common
   // function library 'flib_def'.
@@ -280,6 +306,8 @@ class DirectSession : public Session {
 
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
+  // True if one of devices_ is a GPU, whose kernels FULL_TRACE steps trace.
+  bool has_gpu_devices_ = false;
   // Schedules 'c' for execution on pool.
   void SchedClosure(thread::ThreadPool* pool, std::function<void()> c);
 
@@ -292,6 +320,23 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       GUARDED_BY(executor_lock_);
 
+  // A subgraph created by MakeCallable(). 'feed_indices[i]' and
+  // 'fetch_indices[i]' are the call frame positions of the i-th feed and
+  // fetch, resolved once when the callable is made.
+  struct Callable {
+    ExecutorsAndKeys* executors_and_keys = nullptr;  // not owned.
+    RunOptions run_options;
+    string handle;
+    std::vector<int> feed_indices;
+    std::vector<int> fetch_indices;
+    std::vector<string> fetch_names;
+  };
+
+  mutex callables_lock_;
+  int64 next_callable_handle_ GUARDED_BY(callables_lock_) = 0;
+  std::unordered_map<int64, std::shared_ptr<Callable>> callables_
+      GUARDED_BY(callables_lock_);
+
   // Holds mappings from handle to partial run state.
   std::unordered_map<string, std::unique_ptr<RunState>> partial_runs_
       GUARDED_BY(executor_lock_);
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -24,6 +25,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/common_runtime/sampled_step_profile.h"
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -32,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/log_memory.h"
+#include "tensorflow/core/framework/memory_annotation.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_segment.h"
@@ -50,8 +54,12 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -59,6 +67,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -66,6 +75,35 @@ namespace {
 // 1-D, 0 element tensor.
 static const Tensor* const kEmptyTensor = new Tensor;
 
+auto* executor_queued_nodes = monitoring::Gauge<int64, 0>::New(
+    "/tensorflow/core/executor/queued_nodes",
+    "The number of ready nodes handed to another thread that have not "
+    "started running yet, over all executors of the process.");
+
+monitoring::GaugeCell<int64>* const queued_nodes_cell =
+    executor_queued_nodes->GetCell();
+
+auto* executor_ready_to_start_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/executor/ready_to_start_usecs",
+     "The time from a node becoming ready until a thread started running "
+     "it, for the nodes handed to another thread.",
+     "device"},
+    // 1us to ~8s.
+    monitoring::Buckets::Exponential(1, 2, 24));
+
+auto* executor_scheduled_nodes = monitoring::Counter<2>::New(
+    "/tensorflow/core/executor/scheduled_nodes",
+    "The number of ready nodes, by whether they ran inline on the thread "
+    "that made them ready or were dispatched to another thread.",
+    "device", "scheduling");
+
+auto* executor_queue_length = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/executor/queue_length",
+     "The number of queued nodes over all executors of the process, sampled "
+     "whenever nodes become ready.",
+     "device"},
+    monitoring::Buckets::Exponential(1, 2, 16));
+
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
@@ -185,6 +223,33 @@ void SetMemory(NodeExecStatsWrapper* stats, OpKernelContext* ctx) {
       ctx->device_persistent_memory_allocated());
 }
 
+// Records the hardware events counted on the calling thread during its
+// lifetime in 'stats', if it is not null and 'enabled'.
+class ScopedCPUCounters {
+ public:
+  ScopedCPUCounters(NodeExecStatsWrapper* stats, bool enabled)
+      : stats_(stats),
+        active_(stats != nullptr && enabled &&
+                port::ReadCurrentThreadCPUCounters(&start_)) {}
+
+  ~ScopedCPUCounters() {
+    port::CPUCounterValues end;
+    if (!active_ || !port::ReadCurrentThreadCPUCounters(&end)) return;
+    CPUCounters* counters = stats_->stats()->mutable_cpu_counters();
+    counters->set_cycles(end.cycles - start_.cycles);
+    counters->set_instructions(end.instructions - start_.instructions);
+    counters->set_llc_misses(end.llc_misses - start_.llc_misses);
+    counters->set_stalled_cycles(end.stalled_cycles - start_.stalled_cycles);
+  }
+
+ private:
+  NodeExecStatsWrapper* const stats_;
+  port::CPUCounterValues start_;
+  const bool active_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedCPUCounters);
+};
+
 void SetReferencedTensors(NodeExecStatsWrapper* stats,
                           const TensorReferenceVector& tensors) {
   if (!stats) return;
@@ -243,6 +308,9 @@ struct NodeItem {
 
   PendingCounts::Handle pending_id;
 
+  // The MemoryAnnotation of the node's name, under which its kernel runs.
+  uint32 memory_annotation = MemoryAnnotation::kNone;
+
   const EdgeInfo* output_edge_list() const { return output_edge_base(); }
 
   // ith output edge.
@@ -406,6 +474,10 @@ class ExecutorImpl : public Executor {
 
   static Status BuildControlFlowInfo(const Graph* graph,
                                      ControlFlowInfo* cf_info);
+
+  // Fills in static_plan_ if the graph can be run without dynamic
+  // scheduling.
+  void BuildStaticPlan();
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
 
   FrameInfo* EnsureFrameInfo(const string& fname) {
@@ -427,11 +499,53 @@ class ExecutorImpl : public Executor {
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const Node*> root_nodes_;
 
+  // If non-empty, the ids of all nodes but the sink in a topological order.
+  // Each step then runs them in this order on a single thread, without
+  // maintaining pending counts. Only built when params_.allow_static_plan is
+  // set and the graph has no control flow and no asynchronous kernels.
+  std::vector<int> static_plan_;
+
+  // Measured compute time of each node, indexed by node id, in
+  // microseconds, or -1 if the node has not been measured yet. Only
+  // allocated if params_.inline_cost_threshold_usecs > 0.
+  std::unique_ptr<std::atomic<int64>[]> node_cost_usecs_;
+
+  // The number of steps started so far; used to pick the steps on which
+  // node costs are sampled.
+  mutable std::atomic<int64> num_steps_started_{0};
+
+  // Returns true if "item" should be dispatched to another thread rather
+  // than run inline, based on its measured cost if there is one and on
+  // OpKernel::IsExpensive() otherwise.
+  bool IsExpensive(const NodeItem& item) const {
+    if (node_cost_usecs_ != nullptr) {
+      const int64 cost =
+          node_cost_usecs_[item.node->id()].load(std::memory_order_relaxed);
+      if (cost >= 0) return cost >= params_.inline_cost_threshold_usecs;
+    }
+    return item.kernel_is_expensive;
+  }
+
+  // Folds a measured compute time of "usecs" for node "id" into its
+  // running estimate.
+  void RecordNodeCost(int id, int64 usecs) const {
+    std::atomic<int64>* cost = &node_cost_usecs_[id];
+    const int64 old_cost = cost->load(std::memory_order_relaxed);
+    cost->store(old_cost < 0 ? usecs : (3 * old_cost + usecs) / 4,
+                std::memory_order_relaxed);
+  }
+
   // Mapping from frame name to static information about the frame.
   // TODO(yuanbyu): We could cache it along with the graph so to avoid
   // the overhead of constructing it for each executor instance.
   gtl::FlatMap<string, FrameInfo*> frame_info_;
 
+  // The scheduling metrics of the device of this executor.
+  monitoring::SamplerCell* ready_to_start_cell_ = nullptr;
+  monitoring::SamplerCell* queue_length_cell_ = nullptr;
+  monitoring::CounterCell* inline_nodes_cell_ = nullptr;
+  monitoring::CounterCell* dispatched_nodes_cell_ = nullptr;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
 
@@ -622,10 +736,20 @@ Status ExecutorImpl::Initialize() {
   device_record_tensor_accesses_ =
       params_.device->RequiresRecordingAccessedTensors();
 
+  const string& device_name = params_.device->name();
+  ready_to_start_cell_ = executor_ready_to_start_usecs->GetCell(device_name);
+  queue_length_cell_ = executor_queue_length->GetCell(device_name);
+  inline_nodes_cell_ = executor_scheduled_nodes->GetCell(device_name, "inline");
+  dispatched_nodes_cell_ =
+      executor_scheduled_nodes->GetCell(device_name, "dispatched");
+
   for (auto& it : cf_info.unique_frame_names) {
     EnsureFrameInfo(it)->nodes = new std::vector<const Node*>;
   }
 
+  // The nodes whose kernels are created in parallel after the loop below.
+  std::vector<const Node*> deferred_nodes;
+
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   for (const Node* n : graph_->nodes()) {
@@ -644,16 +768,19 @@ Status ExecutorImpl::Initialize() {
     item->input_start = frame_info->total_inputs;
     frame_info->total_inputs += n->num_inputs();
 
-    Status s = params_.create_kernel(n->def(), &item->kernel);
-    if (!s.ok()) {
-      item->kernel = nullptr;
-      s = AttachDef(s, *n);
-      LOG(ERROR) << "Executor failed to create kernel. " << s;
-      return s;
+    // Stateful kernels may look up or create shared resources when they are
+    // constructed, so they are created in graph order on this thread.
+    if (params_.create_kernel_pool != nullptr && !n->op_def().is_stateful()) {
+      deferred_nodes.push_back(n);
+    } else {
+      Status s = params_.create_kernel(n->def(), &item->kernel);
+      if (!s.ok()) {
+        item->kernel = nullptr;
+        s = AttachDef(s, *n);
+        LOG(ERROR) << "Executor failed to create kernel. " << s;
+        return s;
+      }
     }
-    CHECK(item->kernel);
-    item->kernel_is_expensive = item->kernel->IsExpensive();
-    item->kernel_is_async = (item->kernel->AsAsync() != nullptr);
     item->is_merge = IsMerge(n);
     item->is_enter = IsEnter(n);
     item->is_exit = IsExit(n);
@@ -661,6 +788,7 @@ Status ExecutorImpl::Initialize() {
     item->is_sink = IsSink(n);
     item->is_enter_exit_or_next_iter =
         (IsEnter(n) || IsExit(n) || IsNextIteration(n));
+    item->memory_annotation = MemoryAnnotation::Intern(n->name());
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -680,13 +808,79 @@ Status ExecutorImpl::Initialize() {
     }
   }
 
+  // Constructing a kernel may be expensive, e.g. when it validates or
+  // converts large attrs, so large graphs spread the stateless ones over
+  // the threads of params_.create_kernel_pool.
+  if (!deferred_nodes.empty()) {
+    static const int64 kMinKernelsPerThread = 16;
+    const int64 num_deferred = deferred_nodes.size();
+    const int max_parallelism = static_cast<int>(std::min<int64>(
+        params_.create_kernel_pool->NumThreads() + 1,
+        std::max<int64>(1, num_deferred / kMinKernelsPerThread)));
+    std::vector<Status> kernel_status(deferred_nodes.size());
+    ParallelForEach(max_parallelism, params_.create_kernel_pool, num_deferred,
+                    [this, &deferred_nodes, &kernel_status](int64 i) {
+                      const Node* n = deferred_nodes[i];
+                      kernel_status[i] = params_.create_kernel(
+                          n->def(), &gview_.node(n->id())->kernel);
+                    });
+    for (size_t i = 0; i < deferred_nodes.size(); ++i) {
+      if (!kernel_status[i].ok()) {
+        const Node* n = deferred_nodes[i];
+        gview_.node(n->id())->kernel = nullptr;
+        Status s = AttachDef(kernel_status[i], *n);
+        LOG(ERROR) << "Executor failed to create kernel. " << s;
+        return s;
+      }
+    }
+  }
+  for (const Node* n : graph_->nodes()) {
+    NodeItem* item = gview_.node(n->id());
+    CHECK(item->kernel);
+    item->kernel_is_expensive = item->kernel->IsExpensive();
+    item->kernel_is_async = (item->kernel->AsAsync() != nullptr);
+  }
+
   // Initialize PendingCounts only after item->pending_id is initialized for
   // all nodes.
   InitializePending(graph_, cf_info);
 
+  if (params_.allow_static_plan) {
+    BuildStaticPlan();
+  }
+
+  if (params_.inline_cost_threshold_usecs > 0) {
+    const int num_ids = graph_->num_node_ids();
+    node_cost_usecs_.reset(new std::atomic<int64>[num_ids]);
+    for (int i = 0; i < num_ids; ++i) {
+      node_cost_usecs_[i].store(-1, std::memory_order_relaxed);
+    }
+  }
+
   return gview_.SetAllocAttrs(graph_, params_.device);
 }
 
+void ExecutorImpl::BuildStaticPlan() {
+  for (const Node* n : graph_->nodes()) {
+    if (IsControlFlow(n) || gview_.node(n->id())->kernel_is_async) return;
+  }
+  // Orders the nodes the way the dynamic scheduler would visit them with a
+  // single thread: breadth-first from the root nodes.
+  std::vector<int> pending(graph_->num_node_ids(), 0);
+  std::deque<const Node*> ready(root_nodes_.begin(), root_nodes_.end());
+  for (const Node* n : graph_->nodes()) {
+    pending[n->id()] = n->in_edges().size();
+  }
+  while (!ready.empty()) {
+    const Node* n = ready.front();
+    ready.pop_front();
+    if (!n->IsSink()) static_plan_.push_back(n->id());
+    for (const Edge* e : n->out_edges()) {
+      if (--pending[e->dst()->id()] == 0) ready.push_back(e->dst());
+    }
+  }
+}
+
 Status GraphView::SetAllocAttrs(const Graph* g, const Device* device) {
   Status s;
   DeviceNameUtils::ParsedName local_dev_name = device->parsed_name();
@@ -783,6 +977,20 @@ Status InferAllocAttr(const Node* n, const Node* dst,
   return s;
 }
 
+// When ExecutorOptions::inline_cost_threshold_usecs is set, node costs are
+// measured on every step that collects step stats and on one in this many
+// of the other steps.
+const int64 kNodeCostSampleInterval = 100;
+
+// The work-stealing lane, if any, that the current thread is draining.
+// Set by ExecutorState::RunLane() for the duration of the drain, so that
+// nodes readied by that thread are queued on its own lane.
+struct CurrentLane {
+  const void* state;
+  int lane;
+};
+thread_local CurrentLane current_lane = {nullptr, -1};
+
 // The state associated with one invocation of ExecutorImpl::Run.
 // ExecutorState dispatches nodes when they become ready and keeps
 // track of how many predecessors of a node have not done (pending_).
@@ -1170,6 +1378,16 @@ class ExecutorState {
     int front_index_;
   };
 
+  // One work-stealing lane. The thread draining a lane pops from the back
+  // (the most recently readied nodes, whose inputs are likely still in its
+  // cache) and other threads steal from the front.
+  struct ReadyLane {
+    mutex mu;
+    std::deque<std::pair<TaggedNode, int64>> nodes GUARDED_BY(mu);
+    // True while some thread is running RunLane() for this lane.
+    std::atomic<bool> active{false};
+  };
+
   struct AsyncState;
 
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
@@ -1184,7 +1402,12 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  StepArena* step_arena_;
   StepStatsCollector* stats_collector_;
+  const bool collect_cpu_counters_;
+  // Set on steps sampled by ExecutorOptions::sampled_profiling_step_period
+  // that do not collect StepStats.
+  SampledStepProfile* const sampled_profile_;
   // QUESTION: Make it a checkpoint::TensorSliceReaderCacheWrapper
   // instead of a pointer?  (avoids having to delete).
   checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache_;
@@ -1194,8 +1417,27 @@ class ExecutorState {
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
 
+  // True if this step measures the compute time of synchronous kernels for
+  // ExecutorImpl::IsExpensive().
+  bool measure_costs_ = false;
+
   // Owned.
 
+  // Work-stealing lanes, or nullptr if nodes are dispatched to runner_
+  // directly. See LocalExecutorParams::num_work_stealing_lanes.
+  const int num_lanes_;
+  std::unique_ptr<ReadyLane[]> lanes_;
+
+  // The number of nodes queued over all lanes.
+  std::atomic<int64> num_lane_nodes_{0};
+
+  // Used to spread nodes readied by threads that do not drain a lane.
+  std::atomic<uint32> next_lane_{0};
+
+  // One reference for the step itself plus one per running RunLane().
+  // Finish() is called when the last reference is dropped.
+  std::atomic<int> lane_refs_{1};
+
   // A flag that is set on error after the frame state has been
   // dumped for diagnostic purposes.
   bool dumped_on_error_ = false;
@@ -1240,6 +1482,16 @@ class ExecutorState {
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64 scheduled_usec);
 
+  // Runs every node of ExecutorImpl::static_plan_, in order, in the current
+  // thread, then finishes the step.
+  void RunStaticPlan();
+
+  // Fills in the fields of "params" that are the same for every node of the
+  // step, pointing its input vectors at the given ones.
+  void InitParams(OpKernelContext::Params* params, TensorValueVec* inputs,
+                  DeviceContextVec* input_device_contexts,
+                  AllocatorAttributeVec* input_alloc_attrs);
+
   // Before invoking item->kernel, fills in its "inputs".
   Status PrepareInputs(const NodeItem& item, Entry* first_input,
                        TensorValueVec* inputs,
@@ -1268,6 +1520,24 @@ class ExecutorState {
   void ScheduleReady(const TaggedNodeSeq& ready,
                      TaggedNodeReadyQueue* inline_ready);
 
+  // Processes each of "nodes" in turn on the current thread.
+  void ProcessBatch(const TaggedNodeSeq& nodes, int64 scheduled_usec);
+
+  // Runs "node" on another thread: through runner_, or by queueing it on a
+  // work-stealing lane if lanes are enabled.
+  void Dispatch(const TaggedNode& node, int64 scheduled_usec);
+
+  // Queues "node" on the current thread's lane (or on some lane if the
+  // current thread is not draining one) and wakes an idle lane, if any.
+  void EnqueueOnLane(const TaggedNode& node, int64 scheduled_usec);
+
+  // Pops a node from lane "lane", or steals one from another lane if it is
+  // empty. Returns false if all lanes are empty.
+  bool PopFromLanes(int lane, TaggedNode* node, int64* scheduled_usec);
+
+  // Drains lane "lane" on the current thread until no queued nodes remain.
+  void RunLane(int lane);
+
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter, int64 id);
 
@@ -1286,6 +1556,9 @@ class ExecutorState {
   // Clean up when this executor is done.
   void Finish();
 
+  // Drops one of lane_refs_, and calls Finish() if it was the last one.
+  void MaybeFinish();
+
   // A standalone routine for this expression so that we can express
   // that we don't want thread safety analysis on this reference (it's
   // safe to do without the lock because the iterations array never
@@ -1305,14 +1578,27 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       session_state_(args.session_state),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      step_arena_(args.step_arena),
       stats_collector_(args.stats_collector),
+      collect_cpu_counters_(args.stats_collector != nullptr &&
+                            args.collect_cpu_counters),
+      sampled_profile_(args.stats_collector ? nullptr : args.sampled_profile),
       slice_reader_cache_(new checkpoint::TensorSliceReaderCacheWrapper),
       call_frame_(args.call_frame),
       impl_(impl),
       cancellation_manager_(args.cancellation_manager),
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
+      num_lanes_(impl->params_.num_work_stealing_lanes),
       num_outstanding_ops_(0) {
+  if (num_lanes_ > 0) {
+    lanes_.reset(new ReadyLane[num_lanes_]);
+  }
+  if (impl->node_cost_usecs_ != nullptr) {
+    const int64 step = impl->num_steps_started_.fetch_add(1);
+    measure_costs_ = stats_collector_ != nullptr ||
+                     step % kNodeCostSampleInterval == 0;
+  }
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
   // We assume root_frame_->frame_name.empty().
@@ -1433,6 +1719,12 @@ void ExecutorState::RunAsync(Executor::DoneCallback done) {
     return;
   }
 
+  if (!impl_->static_plan_.empty()) {
+    done_cb_ = std::move(done);
+    runner_(std::bind(&ExecutorState::RunStaticPlan, this));
+    return;
+  }
+
   // Initialize the ready queue.
   for (const Node* n : impl_->root_nodes_) {
     DCHECK_EQ(n->in_edges().size(), 0);
@@ -1506,25 +1798,14 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
   AllocatorAttributeVec input_alloc_attrs;
 
   OpKernelContext::Params params;
-  params.step_id = step_id_;
   Device* device = impl_->params_.device;
-  params.device = device;
-  params.log_memory = log_memory_;
-  params.record_tensor_accesses = impl_->device_record_tensor_accesses_;
-  params.rendezvous = rendezvous_;
-  params.session_state = session_state_;
-  params.tensor_store = tensor_store_;
-  params.cancellation_manager = cancellation_manager_;
-  params.call_frame = call_frame_;
-  params.function_library = impl_->params_.function_library;
-  params.resource_manager = device->resource_manager();
-  params.step_container = step_container_;
-  params.slice_reader_cache = slice_reader_cache_;
-  params.inputs = &inputs;
-  params.input_device_contexts = &input_device_contexts;
-  params.input_alloc_attrs = &input_alloc_attrs;
-  params.runner = &runner_;
-  params.stats_collector = stats_collector_;
+  InitParams(&params, &inputs, &input_device_contexts, &input_alloc_attrs);
+
+  // Only the first node was handed to this thread; the others become ready
+  // on it.
+  if (scheduled_usec > 0) {
+    impl_->ready_to_start_cell_->Add(nodestats::NowInUsec() - scheduled_usec);
+  }
 
   Status s;
   NodeExecStatsWrapper* stats = nullptr;
@@ -1603,6 +1884,9 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
       params.frame_iter = FrameAndIter(input_frame->frame_id, input_iter);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
+      if (step_arena_ != nullptr) {
+        params.step_arena_allocator = step_arena_->NodeAllocator(id);
+      }
 
       if (item.kernel_is_async) {
         // Asynchronous computes.
@@ -1654,15 +1938,32 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
           const bool completed =
               NodeDone(s, state->item->node, ready, stats, nullptr);
           delete state;
-          if (completed) Finish();
+          if (completed) MaybeFinish();
         };
         nodestats::SetOpStart(stats);
+        ScopedMemoryAnnotation annotation(item.memory_annotation);
         device->ComputeAsync(async, &state->ctx, done);
       } else {
         // Synchronous computes.
         OpKernelContext ctx(&params, item.num_outputs);
         nodestats::SetOpStart(stats);
-        device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        const bool sample_latency =
+            sampled_profile_ != nullptr && sampled_profile_->ShouldTime(id);
+        const int64 compute_start_usec =
+            measure_costs_ || sample_latency ? nodestats::NowInUsec() : 0;
+        {
+          ScopedMemoryAnnotation annotation(item.memory_annotation);
+          nodestats::ScopedCPUCounters counters(stats, collect_cpu_counters_);
+          device->Compute(CHECK_NOTNULL(op_kernel), &ctx);
+        }
+        if (measure_costs_ || sample_latency) {
+          const int64 compute_usec =
+              nodestats::NowInUsec() - compute_start_usec;
+          if (measure_costs_) impl_->RecordNodeCost(id, compute_usec);
+          if (sample_latency) {
+            sampled_profile_->Record(&node->type_string(), compute_usec);
+          }
+        }
         nodestats::SetOpEnd(stats);
         s = ProcessOutputs(item, &ctx, &outputs, stats);
         if (s.ok() && impl_->device_record_tensor_accesses_) {
@@ -1706,7 +2007,155 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_usec) {
   }  // while !inline_ready.empty()
 
   // This thread of computation is done if completed = true.
-  if (completed) Finish();
+  if (completed) MaybeFinish();
+}
+
+void ExecutorState::InitParams(OpKernelContext::Params* params,
+                               TensorValueVec* inputs,
+                               DeviceContextVec* input_device_contexts,
+                               AllocatorAttributeVec* input_alloc_attrs) {
+  Device* device = impl_->params_.device;
+  params->step_id = step_id_;
+  params->device = device;
+  params->log_memory = log_memory_;
+  params->record_tensor_accesses = impl_->device_record_tensor_accesses_;
+  params->rendezvous = rendezvous_;
+  params->session_state = session_state_;
+  params->tensor_store = tensor_store_;
+  params->cancellation_manager = cancellation_manager_;
+  params->call_frame = call_frame_;
+  params->function_library = impl_->params_.function_library;
+  params->resource_manager = device->resource_manager();
+  params->step_container = step_container_;
+  params->slice_reader_cache = slice_reader_cache_;
+  params->inputs = inputs;
+  params->input_device_contexts = input_device_contexts;
+  params->input_alloc_attrs = input_alloc_attrs;
+  params->runner = &runner_;
+  params->stats_collector = stats_collector_;
+}
+
+void ExecutorState::RunStaticPlan() {
+  const GraphView& gview = impl_->gview_;
+  Device* device = impl_->params_.device;
+  TensorValueVec inputs;
+  DeviceContextVec input_device_contexts;
+  AllocatorAttributeVec input_alloc_attrs;
+  OpKernelContext::Params params;
+  InitParams(&params, &inputs, &input_device_contexts, &input_alloc_attrs);
+  params.frame_iter = FrameAndIter(root_frame_->frame_id, 0);
+
+  // There is no control flow, so every node runs in iteration 0 of the root
+  // frame and every input it needs has been produced by an earlier node.
+  Entry* input_tensors = GetInputTensors(root_frame_, 0);
+  EntryVector outputs;
+  for (const int id : impl_->static_plan_) {
+    const NodeItem& item = *gview.node(id);
+    const Node* node = item.node;
+    if (id < device_context_map_.size()) {
+      params.op_device_context = device_context_map_[id];
+    }
+    params.track_allocations = false;
+    NodeExecStatsWrapper* stats = nullptr;
+    if (stats_collector_) {
+      params.track_allocations = true;
+      stats = new NodeExecStatsWrapper;
+      stats->stats()->set_node_name(node->name());
+      nodestats::SetAllStart(stats);
+      nodestats::SetScheduled(stats, stats->stats()->all_start_micros());
+    }
+    if (vlog_) {
+      VLOG(1) << "Process node: " << id << " step " << step_id_ << " "
+              << SummarizeNode(*node) << " (static plan)";
+    }
+
+    Entry* first_input = input_tensors + item.input_start;
+    bool is_input_dead = false;
+    TensorReferenceVector accessed_tensors;
+    DeviceContext* device_context = nullptr;
+    Status s = PrepareInputs(item, first_input, &inputs,
+                             &input_device_contexts, &input_alloc_attrs,
+                             &is_input_dead);
+    if (s.ok()) {
+      params.op_kernel = item.kernel;
+      params.is_input_dead = is_input_dead;
+      params.output_attr_array = item.output_attrs();
+      if (step_arena_ != nullptr) {
+        params.step_arena_allocator = step_arena_->NodeAllocator(id);
+      }
+      OpKernelContext ctx(&params, item.num_outputs);
+      nodestats::SetOpStart(stats);
+      const bool sample_latency =
+          sampled_profile_ != nullptr && sampled_profile_->ShouldTime(id);
+      const int64 compute_start_usec =
+          sample_latency ? nodestats::NowInUsec() : 0;
+      {
+        ScopedMemoryAnnotation annotation(item.memory_annotation);
+        nodestats::ScopedCPUCounters counters(stats, collect_cpu_counters_);
+        device->Compute(CHECK_NOTNULL(item.kernel), &ctx);
+      }
+      if (sample_latency) {
+        sampled_profile_->Record(&node->type_string(),
+                                 nodestats::NowInUsec() - compute_start_usec);
+      }
+      nodestats::SetOpEnd(stats);
+      s = ProcessOutputs(item, &ctx, &outputs, stats);
+      if (s.ok() && impl_->device_record_tensor_accesses_) {
+        ctx.retrieve_accessed_tensors(&accessed_tensors);
+        device_context = ctx.op_device_context();
+      }
+      nodestats::SetMemory(stats, &ctx);
+    }
+
+    // Clears inputs.
+    for (int i = 0; i < item.num_inputs; ++i) {
+      (first_input + i)->ClearVal();
+    }
+    // Hands the outputs to their consumers, all of which run later.
+    if (s.ok()) {
+      const EdgeInfo* edges = item.output_edge_list();
+      for (size_t i = 0; i < item.num_output_edges; ++i) {
+        const EdgeInfo& e = edges[i];
+        const NodeItem* dst_item = gview.node(e.dst_id);
+        if (dst_item->is_sink || e.output_slot == Graph::kControlSlot) {
+          continue;
+        }
+        const int dst_loc = dst_item->input_start + e.input_slot;
+        if (e.is_last) {
+          input_tensors[dst_loc] = std::move(outputs[e.output_slot]);
+        } else {
+          input_tensors[dst_loc] = outputs[e.output_slot];
+        }
+      }
+    }
+    outputs.clear();
+    if (!accessed_tensors.empty()) {
+      nodestats::SetReferencedTensors(stats, accessed_tensors);
+      device->ConsumeListOfAccessedTensors(device_context, accessed_tensors);
+    }
+
+    nodestats::SetAllEnd(stats);
+    if (stats_collector_ != nullptr && !SetTimelineLabel(node, stats)) {
+      stats_collector_->Save(device->name(), stats);
+    } else {
+      delete stats;
+    }
+
+    if (!s.ok()) {
+      {
+        mutex_lock l(mu_);
+        status_ = s;
+      }
+      if (rendezvous_) {
+        rendezvous_->StartAbort(s);
+      }
+      if (cancellation_manager_) {
+        cancellation_manager_->StartCancel();
+      }
+      break;
+    }
+  }
+  MaybeFinish();
 }
 
 Status ExecutorState::PrepareInputs(const NodeItem& item, Entry* first_input,
@@ -2078,30 +2527,53 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
                                   TaggedNodeReadyQueue* inline_ready) {
   if (ready.empty()) return;
 
-  int64 scheduled_usec = 0;
-  if (stats_collector_) {
-    scheduled_usec = nodestats::NowInUsec();
-  }
+  // The scheduling metrics are always collected, so the time a node is ready
+  // is too.
+  const int64 scheduled_usec = nodestats::NowInUsec();
+  impl_->queue_length_cell_->Add(queued_nodes_cell->value());
+  const GraphView& gview = impl_->gview_;
   if (inline_ready == nullptr) {
-    // Schedule to run all the ready ops in thread pool.
+    if (impl_->node_cost_usecs_ == nullptr || lanes_ != nullptr) {
+      // Schedule to run all the ready ops in thread pool.
+      for (auto& tagged_node : ready) {
+        Dispatch(tagged_node, scheduled_usec);
+      }
+      return;
+    }
+    // Run the inexpensive nodes together in a single closure, and give each
+    // expensive node a closure of its own.
+    TaggedNodeSeq inexpensive;
     for (auto& tagged_node : ready) {
-      runner_([=]() { Process(tagged_node, scheduled_usec); });
+      const NodeItem& item = *gview.node(tagged_node.node->id());
+      if (tagged_node.is_dead || !impl_->IsExpensive(item)) {
+        inexpensive.push_back(tagged_node);
+      } else {
+        Dispatch(tagged_node, scheduled_usec);
+      }
+    }
+    if (inexpensive.size() == 1) {
+      Dispatch(inexpensive[0], scheduled_usec);
+    } else if (!inexpensive.empty()) {
+      queued_nodes_cell->IncrementBy(inexpensive.size());
+      impl_->dispatched_nodes_cell_->IncrementBy(inexpensive.size());
+      runner_(std::bind(&ExecutorState::ProcessBatch, this,
+                        std::move(inexpensive), scheduled_usec));
     }
     return;
   }
-  const GraphView& gview = impl_->gview_;
+  int64 num_inline = 0;
   const TaggedNode* curr_expensive_node = nullptr;
   for (auto& tagged_node : ready) {
     const NodeItem& item = *gview.node(tagged_node.node->id());
-    if (tagged_node.is_dead || !item.kernel_is_expensive) {
+    if (tagged_node.is_dead || !impl_->IsExpensive(item)) {
       // Inline this inexpensive node.
       inline_ready->push_back(tagged_node);
+      ++num_inline;
     } else {
       if (curr_expensive_node) {
         // Dispatch to another thread since there is plenty of work to
         // do for this thread.
-        runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_usec));
+        Dispatch(*curr_expensive_node, scheduled_usec);
       }
       curr_expensive_node = &tagged_node;
     }
@@ -2110,13 +2582,116 @@ void ExecutorState::ScheduleReady(const TaggedNodeSeq& ready,
     if (inline_ready->empty()) {
       // Tail recursion optimization
       inline_ready->push_back(*curr_expensive_node);
+      ++num_inline;
     } else {
       // There are inline nodes to run already. We dispatch this expensive
       // node to other thread.
-      runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                        scheduled_usec));
+      Dispatch(*curr_expensive_node, scheduled_usec);
     }
   }
+  impl_->inline_nodes_cell_->IncrementBy(num_inline);
+}
+
+void ExecutorState::ProcessBatch(const TaggedNodeSeq& nodes,
+                                 int64 scheduled_usec) {
+  // Every node in "nodes" is outstanding until it is processed, so the step
+  // cannot complete (and delete this ExecutorState) before the last one.
+  for (const TaggedNode& node : nodes) {
+    queued_nodes_cell->IncrementBy(-1);
+    Process(node, scheduled_usec);
+  }
+}
+
+void ExecutorState::Dispatch(const TaggedNode& node, int64 scheduled_usec) {
+  impl_->dispatched_nodes_cell_->IncrementBy(1);
+  if (lanes_ == nullptr) {
+    queued_nodes_cell->IncrementBy(1);
+    runner_([this, node, scheduled_usec]() {
+      queued_nodes_cell->IncrementBy(-1);
+      Process(node, scheduled_usec);
+    });
+  } else {
+    EnqueueOnLane(node, scheduled_usec);
+  }
+}
+
+void ExecutorState::EnqueueOnLane(const TaggedNode& node,
+                                  int64 scheduled_usec) {
+  int lane;
+  if (current_lane.state == this) {
+    lane = current_lane.lane;
+  } else {
+    lane = next_lane_.fetch_add(1, std::memory_order_relaxed) % num_lanes_;
+  }
+  {
+    mutex_lock l(lanes_[lane].mu);
+    lanes_[lane].nodes.emplace_back(node, scheduled_usec);
+  }
+  num_lane_nodes_.fetch_add(1);
+  queued_nodes_cell->IncrementBy(1);
+
+  // Start a thread on the target lane if it is idle, otherwise on some other
+  // idle lane, which will steal the node. If every lane is active, one of
+  // them picks the node up before it goes idle (see RunLane()).
+  for (int i = 0; i < num_lanes_; ++i) {
+    const int l = (lane + i) % num_lanes_;
+    if (!lanes_[l].active.load() && !lanes_[l].active.exchange(true)) {
+      lane_refs_.fetch_add(1, std::memory_order_relaxed);
+      runner_(std::bind(&ExecutorState::RunLane, this, l));
+      break;
+    }
+  }
+}
+
+bool ExecutorState::PopFromLanes(int lane, TaggedNode* node,
+                                 int64* scheduled_usec) {
+  {
+    ReadyLane* own = &lanes_[lane];
+    mutex_lock l(own->mu);
+    if (!own->nodes.empty()) {
+      *node = own->nodes.back().first;
+      *scheduled_usec = own->nodes.back().second;
+      own->nodes.pop_back();
+      num_lane_nodes_.fetch_sub(1);
+      queued_nodes_cell->IncrementBy(-1);
+      return true;
+    }
+  }
+  for (int i = 1; i < num_lanes_; ++i) {
+    if (num_lane_nodes_.load(std::memory_order_relaxed) <= 0) break;
+    ReadyLane* victim = &lanes_[(lane + i) % num_lanes_];
+    mutex_lock l(victim->mu);
+    if (!victim->nodes.empty()) {
+      *node = victim->nodes.front().first;
+      *scheduled_usec = victim->nodes.front().second;
+      victim->nodes.pop_front();
+      num_lane_nodes_.fetch_sub(1);
+      queued_nodes_cell->IncrementBy(-1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ExecutorState::RunLane(int lane) {
+  const CurrentLane saved_lane = current_lane;
+  current_lane = {this, lane};
+  TaggedNode node(nullptr, nullptr, -1, false);
+  int64 scheduled_usec = 0;
+  for (;;) {
+    while (PopFromLanes(lane, &node, &scheduled_usec)) {
+      Process(node, scheduled_usec);
+    }
+    lanes_[lane].active.store(false);
+    // A node queued after the last pop may have found this lane still
+    // active and started no thread for it, so look again before leaving,
+    // unless another thread has already re-activated the lane.
+    if (num_lane_nodes_.load() <= 0 || lanes_[lane].active.exchange(true)) {
+      break;
+    }
+  }
+  current_lane = saved_lane;
+  MaybeFinish();
 }
 
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
@@ -2268,6 +2843,12 @@ void ExecutorState::Finish() {
   runner([=]() { done_cb(status); });
 }
 
+void ExecutorState::MaybeFinish() {
+  if (lane_refs_.fetch_sub(1) == 1) {
+    Finish();
+  }
+}
+
 void ExecutorState::FindOrCreateChildFrame(FrameState* frame, int64 iter,
                                            const Node* node,
                                            FrameState** child) {
@@ -2599,6 +3180,17 @@ void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
 
 }  // end namespace
 
+int NumWorkStealingLanes(const ExecutorOptions& options,
+                         int num_inter_op_threads) {
+  if (options.scheduling_policy() != ExecutorOptions::WORK_STEALING) {
+    return 0;
+  }
+  if (options.num_work_stealing_lanes() > 0) {
+    return options.num_work_stealing_lanes();
+  }
+  return std::max(1, num_inter_op_threads);
+}
+
 Status NewLocalExecutor(const LocalExecutorParams& params, const Graph* graph,
                         Executor** executor) {
   ExecutorImpl* impl = new ExecutorImpl(params, graph);
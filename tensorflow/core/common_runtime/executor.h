@@ -25,10 +25,16 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
 
+class SampledStepProfile;
+class StepArena;
 class StepStatsCollector;
+namespace thread {
+class ThreadPool;
+}  // namespace thread
 
 // Executor runs a graph computation.
 // Example:
@@ -80,15 +86,25 @@ class Executor {
   //
   // RunAsync() dispatches closures to "runner". Typically, "runner"
   // is backed up by a bounded threadpool.
+  //
+  // RunAsync() uses "step_arena", if not nullptr, to allocate the memory
+  // that kernels request with the default allocator attributes.
   struct Args {
     int64 step_id = 0;
     Rendezvous* rendezvous = nullptr;
     StepStatsCollector* stats_collector = nullptr;
+    // If true, the hardware counters of the synchronous kernels are recorded
+    // with their stats. Ignored when 'stats_collector' is not set.
+    bool collect_cpu_counters = false;
+    // If not null, the latencies of the kernels it selects are recorded
+    // into it. Ignored when 'stats_collector' is set.
+    SampledStepProfile* sampled_profile = nullptr;
     CallFrameInterface* call_frame = nullptr;
     CancellationManager* cancellation_manager = nullptr;
     SessionState* session_state = nullptr;
     TensorStore* tensor_store = nullptr;
     ScopedStepContainer* step_container = nullptr;
+    StepArena* step_arena = nullptr;
 
     // If true, calls Sync() on the device.
     bool sync_on_finish = false;
@@ -140,11 +156,40 @@ struct LocalExecutorParams {
   std::function<Status(const NodeDef&, OpKernel**)> create_kernel;
   std::function<void(OpKernel*)> delete_kernel;
 
+  // If set, the kernels of stateless nodes are created concurrently on the
+  // calling thread and on the threads of this pool, so create_kernel must
+  // be thread-safe. The kernels of stateful nodes are still created one at
+  // a time in graph order on the calling thread.
+  thread::ThreadPool* create_kernel_pool = nullptr;
+
   Executor::Args::NodeOutputsCallback node_outputs_cb;
+
+  // If > 0, ready nodes of each step are scheduled on this many
+  // work-stealing lanes instead of being handed to Args::runner one closure
+  // at a time. See ExecutorOptions::WORK_STEALING in config.proto.
+  int num_work_stealing_lanes = 0;
+
+  // If > 0, the executor samples the compute time of its nodes, and nodes
+  // measured below this many microseconds run inline on the thread that
+  // made them ready, whatever OpKernel::IsExpensive() says. See
+  // ExecutorOptions::inline_cost_threshold_usecs in config.proto.
+  int64 inline_cost_threshold_usecs = 0;
+
+  // If true and the graph has no control flow and no asynchronous kernels,
+  // the executor computes a topological order of the graph once and every
+  // step runs the nodes in that order on a single thread, without pending
+  // counts. See ExecutorOptions::use_static_plan in config.proto.
+  bool allow_static_plan = false;
 };
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       const Graph* graph, Executor** executor);
 
+// Returns the number of work-stealing lanes that "options" asks for, given
+// an inter-op thread pool of "num_inter_op_threads" threads. Returns 0 if
+// work stealing is disabled.
+int NumWorkStealingLanes(const ExecutorOptions& options,
+                         int num_inter_op_threads);
+
 // A class to help run multiple executors in parallel and wait until
 // all of them are complete.
 //
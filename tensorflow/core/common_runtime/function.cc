@@ -207,9 +207,40 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
     FunctionBody* func_graph = nullptr;
     Executor* exec = nullptr;
 
+    // Call frames of finished calls, kept for the next calls of this handle.
+    static const int kMaxFreeFrames = 8;
+    mutex frames_mu;
+    std::vector<FunctionCallFrame*> free_frames GUARDED_BY(frames_mu);
+
     ~Item() override {
       delete this->func_graph;
       delete this->exec;
+      for (FunctionCallFrame* frame : free_frames) delete frame;
+    }
+
+    FunctionCallFrame* GetCallFrame() {
+      {
+        mutex_lock l(frames_mu);
+        if (!free_frames.empty()) {
+          FunctionCallFrame* frame = free_frames.back();
+          free_frames.pop_back();
+          return frame;
+        }
+      }
+      return new FunctionCallFrame(func_graph->arg_types,
+                                   func_graph->ret_types);
+    }
+
+    void ReturnCallFrame(FunctionCallFrame* frame) {
+      frame->Reset();
+      {
+        mutex_lock l(frames_mu);
+        if (free_frames.size() < kMaxFreeFrames) {
+          free_frames.push_back(frame);
+          return;
+        }
+      }
+      delete frame;
     }
   };
   std::unordered_map<Handle, Item*> items_ GUARDED_BY(mu_);
@@ -614,12 +645,10 @@ void FunctionLibraryRuntimeImpl::RunRemote(const Options& opts, Handle handle,
     return;
   }
 
-  const FunctionBody* fbody = GetFunctionBody(handle);
-  FunctionCallFrame* frame =
-      new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
+  FunctionCallFrame* frame = item->GetCallFrame();
   exec_args->call_frame = frame;
   if (!s.ok()) {
-    delete frame;
+    item->ReturnCallFrame(frame);
     delete exec_args;
     done(s);
     return;
@@ -641,7 +670,7 @@ void FunctionLibraryRuntimeImpl::RunRemote(const Options& opts, Handle handle,
           s = frame->SetArgs(*remote_args);
         }
         if (!s.ok()) {
-          delete frame;
+          item->ReturnCallFrame(frame);
           delete remote_args;
           delete exec_args;
           done(s);
@@ -655,7 +684,7 @@ void FunctionLibraryRuntimeImpl::RunRemote(const Options& opts, Handle handle,
               if (s.ok()) {
                 s = frame->ConsumeRetvals(rets);
               }
-              delete frame;
+              item->ReturnCallFrame(frame);
               if (!s.ok()) {
                 delete remote_args;
                 delete exec_args;
@@ -697,52 +726,50 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
 
   DCHECK(run_opts.runner != nullptr);
 
-  Executor::Args* exec_args = new Executor::Args;
+  // The executor copies what it needs out of `exec_args`, so local calls
+  // keep it on the stack.
+  Executor::Args exec_args;
   // Inherit the step_id from the caller.
-  exec_args->step_id = run_opts.step_id;
-  exec_args->rendezvous = run_opts.rendezvous;
-  exec_args->stats_collector = run_opts.stats_collector;
-  exec_args->cancellation_manager = run_opts.cancellation_manager;
-  exec_args->step_container = run_opts.step_container;
-  exec_args->runner = *run_opts.runner;
+  exec_args.step_id = run_opts.step_id;
+  exec_args.rendezvous = run_opts.rendezvous;
+  exec_args.stats_collector = run_opts.stats_collector;
+  exec_args.cancellation_manager = run_opts.cancellation_manager;
+  exec_args.step_container = run_opts.step_container;
+  exec_args.runner = *run_opts.runner;
 
   Item* item = nullptr;
   Status s = GetOrCreateItem(handle, &item);
   if (!s.ok()) {
-    delete exec_args;
     done(s);
     return;
   }
 
   if (run_opts.remote_execution) {
     // NOTE(mrry): `RunRemote()` will set `exec_args->call_frame` for us.
-    RunRemote(run_opts, handle, args, rets, exec_args, item, done);
+    RunRemote(run_opts, handle, args, rets, new Executor::Args(exec_args),
+              item, done);
     return;
   }
 
-  const FunctionBody* fbody = GetFunctionBody(handle);
-  FunctionCallFrame* frame =
-      new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
-  exec_args->call_frame = frame;
+  FunctionCallFrame* frame = item->GetCallFrame();
+  exec_args.call_frame = frame;
   s = frame->SetArgs(args);
   if (!s.ok()) {
-    delete frame;
-    delete exec_args;
+    item->ReturnCallFrame(frame);
     done(s);
     return;
   }
 
   item->exec->RunAsync(
       // Executor args
-      *exec_args,
+      exec_args,
       // Done callback.
-      [item, frame, rets, done, exec_args](const Status& status) {
+      [item, frame, rets, done](const Status& status) {
         Status s = status;
         if (s.ok()) {
           s = frame->ConsumeRetvals(rets);
         }
-        delete frame;
-        delete exec_args;
+        item->ReturnCallFrame(frame);
         done(s);
       });
 }
@@ -783,28 +810,17 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   }
   DCHECK(run_opts.runner != nullptr);
 
-  Executor::Args* exec_args = new Executor::Args;
+  Executor::Args exec_args;
   // Inherit the step_id from the caller.
-  exec_args->step_id = run_opts.step_id;
-  exec_args->rendezvous = run_opts.rendezvous;
-  exec_args->stats_collector = run_opts.stats_collector;
-  exec_args->cancellation_manager = run_opts.cancellation_manager;
-  exec_args->step_container = run_opts.step_container;
-  exec_args->runner = *run_opts.runner;
-  exec_args->call_frame = frame;
-
-  item->exec->RunAsync(
-      // Executor args
-      *exec_args,
-      // Done callback.
-      std::bind(
-          [item, frame, exec_args](DoneCallback done,
-                                   // Start unbound arguments.
-                                   const Status& status) {
-            delete exec_args;
-            done(status);
-          },
-          std::move(done), std::placeholders::_1));
+  exec_args.step_id = run_opts.step_id;
+  exec_args.rendezvous = run_opts.rendezvous;
+  exec_args.stats_collector = run_opts.stats_collector;
+  exec_args.cancellation_manager = run_opts.cancellation_manager;
+  exec_args.step_container = run_opts.step_container;
+  exec_args.runner = *run_opts.runner;
+  exec_args.call_frame = frame;
+
+  item->exec->RunAsync(exec_args, std::move(done));
 }
 
 bool FunctionLibraryRuntimeImpl::IsStateful(const string& func) {
@@ -1216,10 +1232,30 @@ void InlineFunctionBody(const FunctionLibraryDefinition& flib_def, Graph* g,
   g->RemoveNode(caller);  // 'caller' is replaced with inlined nodes.
 }
 
-bool ExpandInlineFunctions(FunctionLibraryRuntime* lib, Graph* graph) {
+namespace {
+
+// Inlines the function calls of "graph" with at most "max_body_nodes" nodes
+// in their body, or all of them if "max_body_nodes" is negative.
+bool ExpandInlineFunctionsImpl(FunctionLibraryRuntime* lib, Graph* graph,
+                               int max_body_nodes) {
   std::vector<std::pair<Node*, const FunctionBody*>> candidates;
   const FunctionLibraryDefinition* fld = lib->GetFunctionLibraryDefinition();
   for (Node* node : graph->nodes()) {
+    // Instantiating canonicalizes the attrs of the node, so primitive ops are
+    // skipped up front when only small functions are looked for.
+    if (max_body_nodes >= 0) {
+      if (node->type_string() != kGradientOp &&
+          fld->Find(node->type_string()) == nullptr) {
+        continue;
+      }
+      // Calls that target another device keep running there.
+      const string target =
+          ProcessFunctionLibraryRuntime::ObtainFunctionTarget(node->attrs());
+      if (!target.empty() &&
+          (lib->device() == nullptr || target != lib->device()->name())) {
+        continue;
+      }
+    }
     VLOG(3) << "Expanding " << node->DebugString();
     bool noinline;
     if (fld->GetAttr(*node, kNoInlineAttr, &noinline).ok() && noinline) {
@@ -1239,6 +1275,12 @@ bool ExpandInlineFunctions(FunctionLibraryRuntime* lib, Graph* graph) {
     }
     const FunctionBody* fbody = lib->GetFunctionBody(handle);
     CHECK_NOTNULL(fbody);
+    const int body_nodes = fbody->graph->num_op_nodes() -
+                           fbody->arg_nodes.size() - fbody->ret_nodes.size();
+    if (max_body_nodes >= 0 && body_nodes > max_body_nodes) {
+      VLOG(3) << "Too large to inline: " << node->DebugString();
+      continue;
+    }
     candidates.push_back({node, fbody});
   }
   for (const auto& p : candidates) {
@@ -1247,6 +1289,17 @@ bool ExpandInlineFunctions(FunctionLibraryRuntime* lib, Graph* graph) {
   return !candidates.empty();
 }
 
+}  // namespace
+
+bool ExpandInlineFunctions(FunctionLibraryRuntime* lib, Graph* graph) {
+  return ExpandInlineFunctionsImpl(lib, graph, -1);
+}
+
+bool ExpandSmallInlineFunctions(FunctionLibraryRuntime* lib, Graph* graph,
+                                int max_body_nodes) {
+  return ExpandInlineFunctionsImpl(lib, graph, max_body_nodes);
+}
+
 string NewName(const Node* n, bool pretty) {
   if (pretty) {
     return strings::StrCat(n->type_string(), n->id());
@@ -122,6 +122,12 @@ bool RemoveListArrayConverter(Graph* g);
 // multiple times by calling ExpandInlineFunctions a few times.
 bool ExpandInlineFunctions(FunctionLibraryRuntime* lib, Graph* graph);
 
+// Like ExpandInlineFunctions, but only inlines the calls of functions whose
+// body has at most "max_body_nodes" nodes besides its arguments and return
+// values, where the call costs more than the body.
+bool ExpandSmallInlineFunctions(FunctionLibraryRuntime* lib, Graph* graph,
+                                int max_body_nodes);
+
 // Dump the contents of the "graph" to log files if the logging level is
 // sufficiently high.
 void DumpGraph(StringPiece label, const Graph* g);
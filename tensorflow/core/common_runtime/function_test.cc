@@ -365,6 +365,26 @@ TEST_F(FunctionLibraryRuntimeTest, XTimesN) {
   test::ExpectTensorEqual<float>(y, test::AsTensor<float>({16, 32, 48, 64}));
 }
 
+TEST_F(FunctionLibraryRuntimeTest, RunSameHandleRepeatedly) {
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, &handle));
+  FunctionLibraryRuntime::Options opts;
+  // Every call after the first reuses the call frame of an earlier one.
+  for (int i = 0; i < 4; ++i) {
+    auto x = test::AsTensor<float>({1.0f * i, 2.0f * i});
+    Tensor y;
+    TF_CHECK_OK(Run(flr0_, handle, opts, {x}, {&y}));
+    test::ExpectTensorEqual<float>(
+        y, test::AsTensor<float>({2.0f * i, 4.0f * i}));
+  }
+  HasError(Run(flr0_, handle, opts, {}, {}), "Expects 1 arguments");
+  auto x = test::AsTensor<float>({3, 4});
+  Tensor y;
+  TF_CHECK_OK(Run(flr0_, handle, opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({6, 8}));
+}
+
 TEST_F(FunctionLibraryRuntimeTest, ExpandInlineFunctions) {
   Init({test::function::XTimesTwo(), test::function::XTimesFour(),
         test::function::XTimes16()});
@@ -484,6 +504,33 @@ TEST_F(FunctionLibraryRuntimeTest, ExpandInlineFunctions) {
 
 // Verifies that control dependencies on the caller are added as control
 // dependencies on any function calls created by inlining.
+TEST_F(FunctionLibraryRuntimeTest, ExpandSmallInlineFunctions) {
+  Init({test::function::XTimesTwo(), test::function::XTimesFour(),
+        test::function::XTimes16()});
+  std::unique_ptr<Graph> g = GetFuncBody(flr0_, "XTimes16", {{"T", DT_FLOAT}});
+  ASSERT_TRUE(g != nullptr);
+  auto count_ops = [&g](const string& op) {
+    int count = 0;
+    for (Node* n : g->op_nodes()) {
+      if (n->type_string() == op) ++count;
+    }
+    return count;
+  };
+
+  // The body of XTimesFour is two calls of XTimesTwo.
+  EXPECT_FALSE(ExpandSmallInlineFunctions(flr0_, g.get(), 1));
+  EXPECT_EQ(2, count_ops("XTimesFour"));
+  EXPECT_TRUE(ExpandSmallInlineFunctions(flr0_, g.get(), 2));
+  EXPECT_EQ(0, count_ops("XTimesFour"));
+  EXPECT_EQ(4, count_ops("XTimesTwo"));
+
+  // The body of XTimesTwo has three nodes.
+  EXPECT_FALSE(ExpandSmallInlineFunctions(flr0_, g.get(), 2));
+  EXPECT_TRUE(ExpandSmallInlineFunctions(flr0_, g.get(), 3));
+  EXPECT_EQ(0, count_ops("XTimesTwo"));
+  EXPECT_EQ(4, count_ops("Mul"));
+}
+
 TEST_F(FunctionLibraryRuntimeTest, ExpandInlineFunctionsWithControlDeps) {
   Init({test::function::XTimesTwo(), test::function::XTimesFour()});
 
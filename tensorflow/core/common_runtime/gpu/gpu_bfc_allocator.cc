@@ -16,19 +16,34 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 
+namespace {
+
+SubAllocator* NewGPUSubAllocator(int device_id, const GPUOptions& gpu_options) {
+  if (gpu_options.allocator_type() == "MANAGED") {
+    return new GPUManagedMemAllocator(device_id);
+  }
+  return new GPUMemAllocator(
+      GPUMachineManager()->ExecutorForDevice(device_id).ValueOrDie());
+}
+
+}  // namespace
+
 GPUBFCAllocator::GPUBFCAllocator(int device_id, size_t total_memory)
     : GPUBFCAllocator(device_id, total_memory, GPUOptions()) {}
 
 GPUBFCAllocator::GPUBFCAllocator(int device_id, size_t total_memory,
                                  const GPUOptions& gpu_options)
-    : BFCAllocator(
-          new GPUMemAllocator(
-              GPUMachineManager()->ExecutorForDevice(device_id).ValueOrDie()),
-          total_memory, gpu_options.allow_growth(),
-          strings::StrCat("GPU_", device_id, "_bfc")) {}
+    : BFCAllocator(NewGPUSubAllocator(device_id, gpu_options), total_memory,
+                   gpu_options.allow_growth(),
+          strings::StrCat("GPU_", device_id, "_bfc")) {
+  if (gpu_options.bfc_allocator_thread_cache_bytes() > 0) {
+    EnableThreadCache(gpu_options.bfc_allocator_thread_cache_bytes());
+  }
+}
 
 }  // namespace tensorflow
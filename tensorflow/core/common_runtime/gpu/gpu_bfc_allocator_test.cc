@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/framework/memory_annotation.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
@@ -184,6 +185,154 @@ TEST(GPUBFCAllocatorTest, AllocatedVsRequested) {
   a.DeallocateRaw(t1);
 }
 
+TEST(GPUBFCAllocatorTest, ThreadCache) {
+  // Configure a 1MiB byte limit, with up to 64KiB cached per thread.
+  GPUOptions options;
+  options.set_bfc_allocator_thread_cache_bytes(1 << 16);
+  GPUBFCAllocator a(0, 1 << 20, options);
+
+  // Frees are buffered until 32 of them have been made, and then the small
+  // chunks go to this thread's cache.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 32; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 1024));
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(32, stats.num_allocs);
+
+  // Allocations that round up to the same size reuse the cached chunks.
+  std::sort(ptrs.begin(), ptrs.end());
+  std::vector<void*> reused;
+  for (int i = 0; i < 32; ++i) {
+    void* p = a.AllocateRaw(1, 1000);
+    EXPECT_TRUE(std::binary_search(ptrs.begin(), ptrs.end(), p));
+    EXPECT_EQ(1024, a.RequestedSize(p));
+    reused.push_back(p);
+  }
+  a.GetStats(&stats);
+  EXPECT_EQ(32 * 1024, stats.bytes_in_use);
+  EXPECT_EQ(64, stats.num_allocs);
+  for (void* p : reused) {
+    a.DeallocateRaw(p);
+  }
+
+  // The cached chunks go back to the bins when an allocation needs them.
+  void* big = a.AllocateRaw(1, (1 << 20) - 256);
+  EXPECT_NE(nullptr, big);
+  a.DeallocateRaw(big);
+}
+
+TEST(GPUBFCAllocatorTest, Timeline) {
+  GPUBFCAllocator a(0, 1 << 20);
+  const int64 cursor = a.StartTimeline();
+  EXPECT_EQ(0, cursor);
+
+  // Leave a 1KiB hole between two allocations, then allocate a larger
+  // chunk that does not fit in it.
+  void* p1 = a.AllocateRaw(1, 1024);
+  void* p2 = a.AllocateRaw(1, 1024);
+  void* p3 = a.AllocateRaw(1, 1024);
+  a.DeallocateRaw(p2);
+  void* p4 = a.AllocateRaw(1, 4096);
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p3);
+  a.DeallocateRaw(p4);
+
+  AllocatorTimeline timeline;
+  a.StopTimeline(cursor, &timeline);
+  EXPECT_EQ(a.Name(), timeline.allocator_name());
+  EXPECT_EQ(0, timeline.num_dropped_events());
+
+  std::vector<AllocatorTimelineEvent::Type> expected_types = {
+      AllocatorTimelineEvent::EXTEND,   AllocatorTimelineEvent::SPLIT,
+      AllocatorTimelineEvent::ALLOCATE, AllocatorTimelineEvent::SPLIT,
+      AllocatorTimelineEvent::ALLOCATE, AllocatorTimelineEvent::SPLIT,
+      AllocatorTimelineEvent::ALLOCATE, AllocatorTimelineEvent::DEALLOCATE,
+      AllocatorTimelineEvent::SPLIT,    AllocatorTimelineEvent::ALLOCATE};
+  ASSERT_LE(expected_types.size(), timeline.events_size());
+  for (int i = 0; i < expected_types.size(); ++i) {
+    EXPECT_EQ(expected_types[i], timeline.events(i).type()) << i;
+  }
+  const AllocatorTimelineEvent& last = timeline.events(
+      timeline.events_size() - 1);
+  EXPECT_EQ(AllocatorTimelineEvent::DEALLOCATE, last.type());
+  EXPECT_EQ(4096, last.bytes());
+  EXPECT_EQ(0, last.bytes_in_use());
+  EXPECT_EQ(1 << 20, last.largest_free_bytes());
+
+  // At the peak the 1KiB hole is the only free memory outside of the
+  // largest free chunk.
+  const int64 peak = 1024 + 1024 + 4096;
+  const double fragmentation = 1024.0 / ((1 << 20) - peak);
+  EXPECT_EQ(peak, timeline.peak_bytes_in_use());
+  EXPECT_NEAR(fragmentation, timeline.fragmentation_at_peak(), 1e-9);
+
+  AllocatorStats stats;
+  a.GetStats(&stats);
+  EXPECT_EQ(1 << 20, stats.bytes_reserved);
+  EXPECT_EQ(1, stats.num_region_extensions);
+  EXPECT_EQ(4, stats.num_chunk_splits);
+  EXPECT_EQ(stats.num_chunk_splits, stats.num_chunk_merges);
+  EXPECT_NEAR(fragmentation, stats.fragmentation_at_peak, 1e-9);
+
+  // Events are only recorded while a timeline is started.
+  a.DeallocateRaw(a.AllocateRaw(1, 1024));
+  const int64 next = a.StartTimeline();
+  EXPECT_EQ(cursor + timeline.events_size(), next);
+  AllocatorTimeline empty;
+  a.StopTimeline(next, &empty);
+  EXPECT_EQ(0, empty.events_size());
+}
+
+TEST(GPUBFCAllocatorTest, LiveAtPeak) {
+  GPUBFCAllocator a(0, 1 << 20);
+  void* unattributed = a.AllocateRaw(1, 256);
+  const int64 cursor = a.StartTimeline();
+
+  void* p1;
+  void* p2;
+  void* p3;
+  {
+    ScopedMemoryAnnotation annotation(MemoryAnnotation::Intern("a"));
+    p1 = a.AllocateRaw(1, 1024);
+    p2 = a.AllocateRaw(1, 2048);
+  }
+  {
+    ScopedMemoryAnnotation annotation(MemoryAnnotation::Intern("b"));
+    p3 = a.AllocateRaw(1, 4096);
+  }
+  a.DeallocateRaw(p2);
+  void* p4;
+  {
+    // Allocated after the peak, so not live at it.
+    ScopedMemoryAnnotation annotation(MemoryAnnotation::Intern("b"));
+    p4 = a.AllocateRaw(1, 1024);
+  }
+  a.DeallocateRaw(p1);
+
+  AllocatorTimeline timeline;
+  a.StopTimeline(cursor, &timeline);
+  EXPECT_EQ(256 + 1024 + 2048 + 4096, timeline.peak_bytes_in_use());
+  ASSERT_EQ(3, timeline.live_at_peak_size());
+  EXPECT_EQ("b", timeline.live_at_peak(0).op_name());
+  EXPECT_EQ(4096, timeline.live_at_peak(0).bytes());
+  EXPECT_EQ(1, timeline.live_at_peak(0).num_allocations());
+  EXPECT_EQ("a", timeline.live_at_peak(1).op_name());
+  EXPECT_EQ(1024 + 2048, timeline.live_at_peak(1).bytes());
+  EXPECT_EQ(2, timeline.live_at_peak(1).num_allocations());
+  EXPECT_EQ("", timeline.live_at_peak(2).op_name());
+  EXPECT_EQ(256, timeline.live_at_peak(2).bytes());
+
+  a.DeallocateRaw(p3);
+  a.DeallocateRaw(p4);
+  a.DeallocateRaw(unattributed);
+}
+
 TEST(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   // Configure a 1MiB byte limit
   GPUBFCAllocator a(0, 1 << 20);
@@ -196,6 +345,20 @@ TEST(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   a.DeallocateRaw(first_ptr);
 }
 
+TEST(GPUBFCAllocatorTest, ManagedMemoryIsHostAccessible) {
+  GPUOptions options;
+  options.set_allocator_type("MANAGED");
+  GPUBFCAllocator a(0, 1 << 20, options);
+
+  // Unified memory can be written and read without explicit copies.
+  int* ptr = a.Allocate<int>(1 << 10);
+  ASSERT_NE(nullptr, ptr);
+  for (int i = 0; i < (1 << 10); ++i) ptr[i] = i;
+  for (int i = 0; i < (1 << 10); ++i) EXPECT_EQ(i, ptr[i]);
+  CheckStats(&a, 1, 4096, 4096, 4096);
+  a.DeallocateRaw(ptr);
+}
+
 TEST(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   GPUOptions options;
   options.set_allow_growth(true);
@@ -320,6 +483,66 @@ static void BM_AllocationThreaded(int iters, int num_threads) {
 }
 BENCHMARK(BM_AllocationThreaded)->Arg(1)->Arg(4)->Arg(16);
 
+// Measures the throughput of small allocations made and freed on many
+// threads at once, with and without thread caches.
+static void BM_AllocationThreadedSmall(int iters, int num_threads,
+                                       int thread_cache) {
+  testing::StopTiming();
+  GPUOptions options;
+  if (thread_cache) {
+    options.set_bfc_allocator_thread_cache_bytes(1 << 20);
+  }
+  GPUBFCAllocator a(0, 1uLL << 33, options);
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+  std::atomic_int_fast32_t count(iters);
+  mutex done_lock;
+  condition_variable done;
+  bool done_flag = false;
+  testing::ItemsProcessed(static_cast<int64>(iters));
+  testing::StartTiming();
+
+  for (int t = 0; t < num_threads; t++) {
+    pool.Schedule([&a, &count, &done_lock, &done, &done_flag, iters]() {
+      // Keep a few allocations outstanding, as kernels do with their
+      // inputs and outputs.
+      std::vector<int> sizes = {256, 1024, 4096, 512, 2048, 256, 768};
+      void* ptrs[4] = {nullptr, nullptr, nullptr, nullptr};
+      int size_index = 0;
+      for (int i = 0; i < iters; i++) {
+        void*& slot = ptrs[i % 4];
+        if (slot != nullptr) a.DeallocateRaw(slot);
+        slot = a.AllocateRaw(1, sizes[size_index++ % sizes.size()]);
+        const int64 remaining = count.fetch_sub(1);
+        if (remaining <= 1) {
+          if (remaining == 1) {
+            mutex_lock l(done_lock);
+            done_flag = true;
+            done.notify_all();
+          }
+          break;
+        }
+      }
+      for (void* p : ptrs) {
+        if (p != nullptr) a.DeallocateRaw(p);
+      }
+    });
+  }
+  {
+    mutex_lock l(done_lock);
+    if (!done_flag) {
+      done.wait(l);
+    }
+  }
+  testing::StopTiming();
+}
+BENCHMARK(BM_AllocationThreadedSmall)
+    ->ArgPair(1, 0)
+    ->ArgPair(4, 0)
+    ->ArgPair(16, 0)
+    ->ArgPair(1, 1)
+    ->ArgPair(4, 1)
+    ->ArgPair(16, 1);
+
 // A more complex benchmark that defers deallocation of an object for
 // "delay" allocations.
 static void BM_AllocationDelayed(int iters, int delay) {
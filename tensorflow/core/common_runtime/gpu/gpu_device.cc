@@ -212,7 +212,25 @@ class BaseGPUDevice::StreamGroupFactory {
       group->device_to_device = new gpu::Stream(executor);
       group->device_to_device->Init();
       VLOG(2) << "Created device_to_device_stream[" << stream_group_within_gpu
-              << "] = " << group->device_to_host;
+              << "] = " << group->device_to_device;
+
+      group->small_host_to_device = new gpu::Stream(executor);
+      group->small_host_to_device->Init();
+      VLOG(2) << "Created small_host_to_device_stream["
+              << stream_group_within_gpu
+              << "] = " << group->small_host_to_device;
+
+      group->small_device_to_host = new gpu::Stream(executor);
+      group->small_device_to_host->Init();
+      VLOG(2) << "Created small_device_to_host_stream["
+              << stream_group_within_gpu
+              << "] = " << group->small_device_to_host;
+
+      group->small_device_to_device = new gpu::Stream(executor);
+      group->small_device_to_device->Init();
+      VLOG(2) << "Created small_device_to_device_stream["
+              << stream_group_within_gpu
+              << "] = " << group->small_device_to_device;
     }
     return group;
   }
@@ -247,6 +265,8 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
       cpu_allocator_(cpu_allocator),
       gpu_id_(gpu_id),
       sync_every_op_(sync_every_op),
+      use_managed_memory_(options.config.gpu_options().allocator_type() ==
+                          "MANAGED"),
       max_streams_(max_streams) {
   ProcessState::singleton()->EnableGPUDevice();
 }
@@ -295,9 +315,11 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
           "Failed to memcopy into scratch buffer for device ", gpu_id_);
     }
 
+    const StreamGroup* group = streams_.back();
     device_contexts_.push_back(new GPUDeviceContext(
-        i, streams_.back()->compute, streams_.back()->host_to_device,
-        streams_.back()->device_to_host, streams_.back()->device_to_device));
+        i, group->compute, group->host_to_device, group->device_to_host,
+        group->device_to_device, group->small_host_to_device,
+        group->small_device_to_host, group->small_device_to_device));
   }
   gpu_device_info_ = new GpuDeviceInfo;
   gpu_device_info_->stream = streams_[0]->compute;
@@ -368,6 +390,7 @@ Status BaseGPUDevice::FillContextMap(const Graph* graph,
   const int64 before = Env::Default()->NowMicros();
   gpu_stream_util::AssignStreamsOpts opts;
   opts.max_streams = static_cast<int32>(num_streams);
+  opts.schedule_by_cost = true;
   std::unordered_map<int, int> node_to_stream_id;
   TF_RETURN_IF_ERROR(
       gpu_stream_util::AssignStreams(graph, opts, &node_to_stream_id));
@@ -472,6 +495,7 @@ void BaseGPUDevice::ComputeHelper(OpKernel* op_kernel,
     }
   }
   gpu::cuda::ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  if (use_managed_memory_) PrefetchManagedInputs(context, stream);
   op_kernel->Compute(context);
   if (context->status().ok()) {
     if (sync_every_op_) {
@@ -519,9 +543,44 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   port::Tracing::TraceMe activity(op_kernel->name(), op_kernel->type_string(),
                                   op_kernel->IsExpensive());
   gpu::cuda::ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  if (use_managed_memory_) PrefetchManagedInputs(context, stream);
   op_kernel->ComputeAsync(context, done);
 }
 
+void BaseGPUDevice::PrefetchManagedInputs(OpKernelContext* context,
+                                          gpu::Stream* stream) {
+#if CUDA_VERSION >= 8000
+  // Smaller inputs are cheaper to fault in than to prefetch.
+  static const size_t kMinPrefetchBytes = 1 << 20;
+  const cudaStream_t* cuda_stream = reinterpret_cast<const cudaStream_t*>(
+      stream->implementation()->CudaStreamMemberHack());
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->has_input(i) ||
+        context->input_memory_type(i) != DEVICE_MEMORY) {
+      continue;
+    }
+    const Tensor tensor = IsRefType(context->input_dtype(i))
+                              ? context->mutable_input(i, false)
+                              : context->input(i);
+    if (!DataTypeCanUseMemcpy(tensor.dtype()) ||
+        tensor.TotalBytes() < kMinPrefetchBytes) {
+      continue;
+    }
+    cudaError_t err =
+        cudaMemPrefetchAsync(DMAHelper::base(&tensor), tensor.TotalBytes(),
+                             gpu_id_, *cuda_stream);
+    if (err != cudaSuccess) {
+      // E.g. the device does not support prefetching, so it would fail for
+      // the other inputs as well.
+      VLOG(1) << "cudaMemPrefetchAsync to GPU " << gpu_id_
+              << " failed: " << cudaGetErrorString(err);
+      cudaGetLastError();
+      return;
+    }
+  }
+#endif  // CUDA_VERSION >= 8000
+}
+
 Status BaseGPUDevice::MaybeCopyTensorToGPU(
     const AllocatorAttributes& alloc_attrs, const Tensor& from, Tensor* to,
     StatusCallback done) {
@@ -629,6 +688,20 @@ Status BaseGPUDevice::MakeTensorFromProto(const TensorProto& tensor_proto,
   }
 }
 
+Status BaseGPUDevice::MakeTensorFromHostTensor(
+    const Tensor& host_tensor, const AllocatorAttributes alloc_attrs,
+    Tensor* tensor) {
+  Notification n;
+  Status status;
+  TF_RETURN_IF_ERROR(MaybeCopyTensorToGPU(alloc_attrs, host_tensor, tensor,
+                                          [&n, &status](const Status& s) {
+                                            status = s;
+                                            n.Notify();
+                                          }));
+  n.WaitForNotification();
+  return status;
+}
+
 namespace {
 class ConcretePerOpGpuDevice : public PerOpGpuDevice {
  public:
@@ -78,6 +78,10 @@ class BaseGPUDevice : public LocalDevice {
                              const AllocatorAttributes alloc_attrs,
                              Tensor* tensor) override;
 
+  Status MakeTensorFromHostTensor(const Tensor& host_tensor,
+                                  const AllocatorAttributes alloc_attrs,
+                                  Tensor* tensor) override;
+
   // The caller owns the returned device.
   PerOpGpuDevice* MakeGpuDevice() override;
 
@@ -104,6 +108,11 @@ class BaseGPUDevice : public LocalDevice {
     gpu::Stream* host_to_device = nullptr;
     gpu::Stream* device_to_host = nullptr;
     gpu::Stream* device_to_device = nullptr;
+    // Copies of at most GPUUtil::SmallCopyBytes() use these so that they are
+    // not queued behind bulk transfers in the same direction.
+    gpu::Stream* small_host_to_device = nullptr;
+    gpu::Stream* small_device_to_host = nullptr;
+    gpu::Stream* small_device_to_device = nullptr;
   };
   class StreamGroupFactory;
 
@@ -114,6 +123,8 @@ class BaseGPUDevice : public LocalDevice {
   mutex trace_mu_;
   int gpu_id_ = -1;
   const bool sync_every_op_ = false;
+  // True if the memory of gpu_allocator_ is CUDA unified memory.
+  const bool use_managed_memory_;
   const int32 max_streams_;
   std::unique_ptr<EventMgr> em_;
   std::unique_ptr<thread::ThreadPool> thread_pool_;
@@ -123,6 +134,11 @@ class BaseGPUDevice : public LocalDevice {
 
   void ComputeHelper(OpKernel* op_kernel, OpKernelContext* context);
 
+  // Enqueues migrations of the large device memory inputs of 'context' to
+  // this GPU on 'stream', instead of letting the kernels fault their pages
+  // in one at a time. Only needed with unified memory.
+  void PrefetchManagedInputs(OpKernelContext* context, gpu::Stream* stream);
+
   // This method returns an initialization status, in addition to
   // calling the "done" StatusCallback, if there is a failure to
   // allocate memory or if the tensor "from" is not DMA-copyable.
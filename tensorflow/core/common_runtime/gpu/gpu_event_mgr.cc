@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
@@ -34,17 +37,27 @@ EventMgr::EventMgr(gpu::StreamExecutor* se, const GPUOptions& gpu_options)
           gpu_options.polling_inactive_delay_msecs()
               ? gpu_options.polling_inactive_delay_msecs()
               : 1),
+      use_host_callbacks_(gpu_options.event_mgr_use_host_callbacks()),
       accumulated_stream_(nullptr),
       accumulated_tensors_(new TensorReferenceVector),
       accumulated_tensor_bytes_(0),
       // threadpool_ has 1 thread for the polling loop, and one to execute
       // event callback functions. Maybe we should have more?
       threadpool_(Env::Default(), "GPU_Event_Manager", 2) {
-  StartPollingLoop();
+  if (!use_host_callbacks_) {
+    StartPollingLoop();
+  }
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    // Host callbacks refer to this object until they are retired.
+    mutex_lock l(mu_);
+    while (num_pending_callbacks_ > 0) {
+      events_pending_.wait(l);
+    }
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -148,6 +161,10 @@ void EventMgr::PollLoop() {
 }
 
 void EventMgr::QueueInUse(gpu::Stream* stream, InUse iu) {
+  if (use_host_callbacks_) {
+    QueueHostCallback(stream, std::move(iu));
+    return;
+  }
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
   // Events are created on demand, and repeatedly reused.  There is no
@@ -166,6 +183,48 @@ void EventMgr::QueueInUse(gpu::Stream* stream, InUse iu) {
   if (was_empty) events_pending_.notify_all();
 }
 
+void EventMgr::QueueHostCallback(gpu::Stream* stream, InUse iu) {
+  VLOG(2) << "QueueHostCallback  num_pending_callbacks_ "
+          << num_pending_callbacks_;
+  struct PendingCallback {
+    InUse in_use;
+    std::atomic<bool> retired{false};
+  };
+  auto pending = std::make_shared<PendingCallback>();
+  pending->in_use = std::move(iu);
+  ++num_pending_callbacks_;
+  // Runs on a driver thread, which must not call back into the driver, so
+  // the memory is freed on threadpool_. May run twice (see below), but
+  // retires the callback only once.
+  auto retire = [this, pending]() {
+    if (!pending->retired.exchange(true)) {
+      threadpool_.Schedule(
+          [this, pending]() { RetireHostCallback(pending->in_use); });
+    }
+  };
+  if (stream->ok()) {
+    stream->ThenDoHostCallback(retire);
+  }
+  if (!stream->ok()) {
+    // The callback may not have been enqueued. Like an Event recorded on a
+    // failed stream, it is retired right away.
+    retire();
+  }
+}
+
+void EventMgr::RetireHostCallback(const InUse& iu) {
+  ToFreeVector to_free;
+  to_free.push_back({nullptr, iu.mem, iu.bufrec, nullptr});
+  FreeMemory(to_free);
+  // This already runs on threadpool_, so the function is not scheduled
+  // again.
+  if (iu.func != nullptr) iu.func();
+  mutex_lock l(mu_);
+  if (--num_pending_callbacks_ == 0) {
+    events_pending_.notify_all();
+  }
+}
+
 // This function must be called periodically to check whether pending
 // events have recorded, and then retire them.  Initial observations
 // suggest that typical behavior in a TensorFlow program is to have
@@ -44,6 +44,10 @@ class GPUOptions;
 // An object to keep track of pending Events in the StreamExecutor streams
 // and associated Tensors that cannot safely be deleted until the associated
 // Events are recorded.
+//
+// If GPUOptions.event_mgr_use_host_callbacks is set, no Events are used:
+// a host callback is enqueued on the stream instead, and the Tensors are
+// released as soon as the driver runs it, without a polling thread.
 class EventMgr {
  public:
   EventMgr(perftools::gputools::StreamExecutor* se,
@@ -95,6 +99,7 @@ class EventMgr {
   const int64 deferred_bytes_threshold_;
   const int32 polling_active_delay_usecs_;
   const int32 polling_inactive_delay_msecs_;
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ GUARDED_BY(mu_);
 
@@ -136,6 +141,16 @@ class EventMgr {
   void QueueInUse(perftools::gputools::Stream* stream, InUse in_use)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Stream-enqueues a host callback that retires "in_use" once the work
+  // enqueued before it has completed. Used instead of an Event when
+  // use_host_callbacks_ is true.
+  void QueueHostCallback(perftools::gputools::Stream* stream, InUse in_use)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Frees the memory of "in_use" and runs its function on the calling
+  // thread, which must be a thread of threadpool_.
+  void RetireHostCallback(const InUse& in_use);
+
   void QueueTensors(perftools::gputools::Stream* stream,
                     TensorReferenceVector* tensors)
       EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -180,6 +195,9 @@ class EventMgr {
   // A FIFO queue of InUse events and associated tensors.
   std::deque<InUse> used_events_ GUARDED_BY(mu_);
 
+  // Number of host callbacks that have been enqueued and not yet retired.
+  int64 num_pending_callbacks_ GUARDED_BY(mu_) = 0;
+
   std::unique_ptr<Notification> stop_polling_;
   std::unique_ptr<Notification> polling_stopped_;
 
@@ -20,7 +20,9 @@ limitations under the License.
 #include <atomic>
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
 namespace gpu = ::perftools::gputools;
@@ -246,7 +248,60 @@ TEST(EventMgr, NonEmptyShutdown) {
   }
 }
 
+// With host callbacks, tensors are released and functions run without a
+// polling thread.
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions options;
+  options.set_event_mgr_use_host_callbacks(true);
+  std::unique_ptr<gpu::Stream> stream(new gpu::Stream(stream_exec));
+  CHECK(stream.get());
+  stream->Init();
+  {
+    EventMgr em(stream_exec, options);
+    TEST_EventMgrHelper th(&em);
+    EXPECT_EQ(0, live_tensor_bytes);
+    for (int i = 0; i < 5; ++i) {
+      TensorReferenceVector v;
+      AddTensorReference(&v, 100 * 1048576);
+      em.ThenDeleteTensors(stream.get(), v);
+      // No Events are used.
+      EXPECT_EQ(0, th.queue_size());
+      EXPECT_EQ(0, th.free_size());
+    }
+    Notification n;
+    em.ThenExecute(stream.get(), [&n]() { n.Notify(); });
+    n.WaitForNotification();
+  }
+  // Destroying the EventMgr waits for the pending callbacks.
+  EXPECT_EQ(0, live_tensor_bytes);
+}
+
 }  // namespace
+
+// Measures the latency from the completion of the work enqueued on a stream
+// to the scheduling of a function that waits for it, when the EventMgr polls
+// events (arg 0) or uses host callbacks (arg 1).
+static void BM_ThenExecuteLatency(int iters, int use_host_callbacks) {
+  testing::StopTiming();
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions options;
+  options.set_event_mgr_use_host_callbacks(use_host_callbacks);
+  std::unique_ptr<gpu::Stream> stream(new gpu::Stream(stream_exec));
+  CHECK(stream.get());
+  stream->Init();
+  EventMgr em(stream_exec, options);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    Notification n;
+    em.ThenExecute(stream.get(), [&n]() { n.Notify(); });
+    n.WaitForNotification();
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(iters);
+}
+BENCHMARK(BM_ThenExecuteLatency)->Arg(0)->Arg(1);
+
 }  // namespace tensorflow
 
 #endif  // GOOGLE_CUDA
@@ -36,4 +36,37 @@ void GpuManagedAllocator::DeallocateRaw(void* ptr) {
 #endif
 }
 
+void* GPUManagedMemAllocator::Alloc(size_t alignment, size_t num_bytes) {
+  void* ptr = nullptr;
+#ifdef GOOGLE_CUDA
+  if (num_bytes == 0) return nullptr;
+  cudaError_t err = cudaMallocManaged(&ptr, num_bytes);
+  if (err != cudaSuccess) {
+    LOG(WARNING) << "cudaMallocManaged of " << num_bytes
+                 << " bytes failed: " << cudaGetErrorString(err);
+    return nullptr;
+  }
+#if CUDA_VERSION >= 8000
+  // Devices without concurrent managed access reject the advice, in which
+  // case the memory simply migrates on demand.
+  err = cudaMemAdvise(ptr, num_bytes, cudaMemAdviseSetPreferredLocation,
+                      device_id_);
+  if (err != cudaSuccess) {
+    VLOG(1) << "cudaMemAdvise on GPU " << device_id_
+            << " failed: " << cudaGetErrorString(err);
+    cudaGetLastError();
+  }
+#endif  // CUDA_VERSION >= 8000
+#endif  // GOOGLE_CUDA
+  return ptr;
+}
+
+void GPUManagedMemAllocator::Free(void* ptr, size_t num_bytes) {
+#ifdef GOOGLE_CUDA
+  if (ptr != nullptr) {
+    CHECK_EQ(cudaFree(ptr), cudaSuccess);
+  }
+#endif
+}
+
 }  // namespace tensorflow
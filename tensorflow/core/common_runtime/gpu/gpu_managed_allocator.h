@@ -17,6 +17,7 @@ limitations under the License.
 #define THIRD_PARTY_TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
 
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
@@ -31,6 +32,25 @@ class GpuManagedAllocator : public Allocator {
   void DeallocateRaw(void* ptr) override;
 };
 
+// Suballocator for CUDA unified memory that prefers to reside on device
+// 'device_id'. When the device is oversubscribed, the driver evicts pages to
+// host memory instead of failing, so a BFC allocator on top of it can hand
+// out more memory than the device has. Used for GPUOptions.allocator_type
+// "MANAGED".
+class GPUManagedMemAllocator : public SubAllocator {
+ public:
+  explicit GPUManagedMemAllocator(int device_id) : device_id_(device_id) {}
+  ~GPUManagedMemAllocator() override {}
+
+  void* Alloc(size_t alignment, size_t num_bytes) override;
+  void Free(void* ptr, size_t num_bytes) override;
+
+ private:
+  const int device_id_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUManagedMemAllocator);
+};
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -26,6 +27,64 @@ limitations under the License.
 
 namespace tensorflow {
 namespace gpu_stream_util {
+namespace {
+
+// Returns the stream that "opts" forces nodes of the type of "n" to use, or
+// -1 if they may use any stream.
+int OverrideStream(const Node* n, const AssignStreamsOpts& opts) {
+  const string& op = n->type_string();
+  if (op == "_Send") return opts.send_stream;
+  if (op == "_Recv") return opts.recv_stream;
+  if (op == "Const") return opts.const_stream;
+  return opts.compute_stream;
+}
+
+void ScheduleByCost(const std::vector<Node*>& order,
+                    const AssignStreamsOpts& opts, int num_node_ids,
+                    std::unordered_map<int, int>* node_to_stream_id) {
+  // Estimated finish time of each node, and time at which each stream
+  // finishes the nodes assigned to it so far.
+  std::vector<int64> finish_time(num_node_ids, 0);
+  std::vector<int64> stream_free_time(opts.max_streams, 0);
+  for (Node* n : order) {
+    int first = 0;
+    int end = opts.max_streams;
+    const int override_stream = OverrideStream(n, opts);
+    if (override_stream >= 0) {
+      first = override_stream;
+      end = override_stream + 1;
+    }
+    int best_stream = first;
+    int64 best_start = -1;
+    for (int s = first; s < end; ++s) {
+      int64 start = stream_free_time[s];
+      for (const Edge* e : n->in_edges()) {
+        int64 ready = finish_time[e->src()->id()];
+        if (!e->IsControlEdge() && (*node_to_stream_id)[e->src()->id()] != s) {
+          ready += opts.cross_stream_cost;
+        }
+        start = std::max(start, ready);
+      }
+      // Among the streams on which the node starts the earliest, prefer the
+      // least loaded one.
+      if (best_start < 0 || start < best_start ||
+          (start == best_start &&
+           stream_free_time[s] < stream_free_time[best_stream])) {
+        best_stream = s;
+        best_start = start;
+      }
+    }
+    int64 cost = 0;
+    if (n->IsOp()) {
+      cost = opts.node_cost ? opts.node_cost(n) : 1;
+    }
+    finish_time[n->id()] = best_start + cost;
+    stream_free_time[best_stream] = finish_time[n->id()];
+    (*node_to_stream_id)[n->id()] = best_stream;
+  }
+}
+
+}  // namespace
 
 Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
                      std::unordered_map<int, int>* node_to_stream_id) {
@@ -61,6 +120,13 @@ Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
       }
     }
   }
+  if (opts.schedule_by_cost) {
+    ScheduleByCost(order, opts, graph->num_node_ids(), node_to_stream_id);
+    VLOG(1) << "Scheduled " << order.size() << " nodes on "
+            << opts.max_streams << " streams.";
+    return Status::OK();
+  }
+
   // We perform stream assignment assuming a large number of
   // stream IDs and then map these down to the required number of streams
   // using simple round-robin.
@@ -77,7 +143,6 @@ Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
   for (Node* n : order) {
     VLOG(3) << "Inspecting node " << n->DebugString();
     const int node_id = n->id();
-    const string& op = n->type_string();
 
     // Determine a suitable stream to use.
     int stream_id = highest_stream_id + 1;
@@ -89,15 +154,8 @@ Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
       }
     }
     // Override stream for specific op types.
-    if (op == "_Send") {
-      if (opts.send_stream >= 0) stream_id = opts.send_stream;
-    } else if (op == "_Recv") {
-      if (opts.recv_stream >= 0) stream_id = opts.recv_stream;
-    } else if (op == "Const") {
-      if (opts.const_stream >= 0) stream_id = opts.const_stream;
-    } else {
-      if (opts.compute_stream >= 0) stream_id = opts.compute_stream;
-    }
+    const int override_stream = OverrideStream(n, opts);
+    if (override_stream >= 0) stream_id = override_stream;
 
     (*node_to_stream_id)[node_id] = stream_id % opts.max_streams;
     highest_stream_id = std::max(stream_id, highest_stream_id);
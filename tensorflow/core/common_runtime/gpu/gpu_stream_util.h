@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
 #define TENSORFLOW_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
 
+#include <functional>
 #include <unordered_map>
 
 #include "tensorflow/core/graph/graph.h"
@@ -32,6 +33,19 @@ struct AssignStreamsOpts {
   int32 recv_stream = -1;
   int32 const_stream = -1;
   int32 compute_stream = -1;
+
+  // If true, nodes are assigned by a list schedule of the graph on
+  // max_streams streams instead of by the fanout heuristic: in topological
+  // order, each node goes to the stream on which it could start the
+  // earliest, given the estimated finish times of its inputs and of the
+  // nodes already assigned to each stream. Waiting for an input produced on
+  // another stream adds "cross_stream_cost". The per-op-type overrides
+  // above still apply.
+  bool schedule_by_cost = false;
+  // Estimated run time of a node, in arbitrary units. If null, every node
+  // costs 1.
+  std::function<int64(const Node*)> node_cost = nullptr;
+  int64 cross_stream_cost = 1;
 };
 
 // Given the input graph, assigns every node in the graph with a
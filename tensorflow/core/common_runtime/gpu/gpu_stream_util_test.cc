@@ -143,5 +143,43 @@ TEST_F(GpuStreamUtilTest, StreamOverrides) {
   }
 }
 
+TEST_F(GpuStreamUtilTest, ScheduleByCost) {
+  auto root = Scope::DisabledShapeInferenceScope().ExitOnError();
+  Output a = ops::MatMul(root.WithOpName("a"), {}, {});
+  Output b = ops::MatMul(root.WithOpName("b"), {}, {});
+  ops::MatMul(root.WithOpName("c"), a, b);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&g));
+
+  std::unordered_map<int, int> node_to_stream_id;
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 2;
+  opts.schedule_by_cost = true;
+  opts.node_cost = [](const Node* n) {
+    return n->type_string() == "MatMul" ? 10 : 1;
+  };
+  TF_ASSERT_OK(gpu_stream_util::AssignStreams(&g, opts, &node_to_stream_id));
+
+  std::unordered_map<string, int> stream_of;
+  for (Node* n : g.nodes()) {
+    EXPECT_GE(node_to_stream_id[n->id()], 0);
+    EXPECT_LT(node_to_stream_id[n->id()], opts.max_streams);
+    stream_of[n->name()] = node_to_stream_id[n->id()];
+  }
+  // The two independent products run on different streams.
+  EXPECT_NE(stream_of["a"], stream_of["b"]);
+
+  // Overrides still apply.
+  opts.compute_stream = 1;
+  opts.const_stream = 0;
+  TF_ASSERT_OK(gpu_stream_util::AssignStreams(&g, opts, &node_to_stream_id));
+  for (Node* n : g.nodes()) {
+    if (n->IsOp()) {
+      EXPECT_EQ(n->type_string() == "Const" ? 0 : 1,
+                node_to_stream_id[n->id()]);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
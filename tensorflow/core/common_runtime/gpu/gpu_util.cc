@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -36,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -113,6 +116,58 @@ void* GetBase(const Tensor* src) {
 
 void* GetBase(Tensor* dst) { return DMAHelper::base(dst); }
 
+namespace {
+
+// Returns the stream to use for a copy of 'total_bytes' in one direction:
+// small copies go to 'small_stream', if any, so that they do not wait for
+// the bulk copies queued on 'stream'.
+gpu::Stream* SelectCopyStream(int64 total_bytes, gpu::Stream* stream,
+                              gpu::Stream* small_stream) {
+  if (small_stream != nullptr && total_bytes <= GPUUtil::SmallCopyBytes()) {
+    return small_stream;
+  }
+  return stream;
+}
+
+// Calls 'copy_chunk(offset, bytes)' for consecutive chunks that cover
+// 'total_bytes'.
+template <typename CopyChunkFn>
+void ForEachCopyChunk(int64 total_bytes, const CopyChunkFn& copy_chunk) {
+  const int64 chunk_bytes = GPUUtil::CopyChunkBytes();
+  if (chunk_bytes <= 0) {
+    copy_chunk(0, total_bytes);
+    return;
+  }
+  for (int64 offset = 0; offset < total_bytes; offset += chunk_bytes) {
+    copy_chunk(offset, std::min(chunk_bytes, total_bytes - offset));
+  }
+}
+
+int64 ReadCopyBytesFromEnvVar(StringPiece env_var_name, int64 default_val) {
+  int64 value = default_val;
+  Status s = ReadInt64FromEnvVar(env_var_name, default_val, &value);
+  if (!s.ok()) {
+    LOG(ERROR) << s.error_message();
+  }
+  return value;
+}
+
+}  // namespace
+
+// static
+int64 GPUUtil::SmallCopyBytes() {
+  static const int64 small_copy_bytes =
+      ReadCopyBytesFromEnvVar("TF_GPU_SMALL_COPY_BYTES", 64 << 10);
+  return small_copy_bytes;
+}
+
+// static
+int64 GPUUtil::CopyChunkBytes() {
+  static const int64 copy_chunk_bytes =
+      ReadCopyBytesFromEnvVar("TF_GPU_COPY_CHUNK_BYTES", 8 << 20);
+  return copy_chunk_bytes;
+}
+
 /*static*/
 void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
                               const DeviceContext* device_context,
@@ -159,9 +214,12 @@ void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
                                      LogMemory::PROTO_BUFFER_STEP_ID,
                                      total_bytes, buf, alloc);
     }
-    void* src_ptr = GetBase(&tensor);
-    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    send_device_to_host_stream->ThenMemcpy(buf, gpu_src_ptr, total_bytes);
+    char* src_ptr = static_cast<char*>(GetBase(&tensor));
+    ForEachCopyChunk(total_bytes, [&](int64 offset, int64 bytes) {
+      DeviceMemoryBase gpu_src_chunk(src_ptr + offset, bytes);
+      send_device_to_host_stream->ThenMemcpy(buf + offset, gpu_src_chunk,
+                                             bytes);
+    });
   }
   // Use of tensor may outlive stack scope, so keep a ref.
   TensorReference tensor_ref(tensor);
@@ -202,9 +260,12 @@ void GPUUtil::DeviceToDeviceCopy(DeviceContext* send_dev_context,
     done(s);
     return;
   }
+  const int64 total_bytes = input->TotalBytes();
+  auto* send_gpu_context =
+      static_cast<const GPUDeviceContext*>(send_dev_context);
   auto send_device_to_device_stream =
-      static_cast<const GPUDeviceContext*>(send_dev_context)
-          ->device_to_device_stream();
+      SelectCopyStream(total_bytes, send_gpu_context->device_to_device_stream(),
+                       send_gpu_context->small_device_to_device_stream());
   if (send_device_to_device_stream == nullptr) {
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
@@ -213,12 +274,9 @@ void GPUUtil::DeviceToDeviceCopy(DeviceContext* send_dev_context,
   // available.
   send_device_to_device_stream->ThenWaitFor(send_stream);
 
-  const int64 total_bytes = input->TotalBytes();
   if (total_bytes > 0) {
-    void* src_ptr = GetBase(input);
-    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    void* dst_ptr = GetBase(output);
-    DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
+    char* src_ptr = static_cast<char*>(GetBase(input));
+    char* dst_ptr = static_cast<char*>(GetBase(output));
     auto recv_stream =
         static_cast<const GPUDeviceContext*>(recv_dev_context)->stream();
     if (recv_stream == nullptr) {
@@ -232,9 +290,16 @@ void GPUUtil::DeviceToDeviceCopy(DeviceContext* send_dev_context,
     // to make sure the memory is free.
     send_device_to_device_stream->ThenWaitFor(recv_stream);
 
-    VLOG(2) << "src_ptr " << src_ptr << " dst_ptr " << dst_ptr;
-    send_device_to_device_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
-                                             total_bytes);
+    VLOG(2) << "src_ptr " << static_cast<void*>(src_ptr) << " dst_ptr "
+            << static_cast<void*>(dst_ptr);
+    // With peer access enabled between the devices, this is a direct
+    // peer-to-peer copy.
+    ForEachCopyChunk(total_bytes, [&](int64 offset, int64 bytes) {
+      DeviceMemoryBase gpu_src_chunk(src_ptr + offset, bytes);
+      DeviceMemoryBase gpu_dst_chunk(dst_ptr + offset, bytes);
+      send_device_to_device_stream->ThenMemcpy(&gpu_dst_chunk, gpu_src_chunk,
+                                               bytes);
+    });
   }
 
   // Use of input may outlive stack scope, so keep a ref.
@@ -270,9 +335,11 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
     return;
   }
 
+  const int64 total_bytes = gpu_tensor->TotalBytes();
+  auto* gpu_context = static_cast<const GPUDeviceContext*>(device_context);
   auto send_device_to_host_stream =
-      static_cast<const GPUDeviceContext*>(device_context)
-          ->device_to_host_stream();
+      SelectCopyStream(total_bytes, gpu_context->device_to_host_stream(),
+                       gpu_context->small_device_to_host_stream());
   if (send_device_to_host_stream == nullptr) {
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
@@ -280,12 +347,14 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   // Wait for the sender's main stream to make sure the data are available.
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
-  const int64 total_bytes = gpu_tensor->TotalBytes();
   if (total_bytes > 0) {
-    void* src_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    void* dst_ptr = GetBase(cpu_tensor);
-    send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    char* src_ptr = static_cast<char*>(GetBase(gpu_tensor));
+    char* dst_ptr = static_cast<char*>(GetBase(cpu_tensor));
+    ForEachCopyChunk(total_bytes, [&](int64 offset, int64 bytes) {
+      DeviceMemoryBase gpu_src_chunk(src_ptr + offset, bytes);
+      send_device_to_host_stream->ThenMemcpy(dst_ptr + offset, gpu_src_chunk,
+                                             bytes);
+    });
   }
   // Use of the input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*gpu_tensor);
@@ -315,9 +384,11 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     return;
   }
 
+  const int64 total_bytes = cpu_tensor->TotalBytes();
+  auto* gpu_context = static_cast<const GPUDeviceContext*>(device_context);
   auto recv_host_to_device_stream =
-      static_cast<const GPUDeviceContext*>(device_context)
-          ->host_to_device_stream();
+      SelectCopyStream(total_bytes, gpu_context->host_to_device_stream(),
+                       gpu_context->small_host_to_device_stream());
   if (recv_host_to_device_stream == nullptr) {
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
@@ -325,13 +396,15 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   // Wait for the recv-stream to make sure the buffer is truly available.
   recv_host_to_device_stream->ThenWaitFor(recv_stream);
 
-  const int64 total_bytes = cpu_tensor->TotalBytes();
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
-    void* src_ptr = GetBase(cpu_tensor);
-    void* dst_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
-    recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr, total_bytes);
+    const char* src_ptr = static_cast<const char*>(GetBase(cpu_tensor));
+    char* dst_ptr = static_cast<char*>(GetBase(gpu_tensor));
+    ForEachCopyChunk(total_bytes, [&](int64 offset, int64 bytes) {
+      DeviceMemoryBase gpu_dst_chunk(dst_ptr + offset, bytes);
+      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_chunk, src_ptr + offset,
+                                             bytes);
+    });
   }
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
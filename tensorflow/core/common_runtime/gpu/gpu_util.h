@@ -110,6 +110,17 @@ class GPUUtil {
                                      const Tensor* src_gpu_tensor,
                                      Tensor* dst_gpu_tensor,
                                      StatusCallback done);
+
+  // Copies of at most this many bytes use the small copy streams of the
+  // device context, which lets them run ahead of bulk copies. Configured by
+  // TF_GPU_SMALL_COPY_BYTES, 64KiB by default.
+  static int64 SmallCopyBytes();
+
+  // Larger copies are enqueued in chunks of at most this many bytes, so that
+  // copies on other streams in the same direction can be interleaved between
+  // the chunks. Configured by TF_GPU_COPY_CHUNK_BYTES, 8MiB by default; 0
+  // disables chunking.
+  static int64 CopyChunkBytes();
 };
 
 }  // namespace tensorflow
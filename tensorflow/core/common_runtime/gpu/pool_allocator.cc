@@ -107,17 +107,20 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
   if (has_size_limit_) {
     {
       mutex_lock lock(mutex_);
-      auto iter = pool_.find(num_bytes);
-      if (iter == pool_.end()) {
+      SizeClass& size_class = pool_[num_bytes];
+      if (size_class.free_list.empty()) {
         allocated_count_++;
+        size_class.misses++;
         // Deliberately fall out of lock scope before
         // calling the allocator.  No further modification
         // to the pool will be performed.
       } else {
         get_from_pool_count_++;
-        pr = iter->second;
+        size_class.hits++;
+        pr = size_class.free_list.back();
+        size_class.free_list.pop_back();
+        --pool_size_;
         RemoveFromList(pr);
-        pool_.erase(iter);
         // Fall out of lock scope and do the result without the lock held.
       }
     }
@@ -147,29 +150,32 @@ void PoolAllocator::DeallocateRaw(void* ptr) {
   } else {
     mutex_lock lock(mutex_);
     ++put_count_;
-    while (pool_.size() >= pool_size_limit_) {
+    while (pool_size_ >= pool_size_limit_) {
       EvictOne();
     }
     PtrRecord* pr = new PtrRecord;
     pr->num_bytes = cp->num_bytes;
     pr->ptr = cp;
     AddToList(pr);
-    pool_.insert(std::make_pair(cp->num_bytes, pr));
+    pool_[cp->num_bytes].free_list.push_back(pr);
+    ++pool_size_;
   }
 }
 
 void PoolAllocator::Clear() {
   if (has_size_limit_) {
     mutex_lock lock(mutex_);
-    for (auto iter : pool_) {
-      PtrRecord* pr = iter.second;
-      for (const auto& v : free_visitors_) {
-        v(pr->ptr, pr->num_bytes);
+    for (auto& iter : pool_) {
+      for (PtrRecord* pr : iter.second.free_list) {
+        for (const auto& v : free_visitors_) {
+          v(pr->ptr, pr->num_bytes);
+        }
+        allocator_->Free(pr->ptr, pr->num_bytes);
+        delete pr;
       }
-      allocator_->Free(pr->ptr, pr->num_bytes);
-      delete pr;
     }
     pool_.clear();
+    pool_size_ = 0;
     get_from_pool_count_ = 0;
     put_count_ = 0;
     allocated_count_ = 0;
@@ -214,12 +220,12 @@ void PoolAllocator::EvictOne() {
   DCHECK(lru_tail_ != nullptr);
   PtrRecord* prec = lru_tail_;
   RemoveFromList(prec);
-  auto iter = pool_.find(prec->num_bytes);
-  while (iter->second != prec) {
-    ++iter;
-    DCHECK(iter != pool_.end());
-  }
-  pool_.erase(iter);
+  // The least recently returned buffer overall is also the least recently
+  // returned buffer of its size class.
+  std::deque<PtrRecord*>& free_list = pool_[prec->num_bytes].free_list;
+  DCHECK_EQ(free_list.front(), prec);
+  free_list.pop_front();
+  --pool_size_;
   for (const auto& v : free_visitors_) {
     v(prec->ptr, prec->num_bytes);
   }
@@ -268,6 +274,21 @@ void PoolAllocator::EvictOne() {
   }
 }
 
+std::vector<PoolAllocator::SizeClassStats> PoolAllocator::GetSizeClassStats() {
+  mutex_lock lock(mutex_);
+  std::vector<SizeClassStats> result;
+  result.reserve(pool_.size());
+  for (const auto& iter : pool_) {
+    SizeClassStats stats;
+    stats.num_bytes = iter.first;
+    stats.hits = iter.second.hits;
+    stats.misses = iter.second.misses;
+    stats.free_buffers = iter.second.free_list.size();
+    result.push_back(stats);
+  }
+  return result;
+}
+
 void PoolAllocator::AddAllocVisitor(Visitor visitor) {
   mutex_lock lock(mutex_);
   CHECK(!allocation_begun_)
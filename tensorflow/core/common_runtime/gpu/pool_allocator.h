@@ -21,6 +21,7 @@ limitations under the License.
 // by GPURegionAllocator.
 
 #include <atomic>
+#include <deque>
 #include <map>
 #include <memory>
 #include <vector>
@@ -44,6 +45,13 @@ class RoundUpInterface {
 
 // Size-limited pool of memory buffers obtained from a SubAllocator
 // instance.  Pool eviction policy is LRU.
+//
+// Returned buffers are kept in one free list per size class, where the
+// size class of a request is its size (plus the pool's bookkeeping
+// overhead) rounded up by "size_rounder".  A request is served from the
+// free list of its size class, most recently returned buffer first.  With
+// a rounder that maps many sizes to few classes, such as SizeClassRounder,
+// requests of similar but different sizes share buffers.
 class PoolAllocator : public VisitableAllocator {
  public:
   // "pool_size_limit" is the maximum number of returned, re-usable
@@ -111,6 +119,23 @@ class PoolAllocator : public VisitableAllocator {
     return pool_size_limit_;
   }
 
+  // Counters of one size class.
+  struct SizeClassStats {
+    // Size of the buffers of this class, including the bookkeeping
+    // overhead of the pool.
+    size_t num_bytes = 0;
+    // Number of requests satisfied from the free list of this class.
+    int64 hits = 0;
+    // Number of requests of this class requiring a fresh allocation.
+    int64 misses = 0;
+    // Number of buffers currently in the free list of this class.
+    int64 free_buffers = 0;
+  };
+
+  // Returns the counters of every size class requested since the last
+  // Clear(), in increasing order of size.
+  std::vector<SizeClassStats> GetSizeClassStats();
+
   void GetStats(AllocatorStats* stats) override { stats->Clear(); }
 
  private:
@@ -130,6 +155,13 @@ class PoolAllocator : public VisitableAllocator {
   // Delete the least recently used record.
   void EvictOne() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  struct SizeClass {
+    // Returned buffers of this class, least recently returned first.
+    std::deque<PtrRecord*> free_list;
+    int64 hits = 0;
+    int64 misses = 0;
+  };
+
   const string name_;
   const bool has_size_limit_;
   const bool auto_resize_;
@@ -137,7 +169,10 @@ class PoolAllocator : public VisitableAllocator {
   std::unique_ptr<SubAllocator> allocator_;
   std::unique_ptr<RoundUpInterface> size_rounder_;
   mutex mutex_;
-  std::multimap<const size_t, PtrRecord*> pool_ GUARDED_BY(mutex_);
+  // Size classes keyed by their rounded size.
+  std::map<size_t, SizeClass> pool_ GUARDED_BY(mutex_);
+  // Total number of buffers in the free lists of pool_.
+  size_t pool_size_ GUARDED_BY(mutex_) = 0;
   PtrRecord* lru_head_ GUARDED_BY(mutex_) = nullptr;
   PtrRecord* lru_tail_ GUARDED_BY(mutex_) = nullptr;
   int64 get_from_pool_count_ GUARDED_BY(mutex_) = 0;
@@ -166,6 +201,24 @@ class Pow2Rounder : public RoundUpInterface {
   }
 };
 
+// Size-class rounder: splits every power of 2 range of sizes into
+// kClassesPerDoubling evenly spaced classes, in the style of jemalloc, so
+// that a size is rounded up by less than 1/kClassesPerDoubling of itself.
+// Sizes below kMinClassBytes are rounded up to kMinClassBytes.
+class SizeClassRounder : public RoundUpInterface {
+ public:
+  static const int kClassesPerDoubling = 4;
+  static const size_t kMinClassBytes = 64;
+
+  size_t RoundUp(size_t num_bytes) override {
+    if (num_bytes <= kMinClassBytes) return kMinClassBytes;
+    // num_bytes is in (2^(log2 - 1), 2^log2].
+    const int log2 = Log2Ceiling64(num_bytes);
+    const size_t step = (1uLL << (log2 - 1)) / kClassesPerDoubling;
+    return (num_bytes + step - 1) / step * step;
+  }
+};
+
 class BasicCPUAllocator : public SubAllocator {
  public:
   ~BasicCPUAllocator() override {}
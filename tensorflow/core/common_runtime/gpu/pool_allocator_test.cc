@@ -199,6 +199,57 @@ TEST(PoolAllocatorTest, Pow2Rounder) {
   EXPECT_EQ(65536, rounder.RoundUp(65536));
 }
 
+TEST(PoolAllocatorTest, SizeClassRounder) {
+  SizeClassRounder rounder;
+  EXPECT_EQ(64, rounder.RoundUp(1));
+  EXPECT_EQ(64, rounder.RoundUp(64));
+  EXPECT_EQ(80, rounder.RoundUp(65));
+  EXPECT_EQ(128, rounder.RoundUp(127));
+  EXPECT_EQ(1024, rounder.RoundUp(1024));
+  EXPECT_EQ(1280, rounder.RoundUp(1025));
+  EXPECT_EQ(1536, rounder.RoundUp(1281));
+  EXPECT_EQ(49152, rounder.RoundUp(41234));
+  for (size_t n = 65; n < 100000; n += 997) {
+    const size_t rounded = rounder.RoundUp(n);
+    EXPECT_LE(n, rounded);
+    // The slack is bounded by a quarter of the request.
+    EXPECT_LT(rounded - n, n / 4 + 1);
+    EXPECT_EQ(rounded, rounder.RoundUp(rounded));
+  }
+}
+
+TEST(PoolAllocatorTest, SizeClasses) {
+  PoolAllocator pool(10 /*pool_size_limit*/, false /*auto_resize*/,
+                     new BasicCPUAllocator, new SizeClassRounder, "pool");
+
+  // Requests of different sizes in the same class share a buffer.
+  void* p1 = pool.AllocateRaw(4, 1000);
+  pool.DeallocateRaw(p1);
+  void* p2 = pool.AllocateRaw(4, 980);
+  EXPECT_EQ(p1, p2);
+  // A request of another class does not.
+  void* p3 = pool.AllocateRaw(4, 4000);
+  EXPECT_NE(p1, p3);
+  pool.DeallocateRaw(p2);
+  pool.DeallocateRaw(p3);
+  EXPECT_EQ(1, pool.get_from_pool_count());
+  EXPECT_EQ(2, pool.allocated_count());
+
+  std::vector<PoolAllocator::SizeClassStats> stats =
+      pool.GetSizeClassStats();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_LT(stats[0].num_bytes, stats[1].num_bytes);
+  EXPECT_EQ(1, stats[0].hits);
+  EXPECT_EQ(1, stats[0].misses);
+  EXPECT_EQ(1, stats[0].free_buffers);
+  EXPECT_EQ(0, stats[1].hits);
+  EXPECT_EQ(1, stats[1].misses);
+  EXPECT_EQ(1, stats[1].free_buffers);
+
+  pool.Clear();
+  EXPECT_TRUE(pool.GetSizeClassStats().empty());
+}
+
 TEST(PoolAllocatorTest, Name) {
   gpu::Platform* platform =
       gpu::MultiPlatformManager::PlatformWithName("cuda").ValueOrDie();
@@ -127,7 +127,8 @@ Allocator* ProcessState::GetGPUAllocator(const GPUOptions& options, int gpu_id,
     VisitableAllocator* gpu_allocator;
 
     // Validate allocator types.
-    if (!allocator_type.empty() && allocator_type != "BFC") {
+    if (!allocator_type.empty() && allocator_type != "BFC" &&
+        allocator_type != "MANAGED") {
       LOG(ERROR) << "Invalid allocator type: " << allocator_type;
       return nullptr;
     }
@@ -212,7 +213,7 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     } else {
       allocator = new PoolAllocator(
           100 /*pool_size_limit*/, true /*auto_resize*/,
-          new BasicCPUAllocator(), new NoopRounder, "cpu_pool");
+          new BasicCPUAllocator(), new SizeClassRounder, "cpu_pool");
       VLOG(2) << "Using PoolAllocator for ProcessState CPU allocator";
     }
     if (LogMemory::IsEnabled()) {
@@ -31,16 +31,23 @@ namespace gpu = ::perftools::gputools;
 
 class GPUDeviceContext : public DeviceContext {
  public:
-  // Does not take ownership of streams.
+  // Does not take ownership of streams. The small copy streams are optional;
+  // when they are null small copies share the stream of their direction.
   GPUDeviceContext(int stream_id, gpu::Stream* stream,
                    gpu::Stream* host_to_device_stream,
                    gpu::Stream* device_to_host_stream,
-                   gpu::Stream* device_to_device_stream)
+                   gpu::Stream* device_to_device_stream,
+                   gpu::Stream* small_host_to_device_stream = nullptr,
+                   gpu::Stream* small_device_to_host_stream = nullptr,
+                   gpu::Stream* small_device_to_device_stream = nullptr)
       : stream_id_(stream_id),
         stream_(stream),
         host_to_device_stream_(host_to_device_stream),
         device_to_host_stream_(device_to_host_stream),
-        device_to_device_stream_(device_to_device_stream) {}
+        device_to_device_stream_(device_to_device_stream),
+        small_host_to_device_stream_(small_host_to_device_stream),
+        small_device_to_host_stream_(small_device_to_host_stream),
+        small_device_to_device_stream_(small_device_to_device_stream) {}
 
   ~GPUDeviceContext() override {}
 
@@ -50,6 +57,15 @@ class GPUDeviceContext : public DeviceContext {
   gpu::Stream* device_to_device_stream() const {
     return device_to_device_stream_;
   }
+  gpu::Stream* small_host_to_device_stream() const {
+    return small_host_to_device_stream_;
+  }
+  gpu::Stream* small_device_to_host_stream() const {
+    return small_device_to_host_stream_;
+  }
+  gpu::Stream* small_device_to_device_stream() const {
+    return small_device_to_device_stream_;
+  }
   int stream_id() const { return stream_id_; }
 
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
@@ -74,6 +90,11 @@ class GPUDeviceContext : public DeviceContext {
   gpu::Stream* device_to_host_stream_;
   // The stream to use for copy data between GPU.
   gpu::Stream* device_to_device_stream_;
+  // The streams to use for small copies in each direction, so that they do
+  // not wait for bulk copies. May be null.
+  gpu::Stream* small_host_to_device_stream_;
+  gpu::Stream* small_device_to_host_stream_;
+  gpu::Stream* small_device_to_device_stream_;
 };
 
 }  // namespace tensorflow
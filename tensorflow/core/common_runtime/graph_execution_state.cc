@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
 #endif  // IS_MOBILE_PLATFORM
 
 namespace tensorflow {
@@ -348,10 +349,26 @@ Status GraphExecutionState::OptimizeGraph(
         cpu_device = device;
       }
     }
-    grappler::VirtualCluster cluster(device_map);
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
-        item, rewrite_options, cpu_device, &cluster, &new_graph));
+    std::unique_ptr<grappler::OptimizedGraphCache> cache;
+    string cache_key;
+    if (!rewrite_options.optimized_graph_cache_dir().empty()) {
+      cache.reset(new grappler::OptimizedGraphCache(
+          rewrite_options.optimized_graph_cache_dir()));
+      cache_key =
+          grappler::OptimizedGraphCache::Key(item, rewrite_options, device_map);
+    }
+    if (cache == nullptr || !cache->Lookup(cache_key, &new_graph)) {
+      grappler::VirtualCluster cluster(device_map);
+      TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+          item, rewrite_options, cpu_device, &cluster, &new_graph));
+      if (cache != nullptr) {
+        Status s = cache->Insert(cache_key, new_graph);
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to cache the optimized graph: " << s;
+        }
+      }
+    }
     GraphConstructorOptions opts;
     opts.allow_internal_ops = true;
     optimized_graph->reset(new Graph(OpRegistry::Global()));
@@ -24,6 +24,14 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// At L1, calls of functions with at most this many nodes are inlined even
+// when function inlining is not requested.
+const int kMaxAutoInlinedBodyNodes = 16;
+
+}  // namespace
+
 GraphOptimizer::GraphOptimizer(const OptimizerOptions& opts) : opts_(opts) {
   if (opts_.opt_level() >= OptimizerOptions::L1) {
     opts_.set_do_common_subexpression_elimination(true);
@@ -41,6 +49,10 @@ void GraphOptimizer::Optimize(
   Graph* g = graph->get();
   DumpGraph("Initial", g);
 
+  const bool inline_small_functions =
+      !opts_.do_function_inlining() && runtime != nullptr &&
+      opts_.opt_level() >= OptimizerOptions::L1;
+  bool inlined = false;
   bool changed = true;
   const int kMaxRounds = 10;
   for (int rounds = 0; rounds < kMaxRounds; ++rounds) {
@@ -75,7 +87,8 @@ void GraphOptimizer::Optimize(
       }
     }
 
-    if (opts_.do_function_inlining() && FixupSourceAndSinkEdges(g)) {
+    if ((opts_.do_function_inlining() || inlined) &&
+        FixupSourceAndSinkEdges(g)) {
       DumpGraph("FixupSourceAndSinkEdges", g);
       changed = true;
     }
@@ -88,6 +101,12 @@ void GraphOptimizer::Optimize(
       DumpGraph("ExpandInlineFunctions", g);
       changed = true;
     }
+    if (inline_small_functions &&
+        ExpandSmallInlineFunctions(runtime, g, kMaxAutoInlinedBodyNodes)) {
+      DumpGraph("ExpandSmallInlineFunctions", g);
+      inlined = true;
+      changed = true;
+    }
     if (!changed) break;
   }
 
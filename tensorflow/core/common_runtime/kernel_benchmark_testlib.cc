@@ -82,6 +82,12 @@ Benchmark::Benchmark(const string& device, Graph* g,
   params.delete_kernel = [](OpKernel* kernel) {
     DeleteNonCachedKernel(kernel);
   };
+  params.num_work_stealing_lanes = NumWorkStealingLanes(
+      options->config.executor_options(), pool_->NumThreads());
+  params.inline_cost_threshold_usecs =
+      options->config.executor_options().inline_cost_threshold_usecs();
+  params.allow_static_plan =
+      options->config.executor_options().use_static_plan();
 
   if (init) {
     Executor* init_exec;
@@ -0,0 +1,170 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/numa_bfc_allocator.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The thread caches of the arenas hold at most this many bytes per thread.
+const size_t kThreadCacheBytes = 1 << 20;
+
+size_t PhysicalMemoryBytes() {
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+  return static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) *
+         static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+  return 64LL << 30;
+#endif
+}
+
+}  // namespace
+
+// Reserves the regions of the arena of one node, and records them in the
+// owning allocator so that frees can find their arena.
+class NUMABFCAllocator::NodeSubAllocator : public SubAllocator {
+ public:
+  NodeSubAllocator(NUMABFCAllocator* owner, int node)
+      : owner_(owner), node_(node) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes) override {
+    void* ptr = port::NUMAMalloc(node_, num_bytes, alignment);
+    if (ptr != nullptr) owner_->AddRegion(ptr, num_bytes, node_);
+    return ptr;
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    owner_->RemoveRegion(ptr);
+    port::NUMAFree(ptr, num_bytes);
+  }
+
+ private:
+  NUMABFCAllocator* const owner_;
+  const int node_;
+};
+
+NUMABFCAllocator::NUMABFCAllocator(int num_nodes, size_t memory_limit) {
+  CHECK_GT(num_nodes, 0);
+  arenas_.reserve(num_nodes);
+  for (int node = 0; node < num_nodes; ++node) {
+    arenas_.emplace_back(new BFCAllocator(
+        new NodeSubAllocator(this, node), memory_limit,
+        /*allow_growth=*/true, strings::StrCat("numa_bfc_node", node)));
+    arenas_.back()->EnableThreadCache(kThreadCacheBytes);
+  }
+}
+
+NUMABFCAllocator::~NUMABFCAllocator() {
+  // The arenas free their regions through RemoveRegion().
+  arenas_.clear();
+}
+
+NUMABFCAllocator* NUMABFCAllocator::Global() {
+  static NUMABFCAllocator* allocator =
+      new NUMABFCAllocator(port::NUMANumNodes(), PhysicalMemoryBytes());
+  return allocator;
+}
+
+BFCAllocator* NUMABFCAllocator::CurrentArena() {
+  const int node = port::NUMANodeOfCurrentCPU();
+  if (node < 0 || node >= static_cast<int>(arenas_.size())) {
+    return arenas_[0].get();
+  }
+  return arenas_[node].get();
+}
+
+BFCAllocator* NUMABFCAllocator::ArenaOf(const void* ptr) {
+  const int node = NodeOf(ptr);
+  CHECK_GE(node, 0) << "Pointer " << ptr << " was not allocated by "
+                    << Name();
+  return arenas_[node].get();
+}
+
+int NUMABFCAllocator::NodeOf(const void* ptr) {
+  const uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+  tf_shared_lock l(regions_mu_);
+  auto it = regions_.upper_bound(p);
+  if (it == regions_.begin()) return -1;
+  --it;
+  return p < it->second.end ? it->second.node : -1;
+}
+
+void NUMABFCAllocator::AddRegion(void* ptr, size_t num_bytes, int node) {
+  const uintptr_t start = reinterpret_cast<uintptr_t>(ptr);
+  mutex_lock l(regions_mu_);
+  regions_[start] = {start + num_bytes, node};
+}
+
+void NUMABFCAllocator::RemoveRegion(void* ptr) {
+  mutex_lock l(regions_mu_);
+  regions_.erase(reinterpret_cast<uintptr_t>(ptr));
+}
+
+void* NUMABFCAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  return CurrentArena()->AllocateRaw(alignment, num_bytes);
+}
+
+void* NUMABFCAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  return CurrentArena()->AllocateRaw(alignment, num_bytes, allocation_attr);
+}
+
+void NUMABFCAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  ArenaOf(ptr)->DeallocateRaw(ptr);
+}
+
+size_t NUMABFCAllocator::RequestedSize(void* ptr) {
+  return ArenaOf(ptr)->RequestedSize(ptr);
+}
+
+size_t NUMABFCAllocator::AllocatedSize(void* ptr) {
+  return ArenaOf(ptr)->AllocatedSize(ptr);
+}
+
+int64 NUMABFCAllocator::AllocationId(void* ptr) {
+  return ArenaOf(ptr)->AllocationId(ptr);
+}
+
+void NUMABFCAllocator::GetStats(AllocatorStats* stats) {
+  stats->Clear();
+  for (const auto& arena : arenas_) {
+    AllocatorStats arena_stats;
+    arena->GetStats(&arena_stats);
+    stats->num_allocs += arena_stats.num_allocs;
+    stats->bytes_in_use += arena_stats.bytes_in_use;
+    stats->max_bytes_in_use += arena_stats.max_bytes_in_use;
+    stats->max_alloc_size =
+        std::max(stats->max_alloc_size, arena_stats.max_alloc_size);
+    stats->bytes_limit += arena_stats.bytes_limit;
+    stats->bytes_reserved += arena_stats.bytes_reserved;
+    stats->num_chunk_splits += arena_stats.num_chunk_splits;
+    stats->num_chunk_merges += arena_stats.num_chunk_merges;
+    stats->num_region_extensions += arena_stats.num_region_extensions;
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_NUMA_BFC_ALLOCATOR_H_
+#define TENSORFLOW_COMMON_RUNTIME_NUMA_BFC_ALLOCATOR_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A CPU allocator with one BFCAllocator per NUMA node. Each allocation is
+// served by the arena of the node the calling thread is running on, whose
+// regions are backed by memory of that node, so that threads pinned to a
+// node (see ThreadAffinityProto) work on local memory. Memory may be freed
+// from any thread: it is returned to the arena it came from.
+//
+// Selected for CPU devices with ConfigProto.cpu_allocator_type = "NUMA_BFC".
+class NUMABFCAllocator : public Allocator {
+ public:
+  // 'num_nodes' is the number of arenas, and 'memory_limit' the limit of
+  // each of them.
+  NUMABFCAllocator(int num_nodes, size_t memory_limit);
+  ~NUMABFCAllocator() override;
+
+  // Returns the allocator shared by all the CPU devices of the process,
+  // with one arena per NUMA node of the host.
+  static NUMABFCAllocator* Global();
+
+  string Name() override { return "numa_bfc"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() override { return true; }
+  size_t RequestedSize(void* ptr) override;
+  size_t AllocatedSize(void* ptr) override;
+  int64 AllocationId(void* ptr) override;
+
+  // Sums the stats of all the arenas.
+  void GetStats(AllocatorStats* stats) override;
+
+  int num_nodes() const { return arenas_.size(); }
+
+  // Returns the node whose arena owns 'ptr', or -1 if none does.
+  int NodeOf(const void* ptr);
+
+ private:
+  class NodeSubAllocator;
+
+  // Returns the arena that allocations from the calling thread use.
+  BFCAllocator* CurrentArena();
+
+  // Returns the arena that owns 'ptr', which must have been allocated by
+  // this allocator.
+  BFCAllocator* ArenaOf(const void* ptr);
+
+  void AddRegion(void* ptr, size_t num_bytes, int node);
+  void RemoveRegion(void* ptr);
+
+  std::vector<std::unique_ptr<BFCAllocator>> arenas_;
+
+  struct Region {
+    uintptr_t end;
+    int node;
+  };
+  mutex regions_mu_;
+  // Maps the start of each region of the arenas to its end and node.
+  std::map<uintptr_t, Region> regions_ GUARDED_BY(regions_mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(NUMABFCAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_NUMA_BFC_ALLOCATOR_H_
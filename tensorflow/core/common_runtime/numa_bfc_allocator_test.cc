@@ -0,0 +1,73 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/numa_bfc_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(NUMABFCAllocatorTest, AllocateAndFree) {
+  NUMABFCAllocator allocator(2, 1 << 30);
+  EXPECT_EQ(2, allocator.num_nodes());
+
+  std::vector<void*> ptrs;
+  for (size_t size : {1, 100, 4096, 1 << 20}) {
+    void* ptr = allocator.AllocateRaw(64, size);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % 64);
+    EXPECT_GE(allocator.NodeOf(ptr), 0);
+    EXPECT_GE(allocator.AllocatedSize(ptr), size);
+    ptrs.push_back(ptr);
+  }
+  int dummy;
+  EXPECT_EQ(-1, allocator.NodeOf(&dummy));
+
+  AllocatorStats stats;
+  allocator.GetStats(&stats);
+  EXPECT_EQ(4, stats.num_allocs);
+  for (void* ptr : ptrs) {
+    allocator.DeallocateRaw(ptr);
+  }
+}
+
+TEST(NUMABFCAllocatorTest, FreeFromAnotherThread) {
+  NUMABFCAllocator allocator(port::NUMANumNodes(), 1 << 30);
+  std::vector<void*> ptrs(16, nullptr);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 4);
+    for (size_t i = 0; i < ptrs.size(); ++i) {
+      pool.Schedule([&allocator, &ptrs, i]() {
+        ptrs[i] = allocator.AllocateRaw(64, 1024 * (i + 1));
+      });
+    }
+  }
+  for (void* ptr : ptrs) {
+    ASSERT_NE(ptr, nullptr);
+    allocator.DeallocateRaw(ptr);
+  }
+  AllocatorStats stats;
+  allocator.GetStats(&stats);
+  EXPECT_EQ(0, stats.bytes_in_use);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 
@@ -131,6 +133,7 @@ class ColocationGraph {
     // performing any string allocations.
     std::unordered_map<StringPiece, const Node*, StringPieceHasher>
         colocation_group_root;
+    colocation_group_root.reserve(graph_->num_nodes());
 
     for (Node* node : graph_->nodes()) {
       if (!node->IsOp()) {
@@ -394,8 +397,7 @@ class ColocationGraph {
       if (device_set_->devices().empty()) {
         return errors::Internal("No devices are registered");
       }
-      devices = FilterSupportedDevices(
-          device_set_->devices(), members_[node_root].supported_device_types);
+      devices = SupportedDevices(members_[node_root].supported_device_types);
 
       if (devices.empty()) {
         return errors::InvalidArgument(
@@ -411,6 +413,27 @@ class ColocationGraph {
     return Status::OK();
   }
 
+  // Returns the devices of the device set that support all of
+  // 'supported_device_types', in placement order. Most colocation groups have
+  // no device specification and share a handful of supported device type
+  // sets, so each set is filtered and sorted only once.
+  const std::vector<Device*>& SupportedDevices(
+      const DeviceTypeVector& supported_device_types) {
+    string key;
+    for (const DeviceType& d : supported_device_types) {
+      strings::StrAppend(&key, d.type_string(), ",");
+    }
+    auto iter = supported_devices_.find(key);
+    if (iter == supported_devices_.end()) {
+      iter = supported_devices_
+                 .emplace(std::move(key),
+                          FilterSupportedDevices(device_set_->devices(),
+                                                 supported_device_types))
+                 .first;
+    }
+    return iter->second;
+  }
+
   Status InitializeMembers() {
     for (Node* node : graph_->nodes()) {
       if (!node->IsOp()) {
@@ -621,6 +644,9 @@ class ColocationGraph {
   const DeviceSet* device_set_;  // Not owned.
   const std::vector<DeviceType> device_types_;
   const bool allow_soft_placement_;
+  // Maps a joined list of supported device types to the result of
+  // FilterSupportedDevices() on all devices of device_set_.
+  std::unordered_map<string, std::vector<Device*>> supported_devices_;
 };
 
 // Returns true if the node has no inputs and produces outputs
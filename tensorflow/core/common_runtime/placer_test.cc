@@ -30,11 +30,13 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -1279,5 +1281,42 @@ TEST_F(PlacerTest, TestGeneratorNodeDoesntFollowNonColocatedConsumers) {
   EXPECT_DEVICE_TYPE(g, "in", "FakeGPU");
 }
 
+// Places a chain of 'num_nodes' TestRelu nodes on the 10 CPU and 10 GPU
+// devices, where each group of 8 consecutive nodes is colocated.
+static void BM_Placer(int iters, int num_nodes) {
+  testing::StopTiming();
+  std::vector<std::unique_ptr<Device>> local_devices;
+  DeviceSet devices;
+  for (int i = 0; i < 10; ++i) {
+    local_devices.emplace_back(FakeDevice::MakeCPU(
+        strings::StrCat("/job:a/replica:0/task:0/device:fakecpu:", i)));
+    devices.AddDevice(local_devices.back().get());
+    local_devices.emplace_back(FakeDevice::MakeGPU(
+        strings::StrCat("/job:a/replica:0/task:0/device:fakegpu:", i)));
+    devices.AddDevice(local_devices.back().get());
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_nodes);
+  for (int i = 0; i < iters; ++i) {
+    Graph graph(OpRegistry::Global());
+    Node* input;
+    TF_CHECK_OK(NodeBuilder("in", "TestCPUGPUOutput").Finalize(&graph, &input));
+    Node* last = input;
+    for (int n = 0; n < num_nodes; ++n) {
+      NodeBuilder builder(strings::StrCat("n", n), "TestRelu");
+      builder.Input(last);
+      if (n % 8 != 0) {
+        builder.Attr(kColocationAttrName,
+                     {strings::StrCat(kColocationGroupPrefix, "n", n - n % 8)});
+      }
+      TF_CHECK_OK(builder.Finalize(&graph, &last));
+    }
+    testing::StartTiming();
+    Placer placer(&graph, &devices);
+    TF_CHECK_OK(placer.Run());
+    testing::StopTiming();
+  }
+}
+BENCHMARK(BM_Placer)->Arg(10000)->Arg(100000)->Arg(1000000);
+
 }  // namespace
 }  // namespace tensorflow
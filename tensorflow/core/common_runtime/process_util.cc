@@ -17,6 +17,10 @@ limitations under the License.
 
 #include <string.h>
 
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
@@ -41,6 +45,22 @@ static thread::ThreadPool* InitComputePool(const SessionOptions& options) {
 
 }  // namespace
 
+Status ThreadOptionsFromAffinity(const ThreadAffinityProto& affinity,
+                                 ThreadOptions* thread_options) {
+  std::vector<int> cpus(affinity.cpus().begin(), affinity.cpus().end());
+  for (int node : affinity.numa_nodes()) {
+    std::vector<int> node_cpus;
+    if (!port::NUMANodeCPUs(node, &node_cpus)) {
+      return errors::InvalidArgument("Unknown NUMA node: ", node);
+    }
+    cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  thread_options->cpu_affinity = std::move(cpus);
+  return Status::OK();
+}
+
 thread::ThreadPool* ComputePool(const SessionOptions& options) {
   static thread::ThreadPool* compute_pool = InitComputePool(options);
   return compute_pool;
@@ -30,6 +30,11 @@ namespace tensorflow {
 // using 'options'.  Caller does not take ownership over threadpool.
 thread::ThreadPool* ComputePool(const SessionOptions& options);
 
+// Sets 'thread_options->cpu_affinity' to the CPUs selected by 'affinity'.
+// Returns an error if one of its NUMA nodes is unknown.
+Status ThreadOptionsFromAffinity(const ThreadAffinityProto& affinity,
+                                 ThreadOptions* thread_options);
+
 // Schedule "closure" in the default thread queue.
 void SchedClosure(std::function<void()> closure);
 
@@ -88,6 +88,13 @@ class RenamedDevice : public Device {
     return underlying_->MakeTensorFromProto(tensor_proto, alloc_attrs, tensor);
   }
 
+  Status MakeTensorFromHostTensor(const Tensor& host_tensor,
+                                  const AllocatorAttributes alloc_attrs,
+                                  Tensor* tensor) override {
+    return underlying_->MakeTensorFromHostTensor(host_tensor, alloc_attrs,
+                                                 tensor);
+  }
+
   // Below are virtual methods defined on Device
 
   void Compute(OpKernel* op_kernel, OpKernelContext* context) override {
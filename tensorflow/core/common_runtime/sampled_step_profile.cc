@@ -0,0 +1,75 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/sampled_step_profile.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/monitoring/sampler.h"
+
+namespace tensorflow {
+
+namespace {
+
+auto* op_latency_micros = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/op_latency_micros",
+     "Latency of the kernels timed on sampled steps, in microseconds.",
+     "op"},
+    // 1us to ~1000s.
+    monitoring::Buckets::Exponential(1.0, 2.0, 30));
+
+}  // namespace
+
+SampledStepProfile::SampledStepProfile(int node_period, int capacity)
+    : node_period_(node_period),
+      capacity_(std::max(capacity, 0)),
+      samples_(new Sample[capacity_]) {}
+
+void SampledStepProfile::Record(const string* op_type, int64 micros) {
+  const int64 i = next_.fetch_add(1, std::memory_order_relaxed);
+  if (i < capacity_) {
+    samples_[i].op_type = op_type;
+    samples_[i].micros = micros;
+  }
+}
+
+void SampledStepProfile::Flush() {
+  const int64 n = num_recorded();
+  // Looking up a cell takes the sampler's lock, so the records are grouped
+  // by op type and each group takes one lookup.
+  std::sort(samples_.get(), samples_.get() + n,
+            [](const Sample& a, const Sample& b) {
+              return *a.op_type < *b.op_type;
+            });
+  const string* cell_op_type = nullptr;
+  monitoring::SamplerCell* cell = nullptr;
+  for (int64 i = 0; i < n; ++i) {
+    if (cell_op_type == nullptr || *samples_[i].op_type != *cell_op_type) {
+      cell_op_type = samples_[i].op_type;
+      cell = op_latency_micros->GetCell(*cell_op_type);
+    }
+    cell->Add(static_cast<double>(samples_[i].micros));
+  }
+}
+
+int64 SampledStepProfile::num_recorded() const {
+  return std::min<int64>(next_.load(std::memory_order_relaxed), capacity_);
+}
+
+int64 SampledStepProfile::num_dropped() const {
+  return next_.load(std::memory_order_relaxed) - num_recorded();
+}
+
+}  // namespace tensorflow
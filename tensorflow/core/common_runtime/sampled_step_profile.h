@@ -0,0 +1,74 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLED_STEP_PROFILE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLED_STEP_PROFILE_H_
+
+#include <atomic>
+#include <memory>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Collects the kernel latencies of one sampled step. Unlike
+// StepStatsCollector, nothing is allocated and no lock is taken per node:
+// executor threads claim a slot of a buffer sized up front with one atomic
+// increment, and records beyond its capacity are dropped. Flush() adds the
+// records to the process-wide "/tensorflow/core/op_latency_micros"
+// histograms, which are labelled by op type and exported through the
+// monitoring CollectionRegistry.
+//
+// Record() is thread-safe. Flush() must be called once, after every
+// executor of the step is done.
+class SampledStepProfile {
+ public:
+  // Times the nodes whose id is a multiple of 'node_period' (every node if
+  // 'node_period' <= 1) and keeps at most 'capacity' records.
+  SampledStepProfile(int node_period, int capacity);
+
+  // Returns true if the node with id 'node_id' should be timed.
+  bool ShouldTime(int node_id) const {
+    return node_period_ <= 1 || node_id % node_period_ == 0;
+  }
+
+  // Records that a kernel of type 'op_type' ran for 'micros'. 'op_type' is
+  // not copied and must outlive Flush(); the type strings of the nodes of
+  // the executed graph qualify.
+  void Record(const string* op_type, int64 micros);
+
+  // Adds the records to the op latency histograms.
+  void Flush();
+
+  int64 num_recorded() const;
+  int64 num_dropped() const;
+
+ private:
+  struct Sample {
+    const string* op_type;
+    int64 micros;
+  };
+
+  const int node_period_;
+  const int capacity_;
+  std::unique_ptr<Sample[]> samples_;
+  std::atomic<int64> next_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SampledStepProfile);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLED_STEP_PROFILE_H_
@@ -0,0 +1,84 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/sampled_step_profile.h"
+
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the number of latencies recorded for 'op_type' so far.
+double NumLatencies(const string& op_type) {
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  options.collect_metric_descriptors = false;
+  auto metrics = monitoring::CollectionRegistry::Default()->CollectMetrics(
+      options);
+  auto it = metrics->point_set_map.find("/tensorflow/core/op_latency_micros");
+  if (it == metrics->point_set_map.end()) return 0;
+  for (const auto& point : it->second->points) {
+    if (point->labels.size() == 1 && point->labels[0].value == op_type) {
+      return point->histogram_value.num();
+    }
+  }
+  return 0;
+}
+
+TEST(SampledStepProfileTest, ShouldTime) {
+  SampledStepProfile every_node(0, 1);
+  EXPECT_TRUE(every_node.ShouldTime(0));
+  EXPECT_TRUE(every_node.ShouldTime(7));
+
+  SampledStepProfile every_third_node(3, 1);
+  EXPECT_TRUE(every_third_node.ShouldTime(0));
+  EXPECT_FALSE(every_third_node.ShouldTime(1));
+  EXPECT_FALSE(every_third_node.ShouldTime(2));
+  EXPECT_TRUE(every_third_node.ShouldTime(3));
+}
+
+TEST(SampledStepProfileTest, FlushAddsToHistograms) {
+  const string add = "SampledStepProfileTestAdd";
+  const string mul = "SampledStepProfileTestMul";
+  // The same op type may be recorded through different strings.
+  const string mul_copy = mul;
+  SampledStepProfile profile(1, 8);
+  profile.Record(&add, 5);
+  profile.Record(&mul, 10);
+  profile.Record(&add, 7);
+  profile.Record(&mul_copy, 1000);
+  EXPECT_EQ(4, profile.num_recorded());
+  EXPECT_EQ(0, profile.num_dropped());
+
+  profile.Flush();
+  EXPECT_EQ(2, NumLatencies(add));
+  EXPECT_EQ(2, NumLatencies(mul));
+}
+
+TEST(SampledStepProfileTest, DropsRecordsBeyondCapacity) {
+  const string op = "SampledStepProfileTestDropped";
+  SampledStepProfile profile(1, 2);
+  for (int i = 0; i < 5; ++i) {
+    profile.Record(&op, i);
+  }
+  EXPECT_EQ(2, profile.num_recorded());
+  EXPECT_EQ(3, profile.num_dropped());
+
+  profile.Flush();
+  EXPECT_EQ(2, NumLatencies(op));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,453 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The allocations of a step are identified by the id of the node that made
+// them and the number of allocations that node made before them.
+inline int64 AllocationKey(int node_id, int64 index) {
+  return (static_cast<int64>(node_id) << 32) | index;
+}
+
+inline size_t RoundUpToAlignment(size_t num_bytes) {
+  const size_t alignment = Allocator::kAllocatorAlignment;
+  return (num_bytes + alignment - 1) / alignment * alignment;
+}
+
+// A StepArena that owns one Allocator per node id, each forwarding to
+// Allocate() and Deallocate().
+class NodeAllocatingArena : public StepArena {
+ public:
+  explicit NodeAllocatingArena(int num_node_ids)
+      : num_node_ids_(num_node_ids),
+        node_allocators_(new NodeAllocatorImpl[num_node_ids]) {
+    for (int i = 0; i < num_node_ids; ++i) {
+      node_allocators_[i].Init(this, i);
+    }
+  }
+
+  Allocator* NodeAllocator(int node_id) override {
+    DCHECK_GE(node_id, 0);
+    DCHECK_LT(node_id, num_node_ids_);
+    return &node_allocators_[node_id];
+  }
+
+ protected:
+  // Every successful Allocate() must take a reference on the arena, which
+  // the matching Deallocate() releases.
+  virtual void* Allocate(int node_id, size_t alignment, size_t num_bytes) = 0;
+  virtual void Deallocate(void* ptr) = 0;
+
+  const int num_node_ids_;
+
+ private:
+  class NodeAllocatorImpl : public Allocator {
+   public:
+    void Init(NodeAllocatingArena* arena, int node_id) {
+      arena_ = arena;
+      node_id_ = node_id;
+    }
+
+    string Name() override { return "step_arena"; }
+
+    void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+      return arena_->Allocate(node_id_, alignment, num_bytes);
+    }
+
+    void DeallocateRaw(void* ptr) override { arena_->Deallocate(ptr); }
+
+   private:
+    NodeAllocatingArena* arena_ = nullptr;
+    int node_id_ = -1;
+  };
+
+  std::unique_ptr<NodeAllocatorImpl[]> node_allocators_;
+};
+
+}  // namespace
+
+struct StepMemoryPlanner::Plan {
+  struct Block {
+    size_t offset;
+    size_t num_bytes;
+    // Blocks whose memory overlaps this one.
+    std::vector<int> conflicts;
+  };
+  std::vector<Block> blocks;
+  gtl::FlatMap<int64, int> block_for_key;
+  gtl::FlatMap<size_t, gtl::InlinedVector<int, 2>> blocks_at_offset;
+  size_t slab_bytes = 0;
+};
+
+// The arena of the recorded step. Allocates everything from the base
+// allocator and notes the order in which allocations are made and freed.
+class StepMemoryPlanner::RecordingArena : public NodeAllocatingArena {
+ public:
+  RecordingArena(Allocator* base, int num_node_ids)
+      : NodeAllocatingArena(num_node_ids),
+        base_(base),
+        num_allocations_(num_node_ids, 0) {}
+
+  // Stops recording and returns the plan for the allocations that were
+  // made and freed while recording.
+  std::shared_ptr<const Plan> FinishRecording() {
+    std::vector<Record> records;
+    {
+      mutex_lock l(mu_);
+      recording_ = false;
+      for (const Record& r : records_) {
+        if (r.freed >= 0) records.push_back(r);
+      }
+      records_.clear();
+      live_.clear();
+    }
+    return BuildPlan(records);
+  }
+
+ protected:
+  void* Allocate(int node_id, size_t alignment, size_t num_bytes) override {
+    void* ptr = base_->AllocateRaw(alignment, num_bytes);
+    if (ptr == nullptr) return nullptr;
+    Ref();
+    mutex_lock l(mu_);
+    const int64 index = num_allocations_[node_id]++;
+    if (recording_ && num_bytes > 0 &&
+        alignment <= Allocator::kAllocatorAlignment) {
+      live_[ptr] = records_.size();
+      records_.push_back({AllocationKey(node_id, index),
+                          RoundUpToAlignment(num_bytes), clock_++, -1});
+    }
+    return ptr;
+  }
+
+  void Deallocate(void* ptr) override {
+    {
+      mutex_lock l(mu_);
+      if (recording_) {
+        auto it = live_.find(ptr);
+        if (it != live_.end()) {
+          records_[it->second].freed = clock_++;
+          live_.erase(it);
+        }
+      }
+    }
+    base_->DeallocateRaw(ptr);
+    Unref();
+  }
+
+ private:
+  struct Record {
+    int64 key;
+    size_t num_bytes;
+    int64 allocated;
+    int64 freed;  // -1 while the allocation is live.
+  };
+
+  static bool LiveTogether(const Record& a, const Record& b) {
+    return a.allocated < b.freed && b.allocated < a.freed;
+  }
+
+  // Assigns offsets to "records" greedily, largest first: each record goes
+  // into the smallest gap left by the records already placed that are live
+  // at the same time as it, or after all of them. This is quadratic in the
+  // number of records, but only runs once per planner.
+  static std::shared_ptr<const Plan> BuildPlan(
+      const std::vector<Record>& records) {
+    std::shared_ptr<Plan> plan(new Plan);
+    const int n = records.size();
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&records](int a, int b) {
+      if (records[a].num_bytes != records[b].num_bytes) {
+        return records[a].num_bytes > records[b].num_bytes;
+      }
+      return records[a].allocated < records[b].allocated;
+    });
+
+    plan->blocks.resize(n);
+    std::vector<int> placed;
+    std::vector<std::pair<size_t, size_t>> busy;
+    for (int i : order) {
+      const size_t num_bytes = records[i].num_bytes;
+      busy.clear();
+      for (int j : placed) {
+        if (LiveTogether(records[i], records[j])) {
+          const size_t offset = plan->blocks[j].offset;
+          busy.emplace_back(offset, offset + records[j].num_bytes);
+        }
+      }
+      std::sort(busy.begin(), busy.end());
+      size_t best = std::numeric_limits<size_t>::max();
+      size_t best_gap = std::numeric_limits<size_t>::max();
+      size_t end = 0;
+      for (const auto& range : busy) {
+        if (range.first > end) {
+          const size_t gap = range.first - end;
+          if (gap >= num_bytes && gap < best_gap) {
+            best = end;
+            best_gap = gap;
+          }
+        }
+        end = std::max(end, range.second);
+      }
+      if (best == std::numeric_limits<size_t>::max()) best = end;
+      plan->blocks[i].offset = best;
+      plan->blocks[i].num_bytes = num_bytes;
+      plan->slab_bytes = std::max(plan->slab_bytes, best + num_bytes);
+      placed.push_back(i);
+    }
+
+    // Find the blocks that overlap in memory by sweeping them in offset
+    // order.
+    std::sort(order.begin(), order.end(), [&plan](int a, int b) {
+      return plan->blocks[a].offset < plan->blocks[b].offset;
+    });
+    for (int x = 0; x < n; ++x) {
+      Plan::Block* a = &plan->blocks[order[x]];
+      const size_t a_end = a->offset + a->num_bytes;
+      for (int y = x + 1; y < n && plan->blocks[order[y]].offset < a_end;
+           ++y) {
+        a->conflicts.push_back(order[y]);
+        plan->blocks[order[y]].conflicts.push_back(order[x]);
+      }
+    }
+    for (int i = 0; i < n; ++i) {
+      plan->block_for_key[records[i].key] = i;
+      plan->blocks_at_offset[plan->blocks[i].offset].push_back(i);
+    }
+    return plan;
+  }
+
+  Allocator* const base_;  // Not owned.
+
+  mutex mu_;
+  bool recording_ GUARDED_BY(mu_) = true;
+  int64 clock_ GUARDED_BY(mu_) = 0;
+  std::vector<int64> num_allocations_ GUARDED_BY(mu_);
+  std::vector<Record> records_ GUARDED_BY(mu_);
+  // Maps the live recorded allocations to their index in records_.
+  gtl::FlatMap<void*, size_t> live_ GUARDED_BY(mu_);
+};
+
+// The arena of a planned step. Serves planned allocations from their offset
+// in a slab when no overlapping block is live, and everything else from the
+// base allocator.
+class StepMemoryPlanner::PlannedArena : public NodeAllocatingArena {
+ public:
+  PlannedArena(Allocator* base, int num_node_ids,
+               std::shared_ptr<const Plan> plan)
+      : NodeAllocatingArena(num_node_ids),
+        base_(base),
+        plan_(std::move(plan)),
+        slab_(static_cast<char*>(base->AllocateRaw(
+            Allocator::kAllocatorAlignment, plan_->slab_bytes))),
+        num_allocations_(new std::atomic<int64>[num_node_ids]),
+        states_(new std::atomic<int>[plan_->blocks.size()]) {
+    Reset();
+  }
+
+  ~PlannedArena() override {
+    if (slab_ != nullptr) base_->DeallocateRaw(slab_);
+  }
+
+  bool ok() const { return slab_ != nullptr; }
+
+  // Returns true if no planned block is live.
+  bool AllPlannedMemoryFreed() const { return num_live_.load() == 0; }
+
+  // Prepares the arena for another step. Must not be called while memory
+  // is being allocated from the arena.
+  void Reset() {
+    for (int i = 0; i < num_node_ids_; ++i) {
+      num_allocations_[i].store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < plan_->blocks.size(); ++i) {
+      states_[i].store(kFree, std::memory_order_relaxed);
+    }
+    num_live_.store(0);
+  }
+
+ protected:
+  void* Allocate(int node_id, size_t alignment, size_t num_bytes) override {
+    const int64 index =
+        num_allocations_[node_id].fetch_add(1, std::memory_order_relaxed);
+    void* ptr = nullptr;
+    if (num_bytes > 0 && alignment <= Allocator::kAllocatorAlignment) {
+      auto it = plan_->block_for_key.find(AllocationKey(node_id, index));
+      if (it != plan_->block_for_key.end()) {
+        const Plan::Block& block = plan_->blocks[it->second];
+        if (RoundUpToAlignment(num_bytes) <= block.num_bytes &&
+            Acquire(it->second)) {
+          ptr = slab_ + block.offset;
+        }
+      }
+    }
+    if (ptr == nullptr) {
+      ptr = base_->AllocateRaw(alignment, num_bytes);
+      if (ptr == nullptr) return nullptr;
+    }
+    Ref();
+    return ptr;
+  }
+
+  void Deallocate(void* ptr) override {
+    char* p = static_cast<char*>(ptr);
+    if (p >= slab_ && p < slab_ + plan_->slab_bytes) {
+      Release(p - slab_);
+    } else {
+      base_->DeallocateRaw(ptr);
+    }
+    Unref();
+  }
+
+ private:
+  // The states of a block. A block is kAcquiring while its allocation
+  // checks that the blocks it overlaps are free.
+  enum { kFree = 0, kAcquiring = 1, kLive = 2 };
+
+  bool Acquire(int b) {
+    int expected = kFree;
+    if (!states_[b].compare_exchange_strong(expected, kAcquiring)) {
+      return false;
+    }
+    for (int c : plan_->blocks[b].conflicts) {
+      if (states_[c].load() != kFree) {
+        states_[b].store(kFree);
+        return false;
+      }
+    }
+    states_[b].store(kLive);
+    num_live_.fetch_add(1);
+    return true;
+  }
+
+  void Release(size_t offset) {
+    auto it = plan_->blocks_at_offset.find(offset);
+    CHECK(it != plan_->blocks_at_offset.end());
+    // At most one of the blocks at an offset can be live at a time.
+    for (int b : it->second) {
+      int expected = kLive;
+      if (states_[b].compare_exchange_strong(expected, kFree)) {
+        num_live_.fetch_sub(1);
+        return;
+      }
+    }
+    LOG(FATAL) << "Freed step arena memory at offset " << offset
+               << " that is not live";
+  }
+
+  Allocator* const base_;  // Not owned.
+  const std::shared_ptr<const Plan> plan_;
+  char* const slab_;
+  std::unique_ptr<std::atomic<int64>[]> num_allocations_;
+  std::unique_ptr<std::atomic<int>[]> states_;
+  std::atomic<int> num_live_{0};
+};
+
+StepMemoryPlanner::StepMemoryPlanner(Allocator* base, int num_node_ids)
+    : base_(base), num_node_ids_(num_node_ids) {}
+
+StepMemoryPlanner::~StepMemoryPlanner() {
+  for (PlannedArena* arena : free_arenas_) {
+    arena->Unref();
+  }
+}
+
+StepArena* StepMemoryPlanner::BeginStep() {
+  mutex_lock l(mu_);
+  if (plan_ == nullptr) {
+    if (recording_ != nullptr) return nullptr;
+    recording_ = new RecordingArena(base_, num_node_ids_);
+    return recording_;
+  }
+  if (plan_->blocks.empty()) return nullptr;
+  if (!free_arenas_.empty()) {
+    PlannedArena* arena = free_arenas_.back();
+    free_arenas_.pop_back();
+    return arena;
+  }
+  PlannedArena* arena = new PlannedArena(base_, num_node_ids_, plan_);
+  if (!arena->ok()) {
+    LOG(WARNING) << "Could not allocate a step arena of " << plan_->slab_bytes
+                 << " bytes from " << base_->Name();
+    arena->Unref();
+    return nullptr;
+  }
+  return arena;
+}
+
+void StepMemoryPlanner::EndStep(StepArena* arena) {
+  if (arena == nullptr) return;
+  RecordingArena* recording = nullptr;
+  {
+    mutex_lock l(mu_);
+    if (arena == recording_) {
+      recording = recording_;
+    } else {
+      PlannedArena* planned = static_cast<PlannedArena*>(arena);
+      if (planned->AllPlannedMemoryFreed()) {
+        planned->Reset();
+        free_arenas_.push_back(planned);
+      } else {
+        // Some planned memory outlives the step; the arena is deleted once
+        // it is freed.
+        planned->Unref();
+      }
+      return;
+    }
+  }
+  // Build the plan outside of mu_. Steps that begin meanwhile still see
+  // recording_ and run without an arena.
+  std::shared_ptr<const Plan> plan = recording->FinishRecording();
+  VLOG(1) << "Planned " << plan->blocks.size() << " allocations in a "
+          << plan->slab_bytes << " byte step arena on " << base_->Name();
+  {
+    mutex_lock l(mu_);
+    plan_ = std::move(plan);
+    recording_ = nullptr;
+  }
+  recording->Unref();
+}
+
+bool StepMemoryPlanner::HasPlan() const {
+  mutex_lock l(mu_);
+  return plan_ != nullptr;
+}
+
+size_t StepMemoryPlanner::PlannedBytes() const {
+  mutex_lock l(mu_);
+  return plan_ == nullptr ? 0 : plan_->slab_bytes;
+}
+
+int StepMemoryPlanner::NumPlannedAllocations() const {
+  mutex_lock l(mu_);
+  return plan_ == nullptr ? 0 : plan_->blocks.size();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,117 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
+#define TENSORFLOW_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The memory that the nodes of one step of an executor allocate through
+// OpKernelContext::get_allocator(). A StepArena hands out one allocator per
+// node id; the executor passes NodeAllocator(id) to the kernel of node "id"
+// in OpKernelContext::Params::step_arena_allocator.
+//
+// Memory allocated from a StepArena may outlive the step (e.g. a fetched
+// tensor). The arena is reference counted and stays alive until the last
+// such allocation is freed.
+class StepArena : public core::RefCounted {
+ public:
+  // Returns the allocator to use for the node with id "node_id". The
+  // returned allocator is owned by the arena.
+  virtual Allocator* NodeAllocator(int node_id) = 0;
+};
+
+// StepMemoryPlanner plans the memory of the steps of one executor so that
+// allocations whose lifetimes do not overlap share the same addresses in a
+// single slab that is allocated once and reused from step to step.
+//
+// The first step that calls BeginStep() is recorded: every allocation is
+// identified by the id of the node that made it and how many allocations
+// that node had made before it, and its size and the order of its
+// allocation and deallocation are noted. When that step ends, allocations
+// that were also freed during the step are given offsets in a slab, packed
+// greedily so that two allocations share memory only if they were not live
+// at the same time. Allocations that outlived the step are not planned.
+//
+// Later steps get an arena that serves each planned allocation from its
+// offset in the slab. Since the schedule of a step may differ from the
+// recorded one, an allocation is only placed at its offset if no other
+// allocation overlapping it in the slab is live; otherwise, and for every
+// allocation that is not planned, the arena falls back to the base
+// allocator. Arenas whose planned memory has all been freed by the end of
+// their step are recycled for later steps.
+//
+// Memory plans only the default allocator attributes of one device; the
+// base allocator must be the allocator that device returns for them.
+//
+// Thread-safe. Several steps may run concurrently; steps that start while
+// the first step is being recorded run without an arena.
+class StepMemoryPlanner {
+ public:
+  // "base" is not owned and must outlive the planner and all the memory
+  // allocated from its arenas. "num_node_ids" is the number of node ids of
+  // the graph being planned.
+  StepMemoryPlanner(Allocator* base, int num_node_ids);
+  ~StepMemoryPlanner();
+
+  // Returns the arena that the next step should allocate from, or nullptr
+  // if the step should allocate directly from the base allocator.
+  StepArena* BeginStep();
+
+  // Called once the step that called BeginStep() and got "arena" has
+  // finished running. "arena" may be nullptr.
+  void EndStep(StepArena* arena);
+
+  // Returns true if the first step has been recorded and planned.
+  bool HasPlan() const;
+
+  // Returns the size of the slab of the plan, or 0 if there is no plan.
+  size_t PlannedBytes() const;
+
+  // Returns the number of allocations in the plan.
+  int NumPlannedAllocations() const;
+
+ private:
+  struct Plan;
+  class RecordingArena;
+  class PlannedArena;
+
+  Allocator* const base_;  // Not owned.
+  const int num_node_ids_;
+
+  mutable mutex mu_;
+  // The arena of the step being recorded, if any. Not owned.
+  RecordingArena* recording_ GUARDED_BY(mu_) = nullptr;
+  std::shared_ptr<const Plan> plan_ GUARDED_BY(mu_);
+  // Arenas of steps that returned all their planned memory, each holding
+  // the reference it was created with.
+  std::vector<PlannedArena*> free_arenas_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepMemoryPlanner);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMMON_RUNTIME_STEP_MEMORY_PLANNER_H_
@@ -0,0 +1,134 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_memory_planner.h"
+
+#include <cstring>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+void* Alloc(StepArena* arena, int node_id, size_t num_bytes) {
+  return arena->NodeAllocator(node_id)->AllocateRaw(
+      Allocator::kAllocatorAlignment, num_bytes);
+}
+
+void Free(StepArena* arena, int node_id, void* ptr) {
+  arena->NodeAllocator(node_id)->DeallocateRaw(ptr);
+}
+
+// Runs a step of three nodes where node 0's output is freed before node 2
+// allocates, so the two can share memory.
+void RunChainStep(StepArena* arena, void** ptrs) {
+  ptrs[0] = Alloc(arena, 0, 1000);
+  ptrs[1] = Alloc(arena, 1, 1000);
+  Free(arena, 0, ptrs[0]);
+  ptrs[2] = Alloc(arena, 2, 1000);
+  Free(arena, 1, ptrs[1]);
+  Free(arena, 2, ptrs[2]);
+}
+
+TEST(StepMemoryPlannerTest, ReusesMemoryOfDisjointLifetimes) {
+  StepMemoryPlanner planner(cpu_allocator(), 3);
+  EXPECT_FALSE(planner.HasPlan());
+
+  StepArena* recording = planner.BeginStep();
+  ASSERT_NE(nullptr, recording);
+  // A concurrent step is not recorded.
+  EXPECT_EQ(nullptr, planner.BeginStep());
+  void* ptrs[3];
+  RunChainStep(recording, ptrs);
+  planner.EndStep(recording);
+
+  ASSERT_TRUE(planner.HasPlan());
+  EXPECT_EQ(3, planner.NumPlannedAllocations());
+  const size_t block = 1024;  // 1000 rounded up to the alignment.
+  EXPECT_EQ(2 * block, planner.PlannedBytes());
+
+  for (int step = 0; step < 3; ++step) {
+    StepArena* arena = planner.BeginStep();
+    ASSERT_NE(nullptr, arena);
+    void* planned[3];
+    planned[0] = Alloc(arena, 0, 1000);
+    planned[1] = Alloc(arena, 1, 1000);
+    EXPECT_NE(planned[0], planned[1]);
+    Free(arena, 0, planned[0]);
+    planned[2] = Alloc(arena, 2, 1000);
+    EXPECT_EQ(planned[0], planned[2]);
+    Free(arena, 1, planned[1]);
+    Free(arena, 2, planned[2]);
+    planner.EndStep(arena);
+  }
+}
+
+TEST(StepMemoryPlannerTest, FallsBackWhenScheduleDiffers) {
+  StepMemoryPlanner planner(cpu_allocator(), 3);
+  StepArena* recording = planner.BeginStep();
+  void* ptrs[3];
+  RunChainStep(recording, ptrs);
+  planner.EndStep(recording);
+
+  // Node 2 now allocates before node 0 frees, so it cannot use the memory
+  // planned for it.
+  StepArena* arena = planner.BeginStep();
+  ASSERT_NE(nullptr, arena);
+  void* a = Alloc(arena, 0, 1000);
+  void* b = Alloc(arena, 1, 1000);
+  void* c = Alloc(arena, 2, 1000);
+  EXPECT_NE(a, c);
+  EXPECT_NE(b, c);
+  // An allocation larger than planned also comes from the base allocator.
+  void* d = Alloc(arena, 1, 4096);
+  EXPECT_NE(nullptr, d);
+  Free(arena, 0, a);
+  Free(arena, 1, b);
+  Free(arena, 2, c);
+  Free(arena, 1, d);
+  planner.EndStep(arena);
+}
+
+TEST(StepMemoryPlannerTest, MemoryOutlivingTheStep) {
+  StepMemoryPlanner planner(cpu_allocator(), 3);
+  StepArena* recording = planner.BeginStep();
+  void* ptrs[3];
+  RunChainStep(recording, ptrs);
+  // Node 0 makes a second allocation that survives the recorded step; it
+  // is not planned.
+  void* escaped = Alloc(recording, 0, 64);
+  planner.EndStep(recording);
+  EXPECT_EQ(3, planner.NumPlannedAllocations());
+  Free(recording, 0, escaped);
+
+  // A planned allocation survives a later step: the arena is not reused
+  // and its memory stays valid until it is freed.
+  StepArena* arena = planner.BeginStep();
+  void* a = Alloc(arena, 0, 1000);
+  memset(a, 1, 1000);
+  planner.EndStep(arena);
+  StepArena* next = planner.BeginStep();
+  EXPECT_NE(arena, next);
+  void* b = Alloc(next, 0, 1000);
+  EXPECT_NE(a, b);
+  Free(next, 0, b);
+  planner.EndStep(next);
+  EXPECT_EQ(1, static_cast<char*>(a)[999]);
+  Free(arena, 0, a);
+}
+
+}  // namespace
+}  // namespace tensorflow
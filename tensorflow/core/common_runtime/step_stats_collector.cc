@@ -278,6 +278,34 @@ void StepStatsCollector::Save(const string& device,
   }
 }
 
+void StepStatsCollector::AddDeviceComputeTime(
+    const std::unordered_map<string, int64>& micros_by_node) {
+  if (micros_by_node.empty()) return;
+  mutex_lock l(mu_);
+  for (auto& dev_stat : dev_stats_) {
+    for (auto& stats : dev_stat.second) {
+      NodeExecStats* ns = stats->stats();
+      auto it = micros_by_node.find(ns->node_name());
+      if (it != micros_by_node.end()) {
+        ns->set_device_compute_micros(ns->device_compute_micros() +
+                                      it->second);
+      }
+    }
+  }
+}
+
+void StepStatsCollector::SaveAllocatorTimeline(const string& device,
+                                               AllocatorTimeline* timeline) {
+  mutex_lock l(mu_);
+  if (finalized_) {
+    LOG(WARNING) << "stats saved after finalize will not be collected.";
+  }
+  if (!step_stats_) return;
+  auto& timelines = allocator_timelines_[device];
+  timelines.emplace_back();
+  timelines.back().Swap(timeline);
+}
+
 string StepStatsCollector::ReportAllocsOnResourceExhausted(const string& err) {
   mutex_lock l(mu_);
   if (err.find("OOM") == err.npos) {
@@ -391,5 +419,17 @@ void StepStatsCollector::FinalizeInternal() {
       stats->stats()->Swap(dss->add_node_stats());
     }
   }
+  for (auto& timelines : allocator_timelines_) {
+    if (dev_stats_pb.find(timelines.first) == dev_stats_pb.end()) {
+      DeviceStepStats* ndev_stat = step_stats_->add_dev_stats();
+      ndev_stat->set_device(timelines.first);
+      dev_stats_pb[timelines.first] = ndev_stat;
+    }
+    DeviceStepStats* dss = dev_stats_pb.at(timelines.first);
+    for (auto& timeline : timelines.second) {
+      timeline.Swap(dss->add_allocator_timelines());
+    }
+  }
+  allocator_timelines_.clear();
 }
 }  // namespace tensorflow
@@ -82,6 +82,18 @@ class StepStatsCollector {
   void Save(const string& device, NodeExecStats* nt);
   void Save(const string& device, NodeExecStatsWrapper* stats);
 
+  // Adds micros_by_node[name] to the device_compute_micros of the node
+  // stats saved so far whose node name is 'name'. Used by DeviceTracers to
+  // fold the kernel time of each node into the stats the executor saved
+  // for it. Should be called before Finalize.
+  void AddDeviceComputeTime(
+      const std::unordered_map<string, int64>& micros_by_node);
+
+  // Saves the memory-usage timeline of one of the allocators of device to
+  // the DeviceStats object associated with device. The content of
+  // *timeline is moved out. Should be called before Finalize.
+  void SaveAllocatorTimeline(const string& device, AllocatorTimeline* timeline);
+
   // Generates a string reporting the currently used memory based
   // on ResourceExhausted OOM `err` message.
   // `err` message needs to contain device name and allocator name, E.g.:
@@ -106,6 +118,8 @@ class StepStatsCollector {
   mutex mu_;
   bool finalized_ GUARDED_BY(mu_);
   std::unordered_map<string, NodeExecStatsVec> dev_stats_ GUARDED_BY(mu_);
+  std::unordered_map<string, std::vector<AllocatorTimeline>>
+      allocator_timelines_ GUARDED_BY(mu_);
   StepStats* step_stats_ GUARDED_BY(mu_);
   uint64 collectedNodes GUARDED_BY(mu_) = 0;
 };
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <vector>
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/numa_bfc_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -35,10 +36,20 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
     if (iter != options.config.device_count().end()) {
       n = iter->second;
     }
+    Allocator* allocator;
+    const string& allocator_type = options.config.cpu_allocator_type();
+    if (allocator_type.empty()) {
+      allocator = cpu_allocator();
+    } else if (allocator_type == "NUMA_BFC") {
+      allocator = NUMABFCAllocator::Global();
+    } else {
+      return errors::InvalidArgument("Invalid cpu_allocator_type: ",
+                                     allocator_type);
+    }
     for (int i = 0; i < n; i++) {
       string name = strings::StrCat(name_prefix, "/device:CPU:", i);
       devices->push_back(new ThreadPoolDevice(
-          options, name, Bytes(256 << 20), DeviceLocality(), cpu_allocator()));
+          options, name, Bytes(256 << 20), DeviceLocality(), allocator));
     }
 
     return Status::OK();
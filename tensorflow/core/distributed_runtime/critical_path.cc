@@ -0,0 +1,133 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/critical_path.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The span of a node over all of its NodeExecStats, e.g. on the device and
+// on the GPU streams.
+struct NodeSpan {
+  string device;
+  int64 start_micros = 0;
+  int64 end_micros = 0;
+};
+
+string TaskName(const string& device) {
+  string task;
+  string local;
+  if (DeviceNameUtils::SplitDeviceName(device, &task, &local)) {
+    return task;
+  }
+  return device;
+}
+
+}  // namespace
+
+void ComputeCriticalPath(const Graph& graph, const StepStats& step_stats,
+                         CriticalPath* path) {
+  path->Clear();
+  std::unordered_map<string, const Node*> nodes;
+  for (const Node* n : graph.nodes()) {
+    nodes[n->name()] = n;
+  }
+  std::unordered_map<const Node*, NodeSpan> spans;
+  for (const DeviceStepStats& ds : step_stats.dev_stats()) {
+    for (const NodeExecStats& ns : ds.node_stats()) {
+      auto it = nodes.find(ns.node_name());
+      if (it == nodes.end()) continue;
+      const int64 start = ns.all_start_micros();
+      const int64 end = start + ns.all_end_rel_micros();
+      auto inserted = spans.insert({it->second, NodeSpan()});
+      NodeSpan* span = &inserted.first->second;
+      if (inserted.second) {
+        span->device = ds.device();
+        span->start_micros = start;
+        span->end_micros = end;
+      } else {
+        span->start_micros = std::min(span->start_micros, start);
+        span->end_micros = std::max(span->end_micros, end);
+      }
+    }
+  }
+  if (spans.empty()) return;
+
+  const Node* last = nullptr;
+  for (const auto& it : spans) {
+    if (last == nullptr || it.second.end_micros > spans[last].end_micros) {
+      last = it.first;
+    }
+  }
+  // Walks back through the latest input. The visited set stops the walk on
+  // the back edges of loops.
+  std::vector<const Node*> chain;
+  std::unordered_set<const Node*> visited;
+  for (const Node* n = last; n != nullptr;) {
+    chain.push_back(n);
+    visited.insert(n);
+    const Node* latest = nullptr;
+    int64 latest_end = 0;
+    for (const Edge* e : n->in_edges()) {
+      const Node* src = e->src();
+      if (visited.count(src) > 0) continue;
+      auto it = spans.find(src);
+      if (it == spans.end()) continue;
+      if (latest == nullptr || it->second.end_micros > latest_end) {
+        latest = src;
+        latest_end = it->second.end_micros;
+      }
+    }
+    n = latest;
+  }
+  std::reverse(chain.begin(), chain.end());
+
+  const NodeSpan* prev = nullptr;
+  for (const Node* n : chain) {
+    const NodeSpan& span = spans[n];
+    CriticalPath::Node* node = path->add_nodes();
+    node->set_node_name(n->name());
+    node->set_device(span.device);
+    node->set_start_micros(span.start_micros);
+    node->set_end_micros(span.end_micros);
+    const string task = TaskName(span.device);
+    (*path->mutable_compute_micros())[task] +=
+        span.end_micros - span.start_micros;
+    if (prev != nullptr && span.start_micros > prev->end_micros) {
+      const int64 gap = span.start_micros - prev->end_micros;
+      const string prev_task = TaskName(prev->device);
+      if (prev_task == task) {
+        (*path->mutable_wait_micros())[task] += gap;
+      } else {
+        (*path->mutable_transfer_micros())[strings::StrCat(
+            prev_task, " -> ", task)] += gap;
+      }
+    }
+    prev = &span;
+  }
+  path->set_total_micros(spans[last].end_micros -
+                         spans[chain.front()].start_micros);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,38 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_CRITICAL_PATH_H_
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// Computes the critical path of a step of "graph" from the NodeExecStats of
+// "step_stats", as described in the CriticalPath proto.
+//
+// The path starts at the node of "graph" that finished last and repeatedly
+// moves to the data or control input that finished last, so it only goes
+// through nodes that have stats. Nodes of "step_stats" that are not in
+// "graph", such as the Send/Recv nodes added by partitioning or the
+// RecvTensor records of the RPC logs, are ignored: the time they took shows
+// up as the transfer or wait gap between the nodes they connect.
+void ComputeCriticalPath(const Graph& graph, const StepStats& step_stats,
+                         CriticalPath* path);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_CRITICAL_PATH_H_
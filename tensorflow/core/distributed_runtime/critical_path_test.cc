@@ -0,0 +1,81 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/critical_path.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+const char kTask0[] = "/job:worker/replica:0/task:0";
+const char kTask1[] = "/job:worker/replica:0/task:1";
+
+void AddStats(const string& task, const Node* node, int64 start, int64 end,
+              StepStats* step_stats) {
+  DeviceStepStats* ds = step_stats->add_dev_stats();
+  ds->set_device(strings::StrCat(task, "/device:CPU:0"));
+  NodeExecStats* ns = ds->add_node_stats();
+  ns->set_node_name(node->name());
+  ns->set_all_start_micros(start);
+  ns->set_all_end_rel_micros(end - start);
+}
+
+TEST(CriticalPathTest, FollowsLatestInput) {
+  Graph graph(OpRegistry::Global());
+  Node* a = test::graph::Constant(&graph, test::AsScalar<float>(1));
+  Node* b = test::graph::Constant(&graph, test::AsScalar<float>(2));
+  Node* sum = test::graph::Add(&graph, a, b);
+  Node* neg = test::graph::Unary(&graph, "Neg", sum);
+
+  StepStats step_stats;
+  AddStats(kTask0, a, 0, 10, &step_stats);
+  // "b" finishes after "a", so the path goes through it.
+  AddStats(kTask1, b, 5, 20, &step_stats);
+  AddStats(kTask0, sum, 50, 60, &step_stats);
+  AddStats(kTask0, neg, 65, 70, &step_stats);
+  // Not in the graph.
+  DeviceStepStats* rpc = step_stats.add_dev_stats();
+  rpc->set_device(strings::StrCat(kTask0, "/device:CPU:0"));
+  rpc->add_node_stats()->set_node_name("RecvTensor");
+
+  CriticalPath path;
+  ComputeCriticalPath(graph, step_stats, &path);
+  ASSERT_EQ(3, path.nodes_size());
+  EXPECT_EQ(b->name(), path.nodes(0).node_name());
+  EXPECT_EQ(sum->name(), path.nodes(1).node_name());
+  EXPECT_EQ(neg->name(), path.nodes(2).node_name());
+  EXPECT_EQ(65, path.total_micros());
+  EXPECT_EQ(15, path.compute_micros().at(kTask0));
+  EXPECT_EQ(15, path.compute_micros().at(kTask1));
+  EXPECT_EQ(30, path.transfer_micros().at(strings::StrCat(kTask1, " -> ",
+                                                          kTask0)));
+  EXPECT_EQ(5, path.wait_micros().at(kTask0));
+}
+
+TEST(CriticalPathTest, NoStats) {
+  Graph graph(OpRegistry::Global());
+  test::graph::Constant(&graph, test::AsScalar<float>(1));
+  CriticalPath path;
+  ComputeCriticalPath(graph, StepStats(), &path);
+  EXPECT_EQ(0, path.nodes_size());
+  EXPECT_EQ(0, path.total_micros());
+}
+
+}  // namespace
+}  // namespace tensorflow
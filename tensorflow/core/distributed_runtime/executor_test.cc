@@ -25,8 +25,10 @@ limitations under the License.
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -68,6 +70,9 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
+    params.num_work_stealing_lanes = num_work_stealing_lanes_;
+    params.inline_cost_threshold_usecs = inline_cost_threshold_usecs_;
+    params.allow_static_plan = allow_static_plan_;
     delete exec_;
     TF_CHECK_OK(NewLocalExecutor(params, graph, &exec_));
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
@@ -89,6 +94,9 @@ class ExecutorTest : public ::testing::Test {
   StepStats step_stats_;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  int num_work_stealing_lanes_ = 0;
+  int64 inline_cost_threshold_usecs_ = 0;
+  bool allow_static_plan_ = false;
 };
 
 // A float val -> Tensor<float>
@@ -163,6 +171,51 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, StaticPlanChain) {
+  // out = 1 + 1 + ... + 1, without any asynchronous kernel.
+  allow_static_plan_ = true;
+  Graph* g = new Graph(OpRegistry::Global());
+  auto one = test::graph::Constant(g, V(1.0));
+  auto sum = one;
+  for (int i = 0; i < 100; ++i) {
+    sum = test::graph::Add(g, sum, one);
+  }
+  test::graph::Send(g, sum, "out", BOB, 1, ALICE);
+  Create(g);
+  for (int i = 0; i < 3; ++i) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "out"), args,
+                               &out, &is_dead));
+    EXPECT_EQ(101.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, StaticPlanFallsBackWithAsyncKernels) {
+  // The Recv kernels are asynchronous, so the graph is scheduled
+  // dynamically.
+  allow_static_plan_ = true;
+  Graph* g = new Graph(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g, "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Recv(g, "b", "float", ALICE, 1, BOB);
+  auto tmp = test::graph::Add(g, in0, in1);
+  test::graph::Send(g, tmp, "c", BOB, 1, ALICE);
+  Create(g);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "b"), args, V(1.0),
+                             false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(2.0, V(out));
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -243,6 +296,103 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+// Returns the value of the point of 'metric' with the given label values,
+// which is a count for counters and the number of samples for samplers.
+double MetricValue(const string& metric, const std::vector<string>& labels) {
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  options.collect_metric_descriptors = false;
+  auto metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics(options);
+  auto it = metrics->point_set_map.find(metric);
+  if (it == metrics->point_set_map.end()) return 0;
+  for (const auto& point : it->second->points) {
+    std::vector<string> point_labels;
+    for (const auto& label : point->labels) {
+      point_labels.push_back(label.value);
+    }
+    if (point_labels != labels) continue;
+    if (point->value_type == monitoring::ValueType::kHistogram) {
+      return point->histogram_value.num();
+    }
+    return point->int64_value;
+  }
+  return 0;
+}
+
+TEST_F(ExecutorTest, SchedulingMetrics) {
+  const string scheduled = "/tensorflow/core/executor/scheduled_nodes";
+  const string ready_to_start =
+      "/tensorflow/core/executor/ready_to_start_usecs";
+  const string queue_length = "/tensorflow/core/executor/queue_length";
+  const string& device = device_->name();
+  const double inline_before = MetricValue(scheduled, {device, "inline"});
+  const double dispatched_before =
+      MetricValue(scheduled, {device, "dispatched"});
+  const double ready_to_start_before = MetricValue(ready_to_start, {device});
+  const double queue_length_before = MetricValue(queue_length, {device});
+
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildTree(64, g);
+  const int num_nodes = g->num_nodes();
+  Create(g);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(64.0, V(out));
+
+  // Every node becomes ready exactly once, and the root nodes are always
+  // dispatched.
+  const double num_inline =
+      MetricValue(scheduled, {device, "inline"}) - inline_before;
+  const double num_dispatched =
+      MetricValue(scheduled, {device, "dispatched"}) - dispatched_before;
+  EXPECT_EQ(num_nodes, num_inline + num_dispatched);
+  EXPECT_GE(num_dispatched, 1);
+  EXPECT_GE(MetricValue(ready_to_start, {device}) - ready_to_start_before, 1);
+  EXPECT_GT(MetricValue(queue_length, {device}), queue_length_before);
+}
+
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  num_work_stealing_lanes_ = 4;
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildTree(4096, g);
+  Create(g);
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, RandomTreeCostBasedInlining) {
+  inline_cost_threshold_usecs_ = 10;
+  Graph* g = new Graph(OpRegistry::Global());
+  BuildTree(4096, g);
+  Create(g);
+  // The first step measures node costs, and the later ones schedule with
+  // them.
+  for (int i = 0; i < 3; ++i) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -395,6 +545,33 @@ TEST_F(ExecutorTest, RecvInvalidDtype) {
   rendez->Unref();
 }
 
+TEST_F(ExecutorTest, RecvInvalidDtypeWorkStealing) {
+  num_work_stealing_lanes_ = 2;
+  Graph* g = new Graph(OpRegistry::Global());
+  auto one = test::graph::Recv(g, "one", "float", ALICE, 1, BOB);
+  auto var = test::graph::Var(g, DT_FLOAT, TensorShape({1}));
+  auto init = test::graph::Assign(g, var, one);
+  auto* two = test::graph::Send(g, var, "two", BOB, 1, ALICE);
+  g->AddControlEdge(init, two);
+  Create(g);
+  Rendezvous* rendez = NewLocalRendezvous();
+  TF_ASSERT_OK(rendez->Send(Key(ALICE, 1, BOB, "one"), Rendezvous::Args(),
+                            VD(1.0), false));
+  EXPECT_TRUE(errors::IsInternal(Run(rendez)));
+  rendez->Unref();
+}
+
+TEST_F(ExecutorTest, StaticPlanInvalidRefDtype) {
+  allow_static_plan_ = true;
+  Graph* g = new Graph(OpRegistry::Global());
+  auto var = test::graph::InvalidRefType(g, DT_FLOAT, DT_DOUBLE);
+  test::graph::Send(g, var, "out", BOB, 1, ALICE);
+  Create(g);
+  Rendezvous* rendez = NewLocalRendezvous();
+  EXPECT_TRUE(errors::IsInternal(Run(rendez)));
+  rendez->Unref();
+}
+
 TEST_F(ExecutorTest, RecvInvalidRefDtype) {
   Graph* g = new Graph(OpRegistry::Global());
   // A var that always produces as invalid dtype.
@@ -410,4 +587,97 @@ TEST_F(ExecutorTest, RecvInvalidRefDtype) {
   rendez->Unref();
 }
 
+// Builds a random DAG of NoOps that is "width" nodes wide and "depth"
+// layers deep, and returns the number of nodes in it.
+static int64 BuildRandomNoOpGraph(int width, int depth, Graph* g) {
+  random::PhiloxRandom philox(1729, 17);
+  random::SimplePhilox rand(&philox);
+  int64 cur = 0;
+  uint32 r = 1 + rand.Rand32() % width;
+  std::vector<Node*> ready_nodes;
+  for (int i = 0; i < r; ++i) {
+    ready_nodes.push_back(test::graph::NoOp(g, {}));
+    ++cur;
+  }
+  for (int i = 0; i < depth; ++i) {
+    std::random_shuffle(ready_nodes.begin(), ready_nodes.end());
+    r = 1 + rand.Rand32() % (ready_nodes.size());
+    std::vector<Node*> control_inputs;
+    for (int j = 0; j < r; ++j) {
+      control_inputs.push_back(ready_nodes.back());
+      ready_nodes.pop_back();
+    }
+    Node* n = test::graph::NoOp(g, control_inputs);
+    ++cur;
+    r = 1 + rand.Rand32() % width;
+    for (int j = 0; j < r; ++j) {
+      ready_nodes.push_back(test::graph::NoOp(g, {n}));
+      ++cur;
+    }
+  }
+  FixupSourceAndSinkEdges(g);
+  return cur;
+}
+
+static void BM_executor(int iters, int width, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const int64 num_nodes = BuildRandomNoOpGraph(width, depth, g);
+  testing::ItemsProcessed(num_nodes * static_cast<int64>(iters));
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+static void BM_executor_work_stealing(int iters, int width, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const int64 num_nodes = BuildRandomNoOpGraph(width, depth, g);
+  testing::ItemsProcessed(num_nodes * static_cast<int64>(iters));
+  SessionOptions options;
+  options.config.mutable_executor_options()->set_scheduling_policy(
+      ExecutorOptions::WORK_STEALING);
+  test::Benchmark("cpu", g, &options).Run(iters);
+}
+
+static void BM_executor_cost_based_inlining(int iters, int width,
+                                            int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const int64 num_nodes = BuildRandomNoOpGraph(width, depth, g);
+  testing::ItemsProcessed(num_nodes * static_cast<int64>(iters));
+  SessionOptions options;
+  options.config.mutable_executor_options()->set_inline_cost_threshold_usecs(
+      10);
+  test::Benchmark("cpu", g, &options).Run(iters);
+}
+
+static void BM_executor_static_plan(int iters, int width, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const int64 num_nodes = BuildRandomNoOpGraph(width, depth, g);
+  testing::ItemsProcessed(num_nodes * static_cast<int64>(iters));
+  SessionOptions options;
+  options.config.mutable_executor_options()->set_use_static_plan(true);
+  test::Benchmark("cpu", g, &options).Run(iters);
+}
+
+BENCHMARK(BM_executor)->ArgPair(16, 1024);
+BENCHMARK(BM_executor)->ArgPair(32, 8192);
+BENCHMARK(BM_executor)->ArgPair(1024, 16);
+BENCHMARK(BM_executor)->ArgPair(8192, 32);
+BENCHMARK(BM_executor)->ArgPair(1024, 1024);
+
+BENCHMARK(BM_executor_work_stealing)->ArgPair(16, 1024);
+BENCHMARK(BM_executor_work_stealing)->ArgPair(32, 8192);
+BENCHMARK(BM_executor_work_stealing)->ArgPair(1024, 16);
+BENCHMARK(BM_executor_work_stealing)->ArgPair(8192, 32);
+BENCHMARK(BM_executor_work_stealing)->ArgPair(1024, 1024);
+
+BENCHMARK(BM_executor_cost_based_inlining)->ArgPair(16, 1024);
+BENCHMARK(BM_executor_cost_based_inlining)->ArgPair(32, 8192);
+BENCHMARK(BM_executor_cost_based_inlining)->ArgPair(1024, 16);
+BENCHMARK(BM_executor_cost_based_inlining)->ArgPair(8192, 32);
+BENCHMARK(BM_executor_cost_based_inlining)->ArgPair(1024, 1024);
+
+BENCHMARK(BM_executor_static_plan)->ArgPair(16, 1024);
+BENCHMARK(BM_executor_static_plan)->ArgPair(32, 8192);
+BENCHMARK(BM_executor_static_plan)->ArgPair(1024, 16);
+BENCHMARK(BM_executor_static_plan)->ArgPair(8192, 32);
+BENCHMARK(BM_executor_static_plan)->ArgPair(1024, 1024);
+
 }  // namespace tensorflow
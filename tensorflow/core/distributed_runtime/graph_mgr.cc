@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/constant_folding.h"
@@ -39,11 +40,13 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/validate.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -186,94 +189,152 @@ Status GraphMgr::InitItem(const string& session, const GraphDef& gdef,
   TF_RETURN_IF_ERROR(OptimizationPassRegistry::Global()->RunGrouping(
       OptimizationPassRegistry::POST_PARTITIONING, optimization_options));
 
-  LocalExecutorParams params;
-
-  item->units.reserve(partitions.size());
   item->graph_mgr = this;
-  const auto& optimizer_opts = graph_options.optimizer_options();
-  GraphOptimizer optimizer(optimizer_opts);
-  for (auto& p : partition_graphs) {
-    const string& device_name = p.first;
-    std::unique_ptr<Graph>& subgraph = p.second;
-    item->units.resize(item->units.size() + 1);
-    ExecutionUnit* unit = &(item->units.back());
-
-    // Find the device.
-    Status s = device_mgr_->LookupDevice(device_name, &unit->device);
-    if (!s.ok()) {
-      // Remove the empty unit from the item as the item destructor wants all
-      // units to have valid devices.
-      item->units.pop_back();
-      return s;
-    }
-
-    // Give the device an opportunity to rewrite its subgraph.
-    TF_RETURN_IF_ERROR(unit->device->MaybeRewriteGraph(&subgraph));
 
+  // Finds the devices first, so that every unit in the item has a valid
+  // device even if building one of the executors below fails.
+  std::vector<std::pair<const string, std::unique_ptr<Graph>>*> subgraphs;
+  subgraphs.reserve(partition_graphs.size());
+  std::vector<Device*> devices;
+  devices.reserve(partition_graphs.size());
+  for (auto& p : partition_graphs) {
+    Device* device = nullptr;
+    TF_RETURN_IF_ERROR(device_mgr_->LookupDevice(p.first, &device));
+    subgraphs.push_back(&p);
+    devices.push_back(device);
+  }
+  item->units.resize(subgraphs.size());
+  for (size_t i = 0; i < devices.size(); ++i) {
+    item->units[i].device = devices[i];
     // Top-level nodes in the graph uses the op segment to cache
     // kernels. Therefore, as long as the executor is alive, we need
     // to ensure the kernels cached for the session are alive.
-    auto opseg = unit->device->op_segment();
-    opseg->AddHold(session);
-
-    // Function library runtime.
-    FunctionLibraryRuntime* lib = item->proc_flr->GetFLR(unit->device->name());
-    if (lib == nullptr) {
-      return errors::InvalidArgument("Cannot find FLR for device: ",
-                                     unit->device->name());
+    devices[i]->op_segment()->AddHold(session);
+  }
+
+  // Optimizing a partition and creating its executor only touch that
+  // partition, so the units are built in parallel.
+  const auto& optimizer_opts = graph_options.optimizer_options();
+  GraphOptimizer optimizer(optimizer_opts);
+  std::vector<Status> unit_status(subgraphs.size());
+  ParallelForEach(subgraphs.size(), worker_env_->compute_pool,
+                  subgraphs.size(), [&](int64 i) {
+                    unit_status[i] = InitUnit(
+                        session, graph_options, debug_options, &optimizer,
+                        item, &subgraphs[i]->second, &item->units[i]);
+                  });
+  for (const Status& s : unit_status) {
+    TF_RETURN_IF_ERROR(s);
+  }
+  for (const ExecutionUnit& unit : item->units) {
+    if (unit.build_cost_model > 0) {
+      skip_cost_models_ = false;
     }
+  }
+  return Status::OK();
+}
 
-    // Construct the root executor for the subgraph.
-    params.device = unit->device;
-    params.function_library = lib;
-    params.create_kernel = [session, lib, opseg](const NodeDef& ndef,
-                                                 OpKernel** kernel) {
-      // We do not share the kernel via the OpSegment if the node is
-      // stateless, or a function.
-      // NOTE(mrry): We must not share function kernels (implemented
-      // using `CallOp`) between subgraphs, because `CallOp::handle_`
-      // is tied to a particular subgraph. Even if the function itself
-      // is stateful, the `CallOp` that invokes it is not.
-      if (!lib->IsStateful(ndef.op()) ||
-          lib->GetFunctionLibraryDefinition()->Find(ndef.op()) != nullptr) {
-        return lib->CreateKernel(ndef, kernel);
-      }
-      auto create_fn = [lib, &ndef](OpKernel** kernel) {
-        return lib->CreateKernel(ndef, kernel);
-      };
-      // Kernels created for subgraph nodes need to be cached.  On
-      // cache miss, create_fn() is invoked to create a kernel based
-      // on the function library here + global op registry.
-      return opseg->FindOrCreate(session, ndef.name(), kernel, create_fn);
-    };
-    params.delete_kernel = [lib](OpKernel* kernel) {
-      // If the node is stateful, opseg owns it. Otherwise, delete it.
-      if (kernel && !lib->IsStateful(kernel->type_string())) {
-        delete kernel;
-      }
+Status GraphMgr::InitUnit(const string& session,
+                          const GraphOptions& graph_options,
+                          const DebugOptions& debug_options,
+                          GraphOptimizer* optimizer, Item* item,
+                          std::unique_ptr<Graph>* subgraph,
+                          ExecutionUnit* unit) {
+  // Give the device an opportunity to rewrite its subgraph.
+  TF_RETURN_IF_ERROR(unit->device->MaybeRewriteGraph(subgraph));
+
+  auto opseg = unit->device->op_segment();
+
+  // Function library runtime.
+  FunctionLibraryRuntime* lib = item->proc_flr->GetFLR(unit->device->name());
+  if (lib == nullptr) {
+    return errors::InvalidArgument("Cannot find FLR for device: ",
+                                   unit->device->name());
+  }
+
+  // Construct the root executor for the subgraph.
+  LocalExecutorParams params;
+  params.device = unit->device;
+  params.function_library = lib;
+  params.create_kernel = [session, lib, opseg](const NodeDef& ndef,
+                                               OpKernel** kernel) {
+    auto create_fn = [lib, &ndef](OpKernel** kernel) {
+      return lib->CreateKernel(ndef, kernel);
     };
+    // Stateless kernels that only depend on "ndef" are shared with the
+    // other sessions and subgraphs of this device that run an identical
+    // node, so that they are only constructed once.
+    if (OpSegment::ShouldShareKernel(lib, ndef)) {
+      return opseg->FindOrCreateShared(
+          session, OpSegment::SharedKernelKey(ndef, lib->graph_def_version()),
+          kernel, create_fn);
+    }
+    // We do not share the kernel via the OpSegment if the node is
+    // stateless, or a function.
+    // NOTE(mrry): We must not share function kernels (implemented
+    // using `CallOp`) between subgraphs, because `CallOp::handle_`
+    // is tied to a particular subgraph. Even if the function itself
+    // is stateful, the `CallOp` that invokes it is not.
+    if (!lib->IsStateful(ndef.op()) ||
+        lib->GetFunctionLibraryDefinition()->Find(ndef.op()) != nullptr) {
+      return lib->CreateKernel(ndef, kernel);
+    }
+    // Kernels created for subgraph nodes need to be cached.  On
+    // cache miss, create_fn() is invoked to create a kernel based
+    // on the function library here + global op registry.
+    return opseg->FindOrCreate(session, ndef.name(), kernel, create_fn);
+  };
+  params.create_kernel_pool = worker_env_->compute_pool;
+  params.delete_kernel = [lib](OpKernel* kernel) {
+    // If the node is stateful or shared, opseg owns it. Otherwise, delete
+    // it.
+    if (kernel && !lib->IsStateful(kernel->type_string()) &&
+        !OpSegment::ShouldShareKernel(lib, kernel->def())) {
+      delete kernel;
+    }
+  };
 
-    optimizer.Optimize(lib, worker_env_->env, params.device, &subgraph,
-                       /*shape_map=*/nullptr);
+  optimizer->Optimize(lib, worker_env_->env, params.device, subgraph,
+                     /*shape_map=*/nullptr);
 
-    // EXPERIMENTAL: tfdbg inserts debug nodes (i.e., probes) to the graph.
-    if (!debug_options.debug_tensor_watch_opts().empty()) {
-      TF_RETURN_IF_ERROR(DecorateAndPublishGraphForDebug(
-          debug_options, subgraph.get(), params.device));
-    }
+  // EXPERIMENTAL: tfdbg inserts debug nodes (i.e., probes) to the graph.
+  if (!debug_options.debug_tensor_watch_opts().empty()) {
+    TF_RETURN_IF_ERROR(DecorateAndPublishGraphForDebug(
+        debug_options, subgraph->get(), params.device));
+  }
 
-    TF_RETURN_IF_ERROR(
-        EnsureMemoryTypes(DeviceType(unit->device->device_type()),
-                          unit->device->name(), subgraph.get()));
-    unit->graph = subgraph.get();
-    unit->build_cost_model = graph_options.build_cost_model();
-    if (unit->build_cost_model > 0) {
-      skip_cost_models_ = false;
-    }
-    TF_RETURN_IF_ERROR(
-        NewLocalExecutor(params, subgraph.release(), &unit->root));
+  TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(unit->device->device_type()),
+                                       unit->device->name(), subgraph->get()));
+  unit->graph = subgraph->get();
+  unit->build_cost_model = graph_options.build_cost_model();
+  return NewLocalExecutor(params, subgraph->release(), &unit->root);
+}
+
+// Returns a fingerprint of everything that determines the executors
+// GraphMgr::InitItem() builds for a registration.
+static uint64 RegistrationFingerprint(
+    const string& session, const GraphDef& gdef,
+    const GraphOptions& graph_options, const DebugOptions& debug_options,
+    DistributedFunctionLibraryRuntime* cluster_flr) {
+  uint64 fp = Hash64(session);
+  string buf;
+  for (const protobuf::MessageLite* msg :
+       {static_cast<const protobuf::MessageLite*>(&gdef),
+        static_cast<const protobuf::MessageLite*>(&graph_options),
+        static_cast<const protobuf::MessageLite*>(&debug_options)}) {
+    SerializeToStringDeterministic(*msg, &buf);
+    fp = Hash64Combine(fp, Hash64(buf));
   }
-  return Status::OK();
+  return Hash64Combine(fp, reinterpret_cast<uintptr_t>(cluster_flr));
+}
+
+// Adds a new handle for "item" to table_, which takes over one reference on
+// "item".
+string GraphMgr::AddHandle(Item* item) {
+  const string handle = strings::Printf("%016llx", ++next_id_);
+  if (item->num_handles++ == 0) item->handle = handle;
+  CHECK(table_.insert({handle, item}).second);
+  return handle;
 }
 
 Status GraphMgr::Register(const string& session, const GraphDef& gdef,
@@ -281,6 +342,20 @@ Status GraphMgr::Register(const string& session, const GraphDef& gdef,
                           const DebugOptions& debug_options,
                           DistributedFunctionLibraryRuntime* cluster_flr,
                           string* handle) {
+  const uint64 fingerprint = RegistrationFingerprint(
+      session, gdef, graph_options, debug_options, cluster_flr);
+
+  // Reuses the executors of an identical graph registered before.
+  {
+    mutex_lock l(mu_);
+    auto iter = items_by_fingerprint_.find(fingerprint);
+    if (iter != items_by_fingerprint_.end()) {
+      iter->second->Ref();
+      *handle = AddHandle(iter->second);
+      return Status::OK();
+    }
+  }
+
   Item* item = new Item;
   Status s =
       InitItem(session, gdef, graph_options, debug_options, cluster_flr, item);
@@ -292,13 +367,24 @@ Status GraphMgr::Register(const string& session, const GraphDef& gdef,
   // Inserts one item into table_.
   {
     mutex_lock l(mu_);
-    *handle = strings::Printf("%016llx", ++next_id_);
-    item->handle = *handle;
-    CHECK(table_.insert({*handle, item}).second);
+    *handle = AddHandle(item);
+    item->fingerprint = fingerprint;
+    // If an identical graph was registered concurrently, the first one
+    // stays the one that is reused.
+    items_by_fingerprint_.insert({fingerprint, item});
   }
   return Status::OK();
 }
 
+// Removes "item"'s entry from items_by_fingerprint_ once it has no handles.
+void GraphMgr::RemoveHandle(Item* item) {
+  if (--item->num_handles > 0) return;
+  auto iter = items_by_fingerprint_.find(item->fingerprint);
+  if (iter != items_by_fingerprint_.end() && iter->second == item) {
+    items_by_fingerprint_.erase(iter);
+  }
+}
+
 Status GraphMgr::Deregister(const string& handle) {
   Item* item = nullptr;
   // Removes one item from table_.
@@ -311,6 +397,7 @@ Status GraphMgr::Deregister(const string& handle) {
     }
     item = iter->second;
     table_.erase(iter);
+    RemoveHandle(item);
   }
   item->Unref();
   return Status::OK();
@@ -325,6 +412,7 @@ Status GraphMgr::DeregisterAll() {
       items.push_back(entry.second);
     }
     table_.clear();
+    items_by_fingerprint_.clear();
   }
   for (auto item : items) {
     item->Unref();
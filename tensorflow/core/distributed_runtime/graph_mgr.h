@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/graph_optimizer.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
@@ -138,6 +139,12 @@ class GraphMgr {
     // Used to deregister a cost model when cost model is required in graph
     // manager.
     GraphMgr* graph_mgr;
+
+    // Fingerprint of the registration that built this item, and the number
+    // of graph handles in table_ that refer to it. Guarded by
+    // GraphMgr::mu_.
+    uint64 fingerprint = 0;
+    int num_handles = 0;
   };
 
   const WorkerEnv* worker_env_;             // Not owned.
@@ -159,6 +166,13 @@ class GraphMgr {
   // mechanism to gc these graphs.
   std::unordered_map<string, Item*> table_;
 
+  // Maps the fingerprint of a registration (session, graph, options) to the
+  // item built for it, so that registering an identical graph again in the
+  // same session returns a new handle to the same executors instead of
+  // building them again. Entries do not hold a reference; an entry is
+  // removed when the last handle of its item is deregistered.
+  std::unordered_map<uint64, Item*> items_by_fingerprint_ GUARDED_BY(mu_);
+
   void StartParallelExecutors(const string& handle, int64 step_id, Item* item,
                               Rendezvous* rendezvous,
                               StepStatsCollector* collector,
@@ -178,6 +192,16 @@ class GraphMgr {
                   const DebugOptions& debug_options,
                   DistributedFunctionLibraryRuntime* cluster_flr, Item* item);
 
+  // Builds the executor of "unit", whose device is already set, for the
+  // partition "subgraph" of "item".
+  Status InitUnit(const string& session, const GraphOptions& graph_options,
+                  const DebugOptions& debug_options,
+                  GraphOptimizer* optimizer, Item* item,
+                  std::unique_ptr<Graph>* subgraph, ExecutionUnit* unit);
+
+  string AddHandle(Item* item) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void RemoveHandle(Item* item) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Status DecorateAndPublishGraphForDebug(const DebugOptions& debug_options,
                                          Graph* graph, Device* device);
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/master_session.h"
 
+#include <algorithm>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -23,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/profile_handler.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/debug/debug_graph_utils.h"
+#include "tensorflow/core/distributed_runtime/critical_path.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
@@ -74,7 +77,10 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
         is_partial_(is_partial),
         debug_opts_(bopts.debug_options),
         worker_cache_(worker_cache),
-        should_deregister_(should_deregister) {
+        should_deregister_(should_deregister),
+        keep_partition_graphs_(
+            !is_partial &&
+            session_opts.config.rpc_options().max_worker_recoveries() > 0) {
     VLOG(1) << "Created ReffedClientGraph for node with "
             << client_graph()->graph.num_node_ids();
 
@@ -183,6 +189,20 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // `done` when all cleanup RPCs have completed.
   void CleanupPartitionsAsync(int64 step_id, StatusCallback done);
 
+  // Returns the names of the workers that run partitions of this graph.
+  std::vector<string> WorkerNames() const;
+
+  // After some worker tasks were replaced, registers again the partitions
+  // that ran on them or that exchange tensors with them, and sets
+  // "*num_registered" to their number. "get_incarnation" returns the
+  // current incarnation of a device. Returns an error if a replaced task
+  // held variables, since their values are lost.
+  //
+  // REQUIRES: the graph was registered with max_worker_recoveries > 0.
+  Status RegisterStalePartitions(
+      const PartitionOptions::GetIncarnationFunc& get_incarnation,
+      int* num_registered);
+
   // Post-processing of any runtime statistics gathered during execution.
   void ProcessStats(int64 step_id, PerStepState* pss, ProfileHandler* ph,
                     const RunOptions& options, RunMetadata* resp);
@@ -215,6 +235,9 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   WorkerCacheInterface* const worker_cache_;  // Not owned.
   std::unordered_map<StringPiece, Node*, StringPieceHasher> name_to_node_;
   const bool should_deregister_;
+  // If true, each Part keeps its GraphDef so that it can be registered
+  // again after a worker task is replaced.
+  const bool keep_partition_graphs_;
 
   // Graph partitioned into per-location subgraphs.
   struct Part {
@@ -231,15 +254,23 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     WorkerInterface* worker = nullptr;
 
     // After registeration with the worker, graph_handle identifies
-    // this partition on the worker.
+    // this partition on the worker. Guarded by mu_ once
+    // RegisterPartitions() has returned, since RegisterStalePartitions()
+    // may replace it.
     string graph_handle;
 
+    // The registered graph and the incarnations of the devices it was
+    // built for. Only kept when keep_partition_graphs_ is true.
+    GraphDef graph_def;
+    std::unordered_map<string, uint64> incarnations;
+
     Part() : feed_key(3), key_fetch(3) {}
   };
 
   // partitions_ is immutable after RegisterPartitions() call
-  // finishes.  RunPartitions() can access partitions_ safely without
-  // acquiring locks.
+  // finishes, except for the graph handles (see Part::graph_handle).
+  // RunPartitions() can access partitions_ safely without acquiring
+  // locks.
   std::vector<Part> partitions_;
 
   mutable mutex mu_;
@@ -273,6 +304,12 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // destructor and does not wait for the rpc completion.
   void DeregisterPartitions();
 
+  // Returns the graph handle of the index-th partition.
+  string graph_handle(int index) const {
+    mutex_lock l(mu_);
+    return partitions_[index].graph_handle;
+  }
+
   TF_DISALLOW_COPY_AND_ASSIGN(ReffedClientGraph);
 };
 
@@ -375,6 +412,65 @@ Status MasterSession::ReffedClientGraph::DoBuildPartitions(
   return Partition(popts, &client_graph_->graph, out_partitions);
 }
 
+// Returns the device that sends the tensors of Send or Recv node "ndef", or
+// nullptr if "ndef" is not a Send or Recv node.
+static const string* SendDevice(const NodeDef& ndef) {
+  const auto it = ndef.attr().find("send_device");
+  if (it == ndef.attr().end() ||
+      ndef.attr().count("send_device_incarnation") == 0) {
+    return nullptr;
+  }
+  return &it->second.s();
+}
+
+// Records in "*incarnations" the incarnations of the devices the nodes of
+// "gdef" are placed on and receive tensors from.
+static void RecordIncarnations(
+    const GraphDef& gdef,
+    const PartitionOptions::GetIncarnationFunc& get_incarnation,
+    std::unordered_map<string, uint64>* incarnations) {
+  incarnations->clear();
+  for (const NodeDef& ndef : gdef.node()) {
+    if (!ndef.device().empty() && incarnations->count(ndef.device()) == 0) {
+      (*incarnations)[ndef.device()] = get_incarnation(ndef.device());
+    }
+    const string* send_device = SendDevice(ndef);
+    if (send_device != nullptr && incarnations->count(*send_device) == 0) {
+      (*incarnations)[*send_device] = get_incarnation(*send_device);
+    }
+  }
+}
+
+// Sets the send_device_incarnation attrs of the Send and Recv nodes of
+// "gdef" to the current incarnations of their send devices.
+static void UpdateIncarnations(
+    const PartitionOptions::GetIncarnationFunc& get_incarnation,
+    GraphDef* gdef) {
+  auto update = [&get_incarnation](NodeDef* ndef) {
+    const string* send_device = SendDevice(*ndef);
+    if (send_device != nullptr) {
+      const int64 incarnation = get_incarnation(*send_device);
+      SetAttrValue(incarnation,
+                   &(*ndef->mutable_attr())["send_device_incarnation"]);
+    }
+  };
+  for (NodeDef& ndef : *gdef->mutable_node()) {
+    update(&ndef);
+  }
+  for (FunctionDef& fdef : *gdef->mutable_library()->mutable_function()) {
+    for (NodeDef& ndef : *fdef.mutable_node_def()) {
+      update(&ndef);
+    }
+  }
+}
+
+// Returns true if "ndef" owns state that does not survive the loss of its
+// task and cannot be recomputed by running the graph again.
+static bool IsVariable(const NodeDef& ndef) {
+  return ndef.op() == "Variable" || ndef.op() == "VariableV2" ||
+         ndef.op() == "VarHandleOp";
+}
+
 Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     const PartitionOptions& popts,
     std::unordered_map<string, GraphDef> graph_partitions) {
@@ -406,9 +502,14 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
   gtl::InlinedVector<Call, 4> calls(num);
   BlockingCounter done(num);
   for (int i = 0; i < num; ++i) {
-    const Part& part = partitions_[i];
+    Part& part = partitions_[i];
     Call* c = &calls[i];
     c->req.set_session_handle(session_handle_);
+    if (keep_partition_graphs_) {
+      part.graph_def = graph_partitions[part.name];
+      RecordIncarnations(part.graph_def, popts.get_incarnation,
+                         &part.incarnations);
+    }
     c->req.mutable_graph_def()->Swap(&graph_partitions[part.name]);
     *c->req.mutable_graph_options() = session_opts_.config.graph_options();
     *c->req.mutable_debug_options() = debug_opts_;
@@ -536,7 +637,7 @@ Status MasterSession::ReffedClientGraph::RunPartitions(
       c->req->set_is_last_partial_run(is_last_partial_run);
     }
     c->req->set_session_handle(session_handle_);
-    c->req->set_graph_handle(part.graph_handle);
+    c->req->set_graph_handle(graph_handle(i));
     c->req->set_step_id(step_id);
     *c->req->mutable_exec_opts() = exec_opts;
     // If any feeds are provided, send the feed values together
@@ -726,6 +827,26 @@ void MasterSession::ReffedClientGraph::CleanupPartitionsAsync(
   }
 }
 
+// Logs where the time of the critical path of a step went.
+static void LogCriticalPath(int64 step_id, const CriticalPath& path) {
+  string summary = strings::StrCat("Critical path of step ", step_id, ": ",
+                                   path.nodes_size(), " nodes, ",
+                                   path.total_micros(), "us");
+  for (const auto& it : path.compute_micros()) {
+    strings::StrAppend(&summary, "\n  compute ", it.first, ": ", it.second,
+                       "us");
+  }
+  for (const auto& it : path.transfer_micros()) {
+    strings::StrAppend(&summary, "\n  transfer ", it.first, ": ", it.second,
+                       "us");
+  }
+  for (const auto& it : path.wait_micros()) {
+    strings::StrAppend(&summary, "\n  wait ", it.first, ": ", it.second,
+                       "us");
+  }
+  VLOG(1) << summary;
+}
+
 void MasterSession::ReffedClientGraph::ProcessStats(int64 step_id,
                                                     PerStepState* pss,
                                                     ProfileHandler* ph,
@@ -766,6 +887,11 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64 step_id,
     // Copy the stats back, but only for on-demand profiling to avoid slowing
     // down calls that trigger the automatic profiling.
     if (options.trace_level() == RunOptions::FULL_TRACE) {
+      CriticalPath* path = resp->mutable_critical_path();
+      ComputeCriticalPath(client_graph()->graph, step_stats_proto, path);
+      if (VLOG_IS_ON(1)) {
+        LogCriticalPath(step_id, *path);
+      }
       resp->mutable_step_stats()->Swap(&step_stats_proto);
     } else {
       // If FULL_TRACE, it can be fetched from Session API, no need for
@@ -914,6 +1040,97 @@ void MasterSession::ReffedClientGraph::DeregisterPartitions() {
   }
 }
 
+std::vector<string> MasterSession::ReffedClientGraph::WorkerNames() const {
+  std::vector<string> names;
+  names.reserve(partitions_.size());
+  for (const Part& part : partitions_) {
+    names.push_back(part.name);
+  }
+  return names;
+}
+
+Status MasterSession::ReffedClientGraph::RegisterStalePartitions(
+    const PartitionOptions::GetIncarnationFunc& get_incarnation,
+    int* num_registered) {
+  CHECK(keep_partition_graphs_);
+  *num_registered = 0;
+  std::vector<int> stale;
+  for (int i = 0; i < partitions_.size(); ++i) {
+    const Part& part = partitions_[i];
+    bool is_stale = false;
+    for (const auto& device_incarnation : part.incarnations) {
+      if (get_incarnation(device_incarnation.first) ==
+          device_incarnation.second) {
+        continue;
+      }
+      is_stale = true;
+      for (const NodeDef& ndef : part.graph_def.node()) {
+        if (ndef.device() == device_incarnation.first && IsVariable(ndef)) {
+          return errors::FailedPrecondition(
+              "Cannot recover from the loss of ", part.name,
+              " because it held variable ", ndef.name(),
+              "; restore it from a checkpoint instead.");
+        }
+      }
+    }
+    if (is_stale) stale.push_back(i);
+  }
+  if (stale.empty()) return Status::OK();
+
+  struct Call {
+    RegisterGraphRequest req;
+    RegisterGraphResponse resp;
+    Status status;
+  };
+  gtl::InlinedVector<Call, 4> calls(stale.size());
+  BlockingCounter done(stale.size());
+  for (int j = 0; j < stale.size(); ++j) {
+    Part* part = &partitions_[stale[j]];
+    UpdateIncarnations(get_incarnation, &part->graph_def);
+    Call* c = &calls[j];
+    c->req.set_session_handle(session_handle_);
+    *c->req.mutable_graph_def() = part->graph_def;
+    *c->req.mutable_graph_options() = session_opts_.config.graph_options();
+    *c->req.mutable_debug_options() = debug_opts_;
+    LOG(INFO) << "Registering partition of " << session_handle_ << " on "
+              << part->name << " again";
+    part->worker->RegisterGraphAsync(&c->req, &c->resp,
+                                     [c, &done](const Status& s) {
+                                       c->status = s;
+                                       done.DecrementCount();
+                                     });
+  }
+  done.Wait();
+  Status s;
+  for (const Call& c : calls) {
+    s.Update(c.status);
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  struct DeregisterCall {
+    DeregisterGraphRequest req;
+    DeregisterGraphResponse resp;
+  };
+  for (int j = 0; j < stale.size(); ++j) {
+    Part* part = &partitions_[stale[j]];
+    RecordIncarnations(part->graph_def, get_incarnation, &part->incarnations);
+    string old_handle;
+    {
+      mutex_lock l(mu_);
+      old_handle = part->graph_handle;
+      part->graph_handle = calls[j].resp.graph_handle();
+    }
+    // The graph may still be registered on a worker that was not replaced.
+    DeregisterCall* c = new DeregisterCall;
+    c->req.set_session_handle(session_handle_);
+    c->req.set_graph_handle(old_handle);
+    part->worker->DeregisterGraphAsync(&c->req, &c->resp,
+                                       [c](const Status& s) { delete c; });
+  }
+  *num_registered = stale.size();
+  return Status::OK();
+}
+
 void BuildBuildGraphOptions(const RunStepRequestWrapper& req,
                             BuildGraphOptions* opts) {
   for (size_t i = 0; i < req.num_feeds(); ++i) {
@@ -1061,9 +1278,28 @@ Status MasterSession::Create(GraphDef* graph_def,
 
 Status MasterSession::CreateWorkerSessions(
     const WorkerCacheFactoryOptions& options) {
+  worker_session_request_.set_session_handle(handle_);
+  if (options.cluster_def) {
+    *worker_session_request_.mutable_server_def()->mutable_cluster() =
+        *options.cluster_def;
+    worker_session_request_.mutable_server_def()->set_protocol(
+        *options.protocol);
+    // Session state is always isolated when ClusterSpec propagation
+    // is in use.
+    worker_session_request_.set_isolate_session_state(true);
+  } else {
+    worker_session_request_.set_isolate_session_state(
+        session_opts_.config.isolate_session_state());
+  }
+
   std::vector<string> worker_names;
+  get_worker_cache()->ListWorkers(&worker_names);
+  return CreateWorkerSessionsOn(worker_names);
+}
+
+Status MasterSession::CreateWorkerSessionsOn(
+    const std::vector<string>& worker_names) {
   WorkerCacheInterface* worker_cache = get_worker_cache();
-  worker_cache->ListWorkers(&worker_names);
 
   struct WorkerGroup {
     // The worker name. (Not owned.)
@@ -1094,18 +1330,7 @@ Status MasterSession::CreateWorkerSessions(
   for (size_t i = 0; i < worker_names.size(); ++i) {
     workers[i].name = &worker_names[i];
     workers[i].worker = worker_cache->CreateWorker(worker_names[i]);
-    workers[i].request.set_session_handle(handle_);
-    if (options.cluster_def) {
-      *workers[i].request.mutable_server_def()->mutable_cluster() =
-          *options.cluster_def;
-      workers[i].request.mutable_server_def()->set_protocol(*options.protocol);
-      // Session state is always isolated when ClusterSpec propagation
-      // is in use.
-      workers[i].request.set_isolate_session_state(true);
-    } else {
-      workers[i].request.set_isolate_session_state(
-          session_opts_.config.isolate_session_state());
-    }
+    workers[i].request = worker_session_request_;
 
     DeviceNameUtils::ParsedName name;
     if (!DeviceNameUtils::ParseFullName(worker_names[i], &name)) {
@@ -1386,12 +1611,7 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
   };
   popts.flib_def = rcg->client_graph()->flib_def.get();
   popts.get_incarnation = [this](const string& name) -> int64 {
-    Device* d = devices_->FindDeviceByName(name);
-    if (d == nullptr) {
-      return PartitionOptions::kIllegalIncarnation;
-    } else {
-      return d->attributes().incarnation();
-    }
+    return DeviceIncarnation(name);
   };
   popts.control_flow_added = false;
   const bool enable_bfloat16_sendrecv =
@@ -1417,6 +1637,125 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
   return Status::OK();
 }
 
+uint64 MasterSession::DeviceIncarnation(const string& name) {
+  {
+    mutex_lock l(mu_);
+    auto it = replaced_incarnations_.find(name);
+    if (it != replaced_incarnations_.end()) return it->second;
+  }
+  Device* d = devices_->FindDeviceByName(name);
+  if (d == nullptr) {
+    return PartitionOptions::kIllegalIncarnation;
+  } else {
+    return d->attributes().incarnation();
+  }
+}
+
+namespace {
+
+// Returns true if "s" may be the result of a worker task going away during
+// the step: its peers see it as UNAVAILABLE, and a replacement task aborts
+// RunGraph calls for the graphs it never registered.
+bool IsWorkerFailure(const Status& s) {
+  return errors::IsUnavailable(s) || errors::IsAborted(s);
+}
+
+// Calls GetStatus on "target" until it succeeds or "deadline_micros" is
+// reached, and fills "*devices" with the devices of the worker.
+Status WaitForWorker(WorkerCacheInterface* worker_cache, const string& target,
+                     int64 deadline_micros,
+                     std::vector<DeviceAttributes>* devices) {
+  struct Call {
+    GetStatusRequest req;
+    GetStatusResponse resp;
+    Status status;
+    Notification done;
+  };
+  Env* env = Env::Default();
+  Status s;
+  while (true) {
+    WorkerInterface* worker = worker_cache->CreateWorker(target);
+    if (worker == nullptr) {
+      return errors::NotFound("worker ", target);
+    }
+    // The call may outlive this function if it times out.
+    std::shared_ptr<Call> call = std::make_shared<Call>();
+    worker->GetStatusAsync(
+        &call->req, &call->resp,
+        [call, worker_cache, target, worker](const Status& status) {
+          call->status = status;
+          worker_cache->ReleaseWorker(target, worker);
+          call->done.Notify();
+        });
+    const int64 wait_micros =
+        std::max<int64>(deadline_micros - env->NowMicros(), 1);
+    if (WaitForNotificationWithTimeout(&call->done, wait_micros)) {
+      s = call->status;
+      if (s.ok()) {
+        devices->assign(call->resp.device_attributes().begin(),
+                        call->resp.device_attributes().end());
+        return Status::OK();
+      }
+    } else {
+      s = errors::DeadlineExceeded("GetStatus timed out");
+    }
+    const int64 remaining_micros = deadline_micros - env->NowMicros();
+    if (remaining_micros <= 0) break;
+    // Wait a bit for the task to come back and try again.
+    env->SleepForMicroseconds(std::min<int64>(1000000, remaining_micros));
+  }
+  return errors::Unavailable("Worker ", target,
+                             " did not come back in time: ", s.ToString());
+}
+
+}  // namespace
+
+Status MasterSession::RecoverWorkers(ReffedClientGraph* rcg, bool* recovered) {
+  *recovered = false;
+  mutex_lock recovery_lock(recovery_mu_);
+  const RPCOptions& rpc_options = session_opts_.config.rpc_options();
+  const int64 timeout_ms = rpc_options.worker_recovery_timeout_in_ms() > 0
+                               ? rpc_options.worker_recovery_timeout_in_ms()
+                               : 60000;
+  const int64 deadline_micros =
+      Env::Default()->NowMicros() + timeout_ms * 1000;
+
+  std::vector<string> replaced;
+  for (const string& target : rcg->WorkerNames()) {
+    std::vector<DeviceAttributes> devices;
+    TF_RETURN_IF_ERROR(WaitForWorker(get_worker_cache(), target,
+                                     deadline_micros, &devices));
+    bool is_replaced = false;
+    for (const DeviceAttributes& device : devices) {
+      if (devices_->FindDeviceByName(device.name()) == nullptr ||
+          DeviceIncarnation(device.name()) == device.incarnation()) {
+        continue;
+      }
+      mutex_lock l(mu_);
+      replaced_incarnations_[device.name()] = device.incarnation();
+      is_replaced = true;
+    }
+    if (is_replaced) replaced.push_back(target);
+  }
+  if (!replaced.empty()) {
+    LOG(WARNING) << "Session " << handle_ << ": worker tasks "
+                 << str_util::Join(replaced, ", ") << " were replaced";
+    if (should_delete_worker_sessions_) {
+      TF_RETURN_IF_ERROR(CreateWorkerSessionsOn(replaced));
+    }
+  }
+
+  // Other graphs of this session may have recovered from the same loss
+  // already, in which case "replaced" is empty but the partitions of "rcg"
+  // are still stale.
+  int num_registered = 0;
+  TF_RETURN_IF_ERROR(rcg->RegisterStalePartitions(
+      [this](const string& name) { return DeviceIncarnation(name); },
+      &num_registered));
+  *recovered = num_registered > 0;
+  return Status::OK();
+}
+
 Status MasterSession::DoPartialRun(CallOptions* opts,
                                    const RunStepRequestWrapper& req,
                                    MutableRunStepResponseWrapper* resp) {
@@ -1599,10 +1938,12 @@ Status MasterSession::DoRunWithLocalExecution(
 
   // Keeps the highest 8 bits 0x01: we reserve some bits of the
   // step_id for future use.
-  const uint64 step_id = (random::New64() & ((1uLL << 56) - 1)) | (1uLL << 56);
+  uint64 step_id = (random::New64() & ((1uLL << 56) - 1)) | (1uLL << 56);
   TRACEPRINTF("stepid %llu", step_id);
 
   pss.collect_timeline = req.options().trace_level() == RunOptions::FULL_TRACE;
+  // The RecvTensor logs break the transfers of the timeline down.
+  pss.collect_rpcs = pss.collect_timeline;
   pss.report_tensor_allocations_upon_oom =
       req.options().report_tensor_allocations_upon_oom();
   // Build the cost model every 'build_cost_model_every' steps after skipping an
@@ -1620,11 +1961,34 @@ Status MasterSession::DoRunWithLocalExecution(
       rcg->GetProfileHandler(step_id, count, req.options());
   if (ph) {
     pss.collect_timeline = true;
-    pss.collect_rpcs = ph->should_collect_rpcs();
+    pss.collect_rpcs = pss.collect_rpcs || ph->should_collect_rpcs();
   }
 
   Status s = rcg->RunPartitions(env_, step_id, count, &pss, opts, req, resp,
                                 &cancellation_manager_, false);
+  const int max_worker_recoveries =
+      session_opts_.config.rpc_options().max_worker_recoveries();
+  for (int i = 0; i < max_worker_recoveries && IsWorkerFailure(s); ++i) {
+    bool recovered = false;
+    Status recovery_status = RecoverWorkers(rcg, &recovered);
+    if (!recovery_status.ok()) {
+      LOG(WARNING) << "Could not recover from " << s << ": "
+                   << recovery_status;
+      break;
+    }
+    if (!recovered) break;  // No worker was replaced: "s" stands.
+    LOG(INFO) << "Retrying step " << step_id << " after " << s;
+    rcg->Ref();
+    rcg->CleanupPartitionsAsync(step_id, [rcg](const Status& s) {
+      if (!s.ok()) {
+        LOG(INFO) << "Cleanup partition error: " << s;
+      }
+      rcg->Unref();
+    });
+    step_id = (random::New64() & ((1uLL << 56) - 1)) | (1uLL << 56);
+    s = rcg->RunPartitions(env_, step_id, count, &pss, opts, req, resp,
+                           &cancellation_manager_, false);
+  }
   if (s.ok()) {
     pss.end_micros = Env::Default()->NowMicros();
 
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_MASTER_SESSION_H_
 
 #include <atomic>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/master.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -188,6 +190,14 @@ class MasterSession : public core::RefCounted {
   // nodes) are unique across all sub-graphs within this session.
   int64 next_node_id_ GUARDED_BY(mu_) = 0;
 
+  // Incarnations of the devices of the worker tasks that were replaced
+  // since this session was created. They take precedence over the
+  // incarnations in devices_.
+  std::unordered_map<string, uint64> replaced_incarnations_ GUARDED_BY(mu_);
+
+  // Serializes RecoverWorkers().
+  mutex recovery_mu_;
+
   // Used to cancel running steps on Close().
   CancellationManager cancellation_manager_;
 
@@ -201,6 +211,14 @@ class MasterSession : public core::RefCounted {
   // workers.
   Status CreateWorkerSessions(const WorkerCacheFactoryOptions& server_def);
 
+  // Creates this session on the workers named "worker_names", using the
+  // cluster recorded by CreateWorkerSessions().
+  Status CreateWorkerSessionsOn(const std::vector<string>& worker_names);
+
+  // The request sent to every worker by CreateWorkerSessionsOn(), except
+  // for the task name. Set by CreateWorkerSessions().
+  CreateWorkerSessionRequest worker_session_request_;
+
   // TODO(b/36574172): Always use Create/DeleteWorkerSession.
   bool should_delete_worker_sessions_ = false;
   Status DeleteWorkerSessions();
@@ -219,6 +237,16 @@ class MasterSession : public core::RefCounted {
 
   Status BuildAndRegisterPartitions(ReffedClientGraph* rcg);
 
+  // Returns the current incarnation of the device "name", or
+  // PartitionOptions::kIllegalIncarnation if it is unknown.
+  uint64 DeviceIncarnation(const string& name);
+
+  // Called after a step of "rcg" failed with an error that a lost worker
+  // could cause. Waits for the workers of "rcg" to be reachable, notes the
+  // ones that were replaced, and registers the affected partitions again.
+  // Sets "*recovered" to true if the step is worth retrying.
+  Status RecoverWorkers(ReffedClientGraph* rcg, bool* recovered);
+
   Status CreateDebuggerState(
       const DebugOptions& debug_options, const RunStepRequestWrapper& req,
       int64 rcg_execution_count,
@@ -57,6 +57,11 @@ Status ValidateHostPortPair(const string& host_port) {
 
 Status NewHostPortGrpcChannel(const string& target,
                               SharedGrpcChannelPtr* channel_pointer) {
+  return NewStripedHostPortGrpcChannel(target, 0, channel_pointer);
+}
+
+Status NewStripedHostPortGrpcChannel(const string& target, int stripe,
+                                     SharedGrpcChannelPtr* channel_pointer) {
   // Minimally ensure that the target is valid
   TF_RETURN_IF_ERROR(ValidateHostPortPair(target));
 
@@ -66,6 +71,10 @@ Status NewHostPortGrpcChannel(const string& target,
   // NOTE(mrry): Some versions of gRPC use a 20-second minimum backoff
   // on connection failure, which makes our tests time out.
   args.SetInt("grpc.testing.fixed_reconnect_backoff_ms", 1000);
+  // gRPC shares a subchannel, and thus a TCP connection, between channels
+  // to the same target with the same arguments. A distinct argument gives
+  // each stripe its own connection.
+  if (stripe > 0) args.SetInt("tensorflow.grpc_channel_stripe", stripe);
   *channel_pointer = ::grpc::CreateCustomChannel(
       "dns:///" + target, ::grpc::InsecureChannelCredentials(), args);
   return Status::OK();
@@ -91,6 +91,12 @@ ChannelCreationFunction ConvertToChannelCreationFunction(
 Status NewHostPortGrpcChannel(const string& target,
                               SharedGrpcChannelPtr* channel_pointer);
 
+// Like NewHostPortGrpcChannel(), but channels with different "stripe"s do
+// not share a connection to "target". Stripe 0 is the channel returned by
+// NewHostPortGrpcChannel().
+Status NewStripedHostPortGrpcChannel(const string& target, int stripe,
+                                     SharedGrpcChannelPtr* channel_pointer);
+
 }  // namespace tensorflow
 
 #endif  // THIRD_PARTY_TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_CHANNEL_H_
@@ -156,4 +156,15 @@ TEST(GrpcChannelTest, NewHostPortGrpcChannelValidation) {
   EXPECT_FALSE(NewHostPortGrpcChannel("example.com/abc:", &mock_ptr).ok());
 }
 
+TEST(GrpcChannelTest, NewStripedHostPortGrpcChannel) {
+  SharedGrpcChannelPtr stripe0;
+  SharedGrpcChannelPtr stripe1;
+  TF_EXPECT_OK(NewStripedHostPortGrpcChannel("127.0.0.1:2222", 0, &stripe0));
+  TF_EXPECT_OK(NewStripedHostPortGrpcChannel("127.0.0.1:2222", 1, &stripe1));
+  EXPECT_NE(stripe0, stripe1);
+
+  EXPECT_FALSE(
+      NewStripedHostPortGrpcChannel("example.com/abc:2222", 1, &stripe1).ok());
+}
+
 }  // namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <atomic>
 #include <utility>
+#include <vector>
 
 #include "grpc++/generic/generic_stub.h"
 #include "grpc++/grpc++.h"
@@ -39,11 +41,13 @@ namespace tensorflow {
 
 class GrpcRemoteWorker : public WorkerInterface {
  public:
-  explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
-                            ::grpc::CompletionQueue* completion_queue,
-                            WorkerCacheLogger* logger)
+  GrpcRemoteWorker(const string& target, SharedGrpcChannelPtr channel,
+                   std::vector<SharedGrpcChannelPtr> stripe_channels,
+                   ::grpc::CompletionQueue* completion_queue,
+                   WorkerCacheLogger* logger)
       : channel_(std::move(channel)),
         stub_(channel_),
+        stripe_channels_(std::move(stripe_channels)),
         cq_(completion_queue),
         getstatus_(Method(GrpcWorkerMethod::kGetStatus)),
         createworkersession_(Method(GrpcWorkerMethod::kCreateWorkerSession)),
@@ -54,9 +58,15 @@ class GrpcRemoteWorker : public WorkerInterface {
         cleanupgraph_(Method(GrpcWorkerMethod::kCleanupGraph)),
         cleanupall_(Method(GrpcWorkerMethod::kCleanupAll)),
         recvtensor_(Method(GrpcWorkerMethod::kRecvTensor)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         logging_(Method(GrpcWorkerMethod::kLogging)),
         tracing_(Method(GrpcWorkerMethod::kTracing)),
-        logger_(logger) {}
+        logger_(logger),
+        peer_counters_(logger->GetPeerCounters(target)) {
+    for (const SharedGrpcChannelPtr& c : stripe_channels_) {
+      stripe_stubs_.emplace_back(new ::grpc::GenericStub(c));
+    }
+  }
 
   ~GrpcRemoteWorker() override {}
 
@@ -117,42 +127,61 @@ class GrpcRemoteWorker : public WorkerInterface {
                        TensorResponse* response, StatusCallback done) override {
     VLOG(1) << "RecvTensorAsync req: " << request->DebugString();
     int64 start_usec = Env::Default()->NowMicros();
-    // Type-specialized logging for this method.
-    bool logging_active = logger_->LoggingActive() || VLOG_IS_ON(2);
-    StatusCallback wrapper_done;
-    const StatusCallback* cb_to_use;
-    if (!logging_active) {
-      cb_to_use = &done;  // No additional work to do, so just use done directly
-    } else {
-      wrapper_done = [this, request, response, done, start_usec](Status s) {
-        if (logger_->LoggingActive()) {
-          int64 end_usec = Env::Default()->NowMicros();
-          int64 step_id = request->step_id();
-          int64 bytes = response->tensor().TotalBytes();
-          int64 send_start_usec = start_usec;
-          // If a send start time was reported by the other side, use
-          // that instead.  Maybe we should mark the display if we're using
-          // our local time instead of the remote start time?
-          if (response->metadata().send_start_micros()) {
-            // send_start_micros is the timestamp taken when the
-            // remote machine began to send the RecvTensor response.
-            // Due to clock skew between source and dest machines, it
-            // is possible that send_start_micros can be larger than
-            // end_usec or less than start_usec.
-            //
-            // To respect causality, we enforce the invariants that
-            // the RecvTensor response can not have been sent before
-            // the RecvTensor request, and must have been sent before
-            // it was received.
-            send_start_usec = std::max(
-                start_usec,
-                static_cast<int64>(response->metadata().send_start_micros()));
-            send_start_usec = std::min(send_start_usec, end_usec - 1);
-          }
-          const string& key = request->rendezvous_key();
-          std::vector<string> key_parts = str_util::Split(key, ';');
-          if (key_parts.size() != 5) {
-            LOG(WARNING) << "Bad key: " << key;
+    // Type-specialized logging for this method. The per-peer counters are
+    // updated whether or not logging is active.
+    StatusCallback wrapper_done = [this, request, response, done,
+                                   start_usec](Status s) {
+      int64 end_usec = Env::Default()->NowMicros();
+      if (s.ok()) {
+        peer_counters_->Record(response->tensor().TotalBytes(),
+                               end_usec - start_usec);
+      }
+      if (logger_->LoggingActive()) {
+        int64 step_id = request->step_id();
+        int64 bytes = response->tensor().TotalBytes();
+        int64 send_start_usec = start_usec;
+        // If a send start time was reported by the other side, use
+        // that instead.  Maybe we should mark the display if we're using
+        // our local time instead of the remote start time?
+        if (response->metadata().send_start_micros()) {
+          // send_start_micros is the timestamp taken when the
+          // remote machine began to send the RecvTensor response.
+          // Due to clock skew between source and dest machines, it
+          // is possible that send_start_micros can be larger than
+          // end_usec or less than start_usec.
+          //
+          // To respect causality, we enforce the invariants that
+          // the RecvTensor response can not have been sent before
+          // the RecvTensor request, and must have been sent before
+          // it was received.
+          send_start_usec = std::max(
+              start_usec,
+              static_cast<int64>(response->metadata().send_start_micros()));
+          send_start_usec = std::min(send_start_usec, end_usec - 1);
+        }
+        const string& key = request->rendezvous_key();
+        std::vector<string> key_parts = str_util::Split(key, ';');
+        if (key_parts.size() != 5) {
+          LOG(WARNING) << "Bad key: " << key;
+        } else {
+          if (response->metadata().has_timings()) {
+            // The phases are measured from the local start of the call,
+            // not from send_start_micros, so that they add up whatever
+            // the clock skew.
+            const RecvTensorTimings& remote = response->metadata().timings();
+            WorkerCacheLogger::TransferTimings timings;
+            timings.enqueue_usecs = remote.enqueue_micros();
+            timings.rendezvous_wait_usecs = remote.rendezvous_wait_micros();
+            timings.deserialize_usecs = response->parse_micros();
+            timings.wire_usecs = std::max<int64>(
+                0, end_usec - start_usec - timings.enqueue_usecs -
+                       timings.rendezvous_wait_usecs -
+                       timings.deserialize_usecs);
+            logger_->RecordRecvTensor(step_id, start_usec, end_usec,
+                                      key_parts[3],  // tensor name
+                                      key_parts[0],  // src_device
+                                      key_parts[2],  // dst_device
+                                      bytes, timings);
           } else {
             logger_->RecordRecvTensor(step_id, send_start_usec, end_usec,
                                       key_parts[3],  // tensor name
@@ -161,14 +190,23 @@ class GrpcRemoteWorker : public WorkerInterface {
                                       bytes);
           }
         }
-        VLOG(2) << "done callback, req: " << request->DebugString()
-                << " response " << response->metadata().DebugString();
-        done(s);
-      };
-      cb_to_use = &wrapper_done;
-    }
+      }
+      VLOG(2) << "done callback, req: " << request->DebugString()
+              << " response " << response->metadata().DebugString();
+      done(s);
+    };
+
+    new RPCState<TensorResponse>(NextTensorStub(), cq_, recvtensor_, *request,
+                                 response, std::move(wrapper_done), call_opts);
+  }
 
-    IssueRequest(request, response, recvtensor_, *cb_to_use, call_opts);
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    new RPCState<protobuf::Message>(NextTensorStub(), cq_, recvtensorbatch_,
+                                    *request, response, std::move(done),
+                                    call_opts);
   }
 
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
@@ -197,11 +235,26 @@ class GrpcRemoteWorker : public WorkerInterface {
                                  std::move(done), call_opts);
   }
 
+  // Returns the stub on which to issue the next tensor transfer. Transfers
+  // are spread round-robin over the main channel and the stripe channels,
+  // so that concurrent large tensors from one peer use several
+  // connections.
+  ::grpc::GenericStub* NextTensorStub() {
+    if (stripe_stubs_.empty()) return &stub_;
+    const size_t i = next_stripe_.fetch_add(1, std::memory_order_relaxed) %
+                     (stripe_stubs_.size() + 1);
+    return i == 0 ? &stub_ : stripe_stubs_[i - 1].get();
+  }
+
   // Helper function for initializing the RpcMethod objects below.
   const char* Method(GrpcWorkerMethod id) { return GrpcWorkerMethodName(id); }
 
   SharedGrpcChannelPtr channel_;
   ::grpc::GenericStub stub_;
+  // Additional connections to the same worker, used for tensor transfers.
+  std::vector<SharedGrpcChannelPtr> stripe_channels_;
+  std::vector<std::unique_ptr<::grpc::GenericStub>> stripe_stubs_;
+  std::atomic<uint64> next_stripe_{0};
   ::grpc::CompletionQueue* cq_;
 
   const ::grpc::string getstatus_;
@@ -213,19 +266,24 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string cleanupgraph_;
   const ::grpc::string cleanupall_;
   const ::grpc::string recvtensor_;
+  const ::grpc::string recvtensorbatch_;
   const ::grpc::string logging_;
   const ::grpc::string tracing_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
+  WorkerCacheLogger::PeerCounters* const peer_counters_;  // Not owned.
 
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
 
-WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
-                                     ::grpc::CompletionQueue* completion_queue,
-                                     WorkerCacheLogger* logger) {
-  return new GrpcRemoteWorker(std::move(channel), completion_queue, logger);
+WorkerInterface* NewGrpcRemoteWorker(
+    const string& target, SharedGrpcChannelPtr channel,
+    std::vector<SharedGrpcChannelPtr> stripe_channels,
+    ::grpc::CompletionQueue* completion_queue, WorkerCacheLogger* logger) {
+  return new GrpcRemoteWorker(target, std::move(channel),
+                              std::move(stripe_channels), completion_queue,
+                              logger);
 }
 
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define THIRD_PARTY_TENSORFLOW_DISTRIBUTED_RUNTIME_RPC_GRPC_REMOTE_WORKER_H_
 
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
@@ -29,9 +30,15 @@ namespace tensorflow {
 class WorkerCacheLogger;
 class WorkerInterface;
 
-WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
-                                     ::grpc::CompletionQueue* completion_queue,
-                                     WorkerCacheLogger* logger);
+// Returns a WorkerInterface for the worker "target" (e.g.
+// "/job:worker/replica:0/task:1") that issues its RPCs on "channel".
+// Tensor transfers are also spread over "stripe_channels", which should be
+// separate connections to the same worker. Per-peer transfer counters are
+// kept in "logger" under "target".
+WorkerInterface* NewGrpcRemoteWorker(
+    const string& target, SharedGrpcChannelPtr channel,
+    std::vector<SharedGrpcChannelPtr> stripe_channels,
+    ::grpc::CompletionQueue* completion_queue, WorkerCacheLogger* logger);
 
 }  // namespace tensorflow
 
@@ -17,10 +17,12 @@ limitations under the License.
 #include "grpc++/support/byte_buffer.h"
 #include "grpc++/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
 #include "tensorflow/core/platform/env.h"
@@ -63,6 +65,10 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 // If the tensor data is up to "kLargeTensorBytes", then A
 // through E will all be encoded into "*result" in a single grpc::Slice.
 //
+// DT_STRING tensors take the same path, with E written straight from the
+// strings of "val" in the layout of port::EncodeStringList(), so that a batch
+// of strings is copied once instead of into a TensorProto and then out of it.
+//
 // If the tensor data is larger than "kLargeTensorBytes", then A through
 // D2 will be encoded in one grpc::Slice, and E will be encoded in a second
 // grpc::Slice that points to the backing store for the tensor data, to avoid
@@ -133,22 +139,46 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
-void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
-                              ::grpc::ByteBuffer* result) {
-  const int kLargeTensorBytes = 1024;
-  RecvTensorResponse response;
-  if (is_dead) {
-    response.set_is_dead(is_dead);
+// Returns the size of the tensor_content of the DT_STRING tensor "val": the
+// varint lengths of all elements followed by their bytes.
+static size_t StringTensorContentSize(const Tensor& val) {
+  const auto strings = val.flat<string>();
+  size_t bytes = 0;
+  for (int64 i = 0; i < strings.size(); ++i) {
+    bytes += core::VarintLength(strings(i).size()) + strings(i).size();
+  }
+  return bytes;
+}
+
+// Writes the tensor_content of the DT_STRING tensor "val" to "dst", which
+// must hold StringTensorContentSize(val) bytes.
+static void EncodeStringTensorContent(const Tensor& val, char* dst) {
+  const auto strings = val.flat<string>();
+  for (int64 i = 0; i < strings.size(); ++i) {
+    dst = core::EncodeVarint32(dst, strings(i).size());
+  }
+  for (int64 i = 0; i < strings.size(); ++i) {
+    memcpy(dst, strings(i).data(), strings(i).size());
+    dst += strings(i).size();
   }
-  response.set_send_start_micros(Env::Default()->NowMicros());
-  if (!DataTypeCanUseMemcpy(val.dtype())) {
+}
+
+// Encodes "val" and the fields of "response" other than its tensor, which
+// must be empty.
+static void EncodeTensorWithResponseToByteBuffer(
+    const Tensor& val, RecvTensorResponse* response,
+    ::grpc::ByteBuffer* result) {
+  const int kLargeTensorBytes = 1024;
+  response->set_send_start_micros(Env::Default()->NowMicros());
+  const bool is_string = val.dtype() == DT_STRING;
+  if (!DataTypeCanUseMemcpy(val.dtype()) && !is_string) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
     // go directly from val -> ByteBuffer, with some effort.
-    val.AsProtoTensorContent(response.mutable_tensor());
+    val.AsProtoTensorContent(response->mutable_tensor());
 
     // Encode full protocol buffer to a ByteBuffer
-    EncodeRecvTensorResponseToByteBuffer(response, result);
+    EncodeRecvTensorResponseToByteBuffer(*response, result);
   } else {
     // skeleton is the encoded TensorProto contents (dtype and shape), but
     // not the actual data
@@ -156,13 +186,20 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
     io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
     EncodeSkeleton(val, &e_skeleton);
 
-    StringPiece tdata = val.tensor_data();
+    StringPiece tdata;
+    size_t tdata_size;
+    if (is_string) {
+      tdata_size = StringTensorContentSize(val);
+    } else {
+      tdata = val.tensor_data();
+      tdata_size = tdata.size();
+    }
     uint32 overall_tensor_proto_bytesize =
         (e_skeleton.size() +
          VarLengthEncodingSize(TensorProto::kTensorContentFieldNumber,
-                               tdata.size()));
+                               tdata_size));
     string header;  // All of RecvTensorResponse except the tensor() field
-    response.AppendToString(&header);
+    response->AppendToString(&header);
 
     size_t expected_size =
         (header.size() +
@@ -175,9 +212,10 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
     // If "tensor_data_is_large == true", we arrange to share the backing
     // store of the data by creating a slice that also points to the
     // backing store, with appropriate reference counts to keep the
-    // backing store alive as needed.
-    bool tensor_data_is_large = (tdata.size() > kLargeTensorBytes);
-    size_t encoder_size = expected_size - tdata.size();
+    // backing store alive as needed. The encoding of strings has no
+    // backing store to share, so it is always copied.
+    bool tensor_data_is_large = !is_string && (tdata_size > kLargeTensorBytes);
+    size_t encoder_size = expected_size - tdata_size;
 
     // Encode all but the actual "tdata", but including the tag and
     // varlength header for the "tdata"
@@ -193,7 +231,7 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
     e.WriteRawBytes(StringPiece(e_skeleton.data(), e_skeleton.size()));
     // (D1) & (D2)
     e.WriteVarlengthBeginning(TensorProto::kTensorContentFieldNumber,
-                              tdata.size());
+                              tdata_size);
 
     // All but the tensor backing store are serialized now
 
@@ -201,10 +239,15 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
     ::grpc::Slice slices[2];
     int num_slices = 0;
     {
-      size_t slice_len = e.size() + (tensor_data_is_large ? 0 : tdata.size());
+      size_t slice_len = e.size() + (tensor_data_is_large ? 0 : tdata_size);
       slices[0] = ::grpc::Slice(slice_len);
       memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
-      if (!tensor_data_is_large) {
+      if (is_string) {
+        // (E)
+        EncodeStringTensorContent(
+            val, reinterpret_cast<char*>(
+                     const_cast<uint8_t*>(slices[0].begin()) + e.size()));
+      } else if (!tensor_data_is_large) {
         // (E)
         memcpy(const_cast<uint8_t*>(slices[0].begin()) + e.size(), tdata.data(),
                tdata.size());
@@ -234,5 +277,68 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
   }
 }
 
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              ::grpc::ByteBuffer* result) {
+  RecvTensorResponse response;
+  if (is_dead) {
+    response.set_is_dead(is_dead);
+  }
+  EncodeTensorWithResponseToByteBuffer(val, &response, result);
+}
+
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              TensorCodec codec, ::grpc::ByteBuffer* result) {
+  EncodeTensorToByteBuffer(is_dead, val, codec, nullptr, result);
+}
+
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              TensorCodec codec,
+                              const RecvTensorTimings* timings,
+                              ::grpc::ByteBuffer* result) {
+  RecvTensorResponse response;
+  if (timings != nullptr) {
+    *response.mutable_timings() = *timings;
+  }
+  // Dead tensors have no meaningful contents to encode.
+  if (codec != TENSOR_CODEC_NONE && !is_dead) {
+    if (EncodeTensorProto(codec, val, response.mutable_tensor())) {
+      response.set_send_start_micros(Env::Default()->NowMicros());
+      response.set_codec(codec);
+      EncodeRecvTensorResponseToByteBuffer(response, result);
+      return;
+    }
+    response.clear_tensor();
+  }
+  if (is_dead) {
+    response.set_is_dead(is_dead);
+  }
+  EncodeTensorWithResponseToByteBuffer(val, &response, result);
+}
+
+void EncodeRecvTensorBatchToByteBuffer(const ::grpc::ByteBuffer* responses,
+                                       int num_responses,
+                                       ::grpc::ByteBuffer* result) {
+  std::vector<::grpc::Slice> slices;
+  std::vector<::grpc::Slice> response_slices;
+  for (int i = 0; i < num_responses; ++i) {
+    // Each response is a length-delimited RecvTensorBatchResponse::responses
+    // field: a tag and length, followed by the slices of the response.
+    const size_t length = responses[i].Length();
+    char header[2 * core::kMaxVarint32Bytes];
+    io::ProtoEncodeHelper e(header, sizeof(header));
+    e.WriteVarlengthBeginning(RecvTensorBatchResponse::kResponsesFieldNumber,
+                              length);
+    slices.emplace_back(e.data(), e.size());
+    if (length > 0) {
+      CHECK(responses[i].Dump(&response_slices).ok());
+      for (::grpc::Slice& s : response_slices) {
+        slices.push_back(std::move(s));
+      }
+    }
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
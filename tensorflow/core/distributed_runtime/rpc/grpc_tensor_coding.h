@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include "tensorflow/core/protobuf/worker.pb.h"
+
 namespace grpc {
 class ByteBuffer;
 }  // namespace grpc
@@ -23,6 +25,7 @@ class ByteBuffer;
 namespace tensorflow {
 class Tensor;
 class RecvTensorResponse;
+class RecvTensorTimings;
 
 // TODO(jeff,sanjay): this should not be grpc specific.  Instead of
 // grpc::ByteBuffer*, it should accept an object of an interface type
@@ -51,6 +54,27 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
                               ::grpc::ByteBuffer* result);
 
+// Like the above, but encodes the contents of "val" with "codec" (see
+// tensor_codec.h) if it applies to "val" and makes it smaller.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              TensorCodec codec, ::grpc::ByteBuffer* result);
+
+// Like the above, and also encodes "timings" if it is not nullptr.
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val,
+                              TensorCodec codec,
+                              const RecvTensorTimings* timings,
+                              ::grpc::ByteBuffer* result);
+
+// Encode "num_responses" byte buffers, each holding an encoded
+// RecvTensorResponse, into a byte buffer in a format that is parseable as
+// a RecvTensorBatchResponse protocol buffer with those responses. The
+// slices of the responses are shared, not copied.
+//
+// Discards original contents of *result.
+void EncodeRecvTensorBatchToByteBuffer(const ::grpc::ByteBuffer* responses,
+                                       int num_responses,
+                                       ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -100,4 +100,64 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, StringTensorMatchesProtoEncoding) {
+  // Empty strings and strings whose length takes a multi-byte varint.
+  Tensor t = test::AsTensor<string>({"", "a", string(200, 'b'), "",
+                                     string(70000, 'c')});
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, t, &buf);
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+
+  RecvTensorResponse response;
+  ASSERT_TRUE(response.ParseFromString(tmp));
+  TensorProto expected;
+  t.AsProtoTensorContent(&expected);
+  EXPECT_EQ(expected.tensor_content(), response.tensor().tensor_content());
+  Tensor result;
+  ASSERT_TRUE(result.FromProto(response.tensor()));
+  test::ExpectTensorEqual<string>(t, result);
+}
+
+TEST_F(GrpcTensorCodingTest, Batch) {
+  // A small tensor, a large one whose data is shared with the buffer, and a
+  // dead one.
+  std::vector<Tensor> tensors;
+  tensors.push_back(test::AsTensor<float>({1.0f, 2.0f, 3.0f}));
+  Tensor large(DT_INT32, TensorShape({100000}));
+  test::FillFn<int32>(&large, [](int i) -> int32 { return i; });
+  tensors.push_back(large);
+  tensors.push_back(Tensor(DT_FLOAT, TensorShape({0})));
+  std::vector<::grpc::ByteBuffer> responses(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    grpc::EncodeTensorToByteBuffer(i == 2, tensors[i], &responses[i]);
+  }
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeRecvTensorBatchToByteBuffer(responses.data(), responses.size(),
+                                          &buf);
+
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  RecvTensorBatchResponse batch;
+  ASSERT_TRUE(batch.ParseFromString(tmp));
+  ASSERT_EQ(tensors.size(), batch.responses_size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    EXPECT_EQ(i == 2, batch.responses(i).is_dead());
+    Tensor result;
+    EXPECT_TRUE(result.FromProto(batch.responses(i).tensor()));
+    EXPECT_EQ(tensors[i].DebugString(), result.DebugString());
+  }
+
+  grpc::EncodeRecvTensorBatchToByteBuffer(nullptr, 0, &buf);
+  EXPECT_EQ(0, buf.Length());
+}
+
 }  // namespace tensorflow
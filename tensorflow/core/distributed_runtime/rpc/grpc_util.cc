@@ -15,9 +15,39 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 
 namespace tensorflow {
 
+namespace {
+
+// A TensorBuffer that keeps a reference to the grpc slice it points into.
+class GrpcSliceTensorBuffer : public TensorBuffer {
+ public:
+  GrpcSliceTensorBuffer(const ::grpc::Slice& slice, size_t offset,
+                        size_t num_bytes)
+      : slice_(slice),
+        data_(const_cast<uint8*>(slice_.begin()) + offset),
+        size_(num_bytes) {}
+
+  void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64>(size_));
+    proto->set_allocator_name("grpc_slice");
+  }
+  // The slice may be shared with gRPC, so kernels must not write to it.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::Slice slice_;
+  uint8* const data_;
+  const size_t size_;
+};
+
+}  // namespace
+
 GrpcByteBufferSource::GrpcByteBufferSource() {}
 
 bool GrpcByteBufferSource::Init(const grpc::ByteBuffer& src) {
@@ -78,6 +108,19 @@ grpc::protobuf::int64 GrpcByteBufferSource::ByteCount() const {
   return byte_count_;
 }
 
+TensorBuffer* GrpcByteBufferSource::Alias(int64 offset,
+                                          int64 num_bytes) const {
+  for (const ::grpc::Slice& s : slices_) {
+    const int64 size = s.size();
+    if (offset < size) {
+      if (offset + num_bytes > size) return nullptr;
+      return new GrpcSliceTensorBuffer(s, offset, num_bytes);
+    }
+    offset -= size;
+  }
+  return nullptr;
+}
+
 void GrpcMaybeUnparseProto(const protobuf::Message& src,
                            grpc::ByteBuffer* dst) {
   // TODO(sanjay): For bigger protos, serialize into a ZeroCopyOutputStream.
@@ -115,6 +158,10 @@ bool GrpcMaybeParseProto(const ::grpc::ByteBuffer& src, TensorResponse* dst) {
       ok = src.Init(*buffer);
       return &src;
     }
+
+    TensorBuffer* AliasContents(int64 offset, int64 num_bytes) override {
+      return src.Alias(offset, num_bytes);
+    }
   };
   ByteSource bs;
   bs.buffer = &src;
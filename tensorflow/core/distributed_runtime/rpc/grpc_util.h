@@ -96,6 +96,11 @@ class GrpcByteBufferSource : public ::grpc::protobuf::io::ZeroCopyInputStream {
   bool Skip(int count) override;
   ::grpc::protobuf::int64 ByteCount() const override;
 
+  // Returns a buffer that shares the "num_bytes" bytes that start "offset"
+  // bytes into the source, or nullptr if they do not lie in a single slice.
+  // The caller owns the returned reference.
+  TensorBuffer* Alias(int64 offset, int64 num_bytes) const;
+
  private:
   std::vector<::grpc::Slice> slices_;
   int cur_;          // Current slice index.
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_cache.h"
 
+#include <unordered_map>
+#include <vector>
+
 #include "tensorflow/core/distributed_runtime/rpc/grpc_channel.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
@@ -23,11 +26,39 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_cache_partial.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Number of connections to open to each remote worker. RecvTensor calls are
+// spread round-robin over them, which helps when several large tensors are
+// fetched from the same peer at once.
+int64 NumChannelsPerWorker() {
+  static const int64 num_channels = [] {
+    int64 value;
+    Status s = ReadInt64FromEnvVar("TF_GRPC_CHANNELS_PER_WORKER", 1, &value);
+    if (!s.ok()) LOG(ERROR) << s;
+    return s.ok() && value > 1 ? value : 1;
+  }();
+  return num_channels;
+}
+
+// If true, the connections to all the workers of the cluster are opened
+// when the worker cache is created, i.e. when the session is created,
+// rather than on the first RPC of a step.
+bool WarmUpChannels() {
+  static const bool warm_up = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_GRPC_WARMUP_CHANNELS", false, &value);
+    if (!s.ok()) LOG(ERROR) << s;
+    return s.ok() && value;
+  }();
+  return warm_up;
+}
+
 class GrpcWorkerCache : public WorkerCachePartial {
  public:
   explicit GrpcWorkerCache(GrpcChannelCache* channel_cache,
@@ -47,6 +78,7 @@ class GrpcWorkerCache : public WorkerCachePartial {
             callback_tag->OnCompleted(ok);
           }
         });
+    if (WarmUpChannels()) WarmUp();
   }
 
   // Explicit destructor to control destruction order.
@@ -66,7 +98,8 @@ class GrpcWorkerCache : public WorkerCachePartial {
     } else {
       SharedGrpcChannelPtr channel = channel_cache_->FindWorkerChannel(target);
       if (!channel) return nullptr;
-      return NewGrpcRemoteWorker(channel, &completion_queue_, &logger_);
+      return NewGrpcRemoteWorker(target, channel, StripeChannels(target),
+                                 &completion_queue_, &logger_);
     }
   }
 
@@ -88,12 +121,57 @@ class GrpcWorkerCache : public WorkerCachePartial {
   }
 
  private:
+  // Returns the channels other than channel_cache_'s on which tensors are
+  // received from "target", creating them on first use. Empty unless
+  // TF_GRPC_CHANNELS_PER_WORKER is greater than 1.
+  std::vector<SharedGrpcChannelPtr> StripeChannels(const string& target) {
+    const int64 num_channels = NumChannelsPerWorker();
+    if (num_channels <= 1) return {};
+    mutex_lock l(mu_);
+    auto it = stripe_channels_.find(target);
+    if (it != stripe_channels_.end()) return it->second;
+    std::vector<SharedGrpcChannelPtr>& channels = stripe_channels_[target];
+    const string host_port = channel_cache_->TranslateTask(target);
+    for (int stripe = 1; stripe < num_channels; ++stripe) {
+      SharedGrpcChannelPtr channel;
+      Status s = NewStripedHostPortGrpcChannel(host_port, stripe, &channel);
+      if (!s.ok()) {
+        // E.g. a custom channel creation function; use its channel only.
+        VLOG(1) << "Not striping transfers from " << target << ": " << s;
+        channels.clear();
+        break;
+      }
+      channels.push_back(std::move(channel));
+    }
+    return channels;
+  }
+
+  // Starts connecting to every remote worker, without waiting for the
+  // connections to be established.
+  void WarmUp() {
+    std::vector<string> workers;
+    ListWorkers(&workers);
+    for (const string& target : workers) {
+      if (target == local_target_) continue;
+      SharedGrpcChannelPtr channel = channel_cache_->FindWorkerChannel(target);
+      if (!channel) continue;
+      channel->GetState(true /* try_to_connect */);
+      for (const SharedGrpcChannelPtr& stripe : StripeChannels(target)) {
+        stripe->GetState(true /* try_to_connect */);
+      }
+    }
+  }
+
   const string local_target_;
   WorkerInterface* const local_worker_;  // Not owned.
   GrpcChannelCache* channel_cache_;  // Owned.
   ::grpc::CompletionQueue completion_queue_;
   Thread* polling_thread_;  // Owned.
   WorkerCacheLogger logger_;
+
+  mutex mu_;
+  std::unordered_map<string, std::vector<SharedGrpcChannelPtr>>
+      stripe_channels_ GUARDED_BY(mu_);
 };
 
 }  // namespace
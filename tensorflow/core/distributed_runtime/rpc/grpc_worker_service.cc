@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
 
+#include <algorithm>
 #include <deque>
 
 #include "grpc++/alarm.h"
@@ -36,14 +37,17 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/shared_memory_transport.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
@@ -124,6 +128,9 @@ class GrpcWorkerService : public AsyncServiceInterface {
     for (int i = 0; i < 1000; ++i) {
       EnqueueRecvTensorRequestRaw();
     }
+    for (int i = 0; i < 100; ++i) {
+      EnqueueRecvTensorBatchRequestRaw();
+    }
     for (int i = 0; i < 100; ++i) {
       ENQUEUE_REQUEST(RunGraph, true);
     }
@@ -253,10 +260,13 @@ class GrpcWorkerService : public AsyncServiceInterface {
 
   void RecvTensorHandlerRaw(
       WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
-    Schedule([this, call]() {
+    const int64 arrival_micros = Env::Default()->NowMicros();
+    Schedule([this, call, arrival_micros]() {
+      const int64 enqueue_micros = Env::Default()->NowMicros() - arrival_micros;
       CallOptions* call_opts = new CallOptions;
       call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
       worker_->GrpcRecvTensorAsync(call_opts, &call->request, &call->response,
+                                   enqueue_micros,
                                    [call, call_opts](const Status& s) {
                                      call->ClearCancelCallback();
                                      delete call_opts;
@@ -266,6 +276,24 @@ class GrpcWorkerService : public AsyncServiceInterface {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorBatchHandlerRaw(
+      WorkerCall<RecvTensorBatchRequest, ::grpc::ByteBuffer>* call) {
+    const int64 arrival_micros = Env::Default()->NowMicros();
+    Schedule([this, call, arrival_micros]() {
+      const int64 enqueue_micros = Env::Default()->NowMicros() - arrival_micros;
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->GrpcRecvTensorBatchAsync(call_opts, &call->request,
+                                        &call->response, enqueue_micros,
+                                        [call, call_opts](const Status& s) {
+                                          call->ClearCancelCallback();
+                                          delete call_opts;
+                                          call->SendResponse(ToGrpcStatus(s));
+                                        });
+    });
+    EnqueueRecvTensorBatchRequestRaw();
+  }
+
   void CleanupGraphHandler(
       WorkerCall<CleanupGraphRequest, CleanupGraphResponse>* call) {
     Schedule([this, call]() {
@@ -305,11 +333,72 @@ class GrpcWorkerService : public AsyncServiceInterface {
     }
   }
 
+  void EnqueueRecvTensorBatchRequestRaw() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      Call<GrpcWorkerService, grpc::WorkerService::AsyncService,
+           RecvTensorBatchRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              &worker_service_, cq_.get(),
+              static_cast<int>(GrpcWorkerMethod::kRecvTensorBatch),
+              &GrpcWorkerService::RecvTensorBatchHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcWorkerService);
 };
 
 }  // namespace
 
+namespace {
+
+// Returns the size, in bytes, from which the content of a tensor is sent
+// through shared memory to a caller on the same host that asks for it. Set
+// with TF_GRPC_SHARED_MEMORY_MIN_BYTES; smaller tensors are cheaper to send
+// in the response.
+int64 SharedMemoryMinBytes() {
+  static const int64 min_bytes = [] {
+    int64 value;
+    Status s = ReadInt64FromEnvVar("TF_GRPC_SHARED_MEMORY_MIN_BYTES",
+                                   64 << 10, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return int64{64 << 10};
+    }
+    return std::max<int64>(value, 1);
+  }();
+  return min_bytes;
+}
+
+// Encodes "val" into "*result" like grpc::EncodeTensorToByteBuffer(), except
+// that if "shared_memory" is true, i.e. the caller can open the shared memory
+// objects of this process, large tensors are written to a shared memory
+// object and only their metadata is encoded.
+void EncodeRecvTensor(bool shared_memory, bool is_dead, const Tensor& val,
+                      TensorCodec codec, const RecvTensorTimings& timings,
+                      ::grpc::ByteBuffer* result) {
+  if (shared_memory && !is_dead && DataTypeCanUseMemcpy(val.dtype()) &&
+      val.TotalBytes() >= SharedMemoryMinBytes()) {
+    RecvTensorResponse proto;
+    Status s = WriteTensorToSharedMemory(val, proto.mutable_shared_memory());
+    if (s.ok()) {
+      proto.set_send_start_micros(Env::Default()->NowMicros());
+      *proto.mutable_timings() = timings;
+      TensorProto* tensor = proto.mutable_tensor();
+      tensor->set_dtype(val.dtype());
+      val.shape().AsProto(tensor->mutable_tensor_shape());
+      grpc::EncodeRecvTensorResponseToByteBuffer(proto, result);
+      return;
+    }
+    LOG(WARNING) << "Sending a tensor in the RecvTensor response instead of "
+                 << "shared memory: " << s;
+  }
+  grpc::EncodeTensorToByteBuffer(is_dead, val, codec, &timings, result);
+}
+
+}  // namespace
+
 GrpcWorker::GrpcWorker(WorkerEnv* worker_env) : Worker(worker_env) {}
 
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
@@ -318,9 +407,14 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env) : Worker(worker_env) {}
 void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                                      const RecvTensorRequest* request,
                                      ::grpc::ByteBuffer* response,
+                                     int64 enqueue_micros,
                                      StatusCallback done) {
   const int64 step_id = request->step_id();
   const string& key = request->rendezvous_key();
+  const TensorCodec codec = request->codec();
+  const bool shared_memory =
+      !request->shared_memory_host().empty() &&
+      request->shared_memory_host() == SharedMemoryHostId();
   TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
   Rendezvous::ParsedKey parsed;
   Status s = Rendezvous::ParseKey(key, &parsed);
@@ -338,13 +432,21 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   // of execution of the callback lambda body below, an RPC
   // cancellation should abort the rendezvous.
   opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
+  const int64 wait_start_micros = Env::Default()->NowMicros();
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, response, done, src_dev](const Status& status,
-                                      const Rendezvous::Args& send_args,
-                                      const Rendezvous::Args& recv_args,
-                                      const Tensor& val, const bool is_dead) {
+      [opts, response, done, src_dev, codec, shared_memory, enqueue_micros,
+       wait_start_micros](const Status& status,
+                          const Rendezvous::Args& send_args,
+                          const Rendezvous::Args& recv_args, const Tensor& val,
+                          const bool is_dead) {
         opts->ClearCancelCallback();
+        // Reported to the client, which attributes the rest of the call to
+        // the wire.
+        RecvTensorTimings timings;
+        timings.set_enqueue_micros(enqueue_micros);
+        timings.set_rendezvous_wait_micros(Env::Default()->NowMicros() -
+                                           wait_start_micros);
         if (status.ok()) {
           // DMA can only be used for Tensors that do not fall into
           // the following three odd edge cases: 1) a zero-size
@@ -367,10 +469,12 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                   << "send dev name: " << src_dev->name()
                   << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
               // "val" is on a GPU. Uses GPUUtil to fill the copy on host.
-              StatusCallback copy_ready = [response, done, copy,
-                                           is_dead](const Status& s) {
+              StatusCallback copy_ready = [response, done, copy, is_dead,
+                                           codec, shared_memory,
+                                           timings](const Status& s) {
                 // The value is now ready to be returned on the wire.
-                grpc::EncodeTensorToByteBuffer(is_dead, *copy, response);
+                EncodeRecvTensor(shared_memory, is_dead, *copy, codec, timings,
+                                 response);
                 done(s);
                 delete copy;
               };
@@ -381,7 +485,8 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
               done(errors::Internal("No GPU device in process"));
 #endif  // GOOGLE_CUDA
             } else {
-              grpc::EncodeTensorToByteBuffer(is_dead, val, response);
+              EncodeRecvTensor(shared_memory, is_dead, val, codec, timings,
+                               response);
               done(Status::OK());
             }
           }
@@ -392,6 +497,59 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::GrpcRecvTensorBatchAsync(
+    CallOptions* opts, const RecvTensorBatchRequest* request,
+    ::grpc::ByteBuffer* response, int64 enqueue_micros, StatusCallback done) {
+  const int64 step_id = request->step_id();
+  const int num_tensors = request->requests_size();
+  TRACEPRINTF("RecvTensorBatch: %lld %d", step_id, num_tensors);
+  if (num_tensors == 0) {
+    grpc::EncodeRecvTensorBatchToByteBuffer(nullptr, 0, response);
+    done(Status::OK());
+    return;
+  }
+
+  // The per-tensor calls cannot share "opts", which holds a single cancel
+  // callback, so the whole batch aborts the step when it is cancelled.
+  struct BatchCall {
+    std::vector<RecvTensorRequest> requests;
+    std::unique_ptr<CallOptions[]> opts;
+    std::vector<::grpc::ByteBuffer> responses;
+    mutex mu;
+    int pending GUARDED_BY(mu);
+    Status status GUARDED_BY(mu);
+  };
+  BatchCall* batch = new BatchCall;
+  batch->requests.assign(request->requests().begin(),
+                         request->requests().end());
+  batch->opts.reset(new CallOptions[num_tensors]);
+  batch->responses.resize(num_tensors);
+  batch->pending = num_tensors;
+  opts->SetCancelCallback([this, step_id]() { AbortStep(step_id); });
+  for (int i = 0; i < num_tensors; ++i) {
+    batch->requests[i].set_step_id(step_id);
+    // "batch" may be deleted by the callback of the last call, so it must
+    // not be used after that call is issued.
+    GrpcRecvTensorAsync(
+        &batch->opts[i], &batch->requests[i], &batch->responses[i],
+        enqueue_micros, [batch, opts, response, done](const Status& s) {
+          {
+            mutex_lock l(batch->mu);
+            batch->status.Update(s);
+            if (--batch->pending > 0) return;
+          }
+          opts->ClearCancelCallback();
+          Status status = batch->status;
+          if (status.ok()) {
+            grpc::EncodeRecvTensorBatchToByteBuffer(
+                batch->responses.data(), batch->responses.size(), response);
+          }
+          delete batch;
+          done(status);
+        });
+  }
+}
+
 WorkerEnv* GrpcWorker::env() { return env_; }
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* env) {
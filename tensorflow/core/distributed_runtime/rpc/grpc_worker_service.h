@@ -34,10 +34,20 @@ class GrpcWorker : public Worker {
   GrpcWorker(WorkerEnv* env);
 
   // Specialized version of RecvTensor for gRPC, which avoids a copy.
+  // "enqueue_micros" is the time the request waited for a thread after it
+  // arrived; it is reported to the client with the rendezvous wait in
+  // the RecvTensorTimings of the response.
   virtual void GrpcRecvTensorAsync(CallOptions* opts,
                                    const RecvTensorRequest* request,
                                    ::grpc::ByteBuffer* response,
-                                   StatusCallback done);
+                                   int64 enqueue_micros, StatusCallback done);
+
+  // Receives the tensors of "request" with GrpcRecvTensorAsync() and
+  // encodes them into "response" as a RecvTensorBatchResponse.
+  void GrpcRecvTensorBatchAsync(CallOptions* opts,
+                                const RecvTensorBatchRequest* request,
+                                ::grpc::ByteBuffer* response,
+                                int64 enqueue_micros, StatusCallback done);
 
   WorkerEnv* env();
 };
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/shared_memory_transport.h"
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
@@ -31,11 +34,120 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// Returns true if tensors received for non-host devices should be parsed into
+// host memory and copied to the device, instead of going through a
+// TensorProto. Set TF_GRPC_RECV_TENSOR_STAGE_ON_HOST=1 to enable it.
+bool StageRecvTensorsOnHost() {
+  static bool stage_on_host = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_GRPC_RECV_TENSOR_STAGE_ON_HOST",
+                                  false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.error_message();
+      return false;
+    }
+    return value;
+  }();
+  return stage_on_host;
+}
+
+int64 ReadInt64Option(StringPiece env_var_name, int64 default_val) {
+  int64 value;
+  Status s = ReadInt64FromEnvVar(env_var_name, default_val, &value);
+  if (!s.ok()) {
+    LOG(ERROR) << s.error_message();
+    return default_val;
+  }
+  return value;
+}
+
+// Returns the largest number of tensors that a step receives from one remote
+// worker in a single RecvTensorBatch RPC, or 0 if each tensor is received
+// with its own RecvTensor RPC (the default). Set with
+// TF_GRPC_RECV_TENSOR_BATCH_SIZE.
+//
+// A batched RPC only returns once all its tensors have been produced, so
+// batching must not be enabled for graphs in which a tensor that a worker
+// receives depends on work that the worker does with another tensor it
+// receives from the same worker in the same step. Graphs that read many
+// small variables from parameter servers are the intended use.
+int64 RecvTensorBatchSize() {
+  static int64 batch_size =
+      ReadInt64Option("TF_GRPC_RECV_TENSOR_BATCH_SIZE", 0);
+  return batch_size;
+}
+
+// Returns how long a batch waits for more recvs before its RPC is issued.
+// Set with TF_GRPC_RECV_TENSOR_BATCH_WINDOW_USECS.
+int64 RecvTensorBatchWindowMicros() {
+  static int64 window_usecs =
+      ReadInt64Option("TF_GRPC_RECV_TENSOR_BATCH_WINDOW_USECS", 50);
+  return window_usecs;
+}
+
+// Returns the codec that the tensor of "parsed" should be sent with.
+//
+// TF_GRPC_RECV_TENSOR_CODEC names the codec (see ParseTensorCodec()), and is
+// "none" by default. If TF_GRPC_RECV_TENSOR_CODEC_EDGES is set to a comma
+// separated list of strings, the codec is only used for the edges whose name
+// contains one of them (e.g. "gradients" for the lossy codecs). Whatever the
+// codec, the sender only encodes tensors of the dtypes it applies to.
+TensorCodec RecvTensorCodec(const Rendezvous::ParsedKey& parsed) {
+  struct Config {
+    TensorCodec codec = TENSOR_CODEC_NONE;
+    std::vector<string> edges;
+  };
+  static const Config* config = [] {
+    Config* config = new Config;
+    string name;
+    Status s = ReadStringFromEnvVar("TF_GRPC_RECV_TENSOR_CODEC", "none", &name);
+    if (!s.ok()) {
+      LOG(ERROR) << s.error_message();
+    } else if (!ParseTensorCodec(name, &config->codec)) {
+      LOG(ERROR) << "Unknown TF_GRPC_RECV_TENSOR_CODEC: " << name;
+    }
+    string edges;
+    s = ReadStringFromEnvVar("TF_GRPC_RECV_TENSOR_CODEC_EDGES", "", &edges);
+    if (!s.ok()) {
+      LOG(ERROR) << s.error_message();
+    }
+    config->edges = str_util::Split(edges, ',', str_util::SkipEmpty());
+    return config;
+  }();
+  if (config->codec == TENSOR_CODEC_NONE || config->edges.empty()) {
+    return config->codec;
+  }
+  for (const string& edge : config->edges) {
+    if (parsed.edge_name.contains(edge)) return config->codec;
+  }
+  return TENSOR_CODEC_NONE;
+}
+
+// Returns true if the workers of this process ask the workers they receive
+// tensors from to send large tensors through shared memory when they run on
+// the same host. Set TF_GRPC_SHARED_MEMORY=1 to enable it; the processes
+// must then share /dev/shm.
+bool UseSharedMemory() {
+  static bool use_shared_memory = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_GRPC_SHARED_MEMORY", false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s.error_message();
+      return false;
+    }
+    return value;
+  }();
+  return use_shared_memory;
+}
+
+class RpcRecvTensorBatchCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
@@ -49,6 +161,29 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Receives "parsed" with its own RecvTensor RPC.
+  void RecvFromRemoteSingleAsync(const Rendezvous::ParsedKey& parsed,
+                                 const Rendezvous::Args& args,
+                                 DoneCallback done);
+
+  // Adds "parsed" to the batch of recvs pending for its source worker, and
+  // issues the batch once it is full or its window has passed.
+  void RecvFromRemoteBatchedAsync(const Rendezvous::ParsedKey& parsed,
+                                  const Rendezvous::Args& args,
+                                  DoneCallback done);
+
+  // Issues "batch" if it is still pending for "src_worker".
+  void FlushBatch(const string& src_worker, int64 batch_id);
+
+  // Issues the RecvTensorBatch RPC of "batch", which is no longer pending.
+  void StartBatch(RpcRecvTensorBatchCall* batch);
+
+  mutex batch_mu_;
+  int64 next_batch_id_ GUARDED_BY(batch_mu_) = 0;
+  // The batch being filled for each source worker, if any.
+  std::unordered_map<string, RpcRecvTensorBatchCall*> pending_batches_
+      GUARDED_BY(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -58,8 +193,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
 
   void Init(WorkerInterface* wi, int64 step_id, StringPiece key,
-            AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+            TensorCodec codec, AllocatorAttributes alloc_attrs,
+            Device* dst_device, const Rendezvous::Args& recv_args,
+            Rendezvous::DoneCallback done) {
     wi_ = wi;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
@@ -67,6 +203,13 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     done_ = std::move(done);
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
+    req_.set_codec(codec);
+    // Only tensors received into host memory can be mapped.
+    if (UseSharedMemory() &&
+        (alloc_attrs.on_host() ||
+         dst_device->attributes().device_type() == "CPU")) {
+      req_.set_shared_memory_host(SharedMemoryHostId());
+    }
   }
 
   void Reset(WorkerCacheInterface* wc) {
@@ -125,6 +268,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   // Start the main RecvTensor call, checking for an async abort.
   void StartRTCall(std::function<void()> recv_done) {
     resp_.InitAlloc(dst_device_, alloc_attrs_);
+    resp_.set_stage_on_host(StageRecvTensorsOnHost());
     using namespace std::placeholders;
     StatusCallback cb = std::bind(
         [this](std::function<void()> recv_done,
@@ -202,10 +346,217 @@ static RpcRecvTensorFreeList* get_call_freelist() {
   return call_freelist;
 }
 
+// Used to retrieve several tensors from the same remote process with one
+// RecvTensorBatch RPC.
+class RpcRecvTensorBatchCall : public BaseRecvTensorCall {
+ public:
+  struct Item {
+    Rendezvous::ParsedKey parsed;
+    Device* dst_device;
+    Rendezvous::Args recv_args;
+    Rendezvous::DoneCallback done;
+  };
+
+  RpcRecvTensorBatchCall(int64 batch_id, const string& src_worker,
+                         WorkerInterface* wi, int64 step_id)
+      : batch_id_(batch_id), src_worker_(src_worker), wi_(wi) {
+    req_.set_step_id(step_id);
+  }
+
+  void Add(const Rendezvous::ParsedKey& parsed, Device* dst_device,
+           const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+    items_.push_back({parsed, dst_device, recv_args, std::move(done)});
+    StringPiece key = parsed.FullKey();
+    RecvTensorRequest* request = req_.add_requests();
+    request->set_rendezvous_key(key.data(), key.size());
+    request->set_codec(RecvTensorCodec(parsed));
+  }
+
+  void Start(std::function<void()> recv_done) override {
+    wi_->RecvTensorBatchAsync(&opts_, &req_, &resp_,
+                              [this, recv_done](const Status& s) {
+                                if (!s.ok()) {
+                                  mutex_lock l(mu_);
+                                  status_.Update(s);
+                                }
+                                recv_done();
+                              });
+  }
+
+  void StartAbort(const Status& s) override {
+    {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    opts_.StartCancel();
+  }
+
+  Status status() const override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+  // Converts the response for the "i"-th item into "*tensor" on its
+  // destination device. Must be called at most once for each item.
+  Status GetTensor(int i, Tensor* tensor, bool* is_dead) {
+    if (resp_.responses_size() != size()) {
+      return errors::Internal("Expected ", items_.size(),
+                              " tensors in RecvTensorBatch response, got ",
+                              resp_.responses_size());
+    }
+    const Item& item = items_[i];
+    TensorResponse response;
+    response.InitAlloc(item.dst_device, item.recv_args.alloc_attrs);
+    TF_RETURN_IF_ERROR(response.InitFrom(resp_.mutable_responses(i)));
+    *tensor = response.tensor();
+    *is_dead = response.metadata().is_dead();
+    return Status::OK();
+  }
+
+  int64 batch_id() const { return batch_id_; }
+  const string& src_worker() const { return src_worker_; }
+  WorkerInterface* wi() const { return wi_; }
+  int size() const { return items_.size(); }
+  const Item& item(int i) const { return items_[i]; }
+
+ private:
+  const int64 batch_id_;
+  const string src_worker_;
+  WorkerInterface* const wi_;
+  std::vector<Item> items_;
+  CallOptions opts_;
+  RecvTensorBatchRequest req_;
+  RecvTensorBatchResponse resp_;
+
+  mutable mutex mu_;
+  Status status_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorBatchCall);
+};
+
 void RpcRemoteRendezvous::RecvFromRemoteAsync(
     const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
     DoneCallback done) {
   CHECK(is_initialized());
+  if (RecvTensorBatchSize() > 1) {
+    RecvFromRemoteBatchedAsync(parsed, recv_args, std::move(done));
+  } else {
+    RecvFromRemoteSingleAsync(parsed, recv_args, std::move(done));
+  }
+}
+
+void RpcRemoteRendezvous::RecvFromRemoteBatchedAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
+  string src_worker;
+  string src_rel_device;
+  Status s;
+  if (!DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &src_rel_device)) {
+    s = errors::Internal(parsed.src_device,
+                         " is invalid remote source device.");
+  }
+  WorkerSession* sess = session();
+  Device* dst_device;
+  if (s.ok()) {
+    s = sess->device_mgr->LookupDevice(parsed.dst_device, &dst_device);
+  }
+  if (!s.ok()) {
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+
+  RpcRecvTensorBatchCall* full_batch = nullptr;
+  int64 new_batch_id = -1;
+  {
+    mutex_lock l(batch_mu_);
+    RpcRecvTensorBatchCall*& batch = pending_batches_[src_worker];
+    if (batch == nullptr) {
+      WorkerInterface* rwi = sess->worker_cache->CreateWorker(src_worker);
+      if (rwi == nullptr) {
+        pending_batches_.erase(src_worker);
+        s = errors::Internal("No worker known as ", src_worker);
+      } else {
+        new_batch_id = next_batch_id_++;
+        batch = new RpcRecvTensorBatchCall(new_batch_id, src_worker, rwi,
+                                           step_id_);
+      }
+    }
+    if (s.ok()) {
+      batch->Add(parsed, dst_device, recv_args, std::move(done));
+      if (batch->size() >= RecvTensorBatchSize()) {
+        full_batch = batch;
+        pending_batches_.erase(src_worker);
+      }
+    }
+  }
+  if (!s.ok()) {
+    done(s, Args(), recv_args, Tensor{}, false);
+    return;
+  }
+  if (full_batch != nullptr) {
+    StartBatch(full_batch);
+  } else if (new_batch_id >= 0) {
+    Ref();
+    env_->env->SchedClosureAfter(RecvTensorBatchWindowMicros(),
+                                 [this, src_worker, new_batch_id]() {
+                                   FlushBatch(src_worker, new_batch_id);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker,
+                                     int64 batch_id) {
+  RpcRecvTensorBatchCall* batch = nullptr;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    if (it == pending_batches_.end() || it->second->batch_id() != batch_id) {
+      // The batch filled up and was started already.
+      return;
+    }
+    batch = it->second;
+    pending_batches_.erase(it);
+  }
+  StartBatch(batch);
+}
+
+void RpcRemoteRendezvous::StartBatch(RpcRecvTensorBatchCall* batch) {
+  // Record "batch" in active_ so that it can be aborted cleanly.
+  RegisterCall(batch);
+
+  Ref();
+  batch->Start([this, batch]() {
+    DeregisterCall(batch);
+    Status s = batch->status();
+    if (errors::IsUnimplemented(s)) {
+      // The remote worker does not support batching.
+      for (int i = 0; i < batch->size(); ++i) {
+        const RpcRecvTensorBatchCall::Item& item = batch->item(i);
+        RecvFromRemoteSingleAsync(item.parsed, item.recv_args, item.done);
+      }
+    } else {
+      for (int i = 0; i < batch->size(); ++i) {
+        const RpcRecvTensorBatchCall::Item& item = batch->item(i);
+        Tensor tensor;
+        bool is_dead = false;
+        Status item_status = s;
+        if (item_status.ok()) {
+          item_status = batch->GetTensor(i, &tensor, &is_dead);
+        }
+        item.done(item_status, Args(), item.recv_args, tensor, is_dead);
+      }
+    }
+    session()->worker_cache->ReleaseWorker(batch->src_worker(), batch->wi());
+    delete batch;
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::RecvFromRemoteSingleAsync(
+    const Rendezvous::ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
   Status s;
 
   // Prepare a RecvTensor call that can handle being aborted.
@@ -236,8 +587,8 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
-  call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+  call->Init(rwi, step_id_, parsed.FullKey(), RecvTensorCodec(parsed),
+             recv_args.alloc_attrs, dst_device, recv_args, std::move(done));
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call);
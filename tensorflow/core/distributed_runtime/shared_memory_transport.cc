@@ -0,0 +1,189 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shared_memory_transport.h"
+
+#if !defined(PLATFORM_WINDOWS) && !defined(__ANDROID__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TF_HAS_SHARED_MEMORY_TRANSPORT 1
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <utility>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+#ifdef TF_HAS_SHARED_MEMORY_TRANSPORT
+
+namespace {
+
+// How long a shared memory object that is not received is kept.
+const int64 kUnreceivedSegmentMicros = 60 * 1000 * 1000;
+
+// A private mapping of a shared memory object: writes to the tensor, e.g.
+// by a kernel that forwards its input, do not reach the object.
+class SharedMemoryBuffer : public TensorBuffer {
+ public:
+  SharedMemoryBuffer(void* data, size_t size) : data_(data), size_(size) {}
+
+  ~SharedMemoryBuffer() override { munmap(data_, size_); }
+
+  void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("shared_memory");
+  }
+
+ private:
+  void* const data_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryBuffer);
+};
+
+// Remembers the objects created by this process, and unlinks those that
+// have not been received in time. Unlinking an object that the receiver
+// has already unlinked fails harmlessly.
+void TrackSegment(const string& name) {
+  static mutex* mu = new mutex;
+  static auto* segments = new std::deque<std::pair<int64, string>>;
+  const int64 now = Env::Default()->NowMicros();
+  mutex_lock l(*mu);
+  while (!segments->empty() && segments->front().first <= now) {
+    shm_unlink(segments->front().second.c_str());
+    segments->pop_front();
+  }
+  segments->emplace_back(now + kUnreceivedSegmentMicros, name);
+}
+
+}  // namespace
+
+const string& SharedMemoryHostId() {
+  static const string* id = [] {
+    string boot_id;
+    // Ignore errors: the host name alone is used where there is no boot id.
+    ReadFileToString(Env::Default(), "/proc/sys/kernel/random/boot_id",
+                     &boot_id)
+        .IgnoreError();
+    str_util::StripTrailingWhitespace(&boot_id);
+    return new string(strings::StrCat(port::Hostname(), "/", boot_id));
+  }();
+  return *id;
+}
+
+Status WriteTensorToSharedMemory(const Tensor& tensor,
+                                 SharedMemorySegment* segment) {
+  static std::atomic<int64> next_id(0);
+  const string name = strings::StrCat("/tf_tensor_", getpid(), "_",
+                                      next_id.fetch_add(1));
+  const StringPiece data = tensor.tensor_data();
+  if (data.empty()) {
+    return errors::InvalidArgument("Cannot send an empty tensor through ",
+                                   "shared memory");
+  }
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::Unavailable("shm_open(", name,
+                               ") failed: ", strerror(errno));
+  }
+  Status s;
+  void* addr = MAP_FAILED;
+  if (ftruncate(fd, data.size()) != 0) {
+    s = errors::ResourceExhausted("ftruncate(", name, ", ", data.size(),
+                                  ") failed: ", strerror(errno));
+  } else {
+    addr = mmap(nullptr, data.size(), PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      s = errors::ResourceExhausted("mmap(", name, ") failed: ",
+                                    strerror(errno));
+    }
+  }
+  close(fd);
+  if (!s.ok()) {
+    shm_unlink(name.c_str());
+    return s;
+  }
+  memcpy(addr, data.data(), data.size());
+  munmap(addr, data.size());
+  TrackSegment(name);
+  segment->set_name(name);
+  segment->set_size(data.size());
+  return Status::OK();
+}
+
+Status MapSharedMemory(const SharedMemorySegment& segment, int64 num_bytes,
+                       TensorBuffer** buf) {
+  if (num_bytes != segment.size() || num_bytes == 0) {
+    return errors::Internal("Shared memory object ", segment.name(), " has ",
+                            segment.size(), " bytes, expected ", num_bytes);
+  }
+  int fd = shm_open(segment.name().c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return errors::Internal(
+        "Cannot open shared memory object ", segment.name(), ": ",
+        strerror(errno), ". Do the sender and the receiver share /dev/shm?");
+  }
+  shm_unlink(segment.name().c_str());
+  struct stat st;
+  void* addr = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size == num_bytes) {
+    addr = mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                0);
+  }
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return errors::Internal("Cannot map shared memory object ",
+                            segment.name());
+  }
+  *buf = new SharedMemoryBuffer(addr, num_bytes);
+  return Status::OK();
+}
+
+#else  // TF_HAS_SHARED_MEMORY_TRANSPORT
+
+const string& SharedMemoryHostId() {
+  static const string* id = new string;
+  return *id;
+}
+
+Status WriteTensorToSharedMemory(const Tensor& tensor,
+                                 SharedMemorySegment* segment) {
+  return errors::Unimplemented("Shared memory is not supported");
+}
+
+Status MapSharedMemory(const SharedMemorySegment& segment, int64 num_bytes,
+                       TensorBuffer** buf) {
+  return errors::Unimplemented("Shared memory is not supported");
+}
+
+#endif  // TF_HAS_SHARED_MEMORY_TRANSPORT
+
+}  // namespace tensorflow
@@ -0,0 +1,55 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TRANSPORT_H_
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+// Transfers tensor contents between worker processes of one host through
+// POSIX shared memory objects, instead of serializing them into the RPC
+// response. The RPC still carries the metadata of the tensor and the name
+// of the object.
+
+namespace tensorflow {
+
+// Returns an id of the host that this process runs on, such that processes
+// with the same id can open each other's shared memory objects: the host
+// name and, on Linux, the boot id of the kernel. Returns "" if shared memory
+// objects are not supported on this platform.
+const string& SharedMemoryHostId();
+
+// Writes the content of "tensor", which must have a dtype that can be
+// memcpy-ed, into a new shared memory object and describes it in
+// "*segment".
+//
+// The receiver unlinks the object with MapSharedMemory(). The
+// objects that are never received, e.g. because the call was cancelled, are
+// unlinked a minute after their creation by a later call in this process.
+Status WriteTensorToSharedMemory(const Tensor& tensor,
+                                 SharedMemorySegment* segment);
+
+// Maps and unlinks the object of "segment", which must hold "num_bytes"
+// bytes, and sets "*buf" to a buffer over the mapping, on which the caller
+// owns a reference. The mapping is private: writes to the buffer, e.g. by a
+// kernel that forwards its input, do not reach the object.
+Status MapSharedMemory(const SharedMemorySegment& segment, int64 num_bytes,
+                       TensorBuffer** buf);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_TRANSPORT_H_
@@ -0,0 +1,58 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shared_memory_transport.h"
+
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(SharedMemoryTransportTest, WriteAndMap) {
+  ASSERT_FALSE(SharedMemoryHostId().empty());
+  Tensor tensor(DT_FLOAT, TensorShape({64, 32}));
+  test::FillIota<float>(&tensor, 1.0f);
+  SharedMemorySegment segment;
+  TF_ASSERT_OK(WriteTensorToSharedMemory(tensor, &segment));
+  EXPECT_EQ(tensor.TotalBytes(), segment.size());
+
+  TensorBuffer* buf = nullptr;
+  TF_ASSERT_OK(MapSharedMemory(segment, tensor.TotalBytes(), &buf));
+  ASSERT_EQ(tensor.TotalBytes(), buf->size());
+  EXPECT_EQ(0, memcmp(tensor.tensor_data().data(), buf->data(), buf->size()));
+  // The mapping is private.
+  static_cast<float*>(buf->data())[0] = -1.0f;
+  buf->Unref();
+
+  // The object was unlinked by the first mapping.
+  EXPECT_FALSE(MapSharedMemory(segment, tensor.TotalBytes(), &buf).ok());
+}
+
+TEST(SharedMemoryTransportTest, SizeMismatch) {
+  Tensor tensor = test::AsTensor<int32>({1, 2, 3});
+  SharedMemorySegment segment;
+  TF_ASSERT_OK(WriteTensorToSharedMemory(tensor, &segment));
+  TensorBuffer* buf = nullptr;
+  EXPECT_FALSE(MapSharedMemory(segment, 4, &buf).ok());
+  TF_ASSERT_OK(MapSharedMemory(segment, tensor.TotalBytes(), &buf));
+  buf->Unref();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,223 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
+
+#include <atomic>
+
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+
+namespace {
+
+std::atomic<int64> num_encoded_tensors(0);
+std::atomic<int64> raw_bytes(0);
+std::atomic<int64> encoded_bytes(0);
+
+// Byte shuffling groups the i-th bytes of all the elements together, which
+// makes runs of similar bytes (e.g. the exponents of floats, or the high
+// bytes of small integers) visible to the compressor.
+void ByteShuffle(const char* src, size_t num_elements, int element_size,
+                 char* dst) {
+  for (int j = 0; j < element_size; ++j) {
+    for (size_t i = 0; i < num_elements; ++i) {
+      dst[j * num_elements + i] = src[i * element_size + j];
+    }
+  }
+}
+
+void ByteUnshuffle(const char* src, size_t num_elements, int element_size,
+                   char* dst) {
+  for (int j = 0; j < element_size; ++j) {
+    for (size_t i = 0; i < num_elements; ++i) {
+      dst[i * element_size + j] = src[j * num_elements + i];
+    }
+  }
+}
+
+bool EncodeShuffleSnappy(const Tensor& val, TensorProto* proto) {
+  if (!DataTypeCanUseMemcpy(val.dtype())) return false;
+  StringPiece data = val.tensor_data();
+  if (data.empty()) return false;
+  const int element_size = DataTypeSize(val.dtype());
+  string shuffled;
+  if (element_size > 1) {
+    shuffled.resize(data.size());
+    ByteShuffle(data.data(), val.NumElements(), element_size, &shuffled[0]);
+    data = shuffled;
+  }
+  string compressed;
+  if (!port::Snappy_Compress(data.data(), data.size(), &compressed) ||
+      compressed.size() >= data.size()) {
+    return false;
+  }
+  proto->Clear();
+  proto->set_dtype(val.dtype());
+  val.shape().AsProto(proto->mutable_tensor_shape());
+  proto->set_tensor_content(compressed);
+  return true;
+}
+
+Status DecodeShuffleSnappy(const TensorProto& proto, Allocator* allocator,
+                           Tensor* tensor) {
+  if (!DataTypeCanUseMemcpy(proto.dtype()) ||
+      !TensorShape::IsValid(proto.tensor_shape())) {
+    return errors::InvalidArgument("Invalid shuffle_snappy tensor");
+  }
+  Tensor t(allocator, proto.dtype(), TensorShape(proto.tensor_shape()));
+  StringPiece buf = t.tensor_data();
+  char* dst = const_cast<char*>(buf.data());
+  const string& content = proto.tensor_content();
+  size_t length;
+  if (!port::Snappy_GetUncompressedLength(content.data(), content.size(),
+                                          &length) ||
+      length != buf.size()) {
+    return errors::DataLoss("Corrupted shuffle_snappy tensor content");
+  }
+  if (length > 0) {
+    const int element_size = DataTypeSize(proto.dtype());
+    if (element_size == 1) {
+      if (!port::Snappy_Uncompress(content.data(), content.size(), dst)) {
+        return errors::DataLoss("Corrupted shuffle_snappy tensor content");
+      }
+    } else {
+      string shuffled(length, '\0');
+      if (!port::Snappy_Uncompress(content.data(), content.size(),
+                                   &shuffled[0])) {
+        return errors::DataLoss("Corrupted shuffle_snappy tensor content");
+      }
+      ByteUnshuffle(shuffled.data(), t.NumElements(), element_size, dst);
+    }
+  }
+  *tensor = std::move(t);
+  return Status::OK();
+}
+
+// Sends DT_FLOAT tensors as "dtype", a 16-bit floating point type.
+bool EncodeFloat16(DataType dtype, const Tensor& val, TensorProto* proto) {
+  if (val.dtype() != DT_FLOAT || val.NumElements() == 0) return false;
+  Tensor converted(dtype, val.shape());
+  const float* src = val.flat<float>().data();
+  const int64 n = val.NumElements();
+  if (dtype == DT_BFLOAT16) {
+    FloatToBFloat16(src, converted.flat<bfloat16>().data(), n);
+  } else {
+    FloatToHalf(src, converted.flat<Eigen::half>().data(), n);
+  }
+  converted.AsProtoTensorContent(proto);
+  return true;
+}
+
+Status DecodeFloat16(DataType dtype, const TensorProto& proto,
+                     Allocator* allocator, Tensor* tensor) {
+  Tensor converted;
+  if (proto.dtype() != dtype || !converted.FromProto(proto)) {
+    return errors::InvalidArgument("Invalid ", DataTypeString(dtype),
+                                   " encoded tensor");
+  }
+  Tensor t(allocator, DT_FLOAT, converted.shape());
+  float* dst = t.flat<float>().data();
+  const int64 n = t.NumElements();
+  if (dtype == DT_BFLOAT16) {
+    BFloat16ToFloat(converted.flat<bfloat16>().data(), dst, n);
+  } else {
+    HalfToFloat(converted.flat<Eigen::half>().data(), dst, n);
+  }
+  *tensor = std::move(t);
+  return Status::OK();
+}
+
+}  // namespace
+
+bool ParseTensorCodec(StringPiece name, TensorCodec* codec) {
+  if (name == "none") {
+    *codec = TENSOR_CODEC_NONE;
+  } else if (name == "shuffle_snappy") {
+    *codec = TENSOR_CODEC_SHUFFLE_SNAPPY;
+  } else if (name == "bfloat16") {
+    *codec = TENSOR_CODEC_BFLOAT16;
+  } else if (name == "half") {
+    *codec = TENSOR_CODEC_HALF;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool EncodeTensorProto(TensorCodec codec, const Tensor& val,
+                       TensorProto* proto) {
+  TensorProto encoded;
+  bool ok = false;
+  switch (codec) {
+    case TENSOR_CODEC_SHUFFLE_SNAPPY:
+      ok = EncodeShuffleSnappy(val, &encoded);
+      break;
+    case TENSOR_CODEC_BFLOAT16:
+      ok = EncodeFloat16(DT_BFLOAT16, val, &encoded);
+      break;
+    case TENSOR_CODEC_HALF:
+      ok = EncodeFloat16(DT_HALF, val, &encoded);
+      break;
+    default:
+      break;
+  }
+  if (!ok) return false;
+  num_encoded_tensors.fetch_add(1, std::memory_order_relaxed);
+  raw_bytes.fetch_add(val.TotalBytes(), std::memory_order_relaxed);
+  encoded_bytes.fetch_add(encoded.tensor_content().size(),
+                          std::memory_order_relaxed);
+  proto->Swap(&encoded);
+  return true;
+}
+
+Status DecodeTensorProto(TensorCodec codec, const TensorProto& proto,
+                         Allocator* allocator, Tensor* tensor) {
+  switch (codec) {
+    case TENSOR_CODEC_NONE: {
+      Tensor t;
+      if (!t.FromProto(allocator, proto)) {
+        return errors::InvalidArgument("Cannot parse tensor from proto");
+      }
+      *tensor = std::move(t);
+      return Status::OK();
+    }
+    case TENSOR_CODEC_SHUFFLE_SNAPPY:
+      return DecodeShuffleSnappy(proto, allocator, tensor);
+    case TENSOR_CODEC_BFLOAT16:
+      return DecodeFloat16(DT_BFLOAT16, proto, allocator, tensor);
+    case TENSOR_CODEC_HALF:
+      return DecodeFloat16(DT_HALF, proto, allocator, tensor);
+    default:
+      return errors::Unimplemented("Unknown tensor codec ",
+                                   static_cast<int>(codec));
+  }
+}
+
+TensorCodecStats GetTensorCodecStats() {
+  TensorCodecStats stats;
+  stats.num_encoded_tensors =
+      num_encoded_tensors.load(std::memory_order_relaxed);
+  stats.raw_bytes = raw_bytes.load(std::memory_order_relaxed);
+  stats.encoded_bytes = encoded_bytes.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace tensorflow
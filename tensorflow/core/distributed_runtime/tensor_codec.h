@@ -0,0 +1,54 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODEC_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODEC_H_
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Sets "*codec" to the codec named "name" ("none", "shuffle_snappy",
+// "bfloat16" or "half"). Returns false if there is no such codec.
+bool ParseTensorCodec(StringPiece name, TensorCodec* codec);
+
+// Encodes "val" into "*proto" with "codec". Returns false, and leaves
+// "*proto" unchanged, if "codec" does not apply to the dtype of "val" or
+// would not make it smaller, in which case "val" should be sent as is.
+bool EncodeTensorProto(TensorCodec codec, const Tensor& val,
+                       TensorProto* proto);
+
+// Decodes "proto", which was encoded with "codec", into "*tensor", whose
+// memory is allocated by "allocator".
+Status DecodeTensorProto(TensorCodec codec, const TensorProto& proto,
+                         Allocator* allocator, Tensor* tensor);
+
+// Counters of the tensors that EncodeTensorProto() encoded in this process.
+struct TensorCodecStats {
+  int64 num_encoded_tensors = 0;
+  // The size of the tensor contents before and after encoding.
+  int64 raw_bytes = 0;
+  int64 encoded_bytes = 0;
+};
+TensorCodecStats GetTensorCodecStats();
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODEC_H_
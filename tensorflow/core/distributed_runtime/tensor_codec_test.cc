@@ -0,0 +1,112 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor RoundTrip(TensorCodec codec, const Tensor& val, bool expect_encoded) {
+  TensorProto proto;
+  EXPECT_EQ(expect_encoded, EncodeTensorProto(codec, val, &proto));
+  if (!expect_encoded) {
+    val.AsProtoTensorContent(&proto);
+    codec = TENSOR_CODEC_NONE;
+  }
+  Tensor result;
+  TF_EXPECT_OK(DecodeTensorProto(codec, proto, cpu_allocator(), &result));
+  return result;
+}
+
+TEST(TensorCodecTest, ParseTensorCodec) {
+  TensorCodec codec;
+  EXPECT_TRUE(ParseTensorCodec("shuffle_snappy", &codec));
+  EXPECT_EQ(TENSOR_CODEC_SHUFFLE_SNAPPY, codec);
+  EXPECT_TRUE(ParseTensorCodec("half", &codec));
+  EXPECT_EQ(TENSOR_CODEC_HALF, codec);
+  EXPECT_FALSE(ParseTensorCodec("lz4", &codec));
+}
+
+TEST(TensorCodecTest, ShuffleSnappy) {
+  string dummy;
+  if (!port::Snappy_Compress("abc", 3, &dummy)) {
+    LOG(INFO) << "Snappy is not available, skipping test.";
+    return;
+  }
+  // A sparse gradient compresses well.
+  Tensor sparse(DT_FLOAT, TensorShape({100, 100}));
+  test::FillFn<float>(&sparse,
+                      [](int i) -> float { return i % 37 == 0 ? i : 0.0f; });
+  const TensorCodecStats before = GetTensorCodecStats();
+  test::ExpectTensorEqual<float>(
+      sparse, RoundTrip(TENSOR_CODEC_SHUFFLE_SNAPPY, sparse, true));
+  const TensorCodecStats after = GetTensorCodecStats();
+  EXPECT_EQ(before.num_encoded_tensors + 1, after.num_encoded_tensors);
+  EXPECT_EQ(before.raw_bytes + sparse.TotalBytes(), after.raw_bytes);
+  EXPECT_LT(after.encoded_bytes - before.encoded_bytes, sparse.TotalBytes());
+
+  Tensor bytes(DT_UINT8, TensorShape({1000}));
+  test::FillFn<uint8>(&bytes, [](int i) -> uint8 { return i / 100; });
+  test::ExpectTensorEqual<uint8>(
+      bytes, RoundTrip(TENSOR_CODEC_SHUFFLE_SNAPPY, bytes, true));
+
+  // Strings and incompressible or empty tensors are sent as is.
+  Tensor strings = test::AsTensor<string>({"a", "b"});
+  RoundTrip(TENSOR_CODEC_SHUFFLE_SNAPPY, strings, false);
+  Tensor small = test::AsTensor<int32>({1, 2});
+  RoundTrip(TENSOR_CODEC_SHUFFLE_SNAPPY, small, false);
+  Tensor empty(DT_FLOAT, TensorShape({0, 3}));
+  RoundTrip(TENSOR_CODEC_SHUFFLE_SNAPPY, empty, false);
+}
+
+TEST(TensorCodecTest, Float16) {
+  Tensor val = test::AsTensor<float>({1.0f, -2.5f, 0.1f, 65504.0f},
+                                     TensorShape({2, 2}));
+  for (TensorCodec codec : {TENSOR_CODEC_BFLOAT16, TENSOR_CODEC_HALF}) {
+    TensorProto proto;
+    ASSERT_TRUE(EncodeTensorProto(codec, val, &proto));
+    EXPECT_EQ(4 * 2, proto.tensor_content().size());
+    Tensor result;
+    TF_ASSERT_OK(DecodeTensorProto(codec, proto, cpu_allocator(), &result));
+    test::ExpectTensorNear<float>(val, result, 0.01 * 65504.0f);
+    EXPECT_EQ(1.0f, result.flat<float>()(0));
+    EXPECT_EQ(-2.5f, result.flat<float>()(1));
+  }
+  // Only DT_FLOAT is downcast.
+  RoundTrip(TENSOR_CODEC_BFLOAT16, test::AsTensor<double>({1.0}), false);
+}
+
+TEST(TensorCodecTest, Corrupted) {
+  TensorProto proto;
+  proto.set_dtype(DT_FLOAT);
+  proto.mutable_tensor_shape()->add_dim()->set_size(4);
+  proto.set_tensor_content("garbage");
+  Tensor result;
+  EXPECT_FALSE(DecodeTensorProto(TENSOR_CODEC_SHUFFLE_SNAPPY, proto,
+                                 cpu_allocator(), &result)
+                   .ok());
+  EXPECT_FALSE(
+      DecodeTensorProto(TENSOR_CODEC_HALF, proto, cpu_allocator(), &result)
+          .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -18,19 +18,30 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/shared_memory_transport.h"
+#include "tensorflow/core/distributed_runtime/tensor_codec.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 
 TensorResponse::Source::~Source() {}
 
+TensorBuffer* TensorResponse::Source::AliasContents(int64 offset,
+                                                    int64 num_bytes) {
+  return nullptr;
+}
+
 void TensorResponse::Clear() {
   on_host_ = false;
+  allow_aliasing_ = false;
+  stage_on_host_ = false;
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
   already_used_ = false;
+  parse_micros_ = 0;
   ClearTensor();
 }
 
@@ -47,19 +58,14 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
   if (alloc_attrs_.on_host() || da.device_type() == "CPU") {
     on_host_ = true;
   }
+  allow_aliasing_ = on_host_ && !alloc_attrs_.gpu_compatible() &&
+                    !alloc_attrs_.nic_compatible();
   allocator_ = device_->GetAllocator(alloc_attrs_);
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
-  Status s;
   meta_.Swap(response);
-  if (on_host_) {
-    if (!tensor_.FromProto(allocator_, meta_.tensor())) {
-      s = errors::InvalidArgument("Cannot parse tensor from response");
-    }
-  } else {
-    s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
-  }
+  Status s = TensorFromMeta();
   {
     TensorProto empty;
     meta_.mutable_tensor()->Swap(&empty);
@@ -79,7 +85,19 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response) {
 }
 
 Status TensorResponse::ParseFrom(Source* source) {
+  const int64 start_micros = Env::Default()->NowMicros();
+  Status s = DoParseFrom(source);
+  parse_micros_ = Env::Default()->NowMicros() - start_micros;
+  return s;
+}
+
+Status TensorResponse::DoParseFrom(Source* source) {
   if (!on_host_) {
+    Status staged;
+    if (stage_on_host_ && ParseStagedOnHost(source, &staged)) {
+      if (staged.code() != error::UNIMPLEMENTED) return staged;
+    }
+    meta_.Clear();
     protobuf::io::CodedInputStream input(source->contents());
     input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
 
@@ -87,8 +105,7 @@ Status TensorResponse::ParseFrom(Source* source) {
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
-    Status s =
-        device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    Status s = TensorFromMeta();
     // Reduce memory usage for big tensors.
     {
       TensorProto empty;
@@ -101,7 +118,10 @@ Status TensorResponse::ParseFrom(Source* source) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return Status::OK();
+  if (ParseFast(source, allocator_, allow_aliasing_)) {
+    if (meta_.has_shared_memory()) return TensorFromSharedMemory();
+    return Status::OK();
+  }
   meta_.Clear();
   if (ParseSlow(source)) return Status::OK();
   return errors::InvalidArgument("Cannot parse tensor from response");
@@ -143,8 +163,93 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+Status TensorResponse::TensorFromMeta() {
+  if (meta_.has_shared_memory()) return TensorFromSharedMemory();
+  const TensorCodec codec = meta_.codec();
+  if (on_host_) {
+    return DecodeTensorProto(codec, meta_.tensor(), allocator_, &tensor_);
+  }
+  if (codec == TENSOR_CODEC_NONE) {
+    return device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_,
+                                        &tensor_);
+  }
+  // Decode on the host, then copy to the device.
+  AllocatorAttributes host_attrs;
+  host_attrs.set_on_host(true);
+  host_attrs.set_gpu_compatible(true);
+  Tensor host_tensor;
+  TF_RETURN_IF_ERROR(DecodeTensorProto(codec, meta_.tensor(),
+                                       device_->GetAllocator(host_attrs),
+                                       &host_tensor));
+  Status s =
+      device_->MakeTensorFromHostTensor(host_tensor, alloc_attrs_, &tensor_);
+  if (s.code() != error::UNIMPLEMENTED) return s;
+  TensorProto proto;
+  host_tensor.AsProtoTensorContent(&proto);
+  return device_->MakeTensorFromProto(proto, alloc_attrs_, &tensor_);
+}
+
+Status TensorResponse::TensorFromSharedMemory() {
+  const DataType dtype = meta_.tensor().dtype();
+  if (!DataTypeCanUseMemcpy(dtype)) {
+    return errors::Internal("Cannot receive a ", DataTypeString(dtype),
+                            " tensor through shared memory");
+  }
+  TensorShape shape(meta_.tensor().tensor_shape());
+  TensorBuffer* buf = nullptr;
+  TF_RETURN_IF_ERROR(MapSharedMemory(
+      meta_.shared_memory(), shape.num_elements() * DataTypeSize(dtype),
+      &buf));
+  Tensor mapped(dtype, shape, buf);
+  buf->Unref();
+  if (on_host_ && allow_aliasing_) {
+    tensor_ = std::move(mapped);
+    return Status::OK();
+  }
+  if (on_host_) {
+    Tensor t(allocator_, dtype, shape);
+    memcpy(const_cast<char*>(t.tensor_data().data()),
+           mapped.tensor_data().data(), mapped.TotalBytes());
+    tensor_ = std::move(t);
+    return Status::OK();
+  }
+  return device_->MakeTensorFromHostTensor(mapped, alloc_attrs_, &tensor_);
+}
+
+bool TensorResponse::ParseStagedOnHost(Source* source, Status* status) {
+  ClearTensor();
+  AllocatorAttributes host_attrs;
+  host_attrs.set_on_host(true);
+  host_attrs.set_gpu_compatible(true);
+  if (!ParseFast(source, device_->GetAllocator(host_attrs), false)) {
+    return false;
+  }
+  Tensor host_tensor = std::move(tensor_);
+  *status = device_->MakeTensorFromHostTensor(host_tensor, alloc_attrs_,
+                                              &tensor_);
+  return true;
+}
+
+bool TensorResponse::AliasTensor(Source* source, int64 offset, int num_bytes,
+                                 DataType dtype, const TensorShape& shape,
+                                 Tensor* tensor) {
+  if (num_bytes == 0 ||
+      shape.num_elements() * DataTypeSize(dtype) != num_bytes) {
+    return false;
+  }
+  TensorBuffer* buf = source->AliasContents(offset, num_bytes);
+  if (buf == nullptr) return false;
+  Tensor t(dtype, shape, buf);
+  buf->Unref();
+  // Kernels assume that tensors are aligned.
+  if (!t.IsAligned()) return false;
+  *tensor = std::move(t);
+  return true;
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta,
+    Allocator* allocator, Source* alias_source) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -155,7 +260,7 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
       }
       return ok;
@@ -195,12 +300,18 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        // Avoid copying the content if the source can share it.
+        Tensor aliased;
+        if (alias_source != nullptr &&
+            AliasTensor(alias_source, input->CurrentPosition(), num_bytes,
+                        tensor_meta->dtype(), shape, &aliased)) {
+          if (!input->Skip(num_bytes)) return false;
+          tensor_ = std::move(aliased);
+          break;
+        }
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -215,7 +326,8 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
-bool TensorResponse::ParseFast(Source* source) {
+bool TensorResponse::ParseFast(Source* source, Allocator* allocator,
+                               bool alias) {
   protobuf::io::CodedInputStream input(source->contents());
   input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
   while (true) {
@@ -234,7 +346,8 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(&input, meta_.mutable_tensor(), allocator,
+                                   alias ? source : nullptr)) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -260,6 +373,18 @@ bool TensorResponse::ParseFast(Source* source) {
           return false;
         break;
       }
+      case RecvTensorResponse::kTimingsFieldNumber: {
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadNestedMessage(&input, meta_.mutable_timings()))
+          return false;
+        break;
+      }
+      case RecvTensorResponse::kSharedMemoryFieldNumber: {
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadNestedMessage(&input, meta_.mutable_shared_memory()))
+          return false;
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -275,11 +400,9 @@ bool TensorResponse::ParseSlow(Source* source) {
     return false;
   }
 
-  Tensor parsed(meta_.tensor().dtype());
-  if (!parsed.FromProto(allocator_, meta_.tensor())) {
+  if (!TensorFromMeta().ok()) {
     return false;
   }
-  tensor_ = std::move(parsed);
 
   // Reduce memory usage for big tensors.
   {
@@ -44,8 +44,20 @@ class TensorResponse {
   void ClearTensor();
 
   // Initialize memory allocation related members.
+  //
+  // If the destination is in host memory that need not be gpu- or
+  // nic-compatible, ParseFrom() makes the tensor alias the received bytes
+  // when the Source allows it and they are suitably aligned, instead of
+  // copying them.
   void InitAlloc(DeviceBase* d, const AllocatorAttributes& aa);
 
+  // If true, ParseFrom() parses the contents of tensors destined to device
+  // memory directly into a buffer from the device's gpu-compatible host
+  // allocator and copies it with DeviceBase::MakeTensorFromHostTensor(),
+  // instead of parsing a TensorProto first. Must be called after
+  // InitAlloc().
+  void set_stage_on_host(bool stage_on_host) { stage_on_host_ = stage_on_host; }
+
   // Source provides a way for a particular RPC implementation to provide
   // received data to ParseFrom.
   class Source {
@@ -64,6 +76,13 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer that aliases the "num_bytes" bytes of the data
+    // yielded by contents() that start "offset" bytes from its beginning
+    // and keeps them alive, or nullptr if the source cannot share them
+    // (e.g. because they are not contiguous in memory). The caller owns
+    // the returned reference. The default implementation returns nullptr.
+    virtual TensorBuffer* AliasContents(int64 offset, int64 num_bytes);
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -87,17 +106,39 @@ class TensorResponse {
   // modified.
   const RecvTensorResponse& metadata() const { return meta_; }
 
+  // Returns how long the last call to ParseFrom() took, in microseconds.
+  int64 parse_micros() const { return parse_micros_; }
+
  private:
+  Status DoParseFrom(Source* source);
+  // "allocator" allocates the tensor. If "alias_source" is not null, the
+  // tensor aliases its contents when possible.
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
-                             TensorProto* tensor_meta);
-  bool ParseFast(Source* source);
+                             TensorProto* tensor_meta, Allocator* allocator,
+                             Source* alias_source);
+  bool ParseFast(Source* source, Allocator* allocator, bool alias);
   bool ParseSlow(Source* source);
+  // Parses into a host tensor and copies it to the device. Returns false if
+  // the fast path does not apply, and sets *status otherwise.
+  bool ParseStagedOnHost(Source* source, Status* status);
+  // Sets tensor_ from meta_.tensor(), decoding it with meta_.codec().
+  Status TensorFromMeta();
+  // Sets tensor_ from meta_.shared_memory(), aliasing the mapping of the
+  // shared memory object when allowed.
+  Status TensorFromSharedMemory();
+  // Returns true and sets *tensor to a tensor of "dtype" and "shape" that
+  // aliases "num_bytes" bytes of "source" at "offset" if that is possible.
+  bool AliasTensor(Source* source, int64 offset, int num_bytes,
+                   DataType dtype, const TensorShape& shape, Tensor* tensor);
 
   bool on_host_ = false;
+  bool allow_aliasing_ = false;
+  bool stage_on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
   bool already_used_ = false;
+  int64 parse_micros_ = 0;
   Tensor tensor_;
   RecvTensorResponse meta_;
 };
@@ -19,9 +19,11 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -78,6 +80,8 @@ class TensorResponseTest : public ::testing::Test {
     RecvTensorResponse proto;
     proto.set_is_dead(is_dead);
     proto.set_send_start_micros(123456);
+    proto.mutable_timings()->set_enqueue_micros(12);
+    proto.mutable_timings()->set_rendezvous_wait_micros(34);
     if (use_tensor_content) {
       src.AsProtoTensorContent(proto.mutable_tensor());
     } else {
@@ -98,6 +102,9 @@ class TensorResponseTest : public ::testing::Test {
       const RecvTensorResponse& meta = response.metadata();
       EXPECT_EQ(meta.is_dead(), is_dead);
       EXPECT_EQ(meta.send_start_micros(), 123456);
+      EXPECT_EQ(meta.timings().enqueue_micros(), 12);
+      EXPECT_EQ(meta.timings().rendezvous_wait_micros(), 34);
+      EXPECT_GE(response.parse_micros(), 0);
 
       const Tensor& result = response.tensor();
       EXPECT_EQ(result.dtype(), src.dtype());
@@ -156,6 +163,79 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A TensorBuffer over memory that it does not own.
+class ExternalBuffer : public TensorBuffer {
+ public:
+  ExternalBuffer(char* data, size_t size) : data_(data), size_(size) {}
+
+  void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  char* const data_;
+  const size_t size_;
+};
+
+// A Source over an array whose contents can be aliased.
+class AliasingSource : public TensorResponse::Source {
+ public:
+  AliasingSource(char* data, int size) : data_(data), size_(size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_.reset(new protobuf::io::ArrayInputStream(data_, size_, 16));
+    return stream_.get();
+  }
+
+  TensorBuffer* AliasContents(int64 offset, int64 num_bytes) override {
+    if (offset + num_bytes > size_) return nullptr;
+    return new ExternalBuffer(data_ + offset, num_bytes);
+  }
+
+ private:
+  char* const data_;
+  const int size_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+};
+
+TEST_F(TensorResponseTest, AliasContents) {
+  Tensor src(DT_FLOAT, TensorShape({4, 8}));
+  test::FillFn<float>(&src, [](int i) -> float { return i + 0.5f; });
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  const size_t content_offset = encoded.find(src.tensor_data().ToString());
+  ASSERT_NE(string::npos, content_offset);
+
+  const size_t kAlign = EIGEN_MAX_ALIGN_BYTES;
+  char* storage = static_cast<char*>(
+      port::AlignedMalloc(encoded.size() + 2 * kAlign, kAlign));
+  // Place the encoded response so that the tensor content is aligned.
+  char* aligned = storage + kAlign - content_offset % kAlign;
+  DummyDevice cpu_device(Env::Default());
+  for (int misalign = 0; misalign < 2; ++misalign) {
+    for (bool gpu_compatible : {false, true}) {
+      char* data = aligned + misalign;
+      memcpy(data, encoded.data(), encoded.size());
+      AliasingSource source(data, encoded.size());
+      TensorResponse response;
+      AllocatorAttributes attr;
+      attr.set_gpu_compatible(gpu_compatible);
+      response.InitAlloc(&cpu_device, attr);
+      TF_ASSERT_OK(response.ParseFrom(&source));
+      test::ExpectTensorEqual<float>(src, response.tensor());
+      const bool aliased =
+          response.tensor().tensor_data().data() == data + content_offset;
+      EXPECT_EQ(misalign == 0 && !gpu_compatible, aliased);
+    }
+  }
+  port::AlignedFree(storage);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -92,6 +92,31 @@ void WorkerCacheLogger::RecordRecvTensor(int64 step_id, int64 start_usecs,
                      dst_device, bytes, "", "RecvTensor");
 }
 
+void WorkerCacheLogger::RecordRecvTensor(int64 step_id, int64 start_usecs,
+                                         int64 end_usecs,
+                                         const string& tensor_name,
+                                         const string& src_device,
+                                         const string& dst_device, int64 bytes,
+                                         const TransferTimings& timings) {
+  const int64 elapsed = end_usecs - start_usecs;
+  const int64 op_start_rel = std::min(
+      elapsed, timings.enqueue_usecs + timings.rendezvous_wait_usecs);
+  const int64 op_end_rel =
+      std::max(op_start_rel, elapsed - timings.deserialize_usecs);
+  auto byte_string = strings::StrCat("[", bytes, "B] ");
+  if (bytes >= 0.1 * 1048576.0) {
+    byte_string = strings::Printf("[%.1fMB] ", bytes / 1048576.0);
+  }
+  const string details = strings::StrCat(
+      byte_string, tensor_name, " from ", src_device, " to ", dst_device,
+      " (enqueue ", timings.enqueue_usecs, "us, wait ",
+      timings.rendezvous_wait_usecs, "us, wire ", timings.wire_usecs,
+      "us, deserialize ", timings.deserialize_usecs, "us)");
+  RecordTransfer(step_id, start_usecs, end_usecs, op_start_rel, op_end_rel,
+                 tensor_name, src_device, dst_device, bytes, details,
+                 "RecvTensor");
+}
+
 void WorkerCacheLogger::RecordDataTransfer(int64 step_id, int64 start_usecs,
                                            int64 end_usecs,
                                            const string& tensor_name,
@@ -100,6 +125,16 @@ void WorkerCacheLogger::RecordDataTransfer(int64 step_id, int64 start_usecs,
                                            int64 bytes,
                                            const string& details,
                                            const string& transfer_method_name){
+  RecordTransfer(step_id, start_usecs, end_usecs, 0, end_usecs - start_usecs,
+                 tensor_name, src_device, dst_device, bytes, details,
+                 transfer_method_name);
+}
+
+void WorkerCacheLogger::RecordTransfer(
+    int64 step_id, int64 start_usecs, int64 end_usecs, int64 op_start_rel,
+    int64 op_end_rel, const string& tensor_name, const string& src_device,
+    const string& dst_device, int64 bytes, const string& details,
+    const string& transfer_method_name) {
   NodeExecStats* ns = new NodeExecStats;
   ns->set_node_name(transfer_method_name);
   if (details.empty()) {
@@ -115,10 +150,9 @@ void WorkerCacheLogger::RecordDataTransfer(int64 step_id, int64 start_usecs,
   }
 
   ns->set_all_start_micros(start_usecs);
-  ns->set_op_start_rel_micros(0);
-  int64 elapsed = end_usecs - start_usecs;
-  ns->set_op_end_rel_micros(elapsed);
-  ns->set_all_end_rel_micros(elapsed);
+  ns->set_op_start_rel_micros(op_start_rel);
+  ns->set_op_end_rel_micros(op_end_rel);
+  ns->set_all_end_rel_micros(end_usecs - start_usecs);
   NodeOutput* no = ns->add_output();
   no->set_slot(0);
   // TODO(tucker): Maybe set the dimensions too, but then they'll
@@ -129,4 +163,36 @@ void WorkerCacheLogger::RecordDataTransfer(int64 step_id, int64 start_usecs,
   Save(dst_device, step_id, ns);
 }
 
+void WorkerCacheLogger::PeerCounters::Record(int64 num_bytes,
+                                             int64 num_usecs) {
+  num_transfers.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+  usecs.fetch_add(num_usecs, std::memory_order_relaxed);
+  int64 max = max_usecs.load(std::memory_order_relaxed);
+  while (num_usecs > max &&
+         !max_usecs.compare_exchange_weak(max, num_usecs,
+                                          std::memory_order_relaxed)) {
+  }
+}
+
+WorkerCacheLogger::PeerCounters* WorkerCacheLogger::GetPeerCounters(
+    const string& peer) {
+  mutex_lock l(peer_mu_);
+  std::unique_ptr<PeerCounters>& counters = peer_counters_[peer];
+  if (!counters) counters.reset(new PeerCounters);
+  return counters.get();
+}
+
+void WorkerCacheLogger::GetPeerStats(std::map<string, PeerStats>* stats) {
+  stats->clear();
+  mutex_lock l(peer_mu_);
+  for (const auto& it : peer_counters_) {
+    PeerStats* s = &(*stats)[it.first];
+    s->num_transfers = it.second->num_transfers.load();
+    s->bytes = it.second->bytes.load();
+    s->usecs = it.second->usecs.load();
+    s->max_usecs = it.second->max_usecs.load();
+  }
+}
+
 }  // namespace tensorflow
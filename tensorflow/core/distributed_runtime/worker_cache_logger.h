@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_CACHE_LOGGER_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_CACHE_LOGGER_H_
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -60,6 +63,24 @@ class WorkerCacheLogger {
                         const string& tensor_name, const string& src_device,
                         const string& dst_device, int64 bytes);
 
+  // Where the time of one RecvTensor went, as far as it can be told from
+  // the timings reported by the sender. "wire_usecs" is whatever is left
+  // of the call, i.e. the network and the RPC layers.
+  struct TransferTimings {
+    int64 enqueue_usecs = 0;
+    int64 rendezvous_wait_usecs = 0;
+    int64 wire_usecs = 0;
+    int64 deserialize_usecs = 0;
+  };
+
+  // Like above, but the record also breaks the transfer down into
+  // "timings": the op starts once the sender has the tensor and ends
+  // before it is deserialized, and the label lists every phase.
+  void RecordRecvTensor(int64 step_id, int64 start_usecs, int64 end_usecs,
+                        const string& tensor_name, const string& src_device,
+                        const string& dst_device, int64 bytes,
+                        const TransferTimings& timings);
+
   // Generates a NodeExecStats record with the given data, and saves for
   // later retrieval by RetrieveLogs().
   void RecordDataTransfer(int64 step_id, int64 start_usecs, int64 end_usecs,
@@ -68,6 +89,36 @@ class WorkerCacheLogger {
                           const string& details,
                           const string& transfer_method_name);
 
+  // Always-on counters of the tensors received from one peer, whether or
+  // not logging is active. Bandwidth is bytes / usecs, latency is
+  // usecs / num_transfers.
+  struct PeerCounters {
+    std::atomic<int64> num_transfers{0};
+    std::atomic<int64> bytes{0};
+    std::atomic<int64> usecs{0};
+    std::atomic<int64> max_usecs{0};
+
+    // Accounts for one transfer of "bytes" bytes that took "usecs".
+    void Record(int64 bytes, int64 usecs);
+  };
+
+  // A snapshot of a PeerCounters.
+  struct PeerStats {
+    int64 num_transfers = 0;
+    int64 bytes = 0;
+    int64 usecs = 0;
+    int64 max_usecs = 0;
+  };
+
+  // Returns the counters for "peer", e.g. "/job:worker/replica:0/task:1".
+  // The returned pointer is owned by this logger and stays valid for its
+  // lifetime, so callers can look it up once and record into it without
+  // locking.
+  PeerCounters* GetPeerCounters(const string& peer);
+
+  // Fills "*stats" with a snapshot of the counters of every peer.
+  void GetPeerStats(std::map<string, PeerStats>* stats);
+
  private:
   mutex count_mu_;
   int32 want_logging_count_ GUARDED_BY(count_mu_) = 0;
@@ -80,10 +131,23 @@ class WorkerCacheLogger {
   mutex mu_;
   LogMap log_map_ GUARDED_BY(mu_);
 
+  // Shared by RecordRecvTensor() and RecordDataTransfer(). "op_start_rel"
+  // and "op_end_rel" are relative to "start_usecs".
+  void RecordTransfer(int64 step_id, int64 start_usecs, int64 end_usecs,
+                      int64 op_start_rel, int64 op_end_rel,
+                      const string& tensor_name, const string& src_device,
+                      const string& dst_device, int64 bytes,
+                      const string& details,
+                      const string& transfer_method_name);
+
   // Records "ns" in log_map_ under the given device and step.
   void Save(const string& device, int64 step_id, NodeExecStats* ns);
 
   void ClearLogsWithLock() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutex peer_mu_;
+  std::unordered_map<string, std::unique_ptr<PeerCounters>> peer_counters_
+      GUARDED_BY(peer_mu_);
 };
 }  // namespace tensorflow
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_WORKER_CACHE_LOGGER_H_
@@ -31,6 +31,11 @@ void AllocatorStats::Clear() {
   this->max_bytes_in_use = 0;
   this->max_alloc_size = 0;
   this->bytes_limit = 0;
+  this->bytes_reserved = 0;
+  this->num_chunk_splits = 0;
+  this->num_chunk_merges = 0;
+  this->num_region_extensions = 0;
+  this->fragmentation_at_peak = 0;
 }
 
 string AllocatorStats::DebugString() const {
@@ -39,9 +44,16 @@ string AllocatorStats::DebugString() const {
       "InUse:        %20lld\n"
       "MaxInUse:     %20lld\n"
       "NumAllocs:    %20lld\n"
-      "MaxAllocSize: %20lld\n",
+      "MaxAllocSize: %20lld\n"
+      "Reserved:     %20lld\n"
+      "Splits:       %20lld\n"
+      "Merges:       %20lld\n"
+      "Extensions:   %20lld\n"
+      "FragAtPeak:   %20.4f\n",
       this->bytes_limit, this->bytes_in_use, this->max_bytes_in_use,
-      this->num_allocs, this->max_alloc_size);
+      this->num_allocs, this->max_alloc_size, this->bytes_reserved,
+      this->num_chunk_splits, this->num_chunk_merges,
+      this->num_region_extensions, this->fragmentation_at_peak);
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -64,6 +76,7 @@ static bool cpu_allocator_collect_full_stats = false;
 void EnableCPUAllocatorStats(bool enable) {
   cpu_allocator_collect_stats = enable;
 }
+bool CPUAllocatorStatsEnabled() { return cpu_allocator_collect_stats; }
 void EnableCPUAllocatorFullStats(bool enable) {
   cpu_allocator_collect_full_stats = enable;
 }
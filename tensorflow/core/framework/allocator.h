@@ -29,6 +29,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class AllocatorTimeline;
+
 // Attributes for a single allocation call. Different calls to the same
 // allocator could potentially have different allocation attributes.
 struct AllocationAttributes {
@@ -57,6 +59,16 @@ struct AllocatorStats {
   // unknown.
   int64 bytes_limit;
 
+  // Allocators that carve chunks out of larger regions of memory (e.g.
+  // the BFC allocator) also report the following.
+  int64 bytes_reserved;         // Bytes of regions held by the allocator.
+  int64 num_chunk_splits;       // Number of times a chunk was split.
+  int64 num_chunk_merges;       // Number of times two chunks were merged.
+  int64 num_region_extensions;  // Number of regions reserved.
+  // The fraction of the free reserved memory that did not fit in the
+  // largest free chunk when bytes_in_use last reached max_bytes_in_use.
+  double fragmentation_at_peak;
+
   AllocatorStats() { Clear(); }
 
   void Clear();
@@ -198,6 +210,15 @@ class Allocator {
   // Fills in 'stats' with statistics collected by this allocator.
   virtual void GetStats(AllocatorStats* stats) { stats->Clear(); }
 
+  // Allocators that can record a timeline of their events override the
+  // following. StartTimeline() turns recording on, if it was not already,
+  // and returns a cursor that must be passed to exactly one later call of
+  // StopTimeline(), which fills in 'timeline' with the events recorded
+  // since and turns recording off once no cursor is outstanding. Returns
+  // -1, and StopTimeline() does nothing, if timelines are not supported.
+  virtual int64 StartTimeline() { return -1; }
+  virtual void StopTimeline(int64 cursor, AllocatorTimeline* timeline) {}
+
  private:
   // No constructors or destructors are run for simple types
   template <typename T>
@@ -376,6 +397,9 @@ Allocator* cpu_allocator();
 // AllocatorStats. By default, it's disabled.
 void EnableCPUAllocatorStats(bool enable);
 
+// Returns true if the process-wide cpu allocator collects AllocatorStats.
+bool CPUAllocatorStatsEnabled();
+
 // If 'enable' is true, the process-wide cpu allocator collects full
 // statistics. By default, it's disabled.
 void EnableCPUAllocatorFullStats(bool enable);
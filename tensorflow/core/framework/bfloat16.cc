@@ -15,8 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bfloat16.h"
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace tensorflow {
 
+// The bulk conversions below handle as many elements as possible with the
+// widest vector instructions the compiler targets, and the remainder one
+// element at a time. They give exactly the same results as the scalar loops.
+
 void FloatToBFloat16(const float* src, bfloat16* dst, int64 size) {
   const uint16_t* p = reinterpret_cast<const uint16_t*>(src);
   uint16_t* q = reinterpret_cast<uint16_t*>(dst);
@@ -25,6 +35,41 @@ void FloatToBFloat16(const float* src, bfloat16* dst, int64 size) {
       *q = p[0];
     }
 #else
+#if defined(__AVX512F__)
+    for (; size >= 16; p += 32, q += 16, size -= 16) {
+      const __m512i x = _mm512_srli_epi32(
+          _mm512_loadu_si512(reinterpret_cast<const void*>(p)), 16);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(q),
+                          _mm512_cvtepi32_epi16(x));
+    }
+#elif defined(__AVX2__)
+    for (; size >= 16; p += 32, q += 16, size -= 16) {
+      // The arithmetic shift keeps every value in the int16 range, so the
+      // saturating pack just drops the low halves. The pack interleaves the
+      // 128-bit lanes of its operands, which the permute undoes.
+      const __m256i lo = _mm256_srai_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), 16);
+      const __m256i hi = _mm256_srai_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 16)), 16);
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(q),
+          _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8));
+    }
+#elif defined(__SSE2__)
+    for (; size >= 8; p += 16, q += 8, size -= 8) {
+      const __m128i lo = _mm_srai_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), 16);
+      const __m128i hi = _mm_srai_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8)), 16);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(q), _mm_packs_epi32(lo, hi));
+    }
+#elif defined(__ARM_NEON)
+    for (; size >= 8; p += 16, q += 8, size -= 8) {
+      const uint32x4_t lo = vreinterpretq_u32_u16(vld1q_u16(p));
+      const uint32x4_t hi = vreinterpretq_u32_u16(vld1q_u16(p + 8));
+      vst1q_u16(q, vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)));
+    }
+#endif
     for (; size != 0; p += 2, q++, size--) {
      *q = p[1];
     }
@@ -40,6 +85,35 @@ void BFloat16ToFloat(const bfloat16* src, float* dst, int64 size) {
       q[1] = 0;
     }
 #else
+#if defined(__AVX512F__)
+    for (; size >= 16; p += 16, q += 32, size -= 16) {
+      const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+      _mm512_storeu_si512(reinterpret_cast<void*>(q),
+                          _mm512_slli_epi32(_mm512_cvtepu16_epi32(x), 16));
+    }
+#elif defined(__AVX2__)
+    for (; size >= 8; p += 8, q += 16, size -= 8) {
+      const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(q),
+                          _mm256_slli_epi32(_mm256_cvtepu16_epi32(x), 16));
+    }
+#elif defined(__SSE2__)
+    for (; size >= 8; p += 8, q += 16, size -= 8) {
+      const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i zero = _mm_setzero_si128();
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(q),
+                       _mm_unpacklo_epi16(zero, x));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(q + 8),
+                       _mm_unpackhi_epi16(zero, x));
+    }
+#elif defined(__ARM_NEON)
+    for (; size >= 8; p += 8, q += 16, size -= 8) {
+      const uint16x8_t x = vld1q_u16(p);
+      vst1q_u16(q, vreinterpretq_u16_u32(vshll_n_u16(vget_low_u16(x), 16)));
+      vst1q_u16(q + 8,
+                vreinterpretq_u16_u32(vshll_n_u16(vget_high_u16(x), 16)));
+    }
+#endif
     for (; size != 0; p++, q += 2, size--) {
       q[0] = 0;
       q[1] = *p;
@@ -47,4 +121,38 @@ void BFloat16ToFloat(const bfloat16* src, float* dst, int64 size) {
 #endif
 }
 
+void FloatToHalf(const float* src, Eigen::half* dst, int64 size) {
+#if defined(__F16C__)
+  for (; size >= 8; src += 8, dst += 8, size -= 8) {
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(dst),
+        _mm256_cvtps_ph(_mm256_loadu_ps(src), _MM_FROUND_TO_NEAREST_INT));
+  }
+#elif defined(__aarch64__)
+  for (; size >= 4; src += 4, dst += 4, size -= 4) {
+    vst1_f16(reinterpret_cast<float16_t*>(dst), vcvt_f16_f32(vld1q_f32(src)));
+  }
+#endif
+  for (; size != 0; src++, dst++, size--) {
+    *dst = Eigen::half(*src);
+  }
+}
+
+void HalfToFloat(const Eigen::half* src, float* dst, int64 size) {
+#if defined(__F16C__)
+  for (; size >= 8; src += 8, dst += 8, size -= 8) {
+    _mm256_storeu_ps(dst, _mm256_cvtph_ps(_mm_loadu_si128(
+                              reinterpret_cast<const __m128i*>(src))));
+  }
+#elif defined(__aarch64__)
+  for (; size >= 4; src += 4, dst += 4, size -= 4) {
+    vst1q_f32(dst,
+              vcvt_f32_f16(vld1_f16(reinterpret_cast<const float16_t*>(src))));
+  }
+#endif
+  for (; size != 0; src++, dst++, size--) {
+    *dst = static_cast<float>(*src);
+  }
+}
+
 }  // end namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bfloat16.h"
 
+#include <limits>
+#include <vector>
+
 #include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/lib/core/casts.h"
 #include "tensorflow/core/platform/test.h"
@@ -105,6 +108,69 @@ TEST(Bfloat16Test, Conversion) {
   }
 }
 
+// Values that exercise rounding, denormals, overflow and NaNs.
+std::vector<float> ConversionTestValues(int n) {
+  std::vector<float> values(n);
+  const float specials[] = {0.0f,
+                            -0.0f,
+                            1.0f,
+                            -2.5f,
+                            65504.0f,
+                            65520.0f,
+                            1e-7f,
+                            -6e-8f,
+                            1e30f,
+                            std::numeric_limits<float>::denorm_min(),
+                            std::numeric_limits<float>::infinity(),
+                            -std::numeric_limits<float>::infinity(),
+                            std::numeric_limits<float>::quiet_NaN()};
+  const int num_specials = sizeof(specials) / sizeof(specials[0]);
+  for (int i = 0; i < n; ++i) {
+    values[i] = i < num_specials ? specials[i]
+                                 : (i % 2 ? -1.0f : 1.0f) * (i * 0.37f + 0.01f);
+  }
+  return values;
+}
+
+TEST(Bfloat16Test, BulkConversionMatchesScalar) {
+  // Odd sizes so that both the vectorized body and the tail are used.
+  for (int n : {1, 7, 17, 100, 1031}) {
+    std::vector<float> a = ConversionTestValues(n);
+    std::vector<bfloat16> b(n);
+    std::vector<float> c(n);
+    FloatToBFloat16(a.data(), b.data(), n);
+    BFloat16ToFloat(b.data(), c.data(), n);
+    for (int i = 0; i < n; ++i) {
+      EXPECT_EQ(bfloat16(a[i]).value, b[i].value) << i;
+      EXPECT_EQ(bit_cast<uint32_t>(static_cast<float>(b[i])),
+                bit_cast<uint32_t>(c[i]))
+          << i;
+    }
+  }
+}
+
+TEST(Bfloat16Test, BulkHalfConversionMatchesScalar) {
+  for (int n : {1, 7, 17, 100, 1031}) {
+    std::vector<float> a = ConversionTestValues(n);
+    std::vector<Eigen::half> b(n);
+    std::vector<float> c(n);
+    FloatToHalf(a.data(), b.data(), n);
+    HalfToFloat(b.data(), c.data(), n);
+    for (int i = 0; i < n; ++i) {
+      const Eigen::half expected(a[i]);
+      if (std::isnan(a[i])) {
+        EXPECT_TRUE(std::isnan(static_cast<float>(b[i]))) << i;
+        EXPECT_TRUE(std::isnan(c[i])) << i;
+        continue;
+      }
+      EXPECT_EQ(expected.x, b[i].x) << i;
+      EXPECT_EQ(bit_cast<uint32_t>(static_cast<float>(b[i])),
+                bit_cast<uint32_t>(c[i]))
+          << i;
+    }
+  }
+}
+
 TEST(Bfloat16Test, Epsilon) {
   EXPECT_LT(1.0f, static_cast<float>(bfloat16::epsilon() + bfloat16(1.0f)));
   EXPECT_EQ(1.0f, static_cast<float>((bfloat16::epsilon() / bfloat16(2.0f)) +
@@ -154,5 +220,43 @@ static void BM_BFloat16ToFloat(int iters) {
 }
 BENCHMARK(BM_BFloat16ToFloat);
 
+static void BM_FloatToHalf(int iters) {
+  testing::StopTiming();
+  static const int N = 32 << 20;
+  const int64 tot = static_cast<int64>(iters) * N;
+  testing::ItemsProcessed(tot);
+  testing::BytesProcessed(tot * (sizeof(float) + sizeof(Eigen::half)));
+
+  float* inp = new float[N];
+  Eigen::half* out = new Eigen::half[N];
+
+  testing::StartTiming();
+  while (iters--) {
+    FloatToHalf(inp, out, N);
+  }
+  delete[] inp;
+  delete[] out;
+}
+BENCHMARK(BM_FloatToHalf);
+
+static void BM_HalfToFloat(int iters) {
+  testing::StopTiming();
+  static const int N = 32 << 20;
+  const int64 tot = static_cast<int64>(iters) * N;
+  testing::ItemsProcessed(tot);
+  testing::BytesProcessed(tot * (sizeof(float) + sizeof(Eigen::half)));
+
+  Eigen::half* inp = new Eigen::half[N];
+  float* out = new float[N];
+
+  testing::StartTiming();
+  while (iters--) {
+    HalfToFloat(inp, out, N);
+  }
+  delete[] inp;
+  delete[] out;
+}
+BENCHMARK(BM_HalfToFloat);
+
 }  // namespace
 }  // namespace tensorflow
@@ -221,6 +221,18 @@ class DeviceBase {
     return errors::Internal("Device does not implement MakeTensorFromProto()");
   }
 
+  // Copies "host_tensor", which must be in host memory allocated with the
+  // on_host() and gpu_compatible() attributes of this device, into
+  // 'tensor' stored in Device memory. Returns Unimplemented if the device
+  // does not support it, in which case callers should use
+  // MakeTensorFromProto() instead.
+  virtual Status MakeTensorFromHostTensor(const Tensor& host_tensor,
+                                          const AllocatorAttributes alloc_attrs,
+                                          Tensor* tensor) {
+    return errors::Unimplemented(
+        "Device does not implement MakeTensorFromHostTensor()");
+  }
+
  protected:
   // Does not take ownership.
   void set_tensorflow_device_thread_pool(thread::ThreadPool* thread_pool) {
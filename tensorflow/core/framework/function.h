@@ -269,6 +269,9 @@ class FunctionCallFrame : public CallFrameInterface {
   Status SetArgs(gtl::ArraySlice<Tensor> args);
   Status GetRetvals(std::vector<Tensor>* rets) const;
   Status ConsumeRetvals(std::vector<Tensor>* rets);
+  // Drops the arguments and return values of the last call, so that the
+  // frame can be reused for another call.
+  void Reset();
 
   size_t num_args() const override { return arg_types_.size(); }
   size_t num_retvals() const override { return ret_types_.size(); }
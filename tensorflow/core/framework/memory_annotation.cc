@@ -0,0 +1,76 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/memory_annotation.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+struct InternedNames {
+  mutex mu;
+  // names[id - 1] is the name interned as id.
+  std::vector<string> names GUARDED_BY(mu);
+  std::unordered_map<string, uint32> ids GUARDED_BY(mu);
+};
+
+InternedNames* GetInternedNames() {
+  static InternedNames* interned = new InternedNames;
+  return interned;
+}
+
+thread_local uint32 current_annotation = MemoryAnnotation::kNone;
+
+}  // namespace
+
+// static
+uint32 MemoryAnnotation::Intern(StringPiece op_name) {
+  InternedNames* interned = GetInternedNames();
+  mutex_lock l(interned->mu);
+  auto result =
+      interned->ids.emplace(op_name.ToString(), interned->names.size() + 1);
+  if (result.second) {
+    interned->names.push_back(result.first->first);
+  }
+  return result.first->second;
+}
+
+// static
+string MemoryAnnotation::OpName(uint32 id) {
+  if (id == kNone) return "";
+  InternedNames* interned = GetInternedNames();
+  mutex_lock l(interned->mu);
+  if (id > interned->names.size()) return "";
+  return interned->names[id - 1];
+}
+
+// static
+uint32 MemoryAnnotation::Current() { return current_annotation; }
+
+ScopedMemoryAnnotation::ScopedMemoryAnnotation(uint32 id)
+    : enclosing_(current_annotation) {
+  current_annotation = id;
+}
+
+ScopedMemoryAnnotation::~ScopedMemoryAnnotation() {
+  current_annotation = enclosing_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,63 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_FRAMEWORK_MEMORY_ANNOTATION_H_
+#define TENSORFLOW_FRAMEWORK_MEMORY_ANNOTATION_H_
+
+#include <string>
+
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Names the op on whose behalf the calling thread allocates memory, so that
+// allocators can attribute their allocations to ops at the cost of reading a
+// thread-local integer. Op names are interned once, e.g. when an executor is
+// created, into ids that stay valid for the lifetime of the process.
+class MemoryAnnotation {
+ public:
+  // The id of allocations made outside of any ScopedMemoryAnnotation.
+  static const uint32 kNone = 0;
+
+  // Returns the id of 'op_name', which is the same for every call with the
+  // same name. Takes a lock, so it should not be called per allocation.
+  static uint32 Intern(StringPiece op_name);
+
+  // Returns the op name interned as 'id', or "" for kNone.
+  static string OpName(uint32 id);
+
+  // Returns the id of the innermost ScopedMemoryAnnotation of the calling
+  // thread, or kNone.
+  static uint32 Current();
+};
+
+// Sets the annotation of the calling thread to 'id' for the lifetime of the
+// object, then restores the enclosing one.
+class ScopedMemoryAnnotation {
+ public:
+  explicit ScopedMemoryAnnotation(uint32 id);
+  ~ScopedMemoryAnnotation();
+
+ private:
+  const uint32 enclosing_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedMemoryAnnotation);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_FRAMEWORK_MEMORY_ANNOTATION_H_
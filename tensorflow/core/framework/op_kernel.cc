@@ -277,7 +277,9 @@ OpKernelContext::~OpKernelContext() {
 
 Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   Allocator* allocator =
-      params_->device->GetStepAllocator(attr, resource_manager());
+      (params_->step_arena_allocator != nullptr && attr.value == 0)
+          ? params_->step_arena_allocator
+          : params_->device->GetStepAllocator(attr, resource_manager());
   if (track_allocations()) {
     mutex_lock lock(mu_);
     for (const auto& wrapped : wrapped_allocators_) {
@@ -514,6 +514,11 @@ class OpKernelContext {
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
+    // If not nullptr, get_allocator() returns this allocator instead of the
+    // device's for the default allocator attributes. Set by the executor
+    // when the step allocates from a StepArena. Not owned.
+    Allocator* step_arena_allocator = nullptr;
+
     // Per-step resources accessible by this op kernel invocation should be
     // stored in this container..
     ScopedStepContainer* step_container = nullptr;
@@ -992,6 +997,15 @@ class OpKernelContext {
     return params_->cancellation_manager;
   }
 
+  // Returns true if the step has been cancelled, e.g. because it exceeded
+  // RunOptions.timeout_in_ms. This is a single atomic load, so kernels that
+  // run for a long time can poll it between units of work and give up with
+  // errors::Cancelled().
+  bool IsCancelled() const {
+    return params_->cancellation_manager != nullptr &&
+           params_->cancellation_manager->IsCancelled();
+  }
+
   // Other accessors.
 
   // For control flow.
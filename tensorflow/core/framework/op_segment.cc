@@ -15,9 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_segment.h"
 
+#include <vector>
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -32,6 +39,7 @@ OpSegment::OpSegment() {}
 
 OpSegment::~OpSegment() {
   for (auto kv : sessions_) delete kv.second;
+  for (auto kv : shared_kernels_) delete kv.second.kernel;
 }
 
 Status OpSegment::FindOrCreate(const string& session_handle,
@@ -70,6 +78,80 @@ Status OpSegment::FindOrCreate(const string& session_handle,
   return Status::OK();
 }
 
+Status OpSegment::FindOrCreateShared(const string& session_handle,
+                                     const string& kernel_key,
+                                     OpKernel** kernel,
+                                     CreateKernelFn create_fn) {
+  {
+    mutex_lock l(mu_);
+    auto item = gtl::FindPtrOrNull(sessions_, session_handle);
+    if (item == nullptr) {
+      return errors::NotFound("Session ", session_handle, " is not found.");
+    }
+    auto shared = shared_kernels_.find(kernel_key);
+    if (shared != shared_kernels_.end()) {
+      if (item->shared_keys.insert(kernel_key).second) {
+        ++shared->second.num_sessions;
+      }
+      *kernel = shared->second.kernel;
+      return Status::OK();
+    }
+  }
+  Status s = create_fn(kernel);
+  if (!s.ok()) {
+    LOG(ERROR) << "Create kernel failed: " << s;
+    return s;
+  }
+  {
+    mutex_lock l(mu_);
+    auto item = gtl::FindPtrOrNull(sessions_, session_handle);
+    if (item == nullptr) {
+      delete *kernel;
+      *kernel = nullptr;
+      return errors::NotFound("Session ", session_handle, " is not found.");
+    }
+    SharedKernel* shared = &shared_kernels_[kernel_key];
+    if (shared->kernel == nullptr) {
+      shared->kernel = *kernel;  // Inserts 'kernel' in the map.
+    } else {
+      delete *kernel;
+      *kernel = shared->kernel;
+    }
+    if (item->shared_keys.insert(kernel_key).second) {
+      ++shared->num_sessions;
+    }
+  }
+  return Status::OK();
+}
+
+// static
+bool OpSegment::ShouldShareKernel(FunctionLibraryRuntime* lib,
+                                  const NodeDef& ndef) {
+  if (lib->IsStateful(ndef.op()) ||
+      lib->GetFunctionLibraryDefinition()->Find(ndef.op()) != nullptr ||
+      ndef.op() == FunctionLibraryDefinition::kGradientOp) {
+    return false;
+  }
+  for (const auto& attr : ndef.attr()) {
+    if (attr.second.value_case() == AttrValue::kFunc ||
+        attr.second.list().func_size() > 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// static
+string OpSegment::SharedKernelKey(const NodeDef& ndef, int graph_def_version) {
+  string serialized;
+  SerializeToStringDeterministic(ndef, &serialized);
+  const Fprint128 fp = Fingerprint128(serialized);
+  return strings::Printf("%s:%d:%016llx%016llx", ndef.op().c_str(),
+                         graph_def_version,
+                         static_cast<unsigned long long>(fp.high64),
+                         static_cast<unsigned long long>(fp.low64));
+}
+
 void OpSegment::AddHold(const string& session_handle) {
   mutex_lock l(mu_);
   Item** item = &sessions_[session_handle];
@@ -82,6 +164,7 @@ void OpSegment::AddHold(const string& session_handle) {
 
 void OpSegment::RemoveHold(const string& session_handle) {
   Item* item = nullptr;
+  std::vector<OpKernel*> unused_kernels;
   {
     mutex_lock l(mu_);
     auto siter = sessions_.find(session_handle);
@@ -95,8 +178,16 @@ void OpSegment::RemoveHold(const string& session_handle) {
     } else {
       sessions_.erase(siter);
     }
+    for (const string& key : item->shared_keys) {
+      auto shared = shared_kernels_.find(key);
+      if (--shared->second.num_sessions == 0) {
+        unused_kernels.push_back(shared->second.kernel);
+        shared_kernels_.erase(shared);
+      }
+    }
   }
   delete item;
+  for (OpKernel* kernel : unused_kernels) delete kernel;
 }
 
 }  // end namespace tensorflow
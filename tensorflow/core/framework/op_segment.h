@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -60,21 +61,53 @@ class OpSegment {
   Status FindOrCreate(const string& session_handle, const string& node_name,
                       OpKernel** kernel, CreateKernelFn create_fn);
 
+  // Like FindOrCreate(), except that the kernel is shared by all the sessions
+  // that ask for a kernel with the same "kernel_key", e.g. the stateless
+  // nodes of a GraphDef that several sessions or subgraphs run.  The kernel
+  // lives until the last of these sessions is removed.
+  //
+  // OpSegment keeps the ownership of the returned "*kernel".
+  Status FindOrCreateShared(const string& session_handle,
+                            const string& kernel_key, OpKernel** kernel,
+                            CreateKernelFn create_fn);
+
+  // Returns true if the kernel of "ndef" can be shared through
+  // FindOrCreateShared(), i.e. its construction depends on nothing but
+  // "ndef" and the device.  This excludes stateful ops, functions and ops
+  // with function attrs, whose kernels are tied to "lib".
+  static bool ShouldShareKernel(FunctionLibraryRuntime* lib,
+                                const NodeDef& ndef);
+
+  // Returns the key under which FindOrCreateShared() shares the kernel of
+  // "ndef", which identifies every field of "ndef" and the graph version the
+  // kernel is created for.
+  static string SharedKernelKey(const NodeDef& ndef, int graph_def_version);
+
  private:
   // op name -> OpKernel
   typedef std::unordered_map<string, OpKernel*> KernelMap;
   struct Item {
     int num_holds = 1;      // Num of holds put on the session.
     KernelMap name_kernel;  // op name -> kernel.
+    // The keys of the shared kernels used by the session.
+    std::unordered_set<string> shared_keys;
     ~Item();
   };
 
+  // A kernel shared by "num_sessions" sessions.
+  struct SharedKernel {
+    OpKernel* kernel = nullptr;
+    int num_sessions = 0;
+  };
+
   // session handle -> item.
   // Session handles are produced by strings::FpToString()
   typedef std::unordered_map<string, Item*> SessionMap;
 
   mutable mutex mu_;
   SessionMap sessions_ GUARDED_BY(mu_);
+  // kernel key -> shared kernel.
+  std::unordered_map<string, SharedKernel> shared_kernels_ GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(OpSegment);
 };
@@ -156,4 +156,45 @@ TEST_F(OpSegmentTest, AddRemoveHolds) {
   opseg.RemoveHold("foo");
 }
 
+TEST_F(OpSegmentTest, SharedKernels) {
+  OpSegment opseg;
+  const auto& ndef = float_nodedefs_[0];
+  const string key = OpSegment::SharedKernelKey(ndef, TF_GRAPH_DEF_VERSION);
+  EXPECT_NE(key, OpSegment::SharedKernelKey(int32_nodedefs_[0],
+                                            TF_GRAPH_DEF_VERSION));
+  EXPECT_NE(key, OpSegment::SharedKernelKey(ndef, TF_GRAPH_DEF_VERSION - 1));
+
+  int num_created = 0;
+  auto counting_fn = [this, &ndef, &num_created](OpKernel** kernel) {
+    ++num_created;
+    return GetFn(&ndef)(kernel);
+  };
+  opseg.AddHold("A");
+  opseg.AddHold("B");
+  OpKernel* op_a;
+  OpKernel* op_b;
+  TF_EXPECT_OK(opseg.FindOrCreateShared("A", key, &op_a, counting_fn));
+  TF_EXPECT_OK(opseg.FindOrCreateShared("A", key, &op_a, counting_fn));
+  TF_EXPECT_OK(opseg.FindOrCreateShared("B", key, &op_b, counting_fn));
+  EXPECT_EQ(1, num_created);
+  EXPECT_EQ(op_a, op_b);
+  ValidateOpAndTypes(op_a, ndef, DT_FLOAT);
+
+  // The kernel outlives session "A" as long as "B" uses it.
+  opseg.RemoveHold("A");
+  ValidateOpAndTypes(op_b, ndef, DT_FLOAT);
+  opseg.RemoveHold("B");
+
+  // A session that starts after the last user is removed gets a new kernel.
+  opseg.AddHold("C");
+  OpKernel* op_c;
+  TF_EXPECT_OK(opseg.FindOrCreateShared("C", key, &op_c, counting_fn));
+  EXPECT_EQ(2, num_created);
+  ValidateOpAndTypes(op_c, ndef, DT_FLOAT);
+  opseg.RemoveHold("C");
+
+  Status s = opseg.FindOrCreateShared("D", key, &op_c, counting_fn);
+  EXPECT_TRUE(errors::IsNotFound(s)) << s;
+}
+
 }  // namespace tensorflow
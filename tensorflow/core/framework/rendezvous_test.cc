@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -53,6 +54,9 @@ TEST(RendezvousTest, Key) {
   EXPECT_EQ(parsed.src.type, "CPU");
   EXPECT_EQ(parsed.dst_device, "/job:mnist/replica:1/task:2/device:GPU:0");
   EXPECT_EQ(parsed.dst.type, "GPU");
+  EXPECT_EQ(parsed.KeyHash(), Hash64(key));
+  Rendezvous::ParsedKey copy(parsed);
+  EXPECT_EQ(copy.KeyHash(), parsed.KeyHash());
 
   EXPECT_FALSE(Rendezvous::ParseKey("foo;bar;baz", &parsed).ok());
   EXPECT_FALSE(Rendezvous::ParseKey("/job:mnist/replica:1/task:2/CPU:0;"
@@ -360,5 +364,34 @@ void BM_PingPong(int iters) {
 }
 BENCHMARK(BM_PingPong);
 
+// Each of 'num_threads' threads sends and receives under its own key.
+void BM_SendRecvParallel(int iters, int num_threads) {
+  testing::StopTiming();
+  std::vector<Rendezvous::ParsedKey> keys(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    keys[i] = MakeKey(strings::StrCat("key", i));
+  }
+  Rendezvous* rendez = NewLocalRendezvous();
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", num_threads);
+  testing::StartTiming();
+  for (int i = 0; i < num_threads; ++i) {
+    pool->Schedule([rendez, &keys, i, iters, num_threads]() {
+      Tensor orig = V("val");
+      Tensor val(DT_STRING, TensorShape({}));
+      bool is_dead = false;
+      Rendezvous::Args args;
+      for (int j = i; j < iters; j += num_threads) {
+        TF_CHECK_OK(rendez->Send(keys[i], args, orig, is_dead));
+        TF_CHECK_OK(rendez->Recv(keys[i], args, &val, &is_dead));
+      }
+    });
+  }
+  delete pool;
+  testing::StopTiming();
+  rendez->Unref();
+}
+BENCHMARK(BM_SendRecvParallel)->Arg(1)->Arg(4)->Arg(16);
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,85 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/shared_tensor_store.h"
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+SharedTensorStore* SharedTensorStore::Global() {
+  static SharedTensorStore* store = new SharedTensorStore;
+  return store;
+}
+
+string SharedTensorStore::MakeKey(const string& scope, const string& content) {
+  const Fprint128 fp = Fingerprint128(content);
+  return strings::StrCat(scope, "/", content.size(), "/",
+                         strings::Hex(fp.high64, strings::ZERO_PAD_16),
+                         strings::Hex(fp.low64, strings::ZERO_PAD_16));
+}
+
+Status SharedTensorStore::LookupOrCreate(const string& key,
+                                         const Creator& creator,
+                                         Tensor* tensor) {
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      ++it->second.refs;
+      *tensor = it->second.tensor;
+      return Status::OK();
+    }
+  }
+
+  Tensor created;
+  TF_RETURN_IF_ERROR(creator(&created));
+
+  mutex_lock l(mu_);
+  Entry& entry = entries_[key];
+  if (entry.refs == 0) {
+    entry.tensor = std::move(created);
+  }
+  ++entry.refs;
+  *tensor = entry.tensor;
+  return Status::OK();
+}
+
+void SharedTensorStore::Release(const string& key) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  CHECK(it != entries_.end()) << "Released unknown shared tensor " << key;
+  if (--it->second.refs == 0) {
+    entries_.erase(it);
+  }
+}
+
+size_t SharedTensorStore::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+int64 SharedTensorStore::saved_bytes() const {
+  mutex_lock l(mu_);
+  int64 bytes = 0;
+  for (const auto& it : entries_) {
+    bytes += (it.second.refs - 1) * it.second.tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+}  // namespace tensorflow
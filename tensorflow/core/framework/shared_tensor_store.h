@@ -0,0 +1,84 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_FRAMEWORK_SHARED_TENSOR_STORE_H_
+#define TENSORFLOW_FRAMEWORK_SHARED_TENSOR_STORE_H_
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A process-wide store of read-only tensors, addressed by a key derived
+// from their contents. Sessions that hold the same large constant (e.g.
+// model variants sharing an embedding table) get the same buffer instead
+// of one copy each.
+//
+// Entries are reference counted: every successful LookupOrCreate() must be
+// balanced by a Release() of the same key, and the entry is dropped when
+// the last reference is released. Callers must never write to a tensor
+// returned by the store.
+class SharedTensorStore {
+ public:
+  typedef std::function<Status(Tensor*)> Creator;
+
+  SharedTensorStore() {}
+
+  // Returns the store shared by the whole process.
+  static SharedTensorStore* Global();
+
+  // Returns the key for a tensor made from the serialized 'content' by a
+  // producer identified by 'scope' (e.g. the device and allocator that the
+  // tensor is materialized on).
+  static string MakeKey(const string& scope, const string& content);
+
+  // Sets '*tensor' to the entry for 'key', calling 'creator' to make it if
+  // there is none, and takes a reference on the entry. 'creator' runs
+  // without the store lock held; if two callers race to create the same
+  // key, the loser's tensor is discarded.
+  Status LookupOrCreate(const string& key, const Creator& creator,
+                        Tensor* tensor);
+
+  // Drops a reference taken by LookupOrCreate().
+  void Release(const string& key);
+
+  // Returns the number of distinct live entries.
+  size_t size() const;
+
+  // Returns the number of bytes held once instead of once per reference.
+  int64 saved_bytes() const;
+
+ private:
+  struct Entry {
+    Tensor tensor;
+    int64 refs = 0;
+  };
+
+  mutable mutex mu_;
+  std::unordered_map<string, Entry> entries_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedTensorStore);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_FRAMEWORK_SHARED_TENSOR_STORE_H_
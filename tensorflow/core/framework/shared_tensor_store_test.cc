@@ -0,0 +1,76 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/shared_tensor_store.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(SharedTensorStoreTest, MakeKey) {
+  EXPECT_EQ(SharedTensorStore::MakeKey("cpu", "abc"),
+            SharedTensorStore::MakeKey("cpu", "abc"));
+  EXPECT_NE(SharedTensorStore::MakeKey("cpu", "abc"),
+            SharedTensorStore::MakeKey("cpu", "abd"));
+  EXPECT_NE(SharedTensorStore::MakeKey("cpu", "abc"),
+            SharedTensorStore::MakeKey("gpu", "abc"));
+}
+
+TEST(SharedTensorStoreTest, SharesBufferUntilReleased) {
+  SharedTensorStore store;
+  int num_created = 0;
+  auto creator = [&num_created](Tensor* tensor) {
+    ++num_created;
+    *tensor = test::AsTensor<float>({1, 2, 3, 4});
+    return Status::OK();
+  };
+
+  Tensor a, b;
+  TF_ASSERT_OK(store.LookupOrCreate("key", creator, &a));
+  TF_ASSERT_OK(store.LookupOrCreate("key", creator, &b));
+  EXPECT_EQ(1, num_created);
+  EXPECT_EQ(1, store.size());
+  EXPECT_EQ(a.tensor_data().data(), b.tensor_data().data());
+  EXPECT_EQ(4 * sizeof(float), store.saved_bytes());
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({1, 2, 3, 4}), b);
+
+  store.Release("key");
+  EXPECT_EQ(1, store.size());
+  EXPECT_EQ(0, store.saved_bytes());
+  store.Release("key");
+  EXPECT_EQ(0, store.size());
+
+  // Once all references are gone the tensor is made again.
+  Tensor c;
+  TF_ASSERT_OK(store.LookupOrCreate("key", creator, &c));
+  EXPECT_EQ(2, num_created);
+  store.Release("key");
+}
+
+TEST(SharedTensorStoreTest, CreatorError) {
+  SharedTensorStore store;
+  Tensor t;
+  Status s = store.LookupOrCreate(
+      "key", [](Tensor*) { return errors::Internal("failed"); }, &t);
+  EXPECT_TRUE(errors::IsInternal(s));
+  EXPECT_EQ(0, store.size());
+}
+
+}  // namespace
+}  // namespace tensorflow
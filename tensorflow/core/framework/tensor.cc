@@ -23,12 +23,18 @@ limitations under the License.
 //   default constructors and destructors when T is not a simple type
 //   (e.g., string.), and skips them otherwise.
 //
+// * InlineBuffer: holds the data of a small tensor of a simple type
+//   inside the buffer object itself, so that scalars and tiny shapes
+//   cost one allocation from a per-thread free list.
+//
 // * Helper<T>: provides various routines given type T.  The routines
 //   includes running the constructor and destructor of T[], encoding
 //   an decoding T[] into/from a Cord, etc.
 
 #include "tensorflow/core/framework/tensor.h"
 
+#include <vector>
+
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/resource_handle.pb.h"
@@ -48,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -115,6 +122,100 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Tensors of a memcpy-able type and at most this many bytes that are
+// allocated from cpu_allocator() keep their data in an InlineBuffer.
+constexpr size_t kInlineBufferBytes = 64;
+
+// The number of freed InlineBuffers each thread keeps for reuse.
+constexpr size_t kMaxCachedInlineBuffers = 256;
+
+// Untyped ref-counted buffer of at most kInlineBufferBytes, stored inline.
+class InlineBuffer : public TensorBuffer {
+ public:
+  InlineBuffer(Allocator* alloc, size_t size) : alloc_(alloc), size_(size) {}
+
+  void* data() const override { return const_cast<char*>(data_); }
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(alloc_->Name());
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
+ private:
+  ~InlineBuffer() override {}
+
+  // Only used for its name: the data never comes from the allocator.
+  Allocator* const alloc_;
+  const size_t size_;
+  alignas(Allocator::kAllocatorAlignment) char data_[kInlineBufferBytes];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
+// The freed InlineBuffer blocks of one thread. A buffer released on another
+// thread than the one that created it joins the list of the releasing thread.
+struct InlineBufferCache {
+  ~InlineBufferCache();
+
+  std::vector<void*> blocks;
+};
+
+// Set once the calling thread has destroyed its InlineBufferCache, after
+// which its buffers are freed directly.
+thread_local bool inline_buffer_cache_destroyed = false;
+
+InlineBufferCache::~InlineBufferCache() {
+  for (void* block : blocks) {
+    port::AlignedFree(block);
+  }
+  inline_buffer_cache_destroyed = true;
+}
+
+InlineBufferCache* GetInlineBufferCache() {
+  if (inline_buffer_cache_destroyed) return nullptr;
+  static thread_local InlineBufferCache cache;
+  return &cache;
+}
+
+void* InlineBuffer::operator new(size_t size) {
+  DCHECK_EQ(size, sizeof(InlineBuffer));
+  InlineBufferCache* cache = GetInlineBufferCache();
+  if (cache != nullptr && !cache->blocks.empty()) {
+    void* block = cache->blocks.back();
+    cache->blocks.pop_back();
+    return block;
+  }
+  void* block =
+      port::AlignedMalloc(sizeof(InlineBuffer), alignof(InlineBuffer));
+  CHECK(block != nullptr) << "Failed to allocate an InlineBuffer";
+  return block;
+}
+
+void InlineBuffer::operator delete(void* ptr) {
+  InlineBufferCache* cache = GetInlineBufferCache();
+  if (cache != nullptr && cache->blocks.size() < kMaxCachedInlineBuffers) {
+    cache->blocks.push_back(ptr);
+  } else {
+    port::AlignedFree(ptr);
+  }
+}
+
+// Returns true if a tensor of 'type' and 'shape' allocated from 'a' can keep
+// its data in an InlineBuffer. Allocators that track or log individual
+// allocations, which includes every TrackingAllocator, keep seeing them.
+bool UseInlineBuffer(Allocator* a, DataType type, const TensorShape& shape) {
+  if (!DataTypeCanUseMemcpy(type)) return false;
+  const int64 bytes = shape.num_elements() * DataTypeSize(type);
+  return bytes > 0 && bytes <= static_cast<int64>(kInlineBufferBytes) &&
+         a == cpu_allocator() && !a->TracksAllocationSizes() &&
+         !CPUAllocatorStatsEnabled() && !LogMemory::IsEnabled();
+}
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -714,7 +815,9 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
+  if (UseInlineBuffer(a, type, shape)) {
+    buf_ = new InlineBuffer(a, shape.num_elements() * DataTypeSize(type));
+  } else if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
   }
   if (buf_ != nullptr && buf_->data() != nullptr && LogMemory::IsEnabled()) {
@@ -728,7 +831,9 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
+  if (UseInlineBuffer(a, type, shape)) {
+    buf_ = new InlineBuffer(a, shape.num_elements() * DataTypeSize(type));
+  } else if (shape_.num_elements() > 0 || a->ShouldAllocateEmptyTensors()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (!allocation_attr.allocation_will_be_logged && buf_ != nullptr &&
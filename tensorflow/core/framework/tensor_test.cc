@@ -1128,6 +1128,52 @@ TEST(Tensor, FailureToAllocate) {
   }
 }
 
+// Counts the allocations it forwards to cpu_allocator().
+class CountingCPUAllocator : public Allocator {
+ public:
+  string Name() override { return "counting_cpu"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations = 0;
+};
+
+TEST(Tensor, SmallTensors) {
+  const void* data;
+  {
+    Tensor a(cpu_allocator(), DT_INT64, TensorShape({}));
+    a.scalar<int64>()() = 17;
+    EXPECT_TRUE(a.IsAligned());
+    Tensor b = a;
+    EXPECT_TRUE(b.SharesBufferWith(a));
+    EXPECT_EQ(17, b.scalar<int64>()());
+    data = a.tensor_data().data();
+  }
+  {
+    // A block freed on this thread is reused by its next small tensor.
+    Tensor a(cpu_allocator(), DT_FLOAT, TensorShape({4, 4}));
+    EXPECT_EQ(data, a.tensor_data().data());
+    EXPECT_TRUE(a.IsAligned());
+    a.flat<float>().setConstant(2.0);
+    Tensor row = a.Slice(1, 2);
+    EXPECT_EQ(2.0, row.flat<float>()(3));
+    EXPECT_EQ(64, a.TotalBytes());
+  }
+  {
+    // Anything but cpu_allocator() still sees every allocation.
+    CountingCPUAllocator allocator;
+    Tensor a(&allocator, DT_INT32, TensorShape({}));
+    a.scalar<int32>()() = 3;
+    Tensor b(&allocator, DT_FLOAT, TensorShape({17}));
+    EXPECT_EQ(2, allocator.num_allocations);
+  }
+}
+
 // On the alignment.
 //
 // As of 2015/8, tensorflow::Tensor allocates its buffer with 32-byte
@@ -1311,6 +1357,16 @@ static void BM_CreateAndDestroyWithBuf(int iters) {
 }
 BENCHMARK(BM_CreateAndDestroyWithBuf);
 
+// Benchmark create and destroy a scalar, with an allocated buffer.
+static void BM_CreateAndDestroyScalarWithBuf(int iters) {
+  TensorShape shape({});
+  Allocator* allocator = cpu_allocator();
+  while (--iters) {
+    Tensor a(allocator, DT_INT32, shape);
+  }
+}
+BENCHMARK(BM_CreateAndDestroyScalarWithBuf);
+
 // Benchmark create+copy a tensor, with an allocated buffer.
 static void BM_CreateAndCopyCtrWithBuf(int iters) {
   TensorShape shape({10, 20});
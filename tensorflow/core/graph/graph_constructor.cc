@@ -289,10 +289,11 @@ class GraphConstructor {
   // Used in the conversion from node_defs_ to g_ to represent the ith input
   // of a node.
   struct InputInfo {
-    explicit InputInfo(const string& node_name, Node* n, int i)
+    explicit InputInfo(StringPiece node_name, Node* n, int i)
         : name(node_name), node(n), index(i) {}
-    // Use string instead of StringPiece so we don't have to manage lifetime
-    string name;
+    // Refers to a key of gdef_nodes_ or existing_nodes_, so it stays valid
+    // while the NodeDef being converted is rewritten for import.
+    StringPiece name;
     Node* node;
     int index;
   };
@@ -415,6 +416,7 @@ Status GraphConstructor::ValidateInputMapAndControlDependencies() {
 
 Status GraphConstructor::BuildNodeIndex() {
   // Validate the node names and add them to gdef_nodes_ and gdef_prefixes_.
+  gdef_nodes_.reserve(node_defs_.size());
   for (int n = 0; n < node_defs_.size(); ++n) {
     const NodeDef& node_def = *node_defs_[n];
     if (!IsValidNodeName(node_def.name(), opts_.allow_internal_ops)) {
@@ -455,9 +457,9 @@ Status GraphConstructor::BuildNodeIndex() {
   return Status::OK();
 }
 
-std::unordered_set<string> GetNextIterationNodes(
+std::unordered_set<StringPiece, StringPieceHasher> GetNextIterationNodes(
     const GraphConstructor::NodeDefSlice& node_defs) {
-  std::unordered_set<string> next_iteration_nodes;
+  std::unordered_set<StringPiece, StringPieceHasher> next_iteration_nodes;
 
   for (int n = 0; n < node_defs.size(); ++n) {
     const NodeDef& node_def = *node_defs[n];
@@ -473,7 +475,7 @@ Status GraphConstructor::InitFromEdges() {
   const int num_nodes = node_defs_.size();
   pending_count_.reserve(num_nodes);
   outputs_.resize(num_nodes);
-  std::unordered_set<string> next_iteration_nodes_ =
+  std::unordered_set<StringPiece, StringPieceHasher> next_iteration_nodes_ =
       GetNextIterationNodes(node_defs_);
 
   // Parse the inputs for each node.
@@ -493,7 +495,7 @@ Status GraphConstructor::InitFromEdges() {
           num_control_edges++;
         } else {
           TensorId id(ParseTensorName(input_name));
-          if (next_iteration_nodes_.find(id.first.ToString()) !=
+          if (next_iteration_nodes_.find(id.first) !=
               next_iteration_nodes_.end()) {
             has_loop_back_edge = true;
           }
@@ -950,6 +952,7 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(ValidateColocationConstraints(*node_def));
     for (int i = 0; i < node_def->input_size(); ++i) {
       TensorId id(ParseTensorName(node_def->input(i)));
+      StringPiece src_name;
       Node* src_node;
       int src_index;
 
@@ -957,6 +960,7 @@ Status GraphConstructor::Convert() {
         // Locate input in newly-imported nodes
         auto iter = gdef_nodes_.find(id.first);
         DCHECK(iter != gdef_nodes_.end()) << id.first;
+        src_name = iter->first;
         src_node = iter->second.node;
         src_index = id.second;
         if (src_node == nullptr) has_data_back_edge = true;
@@ -964,6 +968,7 @@ Status GraphConstructor::Convert() {
         // Input refers to preexistng node in graph
         auto iter = existing_nodes_.find(id.first);
         DCHECK(iter != existing_nodes_.end()) << id.first;
+        src_name = iter->first;
         src_node = iter->second;
         src_index = id.second;
       }
@@ -975,7 +980,7 @@ Status GraphConstructor::Convert() {
             src_node->num_outputs(), " outputs");
       }
 
-      inputs.push_back(InputInfo(id.first.ToString(), src_node, src_index));
+      inputs.push_back(InputInfo(src_name, src_node, src_index));
     }
 
     if (has_data_back_edge && !IsMerge(*node_def)) {
@@ -1003,7 +1008,7 @@ Status GraphConstructor::Convert() {
         // Record this back edge, which will be added after all nodes
         // are created.
         back_edges_.push_back(
-            EdgeInfo(inputs[i].name, inputs[i].index, node, i));
+            EdgeInfo(inputs[i].name.ToString(), inputs[i].index, node, i));
       } else if (inputs[i].index == Graph::kControlSlot) {
         g_->AddControlEdge(inputs[i].node, node);
       } else {
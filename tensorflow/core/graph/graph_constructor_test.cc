@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_constructor.h"
 
+#include <algorithm>
 #include <vector>
 #include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
@@ -27,11 +28,13 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -3142,5 +3145,56 @@ TEST_F(GraphConstructorTest, ImportGraphDef_ValidateColationConstraints) {
   TF_EXPECT_OK(ImportGraphDef(options, def, &graph_, nullptr));
 }
 
+// Returns a graph of 'num_nodes' TestMul nodes, each of which reads two of
+// the 100 nodes created before it.
+GraphDef ManyNodesGraphDef(int num_nodes) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  GraphDef def;
+  NodeDef* input = def.add_node();
+  input->set_name("in");
+  input->set_op("TestInput");
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestMul");
+    for (int j = 0; j < 2; ++j) {
+      const int back = std::min(i, 100) + 1;
+      const int src = i - 1 - static_cast<int>(rnd.Uniform(back));
+      node->add_input(src < 0 ? "in:1" : strings::StrCat("n", src));
+    }
+  }
+  return def;
+}
+
+static void BM_ConvertGraphDefToGraph(int iters, int num_nodes) {
+  testing::StopTiming();
+  const GraphDef def = ManyNodesGraphDef(num_nodes);
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_nodes);
+  for (int i = 0; i < iters; ++i) {
+    Graph graph(OpRegistry::Global());
+    GraphConstructorOptions opts;
+    testing::StartTiming();
+    TF_CHECK_OK(ConvertGraphDefToGraph(opts, def, &graph));
+    testing::StopTiming();
+  }
+}
+BENCHMARK(BM_ConvertGraphDefToGraph)->Arg(10000)->Arg(100000)->Arg(1000000);
+
+static void BM_ImportGraphDef(int iters, int num_nodes) {
+  testing::StopTiming();
+  const GraphDef def = ManyNodesGraphDef(num_nodes);
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_nodes);
+  for (int i = 0; i < iters; ++i) {
+    Graph graph(OpRegistry::Global());
+    ImportGraphDefOptions opts;
+    opts.prefix = "import";
+    testing::StartTiming();
+    TF_CHECK_OK(ImportGraphDef(opts, def, &graph, nullptr));
+    testing::StopTiming();
+  }
+}
+BENCHMARK(BM_ImportGraphDef)->Arg(10000)->Arg(100000)->Arg(1000000);
+
 }  // namespace
 }  // namespace tensorflow
@@ -36,7 +36,9 @@ struct GrapplerItem;
 // performance of the hardware that will run the model.
 class AnalyticalCostEstimator : public CostEstimator {
  public:
-  // Does not take ownership of cluster.
+  // Does not take ownership of cluster. Estimates the cost of each node with
+  // NewOpLevelCostEstimator(), which is calibrated with the measured op
+  // timings when they are available.
   AnalyticalCostEstimator(Cluster* cluster, bool use_static_shapes);
   // Does not take ownership of the cluster, but takes ownership of the
   // node_estimator
@@ -0,0 +1,167 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/calibrated_cost_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Measurements below the overhead of launching a kernel are noise.
+constexpr double kMinMeasuredNs = 500.0;
+// Keeps the logarithms of the estimates finite.
+constexpr double kMinEstimatedNs = 1.0;
+
+string CalibrationKey(const OpInfo& op_info) {
+  return strings::StrCat(op_info.op(), ":", op_info.device().type());
+}
+
+Costs::Duration Scale(Costs::Duration duration, double ratio) {
+  return Costs::Duration(duration.count() * ratio);
+}
+
+}  // namespace
+
+CalibratedCostEstimator::CalibratedCostEstimator(
+    const OpPerformanceList& calibration) {
+  for (const OpPerformance& perf : calibration.op_performance()) {
+    if (perf.compute_cost() <= 0) {
+      continue;
+    }
+    OpContext op_context;
+    op_context.op_info = perf.op();
+    const Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+    Measurement measurement;
+    measurement.estimated_ns =
+        std::max<double>(kMinEstimatedNs, costs.execution_time.count());
+    measurement.measured_ns =
+        std::max<double>(kMinMeasuredNs, perf.compute_cost());
+    measurements_[CalibrationKey(perf.op())].push_back(measurement);
+  }
+
+  // Sort the measurements by estimate, and merge the ones with the same
+  // estimate (typically repeated runs of the same shapes) into their
+  // geometric mean.
+  for (auto& entry : measurements_) {
+    std::vector<Measurement>& points = entry.second;
+    std::sort(points.begin(), points.end(),
+              [](const Measurement& a, const Measurement& b) {
+                return a.estimated_ns < b.estimated_ns;
+              });
+    std::vector<Measurement> merged;
+    for (int i = 0; i < points.size();) {
+      int j = i;
+      double log_sum = 0;
+      for (; j < points.size() && points[j].estimated_ns ==
+                                      points[i].estimated_ns;
+           ++j) {
+        log_sum += std::log(points[j].measured_ns);
+      }
+      Measurement measurement;
+      measurement.estimated_ns = points[i].estimated_ns;
+      measurement.measured_ns = std::exp(log_sum / (j - i));
+      merged.push_back(measurement);
+      i = j;
+    }
+    points.swap(merged);
+  }
+}
+
+Costs CalibratedCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  Costs costs = OpLevelCostEstimator::PredictCosts(op_context);
+  auto it = measurements_.find(CalibrationKey(op_context.op_info));
+  if (it == measurements_.end() || costs.execution_time.count() <= 0) {
+    return costs;
+  }
+  const std::vector<Measurement>& points = it->second;
+  const double estimated_ns = std::max<double>(
+      kMinEstimatedNs, costs.execution_time.count());
+
+  double measured_ns;
+  auto upper = std::lower_bound(points.begin(), points.end(), estimated_ns,
+                                [](const Measurement& m, double estimate) {
+                                  return m.estimated_ns < estimate;
+                                });
+  if (upper == points.begin()) {
+    measured_ns = estimated_ns * upper->measured_ns / upper->estimated_ns;
+  } else if (upper == points.end()) {
+    const Measurement& last = points.back();
+    measured_ns = estimated_ns * last.measured_ns / last.estimated_ns;
+  } else {
+    const Measurement& lower = *(upper - 1);
+    const double t = std::log(estimated_ns / lower.estimated_ns) /
+                     std::log(upper->estimated_ns / lower.estimated_ns);
+    measured_ns = std::exp((1 - t) * std::log(lower.measured_ns) +
+                           t * std::log(upper->measured_ns));
+  }
+
+  // Keep the split between compute and memory time of the roofline model.
+  const double ratio = measured_ns / costs.execution_time.count();
+  costs.execution_time = Scale(costs.execution_time, ratio);
+  costs.compute_time = Scale(costs.compute_time, ratio);
+  costs.memory_time = Scale(costs.memory_time, ratio);
+  VLOG(2) << "Calibrated " << op_context.op_info.op() << " from "
+          << estimated_ns << " to " << measured_ns << " ns.";
+  return costs;
+}
+
+std::unique_ptr<OpLevelCostEstimator> NewOpLevelCostEstimator() {
+  // The table is read once per process.
+  static const OpPerformanceList* calibration = []() -> OpPerformanceList* {
+    string filename;
+    Status status = ReadStringFromEnvVar("TF_GRAPPLER_COST_CALIBRATION",
+                                         /*default_val=*/"", &filename);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      return nullptr;
+    }
+    if (filename.empty()) {
+      return nullptr;
+    }
+    OpPerformanceList* list = new OpPerformanceList;
+    status = ReadBinaryProto(Env::Default(), filename, list);
+    if (!status.ok()) {
+      list->Clear();
+      status = ReadTextProto(Env::Default(), filename, list);
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to read the op cost calibration from " << filename
+                 << ": " << status;
+      delete list;
+      return nullptr;
+    }
+    VLOG(1) << "Read " << list->op_performance_size()
+            << " op cost measurements from " << filename;
+    return list;
+  }();
+  if (calibration == nullptr) {
+    return std::unique_ptr<OpLevelCostEstimator>(new OpLevelCostEstimator());
+  }
+  return std::unique_ptr<OpLevelCostEstimator>(
+      new CalibratedCostEstimator(*calibration));
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,66 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_COST_ESTIMATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_COST_ESTIMATOR_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Corrects the roofline estimates of OpLevelCostEstimator with the execution
+// times measured for the same op on the same type of device, e.g. by
+// CalibrateOpCosts().
+//
+// For each op and device type, the measurements are kept sorted by the
+// roofline estimate of the measured op. The execution time of an op is
+// interpolated, in log-log space, between the two measurements whose
+// estimates surround its own estimate, so an op with the shapes of a
+// measurement gets its measured time. Beyond the measured range, the ratio of
+// the nearest measurement to its estimate is applied. Ops that were not
+// measured keep their roofline estimate.
+class CalibratedCostEstimator : public OpLevelCostEstimator {
+ public:
+  explicit CalibratedCostEstimator(const OpPerformanceList& calibration);
+  ~CalibratedCostEstimator() override {}
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+ private:
+  struct Measurement {
+    double estimated_ns;
+    double measured_ns;
+  };
+
+  // Keyed by op and device type.
+  std::unordered_map<string, std::vector<Measurement>> measurements_;
+};
+
+// Returns the estimator of the per-op costs used by grappler: a
+// CalibratedCostEstimator if the environment variable
+// TF_GRAPPLER_COST_CALIBRATION names a file that holds an OpPerformanceList,
+// in binary or text format, and an OpLevelCostEstimator otherwise.
+std::unique_ptr<OpLevelCostEstimator> NewOpLevelCostEstimator();
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_CALIBRATED_COST_ESTIMATOR_H_
@@ -0,0 +1,120 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/calibrated_cost_estimator.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+void DescribeMatrix(int rows, int columns, OpInfo* op_features) {
+  auto input = op_features->add_inputs();
+  auto shape = input->mutable_shape();
+  shape->add_dim()->set_size(rows);
+  shape->add_dim()->set_size(columns);
+  input->set_dtype(DT_FLOAT);
+}
+
+// Returns an OpInfo for the product of two square matrices.
+OpInfo DescribeMatMul(int size, const string& device_type) {
+  OpInfo op_info;
+  op_info.set_op("MatMul");
+  auto device = op_info.mutable_device();
+  device->set_type(device_type);
+  device->set_num_cores(10);
+  device->set_bandwidth(10000000);  // 10000000 KB/s = 10 GB/s
+  device->set_frequency(1000);      // 1000 Mhz = 1 GHz
+  DescribeMatrix(size, size, &op_info);
+  DescribeMatrix(size, size, &op_info);
+  return op_info;
+}
+
+OpContext MatMulContext(int size, const string& device_type = "CPU") {
+  OpContext op_context;
+  op_context.op_info = DescribeMatMul(size, device_type);
+  return op_context;
+}
+
+void AddMeasurement(int size, int64 compute_cost_ns,
+                    OpPerformanceList* calibration) {
+  OpPerformance* perf = calibration->add_op_performance();
+  *perf->mutable_op() = DescribeMatMul(size, "CPU");
+  perf->set_compute_cost(compute_cost_ns);
+}
+
+double ExecutionTime(const OpLevelCostEstimator& estimator,
+                     const OpContext& op_context) {
+  return estimator.PredictCosts(op_context).execution_time.count();
+}
+
+}  // namespace
+
+class CalibratedCostEstimatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    AddMeasurement(100, 40000, &calibration_);
+    // Repeated measurements are averaged geometrically.
+    AddMeasurement(1000, 10000000, &calibration_);
+    AddMeasurement(1000, 40000000, &calibration_);
+  }
+
+  OpPerformanceList calibration_;
+  OpLevelCostEstimator roofline_;
+};
+
+TEST_F(CalibratedCostEstimatorTest, MeasuredShapes) {
+  CalibratedCostEstimator estimator(calibration_);
+  EXPECT_NEAR(40000, ExecutionTime(estimator, MatMulContext(100)), 2);
+  EXPECT_NEAR(20000000, ExecutionTime(estimator, MatMulContext(1000)), 2);
+}
+
+TEST_F(CalibratedCostEstimatorTest, Interpolation) {
+  CalibratedCostEstimator estimator(calibration_);
+  const double time = ExecutionTime(estimator, MatMulContext(300));
+  EXPECT_LT(40000, time);
+  EXPECT_GT(20000000, time);
+}
+
+TEST_F(CalibratedCostEstimatorTest, Extrapolation) {
+  CalibratedCostEstimator estimator(calibration_);
+  // The ratio of the nearest measurement to its estimate is applied.
+  const double small_ratio =
+      40000 / ExecutionTime(roofline_, MatMulContext(100));
+  EXPECT_NEAR(small_ratio * ExecutionTime(roofline_, MatMulContext(10)),
+              ExecutionTime(estimator, MatMulContext(10)), 2);
+  const double large_ratio =
+      20000000 / ExecutionTime(roofline_, MatMulContext(1000));
+  EXPECT_NEAR(large_ratio * ExecutionTime(roofline_, MatMulContext(2000)),
+              ExecutionTime(estimator, MatMulContext(2000)), 2 * large_ratio);
+}
+
+TEST_F(CalibratedCostEstimatorTest, UnmeasuredOps) {
+  CalibratedCostEstimator estimator(calibration_);
+  // The measurements were made on a CPU.
+  EXPECT_EQ(ExecutionTime(roofline_, MatMulContext(100, "GPU")),
+            ExecutionTime(estimator, MatMulContext(100, "GPU")));
+
+  CalibratedCostEstimator empty_estimator((OpPerformanceList()));
+  EXPECT_EQ(ExecutionTime(roofline_, MatMulContext(100)),
+            ExecutionTime(empty_estimator, MatMulContext(100)));
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
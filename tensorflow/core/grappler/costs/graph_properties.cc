@@ -23,6 +23,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -916,7 +918,44 @@ Status GraphProperties::UpdateResource(
   return Status::OK();
 }
 
+constexpr int GraphPropertiesCache::kMaxEntries;
+
 Status GraphProperties::InferStatically(bool assume_valid_feeds) {
+  if (cache_ == nullptr) {
+    return InferStaticallyUncached(assume_valid_feeds);
+  }
+  string key_data;
+  SerializeToStringDeterministic(item_.graph, &key_data);
+  strings::StrAppend(&key_data, "\n", assume_valid_feeds);
+  for (const auto& feed : item_.feed) {
+    strings::StrAppend(&key_data, "\n", feed.first);
+  }
+  const Fprint128 key = Fingerprint128(key_data);
+
+  auto& entries = cache_->entries_;
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    if (it->key == key) {
+      VLOG(1) << "Reusing the shapes inferred for an identical graph";
+      input_properties_ = it->input_properties;
+      output_properties_ = it->output_properties;
+      entries.splice(entries.begin(), entries, it);
+      return Status::OK();
+    }
+  }
+
+  TF_RETURN_IF_ERROR(InferStaticallyUncached(assume_valid_feeds));
+  if (entries.size() >= GraphPropertiesCache::kMaxEntries) {
+    entries.pop_back();
+  }
+  entries.emplace_front();
+  GraphPropertiesCache::Entry& entry = entries.front();
+  entry.key = key;
+  entry.input_properties = input_properties_;
+  entry.output_properties = output_properties_;
+  return Status::OK();
+}
+
+Status GraphProperties::InferStaticallyUncached(bool assume_valid_feeds) {
   Graph graph(OpRegistry::Global());
   FunctionLibraryDefinition function_library(graph.op_registry(),
                                              item_.graph.library());
@@ -16,12 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 #define TENSORFLOW_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 
+#include <list>
+#include <map>
 #include <unordered_map>
 #include <vector>
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -29,12 +32,41 @@ namespace grappler {
 class SymbolicShapeRefiner;
 class TopoQueue;
 
+// Remembers the properties inferred statically for the last few graphs, so
+// that the optimizers run one after the other by the meta-optimizer don't
+// infer the shapes of a graph that the previous optimizers left unchanged
+// again. Not thread-safe.
+class GraphPropertiesCache {
+ public:
+  GraphPropertiesCache() {}
+
+ private:
+  friend class GraphProperties;
+
+  struct Entry {
+    Fprint128 key;
+    std::map<string, std::vector<OpInfo::TensorProperties>> input_properties;
+    std::map<string, std::vector<OpInfo::TensorProperties>> output_properties;
+  };
+  // The number of graphs remembered. The optimizers infer shapes with and
+  // without assuming valid feeds, so the results of both are kept.
+  static constexpr int kMaxEntries = 2;
+
+  // Most recently used first.
+  std::list<Entry> entries_;
+};
+
 // A TensorFlow model to optimize.
 // Models are represented by the combination of a graph, one of more fetch
 // nodes, and potentially a set of nodes to feed.
 class GraphProperties {
  public:
   explicit GraphProperties(const GrapplerItem& item) : item_(item) {}
+  // Reuses the properties found in "cache" for an identical graph, and adds
+  // the ones it infers statically to it. Does not take ownership of the cache,
+  // which may be null.
+  GraphProperties(const GrapplerItem& item, GraphPropertiesCache* cache)
+      : item_(item), cache_(cache) {}
 
   // Infer the shapes through abstract interpretation. Feed information can be
   // incorrect so it should be discarded to ensure correctness of the analysis.
@@ -120,8 +152,12 @@ class GraphProperties {
       const std::unordered_map<string, std::unordered_set<int>>& fed_ports,
       int num_loops) const;
 
+  // Infers the shapes statically, without looking them up in the cache.
+  Status InferStaticallyUncached(bool assume_valid_feeds);
+
   // Data members
   GrapplerItem item_;
+  GraphPropertiesCache* cache_ = nullptr;  // Not owned.
   std::map<string, std::vector<OpInfo::TensorProperties>> input_properties_;
   std::map<string, std::vector<OpInfo::TensorProperties>> output_properties_;
   const std::vector<OpInfo::TensorProperties> missing_properties_;
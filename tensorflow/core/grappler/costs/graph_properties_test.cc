@@ -113,6 +113,41 @@ TEST_F(GraphPropertiesTest, StaticProperties) {
   }
 }
 
+TEST_F(GraphPropertiesTest, Cache) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3}));
+  Output y = ops::Square(s.WithOpName("y"), x);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  GraphPropertiesCache cache;
+  GraphProperties properties(item, &cache);
+  TF_CHECK_OK(properties.InferStatically(false));
+  EXPECT_EQ("float: [2,3]",
+            PropToString(properties.GetOutputProperties("y").at(0)));
+
+  // The properties of the identical graph come from the cache.
+  GraphProperties cached_properties(item, &cache);
+  TF_CHECK_OK(cached_properties.InferStatically(false));
+  EXPECT_EQ("float: [2,3]",
+            PropToString(cached_properties.GetOutputProperties("y").at(0)));
+  EXPECT_EQ("float: [2,3]",
+            PropToString(cached_properties.GetInputProperties("y").at(0)));
+
+  // Changing the graph invalidates the cached properties.
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    if (node.name() == "x") {
+      TensorShapeProto* shape = (*node.mutable_attr())["shape"].mutable_shape();
+      shape->mutable_dim(1)->set_size(5);
+    }
+  }
+  GraphProperties new_properties(item, &cache);
+  TF_CHECK_OK(new_properties.InferStatically(false));
+  EXPECT_EQ("float: [2,5]",
+            PropToString(new_properties.GetOutputProperties("y").at(0)));
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
@@ -0,0 +1,56 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/measuring_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+
+Status CalibrateOpCosts(Cluster* cluster, const GrapplerItem& item,
+                        int measurement_steps,
+                        OpPerformanceList* calibration) {
+  if (!cluster->DetailedStatsEnabled()) {
+    return errors::FailedPrecondition(
+        "Calibrating the op costs requires the detailed stats of the cluster");
+  }
+  MeasuringCostEstimator estimator(cluster, measurement_steps,
+                                   /*measurement_threads=*/0);
+  TF_RETURN_IF_ERROR(estimator.Initialize(item));
+  CostGraphDef cost_graph;
+  Costs overall_cost;
+  TF_RETURN_IF_ERROR(
+      estimator.PredictCosts(item.graph, &cost_graph, &overall_cost));
+
+  OpPerformanceList measured =
+      CostGraphToOpPerformanceData(cost_graph, item.graph);
+  for (OpPerformance& perf : *measured.mutable_op_performance()) {
+    // Ops without a recorded compute cost, such as the feeds, tell nothing
+    // about the kernels.
+    if (perf.compute_cost() > 0) {
+      calibration->add_op_performance()->Swap(&perf);
+    }
+  }
+  return Status::OK();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,43 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+class Cluster;
+struct GrapplerItem;
+
+// Runs the graph of "item" on "cluster" for "measurement_steps" steps and
+// appends the execution time measured for each of its ops, along with their
+// shapes and device, to "calibration". Calling it for the items of a sweep
+// over ops, shapes and devices builds the table that CalibratedCostEstimator
+// interpolates from; the table can be saved with WriteBinaryProto.
+//
+// The detailed stats of the cluster must be enabled, since the per-op
+// timings come from the cost graph of the run.
+Status CalibrateOpCosts(Cluster* cluster, const GrapplerItem& item,
+                        int measurement_steps,
+                        OpPerformanceList* calibration);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
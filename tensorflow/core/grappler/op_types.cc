@@ -132,6 +132,8 @@ bool IsPlaceholder(const NodeDef& node) {
 
 bool IsRealDiv(const NodeDef& node) { return node.op() == "RealDiv"; }
 
+bool IsRelu(const NodeDef& node) { return node.op() == "Relu"; }
+
 bool IsReluGrad(const NodeDef& node) { return node.op() == "ReluGrad"; }
 
 bool IsRecv(const NodeDef& node) { return node.op() == "_Recv"; }
@@ -179,6 +181,8 @@ bool IsSwitch(const NodeDef& node) {
   return op == "Switch" || op == "RefSwitch";
 }
 
+bool IsTanh(const NodeDef& node) { return node.op() == "Tanh"; }
+
 bool IsTranspose(const NodeDef& node) { return node.op() == "Transpose"; }
 
 bool IsVariable(const NodeDef& node) {
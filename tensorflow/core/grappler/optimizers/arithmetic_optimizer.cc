@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -34,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/frame.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -335,10 +337,99 @@ NodeDef* GetTailOfValuePreservingChain(
                         is_value_preserving_non_branching);
 }
 
+// Returns "input", an input of a node of a function body or a return value
+// of the function, read from node "to" instead of "from" if it is read from
+// "from". Unlike the tensors of a graph, the tensors of a function body are
+// named "node:output_arg:index".
+string RenameFunctionInput(const string& input, const string& from,
+                           const string& to) {
+  const bool is_control = !input.empty() && input[0] == '^';
+  const size_t begin = is_control ? 1 : 0;
+  const size_t end = input.find(':');
+  const size_t length = end == string::npos ? string::npos : end - begin;
+  if (input.compare(begin, length, from) != 0) {
+    return input;
+  }
+  return StrCat(is_control ? "^" : "", to,
+                end == string::npos ? "" : input.substr(end));
+}
+
+void RenameFunctions(const std::unordered_map<string, string>& renames,
+                     NameAttrList* func);
+
+void RenameFunctions(const std::unordered_map<string, string>& renames,
+                     AttrValue* attr) {
+  if (attr->has_func()) {
+    RenameFunctions(renames, attr->mutable_func());
+  }
+  if (attr->has_list()) {
+    for (NameAttrList& func : *attr->mutable_list()->mutable_func()) {
+      RenameFunctions(renames, &func);
+    }
+  }
+}
+
+void RenameFunctions(const std::unordered_map<string, string>& renames,
+                     NameAttrList* func) {
+  auto it = renames.find(func->name());
+  if (it != renames.end()) {
+    func->set_name(it->second);
+  }
+  for (auto& attr : *func->mutable_attr()) {
+    RenameFunctions(renames, &attr.second);
+  }
+}
+
+// Makes "node" call, or take as attribute, the functions named by the values
+// of "renames" instead of the ones named by its keys.
+void RenameFunctions(const std::unordered_map<string, string>& renames,
+                     NodeDef* node) {
+  auto it = renames.find(node->op());
+  if (it != renames.end()) {
+    node->set_op(it->second);
+  }
+  for (auto& attr : *node->mutable_attr()) {
+    RenameFunctions(renames, &attr.second);
+  }
+}
+
+bool ReferencesFunctionNotIn(const std::unordered_set<string>& functions,
+                             const FunctionDefLibrary& library,
+                             const AttrValue& attr) {
+  auto is_excluded = [&functions, &library](const NameAttrList& func) {
+    if (functions.count(func.name()) > 0) {
+      return false;
+    }
+    for (const FunctionDef& function : library.function()) {
+      if (function.signature().name() == func.name()) {
+        return true;
+      }
+    }
+    return false;
+  };
+  if (attr.has_func() && is_excluded(attr.func())) {
+    return true;
+  }
+  if (attr.has_list()) {
+    for (const NameAttrList& func : attr.list().func()) {
+      if (is_excluded(func)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 class UniqueNodes {
  public:
+  UniqueNodes() : in_function_body_(false) {}
+  // The nodes of a function body name their inputs differently from the
+  // nodes of a graph.
+  explicit UniqueNodes(bool in_function_body)
+      : in_function_body_(in_function_body) {}
+
   NodeDef* FindOrAddRepresentative(NodeDef* node) {
     std::size_t sig = ComputeSignature(*node);
     std::vector<NodeDef*>& candidates = rep_[sig];
@@ -355,6 +446,7 @@ class UniqueNodes {
   std::size_t ComputeSignature(const NodeDef& node) const;
   bool SameNode(const NodeDef& node1, const NodeDef& node2) const;
 
+  const bool in_function_body_;
   std::unordered_map<std::size_t, std::vector<NodeDef*>> rep_;
 };
 
@@ -362,6 +454,10 @@ std::size_t UniqueNodes::ComputeSignature(const NodeDef& node) const {
   std::size_t h = std::hash<string>{}(node.op());
   h ^= std::hash<string>{}(node.device());
   for (const auto& input : node.input()) {
+    if (in_function_body_) {
+      h ^= std::hash<string>{}(input);
+      continue;
+    }
     int pos;
     string node_name = ParseNodeName(input, &pos);
     h ^= std::hash<string>{}(node_name);
@@ -473,7 +569,162 @@ bool ArithmeticOptimizer::CanDedup(const NodeDef& node) const {
   if (IsAssert(node)) {
     return true;
   }
-  return IsFreeOfSideEffect(node);
+  return IsFreeOfSideEffect(node) ||
+         side_effect_free_functions_.count(node.op()) > 0;
+}
+
+void ArithmeticOptimizer::DedupFunctionBodies() {
+  for (FunctionDef& func :
+       *optimized_graph_->mutable_library()->mutable_function()) {
+    bool stop = true;
+    std::set<int> duplicates;
+    do {
+      stop = true;
+      UniqueNodes nodes(/*in_function_body=*/true);
+      for (int i = 0; i < func.node_def_size(); ++i) {
+        if (duplicates.find(i) != duplicates.end()) {
+          continue;
+        }
+        NodeDef* node = func.mutable_node_def(i);
+        if (IsEnter(*node) || IsExit(*node) ||
+            (!IsAssert(*node) && !IsFreeOfSideEffect(*node) &&
+             side_effect_free_functions_.count(node->op()) == 0)) {
+          continue;
+        }
+        NodeDef* rep = nodes.FindOrAddRepresentative(node);
+        if (rep == node) {
+          continue;
+        }
+        for (NodeDef& other : *func.mutable_node_def()) {
+          for (string& input : *other.mutable_input()) {
+            input = RenameFunctionInput(input, node->name(), rep->name());
+          }
+        }
+        for (auto& ret : *func.mutable_ret()) {
+          ret.second = RenameFunctionInput(ret.second, node->name(),
+                                           rep->name());
+        }
+        duplicates.insert(i);
+        stop = false;
+      }
+    } while (!stop);
+
+    int last = func.node_def_size() - 1;
+    for (auto it = duplicates.rbegin(); it != duplicates.rend(); ++it) {
+      func.mutable_node_def()->SwapElements(*it, last);
+      last--;
+    }
+    func.mutable_node_def()->DeleteSubrange(last + 1, duplicates.size());
+  }
+}
+
+void ArithmeticOptimizer::DedupFunctions() {
+  FunctionDefLibrary* library = optimized_graph_->mutable_library();
+  std::unordered_map<string, string> renames;
+  bool stop = true;
+  do {
+    stop = true;
+    std::unordered_map<string, string> gradients;
+    for (const GradientDef& gradient : library->gradient()) {
+      gradients[gradient.function_name()] = gradient.gradient_func();
+    }
+    // Functions are identical if they only differ by their name, and have
+    // the same gradient function.
+    std::unordered_map<string, string> representatives;
+    std::unordered_map<string, string> new_renames;
+    for (const FunctionDef& func : library->function()) {
+      FunctionDef unnamed = func;
+      unnamed.mutable_signature()->clear_name();
+      string key;
+      SerializeToStringDeterministic(unnamed, &key);
+      strings::StrAppend(&key, gradients[func.signature().name()]);
+      auto it = representatives.emplace(key, func.signature().name()).first;
+      if (it->second != func.signature().name()) {
+        new_renames[func.signature().name()] = it->second;
+      }
+    }
+    if (new_renames.empty()) {
+      break;
+    }
+    stop = false;
+
+    // Renaming the calls may make more function bodies identical.
+    for (FunctionDef& func : *library->mutable_function()) {
+      for (NodeDef& node : *func.mutable_node_def()) {
+        RenameFunctions(new_renames, &node);
+      }
+    }
+    for (GradientDef& gradient : *library->mutable_gradient()) {
+      auto it = new_renames.find(gradient.gradient_func());
+      if (it != new_renames.end()) {
+        gradient.set_gradient_func(it->second);
+      }
+    }
+    FunctionDefLibrary deduped;
+    for (FunctionDef& func : *library->mutable_function()) {
+      if (new_renames.count(func.signature().name()) == 0) {
+        deduped.add_function()->Swap(&func);
+      }
+    }
+    for (GradientDef& gradient : *library->mutable_gradient()) {
+      if (new_renames.count(gradient.function_name()) == 0) {
+        deduped.add_gradient()->Swap(&gradient);
+      }
+    }
+    library->Swap(&deduped);
+    for (auto& rename : renames) {
+      auto it = new_renames.find(rename.second);
+      if (it != new_renames.end()) {
+        rename.second = it->second;
+      }
+    }
+    renames.insert(new_renames.begin(), new_renames.end());
+  } while (!stop);
+
+  if (renames.empty()) {
+    return;
+  }
+  VLOG(1) << "Replaced " << renames.size() << " duplicate functions";
+  for (NodeDef& node : *optimized_graph_->mutable_node()) {
+    RenameFunctions(renames, &node);
+  }
+}
+
+void ArithmeticOptimizer::FindSideEffectFreeFunctions() {
+  const FunctionDefLibrary& library = optimized_graph_->library();
+  side_effect_free_functions_.clear();
+  // A function is free of side effects if the nodes of its body are, whether
+  // they are ops or calls of other functions. Recursive functions are
+  // conservatively assumed to have side effects.
+  bool stop = true;
+  do {
+    stop = true;
+    for (const FunctionDef& func : library.function()) {
+      if (side_effect_free_functions_.count(func.signature().name()) > 0) {
+        continue;
+      }
+      bool free_of_side_effect = true;
+      for (const NodeDef& node : func.node_def()) {
+        if (!IsFreeOfSideEffect(node) &&
+            side_effect_free_functions_.count(node.op()) == 0) {
+          free_of_side_effect = false;
+        }
+        for (const auto& attr : node.attr()) {
+          if (ReferencesFunctionNotIn(side_effect_free_functions_, library,
+                                      attr.second)) {
+            free_of_side_effect = false;
+          }
+        }
+        if (!free_of_side_effect) {
+          break;
+        }
+      }
+      if (free_of_side_effect) {
+        side_effect_free_functions_.insert(func.signature().name());
+        stop = false;
+      }
+    }
+  } while (!stop);
 }
 
 void ArithmeticOptimizer::DedupComputations() {
@@ -1111,13 +1362,19 @@ Status ArithmeticOptimizer::Optimize(Cluster* /*cluster*/,
                                                &frame_map_, &num_frames));
   // Shapes are only needed in aggressive mode.
   if (opt_level_ == RewriterConfig::AGGRESSIVE) {
-    graph_properties_.reset(new GraphProperties(item));
+    graph_properties_.reset(new GraphProperties(item, properties_cache()));
     TF_RETURN_IF_ERROR(graph_properties_->InferStatically(false));
     TF_RETURN_IF_ERROR(
         graph_properties_->AnnotateOutputShapes(optimized_graph_));
   }
 
   // Perform the optimizations.
+  FindSideEffectFreeFunctions();
+  if (optimized_graph_->library().function_size() > 0) {
+    DedupFunctionBodies();
+    DedupFunctions();
+    FindSideEffectFreeFunctions();
+  }
   DedupComputations();
   TF_RETURN_IF_ERROR(SimplifyArithmeticOps());
 
@@ -61,6 +61,18 @@ class ArithmeticOptimizer : public GraphOptimizer {
   // Dedup redundant nodes in the graph.
   void DedupComputations();
 
+  // Dedup redundant nodes in the bodies of the functions of the library.
+  void DedupFunctionBodies();
+
+  // Replaces the functions of the library whose definition is identical to
+  // the one of another function with that function, so that the calls of
+  // either function can be dedupped.
+  void DedupFunctions();
+
+  // Finds the functions of the library whose bodies are free of side effects,
+  // and whose calls can thus be dedupped.
+  void FindSideEffectFreeFunctions();
+
   // Fix frame dependencies by adding control dependencies from old_input to
   // nodes in new_nodes_for_control_dep, and update frame_map for all nodes in
   // new_nodes.
@@ -94,6 +106,7 @@ class ArithmeticOptimizer : public GraphOptimizer {
 
   bool fetch_nodes_known_;
   std::unordered_set<string> nodes_to_preserve_;
+  std::unordered_set<string> side_effect_free_functions_;
   std::unique_ptr<NodeMap> node_map_;
   FrameMap frame_map_;
   std::unique_ptr<GraphProperties> graph_properties_;
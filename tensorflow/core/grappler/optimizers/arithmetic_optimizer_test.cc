@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
@@ -160,6 +162,55 @@ TEST_F(ArithmeticOptimizerTest, OpDedupCommutative) {
   EXPECT_EQ("mul1", new_div1.input(1));
 }
 
+TEST_F(ArithmeticOptimizerTest, OpDedupFunctions) {
+  typedef FunctionDefHelper FDH;
+  // "b" computes the same value as "a".
+  FunctionDef f1 = FDH::Define(
+      "F1", {"x: float"}, {"y: float"}, {},
+      {{{"two"},
+        "Const",
+        {},
+        {{"value", test::AsScalar<float>(2)}, {"dtype", DT_FLOAT}}},
+       {{"a"}, "Mul", {"x", "two"}, {{"T", DT_FLOAT}}},
+       {{"b"}, "Mul", {"x", "two"}, {{"T", DT_FLOAT}}},
+       {{"y"}, "Sub", {"a", "b"}, {{"T", DT_FLOAT}}}});
+  FunctionDef f2 = f1;
+  f2.mutable_signature()->set_name("F2");
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {test::function::NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       test::function::NDef("call1", "F1", {"x"}, {}),
+       test::function::NDef("call2", "F2", {"x"}, {}),
+       test::function::NDef("id1", "Identity", {"call1"}, {{"T", DT_FLOAT}}),
+       test::function::NDef("id2", "Identity", {"call2"}, {{"T", DT_FLOAT}})},
+      {f1, f2});
+  item.fetch = {"id1", "id2"};
+
+  ArithmeticOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_EQ(1, output.library().function_size());
+  const FunctionDef& func = output.library().function(0);
+  EXPECT_EQ("F1", func.signature().name());
+  ASSERT_EQ(3, func.node_def_size());
+  const NodeDef& sub = func.node_def(2);
+  EXPECT_EQ("y", sub.name());
+  EXPECT_EQ("a:z:0", sub.input(0));
+  EXPECT_EQ("a:z:0", sub.input(1));
+
+  EXPECT_EQ(4, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE("call2", node.name());
+    if (node.name() == "call1") {
+      EXPECT_EQ("F1", node.op());
+    } else if (node.name() == "id1" || node.name() == "id2") {
+      EXPECT_EQ("call1", node.input(0));
+    }
+  }
+}
+
 TEST_F(ArithmeticOptimizerTest, MulToSquare) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output c = ops::Const(s.WithOpName("c"), {1.0f, 2.0f}, {1, 2});
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
@@ -61,6 +62,29 @@ NodeDef* AutoParallel::AddNodeDiv(const string& name, const string& input_a,
   return node;
 }
 
+NodeDef* AutoParallel::AddNodeAllReduce(const string& name,
+                                        const string& input) {
+  NodeDef* node = graph_.add_node();
+  node->set_name(strings::StrCat(kAutoParallelPrefix, "-AllReduce-", name));
+  node->set_op("NcclAllReduce");
+  node->add_input(input);
+  AttrValue attr_type;
+  attr_type.set_type(DT_FLOAT);
+  node->mutable_attr()->insert({"T", attr_type});
+  AttrValue attr_reduction;
+  attr_reduction.set_s("sum");
+  node->mutable_attr()->insert({"reduction", attr_reduction});
+  AttrValue attr_num_devices;
+  attr_num_devices.set_i(num_replicas_);
+  node->mutable_attr()->insert({"num_devices", attr_num_devices});
+  // Every replica copies the attributes unchanged, so the copies of this node
+  // join the same reduction.
+  AttrValue attr_shared_name;
+  attr_shared_name.set_s(node->name());
+  node->mutable_attr()->insert({"shared_name", attr_shared_name});
+  return node;
+}
+
 NodeDef* AutoParallel::AddNodeControl(const string& name,
                                       const std::set<string>& deps,
                                       GraphDef* graph) {
@@ -73,9 +97,23 @@ NodeDef* AutoParallel::AddNodeControl(const string& name,
   return node;
 }
 
-Status AutoParallel::Initialize(const GrapplerItem& item) {
-  num_gpus_ = GetNumAvailableGPUs();
+Status AutoParallel::Initialize(Cluster* cluster, const GrapplerItem& item) {
+  if (cluster) {
+    num_gpus_ = 0;
+    for (const auto& device : cluster->GetDevices()) {
+      if (device.second.type() == "GPU") {
+        num_gpus_++;
+      }
+    }
+  } else {
+    num_gpus_ = GetNumAvailableGPUs();
+  }
   LOG(INFO) << "Number of GPUs: " << num_gpus_;
+  if (use_nccl_ && num_gpus_ < num_replicas_) {
+    return errors::InvalidArgument(
+        "NCCL all-reduce needs one GPU per replica, but only ", num_gpus_,
+        " GPUs are available for ", num_replicas_, " replicas.");
+  }
   item_ = &item;
   graph_ = item.graph;
   LOG(INFO) << "Original graph size: " << graph_.node_size();
@@ -137,10 +175,19 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
     auto apply_gradients_op = all_nodes_[apply_gradient_node_name]->op();
     auto apply_gradients_node = all_nodes_[apply_gradient_node_name];
 
-    auto div_node = AddNodeDiv(
-        apply_gradient_node_name,
-        apply_gradients_node->input(gradient_pos[apply_gradients_op]),
-        div_const_node->name());
+    string gradient =
+        apply_gradients_node->input(gradient_pos[apply_gradients_op]);
+    if (use_nccl_) {
+      // Each gradient is reduced on its own as soon as the backprop produces
+      // it, so the reductions overlap with the rest of the backprop.
+      auto all_reduce_node =
+          AddNodeAllReduce(apply_gradient_node_name, gradient);
+      all_nodes_.insert(
+          std::make_pair(all_reduce_node->name(), all_reduce_node));
+      gradient = all_reduce_node->name();
+    }
+    auto div_node =
+        AddNodeDiv(apply_gradient_node_name, gradient, div_const_node->name());
     all_nodes_.insert(std::make_pair(div_node->name(), div_node));
     *apply_gradients_node->mutable_input(gradient_pos[apply_gradients_op]) =
         div_node->name();
@@ -166,8 +213,11 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
   LOG(INFO) << "Number of input nodes: " << input_nodes.size();
 
   std::set<string> dont_replicate_nodes;
-  for (const auto& variable : item.MainVariables()) {
-    dont_replicate_nodes.insert(variable->name());
+  // Mirrored variables are replicated along with the nodes that train them.
+  if (!use_nccl_) {
+    for (const auto& variable : item.MainVariables()) {
+      dont_replicate_nodes.insert(variable->name());
+    }
   }
 
   for (const auto& init : item.init_ops) {
@@ -194,6 +244,21 @@ Status AutoParallel::Initialize(const GrapplerItem& item) {
     }
   }
   LOG(INFO) << "Number of shared nodes: " << shared_nodes_.size();
+
+  // The initializers and restores of a mirrored variable assign the same
+  // value to every copy of the variable.
+  for (const auto& node : shared_nodes_) {
+    const NodeDef* assign = all_nodes_[node];
+    if (assign->op() == "Assign" && assign->input_size() > 0 &&
+        NotSharedNode(NodeName(assign->input(0)))) {
+      const NodeDef* variable = all_nodes_[NodeName(assign->input(0))];
+      if (variable != nullptr && IsVariable(*variable)) {
+        mirrored_assign_nodes_.insert(node);
+      }
+    }
+  }
+  LOG(INFO) << "Number of mirrored assign nodes: "
+            << mirrored_assign_nodes_.size();
   return Status::OK();
 }
 
@@ -212,6 +277,14 @@ void AutoParallel::AddSharedNodes(GraphDef* graph) {
         *new_node->mutable_input(i) = new_name;
       }
     }
+    if (mirrored_assign_nodes_.find(node) != mirrored_assign_nodes_.end()) {
+      for (int i = 1; i < num_replicas_; i++) {
+        string mirror_prefix =
+            strings::StrCat(kAutoParallelPrefix, "-Replica-", i);
+        new_node->add_input(
+            AddPrefixToNodeName(strings::StrCat("^", node), mirror_prefix));
+      }
+    }
   }
 }
 
@@ -233,6 +306,29 @@ void AutoParallel::AddOneReplica(GraphDef* graph, int number) {
       }
     }
   }
+  if (number == 0) {
+    return;
+  }
+  // The copies of the assigns of the other replicas read the same value as
+  // the shared assign, which runs after them.
+  string shared_prefix = strings::StrCat(kAutoParallelPrefix, "-Replica-", 0);
+  for (const auto& node : mirrored_assign_nodes_) {
+    auto new_node = graph->add_node();
+    *new_node = *all_nodes_[node];
+    new_node->set_name(AddPrefixToNodeName(new_node->name(), prefix));
+    if (num_gpus_ > 0) {
+      new_node->set_device(strings::StrCat("/gpu:", number % num_gpus_));
+    }
+    *new_node->mutable_input(0) =
+        AddPrefixToNodeName(new_node->input(0), prefix);
+    for (int i = 1; i < new_node->input_size(); i++) {
+      if (NotSharedNode(NodeName(new_node->input(i)))) {
+        string new_name =
+            AddPrefixToNodeName(new_node->input(i), shared_prefix);
+        *new_node->mutable_input(i) = new_name;
+      }
+    }
+  }
 }
 
 void AutoParallel::BuildGraph(GraphDef* graph) {
@@ -262,7 +358,7 @@ void AutoParallel::BuildGraph(GraphDef* graph) {
 
 Status AutoParallel::Optimize(Cluster* cluster, const GrapplerItem& item,
                               GraphDef* output) {
-  TF_RETURN_IF_ERROR(Initialize(item));
+  TF_RETURN_IF_ERROR(Initialize(cluster, item));
   BuildGraph(output);
   return Status::OK();
 }
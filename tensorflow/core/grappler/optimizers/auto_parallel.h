@@ -24,9 +24,16 @@ namespace tensorflow {
 namespace grappler {
 
 // Automatically parallelize a graph by splitting in the batch dimension.
+//
+// By default the replicas share the variables, and each of them applies its
+// share of the gradients. With 'use_nccl', every replica runs on its own GPU
+// with its own copy of the variables, the gradients are averaged across the
+// replicas with NcclAllReduce, and every replica applies the average to its
+// copy. The graph must then be run with the NCCL ops registered.
 class AutoParallel : public GraphOptimizer {
  public:
-  AutoParallel(int num_replicas) : num_replicas_(num_replicas) {
+  AutoParallel(int num_replicas, bool use_nccl = false)
+      : num_replicas_(num_replicas), use_nccl_(use_nccl) {
     CHECK(num_replicas_ >= 2);
   }
   ~AutoParallel() override {}
@@ -45,13 +52,17 @@ class AutoParallel : public GraphOptimizer {
   std::set<string> apply_gradients_nodes_;
   std::set<string> replica_nodes_;
   std::set<string> shared_nodes_;
+  // The shared nodes that assign to a variable mirrored on every replica.
+  std::set<string> mirrored_assign_nodes_;
   const GrapplerItem* item_;
   int num_replicas_;
+  bool use_nccl_;
   int num_gpus_;
-  Status Initialize(const GrapplerItem& item);
+  Status Initialize(Cluster* cluster, const GrapplerItem& item);
   NodeDef* AddNodeDivConst();
   NodeDef* AddNodeDiv(const string& name, const string& input_a,
                       const string& input_b);
+  NodeDef* AddNodeAllReduce(const string& name, const string& input);
   NodeDef* AddNodeControl(const string& name, const std::set<string>& deps,
                           GraphDef* graph);
   bool NotSharedNode(const string& name);
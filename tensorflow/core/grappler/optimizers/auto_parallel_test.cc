@@ -16,9 +16,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -126,6 +128,108 @@ TEST_F(AutoParallelTest, SimpleParallel) {
   EXPECT_EQ("^AutoParallel-Control-Fetch", node_gradient.input(0));
 }
 
+// Builds the training graph of SimpleParallel.
+GrapplerItem CreateTrainingItem() {
+  tensorflow::Scope s = tensorflow::Scope::DisabledShapeInferenceScope();
+  Output constant_a = ops::Const(s.WithOpName("constant_a"), 1.0f, {1});
+  Output constant_b = ops::Const(s.WithOpName("constant_b"), 1, {1});
+  Output var = ops::Variable(s.WithOpName("var"), {1}, DT_FLOAT);
+  Output assign = ops::Assign(s.WithOpName("assign"), {var}, {constant_a});
+  Output fifo_queue = ops::FIFOQueue(s.WithOpName("fifo_queue"), {DT_FLOAT});
+  auto dequeue = ops::QueueDequeueMany(s.WithOpName("dequeue"), {fifo_queue},
+                                       {constant_b}, {DT_FLOAT});
+  Output add = ops::AddN(s.WithOpName("add"), {constant_a, dequeue[0]});
+  Output learning_rate = ops::Const(s.WithOpName("learning_rate"), 0.01f, {1});
+  Output apply_gradient = ops::ApplyGradientDescent(
+      s.WithOpName("apply_gradient"), {var}, {learning_rate}, {add});
+
+  GrapplerItem item;
+  item.init_ops.push_back("assign");
+  item.fetch.push_back("apply_gradient");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  return item;
+}
+
+std::unique_ptr<VirtualCluster> CreateCluster(int num_gpus) {
+  std::unordered_map<string, DeviceProperties> devices;
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  for (int i = 0; i < num_gpus; i++) {
+    devices[strings::StrCat("/job:localhost/replica:0/task:0/device:GPU:",
+                            i)] = gpu_device;
+  }
+  return std::unique_ptr<VirtualCluster>(new VirtualCluster(devices));
+}
+
+TEST_F(AutoParallelTest, NcclAllReduce) {
+  GrapplerItem item = CreateTrainingItem();
+  std::unique_ptr<VirtualCluster> cluster = CreateCluster(2);
+
+  AutoParallel parallel(2, true /* use_nccl */);
+  GraphDef output;
+  TF_EXPECT_OK(parallel.Optimize(cluster.get(), item, &output));
+
+  std::map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : output.node()) {
+    nodes[node.name()] = &node;
+  }
+  EXPECT_EQ(0, nodes.count("var"));
+  for (int i = 0; i < 2; i++) {
+    const string prefix = strings::StrCat("AutoParallel-Replica-", i, "/");
+
+    // Every replica has its own copy of the variable on its own GPU.
+    ASSERT_EQ(1, nodes.count(prefix + "var"));
+    EXPECT_EQ(strings::StrCat("/gpu:", i), nodes[prefix + "var"]->device());
+
+    const NodeDef* all_reduce =
+        nodes[prefix + "AutoParallel-AllReduce-apply_gradient"];
+    ASSERT_NE(nullptr, all_reduce);
+    EXPECT_EQ("NcclAllReduce", all_reduce->op());
+    EXPECT_EQ(prefix + "add", all_reduce->input(0));
+    EXPECT_EQ("sum", all_reduce->attr().at("reduction").s());
+    EXPECT_EQ(2, all_reduce->attr().at("num_devices").i());
+    EXPECT_EQ("AutoParallel-AllReduce-apply_gradient",
+              all_reduce->attr().at("shared_name").s());
+
+    const NodeDef* div = nodes[prefix + "AutoParallel-Div-apply_gradient"];
+    ASSERT_NE(nullptr, div);
+    EXPECT_EQ(all_reduce->name(), div->input(0));
+
+    const NodeDef* apply_gradient = nodes[prefix + "apply_gradient"];
+    ASSERT_NE(nullptr, apply_gradient);
+    EXPECT_EQ(prefix + "var", apply_gradient->input(0));
+    EXPECT_EQ(div->name(), apply_gradient->input(2));
+  }
+
+  // The initializer of the variable also initializes its other copy with the
+  // same value.
+  const NodeDef* assign = nodes["assign"];
+  ASSERT_NE(nullptr, assign);
+  ASSERT_EQ(3, assign->input_size());
+  EXPECT_EQ("AutoParallel-Replica-0/var", assign->input(0));
+  EXPECT_EQ("AutoParallel-Replica-0/constant_a", assign->input(1));
+  EXPECT_EQ("^AutoParallel-Replica-1/assign", assign->input(2));
+
+  const NodeDef* mirror_assign = nodes["AutoParallel-Replica-1/assign"];
+  ASSERT_NE(nullptr, mirror_assign);
+  ASSERT_EQ(2, mirror_assign->input_size());
+  EXPECT_EQ("AutoParallel-Replica-1/var", mirror_assign->input(0));
+  EXPECT_EQ("AutoParallel-Replica-0/constant_a", mirror_assign->input(1));
+}
+
+TEST_F(AutoParallelTest, NcclAllReduceNeedsOneGpuPerReplica) {
+  GrapplerItem item = CreateTrainingItem();
+  std::unique_ptr<VirtualCluster> cluster = CreateCluster(1);
+
+  AutoParallel parallel(2, true /* use_nccl */);
+  GraphDef output;
+  Status status = parallel.Optimize(cluster.get(), item, &output);
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
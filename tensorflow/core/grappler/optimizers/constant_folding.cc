@@ -131,11 +131,18 @@ bool AllValuesAre(const TensorProto& tensor, const T& value) {
 }  // namespace
 
 ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
-                                 DeviceBase* cpu_device)
-    : opt_level_(opt_level), cpu_device_(cpu_device) {
+                                 DeviceBase* cpu_device,
+                                 int64 max_constant_size_bytes)
+    : opt_level_(opt_level),
+      cpu_device_(cpu_device),
+      max_constant_size_bytes_(max_constant_size_bytes) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
+ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
+                                 DeviceBase* cpu_device)
+    : ConstantFolding(opt_level, cpu_device, kDefaultMaxConstantSizeBytes) {}
+
 ConstantFolding::ConstantFolding(DeviceBase* cpu_device)
     : ConstantFolding(RewriterConfig::ON, cpu_device) {}
 
@@ -854,6 +861,15 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     return Status(error::INVALID_ARGUMENT, "Expected at least one output.");
   }
 
+  for (const auto& output : output_tensors) {
+    if (output.tensor && output->TotalBytes() > max_constant_size_bytes_) {
+      return errors::InvalidArgument(
+          "Can't fold ", node.name(), ", its output is ",
+          output->TotalBytes(), " bytes, more than the limit of ",
+          max_constant_size_bytes_, " bytes");
+    }
+  }
+
   for (size_t i = 0; i < output_tensors.size(); i++) {
     string node_name = OptimizedNodeName(node, "");
     if (output_tensors.size() > 1) {
@@ -870,7 +886,9 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
   return Status::OK();
 }
 
-Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
+Status ConstantFolding::FoldNode(NodeDef* node,
+                                 std::vector<NodeDef>* const_nodes,
+                                 GraphDef* output_graph) {
   if (IsMerge(*node)) {
     // Merge nodes are special, in the sense that they execute as soon as one of
     // their input is ready. We can therefore fold a merge node iff it has at
@@ -962,11 +980,9 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
     return Status::OK();
   }
 
-  std::vector<NodeDef> const_nodes;
-  TF_RETURN_IF_ERROR(EvaluateOneFoldable(*node, &const_nodes));
   NodeDef* constant_output = nullptr;
-  for (int i = 0; i < const_nodes.size(); i++) {
-    NodeDef* const_node = &const_nodes[i];
+  for (int i = 0; i < const_nodes->size(); i++) {
+    NodeDef* const_node = &(*const_nodes)[i];
     if (const_node->name().empty()) {
       // Dead output: we can't create a constant to encode its value, so we'll
       // just skip it. We'll preserve the edges that originate from that
@@ -995,7 +1011,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
 
     // We rewrite the existing node if it only has a single output, and
     // create new nodes otherwise.
-    if (const_nodes.size() == 1) {
+    if (const_nodes->size() == 1) {
       node->set_op("Const");
       // Note we need to clear the inputs in NodeMap before we clear the inputs
       // in the node, otherwise NodeMap would see empty inputs and effectively
@@ -1028,7 +1044,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
     }
   }
 
-  if (const_nodes.size() > 1) {
+  if (const_nodes->size() > 1) {
     auto outputs = node_map_->GetOutputs(node->name());
     for (const auto& output : outputs) {
       for (int i = 0; i < output->input_size(); i++) {
@@ -1043,12 +1059,12 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph) {
                                      constant_output->name());
               *output->mutable_input(i) = AsControlDependency(*constant_output);
             }
-          } else if (port < const_nodes.size() &&
-                     !const_nodes[port].name().empty()) {
+          } else if (port < const_nodes->size() &&
+                     !(*const_nodes)[port].name().empty()) {
             // Replace alive outputs with the corresponding constant.
             node_map_->UpdateInput(output->name(), NodeName(output->input(i)),
-                                   const_nodes[port].name());
-            *output->mutable_input(i) = const_nodes[port].name();
+                                   (*const_nodes)[port].name());
+            *output->mutable_input(i) = (*const_nodes)[port].name();
           } else {
             // Leave this edge alone.
             VLOG(1) << "Preserving edge from " << node->name() << ":" << port
@@ -1078,22 +1094,55 @@ Status ConstantFolding::FoldGraph(GraphDef* output) {
     }
   }
   while (!queue.empty()) {
-    NodeDef* node = queue.front();
-    queue.pop_front();
-    if (processed_nodes.count(node->name())) {
-      continue;
+    // All the queued nodes only depend on constants, so they can be evaluated
+    // independently of each other. Merge nodes are folded without being
+    // evaluated.
+    std::vector<NodeDef*> nodes;
+    std::unordered_set<NodeDef*> queued;
+    for (NodeDef* node : queue) {
+      if (processed_nodes.count(node->name()) == 0 &&
+          queued.insert(node).second) {
+        nodes.push_back(node);
+      }
     }
-    // We need to record a copy of output nodes before FoldNode() modifies it.
-    std::set<NodeDef*> outputs = node_map_->GetOutputs(node->name());
-
-    Status s = FoldNode(node, output);
-    processed_nodes.insert(node->name());
-    if (!s.ok()) {
-      VLOG(1) << "Failed to fold node " << node->name() << ": " << s;
+    queue.clear();
+
+    std::vector<std::vector<NodeDef>> const_nodes(nodes.size());
+    std::vector<Status> statuses(nodes.size());
+    auto evaluate = [this, &nodes, &const_nodes, &statuses](int64 begin,
+                                                            int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        if (!IsMerge(*nodes[i])) {
+          statuses[i] = EvaluateOneFoldable(*nodes[i], &const_nodes[i]);
+        }
+      }
+    };
+    if (thread_pool_ != nullptr && nodes.size() > 1) {
+      // Evaluating a node costs far more than scheduling it.
+      const int64 kCostPerNode = 100000;
+      thread_pool_->ParallelFor(nodes.size(), kCostPerNode, evaluate);
     } else {
-      for (auto& output : outputs) {
-        if (IsFoldable(*output)) {
-          queue.push_back(output);
+      evaluate(0, nodes.size());
+    }
+
+    for (int i = 0; i < nodes.size(); ++i) {
+      NodeDef* node = nodes[i];
+      // We need to record a copy of output nodes before FoldNode() modifies
+      // it.
+      std::set<NodeDef*> outputs = node_map_->GetOutputs(node->name());
+
+      Status s = statuses[i];
+      if (s.ok()) {
+        s = FoldNode(node, &const_nodes[i], output);
+      }
+      processed_nodes.insert(node->name());
+      if (!s.ok()) {
+        VLOG(1) << "Failed to fold node " << node->name() << ": " << s;
+      } else {
+        for (auto& output : outputs) {
+          if (IsFoldable(*output)) {
+            queue.push_back(output);
+          }
         }
       }
     }
@@ -1553,7 +1602,7 @@ Status ConstantFolding::RunOptimizationPass(Cluster* cluster,
     }
   }
 
-  GraphProperties properties(item);
+  GraphProperties properties(item, properties_cache());
   // It's possible to feed a placeholder with a tensor of any shape: make sure
   // that the shape inference deals with this conservatively unless we're in
   // aggressive mode.
@@ -1583,6 +1632,11 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
     owned_device_.reset(new DeviceSimple());
     cpu_device_ = owned_device_.get();
   }
+  const int num_threads = port::NumSchedulableCPUs();
+  if (thread_pool_ == nullptr && num_threads > 1) {
+    thread_pool_.reset(new thread::ThreadPool(
+        Env::Default(), "constant_folding", num_threads));
+  }
 
   has_fetch_ = !item.fetch.empty();
 
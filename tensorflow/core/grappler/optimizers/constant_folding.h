@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
 namespace tensorflow {
@@ -29,8 +30,13 @@ namespace grappler {
 
 const char kConstantFoldingConst[] = "ConstantFolding";
 const char kConstantFoldingCtrl[] = "ConstantFoldingCtrl";
+// The default size limit of the constants created by folding.
+const int64 kDefaultMaxConstantSizeBytes = 10 * 1024 * 1024;
 
-// Constant folding optimization for a graph.
+// Constant folding optimization for a graph. The nodes that can be folded
+// at the same time, since they only depend on constants, are evaluated in
+// parallel. Nodes whose outputs would be larger than max_constant_size_bytes
+// are not folded, to keep the graph and the memory used at startup small.
 class ConstantFolding : public GraphOptimizer {
  public:
   static NodeDef CreateNodeDef(const string& name, const TensorValue& tensor);
@@ -39,6 +45,8 @@ class ConstantFolding : public GraphOptimizer {
 
   ConstantFolding(DeviceBase* cpu_device);
   ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device);
+  ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device,
+                  int64 max_constant_size_bytes);
 
   ~ConstantFolding() override {}
 
@@ -74,7 +82,11 @@ class ConstantFolding : public GraphOptimizer {
   Status EvaluateOneFoldable(const NodeDef& node,
                              std::vector<NodeDef>* outputs);
 
-  Status FoldNode(NodeDef* node, GraphDef* output_graph);
+  // Replaces "node" with the constants that EvaluateOneFoldable computed for
+  // its outputs. Merge nodes are folded without being evaluated, so their
+  // const_nodes are ignored.
+  Status FoldNode(NodeDef* node, std::vector<NodeDef>* const_nodes,
+                  GraphDef* output_graph);
 
   bool IsOnes(const NodeDef& node) const;
   bool IsZeros(const NodeDef& node) const;
@@ -98,6 +110,9 @@ class ConstantFolding : public GraphOptimizer {
   RewriterConfig::Toggle opt_level_;
   DeviceBase* cpu_device_;
   std::unique_ptr<DeviceBase> owned_device_;
+  const int64 max_constant_size_bytes_;
+  // Evaluates the foldable nodes in parallel. Null on single core machines.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
 
   std::unique_ptr<ResourceMgr> resource_mgr_;
   GraphDef* graph_;
@@ -77,6 +77,36 @@ TEST_F(ConstantFoldingTest, SimpleFolding) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, MaxConstantSize) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output value = ops::Const(s.WithOpName("value"), 1.0f);
+  Output small_dims = ops::Const(s.WithOpName("small_dims"), {2, 2});
+  Output large_dims = ops::Const(s.WithOpName("large_dims"), {256, 256});
+  Output small = ops::Fill(s.WithOpName("small"), small_dims, value);
+  Output large = ops::Fill(s.WithOpName("large"), large_dims, value);
+
+  GrapplerItem item;
+  item.fetch = {"small", "large"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  // The large fill would create a 256KB constant.
+  ConstantFolding fold(RewriterConfig::ON, nullptr /* cpu_device */, 1024);
+  GraphDef output;
+  TF_EXPECT_OK(fold.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "small") {
+      EXPECT_EQ("Const", node.op());
+      ++found;
+    } else if (node.name() == "large") {
+      EXPECT_EQ("Fill", node.op());
+      ++found;
+    }
+  }
+  EXPECT_EQ(2, found);
+}
+
 TEST_F(ConstantFoldingTest, AddTree) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
 
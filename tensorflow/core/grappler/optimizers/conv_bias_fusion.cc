@@ -0,0 +1,191 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/conv_bias_fusion.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Returns true if "node" has the attribute "name" set to "value", or doesn't
+// have it at all.
+bool HasStringAttrOrDefault(const NodeDef& node, const string& name,
+                            const string& value) {
+  auto it = node.attr().find(name);
+  return it == node.attr().end() || it->second.s() == value;
+}
+
+// Returns true if "node" runs on CPU, where FusedConv2DWithBias has its only
+// kernel. A node without a device only runs on CPU if the cluster has no GPU.
+bool RunsOnCpu(const NodeDef& node, bool has_gpu) {
+  if (node.device().empty()) {
+    return !has_gpu;
+  }
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(node.device(), &parsed) &&
+         parsed.has_type && parsed.type == DEVICE_CPU;
+}
+
+// Returns true if "conv" is a Conv2D that FusedConv2DWithBias can compute.
+bool IsFusableConv(const NodeDef& conv, bool has_gpu) {
+  if (conv.op() != "Conv2D" || NumNonControlInputs(conv) != 2) {
+    return false;
+  }
+  const DataType type = conv.attr().at("T").type();
+  if ((type != DT_FLOAT && type != DT_DOUBLE) ||
+      !HasStringAttrOrDefault(conv, "data_format", "NHWC") ||
+      !RunsOnCpu(conv, has_gpu)) {
+    return false;
+  }
+  auto dilations = conv.attr().find("dilations");
+  if (dilations != conv.attr().end()) {
+    for (int64 dilation : dilations->second.list().i()) {
+      if (dilation != 1) {
+        return false;
+      }
+    }
+  }
+  const auto& strides = conv.attr().at("strides").list();
+  return strides.i_size() == 4 && strides.i(0) == 1 && strides.i(3) == 1;
+}
+
+// Returns true if "node" is the only consumer of the output of "producer",
+// which is read once.
+bool IsOnlyConsumer(const NodeDef& node, const NodeDef& producer,
+                    const NodeMap& node_map) {
+  return NodeName(node.input(0)) == producer.name() &&
+         NodePosition(node.input(0)) == 0 &&
+         node_map.GetOutputs(producer.name()).size() == 1 &&
+         NumNonControlOutputs(producer, node_map) == 1;
+}
+
+// Returns the fused node that replaces "conv", "bias_add" and, if it isn't
+// null, "activation".
+NodeDef FuseConvBias(const NodeDef& conv, const NodeDef& bias_add,
+                     const NodeDef* activation) {
+  NodeDef fused;
+  fused.set_name(activation ? activation->name() : bias_add.name());
+  fused.set_op("FusedConv2DWithBias");
+  fused.set_device(conv.device());
+  fused.add_input(conv.input(0));
+  fused.add_input(conv.input(1));
+  fused.add_input(bias_add.input(1));
+  (*fused.mutable_attr())["T"] = conv.attr().at("T");
+  (*fused.mutable_attr())["strides"] = conv.attr().at("strides");
+  (*fused.mutable_attr())["padding"] = conv.attr().at("padding");
+  (*fused.mutable_attr())["activation"].set_s(activation ? activation->op()
+                                                         : "Identity");
+  for (const NodeDef* node : {&conv, &bias_add, activation}) {
+    if (node == nullptr) {
+      continue;
+    }
+    for (int i = NumNonControlInputs(*node); i < node->input_size(); ++i) {
+      fused.add_input(node->input(i));
+    }
+  }
+  return fused;
+}
+
+}  // namespace
+
+Status ConvBiasFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  bool has_gpu = false;
+  if (cluster != nullptr) {
+    for (const auto& device : cluster->GetDevices()) {
+      if (device.second.type() == "GPU") {
+        has_gpu = true;
+      }
+    }
+  }
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  std::unordered_map<string, NodeDef> fused_nodes;
+  std::unordered_set<string> fused_away;
+  for (const NodeDef& node : optimized_graph->node()) {
+    if ((node.op() != "BiasAdd" && node.op() != "BiasAddV1") ||
+        NumNonControlInputs(node) != 2 ||
+        !HasStringAttrOrDefault(node, "data_format", "NHWC")) {
+      continue;
+    }
+    const NodeDef* conv = node_map.GetNode(node.input(0));
+    if (conv == nullptr || !IsFusableConv(*conv, has_gpu) ||
+        nodes_to_preserve.count(conv->name()) > 0 ||
+        !IsOnlyConsumer(node, *conv, node_map)) {
+      continue;
+    }
+    // Fuse the activation too if the bias add is only read by it.
+    const NodeDef* activation = nullptr;
+    if (nodes_to_preserve.count(node.name()) == 0 &&
+        node_map.GetOutputs(node.name()).size() == 1) {
+      const NodeDef* consumer = *node_map.GetOutputs(node.name()).begin();
+      if ((consumer->op() == "Relu" || consumer->op() == "Relu6") &&
+          NumNonControlInputs(*consumer) == 1 &&
+          IsOnlyConsumer(*consumer, node, node_map)) {
+        activation = consumer;
+      }
+    }
+    fused_away.insert(conv->name());
+    if (activation != nullptr) {
+      fused_away.insert(node.name());
+      fused_nodes[activation->name()] = FuseConvBias(*conv, node, activation);
+    } else {
+      fused_nodes[node.name()] = FuseConvBias(*conv, node, nullptr);
+    }
+  }
+  if (fused_nodes.empty()) {
+    return Status::OK();
+  }
+  VLOG(1) << "Fused " << fused_nodes.size() << " convolutions with biases";
+
+  GraphDef graph;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (fused_away.count(node.name()) > 0) {
+      continue;
+    }
+    auto it = fused_nodes.find(node.name());
+    if (it != fused_nodes.end()) {
+      graph.add_node()->Swap(&it->second);
+    } else {
+      graph.add_node()->Swap(&node);
+    }
+  }
+  optimized_graph->mutable_node()->Swap(graph.mutable_node());
+  return Status::OK();
+}
+
+void ConvBiasFusion::Feedback(Cluster* /*cluster*/,
+                              const GrapplerItem& /*item*/,
+                              const GraphDef& /*optimized_graph*/,
+                              double /*result*/) {
+  // Nothing to do for ConvBiasFusion.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,46 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONV_BIAS_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONV_BIAS_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Replaces each NHWC Conv2D on CPU whose only consumer is a BiasAdd with a
+// FusedConv2DWithBias, which adds the bias and applies the activation to each
+// block of the output while it is still in cache. A Relu or Relu6 that is the
+// only consumer of the BiasAdd is fused as well. The fused op keeps the name
+// of the last fused node, so its consumers are unchanged.
+class ConvBiasFusion : public GraphOptimizer {
+ public:
+  ConvBiasFusion() {}
+  ~ConvBiasFusion() override {}
+
+  string name() const override { return "conv_bias_fusion"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONV_BIAS_FUSION_H_
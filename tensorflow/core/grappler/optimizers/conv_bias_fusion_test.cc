@@ -0,0 +1,185 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/conv_bias_fusion.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ConvBiasFusionTest : public ::testing::Test {};
+
+const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) {
+      return &node;
+    }
+  }
+  return nullptr;
+}
+
+// Builds the input, filter and bias of a convolution.
+struct ConvInputs {
+  explicit ConvInputs(const Scope& s)
+      : input(ops::Placeholder(s.WithOpName("input"), DT_FLOAT,
+                               ops::Placeholder::Shape({8, 32, 32, 3}))),
+        filter(ops::Placeholder(s.WithOpName("filter"), DT_FLOAT,
+                                ops::Placeholder::Shape({3, 3, 3, 16}))),
+        bias(ops::Placeholder(s.WithOpName("bias"), DT_FLOAT,
+                              ops::Placeholder::Shape({16}))) {}
+
+  Output input;
+  Output filter;
+  Output bias;
+};
+
+TEST_F(ConvBiasFusionTest, FusesConvBiasAddAndRelu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  ConvInputs inputs(s);
+  Output conv = ops::Conv2D(s.WithOpName("conv"), inputs.input, inputs.filter,
+                            {1, 2, 2, 1}, "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, inputs.bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu"};
+
+  ConvBiasFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "conv"));
+  EXPECT_EQ(nullptr, FindNode(output, "bias_add"));
+  const NodeDef* fused = FindNode(output, "relu");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("FusedConv2DWithBias", fused->op());
+  ASSERT_EQ(3, fused->input_size());
+  EXPECT_EQ("input", fused->input(0));
+  EXPECT_EQ("filter", fused->input(1));
+  EXPECT_EQ("bias", fused->input(2));
+  EXPECT_EQ("Relu", fused->attr().at("activation").s());
+  EXPECT_EQ("SAME", fused->attr().at("padding").s());
+  EXPECT_EQ(2, fused->attr().at("strides").list().i(1));
+  EXPECT_EQ(DT_FLOAT, fused->attr().at("T").type());
+}
+
+TEST_F(ConvBiasFusionTest, FusesConvAndBiasAddWithoutActivation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  ConvInputs inputs(s);
+  Output conv = ops::Conv2D(s.WithOpName("conv"), inputs.input, inputs.filter,
+                            {1, 1, 1, 1}, "VALID");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, inputs.bias);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), bias_add);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"tanh"};
+
+  ConvBiasFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "conv"));
+  const NodeDef* fused = FindNode(output, "bias_add");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("FusedConv2DWithBias", fused->op());
+  EXPECT_EQ("Identity", fused->attr().at("activation").s());
+  EXPECT_EQ("Tanh", FindNode(output, "tanh")->op());
+}
+
+TEST_F(ConvBiasFusionTest, KeepsConvWithOtherConsumers) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  ConvInputs inputs(s);
+  Output conv = ops::Conv2D(s.WithOpName("conv"), inputs.input, inputs.filter,
+                            {1, 1, 1, 1}, "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, inputs.bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+  Output shape = ops::Shape(s.WithOpName("shape"), conv);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu", "shape"};
+
+  ConvBiasFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ("Conv2D", FindNode(output, "conv")->op());
+  EXPECT_EQ("BiasAdd", FindNode(output, "bias_add")->op());
+  EXPECT_EQ("Relu", FindNode(output, "relu")->op());
+}
+
+TEST_F(ConvBiasFusionTest, KeepsFetchedBiasAdd) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  ConvInputs inputs(s);
+  Output conv = ops::Conv2D(s.WithOpName("conv"), inputs.input, inputs.filter,
+                            {1, 1, 1, 1}, "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, inputs.bias);
+  Output relu = ops::Relu(s.WithOpName("relu"), bias_add);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu", "bias_add"};
+
+  ConvBiasFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  // The bias add is still fused with the convolution, but not with the relu.
+  EXPECT_EQ(nullptr, FindNode(output, "conv"));
+  const NodeDef* fused = FindNode(output, "bias_add");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("FusedConv2DWithBias", fused->op());
+  EXPECT_EQ("Identity", fused->attr().at("activation").s());
+  EXPECT_EQ("Relu", FindNode(output, "relu")->op());
+}
+
+TEST_F(ConvBiasFusionTest, KeepsConvOnGpu) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  ConvInputs inputs(s);
+  Output gpu_conv =
+      ops::Conv2D(s.WithOpName("gpu_conv").WithDevice("/gpu:0"), inputs.input,
+                  inputs.filter, {1, 1, 1, 1}, "SAME");
+  Output gpu_bias_add =
+      ops::BiasAdd(s.WithOpName("gpu_bias_add"), gpu_conv, inputs.bias);
+  Output conv = ops::Conv2D(s.WithOpName("conv"), inputs.input, inputs.filter,
+                            {1, 1, 1, 1}, "SAME");
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), conv, inputs.bias);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gpu_bias_add", "bias_add"};
+
+  // Without a device, the convolution may be placed on the GPU of the
+  // cluster.
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  VirtualCluster cluster({{"/GPU:0", gpu_device}});
+
+  ConvBiasFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cluster, item, &output));
+
+  EXPECT_EQ("Conv2D", FindNode(output, "gpu_conv")->op());
+  EXPECT_EQ("Conv2D", FindNode(output, "conv")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
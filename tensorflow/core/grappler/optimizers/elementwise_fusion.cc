@@ -0,0 +1,239 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/elementwise_fusion.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// The longest chain that one _FusedElementwise op applies; must not exceed
+// kMaxFusedElementwiseSteps of its kernel. Longer chains are fused into
+// several ops.
+const int kMaxFusedOps = 16;
+
+bool IsFusedUnaryOp(const NodeDef& node) {
+  return IsRelu(node) || IsTanh(node);
+}
+
+bool IsFusedBinaryOp(const NodeDef& node) {
+  return IsAdd(node) || IsMul(node);
+}
+
+// Returns true if both shapes are statically known to be equal. Unknown
+// dimensions are equal if the shape inference gave them the same symbolic
+// id.
+bool ShapesEqual(const TensorShapeProto& x, const TensorShapeProto& y) {
+  if (x.unknown_rank() || y.unknown_rank() || x.dim_size() != y.dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < x.dim_size(); ++i) {
+    if (x.dim(i).size() == -1 || x.dim(i).size() != y.dim(i).size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsScalar(const TensorShapeProto& shape) {
+  return !shape.unknown_rank() && shape.dim_size() == 0;
+}
+
+bool HasFusedKernel(const NodeDef& node) {
+  auto it = node.attr().find("T");
+  if (it == node.attr().end() ||
+      (it->second.type() != DT_FLOAT && it->second.type() != DT_DOUBLE)) {
+    return false;
+  }
+  if (node.device().empty()) {
+    return true;
+  }
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(node.device(), &parsed) &&
+         (!parsed.has_type || parsed.type == DEVICE_CPU ||
+          parsed.type == DEVICE_GPU);
+}
+
+// Returns the indices of the inputs of "node" that can carry a chain into
+// it, or nothing if "node" cannot be fused. The other input of a binary op
+// becomes an operand of the fused op, so it must be a scalar or have the
+// shape of the chain.
+std::vector<int> ChainInputs(const NodeDef& node,
+                             const GraphProperties& properties) {
+  std::vector<int> chain_inputs;
+  if (!HasFusedKernel(node)) {
+    return chain_inputs;
+  }
+  if (IsFusedUnaryOp(node) && NumNonControlInputs(node) == 1) {
+    chain_inputs.push_back(0);
+  } else if (IsFusedBinaryOp(node) && NumNonControlInputs(node) == 2 &&
+             properties.HasInputProperties(node.name())) {
+    const auto& inputs = properties.GetInputProperties(node.name());
+    for (int i = 0; i < 2; ++i) {
+      const TensorShapeProto& chain_shape = inputs[i].shape();
+      const TensorShapeProto& operand_shape = inputs[1 - i].shape();
+      if (IsScalar(operand_shape) || ShapesEqual(chain_shape, operand_shape)) {
+        chain_inputs.push_back(i);
+      }
+    }
+  }
+  return chain_inputs;
+}
+
+// Returns the fused op that applies the ops chain[begin, end).
+NodeDef FuseChain(const std::vector<const NodeDef*>& chain, int begin, int end,
+                  const std::unordered_map<const NodeDef*, int>& chain_input) {
+  const NodeDef& first = *chain[begin];
+  const NodeDef& last = *chain[end - 1];
+  NodeDef fused;
+  fused.set_name(last.name());
+  fused.set_op("_FusedElementwise");
+  fused.set_device(last.device());
+  (*fused.mutable_attr())["T"] = last.attr().at("T");
+  fused.add_input(first.input(chain_input.at(&first)));
+
+  AttrValue ops;
+  std::set<string> control_inputs;
+  for (int i = begin; i < end; ++i) {
+    const NodeDef& node = *chain[i];
+    if (IsFusedBinaryOp(node)) {
+      fused.add_input(node.input(1 - chain_input.at(&node)));
+      ops.mutable_list()->add_s(IsAdd(node) ? "Add" : "Mul");
+    } else {
+      ops.mutable_list()->add_s(node.op());
+    }
+    for (int j = NumNonControlInputs(node); j < node.input_size(); ++j) {
+      control_inputs.insert(node.input(j));
+    }
+  }
+  (*fused.mutable_attr())["N"].set_i(fused.input_size() - 1);
+  (*fused.mutable_attr())["ops"] = ops;
+  for (const string& control_input : control_inputs) {
+    fused.add_input(control_input);
+  }
+  return fused;
+}
+
+}  // namespace
+
+Status ElementwiseFusion::Optimize(Cluster* /*cluster*/,
+                                   const GrapplerItem& item,
+                                   GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  GraphProperties properties(item, properties_cache());
+  TF_RETURN_IF_ERROR(properties.InferStatically(false));
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  // The input of each fusible node that carries the chain, and the node that
+  // feeds it if that node is the previous op of the chain. An op can only
+  // precede one op, its single consumer, so the chains do not overlap.
+  std::unordered_map<const NodeDef*, int> chain_input;
+  std::unordered_map<const NodeDef*, const NodeDef*> previous;
+  std::unordered_set<const NodeDef*> has_next;
+  for (const NodeDef& node : optimized_graph->node()) {
+    const std::vector<int> inputs = ChainInputs(node, properties);
+    if (inputs.empty()) {
+      continue;
+    }
+    chain_input[&node] = inputs[0];
+    for (int i : inputs) {
+      const NodeDef* input = node_map.GetNode(node.input(i));
+      if (input == nullptr || ChainInputs(*input, properties).empty() ||
+          input->device() != node.device() ||
+          input->attr().at("T").type() != node.attr().at("T").type() ||
+          nodes_to_preserve.count(input->name()) > 0 ||
+          node_map.GetOutputs(input->name()).size() != 1 ||
+          NumNonControlOutputs(*input, node_map) != 1) {
+        continue;
+      }
+      chain_input[&node] = i;
+      previous[&node] = input;
+      has_next.insert(input);
+      break;
+    }
+  }
+
+  std::unordered_map<string, NodeDef> fused_nodes;
+  std::unordered_set<string> fused_away;
+  for (const NodeDef& node : optimized_graph->node()) {
+    if (previous.count(&node) == 0 || has_next.count(&node) > 0) {
+      continue;
+    }
+    // "node" is the last op of a chain of at least two ops.
+    std::vector<const NodeDef*> chain;
+    for (const NodeDef* op = &node; op != nullptr;) {
+      chain.push_back(op);
+      auto it = previous.find(op);
+      op = it == previous.end() ? nullptr : it->second;
+    }
+    std::reverse(chain.begin(), chain.end());
+    for (int begin = 0; begin + 1 < chain.size(); begin += kMaxFusedOps) {
+      const int end = std::min<int>(chain.size(), begin + kMaxFusedOps);
+      for (int i = begin; i < end - 1; ++i) {
+        fused_away.insert(chain[i]->name());
+      }
+      fused_nodes[chain[end - 1]->name()] =
+          FuseChain(chain, begin, end, chain_input);
+    }
+  }
+  if (fused_nodes.empty()) {
+    return Status::OK();
+  }
+  VLOG(1) << "Fused " << fused_away.size() + fused_nodes.size()
+          << " element-wise ops into " << fused_nodes.size() << " ops";
+
+  GraphDef graph;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (fused_away.count(node.name()) > 0) {
+      continue;
+    }
+    auto it = fused_nodes.find(node.name());
+    if (it != fused_nodes.end()) {
+      graph.add_node()->Swap(&it->second);
+    } else {
+      graph.add_node()->Swap(&node);
+    }
+  }
+  optimized_graph->mutable_node()->Swap(graph.mutable_node());
+  return Status::OK();
+}
+
+void ElementwiseFusion::Feedback(Cluster* /*cluster*/,
+                                 const GrapplerItem& /*item*/,
+                                 const GraphDef& /*optimized_graph*/,
+                                 double /*result*/) {
+  // Nothing to do for ElementwiseFusion.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
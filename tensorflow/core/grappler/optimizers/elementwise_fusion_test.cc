@@ -0,0 +1,142 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/elementwise_fusion.h"
+
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ElementwiseFusionTest : public ::testing::Test {};
+
+const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) {
+      return &node;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<string> FusedOps(const NodeDef& node) {
+  const auto& ops = node.attr().at("ops").list().s();
+  return std::vector<string>(ops.begin(), ops.end());
+}
+
+TEST_F(ElementwiseFusionTest, FusesChain) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3}));
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3}));
+  Output c = ops::Const(s.WithOpName("c"), 0.5f);
+  Output add = ops::Add(s.WithOpName("add"), x, y);
+  Output relu = ops::Relu(s.WithOpName("relu"), add);
+  Output mul = ops::Mul(s.WithOpName("mul"), c, relu);
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), mul);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"tanh"};
+
+  ElementwiseFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(4, output.node_size());
+  EXPECT_EQ(nullptr, FindNode(output, "add"));
+  EXPECT_EQ(nullptr, FindNode(output, "relu"));
+  EXPECT_EQ(nullptr, FindNode(output, "mul"));
+  const NodeDef* fused = FindNode(output, "tanh");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedElementwise", fused->op());
+  ASSERT_EQ(3, fused->input_size());
+  EXPECT_EQ("x", fused->input(0));
+  EXPECT_EQ("y", fused->input(1));
+  EXPECT_EQ("c", fused->input(2));
+  EXPECT_EQ(2, fused->attr().at("N").i());
+  EXPECT_EQ(std::vector<string>({"Add", "Relu", "Mul", "Tanh"}),
+            FusedOps(*fused));
+
+  // The fused op cannot be fused further.
+  item.graph.Swap(&output);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(4, output.node_size());
+}
+
+TEST_F(ElementwiseFusionTest, KeepsBranchesAndFetches) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3}));
+  Output add = ops::Add(s.WithOpName("add"), x, x);
+  // "add" feeds two ops, so it ends the chains that "relu" and "tanh" start.
+  Output relu = ops::Relu(s.WithOpName("relu"), add);
+  Output tanh1 = ops::Tanh(s.WithOpName("tanh1"), add);
+  // "tanh2" is fetched, so it ends the chain even though it has a consumer.
+  Output tanh2 = ops::Tanh(s.WithOpName("tanh2"), relu);
+  Output tanh3 = ops::Tanh(s.WithOpName("tanh3"), tanh2);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"tanh1", "tanh2", "tanh3"};
+
+  ElementwiseFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(5, output.node_size());
+  EXPECT_EQ("Add", FindNode(output, "add")->op());
+  EXPECT_EQ("Tanh", FindNode(output, "tanh1")->op());
+  EXPECT_EQ("Tanh", FindNode(output, "tanh3")->op());
+  EXPECT_EQ(nullptr, FindNode(output, "relu"));
+  const NodeDef* fused = FindNode(output, "tanh2");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("_FusedElementwise", fused->op());
+  ASSERT_EQ(1, fused->input_size());
+  EXPECT_EQ("add", fused->input(0));
+  EXPECT_EQ(std::vector<string>({"Relu", "Tanh"}), FusedOps(*fused));
+}
+
+TEST_F(ElementwiseFusionTest, DoesNotFuseBroadcasts) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3}));
+  Output b = ops::Placeholder(s.WithOpName("b"), DT_FLOAT,
+                              ops::Placeholder::Shape({3}));
+  Output add = ops::Add(s.WithOpName("add"), x, b);
+  Output relu = ops::Relu(s.WithOpName("relu"), add);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"relu"};
+
+  ElementwiseFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(4, output.node_size());
+  EXPECT_EQ("Add", FindNode(output, "add")->op());
+  EXPECT_EQ("Relu", FindNode(output, "relu")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
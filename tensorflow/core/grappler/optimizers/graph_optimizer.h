@@ -23,6 +23,7 @@ namespace tensorflow {
 namespace grappler {
 
 class Cluster;
+class GraphPropertiesCache;
 struct GrapplerItem;
 
 // An abstract interface for an algorithm for generating a candidate
@@ -45,6 +46,19 @@ class GraphOptimizer {
   // call to Optimize) performed.  Lower "result" scores are better.
   virtual void Feedback(Cluster* cluster, const GrapplerItem& item,
                         const GraphDef& optimized_graph, double result) = 0;
+
+  // Lets the optimizer reuse the shapes inferred by the other optimizers that
+  // run on the same graphs. Does not take ownership of the cache.
+  void set_properties_cache(GraphPropertiesCache* cache) {
+    properties_cache_ = cache;
+  }
+
+ protected:
+  // The cache to pass to the GraphProperties of the optimizer. May be null.
+  GraphPropertiesCache* properties_cache() const { return properties_cache_; }
+
+ private:
+  GraphPropertiesCache* properties_cache_ = nullptr;  // Not owned.
 };
 
 }  // end namespace grappler
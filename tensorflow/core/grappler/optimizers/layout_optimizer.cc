@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
@@ -46,6 +47,7 @@ const char kVecPermuteNCHWToNHWC[] = "LayoutOptimizerVecPermuteNCHWToNHWC";
 const char kReshapeNHWCToNCHW[] = "LayoutOptimizerReshapeNHWCToNCHW";
 const char kReshapeConst[] = "LayoutOptimizerReshapeConst";
 const char kReductionConst[] = "LayoutOptimizerReductionConst";
+const char kPermComposed[] = "LayoutOptimizerPermComposed";
 
 std::set<string> GetOpsFormatSupported() {
   std::set<string> ops_format_supported = {
@@ -72,7 +74,8 @@ std::set<string> GetOpsFormatSupported() {
 // TODO(yaozhang): enable SumProcessor with auto-tuning. Currently disabled
 // because of the worse performance in some cases.
 std::set<string> GetOpsFormatAgnostic() {
-  std::set<string> ops_format_agnostic = {"Add",
+  std::set<string> ops_format_agnostic = {"Abs",
+                                          "Add",
                                           "AddN",
                                           "Acos",
                                           "Acosh",
@@ -86,6 +89,7 @@ std::set<string> GetOpsFormatAgnostic() {
                                           "Concat",
                                           "ConcatV2",
                                           "Digamma",
+                                          "Elu",
                                           "Erf",
                                           "Erfc",
                                           "Exp",
@@ -118,15 +122,19 @@ std::set<string> GetOpsFormatAgnostic() {
                                           "Sin",
                                           "Sinh",
                                           "Slice",
+                                          "Softplus",
+                                          "Softsign",
                                           "Split",
                                           "Round",
                                           "Rsqrt",
                                           "RsqrtGrad",
+                                          "Selu",
                                           "Sqrt",
                                           "SqrtGrad",
                                           "Square",
                                           "SquaredDifference",
                                           "Squeeze",
+                                          "StopGradient",
                                           /*"Sum",*/ "Sub",
                                           "Tan",
                                           "Tanh",
@@ -1366,10 +1374,25 @@ class DataLayoutOptimizer : GraphProcessor {
 
   Status Optimize() {
     VLOG(1) << "Number of nodes for original graph: " << graph_->node_size();
+    const int num_original_transposes = NumTransposes();
     TF_RETURN_IF_ERROR(Expand());
     VLOG(1) << "Number of nodes after Expand: " << graph_->node_size();
+    const int num_expanded_transposes = NumTransposes();
     TF_RETURN_IF_ERROR(Collapse());
     VLOG(1) << "Number of nodes after Collapse: " << graph_->node_size();
+    const int num_collapsed_transposes = NumTransposes();
+    TF_RETURN_IF_ERROR(CancelTransposes());
+    VLOG(1) << "Number of nodes after CancelTransposes: "
+            << graph_->node_size();
+    const int num_final_transposes = NumTransposes();
+    VLOG(1) << "Transposes: " << num_original_transposes << " in the graph, "
+            << num_expanded_transposes - num_original_transposes
+            << " added around the converted nodes, "
+            << num_expanded_transposes - num_collapsed_transposes
+            << " removed by Collapse, "
+            << num_collapsed_transposes - num_final_transposes
+            << " removed by CancelTransposes, " << num_final_transposes
+            << " left";
     return Status::OK();
   }
 
@@ -1517,6 +1540,137 @@ class DataLayoutOptimizer : GraphProcessor {
     return Status::OK();
   }
 
+  // Merges the consecutive 4-D transposes that Collapse doesn't remove, e.g.
+  // transposes of the model next to the ones added by Expand, or the ones
+  // separated by a node that was collapsed. A transpose that feeds only
+  // another transpose is bypassed, and the second one applies the composition
+  // of both permutations. If the composition is the identity, the second
+  // transpose becomes an Identity node, which is removed if it was added by
+  // the layout optimizer.
+  Status CancelTransposes() {
+    std::unordered_set<string> nodes_removable;
+    for (int i = 0; i < graph_->node_size(); i++) {
+      NodeDef* second = graph_->mutable_node(i);
+      if (!IsTranspose(*second) || nodes_removable.count(second->name()) > 0) {
+        continue;
+      }
+      NodeDef* first = node_map_->GetNode(second->input(0));
+      if (first == nullptr || !IsTranspose(*first) ||
+          first->device() != second->device() ||
+          nodes_to_preserve_.count(first->name()) > 0 ||
+          node_map_->GetOutputs(first->name()).size() != 1 ||
+          first->input_size() != 2 ||
+          NodeName(second->input(1)) == first->name()) {
+        continue;
+      }
+      std::vector<int> first_perm;
+      std::vector<int> second_perm;
+      if (!GetPermutation(first->input(1), &first_perm) ||
+          !GetPermutation(second->input(1), &second_perm)) {
+        continue;
+      }
+      std::vector<int> perm(second_perm.size());
+      bool is_identity = true;
+      for (int j = 0; j < perm.size(); j++) {
+        perm[j] = first_perm[second_perm[j]];
+        is_identity &= perm[j] == j;
+      }
+
+      const string input = first->input(0);
+      node_map_->UpdateInput(second->name(), first->name(), input);
+      *second->mutable_input(0) = input;
+      node_map_->RemoveInputs(first->name());
+      nodes_removable.insert(first->name());
+
+      node_map_->RemoveOutput(NodeName(second->input(1)), second->name());
+      if (!is_identity) {
+        const string perm_name =
+            strings::StrCat(kPermComposed, "-", second->name());
+        NodeDef* perm_node =
+            AddNodePermConst(perm_name, second->device(), perm);
+        *second->mutable_input(1) = perm_node->name();
+        node_map_->AddOutput(perm_node->name(), second->name());
+        continue;
+      }
+      second->set_op("Identity");
+      second->mutable_input()->erase(second->mutable_input()->begin() + 1);
+      second->mutable_attr()->erase("Tperm");
+      if (IsNodeByLayoutOptimizer(second->name()) &&
+          nodes_to_preserve_.count(second->name()) == 0 &&
+          second->input_size() == 1) {
+        BypassIdentity(*second);
+        nodes_removable.insert(second->name());
+      }
+    }
+    graph_->mutable_node()->erase(
+        std::remove_if(
+            graph_->mutable_node()->begin(), graph_->mutable_node()->end(),
+            [&nodes_removable](const NodeDef& node) {
+              return nodes_removable.find(node.name()) != nodes_removable.end();
+            }),
+        graph_->mutable_node()->end());
+    return Status::OK();
+  }
+
+  // Reads the permutation of a transpose from the constant "input".
+  bool GetPermutation(const string& input, std::vector<int>* perm) const {
+    const NodeDef* node = node_map_->GetNode(input);
+    if (node == nullptr || !IsConstant(*node) ||
+        node->attr().count("value") == 0) {
+      return false;
+    }
+    Tensor tensor;
+    if (!tensor.FromProto(node->attr().at("value").tensor()) ||
+        tensor.dims() != 1 || tensor.NumElements() != 4) {
+      return false;
+    }
+    perm->clear();
+    for (int i = 0; i < tensor.NumElements(); i++) {
+      int dim;
+      if (tensor.dtype() == DT_INT32) {
+        dim = tensor.flat<int32>()(i);
+      } else if (tensor.dtype() == DT_INT64) {
+        dim = tensor.flat<int64>()(i);
+      } else {
+        return false;
+      }
+      if (dim < 0 || dim >= tensor.NumElements()) {
+        return false;
+      }
+      perm->push_back(dim);
+    }
+    return true;
+  }
+
+  // Rewires the consumers of the Identity node "identity" to its input.
+  void BypassIdentity(const NodeDef& identity) {
+    const string& input = identity.input(0);
+    const std::set<NodeDef*> outputs = node_map_->GetOutputs(identity.name());
+    for (NodeDef* output : outputs) {
+      for (int i = 0; i < output->input_size(); i++) {
+        const string& output_input = output->input(i);
+        if (NodeName(output_input) != identity.name()) {
+          continue;
+        }
+        *output->mutable_input(i) = IsControlInput(output_input)
+                                        ? AsControlDependency(NodeName(input))
+                                        : input;
+      }
+      node_map_->UpdateInput(output->name(), identity.name(), input);
+    }
+    node_map_->RemoveInputs(identity.name());
+  }
+
+  int NumTransposes() const {
+    int number = 0;
+    for (const auto& node : graph_->node()) {
+      if (IsTranspose(node)) {
+        number++;
+      }
+    }
+    return number;
+  }
+
   const LayoutOptimizer::TuningConfig& config_;
 };
 
@@ -1575,7 +1729,7 @@ Status LayoutOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   virtual_placer_.reset(new VirtualPlacer(cluster));
   nodes_to_preserve_ = item.NodesToPreserve();
-  GraphProperties graph_properties(item);
+  GraphProperties graph_properties(item, properties_cache());
   auto status = graph_properties.InferStatically(false);
   if (!status.ok()) {
     *output = item.graph;
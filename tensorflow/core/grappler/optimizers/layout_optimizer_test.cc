@@ -1002,6 +1002,28 @@ TEST_F(LayoutOptimizerTest, ShapeNWithInputs4DAndNoNeedToTransform4D) {
   EXPECT_EQ(shapen_node->input(1), "i2");
 }
 
+TEST_F(LayoutOptimizerTest, CancelTransposeOfModel) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto conv = SimpleConv2D(&s, 3, 2, "VALID");
+  // The model converts the output of the convolution to NCHW itself.
+  auto perm = ops::Const(s.WithOpName("perm"), {0, 3, 1, 2}, {4});
+  auto transpose = ops::Transpose(s.WithOpName("transpose"), conv, perm);
+  auto relu = ops::Relu(s.WithOpName("relu"), transpose);
+  GrapplerItem item;
+  item.fetch = {"relu"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  LayoutOptimizer optimizer;
+  GraphDef output;
+  Status status = optimizer.Optimize(virtual_cluster_.get(), item, &output);
+  NodeMap node_map(&output);
+  EXPECT_FALSE(
+      node_map.GetNode("LayoutOptimizerTransposeNCHWToNHWC-Conv2D-0-0"));
+  auto transpose_node = node_map.GetNode("transpose");
+  EXPECT_EQ("Identity", transpose_node->op());
+  ASSERT_EQ(1, transpose_node->input_size());
+  EXPECT_EQ("Conv2D", transpose_node->input(0));
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
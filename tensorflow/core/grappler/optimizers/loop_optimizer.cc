@@ -0,0 +1,316 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
+
+#include <deque>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+const char kInvariantPrefix[] = "LoopOptimizerInvariant";
+const char kHoistedConstPrefix[] = "LoopOptimizerHoisted";
+
+bool IsConstantEnter(const NodeDef& node) {
+  if (!IsEnter(node)) {
+    return false;
+  }
+  auto it = node.attr().find("is_constant");
+  return it != node.attr().end() && it->second.b();
+}
+
+bool IsControlFlowNode(const NodeDef& node) {
+  return IsEnter(node) || IsExit(node) || IsMerge(node) || IsSwitch(node) ||
+         IsNextIteration(node) || node.op() == "LoopCond";
+}
+
+class InvariantHoister {
+ public:
+  InvariantHoister(const GrapplerItem& item, GraphDef* graph)
+      : graph_(graph),
+        node_map_(graph),
+        nodes_to_preserve_(item.NodesToPreserve()) {}
+
+  Status Hoist() {
+    int num_frames;
+    TF_RETURN_IF_ERROR(
+        IdentifyFramesWithNodeMap(*graph_, node_map_, &frames_, &num_frames));
+    if (num_frames == 0) {
+      return Status::OK();
+    }
+
+    std::deque<NodeDef*> queue;
+    std::unordered_set<NodeDef*> queued;
+    for (const NodeDef& node : graph_->node()) {
+      if (IsConstantEnter(node)) {
+        for (NodeDef* output : node_map_.GetOutputs(node.name())) {
+          if (queued.insert(output).second) {
+            queue.push_back(output);
+          }
+        }
+      }
+    }
+    int num_hoisted = 0;
+    while (!queue.empty()) {
+      NodeDef* node = queue.front();
+      queue.pop_front();
+      queued.erase(node);
+      std::vector<NodeDef*> enters;
+      if (!HoistIfInvariant(node, &enters)) {
+        continue;
+      }
+      ++num_hoisted;
+      for (const NodeDef* enter : enters) {
+        for (NodeDef* output : node_map_.GetOutputs(enter->name())) {
+          if (queued.insert(output).second) {
+            queue.push_back(output);
+          }
+        }
+      }
+    }
+    if (num_hoisted == 0) {
+      return Status::OK();
+    }
+    VLOG(1) << "Hoisted " << num_hoisted << " loop-invariant nodes";
+    RemoveUnusedInputs();
+    return Status::OK();
+  }
+
+ private:
+  // Moves "node" out of its loop if it is invariant, and returns the Enter
+  // nodes that now feed its value to the loop.
+  bool HoistIfInvariant(NodeDef* node, std::vector<NodeDef*>* enters) {
+    if (nodes_to_preserve_.count(node->name()) > 0 ||
+        IsControlFlowNode(*node) || !IsFreeOfSideEffect(*node)) {
+      return false;
+    }
+    auto frame_it = frames_.find(node);
+    if (frame_it == frames_.end() || frame_it->second.empty()) {
+      return false;
+    }
+    const std::vector<int> frame = frame_it->second;
+    std::vector<int> parent_frame = frame;
+    parent_frame.pop_back();
+
+    const OpDef* op_def = nullptr;
+    DataTypeVector input_types;
+    DataTypeVector output_types;
+    if (!OpRegistry::Global()->LookUpOpDef(node->op(), &op_def).ok() ||
+        !InOutTypesForNode(*node, *op_def, &input_types, &output_types).ok() ||
+        output_types.empty()) {
+      return false;
+    }
+
+    // The inputs of the hoisted node, and the Consts of the loop body that
+    // must be copied out of it.
+    std::vector<string> new_inputs;
+    std::vector<const NodeDef*> consts_to_copy;
+    const NodeDef* frame_enter = nullptr;
+    for (const string& input : node->input()) {
+      const NodeDef* input_node = node_map_.GetNode(input);
+      if (input_node == nullptr || frames_.count(input_node) == 0 ||
+          frames_.at(input_node) != frame) {
+        return false;
+      }
+      if (IsConstantEnter(*input_node) &&
+          NumNonControlInputs(*input_node) == 1) {
+        frame_enter = input_node;
+        new_inputs.push_back(IsControlInput(input)
+                                 ? AsControlDependency(input_node->input(0))
+                                 : input_node->input(0));
+      } else if (IsConstant(*input_node) &&
+                 NumNonControlInputs(*input_node) == 0 &&
+                 parent_frame.empty()) {
+        // The control inputs of a Const of the body only place it in the
+        // frame: a copy without inputs outside the loop has the same value.
+        if (!IsControlInput(input)) {
+          consts_to_copy.push_back(input_node);
+          new_inputs.push_back(
+              AddPrefixToNodeName(input_node->name(), kHoistedConstPrefix));
+        }
+      } else {
+        return false;
+      }
+    }
+    if (frame_enter == nullptr) {
+      return false;
+    }
+
+    // The output ports of the node that the loop reads.
+    std::map<int, std::vector<NodeDef*>> port_consumers;
+    std::vector<NodeDef*> control_consumers;
+    for (NodeDef* output : node_map_.GetOutputs(node->name())) {
+      for (const string& input : output->input()) {
+        int port;
+        if (ParseNodeName(input, &port) != node->name()) {
+          continue;
+        }
+        if (port < 0) {
+          control_consumers.push_back(output);
+        } else {
+          port_consumers[port].push_back(output);
+        }
+      }
+    }
+    if (port_consumers.empty()) {
+      // The Enter of the first output carries the control dependencies.
+      port_consumers[0] = {};
+    }
+    for (const auto& port : port_consumers) {
+      if (port.first >= output_types.size() ||
+          node_map_.NodeExists(EnterName(*node, port.first))) {
+        return false;
+      }
+    }
+
+    for (const NodeDef* const_node : consts_to_copy) {
+      const string name =
+          AddPrefixToNodeName(const_node->name(), kHoistedConstPrefix);
+      if (node_map_.NodeExists(name)) {
+        continue;
+      }
+      NodeDef* copy = graph_->add_node();
+      copy->set_name(name);
+      copy->set_op(const_node->op());
+      copy->set_device(const_node->device());
+      *copy->mutable_attr() = const_node->attr();
+      node_map_.AddNode(name, copy);
+      frames_[copy] = parent_frame;
+    }
+    for (const string& input : node->input()) {
+      node_map_.RemoveOutput(NodeName(input), node->name());
+      old_inputs_.insert(NodeName(input));
+    }
+    node->clear_input();
+    for (const string& input : new_inputs) {
+      node_map_.AddOutput(NodeName(input), node->name());
+      node->add_input(input);
+    }
+    frames_[node] = parent_frame;
+
+    for (const auto& port : port_consumers) {
+      NodeDef* enter = graph_->add_node();
+      enter->set_name(EnterName(*node, port.first));
+      enter->set_op("Enter");
+      enter->set_device(node->device());
+      enter->add_input(port.first == 0
+                           ? node->name()
+                           : strings::StrCat(node->name(), ":", port.first));
+      (*enter->mutable_attr())["T"].set_type(output_types[port.first]);
+      (*enter->mutable_attr())["frame_name"] =
+          frame_enter->attr().at("frame_name");
+      (*enter->mutable_attr())["is_constant"].set_b(true);
+      if (frame_enter->attr().count("parallel_iterations") > 0) {
+        (*enter->mutable_attr())["parallel_iterations"] =
+            frame_enter->attr().at("parallel_iterations");
+      }
+      node_map_.AddNode(enter->name(), enter);
+      node_map_.AddOutput(node->name(), enter->name());
+      frames_[enter] = frame;
+      for (NodeDef* consumer : port.second) {
+        for (int i = 0; i < consumer->input_size(); ++i) {
+          int input_port;
+          if (ParseNodeName(consumer->input(i), &input_port) == node->name() &&
+              input_port == port.first) {
+            node_map_.UpdateInput(consumer->name(), consumer->input(i),
+                                  enter->name());
+            *consumer->mutable_input(i) = enter->name();
+          }
+        }
+      }
+      enters->push_back(enter);
+    }
+    const string control_input = AsControlDependency(enters->front()->name());
+    for (NodeDef* consumer : control_consumers) {
+      for (int i = 0; i < consumer->input_size(); ++i) {
+        if (consumer->input(i) == AsControlDependency(node->name())) {
+          node_map_.UpdateInput(consumer->name(), consumer->input(i),
+                                control_input);
+          *consumer->mutable_input(i) = control_input;
+        }
+      }
+    }
+    return true;
+  }
+
+  static string EnterName(const NodeDef& node, int port) {
+    return AddPrefixToNodeName(strings::StrCat(node.name(), "_", port),
+                               kInvariantPrefix);
+  }
+
+  // Removes the Enter nodes and the Consts of the loop bodies that only fed
+  // hoisted nodes.
+  void RemoveUnusedInputs() {
+    std::unordered_set<string> nodes_to_delete;
+    for (const string& name : old_inputs_) {
+      if (nodes_to_preserve_.count(name) == 0 &&
+          node_map_.GetOutputs(name).empty()) {
+        nodes_to_delete.insert(name);
+      }
+    }
+    if (nodes_to_delete.empty()) {
+      return;
+    }
+    GraphDef graph;
+    for (NodeDef& node : *graph_->mutable_node()) {
+      if (nodes_to_delete.count(node.name()) == 0) {
+        graph.add_node()->Swap(&node);
+      }
+    }
+    graph_->mutable_node()->Swap(graph.mutable_node());
+  }
+
+  GraphDef* graph_;
+  NodeMap node_map_;
+  FrameMap frames_;
+  const std::unordered_set<string> nodes_to_preserve_;
+  std::unordered_set<string> old_inputs_;
+};
+
+}  // namespace
+
+Status LoopOptimizer::Optimize(Cluster* /*cluster*/, const GrapplerItem& item,
+                               GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  InvariantHoister hoister(item, optimized_graph);
+  return hoister.Hoist();
+}
+
+void LoopOptimizer::Feedback(Cluster* /*cluster*/,
+                             const GrapplerItem& /*item*/,
+                             const GraphDef& /*optimized_graph*/,
+                             double /*result*/) {
+  // Nothing to do for LoopOptimizer.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,175 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class LoopOptimizerTest : public ::testing::Test {
+ protected:
+  NodeDef* AddNode(const string& name, const string& op,
+                   const std::vector<string>& inputs, DataType type) {
+    NodeDef* node = graph_.add_node();
+    node->set_name(name);
+    node->set_op(op);
+    for (const string& input : inputs) {
+      node->add_input(input);
+    }
+    if (op == "Const" || op == "Placeholder") {
+      (*node->mutable_attr())["dtype"].set_type(type);
+    } else if (op != "LoopCond") {
+      (*node->mutable_attr())["T"].set_type(type);
+    }
+    return node;
+  }
+
+  NodeDef* AddConst(const string& name, const Tensor& value,
+                    const std::vector<string>& inputs) {
+    NodeDef* node = AddNode(name, "Const", inputs, value.dtype());
+    value.AsProtoTensorContent(
+        (*node->mutable_attr())["value"].mutable_tensor());
+    return node;
+  }
+
+  NodeDef* AddEnter(const string& name, const string& input,
+                    bool is_constant, DataType type) {
+    NodeDef* node = AddNode(name, "Enter", {input}, type);
+    (*node->mutable_attr())["frame_name"].set_s("while/while_context");
+    (*node->mutable_attr())["is_constant"].set_b(is_constant);
+    (*node->mutable_attr())["parallel_iterations"].set_i(10);
+    return node;
+  }
+
+  // Adds a while loop that iterates on "x", and returns the name of the node
+  // of the body that reads the loop variable.
+  string AddLoop() {
+    AddNode("x", "Placeholder", {}, DT_FLOAT);
+    AddNode("pred", "Placeholder", {}, DT_BOOL);
+    AddEnter("while/Enter", "x", false, DT_FLOAT);
+    AddEnter("while/pred", "pred", true, DT_BOOL);
+    AddNode("while/Merge", "Merge", {"while/Enter", "while/NextIteration"},
+            DT_FLOAT);
+    AddNode("while/LoopCond", "LoopCond", {"while/pred"}, DT_BOOL);
+    AddNode("while/Switch", "Switch", {"while/Merge", "while/LoopCond"},
+            DT_FLOAT);
+    AddNode("while/Identity", "Identity", {"while/Switch:1"}, DT_FLOAT);
+    AddNode("while/Exit", "Exit", {"while/Switch"}, DT_FLOAT);
+    return "while/Identity";
+  }
+
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) {
+        return &node;
+      }
+    }
+    return nullptr;
+  }
+
+  GraphDef graph_;
+};
+
+TEST_F(LoopOptimizerTest, HoistsInvariantChain) {
+  const string body = AddLoop();
+  AddConst("w", test::AsTensor<float>({1, 2, 3, 4}), {});
+  AddEnter("while/w", "w", true, DT_FLOAT);
+  AddConst("while/shape", test::AsTensor<int32>({2, 2}),
+           {AsControlDependency(body)});
+  NodeDef* reshape =
+      AddNode("while/reshape", "Reshape", {"while/w", "while/shape"}, DT_FLOAT);
+  (*reshape->mutable_attr())["Tshape"].set_type(DT_INT32);
+  AddNode("while/square", "Square", {"while/reshape"}, DT_FLOAT);
+  AddNode("while/add", "Add", {body, "while/square"}, DT_FLOAT);
+  AddNode("while/NextIteration", "NextIteration", {"while/add"}, DT_FLOAT);
+
+  GrapplerItem item;
+  item.graph = graph_;
+  item.fetch = {"while/Exit"};
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* hoisted_reshape = FindNode(output, "while/reshape");
+  ASSERT_NE(nullptr, hoisted_reshape);
+  ASSERT_EQ(2, hoisted_reshape->input_size());
+  EXPECT_EQ("w", hoisted_reshape->input(0));
+  EXPECT_EQ("LoopOptimizerHoisted/while/shape", hoisted_reshape->input(1));
+  const NodeDef* shape = FindNode(output, "LoopOptimizerHoisted/while/shape");
+  ASSERT_NE(nullptr, shape);
+  EXPECT_EQ(0, shape->input_size());
+  const NodeDef* square = FindNode(output, "while/square");
+  ASSERT_NE(nullptr, square);
+  ASSERT_EQ(1, square->input_size());
+  EXPECT_EQ("while/reshape", square->input(0));
+
+  const NodeDef* enter =
+      FindNode(output, "LoopOptimizerInvariant/while/square_0");
+  ASSERT_NE(nullptr, enter);
+  EXPECT_EQ("Enter", enter->op());
+  ASSERT_EQ(1, enter->input_size());
+  EXPECT_EQ("while/square", enter->input(0));
+  EXPECT_TRUE(enter->attr().at("is_constant").b());
+  EXPECT_EQ("while/while_context", enter->attr().at("frame_name").s());
+  EXPECT_EQ(DT_FLOAT, enter->attr().at("T").type());
+  const NodeDef* add = FindNode(output, "while/add");
+  ASSERT_NE(nullptr, add);
+  EXPECT_EQ(body, add->input(0));
+  EXPECT_EQ("LoopOptimizerInvariant/while/square_0", add->input(1));
+
+  // The Enter and Const nodes that fed the hoisted nodes are gone, as is the
+  // intermediate Enter of "while/reshape".
+  EXPECT_EQ(nullptr, FindNode(output, "while/w"));
+  EXPECT_EQ(nullptr, FindNode(output, "while/shape"));
+  EXPECT_EQ(nullptr,
+            FindNode(output, "LoopOptimizerInvariant/while/reshape_0"));
+  EXPECT_EQ(graph_.node_size(), output.node_size());
+}
+
+TEST_F(LoopOptimizerTest, KeepsVariantAndStatefulNodes) {
+  const string body = AddLoop();
+  AddConst("shape", test::AsTensor<int32>({2, 2}), {});
+  AddEnter("while/shape", "shape", true, DT_INT32);
+  NodeDef* random = AddNode("while/random", "RandomUniform", {"while/shape"},
+                            DT_INT32);
+  (*random->mutable_attr())["dtype"].set_type(DT_FLOAT);
+  AddNode("while/mul", "Mul", {body, "while/random"}, DT_FLOAT);
+  AddNode("while/NextIteration", "NextIteration", {"while/mul"}, DT_FLOAT);
+
+  GrapplerItem item;
+  item.graph = graph_;
+  item.fetch = {"while/Exit"};
+  LoopOptimizer optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(graph_.node_size(), output.node_size());
+  for (int i = 0; i < graph_.node_size(); ++i) {
+    EXPECT_EQ(graph_.node(i).DebugString(), output.node(i).DebugString());
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,147 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/map_and_batch_fusion.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+bool IsMapDataset(const NodeDef& node) {
+  return node.op() == "MapDataset" || node.op() == "ParallelMapDataset";
+}
+
+// Returns the nodes that replace the BatchDataset "batch" of the output of the
+// map dataset "map": the fused op, preceded by the node that computes its
+// num_parallel_calls input.
+std::vector<NodeDef> FuseMapAndBatch(const NodeDef& map, const NodeDef& batch) {
+  const int num_arguments = map.attr().at("Targuments").list().type_size();
+
+  NodeDef num_parallel_calls;
+  num_parallel_calls.set_name(
+      strings::StrCat(batch.name(), "/num_parallel_calls"));
+  num_parallel_calls.set_device(batch.device());
+  if (map.op() == "ParallelMapDataset") {
+    // The number of parallel calls of a ParallelMapDataset is an int32.
+    num_parallel_calls.set_op("Cast");
+    num_parallel_calls.add_input(map.input(1 + num_arguments));
+    (*num_parallel_calls.mutable_attr())["SrcT"].set_type(DT_INT32);
+    (*num_parallel_calls.mutable_attr())["DstT"].set_type(DT_INT64);
+  } else {
+    num_parallel_calls.set_op("Const");
+    (*num_parallel_calls.mutable_attr())["dtype"].set_type(DT_INT64);
+    Tensor one(DT_INT64, TensorShape({}));
+    one.scalar<int64>()() = 1;
+    one.AsProtoField(
+        (*num_parallel_calls.mutable_attr())["value"].mutable_tensor());
+  }
+
+  NodeDef fused;
+  fused.set_name(batch.name());
+  fused.set_op("MapAndBatchDatasetV2");
+  fused.set_device(batch.device());
+  for (int i = 0; i < 1 + num_arguments; ++i) {
+    fused.add_input(map.input(i));
+  }
+  fused.add_input(batch.input(1));
+  fused.add_input(num_parallel_calls.name());
+  (*fused.mutable_attr())["f"] = map.attr().at("f");
+  (*fused.mutable_attr())["Targuments"] = map.attr().at("Targuments");
+  (*fused.mutable_attr())["output_types"] = batch.attr().at("output_types");
+  (*fused.mutable_attr())["output_shapes"] = batch.attr().at("output_shapes");
+  for (const NodeDef* node : {&map, &batch}) {
+    for (int i = NumNonControlInputs(*node); i < node->input_size(); ++i) {
+      fused.add_input(node->input(i));
+    }
+  }
+  return {num_parallel_calls, fused};
+}
+
+}  // namespace
+
+Status MapAndBatchFusion::Optimize(Cluster* /*cluster*/,
+                                   const GrapplerItem& item,
+                                   GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  std::unordered_map<string, std::vector<NodeDef>> fused_nodes;
+  std::unordered_set<string> fused_away;
+  for (const NodeDef& node : optimized_graph->node()) {
+    if (node.op() != "BatchDataset" || NumNonControlInputs(node) != 2) {
+      continue;
+    }
+    const NodeDef* map = node_map.GetNode(node.input(0));
+    if (map == nullptr || !IsMapDataset(*map) ||
+        map->device() != node.device() ||
+        nodes_to_preserve.count(map->name()) > 0 ||
+        node_map.GetOutputs(map->name()).size() != 1 ||
+        NumNonControlOutputs(*map, node_map) != 1 ||
+        node.input(0) != map->name()) {
+      continue;
+    }
+    if (node_map.GetNode(strings::StrCat(node.name(), "/num_parallel_calls")) !=
+        nullptr) {
+      continue;
+    }
+    fused_away.insert(map->name());
+    fused_nodes[node.name()] = FuseMapAndBatch(*map, node);
+  }
+  if (fused_nodes.empty()) {
+    return Status::OK();
+  }
+  VLOG(1) << "Fused " << fused_nodes.size() << " map and batch datasets";
+
+  GraphDef graph;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (fused_away.count(node.name()) > 0) {
+      continue;
+    }
+    auto it = fused_nodes.find(node.name());
+    if (it != fused_nodes.end()) {
+      for (NodeDef& fused_node : it->second) {
+        graph.add_node()->Swap(&fused_node);
+      }
+    } else {
+      graph.add_node()->Swap(&node);
+    }
+  }
+  optimized_graph->mutable_node()->Swap(graph.mutable_node());
+  return Status::OK();
+}
+
+void MapAndBatchFusion::Feedback(Cluster* /*cluster*/,
+                                 const GrapplerItem& /*item*/,
+                                 const GraphDef& /*optimized_graph*/,
+                                 double /*result*/) {
+  // Nothing to do for MapAndBatchFusion.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
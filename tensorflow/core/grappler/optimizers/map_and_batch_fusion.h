@@ -0,0 +1,47 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MAP_AND_BATCH_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MAP_AND_BATCH_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Replaces each BatchDataset whose input is a MapDataset or a
+// ParallelMapDataset consumed by nothing else with a MapAndBatchDatasetV2,
+// which copies the output of each invocation of the map function straight into
+// its slot of the batch. A ParallelMapDataset keeps its number of parallel
+// calls, a MapDataset makes one call at a time. The fused op keeps the name of
+// the BatchDataset, so its consumers are unchanged.
+class MapAndBatchFusion : public GraphOptimizer {
+ public:
+  MapAndBatchFusion() {}
+  ~MapAndBatchFusion() override {}
+
+  string name() const override { return "map_and_batch_fusion"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_MAP_AND_BATCH_FUSION_H_
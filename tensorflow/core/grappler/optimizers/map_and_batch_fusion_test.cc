@@ -0,0 +1,159 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/map_and_batch_fusion.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef Int64Const(const string& name, int64 value) {
+  return NDef(name, "Const", {},
+              {{"value", test::AsScalar<int64>(value)}, {"dtype", DT_INT64}});
+}
+
+class MapAndBatchFusionTest : public ::testing::Test {
+ protected:
+  // Returns a graph in which "batch" batches the elements of "map", a dataset
+  // of the given op that maps "Square" over "range" with the captured
+  // argument "arg".
+  GraphDef MapAndBatchGraph(const string& map_op) {
+    const DataTypeVector types = {DT_INT64};
+    const std::vector<PartialTensorShape> shapes = {PartialTensorShape({})};
+    const std::vector<PartialTensorShape> batch_shapes = {
+        PartialTensorShape({-1})};
+    std::vector<string> map_inputs = {"range", "arg"};
+    if (map_op == "ParallelMapDataset") {
+      map_inputs.push_back("num_parallel_calls");
+    }
+    return test::function::GDef({
+        Int64Const("start", 0),
+        Int64Const("stop", 10),
+        Int64Const("step", 1),
+        NDef("range", "RangeDataset", {"start", "stop", "step"},
+             {{"output_types", types}, {"output_shapes", shapes}}),
+        Int64Const("arg", 2),
+        NDef("num_parallel_calls", "Const", {},
+             {{"value", test::AsScalar<int32>(4)}, {"dtype", DT_INT32}}),
+        NDef("map", map_op, map_inputs,
+             {{"f", FunctionDefHelper::FunctionRef("Square")},
+              {"Targuments", DataTypeVector({DT_INT64})},
+              {"output_types", types},
+              {"output_shapes", shapes}}),
+        Int64Const("batch_size", 3),
+        NDef("batch", "BatchDataset", {"map", "batch_size"},
+             {{"output_types", types}, {"output_shapes", batch_shapes}}),
+    });
+  }
+};
+
+const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) {
+      return &node;
+    }
+  }
+  return nullptr;
+}
+
+TEST_F(MapAndBatchFusionTest, FusesParallelMap) {
+  GrapplerItem item;
+  item.graph = MapAndBatchGraph("ParallelMapDataset");
+  item.fetch = {"batch"};
+
+  MapAndBatchFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "map"));
+  const NodeDef* fused = FindNode(output, "batch");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("MapAndBatchDatasetV2", fused->op());
+  ASSERT_EQ(4, fused->input_size());
+  EXPECT_EQ("range", fused->input(0));
+  EXPECT_EQ("arg", fused->input(1));
+  EXPECT_EQ("batch_size", fused->input(2));
+  EXPECT_EQ("batch/num_parallel_calls", fused->input(3));
+  EXPECT_EQ("Square", fused->attr().at("f").func().name());
+  EXPECT_EQ(-1,
+            fused->attr().at("output_shapes").list().shape(0).dim(0).size());
+
+  const NodeDef* num_parallel_calls =
+      FindNode(output, "batch/num_parallel_calls");
+  ASSERT_NE(nullptr, num_parallel_calls);
+  EXPECT_EQ("Cast", num_parallel_calls->op());
+  ASSERT_EQ(1, num_parallel_calls->input_size());
+  EXPECT_EQ("num_parallel_calls", num_parallel_calls->input(0));
+  EXPECT_EQ(DT_INT64, num_parallel_calls->attr().at("DstT").type());
+}
+
+TEST_F(MapAndBatchFusionTest, FusesSequentialMap) {
+  GrapplerItem item;
+  item.graph = MapAndBatchGraph("MapDataset");
+  item.fetch = {"batch"};
+
+  MapAndBatchFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "map"));
+  EXPECT_EQ("MapAndBatchDatasetV2", FindNode(output, "batch")->op());
+  const NodeDef* num_parallel_calls =
+      FindNode(output, "batch/num_parallel_calls");
+  ASSERT_NE(nullptr, num_parallel_calls);
+  EXPECT_EQ("Const", num_parallel_calls->op());
+  EXPECT_EQ(1, num_parallel_calls->attr().at("value").tensor().int64_val(0));
+}
+
+TEST_F(MapAndBatchFusionTest, KeepsSharedAndFetchedMaps) {
+  GrapplerItem item;
+  item.graph = MapAndBatchGraph("MapDataset");
+  item.fetch = {"batch", "map"};
+
+  MapAndBatchFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ("BatchDataset", FindNode(output, "batch")->op());
+  EXPECT_EQ("MapDataset", FindNode(output, "map")->op());
+
+  // "map" feeds a second dataset.
+  *item.graph.add_node() = Int64Const("repeat_count", 2);
+  *item.graph.add_node() =
+      NDef("repeat", "RepeatDataset", {"map", "repeat_count"},
+           {{"output_types", DataTypeVector({DT_INT64})},
+            {"output_shapes",
+             std::vector<PartialTensorShape>({PartialTensorShape({})})}});
+  item.fetch = {"batch", "repeat"};
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ("BatchDataset", FindNode(output, "batch")->op());
+  EXPECT_EQ("MapDataset", FindNode(output, "map")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
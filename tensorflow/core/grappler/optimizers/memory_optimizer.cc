@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <queue>
+#include <set>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -531,6 +533,12 @@ struct SwapInfo {
   Costs::NanoSeconds time_to_swap = 0;
 };
 
+// Estimates the time it takes to copy a tensor between the host and a
+// device, assuming PCIe running at 16 GBps.
+static Costs::NanoSeconds EstimateSwapTime(int64 bytes) {
+  return Costs::NanoSeconds(bytes / 16);
+}
+
 static const NodeDef* FindSwapTrigger(
     const NodeDef* node, const SwapInfo& swap_info,
     const std::unordered_map<string, const NodeDef*>& name_map,
@@ -605,6 +613,17 @@ static const NodeDef* FindSwapTrigger(
   return nullptr;
 }
 
+// A tensor live at the peak memory usage of a device that can be swapped out
+// to the host between its last two uses, with both copies hidden behind the
+// computation that runs in between.
+struct SwapCandidate {
+  NodeDef* fanout_to_swap;
+  int port_to_swap;
+  int64 memory_used;
+  // The time between the two uses that is not spent copying the tensor.
+  Costs::NanoSeconds slack;
+};
+
 static void IdentifySwappingCandidates(Cluster* cluster,
                                        const GrapplerItem& item,
                                        GraphDef* optimized_graph) {
@@ -615,6 +634,32 @@ static void IdentifySwappingCandidates(Cluster* cluster,
     return;
   }
 
+  // The execution times are keyed by the nodes of item.graph: look them up by
+  // name to find those of the nodes of the optimized graph.
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
+  if (!EstimateEarliestExecutionTimes(item, cluster, &execution_times).ok()) {
+    return;
+  }
+  std::unordered_map<string, const NodeDef*> name_map;
+  for (const auto& node : item.graph.node()) {
+    name_map[node.name()] = &node;
+  }
+  auto execution_time = [&name_map, &execution_times](
+                            const string& node_name, Costs::NanoSeconds* t) {
+    auto it1 = name_map.find(node_name);
+    if (it1 == name_map.end()) {
+      return false;
+    }
+    auto it2 = execution_times.find(it1->second);
+    if (it2 == execution_times.end()) {
+      return false;
+    }
+    *t = it2->second;
+    return true;
+  };
+
+  GraphView graph(optimized_graph);
+  std::unordered_map<const NodeDef*, SwapInfo> swaps;
   for (const auto& device : devices) {
     const string& name = device.first;
     const DeviceProperties& prop = device.second;
@@ -629,55 +674,386 @@ static void IdentifySwappingCandidates(Cluster* cluster,
       continue;
     }
     int64 required_savings = mem_usage.used_memory - prop.memory_size();
-    // TODO(bsteiner): sort the tensors by how long they're live.
 
-    std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
-    if (!EstimateEarliestExecutionTimes(item, cluster, &execution_times).ok()) {
-      return;
-    }
-    GraphView graph(optimized_graph);
+    std::vector<SwapCandidate> candidates;
     for (const auto& live_tensor : mem_usage.live_tensors) {
-      if (live_tensor.deallocation_time - live_tensor.allocation_time <=
-          Costs::Duration(1e6)) {
-        // Not enough time to swap.
-        continue;
-      }
       if (live_tensor.memory_used <= 1024) {
         // Don't bother with small tensors.
         continue;
       }
-      Costs::NanoSeconds execution_time(-1);
+      // The tensor is idle between its last use but one, possibly by the op
+      // that produces it, and its last use, by fanout_to_swap.
+      Costs::NanoSeconds last_use(-1);
+      Costs::NanoSeconds previous_use(-1);
+      if (!execution_time(live_tensor.node, &previous_use)) {
+        continue;
+      }
       GraphView::InputPort fanout_to_swap;
+      fanout_to_swap.node = nullptr;
       GraphView::OutputPort port =
           graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
       for (GraphView::InputPort input : graph.GetFanout(port)) {
-        auto it = execution_times.find(input.node);
-        if (it != execution_times.end()) {
-          if (it->second > execution_time) {
-            fanout_to_swap = input;
-            execution_time = it->second;
-          }
+        Costs::NanoSeconds t;
+        if (input.port_id < 0 || !execution_time(input.node->name(), &t)) {
+          continue;
         }
-      }
-      // Annotate the fanout to request the tensor to be swapped if it's not
-      // already been done.
-      AttrValue& val = (*fanout_to_swap.node->mutable_attr())["_swap_to_host"];
-      bool found = false;
-      for (int port_id : val.list().i()) {
-        if (port_id == fanout_to_swap.port_id) {
-          found = true;
-          break;
+        if (t > last_use) {
+          previous_use = std::max(previous_use, last_use);
+          fanout_to_swap = input;
+          last_use = t;
+        } else {
+          previous_use = std::max(previous_use, t);
         }
       }
-      if (!found) {
-        val.mutable_list()->add_i(fanout_to_swap.port_id);
-        required_savings -= live_tensor.memory_used;
-        if (required_savings < 0) {
-          break;
+      if (fanout_to_swap.node == nullptr) {
+        continue;
+      }
+      // The tensor must be copied out and back in while it is idle.
+      const Costs::NanoSeconds swap_time =
+          EstimateSwapTime(live_tensor.memory_used);
+      const Costs::NanoSeconds slack = last_use - previous_use - 2 * swap_time;
+      if (slack <= Costs::NanoSeconds(0)) {
+        // Not enough time to swap.
+        continue;
+      }
+      candidates.push_back({fanout_to_swap.node, fanout_to_swap.port_id,
+                            static_cast<int64>(live_tensor.memory_used),
+                            slack});
+    }
+
+    // Swapping any tensor frees as much memory as it copies, so start with
+    // those whose copies are the most comfortably hidden: they are the least
+    // likely to delay the step if the cost estimates are off.
+    std::sort(candidates.begin(), candidates.end(),
+              [](const SwapCandidate& a, const SwapCandidate& b) {
+                return a.slack > b.slack;
+              });
+    for (const SwapCandidate& candidate : candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      SwapInfo swap_info;
+      auto it = swaps.find(candidate.fanout_to_swap);
+      if (it != swaps.end()) {
+        swap_info = it->second;
+      }
+      if (std::find(swap_info.inputs_to_swap.begin(),
+                    swap_info.inputs_to_swap.end(),
+                    candidate.port_to_swap) != swap_info.inputs_to_swap.end()) {
+        continue;
+      }
+      swap_info.inputs_to_swap.push_back(candidate.port_to_swap);
+      swap_info.time_to_swap += EstimateSwapTime(candidate.memory_used);
+      // The swap is only applied if there is a node to trigger the copy back
+      // to the device in time.
+      if (FindSwapTrigger(candidate.fanout_to_swap, swap_info, name_map,
+                          execution_times) == nullptr) {
+        continue;
+      }
+      swaps[candidate.fanout_to_swap] = swap_info;
+      required_savings -= candidate.memory_used;
+    }
+  }
+
+  // Annotate the fanouts to request the tensors to be swapped.
+  for (const auto& swap : swaps) {
+    NodeDef* node = graph.GetNode(swap.first->name());
+    AttrValue& val = (*node->mutable_attr())["_swap_to_host"];
+    std::set<int> ports(val.list().i().begin(), val.list().i().end());
+    for (int port_id : swap.second.inputs_to_swap) {
+      if (ports.insert(port_id).second) {
+        val.mutable_list()->add_i(port_id);
+      }
+    }
+  }
+}
+
+// The smallest reduction of the peak memory usage, as a fraction of the peak
+// usage of the default order, that is worth enforcing a schedule.
+static const double kMinPeakMemoryReduction = 0.1;
+// Only the nodes whose outputs are at least this large are delayed.
+static const int64 kMinDelayedNodeBytes = 1 << 20;
+// The number of nodes of the schedule that precede a node that are searched
+// for a node to delay it after.
+static const int kMaxScheduleLookback = 100;
+
+// The nodes of a graph, by index, with the sizes of their outputs.
+struct ScheduleGraph {
+  std::vector<int64> output_bytes;
+  // The distinct nodes whose outputs each node reads.
+  std::vector<std::vector<int>> data_fanins;
+  // The distinct nodes that must run before each node.
+  std::vector<std::vector<int>> fanins;
+  std::vector<std::vector<int>> data_fanouts;
+  std::vector<std::vector<int>> fanouts;
+};
+
+// Returns the peak memory usage of the execution of the nodes one at a time in
+// "order": the outputs of a node are allocated when it runs, and freed once
+// their last consumer has run.
+static int64 SimulatePeakMemory(const ScheduleGraph& graph,
+                                const std::vector<int>& order) {
+  std::vector<int> remaining_uses(graph.data_fanouts.size());
+  for (int i = 0; i < remaining_uses.size(); ++i) {
+    remaining_uses[i] = graph.data_fanouts[i].size();
+  }
+  int64 live = 0;
+  int64 peak = 0;
+  for (int node : order) {
+    live += graph.output_bytes[node];
+    peak = std::max(peak, live);
+    for (int fanin : graph.data_fanins[node]) {
+      if (--remaining_uses[fanin] == 0) {
+        live -= graph.output_bytes[fanin];
+      }
+    }
+    if (remaining_uses[node] == 0) {
+      live -= graph.output_bytes[node];
+    }
+  }
+  return peak;
+}
+
+// Returns in "order" a topological order of the nodes that greedily keeps the
+// memory usage low: among the nodes that are ready, it runs the one that
+// increases the memory usage the least, and the earliest one in case of a tie.
+// "net_bytes" receives the change of memory usage caused by the execution of
+// each node in that order.
+static bool ScheduleForMemory(const ScheduleGraph& graph,
+                              const std::vector<int64>& earliest_times,
+                              std::vector<int>* order,
+                              std::vector<int64>* net_bytes) {
+  const int num_nodes = graph.fanins.size();
+  std::vector<int> remaining_uses(num_nodes);
+  std::vector<int> pending_fanins(num_nodes);
+  std::vector<bool> is_ready(num_nodes, false);
+  for (int i = 0; i < num_nodes; ++i) {
+    remaining_uses[i] = graph.data_fanouts[i].size();
+    pending_fanins[i] = graph.fanins[i].size();
+  }
+  auto net = [&graph, &remaining_uses](int node) {
+    int64 bytes = graph.output_bytes[node];
+    for (int fanin : graph.data_fanins[node]) {
+      if (remaining_uses[fanin] == 1) {
+        bytes -= graph.output_bytes[fanin];
+      }
+    }
+    if (remaining_uses[node] == 0) {
+      bytes -= graph.output_bytes[node];
+    }
+    return bytes;
+  };
+
+  typedef std::tuple<int64, int64, int> Key;
+  std::set<Key> ready;
+  std::vector<Key> keys(num_nodes);
+  auto make_ready = [&](int node) {
+    keys[node] = Key(net(node), earliest_times[node], node);
+    ready.insert(keys[node]);
+    is_ready[node] = true;
+  };
+  for (int i = 0; i < num_nodes; ++i) {
+    if (pending_fanins[i] == 0) {
+      make_ready(i);
+    }
+  }
+  order->clear();
+  net_bytes->assign(num_nodes, 0);
+  while (!ready.empty()) {
+    const int node = std::get<2>(*ready.begin());
+    ready.erase(ready.begin());
+    is_ready[node] = false;
+    (*net_bytes)[node] = std::get<0>(keys[node]);
+    order->push_back(node);
+    for (int fanin : graph.data_fanins[node]) {
+      if (--remaining_uses[fanin] != 1) {
+        continue;
+      }
+      // The last consumer of the fanin now frees it.
+      for (int fanout : graph.data_fanouts[fanin]) {
+        if (is_ready[fanout]) {
+          ready.erase(keys[fanout]);
+          make_ready(fanout);
         }
       }
     }
+    for (int fanout : graph.fanouts[node]) {
+      if (--pending_fanins[fanout] == 0) {
+        make_ready(fanout);
+      }
+    }
+  }
+  return order->size() == num_nodes;
+}
+
+// Adds control dependencies to delay the execution of the nodes whose outputs
+// are live at the peak memory usage until other nodes have freed memory, as
+// they would be in a schedule that greedily minimizes the memory usage. Only
+// the nodes that have enough slack to be delayed and still complete by the
+// time their fanouts need them are delayed, so the critical path is preserved.
+static void ScheduleToReducePeakMemory(Cluster* cluster,
+                                       const GrapplerItem& item,
+                                       GraphPropertiesCache* properties_cache,
+                                       GraphDef* optimized_graph) {
+  const GraphDef& graph_def = item.graph;
+  const int num_nodes = graph_def.node_size();
+  std::unordered_map<string, int> node_ids;
+  for (int i = 0; i < num_nodes; ++i) {
+    // Loops can't be scheduled in a topological order.
+    if (IsMerge(graph_def.node(i)) || IsNextIteration(graph_def.node(i))) {
+      return;
+    }
+    node_ids[graph_def.node(i).name()] = i;
+  }
+
+  GraphProperties properties(item, properties_cache);
+  if (!properties.InferStatically(false).ok()) {
+    return;
+  }
+  ScheduleGraph graph;
+  graph.output_bytes.resize(num_nodes, 0);
+  graph.data_fanins.resize(num_nodes);
+  graph.fanins.resize(num_nodes);
+  graph.data_fanouts.resize(num_nodes);
+  graph.fanouts.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = graph_def.node(i);
+    if (properties.HasOutputProperties(node.name())) {
+      for (const auto& output : properties.GetOutputProperties(node.name())) {
+        graph.output_bytes[i] += EstimateSize(output);
+      }
+    }
+    std::set<int> data_fanins;
+    std::set<int> fanins;
+    for (const string& input : node.input()) {
+      auto it = node_ids.find(NodeName(input));
+      if (it == node_ids.end()) {
+        return;
+      }
+      fanins.insert(it->second);
+      if (!IsControlInput(input)) {
+        data_fanins.insert(it->second);
+      }
+    }
+    for (int fanin : fanins) {
+      graph.fanins[i].push_back(fanin);
+      graph.fanouts[fanin].push_back(i);
+    }
+    for (int fanin : data_fanins) {
+      graph.data_fanins[i].push_back(fanin);
+      graph.data_fanouts[fanin].push_back(i);
+    }
+  }
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> execution_times;
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> required_times;
+  if (!EstimateEarliestExecutionTimes(item, cluster, &execution_times).ok() ||
+      !EstimateRequiredTimes(item, cluster, execution_times, &required_times)
+           .ok()) {
+    return;
+  }
+  std::vector<int64> earliest_times(num_nodes);
+  std::vector<int64> latest_times(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef* node = &graph_def.node(i);
+    if (execution_times.count(node) == 0 || required_times.count(node) == 0) {
+      return;
+    }
+    earliest_times[i] = execution_times[node].count();
+    latest_times[i] = required_times[node].count();
+  }
+  // The execution time of each node: it starts as soon as its fanins have
+  // completed.
+  std::vector<int64> durations(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    int64 start = 0;
+    for (int fanin : graph.fanins[i]) {
+      start = std::max(start, earliest_times[fanin]);
+    }
+    durations[i] = earliest_times[i] - start;
+  }
+
+  // The executor runs the nodes roughly in the order of their earliest
+  // completion times.
+  std::vector<int> default_order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    default_order[i] = i;
+  }
+  std::stable_sort(default_order.begin(), default_order.end(),
+                   [&earliest_times](int a, int b) {
+                     return earliest_times[a] < earliest_times[b];
+                   });
+  std::vector<int> order;
+  std::vector<int64> net_bytes;
+  if (!ScheduleForMemory(graph, earliest_times, &order, &net_bytes)) {
+    return;
+  }
+  const int64 default_peak = SimulatePeakMemory(graph, default_order);
+  const int64 scheduled_peak = SimulatePeakMemory(graph, order);
+  VLOG(1) << "Peak memory usage of the default order: " << default_peak
+          << " bytes, of the memory-aware schedule: " << scheduled_peak
+          << " bytes";
+  if (default_peak - scheduled_peak <
+      kMinPeakMemoryReduction * default_peak) {
+    return;
+  }
+
+  // The nodes to delay are those that allocate the large tensors live at the
+  // peak memory usage of each device.
+  GraphMemory memory(item);
+  const std::unordered_map<string, DeviceProperties>& devices =
+      cluster->GetDevices();
+  if (!memory.InferStatically(devices).ok()) {
+    return;
+  }
+  std::set<int> nodes_to_delay;
+  for (const auto& device : devices) {
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      auto it = node_ids.find(live_tensor.node);
+      if (it != node_ids.end() &&
+          live_tensor.memory_used >= kMinDelayedNodeBytes) {
+        nodes_to_delay.insert(it->second);
+      }
+    }
+  }
+
+  std::vector<int> positions(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    positions[order[i]] = i;
   }
+  NodeMap node_map(optimized_graph);
+  int num_delayed = 0;
+  for (int node : nodes_to_delay) {
+    if (latest_times[node] <= earliest_times[node]) {
+      // On the critical path.
+      continue;
+    }
+    const NodeDef& node_def = graph_def.node(node);
+    const int first = std::max(0, positions[node] - kMaxScheduleLookback);
+    for (int pos = positions[node] - 1; pos >= first; --pos) {
+      const int prev = order[pos];
+      const NodeDef& prev_def = graph_def.node(prev);
+      // The previous node must free memory, not already be known to complete
+      // before the node starts, and leave it enough time to complete.
+      if (net_bytes[prev] >= 0 || prev_def.device() != node_def.device() ||
+          earliest_times[prev] <= earliest_times[node] - durations[node] ||
+          earliest_times[prev] + durations[node] > latest_times[node]) {
+        continue;
+      }
+      NodeDef* delayed = node_map.GetNode(node_def.name());
+      if (delayed == nullptr || !node_map.NodeExists(prev_def.name())) {
+        break;
+      }
+      delayed->add_input(AsControlDependency(prev_def.name()));
+      node_map.AddOutput(prev_def.name(), delayed->name());
+      earliest_times[node] = earliest_times[prev] + durations[node];
+      ++num_delayed;
+      break;
+    }
+  }
+  VLOG(1) << "Delayed " << num_delayed << " nodes to reduce the peak memory";
 }
 
 Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -692,6 +1068,12 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     IdentifySwappingCandidates(cluster, item, optimized_graph);
   }
 
+  if (optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS &&
+      cluster != nullptr) {
+    ScheduleToReducePeakMemory(cluster, item, properties_cache(),
+                               optimized_graph);
+  }
+
   // Figure out what needs to be swapped;
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   for (auto& node : *optimized_graph->mutable_node()) {
@@ -715,7 +1097,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   {
     // Estimate the size of the data to swap for each node.
-    GraphProperties properties(item);
+    GraphProperties properties(item, properties_cache());
     TF_RETURN_IF_ERROR(properties.InferStatically(true));
     for (auto& swap : nodes_to_swap) {
       const NodeDef* node = swap.first;
@@ -727,8 +1109,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
         const OpInfo::TensorProperties& t = props[input_id];
         bytes_to_swap += EstimateSize(t);
       }
-      // Let's assume we're going to swap over PCIe running at 16 GBps.
-      swap_info.time_to_swap = bytes_to_swap / 16;
+      swap_info.time_to_swap = EstimateSwapTime(bytes_to_swap);
     }
   }
 
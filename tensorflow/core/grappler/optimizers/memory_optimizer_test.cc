@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -252,6 +253,104 @@ TEST_F(MemoryOptimizerTest, SimpleSwapping) {
   EXPECT_EQ("^c", swap_in.input(1));
 }
 
+TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
+  // "b" is idle on the GPU while "d" and "e" run, long enough to be copied to
+  // the host and back.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/GPU:0");
+  Output a = ops::Variable(s.WithOpName("a"), {1024, 1024}, DT_FLOAT);
+  Output b = ops::AddN(s.WithOpName("b"), {a});
+  Output c = ops::MatMul(s.WithOpName("c"), b, b);
+  Output d = ops::MatMul(s.WithOpName("d"), c, c);
+  Output e = ops::MatMul(s.WithOpName("e"), d, d);
+  Output f = ops::AddN(s.WithOpName("f"), {b, e});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"f"};
+
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  gpu_device.set_frequency(1000);
+  gpu_device.set_num_cores(1);
+  gpu_device.set_bandwidth(32);
+  // Less than the 3 matrices that are live while "d" runs.
+  gpu_device.set_memory_size(10 * 1024 * 1024);
+  (*gpu_device.mutable_environment())["architecture"] = "3";
+  std::unordered_map<string, DeviceProperties> devices;
+  devices["/GPU:0"] = gpu_device;
+  VirtualCluster cluster(devices);
+
+  MemoryOptimizer optimizer(RewriterConfig::SWAPPING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cluster, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* new_f = node_map.GetNode("f");
+  ASSERT_NE(nullptr, new_f);
+  EXPECT_EQ("swap_in_f_0", new_f->input(0));
+  EXPECT_EQ("e", new_f->input(1));
+  const NodeDef* swap_out = node_map.GetNode("swap_out_f_0");
+  ASSERT_NE(nullptr, swap_out);
+  EXPECT_EQ("b", swap_out->input(0));
+  const NodeDef* swap_in = node_map.GetNode("swap_in_f_0");
+  ASSERT_NE(nullptr, swap_in);
+  EXPECT_EQ("swap_out_f_0", swap_in->input(0));
+  // The copy back starts once "d" has run, to be done in time for "f".
+  EXPECT_EQ("^d", swap_in->input(1));
+  // The other tensors are only idle while a single MatMul runs, or have no
+  // node to trigger their copy back.
+  EXPECT_EQ(nullptr, node_map.GetNode("swap_in_d_0"));
+  EXPECT_EQ(nullptr, node_map.GetNode("swap_in_e_0"));
+}
+
+TEST_F(MemoryOptimizerTest, SchedulingHeuristics) {
+  // "a1" and "b1" are live at the same time in the default order, but "b1"
+  // can wait for "a2" to free "a1" and still complete before the longer
+  // branch that starts with "a1".
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/GPU:0");
+  Output v = ops::Variable(s.WithOpName("v"), {1024, 1024}, DT_FLOAT);
+  Output w = ops::Variable(s.WithOpName("w"), {512, 512}, DT_FLOAT);
+  Output a1 = ops::AddN(s.WithOpName("a1"), {v});
+  Output a2 = ops::Sum(s.WithOpName("a2"), a1, {0, 1});
+  Output tail = ops::Mul(s.WithOpName("t0"), w, a2);
+  for (int i = 1; i <= 10; ++i) {
+    tail = ops::MatMul(s.WithOpName(strings::StrCat("t", i)), tail, w);
+  }
+  Output b1 = ops::AddN(s.WithOpName("b1"), {v});
+  Output b2 = ops::Sum(s.WithOpName("b2"), b1, {0, 1});
+  Output out = ops::Add(s.WithOpName("out"), tail, b2);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"out"};
+
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  gpu_device.set_frequency(1000);
+  gpu_device.set_num_cores(1);
+  gpu_device.set_bandwidth(32);
+  gpu_device.set_memory_size(1024 * 1024 * 1024);
+  (*gpu_device.mutable_environment())["architecture"] = "3";
+  std::unordered_map<string, DeviceProperties> devices;
+  devices["/GPU:0"] = gpu_device;
+  VirtualCluster cluster(devices);
+
+  MemoryOptimizer optimizer(RewriterConfig::SCHEDULING_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(&cluster, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* new_b1 = node_map.GetNode("b1");
+  ASSERT_NE(nullptr, new_b1);
+  ASSERT_EQ(2, new_b1->input_size());
+  EXPECT_EQ("v", new_b1->input(0));
+  EXPECT_EQ("^a2", new_b1->input(1));
+  // "a1" is on the critical path, so it is not delayed.
+  const NodeDef* new_a1 = node_map.GetNode("a1");
+  ASSERT_NE(nullptr, new_a1);
+  EXPECT_EQ(1, new_a1->input_size());
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
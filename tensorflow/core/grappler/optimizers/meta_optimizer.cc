@@ -16,14 +16,21 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/core/grappler/optimizers/conv_bias_fusion.h"
 #include "tensorflow/core/grappler/optimizers/dependency_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/elementwise_fusion.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/layout_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/map_and_batch_fusion.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/small_op_batching.h"
+#include "tensorflow/core/grappler/optimizers/sparse_embedding_fusion.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/status.h"
 
@@ -50,9 +57,27 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::NewOptimizer(
     graph_optimizer.reset(
         new ArithmeticOptimizer(cfg_.arithmetic_optimization()));
   }
+  if (optimizer == "elementwise") {
+    graph_optimizer.reset(new ElementwiseFusion());
+  }
+  if (optimizer == "loop") {
+    graph_optimizer.reset(new LoopOptimizer());
+  }
+  if (optimizer == "map_and_batch") {
+    graph_optimizer.reset(new MapAndBatchFusion());
+  }
+  if (optimizer == "sparse_embedding") {
+    graph_optimizer.reset(new SparseEmbeddingFusion());
+  }
+  if (optimizer == "conv_bias") {
+    graph_optimizer.reset(new ConvBiasFusion());
+  }
+  if (optimizer == "small_op") {
+    graph_optimizer.reset(new SmallOpBatching());
+  }
   if (optimizer == "autoparallel") {
-    graph_optimizer.reset(
-        new AutoParallel(cfg_.auto_parallel().num_replicas()));
+    graph_optimizer.reset(new AutoParallel(cfg_.auto_parallel().num_replicas(),
+                                           cfg_.auto_parallel().use_nccl()));
   }
   if (optimizer == "dependency") {
     graph_optimizer.reset(
@@ -69,13 +94,42 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(new ModelPruner()));
     }
     if (cfg_.constant_folding() != RewriterConfig::OFF) {
+      const int64 max_constant_size_bytes =
+          cfg_.max_folded_constant_size_bytes() > 0
+              ? cfg_.max_folded_constant_size_bytes()
+              : kDefaultMaxConstantSizeBytes;
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(
-          new ConstantFolding(cfg_.constant_folding(), cpu_device_)));
+          new ConstantFolding(cfg_.constant_folding(), cpu_device_,
+                              max_constant_size_bytes)));
     }
     if (cfg_.arithmetic_optimization() != RewriterConfig::OFF) {
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(
           new ArithmeticOptimizer(cfg_.arithmetic_optimization())));
     }
+    if (cfg_.elementwise_fusion() == RewriterConfig::ON) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new ElementwiseFusion()));
+    }
+    if (cfg_.loop_optimization() == RewriterConfig::ON) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new LoopOptimizer()));
+    }
+    if (cfg_.map_and_batch_fusion() == RewriterConfig::ON) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new MapAndBatchFusion()));
+    }
+    if (cfg_.sparse_embedding_fusion() == RewriterConfig::ON) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new SparseEmbeddingFusion()));
+    }
+    if (cfg_.conv_bias_fusion() == RewriterConfig::ON) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new ConvBiasFusion()));
+    }
+    if (cfg_.small_op_batching() == RewriterConfig::ON) {
+      optimizers.push_back(
+          std::unique_ptr<GraphOptimizer>(new SmallOpBatching()));
+    }
     if (cfg_.dependency_optimization() != RewriterConfig::OFF) {
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(
           new DependencyOptimizer(cfg_.dependency_optimization())));
@@ -98,12 +152,16 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     }
     if (cfg_.auto_parallel().enable()) {
       optimizers.push_back(std::unique_ptr<GraphOptimizer>(
-          new AutoParallel(cfg_.auto_parallel().num_replicas())));
+          new AutoParallel(cfg_.auto_parallel().num_replicas(),
+                           cfg_.auto_parallel().use_nccl())));
     }
   } else {
     std::set<string> available_optimizers = {
-        "pruning",      "constfold",  "layout",    "memory",
-        "autoparallel", "arithmetic", "dependency"};
+        "pruning",       "constfold",        "layout",
+        "memory",        "autoparallel",     "arithmetic",
+        "dependency",    "elementwise",      "loop",
+        "map_and_batch", "sparse_embedding", "conv_bias",
+        "small_op"};
     for (const auto& optimizer : cfg_.optimizers()) {
       if (available_optimizers.find(optimizer) != available_optimizers.end()) {
         optimizers.push_back(NewOptimizer(optimizer));
@@ -116,8 +174,12 @@ Status MetaOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     return Status::OK();
   }
 
+  // Shared by the optimizers, so that a graph left unchanged by an optimizer
+  // doesn't have its shapes inferred again by the next one.
+  GraphPropertiesCache properties_cache;
   bool already_optimized = false;
   for (const auto& optimizer : optimizers) {
+    optimizer->set_properties_cache(&properties_cache);
     if (!already_optimized) {
       auto status = optimizer->Optimize(cluster, item, optimized_graph);
       string result;
@@ -193,6 +255,12 @@ bool MetaOptimizerEnabled(const RewriterConfig& cfg) {
          cfg.constant_folding() != RewriterConfig::OFF ||
          cfg.dependency_optimization() != RewriterConfig::OFF ||
          cfg.arithmetic_optimization() != RewriterConfig::OFF ||
+         cfg.elementwise_fusion() == RewriterConfig::ON ||
+         cfg.loop_optimization() == RewriterConfig::ON ||
+         cfg.map_and_batch_fusion() == RewriterConfig::ON ||
+         cfg.sparse_embedding_fusion() == RewriterConfig::ON ||
+         cfg.conv_bias_fusion() == RewriterConfig::ON ||
+         cfg.small_op_batching() == RewriterConfig::ON ||
          cfg.auto_parallel().enable() || cfg.memory_optimization() > 1 ||
          !cfg.optimizers().empty();
 }
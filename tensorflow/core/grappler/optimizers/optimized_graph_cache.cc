@@ -0,0 +1,134 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include <map>
+
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Appends the length of "s" before "s", so that the concatenation of the
+// fields can't be ambiguous.
+void AppendField(const string& s, string* key_data) {
+  strings::StrAppend(key_data, s.size(), ":", s);
+}
+
+void AppendProto(const protobuf::MessageLite& proto, string* key_data) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendField(serialized, key_data);
+}
+
+}  // namespace
+
+OptimizedGraphCache::OptimizedGraphCache(const string& cache_dir, Env* env)
+    : cache_dir_(cache_dir), env_(env) {}
+
+string OptimizedGraphCache::Key(
+    const GrapplerItem& item, const RewriterConfig& cfg,
+    const std::unordered_map<string, DeviceProperties>& devices) {
+  string key_data;
+  AppendField(TF_VERSION_STRING, &key_data);
+  AppendField(strings::StrCat(TF_GRAPH_DEF_VERSION), &key_data);
+  AppendProto(item.graph, &key_data);
+
+  AppendField(strings::StrCat(item.fetch.size()), &key_data);
+  for (const string& fetch : item.fetch) {
+    AppendField(fetch, &key_data);
+  }
+  // The values fed to the optimizers are placeholders: only their types and
+  // shapes matter.
+  AppendField(strings::StrCat(item.feed.size()), &key_data);
+  for (const auto& feed : item.feed) {
+    AppendField(feed.first, &key_data);
+    AppendField(strings::StrCat(feed.second.dtype()), &key_data);
+    TensorShapeProto shape;
+    feed.second.shape().AsProto(&shape);
+    AppendProto(shape, &key_data);
+  }
+
+  const std::map<string, DeviceProperties> sorted_devices(devices.begin(),
+                                                          devices.end());
+  AppendField(strings::StrCat(sorted_devices.size()), &key_data);
+  for (const auto& device : sorted_devices) {
+    AppendField(device.first, &key_data);
+    AppendProto(device.second, &key_data);
+  }
+
+  // Where the cache lives doesn't change the optimized graph.
+  RewriterConfig cfg_without_cache = cfg;
+  cfg_without_cache.clear_optimized_graph_cache_dir();
+  AppendProto(cfg_without_cache, &key_data);
+
+  const Fprint128 fingerprint = Fingerprint128(key_data);
+  return strings::Printf("%016llx%016llx",
+                         static_cast<unsigned long long>(fingerprint.high64),
+                         static_cast<unsigned long long>(fingerprint.low64));
+}
+
+bool OptimizedGraphCache::Lookup(const string& key,
+                                 GraphDef* optimized_graph) const {
+  const string filename = FileName(key);
+  if (!env_->FileExists(filename).ok()) {
+    return false;
+  }
+  Status s = ReadBinaryProto(env_, filename, optimized_graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring unreadable optimized graph " << filename << ": "
+                 << s;
+    optimized_graph->Clear();
+    return false;
+  }
+  VLOG(1) << "Read optimized graph from " << filename;
+  return true;
+}
+
+Status OptimizedGraphCache::Insert(const string& key,
+                                   const GraphDef& optimized_graph) const {
+  Status s = env_->RecursivelyCreateDir(cache_dir_);
+  if (!s.ok() && s.code() != error::ALREADY_EXISTS) {
+    return s;
+  }
+  const string filename = FileName(key);
+  const string tmp_filename =
+      strings::StrCat(filename, ".tmp", strings::Hex(random::New64()));
+  s = WriteBinaryProto(env_, tmp_filename, optimized_graph);
+  if (s.ok()) {
+    s = env_->RenameFile(tmp_filename, filename);
+  }
+  if (!s.ok()) {
+    env_->DeleteFile(tmp_filename).IgnoreError();
+  }
+  return s;
+}
+
+string OptimizedGraphCache::FileName(const string& key) const {
+  return io::JoinPath(cache_dir_, strings::StrCat(key, ".pb"));
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
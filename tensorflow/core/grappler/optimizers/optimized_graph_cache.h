@@ -0,0 +1,69 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+#define TENSORFLOW_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A cache of the graphs optimized by the meta-optimizer, stored on disk so it
+// is shared by the sessions of all the processes that use the same directory.
+// Each graph is stored in its own file, named after the fingerprint of
+// everything the optimization depends on: the input graph and its function
+// library, the fetches, the shapes and types of the feeds, the devices and
+// the rewriter config. The fingerprint also covers the version of TensorFlow,
+// so upgrading the binary invalidates the cache.
+class OptimizedGraphCache {
+ public:
+  // Does not take ownership of env.
+  explicit OptimizedGraphCache(const string& cache_dir,
+                               Env* env = Env::Default());
+
+  // Returns the key under which the result of optimizing "item" with "cfg"
+  // for "devices" is cached.
+  static string Key(
+      const GrapplerItem& item, const RewriterConfig& cfg,
+      const std::unordered_map<string, DeviceProperties>& devices);
+
+  // Reads the graph cached under "key" into "optimized_graph". Returns false
+  // if there is none, or if it can't be read.
+  bool Lookup(const string& key, GraphDef* optimized_graph) const;
+
+  // Caches "optimized_graph" under "key". The graph is written to a temporary
+  // file that is then renamed, so concurrent lookups never see a partially
+  // written graph.
+  Status Insert(const string& key, const GraphDef& optimized_graph) const;
+
+ private:
+  string FileName(const string& key) const;
+
+  const string cache_dir_;
+  Env* const env_;  // Not owned.
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_GRAPPLER_OPTIMIZERS_OPTIMIZED_GRAPH_CACHE_H_
@@ -0,0 +1,97 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_graph_cache.h"
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class OptimizedGraphCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+    CHECK(fake_input.NextItem(&item_));
+    DeviceProperties cpu;
+    cpu.set_type("CPU");
+    devices_["/job:localhost/replica:0/task:0/cpu:0"] = cpu;
+  }
+
+  GrapplerItem item_;
+  RewriterConfig cfg_;
+  std::unordered_map<string, DeviceProperties> devices_;
+};
+
+TEST_F(OptimizedGraphCacheTest, Key) {
+  const string key = OptimizedGraphCache::Key(item_, cfg_, devices_);
+  EXPECT_EQ(32, key.size());
+  EXPECT_EQ(key, OptimizedGraphCache::Key(item_, cfg_, devices_));
+
+  // The location of the cache is not part of the key.
+  RewriterConfig cfg_with_dir = cfg_;
+  cfg_with_dir.set_optimized_graph_cache_dir("/tmp/cache");
+  EXPECT_EQ(key, OptimizedGraphCache::Key(item_, cfg_with_dir, devices_));
+
+  RewriterConfig other_cfg = cfg_;
+  other_cfg.set_constant_folding(RewriterConfig::OFF);
+  EXPECT_NE(key, OptimizedGraphCache::Key(item_, other_cfg, devices_));
+
+  GrapplerItem other_item = item_;
+  other_item.fetch.push_back(item_.graph.node(0).name());
+  EXPECT_NE(key, OptimizedGraphCache::Key(other_item, cfg_, devices_));
+
+  other_item = item_;
+  other_item.graph.mutable_node(0)->set_device("/cpu:1");
+  EXPECT_NE(key, OptimizedGraphCache::Key(other_item, cfg_, devices_));
+
+  std::unordered_map<string, DeviceProperties> other_devices = devices_;
+  other_devices["/job:localhost/replica:0/task:0/gpu:0"].set_type("GPU");
+  EXPECT_NE(key, OptimizedGraphCache::Key(item_, cfg_, other_devices));
+}
+
+TEST_F(OptimizedGraphCacheTest, LookupAndInsert) {
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache_test");
+  OptimizedGraphCache cache(cache_dir);
+  const string key = OptimizedGraphCache::Key(item_, cfg_, devices_);
+
+  GraphDef optimized_graph;
+  EXPECT_FALSE(cache.Lookup(key, &optimized_graph));
+  TF_EXPECT_OK(cache.Insert(key, item_.graph));
+  ASSERT_TRUE(cache.Lookup(key, &optimized_graph));
+  EXPECT_EQ(item_.graph.DebugString(), optimized_graph.DebugString());
+
+  // Another cache in the same directory sees the graph.
+  OptimizedGraphCache other_cache(cache_dir);
+  GraphDef other_graph;
+  EXPECT_TRUE(other_cache.Lookup(key, &other_graph));
+
+  // Corrupted entries are ignored.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 io::JoinPath(cache_dir, key + ".pb"),
+                                 "not a graph"));
+  EXPECT_FALSE(cache.Lookup(key, &optimized_graph));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
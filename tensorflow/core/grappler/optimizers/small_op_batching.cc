@@ -0,0 +1,271 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/small_op_batching.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// The largest output, in elements, of the ops that are batched. Their
+// kernels take less time than their launch.
+const int64 kMaxBatchedElements = 4096;
+
+// The most ops that one _BatchedElementwise op applies; must not exceed
+// kMaxBatchedElementwiseOps of its kernel. Larger groups are split.
+const int kMaxBatchSize = 32;
+
+// Returns the number of elements of "shape", or -1 if it is not statically
+// known.
+int64 NumElements(const TensorShapeProto& shape) {
+  if (shape.unknown_rank()) {
+    return -1;
+  }
+  int64 num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) {
+      return -1;
+    }
+    num_elements *= dim.size();
+  }
+  return num_elements;
+}
+
+bool ShapesEqual(const TensorShapeProto& x, const TensorShapeProto& y) {
+  if (x.unknown_rank() || y.unknown_rank() || x.dim_size() != y.dim_size()) {
+    return false;
+  }
+  for (int i = 0; i < x.dim_size(); ++i) {
+    if (x.dim(i).size() < 0 || x.dim(i).size() != y.dim(i).size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsScalar(const TensorShapeProto& shape) {
+  return !shape.unknown_rank() && shape.dim_size() == 0;
+}
+
+bool IsBatchedBinaryOp(const NodeDef& node) {
+  return IsAdd(node) || IsMul(node);
+}
+
+bool OnGPU(const NodeDef& node) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(node.device(), &parsed) &&
+         parsed.has_type && parsed.type == DEVICE_GPU;
+}
+
+// Returns the index of the input of "node" that becomes its input of the
+// batched op, or -1 if "node" cannot be batched. The other input of a binary
+// op becomes an operand, so it must be a scalar or have the shape of the
+// output.
+int BatchedInput(const NodeDef& node, const GraphProperties& properties) {
+  const bool unary = IsRelu(node) || IsTanh(node);
+  if (!unary && !IsBatchedBinaryOp(node)) {
+    return -1;
+  }
+  auto it = node.attr().find("T");
+  if (it == node.attr().end() ||
+      (it->second.type() != DT_FLOAT && it->second.type() != DT_DOUBLE) ||
+      !OnGPU(node) || !properties.HasOutputProperties(node.name())) {
+    return -1;
+  }
+  const TensorShapeProto& output_shape =
+      properties.GetOutputProperties(node.name())[0].shape();
+  const int64 size = NumElements(output_shape);
+  if (size <= 0 || size > kMaxBatchedElements) {
+    return -1;
+  }
+  if (unary) {
+    return NumNonControlInputs(node) == 1 ? 0 : -1;
+  }
+  if (NumNonControlInputs(node) != 2 ||
+      !properties.HasInputProperties(node.name())) {
+    return -1;
+  }
+  const auto& inputs = properties.GetInputProperties(node.name());
+  for (int i = 0; i < 2; ++i) {
+    const TensorShapeProto& operand_shape = inputs[1 - i].shape();
+    if (ShapesEqual(inputs[i].shape(), output_shape) &&
+        (IsScalar(operand_shape) || ShapesEqual(operand_shape, output_shape))) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Returns the batched op that applies the ops[begin, end).
+NodeDef BatchOps(const std::vector<const NodeDef*>& ops, int begin, int end,
+                 const std::unordered_map<const NodeDef*, int>& batched_input) {
+  const NodeDef& first = *ops[begin];
+  NodeDef batched;
+  batched.set_name(AddPrefixToNodeName(first.name(), "SmallOpBatching"));
+  batched.set_op("_BatchedElementwise");
+  batched.set_device(first.device());
+  (*batched.mutable_attr())["T"] = first.attr().at("T");
+
+  AttrValue op_names;
+  std::vector<string> operands;
+  std::set<string> control_inputs;
+  for (int i = begin; i < end; ++i) {
+    const NodeDef& node = *ops[i];
+    const int input = batched_input.at(&node);
+    batched.add_input(node.input(input));
+    if (IsBatchedBinaryOp(node)) {
+      operands.push_back(node.input(1 - input));
+      op_names.mutable_list()->add_s(IsAdd(node) ? "Add" : "Mul");
+    } else {
+      op_names.mutable_list()->add_s(node.op());
+    }
+    for (int j = NumNonControlInputs(node); j < node.input_size(); ++j) {
+      control_inputs.insert(node.input(j));
+    }
+  }
+  for (const string& operand : operands) {
+    batched.add_input(operand);
+  }
+  for (const string& control_input : control_inputs) {
+    batched.add_input(control_input);
+  }
+  (*batched.mutable_attr())["N"].set_i(end - begin);
+  (*batched.mutable_attr())["M"].set_i(operands.size());
+  (*batched.mutable_attr())["ops"] = op_names;
+  return batched;
+}
+
+}  // namespace
+
+Status SmallOpBatching::Optimize(Cluster* /*cluster*/, const GrapplerItem& item,
+                                 GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
+  GraphProperties properties(item, properties_cache());
+  TF_RETURN_IF_ERROR(properties.InferStatically(false));
+  NodeMap node_map(optimized_graph);
+  FrameMap frame_map;
+  int num_frames;
+  TF_RETURN_IF_ERROR(IdentifyFramesWithNodeMap(*optimized_graph, node_map,
+                                               &frame_map, &num_frames));
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  // The length of the longest path from a source of the graph to each node.
+  // There is no path between two nodes at the same depth, so they can be
+  // batched without creating a cycle. The back edges of loops are ignored,
+  // which is fine since the ops in loops are not batched.
+  std::unordered_map<string, int> depth;
+  std::unordered_map<const NodeDef*, int> batched_input;
+  std::map<std::tuple<string, DataType, int>, std::vector<const NodeDef*>>
+      groups;
+  for (const NodeDef& node : optimized_graph->node()) {
+    int node_depth = 0;
+    for (const string& input : node.input()) {
+      auto it = depth.find(NodeName(input));
+      if (it != depth.end()) {
+        node_depth = std::max(node_depth, it->second + 1);
+      }
+    }
+    depth[node.name()] = node_depth;
+
+    auto frames = frame_map.find(&node);
+    if (nodes_to_preserve.count(node.name()) > 0 ||
+        (frames != frame_map.end() && !frames->second.empty())) {
+      continue;
+    }
+    const int input = BatchedInput(node, properties);
+    if (input < 0) {
+      continue;
+    }
+    batched_input[&node] = input;
+    groups[std::make_tuple(node.device(), node.attr().at("T").type(),
+                           node_depth)]
+        .push_back(&node);
+  }
+
+  std::vector<NodeDef> batched_nodes;
+  std::unordered_map<string, NodeDef> identities;
+  for (const auto& group : groups) {
+    const std::vector<const NodeDef*>& ops = group.second;
+    for (int begin = 0; begin + 1 < ops.size(); begin += kMaxBatchSize) {
+      const int end = std::min<int>(ops.size(), begin + kMaxBatchSize);
+      NodeDef batched = BatchOps(ops, begin, end, batched_input);
+      if (node_map.GetNode(batched.name()) != nullptr) {
+        continue;
+      }
+      for (int i = begin; i < end; ++i) {
+        const NodeDef& op = *ops[i];
+        NodeDef& identity = identities[op.name()];
+        identity.set_name(op.name());
+        identity.set_op("Identity");
+        identity.set_device(op.device());
+        (*identity.mutable_attr())["T"] = op.attr().at("T");
+        const int output = i - begin;
+        identity.add_input(output == 0 ? batched.name()
+                                       : strings::StrCat(batched.name(), ":",
+                                                         output));
+      }
+      batched_nodes.push_back(std::move(batched));
+    }
+  }
+  if (batched_nodes.empty()) {
+    return Status::OK();
+  }
+  VLOG(1) << "Batched " << identities.size() << " small ops into "
+          << batched_nodes.size() << " ops";
+
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    auto it = identities.find(node.name());
+    if (it != identities.end()) {
+      node.Swap(&it->second);
+    }
+  }
+  for (NodeDef& batched : batched_nodes) {
+    optimized_graph->add_node()->Swap(&batched);
+  }
+  return TopologicalSort(optimized_graph);
+}
+
+void SmallOpBatching::Feedback(Cluster* /*cluster*/,
+                               const GrapplerItem& /*item*/,
+                               const GraphDef& /*optimized_graph*/,
+                               double /*result*/) {
+  // Nothing to do for SmallOpBatching.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
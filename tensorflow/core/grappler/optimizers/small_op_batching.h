@@ -0,0 +1,52 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SMALL_OP_BATCHING_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SMALL_OP_BATCHING_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Runs groups of tiny element-wise Add, Mul, Relu and Tanh ops on the same GPU
+// as single _BatchedElementwise ops, so that a group costs one kernel launch
+// instead of one per op. The ops of a group are independent: they are all at
+// the same distance from the sources of the graph, so none of them can depend
+// on another. Each op is replaced by an Identity of its output of the batched
+// op, which keeps its name, so its consumers and control dependencies are
+// unchanged.
+//
+// Only the ops with a statically known output of at most a few thousand
+// elements are batched, since launching their kernels costs more than
+// running them. Ops in loops and ops that broadcast are left alone.
+class SmallOpBatching : public GraphOptimizer {
+ public:
+  SmallOpBatching() {}
+  ~SmallOpBatching() override {}
+
+  string name() const override { return "small_op_batching"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SMALL_OP_BATCHING_H_
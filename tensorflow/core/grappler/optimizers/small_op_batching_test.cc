@@ -0,0 +1,144 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/small_op_batching.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class SmallOpBatchingTest : public ::testing::Test {};
+
+const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) {
+      return &node;
+    }
+  }
+  return nullptr;
+}
+
+int CountOps(const GraphDef& graph, const string& op) {
+  int count = 0;
+  for (const NodeDef& node : graph.node()) {
+    count += node.op() == op;
+  }
+  return count;
+}
+
+TEST_F(SmallOpBatchingTest, BatchesIndependentOps) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:GPU:0");
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+  Output c = ops::Const(s.WithOpName("c"), 2.0f);
+  Output add = ops::Add(s.WithOpName("add"), x, y);
+  Output relu = ops::Relu(s.WithOpName("relu"), y);
+  Output mul = ops::Mul(s.WithOpName("mul"), c, x);
+  // Depends on "add", so it is not batched with it.
+  Output tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  // Fetched ops are not batched, so fetch their consumers instead.
+  Output relu_out = ops::Identity(s.WithOpName("relu_out"), relu);
+  Output mul_out = ops::Identity(s.WithOpName("mul_out"), mul);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"tanh", "relu_out", "mul_out"};
+
+  SmallOpBatching optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(1, CountOps(output, "_BatchedElementwise"));
+  EXPECT_EQ("Tanh", FindNode(output, "tanh")->op());
+  const NodeDef* batched = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "_BatchedElementwise") batched = &node;
+  }
+  ASSERT_NE(nullptr, batched);
+  EXPECT_EQ(3, batched->attr().at("N").i());
+  EXPECT_EQ(2, batched->attr().at("M").i());
+  ASSERT_EQ(5, batched->input_size());
+
+  // Each op reads its input from the batched op at the index of its output.
+  const auto& op_names = batched->attr().at("ops").list().s();
+  for (const string& name : {"add", "relu", "mul"}) {
+    const NodeDef* node = FindNode(output, name);
+    ASSERT_NE(nullptr, node);
+    EXPECT_EQ("Identity", node->op());
+    ASSERT_EQ(1, node->input_size());
+    int index;
+    EXPECT_EQ(batched->name(), ParseNodeName(node->input(0), &index));
+    ASSERT_LT(index, 3);
+    if (name == "add") {
+      EXPECT_EQ("Add", op_names.Get(index));
+      EXPECT_EQ("x", batched->input(index));
+    } else if (name == "relu") {
+      EXPECT_EQ("Relu", op_names.Get(index));
+      EXPECT_EQ("y", batched->input(index));
+    } else {
+      // The scalar becomes the operand.
+      EXPECT_EQ("Mul", op_names.Get(index));
+      EXPECT_EQ("x", batched->input(index));
+    }
+  }
+  std::vector<string> batched_operands = {batched->input(3),
+                                          batched->input(4)};
+  std::sort(batched_operands.begin(), batched_operands.end());
+  EXPECT_EQ(std::vector<string>({"c", "y"}), batched_operands);
+}
+
+TEST_F(SmallOpBatchingTest, KeepsLargeCpuAndFetchedOps) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  tensorflow::Scope gpu = s.WithDevice("/device:GPU:0");
+  Output x = ops::Placeholder(gpu.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({4}));
+  Output large = ops::Placeholder(gpu.WithOpName("large"), DT_FLOAT,
+                                  ops::Placeholder::Shape({10000}));
+  // Only "relu1" can be batched, so there is nothing to batch it with.
+  Output relu1 = ops::Relu(gpu.WithOpName("relu1"), x);
+  Output relu2 = ops::Relu(gpu.WithOpName("relu2"), large);
+  Output relu3 =
+      ops::Relu(s.WithOpName("relu3").WithDevice("/device:CPU:0"), x);
+  Output relu4 = ops::Relu(gpu.WithOpName("relu4"), x);
+  Output out1 = ops::Identity(gpu.WithOpName("out1"), relu1);
+  Output out2 = ops::Identity(gpu.WithOpName("out2"), relu2);
+  Output out3 = ops::Identity(gpu.WithOpName("out3"), relu3);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"out1", "out2", "out3", "relu4"};
+
+  SmallOpBatching optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(0, CountOps(output, "_BatchedElementwise"));
+  EXPECT_EQ(4, CountOps(output, "Relu"));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
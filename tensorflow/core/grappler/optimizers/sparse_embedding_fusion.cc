@@ -0,0 +1,215 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/sparse_embedding_fusion.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Returns the combiner of the fused op that replaces "node", or an empty
+// string if "node" is not a sparse segment reduction that can be fused.
+string Combiner(const NodeDef& node) {
+  string combiner;
+  if (node.op() == "SparseSegmentSum") {
+    combiner = "sum";
+  } else if (node.op() == "SparseSegmentMean") {
+    combiner = "mean";
+  } else if (node.op() == "SparseSegmentSqrtN") {
+    combiner = "sqrtn";
+  } else {
+    return "";
+  }
+  const DataType type = node.attr().at("T").type();
+  if (type != DT_FLOAT && type != DT_DOUBLE) {
+    return "";
+  }
+  return combiner;
+}
+
+// Returns true if "node" is a Const holding the scalar 0.
+bool IsZero(const NodeDef* node) {
+  if (node == nullptr || node->op() != "Const") {
+    return false;
+  }
+  Tensor value;
+  if (!value.FromProto(node->attr().at("value").tensor()) ||
+      value.NumElements() != 1) {
+    return false;
+  }
+  if (value.dtype() == DT_INT32) {
+    return value.flat<int32>()(0) == 0;
+  }
+  if (value.dtype() == DT_INT64) {
+    return value.flat<int64>()(0) == 0;
+  }
+  return false;
+}
+
+// Returns true if "node" gathers rows of its first input.
+bool IsGatherOfRows(const NodeDef& node, const NodeMap& node_map) {
+  if (node.op() == "Gather") {
+    return NumNonControlInputs(node) == 2;
+  }
+  if (node.op() == "GatherV2") {
+    return NumNonControlInputs(node) == 3 &&
+           IsZero(node_map.GetNode(node.input(2)));
+  }
+  return false;
+}
+
+// Returns true if the ids gathered by "gather" are known to be a vector.
+bool HasVectorIds(const NodeDef& gather, const GraphProperties& properties) {
+  if (!properties.HasInputProperties(gather.name())) {
+    return false;
+  }
+  const auto& inputs = properties.GetInputProperties(gather.name());
+  if (inputs.size() < 2) {
+    return false;
+  }
+  const TensorShapeProto& shape = inputs[1].shape();
+  return !shape.unknown_rank() && shape.dim_size() == 1;
+}
+
+// Returns the nodes that replace the sparse segment reduction "segment" of
+// the output of "gather": the fused op, preceded by the nodes that compute
+// the ids it looks up and its empty weights.
+std::vector<NodeDef> FuseSparseEmbedding(const NodeDef& gather,
+                                         const NodeDef& segment,
+                                         const string& combiner) {
+  const DataType type = segment.attr().at("T").type();
+  const DataType ids_type = gather.attr().at("Tindices").type();
+
+  NodeDef ids;
+  ids.set_name(strings::StrCat(segment.name(), "/ids"));
+  ids.set_op("Gather");
+  ids.set_device(gather.device());
+  ids.add_input(gather.input(1));
+  ids.add_input(segment.input(1));
+  (*ids.mutable_attr())["Tparams"].set_type(ids_type);
+  (*ids.mutable_attr())["Tindices"] = segment.attr().at("Tidx");
+  (*ids.mutable_attr())["validate_indices"].set_b(true);
+
+  NodeDef weights;
+  weights.set_name(strings::StrCat(segment.name(), "/weights"));
+  weights.set_op("Const");
+  weights.set_device(gather.device());
+  (*weights.mutable_attr())["dtype"].set_type(type);
+  Tensor empty(type, TensorShape({0}));
+  empty.AsProtoTensorContent(
+      (*weights.mutable_attr())["value"].mutable_tensor());
+
+  NodeDef fused;
+  fused.set_name(segment.name());
+  fused.set_op("FusedEmbeddingLookupSparse");
+  // The fused op runs where the gather ran, next to the embeddings.
+  fused.set_device(gather.device());
+  fused.add_input(gather.input(0));
+  fused.add_input(ids.name());
+  fused.add_input(segment.input(2));
+  fused.add_input(weights.name());
+  (*fused.mutable_attr())["T"].set_type(type);
+  (*fused.mutable_attr())["Tidx"].set_type(ids_type);
+  (*fused.mutable_attr())["combiner"].set_s(combiner);
+  for (const NodeDef* node : {&gather, &segment}) {
+    for (int i = NumNonControlInputs(*node); i < node->input_size(); ++i) {
+      fused.add_input(node->input(i));
+    }
+  }
+  return {ids, weights, fused};
+}
+
+}  // namespace
+
+Status SparseEmbeddingFusion::Optimize(Cluster* /*cluster*/,
+                                       const GrapplerItem& item,
+                                       GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  GraphProperties properties(item, properties_cache());
+  TF_RETURN_IF_ERROR(properties.InferStatically(false));
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  std::unordered_map<string, std::vector<NodeDef>> fused_nodes;
+  std::unordered_set<string> fused_away;
+  for (const NodeDef& node : optimized_graph->node()) {
+    const string combiner = Combiner(node);
+    if (combiner.empty() || NumNonControlInputs(node) != 3) {
+      continue;
+    }
+    const NodeDef* gather = node_map.GetNode(node.input(0));
+    if (gather == nullptr || node.input(0) != gather->name() ||
+        !IsGatherOfRows(*gather, node_map) ||
+        nodes_to_preserve.count(gather->name()) > 0 ||
+        fused_away.count(gather->name()) > 0 ||
+        node_map.GetOutputs(gather->name()).size() != 1 ||
+        NumNonControlOutputs(*gather, node_map) != 1 ||
+        !HasVectorIds(*gather, properties)) {
+      continue;
+    }
+    if (node_map.GetNode(strings::StrCat(node.name(), "/ids")) != nullptr ||
+        node_map.GetNode(strings::StrCat(node.name(), "/weights")) != nullptr) {
+      continue;
+    }
+    fused_away.insert(gather->name());
+    fused_nodes[node.name()] = FuseSparseEmbedding(*gather, node, combiner);
+  }
+  if (fused_nodes.empty()) {
+    return Status::OK();
+  }
+  VLOG(1) << "Fused " << fused_nodes.size() << " sparse embedding lookups";
+
+  GraphDef graph;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (fused_away.count(node.name()) > 0) {
+      continue;
+    }
+    auto it = fused_nodes.find(node.name());
+    if (it != fused_nodes.end()) {
+      for (NodeDef& fused_node : it->second) {
+        graph.add_node()->Swap(&fused_node);
+      }
+    } else {
+      graph.add_node()->Swap(&node);
+    }
+  }
+  optimized_graph->mutable_node()->Swap(graph.mutable_node());
+  return Status::OK();
+}
+
+void SparseEmbeddingFusion::Feedback(Cluster* /*cluster*/,
+                                     const GrapplerItem& /*item*/,
+                                     const GraphDef& /*optimized_graph*/,
+                                     double /*result*/) {
+  // Nothing to do for SparseEmbeddingFusion.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SPARSE_EMBEDDING_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SPARSE_EMBEDDING_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Replaces each SparseSegmentSum, SparseSegmentMean or SparseSegmentSqrtN
+// whose data is a Gather (or a GatherV2 along axis 0) of a vector of ids
+// consumed by nothing else with a FusedEmbeddingLookupSparse, as built by
+// embedding_lookup_sparse() without weights. The fused op adds each looked up
+// row straight into its segment instead of materializing the gathered rows;
+// it looks up ids gathered at the indices of the segment op. The fused op
+// keeps the name of the segment op, so its consumers are unchanged.
+class SparseEmbeddingFusion : public GraphOptimizer {
+ public:
+  SparseEmbeddingFusion() {}
+  ~SparseEmbeddingFusion() override {}
+
+  string name() const override { return "sparse_embedding_fusion"; };
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_SPARSE_EMBEDDING_FUSION_H_
@@ -0,0 +1,162 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/sparse_embedding_fusion.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class SparseEmbeddingFusionTest : public ::testing::Test {};
+
+const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+  for (const NodeDef& node : graph.node()) {
+    if (node.name() == name) {
+      return &node;
+    }
+  }
+  return nullptr;
+}
+
+// Builds the graph of embedding_lookup_sparse() without weights.
+struct EmbeddingLookup {
+  explicit EmbeddingLookup(const Scope& s)
+      : params(ops::Placeholder(s.WithOpName("params"), DT_FLOAT,
+                                ops::Placeholder::Shape({100, 8}))),
+        ids(ops::Placeholder(s.WithOpName("ids"), DT_INT64,
+                             ops::Placeholder::Shape({-1}))),
+        segment_ids(ops::Placeholder(s.WithOpName("segment_ids"), DT_INT32,
+                                     ops::Placeholder::Shape({-1}))),
+        unique(s.WithOpName("unique"), ids) {}
+
+  Output params;
+  Output ids;
+  Output segment_ids;
+  ops::Unique unique;
+};
+
+TEST_F(SparseEmbeddingFusionTest, FusesGatherAndSparseSegmentMean) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  EmbeddingLookup lookup(s);
+  Output gather =
+      ops::Gather(s.WithOpName("gather"), lookup.params, lookup.unique.y);
+  Output mean = ops::SparseSegmentMean(s.WithOpName("mean"), gather,
+                                       lookup.unique.idx, lookup.segment_ids);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"mean"};
+
+  SparseEmbeddingFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "gather"));
+  const NodeDef* fused = FindNode(output, "mean");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("FusedEmbeddingLookupSparse", fused->op());
+  ASSERT_EQ(4, fused->input_size());
+  EXPECT_EQ("params", fused->input(0));
+  EXPECT_EQ("mean/ids", fused->input(1));
+  EXPECT_EQ("segment_ids", fused->input(2));
+  EXPECT_EQ("mean/weights", fused->input(3));
+  EXPECT_EQ("mean", fused->attr().at("combiner").s());
+  EXPECT_EQ(DT_FLOAT, fused->attr().at("T").type());
+  EXPECT_EQ(DT_INT64, fused->attr().at("Tidx").type());
+
+  const NodeDef* ids = FindNode(output, "mean/ids");
+  ASSERT_NE(nullptr, ids);
+  EXPECT_EQ("Gather", ids->op());
+  ASSERT_EQ(2, ids->input_size());
+  EXPECT_EQ("unique", ids->input(0));
+  EXPECT_EQ("unique:1", ids->input(1));
+  EXPECT_EQ(DT_INT64, ids->attr().at("Tparams").type());
+
+  const NodeDef* weights = FindNode(output, "mean/weights");
+  ASSERT_NE(nullptr, weights);
+  EXPECT_EQ("Const", weights->op());
+}
+
+TEST_F(SparseEmbeddingFusionTest, FusesGatherV2AlongAxisZero) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  EmbeddingLookup lookup(s);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output gather = ops::GatherV2(s.WithOpName("gather"), lookup.params,
+                                lookup.unique.y, axis);
+  Output sum = ops::SparseSegmentSum(s.WithOpName("sum"), gather,
+                                     lookup.unique.idx, lookup.segment_ids);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"sum"};
+
+  SparseEmbeddingFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(nullptr, FindNode(output, "gather"));
+  const NodeDef* fused = FindNode(output, "sum");
+  ASSERT_NE(nullptr, fused);
+  EXPECT_EQ("FusedEmbeddingLookupSparse", fused->op());
+  EXPECT_EQ("sum", fused->attr().at("combiner").s());
+}
+
+TEST_F(SparseEmbeddingFusionTest, KeepsGatherWithOtherConsumers) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  EmbeddingLookup lookup(s);
+  Output gather =
+      ops::Gather(s.WithOpName("gather"), lookup.params, lookup.unique.y);
+  Output sum = ops::SparseSegmentSum(s.WithOpName("sum"), gather,
+                                     lookup.unique.idx, lookup.segment_ids);
+  Output shape = ops::Shape(s.WithOpName("shape"), gather);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"sum", "shape"};
+
+  SparseEmbeddingFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_NE(nullptr, FindNode(output, "gather"));
+  EXPECT_EQ("SparseSegmentSum", FindNode(output, "sum")->op());
+}
+
+TEST_F(SparseEmbeddingFusionTest, KeepsGatherAlongOtherAxes) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  EmbeddingLookup lookup(s);
+  Output axis = ops::Const(s.WithOpName("axis"), 1);
+  Output gather = ops::GatherV2(s.WithOpName("gather"), lookup.params,
+                                lookup.unique.y, axis);
+  Output sum = ops::SparseSegmentSum(s.WithOpName("sum"), gather,
+                                     lookup.unique.idx, lookup.segment_ids);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"sum"};
+
+  SparseEmbeddingFusion optimizer;
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_NE(nullptr, FindNode(output, "gather"));
+  EXPECT_EQ("SparseSegmentSum", FindNode(output, "sum")->op());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 #include <deque>
+#include <memory>
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/grappler/costs/calibrated_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
@@ -87,7 +89,8 @@ Status EstimateEarliestExecutionTimes(
 
   GraphProperties properties(item);
   TF_RETURN_IF_ERROR(properties.InferStatically(true));
-  OpLevelCostEstimator estimator;
+  std::unique_ptr<OpLevelCostEstimator> estimator =
+      NewOpLevelCostEstimator();
   VirtualPlacer placer(cluster);
 
   while (!ready_nodes.empty()) {
@@ -95,7 +98,7 @@ Status EstimateEarliestExecutionTimes(
     ready_nodes.pop_front();
 
     Costs::NanoSeconds execution_time =
-        PredictExecutionTime(properties, estimator, placer, *node);
+        PredictExecutionTime(properties, *estimator, placer, *node);
     Costs::NanoSeconds completion_time =
         execution_time + (*completion_times)[node];
     (*completion_times)[node] = completion_time;
@@ -155,7 +158,8 @@ Status EstimateRequiredTimes(
   }
   GraphProperties properties(item);
   TF_RETURN_IF_ERROR(properties.InferStatically(true));
-  OpLevelCostEstimator estimator;
+  std::unique_ptr<OpLevelCostEstimator> estimator =
+      NewOpLevelCostEstimator();
   VirtualPlacer placer(cluster);
 
   while (!ready_nodes.empty()) {
@@ -163,7 +167,7 @@ Status EstimateRequiredTimes(
     ready_nodes.pop_front();
 
     Costs::NanoSeconds execution_time =
-        PredictExecutionTime(properties, estimator, placer, *node);
+        PredictExecutionTime(properties, *estimator, placer, *node);
     Costs::NanoSeconds required_time = (*required_times)[node] - execution_time;
 
     for (const string& fanin_name : node->input()) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <vector>
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op.h"
@@ -191,6 +192,51 @@ struct SequentialMatMulKernel {
   }
 };
 
+// Sequential batch matmul kernel for small matrices, where the packing and
+// blocking of Eigen's general matrix product cost more than the product
+// itself. Row r of each output is accumulated from the rows of y scaled by
+// the elements of row r of x, so the innermost loop runs over contiguous
+// rows of y and z and is vectorized by the compiler. If adj_y, the adjoint
+// of each y is first copied to a buffer.
+template <typename Scalar>
+struct SmallMatMulKernel {
+  static void Run(const Tensor& in_x, const Tensor& in_y, bool adj_x,
+                  bool adj_y, Tensor* out, int start, int limit) {
+    const int64 m = out->dim_size(1);
+    const int64 n = out->dim_size(2);
+    const int64 k = in_x.dim_size(adj_x ? 1 : 2);
+    const Scalar* x_base = in_x.flat<Scalar>().data();
+    const Scalar* y_base = in_y.flat<Scalar>().data();
+    Scalar* z_base = out->flat<Scalar>().data();
+    std::vector<Scalar> y_adjoint(adj_y ? k * n : 0);
+    for (int i = start; i < limit; ++i) {
+      const Scalar* x = x_base + i * m * k;
+      const Scalar* y = y_base + i * k * n;
+      Scalar* z = z_base + i * m * n;
+      if (adj_y) {
+        for (int64 c = 0; c < n; ++c) {
+          for (int64 d = 0; d < k; ++d) {
+            y_adjoint[d * n + c] = Eigen::numext::conj(y[c * k + d]);
+          }
+        }
+        y = y_adjoint.data();
+      }
+      for (int64 r = 0; r < m; ++r) {
+        Scalar* z_row = z + r * n;
+        std::fill(z_row, z_row + n, Scalar(0));
+        for (int64 d = 0; d < k; ++d) {
+          const Scalar a =
+              adj_x ? Eigen::numext::conj(x[d * m + r]) : x[r * k + d];
+          const Scalar* y_row = y + d * n;
+          for (int64 c = 0; c < n; ++c) {
+            z_row[c] += a * y_row[c];
+          }
+        }
+      }
+    }
+  }
+};
+
 }  // namespace
 
 template <typename Device, typename Scalar>
@@ -211,9 +257,19 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
     const int64 small_dim = std::min(
         std::min(in_x.dim_size(1), in_x.dim_size(2)), out->dim_size(2));
     const int64 kMaxCostOuterParallelism = 128 * 128 * 256;  // heuristic.
+    const int64 kMaxCostSmallMatMul = 64 * 64 * 64;          // heuristic.
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
-    if (small_dim > 1 &&
-        (batch_size == 1 || cost_per_unit > kMaxCostOuterParallelism)) {
+    if (small_dim > 1 && cost_per_unit <= kMaxCostSmallMatMul) {
+      // Small matrix products are computed directly, in parallel over the
+      // batch dimension.
+      Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+            cost_per_unit,
+            [&in_x, &in_y, adj_x, adj_y, out](int start, int limit) {
+              SmallMatMulKernel<Scalar>::Run(in_x, in_y, adj_x, adj_y, out,
+                                             start, limit);
+            });
+    } else if (small_dim > 1 &&
+               (batch_size == 1 || cost_per_unit > kMaxCostOuterParallelism)) {
       // Parallelize over inner dims.
       // For large matrix products it is counter-productive to parallelize
       // over the batch dimension.
@@ -251,38 +307,38 @@ perftools::gputools::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory) {
   return typed;
 }
 
-class CublasScratchAllocator : public perftools::gputools::ScratchAllocator {
- public:
-  using Stream = ::perftools::gputools::Stream;
-  using DeviceMemoryBytes = ::perftools::gputools::DeviceMemory<uint8>;
-
-  CublasScratchAllocator(OpKernelContext* context) : context_(context) {}
-
-  int64 GetMemoryLimitInBytes(Stream* stream) override { return -1; }
-
-  perftools::gputools::port::StatusOr<DeviceMemoryBytes> AllocateBytes(
-      Stream* stream, int64 byte_size) override {
-    Tensor temporary_memory;
-
-    Status allocation_status(context_->allocate_temp(
-        DT_UINT8, TensorShape({byte_size}), &temporary_memory));
-    if (!allocation_status.ok()) {
-      return perftools::gputools::port::StatusOr<DeviceMemoryBytes>(
-          DeviceMemoryBytes::MakeFromByteSize(nullptr, 0));
-    }
-    // Hold the reference of the allocated tensors until the end of the
-    // allocator.
-    allocated_tensors_.push_back(temporary_memory);
-    return perftools::gputools::port::StatusOr<DeviceMemoryBytes>(
-        DeviceMemoryBytes::MakeFromByteSize(
-            temporary_memory.flat<uint8>().data(),
-            temporary_memory.flat<uint8>().size()));
+// Enqueues y = op(a) * x with GEMV on 'stream', where a is m x n in column
+// major order.
+template <typename Scalar>
+struct BatchMatMulGemv {
+  static constexpr bool kSupported = true;
+  static bool Launch(perftools::gputools::Stream* stream,
+                     perftools::gputools::blas::Transpose trans, uint64 m,
+                     uint64 n,
+                     const perftools::gputools::DeviceMemory<Scalar>& a,
+                     const perftools::gputools::DeviceMemory<Scalar>& x,
+                     perftools::gputools::DeviceMemory<Scalar>* y) {
+    return stream
+        ->ThenBlasGemv(trans, m, n, static_cast<Scalar>(1.0), a, m, x, 1,
+                       static_cast<Scalar>(0.0), y, 1)
+        .ok();
   }
+};
 
- private:
-  OpKernelContext* context_;
-  std::vector<Tensor> allocated_tensors_;
+// cuBLAS has no half precision GEMV, so half products always use GEMM.
+template <>
+struct BatchMatMulGemv<Eigen::half> {
+  static constexpr bool kSupported = false;
+  static bool Launch(perftools::gputools::Stream* stream,
+                     perftools::gputools::blas::Transpose trans, uint64 m,
+                     uint64 n,
+                     const perftools::gputools::DeviceMemory<Eigen::half>& a,
+                     const perftools::gputools::DeviceMemory<Eigen::half>& x,
+                     perftools::gputools::DeviceMemory<Eigen::half>* y) {
+    return false;
+  }
 };
+
 }  // namespace
 
 template <typename Scalar>
@@ -305,30 +361,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
     auto* stream = context->op_device_context()->stream();
     OP_REQUIRES(context, stream, errors::Internal("No GPU stream available."));
 
-    typedef perftools::gputools::DeviceMemory<Scalar> DeviceMemoryType;
-    std::vector<DeviceMemoryType> a_device_memory;
-    std::vector<DeviceMemoryType> b_device_memory;
-    std::vector<DeviceMemoryType> c_device_memory;
-    std::vector<DeviceMemoryType*> a_ptrs;
-    std::vector<DeviceMemoryType*> b_ptrs;
-    std::vector<DeviceMemoryType*> c_ptrs;
-    a_device_memory.reserve(batch_size);
-    b_device_memory.reserve(batch_size);
-    c_device_memory.reserve(batch_size);
-    a_ptrs.reserve(batch_size);
-    b_ptrs.reserve(batch_size);
-    c_ptrs.reserve(batch_size);
-    auto* a_base_ptr = in_x.template flat<Scalar>().data();
-    auto* b_base_ptr = in_y.template flat<Scalar>().data();
-    auto* c_base_ptr = out->template flat<Scalar>().data();
-    for (int64 i = 0; i < batch_size; ++i) {
-      a_device_memory.push_back(AsDeviceMemory(a_base_ptr + i * m * k));
-      b_device_memory.push_back(AsDeviceMemory(b_base_ptr + i * k * n));
-      c_device_memory.push_back(AsDeviceMemory(c_base_ptr + i * m * n));
-      a_ptrs.push_back(&a_device_memory.back());
-      b_ptrs.push_back(&b_device_memory.back());
-      c_ptrs.push_back(&c_device_memory.back());
-    }
+    auto a_ptr = AsDeviceMemory(in_x.template flat<Scalar>().data());
+    auto b_ptr = AsDeviceMemory(in_y.template flat<Scalar>().data());
+    auto c_ptr = AsDeviceMemory(out->template flat<Scalar>().data());
 
     // Cublas does
     // C = A x B
@@ -339,7 +374,7 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
     if (batch_size == 1) {
       // This is a regular matrix*matrix or matrix*vector multiply. Avoid the
       // overhead of the scratch allocator and the batch interface.
-      if (n == 1 &&
+      if (n == 1 && BatchMatMulGemv<Scalar>::kSupported &&
           blas_transpose_b !=
               perftools::gputools::blas::Transpose::kConjugateTranspose &&
           blas_transpose_a !=
@@ -353,13 +388,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
             blas_transpose_a == perftools::gputools::blas::Transpose::kTranspose
                 ? perftools::gputools::blas::Transpose::kNoTranspose
                 : perftools::gputools::blas::Transpose::kTranspose;
-        bool blas_launch_status =
-            stream
-                ->ThenBlasGemv(gemv_trans_a, adj_x ? m : k, adj_x ? k : m,
-                               static_cast<Scalar>(1.0), *(a_ptrs[0]),
-                               adj_x ? m : k, *(b_ptrs[0]), 1,
-                               static_cast<Scalar>(0.0), c_ptrs[0], 1)
-                .ok();
+        bool blas_launch_status = BatchMatMulGemv<Scalar>::Launch(
+            stream, gemv_trans_a, adj_x ? m : k, adj_x ? k : m, a_ptr, b_ptr,
+            &c_ptr);
         if (!blas_launch_status) {
           context->SetStatus(errors::Internal(
               "Blas xGEMV launch failed : a.shape=", in_x.shape().DebugString(),
@@ -370,9 +401,9 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
         bool blas_launch_status =
             stream
                 ->ThenBlasGemm(blas_transpose_b, blas_transpose_a, n, m, k,
-                               static_cast<Scalar>(1.0), *(b_ptrs[0]),
-                               adj_y ? k : n, *(a_ptrs[0]), adj_x ? m : k,
-                               static_cast<Scalar>(0.0), c_ptrs[0], n)
+                               static_cast<Scalar>(1.0), b_ptr, adj_y ? k : n,
+                               a_ptr, adj_x ? m : k, static_cast<Scalar>(0.0),
+                               &c_ptr, n)
                 .ok();
         if (!blas_launch_status) {
           context->SetStatus(errors::Internal(
@@ -382,18 +413,19 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
         }
       }
     } else {
-      CublasScratchAllocator scratch_allocator(context);
+      // The matrices of each input are contiguous, so a strided batched GEMM
+      // needs no array of matrix pointers on the device.
       bool blas_launch_status =
           stream
-              ->ThenBlasGemmBatchedWithScratch(
+              ->ThenBlasGemmStridedBatched(
                   blas_transpose_b, blas_transpose_a, n, m, k,
-                  static_cast<Scalar>(1.0), b_ptrs, adj_y ? k : n, a_ptrs,
-                  adj_x ? m : k, static_cast<Scalar>(0.0), c_ptrs, n,
-                  batch_size, &scratch_allocator)
+                  static_cast<Scalar>(1.0), b_ptr, adj_y ? k : n, k * n, a_ptr,
+                  adj_x ? m : k, m * k, static_cast<Scalar>(0.0), &c_ptr, n,
+                  m * n, batch_size)
               .ok();
       if (!blas_launch_status) {
         context->SetStatus(errors::Internal(
-            "Blas xGEMMBatched launch failed : a.shape=",
+            "Blas xGEMMStridedBatched launch failed : a.shape=",
             in_x.shape().DebugString(),
             ", b.shape=", in_y.shape().DebugString(), ", m=", m, ", n=", n,
             ", k=", k, ", batch_size=", batch_size));
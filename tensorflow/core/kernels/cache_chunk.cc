@@ -0,0 +1,288 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/cache_chunk.h"
+
+#include <string.h>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+const uint64 kMagic = 0x2d6568636163fd0aull;
+const uint32 kVersion = 1;
+const size_t kFooterSize = 8 + 8 + 4 + 4 + 8;
+const size_t kAlignment = Allocator::kAllocatorAlignment;
+
+enum Encoding : uint32 {
+  kRaw = 0,
+  kTensorProto = 1,
+};
+
+// Hands out the memory of one tensor in a mapped chunk, and keeps the mapping
+// alive until the tensor is deallocated. It is owned by the buffer of that
+// tensor, and deletes itself when that buffer is deallocated.
+class MappedTensorAllocator : public Allocator {
+ public:
+  MappedTensorAllocator(std::shared_ptr<const ReadOnlyMemoryRegion> region,
+                        const char* data)
+      : region_(std::move(region)), data_(data) {}
+
+  string Name() override { return "MappedTensorAllocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    DCHECK_EQ(reinterpret_cast<intptr_t>(data_) % alignment, 0);
+    return const_cast<char*>(data_);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    DCHECK_EQ(ptr, data_);
+    delete this;
+  }
+
+ private:
+  const std::shared_ptr<const ReadOnlyMemoryRegion> region_;
+  const char* const data_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedTensorAllocator);
+};
+
+}  // namespace
+
+CacheChunkWriter::CacheChunkWriter(Env* env, const string& filename)
+    : env_(env),
+      filename_(filename),
+      tmp_filename_(strings::StrCat(filename, ".tmp")) {}
+
+Status CacheChunkWriter::Open() {
+  return env_->NewWritableFile(tmp_filename_, &file_);
+}
+
+Status CacheChunkWriter::Pad() {
+  static const char kZeros[kAlignment] = {0};
+  const size_t padding = (kAlignment - offset_ % kAlignment) % kAlignment;
+  if (padding > 0) {
+    TF_RETURN_IF_ERROR(file_->Append(StringPiece(kZeros, padding)));
+    offset_ += padding;
+  }
+  return Status::OK();
+}
+
+Status CacheChunkWriter::Add(const std::vector<Tensor>& element) {
+  if (num_tensors_ < 0) {
+    num_tensors_ = element.size();
+  } else if (element.size() != num_tensors_) {
+    return errors::InvalidArgument("Expected ", num_tensors_,
+                                   " tensors per element, got ",
+                                   element.size());
+  }
+  for (const Tensor& t : element) {
+    string proto_data;
+    StringPiece data;
+    Encoding encoding;
+    if (DataTypeCanUseMemcpy(t.dtype())) {
+      data = t.tensor_data();
+      encoding = kRaw;
+    } else {
+      TensorProto proto;
+      t.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&proto_data)) {
+        return errors::Internal("Failed to serialize a tensor of type ",
+                                DataTypeString(t.dtype()), " to ",
+                                filename_);
+      }
+      data = proto_data;
+      encoding = kTensorProto;
+    }
+    TF_RETURN_IF_ERROR(Pad());
+    core::PutVarint32(&index_, t.dtype());
+    core::PutVarint32(&index_, encoding);
+    core::PutVarint32(&index_, t.dims());
+    for (int i = 0; i < t.dims(); ++i) {
+      core::PutVarint64(&index_, t.dim_size(i));
+    }
+    core::PutVarint64(&index_, offset_);
+    core::PutVarint64(&index_, data.size());
+    TF_RETURN_IF_ERROR(file_->Append(data));
+    offset_ += data.size();
+  }
+  ++num_elements_;
+  return Status::OK();
+}
+
+Status CacheChunkWriter::Finish() {
+  string header;
+  core::PutVarint64(&header, num_elements_);
+  core::PutVarint32(&header, std::max(num_tensors_, 0));
+  const string index = strings::StrCat(header, index_);
+  TF_RETURN_IF_ERROR(Pad());
+  const uint64 index_offset = offset_;
+  TF_RETURN_IF_ERROR(file_->Append(index));
+
+  string footer;
+  core::PutFixed64(&footer, index_offset);
+  core::PutFixed64(&footer, index.size());
+  core::PutFixed32(&footer,
+                   crc32c::Mask(crc32c::Value(index.data(), index.size())));
+  core::PutFixed32(&footer, kVersion);
+  core::PutFixed64(&footer, kMagic);
+  DCHECK_EQ(footer.size(), kFooterSize);
+  TF_RETURN_IF_ERROR(file_->Append(footer));
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  return env_->RenameFile(tmp_filename_, filename_);
+}
+
+Status CacheChunk::Open(Env* env, const string& filename,
+                        std::shared_ptr<const CacheChunk>* chunk) {
+  std::unique_ptr<CacheChunk> result(new CacheChunk);
+  result->filename_ = filename;
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status status = env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+  if (status.ok()) {
+    result->data_ = StringPiece(static_cast<const char*>(region->data()),
+                                region->length());
+    result->region_ = std::move(region);
+  } else if (errors::IsUnimplemented(status)) {
+    // The file system cannot map files, read the whole chunk instead.
+    TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &result->contents_));
+    result->data_ = result->contents_;
+  } else {
+    return status;
+  }
+  TF_RETURN_IF_ERROR(result->ParseIndex());
+  chunk->reset(result.release());
+  return Status::OK();
+}
+
+Status CacheChunk::ParseIndex() {
+  if (data_.size() < kFooterSize) {
+    return errors::DataLoss("Cache chunk ", filename_, " is too short");
+  }
+  const char* footer = data_.data() + data_.size() - kFooterSize;
+  const uint64 index_offset = core::DecodeFixed64(footer);
+  const uint64 index_size = core::DecodeFixed64(footer + 8);
+  const uint32 masked_crc = core::DecodeFixed32(footer + 16);
+  const uint32 version = core::DecodeFixed32(footer + 20);
+  if (core::DecodeFixed64(footer + 24) != kMagic) {
+    return errors::DataLoss(filename_, " is not a cache chunk");
+  }
+  if (version != kVersion) {
+    return errors::Unimplemented("Cache chunk ", filename_, " has version ",
+                                 version, ", expected ", kVersion);
+  }
+  const uint64 data_size = data_.size() - kFooterSize;
+  if (index_offset > data_size || index_size != data_size - index_offset) {
+    return errors::DataLoss("Cache chunk ", filename_, " has a corrupt footer");
+  }
+  StringPiece index(data_.data() + index_offset, index_size);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(index.data(), index.size())) {
+    return errors::DataLoss("Cache chunk ", filename_,
+                            " has a corrupt index (checksum mismatch)");
+  }
+
+  auto corrupt = [this]() {
+    return errors::DataLoss("Cache chunk ", filename_, " has a corrupt index");
+  };
+  uint64 num_elements;
+  uint32 num_tensors;
+  if (!core::GetVarint64(&index, &num_elements) ||
+      !core::GetVarint32(&index, &num_tensors)) {
+    return corrupt();
+  }
+  num_elements_ = num_elements;
+  num_tensors_ = num_tensors;
+  entries_.resize(num_elements * num_tensors);
+  for (TensorEntry& entry : entries_) {
+    uint32 dtype, encoding, rank;
+    if (!core::GetVarint32(&index, &dtype) ||
+        !core::GetVarint32(&index, &encoding) ||
+        !core::GetVarint32(&index, &rank) || !DataType_IsValid(dtype) ||
+        encoding > kTensorProto || rank > TensorShape::MaxDimensions()) {
+      return corrupt();
+    }
+    entry.dtype = static_cast<DataType>(dtype);
+    entry.raw = encoding == kRaw;
+    if (entry.raw && !DataTypeCanUseMemcpy(entry.dtype)) {
+      return corrupt();
+    }
+    gtl::InlinedVector<int64, 4> dims(rank);
+    for (uint32 i = 0; i < rank; ++i) {
+      uint64 dim;
+      if (!core::GetVarint64(&index, &dim)) {
+        return corrupt();
+      }
+      dims[i] = dim;
+    }
+    if (!TensorShapeUtils::MakeShape(dims.data(), rank, &entry.shape).ok()) {
+      return corrupt();
+    }
+    if (!core::GetVarint64(&index, &entry.offset) ||
+        !core::GetVarint64(&index, &entry.size) ||
+        entry.offset > index_offset ||
+        entry.size > index_offset - entry.offset ||
+        (entry.raw && entry.size != entry.shape.num_elements() *
+                                        DataTypeSize(entry.dtype))) {
+      return corrupt();
+    }
+  }
+  return Status::OK();
+}
+
+Status CacheChunk::GetElement(int64 index,
+                              std::vector<Tensor>* element) const {
+  if (index < 0 || index >= num_elements_) {
+    return errors::OutOfRange("Element ", index, " is out of range of ",
+                              filename_, ", which has ", num_elements_,
+                              " elements");
+  }
+  element->clear();
+  element->reserve(num_tensors_);
+  for (int32 i = 0; i < num_tensors_; ++i) {
+    const TensorEntry& entry = entries_[index * num_tensors_ + i];
+    const char* data = data_.data() + entry.offset;
+    if (!entry.raw) {
+      TensorProto proto;
+      element->emplace_back();
+      if (!proto.ParseFromArray(data, entry.size) ||
+          !element->back().FromProto(proto)) {
+        return errors::DataLoss("Cache chunk ", filename_,
+                                " has a corrupt tensor");
+      }
+    } else if (region_ && entry.size > 0 &&
+               reinterpret_cast<intptr_t>(data) % kAlignment == 0) {
+      // The tensor owns its allocator, which keeps the mapping alive.
+      element->emplace_back(new MappedTensorAllocator(region_, data),
+                            entry.dtype, entry.shape);
+    } else {
+      element->emplace_back(entry.dtype, entry.shape);
+      if (entry.size > 0) {
+        memcpy(const_cast<char*>(element->back().tensor_data().data()), data,
+               entry.size);
+      }
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
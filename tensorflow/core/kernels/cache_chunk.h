@@ -0,0 +1,121 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_CACHE_CHUNK_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_CACHE_CHUNK_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+
+// A cache chunk is an immutable file that holds a sequence of dataset
+// elements, each of which is a fixed number of tensors. It is laid out so that
+// it can be memory-mapped and its tensors used in place:
+//
+//   [tensor data]  The contents of each tensor, starting at a multiple of
+//                  Allocator::kAllocatorAlignment. Tensors whose type can be
+//                  copied with memcpy are stored as raw bytes, and the others
+//                  (e.g. strings) as serialized TensorProtos.
+//   [index]        varint64 number of elements, varint32 tensors per element,
+//                  then for each tensor: varint32 dtype, varint32 encoding,
+//                  varint32 rank, varint64 dimensions, varint64 offset and
+//                  varint64 size of its data.
+//   [footer]       fixed64 index offset, fixed64 index size, fixed32 masked
+//                  crc32c of the index, fixed32 version, fixed64 magic.
+//
+// A `CacheChunkWriter` writes the chunk to a temporary file, and renames it
+// to its final name in `Finish()`, so a chunk that exists is complete.
+class CacheChunkWriter {
+ public:
+  CacheChunkWriter(Env* env, const string& filename);
+
+  // Creates the temporary file. Must be called before `Add()`.
+  Status Open();
+
+  // Appends an element to the chunk.
+  Status Add(const std::vector<Tensor>& element);
+
+  // Writes the index, closes the file and renames it to `filename`.
+  Status Finish();
+
+  int64 num_elements() const { return num_elements_; }
+  // The number of bytes of tensor data written so far.
+  uint64 size() const { return offset_; }
+
+ private:
+  Status Pad();
+
+  Env* const env_;
+  const string filename_;
+  const string tmp_filename_;
+  std::unique_ptr<WritableFile> file_;
+  uint64 offset_ = 0;
+  int64 num_elements_ = 0;
+  int32 num_tensors_ = -1;
+  string index_;
+};
+
+// A `CacheChunk` gives access to the elements of a chunk written by
+// `CacheChunkWriter`. The file is memory-mapped if the file system supports
+// it, and the tensors of types that can be copied with memcpy then alias the
+// mapped memory, which they keep alive. Otherwise the file is read into
+// memory and the tensors are copied out.
+//
+// This class is thread-safe once opened: several iterators may read the
+// elements of one chunk concurrently.
+class CacheChunk {
+ public:
+  // Opens and validates the chunk in `filename`.
+  static Status Open(Env* env, const string& filename,
+                     std::shared_ptr<const CacheChunk>* chunk);
+
+  int64 num_elements() const { return num_elements_; }
+  int32 num_tensors() const { return num_tensors_; }
+
+  // Returns the tensors of the `index`-th element of the chunk.
+  Status GetElement(int64 index, std::vector<Tensor>* element) const;
+
+ private:
+  struct TensorEntry {
+    DataType dtype;
+    bool raw;
+    TensorShape shape;
+    uint64 offset;
+    uint64 size;
+  };
+
+  CacheChunk() {}
+  Status ParseIndex();
+
+  string filename_;
+  std::shared_ptr<const ReadOnlyMemoryRegion> region_;
+  string contents_;
+  StringPiece data_;
+  int64 num_elements_ = 0;
+  int32 num_tensors_ = 0;
+  std::vector<TensorEntry> entries_;
+};
+
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_KERNELS_CACHE_CHUNK_H_
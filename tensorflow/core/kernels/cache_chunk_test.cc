@@ -0,0 +1,125 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/cache_chunk.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string ChunkFilename(const string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(CacheChunkTest, RoundTrip) {
+  const string filename = ChunkFilename("round_trip.chunk");
+  std::vector<std::vector<Tensor>> elements;
+  for (int i = 0; i < 3; ++i) {
+    elements.push_back({test::AsTensor<float>({1.0f * i, 2.0f, 3.0f}, {3}),
+                        test::AsTensor<string>({"a", string(i, 'b')}, {2, 1}),
+                        test::AsScalar<int64>(i)});
+  }
+  CacheChunkWriter writer(Env::Default(), filename);
+  TF_ASSERT_OK(writer.Open());
+  for (const auto& element : elements) {
+    TF_ASSERT_OK(writer.Add(element));
+  }
+  EXPECT_EQ(3, writer.num_elements());
+  // The chunk only appears when it is complete.
+  EXPECT_FALSE(Env::Default()->FileExists(filename).ok());
+  TF_ASSERT_OK(writer.Finish());
+
+  std::shared_ptr<const CacheChunk> chunk;
+  TF_ASSERT_OK(CacheChunk::Open(Env::Default(), filename, &chunk));
+  EXPECT_EQ(3, chunk->num_elements());
+  EXPECT_EQ(3, chunk->num_tensors());
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(chunk->GetElement(i, &element));
+    ASSERT_EQ(3, element.size());
+    test::ExpectTensorEqual<float>(elements[i][0], element[0]);
+    test::ExpectTensorEqual<string>(elements[i][1], element[1]);
+    test::ExpectTensorEqual<int64>(elements[i][2], element[2]);
+    // The tensors are aligned, whether or not they alias the mapping.
+    EXPECT_TRUE(element[0].IsAligned());
+  }
+  std::vector<Tensor> element;
+  EXPECT_TRUE(errors::IsOutOfRange(chunk->GetElement(3, &element)));
+}
+
+TEST(CacheChunkTest, TensorsOutliveChunk) {
+  const string filename = ChunkFilename("outlive.chunk");
+  CacheChunkWriter writer(Env::Default(), filename);
+  TF_ASSERT_OK(writer.Open());
+  TF_ASSERT_OK(writer.Add({test::AsTensor<int32>({1, 2, 3, 4}, {2, 2})}));
+  TF_ASSERT_OK(writer.Finish());
+
+  std::vector<Tensor> element;
+  {
+    std::shared_ptr<const CacheChunk> chunk;
+    TF_ASSERT_OK(CacheChunk::Open(Env::Default(), filename, &chunk));
+    TF_ASSERT_OK(chunk->GetElement(0, &element));
+  }
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({1, 2, 3, 4}, {2, 2}),
+                                 element[0]);
+}
+
+TEST(CacheChunkTest, EmptyChunk) {
+  const string filename = ChunkFilename("empty.chunk");
+  CacheChunkWriter writer(Env::Default(), filename);
+  TF_ASSERT_OK(writer.Open());
+  TF_ASSERT_OK(writer.Finish());
+
+  std::shared_ptr<const CacheChunk> chunk;
+  TF_ASSERT_OK(CacheChunk::Open(Env::Default(), filename, &chunk));
+  EXPECT_EQ(0, chunk->num_elements());
+}
+
+TEST(CacheChunkTest, MismatchedElement) {
+  CacheChunkWriter writer(Env::Default(), ChunkFilename("mismatch.chunk"));
+  TF_ASSERT_OK(writer.Open());
+  TF_ASSERT_OK(writer.Add({test::AsScalar<int32>(1)}));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      writer.Add({test::AsScalar<int32>(1), test::AsScalar<int32>(2)})));
+}
+
+TEST(CacheChunkTest, CorruptChunk) {
+  const string filename = ChunkFilename("corrupt.chunk");
+  CacheChunkWriter writer(Env::Default(), filename);
+  TF_ASSERT_OK(writer.Open());
+  TF_ASSERT_OK(writer.Add({test::AsScalar<int32>(1)}));
+  TF_ASSERT_OK(writer.Finish());
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  std::shared_ptr<const CacheChunk> chunk;
+  // Flip a byte of the index, which is checksummed.
+  contents[contents.size() - 33] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+  EXPECT_TRUE(errors::IsDataLoss(
+      CacheChunk::Open(Env::Default(), filename, &chunk)));
+
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, "short"));
+  EXPECT_TRUE(errors::IsDataLoss(
+      CacheChunk::Open(Env::Default(), filename, &chunk)));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,8 +14,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/dataset.h"
 
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/cache_chunk.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -42,15 +50,17 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     if (filename.empty()) {
       *output = new MemoryDataset(input);
     } else {
-      *output = new FileDataset(input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, ctx->env());
     }
   }
 
  private:
-  class FileDataset : public DatasetBase {
+  class FileDataset : public GraphDatasetBase {
    public:
-    explicit FileDataset(const DatasetBase* input, string filename, Env* env)
-        : input_(input),
+    explicit FileDataset(OpKernelContext* ctx, const DatasetBase* input,
+                         string filename, Env* env)
+        : GraphDatasetBase(ctx),
+          input_(input),
           filename_(std::move(filename)),
           env_(env),
           num_tensors_(input->output_dtypes().size()),
@@ -68,12 +78,22 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     std::unique_ptr<IteratorBase> MakeIterator(
         const string& prefix) const override {
       if (env_->FileExists(strings::StrCat(filename_, ".index")).ok()) {
+        // A cache written by an earlier version, in the tensor bundle format.
         return std::unique_ptr<IteratorBase>(new FileReaderIterator(
             {this, strings::StrCat(prefix, "::FileReader")}));
-      } else {
-        return std::unique_ptr<IteratorBase>(new FileWriterIterator(
-            {this, strings::StrCat(prefix, "::FileWriter")}));
       }
+      std::vector<string> done_files;
+      Status s = env_->GetMatchingPaths(DoneFilename("*"), &done_files);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to look for the cache " << filename_ << ": "
+                     << s;
+      }
+      if (!done_files.empty()) {
+        return std::unique_ptr<IteratorBase>(new ChunkReaderIterator(
+            {this, strings::StrCat(prefix, "::ChunkReader")}));
+      }
+      return std::unique_ptr<IteratorBase>(new FileWriterIterator(
+          {this, strings::StrCat(prefix, "::FileWriter")}));
     }
 
     const DataTypeVector& output_dtypes() const override {
@@ -86,6 +106,17 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
 
     string DebugString() override { return "CacheDatasetOp::FileDataset"; }
 
+   protected:
+    Status AsGraphDefInternal(OpKernelContext* ctx, DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph = nullptr;
+      TF_RETURN_IF_ERROR(b->AddParentDataset(ctx, input_, &input_graph));
+      Node* filename = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename));
+      TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename}, output));
+      return Status::OK();
+    }
+
    private:
     static size_t StringPaddingSize(size_t num_tensors) {
       return strings::Printf("%zu", num_tensors - 1).size();
@@ -96,118 +127,359 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
                              tensor_index);
     }
 
+    // The cache consists of the files of its writers: writer `writer_id`
+    // writes its elements to the chunks "<filename>.<writer_id>.<n>.chunk",
+    // holds "<filename>.<writer_id>.lockfile" while it writes, and creates
+    // "<filename>.<writer_id>.done", which holds its number of chunks, when
+    // it has written all the elements of its input.
+    string ChunkFilename(const string& writer_id, int64 chunk_index) const {
+      return strings::Printf("%s.%s.%08lld.chunk", filename_.c_str(),
+                             writer_id.c_str(),
+                             static_cast<long long>(chunk_index));
+    }
+
+    string LockFilename(const string& writer_id) const {
+      return strings::StrCat(filename_, ".", writer_id, ".lockfile");
+    }
+
+    string DoneFilename(const string& writer_id) const {
+      return strings::StrCat(filename_, ".", writer_id, ".done");
+    }
+
+    // Returns the chunk in `chunk_filename`, which shares its mapping with
+    // the other iterators that read it.
+    Status GetChunk(const string& chunk_filename,
+                    std::shared_ptr<const CacheChunk>* chunk) const {
+      mutex_lock l(mu_);
+      std::weak_ptr<const CacheChunk>& cached = chunks_[chunk_filename];
+      *chunk = cached.lock();
+      if (!*chunk) {
+        TF_RETURN_IF_ERROR(CacheChunk::Open(env_, chunk_filename, chunk));
+        cached = *chunk;
+      }
+      return Status::OK();
+    }
+
     // FileWriterIterator passes through and caches items from the input
     // FileDataset.
     //
-    // This iterator is used when the cache directory is not found on disk. It
-    // creates the cache directory, and passes on the underlying iterator's
-    // elements.
+    // This iterator is used when no writer of the cache has finished. Several
+    // iterators, e.g. one per shard of a sharded input pipeline, may write
+    // the same cache concurrently; each of them writes its own chunks, and
+    // the cache holds the elements of all of them. The chunks written so far
+    // are kept when the iterator is saved, so that a restored iterator
+    // resumes writing the cache in the middle of the epoch.
     class FileWriterIterator : public DatasetIterator<FileDataset> {
      public:
       explicit FileWriterIterator(const Params& params)
           : DatasetIterator<FileDataset>(params),
-            cur_index_(0),
             input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
-            writer_(params.dataset->env_, params.dataset->filename_),
-            lockfile_(strings::StrCat(params.dataset->filename_, ".lockfile")),
-            lockfile_created_(false),
-            iteration_completed_(false) {}
+            writer_id_(strings::Printf(
+                "%016llx", static_cast<unsigned long long>(random::New64()))) {}
+
+      ~FileWriterIterator() override {
+        mutex_lock l(mu_);
+        if (iteration_completed_) {
+          return;
+        }
+        if (saved_) {
+          // Keep the chunks for an iterator restored from the checkpoint,
+          // which creates the lockfile again.
+          if (lockfile_created_) {
+            dataset()
+                ->env_->DeleteFile(dataset()->LockFilename(writer_id_))
+                .IgnoreError();
+          }
+        } else {
+          // Nobody can resume this writer, so remove what it wrote.
+          DeleteFilesLocked(/*num_chunks_to_keep=*/0);
+        }
+      }
 
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(EnsureLockFileExists());
-        TF_RETURN_IF_ERROR(writer_.status());
-        if (cur_index_ >= kMaxItems) {
-          // As a courtesy, close the [truncated] cache file.
-          Status s = Finish();
-          if (!s.ok()) {
-            LOG(ERROR) << s;
-          }
-          return errors::InvalidArgument(
-              "Upstream iterator is producing more than ", kMaxItems,
-              " items, which is more than the cache limit.");
-        }
-
         TF_RETURN_IF_ERROR(
             input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
-        if (*end_of_sequence && out_tensors->empty()) {
-          TF_RETURN_IF_ERROR(Finish());
-          cur_index_++;
-          return Status::OK();
+        if (*end_of_sequence) {
+          return Finish();
         }
         if (out_tensors->size() != dataset()->num_tensors_) {
           return errors::Internal(
               "Upstream iterator returned invalid number of tensors. Expected ",
               dataset()->num_tensors_, " got: ", out_tensors->size());
         }
-        size_t tensor_index = 0;
-        for (const Tensor& t : *out_tensors) {
-          DCHECK_LT(tensor_index, dataset()->num_tensors_);
-          string key = dataset()->FormatName(cur_index_, tensor_index++);
-          TF_RETURN_IF_ERROR(writer_.Add(key, t));
+        if (!chunk_writer_) {
+          chunk_writer_.reset(new CacheChunkWriter(
+              dataset()->env_, dataset()->ChunkFilename(writer_id_,
+                                                        num_chunks_)));
+          TF_RETURN_IF_ERROR(chunk_writer_->Open());
         }
-        if (*end_of_sequence) {
-          TF_RETURN_IF_ERROR(Finish());
+        TF_RETURN_IF_ERROR(chunk_writer_->Add(*out_tensors));
+        if (chunk_writer_->size() >= kChunkBytes) {
+          TF_RETURN_IF_ERROR(FinishChunk());
+        }
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        // Complete the current chunk, so that the elements produced so far
+        // stay in the cache if the iterator is restored.
+        TF_RETURN_IF_ERROR(FinishChunk());
+        TF_RETURN_IF_ERROR(SaveParent(writer, input_impl_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("writer_id"), writer_id_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("num_chunks"), num_chunks_));
+        if (iteration_completed_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("iteration_completed"), ""));
+        }
+        saved_ = true;
+        return Status::OK();
+      }
+
+      Status RestoreInternal(OpKernelContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        if (!iteration_completed_ && !saved_) {
+          DeleteFilesLocked(/*num_chunks_to_keep=*/0);
+        }
+        chunk_writer_.reset();
+        lockfile_created_ = false;
+        TF_RETURN_IF_ERROR(RestoreParent(ctx, reader, input_impl_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("writer_id"), &writer_id_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("num_chunks"), &num_chunks_));
+        iteration_completed_ =
+            reader->Contains(full_name("iteration_completed"));
+        saved_ = true;
+        if (!iteration_completed_) {
+          // Remove the chunks written after the checkpoint; the restored
+          // iterator writes their elements again.
+          DeleteFilesLocked(/*num_chunks_to_keep=*/num_chunks_);
         }
-        cur_index_++;
         return Status::OK();
       }
 
      private:
+      // Chunks are completed once they hold this many bytes of tensor data.
+      static const uint64 kChunkBytes = 64 << 20;
+
       Status EnsureLockFileExists() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (iteration_completed_)
           return errors::OutOfRange(
               "Attempting to call get_next after iteration should have "
               "finished.");
-        if (lockfile_created_ && !iteration_completed_) return Status::OK();
-        // Perform rudimentary locking to help catch concurrent writes to the
-        // same cache files.
-        if (dataset()->env_->FileExists(lockfile_).ok()) {
-          // Attempt to read the contents of the lockfile.
-          char contents_scratch[151] = {0};  // Initialize all to 0.
-          StringPiece contents;
-          std::unique_ptr<RandomAccessFile> file;
-          if (dataset()->env_->NewRandomAccessFile(lockfile_, &file).ok()) {
-            file->Read(0, 150, &contents, contents_scratch).IgnoreError();
-          }
-          return errors::AlreadyExists(
-              "There appears to be a concurrent caching iterator running - "
-              "cache lockfile already exists ('",
-              lockfile_,
-              "'). If you are sure no other running TF computations are using "
-              "this cache prefix, delete the lockfile and re-initialize the "
-              "iterator. Lockfile contents: ",
-              contents);
-        } else {
-          // Create the file, and write some basic contents.
-          std::unique_ptr<WritableFile> lockfile;
-          TF_RETURN_IF_ERROR(
-              dataset()->env_->NewWritableFile(lockfile_, &lockfile));
-          TF_RETURN_IF_ERROR(lockfile->Append(
-              strings::StrCat("Created at: ", dataset()->env_->NowSeconds())));
-          lockfile_created_ = true;
-          return Status::OK();
+        if (lockfile_created_) return Status::OK();
+        // The lockfile tells readers that the cache is still being written.
+        std::unique_ptr<WritableFile> lockfile;
+        TF_RETURN_IF_ERROR(dataset()->env_->NewWritableFile(
+            dataset()->LockFilename(writer_id_), &lockfile));
+        TF_RETURN_IF_ERROR(lockfile->Append(
+            strings::StrCat("Created at: ", dataset()->env_->NowSeconds())));
+        TF_RETURN_IF_ERROR(lockfile->Close());
+        lockfile_created_ = true;
+        return Status::OK();
+      }
+
+      Status FinishChunk() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (chunk_writer_) {
+          TF_RETURN_IF_ERROR(chunk_writer_->Finish());
+          chunk_writer_.reset();
+          ++num_chunks_;
         }
+        return Status::OK();
       }
 
       Status Finish() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         iteration_completed_ = true;
-        TF_RETURN_IF_ERROR(writer_.Finish());
-        TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(lockfile_));
-        return Status::OK();
+        TF_RETURN_IF_ERROR(FinishChunk());
+        Env* env = dataset()->env_;
+        const string done_filename = dataset()->DoneFilename(writer_id_);
+        const string tmp_filename = strings::StrCat(done_filename, ".tmp");
+        TF_RETURN_IF_ERROR(
+            WriteStringToFile(env, tmp_filename, strings::StrCat(num_chunks_)));
+        TF_RETURN_IF_ERROR(env->RenameFile(tmp_filename, done_filename));
+        return env->DeleteFile(dataset()->LockFilename(writer_id_));
+      }
+
+      // Deletes the files of this writer, except for its first
+      // `num_chunks_to_keep` chunks.
+      void DeleteFilesLocked(int64 num_chunks_to_keep)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        Env* env = dataset()->env_;
+        std::vector<string> filenames;
+        Status s = env->GetMatchingPaths(
+            strings::StrCat(dataset()->filename_, ".", writer_id_, ".*"),
+            &filenames);
+        std::set<string> kept;
+        for (int64 i = 0; i < num_chunks_to_keep; ++i) {
+          kept.insert(dataset()->ChunkFilename(writer_id_, i));
+        }
+        for (const string& filename : filenames) {
+          if (kept.count(filename) == 0) {
+            s.Update(env->DeleteFile(filename));
+          }
+        }
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to delete the files of cache writer "
+                       << writer_id_ << ": " << s;
+        }
       }
 
       mutex mu_;
-      size_t cur_index_ GUARDED_BY(mu_);
       std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
-      BundleWriter writer_ GUARDED_BY(mu_);
-      const string lockfile_;
-      bool lockfile_created_ GUARDED_BY(mu_);
-      bool iteration_completed_ GUARDED_BY(mu_);
+      string writer_id_ GUARDED_BY(mu_);
+      std::unique_ptr<CacheChunkWriter> chunk_writer_ GUARDED_BY(mu_);
+      int64 num_chunks_ GUARDED_BY(mu_) = 0;
+      bool lockfile_created_ GUARDED_BY(mu_) = false;
+      bool iteration_completed_ GUARDED_BY(mu_) = false;
+      bool saved_ GUARDED_BY(mu_) = false;
     };  // FileWriterIterator
 
+    // ChunkReaderIterator reads the elements of all the writers of the cache,
+    // in the order of their writer ids, from their memory-mapped chunks.
+    //
+    // This iterator is used when a writer of the cache has finished. It waits
+    // until all the writers, whose lockfiles exist, have finished.
+    class ChunkReaderIterator : public DatasetIterator<FileDataset> {
+     public:
+      explicit ChunkReaderIterator(const Params& params)
+          : DatasetIterator<FileDataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(EnsureChunksListed());
+        while (chunk_index_ < chunk_filenames_.size()) {
+          if (!chunk_) {
+            TF_RETURN_IF_ERROR(
+                dataset()->GetChunk(chunk_filenames_[chunk_index_], &chunk_));
+          }
+          if (element_index_ < chunk_->num_elements()) {
+            TF_RETURN_IF_ERROR(
+                chunk_->GetElement(element_index_, out_tensors));
+            TF_RETURN_IF_ERROR(CheckElement(*out_tensors));
+            ++element_index_;
+            *end_of_sequence = false;
+            return Status::OK();
+          }
+          chunk_.reset();
+          ++chunk_index_;
+          element_index_ = 0;
+        }
+        *end_of_sequence = true;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("chunk_index"), chunk_index_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("element_index"), element_index_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(OpKernelContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        int64 chunk_index;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("chunk_index"), &chunk_index));
+        chunk_index_ = chunk_index;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("element_index"), &element_index_));
+        chunk_.reset();
+        return Status::OK();
+      }
+
+     private:
+      // Polling interval while writers of the cache are running.
+      static const int64 kWaitForWritersUsecs = 1000000;
+
+      Status EnsureChunksListed() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (chunks_listed_) {
+          return Status::OK();
+        }
+        Env* env = dataset()->env_;
+        for (int64 num_waits = 0;; ++num_waits) {
+          std::vector<string> lockfiles;
+          TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+              dataset()->LockFilename("*"), &lockfiles));
+          if (lockfiles.empty()) {
+            break;
+          }
+          if (num_waits % 60 == 0) {
+            LOG(WARNING) << "Waiting for " << lockfiles.size()
+                         << " writers of the cache " << dataset()->filename_
+                         << " to finish. If their iterators are no longer "
+                            "running, delete their lockfiles: "
+                         << str_util::Join(lockfiles, ", ");
+          }
+          env->SleepForMicroseconds(kWaitForWritersUsecs);
+        }
+
+        std::vector<string> done_files;
+        TF_RETURN_IF_ERROR(
+            env->GetMatchingPaths(dataset()->DoneFilename("*"), &done_files));
+        std::sort(done_files.begin(), done_files.end());
+        const string prefix = strings::StrCat(dataset()->filename_, ".");
+        chunk_filenames_.clear();
+        for (const string& done_file : done_files) {
+          StringPiece writer_id(done_file);
+          if (!writer_id.Consume(prefix) || !writer_id.ends_with(".done")) {
+            continue;
+          }
+          writer_id.remove_suffix(strlen(".done"));
+          string contents;
+          int64 num_chunks;
+          TF_RETURN_IF_ERROR(ReadFileToString(env, done_file, &contents));
+          if (!strings::safe_strto64(contents, &num_chunks)) {
+            return errors::DataLoss("Corrupt cache file ", done_file);
+          }
+          for (int64 i = 0; i < num_chunks; ++i) {
+            chunk_filenames_.push_back(
+                dataset()->ChunkFilename(writer_id.ToString(), i));
+          }
+        }
+        chunks_listed_ = true;
+        return Status::OK();
+      }
+
+      Status CheckElement(const std::vector<Tensor>& element) {
+        if (element.size() != dataset()->num_tensors_) {
+          return errors::InvalidArgument(
+              "The cache ", dataset()->filename_, " holds elements of ",
+              element.size(), " tensors, expected ", dataset()->num_tensors_);
+        }
+        for (size_t i = 0; i < element.size(); ++i) {
+          if (element[i].dtype() != dataset()->output_dtypes()[i]) {
+            return errors::InvalidArgument(
+                "The cache ", dataset()->filename_, " holds tensors of type ",
+                DataTypeString(element[i].dtype()), " for component ", i,
+                ", expected ", DataTypeString(dataset()->output_dtypes()[i]));
+          }
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      bool chunks_listed_ GUARDED_BY(mu_) = false;
+      std::vector<string> chunk_filenames_ GUARDED_BY(mu_);
+      size_t chunk_index_ GUARDED_BY(mu_) = 0;
+      int64 element_index_ GUARDED_BY(mu_) = 0;
+      std::shared_ptr<const CacheChunk> chunk_ GUARDED_BY(mu_);
+    };  // ChunkReaderIterator
+
     class FileReaderIterator : public DatasetIterator<FileDataset> {
      public:
       explicit FileReaderIterator(const Params& params)
@@ -259,6 +531,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
     static const size_t kMaxItems = 10000000;  // 10 million
     const size_t item_index_padding_size_;
     const string tensor_format_string_;
+    mutable mutex mu_;
+    mutable std::unordered_map<string, std::weak_ptr<const CacheChunk>> chunks_
+        GUARDED_BY(mu_);
   };  // FileDataset
 
   class MemoryDataset : public DatasetBase {
@@ -0,0 +1,72 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+// CollectiveAllReduce nodes are rewritten into Send/Recv and arithmetic after
+// placement (see common_runtime/all_reduce.cc). The kernels exist so that the
+// placer can put the nodes on a device, and run only for groups of one node,
+// where the reduction is the identity.
+class CollectiveAllReduceOp : public OpKernel {
+ public:
+  explicit CollectiveAllReduceOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    int group_size;
+    OP_REQUIRES_OK(context, context->GetAttr("group_size", &group_size));
+    OP_REQUIRES(context, group_size == 1,
+                errors::Unimplemented(
+                    "CollectiveAllReduce with group_size ", group_size,
+                    " must be rewritten before it is executed"));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    context->set_output(0, context->input(0));
+  }
+
+  bool IsExpensive() override { return false; }
+};
+
+REGISTER_KERNEL_BUILDER(Name("CollectiveAllReduce").Device(DEVICE_CPU),
+                        CollectiveAllReduceOp);
+
+#if GOOGLE_CUDA
+#define REGISTER_GPU_KERNEL(type)                                    \
+  REGISTER_KERNEL_BUILDER(                                           \
+      Name("CollectiveAllReduce").Device(DEVICE_GPU).TypeConstraint< \
+          type>("T"),                                                \
+      CollectiveAllReduceOp);
+
+TF_CALL_half(REGISTER_GPU_KERNEL);
+TF_CALL_float(REGISTER_GPU_KERNEL);
+TF_CALL_double(REGISTER_GPU_KERNEL);
+TF_CALL_int64(REGISTER_GPU_KERNEL);
+#undef REGISTER_GPU_KERNEL
+
+// A special GPU kernel for int32.
+// TODO(b/25387198): Also enable int32 in device memory. This kernel
+// registration requires all int32 inputs and outputs to be in host memory.
+REGISTER_KERNEL_BUILDER(Name("CollectiveAllReduce")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("input")
+                            .HostMemory("data")
+                            .TypeConstraint<int32>("T"),
+                        CollectiveAllReduceOp);
+#endif  // GOOGLE_CUDA
+
+}  // namespace tensorflow
@@ -0,0 +1,479 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstring>
+
+#include "tensorflow/core/kernels/dataset.h"
+
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/util/columnar_file.pb.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+// The footer of a columnar file, described in
+// ../util/columnar_file.proto, is the size of its metadata and this magic
+// number ("tfcolumn").
+const uint64 kColumnarFileMagic = 0x6e6d756c6f636674ull;
+const size_t kFooterSize = 2 * sizeof(uint64);
+
+// An open columnar file and its metadata.
+struct ColumnarFile {
+  string filename;
+  std::unique_ptr<RandomAccessFile> file;
+  ColumnarFileMetadata metadata;
+  // The index in `metadata.columns()` of each column that is read.
+  std::vector<int> column_indices;
+};
+
+class ColumnarDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ColumnarDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES(ctx, output_types_.size() == output_shapes_.size(),
+                errors::InvalidArgument(
+                    "`output_types` and `output_shapes` must have the same "
+                    "length."));
+    for (const DataType& dt : output_types_) {
+      OP_REQUIRES(ctx, dt == DT_STRING || DataTypeCanUseMemcpy(dt),
+                  errors::InvalidArgument("Unsupported column type: ",
+                                          DataTypeString(dt)));
+    }
+    // Column chunks store the values of fixed-size types in little-endian
+    // order, and are read straight into the output tensors.
+    OP_REQUIRES(ctx, port::kLittleEndian,
+                errors::Unimplemented(
+                    "ColumnarDataset is only supported on little-endian "
+                    "hosts."));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    const Tensor* columns_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("columns", &columns_tensor));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(columns_tensor->shape()),
+                errors::InvalidArgument("`columns` must be a vector."));
+    OP_REQUIRES(ctx, columns_tensor->NumElements() == output_types_.size(),
+                errors::InvalidArgument(
+                    "`columns` has ", columns_tensor->NumElements(),
+                    " elements, but `output_types` has ",
+                    output_types_.size()));
+
+    std::vector<string> columns;
+    columns.reserve(columns_tensor->NumElements());
+    for (int i = 0; i < columns_tensor->NumElements(); ++i) {
+      columns.push_back(columns_tensor->flat<string>()(i));
+    }
+
+    *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                          output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            std::vector<string> columns, const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : GraphDatasetBase(ctx),
+          filenames_(std::move(filenames)),
+          columns_(std::move(columns)),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::Columnar")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override { return "ColumnarDatasetOp::Dataset"; }
+
+   protected:
+    Status AsGraphDefInternal(DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* columns = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+      AttrValue output_types;
+      b->BuildAttrValue(output_types_, &output_types);
+      AttrValue output_shapes;
+      b->BuildAttrValue(output_shapes_, &output_shapes);
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames, columns},
+          {std::make_pair("output_types", output_types),
+           std::make_pair("output_shapes", output_shapes)},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    // Opens `filename`, reads its metadata, and finds the columns to read.
+    Status OpenFile(Env* env, const string& filename,
+                    ColumnarFile* file) const {
+      file->filename = filename;
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+      if (file_size < kFooterSize) {
+        return errors::DataLoss(filename, " is too small to be a columnar ",
+                                "file.");
+      }
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file->file));
+
+      char footer[kFooterSize];
+      StringPiece result;
+      TF_RETURN_IF_ERROR(file->file->Read(file_size - kFooterSize,
+                                          kFooterSize, &result, footer));
+      const uint64 metadata_size = core::DecodeFixed64(result.data());
+      if (core::DecodeFixed64(result.data() + sizeof(uint64)) !=
+          kColumnarFileMagic) {
+        return errors::DataLoss(filename, " is not a columnar file.");
+      }
+      if (metadata_size > file_size - kFooterSize) {
+        return errors::DataLoss("The metadata of columnar file ", filename,
+                                " has ", metadata_size,
+                                " bytes, which is more than the file.");
+      }
+      const uint64 data_size = file_size - kFooterSize - metadata_size;
+      string metadata;
+      metadata.resize(metadata_size);
+      TF_RETURN_IF_ERROR(
+          file->file->Read(data_size, metadata_size, &result, &metadata[0]));
+      if (!file->metadata.ParseFromArray(result.data(), result.size())) {
+        return errors::DataLoss("Could not parse the metadata of columnar "
+                                "file ",
+                                filename);
+      }
+
+      // Only the chunks of the requested columns are ever read.
+      file->column_indices.clear();
+      for (size_t i = 0; i < columns_.size(); ++i) {
+        int index = -1;
+        for (int c = 0; c < file->metadata.columns_size(); ++c) {
+          if (file->metadata.columns(c).name() == columns_[i]) {
+            index = c;
+            break;
+          }
+        }
+        if (index < 0) {
+          return errors::InvalidArgument("Columnar file ", filename,
+                                         " has no column ", columns_[i]);
+        }
+        const ColumnarFileMetadata::Column& column =
+            file->metadata.columns(index);
+        if (column.dtype() != output_types_[i]) {
+          return errors::InvalidArgument(
+              "Column ", columns_[i], " of ", filename, " has type ",
+              DataTypeString(column.dtype()), ", but type ",
+              DataTypeString(output_types_[i]), " is expected.");
+        }
+        TF_RETURN_IF_ERROR(TensorShape::IsValidShape(column.shape()));
+        PartialTensorShape batch_shape({-1});
+        batch_shape = batch_shape.Concatenate(TensorShape(column.shape()));
+        if (!output_shapes_[i].IsCompatibleWith(batch_shape)) {
+          return errors::InvalidArgument(
+              "Column ", columns_[i], " of ", filename, " has batches of ",
+              "shape ", batch_shape.DebugString(), ", which is incompatible ",
+              "with the expected shape ", output_shapes_[i].DebugString());
+        }
+        file->column_indices.push_back(index);
+      }
+
+      for (const ColumnarFileMetadata::RowGroup& row_group :
+           file->metadata.row_groups()) {
+        if (row_group.num_rows() < 0 ||
+            row_group.chunks_size() != file->metadata.columns_size()) {
+          return errors::DataLoss("Columnar file ", filename,
+                                  " has an invalid row group.");
+        }
+        for (const ColumnarFileMetadata::ColumnChunk& chunk :
+             row_group.chunks()) {
+          if (chunk.offset() > data_size ||
+              chunk.size() > data_size - chunk.offset()) {
+            return errors::DataLoss("Columnar file ", filename,
+                                    " has a column chunk outside of its ",
+                                    "data.");
+          }
+        }
+      }
+      return Status::OK();
+    }
+
+    // Reads the chunks of the requested columns of row group `row_group`,
+    // each into a tensor with a row per row of the group.
+    Status ReadRowGroup(const ColumnarFile& file, int row_group,
+                        std::vector<Tensor>* out_tensors) const {
+      const ColumnarFileMetadata::RowGroup& group =
+          file.metadata.row_groups(row_group);
+      out_tensors->clear();
+      out_tensors->reserve(file.column_indices.size());
+      for (int c : file.column_indices) {
+        const ColumnarFileMetadata::Column& column = file.metadata.columns(c);
+        const ColumnarFileMetadata::ColumnChunk& chunk = group.chunks(c);
+        TensorShape shape({group.num_rows()});
+        shape.AppendShape(TensorShape(column.shape()));
+        Tensor tensor(cpu_allocator(), column.dtype(), shape);
+        auto chunk_error = [&](StringPiece message) {
+          return errors::DataLoss("Chunk of column ", column.name(),
+                                  " in row group ", row_group, " of ",
+                                  file.filename, " ", message);
+        };
+
+        if (column.dtype() == DT_STRING) {
+          string buffer;
+          buffer.resize(chunk.size());
+          StringPiece input;
+          TF_RETURN_IF_ERROR(file.file->Read(chunk.offset(), chunk.size(),
+                                             &input, &buffer[0]));
+          auto values = tensor.flat<string>();
+          std::vector<uint64> lengths(values.size());
+          for (uint64& length : lengths) {
+            if (!core::GetVarint64(&input, &length)) {
+              return chunk_error("has truncated value lengths.");
+            }
+          }
+          for (int64 i = 0; i < values.size(); ++i) {
+            if (lengths[i] > input.size()) {
+              return chunk_error("has truncated values.");
+            }
+            values(i).assign(input.data(), lengths[i]);
+            input.remove_prefix(lengths[i]);
+          }
+          if (!input.empty()) {
+            return chunk_error("has unexpected trailing bytes.");
+          }
+        } else {
+          // Values of fixed-size types are read straight into the tensor.
+          StringPiece data = tensor.tensor_data();
+          if (chunk.size() != data.size()) {
+            return chunk_error(strings::StrCat(
+                "has ", chunk.size(), " bytes, but ", data.size(),
+                " are expected."));
+          }
+          if (!data.empty()) {
+            char* scratch = const_cast<char*>(data.data());
+            StringPiece result;
+            TF_RETURN_IF_ERROR(file.file->Read(chunk.offset(), chunk.size(),
+                                               &result, scratch));
+            if (result.data() != scratch) {
+              memcpy(scratch, result.data(), result.size());
+            }
+          }
+        }
+        out_tensors->push_back(std::move(tensor));
+      }
+      return Status::OK();
+    }
+
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      ~Iterator() override {
+        mutex_lock l(mu_);
+        WaitForPrefetchLocked(&l);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        do {
+          // We are currently processing a file, so try to read its next row
+          // group.
+          if (file_) {
+            if (next_row_group_ < file_->metadata.row_groups_size()) {
+              std::vector<Tensor> row_group;
+              if (prefetch_row_group_ == next_row_group_) {
+                WaitForPrefetchLocked(&l);
+                prefetch_row_group_ = -1;
+                TF_RETURN_IF_ERROR(prefetch_status_);
+                row_group.swap(prefetch_tensors_);
+              } else {
+                TF_RETURN_IF_ERROR(dataset()->ReadRowGroup(
+                    *file_, next_row_group_, &row_group));
+              }
+              ++next_row_group_;
+              StartPrefetchLocked(ctx);
+              *out_tensors = std::move(row_group);
+              *end_of_sequence = false;
+              return Status::OK();
+            }
+
+            // We have reached the end of the current file, so maybe
+            // move on to next file.
+            ResetStreamsLocked(&l);
+            ++current_file_index_;
+          }
+
+          // Iteration ends when there are no more files to process.
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        } while (true);
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("current_file_index"),
+                                               current_file_index_));
+        if (file_) {
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("next_row_group"),
+                                                 next_row_group_));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(OpKernelContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        ResetStreamsLocked(&l);
+        int64 current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("current_file_index"),
+                                              &current_file_index));
+        current_file_index_ = size_t(current_file_index);
+        if (reader->Contains(full_name("next_row_group"))) {
+          int64 next_row_group;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("next_row_group"),
+                                                &next_row_group));
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+          if (next_row_group < 0 ||
+              next_row_group > file_->metadata.row_groups_size()) {
+            return errors::InvalidArgument(
+                "Cannot restore the iterator at row group ", next_row_group,
+                " of ", file_->filename, ", which has ",
+                file_->metadata.row_groups_size(), " row groups.");
+          }
+          next_row_group_ = next_row_group;
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Opens the file at `current_file_index_`.
+      Status SetupStreamsLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (current_file_index_ >= dataset()->filenames_.size()) {
+          return errors::InvalidArgument(
+              "current_file_index_:", current_file_index_,
+              " >= filenames_.size():", dataset()->filenames_.size());
+        }
+        std::unique_ptr<ColumnarFile> file(new ColumnarFile);
+        TF_RETURN_IF_ERROR(dataset()->OpenFile(
+            env, dataset()->filenames_[current_file_index_], file.get()));
+        file_ = std::move(file);
+        next_row_group_ = 0;
+        return Status::OK();
+      }
+
+      // Closes the current file, once no prefetch reads from it.
+      void ResetStreamsLocked(mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        WaitForPrefetchLocked(l);
+        prefetch_row_group_ = -1;
+        prefetch_tensors_.clear();
+        file_.reset();
+      }
+
+      // Starts reading the row group at `next_row_group_` in the
+      // background, so that its column chunks are read while the previous
+      // row group is consumed.
+      void StartPrefetchLocked(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (next_row_group_ >= file_->metadata.row_groups_size()) return;
+        prefetch_row_group_ = next_row_group_;
+        prefetch_in_flight_ = true;
+        const ColumnarFile* file = file_.get();
+        const int row_group = next_row_group_;
+        (*ctx->runner())([this, file, row_group]() {
+          std::vector<Tensor> tensors;
+          Status s = dataset()->ReadRowGroup(*file, row_group, &tensors);
+          mutex_lock l(mu_);
+          prefetch_status_ = s;
+          prefetch_tensors_ = std::move(tensors);
+          prefetch_in_flight_ = false;
+          cond_var_.notify_all();
+        });
+      }
+
+      void WaitForPrefetchLocked(mutex_lock* l)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (prefetch_in_flight_) {
+          cond_var_.wait(*l);
+        }
+      }
+
+      mutex mu_;
+      condition_variable cond_var_;
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+      std::unique_ptr<ColumnarFile> file_ GUARDED_BY(mu_);
+      int next_row_group_ GUARDED_BY(mu_) = 0;
+
+      // The row group that is read in the background, or -1, and the result
+      // of that read once `prefetch_in_flight_` is false.
+      int prefetch_row_group_ GUARDED_BY(mu_) = -1;
+      bool prefetch_in_flight_ GUARDED_BY(mu_) = false;
+      Status prefetch_status_ GUARDED_BY(mu_);
+      std::vector<Tensor> prefetch_tensors_ GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const std::vector<string> columns_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
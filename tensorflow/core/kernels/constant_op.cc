@@ -25,6 +25,7 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shared_tensor_store.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -33,7 +34,9 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/kernels/bounds_check.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/env_var.h"
 
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
@@ -41,12 +44,50 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+// Constants whose serialized value is at least this large are materialized
+// once per process and device through the SharedTensorStore, so that
+// sessions loading the same model variant share them. Zero disables
+// sharing.
+int64 SharedConstantMinBytes() {
+  static const int64 min_bytes = [] {
+    int64 value;
+    Status s = ReadInt64FromEnvVar("TF_SHARED_CONSTANT_MIN_BYTES", 0, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return static_cast<int64>(0);
+    }
+    return value;
+  }();
+  return min_bytes;
+}
+
+}  // namespace
+
 ConstantOp::ConstantOp(OpKernelConstruction* ctx)
     : OpKernel(ctx), tensor_(ctx->output_type(0)) {
   const TensorProto* proto = nullptr;
   OP_REQUIRES_OK(ctx, ctx->GetAttr("value", &proto));
-  OP_REQUIRES_OK(ctx, ctx->device()->MakeTensorFromProto(
-                          *proto, AllocatorAttributes(), &tensor_));
+  const int64 shared_min_bytes = SharedConstantMinBytes();
+  if (shared_min_bytes > 0 && proto->ByteSizeLong() >= shared_min_bytes) {
+    DeviceBase* device = ctx->device();
+    const string key = SharedTensorStore::MakeKey(
+        strings::StrCat(device->name(), "/",
+                        device->GetAllocator(AllocatorAttributes())->Name()),
+        proto->SerializeAsString());
+    OP_REQUIRES_OK(ctx, SharedTensorStore::Global()->LookupOrCreate(
+                            key,
+                            [device, proto](Tensor* tensor) {
+                              return device->MakeTensorFromProto(
+                                  *proto, AllocatorAttributes(), tensor);
+                            },
+                            &tensor_));
+    shared_key_ = key;
+  } else {
+    OP_REQUIRES_OK(ctx, ctx->device()->MakeTensorFromProto(
+                            *proto, AllocatorAttributes(), &tensor_));
+  }
   OP_REQUIRES(
       ctx, ctx->output_type(0) == tensor_.dtype(),
       errors::InvalidArgument("Type mismatch between value (",
@@ -66,7 +107,11 @@ void ConstantOp::Compute(OpKernelContext* ctx) {
   }
 }
 
-ConstantOp::~ConstantOp() {}
+ConstantOp::~ConstantOp() {
+  if (!shared_key_.empty()) {
+    SharedTensorStore::Global()->Release(shared_key_);
+  }
+}
 
 REGISTER_KERNEL_BUILDER(Name("Const").Device(DEVICE_CPU), ConstantOp);
 
@@ -33,6 +33,8 @@ class ConstantOp : public OpKernel {
 
  private:
   Tensor tensor_;
+  // Set if 'tensor_' is held by the SharedTensorStore.
+  string shared_key_;
   TF_DISALLOW_COPY_AND_ASSIGN(ConstantOp);
 };
 
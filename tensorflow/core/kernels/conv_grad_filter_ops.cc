@@ -898,8 +898,10 @@ void LaunchConv2DBackpropFilterOp<Eigen::GpuDevice, T>::operator()(
       device_id,                             // device_id
   };
   AlgorithmConfig algorithm_config;
-  if (cudnn_use_autotune && !AutoTuneConvBwdFilter::GetInstance()->Find(
-                                conv_parameters, &algorithm_config)) {
+  if (cudnn_use_autotune &&
+      !AutoTuneConvBwdFilter::GetInstance()->Find(
+          conv_parameters, AutoTuneCacheDeviceKey(stream),
+          &algorithm_config)) {
     std::vector<AlgorithmDesc> algorithms;
     CHECK(stream->parent()->GetConvolveBackwardFilterAlgorithms(
         conv_parameters.ShouldIncludeWinogradNonfusedAlgo<T>(), &algorithms));
@@ -944,6 +946,7 @@ void LaunchConv2DBackpropFilterOp<Eigen::GpuDevice, T>::operator()(
           best_result_no_scratch.algorithm());
     }
     AutoTuneConvBwdFilter::GetInstance()->Insert(conv_parameters,
+                                                 AutoTuneCacheDeviceKey(stream),
                                                  algorithm_config);
   }
   CudnnScratchAllocator scratch_allocator(ConvolveBackwardFilterScratchSize,
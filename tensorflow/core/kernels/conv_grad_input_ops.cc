@@ -954,8 +954,10 @@ void LaunchConv2DBackpropInputOp<GPUDevice, T>::operator()(
       device_id,                             // device_id
   };
   AlgorithmConfig algorithm_config;
-  if (cudnn_use_autotune && !AutoTuneConvBwdData::GetInstance()->Find(
-                                conv_parameters, &algorithm_config)) {
+  if (cudnn_use_autotune &&
+      !AutoTuneConvBwdData::GetInstance()->Find(conv_parameters,
+                                                AutoTuneCacheDeviceKey(stream),
+                                                &algorithm_config)) {
     std::vector<AlgorithmDesc> algorithms;
     CHECK(stream->parent()->GetConvolveBackwardDataAlgorithms(
         conv_parameters.ShouldIncludeWinogradNonfusedAlgo<T>(), &algorithms));
@@ -999,6 +1001,7 @@ void LaunchConv2DBackpropInputOp<GPUDevice, T>::operator()(
           best_result_no_scratch.algorithm());
     }
     AutoTuneConvBwdData::GetInstance()->Insert(conv_parameters,
+                                               AutoTuneCacheDeviceKey(stream),
                                                algorithm_config);
   }
   bool cudnn_launch_status =
@@ -658,8 +658,10 @@ class Conv3DBackpropInputOp<GPUDevice, T> : public OpKernel {
     using perftools::gputools::dnn::AlgorithmDesc;
     using perftools::gputools::dnn::ProfileResult;
     AlgorithmConfig algorithm_config;
-    if (cudnn_use_autotune_ && !AutoTuneConv3dBwdData::GetInstance()->Find(
-                                   conv_parameters, &algorithm_config)) {
+    if (cudnn_use_autotune_ &&
+        !AutoTuneConv3dBwdData::GetInstance()->Find(
+            conv_parameters, AutoTuneCacheDeviceKey(stream),
+            &algorithm_config)) {
       std::vector<AlgorithmDesc> algorithms;
       CHECK(stream->parent()->GetConvolveBackwardDataAlgorithms(
           conv_parameters.ShouldIncludeWinogradNonfusedAlgo<T>(), &algorithms));
@@ -702,8 +704,8 @@ class Conv3DBackpropInputOp<GPUDevice, T> : public OpKernel {
         algorithm_config.set_algorithm_no_scratch(
             best_result_no_scratch.algorithm());
       }
-      AutoTuneConv3dBwdData::GetInstance()->Insert(conv_parameters,
-                                                   algorithm_config);
+      AutoTuneConv3dBwdData::GetInstance()->Insert(
+          conv_parameters, AutoTuneCacheDeviceKey(stream), algorithm_config);
     }
     CudnnScratchAllocator scratch_allocator(ConvolveBackwardDataScratchSize,
                                             context);
@@ -1025,8 +1027,10 @@ class Conv3DBackpropFilterOp<GPUDevice, T> : public OpKernel {
     using perftools::gputools::dnn::AlgorithmDesc;
     using perftools::gputools::dnn::ProfileResult;
     AlgorithmConfig algorithm_config;
-    if (cudnn_use_autotune_ && !AutoTuneConv3dBwdFilter::GetInstance()->Find(
-                                   conv_parameters, &algorithm_config)) {
+    if (cudnn_use_autotune_ &&
+        !AutoTuneConv3dBwdFilter::GetInstance()->Find(
+            conv_parameters, AutoTuneCacheDeviceKey(stream),
+            &algorithm_config)) {
       std::vector<AlgorithmDesc> algorithms;
       CHECK(stream->parent()->GetConvolveBackwardFilterAlgorithms(
           conv_parameters.ShouldIncludeWinogradNonfusedAlgo<T>(), &algorithms));
@@ -1070,8 +1074,8 @@ class Conv3DBackpropFilterOp<GPUDevice, T> : public OpKernel {
         algorithm_config.set_algorithm_no_scratch(
             best_result_no_scratch.algorithm());
       }
-      AutoTuneConv3dBwdFilter::GetInstance()->Insert(conv_parameters,
-                                                     algorithm_config);
+      AutoTuneConv3dBwdFilter::GetInstance()->Insert(
+          conv_parameters, AutoTuneCacheDeviceKey(stream), algorithm_config);
     }
     CudnnScratchAllocator scratch_allocator(ConvolveBackwardFilterScratchSize,
                                             context);
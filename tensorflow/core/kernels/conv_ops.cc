@@ -85,6 +85,36 @@ struct LaunchGeneric {
           input.shaped<T, 2>({conv_width, filter.dim_size(2)}),
           filter.shaped<T, 2>({filter.dim_size(2), filter.dim_size(3)}),
           dim_pair);
+    } else if (filter.dim_size(0) == 1 && filter.dim_size(1) == 1) {
+      // A strided 1x1 convolution never pads, and reads only the input pixels
+      // at multiples of the strides. Those are gathered into a buffer, which
+      // is then multiplied by the filter as above.
+      int conv_width = 1;  // Width for the convolution step.
+      for (int i = 0; i < 3; ++i) {
+        conv_width *= output->dim_size(i);
+      }
+      Tensor strided_input;
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                              DataTypeToEnum<T>::value,
+                              TensorShape({output->dim_size(0),
+                                           output->dim_size(1),
+                                           output->dim_size(2),
+                                           filter.dim_size(2)}),
+                              &strided_input));
+      Eigen::DSizes<Eigen::DenseIndex, 4> strides(1, row_stride, col_stride,
+                                                  1);
+      strided_input.tensor<T, 4>().device(ctx->eigen_device<Device>()) =
+          input.tensor<T, 4>().stride(strides);
+
+      Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> dim_pair;
+      dim_pair[0] = Eigen::IndexPair<Eigen::DenseIndex>(1, 0);
+      functor::MatMulConvFunctor<Device, T>()(
+          ctx->eigen_device<Device>(),
+          output->shaped<T, 2>({conv_width, filter.dim_size(3)}),
+          static_cast<const Tensor&>(strided_input)
+              .shaped<T, 2>({conv_width, filter.dim_size(2)}),
+          filter.shaped<T, 2>({filter.dim_size(2), filter.dim_size(3)}),
+          dim_pair);
     } else if (filter.dim_size(0) == input.dim_size(1) &&
                filter.dim_size(1) == input.dim_size(2) && padding == VALID) {
       // If the input data and filter have the same height/width,
@@ -144,7 +174,8 @@ class LaunchDeepConvOp {
                   int /*out_cols*/, int /*out_depth*/, int /*dilation_rows*/,
                   int /*dilation_cols*/, int /*stride_rows*/,
                   int /*stride_cols*/, Tensor* /*output*/,
-                  TensorFormat /*data_format*/) {
+                  TensorFormat /*data_format*/,
+                  DeepConv2DFilterCache* /*filter_cache*/) {
     return false;
   }
 };
@@ -159,7 +190,8 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int dilation_rows,
                   int dilation_cols, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
+                  Tensor* output, TensorFormat data_format,
+                  DeepConv2DFilterCache* filter_cache) {
     if (data_format != FORMAT_NHWC || dilation_rows != 1 ||
         dilation_cols != 1 ||
         !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
@@ -185,7 +217,7 @@ class LaunchDeepConvOp<CPUDevice, float> {
     auto output_ptr = output->template flat<float>().data();
 
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
-                                            output_ptr);
+                                            output_ptr, filter_cache);
     return true;
   }
 };
@@ -420,7 +452,7 @@ class Conv2DOp : public BinaryOp<T> {
             context, input, filter, batch, input_rows, input_cols, in_depth,
             filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
             out_depth, dilation_rows, dilation_cols, stride_rows, stride_cols,
-            output, data_format_)) {
+            output, data_format_, &deep_conv_filter_cache_)) {
       return;
     }
 
@@ -437,6 +469,7 @@ class Conv2DOp : public BinaryOp<T> {
   TensorFormat data_format_;
   LaunchConv2DOp<Device, T> launcher_;
   bool cudnn_use_autotune_;
+  DeepConv2DFilterCache deep_conv_filter_cache_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(Conv2DOp);
 };
@@ -711,7 +744,9 @@ void LaunchConv2DOp<GPUDevice, T>::operator()(
   };
   AlgorithmConfig algorithm_config;
   if (cudnn_use_autotune &&
-      !AutoTuneConv::GetInstance()->Find(conv_parameters, &algorithm_config)) {
+      !AutoTuneConv::GetInstance()->Find(conv_parameters,
+                                         AutoTuneCacheDeviceKey(stream),
+                                         &algorithm_config)) {
     std::vector<AlgorithmDesc> algorithms;
     CHECK(stream->parent()->GetConvolveAlgorithms(
         conv_parameters.ShouldIncludeWinogradNonfusedAlgo<T>(), &algorithms));
@@ -755,7 +790,9 @@ void LaunchConv2DOp<GPUDevice, T>::operator()(
       algorithm_config.set_algorithm_no_scratch(
           best_result_no_scratch.algorithm());
     }
-    AutoTuneConv::GetInstance()->Insert(conv_parameters, algorithm_config);
+    AutoTuneConv::GetInstance()->Insert(conv_parameters,
+                                        AutoTuneCacheDeviceKey(stream),
+                                        algorithm_config);
   }
 
   CudnnScratchAllocator scratch_allocator(ConvolveScratchSize, ctx);
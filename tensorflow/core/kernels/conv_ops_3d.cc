@@ -392,8 +392,10 @@ struct LaunchConvOp<GPUDevice, T> {
 
     AlgorithmConfig algorithm_config;
 
-    if (cudnn_use_autotune && !AutoTuneConv3d::GetInstance()->Find(
-                                  conv_parameters, &algorithm_config)) {
+    if (cudnn_use_autotune &&
+        !AutoTuneConv3d::GetInstance()->Find(conv_parameters,
+                                             AutoTuneCacheDeviceKey(stream),
+                                             &algorithm_config)) {
       std::vector<AlgorithmDesc> algorithms;
       CHECK(stream->parent()->GetConvolveAlgorithms(
           conv_parameters.ShouldIncludeWinogradNonfusedAlgo<T>(), &algorithms));
@@ -435,7 +437,9 @@ struct LaunchConvOp<GPUDevice, T> {
         algorithm_config.set_algorithm_no_scratch(
             best_result_no_scratch.algorithm());
       }
-      AutoTuneConv3d::GetInstance()->Insert(conv_parameters, algorithm_config);
+      AutoTuneConv3d::GetInstance()->Insert(conv_parameters,
+                                            AutoTuneCacheDeviceKey(stream),
+                                            algorithm_config);
     }
 
     CudnnScratchAllocator scratch_allocator(ConvolveScratchSize, ctx);
@@ -21,6 +21,7 @@ limitations under the License.
 #include <string.h>
 #include <map>
 #include <vector>
+#include "third_party/eigen3/Eigen/Core"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/numeric_op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/util/mirror_pad_mode.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -886,4 +888,260 @@ TF_CALL_float(REGISTER_FUSED);
 
 TF_CALL_float(REGISTER_PAD_ONLY_FUSED);
 
+namespace {
+
+// The output of FusedConv2DWithBias is computed in blocks of rows that fit in
+// this many bytes, so that each output block is still in cache when the bias
+// and activation are applied. Blocks have at least kMinPatchesPerBlock rows,
+// since each GEMM packs the whole filter again.
+const size_t kFusedBiasBlockSize = (256 * 1024);
+const int64 kMinPatchesPerBlock = 32;
+
+// Activations applied by FusedConv2DWithBias.
+enum FusedActivation {
+  IDENTITY = 0,
+  RELU = 1,
+  RELU6 = 2,
+};
+
+// Adds "bias" to each of the "rows" rows of "output", then applies
+// "activation" to them.
+template <class T>
+void BiasAndActivation(FusedActivation activation, const T* bias, int64 rows,
+                       int64 depth, T* output) {
+  typedef Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+      Array;
+  Eigen::Map<Array> output_block(output, rows, depth);
+  Eigen::Map<const Eigen::Array<T, 1, Eigen::Dynamic>> bias_row(bias, 1,
+                                                                  depth);
+  output_block.rowwise() += bias_row;
+  switch (activation) {
+    case IDENTITY:
+      break;
+    case RELU:
+      output_block = output_block.max(T(0));
+      break;
+    case RELU6:
+      output_block = output_block.max(T(0)).min(T(6));
+      break;
+  }
+}
+
+}  // namespace
+
+// Implements Conv2D followed by BiasAdd and an activation. The convolution is
+// an im2col GEMM over blocks of output pixels, sharded over the CPU threads,
+// and each block gets its bias and activation right after its GEMM.
+template <class T>
+class FusedConv2DWithBiasOp : public OpKernel {
+ public:
+  explicit FusedConv2DWithBiasOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("strides", &strides_));
+    OP_REQUIRES(context, strides_.size() == 4,
+                errors::InvalidArgument("Sliding window strides field must "
+                                        "specify 4 dimensions"));
+    const int64 stride_n = GetTensorDim(strides_, FORMAT_NHWC, 'N');
+    const int64 stride_c = GetTensorDim(strides_, FORMAT_NHWC, 'C');
+    OP_REQUIRES(
+        context, stride_n == 1 && stride_c == 1,
+        errors::InvalidArgument("Current implementation does not yet support "
+                                "strides in the batch and depth dimensions."));
+    OP_REQUIRES_OK(context, context->GetAttr("padding", &padding_));
+    string activation;
+    OP_REQUIRES_OK(context, context->GetAttr("activation", &activation));
+    if (activation == "Identity") {
+      activation_ = IDENTITY;
+    } else if (activation == "Relu") {
+      activation_ = RELU;
+    } else if (activation == "Relu6") {
+      activation_ = RELU6;
+    } else {
+      context->CtxFailure(
+          errors::InvalidArgument("Unsupported activation: ", activation));
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // Input tensor is of the following dimensions:
+    // [ batch, in_rows, in_cols, in_depth ]
+    const Tensor& input = context->input(0);
+    // Input filter is of the following dimensions:
+    // [ filter_rows, filter_cols, in_depth, out_depth]
+    const Tensor& filter = context->input(1);
+    const Tensor& bias = context->input(2);
+
+    OP_REQUIRES(context, input.dims() == 4,
+                errors::InvalidArgument("input must be 4-dimensional",
+                                        input.shape().DebugString()));
+    OP_REQUIRES(context, filter.dims() == 4,
+                errors::InvalidArgument("filter must be 4-dimensional: ",
+                                        filter.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(bias.shape()),
+                errors::InvalidArgument("bias must be 1-dimensional: ",
+                                        bias.shape().DebugString()));
+    for (int i = 0; i < 4; i++) {
+      OP_REQUIRES(context, FastBoundsCheck(filter.dim_size(i),
+                                           std::numeric_limits<int>::max()),
+                  errors::InvalidArgument("filter too large"));
+    }
+
+    const int64 in_depth = input.dim_size(3);
+    OP_REQUIRES(
+        context, in_depth == filter.dim_size(2),
+        errors::InvalidArgument("input and filter must have the same depth: ",
+                                in_depth, " vs ", filter.dim_size(2)));
+    const int64 out_depth = filter.dim_size(3);
+    OP_REQUIRES(
+        context, out_depth == bias.dim_size(0),
+        errors::InvalidArgument("bias must have the same size as the last "
+                                "dimension of filter: ",
+                                bias.dim_size(0), " vs ", out_depth));
+
+    const int64 batch = input.dim_size(0);
+    const int64 in_rows = input.dim_size(1);
+    const int64 in_cols = input.dim_size(2);
+    const int64 filter_rows = filter.dim_size(0);
+    const int64 filter_cols = filter.dim_size(1);
+    const int stride_rows = GetTensorDim(strides_, FORMAT_NHWC, 'H');
+    const int stride_cols = GetTensorDim(strides_, FORMAT_NHWC, 'W');
+
+    int64 out_rows = 0, out_cols = 0, pad_rows = 0, pad_cols = 0;
+    OP_REQUIRES_OK(context,
+                   GetWindowedOutputSize(in_rows, filter_rows, stride_rows,
+                                         padding_, &out_rows, &pad_rows));
+    OP_REQUIRES_OK(context,
+                   GetWindowedOutputSize(in_cols, filter_cols, stride_cols,
+                                         padding_, &out_cols, &pad_cols));
+    TensorShape out_shape =
+        ShapeFromFormat(FORMAT_NHWC, batch, out_rows, out_cols, out_depth);
+
+    // Output tensor is of the following dimensions:
+    // [ in_batch, out_rows, out_cols, out_depth ]
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, out_shape, &output));
+
+    VLOG(2) << "FusedConv2DWithBias: " << name() << ", in_depth = " << in_depth
+            << ", in_cols = " << in_cols << ", filter_cols = " << filter_cols
+            << ", in_rows = " << in_rows << ", filter_rows = " << filter_rows
+            << ", stride_rows = " << stride_rows
+            << ", stride_cols = " << stride_cols
+            << ", out_depth = " << out_depth;
+
+    // If there is nothing to compute, return.
+    if (out_shape.num_elements() == 0) {
+      return;
+    }
+    if (input.NumElements() == 0 || filter.NumElements() == 0) {
+      output->flat<T>().setZero();
+      T* output_data = output->flat<T>().data();
+      BiasAndActivation<T>(activation_, bias.flat<T>().data(),
+                           batch * out_rows * out_cols, out_depth,
+                           output_data);
+      return;
+    }
+
+    // Every output pixel is the product of its patch of the input, laid out
+    // as an im2col row with the depth most contiguous, and of the filter as a
+    // [filter_value_count, out_depth] matrix. A 1x1 convolution with unit
+    // strides reads its patches straight from the input.
+    const int64 filter_value_count = filter_rows * filter_cols * in_depth;
+    const bool is_direct = (filter_rows == 1 && filter_cols == 1 &&
+                            stride_rows == 1 && stride_cols == 1);
+    const int64 patch_count = batch * out_rows * out_cols;
+    const int64 patches_per_block = std::min(
+        patch_count,
+        std::max<int64>(kMinPatchesPerBlock,
+                        kFusedBiasBlockSize / (out_depth * sizeof(T))));
+    const int64 block_count =
+        (patch_count + patches_per_block - 1) / patches_per_block;
+
+    const T* input_data = input.flat<T>().data();
+    const T* filter_data = filter.flat<T>().data();
+    const T* bias_data = bias.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const FusedActivation activation = activation_;
+
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        Matrix;
+    auto compute_blocks = [&](int64 start_block, int64 limit_block) {
+      std::vector<T> im2col_buffer;
+      if (!is_direct) {
+        im2col_buffer.resize(patches_per_block * filter_value_count);
+      }
+      Eigen::Map<const Matrix> filter_matrix(filter_data, filter_value_count,
+                                             out_depth);
+      for (int64 block = start_block; block < limit_block; ++block) {
+        const int64 patch_begin = block * patches_per_block;
+        const int64 patch_end =
+            std::min(patch_count, patch_begin + patches_per_block);
+        const int64 block_patches = patch_end - patch_begin;
+        const T* patches = input_data + patch_begin * in_depth;
+        if (!is_direct) {
+          for (int64 patch = patch_begin; patch < patch_end; ++patch) {
+            const int64 b = patch / (out_rows * out_cols);
+            const int64 out_y = (patch / out_cols) % out_rows;
+            const int64 out_x = patch % out_cols;
+            const int64 in_y_origin = out_y * stride_rows - pad_rows;
+            const int64 in_x_origin = out_x * stride_cols - pad_cols;
+            T* im2col_patch = im2col_buffer.data() +
+                              (patch - patch_begin) * filter_value_count;
+            for (int64 filter_y = 0; filter_y < filter_rows; ++filter_y) {
+              T* im2col_row =
+                  im2col_patch + filter_y * filter_cols * in_depth;
+              const int64 in_y = in_y_origin + filter_y;
+              if (in_y < 0 || in_y >= in_rows) {
+                std::fill_n(im2col_row, filter_cols * in_depth, T(0));
+                continue;
+              }
+              const T* input_row =
+                  input_data + (b * in_rows + in_y) * in_cols * in_depth;
+              for (int64 filter_x = 0; filter_x < filter_cols; ++filter_x) {
+                const int64 in_x = in_x_origin + filter_x;
+                T* im2col_pixel = im2col_row + filter_x * in_depth;
+                if (in_x < 0 || in_x >= in_cols) {
+                  std::fill_n(im2col_pixel, in_depth, T(0));
+                } else {
+                  std::copy_n(input_row + in_x * in_depth, in_depth,
+                              im2col_pixel);
+                }
+              }
+            }
+          }
+          patches = im2col_buffer.data();
+        }
+        T* block_output = output_data + patch_begin * out_depth;
+        Eigen::Map<Matrix> output_matrix(block_output, block_patches,
+                                         out_depth);
+        output_matrix.noalias() =
+            Eigen::Map<const Matrix>(patches, block_patches,
+                                     filter_value_count) *
+            filter_matrix;
+        BiasAndActivation<T>(activation, bias_data, block_patches, out_depth,
+                             block_output);
+      }
+    };
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64 cost_per_block =
+        patches_per_block * (filter_value_count + 1) * out_depth;
+    Shard(worker_threads.num_threads, worker_threads.workers, block_count,
+          cost_per_block, compute_blocks);
+  }
+
+ private:
+  std::vector<int32> strides_;
+  Padding padding_;
+  FusedActivation activation_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedConv2DWithBiasOp);
+};
+
+#define REGISTER_FUSED_BIAS(T)                                               \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("FusedConv2DWithBias").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedConv2DWithBiasOp<T>);
+
+TF_CALL_float(REGISTER_FUSED_BIAS);
+TF_CALL_double(REGISTER_FUSED_BIAS);
+
 }  // namespace tensorflow
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <stdlib.h>
+
 #include "tensorflow/cc/ops/const_op.h"
 #include "tensorflow/cc/ops/image_ops.h"
 #include "tensorflow/cc/ops/nn_ops.h"
@@ -22,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -350,6 +354,86 @@ TEST_F(FusedResizePadConvOpTest, ResizeAndPadSymmetricComparativeLarge) {
                           "SYMMETRIC", 1, "SAME");
 }
 
+class FusedConv2DWithBiasOpTest : public OpsTestBase {
+ protected:
+  void CompareFusedAndSeparate(int batch, int input_size, int input_depth,
+                               int filter_size, int filter_count, int stride,
+                               const string& padding,
+                               const string& activation) {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor input_data(DT_FLOAT, TensorShape({batch, input_size, input_size,
+                                             input_depth}));
+    input_data.flat<float>().setRandom();
+    Output input =
+        Const(root.WithOpName("input"), Input::Initializer(input_data));
+
+    Tensor filter_data(DT_FLOAT, TensorShape({filter_size, filter_size,
+                                              input_depth, filter_count}));
+    filter_data.flat<float>().setRandom();
+    filter_data.flat<float>() -= filter_data.flat<float>().constant(0.5f);
+    Output filter =
+        Const(root.WithOpName("filter"), Input::Initializer(filter_data));
+
+    Tensor bias_data(DT_FLOAT, TensorShape({filter_count}));
+    bias_data.flat<float>().setRandom();
+    bias_data.flat<float>() -= bias_data.flat<float>().constant(0.5f);
+    Output bias = Const(root.WithOpName("bias"), Input::Initializer(bias_data));
+
+    Output conv = Conv2D(root.WithOpName("conv"), input, filter,
+                         {1, stride, stride, 1}, padding);
+    Output bias_add = BiasAdd(root.WithOpName("bias_add"), conv, bias);
+    if (activation == "Relu") {
+      Relu(root.WithOpName("separate"), bias_add);
+    } else if (activation == "Relu6") {
+      Relu6(root.WithOpName("separate"), bias_add);
+    } else {
+      Identity(root.WithOpName("separate"), bias_add);
+    }
+
+    FusedConv2DWithBias(root.WithOpName("fused"), input, filter, bias,
+                        {1, stride, stride, 1}, padding,
+                        FusedConv2DWithBias::Activation(activation));
+
+    tensorflow::GraphDef graph;
+    TF_ASSERT_OK(root.ToGraphDef(&graph));
+
+    std::unique_ptr<tensorflow::Session> session(
+        tensorflow::NewSession(tensorflow::SessionOptions()));
+    TF_ASSERT_OK(session->Create(graph));
+
+    std::vector<Tensor> separate_tensors;
+    TF_ASSERT_OK(session->Run({}, {"separate"}, {}, &separate_tensors));
+
+    std::vector<Tensor> fused_tensors;
+    TF_ASSERT_OK(session->Run({}, {"fused"}, {}, &fused_tensors));
+
+    test::ExpectTensorNear<float>(separate_tensors[0], fused_tensors[0], 1e-4);
+  }
+};
+
+TEST_F(FusedConv2DWithBiasOpTest, ReluSameComparative) {
+  CompareFusedAndSeparate(2, 9, 3, 3, 4, 1, "SAME", "Relu");
+}
+
+TEST_F(FusedConv2DWithBiasOpTest, Relu6StridedValidComparative) {
+  CompareFusedAndSeparate(3, 11, 5, 3, 7, 2, "VALID", "Relu6");
+}
+
+TEST_F(FusedConv2DWithBiasOpTest, IdentityEvenFilterComparative) {
+  CompareFusedAndSeparate(1, 8, 2, 2, 3, 3, "SAME", "Identity");
+}
+
+TEST_F(FusedConv2DWithBiasOpTest, PointwiseComparative) {
+  CompareFusedAndSeparate(2, 10, 16, 1, 8, 1, "SAME", "Relu");
+}
+
+TEST_F(FusedConv2DWithBiasOpTest, ManyBlocksComparative) {
+  // The output is computed in several blocks of 256 pixels.
+  CompareFusedAndSeparate(2, 23, 4, 3, 256, 1, "SAME", "Relu");
+}
+
 class ConvOpTest : public OpsTestBase {
  protected:
   void HandwrittenConv() {
@@ -458,10 +542,220 @@ class ConvOpTest : public OpsTestBase {
     const Tensor& output = *GetOutput(0);
     test::ExpectTensorNear<float>(expected, output, 1e-5);
   }
+
+  void Strided1x1Conv() {
+    TF_EXPECT_OK(NodeDefBuilder("conv_op", "Conv2D")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("strides", {1, 2, 2, 1})
+                     .Attr("padding", "SAME")
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+    // A [1, 3, 4, 2] image, whose pixels at even rows and columns are
+    // (1, 2), (5, 6), (17, 18) and (21, 22).
+    Tensor image(DT_FLOAT, {1, 3, 4, 2});
+    test::FillIota<float>(&image, 1);
+    Tensor filter(DT_FLOAT, {1, 1, 2, 2});
+    test::FillValues<float>(&filter, {1, 10, -1, 100});
+
+    AddInputFromArray<float>(image.shape(), image.flat<float>());
+    AddInputFromArray<float>(filter.shape(), filter.flat<float>());
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({1, 2, 2, 2}));
+    test::FillValues<float>(&expected, {-1, 210, -1, 650, -1, 1970, -1, 2410});
+    test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+  }
+
+  // Returns the SAME-padded, stride 1 convolution of 'image' by 'filter'.
+  static Tensor ReferenceConv(const Tensor& image, const Tensor& filter) {
+    const int rows = image.dim_size(1);
+    const int cols = image.dim_size(2);
+    const int in_depth = image.dim_size(3);
+    const int filter_rows = filter.dim_size(0);
+    const int filter_cols = filter.dim_size(1);
+    const int out_depth = filter.dim_size(3);
+    auto x = image.tensor<float, 4>();
+    auto w = filter.tensor<float, 4>();
+    Tensor output(DT_FLOAT, TensorShape({1, rows, cols, out_depth}));
+    auto y = output.tensor<float, 4>();
+    for (int r = 0; r < rows; ++r) {
+      for (int c = 0; c < cols; ++c) {
+        for (int o = 0; o < out_depth; ++o) {
+          double sum = 0;
+          for (int i = 0; i < filter_rows; ++i) {
+            for (int j = 0; j < filter_cols; ++j) {
+              const int in_r = r + i - filter_rows / 2;
+              const int in_c = c + j - filter_cols / 2;
+              if (in_r < 0 || in_r >= rows || in_c < 0 || in_c >= cols) {
+                continue;
+              }
+              for (int d = 0; d < in_depth; ++d) {
+                sum += x(0, in_r, in_c, d) * w(i, j, d, o);
+              }
+            }
+          }
+          y(0, r, c, o) = sum;
+        }
+      }
+    }
+    return output;
+  }
+
+  void DeepConvFilterCache() {
+    // NOTE: DeepConv2D is only used when this environment variable is set.
+    setenv("TF_USE_DEEP_CONV2D", "1", 1);
+    TF_EXPECT_OK(NodeDefBuilder("conv_op", "Conv2D")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("strides", {1, 1, 1, 1})
+                     .Attr("padding", "SAME")
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+    // Deep enough for DeepConv2D to be cheaper than the direct convolution.
+    const int depth = 32;
+    Tensor image(DT_FLOAT, {1, 7, 6, depth});
+    image.flat<float>().setRandom();
+    Tensor filter(DT_FLOAT, {3, 3, depth, depth});
+    filter.flat<float>().setRandom();
+    AddInputFromArray<float>(image.shape(), image.flat<float>());
+    AddInputFromArray<float>(filter.shape(), filter.flat<float>());
+
+    // The second run reuses the transformed filter of the first, and the third
+    // has to transform the changed filter.
+    for (int run = 0; run < 3; ++run) {
+      if (run == 2) {
+        mutable_input(1).tensor->flat<float>() =
+            mutable_input(1).tensor->flat<float>() * 2.0f;
+      }
+      TF_ASSERT_OK(RunOpKernel());
+      test::ExpectTensorNear<float>(
+          ReferenceConv(*mutable_input(0).tensor, *mutable_input(1).tensor),
+          *GetOutput(0), 1e-3);
+    }
+    unsetenv("TF_USE_DEEP_CONV2D");
+  }
 };
 
 TEST_F(ConvOpTest, HandwrittenConv) { HandwrittenConv(); }
 
 TEST_F(ConvOpTest, AnisotropicStride) { AnisotropicStrides(); }
 
+TEST_F(ConvOpTest, Strided1x1Conv) { Strided1x1Conv(); }
+
+TEST_F(ConvOpTest, DeepConvFilterCache) { DeepConvFilterCache(); }
+
+static Graph* Conv2DGraph(int batch, int rows, int cols, int in_depth,
+                          int filter_size, int out_depth, int stride) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({batch, rows, cols, in_depth}));
+  input.flat<float>().setRandom();
+  Tensor filter(DT_FLOAT,
+                TensorShape({filter_size, filter_size, in_depth, out_depth}));
+  filter.flat<float>().setRandom();
+
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Conv2D")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, filter))
+                  .Attr("T", DT_FLOAT)
+                  .Attr("strides", {1, stride, stride, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(g, &ret));
+  return g;
+}
+
+// Benchmarks Conv2D on a constant filter, with DeepConv2D enabled if
+// 'use_deep_conv' (in which case the filter is only transformed once).
+static void BM_Conv2D(int iters, int batch, int rows, int cols, int in_depth,
+                      int filter_size, int out_depth, int stride,
+                      bool use_deep_conv) {
+  const int64 out_rows = (rows + stride - 1) / stride;
+  const int64 out_cols = (cols + stride - 1) / stride;
+  testing::ItemsProcessed(static_cast<int64>(iters) * batch * out_rows *
+                          out_cols * filter_size * filter_size * in_depth *
+                          out_depth * 2);
+  if (use_deep_conv) setenv("TF_USE_DEEP_CONV2D", "1", 1);
+  test::Benchmark("cpu", Conv2DGraph(batch, rows, cols, in_depth, filter_size,
+                                     out_depth, stride))
+      .Run(iters);
+  if (use_deep_conv) unsetenv("TF_USE_DEEP_CONV2D");
+}
+
+#define BM_Conv2DCpu(B, R, C, ID, F, OD, S, DEEP, LABEL)                  \
+  static void BM_Conv2D_cpu_##LABEL(int iters) {                          \
+    BM_Conv2D(iters, B, R, C, ID, F, OD, S, DEEP);                        \
+  }                                                                       \
+  BENCHMARK(BM_Conv2D_cpu_##LABEL)
+
+BM_Conv2DCpu(8, 56, 56, 64, 3, 64, 1, false, 3x3_s1_64_64);
+BM_Conv2DCpu(8, 56, 56, 64, 3, 64, 1, true, 3x3_s1_64_64_deep);
+BM_Conv2DCpu(8, 14, 14, 256, 3, 256, 1, false, 3x3_s1_256_256);
+BM_Conv2DCpu(8, 14, 14, 256, 3, 256, 1, true, 3x3_s1_256_256_deep);
+BM_Conv2DCpu(8, 56, 56, 64, 1, 256, 1, false, 1x1_s1_64_256);
+BM_Conv2DCpu(8, 56, 56, 256, 1, 512, 2, false, 1x1_s2_256_512);
+
+// Builds a SAME-padded, stride 1 convolution followed by a bias add and a
+// relu, as three ops or as one FusedConv2DWithBias if 'fused'.
+static Graph* Conv2DBiasReluGraph(int batch, int rows, int cols, int in_depth,
+                                  int filter_size, int out_depth, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor input(DT_FLOAT, TensorShape({batch, rows, cols, in_depth}));
+  input.flat<float>().setRandom();
+  Tensor filter(DT_FLOAT,
+                TensorShape({filter_size, filter_size, in_depth, out_depth}));
+  filter.flat<float>().setRandom();
+  Tensor bias(DT_FLOAT, TensorShape({out_depth}));
+  bias.flat<float>().setRandom();
+
+  Node* ret;
+  if (fused) {
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "FusedConv2DWithBias")
+                    .Input(test::graph::Constant(g, input))
+                    .Input(test::graph::Constant(g, filter))
+                    .Input(test::graph::Constant(g, bias))
+                    .Attr("T", DT_FLOAT)
+                    .Attr("strides", {1, 1, 1, 1})
+                    .Attr("padding", "SAME")
+                    .Attr("activation", "Relu")
+                    .Finalize(g, &ret));
+    return g;
+  }
+  Node* conv;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Conv2D")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, filter))
+                  .Attr("T", DT_FLOAT)
+                  .Attr("strides", {1, 1, 1, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(g, &conv));
+  Node* bias_add;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "BiasAdd")
+                  .Input(conv)
+                  .Input(test::graph::Constant(g, bias))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &bias_add));
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Relu")
+                  .Input(bias_add)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &ret));
+  return g;
+}
+
+#define BM_Conv2DBiasReluCpu(B, R, C, ID, F, OD, FUSED, LABEL)               \
+  static void BM_Conv2DBiasRelu_cpu_##LABEL(int iters) {                     \
+    testing::ItemsProcessed(static_cast<int64>(iters) * B * R * C * F * F *  \
+                            ID * OD * 2);                                    \
+    test::Benchmark("cpu", Conv2DBiasReluGraph(B, R, C, ID, F, OD, FUSED))   \
+        .Run(iters);                                                         \
+  }                                                                          \
+  BENCHMARK(BM_Conv2DBiasRelu_cpu_##LABEL)
+
+BM_Conv2DBiasReluCpu(8, 56, 56, 64, 3, 64, false, 3x3_64_64);
+BM_Conv2DBiasReluCpu(8, 56, 56, 64, 3, 64, true, 3x3_64_64_fused);
+BM_Conv2DBiasReluCpu(8, 56, 56, 64, 1, 256, false, 1x1_64_256);
+BM_Conv2DBiasReluCpu(8, 56, 56, 64, 1, 256, true, 1x1_64_256_fused);
+
 }  // namespace tensorflow
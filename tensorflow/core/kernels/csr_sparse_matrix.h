@@ -0,0 +1,126 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_CSR_SPARSE_MATRIX_H_
+#define TENSORFLOW_KERNELS_CSR_SPARSE_MATRIX_H_
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+// A sparse matrix in compressed sparse row (CSR) format, stored in a scalar
+// DT_VARIANT tensor so that it can be converted once and passed to many
+// CSRSparseMatrixMatMul ops.
+//
+// Row i of the matrix holds the entries row_ptr(i) <= e < row_ptr(i + 1), at
+// columns col_ind(e) with values values(e). The matrix also holds its
+// transpose in the same format, which is its compressed sparse column (CSC)
+// form, so that products with the adjoint can be computed row by row as well.
+//
+// The tensors live in the memory of the device that built the matrix, whose
+// type is device_type().
+class CSRSparseMatrix {
+ public:
+  CSRSparseMatrix() : device_type_(DEVICE_CPU), num_rows_(0), num_cols_(0) {}
+
+  CSRSparseMatrix(const string& device_type, int64 num_rows, int64 num_cols,
+                  const Tensor& row_ptr,
+                  const Tensor& col_ind, const Tensor& values,
+                  const Tensor& transpose_row_ptr,
+                  const Tensor& transpose_col_ind,
+                  const Tensor& transpose_values)
+      : device_type_(device_type),
+        num_rows_(num_rows),
+        num_cols_(num_cols),
+        row_ptr_(row_ptr),
+        col_ind_(col_ind),
+        values_(values),
+        transpose_row_ptr_(transpose_row_ptr),
+        transpose_col_ind_(transpose_col_ind),
+        transpose_values_(transpose_values) {}
+
+  const string& device_type() const { return device_type_; }
+  int64 num_rows() const { return num_rows_; }
+  int64 num_cols() const { return num_cols_; }
+  int64 nnz() const { return values_.NumElements(); }
+  DataType dtype() const { return values_.dtype(); }
+
+  // The CSR arrays of the matrix, or of its transpose if "transpose".
+  const Tensor& row_ptr(bool transpose) const {
+    return transpose ? transpose_row_ptr_ : row_ptr_;
+  }
+  const Tensor& col_ind(bool transpose) const {
+    return transpose ? transpose_col_ind_ : col_ind_;
+  }
+  const Tensor& values(bool transpose) const {
+    return transpose ? transpose_values_ : values_;
+  }
+
+  string TypeName() const { return "tensorflow::CSRSparseMatrix"; }
+  string DebugString() const {
+    return strings::StrCat("CSRSparseMatrix(", num_rows_, "x", num_cols_,
+                           ", nnz=", nnz(), ")");
+  }
+
+  // Encoding is only meaningful for matrices whose tensors are in host memory.
+  void Encode(VariantTensorData* data) const {
+    data->set_type_name(TypeName());
+    Tensor* dense_shape = data->add_tensors();
+    *dense_shape = Tensor(DT_INT64, TensorShape({2}));
+    dense_shape->vec<int64>()(0) = num_rows_;
+    dense_shape->vec<int64>()(1) = num_cols_;
+    *data->add_tensors() = row_ptr_;
+    *data->add_tensors() = col_ind_;
+    *data->add_tensors() = values_;
+    *data->add_tensors() = transpose_row_ptr_;
+    *data->add_tensors() = transpose_col_ind_;
+    *data->add_tensors() = transpose_values_;
+  }
+
+  bool Decode(const VariantTensorData& data) {
+    if (data.tensors_size() != 7 || data.tensors(0).dtype() != DT_INT64 ||
+        data.tensors(0).NumElements() != 2) {
+      return false;
+    }
+    device_type_ = DEVICE_CPU;
+    num_rows_ = data.tensors(0).vec<int64>()(0);
+    num_cols_ = data.tensors(0).vec<int64>()(1);
+    row_ptr_ = data.tensors(1);
+    col_ind_ = data.tensors(2);
+    values_ = data.tensors(3);
+    transpose_row_ptr_ = data.tensors(4);
+    transpose_col_ind_ = data.tensors(5);
+    transpose_values_ = data.tensors(6);
+    return true;
+  }
+
+ private:
+  string device_type_;
+  int64 num_rows_;
+  int64 num_cols_;
+  Tensor row_ptr_;            // int64 [num_rows + 1]
+  Tensor col_ind_;            // int64 [nnz]
+  Tensor values_;             // [nnz]
+  Tensor transpose_row_ptr_;  // int64 [num_cols + 1]
+  Tensor transpose_col_ind_;  // int64 [nnz]
+  Tensor transpose_values_;   // [nnz]
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_CSR_SPARSE_MATRIX_H_
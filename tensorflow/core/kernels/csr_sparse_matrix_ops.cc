@@ -0,0 +1,403 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/sparse_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/csr_sparse_matrix_ops.h"
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/kernels/csr_sparse_matrix.h"
+#include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if GOOGLE_CUDA
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+REGISTER_UNARY_VARIANT_DECODE_FUNCTION(CSRSparseMatrix,
+                                       "tensorflow::CSRSparseMatrix");
+
+namespace {
+
+// The type of the devices that "Device" computes on.
+template <typename Device>
+const char* DeviceTypeOf() {
+  return std::is_same<Device, GPUDevice>::value ? DEVICE_GPU : DEVICE_CPU;
+}
+
+// Fills the CSR arrays of the matrix with entries at "indices", grouped by
+// their coordinate in dimension "row_dim". Entries of the same row keep their
+// relative order.
+template <typename T>
+void BuildCSR(TTypes<int64>::ConstMatrix indices,
+              typename TTypes<T>::ConstVec values, int row_dim,
+              TTypes<int64>::Vec row_ptr, TTypes<int64>::Vec col_ind,
+              typename TTypes<T>::Vec csr_values) {
+  const int64 nnz = values.size();
+  const int64 num_rows = row_ptr.size() - 1;
+  std::fill(row_ptr.data(), row_ptr.data() + num_rows + 1, 0);
+  for (int64 e = 0; e < nnz; ++e) {
+    ++row_ptr(indices(e, row_dim) + 1);
+  }
+  for (int64 i = 0; i < num_rows; ++i) {
+    row_ptr(i + 1) += row_ptr(i);
+  }
+  std::vector<int64> next(row_ptr.data(), row_ptr.data() + num_rows);
+  for (int64 e = 0; e < nnz; ++e) {
+    const int64 position = next[indices(e, row_dim)]++;
+    col_ind(position) = indices(e, 1 - row_dim);
+    csr_values(position) = values(e);
+  }
+}
+
+#if GOOGLE_CUDA
+// Allocates "device" in the memory of the op's device and enqueues a copy of
+// the host tensor "host" into it.
+Status CopyToDevice(OpKernelContext* ctx, const Tensor& host, Tensor* device) {
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(host.dtype(), host.shape(), device));
+  if (host.NumElements() == 0) {
+    return Status::OK();
+  }
+  auto* stream = ctx->op_device_context()->stream();
+  perftools::gputools::DeviceMemoryBase device_ptr(
+      const_cast<char*>(device->tensor_data().data()), host.TotalBytes());
+  if (!stream
+           ->ThenMemcpy(&device_ptr, host.tensor_data().data(),
+                        host.TotalBytes())
+           .ok()) {
+    return errors::Internal("Failed to copy the CSR matrix to the device.");
+  }
+  return Status::OK();
+}
+#endif  // GOOGLE_CUDA
+
+}  // namespace
+
+template <typename Device, typename T>
+class SparseTensorToCSRSparseMatrixOp : public OpKernel {
+ public:
+  explicit SparseTensorToCSRSparseMatrixOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& indices = ctx->input(0);
+    const Tensor& values = ctx->input(1);
+    const Tensor& dense_shape = ctx->input(2);
+
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(indices.shape()) &&
+                         indices.dim_size(1) == 2,
+                errors::InvalidArgument(
+                    "Tensor 'indices' must have shape [nnz, 2], got shape ",
+                    indices.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(values.shape()),
+                errors::InvalidArgument("Tensor 'values' is not a vector"));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsVector(dense_shape.shape()) &&
+                 dense_shape.NumElements() == 2,
+        errors::InvalidArgument("Tensor 'dense_shape' must have 2 elements"));
+    const int64 nnz = indices.dim_size(0);
+    OP_REQUIRES(ctx, nnz == values.NumElements(),
+                errors::InvalidArgument("Number of rows of indices does not "
+                                        "match number of entries in values"));
+
+    const int64 num_rows = dense_shape.vec<int64>()(0);
+    const int64 num_cols = dense_shape.vec<int64>()(1);
+    OP_REQUIRES(ctx, num_rows >= 0 && num_cols >= 0,
+                errors::InvalidArgument("Invalid dense_shape: [", num_rows,
+                                        ", ", num_cols, "]"));
+    const auto indices_mat = indices.matrix<int64>();
+    for (int64 e = 0; e < nnz; ++e) {
+      OP_REQUIRES(ctx, FastBoundsCheck(indices_mat(e, 0), num_rows) &&
+                           FastBoundsCheck(indices_mat(e, 1), num_cols),
+                  errors::InvalidArgument(
+                      "indices[", e, "] = [", indices_mat(e, 0), ", ",
+                      indices_mat(e, 1), "] is out of bounds: need 0 <= "
+                      "index < [", num_rows, ", ", num_cols, "]"));
+    }
+
+    // The arrays are built on the host, and copied once to the device if the
+    // op runs on a GPU.
+    AllocatorAttributes host_attr;
+    host_attr.set_on_host(true);
+    host_attr.set_gpu_compatible(true);
+    Tensor host[6];
+    for (int transpose = 0; transpose < 2; ++transpose) {
+      Tensor* row_ptr = &host[3 * transpose];
+      Tensor* col_ind = &host[3 * transpose + 1];
+      Tensor* csr_values = &host[3 * transpose + 2];
+      const int64 rows = transpose ? num_cols : num_rows;
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_INT64, TensorShape({rows + 1}),
+                                             row_ptr, host_attr));
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_INT64, TensorShape({nnz}),
+                                             col_ind, host_attr));
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                             TensorShape({nnz}), csr_values,
+                                             host_attr));
+      BuildCSR<T>(indices_mat, values.vec<T>(), transpose,
+                  row_ptr->vec<int64>(), col_ind->vec<int64>(),
+                  csr_values->vec<T>());
+    }
+
+    Tensor arrays[6];
+    if (std::is_same<Device, GPUDevice>::value) {
+#if GOOGLE_CUDA
+      for (int i = 0; i < 6; ++i) {
+        OP_REQUIRES_OK(ctx, CopyToDevice(ctx, host[i], &arrays[i]));
+      }
+      // The host arrays are released when Compute returns.
+      OP_REQUIRES_OK(ctx,
+                     ctx->op_device_context()->stream()->BlockHostUntilDone());
+#endif  // GOOGLE_CUDA
+    } else {
+      std::copy(host, host + 6, arrays);
+    }
+
+    Tensor* csr = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &csr));
+    csr->scalar<Variant>()() = CSRSparseMatrix(
+        DeviceTypeOf<Device>(), num_rows, num_cols, arrays[0], arrays[1],
+        arrays[2], arrays[3], arrays[4], arrays[5]);
+  }
+};
+
+template <typename Device, typename T>
+class CSRSparseMatrixMatMulOp : public OpKernel {
+ public:
+  explicit CSRSparseMatrixMatMulOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("adjoint_a", &adjoint_a_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("adjoint_b", &adjoint_b_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& a_t = ctx->input(0);
+    const Tensor& b = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(a_t.shape()),
+                errors::InvalidArgument("Tensor 'a' is not a scalar"));
+    const CSRSparseMatrix* a = a_t.scalar<Variant>()().get<CSRSparseMatrix>();
+    OP_REQUIRES(ctx, a != nullptr,
+                errors::InvalidArgument(
+                    "Tensor 'a' does not hold a CSRSparseMatrix, got ",
+                    a_t.scalar<Variant>()().DebugString()));
+    OP_REQUIRES(ctx, a->dtype() == DataTypeToEnum<T>::value,
+                errors::InvalidArgument("CSRSparseMatrix has type ",
+                                        DataTypeString(a->dtype()),
+                                        " but 'b' has type ",
+                                        DataTypeString(b.dtype())));
+    OP_REQUIRES(ctx, a->device_type() == DeviceTypeOf<Device>(),
+                errors::InvalidArgument(
+                    "CSRSparseMatrix is in ", a->device_type(),
+                    " memory but the product runs on ", DeviceTypeOf<Device>(),
+                    "; convert the matrix on the same device"));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("Tensor 'b' is not a matrix"));
+
+    const int64 outer_left = adjoint_a_ ? a->num_cols() : a->num_rows();
+    const int64 inner_left = adjoint_a_ ? a->num_rows() : a->num_cols();
+    const int64 outer_right = adjoint_b_ ? b.dim_size(0) : b.dim_size(1);
+    const int64 inner_right = adjoint_b_ ? b.dim_size(1) : b.dim_size(0);
+    OP_REQUIRES(
+        ctx, inner_right == inner_left,
+        errors::InvalidArgument(
+            "Cannot multiply A and B because inner dimension does not match: ",
+            inner_left, " vs. ", inner_right,
+            ".  Did you forget a transpose?  "
+            "Dimensions of A: [",
+            a->num_rows(), ", ", a->num_cols(),
+            ").  Dimensions of B: ", b.shape().DebugString()));
+
+    if (std::is_same<Device, GPUDevice>::value) {
+      // The GPU kernel uses 32 bit indexing over the output.
+      const int int32max = std::numeric_limits<int>::max();
+      OP_REQUIRES(ctx,
+                  FastBoundsCheck(outer_left * outer_right, int32max) &&
+                      FastBoundsCheck(b.NumElements(), int32max),
+                  errors::InvalidArgument(
+                      "Cannot use GPU for > 2^31 entry inputs or outputs"));
+    }
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            0, TensorShape({outer_left, outer_right}), &out));
+    if (out->NumElements() == 0) {
+      return;
+    }
+    if (a->nnz() == 0 || b.NumElements() == 0) {
+      functor::SetZeroFunctor<Device, T> f;
+      f(ctx->eigen_device<Device>(), out->flat<T>());
+      return;
+    }
+
+    // Row i of op(A) is row i of A, or row i of the transpose of A.
+    const auto row_ptr = a->row_ptr(adjoint_a_).vec<int64>();
+    const auto col_ind = a->col_ind(adjoint_a_).vec<int64>();
+    const auto values = a->values(adjoint_a_).vec<T>();
+
+#define MAYBE_ADJOINT(ADJ_A, ADJ_B)                                          \
+  if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                          \
+    Status functor_status = functor::CSRSparseMatrixMatMulFunctor<           \
+        Device, T, ADJ_A, ADJ_B>::Compute(ctx, row_ptr, col_ind, values,     \
+                                          b.matrix<T>(), out->matrix<T>());  \
+    OP_REQUIRES_OK(ctx, functor_status);                                     \
+  }
+
+    MAYBE_ADJOINT(false, false);
+    MAYBE_ADJOINT(false, true);
+    MAYBE_ADJOINT(true, false);
+    MAYBE_ADJOINT(true, true);
+
+#undef MAYBE_ADJOINT
+  }
+
+ private:
+  bool adjoint_a_;
+  bool adjoint_b_;
+};
+
+namespace functor {
+
+template <typename T, bool ADJ_A, bool ADJ_B>
+struct CSRSparseMatrixMatMulFunctor<CPUDevice, T, ADJ_A, ADJ_B> {
+  static Status Compute(OpKernelContext* ctx,
+                        typename TTypes<int64>::ConstVec row_ptr,
+                        typename TTypes<int64>::ConstVec col_ind,
+                        typename TTypes<T>::ConstVec values,
+                        typename TTypes<T>::ConstMatrix b,
+                        typename TTypes<T>::Matrix out) {
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    const int64 num_rows = out.dimension(0);
+    const int64 n = out.dimension(1);
+
+    // Rows of B' are read contiguously, so the adjoint of B is materialized.
+    Tensor b_adjoint;
+    const T* b_data = b.data();
+    if (ADJ_B) {
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(
+          DataTypeToEnum<T>::value,
+          TensorShape({b.dimension(1), b.dimension(0)}), &b_adjoint));
+      Eigen::array<int, 2> shuffle{1, 0};
+      b_adjoint.matrix<T>().device(d) = b.shuffle(shuffle).conjugate();
+      b_data = b_adjoint.flat<T>().data();
+    }
+
+    auto ComputeRows = [&](int64 start, int64 limit) {
+      for (int64 i = start; i < limit; ++i) {
+        T* out_row = &out(i, 0);
+        std::fill(out_row, out_row + n, T(0));
+        for (int64 e = row_ptr(i); e < row_ptr(i + 1); ++e) {
+          const T a_value = ADJ_A ? Eigen::numext::conj(values(e)) : values(e);
+          const T* b_row = b_data + col_ind(e) * n;
+          for (int64 j = 0; j < n; ++j) {
+            out_row[j] += a_value * b_row[j];
+          }
+        }
+      }
+    };
+    const int64 nnz_per_row = values.size() / num_rows + 1;
+    const int64 cost_per_row =
+        nnz_per_row * n *
+        (Eigen::TensorOpCost::AddCost<T>() + Eigen::TensorOpCost::MulCost<T>());
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          cost_per_row, ComputeRows);
+    return Status::OK();
+  }
+};
+
+}  // namespace functor
+
+#define REGISTER_CPU(T)                                                  \
+  REGISTER_KERNEL_BUILDER(Name("SparseTensorToCSRSparseMatrix")          \
+                              .Device(DEVICE_CPU)                        \
+                              .TypeConstraint<T>("T"),                   \
+                          SparseTensorToCSRSparseMatrixOp<CPUDevice, T>); \
+  REGISTER_KERNEL_BUILDER(Name("CSRSparseMatrixMatMul")                  \
+                              .Device(DEVICE_CPU)                        \
+                              .TypeConstraint<T>("T"),                   \
+                          CSRSparseMatrixMatMulOp<CPUDevice, T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(double);
+REGISTER_CPU(complex64);
+REGISTER_CPU(complex128);
+#undef REGISTER_CPU
+
+#if GOOGLE_CUDA
+
+namespace functor {
+#define DECLARE_GPU_SPEC(T, ADJ_A, ADJ_B)                                   \
+  template <>                                                               \
+  Status CSRSparseMatrixMatMulFunctor<GPUDevice, T, ADJ_A, ADJ_B>::Compute( \
+      OpKernelContext* ctx, typename TTypes<int64>::ConstVec row_ptr,       \
+      typename TTypes<int64>::ConstVec col_ind,                             \
+      typename TTypes<T>::ConstVec values,                                  \
+      typename TTypes<T>::ConstMatrix b, typename TTypes<T>::Matrix out);   \
+  extern template struct CSRSparseMatrixMatMulFunctor<GPUDevice, T, ADJ_A,  \
+                                                      ADJ_B>;
+
+#define DECLARE_ADJOINT_GPU_SPEC(T)  \
+  DECLARE_GPU_SPEC(T, false, false); \
+  DECLARE_GPU_SPEC(T, false, true);  \
+  DECLARE_GPU_SPEC(T, true, false);  \
+  DECLARE_GPU_SPEC(T, true, true)
+
+DECLARE_ADJOINT_GPU_SPEC(float);
+DECLARE_ADJOINT_GPU_SPEC(double);
+#undef DECLARE_ADJOINT_GPU_SPEC
+#undef DECLARE_GPU_SPEC
+
+}  // namespace functor
+
+// The CSR matrix is built on the host, so every input of the conversion is in
+// host memory; its arrays are copied to the GPU once.
+#define REGISTER_GPU(T)                                                  \
+  REGISTER_KERNEL_BUILDER(Name("SparseTensorToCSRSparseMatrix")          \
+                              .Device(DEVICE_GPU)                        \
+                              .TypeConstraint<T>("T")                    \
+                              .HostMemory("indices")                     \
+                              .HostMemory("values")                      \
+                              .HostMemory("dense_shape")                 \
+                              .HostMemory("csr"),                        \
+                          SparseTensorToCSRSparseMatrixOp<GPUDevice, T>); \
+  REGISTER_KERNEL_BUILDER(Name("CSRSparseMatrixMatMul")                  \
+                              .Device(DEVICE_GPU)                        \
+                              .TypeConstraint<T>("T")                    \
+                              .HostMemory("a"),                          \
+                          CSRSparseMatrixMatMulOp<GPUDevice, T>);
+
+REGISTER_GPU(float);
+REGISTER_GPU(double);
+#undef REGISTER_GPU
+
+#endif  // GOOGLE_CUDA
+
+}  // namespace tensorflow
@@ -0,0 +1,47 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_CSR_SPARSE_MATRIX_OPS_H_
+#define TENSORFLOW_KERNELS_CSR_SPARSE_MATRIX_OPS_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+namespace functor {
+
+// Computes out = A' * B', where A' is the CSR matrix held in "row_ptr",
+// "col_ind" and "values", conjugated if ADJ_A, and B' is the adjoint of "b"
+// if ADJ_B and "b" otherwise. Row i of "out" is computed from row i of A'
+// alone, so rows are computed independently and without atomics.
+template <typename Device, typename T, bool ADJ_A, bool ADJ_B>
+struct CSRSparseMatrixMatMulFunctor {
+  static Status Compute(OpKernelContext* ctx,
+                        typename TTypes<int64>::ConstVec row_ptr,
+                        typename TTypes<int64>::ConstVec col_ind,
+                        typename TTypes<T>::ConstVec values,
+                        typename TTypes<T>::ConstMatrix b,
+                        typename TTypes<T>::Matrix out);
+};
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_CSR_SPARSE_MATRIX_OPS_H_
@@ -0,0 +1,106 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/csr_sparse_matrix_ops.h"
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Each thread computes out[i, j] from row i of A, so no two threads write the
+// same output. Threads of a warp share i and read consecutive columns of B.
+template <typename T, bool ADJ_A>
+__global__ void CSRSparseMatrixMatMulKernel(int size, int n,
+                                            const int64* row_ptr,
+                                            const int64* col_ind,
+                                            const T* values, const T* b,
+                                            T* out) {
+  CUDA_1D_KERNEL_LOOP(index, size) {
+    const int i = index / n;
+    const int j = index % n;
+    const int64 row_end = ldg(row_ptr + i + 1);
+    T sum = T(0);
+    for (int64 e = ldg(row_ptr + i); e < row_end; ++e) {
+      const T a_value =
+          ADJ_A ? Eigen::numext::conj(ldg(values + e)) : ldg(values + e);
+      sum += a_value * ldg(b + ldg(col_ind + e) * n + j);
+    }
+    out[index] = sum;
+  }
+}
+
+namespace functor {
+
+template <typename T, bool ADJ_A, bool ADJ_B>
+struct CSRSparseMatrixMatMulFunctor<GPUDevice, T, ADJ_A, ADJ_B> {
+  static Status Compute(OpKernelContext* ctx,
+                        typename TTypes<int64>::ConstVec row_ptr,
+                        typename TTypes<int64>::ConstVec col_ind,
+                        typename TTypes<T>::ConstVec values,
+                        typename TTypes<T>::ConstMatrix b,
+                        typename TTypes<T>::Matrix out) {
+    const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+    const int n = out.dimension(1);
+    const int size = out.size();
+
+    // Rows of B' are read with coalesced loads, so the adjoint of B is
+    // materialized.
+    Tensor b_adjoint;
+    const T* b_data = b.data();
+    if (ADJ_B) {
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(
+          DataTypeToEnum<T>::value,
+          TensorShape({b.dimension(1), b.dimension(0)}), &b_adjoint));
+      Eigen::array<int, 2> shuffle{1, 0};
+      b_adjoint.matrix<T>().device(d) = b.shuffle(shuffle).conjugate();
+      b_data = b_adjoint.flat<T>().data();
+    }
+
+    CudaLaunchConfig config = GetCudaLaunchConfig(size, d);
+    CSRSparseMatrixMatMulKernel<T, ADJ_A>
+        <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+            size, n, row_ptr.data(), col_ind.data(), values.data(), b_data,
+            out.data());
+    return Status::OK();
+  }
+};
+
+}  // namespace functor
+
+#define DEFINE(T)                                                            \
+  template struct functor::CSRSparseMatrixMatMulFunctor<GPUDevice, T, false, \
+                                                         false>;             \
+  template struct functor::CSRSparseMatrixMatMulFunctor<GPUDevice, T, false, \
+                                                         true>;              \
+  template struct functor::CSRSparseMatrixMatMulFunctor<GPUDevice, T, true,  \
+                                                         false>;             \
+  template struct functor::CSRSparseMatrixMatMulFunctor<GPUDevice, T, true,  \
+                                                         true>;
+
+DEFINE(float);
+DEFINE(double);
+#undef DEFINE
+
+}  // end namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -17,11 +17,14 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/stats_aggregator.h"
 
 namespace tensorflow {
 
 namespace {
 
+thread_local GetNextStatsRecorder* current_get_next_stats = nullptr;
+
 // A wrapper class for storing a `DatasetBase` instance in a DT_VARIANT tensor.
 // Objects of the wrapper class own a reference on an instance of `DatasetBase`,
 // and the wrapper's copy constructor and destructor take care of managing the
@@ -266,6 +269,59 @@ void BinaryDatasetOpKernel::MakeDataset(OpKernelContext* ctx,
   MakeDataset(ctx, input, another_input, output);
 }
 
+GetNextStatsRecorder::GetNextStatsRecorder(
+    IteratorContext* ctx, std::shared_ptr<StatsAggregator> stats_aggregator,
+    const string& prefix)
+    : env_(ctx->env()),
+      stats_aggregator_(std::move(stats_aggregator)),
+      prefix_(prefix),
+      parent_(current_get_next_stats),
+      start_usecs_(env_->NowMicros()) {
+  current_get_next_stats = this;
+}
+
+GetNextStatsRecorder::~GetNextStatsRecorder() {
+  if (!finished_) Finish(false);
+}
+
+void GetNextStatsRecorder::Finish(bool produced_element) {
+  DCHECK(!finished_);
+  finished_ = true;
+  current_get_next_stats = parent_;
+  const int64 usecs = env_->NowMicros() - start_usecs_;
+  // The whole call is time that the enclosing call waited for its input.
+  if (parent_ != nullptr) parent_->AddInputWait(usecs);
+  if (!produced_element) return;
+  stats_aggregator_->AddToHistogram(
+      strings::StrCat(prefix_, "::get_next_usecs"),
+      {static_cast<double>(usecs)});
+  stats_aggregator_->AddToHistogram(
+      strings::StrCat(prefix_, "::input_wait_usecs"),
+      {static_cast<double>(std::min(input_wait_usecs_, usecs))});
+}
+
+// static
+GetNextStatsRecorder* GetNextStatsRecorder::Current() {
+  return current_get_next_stats;
+}
+
+void GetNextStatsRecorder::RecordBufferUtilization(int64 size,
+                                                   int64 capacity) {
+  stats_aggregator_->AddToHistogram(
+      strings::StrCat(prefix_, "::buffer_utilization"),
+      {capacity > 0 ? static_cast<double>(size) / capacity : 0.0});
+}
+
+ScopedInputWait::ScopedInputWait()
+    : recorder_(current_get_next_stats),
+      start_usecs_(recorder_ ? recorder_->env()->NowMicros() : 0) {}
+
+ScopedInputWait::~ScopedInputWait() {
+  if (recorder_ != nullptr) {
+    recorder_->AddInputWait(recorder_->env()->NowMicros() - start_usecs_);
+  }
+}
+
 const char GraphDatasetBase::kDatasetGraphKey[] = "_DATASET_GRAPH";
 const char GraphDatasetBase::kDatasetGraphOutputNodeKey[] =
     "_DATASET_GRAPH_OUTPUT_NODE";
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/function.h"
@@ -258,6 +259,13 @@ class IteratorContext {
     // created. Better suggestions are welcome!
     std::function<std::shared_ptr<StatsAggregator>()> stats_aggregator_getter =
         nullptr;
+
+    // A function that returns the allocator for the buffers of the elements
+    // that the iterator produces, given their `AllocatorAttributes`. This
+    // lets a consumer that copies the elements to a device have them built
+    // in memory that the device can read directly (e.g. pinned host memory).
+    // If not set, `cpu_allocator()` is used.
+    std::function<Allocator*(AllocatorAttributes)> allocator_getter = nullptr;
   };
 
   explicit IteratorContext(Params params) : params_(std::move(params)) {}
@@ -276,10 +284,79 @@ class IteratorContext {
     }
   }
 
+  Allocator* allocator(AllocatorAttributes attrs) {
+    if (params_.allocator_getter) {
+      return params_.allocator_getter(attrs);
+    } else {
+      return cpu_allocator();
+    }
+  }
+
  private:
   Params params_;
 };
 
+// Records statistics about a `GetNext` call of an iterator in a
+// `StatsAggregator`: for each element that it produces, the time that the call
+// took as "<prefix>::get_next_usecs" and the part of it spent waiting for its
+// input as "<prefix>::input_wait_usecs". The wait includes the `GetNext` calls
+// of input iterators on the same thread, and the waits counted by
+// `ScopedInputWait`. The rest of the time is spent in the iterator itself.
+//
+// `DatasetIterator::GetNext` creates one for every call while the iterator has
+// a `StatsAggregator`, so that every stage of an input pipeline is measured.
+class GetNextStatsRecorder {
+ public:
+  GetNextStatsRecorder(IteratorContext* ctx,
+                       std::shared_ptr<StatsAggregator> stats_aggregator,
+                       const string& prefix);
+  ~GetNextStatsRecorder();
+
+  // Records the statistics of the call if it produced an element.
+  void Finish(bool produced_element);
+
+  // Returns the recorder of the innermost `GetNext` call on the calling
+  // thread, or nullptr if the statistics of that call are not recorded.
+  static GetNextStatsRecorder* Current();
+
+  // Counts `usecs` as time that the call waited for its input.
+  void AddInputWait(int64 usecs) { input_wait_usecs_ += usecs; }
+
+  // Records that `size` of the `capacity` elements of the buffer of the
+  // iterator were full when its consumer asked for an element, as
+  // "<prefix>::buffer_utilization".
+  void RecordBufferUtilization(int64 size, int64 capacity);
+
+  Env* env() const { return env_; }
+
+ private:
+  Env* const env_;
+  const std::shared_ptr<StatsAggregator> stats_aggregator_;
+  const string& prefix_;
+  GetNextStatsRecorder* const parent_;
+  const int64 start_usecs_;
+  int64 input_wait_usecs_ = 0;
+  bool finished_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GetNextStatsRecorder);
+};
+
+// Counts its lifetime as time that the calling `GetNext` waited for its
+// input, when the statistics of the call are recorded. Iterators use it where
+// they block on elements that other threads take from their input, e.g. for
+// a buffer to fill.
+class ScopedInputWait {
+ public:
+  ScopedInputWait();
+  ~ScopedInputWait();
+
+ private:
+  GetNextStatsRecorder* const recorder_;
+  const int64 start_usecs_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedInputWait);
+};
+
 // Represents the current position in a range of outputs, where the
 // range of outputs is typically represented by an `DatasetBase`,
 // defined below.
@@ -485,7 +562,15 @@ class DatasetIterator : public IteratorBase {
   Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
                  bool* end_of_sequence) final {
     port::Tracing::TraceMe activity(params_.prefix);
-    return GetNextInternal(ctx, out_tensors, end_of_sequence);
+    std::shared_ptr<StatsAggregator> stats_aggregator = ctx->stats_aggregator();
+    if (!stats_aggregator) {
+      return GetNextInternal(ctx, out_tensors, end_of_sequence);
+    }
+    GetNextStatsRecorder recorder(ctx, std::move(stats_aggregator),
+                                  params_.prefix);
+    Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
+    recorder.Finish(s.ok() && !*end_of_sequence);
+    return s;
   }
 
   Status Save(OpKernelContext* ctx, IteratorStateWriter* writer) final {
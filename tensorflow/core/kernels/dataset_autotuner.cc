@@ -0,0 +1,125 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/dataset_autotuner.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/kernels/stats_aggregator.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+constexpr int64 DatasetAutotuner::kWindowSize;
+constexpr double DatasetAutotuner::kGrowWaitFraction;
+constexpr int DatasetAutotuner::kShrinkWindows;
+
+DatasetAutotuner::DatasetAutotuner(int64 initial_target, int64 max_target)
+    : max_target_(std::max<int64>(1, max_target)) {
+  target_ = std::min(std::max<int64>(1, initial_target), max_target_);
+}
+
+bool DatasetAutotuner::RecordElement(int64 now_usecs, int64 wait_usecs) {
+  if (window_start_usecs_ < 0) {
+    // The window starts when the consumer asks for its first element.
+    window_start_usecs_ = now_usecs - wait_usecs;
+  }
+  ++window_elements_;
+  window_wait_usecs_ += wait_usecs;
+  if (window_elements_ < kWindowSize) {
+    return false;
+  }
+
+  const int64 elapsed_usecs =
+      std::max<int64>(1, now_usecs - window_start_usecs_);
+  wait_fraction_ = static_cast<double>(window_wait_usecs_) / elapsed_usecs;
+  production_usecs_ =
+      window_productions_ > 0
+          ? static_cast<double>(window_production_usecs_) / window_productions_
+          : 0;
+  if (wait_fraction_ > kGrowWaitFraction) {
+    target_ = std::min(max_target_, target_ + std::max<int64>(1, target_ / 2));
+    idle_windows_ = 0;
+  } else if (window_wait_usecs_ > 0) {
+    idle_windows_ = 0;
+  } else if (++idle_windows_ >= kShrinkWindows) {
+    target_ = std::max<int64>(1, target_ - 1);
+    idle_windows_ = 0;
+  }
+
+  window_start_usecs_ = now_usecs;
+  window_elements_ = 0;
+  window_wait_usecs_ = 0;
+  window_production_usecs_ = 0;
+  window_productions_ = 0;
+  return true;
+}
+
+void DatasetAutotuner::RecordProduction(int64 usecs) {
+  window_production_usecs_ += usecs;
+  ++window_productions_;
+}
+
+void DatasetAutotuner::SetMaxTarget(int64 max_target) {
+  max_target_ = std::max<int64>(1, max_target);
+  target_ = std::min(target_, max_target_);
+}
+
+void DatasetAutotuner::RecordStats(IteratorContext* ctx,
+                                   const string& prefix) const {
+  auto stats_aggregator = ctx->stats_aggregator();
+  if (!stats_aggregator) {
+    return;
+  }
+  stats_aggregator->AddToHistogram(strings::StrCat(prefix, "::autotune_target"),
+                                   {static_cast<double>(target_)});
+  stats_aggregator->AddToHistogram(
+      strings::StrCat(prefix, "::autotune_wait_fraction"), {wait_fraction_});
+  stats_aggregator->AddToHistogram(
+      strings::StrCat(prefix, "::autotune_production_usecs"),
+      {production_usecs_});
+}
+
+int64 AutotuneCpuBudget() {
+  static const int64 budget = [] {
+    int64 value;
+    Status status = ReadInt64FromEnvVar("TF_DATA_AUTOTUNE_CPU_BUDGET",
+                                        port::NumSchedulableCPUs(), &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      value = port::NumSchedulableCPUs();
+    }
+    return std::max<int64>(1, value);
+  }();
+  return budget;
+}
+
+int64 AutotuneRamBudgetBytes() {
+  static const int64 budget = [] {
+    int64 megabytes;
+    Status status = ReadInt64FromEnvVar("TF_DATA_AUTOTUNE_RAM_BUDGET_MB",
+                                        /*default_val=*/1024, &megabytes);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      megabytes = 1024;
+    }
+    return std::max<int64>(1, megabytes) * (1LL << 20);
+  }();
+  return budget;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,102 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATASET_AUTOTUNER_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATASET_AUTOTUNER_H_
+
+#include <string>
+
+#include "tensorflow/core/kernels/dataset.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The value of a `buffer_size` or `num_parallel_calls` argument that asks the
+// iterators of a dataset to choose it at runtime.
+constexpr int64 kAutotune = -1;
+
+// A `DatasetAutotuner` adjusts a target of an iterator, e.g. the number of
+// elements it prefetches or the number of function calls it runs in parallel,
+// from the time its consumer spends waiting for elements.
+//
+// The elements are grouped into windows of `kWindowSize` elements. At the end
+// of a window, the target grows by half if the consumer waited for more than
+// `kGrowWaitFraction` of the duration of the window, so that the iterator
+// produces elements faster, and shrinks by one after `kShrinkWindows`
+// consecutive windows in which the consumer never waited, to give back the
+// CPU and memory that it does not need. The target stays in
+// [1, `max_target`].
+//
+// This class is thread-compatible; the iterators call it with their lock held.
+class DatasetAutotuner {
+ public:
+  static constexpr int64 kWindowSize = 32;
+  static constexpr double kGrowWaitFraction = 0.02;
+  static constexpr int kShrinkWindows = 4;
+
+  DatasetAutotuner(int64 initial_target, int64 max_target);
+
+  // Records that the consumer got an element at `now_usecs`, after waiting
+  // `wait_usecs` for it. Returns true at the end of a window, when the target
+  // may have changed.
+  bool RecordElement(int64 now_usecs, int64 wait_usecs);
+
+  // Records that the iterator spent `usecs` producing an element.
+  void RecordProduction(int64 usecs);
+
+  // Lowers or raises the bound of the target, e.g. when the size of the
+  // elements of a buffer becomes known. The target is clipped to it.
+  void SetMaxTarget(int64 max_target);
+
+  int64 target() const { return target_; }
+  int64 max_target() const { return max_target_; }
+
+  // The fraction of the last window the consumer spent waiting, and the mean
+  // time spent producing an element in that window.
+  double wait_fraction() const { return wait_fraction_; }
+  double production_usecs() const { return production_usecs_; }
+
+  // Records the target and the measurements of the last window as histograms
+  // named "<prefix>::autotune_target", "<prefix>::autotune_wait_fraction" and
+  // "<prefix>::autotune_production_usecs" in the `StatsAggregator` of `ctx`,
+  // if it has one.
+  void RecordStats(IteratorContext* ctx, const string& prefix) const;
+
+ private:
+  int64 target_;
+  int64 max_target_;
+  int64 window_start_usecs_ = -1;
+  int64 window_elements_ = 0;
+  int64 window_wait_usecs_ = 0;
+  int64 window_production_usecs_ = 0;
+  int64 window_productions_ = 0;
+  int idle_windows_ = 0;
+  double wait_fraction_ = 0;
+  double production_usecs_ = 0;
+};
+
+// Returns the largest number of parallel function calls that an autotuned
+// iterator runs: the value of the environment variable
+// TF_DATA_AUTOTUNE_CPU_BUDGET if it is set, and the number of schedulable
+// CPUs otherwise.
+int64 AutotuneCpuBudget();
+
+// Returns the number of bytes that the buffer of an autotuned iterator may
+// hold: the value of the environment variable TF_DATA_AUTOTUNE_RAM_BUDGET_MB,
+// in megabytes, if it is set, and 1GB otherwise.
+int64 AutotuneRamBudgetBytes();
+
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DATASET_AUTOTUNER_H_
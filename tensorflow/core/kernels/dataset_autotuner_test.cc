@@ -0,0 +1,89 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/dataset_autotuner.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Records a window of elements, each of which took `usecs_per_element` of
+// which the consumer waited `wait_usecs`. Returns the time after the window.
+int64 RecordWindow(DatasetAutotuner* autotuner, int64 now_usecs,
+                   int64 usecs_per_element, int64 wait_usecs) {
+  for (int i = 0; i < DatasetAutotuner::kWindowSize; ++i) {
+    now_usecs += usecs_per_element;
+    const bool window_ended = autotuner->RecordElement(now_usecs, wait_usecs);
+    EXPECT_EQ(i == DatasetAutotuner::kWindowSize - 1, window_ended);
+  }
+  return now_usecs;
+}
+
+TEST(DatasetAutotunerTest, GrowsWhileConsumerWaits) {
+  DatasetAutotuner autotuner(/*initial_target=*/1, /*max_target=*/8);
+  int64 now_usecs = 0;
+  const std::vector<int64> targets = {2, 3, 4, 6, 8, 8};
+  for (int64 target : targets) {
+    now_usecs = RecordWindow(&autotuner, now_usecs, 100, 50);
+    EXPECT_NEAR(0.5, autotuner.wait_fraction(), 0.02);
+    EXPECT_EQ(target, autotuner.target());
+  }
+}
+
+TEST(DatasetAutotunerTest, ShrinksWhenConsumerNeverWaits) {
+  DatasetAutotuner autotuner(/*initial_target=*/4, /*max_target=*/8);
+  int64 now_usecs = 0;
+  for (int i = 1; i < DatasetAutotuner::kShrinkWindows; ++i) {
+    now_usecs = RecordWindow(&autotuner, now_usecs, 100, 0);
+    EXPECT_EQ(4, autotuner.target());
+  }
+  now_usecs = RecordWindow(&autotuner, now_usecs, 100, 0);
+  EXPECT_EQ(3, autotuner.target());
+
+  // Short waits keep the target, but reset the count of idle windows.
+  now_usecs = RecordWindow(&autotuner, now_usecs, 100, 1);
+  for (int i = 1; i < DatasetAutotuner::kShrinkWindows; ++i) {
+    now_usecs = RecordWindow(&autotuner, now_usecs, 100, 0);
+  }
+  EXPECT_EQ(3, autotuner.target());
+}
+
+TEST(DatasetAutotunerTest, StaysWithinBounds) {
+  DatasetAutotuner autotuner(/*initial_target=*/16, /*max_target=*/4);
+  EXPECT_EQ(4, autotuner.target());
+  autotuner.SetMaxTarget(2);
+  EXPECT_EQ(2, autotuner.target());
+  autotuner.SetMaxTarget(0);
+  EXPECT_EQ(1, autotuner.max_target());
+  EXPECT_EQ(1, autotuner.target());
+
+  int64 now_usecs = 0;
+  for (int i = 0; i < 2 * DatasetAutotuner::kShrinkWindows; ++i) {
+    now_usecs = RecordWindow(&autotuner, now_usecs, 100, 0);
+  }
+  EXPECT_EQ(1, autotuner.target());
+}
+
+TEST(DatasetAutotunerTest, MeasuresProductionTime) {
+  DatasetAutotuner autotuner(/*initial_target=*/1, /*max_target=*/8);
+  autotuner.RecordProduction(10);
+  autotuner.RecordProduction(30);
+  RecordWindow(&autotuner, 0, 100, 0);
+  EXPECT_EQ(20, autotuner.production_usecs());
+}
+
+}  // namespace
+}  // namespace tensorflow
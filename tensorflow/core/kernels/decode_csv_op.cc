@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <string.h>
+#include <deque>
 #include <vector>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -21,9 +23,45 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Converts a non-empty field to T. Returns false if it is not a valid T.
+template <typename T>
+bool ParseField(StringPiece field, T* value);
+
+template <>
+bool ParseField(StringPiece field, int32* value) {
+  return strings::safe_strto32(field, value);
+}
+
+template <>
+bool ParseField(StringPiece field, int64* value) {
+  return strings::safe_strto64(field, value);
+}
+
+template <>
+bool ParseField(StringPiece field, float* value) {
+  return strings::safe_strtof(field, value);
+}
+
+template <>
+bool ParseField(StringPiece field, double* value) {
+  return strings::safe_strtod(field, value);
+}
+
+template <>
+bool ParseField(StringPiece field, string* value) {
+  value->assign(field.data(), field.size());
+  return true;
+}
+
+}  // namespace
+
 class DecodeCSVOp : public OpKernel {
  public:
   explicit DecodeCSVOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -38,6 +76,14 @@ class DecodeCSVOp : public OpKernel {
                 errors::InvalidArgument("field_delim should be only 1 char"));
     delim_ = delim[0];
     OP_REQUIRES_OK(ctx, ctx->GetAttr("na_value", &na_value_));
+
+    // The characters that end the body of an unquoted field, or that are not
+    // allowed in it.
+    memset(stops_, 0, sizeof(stops_));
+    stops_[static_cast<uint8>(delim_)] = true;
+    stops_[static_cast<uint8>('\n')] = true;
+    stops_[static_cast<uint8>('\r')] = true;
+    if (use_quote_delim_) stops_[static_cast<uint8>('"')] = true;
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -60,125 +106,39 @@ class DecodeCSVOp : public OpKernel {
     OpOutputList output;
     OP_REQUIRES_OK(ctx, ctx->output_list("output", &output));
 
+    std::vector<Tensor*> outputs(out_type_.size());
     for (int i = 0; i < static_cast<int>(out_type_.size()); ++i) {
-      Tensor* out = nullptr;
-      OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
+      OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &outputs[i]));
     }
+    if (records_size == 0) return;
 
-    for (int64 i = 0; i < records_size; ++i) {
-      const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
-      OP_REQUIRES(ctx, fields.size() == out_type_.size(),
-                  errors::InvalidArgument("Expect ", out_type_.size(),
-                                          " fields but have ", fields.size(),
-                                          " in record ", i));
-
-      // Check each field in the record
-      for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
-        const DataType& dtype = out_type_[f];
-        switch (dtype) {
-          case DT_INT32: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-
-              output[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
-            } else {
-              int32 value;
-              OP_REQUIRES(ctx, strings::safe_strto32(fields[f], &value),
-                          errors::InvalidArgument("Field ", f, " in record ", i,
-                                                  " is not a valid int32: ",
-                                                  fields[f]));
-              output[f]->flat<int32>()(i) = value;
-            }
-            break;
-          }
-          case DT_INT64: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-
-              output[f]->flat<int64>()(i) = record_defaults[f].flat<int64>()(0);
-            } else {
-              int64 value;
-              OP_REQUIRES(ctx, strings::safe_strto64(fields[f], &value),
-                          errors::InvalidArgument("Field ", f, " in record ", i,
-                                                  " is not a valid int64: ",
-                                                  fields[f]));
-              output[f]->flat<int64>()(i) = value;
-            }
-            break;
-          }
-          case DT_FLOAT: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
-            } else {
-              float value;
-              OP_REQUIRES(ctx, strings::safe_strtof(fields[f].c_str(), &value),
-                          errors::InvalidArgument("Field ", f, " in record ", i,
-                                                  " is not a valid float: ",
-                                                  fields[f]));
-              output[f]->flat<float>()(i) = value;
-            }
-            break;
-          }
-          case DT_DOUBLE: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<double>()(i) =
-                  record_defaults[f].flat<double>()(0);
-            } else {
-              double value;
-              OP_REQUIRES(ctx, strings::safe_strtod(fields[f].c_str(), &value),
-                          errors::InvalidArgument("Field ", f, " in record ", i,
-                                                  " is not a valid double: ",
-                                                  fields[f]));
-              output[f]->flat<double>()(i) = value;
-            }
-            break;
-          }
-          case DT_STRING: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<string>()(i) =
-                  record_defaults[f].flat<string>()(0);
-            } else {
-              output[f]->flat<string>()(i) = fields[f];
-            }
-            break;
+    // Records are parsed in parallel. Each shard stops at its first invalid
+    // record, and the error of the first invalid record overall is reported.
+    mutex mu;
+    Status status;
+    int64 error_record = records_size;
+    auto parse_records = [&](int64 start, int64 limit) {
+      std::vector<StringPiece> fields;
+      std::deque<string> unescaped;
+      for (int64 i = start; i < limit; ++i) {
+        Status s = ParseRecord(records_t(i), i, record_defaults, &fields,
+                               &unescaped, &outputs);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          if (i < error_record) {
+            error_record = i;
+            status = s;
           }
-          default:
-            OP_REQUIRES(ctx, false,
-                        errors::InvalidArgument("csv: data type ", dtype,
-                                                " not supported in field ", f));
+          return;
         }
       }
-    }
+    };
+    const int64 cost_per_record =
+        10 * records_t(0).size() + 100 * out_type_.size();
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, records_size,
+          cost_per_record, parse_records);
+    OP_REQUIRES_OK(ctx, status);
   }
 
  private:
@@ -186,74 +146,163 @@ class DecodeCSVOp : public OpKernel {
   char delim_;
   bool use_quote_delim_;
   string na_value_;
+  bool stops_[256];
+
+  Status ParseRecord(StringPiece record, int64 i,
+                     const OpInputList& record_defaults,
+                     std::vector<StringPiece>* fields,
+                     std::deque<string>* unescaped,
+                     std::vector<Tensor*>* outputs) const {
+    fields->clear();
+    unescaped->clear();
+    TF_RETURN_IF_ERROR(ExtractFields(record, fields, unescaped));
+    if (fields->size() != out_type_.size()) {
+      return errors::InvalidArgument("Expect ", out_type_.size(),
+                                     " fields but have ", fields->size(),
+                                     " in record ", i);
+    }
 
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
-    int64 current_idx = 0;
+    // Check each field in the record
+    for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
+      const StringPiece field = (*fields)[f];
+      const Tensor& record_default = record_defaults[f];
+      Tensor* out = (*outputs)[f];
+      switch (out_type_[f]) {
+        case DT_INT32:
+          TF_RETURN_IF_ERROR(ConvertField<int32>(field, f, i, "int32",
+                                                 record_default, out));
+          break;
+        case DT_INT64:
+          TF_RETURN_IF_ERROR(ConvertField<int64>(field, f, i, "int64",
+                                                 record_default, out));
+          break;
+        case DT_FLOAT:
+          TF_RETURN_IF_ERROR(ConvertField<float>(field, f, i, "float",
+                                                 record_default, out));
+          break;
+        case DT_DOUBLE:
+          TF_RETURN_IF_ERROR(ConvertField<double>(field, f, i, "double",
+                                                  record_default, out));
+          break;
+        case DT_STRING:
+          TF_RETURN_IF_ERROR(ConvertField<string>(field, f, i, "string",
+                                                  record_default, out));
+          break;
+        default:
+          return errors::InvalidArgument("csv: data type ", out_type_[f],
+                                         " not supported in field ", f);
+      }
+    }
+    return Status::OK();
+  }
+
+  // Stores field f of record i, or its default if it is empty or the NA
+  // value, in element i of "out".
+  template <typename T>
+  Status ConvertField(StringPiece field, int f, int64 i, const char* type_name,
+                      const Tensor& record_default, Tensor* out) const {
+    T* value = &out->flat<T>()(i);
+    // If this field is empty or NA value, check if default is given:
+    // If yes, use default value; Otherwise report error.
+    if (field.empty() || field == na_value_) {
+      if (record_default.NumElements() != 1) {
+        return errors::InvalidArgument(
+            "Field ", f, " is required but missing in record ", i, "!");
+      }
+      *value = record_default.flat<T>()(0);
+    } else if (!ParseField(field, value)) {
+      return errors::InvalidArgument("Field ", f, " in record ", i,
+                                     " is not a valid ", type_name, ": ",
+                                     field);
+    }
+    return Status::OK();
+  }
+
+  // Splits "input" into "fields". Unquoted fields, and quoted fields without
+  // escaped quotes, point into "input"; the other quoted fields are
+  // unescaped into "unescaped".
+  Status ExtractFields(StringPiece input, std::vector<StringPiece>* result,
+                       std::deque<string>* unescaped) const {
+    const char* data = input.data();
+    const size_t size = input.size();
+    size_t current_idx = 0;
     if (!input.empty()) {
-      while (static_cast<size_t>(current_idx) < input.size()) {
-        if (input[current_idx] == '\n' || input[current_idx] == '\r') {
+      while (current_idx < size) {
+        if (data[current_idx] == '\n' || data[current_idx] == '\r') {
           current_idx++;
           continue;
         }
 
         bool quoted = false;
-        if (use_quote_delim_ && input[current_idx] == '"') {
+        if (use_quote_delim_ && data[current_idx] == '"') {
           quoted = true;
           current_idx++;
         }
 
         // This is the body of the field;
-        string field;
+        const size_t field_start = current_idx;
         if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx, (!use_quote_delim_ || input[current_idx] != '"') &&
-                                 input[current_idx] != '\n' &&
-                                 input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            field += input[current_idx];
+          while (current_idx < size &&
+                 !stops_[static_cast<uint8>(data[current_idx])]) {
             current_idx++;
           }
+          if (current_idx < size && data[current_idx] != delim_) {
+            return errors::InvalidArgument(
+                "Unquoted fields cannot have quotes/CRLFs inside");
+          }
+          result->emplace_back(data + field_start, current_idx - field_start);
 
           // Go to next field or the end
           current_idx++;
-        } else if (use_quote_delim_) {
-          // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              field += input[current_idx];
-              current_idx++;
-            } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              field += '"';
-              current_idx += 2;
+        } else {
+          // Quoted field needs to be ended with '"' and delim or end. The
+          // field is copied only once it has an escaped quote.
+          string* field = nullptr;
+          size_t segment_start = current_idx;
+          while (current_idx + 1 < size) {
+            const void* quote = memchr(data + current_idx, '"',
+                                       size - 1 - current_idx);
+            if (quote == nullptr) {
+              current_idx = size - 1;
+              break;
+            }
+            current_idx = static_cast<const char*>(quote) - data;
+            if (data[current_idx + 1] == delim_) break;
+            if (data[current_idx + 1] != '"') {
+              return errors::InvalidArgument(
+                  "Quote inside a string has to be escaped by another quote");
             }
+            if (field == nullptr) {
+              unescaped->emplace_back();
+              field = &unescaped->back();
+            }
+            // Keeps the first quote of the pair.
+            field->append(data + segment_start,
+                          current_idx + 1 - segment_start);
+            current_idx += 2;
+            segment_start = current_idx;
           }
 
-          OP_REQUIRES(
-              ctx, (static_cast<size_t>(current_idx) < input.size() &&
-                    input[current_idx] == '"' &&
-                    (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                     input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
+          if (!(current_idx < size && data[current_idx] == '"' &&
+                (current_idx == size - 1 || data[current_idx + 1] == delim_))) {
+            return errors::InvalidArgument(
+                "Quoted field has to end with quote followed by delim or end");
+          }
+          if (field == nullptr) {
+            result->emplace_back(data + field_start, current_idx - field_start);
+          } else {
+            field->append(data + segment_start, current_idx - segment_start);
+            result->emplace_back(*field);
+          }
 
           current_idx += 2;
         }
-
-        result->push_back(field);
       }
 
       // Check if the last field is missing
-      if (input[input.size() - 1] == delim_) result->push_back(string());
+      if (data[size - 1] == delim_) result->emplace_back();
     }
+    return Status::OK();
   }
 };
 
@@ -15,18 +15,23 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <vector>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/image_resizer_state.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gif/gif_io.h"
 #include "tensorflow/core/lib/jpeg/jpeg_mem.h"
 #include "tensorflow/core/lib/png/png_io.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -331,11 +336,218 @@ class DecodeImageOp : public OpKernel {
   jpeg::UncompressFlags flags_;
 };
 
+// Interpolation weights along one dimension of a bilinear resize, computed
+// the same way as in ResizeBilinear.
+struct CachedInterpolation {
+  int64 lower;
+  int64 upper;
+  float lerp;
+};
+
+std::vector<CachedInterpolation> ComputeInterpolationWeights(int64 out_size,
+                                                             int64 in_size,
+                                                             float scale) {
+  std::vector<CachedInterpolation> interpolation(out_size);
+  for (int64 i = 0; i < out_size; ++i) {
+    const float in = i * scale;
+    interpolation[i].lower = static_cast<int64>(in);
+    interpolation[i].upper = std::min(interpolation[i].lower + 1, in_size - 1);
+    interpolation[i].lerp = in - interpolation[i].lower;
+  }
+  return interpolation;
+}
+
+// Bilinearly resizes the [in_height, in_width, channels] uint8 image "input"
+// to the [out_height, out_width, channels] float image "output".
+void ResizeDecodedImage(const uint8* input, int64 in_height, int64 in_width,
+                        int channels, int64 out_height, int64 out_width,
+                        bool align_corners, float* output) {
+  if (in_height == out_height && in_width == out_width) {
+    std::copy_n(input, out_height * out_width * channels, output);
+    return;
+  }
+  const std::vector<CachedInterpolation> ys = ComputeInterpolationWeights(
+      out_height, in_height,
+      CalculateResizeScale(in_height, out_height, align_corners));
+  std::vector<CachedInterpolation> xs = ComputeInterpolationWeights(
+      out_width, in_width,
+      CalculateResizeScale(in_width, out_width, align_corners));
+  for (CachedInterpolation& x : xs) {
+    x.lower *= channels;
+    x.upper *= channels;
+  }
+  const int64 in_row_size = in_width * channels;
+  for (int64 y = 0; y < out_height; ++y) {
+    const uint8* top = input + ys[y].lower * in_row_size;
+    const uint8* bottom = input + ys[y].upper * in_row_size;
+    const float y_lerp = ys[y].lerp;
+    for (int64 x = 0; x < out_width; ++x) {
+      const float x_lerp = xs[x].lerp;
+      for (int c = 0; c < channels; ++c) {
+        const float top_left(top[xs[x].lower + c]);
+        const float top_right(top[xs[x].upper + c]);
+        const float bottom_left(bottom[xs[x].lower + c]);
+        const float bottom_right(bottom[xs[x].upper + c]);
+        const float top_lerp = top_left + (top_right - top_left) * x_lerp;
+        const float bottom_lerp =
+            bottom_left + (bottom_right - bottom_left) * x_lerp;
+        *output++ = top_lerp + (bottom_lerp - top_lerp) * y_lerp;
+      }
+    }
+  }
+}
+
+// Decodes a batch of JPEG images and bilinearly resizes them to a common size.
+// Each image is decoded at the smallest DCT scale (1/1, 1/2, 1/4 or 1/8) that
+// still covers the requested size, so that libjpeg does most of the
+// downscaling, and only the remaining factor is interpolated.
+class DecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // As in DecodeJpeg, the default is IFAST.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be 1-D, got shape ",
+                                        contents.shape().DebugString()));
+    const Tensor& size = context->input(1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument("size must be 1-D with 2 elements, "
+                                        "got shape ",
+                                        size.shape().DebugString()));
+    const int64 out_height = size.vec<int32>()(0);
+    const int64 out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("output dimensions must be positive, "
+                                        "got ",
+                                        out_height, " by ", out_width));
+
+    const int64 batch_size = contents.NumElements();
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(
+        context,
+        context->allocate_output(
+            0, TensorShape({batch_size, out_height, out_width, channels_}),
+            &output));
+    if (batch_size == 0) return;
+
+    const auto contents_vec = contents.vec<string>();
+    float* output_data = output->flat<float>().data();
+    const int64 image_size = out_height * out_width * channels_;
+    std::vector<Status> statuses(batch_size);
+    auto decode_and_resize = [&](int64 begin, int64 end) {
+      for (int64 b = begin; b < end; ++b) {
+        statuses[b] = DecodeAndResize(contents_vec(b), out_height, out_width,
+                                      output_data + b * image_size);
+      }
+    };
+    int64 total_bytes = 0;
+    for (int64 b = 0; b < batch_size; ++b) {
+      total_bytes += contents_vec(b).size();
+    }
+    // Decoding costs roughly a hundred cycles per compressed byte, and the
+    // resize a few cycles per output value.
+    const int64 cost_per_image =
+        100 * (total_bytes / batch_size) + 10 * image_size;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          cost_per_image, decode_and_resize);
+    for (int64 b = 0; b < batch_size; ++b) {
+      OP_REQUIRES_OK(context, statuses[b]);
+    }
+  }
+
+ private:
+  Status DecodeAndResize(StringPiece input, int64 out_height, int64 out_width,
+                         float* output) const {
+    if (ClassifyFileFormat(input) != kJpgFormat) {
+      return errors::InvalidArgument(
+          "Expected JPEG, got ",
+          FileFormatString(ClassifyFileFormat(input), input));
+    }
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                     input.size());
+    }
+    int image_width;
+    int image_height;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &image_width,
+                            &image_height, nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG header, data size ",
+                                     input.size());
+    }
+
+    // libjpeg scales a dimension of size n by 1/ratio to ceil(n / ratio).
+    jpeg::UncompressFlags flags = flags_;
+    for (int ratio = 8; ratio > 1; ratio /= 2) {
+      if ((image_height + ratio - 1) / ratio >= out_height &&
+          (image_width + ratio - 1) / ratio >= out_width) {
+        flags.ratio = ratio;
+        break;
+      }
+    }
+
+    std::unique_ptr<uint8[]> decoded;
+    int decoded_width = 0;
+    int decoded_height = 0;
+    if (!jpeg::Uncompress(
+            input.data(), input.size(), flags, nullptr /* nwarn */,
+            [&](int width, int height, int channels) -> uint8* {
+              decoded_width = width;
+              decoded_height = height;
+              decoded.reset(new uint8[static_cast<int64>(width) * height *
+                                      channels]);
+              return decoded.get();
+            })) {
+      return errors::InvalidArgument("Invalid JPEG data, data size ",
+                                     input.size());
+    }
+    ResizeDecodedImage(decoded.get(), decoded_height, decoded_width, channels_,
+                       out_height, out_width, align_corners_, output);
+    return Status::OK();
+  }
+
+  int channels_;
+  bool align_corners_;
+  jpeg::UncompressFlags flags_;
+};
+
 REGISTER_KERNEL_BUILDER(Name("DecodeJpeg").Device(DEVICE_CPU), DecodeImageOp);
 REGISTER_KERNEL_BUILDER(Name("DecodePng").Device(DEVICE_CPU), DecodeImageOp);
 REGISTER_KERNEL_BUILDER(Name("DecodeGif").Device(DEVICE_CPU), DecodeImageOp);
 REGISTER_KERNEL_BUILDER(Name("DecodeAndCropJpeg").Device(DEVICE_CPU),
                         DecodeImageOp);
+REGISTER_KERNEL_BUILDER(Name("DecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegOp);
 
 }  // namespace
 }  // namespace tensorflow
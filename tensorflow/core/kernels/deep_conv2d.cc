@@ -921,7 +921,8 @@ namespace functor {
 // Conv2D operation specialized for deep convolutions (i.e. large
 // in_depth * out_depth).
 // Details:
-// *) Transforms and packs filters from 'filter' in parallel.
+// *) Transforms and packs filters from 'filter' in parallel, or reuses those
+//    in 'filter_cache' if it holds the same filter.
 // *) Computes Conv2D parallelized across 'batch' dimension.
 //   *) Each thread loops over images in its batch shard, copying 'num_tiles'
 //      input tiles into a local buffer, and computing the Conv2D output of
@@ -935,7 +936,8 @@ namespace functor {
 template <typename T>
 struct DeepConv2D<CPUDevice, T> {
   void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
-                  const T* filter, T* output) {
+                  const T* filter, T* output,
+                  DeepConv2DFilterCache* filter_cache) {
     // TODO(andydavis) Add function to select transform based on conv params.
     std::unique_ptr<DeepConv2DTransform<T>> transform(new WinogradTransform<T>);
 
@@ -960,24 +962,54 @@ struct DeepConv2D<CPUDevice, T> {
         std::max(0LL, args.filter_cols - base_filter_rows);
     const int64 filter_shards_col = 1 + (filter_residual_col + 2 - 1) / 2;
 
-    // Allocate buffer for transformed filters.
-    Tensor filter_transform;
-    OP_REQUIRES_OK(
-        ctx, ctx->allocate_temp(
-                 DataTypeToEnum<T>::value,
-                 TensorShape({tile_rows, tile_cols, out_depth,
-                              filter_shards_row, filter_shards_col, in_depth}),
-                 &filter_transform));
-    T* filter_transform_data = filter_transform.template flat<T>().data();
-
-    // Transform filters.
-    TransformFilters<T>()(ctx, args, transform.get(), filter_shards_row,
-                          filter_shards_col, filter, filter_transform_data);
-
-    // Pack filters.
-    std::vector<Tensor> packed_filters(tile_spatial_size);
-    PackFilters<T>()(ctx, args, tile_spatial_size, filter_shards_row,
-                     filter_shards_col, filter_transform_data, &packed_filters);
+    // Look up the packed filters of the last call.
+    const TensorShape filter_shape(
+        {args.filter_rows, args.filter_cols, in_depth, out_depth});
+    const size_t filter_bytes = filter_shape.num_elements() * sizeof(T);
+    std::vector<Tensor> packed_filters;
+    if (filter_cache != nullptr) {
+      mutex_lock l(filter_cache->mu);
+      const Tensor& cached_filter = filter_cache->filter;
+      if (cached_filter.dtype() == DataTypeToEnum<T>::value &&
+          cached_filter.shape() == filter_shape &&
+          memcmp(cached_filter.tensor_data().data(), filter, filter_bytes) ==
+              0) {
+        packed_filters = filter_cache->packed_filters;
+      }
+    }
+
+    if (packed_filters.empty()) {
+      // Allocate buffer for transformed filters.
+      Tensor filter_transform;
+      OP_REQUIRES_OK(
+          ctx,
+          ctx->allocate_temp(
+              DataTypeToEnum<T>::value,
+              TensorShape({tile_rows, tile_cols, out_depth, filter_shards_row,
+                           filter_shards_col, in_depth}),
+              &filter_transform));
+      T* filter_transform_data = filter_transform.template flat<T>().data();
+
+      // Transform filters.
+      TransformFilters<T>()(ctx, args, transform.get(), filter_shards_row,
+                            filter_shards_col, filter, filter_transform_data);
+
+      // Pack filters.
+      packed_filters.resize(tile_spatial_size);
+      PackFilters<T>()(ctx, args, tile_spatial_size, filter_shards_row,
+                       filter_shards_col, filter_transform_data,
+                       &packed_filters);
+      if (!ctx->status().ok()) return;
+
+      if (filter_cache != nullptr) {
+        Tensor filter_copy(DataTypeToEnum<T>::value, filter_shape);
+        memcpy(const_cast<char*>(filter_copy.tensor_data().data()), filter,
+               filter_bytes);
+        mutex_lock l(filter_cache->mu);
+        filter_cache->filter = filter_copy;
+        filter_cache->packed_filters = packed_filters;
+      }
+    }
 
     // Allocate buffer for tile transform matrix.
     Tensor tile_transform_matrix_tensor;
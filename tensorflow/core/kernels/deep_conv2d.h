@@ -16,7 +16,12 @@ limitations under the License.
 #ifndef THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DEEP_CONV2D_H_
 #define THIRD_PARTY_TENSORFLOW_CORE_KERNELS_DEEP_CONV2D_H_
 
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -101,13 +106,25 @@ bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
                       int out_rows, int out_cols);
 
+// Holds the transformed and packed filters of the last DeepConv2D call of a
+// kernel, along with a copy of the filter they were computed from. A call
+// whose filter equals the copy, as when the filter is a constant, reuses them
+// instead of transforming the filter again.
+struct DeepConv2DFilterCache {
+  mutex mu;
+  Tensor filter GUARDED_BY(mu);
+  std::vector<Tensor> packed_filters GUARDED_BY(mu);
+};
+
 namespace functor {
 
 // Calls DeepConv2D implementation (see deep_conv2d.cc for details).
+// 'filter_cache' may be null, in which case the filter is always transformed.
 template <typename Device, typename T>
 struct DeepConv2D {
   void operator()(OpKernelContext* ctx, const Conv2DArgs& args, const T* input,
-                  const T* filter, T* output);
+                  const T* filter, T* output,
+                  DeepConv2DFilterCache* filter_cache = nullptr);
 };
 
 }  // namespace functor
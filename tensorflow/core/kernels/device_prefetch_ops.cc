@@ -0,0 +1,381 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/dataset.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following ops.
+
+// Buffers the elements of an iterator on a device. A producer thread gets
+// the elements from the iterator, which builds them in host memory that the
+// device can read directly (for a GPU, the pinned memory of the CUDA host
+// allocator), and copies them to the device through its `DeviceContext`, so
+// that the copies run on the host-to-device stream of a GPU while the
+// consumer works on the previous elements.
+//
+// On a device without a `DeviceContext` (e.g. a CPU) the elements are
+// buffered as they are.
+class DevicePrefetcher : public ResourceBase {
+ public:
+  DevicePrefetcher(const DataTypeVector& output_dtypes, int64 buffer_size)
+      : output_dtypes_(output_dtypes), buffer_size_(buffer_size) {}
+
+  ~DevicePrefetcher() override {
+    StopProducer();
+    if (device_context_ != nullptr) {
+      device_context_->Unref();
+    }
+  }
+
+  // Replaces the iterator whose elements are prefetched to `device`,
+  // discarding the elements buffered from the previous one.
+  Status set_iterator(std::unique_ptr<IteratorBase> iterator, Device* device,
+                      DeviceContext* device_context) LOCKS_EXCLUDED(mu_) {
+    // Concurrent calls must not interleave between stopping the producer of
+    // the previous iterator and installing the new iterator.
+    mutex_lock set_iterator_lock(set_iterator_mu_);
+    StopProducer();
+    if (device_context != nullptr) {
+      device_context->Ref();
+    }
+    mutex_lock l(mu_);
+    if (device_context_ != nullptr) {
+      device_context_->Unref();
+    }
+    iterator_ = std::move(iterator);
+    device_ = device;
+    device_context_ = device_context;
+    buffer_.clear();
+    cancelled_ = false;
+    producer_finished_ = false;
+    // Wake a consumer that waited on the previous iterator, so that it
+    // starts the producer of this one.
+    cond_var_.notify_all();
+    return Status::OK();
+  }
+
+  Status GetNext(OpKernelContext* ctx, std::vector<Tensor>* out_tensors,
+                 bool* end_of_sequence) LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    while (true) {
+      if (!iterator_) {
+        return errors::FailedPrecondition(
+            "GetNext() failed because the iterator has not been initialized. "
+            "Ensure that you have run the initializer operation for this "
+            "iterator before getting the next element.");
+      }
+      if (!buffer_.empty() || producer_finished_) {
+        break;
+      }
+      if (!producer_thread_ && !cancelled_) {
+        StartProducerLocked(ctx);
+      }
+      cond_var_.wait(l);
+    }
+
+    if (buffer_.empty()) {
+      *end_of_sequence = true;
+      return Status::OK();
+    }
+    BufferElement element = std::move(buffer_.front());
+    buffer_.pop_front();
+    cond_var_.notify_all();
+    TF_RETURN_IF_ERROR(element.status);
+    *out_tensors = std::move(element.value);
+    *end_of_sequence = false;
+    return Status::OK();
+  }
+
+  const DataTypeVector& output_dtypes() const { return output_dtypes_; }
+
+  string DebugString() override { return "DevicePrefetcher"; }
+
+ private:
+  // An element from the iterator, or the error that ended it.
+  struct BufferElement {
+    Status status;
+    std::vector<Tensor> value;
+  };
+
+  void StartProducerLocked(OpKernelContext* ctx)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    IteratorContext::Params params;
+    params.env = ctx->env();
+    params.runner = *(ctx->runner());
+    if (device_context_ != nullptr) {
+      Device* device = device_;
+      params.allocator_getter = [device](AllocatorAttributes attrs) {
+        attrs.set_on_host(true);
+        attrs.set_gpu_compatible(true);
+        return device->GetAllocator(attrs);
+      };
+    }
+    std::shared_ptr<IteratorContext> iter_ctx(
+        new IteratorContext(std::move(params)));
+    producer_thread_.reset(ctx->env()->StartThread(
+        {}, "device_prefetch_producer",
+        [this, iter_ctx]() { ProducerThread(iter_ctx.get()); }));
+  }
+
+  // Cancels the producer thread and waits for it to finish the element that
+  // it is working on.
+  void StopProducer() LOCKS_EXCLUDED(mu_) {
+    std::unique_ptr<Thread> producer_thread;
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+      producer_thread = std::move(producer_thread_);
+    }
+    // Joins the thread.
+    producer_thread.reset();
+  }
+
+  void ProducerThread(IteratorContext* ctx) {
+    while (true) {
+      {
+        mutex_lock l(mu_);
+        while (!cancelled_ && buffer_.size() >= buffer_size_) {
+          cond_var_.wait(l);
+        }
+        if (cancelled_) {
+          return;
+        }
+      }
+
+      BufferElement element;
+      std::vector<Tensor> host_tensors;
+      bool end_of_sequence = false;
+      element.status =
+          iterator_->GetNext(ctx, &host_tensors, &end_of_sequence);
+      if (element.status.ok() && !end_of_sequence) {
+        element.status = CopyToDevice(host_tensors, &element.value);
+      }
+
+      mutex_lock l(mu_);
+      if (!element.status.ok() || end_of_sequence) {
+        if (!element.status.ok()) {
+          buffer_.push_back(std::move(element));
+        }
+        producer_finished_ = true;
+        cond_var_.notify_all();
+        return;
+      }
+      buffer_.push_back(std::move(element));
+      cond_var_.notify_all();
+    }
+  }
+
+  // Copies `host_tensors` to the device, and blocks until the copies are
+  // complete. Components of a type that is always kept in host memory are
+  // not copied.
+  Status CopyToDevice(const std::vector<Tensor>& host_tensors,
+                      std::vector<Tensor>* device_tensors) {
+    if (device_context_ == nullptr) {
+      *device_tensors = host_tensors;
+      return Status::OK();
+    }
+    // Allocate all the components before issuing any copy, so that running
+    // out of memory does not leave copies in flight.
+    Allocator* allocator = device_->GetAllocator(AllocatorAttributes());
+    device_tensors->reserve(host_tensors.size());
+    for (const Tensor& host_tensor : host_tensors) {
+      if (DataTypeAlwaysOnHost(host_tensor.dtype())) {
+        device_tensors->push_back(host_tensor);
+        continue;
+      }
+      device_tensors->emplace_back(allocator, host_tensor.dtype(),
+                                   host_tensor.shape());
+      if (!device_tensors->back().IsInitialized()) {
+        return errors::ResourceExhausted(
+            "OOM when allocating tensor of shape ",
+            host_tensor.shape().DebugString(), " and type ",
+            DataTypeString(host_tensor.dtype()), " on ",
+            device_->attributes().name());
+      }
+    }
+
+    BlockingCounter counter(host_tensors.size());
+    mutex status_mu;
+    Status status;
+    for (size_t i = 0; i < host_tensors.size(); ++i) {
+      if (DataTypeAlwaysOnHost(host_tensors[i].dtype())) {
+        counter.DecrementCount();
+        continue;
+      }
+      device_context_->CopyCPUTensorToDevice(
+          &host_tensors[i], device_, &(*device_tensors)[i],
+          [&counter, &status_mu, &status](const Status& s) {
+            {
+              mutex_lock l(status_mu);
+              status.Update(s);
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    return status;
+  }
+
+  const DataTypeVector output_dtypes_;
+  const int64 buffer_size_;
+
+  mutex set_iterator_mu_;
+  mutex mu_;
+  condition_variable cond_var_;
+  // Written under `mu_` while no producer thread runs, and read by the
+  // producer thread without holding `mu_`.
+  std::unique_ptr<IteratorBase> iterator_;
+  Device* device_ = nullptr;  // Not owned.
+  DeviceContext* device_context_ = nullptr;
+  std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
+  std::unique_ptr<Thread> producer_thread_ GUARDED_BY(mu_);
+  bool cancelled_ GUARDED_BY(mu_) = false;
+  bool producer_finished_ GUARDED_BY(mu_) = false;
+};
+
+class DevicePrefetchIteratorHandleOp
+    : public ResourceOpKernel<DevicePrefetcher> {
+ public:
+  explicit DevicePrefetchIteratorHandleOp(OpKernelConstruction* ctx)
+      : ResourceOpKernel<DevicePrefetcher>(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_dtypes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("buffer_size", &buffer_size_));
+  }
+
+ private:
+  Status CreateResource(DevicePrefetcher** ret) override
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    *ret = new DevicePrefetcher(output_dtypes_, buffer_size_);
+    return Status::OK();
+  }
+
+  Status VerifyResource(DevicePrefetcher* resource) override {
+    if (resource->output_dtypes() != output_dtypes_) {
+      return errors::InvalidArgument(
+          "The shared iterator has types ",
+          DataTypeVectorString(resource->output_dtypes()), " but expected ",
+          DataTypeVectorString(output_dtypes_), ".");
+    }
+    return Status::OK();
+  }
+
+  DataTypeVector output_dtypes_;
+  int64 buffer_size_;
+};
+
+class MakeDevicePrefetchIteratorOp : public OpKernel {
+ public:
+  explicit MakeDevicePrefetchIteratorOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    DatasetBase* dataset;
+    OP_REQUIRES_OK(ctx, GetDatasetFromVariantTensor(ctx->input(0), &dataset));
+    DevicePrefetcher* prefetcher;
+    OP_REQUIRES_OK(ctx,
+                   LookupResource(ctx, HandleFromInput(ctx, 1), &prefetcher));
+    core::ScopedUnref unref_prefetcher(prefetcher);
+    const DataTypeVector& dtypes = dataset->output_dtypes();
+    OP_REQUIRES(ctx, dtypes == prefetcher->output_dtypes(),
+                errors::InvalidArgument(
+                    "The dataset has types ", DataTypeVectorString(dtypes),
+                    " but the iterator expects ",
+                    DataTypeVectorString(prefetcher->output_dtypes()), "."));
+    OP_REQUIRES_OK(ctx, prefetcher->set_iterator(
+                            dataset->MakeIterator("DevicePrefetchIterator"),
+                            static_cast<Device*>(ctx->device()),
+                            ctx->op_device_context()));
+  }
+};
+
+class DevicePrefetchIteratorGetNextOp : public AsyncOpKernel {
+ public:
+  explicit DevicePrefetchIteratorGetNextOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        thread_pool_(new thread::ThreadPool(
+            ctx->env(), ThreadOptions(),
+            strings::StrCat("device_prefetch_get_next_thread_",
+                            SanitizeThreadSuffix(name())),
+            1 /* num_threads */, false /* low_latency_hint */)) {}
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    DevicePrefetcher* prefetcher;
+    OP_REQUIRES_OK_ASYNC(
+        ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &prefetcher), done);
+
+    // The call to `prefetcher->GetNext()` blocks until the producer has
+    // copied an element, so we issue the call from the owned thread pool.
+    thread_pool_->Schedule([ctx, prefetcher, done]() {
+      core::ScopedUnref unref_prefetcher(prefetcher);
+
+      std::vector<Tensor> components;
+      bool end_of_sequence = false;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, prefetcher->GetNext(ctx, &components, &end_of_sequence), done);
+      OP_REQUIRES_ASYNC(ctx, !end_of_sequence,
+                        errors::OutOfRange("End of sequence"), done);
+
+      for (int i = 0; i < components.size(); ++i) {
+        ctx->set_output(i, components[i]);
+      }
+
+      done();
+    });
+  }
+
+ private:
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DevicePrefetchIterator").Device(DEVICE_CPU),
+                        DevicePrefetchIteratorHandleOp);
+REGISTER_KERNEL_BUILDER(Name("MakeDevicePrefetchIterator").Device(DEVICE_CPU),
+                        MakeDevicePrefetchIteratorOp);
+REGISTER_KERNEL_BUILDER(
+    Name("DevicePrefetchIteratorGetNext").Device(DEVICE_CPU),
+    DevicePrefetchIteratorGetNextOp);
+
+#if GOOGLE_CUDA
+REGISTER_KERNEL_BUILDER(Name("DevicePrefetchIterator")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("handle"),
+                        DevicePrefetchIteratorHandleOp);
+REGISTER_KERNEL_BUILDER(Name("MakeDevicePrefetchIterator")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("dataset")
+                            .HostMemory("iterator"),
+                        MakeDevicePrefetchIteratorOp);
+REGISTER_KERNEL_BUILDER(Name("DevicePrefetchIteratorGetNext")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("iterator"),
+                        DevicePrefetchIteratorGetNextOp);
+#endif  // GOOGLE_CUDA
+
+}  // namespace
+
+}  // namespace tensorflow
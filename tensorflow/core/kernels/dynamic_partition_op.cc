@@ -15,12 +15,15 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <numeric>
 #include <vector>
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
 
@@ -39,9 +42,16 @@ class DynamicPartitionOp_Shared : public OpKernel {
     //   in the graph?
   }
 
+  // The rows of data are split into num_blocks contiguous blocks of
+  // block_size rows each (the last one may be shorter). The partition ids are
+  // counted per block in parallel, and on return (*offsets)[b * P + p] is the
+  // row of outputs[p] that the first row of block b in partition p goes to,
+  // so that the blocks can later be scattered in parallel as well.
   void ValidateAndAllocateOutputs(OpKernelContext* c, const Tensor** data,
                                   const Tensor** partitions,
-                                  OpOutputList* Tout) {
+                                  OpOutputList* Tout, int64* block_size,
+                                  int64* num_blocks,
+                                  std::vector<int64>* offsets) {
     OP_REQUIRES_OK(c, c->input("data", data));
     OP_REQUIRES_OK(c, c->input("partitions", partitions));
     OP_REQUIRES(
@@ -52,17 +62,60 @@ class DynamicPartitionOp_Shared : public OpKernel {
             "got data.shape = ", (*data)->shape().DebugString(),
             ", partitions.shape = ", (*partitions)->shape().DebugString()));
 
-    // Count how many occurrences of each partition id we have in partitions
-    gtl::InlinedVector<int, 32> partition_count(num_partitions_);
+    // Count how many occurrences of each partition id we have in each block
+    // of partitions.
     auto e_partitions = (*partitions)->flat<int32>();
     const int64 N = e_partitions.dimension(0);
-    for (int64 i = 0; i < N; i++) {
-      const int32 p = internal::SubtleMustCopy(e_partitions(i));
-      OP_REQUIRES(c, FastBoundsCheck(p, num_partitions_),
-                  errors::InvalidArgument(
-                      "partitions", SliceDebugString((*partitions)->shape(), i),
-                      " = ", p, " is not in [0, ", num_partitions_, ")"));
-      partition_count[p]++;
+    // Blocks hold at least kMinBlockRows rows or kMinBlockBytes bytes of
+    // data, and there are at most a few blocks per thread.
+    const int64 kMinBlockRows = 4096;
+    const int64 kMinBlockBytes = 64 << 10;
+    const int64 slice_size = N > 0 ? (*data)->NumElements() / N : 0;
+    const int64 row_bytes = std::max<int64>(
+        DataTypeSize((*data)->dtype()) * slice_size, 1);
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    const int64 max_blocks = 4 * worker_threads->num_threads;
+    *block_size = std::max(
+        std::min(kMinBlockRows, std::max<int64>(kMinBlockBytes / row_bytes, 1)),
+        (N + max_blocks - 1) / max_blocks);
+    *num_blocks = std::max<int64>((N + *block_size - 1) / *block_size, 1);
+
+    const int64 P = num_partitions_;
+    offsets->assign(*num_blocks * P, 0);
+    // The first out of range row of each block, or N.
+    std::vector<int64> first_invalid(*num_blocks, N);
+    auto CountBlocks = [&](int64 first, int64 last) {
+      for (int64 b = first; b < last; ++b) {
+        int64* block_count = offsets->data() + b * P;
+        const int64 end = std::min(N, (b + 1) * *block_size);
+        for (int64 i = b * *block_size; i < end; ++i) {
+          const int32 p = internal::SubtleMustCopy(e_partitions(i));
+          if (!FastBoundsCheck(p, num_partitions_)) {
+            first_invalid[b] = i;
+            break;
+          }
+          block_count[p]++;
+        }
+      }
+    };
+    worker_threads->workers->ParallelFor(*num_blocks, *block_size,
+                                         CountBlocks);
+    const int64 bad =
+        *std::min_element(first_invalid.begin(), first_invalid.end());
+    OP_REQUIRES(c, bad == N,
+                errors::InvalidArgument(
+                    "partitions", SliceDebugString((*partitions)->shape(), bad),
+                    " = ", e_partitions(bad), " is not in [0, ",
+                    num_partitions_, ")"));
+
+    // Turn the per block counts into output offsets.
+    gtl::InlinedVector<int64, 32> partition_count(num_partitions_);
+    for (int64 b = 0; b < *num_blocks; ++b) {
+      for (int64 p = 0; p < P; ++p) {
+        const int64 count = (*offsets)[b * P + p];
+        (*offsets)[b * P + p] = partition_count[p];
+        partition_count[p] += count;
+      }
     }
 
     // Allocate output tensors of the right size
@@ -91,68 +144,61 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
     const Tensor* data;
     const Tensor* partitions;
     OpOutputList outputs;
-    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs);
+    int64 block_size;
+    int64 num_blocks;
+    std::vector<int64> offsets;
+    ValidateAndAllocateOutputs(c, &data, &partitions, &outputs, &block_size,
+                               &num_blocks, &offsets);
     if (!c->status().ok()) return;
     if (num_partitions_ == 0 || data->NumElements() == 0) return;
 
     auto e_partitions = partitions->flat<int32>();
     const int64 N = e_partitions.dimension(0);
-    gtl::InlinedVector<int, 32> output_index(num_partitions_);
-
-    if (partitions->dims() == data->dims()) {
-      // Walk through data and copy the data to the appropriate output tensor
-      const auto data_flat = data->flat<T>();
-      std::vector<Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                                   Eigen::Aligned> > out_vec;
-      out_vec.reserve(num_partitions_);
-      for (int p = 0; p < num_partitions_; p++) {
-        out_vec.push_back(outputs[p]->vec<T>());
-      }
-      for (int64 i = 0; i < N; i++) {
-        const int32 p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i, "] is out of range"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_vec[p].size()),
-                    errors::InvalidArgument(
-                        "out_vec[", p, "] size: ", out_vec[p].size(),
-                        " is not LTE output_index[", p, "] : ", oi));
-        out_vec[p](oi) = data_flat(i);
-        output_index[p]++;
-      }
-    } else {
-      // If data has extra dimensions, use Eigen slices
-      std::vector<Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
-                                   Eigen::Aligned> > out_flat;
-      out_flat.reserve(num_partitions_);
-      for (int p = 0; p < num_partitions_; p++) {
-        out_flat.push_back(outputs[p]->flat_outer_dims<T>());
-      }
+    const int64 slice_size = data->NumElements() / N;
+    const T* data_base = data->flat<T>().data();
+    const int64 P = num_partitions_;
+    gtl::InlinedVector<T*, 32> out_base(num_partitions_);
+    gtl::InlinedVector<int64, 32> out_rows(num_partitions_);
+    for (int p = 0; p < num_partitions_; p++) {
+      out_base[p] = outputs[p]->flat<T>().data();
+      out_rows[p] = outputs[p]->NumElements() / slice_size;
+    }
 
-      // Walk through data and copy the data to the appropriate output tensor
-      const int64 slice_size = data->NumElements() / N;
-      const auto data_flat = data->shaped<T, 2>({N, slice_size});
-      Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-      for (int64 i = 0; i < N; i++) {
-        // outputs[p][output_index[p]++] = data[i]
-        const int32 p = internal::SubtleMustCopy(e_partitions(i));
-        OP_REQUIRES(
-            c, FastBoundsCheck(p, num_partitions_),
-            errors::InvalidArgument("indices[", i,
-                                    "] has been asynchronously overwitten and "
-                                    "is no longer in range!"));
-        auto oi = output_index[p];
-        OP_REQUIRES(c, FastBoundsCheck(oi, out_flat[p].dimension(0)),
-                    errors::InvalidArgument("Size of output_index: ", oi,
-                                            " is no longer in range."));
-        Eigen::DSizes<Eigen::DenseIndex, 2> out_indices(oi, 0);
-        Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
-        out_flat[p].slice(out_indices, sizes) =
-            data_flat.slice(data_indices, sizes);
-        output_index[p]++;
+    // Walk through each block of data and copy its rows to the appropriate
+    // output tensors, starting at the offsets computed for the block.
+    std::vector<int64> num_failed(num_blocks, 0);
+    auto ScatterBlocks = [&](int64 first, int64 last) {
+      gtl::InlinedVector<int64, 32> output_index(num_partitions_);
+      for (int64 b = first; b < last; ++b) {
+        std::copy_n(offsets.begin() + b * P, P, output_index.begin());
+        const int64 end = std::min(N, (b + 1) * block_size);
+        for (int64 i = b * block_size; i < end; ++i) {
+          // outputs[p][output_index[p]++] = data[i]
+          const int32 p = internal::SubtleMustCopy(e_partitions(i));
+          if (!FastBoundsCheck(p, num_partitions_) ||
+              !FastBoundsCheck(output_index[p], out_rows[p])) {
+            num_failed[b] = 1;
+            break;
+          }
+          T* out = out_base[p] + output_index[p] * slice_size;
+          const T* in = data_base + i * slice_size;
+          if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+            memcpy(out, in, slice_size * sizeof(T));
+          } else {
+            std::copy_n(in, slice_size, out);
+          }
+          output_index[p]++;
+        }
       }
-    }
+    };
+    c->device()->tensorflow_cpu_worker_threads()->workers->ParallelFor(
+        num_blocks, block_size * slice_size * sizeof(T), ScatterBlocks);
+    OP_REQUIRES(c,
+                std::accumulate(num_failed.begin(), num_failed.end(),
+                                int64{0}) == 0,
+                errors::InvalidArgument("partitions have been asynchronously "
+                                        "overwritten and are no longer in "
+                                        "range!"));
   }
 };
 
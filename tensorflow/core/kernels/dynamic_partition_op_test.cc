@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -145,6 +146,34 @@ TEST_F(DynamicPartitionOpTest, SomeOutputsEmpty) {
   }
 }
 
+TEST_F(DynamicPartitionOpTest, ManyBlocks) {
+  MakeOp();
+
+  // Enough rows for the partitions to be counted and scattered in several
+  // blocks; the rows of each output must keep their order.
+  const int kRows = 100000;
+  std::vector<float> data(2 * kRows);
+  std::vector<int32> partitions(kRows);
+  std::vector<std::vector<float>> expected(4);
+  for (int i = 0; i < kRows; i++) {
+    data[2 * i] = i;
+    data[2 * i + 1] = -i;
+    partitions[i] = (i * 7 + i / 3) % 4;
+    expected[partitions[i]].push_back(i);
+    expected[partitions[i]].push_back(-i);
+  }
+  AddInputFromArray<float>(TensorShape({kRows, 2}), data);
+  AddInputFromArray<int32>(TensorShape({kRows}), partitions);
+  TF_ASSERT_OK(RunOpKernel());
+
+  for (int p = 0; p < 4; p++) {
+    const int64 rows = expected[p].size() / 2;
+    Tensor expected_output(allocator(), DT_FLOAT, TensorShape({rows, 2}));
+    test::FillValues<float>(&expected_output, expected[p]);
+    test::ExpectTensorEqual<float>(expected_output, *GetOutput(p));
+  }
+}
+
 TEST_F(DynamicPartitionOpTest, Error_IndexOutOfRange) {
   MakeOp();
 
@@ -158,6 +187,21 @@ TEST_F(DynamicPartitionOpTest, Error_IndexOutOfRange) {
       << s;
 }
 
+TEST_F(DynamicPartitionOpTest, Error_FirstIndexOutOfRangeIsReported) {
+  MakeOp();
+
+  const int kRows = 100000;
+  std::vector<int32> partitions(kRows, 1);
+  partitions[70000] = -1;
+  partitions[90000] = 4;
+  AddInputFromArray<float>(TensorShape({kRows}), std::vector<float>(kRows));
+  AddInputFromArray<int32>(TensorShape({kRows}), partitions);
+  Status s = RunOpKernel();
+  EXPECT_TRUE(StringPiece(s.ToString())
+                  .contains("partitions[70000] = -1 is not in [0, 4)"))
+      << s;
+}
+
 Node* DynamicPartitionNode(Graph* g, Node* in0, Node* in1, int num_partitions) {
   Node* ret;
   TF_CHECK_OK(NodeBuilder(g->NewName("n"), "DynamicPartition")
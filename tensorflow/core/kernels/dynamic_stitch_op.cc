@@ -15,6 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -237,65 +240,43 @@ class DynamicStitchOpImplCPU : public DynamicStitchOpImplBase<T> {
     // merged that aren't covered by an index in indices.  What should we do?
     if (first_dim_size > 0) {
       auto merged_flat = merged->flat_outer_dims<T>();
-      const int slice_size = merged_flat.dimension(1);
+      const int64 slice_size = merged_flat.dimension(1);
       const size_t slice_bytes = slice_size * sizeof(T);
-      auto OnInputNumber = [&](int input_num) {
+
+      // First find the slice of data that ends up in each row of merged. Later
+      // indices overwrite earlier ones, so this pass is serial, but it only
+      // moves pointers around.
+      std::vector<const T*> sources(first_dim_size, nullptr);
+      for (int input_num = 0; input_num < indices_inputs.size(); input_num++) {
         const Tensor& indices = indices_inputs[input_num];
         auto indices_vec = indices.flat<int32>();
-        const Tensor& data = data_inputs[input_num];
-        auto data_flat =
-            data.shaped<T, 2>({indices_vec.dimension(0), slice_size});
-
-        if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
-          T* merged_base = &merged_flat(0, 0);
-          const T* data_base = &data_flat(0, 0);
-          for (int i = 0; i < indices_vec.size(); i++) {
-            int32 index = internal::SubtleMustCopy(indices_vec(i));
-            OP_REQUIRES(
-                c, FastBoundsCheck(index, first_dim_size),
-                errors::InvalidArgument("indices[", i, "] is out of range"));
-            memcpy(merged_base + index * slice_size, data_base + i * slice_size,
-                   slice_bytes);
-          }
-        } else {
-          Eigen::DSizes<Eigen::DenseIndex, 2> sizes(1, slice_size);
-          for (int i = 0; i < indices_vec.size(); i++) {
-            // Copy slice data[i] to merged[indices[i]]
-            Eigen::DSizes<Eigen::DenseIndex, 2> data_indices(i, 0);
-            int32 index = internal::SubtleMustCopy(indices_vec(i));
-            OP_REQUIRES(
-                c, FastBoundsCheck(index, first_dim_size),
-                errors::InvalidArgument("indices[", i, "] is out of range"));
-            Eigen::DSizes<Eigen::DenseIndex, 2> merged_indices(index, 0);
-            merged_flat.slice(merged_indices, sizes) =
-                data_flat.slice(data_indices, sizes);
-          }
-        }
-      };
-      if (Parallel) {
-        auto thread_pool =
-            c->device()->tensorflow_cpu_worker_threads()->workers;
-        size_t total_indices_size = 0;
-        for (int input_num = 0; input_num < indices_inputs.size();
-             ++input_num) {
-          total_indices_size += indices_inputs[input_num].NumElements();
+        const T* data_base = data_inputs[input_num].template flat<T>().data();
+        for (int i = 0; i < indices_vec.size(); i++) {
+          int32 index = internal::SubtleMustCopy(indices_vec(i));
+          OP_REQUIRES(
+              c, FastBoundsCheck(index, first_dim_size),
+              errors::InvalidArgument("indices[", i, "] is out of range"));
+          sources[index] = data_base + i * slice_size;
         }
-        const double avg_indices_size =
-            static_cast<double>(total_indices_size) / indices_inputs.size();
-        auto bytes_processed = slice_bytes * avg_indices_size;
-        auto LoopBody = [&](int first, int last) {
-          for (int input_num = first; input_num < last; ++input_num) {
-            OnInputNumber(input_num);
+      }
+
+      // Then copy the rows of merged in parallel. Every row is written at most
+      // once, so the result does not depend on how the rows are sharded.
+      auto CopyRows = [&](int64 first, int64 last) {
+        T* merged_base = merged_flat.data();
+        for (int64 row = first; row < last; row++) {
+          const T* source = sources[row];
+          if (source == nullptr) continue;
+          if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v())) {
+            memcpy(merged_base + row * slice_size, source, slice_bytes);
+          } else {
+            std::copy_n(source, slice_size, merged_base + row * slice_size);
           }
-        };
-        thread_pool->ParallelFor(indices_inputs.size(), bytes_processed,
-                                 LoopBody);
-      } else {
-        for (int input_num = 0; input_num < indices_inputs.size();
-             input_num++) {
-          OnInputNumber(input_num);
         }
-      }
+      };
+      auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+      worker_threads->workers->ParallelFor(
+          first_dim_size, std::max<int64>(slice_bytes, 1), CopyRows);
     }
   }
 };
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
@@ -79,6 +80,42 @@ TEST_F(DynamicStitchOpTest, Simple_TwoD) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+TEST_F(DynamicStitchOpTest, DuplicateIndicesTakeTheLastSlice) {
+  MakeOp(2, DT_FLOAT);
+
+  // Every row of merged is covered by both inputs, and twice by the second
+  // one, so the rows must come from the last slice in input order.
+  const int kRows = 50000;
+  std::vector<int32> indices0(kRows);
+  std::vector<int32> indices1(2 * kRows);
+  std::vector<float> data0(2 * kRows);
+  std::vector<float> data1(4 * kRows);
+  std::vector<float> expected(2 * kRows);
+  for (int i = 0; i < kRows; i++) {
+    indices0[i] = i;
+    indices1[i] = kRows - 1 - i;
+    indices1[kRows + i] = (i * 3) % kRows;
+  }
+  for (int i = 0; i < 4 * kRows; i++) {
+    if (i < 2 * kRows) data0[i] = -i;
+    data1[i] = i;
+  }
+  for (int i = 0; i < kRows; i++) {
+    const int row = indices1[kRows + i];
+    expected[2 * row] = data1[2 * (kRows + i)];
+    expected[2 * row + 1] = data1[2 * (kRows + i) + 1];
+  }
+  AddInputFromArray<int32>(TensorShape({kRows}), indices0);
+  AddInputFromArray<int32>(TensorShape({2 * kRows}), indices1);
+  AddInputFromArray<float>(TensorShape({kRows, 2}), data0);
+  AddInputFromArray<float>(TensorShape({2 * kRows, 2}), data1);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_output(allocator(), DT_FLOAT, TensorShape({kRows, 2}));
+  test::FillValues<float>(&expected_output, expected);
+  test::ExpectTensorEqual<float>(expected_output, *GetOutput(0));
+}
+
 TEST_F(DynamicStitchOpTest, Error_IndicesMultiDimensional) {
   MakeOp(2, DT_FLOAT);
 
@@ -0,0 +1,135 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/embedding_row_cache.h"
+
+#include <string.h>
+
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+
+namespace {
+
+auto* row_cache_hits = monitoring::Counter<0>::New(
+    "/tensorflow/core/embedding_row_cache/hits",
+    "The number of rows looked up in EmbeddingRowCaches that were cached.");
+
+auto* row_cache_misses = monitoring::Counter<0>::New(
+    "/tensorflow/core/embedding_row_cache/misses",
+    "The number of rows looked up in EmbeddingRowCaches that had to be "
+    "fetched.");
+
+}  // namespace
+
+EmbeddingRowCache::EmbeddingRowCache(DataType dtype,
+                                     const TensorShape& row_shape,
+                                     int64 capacity, int64 max_staleness)
+    : dtype_(dtype),
+      row_shape_(row_shape),
+      row_bytes_(DataTypeSize(dtype) * row_shape.num_elements()),
+      capacity_(capacity),
+      max_staleness_(max_staleness) {}
+
+void EmbeddingRowCache::Lookup(const int64* ids, int64 n, int64 version,
+                               char* values, std::vector<int64>* miss_ids,
+                               int32* miss_index) {
+  // The position of each missing id in "miss_ids".
+  std::unordered_map<int64, int32> miss_positions;
+  int64 num_hits = 0;
+  {
+    mutex_lock l(mu_);
+    for (int64 i = 0; i < n; ++i) {
+      char* value = values + i * row_bytes_;
+      auto it = entries_.find(ids[i]);
+      if (it != entries_.end() &&
+          version - it->second.version <= max_staleness_) {
+        memcpy(value, &rows_[it->second.slot * row_bytes_], row_bytes_);
+        lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+        miss_index[i] = -1;
+        ++num_hits;
+        continue;
+      }
+      memset(value, 0, row_bytes_);
+      auto inserted = miss_positions.emplace(ids[i], miss_ids->size());
+      if (inserted.second) miss_ids->push_back(ids[i]);
+      miss_index[i] = inserted.first->second;
+    }
+    hits_ += num_hits;
+    misses_ += n - num_hits;
+  }
+  row_cache_hits->GetCell()->IncrementBy(num_hits);
+  row_cache_misses->GetCell()->IncrementBy(n - num_hits);
+}
+
+void EmbeddingRowCache::Insert(const int64* ids, int64 n, const char* rows,
+                               int64 version) {
+  if (capacity_ == 0) return;
+  mutex_lock l(mu_);
+  for (int64 i = 0; i < n; ++i) {
+    auto it = entries_.find(ids[i]);
+    if (it == entries_.end()) {
+      int64 slot;
+      if (static_cast<int64>(entries_.size()) < capacity_) {
+        slot = entries_.size();
+        rows_.resize((slot + 1) * row_bytes_);
+      } else {
+        // Evicts the least recently used row and reuses its slot.
+        auto victim = entries_.find(lru_.back());
+        slot = victim->second.slot;
+        entries_.erase(victim);
+        lru_.pop_back();
+      }
+      lru_.push_front(ids[i]);
+      it = entries_.emplace(ids[i], Entry{slot, version, lru_.begin()}).first;
+    } else {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+    }
+    it->second.version = version;
+    memcpy(&rows_[it->second.slot * row_bytes_], rows + i * row_bytes_,
+           row_bytes_);
+  }
+}
+
+int64 EmbeddingRowCache::hits() const {
+  mutex_lock l(mu_);
+  return hits_;
+}
+
+int64 EmbeddingRowCache::misses() const {
+  mutex_lock l(mu_);
+  return misses_;
+}
+
+int64 EmbeddingRowCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+string EmbeddingRowCache::DebugString() {
+  mutex_lock l(mu_);
+  return strings::StrCat("EmbeddingRowCache of ", entries_.size(), "/",
+                         capacity_, " rows of ", DataTypeString(dtype_),
+                         row_shape_.DebugString(), ", ", hits_, " hits, ",
+                         misses_, " misses");
+}
+
+int64 EmbeddingRowCache::MemoryUsed() const {
+  mutex_lock l(mu_);
+  return rows_.size();
+}
+
+}  // namespace tensorflow
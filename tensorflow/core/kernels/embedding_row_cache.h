@@ -0,0 +1,101 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_EMBEDDING_ROW_CACHE_H_
+#define TENSORFLOW_KERNELS_EMBEDDING_ROW_CACHE_H_
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A cache of the rows of an embedding, e.g. of the rows of a partitioned
+// variable that a worker fetches from parameter servers every step.  Rows are
+// keyed by id, tagged with the version they were fetched at, and the least
+// recently used rows are evicted first.
+//
+// All the methods are thread-safe.
+class EmbeddingRowCache : public ResourceBase {
+ public:
+  // Caches rows of "dtype" and "row_shape", which must be a type that can be
+  // copied with memcpy().  Rows older than "max_staleness" versions are
+  // fetched again.  A "capacity" of 0 disables the cache.
+  EmbeddingRowCache(DataType dtype, const TensorShape& row_shape,
+                    int64 capacity, int64 max_staleness);
+
+  // Copies the cached rows of "ids[0, n)" that are fresh at "version" into
+  // "values", which holds n rows of row_bytes(), and zeros the others.
+  // Appends the unique ids whose rows are missing or stale to "miss_ids", in
+  // the order they first appear, and sets "miss_index[i]" to the position of
+  // "ids[i]" in "miss_ids", or -1 if its row was copied.
+  void Lookup(const int64* ids, int64 n, int64 version, char* values,
+              std::vector<int64>* miss_ids, int32* miss_index);
+
+  // Caches the rows "rows[0, n)" of "ids[0, n)", fetched at "version",
+  // replacing the cached rows of the same ids.
+  void Insert(const int64* ids, int64 n, const char* rows, int64 version);
+
+  DataType dtype() const { return dtype_; }
+  const TensorShape& row_shape() const { return row_shape_; }
+  int64 row_bytes() const { return row_bytes_; }
+  int64 capacity() const { return capacity_; }
+  int64 max_staleness() const { return max_staleness_; }
+
+  // The number of rows that Lookup() copied or missed so far.
+  int64 hits() const;
+  int64 misses() const;
+  // The number of cached rows.
+  int64 size() const;
+
+  string DebugString() override;
+  int64 MemoryUsed() const override;
+
+ private:
+  struct Entry {
+    int64 slot;     // The row is at rows_[slot * row_bytes_].
+    int64 version;  // The version the row was fetched at.
+    std::list<int64>::iterator lru_position;
+  };
+
+  const DataType dtype_;
+  const TensorShape row_shape_;
+  const int64 row_bytes_;
+  const int64 capacity_;
+  const int64 max_staleness_;
+
+  mutable mutex mu_;
+  // Grows by one row per slot until "capacity_" rows are cached.
+  std::vector<char> rows_ GUARDED_BY(mu_);
+  std::unordered_map<int64, Entry> entries_ GUARDED_BY(mu_);
+  // The cached ids, most recently used first.
+  std::list<int64> lru_ GUARDED_BY(mu_);
+  int64 hits_ GUARDED_BY(mu_) = 0;
+  int64 misses_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(EmbeddingRowCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_EMBEDDING_ROW_CACHE_H_
@@ -0,0 +1,253 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/lookup_ops.cc.
+
+#include <string.h>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/embedding_row_cache.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+namespace {
+
+char* RowData(Tensor* t) { return const_cast<char*>(t->tensor_data().data()); }
+
+template <typename Index>
+std::vector<int64> IdsToInt64(const Tensor& ids) {
+  const auto ids_flat = ids.flat<Index>();
+  return std::vector<int64>(ids_flat.data(), ids_flat.data() + ids_flat.size());
+}
+
+// Looks up the cache of input 0, and checks that its rows are of "dtype".
+Status GetCache(OpKernelContext* ctx, DataType dtype,
+                EmbeddingRowCache** cache) {
+  TF_RETURN_IF_ERROR(LookupResource(ctx, HandleFromInput(ctx, 0), cache));
+  if ((*cache)->dtype() != dtype) {
+    const DataType cache_dtype = (*cache)->dtype();
+    (*cache)->Unref();
+    return errors::InvalidArgument("The cache holds rows of ",
+                                   DataTypeString(cache_dtype), ", not ",
+                                   DataTypeString(dtype));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+class EmbeddingRowCacheOp : public ResourceOpKernel<EmbeddingRowCache> {
+ public:
+  explicit EmbeddingRowCacheOp(OpKernelConstruction* context)
+      : ResourceOpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("dtype", &dtype_));
+    OP_REQUIRES_OK(context, context->GetAttr("row_shape", &row_shape_));
+    OP_REQUIRES_OK(context, context->GetAttr("capacity", &capacity_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("max_staleness", &max_staleness_));
+  }
+
+ private:
+  Status CreateResource(EmbeddingRowCache** cache) override
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    *cache =
+        new EmbeddingRowCache(dtype_, row_shape_, capacity_, max_staleness_);
+    return Status::OK();
+  }
+
+  Status VerifyResource(EmbeddingRowCache* cache) override {
+    if (cache->dtype() != dtype_ || cache->row_shape() != row_shape_ ||
+        cache->capacity() != capacity_ ||
+        cache->max_staleness() != max_staleness_) {
+      return errors::InvalidArgument("Shared embedding row cache ",
+                                     cinfo_.name(), " is a ",
+                                     cache->DebugString());
+    }
+    return Status::OK();
+  }
+
+  DataType dtype_;
+  TensorShape row_shape_;
+  int64 capacity_;
+  int64 max_staleness_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("EmbeddingRowCache").Device(DEVICE_CPU),
+                        EmbeddingRowCacheOp);
+
+template <typename Index>
+class EmbeddingRowCacheLookupOp : public OpKernel {
+ public:
+  explicit EmbeddingRowCacheLookupOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("dtype", &dtype_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    EmbeddingRowCache* cache;
+    OP_REQUIRES_OK(ctx, GetCache(ctx, dtype_, &cache));
+    core::ScopedUnref unref(cache);
+    const Tensor& ids = ctx->input(1);
+    const Tensor& version = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(version.shape()),
+                errors::InvalidArgument("version must be a scalar, got ",
+                                        version.shape().DebugString()));
+
+    const int64 n = ids.NumElements();
+    TensorShape values_shape({n});
+    values_shape.AppendShape(cache->row_shape());
+    Tensor* values = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, values_shape, &values));
+    Tensor* miss_index = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(2, TensorShape({n}), &miss_index));
+
+    const std::vector<int64> ids64 = IdsToInt64<Index>(ids);
+    std::vector<int64> miss_ids64;
+    cache->Lookup(ids64.data(), n, version.scalar<int64>()(), RowData(values),
+                  &miss_ids64, miss_index->flat<int32>().data());
+
+    const int64 num_misses = miss_ids64.size();
+    Tensor* miss_ids = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({num_misses}),
+                                             &miss_ids));
+    auto miss_ids_flat = miss_ids->flat<Index>();
+    for (int64 i = 0; i < num_misses; ++i) {
+      miss_ids_flat(i) = static_cast<Index>(miss_ids64[i]);
+    }
+  }
+
+ private:
+  DataType dtype_;
+};
+
+template <typename Index>
+class EmbeddingRowCacheUpdateOp : public OpKernel {
+ public:
+  explicit EmbeddingRowCacheUpdateOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("dtype", &dtype_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    EmbeddingRowCache* cache;
+    OP_REQUIRES_OK(ctx, GetCache(ctx, dtype_, &cache));
+    core::ScopedUnref unref(cache);
+    const Tensor& values = ctx->input(1);
+    const Tensor& miss_ids = ctx->input(2);
+    const Tensor& miss_index = ctx->input(3);
+    const Tensor& miss_rows = ctx->input(4);
+    const Tensor& version = ctx->input(5);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(miss_ids.shape()),
+                errors::InvalidArgument("miss_ids must be a vector, got ",
+                                        miss_ids.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(miss_index.shape()),
+                errors::InvalidArgument("miss_index must be a vector, got ",
+                                        miss_index.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(version.shape()),
+                errors::InvalidArgument("version must be a scalar, got ",
+                                        version.shape().DebugString()));
+    const int64 n = miss_index.NumElements();
+    const int64 m = miss_ids.NumElements();
+    TensorShape values_shape({n});
+    values_shape.AppendShape(cache->row_shape());
+    OP_REQUIRES(ctx, values.shape() == values_shape,
+                errors::InvalidArgument(
+                    "values must be of shape ", values_shape.DebugString(),
+                    ", got ", values.shape().DebugString()));
+    TensorShape miss_rows_shape({m});
+    miss_rows_shape.AppendShape(cache->row_shape());
+    OP_REQUIRES(ctx, miss_rows.shape() == miss_rows_shape,
+                errors::InvalidArgument(
+                    "miss_rows must be of shape ",
+                    miss_rows_shape.DebugString(), ", got ",
+                    miss_rows.shape().DebugString()));
+    const auto miss_index_flat = miss_index.flat<int32>();
+    for (int64 i = 0; i < n; ++i) {
+      OP_REQUIRES(ctx, miss_index_flat(i) >= -1 && miss_index_flat(i) < m,
+                  errors::InvalidArgument("miss_index[", i, "] = ",
+                                          miss_index_flat(i),
+                                          " is not in [-1, ", m, ")"));
+    }
+
+    const std::vector<int64> miss_ids64 = IdsToInt64<Index>(miss_ids);
+    const char* rows = miss_rows.tensor_data().data();
+    cache->Insert(miss_ids64.data(), m, rows, version.scalar<int64>()());
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {1}, 0, values.shape(), &output));
+    char* out = RowData(output);
+    const int64 row_bytes = cache->row_bytes();
+    if (out != values.tensor_data().data()) {
+      memcpy(out, values.tensor_data().data(), n * row_bytes);
+    }
+    for (int64 i = 0; i < n; ++i) {
+      const int32 index = miss_index_flat(i);
+      if (index < 0) continue;
+      memcpy(out + i * row_bytes, rows + index * row_bytes, row_bytes);
+    }
+  }
+
+ private:
+  DataType dtype_;
+};
+
+#define REGISTER_KERNELS(Index)                                   \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingRowCacheLookup")         \
+                              .Device(DEVICE_CPU)                 \
+                              .TypeConstraint<Index>("Tindices"), \
+                          EmbeddingRowCacheLookupOp<Index>);      \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingRowCacheUpdate")         \
+                              .Device(DEVICE_CPU)                 \
+                              .TypeConstraint<Index>("Tindices"), \
+                          EmbeddingRowCacheUpdateOp<Index>);
+
+REGISTER_KERNELS(int32);
+REGISTER_KERNELS(int64);
+#undef REGISTER_KERNELS
+
+class EmbeddingRowCacheStatsOp : public OpKernel {
+ public:
+  explicit EmbeddingRowCacheStatsOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    EmbeddingRowCache* cache;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &cache));
+    core::ScopedUnref unref(cache);
+    const int64 stats[] = {cache->hits(), cache->misses(), cache->size()};
+    for (int i = 0; i < 3; ++i) {
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(i, TensorShape({}), &output));
+      output->scalar<int64>()() = stats[i];
+    }
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("EmbeddingRowCacheStats").Device(DEVICE_CPU),
+                        EmbeddingRowCacheStatsOp);
+
+}  // namespace tensorflow
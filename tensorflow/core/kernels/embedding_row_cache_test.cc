@@ -0,0 +1,117 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/embedding_row_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Rows of two floats, whose first element is the id and the second the version
+// they were fetched at.
+std::vector<float> Rows(const std::vector<int64>& ids, int64 version) {
+  std::vector<float> rows;
+  for (int64 id : ids) {
+    rows.push_back(id);
+    rows.push_back(version);
+  }
+  return rows;
+}
+
+struct LookupResult {
+  std::vector<float> values;
+  std::vector<int64> miss_ids;
+  std::vector<int32> miss_index;
+};
+
+LookupResult Lookup(EmbeddingRowCache* cache, const std::vector<int64>& ids,
+                    int64 version) {
+  LookupResult result;
+  result.values.resize(2 * ids.size(), -1);
+  result.miss_index.resize(ids.size());
+  cache->Lookup(ids.data(), ids.size(), version,
+                reinterpret_cast<char*>(result.values.data()),
+                &result.miss_ids, result.miss_index.data());
+  return result;
+}
+
+void Insert(EmbeddingRowCache* cache, const std::vector<int64>& ids,
+            int64 version) {
+  const std::vector<float> rows = Rows(ids, version);
+  cache->Insert(ids.data(), ids.size(),
+                reinterpret_cast<const char*>(rows.data()), version);
+}
+
+TEST(EmbeddingRowCacheTest, HitsAndMisses) {
+  EmbeddingRowCache* cache =
+      new EmbeddingRowCache(DT_FLOAT, TensorShape({2}), 10, 0);
+  core::ScopedUnref unref(cache);
+  EXPECT_EQ(8, cache->row_bytes());
+
+  LookupResult result = Lookup(cache, {3, 5, 3}, 0);
+  EXPECT_EQ(std::vector<int64>({3, 5}), result.miss_ids);
+  EXPECT_EQ(std::vector<int32>({0, 1, 0}), result.miss_index);
+  EXPECT_EQ(std::vector<float>(6, 0), result.values);
+  Insert(cache, result.miss_ids, 0);
+  EXPECT_EQ(2, cache->size());
+
+  result = Lookup(cache, {5, 7, 3}, 0);
+  EXPECT_EQ(std::vector<int64>({7}), result.miss_ids);
+  EXPECT_EQ(std::vector<int32>({-1, 0, -1}), result.miss_index);
+  EXPECT_EQ(std::vector<float>({5, 0, 0, 0, 3, 0}), result.values);
+  EXPECT_EQ(2, cache->hits());
+  EXPECT_EQ(4, cache->misses());
+}
+
+TEST(EmbeddingRowCacheTest, Staleness) {
+  EmbeddingRowCache* cache =
+      new EmbeddingRowCache(DT_FLOAT, TensorShape({2}), 10, 2);
+  core::ScopedUnref unref(cache);
+  Insert(cache, {1, 2}, 10);
+  Insert(cache, {2}, 11);
+  EXPECT_TRUE(Lookup(cache, {1, 2}, 12).miss_ids.empty());
+  LookupResult result = Lookup(cache, {1, 2}, 13);
+  EXPECT_EQ(std::vector<int64>({1}), result.miss_ids);
+  EXPECT_EQ(std::vector<float>({0, 0, 2, 11}), result.values);
+}
+
+TEST(EmbeddingRowCacheTest, EvictsLeastRecentlyUsed) {
+  EmbeddingRowCache* cache =
+      new EmbeddingRowCache(DT_FLOAT, TensorShape({2}), 2, 100);
+  core::ScopedUnref unref(cache);
+  Insert(cache, {1, 2}, 0);
+  // Makes 1 more recently used than 2.
+  Lookup(cache, {1}, 0);
+  Insert(cache, {3}, 1);
+  EXPECT_EQ(2, cache->size());
+  LookupResult result = Lookup(cache, {1, 2, 3}, 1);
+  EXPECT_EQ(std::vector<int64>({2}), result.miss_ids);
+  EXPECT_EQ(std::vector<float>({1, 0, 0, 0, 3, 1}), result.values);
+}
+
+TEST(EmbeddingRowCacheTest, Disabled) {
+  EmbeddingRowCache* cache =
+      new EmbeddingRowCache(DT_FLOAT, TensorShape({2}), 0, 0);
+  core::ScopedUnref unref(cache);
+  Insert(cache, {1}, 0);
+  EXPECT_EQ(0, cache->size());
+  EXPECT_EQ(std::vector<int64>({1}), Lookup(cache, {1}, 0).miss_ids);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -131,6 +131,7 @@ class ExampleParserOp : public OpKernel {
     for (int d = 0; d < attrs_.num_sparse; ++d) {
       config.sparse.push_back({sparse_keys_t[d], attrs_.sparse_types[d]});
     }
+    config.cancellation_manager = ctx->cancellation_manager();
 
     auto serialized_t = serialized->flat<string>();
     auto names_t = names->flat<string>();
@@ -26,6 +26,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -230,4 +232,89 @@ BM_AllParseExample(SparseFloat);
 BM_AllParseExample(DenseFloat);
 BM_AllParseExample(VarLenDenseFloat);
 
+// Examples shaped like those of a ranking model: a dense float embedding,
+// dense scalar label, weight and query, and sparse lists of ids of all
+// magnitudes and of string tokens, of varying lengths.
+static Tensor MakeRealisticExamples(int batch_size, int embedding_size) {
+  random::PhiloxRandom philox(1729);
+  random::SimplePhilox rng(&philox);
+  Tensor serialized(DT_STRING, TensorShape({batch_size}));
+  auto serialized_t = serialized.vec<string>();
+  for (int b = 0; b < batch_size; ++b) {
+    Example example;
+    auto& features = *example.mutable_features()->mutable_feature();
+    for (int i = 0; i < embedding_size; ++i) {
+      features["embedding"].mutable_float_list()->add_value(rng.RandFloat());
+    }
+    features["label"].mutable_int64_list()->add_value(rng.Uniform(2));
+    features["weight"].mutable_float_list()->add_value(rng.RandFloat());
+    features["query"].mutable_bytes_list()->add_value(
+        strings::Printf("query_%u", rng.Uniform(100000)));
+    const int num_ids = rng.Uniform(50);
+    for (int i = 0; i < num_ids; ++i) {
+      // Ids of 1 to 9 bytes.
+      const int bits = 7 * (1 + rng.Uniform(9)) - 1;
+      features["ids"].mutable_int64_list()->add_value(rng.Rand64() >>
+                                                      (64 - bits));
+    }
+    const int num_tokens = 1 + rng.Uniform(20);
+    for (int i = 0; i < num_tokens; ++i) {
+      features["tokens"].mutable_bytes_list()->add_value(
+          string(5 + rng.Uniform(10), 'a' + rng.Uniform(26)));
+    }
+    CHECK(example.SerializeToString(&serialized_t(b)));
+  }
+  return serialized;
+}
+
+static Graph* ParseRealisticExample(int batch_size, int embedding_size) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor serialized = MakeRealisticExamples(batch_size, embedding_size);
+  Tensor names(DT_STRING, TensorShape({batch_size}));
+
+  auto key = [g](const string& name) {
+    Tensor key(DT_STRING, TensorShape());
+    key.scalar<string>()() = name;
+    return NodeBuilder::NodeOut(test::graph::Constant(g, key));
+  };
+  std::vector<NodeBuilder::NodeOut> sparse_keys = {key("ids"), key("tokens")};
+  std::vector<DataType> sparse_types = {DT_INT64, DT_STRING};
+  std::vector<NodeBuilder::NodeOut> dense_keys = {
+      key("embedding"), key("label"), key("weight"), key("query")};
+  std::vector<NodeBuilder::NodeOut> dense_defaults = {
+      test::graph::Constant(g, Tensor(DT_FLOAT, {embedding_size})),
+      test::graph::Constant(g, Tensor(DT_INT64, {})),
+      test::graph::Constant(g, Tensor(DT_FLOAT, {})),
+      test::graph::Constant(g, Tensor(DT_STRING, {}))};
+  std::vector<PartialTensorShape> dense_shapes = {
+      PartialTensorShape({embedding_size}), PartialTensorShape({}),
+      PartialTensorShape({}), PartialTensorShape({})};
+
+  Node* ret;
+  TF_EXPECT_OK(NodeBuilder(g->NewName("n"), "ParseExample")
+                   .Input(test::graph::Constant(g, serialized))
+                   .Input(test::graph::Constant(g, names))
+                   .Input(sparse_keys)
+                   .Input(dense_keys)
+                   .Input(dense_defaults)
+                   .Attr("sparse_types", sparse_types)
+                   .Attr("dense_shapes", dense_shapes)
+                   .Finalize(g, &ret));
+
+  return g;
+}
+
+// B == batch_size, E == embedding_size.
+#define BM_ParseRealisticExample(B, E)                                   \
+  static void BM_ParseRealisticExample##_##B##_##E(int iters) {          \
+    testing::UseRealTime();                                              \
+    testing::ItemsProcessed(static_cast<int64>(iters) * B);              \
+    test::Benchmark("cpu", ParseRealisticExample(B, E)).Run(iters);      \
+  }                                                                      \
+  BENCHMARK(BM_ParseRealisticExample##_##B##_##E);
+
+BM_ParseRealisticExample(128, 64);
+BM_ParseRealisticExample(512, 64);
+BM_ParseRealisticExample(512, 256);
+
 }  // end namespace tensorflow
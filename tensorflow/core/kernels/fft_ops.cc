@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
+#include "tensorflow/core/kernels/gpu_utils.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #endif
 
@@ -287,56 +288,8 @@ gpu::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory) {
   return typed;
 }
 
-template <typename T>
-gpu::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
-  gpu::DeviceMemoryBase wrapped(const_cast<T*>(cuda_memory), size * sizeof(T));
-  gpu::DeviceMemory<T> typed(wrapped);
-  return typed;
-}
-
-// A class to provide scratch-space allocator for Stream-Executor Cufft
-// callback. Tensorflow is responsible for releasing the temporary buffers after
-// the kernel finishes.
-// TODO(yangzihao): Refactor redundant code in subclasses of ScratchAllocator
-// into base class.
-class CufftScratchAllocator : public gpu::ScratchAllocator {
- public:
-  ~CufftScratchAllocator() override {}
-  CufftScratchAllocator(int64 memory_limit, OpKernelContext* context)
-      : memory_limit_(memory_limit), total_byte_size_(0), context_(context) {}
-  int64 GetMemoryLimitInBytes(gpu::Stream* stream) override {
-    return memory_limit_;
-  }
-  gpu::port::StatusOr<gpu::DeviceMemory<uint8>> AllocateBytes(
-      gpu::Stream* stream, int64 byte_size) override {
-    Tensor temporary_memory;
-    if (byte_size > memory_limit_) {
-      return gpu::port::StatusOr<gpu::DeviceMemory<uint8>>();
-    }
-    AllocationAttributes allocation_attr;
-    allocation_attr.no_retry_on_failure = true;
-    Status allocation_status(context_->allocate_temp(
-        DT_UINT8, TensorShape({byte_size}), &temporary_memory,
-        AllocatorAttributes(), allocation_attr));
-    if (!allocation_status.ok()) {
-      return gpu::port::StatusOr<gpu::DeviceMemory<uint8>>();
-    }
-    // Hold the reference of the allocated tensors until the end of the
-    // allocator.
-    allocated_tensors_.push_back(temporary_memory);
-    total_byte_size_ += byte_size;
-    return gpu::port::StatusOr<gpu::DeviceMemory<uint8>>(
-        AsDeviceMemory(temporary_memory.flat<uint8>().data(),
-                       temporary_memory.flat<uint8>().size()));
-  }
-  int64 TotalByteSize() { return total_byte_size_; }
-
- private:
-  int64 memory_limit_;
-  int64 total_byte_size_;
-  OpKernelContext* context_;
-  std::vector<Tensor> allocated_tensors_;
-};
+// The scratch-space allocator for Stream-Executor Cufft callbacks.
+typedef GpuScratchAllocator CufftScratchAllocator;
 
 }  // end namespace
 
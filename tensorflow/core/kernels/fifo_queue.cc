@@ -42,13 +42,34 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
   DCHECK_GT(queues_[0].size(), size_t{0});
   (*tuple).reserve(num_components());
   for (int i = 0; i < num_components(); ++i) {
-    (*tuple).push_back(*queues_[i][0].AccessTensor(ctx));
+    (*tuple).push_back(std::move(*queues_[i][0].AccessTensor(ctx)));
     queues_[i].pop_front();
   }
 }
 
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  // When no other enqueue is waiting and there is room, the element goes in
+  // directly, without registering for cancellation or queueing an attempt.
+  bool enqueued = false;
+  bool dequeues_pending = false;
+  {
+    mutex_lock l(mu_);
+    if (!closed_ && enqueue_attempts_.empty() &&
+        queues_[0].size() < static_cast<size_t>(capacity_)) {
+      for (int i = 0; i < num_components(); ++i) {
+        queues_[i].push_back(PersistentTensor(tuple[i]));
+      }
+      enqueued = true;
+      dequeues_pending = !dequeue_attempts_.empty();
+    }
+  }
+  if (enqueued) {
+    if (dequeues_pending) FlushUnlocked();
+    callback();
+    return;
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -153,6 +174,26 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  // When no other dequeue is waiting and the queue has an element, it is
+  // taken directly, without registering for cancellation or queueing an
+  // attempt.
+  {
+    Tuple tuple;
+    bool enqueues_pending = false;
+    {
+      mutex_lock l(mu_);
+      if (dequeue_attempts_.empty() && !queues_[0].empty()) {
+        DequeueLocked(ctx, &tuple);
+        enqueues_pending = !enqueue_attempts_.empty();
+      }
+    }
+    if (!tuple.empty()) {
+      if (enqueues_pending) FlushUnlocked();
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -0,0 +1,59 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+
+// Returns a graph in which 'num_producers' enqueue ops and as many dequeue
+// ops share one FIFOQueue, so that they contend for it when run in parallel.
+static Graph* EnqueueDequeue(int num_producers, int capacity) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* queue;
+  TF_CHECK_OK(NodeBuilder(g->NewName("queue"), "FIFOQueueV2")
+                  .Attr("component_types", {DT_FLOAT})
+                  .Attr("capacity", capacity)
+                  .Finalize(g, &queue));
+  Tensor value(DT_FLOAT, TensorShape({}));
+  value.scalar<float>()() = 1.0;
+  Node* component = test::graph::Constant(g, value);
+  for (int i = 0; i < num_producers; ++i) {
+    Node* enqueue;
+    TF_CHECK_OK(NodeBuilder(g->NewName("enqueue"), "QueueEnqueueV2")
+                    .Input(queue)
+                    .Input({NodeBuilder::NodeOut(component)})
+                    .Finalize(g, &enqueue));
+    Node* dequeue;
+    TF_CHECK_OK(NodeBuilder(g->NewName("dequeue"), "QueueDequeueV2")
+                    .Input(queue)
+                    .Attr("component_types", {DT_FLOAT})
+                    .Finalize(g, &dequeue));
+  }
+  return g;
+}
+
+// Benchmark 'num_producers' enqueues and dequeues of a scalar, which run
+// concurrently on a pool with one thread per CPU.
+static void BM_FIFOQueueEnqueueDequeue(int iters, int num_producers) {
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_producers);
+  test::Benchmark("cpu", EnqueueDequeue(num_producers, 1000)).Run(iters);
+}
+BENCHMARK(BM_FIFOQueueEnqueueDequeue)->Arg(1)->Arg(8)->Arg(32);
+
+}  // end namespace tensorflow
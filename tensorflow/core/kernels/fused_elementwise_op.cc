@@ -0,0 +1,355 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/fused_elementwise_op.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+
+namespace functor {
+
+namespace {
+
+// The number of elements that a CPU thread takes through the whole chain at
+// once. A block and its operands stay in L1 between the steps, so the chain
+// reads each input and writes the output once, however long it is.
+const int64 kCpuBlockSize = 1024;
+
+template <typename T>
+void ApplyStep(const FusedElementwiseChain<T>& chain, int step, int64 begin,
+               typename TTypes<T>::UnalignedConstVec x,
+               typename TTypes<T>::UnalignedVec y) {
+  const T* operand = chain.operands[step];
+  switch (chain.steps[step]) {
+    case kFusedAdd:
+      if (chain.scalar_operands[step]) {
+        y = x + x.constant(*operand);
+      } else {
+        y = x + typename TTypes<T>::UnalignedConstVec(operand + begin,
+                                                      y.size());
+      }
+      break;
+    case kFusedMul:
+      if (chain.scalar_operands[step]) {
+        y = x * x.constant(*operand);
+      } else {
+        y = x * typename TTypes<T>::UnalignedConstVec(operand + begin,
+                                                      y.size());
+      }
+      break;
+    case kFusedRelu:
+      y = x.cwiseMax(static_cast<T>(0));
+      break;
+    case kFusedTanh:
+      y = x.tanh();
+      break;
+  }
+}
+
+}  // namespace
+
+template <typename T>
+struct FusedElementwise<CPUDevice, T> {
+  void operator()(const CPUDevice& d, const FusedElementwiseChain<T>& chain,
+                  const T* input, int64 size, T* output) {
+    double bytes_loaded = sizeof(T);
+    double compute_cycles = 0;
+    for (int s = 0; s < chain.num_steps; ++s) {
+      if (chain.operands[s] != nullptr && !chain.scalar_operands[s]) {
+        bytes_loaded += sizeof(T);
+      }
+      switch (chain.steps[s]) {
+        case kFusedAdd:
+        case kFusedRelu:
+          compute_cycles += Eigen::TensorOpCost::AddCost<T>();
+          break;
+        case kFusedMul:
+          compute_cycles += Eigen::TensorOpCost::MulCost<T>();
+          break;
+        case kFusedTanh:
+          compute_cycles += Eigen::internal::functor_traits<
+              Eigen::internal::scalar_tanh_op<T>>::Cost;
+          break;
+      }
+    }
+    auto work = [&chain, input, output](int64 start, int64 end) {
+      for (int64 begin = start; begin < end; begin += kCpuBlockSize) {
+        const int64 n = std::min(kCpuBlockSize, end - begin);
+        typename TTypes<T>::UnalignedVec y(output + begin, n);
+        ApplyStep<T>(chain, 0, begin,
+                     typename TTypes<T>::UnalignedConstVec(input + begin, n),
+                     y);
+        for (int s = 1; s < chain.num_steps; ++s) {
+          ApplyStep<T>(chain, s, begin,
+                       typename TTypes<T>::UnalignedConstVec(y.data(), n), y);
+        }
+      }
+    };
+    d.parallelFor(size,
+                  Eigen::TensorOpCost(bytes_loaded, sizeof(T), compute_cycles),
+                  work);
+  }
+};
+
+template <typename T>
+struct BatchedElementwise<CPUDevice, T> {
+  void operator()(const CPUDevice& d, const BatchedElementwiseOps<T>& ops) {
+    for (int i = 0; i < ops.num_ops; ++i) {
+      FusedElementwiseChain<T> chain;
+      chain.num_steps = 1;
+      chain.steps[0] = ops.steps[i];
+      chain.operands[0] = ops.operands[i];
+      chain.scalar_operands[0] = ops.scalar_operands[i];
+      FusedElementwise<CPUDevice, T>()(d, chain, ops.inputs[i],
+                                       ops.offsets[i + 1] - ops.offsets[i],
+                                       ops.outputs[i]);
+    }
+  }
+};
+
+}  // namespace functor
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// Parses one of the ops of a _FusedElementwise or _BatchedElementwise op.
+Status ParseElementwiseStep(const string& op,
+                            functor::FusedElementwiseStep* step,
+                            bool* binary) {
+  *binary = op == "Add" || op == "Mul";
+  if (op == "Add") {
+    *step = functor::kFusedAdd;
+  } else if (op == "Mul") {
+    *step = functor::kFusedMul;
+  } else if (op == "Relu") {
+    *step = functor::kFusedRelu;
+  } else if (op == "Tanh") {
+    *step = functor::kFusedTanh;
+  } else {
+    return errors::InvalidArgument("Unsupported element-wise op ", op);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> ops;
+    OP_REQUIRES_OK(context, context->GetAttr("ops", &ops));
+    OP_REQUIRES(context, ops.size() <= functor::kMaxFusedElementwiseSteps,
+                errors::InvalidArgument(
+                    "_FusedElementwise applies at most ",
+                    functor::kMaxFusedElementwiseSteps, " ops, got ",
+                    ops.size()));
+    int num_operands = 0;
+    for (const string& op : ops) {
+      functor::FusedElementwiseStep step;
+      bool binary;
+      OP_REQUIRES_OK(context, ParseElementwiseStep(op, &step, &binary));
+      steps_.push_back(step);
+      num_operands += binary;
+    }
+    OP_REQUIRES(context, num_operands == context->num_inputs() - 1,
+                errors::InvalidArgument(
+                    "_FusedElementwise has ", context->num_inputs() - 1,
+                    " operands but its ops take ", num_operands));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    functor::FusedElementwiseChain<T> chain;
+    chain.num_steps = steps_.size();
+    int next_operand = 1;
+    for (int s = 0; s < chain.num_steps; ++s) {
+      chain.steps[s] = steps_[s];
+      chain.operands[s] = nullptr;
+      chain.scalar_operands[s] = false;
+      if (steps_[s] != functor::kFusedAdd && steps_[s] != functor::kFusedMul) {
+        continue;
+      }
+      const Tensor& operand = context->input(next_operand++);
+      const bool scalar = TensorShapeUtils::IsScalar(operand.shape());
+      OP_REQUIRES(context, scalar || operand.shape() == x.shape(),
+                  errors::InvalidArgument(
+                      "Operand ", next_operand - 2, " of _FusedElementwise "
+                      "must be a scalar or have the shape of x ",
+                      x.shape().DebugString(), ", got ",
+                      operand.shape().DebugString()));
+      chain.operands[s] = operand.flat<T>().data();
+      chain.scalar_operands[s] = scalar;
+    }
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+    functor::FusedElementwise<Device, T>()(
+        context->eigen_device<Device>(), chain, x.flat<T>().data(),
+        x.NumElements(), y->flat<T>().data());
+  }
+
+ private:
+  std::vector<functor::FusedElementwiseStep> steps_;
+};
+
+#define REGISTER_KERNEL(T)                                                  \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
+template <typename Device, typename T>
+class BatchedElementwiseOp : public OpKernel {
+ public:
+  explicit BatchedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> ops;
+    OP_REQUIRES_OK(context, context->GetAttr("ops", &ops));
+    int num_ops = 0;
+    OP_REQUIRES_OK(context, context->GetAttr("N", &num_ops));
+    OP_REQUIRES(context, ops.size() == num_ops,
+                errors::InvalidArgument("_BatchedElementwise has ", num_ops,
+                                        " inputs but ", ops.size(), " ops"));
+    OP_REQUIRES(context, num_ops <= functor::kMaxBatchedElementwiseOps,
+                errors::InvalidArgument(
+                    "_BatchedElementwise applies at most ",
+                    functor::kMaxBatchedElementwiseOps, " ops, got ", num_ops));
+    int num_operands = 0;
+    for (const string& op : ops) {
+      functor::FusedElementwiseStep step;
+      bool binary;
+      OP_REQUIRES_OK(context, ParseElementwiseStep(op, &step, &binary));
+      steps_.push_back(step);
+      binary_.push_back(binary);
+      num_operands += binary;
+    }
+    OP_REQUIRES(context, num_operands == context->num_inputs() - num_ops,
+                errors::InvalidArgument(
+                    "_BatchedElementwise has ", context->num_inputs() - num_ops,
+                    " operands but its ops take ", num_operands));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const int num_ops = steps_.size();
+    functor::BatchedElementwiseOps<T> ops;
+    ops.num_ops = num_ops;
+    ops.offsets[0] = 0;
+    int next_operand = num_ops;
+    for (int i = 0; i < num_ops; ++i) {
+      const Tensor& x = context->input(i);
+      ops.steps[i] = steps_[i];
+      ops.inputs[i] = x.flat<T>().data();
+      ops.operands[i] = nullptr;
+      ops.scalar_operands[i] = false;
+      if (binary_[i]) {
+        const Tensor& operand = context->input(next_operand++);
+        const bool scalar = TensorShapeUtils::IsScalar(operand.shape());
+        OP_REQUIRES(context, scalar || operand.shape() == x.shape(),
+                    errors::InvalidArgument(
+                        "The operand of op ", i, " of _BatchedElementwise "
+                        "must be a scalar or have the shape of its input ",
+                        x.shape().DebugString(), ", got ",
+                        operand.shape().DebugString()));
+        ops.operands[i] = operand.flat<T>().data();
+        ops.scalar_operands[i] = scalar;
+      }
+      OP_REQUIRES(
+          context,
+          ops.offsets[i] + x.NumElements() <= std::numeric_limits<int>::max(),
+          errors::InvalidArgument("_BatchedElementwise inputs are too large"));
+      ops.offsets[i + 1] = ops.offsets[i] + x.NumElements();
+
+      Tensor* y = nullptr;
+      OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                  {i}, i, x.shape(), &y));
+      ops.outputs[i] = y->flat<T>().data();
+    }
+    if (ops.offsets[num_ops] == 0) return;
+    functor::BatchedElementwise<Device, T>()(context->eigen_device<Device>(),
+                                             ops);
+  }
+
+ private:
+  std::vector<functor::FusedElementwiseStep> steps_;
+  std::vector<bool> binary_;
+};
+
+#define REGISTER_KERNEL(T)                                                    \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("_BatchedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      BatchedElementwiseOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+#undef REGISTER_KERNEL
+
+#if GOOGLE_CUDA
+
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                 \
+  template <>                                                               \
+  void FusedElementwise<GPUDevice, T>::operator()(                          \
+      const GPUDevice& d, const FusedElementwiseChain<T>& chain,            \
+      const T* input, int64 size, T* output);                               \
+  extern template struct FusedElementwise<GPUDevice, T>;                    \
+  template <>                                                               \
+  void BatchedElementwise<GPUDevice, T>::operator()(                        \
+      const GPUDevice& d, const BatchedElementwiseOps<T>& ops);             \
+  extern template struct BatchedElementwise<GPUDevice, T>;
+
+TF_CALL_float(DECLARE_GPU_SPEC);
+TF_CALL_double(DECLARE_GPU_SPEC);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+#define REGISTER_GPU_KERNEL(T)                                              \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedElementwise").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<GPUDevice, T>);                                    \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_BatchedElementwise").Device(DEVICE_GPU).TypeConstraint<T>("T"), \
+      BatchedElementwiseOp<GPUDevice, T>);
+
+TF_CALL_float(REGISTER_GPU_KERNEL);
+TF_CALL_double(REGISTER_GPU_KERNEL);
+#undef REGISTER_GPU_KERNEL
+
+#endif  // GOOGLE_CUDA
+
+}  // namespace tensorflow
@@ -0,0 +1,84 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_FUSED_ELEMENTWISE_OP_H_
+#define TENSORFLOW_KERNELS_FUSED_ELEMENTWISE_OP_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace functor {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+enum FusedElementwiseStep { kFusedAdd, kFusedMul, kFusedRelu, kFusedTanh };
+
+// The longest chain that a _FusedElementwise op can apply. The chain is
+// passed by value to the GPU kernel, so it has a fixed size.
+constexpr int kMaxFusedElementwiseSteps = 16;
+
+template <typename T>
+struct FusedElementwiseChain {
+  int num_steps = 0;
+  FusedElementwiseStep steps[kMaxFusedElementwiseSteps];
+  // The second argument of each binary step, null for the unary steps.
+  const T* operands[kMaxFusedElementwiseSteps];
+  // Whether the operand of the step is a scalar rather than a tensor of
+  // "size" elements.
+  bool scalar_operands[kMaxFusedElementwiseSteps];
+};
+
+// Sets output[i] to the result of "chain" applied to input[i], for i in
+// [0, size). "output" may be "input".
+template <typename Device, typename T>
+struct FusedElementwise {
+  void operator()(const Device& d, const FusedElementwiseChain<T>& chain,
+                  const T* input, int64 size, T* output);
+};
+
+// The most ops that a _BatchedElementwise op applies at once. The ops are
+// passed by value to the GPU kernel, so there is a fixed number of them.
+constexpr int kMaxBatchedElementwiseOps = 32;
+
+// Independent single-step element-wise ops, each with its own input and
+// output.
+template <typename T>
+struct BatchedElementwiseOps {
+  int num_ops = 0;
+  FusedElementwiseStep steps[kMaxBatchedElementwiseOps];
+  const T* inputs[kMaxBatchedElementwiseOps];
+  // The second argument of each binary op, null for the unary ops.
+  const T* operands[kMaxBatchedElementwiseOps];
+  bool scalar_operands[kMaxBatchedElementwiseOps];
+  T* outputs[kMaxBatchedElementwiseOps];
+  // Op i covers the elements [offsets[i], offsets[i + 1]) of the batch.
+  int offsets[kMaxBatchedElementwiseOps + 1];
+};
+
+// Applies every op of "ops". The GPU version runs all of them in one kernel
+// launch.
+template <typename Device, typename T>
+struct BatchedElementwise {
+  void operator()(const Device& d, const BatchedElementwiseOps<T>& ops);
+};
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_FUSED_ELEMENTWISE_OP_H_
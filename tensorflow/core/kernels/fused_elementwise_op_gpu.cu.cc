@@ -0,0 +1,114 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/fused_elementwise_op.h"
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+// Each thread keeps its element in a register through the whole chain.
+template <typename T>
+__global__ void FusedElementwiseKernel(const int size,
+                                       const FusedElementwiseChain<T> chain,
+                                       const T* input, T* output) {
+  CUDA_1D_KERNEL_LOOP(i, size) {
+    T x = ldg(input + i);
+    for (int s = 0; s < chain.num_steps; ++s) {
+      switch (chain.steps[s]) {
+        case kFusedAdd:
+          x += ldg(chain.operands[s] + (chain.scalar_operands[s] ? 0 : i));
+          break;
+        case kFusedMul:
+          x *= ldg(chain.operands[s] + (chain.scalar_operands[s] ? 0 : i));
+          break;
+        case kFusedRelu:
+          x = x < static_cast<T>(0) ? static_cast<T>(0) : x;
+          break;
+        case kFusedTanh:
+          x = tanh(x);
+          break;
+      }
+    }
+    output[i] = x;
+  }
+}
+
+// Each thread finds the op of its element of the batch, then applies it.
+template <typename T>
+__global__ void BatchedElementwiseKernel(const BatchedElementwiseOps<T> ops) {
+  CUDA_1D_KERNEL_LOOP(i, ops.offsets[ops.num_ops]) {
+    int op = 0;
+    while (i >= ops.offsets[op + 1]) ++op;
+    const int j = i - ops.offsets[op];
+    T x = ldg(ops.inputs[op] + j);
+    switch (ops.steps[op]) {
+      case kFusedAdd:
+        x += ldg(ops.operands[op] + (ops.scalar_operands[op] ? 0 : j));
+        break;
+      case kFusedMul:
+        x *= ldg(ops.operands[op] + (ops.scalar_operands[op] ? 0 : j));
+        break;
+      case kFusedRelu:
+        x = x < static_cast<T>(0) ? static_cast<T>(0) : x;
+        break;
+      case kFusedTanh:
+        x = tanh(x);
+        break;
+    }
+    ops.outputs[op][j] = x;
+  }
+}
+
+#define DEFINE_GPU_SPEC(T)                                                 \
+  template <>                                                              \
+  void FusedElementwise<GPUDevice, T>::operator()(                         \
+      const GPUDevice& d, const FusedElementwiseChain<T>& chain,           \
+      const T* input, int64 size, T* output) {                             \
+    CudaLaunchConfig config = GetCudaLaunchConfig(size, d);                \
+    FusedElementwiseKernel<T>                                              \
+        <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(  \
+            size, chain, input, output);                                   \
+  }                                                                        \
+  template <>                                                              \
+  void BatchedElementwise<GPUDevice, T>::operator()(                       \
+      const GPUDevice& d, const BatchedElementwiseOps<T>& ops) {           \
+    CudaLaunchConfig config =                                              \
+        GetCudaLaunchConfig(ops.offsets[ops.num_ops], d);                  \
+    BatchedElementwiseKernel<T>                                            \
+        <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(  \
+            ops);                                                          \
+  }
+
+TF_CALL_float(DEFINE_GPU_SPEC);
+TF_CALL_double(DEFINE_GPU_SPEC);
+
+#undef DEFINE_GPU_SPEC
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
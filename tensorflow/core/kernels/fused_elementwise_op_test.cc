@@ -0,0 +1,136 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_operands, const std::vector<string>& ops) {
+    TF_CHECK_OK(NodeDefBuilder("fused", "_FusedElementwise")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(num_operands, DT_FLOAT))
+                    .Attr("ops", ops)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, Chain) {
+  // Large enough to be split into several blocks and shards.
+  const int kSize = 10000;
+  TF_ASSERT_OK(MakeOp(2, {"Add", "Relu", "Mul", "Tanh"}));
+  std::vector<float> x(kSize);
+  std::vector<float> y(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    x[i] = (i % 41) * 0.1f - 2.0f;
+    y[i] = (i % 7) * 0.25f - 1.0f;
+  }
+  AddInputFromArray<float>(TensorShape({kSize}), x);
+  AddInputFromArray<float>(TensorShape({kSize}), y);
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({kSize}));
+  auto expected_flat = expected.flat<float>();
+  for (int i = 0; i < kSize; ++i) {
+    expected_flat(i) = std::tanh(std::max(x[i] + y[i], 0.0f) * 0.5f);
+  }
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(FusedElementwiseOpTest, UnaryOnly) {
+  TF_ASSERT_OK(MakeOp(0, {"Relu", "Tanh"}));
+  AddInputFromArray<float>(TensorShape({2, 2}), {-1.0f, 0.0f, 1.0f, 2.0f});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({0.0f, 0.0f, std::tanh(1.0f), std::tanh(2.0f)},
+                            {2, 2}),
+      *GetOutput(0), 1e-6);
+}
+
+TEST_F(FusedElementwiseOpTest, OperandShapeMismatch) {
+  TF_ASSERT_OK(MakeOp(1, {"Add"}));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  Status s = RunOpKernel();
+  EXPECT_EQ(error::INVALID_ARGUMENT, s.code()) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, BadOps) {
+  EXPECT_FALSE(MakeOp(1, {"Sub"}).ok());
+  EXPECT_FALSE(MakeOp(0, {"Add"}).ok());
+}
+
+class BatchedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status MakeOp(int num_operands, const std::vector<string>& ops) {
+    TF_CHECK_OK(NodeDefBuilder("batched", "_BatchedElementwise")
+                    .Input(FakeInput(ops.size(), DT_FLOAT))
+                    .Input(FakeInput(num_operands, DT_FLOAT))
+                    .Attr("ops", ops)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(BatchedElementwiseOpTest, AppliesEachOp) {
+  TF_ASSERT_OK(MakeOp(2, {"Add", "Tanh", "Mul", "Relu"}));
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {-1, 1});
+  AddInputFromArray<float>(TensorShape({3}), {10, 20, 30});
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 2, 2, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(test::AsTensor<float>({11, 22, 33}, {3}),
+                                *GetOutput(0), 1e-6);
+  test::ExpectTensorNear<float>(test::AsTensor<float>({std::tanh(0.5f)}, {}),
+                                *GetOutput(1), 1e-6);
+  test::ExpectTensorNear<float>(test::AsTensor<float>({2, 4, 6, 8}, {2, 2}),
+                                *GetOutput(2), 1e-6);
+  test::ExpectTensorNear<float>(test::AsTensor<float>({0, 1}, {2}),
+                                *GetOutput(3), 1e-6);
+}
+
+TEST_F(BatchedElementwiseOpTest, OperandShapeMismatch) {
+  TF_ASSERT_OK(MakeOp(1, {"Relu", "Add"}));
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  Status s = RunOpKernel();
+  EXPECT_EQ(error::INVALID_ARGUMENT, s.code()) << s;
+}
+
+TEST_F(BatchedElementwiseOpTest, BadOps) {
+  EXPECT_FALSE(MakeOp(1, {"Sub"}).ok());
+  EXPECT_FALSE(MakeOp(0, {"Relu", "Add"}).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
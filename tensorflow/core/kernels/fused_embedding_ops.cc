@@ -0,0 +1,470 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+#if GOOGLE_CUDA
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA
+
+#include "tensorflow/core/kernels/fused_embedding_ops.h"
+
+#include <cmath>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/kernels/cuda_solvers.h"
+#include "tensorflow/core/platform/cuda.h"
+
+using ::perftools::gputools::cuda::ScopedActivateExecutorContext;
+#endif  // GOOGLE_CUDA
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+Status GetCombiner(OpKernelConstruction* context,
+                   EmbeddingCombiner* combiner) {
+  string name;
+  TF_RETURN_IF_ERROR(context->GetAttr("combiner", &name));
+  if (name == "sum") {
+    *combiner = EmbeddingCombiner::kSum;
+  } else if (name == "mean") {
+    *combiner = EmbeddingCombiner::kMean;
+  } else if (name == "sqrtn") {
+    *combiner = EmbeddingCombiner::kSqrtN;
+  } else {
+    return errors::InvalidArgument("Unknown combiner: ", name);
+  }
+  return Status::OK();
+}
+
+// Checks that "segment_ids" is a vector, and that "weights" is a vector of
+// the same size or empty.
+Status ValidateSegmentIdsAndWeights(const Tensor& segment_ids,
+                                    const Tensor& weights) {
+  if (!TensorShapeUtils::IsVector(segment_ids.shape())) {
+    return errors::InvalidArgument("segment_ids should be a vector.");
+  }
+  if (!TensorShapeUtils::IsVector(weights.shape())) {
+    return errors::InvalidArgument("weights should be a vector.");
+  }
+  if (weights.NumElements() != 0 &&
+      weights.NumElements() != segment_ids.NumElements()) {
+    return errors::InvalidArgument(
+        "weights should be empty or have the same size as segment_ids, but "
+        "got ",
+        weights.NumElements(), " weights for ", segment_ids.NumElements(),
+        " segment ids.");
+  }
+  return Status::OK();
+}
+
+// Returns what the sum of the rows of a segment is divided by, given the sum
+// of their weights (or of their squares for sqrtn).
+template <typename T>
+T Divisor(EmbeddingCombiner combiner, T normalizer) {
+  if (combiner == EmbeddingCombiner::kSum || normalizer == T(0)) {
+    return T(1);
+  }
+  if (combiner == EmbeddingCombiner::kMean) {
+    return normalizer;
+  }
+  return std::sqrt(normalizer);
+}
+
+}  // namespace
+
+template <typename T, typename Index>
+class FusedEmbeddingLookupSparseOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingLookupSparseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params = context->input(0);
+    const Tensor& ids = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& weights = context->input(3);
+
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids should be a vector."));
+    OP_REQUIRES_OK(context, ValidateSegmentIdsAndWeights(segment_ids, weights));
+    const int64 num_ids = ids.NumElements();
+    OP_REQUIRES(
+        context, num_ids == segment_ids.NumElements(),
+        errors::InvalidArgument("segment_ids and ids should have same size."));
+
+    const auto ids_vec = ids.vec<Index>();
+    const auto segment_vec = segment_ids.vec<int32>();
+    const int32 num_segments =
+        num_ids > 0 ? internal::SubtleMustCopy(segment_vec(num_ids - 1)) + 1
+                    : 0;
+    OP_REQUIRES(context, num_segments >= 0,
+                errors::InvalidArgument("segment ids must be >= 0"));
+
+    // The ids of segment s are ids[segment_starts[s]:segment_starts[s + 1]].
+    const int64 num_rows = params.dim_size(0);
+    std::vector<int64> segment_starts(num_segments + 1);
+    int32 next_segment = 0;
+    int32 previous_segment = 0;
+    for (int64 i = 0; i < num_ids; ++i) {
+      const int32 segment = internal::SubtleMustCopy(segment_vec(i));
+      OP_REQUIRES(context, segment >= 0,
+                  errors::InvalidArgument("segment ids must be >= 0"));
+      OP_REQUIRES(context, segment >= previous_segment,
+                  errors::InvalidArgument("segment ids are not increasing"));
+      previous_segment = segment;
+      for (; next_segment <= segment; ++next_segment) {
+        segment_starts[next_segment] = i;
+      }
+      const Index id = internal::SubtleMustCopy(ids_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(id, num_rows),
+                  errors::InvalidArgument("ids[", i, "] = ", id,
+                                          " is not in [0, ", num_rows, ")"));
+    }
+    for (; next_segment <= num_segments; ++next_segment) {
+      segment_starts[next_segment] = num_ids;
+    }
+
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, num_segments);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    const auto params_flat = params.flat_outer_dims<T>();
+    auto output_flat = output->flat_outer_dims<T>();
+    const int64 dim = params_flat.dimension(1);
+    const T* weights_data =
+        weights.NumElements() > 0 ? weights.flat<T>().data() : nullptr;
+    const EmbeddingCombiner combiner = combiner_;
+
+    // Each row of params is added into its output row as it is read, so the
+    // gathered rows are never materialized. Eigen vectorizes the adds.
+    typedef Eigen::Array<T, Eigen::Dynamic, 1> Row;
+    auto combine = [&](int64 begin, int64 end) {
+      for (int64 segment = begin; segment < end; ++segment) {
+        Eigen::Map<Row> out(output_flat.data() + segment * dim, dim);
+        out.setZero();
+        T normalizer(0);
+        for (int64 i = segment_starts[segment];
+             i < segment_starts[segment + 1]; ++i) {
+          Eigen::Map<const Row> row(
+              params_flat.data() + static_cast<int64>(ids_vec(i)) * dim, dim);
+          if (weights_data == nullptr) {
+            out += row;
+            normalizer += T(1);
+          } else {
+            const T weight = weights_data[i];
+            out += weight * row;
+            normalizer += combiner == EmbeddingCombiner::kSqrtN
+                              ? weight * weight
+                              : weight;
+          }
+        }
+        const T divisor = Divisor(combiner, normalizer);
+        if (divisor != T(1)) {
+          out /= divisor;
+        }
+      }
+    };
+    const int64 cost_per_segment = (num_ids / num_segments + 1) * dim * 2;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, combine);
+  }
+
+ private:
+  EmbeddingCombiner combiner_;
+};
+
+template <typename T>
+class FusedEmbeddingLookupSparseGradOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingLookupSparseGradOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& grad = context->input(0);
+    const Tensor& segment_ids = context->input(1);
+    const Tensor& weights = context->input(2);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(grad.shape()),
+                errors::InvalidArgument("grad must be at least 1 dimensional"));
+    OP_REQUIRES_OK(context, ValidateSegmentIdsAndWeights(segment_ids, weights));
+
+    const int64 num_ids = segment_ids.NumElements();
+    const int64 num_segments = grad.dim_size(0);
+    const auto segment_vec = segment_ids.vec<int32>();
+    const T* weights_data =
+        weights.NumElements() > 0 ? weights.flat<T>().data() : nullptr;
+
+    // Compute the scaling factor of each segment.
+    std::vector<T> scales(num_segments, T(0));
+    for (int64 i = 0; i < num_ids; ++i) {
+      const int32 segment = internal::SubtleMustCopy(segment_vec(i));
+      OP_REQUIRES(
+          context, FastBoundsCheck(segment, num_segments),
+          errors::InvalidArgument("Segment id ", segment, " out of range [0, ",
+                                  num_segments, ")."));
+      if (weights_data == nullptr) {
+        scales[segment] += T(1);
+      } else if (combiner_ == EmbeddingCombiner::kSqrtN) {
+        scales[segment] += weights_data[i] * weights_data[i];
+      } else {
+        scales[segment] += weights_data[i];
+      }
+    }
+    for (T& scale : scales) {
+      scale = T(1) / Divisor(combiner_, scale);
+    }
+
+    TensorShape output_shape = grad.shape();
+    output_shape.set_dim(0, num_ids);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    const auto grad_flat = grad.flat_outer_dims<T>();
+    auto output_flat = output->flat_outer_dims<T>();
+    const int64 dim = grad_flat.dimension(1);
+
+    typedef Eigen::Array<T, Eigen::Dynamic, 1> Row;
+    auto scatter = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        const int32 segment = segment_vec(i);
+        T scale = scales[segment];
+        if (weights_data != nullptr) {
+          scale *= weights_data[i];
+        }
+        Eigen::Map<Row> out(output_flat.data() + i * dim, dim);
+        Eigen::Map<const Row> in(grad_flat.data() + segment * dim, dim);
+        out = in * scale;
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_ids, dim,
+          scatter);
+  }
+
+ private:
+  EmbeddingCombiner combiner_;
+};
+
+#define REGISTER_CPU_KERNELS(type)                                      \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookupSparse")            \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<type>("T")                \
+                              .TypeConstraint<int32>("Tidx"),           \
+                          FusedEmbeddingLookupSparseOp<type, int32>);   \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookupSparse")            \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<type>("T")                \
+                              .TypeConstraint<int64>("Tidx"),           \
+                          FusedEmbeddingLookupSparseOp<type, int64>);   \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookupSparseGrad")        \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<type>("T"),               \
+                          FusedEmbeddingLookupSparseGradOp<type>);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
+#if GOOGLE_CUDA
+
+// The GPU kernel copies the last segment id to the host to find the number of
+// output rows, like SegmentSumGPUOp. It does not check that the segment ids
+// are sorted, or that the ids are in range.
+template <typename T, typename Index>
+class FusedEmbeddingLookupSparseGPUOp : public AsyncOpKernel {
+ public:
+  explicit FusedEmbeddingLookupSparseGPUOp(OpKernelConstruction* context)
+      : AsyncOpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    const Tensor& params = context->input(0);
+    const Tensor& ids = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& weights = context->input(3);
+
+    OP_REQUIRES_ASYNC(
+        context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"),
+        done);
+    OP_REQUIRES_ASYNC(context, TensorShapeUtils::IsVector(ids.shape()),
+                      errors::InvalidArgument("ids should be a vector."), done);
+    OP_REQUIRES_OK_ASYNC(
+        context, ValidateSegmentIdsAndWeights(segment_ids, weights), done);
+    const int64 num_ids = ids.NumElements();
+    OP_REQUIRES_ASYNC(
+        context, num_ids == segment_ids.NumElements(),
+        errors::InvalidArgument("segment_ids and ids should have same size."),
+        done);
+
+    if (num_ids == 0) {
+      TensorShape output_shape = params.shape();
+      output_shape.set_dim(0, 0);
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context, context->allocate_output(0, output_shape, &output), done);
+      done();
+      return;
+    }
+
+    perftools::gputools::DeviceMemoryBase last_segment_id_device(
+        const_cast<Tensor&>(segment_ids).flat<int32>().data() + (num_ids - 1));
+    ScratchSpace<int32> last_segment_id_host(context, 1, /* on_host */ true);
+
+    auto stream = context->op_device_context()->stream();
+    OP_REQUIRES_ASYNC(
+        context,
+        stream
+            ->ThenMemcpy(last_segment_id_host.mutable_data(),
+                         last_segment_id_device, sizeof(int32))
+            .ok(),
+        errors::Internal("FusedEmbeddingLookupSparseGPUOp: failed to copy the "
+                         "last segment id from device"),
+        done);
+
+    auto combine = [this, context, last_segment_id_host, done]() {
+      // Ensure that within the callback, the proper GPU settings are
+      // configured.
+      auto stream = context->op_device_context()->stream();
+      ScopedActivateExecutorContext scoped_activation{stream->parent()};
+
+      const Tensor& params = context->input(0);
+      const Tensor& ids = context->input(1);
+      const Tensor& segment_ids = context->input(2);
+      const Tensor& weights = context->input(3);
+      const int32 num_segments = *last_segment_id_host.data() + 1;
+      OP_REQUIRES_ASYNC(context, num_segments > 0,
+                        errors::InvalidArgument("segment ids must be >= 0"),
+                        done);
+
+      TensorShape output_shape = params.shape();
+      output_shape.set_dim(0, num_segments);
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context, context->allocate_output(0, output_shape, &output), done);
+      Tensor normalizers;
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          context->allocate_temp(DataTypeToEnum<T>::value,
+                                 TensorShape({num_segments}), &normalizers),
+          done);
+
+      if (output->NumElements() > 0) {
+        functor::FusedEmbeddingLookupSparseFunctor<T, Index>()(
+            context->eigen_device<GPUDevice>(), combiner_,
+            params.flat_outer_dims<T>(), ids.vec<Index>(),
+            segment_ids.vec<int32>(),
+            weights.NumElements() > 0 ? weights.flat<T>().data() : nullptr,
+            normalizers.vec<T>(), output->flat_outer_dims<T>());
+      }
+      done();
+    };
+
+    context->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        stream, combine);
+  }
+
+ private:
+  EmbeddingCombiner combiner_;
+};
+
+template <typename T>
+class FusedEmbeddingLookupSparseGradGPUOp : public OpKernel {
+ public:
+  explicit FusedEmbeddingLookupSparseGradGPUOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetCombiner(context, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& grad = context->input(0);
+    const Tensor& segment_ids = context->input(1);
+    const Tensor& weights = context->input(2);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(grad.shape()),
+                errors::InvalidArgument("grad must be at least 1 dimensional"));
+    OP_REQUIRES_OK(context, ValidateSegmentIdsAndWeights(segment_ids, weights));
+
+    TensorShape output_shape = grad.shape();
+    output_shape.set_dim(0, segment_ids.NumElements());
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    Tensor normalizers;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DataTypeToEnum<T>::value,
+                                TensorShape({grad.dim_size(0)}), &normalizers));
+    functor::FusedEmbeddingLookupSparseGradFunctor<T>()(
+        context->eigen_device<GPUDevice>(), combiner_,
+        grad.flat_outer_dims<T>(), segment_ids.vec<int32>(),
+        weights.NumElements() > 0 ? weights.flat<T>().data() : nullptr,
+        normalizers.vec<T>(), output->flat_outer_dims<T>());
+  }
+
+ private:
+  EmbeddingCombiner combiner_;
+};
+
+#define REGISTER_GPU_KERNELS(type)                                       \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookupSparse")             \
+                              .Device(DEVICE_GPU)                        \
+                              .TypeConstraint<type>("T")                 \
+                              .TypeConstraint<int32>("Tidx"),            \
+                          FusedEmbeddingLookupSparseGPUOp<type, int32>); \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookupSparse")             \
+                              .Device(DEVICE_GPU)                        \
+                              .TypeConstraint<type>("T")                 \
+                              .TypeConstraint<int64>("Tidx"),            \
+                          FusedEmbeddingLookupSparseGPUOp<type, int64>); \
+  REGISTER_KERNEL_BUILDER(Name("FusedEmbeddingLookupSparseGrad")         \
+                              .Device(DEVICE_GPU)                        \
+                              .TypeConstraint<type>("T"),                \
+                          FusedEmbeddingLookupSparseGradGPUOp<type>);
+TF_CALL_float(REGISTER_GPU_KERNELS);
+TF_CALL_double(REGISTER_GPU_KERNELS);
+#undef REGISTER_GPU_KERNELS
+
+#endif  // GOOGLE_CUDA
+
+}  // namespace tensorflow
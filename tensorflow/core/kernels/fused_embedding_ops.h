@@ -0,0 +1,69 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_EMBEDDING_OPS_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_EMBEDDING_OPS_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// How FusedEmbeddingLookupSparse combines the rows of a segment.
+enum class EmbeddingCombiner { kSum, kMean, kSqrtN };
+
+namespace functor {
+
+#ifdef GOOGLE_CUDA
+typedef Eigen::GpuDevice GPUDevice;
+
+// Functor for the GPU kernel of FusedEmbeddingLookupSparse.
+// params: the embeddings, reshaped to {rows, dim}.
+// ids: the row of params of each entry.
+// segment_ids: the output row of each entry.
+// weights: the weight of each entry, or nullptr for unit weights.
+// normalizers: scratch space of one element per output row.
+// output: output reshaped to {output_rows, dim}.
+template <typename T, typename Index>
+struct FusedEmbeddingLookupSparseFunctor {
+  void operator()(const GPUDevice& d, EmbeddingCombiner combiner,
+                  typename TTypes<T>::ConstMatrix params,
+                  typename TTypes<Index>::ConstVec ids,
+                  typename TTypes<int32>::ConstVec segment_ids,
+                  const T* weights, typename TTypes<T>::Vec normalizers,
+                  typename TTypes<T>::Matrix output);
+};
+
+// Functor for the GPU kernel of FusedEmbeddingLookupSparseGrad.
+// grad: the gradient of the output, reshaped to {output_rows, dim}.
+// segment_ids: the output row of each entry.
+// weights: the weight of each entry, or nullptr for unit weights.
+// normalizers: scratch space of one element per output row.
+// output: the gradient of each entry, reshaped to {entries, dim}.
+template <typename T>
+struct FusedEmbeddingLookupSparseGradFunctor {
+  void operator()(const GPUDevice& d, EmbeddingCombiner combiner,
+                  typename TTypes<T>::ConstMatrix grad,
+                  typename TTypes<int32>::ConstVec segment_ids,
+                  const T* weights, typename TTypes<T>::Vec normalizers,
+                  typename TTypes<T>::Matrix output);
+};
+#endif  // GOOGLE_CUDA
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_EMBEDDING_OPS_H_
@@ -0,0 +1,202 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/fused_embedding_ops.h"
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
+
+namespace tensorflow {
+
+using GPUDevice = Eigen::GpuDevice;
+
+namespace {
+
+// Adds the weight of each entry (or its square for sqrtn) into the normalizer
+// of its segment.
+template <typename T>
+__global__ void AccumulateNormalizersKernel(const int32 num_ids,
+                                            const EmbeddingCombiner combiner,
+                                            const int32* segment_ids,
+                                            const T* weights,
+                                            const int32 num_segments,
+                                            T* normalizers) {
+  CUDA_1D_KERNEL_LOOP(i, num_ids) {
+    const int32 segment = ldg(segment_ids + i);
+    if (segment < 0 || segment >= num_segments) {
+      continue;
+    }
+    T value = T(1);
+    if (weights != nullptr) {
+      value = ldg(weights + i);
+      if (combiner == EmbeddingCombiner::kSqrtN) {
+        value *= value;
+      }
+    }
+    CudaAtomicAdd(normalizers + segment, value);
+  }
+}
+
+// Returns the factor the rows of a segment are scaled by.
+template <typename T>
+__device__ __forceinline__ T SegmentScale(const EmbeddingCombiner combiner,
+                                          const T normalizer) {
+  if (combiner == EmbeddingCombiner::kSum || normalizer == T(0)) {
+    return T(1);
+  }
+  if (combiner == EmbeddingCombiner::kMean) {
+    return T(1) / normalizer;
+  }
+  return T(1) / sqrt(normalizer);
+}
+
+// Each thread adds one element of a looked up row into its output row.
+template <typename T, typename Index>
+__global__ void FusedEmbeddingLookupSparseKernel(
+    const int32 total_size, const int32 dim, const EmbeddingCombiner combiner,
+    const T* params, const Index num_rows, const Index* ids,
+    const int32* segment_ids, const T* weights, const T* normalizers,
+    const int32 num_segments, T* output) {
+  CUDA_1D_KERNEL_LOOP(index, total_size) {
+    const int32 i = index / dim;
+    const int32 offset = index % dim;
+    const Index id = ldg(ids + i);
+    const int32 segment = ldg(segment_ids + i);
+    if (id < 0 || id >= num_rows || segment < 0 || segment >= num_segments) {
+      continue;
+    }
+    T value = ldg(params + id * dim + offset) *
+              SegmentScale(combiner, ldg(normalizers + segment));
+    if (weights != nullptr) {
+      value *= ldg(weights + i);
+    }
+    CudaAtomicAdd(output + segment * dim + offset, value);
+  }
+}
+
+// Each thread computes one element of the gradient of a looked up row.
+template <typename T>
+__global__ void FusedEmbeddingLookupSparseGradKernel(
+    const int32 total_size, const int32 dim, const EmbeddingCombiner combiner,
+    const T* grad, const int32* segment_ids, const T* weights,
+    const T* normalizers, const int32 num_segments, T* output) {
+  CUDA_1D_KERNEL_LOOP(index, total_size) {
+    const int32 i = index / dim;
+    const int32 offset = index % dim;
+    const int32 segment = ldg(segment_ids + i);
+    if (segment < 0 || segment >= num_segments) {
+      output[index] = T(0);
+      continue;
+    }
+    T value = ldg(grad + segment * dim + offset) *
+              SegmentScale(combiner, ldg(normalizers + segment));
+    if (weights != nullptr) {
+      value *= ldg(weights + i);
+    }
+    output[index] = value;
+  }
+}
+
+// Sets "normalizers" to the normalizer of each segment, if the combiner
+// needs them.
+template <typename T>
+void ComputeNormalizers(const GPUDevice& d, const EmbeddingCombiner combiner,
+                        typename TTypes<int32>::ConstVec segment_ids,
+                        const T* weights, typename TTypes<T>::Vec normalizers) {
+  const int32 num_segments = normalizers.size();
+  if (num_segments == 0) {
+    return;
+  }
+  CudaLaunchConfig config = GetCudaLaunchConfig(num_segments, d);
+  SetZero<<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+      num_segments, normalizers.data());
+  if (combiner == EmbeddingCombiner::kSum || segment_ids.size() == 0) {
+    return;
+  }
+  config = GetCudaLaunchConfig(segment_ids.size(), d);
+  AccumulateNormalizersKernel<T>
+      <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+          segment_ids.size(), combiner, segment_ids.data(), weights,
+          num_segments, normalizers.data());
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T, typename Index>
+void FusedEmbeddingLookupSparseFunctor<T, Index>::operator()(
+    const GPUDevice& d, EmbeddingCombiner combiner,
+    typename TTypes<T>::ConstMatrix params,
+    typename TTypes<Index>::ConstVec ids,
+    typename TTypes<int32>::ConstVec segment_ids, const T* weights,
+    typename TTypes<T>::Vec normalizers, typename TTypes<T>::Matrix output) {
+  // Set 'output' to zeros.
+  CudaLaunchConfig config = GetCudaLaunchConfig(output.size(), d);
+  SetZero<<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+      output.size(), output.data());
+  ComputeNormalizers<T>(d, combiner, segment_ids, weights, normalizers);
+
+  const int32 dim = params.dimension(1);
+  const int32 total_size = ids.size() * dim;
+  if (total_size == 0) {
+    return;
+  }
+  config = GetCudaLaunchConfig(total_size, d);
+  FusedEmbeddingLookupSparseKernel<T, Index>
+      <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+          total_size, dim, combiner, params.data(), params.dimension(0),
+          ids.data(), segment_ids.data(), weights, normalizers.data(),
+          output.dimension(0), output.data());
+}
+
+template <typename T>
+void FusedEmbeddingLookupSparseGradFunctor<T>::operator()(
+    const GPUDevice& d, EmbeddingCombiner combiner,
+    typename TTypes<T>::ConstMatrix grad,
+    typename TTypes<int32>::ConstVec segment_ids, const T* weights,
+    typename TTypes<T>::Vec normalizers, typename TTypes<T>::Matrix output) {
+  ComputeNormalizers<T>(d, combiner, segment_ids, weights, normalizers);
+
+  const int32 total_size = output.size();
+  if (total_size == 0) {
+    return;
+  }
+  CudaLaunchConfig config = GetCudaLaunchConfig(total_size, d);
+  FusedEmbeddingLookupSparseGradKernel<T>
+      <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+          total_size, grad.dimension(1), combiner, grad.data(),
+          segment_ids.data(), weights, normalizers.data(), grad.dimension(0),
+          output.data());
+}
+
+#define DEFINE_GPU_SPECS(T)                                    \
+  template struct FusedEmbeddingLookupSparseFunctor<T, int32>; \
+  template struct FusedEmbeddingLookupSparseFunctor<T, int64>; \
+  template struct FusedEmbeddingLookupSparseGradFunctor<T>;
+
+TF_CALL_float(DEFINE_GPU_SPECS);
+TF_CALL_double(DEFINE_GPU_SPECS);
+
+#undef DEFINE_GPU_SPECS
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -0,0 +1,246 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/kernels/gpu_utils.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+using perftools::gputools::dnn::AlgorithmConfig;
+using perftools::gputools::dnn::AlgorithmDesc;
+
+string AlgorithmDescValue(const AlgorithmDesc& desc) {
+  return strings::StrCat(desc.algo_id(), ",", desc.tensor_ops_enabled());
+}
+
+bool ParseAlgorithmDescValue(StringPiece value, AlgorithmDesc* desc) {
+  std::vector<string> fields = str_util::Split(value, ',');
+  int64 algo_id;
+  int32 tensor_ops_enabled;
+  if (fields.size() != 2 || !strings::safe_strto64(fields[0], &algo_id) ||
+      !strings::safe_strto32(fields[1], &tensor_ops_enabled)) {
+    return false;
+  }
+  *desc = AlgorithmDesc(algo_id, tensor_ops_enabled != 0);
+  return true;
+}
+
+}  // namespace
+
+// static
+ScratchArena* ScratchArena::Get(perftools::gputools::Stream* stream) {
+  static const int64 limit_in_mb = [] {
+    int64 value;
+    Status status =
+        ReadInt64FromEnvVar("TF_GPU_SCRATCH_ARENA_LIMIT_IN_MB", 0, &value);
+    if (!status.ok()) {
+      LOG(WARNING) << status;
+      return int64{0};
+    }
+    return value;
+  }();
+  if (limit_in_mb <= 0) return nullptr;
+  static mutex* mu = new mutex;
+  static auto* arenas =
+      new std::unordered_map<perftools::gputools::Stream*, ScratchArena*>;
+  mutex_lock l(*mu);
+  ScratchArena*& arena = (*arenas)[stream];
+  if (arena == nullptr) arena = new ScratchArena(limit_in_mb << 20);
+  return arena;
+}
+
+bool ScratchArena::Acquire(Allocator* allocator, int64 byte_size,
+                           Tensor* buffer) {
+  if (byte_size > limit_) return false;
+  mutex_lock l(mu_);
+  if (in_use_) return false;
+  if (buffer_.NumElements() < byte_size) {
+    // Grows geometrically so that a sequence of increasing requests does not
+    // reallocate each time. The old buffer is freed once the calls holding it
+    // drop their references, and the allocator only reuses it for work that is
+    // enqueued after them on the stream.
+    const int64 new_size =
+        std::min(limit_, std::max(byte_size, 2 * buffer_.NumElements()));
+    AllocationAttributes allocation_attr;
+    allocation_attr.no_retry_on_failure = true;
+    Tensor grown(allocator, DT_UINT8, TensorShape({new_size}),
+                 allocation_attr);
+    if (!grown.IsInitialized()) return false;
+    VLOG(1) << "Grew scratch arena to " << new_size << " bytes";
+    buffer_ = grown;
+  }
+  in_use_ = true;
+  *buffer = buffer_;
+  return true;
+}
+
+void ScratchArena::Release() {
+  mutex_lock l(mu_);
+  in_use_ = false;
+}
+
+int64 ScratchArena::size() const {
+  mutex_lock l(mu_);
+  return buffer_.NumElements();
+}
+
+GpuScratchAllocator::GpuScratchAllocator(int64 memory_limit,
+                                         OpKernelContext* context)
+    : memory_limit_(memory_limit), total_byte_size_(0), context_(context) {}
+
+GpuScratchAllocator::~GpuScratchAllocator() {
+  if (holds_arena_) arena_->Release();
+}
+
+ScratchArena* GpuScratchAllocator::GetArena(
+    perftools::gputools::Stream* stream) {
+  if (arena_ == nullptr) arena_ = ScratchArena::Get(stream);
+  return arena_;
+}
+
+int64 GpuScratchAllocator::GetMemoryLimitInBytes(
+    perftools::gputools::Stream* stream) {
+  ScratchArena* arena = GetArena(stream);
+  return arena == nullptr ? memory_limit_ : arena->limit();
+}
+
+perftools::gputools::port::StatusOr<perftools::gputools::DeviceMemory<uint8>>
+GpuScratchAllocator::AllocateBytes(perftools::gputools::Stream* stream,
+                                   int64 byte_size) {
+  if (byte_size < 0) {
+    return perftools::gputools::port::Status{
+        perftools::gputools::port::error::INVALID_ARGUMENT,
+        "Requested negative byte size!"};
+  }
+  if (byte_size > GetMemoryLimitInBytes(stream)) {
+    return perftools::gputools::port::StatusOr<
+        perftools::gputools::DeviceMemory<uint8>>();
+  }
+  Tensor temporary_memory;
+  ScratchArena* arena = GetArena(stream);
+  if (arena != nullptr && !holds_arena_ &&
+      arena->Acquire(context_->device()->GetAllocator(AllocatorAttributes()),
+                     byte_size, &temporary_memory)) {
+    holds_arena_ = true;
+  } else {
+    AllocationAttributes allocation_attr;
+    allocation_attr.no_retry_on_failure = true;
+    Status allocation_status(context_->allocate_temp(
+        DT_UINT8, TensorShape({byte_size}), &temporary_memory,
+        AllocatorAttributes(), allocation_attr));
+    if (!allocation_status.ok()) {
+      return perftools::gputools::port::StatusOr<
+          perftools::gputools::DeviceMemory<uint8>>();
+    }
+  }
+  // Hold the reference of the allocated tensors until the end of the
+  // allocator.
+  allocated_tensors_.push_back(temporary_memory);
+  total_byte_size_ += byte_size;
+  return perftools::gputools::port::StatusOr<
+      perftools::gputools::DeviceMemory<uint8>>(
+      AsDeviceMemory(temporary_memory.flat<uint8>().data(), byte_size));
+}
+
+// static
+AutoTuneCache* AutoTuneCache::Global() {
+  static AutoTuneCache* cache = []() {
+    const char* filename = getenv("TF_AUTOTUNE_CACHE_FILE");
+    return new AutoTuneCache(filename == nullptr ? "" : filename);
+  }();
+  return cache;
+}
+
+AutoTuneCache::AutoTuneCache(const string& filename) : filename_(filename) {
+  if (filename_.empty()) return;
+  string contents;
+  Status s = ReadFileToString(Env::Default(), filename_, &contents);
+  if (!s.ok()) {
+    VLOG(1) << "Not loading autotune results from " << filename_ << ": " << s;
+    return;
+  }
+  for (const string& line : str_util::Split(contents, '\n')) {
+    const size_t tab = line.rfind('\t');
+    if (tab == string::npos) continue;
+    values_[line.substr(0, tab)] = line.substr(tab + 1);
+  }
+  VLOG(1) << "Loaded " << values_.size() << " autotune results from "
+          << filename_;
+}
+
+bool AutoTuneCache::Find(const string& key, string* value) const {
+  mutex_lock l(mu_);
+  auto it = values_.find(key);
+  if (it == values_.end()) return false;
+  *value = it->second;
+  return true;
+}
+
+void AutoTuneCache::Insert(const string& key, const string& value) {
+  if (filename_.empty()) return;
+  mutex_lock l(mu_);
+  auto it = values_.find(key);
+  if (it != values_.end() && it->second == value) return;
+  values_[key] = value;
+  // Appending a single line keeps the file consistent when processes that
+  // share it write at the same time.
+  std::unique_ptr<WritableFile> file;
+  Status s = Env::Default()->NewAppendableFile(filename_, &file);
+  if (s.ok()) s = file->Append(strings::StrCat(key, "\t", value, "\n"));
+  if (s.ok()) s = file->Close();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to save an autotune result to " << filename_
+                 << ": " << s;
+  }
+}
+
+string AutoTuneCacheDeviceKey(perftools::gputools::Stream* stream) {
+  perftools::gputools::StreamExecutor* executor = stream->parent();
+  perftools::gputools::dnn::DnnSupport* dnn = executor->AsDnn();
+  return strings::StrCat(executor->GetDeviceDescription().name(), ", dnn ",
+                         dnn == nullptr ? "" : dnn->GetVersion());
+}
+
+string AutoTuneCacheValue(const AlgorithmConfig& config) {
+  return strings::StrCat(AlgorithmDescValue(config.algorithm()), " ",
+                         AlgorithmDescValue(config.algorithm_no_scratch()));
+}
+
+bool ParseAutoTuneCacheValue(const string& value, AlgorithmConfig* config) {
+  std::vector<string> fields = str_util::Split(value, ' ');
+  AlgorithmDesc algorithm;
+  AlgorithmDesc algorithm_no_scratch;
+  if (fields.size() != 2 || !ParseAlgorithmDescValue(fields[0], &algorithm) ||
+      !ParseAlgorithmDescValue(fields[1], &algorithm_no_scratch)) {
+    return false;
+  }
+  *config = AlgorithmConfig(algorithm, algorithm_no_scratch);
+  return true;
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
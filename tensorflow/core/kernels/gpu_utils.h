@@ -19,11 +19,15 @@ limitations under the License.
 #if GOOGLE_CUDA
 
 #include <unordered_map>
+#include <vector>
 
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 
 namespace tensorflow {
@@ -37,6 +41,109 @@ inline perftools::gputools::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory,
   return typed;
 }
 
+// A scratch buffer per stream, reused by the cuDNN and cuFFT calls enqueued on
+// the stream instead of allocating a temporary buffer for each of them. Work
+// on one stream runs in order on the device, so a buffer handed to a call can
+// be handed to the next one as soon as the first has been enqueued. The buffer
+// grows to the largest request up to the limit and is then kept, trading a
+// bounded amount of device memory for stable peak memory and for algorithms
+// that need a large workspace.
+//
+// Arenas are enabled by setting TF_GPU_SCRATCH_ARENA_LIMIT_IN_MB to their
+// limit. Thread-safe.
+class ScratchArena {
+ public:
+  // Returns the arena of 'stream', or nullptr if arenas are disabled.
+  static ScratchArena* Get(perftools::gputools::Stream* stream);
+
+  explicit ScratchArena(int64 limit) : limit_(limit) {}
+
+  // The largest buffer the arena hands out, in bytes.
+  int64 limit() const { return limit_; }
+
+  // Sets '*buffer' to at least 'byte_size' bytes of the arena, allocated with
+  // 'allocator' if it has to grow, and holds the arena until Release(). The
+  // buffer must only be used by work enqueued on the arena's stream before
+  // Release(). Returns false without waiting if the arena is held by another
+  // call, if 'byte_size' is above the limit or if growing fails.
+  bool Acquire(Allocator* allocator, int64 byte_size, Tensor* buffer);
+  void Release();
+
+  // The size of the buffer, in bytes.
+  int64 size() const;
+
+ private:
+  const int64 limit_;
+  mutable mutex mu_;
+  bool in_use_ GUARDED_BY(mu_) = false;
+  Tensor buffer_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ScratchArena);
+};
+
+// A scratch-space allocator for Stream-Executor cuDNN and cuFFT callbacks.
+// The first request is served from the ScratchArena of the stream when there
+// is one, in which case the arena limit replaces 'memory_limit', so that
+// algorithm selection sees the workspace that is actually available. Other
+// requests get temporary buffers of 'context'. TensorFlow is responsible for
+// releasing the buffers after the kernel finishes.
+class GpuScratchAllocator : public perftools::gputools::ScratchAllocator {
+ public:
+  GpuScratchAllocator(int64 memory_limit, OpKernelContext* context);
+  ~GpuScratchAllocator() override;
+
+  int64 GetMemoryLimitInBytes(perftools::gputools::Stream* stream) override;
+  perftools::gputools::port::StatusOr<perftools::gputools::DeviceMemory<uint8>>
+  AllocateBytes(perftools::gputools::Stream* stream, int64 byte_size) override;
+  int64 TotalByteSize() { return total_byte_size_; }
+
+ private:
+  ScratchArena* GetArena(perftools::gputools::Stream* stream);
+
+  int64 memory_limit_;
+  int64 total_byte_size_;
+  OpKernelContext* context_;
+  // The arena of the stream, once a request has been made.
+  ScratchArena* arena_ = nullptr;
+  bool holds_arena_ = false;
+  std::vector<Tensor> allocated_tensors_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuScratchAllocator);
+};
+
+// Autotune results that persist across processes, in the file named by the
+// TF_AUTOTUNE_CACHE_FILE environment variable. The file holds a line per
+// result, "<key>\t<value>", where a later line overrides an earlier one with
+// the same key. It is read on first use and new results are appended to it,
+// so processes that share the file only autotune what none of them has seen.
+// Does nothing if the variable is not set.
+class AutoTuneCache {
+ public:
+  static AutoTuneCache* Global();
+
+  bool Find(const string& key, string* value) const;
+  void Insert(const string& key, const string& value);
+
+ private:
+  explicit AutoTuneCache(const string& filename);
+
+  const string filename_;
+  mutable mutex mu_;
+  std::unordered_map<string, string> values_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AutoTuneCache);
+};
+
+// Returns the prefix of the AutoTuneCache keys of the results that hold for
+// 'stream': the model of its GPU and the version of its DNN library.
+string AutoTuneCacheDeviceKey(perftools::gputools::Stream* stream);
+
+// Converts between a dnn::AlgorithmConfig and its AutoTuneCache value.
+string AutoTuneCacheValue(
+    const perftools::gputools::dnn::AlgorithmConfig& config);
+bool ParseAutoTuneCacheValue(const string& value,
+                             perftools::gputools::dnn::AlgorithmConfig* config);
+
 // A helper class that looks up the best autotuned config from parameters.
 // Due to the noisy nature of autotune, especially with multiple devices, it
 // only accepts a config if its margin exceeds a threshold.
@@ -95,6 +202,37 @@ class AutoTuneMap {
     }
   }
 
+  // Like Find, but also accepts a config that the AutoTuneCache holds for
+  // 'params' on the device described by 'device_key', e.g. one that an
+  // earlier process found.
+  bool Find(const Parameters& params, const string& device_key,
+            Config* config) {
+    if (Find(params, config)) return true;
+    string value;
+    if (!AutoTuneCache::Global()->Find(CacheKey(params, device_key),
+                                       &value) ||
+        !ParseAutoTuneCacheValue(value, config)) {
+      return false;
+    }
+    mutex_lock lock(mu_);
+    VLOG(1) << GetActionSummary("loads", params, *config);
+    params_config_map_[params] =
+        ValueType{*config, min_score_threshold_, max_autotune_count_};
+    return true;
+  }
+
+  // Like Insert, but also saves the config to the AutoTuneCache for
+  // 'params' on the device described by 'device_key' once it is accepted.
+  void Insert(const Parameters& params, const string& device_key,
+              const Config& config) {
+    Insert(params, config);
+    Config accepted;
+    if (Find(params, &accepted) && accepted == config) {
+      AutoTuneCache::Global()->Insert(CacheKey(params, device_key),
+                                      AutoTuneCacheValue(config));
+    }
+  }
+
  private:
   AutoTuneMap(const string& name) : name_(name) {
     min_score_threshold_ = 1;
@@ -122,6 +260,10 @@ class AutoTuneMap {
     }
   };
 
+  string CacheKey(const Parameters& params, const string& device_key) const {
+    return strings::StrCat(name_, ": ", device_key, ": ", params.ToString());
+  }
+
   string GetActionSummary(StringPiece action, const Parameters& params,
                           const Config& config) {
     return strings::Printf("autotune_map %s %s: %s -> (%s)", name_.c_str(),
@@ -0,0 +1,122 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/kernels/gpu_utils.h"
+
+#include <stdlib.h>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using perftools::gputools::dnn::AlgorithmConfig;
+using perftools::gputools::dnn::AlgorithmDesc;
+
+struct TestParameters {
+  int64 size;
+
+  bool operator==(const TestParameters& other) const {
+    return size == other.size;
+  }
+  uint64 hash() const { return size; }
+  string ToString() const { return strings::StrCat(size); }
+};
+
+struct FirstAutoTuneGroup {
+  static string name() { return "First"; }
+};
+struct SecondAutoTuneGroup {
+  static string name() { return "Second"; }
+};
+
+TEST(AutoTuneCacheTest, ConfigValues) {
+  const AlgorithmConfig config(AlgorithmDesc(5, true), AlgorithmDesc());
+  AlgorithmConfig parsed;
+  ASSERT_TRUE(ParseAutoTuneCacheValue(AutoTuneCacheValue(config), &parsed));
+  EXPECT_EQ(config, parsed);
+  EXPECT_FALSE(ParseAutoTuneCacheValue("", &parsed));
+  EXPECT_FALSE(ParseAutoTuneCacheValue("5,1", &parsed));
+  EXPECT_FALSE(ParseAutoTuneCacheValue("a,1 -1,0", &parsed));
+}
+
+TEST(AutoTuneCacheTest, SharesResults) {
+  const string filename = io::JoinPath(testing::TmpDir(), "autotune_cache");
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), filename,
+      "Second: GPU, dnn 6.0.21: 2\t3,0 -1,0\nmalformed line\n"));
+  setenv("TF_AUTOTUNE_CACHE_FILE", filename.c_str(), 1);
+
+  // An autotuned config is saved once it is accepted.
+  auto* first = AutoTuneSingleton<FirstAutoTuneGroup, TestParameters,
+                                  AlgorithmConfig>::GetInstance();
+  const AlgorithmConfig config(AlgorithmDesc(7, false), AlgorithmDesc(1, true));
+  AlgorithmConfig found;
+  EXPECT_FALSE(first->Find({1}, "GPU, dnn 6.0.21", &found));
+  first->Insert({1}, "GPU, dnn 6.0.21", config);
+  ASSERT_TRUE(first->Find({1}, "GPU, dnn 6.0.21", &found));
+  EXPECT_EQ(config, found);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  EXPECT_NE(string::npos,
+            contents.find("First: GPU, dnn 6.0.21: 1\t7,0 1,1\n"));
+
+  // Results from the file are only used for the same group, device and
+  // parameters.
+  auto* second = AutoTuneSingleton<SecondAutoTuneGroup, TestParameters,
+                                   AlgorithmConfig>::GetInstance();
+  EXPECT_FALSE(second->Find({1}, "GPU, dnn 6.0.21", &found));
+  EXPECT_FALSE(second->Find({2}, "GPU, dnn 7.0.3", &found));
+  ASSERT_TRUE(second->Find({2}, "GPU, dnn 6.0.21", &found));
+  EXPECT_EQ(AlgorithmConfig(AlgorithmDesc(3, false), AlgorithmDesc()), found);
+}
+
+TEST(ScratchArenaTest, ReusesBuffer) {
+  ScratchArena arena(1 << 20);
+  Tensor first;
+  ASSERT_TRUE(arena.Acquire(cpu_allocator(), 100, &first));
+  EXPECT_EQ(100, first.NumElements());
+  // The arena is handed to one call at a time.
+  Tensor second;
+  EXPECT_FALSE(arena.Acquire(cpu_allocator(), 100, &second));
+  arena.Release();
+
+  ASSERT_TRUE(arena.Acquire(cpu_allocator(), 50, &second));
+  EXPECT_EQ(first.flat<uint8>().data(), second.flat<uint8>().data());
+  arena.Release();
+
+  // Grows geometrically, up to the limit.
+  ASSERT_TRUE(arena.Acquire(cpu_allocator(), 150, &second));
+  EXPECT_EQ(200, arena.size());
+  arena.Release();
+  ASSERT_TRUE(arena.Acquire(cpu_allocator(), 300, &second));
+  EXPECT_EQ(400, arena.size());
+  arena.Release();
+  ASSERT_TRUE(arena.Acquire(cpu_allocator(), (1 << 20) - 1, &second));
+  EXPECT_EQ((1 << 20) - 1, arena.size());
+  arena.Release();
+  EXPECT_FALSE(arena.Acquire(cpu_allocator(), (1 << 20) + 1, &second));
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -12,9 +12,12 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <map>
+
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/framework/iterator.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -25,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/stats_aggregator.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -39,6 +43,16 @@ namespace {
 
 const char kIteratorVariantTypeName[] = "tensorflow::Iterator";
 
+auto* get_next_wait_micros = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/data/get_next_wait_micros",
+     "Time IteratorGetNext waited for the next element of its iterator, in "
+     "microseconds."},
+    // 1us to ~1000s.
+    monitoring::Buckets::Exponential(1.0, 2.0, 30));
+
+monitoring::SamplerCell* const get_next_wait_cell =
+    get_next_wait_micros->GetCell();
+
 Status VerifyTypesMatch(const DataTypeVector& expected,
                         const DataTypeVector& received) {
   if (expected.size() != received.size()) {
@@ -76,6 +90,35 @@ Status VerifyShapesCompatible(const std::vector<PartialTensorShape>& expected,
   return Status::OK();
 }
 
+// Rebuilds the dataset that `output_node` of `graph_def` outputs. The functions
+// of the dataset run in `*pflr`, which knows about the functions of
+// `graph_def`. The caller owns a reference on `*dataset`.
+Status ImportDatasetGraph(OpKernelContext* ctx, int graph_def_version,
+                          const GraphDef& graph_def, const string& output_node,
+                          std::unique_ptr<FunctionLibraryDefinition>* flib_def,
+                          std::unique_ptr<ProcessFunctionLibraryRuntime>* pflr,
+                          DatasetBase** dataset) {
+  Graph graph(OpRegistry::Global());
+  TF_RETURN_IF_ERROR(ImportGraphDef({}, graph_def, &graph, nullptr));
+  std::vector<Tensor> outputs;
+  GraphRunner graph_runner(ctx->env());
+
+  // Build a new FLR that knows about the functions in the graph.
+  flib_def->reset(new FunctionLibraryDefinition(
+      *ctx->function_library()->GetFunctionLibraryDefinition()));
+  TF_RETURN_IF_ERROR((*flib_def)->AddLibrary(graph_def.library()));
+  pflr->reset(new ProcessFunctionLibraryRuntime(
+      nullptr, ctx->env(), graph_def_version, flib_def->get(), {}, nullptr));
+  FunctionLibraryRuntime* lib =
+      (*pflr)->GetFLR(ProcessFunctionLibraryRuntime::kDefaultFLRDevice);
+
+  TF_RETURN_IF_ERROR(
+      graph_runner.Run(&graph, lib, {}, {output_node}, &outputs));
+  TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(outputs[0], dataset));
+  (*dataset)->Ref();
+  return Status::OK();
+}
+
 class IteratorResource : public ResourceBase {
  public:
   IteratorResource(const DataTypeVector& output_dtypes,
@@ -123,26 +166,12 @@ class IteratorResource : public ResourceBase {
     TF_RETURN_IF_ERROR(reader->ReadScalar(
         GraphDatasetBase::kDatasetGraphOutputNodeKey, &output_node));
     DatasetBase* dataset = nullptr;
-    Graph graph(OpRegistry::Global());
-    TF_RETURN_IF_ERROR(ImportGraphDef({}, graph_def, &graph, nullptr));
-    std::vector<Tensor> outputs;
-    GraphRunner graph_runner(ctx->env());
-
-    // Build a new FLR that knows about the functions in the graph.
-    std::unique_ptr<FunctionLibraryDefinition> flib_def(
-        new FunctionLibraryDefinition(
-            *ctx->function_library()->GetFunctionLibraryDefinition()));
-    TF_RETURN_IF_ERROR(flib_def->AddLibrary(graph_def.library()));
-    std::unique_ptr<ProcessFunctionLibraryRuntime> pflr(
-        new ProcessFunctionLibraryRuntime(nullptr, ctx->env(),
-                                          graph_def_version_, flib_def.get(),
-                                          {}, nullptr));
-    FunctionLibraryRuntime* lib =
-        pflr->GetFLR(ProcessFunctionLibraryRuntime::kDefaultFLRDevice);
-
-    TF_RETURN_IF_ERROR(
-        graph_runner.Run(&graph, lib, {}, {output_node}, &outputs));
-    TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(outputs[0], &dataset));
+    std::unique_ptr<FunctionLibraryDefinition> flib_def;
+    std::unique_ptr<ProcessFunctionLibraryRuntime> pflr;
+    TF_RETURN_IF_ERROR(ImportDatasetGraph(ctx, graph_def_version_, graph_def,
+                                          output_node, &flib_def, &pflr,
+                                          &dataset));
+    core::ScopedUnref unref_dataset(dataset);
 
     TF_RETURN_IF_ERROR(set_iterator(dataset->MakeIterator("Iterator")));
     std::shared_ptr<IteratorBase> captured_iterator(iterator_);
@@ -689,7 +718,8 @@ class IteratorGetNextOp : public AsyncOpKernel {
     // The call to `iterator->GetNext()` may block and depend on an
     // inter-op thread pool thread, so we issue the call from the
     // owned thread pool.
-    thread_pool_->Schedule([this, ctx, iterator, done]() {
+    const uint64 start_micros = ctx->env()->NowMicros();
+    thread_pool_->Schedule([this, ctx, iterator, done, start_micros]() {
       core::ScopedUnref unref_iterator(iterator);
 
       std::vector<Tensor> components;
@@ -703,9 +733,10 @@ class IteratorGetNextOp : public AsyncOpKernel {
       params.runner = *(ctx->runner());
       IteratorContext iter_ctx(std::move(params));
 
-      OP_REQUIRES_OK_ASYNC(
-          ctx, iterator->GetNext(&iter_ctx, &components, &end_of_sequence),
-          done);
+      const Status s =
+          iterator->GetNext(&iter_ctx, &components, &end_of_sequence);
+      get_next_wait_cell->Add(ctx->env()->NowMicros() - start_micros);
+      OP_REQUIRES_OK_ASYNC(ctx, s, done);
       OP_REQUIRES_ASYNC(ctx, !end_of_sequence,
                         errors::OutOfRange("End of sequence"), done);
 
@@ -876,6 +907,213 @@ class IteratorSetStatsAggregatorOp : public OpKernel {
   }
 };
 
+// The name of the node that outputs the dataset in the graphs of
+// "DatasetToGraph".
+const char kDatasetGraphOutputNode[] = "dataset_graph_output";
+
+// The container of the iterators of "DatasetServiceGetNext".
+const char kDatasetServiceContainer[] = "dataset_service";
+
+// Collects the serialized graph that `DatasetBase::Save()` writes.
+class DatasetGraphWriter : public IteratorStateWriter {
+ public:
+  Status WriteScalar(StringPiece key, const int64 val) override {
+    return errors::Unimplemented("DatasetGraphWriter::WriteScalar(", key,
+                                 ", int64)");
+  }
+
+  Status WriteScalar(StringPiece key, const string& val) override {
+    values_[key.ToString()] = val;
+    return Status::OK();
+  }
+
+  Status WriteTensor(StringPiece key, const Tensor& val) override {
+    return errors::Unimplemented("DatasetGraphWriter::WriteTensor(", key, ")");
+  }
+
+  Status Read(StringPiece key, string* val) const {
+    auto it = values_.find(key.ToString());
+    if (it == values_.end()) {
+      return errors::Internal("The dataset did not write ", key);
+    }
+    *val = it->second;
+    return Status::OK();
+  }
+
+ private:
+  std::map<string, string> values_;
+};
+
+class DatasetToGraphOp : public OpKernel {
+ public:
+  explicit DatasetToGraphOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    DatasetBase* dataset;
+    OP_REQUIRES_OK(ctx, GetDatasetFromVariantTensor(ctx->input(0), &dataset));
+    DatasetGraphWriter writer;
+    OP_REQUIRES_OK(ctx, dataset->Save(ctx, &writer));
+    string serialized_graph_def;
+    OP_REQUIRES_OK(ctx, writer.Read(GraphDatasetBase::kDatasetGraphKey,
+                                    &serialized_graph_def));
+    string output_node;
+    OP_REQUIRES_OK(ctx,
+                   writer.Read(GraphDatasetBase::kDatasetGraphOutputNodeKey,
+                               &output_node));
+    GraphDef graph_def;
+    OP_REQUIRES(ctx, graph_def.ParseFromString(serialized_graph_def),
+                errors::Internal("Error parsing dataset GraphDef."));
+
+    // Names the output of the graph, so that it can be shipped as a single
+    // string.
+    NodeDef* node = graph_def.add_node();
+    node->set_name(kDatasetGraphOutputNode);
+    node->set_op("Identity");
+    node->add_input(output_node);
+    AddNodeAttr("T", DT_VARIANT, node);
+
+    Tensor* graph_t;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &graph_t));
+    graph_def.SerializeToString(&graph_t->scalar<string>()());
+  }
+};
+
+// An iterator that a device runs for a remote consumer, over a dataset rebuilt
+// from a graph of "DatasetToGraph".
+class DatasetServiceIterator : public ResourceBase {
+ public:
+  Status Initialize(OpKernelContext* ctx, int graph_def_version,
+                    const string& serialized_graph_def,
+                    const DataTypeVector& output_dtypes,
+                    const std::vector<PartialTensorShape>& output_shapes) {
+    GraphDef graph_def;
+    if (!graph_def.ParseFromString(serialized_graph_def)) {
+      return errors::InvalidArgument("Error parsing dataset GraphDef.");
+    }
+    DatasetBase* dataset = nullptr;
+    TF_RETURN_IF_ERROR(ImportDatasetGraph(ctx, graph_def_version, graph_def,
+                                          kDatasetGraphOutputNode, &flib_def_,
+                                          &pflr_, &dataset));
+    core::ScopedUnref unref_dataset(dataset);
+    TF_RETURN_IF_ERROR(
+        VerifyTypesMatch(output_dtypes, dataset->output_dtypes()));
+    TF_RETURN_IF_ERROR(
+        VerifyShapesCompatible(output_shapes, dataset->output_shapes()));
+    iterator_ = dataset->MakeIterator("DatasetServiceIterator");
+    return Status::OK();
+  }
+
+  // Releases the dataset once it has reached its end, and keeps reporting the
+  // end to the calls that were in flight.
+  Status GetNext(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
+                 bool* end_of_sequence) {
+    std::shared_ptr<IteratorBase> captured_iterator;
+    {
+      tf_shared_lock l(mu_);
+      captured_iterator = iterator_;
+    }
+    if (!captured_iterator) {
+      *end_of_sequence = true;
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(
+        captured_iterator->GetNext(ctx, out_tensors, end_of_sequence));
+    if (*end_of_sequence) {
+      mutex_lock l(mu_);
+      iterator_.reset();
+    }
+    return Status::OK();
+  }
+
+  string DebugString() override { return "DatasetServiceIterator"; }
+
+ private:
+  // The dataset runs its functions in `pflr_`, so `iterator_` is destroyed
+  // first.
+  std::unique_ptr<FunctionLibraryDefinition> flib_def_;
+  std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
+  mutex mu_;
+  std::shared_ptr<IteratorBase> iterator_ GUARDED_BY(mu_);
+};
+
+class DatasetServiceGetNextOp : public AsyncOpKernel {
+ public:
+  explicit DatasetServiceGetNextOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        graph_def_version_(ctx->graph_def_version()),
+        thread_pool_(new thread::ThreadPool(
+            ctx->env(), ThreadOptions(),
+            strings::StrCat("dataset_service_get_next_thread_",
+                            SanitizeThreadSuffix(name())),
+            1 /* num_threads */, false /* low_latency_hint */)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_dtypes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    const Tensor& graph_t = ctx->input(0);
+    const Tensor& iterator_id_t = ctx->input(1);
+    OP_REQUIRES_ASYNC(ctx, TensorShapeUtils::IsScalar(graph_t.shape()),
+                      errors::InvalidArgument("graph must be a scalar"), done);
+    OP_REQUIRES_ASYNC(ctx, TensorShapeUtils::IsScalar(iterator_id_t.shape()),
+                      errors::InvalidArgument("iterator_id must be a scalar"),
+                      done);
+
+    // Creating the iterator and getting its next element may both block, so
+    // they run in the owned thread pool.
+    thread_pool_->Schedule([this, ctx, done]() {
+      const string& graph = ctx->input(0).scalar<string>()();
+      const string& iterator_id = ctx->input(1).scalar<string>()();
+      DatasetServiceIterator* iterator;
+      OP_REQUIRES_OK_ASYNC(
+          ctx,
+          ctx->resource_manager()->LookupOrCreate<DatasetServiceIterator>(
+              kDatasetServiceContainer, iterator_id, &iterator,
+              [this, ctx, &graph,
+               &iterator_id](DatasetServiceIterator** ret) {
+                if (graph.empty()) {
+                  return errors::FailedPrecondition(
+                      "Dataset service iterator ", iterator_id,
+                      " does not exist on ", ctx->device()->name(),
+                      ", e.g. because its container was reset.");
+                }
+                std::unique_ptr<DatasetServiceIterator> created(
+                    new DatasetServiceIterator);
+                TF_RETURN_IF_ERROR(
+                    created->Initialize(ctx, graph_def_version_, graph,
+                                        output_dtypes_, output_shapes_));
+                *ret = created.release();
+                return Status::OK();
+              }),
+          done);
+      core::ScopedUnref unref_iterator(iterator);
+
+      std::vector<Tensor> components;
+      bool end_of_sequence = false;
+      IteratorContext::Params params;
+      params.env = ctx->env();
+      params.runner = *(ctx->runner());
+      IteratorContext iter_ctx(std::move(params));
+      OP_REQUIRES_OK_ASYNC(
+          ctx, iterator->GetNext(&iter_ctx, &components, &end_of_sequence),
+          done);
+      OP_REQUIRES_ASYNC(ctx, !end_of_sequence,
+                        errors::OutOfRange("End of sequence"), done);
+
+      for (int i = 0; i < components.size(); ++i) {
+        ctx->set_output(i, components[i]);
+      }
+      done();
+    });
+  }
+
+ private:
+  const int graph_def_version_;
+  DataTypeVector output_dtypes_;
+  std::vector<PartialTensorShape> output_shapes_;
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+};
+
 REGISTER_KERNEL_BUILDER(Name("Iterator").Device(DEVICE_CPU), IteratorHandleOp);
 REGISTER_KERNEL_BUILDER(Name("MakeIterator").Device(DEVICE_CPU),
                         MakeIteratorOp);
@@ -895,6 +1133,10 @@ REGISTER_KERNEL_BUILDER(Name("DeserializeIterator").Device(DEVICE_CPU),
                         DeserializeIteratorOp);
 REGISTER_KERNEL_BUILDER(Name("IteratorSetStatsAggregator").Device(DEVICE_CPU),
                         IteratorSetStatsAggregatorOp);
+REGISTER_KERNEL_BUILDER(Name("DatasetToGraph").Device(DEVICE_CPU),
+                        DatasetToGraphOp);
+REGISTER_KERNEL_BUILDER(Name("DatasetServiceGetNext").Device(DEVICE_CPU),
+                        DatasetServiceGetNextOp);
 
 }  // namespace
 
@@ -26,6 +26,11 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 
+#if GOOGLE_CUDA
+#include "tensorflow/core/kernels/lookup_table_op_gpu.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA
+
 namespace tensorflow {
 namespace lookup {
 
@@ -49,7 +54,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
   size_t size() const override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     return table_.size();
   }
 
@@ -59,7 +64,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     for (int64 i = 0; i < key_values.size(); ++i) {
       value_values(i) = gtl::FindWithDefault(
           table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)),
@@ -96,7 +101,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     int64 size = table_.size();
 
     Tensor* keys;
@@ -126,7 +131,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64 MemoryUsed() const override {
     int64 ret = 0;
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     for (unsigned i = 0; i < table_.bucket_count(); ++i) {
       size_t bucket_size = table_.bucket_size(i);
       if (bucket_size == 0) {
@@ -139,7 +144,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
+  // Lookups and exports only read the table, so they hold mu_ shared and run
+  // concurrently; inserts and imports hold it exclusively.
   mutable mutex mu_;
   std::unordered_map<K, V> table_ GUARDED_BY(mu_);
 };
@@ -159,7 +165,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   size_t size() const override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     return table_.size();
   }
 
@@ -170,9 +176,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
     auto value_values = value->flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec = gtl::FindOrNull(
+      const ValueArray* value_vec = gtl::FindOrNull(
           table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)));
       if (value_vec != nullptr) {
         for (int64 j = 0; j < value_dim; j++) {
@@ -220,7 +226,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     int64 size = table_.size();
     int64 value_dim = value_shape_.dim_size(0);
 
@@ -255,7 +261,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
   int64 MemoryUsed() const override {
     int64 ret = 0;
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     for (unsigned i = 0; i < table_.bucket_count(); ++i) {
       size_t bucket_size = table_.bucket_size(i);
       if (bucket_size == 0) {
@@ -269,7 +275,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
  private:
   TensorShape value_shape_;
-  // TODO(andreasst): consider using a read/write lock or a concurrent map
+  // Lookups and exports only read the table, so they hold mu_ shared and run
+  // concurrently; inserts and imports hold it exclusively.
   mutable mutex mu_;
   typedef gtl::InlinedVector<V, 4> ValueArray;
   std::unordered_map<K, ValueArray> table_ GUARDED_BY(mu_);
@@ -336,7 +343,7 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
   size_t size() const override LOCKS_EXCLUDED(mu_) {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     return num_entries_;
   }
 
@@ -356,7 +363,7 @@ class MutableDenseHashTable final : public LookupInterface {
     auto value_matrix = value->shaped<V, 2>({num_elements, value_size});
     const auto default_flat = default_value.flat<V>();
 
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     const auto key_buckets_matrix =
         key_buckets_.AccessTensor(ctx)->template matrix<K>();
     const auto value_buckets_matrix =
@@ -452,7 +459,7 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override LOCKS_EXCLUDED(mu_) {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     Tensor key_buckets_tensor = *key_buckets_.AccessTensor(ctx);
     Tensor value_buckets_tensor = *value_buckets_.AccessTensor(ctx);
     TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_tensor));
@@ -494,7 +501,7 @@ class MutableDenseHashTable final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64 MemoryUsed() const override {
-    mutex_lock l(mu_);
+    tf_shared_lock l(mu_);
     return sizeof(MutableDenseHashTable) + key_buckets_.AllocatedBytes() +
            value_buckets_.AllocatedBytes() + empty_key_.AllocatedBytes();
   }
@@ -644,6 +651,231 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 empty_key_hash_;
 };
 
+#if GOOGLE_CUDA
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Version of MutableDenseHashTable whose buckets live in GPU memory, so that
+// the ids of a model running on the GPU are looked up without copying them to
+// the host. Keys must be scalars. Find is a single asynchronous kernel launch.
+// Insert waits for its kernel to learn how many keys were new, since that
+// decides when the table grows. Looking up the empty key returns the default
+// value instead of an error.
+//
+// The key and value buckets have the same shapes as in MutableDenseHashTable,
+// so tables exported from one can be imported into the other.
+template <class K, class V>
+class MutableDenseHashTableGPU final : public LookupInterface {
+ public:
+  MutableDenseHashTableGPU(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "max_load_factor", &max_load_factor_));
+    OP_REQUIRES(ctx, max_load_factor_ > 0 && max_load_factor_ < 1,
+                errors::InvalidArgument(
+                    "max_load_factor must be between 0 and 1, got: ",
+                    max_load_factor_));
+
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(value_shape_) ||
+                    TensorShapeUtils::IsVector(value_shape_),
+                errors::InvalidArgument(
+                    "Empty value must be a scalar or a vector, got shape ",
+                    value_shape_.DebugString()));
+
+    // The empty key is in host memory.
+    const Tensor* empty_key_input;
+    OP_REQUIRES_OK(ctx, ctx->input("empty_key", &empty_key_input));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(empty_key_input->shape()),
+                errors::InvalidArgument(
+                    "Empty key must be a scalar on GPU, got shape ",
+                    empty_key_input->shape().DebugString(),
+                    ". Tables with vector keys must be placed on the CPU."));
+    empty_key_ = empty_key_input->scalar<K>()();
+
+    int64 initial_num_buckets;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
+                                    &initial_num_buckets));
+    mutex_lock l(mu_);
+    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
+  }
+
+  size_t size() const override LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return num_entries_;
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override LOCKS_EXCLUDED(mu_) {
+    const int64 num_elements = key.NumElements();
+    const int64 value_size = value_shape_.num_elements();
+    tf_shared_lock l(mu_);
+    functor::DenseHashTableFind<K, V>()(
+        ctx->eigen_device<GPUDevice>(), key.flat<K>(), empty_key_,
+        key_buckets_.AccessTensor(ctx)->template flat<K>(),
+        value_buckets_.AccessTensor(ctx)->template matrix<V>(),
+        default_value.flat<V>(),
+        value->shaped<V, 2>({num_elements, value_size}));
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& key,
+                const Tensor& value) override LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    // As in MutableDenseHashTable, all keys are assumed to be new when
+    // deciding whether to grow the table.
+    const int64 pending_num_entries = num_entries_ + key.NumElements();
+    if (pending_num_entries > num_buckets_ * max_load_factor_) {
+      int64 new_num_buckets = num_buckets_;
+      do {
+        new_num_buckets <<= 1;
+      } while (pending_num_entries > new_num_buckets * max_load_factor_);
+      TF_RETURN_IF_ERROR(Rebucket(ctx, new_num_buckets));
+    }
+    return DoInsert(ctx, key, value, false);
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    // The keys are inserted again rather than copied, which also counts them.
+    int64 new_num_buckets = 4;
+    while (new_num_buckets < keys.dim_size(0)) {
+      new_num_buckets <<= 1;
+    }
+    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, new_num_buckets));
+    return DoInsert(ctx, keys, values, true);
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    Tensor key_buckets_tensor = *key_buckets_.AccessTensor(ctx);
+    Tensor value_buckets_tensor = *value_buckets_.AccessTensor(ctx);
+    TF_RETURN_IF_ERROR(ctx->set_output("keys", key_buckets_tensor));
+    TF_RETURN_IF_ERROR(ctx->set_output("values", value_buckets_tensor));
+    return Status::OK();
+  }
+
+  Status CheckKeyAndValueTensorsForImport(const Tensor& keys,
+                                          const Tensor& values) override {
+    TF_RETURN_IF_ERROR(CheckKeyAndValueTypes(keys, values));
+    TF_RETURN_IF_ERROR(CheckKeyShape(keys.shape()));
+
+    // Buckets are exported as matrices, see MutableDenseHashTable.
+    TensorShape expected_value_shape = keys.shape();
+    expected_value_shape.RemoveLastDims(1);
+    expected_value_shape.AppendShape(MaybeVectorizeShape(value_shape_));
+    if (values.shape() != expected_value_shape) {
+      return errors::InvalidArgument(
+          "Expected shape ", expected_value_shape.DebugString(),
+          " for value, got ", values.shape().DebugString());
+    }
+    return Status::OK();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64 MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    return sizeof(MutableDenseHashTableGPU) + key_buckets_.AllocatedBytes() +
+           value_buckets_.AllocatedBytes();
+  }
+
+ private:
+  Status DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value,
+                  bool ignore_empty_key) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64 num_elements = key.NumElements();
+    const int64 value_size = value_shape_.num_elements();
+    Tensor counters;
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(
+        DT_INT32, TensorShape({functor::kNumInsertCounters}), &counters));
+    functor::DenseHashTableInsert<K, V>()(
+        ctx->eigen_device<GPUDevice>(), key.flat<K>(),
+        value.shaped<V, 2>({num_elements, value_size}), empty_key_,
+        key_buckets_.AccessTensor(ctx)->template flat<K>(),
+        value_buckets_.AccessTensor(ctx)->template matrix<V>(),
+        counters.flat<int32>().data());
+
+    auto* stream = ctx->op_device_context()->stream();
+    if (stream == nullptr) {
+      return errors::Internal("No GPU stream available.");
+    }
+    int32 host_counters[functor::kNumInsertCounters];
+    perftools::gputools::DeviceMemoryBase counters_ptr(
+        counters.flat<int32>().data(), sizeof(host_counters));
+    if (!stream->ThenMemcpy(host_counters, counters_ptr, sizeof(host_counters))
+             .ok()) {
+      return errors::Internal("Failed to copy the insert counters to host.");
+    }
+    TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+
+    num_entries_ += host_counters[functor::kNumInsertedKeys];
+    if (host_counters[functor::kNumDroppedKeys] > 0) {
+      return errors::Internal(
+          "Internal error in MutableDenseHashTableGPU insert");
+    }
+    if (!ignore_empty_key && host_counters[functor::kNumEmptyKeys] > 0) {
+      return errors::InvalidArgument(
+          "Using the empty_key as a table key is not allowed");
+    }
+    return Status::OK();
+  }
+
+  Status AllocateBuckets(OpKernelContext* ctx, int64 new_num_buckets)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (new_num_buckets < 4 ||
+        ((new_num_buckets & (new_num_buckets - 1)) != 0)) {
+      return errors::InvalidArgument(
+          "Number of buckets must be at least 4 and a power of 2, got: ",
+          new_num_buckets);
+    }
+    num_buckets_ = new_num_buckets;
+    num_entries_ = 0;
+
+    Tensor* key_buckets_tensor;
+    TF_RETURN_IF_ERROR(ctx->allocate_persistent(
+        key_dtype(), TensorShape({num_buckets_, 1}), &key_buckets_,
+        &key_buckets_tensor));
+    Tensor* value_buckets_tensor;
+    TF_RETURN_IF_ERROR(ctx->allocate_persistent(
+        value_dtype(),
+        TensorShape({num_buckets_, value_shape_.num_elements()}),
+        &value_buckets_, &value_buckets_tensor));
+    // Values are set to V() to avoid exposing uninitialized memory in
+    // ExportValues().
+    functor::DenseHashTableClear<K, V>()(
+        ctx->eigen_device<GPUDevice>(), empty_key_,
+        key_buckets_tensor->flat<K>(), value_buckets_tensor->flat<V>());
+    return Status::OK();
+  }
+
+  Status Rebucket(OpKernelContext* ctx, int64 num_new_buckets)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Tensor old_key_buckets = *key_buckets_.AccessTensor(ctx);
+    Tensor old_value_buckets = *value_buckets_.AccessTensor(ctx);
+    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, num_new_buckets));
+    return DoInsert(ctx, old_key_buckets, old_value_buckets, true);
+  }
+
+  TensorShape value_shape_;
+  float max_load_factor_;
+  K empty_key_;
+  mutable mutex mu_;
+  int64 num_entries_ GUARDED_BY(mu_);
+  int64 num_buckets_ GUARDED_BY(mu_);
+  PersistentTensor key_buckets_ GUARDED_BY(mu_);
+  PersistentTensor value_buckets_ GUARDED_BY(mu_);
+};
+
+#endif  // GOOGLE_CUDA
+
 }  // namespace lookup
 
 // Table lookup op. Perform the lookup operation on the given table.
@@ -902,4 +1134,54 @@ REGISTER_KERNEL(int64, bool);
 
 #undef REGISTER_KERNEL
 
+#if GOOGLE_CUDA
+
+// Register the GPU MutableDenseHashTable op, and the ops that use the tables
+// it creates. The table handles, the empty key and the size are in host
+// memory; keys and values stay on the GPU.
+#define REGISTER_GPU_KERNEL(key_dtype, value_dtype)                         \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("MutableDenseHashTableV2")                                       \
+          .Device(DEVICE_GPU)                                               \
+          .HostMemory("empty_key")                                          \
+          .TypeConstraint<key_dtype>("key_dtype")                           \
+          .TypeConstraint<value_dtype>("value_dtype"),                      \
+      LookupTableOp<lookup::MutableDenseHashTableGPU<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)                                \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableFindV2")                         \
+                              .Device(DEVICE_GPU)                           \
+                              .TypeConstraint<key_dtype>("Tin")             \
+                              .TypeConstraint<value_dtype>("Tout"),         \
+                          LookupTableFindOp)                                \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableInsertV2")                       \
+                              .Device(DEVICE_GPU)                           \
+                              .TypeConstraint<key_dtype>("Tin")             \
+                              .TypeConstraint<value_dtype>("Tout"),         \
+                          LookupTableInsertOp)                              \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableExportV2")                       \
+                              .Device(DEVICE_GPU)                           \
+                              .TypeConstraint<key_dtype>("Tkeys")           \
+                              .TypeConstraint<value_dtype>("Tvalues"),      \
+                          LookupTableExportOp)                              \
+  REGISTER_KERNEL_BUILDER(Name("LookupTableImportV2")                       \
+                              .Device(DEVICE_GPU)                           \
+                              .TypeConstraint<key_dtype>("Tin")             \
+                              .TypeConstraint<value_dtype>("Tout"),         \
+                          LookupTableImportOp)
+
+REGISTER_GPU_KERNEL(int32, int32);
+REGISTER_GPU_KERNEL(int32, int64);
+REGISTER_GPU_KERNEL(int32, float);
+REGISTER_GPU_KERNEL(int64, int32);
+REGISTER_GPU_KERNEL(int64, int64);
+REGISTER_GPU_KERNEL(int64, float);
+
+#undef REGISTER_GPU_KERNEL
+
+REGISTER_KERNEL_BUILDER(
+    Name("LookupTableSizeV2").Device(DEVICE_GPU).HostMemory("size"),
+    LookupTableSizeOp);
+
+#endif  // GOOGLE_CUDA
+
 }  // namespace tensorflow
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -26,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -141,19 +146,32 @@ inline const double SubtleMustCopyUnlessStringOrFloat(const double value) {
   return value;
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
-// is specified.
+// Hashes a key of a HashTable. Integer keys are mixed so that keys with a
+// common stride do not collide in the low bits used to pick a bucket.
+template <typename T>
+inline uint64 HashTableKeyHash(const T& key) {
+  const uint64 h = static_cast<uint64>(key) * 0x9ddfea08eb382d69ULL;
+  return h ^ (h >> 32);
+}
+
+inline uint64 HashTableKeyHash(const string& key) { return Hash64(key); }
+
+// Lookup table backed by a flat open-addressing array, where the key and value
+// data type is specified.
 //
 // This table is recommended for any variations to key values.
 //
 // For look up, the table is required to be initialized (allocated
-// and populated). Once the table is marked as initialized it becomes read-only.
+// and populated). Once the table is marked as initialized it becomes read-only,
+// so lookups take no lock. Keys and values are stored inline in the buckets,
+// and lookups are done in batches that prefetch the buckets of all the keys of
+// a batch before probing any of them.
 //
 // Sample use case:
 //
 // HashTable<int64, int64> table;  // int64 -> int64.
 // table.Prepare(10); // Prepare the underlying data structure, the number of
-//                    // elements is required by interface, but not used.
+//                    // elements is used to size the table if it is known.
 // // Populate the table, elements could be added in one or multiple calls.
 // table.Insert(key_tensor, value_tensor); // Populate the table.
 // ...
@@ -172,7 +190,7 @@ class HashTable : public InitializableLookupTable {
       return 0;
     }
     std::atomic_thread_fence(std::memory_order_acquire);
-    return table_ ? table_->size() : 0;
+    return num_entries_;
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -180,33 +198,40 @@ class HashTable : public InitializableLookupTable {
   DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
 
  protected:
-  Status DoPrepare(size_t unused) override {
+  Status DoPrepare(size_t expected_num_elements) override {
     if (is_initialized_) {
       return errors::Aborted("HashTable already initialized.");
     }
-    if (!table_) {
-      table_ = std::unique_ptr<std::unordered_map<K, V>>(
-          new std::unordered_map<K, V>());
-    }
+    // Iterators that don't know their size report -1.
+    const int64 expected = static_cast<int64>(expected_num_elements);
+    Reserve(std::max<int64>(expected, 0));
     return Status::OK();
   };
 
   Status DoInsert(const Tensor& keys, const Tensor& values) override {
-    if (!table_) {
+    if (buckets_.empty()) {
       return errors::FailedPrecondition("HashTable is not prepared.");
     }
 
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
+    Reserve(num_entries_ + key_values.size());
     for (int64 i = 0; i < key_values.size(); ++i) {
       const K key = SubtleMustCopyUnlessStringOrFloat(key_values(i));
       const V value = SubtleMustCopyUnlessStringOrFloat(value_values(i));
-      const V& previous_value = gtl::LookupOrInsert(table_.get(), key, value);
-      if (previous_value != value) {
-        return errors::FailedPrecondition(
-            "HashTable has different value for same key. Key ", key, " has ",
-            previous_value, " and trying to add value ", value);
+      Bucket* bucket = &buckets_[FindBucket(key, HashTableKeyHash(key))];
+      if (bucket->occupied) {
+        if (bucket->value != value) {
+          return errors::FailedPrecondition(
+              "HashTable has different value for same key. Key ", key,
+              " has ", bucket->value, " and trying to add value ", value);
+        }
+        continue;
       }
+      bucket->occupied = true;
+      bucket->key = key;
+      bucket->value = value;
+      ++num_entries_;
     }
     return Status::OK();
   }
@@ -216,26 +241,79 @@ class HashTable : public InitializableLookupTable {
     const V default_val = default_value.flat<V>()(0);
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
-
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          *table_, SubtleMustCopyUnlessStringOrFloat(key_values(i)),
-          default_val);
+    const int64 num_keys = key_values.size();
+
+    // Most lookups miss the cache, so the buckets of a whole batch are
+    // fetched in parallel before any of them is probed.
+    uint64 hashes[kLookupBatchSize];
+    for (int64 start = 0; start < num_keys; start += kLookupBatchSize) {
+      const int64 end = std::min(start + kLookupBatchSize, num_keys);
+      for (int64 i = start; i < end; ++i) {
+        const uint64 hash =
+            HashTableKeyHash(SubtleMustCopyUnlessStringOrFloat(key_values(i)));
+        hashes[i - start] = hash;
+        port::prefetch<port::PREFETCH_HINT_T0>(&buckets_[hash & bucket_mask_]);
+      }
+      for (int64 i = start; i < end; ++i) {
+        const Bucket& bucket = buckets_[FindBucket(
+            SubtleMustCopyUnlessStringOrFloat(key_values(i)),
+            hashes[i - start])];
+        value_values(i) = bucket.occupied ? bucket.value : default_val;
+      }
     }
     return Status::OK();
   }
 
   int64 MemoryUsed() const override {
-    if (table_) {
-      const int64 num_elements = table_->size();
-      return num_elements * (sizeof(K) + sizeof(V));
-    } else {
-      return 0;
-    }
+    return buckets_.size() * sizeof(Bucket);
   }
 
  private:
-  std::unique_ptr<std::unordered_map<K, V>> table_;
+  struct Bucket {
+    K key;
+    V value;
+    bool occupied = false;
+  };
+
+  static constexpr int64 kLookupBatchSize = 16;
+  static constexpr int64 kMinNumBuckets = 16;
+
+  // Returns the index of the bucket that holds "key", or of the empty bucket
+  // where it would be inserted. There is always an empty bucket since the load
+  // factor is at most 1/2.
+  uint64 FindBucket(const K& key, uint64 hash) const {
+    uint64 index = hash & bucket_mask_;
+    while (buckets_[index].occupied && !(buckets_[index].key == key)) {
+      index = (index + 1) & bucket_mask_;  // linear probing
+    }
+    return index;
+  }
+
+  // Makes room for "num_elements" entries while keeping the load factor at
+  // most 1/2, rehashing the existing entries if needed.
+  void Reserve(int64 num_elements) {
+    int64 num_buckets = kMinNumBuckets;
+    while (num_buckets < 2 * num_elements) {
+      num_buckets <<= 1;
+    }
+    if (num_buckets <= static_cast<int64>(buckets_.size())) {
+      return;
+    }
+    std::vector<Bucket> old_buckets(num_buckets);
+    old_buckets.swap(buckets_);
+    bucket_mask_ = num_buckets - 1;
+    for (Bucket& old_bucket : old_buckets) {
+      if (old_bucket.occupied) {
+        buckets_[FindBucket(old_bucket.key,
+                            HashTableKeyHash(old_bucket.key))] =
+            std::move(old_bucket);
+      }
+    }
+  }
+
+  std::vector<Bucket> buckets_;
+  uint64 bucket_mask_ = 0;
+  int64 num_entries_ = 0;
 };
 
 }  // namespace lookup
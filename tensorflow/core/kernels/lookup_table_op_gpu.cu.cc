@@ -0,0 +1,213 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/lookup_table_op_gpu.h"
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Mixes the bits of "key" so that keys with a common stride do not collide in
+// the low bits used to pick a bucket.
+template <typename K>
+__device__ __forceinline__ uint64 HashKey(const K key) {
+  const uint64 h = static_cast<uint64>(key) * 0x9ddfea08eb382d69ULL;
+  return h ^ (h >> 32);
+}
+
+// Atomically replaces *address with "val" if it is "compare", and returns the
+// previous value of *address.
+__device__ __forceinline__ int32 AtomicCasKey(int32* address, int32 compare,
+                                              int32 val) {
+  return atomicCAS(address, compare, val);
+}
+
+__device__ __forceinline__ int64 AtomicCasKey(int64* address, int64 compare,
+                                              int64 val) {
+  return static_cast<int64>(atomicCAS(reinterpret_cast<uint64*>(address),
+                                      static_cast<uint64>(compare),
+                                      static_cast<uint64>(val)));
+}
+
+template <typename K, typename V>
+__global__ void ClearKernel(const int64 num_buckets, const int64 value_size,
+                            const K empty_key, K* key_buckets,
+                            V* value_buckets) {
+  CUDA_1D_KERNEL_LOOP(i, num_buckets) {
+    key_buckets[i] = empty_key;
+    for (int64 j = 0; j < value_size; ++j) {
+      value_buckets[i * value_size + j] = V();
+    }
+  }
+}
+
+// Each thread inserts one key. A bucket is claimed by swapping the empty key
+// for the key, so concurrent inserts of different keys never share a bucket.
+// Buckets are probed quadratically, like MutableDenseHashTable does on CPU.
+template <typename K, typename V>
+__global__ void InsertKernel(const int64 num_keys, const int64 value_size,
+                             const K* keys, const V* values, const K empty_key,
+                             const int64 num_buckets, K* key_buckets,
+                             V* value_buckets, int32* counters) {
+  const int64 bit_mask = num_buckets - 1;
+  CUDA_1D_KERNEL_LOOP(i, num_keys) {
+    const K key = ldg(keys + i);
+    if (key == empty_key) {
+      CudaAtomicAdd(counters + functor::kNumEmptyKeys, 1);
+      continue;
+    }
+    int64 bucket = HashKey(key) & bit_mask;
+    int64 num_probes = 0;
+    while (true) {
+      const K previous = AtomicCasKey(key_buckets + bucket, empty_key, key);
+      if (previous == empty_key || previous == key) {
+        if (previous == empty_key) {
+          CudaAtomicAdd(counters + functor::kNumInsertedKeys, 1);
+        }
+        for (int64 j = 0; j < value_size; ++j) {
+          value_buckets[bucket * value_size + j] =
+              ldg(values + i * value_size + j);
+        }
+        break;
+      }
+      ++num_probes;
+      if (num_probes >= num_buckets) {
+        CudaAtomicAdd(counters + functor::kNumDroppedKeys, 1);
+        break;
+      }
+      bucket = (bucket + num_probes) & bit_mask;  // quadratic probing
+    }
+  }
+}
+
+// Each thread looks up one key.
+template <typename K, typename V>
+__global__ void FindKernel(const int64 num_keys, const int64 value_size,
+                           const K* keys, const K empty_key,
+                           const int64 num_buckets, const K* key_buckets,
+                           const V* value_buckets, const V* default_value,
+                           V* values) {
+  const int64 bit_mask = num_buckets - 1;
+  CUDA_1D_KERNEL_LOOP(i, num_keys) {
+    const K key = ldg(keys + i);
+    int64 found = -1;
+    if (key != empty_key) {
+      int64 bucket = HashKey(key) & bit_mask;
+      for (int64 num_probes = 1; num_probes <= num_buckets; ++num_probes) {
+        const K bucket_key = ldg(key_buckets + bucket);
+        if (bucket_key == key) {
+          found = bucket;
+          break;
+        }
+        if (bucket_key == empty_key) {
+          break;
+        }
+        bucket = (bucket + num_probes) & bit_mask;  // quadratic probing
+      }
+    }
+    for (int64 j = 0; j < value_size; ++j) {
+      values[i * value_size + j] =
+          found >= 0 ? ldg(value_buckets + found * value_size + j)
+                     : ldg(default_value + j);
+    }
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename K, typename V>
+void DenseHashTableClear<K, V>::operator()(
+    const GPUDevice& d, K empty_key, typename TTypes<K>::Flat key_buckets,
+    typename TTypes<V>::Flat value_buckets) {
+  const int64 num_buckets = key_buckets.size();
+  if (num_buckets == 0) {
+    return;
+  }
+  CudaLaunchConfig config = GetCudaLaunchConfig(num_buckets, d);
+  ClearKernel<K, V>
+      <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+          num_buckets, value_buckets.size() / num_buckets, empty_key,
+          key_buckets.data(), value_buckets.data());
+}
+
+template <typename K, typename V>
+void DenseHashTableInsert<K, V>::operator()(
+    const GPUDevice& d, typename TTypes<K>::ConstFlat keys,
+    typename TTypes<V>::ConstMatrix values, K empty_key,
+    typename TTypes<K>::Flat key_buckets,
+    typename TTypes<V>::Matrix value_buckets, int32* counters) {
+  CudaLaunchConfig config = GetCudaLaunchConfig(kNumInsertCounters, d);
+  SetZero<<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+      kNumInsertCounters, counters);
+  const int64 num_keys = keys.size();
+  if (num_keys == 0) {
+    return;
+  }
+  config = GetCudaLaunchConfig(num_keys, d);
+  InsertKernel<K, V>
+      <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+          num_keys, values.dimension(1), keys.data(), values.data(), empty_key,
+          key_buckets.size(), key_buckets.data(), value_buckets.data(),
+          counters);
+}
+
+template <typename K, typename V>
+void DenseHashTableFind<K, V>::operator()(
+    const GPUDevice& d, typename TTypes<K>::ConstFlat keys, K empty_key,
+    typename TTypes<K>::ConstFlat key_buckets,
+    typename TTypes<V>::ConstMatrix value_buckets,
+    typename TTypes<V>::ConstFlat default_value,
+    typename TTypes<V>::Matrix values) {
+  const int64 num_keys = keys.size();
+  if (num_keys == 0) {
+    return;
+  }
+  CudaLaunchConfig config = GetCudaLaunchConfig(num_keys, d);
+  FindKernel<K, V>
+      <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+          num_keys, values.dimension(1), keys.data(), empty_key,
+          key_buckets.size(), key_buckets.data(), value_buckets.data(),
+          default_value.data(), values.data());
+}
+
+#define DEFINE_GPU_SPECS(K, V)                \
+  template struct DenseHashTableClear<K, V>;  \
+  template struct DenseHashTableInsert<K, V>; \
+  template struct DenseHashTableFind<K, V>;
+
+#define DEFINE_GPU_SPECS_FOR_KEY(K) \
+  DEFINE_GPU_SPECS(K, int32);       \
+  DEFINE_GPU_SPECS(K, int64);       \
+  DEFINE_GPU_SPECS(K, float);
+
+DEFINE_GPU_SPECS_FOR_KEY(int32);
+DEFINE_GPU_SPECS_FOR_KEY(int64);
+
+#undef DEFINE_GPU_SPECS_FOR_KEY
+#undef DEFINE_GPU_SPECS
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -0,0 +1,77 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
+#define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace functor {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// The counters written by DenseHashTableInsert.
+enum DenseHashTableInsertCounter {
+  kNumInsertedKeys = 0,  // keys that were not in the table
+  kNumEmptyKeys = 1,     // keys equal to the empty key, which are skipped
+  kNumDroppedKeys = 2,   // keys that found no free bucket
+  kNumInsertCounters = 3,
+};
+
+// Sets every key bucket to "empty_key" and every value bucket to V().
+template <typename K, typename V>
+struct DenseHashTableClear {
+  void operator()(const GPUDevice& d, K empty_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<V>::Flat value_buckets);
+};
+
+// Inserts row i of "values" under keys(i) into the open-addressing table held
+// in "key_buckets" and "value_buckets", whose number of rows is a power of 2.
+// Sets "counters", which lives in device memory, to the number of keys of each
+// DenseHashTableInsertCounter kind. If a key appears more than once in "keys",
+// which of its values is kept is unspecified.
+template <typename K, typename V>
+struct DenseHashTableInsert {
+  void operator()(const GPUDevice& d, typename TTypes<K>::ConstFlat keys,
+                  typename TTypes<V>::ConstMatrix values, K empty_key,
+                  typename TTypes<K>::Flat key_buckets,
+                  typename TTypes<V>::Matrix value_buckets, int32* counters);
+};
+
+// Sets row i of "values" to the value of keys(i) in the table, or to
+// "default_value" if keys(i) is not in the table or is the empty key.
+template <typename K, typename V>
+struct DenseHashTableFind {
+  void operator()(const GPUDevice& d, typename TTypes<K>::ConstFlat keys,
+                  K empty_key, typename TTypes<K>::ConstFlat key_buckets,
+                  typename TTypes<V>::ConstMatrix value_buckets,
+                  typename TTypes<V>::ConstFlat default_value,
+                  typename TTypes<V>::Matrix values);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
+
+#endif  // TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_GPU_H_
@@ -0,0 +1,162 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/lookup_table_op.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/lookup_util.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+template <class K, class V>
+HashTable<K, V>* MakeTable(const Tensor& keys, const Tensor& values) {
+  HashTable<K, V>* table = new HashTable<K, V>(nullptr, nullptr);
+  KeyValueTensorIterator iter(&keys, &values);
+  TF_CHECK_OK(table->Initialize(iter));
+  return table;
+}
+
+TEST(HashTableTest, FindInt64) {
+  Tensor keys = test::AsTensor<int64>({3, 1, 100, -7, 1 << 20});
+  Tensor values = test::AsTensor<int64>({30, 10, 1000, -70, 5});
+  HashTable<int64, int64>* table = MakeTable<int64, int64>(keys, values);
+  core::ScopedUnref unref(table);
+  EXPECT_EQ(5, table->size());
+
+  Tensor lookup = test::AsTensor<int64>({1, 2, -7, 1 << 20, 3, 100, 0});
+  Tensor found(DT_INT64, lookup.shape());
+  TF_ASSERT_OK(
+      table->Find(nullptr, lookup, &found, test::AsScalar<int64>(-1)));
+  test::ExpectTensorEqual<int64>(
+      test::AsTensor<int64>({10, -1, -70, 5, 30, 1000, -1}), found);
+}
+
+TEST(HashTableTest, FindString) {
+  Tensor keys = test::AsTensor<string>({"brain", "salad", "surgery"});
+  Tensor values = test::AsTensor<int64>({0, 1, 2});
+  HashTable<string, int64>* table = MakeTable<string, int64>(keys, values);
+  core::ScopedUnref unref(table);
+
+  Tensor lookup = test::AsTensor<string>({"salad", "tank", "surgery", ""});
+  Tensor found(DT_INT64, lookup.shape());
+  TF_ASSERT_OK(
+      table->Find(nullptr, lookup, &found, test::AsScalar<int64>(-1)));
+  test::ExpectTensorEqual<int64>(test::AsTensor<int64>({1, -1, 2, -1}), found);
+}
+
+TEST(HashTableTest, ManyKeys) {
+  // Enough keys that the table grows past its initial size, with a stride
+  // that would collide in the low bits without mixing.
+  const int64 num_keys = 10000;
+  Tensor keys(DT_INT64, TensorShape({num_keys}));
+  Tensor values(DT_INT64, TensorShape({num_keys}));
+  for (int64 i = 0; i < num_keys; ++i) {
+    keys.vec<int64>()(i) = i << 16;
+    values.vec<int64>()(i) = i;
+  }
+  HashTable<int64, int64>* table = MakeTable<int64, int64>(keys, values);
+  core::ScopedUnref unref(table);
+  EXPECT_EQ(num_keys, table->size());
+
+  Tensor found(DT_INT64, keys.shape());
+  TF_ASSERT_OK(table->Find(nullptr, keys, &found, test::AsScalar<int64>(-1)));
+  test::ExpectTensorEqual<int64>(values, found);
+}
+
+TEST(HashTableTest, DuplicateKeys) {
+  Tensor keys = test::AsTensor<int64>({1, 2, 1});
+  Tensor same_values = test::AsTensor<int64>({10, 20, 10});
+  HashTable<int64, int64>* table = MakeTable<int64, int64>(keys, same_values);
+  core::ScopedUnref unref(table);
+  EXPECT_EQ(2, table->size());
+
+  Tensor other_values = test::AsTensor<int64>({10, 20, 30});
+  HashTable<int64, int64>* other_table =
+      new HashTable<int64, int64>(nullptr, nullptr);
+  core::ScopedUnref other_unref(other_table);
+  KeyValueTensorIterator iter(&keys, &other_values);
+  EXPECT_TRUE(errors::IsFailedPrecondition(other_table->Initialize(iter)));
+  EXPECT_EQ(0, other_table->size());
+}
+
+void MakeKeys(int64 num_keys, int64 num_lookups, Tensor* keys,
+              Tensor* values, Tensor* lookups) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  *keys = Tensor(DT_INT64, TensorShape({num_keys}));
+  *values = Tensor(DT_INT64, TensorShape({num_keys}));
+  for (int64 i = 0; i < num_keys; ++i) {
+    keys->vec<int64>()(i) = rnd.Rand64();
+    values->vec<int64>()(i) = i;
+  }
+  *lookups = Tensor(DT_INT64, TensorShape({num_lookups}));
+  for (int64 i = 0; i < num_lookups; ++i) {
+    lookups->vec<int64>()(i) = keys->vec<int64>()(rnd.Uniform(num_keys));
+  }
+}
+
+static void BM_HashTableFind(int iters, int num_keys) {
+  testing::StopTiming();
+  const int64 num_lookups = 1 << 16;
+  Tensor keys, values, lookups;
+  MakeKeys(num_keys, num_lookups, &keys, &values, &lookups);
+  HashTable<int64, int64>* table = MakeTable<int64, int64>(keys, values);
+  core::ScopedUnref unref(table);
+  Tensor found(DT_INT64, lookups.shape());
+  const Tensor default_value = test::AsScalar<int64>(-1);
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_lookups);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(table->Find(nullptr, lookups, &found, default_value));
+  }
+}
+BENCHMARK(BM_HashTableFind)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 22);
+
+// The unordered_map the table used to be backed by, for comparison.
+static void BM_UnorderedMapFind(int iters, int num_keys) {
+  testing::StopTiming();
+  const int64 num_lookups = 1 << 16;
+  Tensor keys, values, lookups;
+  MakeKeys(num_keys, num_lookups, &keys, &values, &lookups);
+  std::unordered_map<int64, int64> table;
+  for (int64 i = 0; i < num_keys; ++i) {
+    table[keys.vec<int64>()(i)] = values.vec<int64>()(i);
+  }
+  Tensor found(DT_INT64, lookups.shape());
+  const auto lookups_vec = lookups.vec<int64>();
+  auto found_vec = found.vec<int64>();
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_lookups);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    for (int64 j = 0; j < num_lookups; ++j) {
+      found_vec(j) = gtl::FindWithDefault(table, lookups_vec(j), -1);
+    }
+  }
+}
+BENCHMARK(BM_UnorderedMapFind)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 22);
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
@@ -14,13 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/captured_function.h"
 #include "tensorflow/core/kernels/dataset.h"
 #include "tensorflow/core/kernels/inplace_ops_functor.h"
-#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -36,7 +37,8 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit MapAndBatchDatasetOp(OpKernelConstruction* ctx)
       : UnaryDatasetOpKernel(ctx),
-        graph_def_version_(ctx->graph_def_version()) {
+        graph_def_version_(ctx->graph_def_version()),
+        op_version_(ctx->def().op() == "MapAndBatchDataset" ? 1 : 2) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
@@ -60,11 +62,26 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         errors::InvalidArgument("batch_size must be greater than zero."));
 
     int64 num_parallel_batches;
-    OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_batches",
-                                            &num_parallel_batches));
-    OP_REQUIRES(ctx, num_parallel_batches > 0,
-                errors::InvalidArgument(
-                    "num_parallel_batches must be greater than zero."));
+    int64 num_parallel_calls;
+    if (op_version_ == 1) {
+      OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_batches",
+                                              &num_parallel_batches));
+      OP_REQUIRES(ctx, num_parallel_batches > 0,
+                  errors::InvalidArgument(
+                      "num_parallel_batches must be greater than zero."));
+      num_parallel_calls = batch_size * num_parallel_batches;
+    } else {
+      OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
+                                              &num_parallel_calls));
+      OP_REQUIRES(ctx, num_parallel_calls > 0,
+                  errors::InvalidArgument(
+                      "num_parallel_calls must be greater than zero."));
+      // Enough batches for `num_parallel_calls` invocations to be in flight,
+      // and at least two, so that the next batch is produced while the
+      // consumer uses the current one.
+      num_parallel_batches = std::max<int64>(
+          2, (num_parallel_calls + batch_size - 1) / batch_size);
+    }
 
     std::unique_ptr<CapturedFunction> captured_func;
     OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_, graph_def_version_,
@@ -72,7 +89,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
                                                  &captured_func));
 
     *output = new Dataset(input, batch_size, num_parallel_batches,
-                          output_types_, output_shapes_,
+                          num_parallel_calls, output_types_, output_shapes_,
                           std::move(captured_func), &ctx->eigen_cpu_device());
   }
 
@@ -80,13 +97,15 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   class Dataset : public DatasetBase {
    public:
     Dataset(const DatasetBase* input, int64 batch_size,
-            int64 num_parallel_batches, const DataTypeVector& output_types,
+            int64 num_parallel_batches, int64 num_parallel_calls,
+            const DataTypeVector& output_types,
             const std::vector<PartialTensorShape>& output_shapes,
             std::unique_ptr<CapturedFunction> captured_func,
             const Eigen::ThreadPoolDevice* device)
         : input_(input),
           batch_size_(batch_size),
           num_parallel_batches_(num_parallel_batches),
+          num_parallel_calls_(num_parallel_calls),
           output_types_(output_types),
           output_shapes_(output_shapes),
           captured_func_(std::move(captured_func)),
@@ -113,14 +132,22 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
     string DebugString() override { return "MapAndBatchDatasetOp::Dataset"; }
 
    private:
+    // The iterator produces the elements of up to `num_parallel_batches_`
+    // batches at once, with up to `num_parallel_calls_` invocations of the
+    // function in flight. Invocations are started in order of batch and offset
+    // by the thread that calls GetNext(), while it waits for a batch and before
+    // it returns one. Each invocation copies its outputs into its slot of the
+    // batch on the thread that ran the function, as soon as it finishes.
     class Iterator : public DatasetIterator<Dataset> {
      public:
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
             input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
-            invocation_results_(params.dataset->batch_size_ *
-                                params.dataset->num_parallel_batches_),
-            batch_results_(params.dataset->num_parallel_batches_) {}
+            batch_results_(params.dataset->num_parallel_batches_) {
+        for (BatchResult& batch_result : batch_results_) {
+          batch_result.return_values.resize(params.dataset->batch_size_);
+        }
+      }
 
       ~Iterator() override {
         // TODO(mrry): Replace this cancellation logic with a
@@ -129,97 +156,93 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         // through the IteratorContext to upstream,
         // potentially-blocking iterators, when we add these.
         mutex_lock l(mu_);
-        if (current_batch_index_ != -1) {
-          for (size_t batch_index = 0;
-               batch_index < dataset()->num_parallel_batches_; ++batch_index) {
-            int64 num_elements;
-            WaitForBatch(batch_index, &num_elements).IgnoreError();
-            // Deallocate tensors allocated for the output.
-            batch_results_[batch_index].output.clear();
-          }
+        // The in-flight invocations refer to this iterator.
+        while (num_calls_ > 0) {
+          cond_var_.wait(l);
         }
       }
 
-      // TODO(jsimsa): Implement and profile the following alternative design:
-      //
-      // 0. Set the number of in-flight batches and invocations independently
-      // (though obviously the max number of in-flight invocations must be <
-      // batch_size * num_parallel_batches). Maintain a current producing batch
-      // index and offset.
-      // 1. Issue invocations in order of batch and offset, as you do currently.
-      // 2. When an invocation finishes, increment the current producing batch
-      // and offset. If that invocation would start a new batch and give more
-      // than num_parallel_batches in-flight, block; else start the new
-      // invocation into that location.
-      // 3. When a GetNext() call arrives, block until there's a full batch.
-      // Before returning the batch, if the number of pending invocations is
-      // less than the max, issue that number of invocations.
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
-
-        // One-time initialization.
-        if (current_batch_index_ == -1) {
-          current_batch_index_ = 0;
-          for (size_t i = 0; i < dataset()->num_parallel_batches_; ++i) {
-            StartInvocationBatch(ctx, i);
+        BatchResult* result =
+            &batch_results_[consumer_batch_ % batch_results_.size()];
+        {
+          port::Tracing::TraceMe activity(strings::StrCat(prefix(), "::Wait"));
+          // Start the invocations for the slots that became free while
+          // waiting for the current batch.
+          StartCallsLocked(ctx);
+          while (!BatchCompleteLocked(*result)) {
+            cond_var_.wait(l);
+            StartCallsLocked(ctx);
           }
         }
 
-        int64 num_elements = 0;
-        Status status = WaitForBatch(current_batch_index_, &num_elements);
+        const int64 num_elements = result->num_elements;
         if (num_elements == 0) {
           *end_of_sequence = true;
           return Status::OK();
         }
-        if (!status.ok()) {
-          // Deallocate tensors allocated for the output.
-          batch_results_[current_batch_index_].output.clear();
-        } else {
+        Status status = result->status;
+        if (status.ok()) {
           if (num_elements < dataset()->batch_size_) {
-            const std::vector<Tensor>& output =
-                batch_results_[current_batch_index_].output;
+            const std::vector<Tensor>& output = result->output;
             for (size_t i = 0; i < output.size(); ++i) {
-              TensorShape component_shape(
-                  batch_results_[current_batch_index_].output[i].shape());
+              TensorShape component_shape(output[i].shape());
               component_shape.set_dim(0, num_elements);
-              Tensor component(cpu_allocator(), output[i].dtype(),
+              Tensor component(ctx->allocator({}), output[i].dtype(),
                                component_shape);
               TF_RETURN_IF_ERROR(
                   CopyPartialBatch(&component, output[i], num_elements));
               out_tensors->emplace_back(std::move(component));
             }
-            // Deallocate tensors allocated for the output.
-            batch_results_[current_batch_index_].output.clear();
           } else {
-            *out_tensors =
-                std::move(batch_results_[current_batch_index_].output);
+            *out_tensors = std::move(result->output);
           }
           *end_of_sequence = false;
+        } else {
+          VLOG(3) << "failed to process batch " << consumer_batch_ << ": "
+                  << status;
         }
-        StartInvocationBatch(ctx, current_batch_index_);
-        current_batch_index_ =
-            (current_batch_index_ + 1) % dataset()->num_parallel_batches_;
+        // Deallocate tensors allocated for the output, and produce the next
+        // batch into the freed slot while the consumer uses this one.
+        ResetBatchLocked(result);
+        ++consumer_batch_;
+        StartCallsLocked(ctx);
         return status;
       }
 
      private:
       struct BatchResult {
-        mutex mu;
-        bool output_allocated GUARDED_BY(mu);
+        // The number of elements of the batch taken from the input, and how
+        // many of them have been processed.
+        int64 num_elements = 0;
+        int64 num_completed = 0;
+        Status status;
+        bool output_allocated = false;
+        // Written by the invocations outside `mu_` once allocated, each
+        // invocation into its own slot.
         std::vector<Tensor> output;
-        std::unique_ptr<BlockingCounter> counter;
+        // The return values of the invocation for each slot.
+        std::vector<std::vector<Tensor>> return_values;
       };
 
-      struct InvocationResult {
-        Status status;
-        bool end_of_input;
-        std::vector<Tensor> return_values;
-      };
+      // A batch is complete once all its elements have been processed, and
+      // either it is full or the input has no more elements.
+      bool BatchCompleteLocked(const BatchResult& result)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return result.num_completed == result.num_elements &&
+               (result.num_elements == dataset()->batch_size_ ||
+                end_of_input_);
+      }
 
-      int64 ComputeInvocationIndex(int64 batch_index, int64 offset) {
-        return batch_index * dataset()->batch_size_ + offset;
+      void ResetBatchLocked(BatchResult* result) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        result->num_elements = 0;
+        result->num_completed = 0;
+        result->status = Status::OK();
+        result->output_allocated = false;
+        result->output.clear();
       }
 
       Status CopyPartialBatch(Tensor* output, const Tensor& value,
@@ -245,41 +268,51 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         return Status::OK();
       }
 
-      void EnsureOutputAllocated(BatchResult* batch_result,
-                                 const std::vector<Tensor>& return_values) {
-        mutex_lock l(batch_result->mu);
-        if (batch_result->output_allocated) {
-          return;
+      // Copies the return values of an invocation into slot `offset` of the
+      // batch, allocating the batch from `allocator` first if this is its
+      // first invocation to finish.
+      Status CopyToBatch(Allocator* allocator, BatchResult* result,
+                         int64 offset, const std::vector<Tensor>& return_values)
+          LOCKS_EXCLUDED(mu_) {
+        {
+          mutex_lock l(mu_);
+          if (!result->output_allocated) {
+            for (const Tensor& value : return_values) {
+              TensorShape component_shape({dataset()->batch_size_});
+              component_shape.AppendShape(value.shape());
+              result->output.emplace_back(allocator, value.dtype(),
+                                          component_shape);
+            }
+            result->output_allocated = true;
+          }
         }
-        const size_t num_components = return_values.size();
-        for (size_t i = 0; i < num_components; ++i) {
-          TensorShape component_shape({dataset()->batch_size_});
-          component_shape.AppendShape(return_values[i].shape());
-          Tensor component(cpu_allocator(), return_values[i].dtype(),
-                           component_shape);
-          batch_result->output.emplace_back(std::move(component));
+        for (size_t i = 0; i < return_values.size(); ++i) {
+          const Tensor& tensor = return_values[i];
+          Tensor* batch = &result->output[i];
+          if (tensor.NumElements() !=
+              (batch->NumElements() / batch->dim_size(0))) {
+            TensorShape batch_shape = batch->shape();
+            batch_shape.RemoveDim(0);
+            return errors::InvalidArgument(
+                "Cannot add tensor to the batch: number of elements does not "
+                "match. Shapes are: [tensor]: ",
+                tensor.shape().DebugString(),
+                ", [batch]: ", batch_shape.DebugString());
+          }
+          // TODO(mrry): Add a version of DoParallelConcat that allows us to
+          // move `tensor` where possible, to speed up string tensor batching.
+          TF_RETURN_IF_ERROR(::tensorflow::functor::DoParallelConcat(
+              *dataset()->device_, tensor, offset, batch));
         }
-        batch_result->output_allocated = true;
+        return Status::OK();
       }
 
-      void InvokeFunctionLocked(IteratorContext* ctx, int64 batch_index,
-                                int64 offset) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-        size_t index = ComputeInvocationIndex(batch_index, offset);
-        InvocationResult* result = &invocation_results_[index];
-        BatchResult* batch_result = &batch_results_[batch_index];
-
-        // Get the next input element.
-        std::vector<Tensor> input_element;
-        result->status =
-            input_impl_->GetNext(ctx, &input_element, &result->end_of_input);
-        if (result->end_of_input || !result->status.ok()) {
-          batch_result->counter->DecrementCount();
-          return;
-        }
-
-        // Call `captured_func_(input_element)`, store the result in
-        // `result->return_values`, and notify `batch_result->counter`
-        // to unblock a consumer.
+      void InvokeFunctionLocked(IteratorContext* ctx, BatchResult* result,
+                                int64 offset, std::vector<Tensor> input_element)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        // Call `captured_func_(input_element)`, copy the result into slot
+        // `offset` of `result->output`, and notify `cond_var_` to unblock a
+        // consumer.
         FunctionLibraryRuntime::Options opts;
         opts.step_id = CapturedFunction::generate_step_id();
         ScopedStepContainer* step_container =
@@ -293,115 +326,94 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
         std::function<void(std::function<void()>)>* runner =
             new std::function<void(std::function<void()>)>(*ctx->runner());
         opts.runner = runner;
+        std::vector<Tensor>* return_values = &result->return_values[offset];
+        // `ctx` may not outlive the invocation.
+        Allocator* allocator = ctx->allocator({});
+        ++num_calls_;
         (*ctx->runner())(std::bind(
             [=](std::vector<Tensor> input_element) {
               dataset()->captured_func_->RunAsync(
-                  opts, std::move(input_element), &result->return_values,
-                  [this, step_container, runner, result, batch_result,
-                   offset](Status ret_status) {
+                  opts, std::move(input_element), return_values,
+                  [this, step_container, runner, allocator, result,
+                   return_values, offset](Status status) {
                     delete step_container;
                     delete runner;
-                    result->status.Update(ret_status);
-                    if (ret_status.ok()) {
-                      EnsureOutputAllocated(batch_result,
-                                            result->return_values);
-                      const size_t num_components =
-                          result->return_values.size();
-                      for (size_t i = 0; i < num_components; ++i) {
-                        const Tensor& tensor = result->return_values[i];
-                        Tensor* batch = &(batch_result->output)[i];
-                        if (tensor.NumElements() !=
-                            (batch->NumElements() / batch->dim_size(0))) {
-                          TensorShape batch_shape = batch->shape();
-                          batch_shape.RemoveDim(0);
-                          result->status.Update(errors::InvalidArgument(
-                              "Cannot add tensor to the batch: number of "
-                              "elements does not match. Shapes are: [tensor]: ",
-                              tensor.shape().DebugString(),
-                              ", [batch]: ", batch_shape.DebugString()));
-                          break;
-                        }
-                        // TODO(mrry): Add a version of DoParallelConcat that
-                        // allows us to move `tensor` where possible, to speed
-                        // up string tensor batching.
-                        Status copy_status =
-                            ::tensorflow::functor::DoParallelConcat(
-                                *dataset()->device_, tensor, offset, batch);
-                        if (!copy_status.ok()) {
-                          result->status.Update(copy_status);
-                          break;
-                        }
-                      }
+                    if (status.ok()) {
+                      status = CopyToBatch(allocator, result, offset,
+                                           *return_values);
                     }
                     // NOTE(mrry): We clear the return values here to release
                     // any memory associated with them and to paralellize the
                     // destruction of the tensors (which can be surprisingly
                     // expensive for map functions with large numbers of return
                     // values).
-                    result->return_values.clear();
-                    batch_result->counter->DecrementCount();
+                    return_values->clear();
+                    mutex_lock l(mu_);
+                    result->status.Update(status);
+                    ++result->num_completed;
+                    --num_calls_;
+                    cond_var_.notify_all();
                   });
             },
             std::move(input_element)));
       }
 
-      void StartInvocationBatch(IteratorContext* ctx, int64 batch_index)
+      // Takes elements from the input and starts their invocations, until
+      // `num_parallel_calls_` invocations are in flight or all the batches
+      // that may be produced have all their elements.
+      void StartCallsLocked(IteratorContext* ctx)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         port::Tracing::TraceMe activity(strings::StrCat(prefix(), "::Start"));
-        // Initialize batch result.
-        {
-          mutex_lock l(batch_results_[batch_index].mu);
-          batch_results_[batch_index].output_allocated = false;
-          batch_results_[batch_index].counter.reset(
-              new BlockingCounter(dataset()->batch_size_));
-        }
-        // Initialize invocation results.
-        for (size_t i = 0; i < dataset()->batch_size_; ++i) {
-          size_t index = ComputeInvocationIndex(batch_index, i);
-          InvocationResult* result = &invocation_results_[index];
-          // Reset the state of `result`; `result->return_values` was cleared
-          // when the previous invocation completed.
-          result->end_of_input = false;
-          result->status = Status::OK();
-        }
-        // Start individual invocations.
-        for (size_t i = 0; i < dataset()->batch_size_; ++i) {
-          InvokeFunctionLocked(ctx, batch_index, i);
-        }
-      }
-
-      Status WaitForBatch(int64 batch_index, int64* num_elements)
-          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-        port::Tracing::TraceMe activity(strings::StrCat(prefix(), "::Wait"));
-        batch_results_[batch_index].counter->Wait();
-        Status status = Status::OK();
-        for (size_t i = 0; i < dataset()->batch_size_; ++i, ++*num_elements) {
-          size_t index = ComputeInvocationIndex(batch_index, i);
-          InvocationResult* result = &invocation_results_[index];
-          if (result->end_of_input) {
-            VLOG(3) << "end of input encountered at element[" << i << "]: ";
-            return Status::OK();
+        while (!end_of_input_ && num_calls_ < dataset()->num_parallel_calls_ &&
+               producer_batch_ - consumer_batch_ < batch_results_.size()) {
+          BatchResult* result =
+              &batch_results_[producer_batch_ % batch_results_.size()];
+          const int64 offset = result->num_elements;
+
+          // Get the next input element.
+          std::vector<Tensor> input_element;
+          bool end_of_input = false;
+          Status status =
+              input_impl_->GetNext(ctx, &input_element, &end_of_input);
+          if (end_of_input) {
+            VLOG(3) << "end of input encountered at element[" << offset
+                    << "] of batch " << producer_batch_;
+            end_of_input_ = true;
+            return;
+          }
+          if (++result->num_elements == dataset()->batch_size_) {
+            ++producer_batch_;
           }
-          if (!result->status.ok()) {
-            VLOG(3) << "failed to process element[" << i
-                    << "]: " << result->status;
-            status.Update(result->status);
+          if (!status.ok()) {
+            VLOG(3) << "failed to get element[" << offset << "]: " << status;
+            result->status.Update(status);
+            ++result->num_completed;
+            continue;
           }
+          InvokeFunctionLocked(ctx, result, offset, std::move(input_element));
         }
-        return status;
       }
 
       mutex mu_;
-      int32 current_batch_index_ GUARDED_BY(mu_) = -1;
+      // Signalled when an invocation finishes.
+      condition_variable cond_var_;
       const std::unique_ptr<IteratorBase> input_impl_ GUARDED_BY(mu_);
-      std::vector<InvocationResult> invocation_results_ GUARDED_BY(mu_);
+      // The batches being produced, indexed by batch number modulo their
+      // count.
       std::vector<BatchResult> batch_results_ GUARDED_BY(mu_);
+      // The numbers of the batch returned by the next GetNext() call and of
+      // the batch that the next input element goes into.
+      int64 consumer_batch_ GUARDED_BY(mu_) = 0;
+      int64 producer_batch_ GUARDED_BY(mu_) = 0;
+      int64 num_calls_ GUARDED_BY(mu_) = 0;
+      bool end_of_input_ GUARDED_BY(mu_) = false;
     };
 
     const DatasetBase* const input_;
     const NameAttrList func_;
     const int64 batch_size_;
     const int64 num_parallel_batches_;
+    const int64 num_parallel_calls_;
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
     const std::unique_ptr<CapturedFunction> captured_func_;
@@ -409,6 +421,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   };
 
   const int graph_def_version_;
+  const int op_version_;
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   NameAttrList func_;
@@ -416,6 +429,8 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
 
 REGISTER_KERNEL_BUILDER(Name("MapAndBatchDataset").Device(DEVICE_CPU),
                         MapAndBatchDatasetOp);
+REGISTER_KERNEL_BUILDER(Name("MapAndBatchDatasetV2").Device(DEVICE_CPU),
+                        MapAndBatchDatasetOp);
 
 }  // namespace
 
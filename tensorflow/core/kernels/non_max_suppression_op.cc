@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/non_max_suppression_op.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,11 +33,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
 
 static inline void ParseAndCheckBoxSizes(OpKernelContext* context,
                                          const Tensor& boxes,
@@ -258,6 +262,70 @@ void DoNonMaxSuppressionOp3D(OpKernelContext* context,
 
 }  // namespace
 
+namespace functor {
+
+template <>
+Status BatchedNonMaxSuppression<CPUDevice>::operator()(
+    OpKernelContext* context, typename TTypes<float, 3>::ConstTensor boxes,
+    typename TTypes<float, 3>::ConstTensor scores, float iou_threshold,
+    float score_threshold, typename TTypes<int, 3>::Tensor selected_indices,
+    typename TTypes<int, 2>::Tensor num_valid) {
+  const int batch_size = scores.dimension(0);
+  const int num_boxes = scores.dimension(1);
+  const int num_classes = scores.dimension(2);
+  const int max_output_size = selected_indices.dimension(2);
+
+  // Each unit of work is one class of one image.
+  auto work = [&boxes, &scores, iou_threshold, score_threshold,
+               &selected_indices, &num_valid, num_boxes, num_classes,
+               max_output_size](int64 begin, int64 end) {
+    std::vector<int> candidates;
+    std::vector<int> selected;
+    for (int64 segment = begin; segment < end; ++segment) {
+      const int b = segment / num_classes;
+      const int c = segment % num_classes;
+      typename TTypes<float, 2>::ConstTensor image_boxes(
+          boxes.data() + b * num_boxes * 4, num_boxes, 4);
+      candidates.clear();
+      for (int i = 0; i < num_boxes; ++i) {
+        if (scores(b, i, c) > score_threshold) candidates.push_back(i);
+      }
+      std::stable_sort(candidates.begin(), candidates.end(),
+                       [&scores, b, c](const int i, const int j) {
+                         return scores(b, i, c) > scores(b, j, c);
+                       });
+      selected.clear();
+      for (const int i : candidates) {
+        if (selected.size() >= max_output_size) break;
+        bool should_select = true;
+        // Overlapping boxes are likely to have similar scores,
+        // therefore we iterate through the selected boxes backwards.
+        for (int j = static_cast<int>(selected.size()) - 1; j >= 0; --j) {
+          if (IOUGreaterThanThreshold(image_boxes, i, selected[j],
+                                      iou_threshold)) {
+            should_select = false;
+            break;
+          }
+        }
+        if (should_select) selected.push_back(i);
+      }
+      for (int k = 0; k < max_output_size; ++k) {
+        selected_indices(b, c, k) = k < selected.size() ? selected[k] : 0;
+      }
+      num_valid(b, c) = selected.size();
+    }
+  };
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  // At most max_output_size comparisons per box, plus the sort.
+  const int64 cost_per_unit =
+      static_cast<int64>(num_boxes) * (std::max(max_output_size, 1) + 20) * 10;
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        batch_size * num_classes, cost_per_unit, work);
+  return Status::OK();
+}
+
+}  // namespace functor
+
 template <typename Device>
 class NonMaxSuppressionOp : public OpKernel {
  public:
@@ -350,6 +418,88 @@ class NonMaxSuppressionOp3D : public OpKernel {
   }
 };
 
+template <typename Device>
+class BatchedNonMaxSuppressionOp : public OpKernel {
+ public:
+  explicit BatchedNonMaxSuppressionOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    // boxes: [batch_size, num_boxes, 4]
+    const Tensor& boxes = context->input(0);
+    OP_REQUIRES(context, boxes.dims() == 3 && boxes.dim_size(2) == 4,
+                errors::InvalidArgument(
+                    "boxes must be 3-D with 4 columns, got shape ",
+                    boxes.shape().DebugString()));
+    // scores: [batch_size, num_boxes, num_classes]
+    const Tensor& scores = context->input(1);
+    OP_REQUIRES(context, scores.dims() == 3,
+                errors::InvalidArgument("scores must be 3-D, got shape ",
+                                        scores.shape().DebugString()));
+    OP_REQUIRES(context,
+                scores.dim_size(0) == boxes.dim_size(0) &&
+                    scores.dim_size(1) == boxes.dim_size(1),
+                errors::InvalidArgument(
+                    "scores has incompatible shape ",
+                    scores.shape().DebugString(), " for boxes of shape ",
+                    boxes.shape().DebugString()));
+    OP_REQUIRES(
+        context,
+        FastBoundsCheck(scores.NumElements(),
+                        std::numeric_limits<int32>::max()),
+        errors::InvalidArgument("scores has too many elements: ",
+                                scores.NumElements()));
+    // max_output_size_per_class: scalar
+    const Tensor& max_output_size = context->input(2);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(max_output_size.shape()),
+        errors::InvalidArgument("max_output_size_per_class must be 0-D, got "
+                                "shape ",
+                                max_output_size.shape().DebugString()));
+    const int max_output_size_val = max_output_size.scalar<int>()();
+    OP_REQUIRES(context, max_output_size_val >= 0,
+                errors::InvalidArgument(
+                    "max_output_size_per_class must be non-negative, got ",
+                    max_output_size_val));
+    // iou_threshold: scalar
+    const Tensor& iou_threshold = context->input(3);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(iou_threshold.shape()),
+        errors::InvalidArgument("iou_threshold must be 0-D, got shape ",
+                                iou_threshold.shape().DebugString()));
+    const float iou_threshold_val = iou_threshold.scalar<float>()();
+    OP_REQUIRES(context, iou_threshold_val >= 0 && iou_threshold_val <= 1,
+                errors::InvalidArgument("iou_threshold must be in [0, 1]"));
+    // score_threshold: scalar
+    const Tensor& score_threshold = context->input(4);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(score_threshold.shape()),
+        errors::InvalidArgument("score_threshold must be 0-D, got shape ",
+                                score_threshold.shape().DebugString()));
+    const float score_threshold_val = score_threshold.scalar<float>()();
+
+    const int64 batch_size = scores.dim_size(0);
+    const int64 num_boxes = scores.dim_size(1);
+    const int64 num_classes = scores.dim_size(2);
+    const int64 output_size = std::min<int64>(max_output_size_val, num_boxes);
+    Tensor* selected_indices = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({batch_size, num_classes, output_size}),
+                       &selected_indices));
+    Tensor* num_valid = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                1, TensorShape({batch_size, num_classes}),
+                                &num_valid));
+    OP_REQUIRES_OK(context,
+                   functor::BatchedNonMaxSuppression<Device>()(
+                       context, boxes.tensor<float, 3>(),
+                       scores.tensor<float, 3>(), iou_threshold_val,
+                       score_threshold_val, selected_indices->tensor<int, 3>(),
+                       num_valid->tensor<int, 2>()));
+  }
+};
+
 REGISTER_KERNEL_BUILDER(Name("NonMaxSuppression").Device(DEVICE_CPU),
                         NonMaxSuppressionOp<CPUDevice>);
 
@@ -358,4 +508,26 @@ REGISTER_KERNEL_BUILDER(Name("NonMaxSuppressionV2").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(Name("NonMaxSuppression3D").Device(DEVICE_CPU),
                         NonMaxSuppressionOp3D<CPUDevice>);
 
+REGISTER_KERNEL_BUILDER(Name("BatchedNonMaxSuppression").Device(DEVICE_CPU),
+                        BatchedNonMaxSuppressionOp<CPUDevice>);
+
+#if GOOGLE_CUDA
+// Forward declaration of the functor specialization for GPU.
+namespace functor {
+template <>
+Status BatchedNonMaxSuppression<GPUDevice>::operator()(
+    OpKernelContext* context, typename TTypes<float, 3>::ConstTensor boxes,
+    typename TTypes<float, 3>::ConstTensor scores, float iou_threshold,
+    float score_threshold, typename TTypes<int, 3>::Tensor selected_indices,
+    typename TTypes<int, 2>::Tensor num_valid);
+}  // namespace functor
+
+REGISTER_KERNEL_BUILDER(Name("BatchedNonMaxSuppression")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("max_output_size_per_class")
+                            .HostMemory("iou_threshold")
+                            .HostMemory("score_threshold"),
+                        BatchedNonMaxSuppressionOp<GPUDevice>);
+#endif  // GOOGLE_CUDA
+
 }  // namespace tensorflow
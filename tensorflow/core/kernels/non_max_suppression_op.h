@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/numeric_types.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
 
 namespace tensorflow {
@@ -39,6 +40,22 @@ struct NonMaxSuppression3D {
                   typename TTypes<int, 1>::Tensor selected_indices);
 };
 
+// Runs non max suppression independently for each image and class of the
+// [batch, num_boxes, num_classes] "scores", over the [batch, num_boxes, 4]
+// "boxes" of the image. Only boxes with a score above "score_threshold" are
+// candidates. The indices of the boxes selected for image b and class c are
+// written to selected_indices(b, c, :), padded with 0, and their number to
+// num_valid(b, c). Boxes with equal scores are visited in order of index.
+template <typename Device>
+struct BatchedNonMaxSuppression {
+  Status operator()(OpKernelContext* context,
+                    typename TTypes<float, 3>::ConstTensor boxes,
+                    typename TTypes<float, 3>::ConstTensor scores,
+                    float iou_threshold, float score_threshold,
+                    typename TTypes<int, 3>::Tensor selected_indices,
+                    typename TTypes<int, 2>::Tensor num_valid);
+};
+
 }  // namespace functor
 }  // namespace tensorflow
 
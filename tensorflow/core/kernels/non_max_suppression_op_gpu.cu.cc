@@ -0,0 +1,283 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/non_max_suppression_op.h"
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "external/cub_archive/cub/device/device_segmented_radix_sort.cuh"
+#include "external/cub_archive/cub/iterator/counting_input_iterator.cuh"
+#include "external/cub_archive/cub/iterator/transform_input_iterator.cuh"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// The number of boxes whose overlaps are packed into one word of the mask.
+constexpr int kNmsBlockSize = 64;
+
+// The selection kernel keeps one bit per box of a segment in shared memory.
+constexpr int kMaxNmsWords = 48 * 1024 / sizeof(uint64);
+
+// A segment holds the boxes of one class of one image. Gathers the scores of
+// each segment into a row of "segment_scores", next to the indices of the
+// boxes, for the segmented sort.
+__global__ void GatherSegmentScoresKernel(const float* scores, int num_boxes,
+                                          int num_classes, int num_segments,
+                                          float* segment_scores,
+                                          int* box_indices) {
+  CUDA_1D_KERNEL_LOOP(idx, num_segments * num_boxes) {
+    const int segment = idx / num_boxes;
+    const int box = idx % num_boxes;
+    const int batch = segment / num_classes;
+    const int cls = segment % num_classes;
+    segment_scores[idx] =
+        ldg(scores + (batch * num_boxes + box) * num_classes + cls);
+    box_indices[idx] = box;
+  }
+}
+
+// Same as IOUGreaterThanThreshold in non_max_suppression_op.cc.
+__device__ inline bool OverlapsMoreThan(const float4& a, const float4& b,
+                                        float iou_threshold) {
+  const float ymin_a = fminf(a.x, a.z);
+  const float xmin_a = fminf(a.y, a.w);
+  const float ymax_a = fmaxf(a.x, a.z);
+  const float xmax_a = fmaxf(a.y, a.w);
+  const float ymin_b = fminf(b.x, b.z);
+  const float xmin_b = fminf(b.y, b.w);
+  const float ymax_b = fmaxf(b.x, b.z);
+  const float xmax_b = fmaxf(b.y, b.w);
+  const float area_a = (ymax_a - ymin_a) * (xmax_a - xmin_a);
+  const float area_b = (ymax_b - ymin_b) * (xmax_b - xmin_b);
+  if (area_a <= 0 || area_b <= 0) return false;
+  const float intersection_area =
+      fmaxf(fminf(ymax_a, ymax_b) - fmaxf(ymin_a, ymin_b), 0.0f) *
+      fmaxf(fminf(xmax_a, xmax_b) - fmaxf(xmin_a, xmin_b), 0.0f);
+  const float iou = intersection_area / (area_a + area_b - intersection_area);
+  return iou > iou_threshold;
+}
+
+// Bit k of mask[segment, i, w] is set if the i-th box of the segment in order
+// of decreasing score overlaps the box j = w * kNmsBlockSize + k > i by more
+// than iou_threshold. Each block compares kNmsBlockSize boxes to another
+// kNmsBlockSize boxes, and only the words w >= i / kNmsBlockSize are written.
+__global__ void NmsMaskKernel(const float4* boxes,
+                              const int* sorted_box_indices,
+                              const float* sorted_scores, int num_boxes,
+                              int num_classes, int num_words,
+                              float iou_threshold, float score_threshold,
+                              uint64* mask) {
+  const int segment = blockIdx.x;
+  const int row_block = blockIdx.y;
+  const int col_block = blockIdx.z;
+  if (col_block < row_block) return;
+
+  const float4* image_boxes = boxes + (segment / num_classes) * num_boxes;
+  const int* box_indices = sorted_box_indices + segment * num_boxes;
+  const float* scores = sorted_scores + segment * num_boxes;
+
+  __shared__ float4 col_boxes[kNmsBlockSize];
+  const int col_begin = col_block * kNmsBlockSize;
+  const int num_cols = min(num_boxes - col_begin, kNmsBlockSize);
+  if (threadIdx.x < num_cols) {
+    col_boxes[threadIdx.x] = image_boxes[box_indices[col_begin + threadIdx.x]];
+  }
+  __syncthreads();
+
+  const int i = row_block * kNmsBlockSize + threadIdx.x;
+  // Boxes at or below the score threshold are never selected, so their rows
+  // of the mask are never read.
+  if (i >= num_boxes || !(scores[i] > score_threshold)) return;
+  const float4 box = image_boxes[box_indices[i]];
+  uint64 bits = 0;
+  for (int k = (row_block == col_block) ? threadIdx.x + 1 : 0; k < num_cols;
+       ++k) {
+    if (OverlapsMoreThan(box, col_boxes[k], iou_threshold)) {
+      bits |= 1ULL << k;
+    }
+  }
+  mask[(static_cast<int64>(segment) * num_boxes + i) * num_words + col_block] =
+      bits;
+}
+
+// Greedily selects the boxes of one segment per block, in order of decreasing
+// score, while the bits of the boxes removed by the selected ones are kept in
+// shared memory.
+__global__ void NmsSelectKernel(const int* sorted_box_indices,
+                                const float* sorted_scores,
+                                const uint64* mask, int num_boxes,
+                                int num_words, int max_output_size,
+                                float score_threshold, int* selected_indices,
+                                int* num_valid) {
+  extern __shared__ uint64 removed[];
+  const int segment = blockIdx.x;
+  for (int w = threadIdx.x; w < num_words; w += blockDim.x) removed[w] = 0;
+  __syncthreads();
+
+  const int* box_indices = sorted_box_indices + segment * num_boxes;
+  const float* scores = sorted_scores + segment * num_boxes;
+  const uint64* segment_mask =
+      mask + static_cast<int64>(segment) * num_boxes * num_words;
+  int* selected = selected_indices + segment * max_output_size;
+  int count = 0;
+  for (int i = 0; i < num_boxes && count < max_output_size; ++i) {
+    if (!(scores[i] > score_threshold)) break;
+    if (removed[i / kNmsBlockSize] & (1ULL << (i % kNmsBlockSize))) continue;
+    if (threadIdx.x == 0) selected[count] = box_indices[i];
+    ++count;
+    // Every thread has read the bit of box i before it is updated.
+    __syncthreads();
+    const uint64* row = segment_mask + static_cast<int64>(i) * num_words;
+    for (int w = i / kNmsBlockSize + threadIdx.x; w < num_words;
+         w += blockDim.x) {
+      removed[w] |= row[w];
+    }
+    __syncthreads();
+  }
+  for (int k = count + threadIdx.x; k < max_output_size; k += blockDim.x) {
+    selected[k] = 0;
+  }
+  if (threadIdx.x == 0) num_valid[segment] = count;
+}
+
+struct SegmentOffsetCreator {
+  __host__ __device__ explicit SegmentOffsetCreator(int num_boxes)
+      : num_boxes_(num_boxes) {}
+
+  __host__ __device__ int operator()(const int& segment) const {
+    return segment * num_boxes_;
+  }
+
+  int num_boxes_;
+};
+
+}  // namespace
+
+namespace functor {
+
+template <>
+Status BatchedNonMaxSuppression<GPUDevice>::operator()(
+    OpKernelContext* context, typename TTypes<float, 3>::ConstTensor boxes,
+    typename TTypes<float, 3>::ConstTensor scores, float iou_threshold,
+    float score_threshold, typename TTypes<int, 3>::Tensor selected_indices,
+    typename TTypes<int, 2>::Tensor num_valid) {
+  const GPUDevice& d = context->eigen_device<GPUDevice>();
+  const cudaStream_t& cu_stream = GetCudaStream(context);
+  const int batch_size = scores.dimension(0);
+  const int num_boxes = scores.dimension(1);
+  const int num_classes = scores.dimension(2);
+  const int max_output_size = selected_indices.dimension(2);
+  const int num_segments = batch_size * num_classes;
+  if (num_segments == 0) return Status::OK();
+  if (max_output_size == 0) {
+    d.memset(num_valid.data(), 0, num_valid.size() * sizeof(int));
+    return Status::OK();
+  }
+  const int num_words = Eigen::divup(num_boxes, kNmsBlockSize);
+  if (num_words > kMaxNmsWords) {
+    return errors::InvalidArgument(
+        "BatchedNonMaxSuppression supports at most ",
+        kMaxNmsWords * kNmsBlockSize, " boxes per image on GPU, got ",
+        num_boxes);
+  }
+
+  Tensor segment_scores, box_indices, sorted_scores, sorted_box_indices;
+  const TensorShape segments_shape({num_segments, num_boxes});
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(DT_FLOAT, segments_shape, &segment_scores));
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(DT_INT32, segments_shape, &box_indices));
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(DT_FLOAT, segments_shape, &sorted_scores));
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(DT_INT32, segments_shape, &sorted_box_indices));
+  const int num_items = num_segments * num_boxes;
+  CudaLaunchConfig config = GetCudaLaunchConfig(num_items, d);
+  GatherSegmentScoresKernel<<<config.block_count, config.thread_per_block, 0,
+                              cu_stream>>>(
+      scores.data(), num_boxes, num_classes, num_segments,
+      segment_scores.flat<float>().data(), box_indices.flat<int32>().data());
+
+  cub::CountingInputIterator<int> counting_iter(0);
+  cub::TransformInputIterator<int, SegmentOffsetCreator,
+                              cub::CountingInputIterator<int>>
+      segment_offsets(counting_iter, SegmentOffsetCreator(num_boxes));
+  size_t temp_storage_bytes = 0;
+  auto err = cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      nullptr, temp_storage_bytes, segment_scores.flat<float>().data(),
+      sorted_scores.flat<float>().data(), box_indices.flat<int32>().data(),
+      sorted_box_indices.flat<int32>().data(), num_items, num_segments,
+      segment_offsets, segment_offsets + 1, 0, sizeof(float) * 8, cu_stream);
+  if (err != cudaSuccess) {
+    return errors::Internal(
+        "BatchedNonMaxSuppression: Could not launch "
+        "cub::DeviceSegmentedRadixSort::SortPairsDescending to calculate "
+        "temp_storage_bytes, status: ",
+        cudaGetErrorString(err));
+  }
+  Tensor temp_storage;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DT_INT8, TensorShape({static_cast<int64>(temp_storage_bytes)}),
+      &temp_storage));
+  err = cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      temp_storage.flat<int8>().data(), temp_storage_bytes,
+      segment_scores.flat<float>().data(), sorted_scores.flat<float>().data(),
+      box_indices.flat<int32>().data(),
+      sorted_box_indices.flat<int32>().data(), num_items, num_segments,
+      segment_offsets, segment_offsets + 1, 0, sizeof(float) * 8, cu_stream);
+  if (err != cudaSuccess) {
+    return errors::Internal(
+        "BatchedNonMaxSuppression: Could not launch "
+        "cub::DeviceSegmentedRadixSort::SortPairsDescending to sort scores, "
+        "temp_storage_bytes: ",
+        temp_storage_bytes, ", status: ", cudaGetErrorString(err));
+  }
+
+  Tensor mask;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DT_INT64, TensorShape({num_items, num_words}), &mask));
+  uint64* mask_data = reinterpret_cast<uint64*>(mask.flat<int64>().data());
+  const dim3 mask_grid(num_segments, num_words, num_words);
+  NmsMaskKernel<<<mask_grid, kNmsBlockSize, 0, cu_stream>>>(
+      reinterpret_cast<const float4*>(boxes.data()),
+      sorted_box_indices.flat<int32>().data(),
+      sorted_scores.flat<float>().data(), num_boxes, num_classes, num_words,
+      iou_threshold, score_threshold, mask_data);
+
+  const int select_threads = 128;
+  NmsSelectKernel<<<num_segments, select_threads, num_words * sizeof(uint64),
+                    cu_stream>>>(
+      sorted_box_indices.flat<int32>().data(),
+      sorted_scores.flat<float>().data(), mask_data, num_boxes, num_words,
+      max_output_size, score_threshold, selected_indices.data(),
+      num_valid.data());
+  return Status::OK();
+}
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -335,4 +337,143 @@ TEST_F(NonMaxSuppressionV2OpTest, TestEmptyInput) {
   test::ExpectTensorEqual<int>(expected, *GetOutput(0));
 }
 
+//
+// BatchedNonMaxSuppressionOp Tests
+//
+
+class BatchedNonMaxSuppressionOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_EXPECT_OK(NodeDefBuilder("batched_non_max_suppression_op",
+                                "BatchedNonMaxSuppression")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+
+  // The boxes of the three clusters of the tests above, with the scores of
+  // the first class of the tests above, and increasing scores for the second
+  // class.
+  void AddThreeClustersInputs() {
+    AddInputFromArray<float>(
+        TensorShape({1, 6, 4}),
+        {0, 0,  1, 1,  0, 0.1f,  1, 1.1f,  0, -0.1f, 1, 0.9f,
+         0, 10, 1, 11, 0, 10.1f, 1, 11.1f, 0, 100,  1, 101});
+    AddInputFromArray<float>(TensorShape({1, 6, 2}),
+                             {.9f, .1f, .75f, .2f, .6f, .3f, .95f, .4f, .5f,
+                              .5f, .3f, .6f});
+  }
+};
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestSelectFromThreeClusters) {
+  MakeOp();
+  AddThreeClustersInputs();
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}),
+                           {std::numeric_limits<float>::lowest()});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_INT32, TensorShape({1, 2, 3}));
+  test::FillValues<int>(&expected, {3, 0, 5, 5, 4, 2});
+  test::ExpectTensorEqual<int>(expected, *GetOutput(0));
+  Tensor expected_num_valid(allocator(), DT_INT32, TensorShape({1, 2}));
+  test::FillValues<int>(&expected_num_valid, {3, 3});
+  test::ExpectTensorEqual<int>(expected_num_valid, *GetOutput(1));
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestOutputSizeIsAtMostNumBoxes) {
+  MakeOp();
+  AddThreeClustersInputs();
+  AddInputFromArray<int>(TensorShape({}), {30});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}),
+                           {std::numeric_limits<float>::lowest()});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_INT32, TensorShape({1, 2, 6}));
+  test::FillValues<int>(&expected, {3, 0, 5, 0, 0, 0, 5, 4, 2, 0, 0, 0});
+  test::ExpectTensorEqual<int>(expected, *GetOutput(0));
+  Tensor expected_num_valid(allocator(), DT_INT32, TensorShape({1, 2}));
+  test::FillValues<int>(&expected_num_valid, {3, 3});
+  test::ExpectTensorEqual<int>(expected_num_valid, *GetOutput(1));
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestScoreThresholdAndBatch) {
+  MakeOp();
+  // The second image has six identical boxes.
+  AddInputFromArray<float>(
+      TensorShape({2, 6, 4}),
+      {0, 0,  1, 1,  0, 0.1f,  1, 1.1f,  0, -0.1f, 1, 0.9f,
+       0, 10, 1, 11, 0, 10.1f, 1, 11.1f, 0, 100,  1, 101,
+       0, 0,  1, 1,  0, 0,     1, 1,     0, 0,     1, 1,
+       0, 0,  1, 1,  0, 0,     1, 1,     0, 0,     1, 1});
+  AddInputFromArray<float>(TensorShape({2, 6, 2}),
+                           {.9f, .1f, .75f, .2f, .6f, .3f, .95f, .4f, .5f, .5f,
+                            .3f, .6f, .5f, .1f, .6f, .1f, .7f, .1f, .8f, .1f,
+                            .9f, .1f, .95f, .1f});
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {.4f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_INT32, TensorShape({2, 2, 3}));
+  test::FillValues<int>(&expected, {3, 0, 0, 5, 4, 0, 5, 0, 0, 0, 0, 0});
+  test::ExpectTensorEqual<int>(expected, *GetOutput(0));
+  Tensor expected_num_valid(allocator(), DT_INT32, TensorShape({2, 2}));
+  test::FillValues<int>(&expected_num_valid, {2, 2, 1, 0});
+  test::ExpectTensorEqual<int>(expected_num_valid, *GetOutput(1));
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestInconsistentBoxAndScoreShapes) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({1, 2, 4}), {0, 0, 1, 1, 0, 0, 1, 1});
+  AddInputFromArray<float>(TensorShape({1, 3, 1}), {.9f, .75f, .6f});
+  AddInputFromArray<int>(TensorShape({}), {30});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.f});
+  Status s = RunOpKernel();
+
+  ASSERT_FALSE(s.ok());
+  EXPECT_TRUE(
+      StringPiece(s.ToString()).contains("scores has incompatible shape"))
+      << s;
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestInvalidIOUThreshold) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({1, 1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<float>(TensorShape({1, 1, 1}), {.9f});
+  AddInputFromArray<int>(TensorShape({}), {3});
+  AddInputFromArray<float>(TensorShape({}), {1.2f});
+  AddInputFromArray<float>(TensorShape({}), {0.f});
+  Status s = RunOpKernel();
+
+  ASSERT_FALSE(s.ok());
+  EXPECT_TRUE(
+      StringPiece(s.ToString()).contains("iou_threshold must be in [0, 1]"))
+      << s;
+}
+
+TEST_F(BatchedNonMaxSuppressionOpTest, TestEmptyInput) {
+  MakeOp();
+  AddInputFromArray<float>(TensorShape({1, 0, 4}), {});
+  AddInputFromArray<float>(TensorShape({1, 0, 2}), {});
+  AddInputFromArray<int>(TensorShape({}), {30});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_INT32, TensorShape({1, 2, 0}));
+  test::FillValues<int>(&expected, {});
+  test::ExpectTensorEqual<int>(expected, *GetOutput(0));
+  Tensor expected_num_valid(allocator(), DT_INT32, TensorShape({1, 2}));
+  test::FillValues<int>(&expected_num_valid, {0, 0});
+  test::ExpectTensorEqual<int>(expected_num_valid, *GetOutput(1));
+}
+
 }  // namespace tensorflow
@@ -73,6 +73,8 @@ class NthElementOp : public OpKernel {
 
     functor::NthElementFunctor<Device, T> nthElementFunc;
     nthElementFunc(context, input_in, *output_tensor, n, reverse_);
+    OP_REQUIRES(context, !context->IsCancelled(),
+                errors::Cancelled("NthElement was cancelled"));
   }
 
  private:
@@ -120,7 +122,7 @@ struct NthElementFunctor<CPUDevice, T> {
     // althought the worst time complexity could be O(n^2).
     // Here, 20 is a empirical factor of cost_per_unit.
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
-          20 * last_dim, SubNthElement);
+          20 * last_dim, SubNthElement, context->cancellation_manager());
   }
 };
 
@@ -139,6 +139,13 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
           *end_of_sequence = true;
           return Status::OK();
         }
+        if (GetNextStatsRecorder* stats = GetNextStatsRecorder::Current()) {
+          int64 num_produced = 0;
+          for (const OutputBufferElement& element : output_elements_) {
+            if (element.is_produced) ++num_produced;
+          }
+          stats->RecordBufferUtilization(num_produced, num_workers);
+        }
         while (!cancelled_) {
           // Wait for an item to become available, blocking if necessary. If we
           // are allowed to be sloppy, we can skip over input datasets that do
@@ -196,6 +203,7 @@ class ParallelInterleaveDatasetOp : public UnaryDatasetOpKernel {
           // No values available; wait until woken up.
           // TODO(jsimsa): Use slot-specific condition variable for
           // coordination of elements consumption.
+          ScopedInputWait wait;
           cond_var_.wait(l);
         }
         return errors::Cancelled(
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random.h"
 
 #include "tensorflow/core/kernels/captured_function.h"
+#include "tensorflow/core/kernels/dataset_autotuner.h"
 
 namespace tensorflow {
 
@@ -54,9 +55,10 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
     int32 num_parallel_calls;
     OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, "num_parallel_calls",
                                             &num_parallel_calls));
-    OP_REQUIRES(ctx, num_parallel_calls > 0,
+    OP_REQUIRES(ctx, num_parallel_calls > 0 || num_parallel_calls == kAutotune,
                 errors::InvalidArgument(
-                    "num_parallel_calls must be greater than zero."));
+                    "num_parallel_calls must be greater than zero, or ",
+                    kAutotune, " to autotune."));
 
     std::unique_ptr<CapturedFunction> captured_func;
     OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_, graph_def_version_,
@@ -106,7 +108,18 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
             input_impl_(params.dataset->input_->MakeIterator(params.prefix)),
-            invocation_results_(params.dataset->num_parallel_calls_) {}
+            invocation_results_(params.dataset->num_parallel_calls_ ==
+                                        kAutotune
+                                    ? AutotuneCpuBudget()
+                                    : params.dataset->num_parallel_calls_) {
+        if (params.dataset->num_parallel_calls_ == kAutotune) {
+          // The number of calls grows from one while the consumer waits, up
+          // to one call per CPU of the budget.
+          autotuner_.reset(new DatasetAutotuner(
+              /*initial_target=*/1,
+              /*max_target=*/invocation_results_.size()));
+        }
+      }
 
       ~Iterator() override {
         // TODO(mrry): Replace this cancellation logic with a
@@ -116,7 +129,7 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         // potentially-blocking iterators, when we add these.
         {
           mutex_lock l(mu_);
-          for (size_t i = 0; i < dataset()->num_parallel_calls_; ++i) {
+          for (size_t i = 0; i < invocation_results_.size(); ++i) {
             if (invocation_results_[i].notification) {
               invocation_results_[i].notification->WaitForNotification();
             }
@@ -129,10 +142,10 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
 
-        // Ensure that there are `dataset()->num_parallel_calls_`
-        // invocations of `func_` outstanding at once.
+        // Ensure that there are `NumParallelCallsLocked()` invocations of
+        // `func_` outstanding at once.
         while (!end_of_input_ && (num_inputs_consumed_ - num_outputs_consumed_ <
-                                  dataset()->num_parallel_calls_)) {
+                                  NumParallelCallsLocked())) {
           InvokeFunctionLocked(ctx);
         }
 
@@ -144,9 +157,13 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         // Read the next result out of `invocation_results_`, which
         // acts as a circular buffer.
         const size_t result_index =
-            num_outputs_consumed_ % dataset()->num_parallel_calls_;
+            num_outputs_consumed_ % invocation_results_.size();
         InvocationResult* result = &invocation_results_[result_index];
         *end_of_sequence = false;
+        if (GetNextStatsRecorder* stats = GetNextStatsRecorder::Current()) {
+          RecordCompletedInvocationsLocked(stats);
+        }
+        const int64 start_usecs = autotuner_ ? ctx->env()->NowMicros() : 0;
         if (result->notification) {
           result->notification->WaitForNotification();
           if (result->status.ok()) {
@@ -154,6 +171,15 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
           }
         }
         ++num_outputs_consumed_;
+        if (autotuner_) {
+          const int64 now_usecs = ctx->env()->NowMicros();
+          if (result->notification) {
+            autotuner_->RecordProduction(result->production_usecs);
+          }
+          if (autotuner_->RecordElement(now_usecs, now_usecs - start_usecs)) {
+            autotuner_->RecordStats(ctx, prefix());
+          }
+        }
         return result->status;
       }
 
@@ -162,18 +188,45 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
         Status status;
         std::unique_ptr<Notification> notification;
         std::vector<Tensor> return_values;
+        // The time spent running the function, set with `status`.
+        int64 production_usecs = 0;
       };
 
+      // Records the fraction of the outstanding invocations of `func_` whose
+      // results are ready. The wait for the others is time spent in this
+      // iterator, not in its input.
+      void RecordCompletedInvocationsLocked(GetNextStatsRecorder* stats)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64 num_outstanding =
+            num_inputs_consumed_ - num_outputs_consumed_;
+        int64 num_completed = 0;
+        for (int64 i = num_outputs_consumed_; i < num_inputs_consumed_; ++i) {
+          const InvocationResult& result =
+              invocation_results_[i % invocation_results_.size()];
+          if (!result.notification ||
+              result.notification->HasBeenNotified()) {
+            ++num_completed;
+          }
+        }
+        stats->RecordBufferUtilization(num_completed, num_outstanding);
+      }
+
+      // Returns the number of invocations of `func_` to keep outstanding.
+      int64 NumParallelCallsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return autotuner_ ? autotuner_->target()
+                          : dataset()->num_parallel_calls_;
+      }
+
       void InvokeFunctionLocked(IteratorContext* ctx)
           EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         DCHECK(!end_of_input_);
         DCHECK(num_inputs_consumed_ - num_outputs_consumed_ <
-               dataset()->num_parallel_calls_);
+               NumParallelCallsLocked());
 
         // The result of invoking the function will be written into the next
         // slot in `invocation_results_`, which acts as a circular buffer.
         const size_t result_index =
-            num_inputs_consumed_ % dataset()->num_parallel_calls_;
+            num_inputs_consumed_ % invocation_results_.size();
         InvocationResult* result = &invocation_results_[result_index];
         *result = InvocationResult();
 
@@ -204,10 +257,13 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
               });
           opts.step_container = step_container;
           opts.runner = ctx->runner();
+          Env* env = ctx->env();
+          const int64 start_usecs = env->NowMicros();
           dataset()->captured_func_->RunAsync(
               opts, std::move(input_element), &result->return_values,
-              [result, step_container, result_index](Status ret_status) {
+              [result, step_container, env, start_usecs](Status ret_status) {
                 delete step_container;
+                result->production_usecs = env->NowMicros() - start_usecs;
                 result->status.Update(ret_status);
                 result->notification->Notify();
               });
@@ -220,6 +276,8 @@ class ParallelMapDatasetOp : public UnaryDatasetOpKernel {
       bool end_of_input_ GUARDED_BY(mu_) = false;
       int64 num_inputs_consumed_ GUARDED_BY(mu_) = 0;
       int64 num_outputs_consumed_ GUARDED_BY(mu_) = 0;
+      // Set if the number of parallel calls is autotuned.
+      std::unique_ptr<DatasetAutotuner> autotuner_ GUARDED_BY(mu_);
     };
 
     const DatasetBase* const input_;
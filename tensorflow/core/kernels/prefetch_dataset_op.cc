@@ -12,11 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <deque>
 
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/dataset.h"
+#include "tensorflow/core/kernels/dataset_autotuner.h"
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 
 namespace tensorflow {
@@ -37,8 +39,9 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
     int64 buffer_size;
     OP_REQUIRES_OK(
         ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
-    OP_REQUIRES(ctx, buffer_size > 0,
-                errors::InvalidArgument("buffer_size must be > 0"));
+    OP_REQUIRES(ctx, buffer_size > 0 || buffer_size == kAutotune,
+                errors::InvalidArgument(
+                    "buffer_size must be > 0, or ", kAutotune, " to autotune"));
 
     *output = new Dataset(ctx, input, buffer_size);
   }
@@ -85,7 +88,14 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
      public:
       explicit Iterator(const Params& params)
           : DatasetIterator<Dataset>(params),
-            input_impl_(params.dataset->input_->MakeIterator(params.prefix)) {}
+            input_impl_(params.dataset->input_->MakeIterator(params.prefix)) {
+        if (params.dataset->buffer_size_ == kAutotune) {
+          // The buffer grows from one element while the consumer waits, up
+          // to the memory budget once the size of the elements is known.
+          autotuner_.reset(new DatasetAutotuner(
+              /*initial_target=*/1, /*max_target=*/AutotuneRamBudgetBytes()));
+        }
+      }
 
       ~Iterator() override {
         // Signal the prefetch thread to terminate it. We will then
@@ -108,12 +118,20 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(EnsurePrefetchThreadStarted(ctx));
+        const int64 start_usecs = autotuner_ ? ctx->env()->NowMicros() : 0;
+        if (GetNextStatsRecorder* stats = GetNextStatsRecorder::Current()) {
+          stats->RecordBufferUtilization(buffer_.size(), BufferLimit());
+        }
 
         while (true) {
           // Wait until the next element in the buffer has been
           // produced, or we are shutting down.
-          while (!cancelled_ && !prefetch_thread_finished_ && buffer_.empty()) {
-            cond_var_.wait(l);
+          {
+            ScopedInputWait wait;
+            while (!cancelled_ && !prefetch_thread_finished_ &&
+                   buffer_.empty()) {
+              cond_var_.wait(l);
+            }
           }
 
           if (cancelled_) {
@@ -131,6 +149,13 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
             }
             buffer_.pop_front();
             *end_of_sequence = false;
+            if (autotuner_) {
+              const int64 now_usecs = ctx->env()->NowMicros();
+              if (autotuner_->RecordElement(now_usecs,
+                                            now_usecs - start_usecs)) {
+                autotuner_->RecordStats(ctx, prefix());
+              }
+            }
 
             // Wake the prefetch thread, in case it has been waiting
             // for space in the buffer.
@@ -242,7 +267,7 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
           // 1. Wait for a slot in the buffer.
           {
             mutex_lock l(mu_);
-            while (!cancelled_ && buffer_.size() == dataset()->buffer_size_) {
+            while (!cancelled_ && buffer_.size() >= BufferLimit()) {
               cond_var_.wait(l);
             }
 
@@ -260,8 +285,10 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
           mutex_lock parent_l(parent_mu_);
           bool end_of_sequence;
           BufferElement buffer_element;
+          const int64 start_usecs = ctx->env()->NowMicros();
           buffer_element.status = input_impl_->GetNext(
               ctx, &buffer_element.value, &end_of_sequence);
+          const int64 production_usecs = ctx->env()->NowMicros() - start_usecs;
           if (buffer_element.status.ok() && end_of_sequence) {
             mutex_lock l(mu_);
             prefetch_thread_finished_ = true;
@@ -272,12 +299,35 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
           // 3. Signal that the element has been produced.
           {
             mutex_lock l(mu_);
+            if (autotuner_) {
+              RecordProducedLocked(buffer_element, production_usecs);
+            }
             buffer_.push_back(std::move(buffer_element));
             cond_var_.notify_all();
           }
         }
       }
 
+      // Returns the number of elements that the buffer holds at most.
+      size_t BufferLimit() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return autotuner_ ? autotuner_->target() : dataset()->buffer_size_;
+      }
+
+      // Bounds the autotuned buffer by the memory budget, using the mean size
+      // of the elements produced so far.
+      void RecordProducedLocked(const BufferElement& buffer_element,
+                                int64 production_usecs)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        autotuner_->RecordProduction(production_usecs);
+        for (const Tensor& t : buffer_element.value) {
+          bytes_produced_ += t.TotalBytes();
+        }
+        ++elements_produced_;
+        const int64 element_bytes =
+            std::max<int64>(1, bytes_produced_ / elements_produced_);
+        autotuner_->SetMaxTarget(AutotuneRamBudgetBytes() / element_bytes);
+      }
+
       Status WriteStatus(IteratorStateWriter* writer, size_t index,
                          const Status& status) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(
@@ -327,6 +377,10 @@ class PrefetchDatasetOp : public UnaryDatasetOpKernel {
       std::unique_ptr<Thread> prefetch_thread_ GUARDED_BY(mu_);
       bool cancelled_ GUARDED_BY(mu_) = false;
       bool prefetch_thread_finished_ GUARDED_BY(mu_) = false;
+      // Set if the buffer size is autotuned.
+      std::unique_ptr<DatasetAutotuner> autotuner_ GUARDED_BY(mu_);
+      int64 bytes_produced_ GUARDED_BY(mu_) = 0;
+      int64 elements_produced_ GUARDED_BY(mu_) = 0;
     };
 
     const DatasetBase* const input_;
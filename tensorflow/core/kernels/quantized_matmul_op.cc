@@ -17,6 +17,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <cmath>
+#include <limits>
+
 #define GEMMLOWP_ALLOW_SLOW_SCALAR_FALLBACK
 #include "public/gemmlowp.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -63,6 +66,58 @@ void GemmlowpMultiply(OpKernelContext* op_context, const quint8* a_data,
   TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_int32, m * n * sizeof(int32));
 }
 
+// Multiplies into eight-bit results directly. The gemmlowp output pipeline
+// adds the bias to each block of 32-bit accumulators, scales it into the
+// output range and clamps it while the block is still in registers.
+template <bool TransposeA, bool TransposeB>
+void GemmlowpMultiplyWithBiasAndRequantize(
+    OpKernelContext* op_context, const quint8* a_data, const quint8* b_data,
+    const int32* bias_data, quint8* c_data, int m, int n, int k, int offset_a,
+    int offset_b, int lda, int ldb, int ldc, int32 result_offset,
+    int32 result_multiplier, int result_shift, int32 result_min) {
+  const uint8* a_data_as_uint8 = &(a_data->value);
+  const uint8* b_data_as_uint8 = &(b_data->value);
+  uint8* c_data_as_uint8 = &(c_data->value);
+  static const gemmlowp::MapOrder LhsOrder =
+      !TransposeA ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  static const gemmlowp::MapOrder RhsOrder =
+      !TransposeB ? gemmlowp::MapOrder::RowMajor : gemmlowp::MapOrder::ColMajor;
+  gemmlowp::MatrixMap<const std::uint8_t, LhsOrder> lhs(a_data_as_uint8, m, k,
+                                                        lda);
+  gemmlowp::MatrixMap<const std::uint8_t, RhsOrder> rhs(b_data_as_uint8, k, n,
+                                                        ldb);
+  gemmlowp::MatrixMap<std::uint8_t, gemmlowp::MapOrder::RowMajor> result(
+      c_data_as_uint8, m, n, ldc);
+
+  typedef gemmlowp::VectorMap<const std::int32_t, gemmlowp::VectorShape::Row>
+      BiasVectorMap;
+  gemmlowp::OutputStageBiasAddition<BiasVectorMap> bias_addition_stage;
+  bias_addition_stage.bias_vector = BiasVectorMap(bias_data, n);
+  gemmlowp::OutputStageQuantizeDownInt32ToUint8ScaleByFixedPoint
+      quantize_down_stage;
+  quantize_down_stage.result_offset_after_shift = result_offset;
+  quantize_down_stage.result_fixedpoint_multiplier = result_multiplier;
+  quantize_down_stage.result_shift = result_shift;
+  gemmlowp::OutputStageClamp clamp_stage;
+  clamp_stage.min = result_min;
+  clamp_stage.max = 255;
+  gemmlowp::OutputStageSaturatingCastToUint8 saturating_cast_stage;
+  const auto output_pipeline =
+      std::make_tuple(bias_addition_stage, quantize_down_stage, clamp_stage,
+                      saturating_cast_stage);
+
+  auto& worker_threads =
+      *(op_context->device()->tensorflow_cpu_worker_threads());
+  TensorflowGemmContext context(worker_threads.num_threads,
+                                worker_threads.workers);
+  gemmlowp::GemmWithOutputPipeline<std::uint8_t, std::uint8_t,
+                                   gemmlowp::DefaultL8R8BitDepthParams>(
+      &context, lhs, rhs, &result, -offset_a, -offset_b, output_pipeline);
+  // Since gemmlowp uses assembly to write to the output, msan won't detect
+  // the output buffer as written to, so we mark it manually.
+  TF_ANNOTATE_MEMORY_IS_INITIALIZED(c_data_as_uint8, m * n * sizeof(uint8));
+}
+
 template <class T1, class T2, class Toutput>
 class QuantizedMatMulOp : public OpKernel {
  public:
@@ -198,4 +253,177 @@ REGISTER_KERNEL_BUILDER(Name("QuantizedMatMul")
                             .TypeConstraint<qint32>("Toutput"),
                         QuantizedMatMulOp<quint8, quint8, qint32>);
 
+// Computes QuantizedMatMul, BiasAdd, an optional Relu and Requantize into a
+// fixed output range in a single pass, without materializing the 32-bit
+// product.
+class QuantizedMatMulWithBiasAndRequantizeOp : public OpKernel {
+ public:
+  explicit QuantizedMatMulWithBiasAndRequantizeOp(
+      OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+    OP_REQUIRES_OK(context, context->GetAttr("fused_relu", &fused_relu_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& bias = context->input(2);
+    const float min_a = context->input(3).flat<float>()(0);
+    const float max_a = context->input(4).flat<float>()(0);
+    const float min_b = context->input(5).flat<float>()(0);
+    const float max_b = context->input(6).flat<float>()(0);
+    const float min_output = context->input(7).flat<float>()(0);
+    const float max_output = context->input(8).flat<float>()(0);
+
+    OP_REQUIRES(context, (max_a > min_a),
+                errors::InvalidArgument("max_a must be larger than min_a."));
+    OP_REQUIRES(context, (max_b > min_b),
+                errors::InvalidArgument("max_b must be larger than min_b."));
+    OP_REQUIRES(context, (max_output > min_output),
+                errors::InvalidArgument("max_freezed_output must be larger "
+                                        "than min_freezed_output."));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix"));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix"));
+    const int a_contracted_dim = transpose_a_ ? 0 : 1;
+    const int b_contracted_dim = transpose_b_ ? 1 : 0;
+    OP_REQUIRES(context,
+                a.dim_size(a_contracted_dim) == b.dim_size(b_contracted_dim),
+                errors::InvalidArgument("Matrix size-compatible: In[0]: ",
+                                        a.shape().DebugString(), ", In[1]: ",
+                                        b.shape().DebugString()));
+    const int m = a.dim_size(1 - a_contracted_dim);
+    const int n = b.dim_size(1 - b_contracted_dim);
+    const int k = a.dim_size(a_contracted_dim);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(bias.shape()) &&
+                    bias.dim_size(0) == n,
+                errors::InvalidArgument("bias must be a vector of size ", n,
+                                        ", got ", bias.shape().DebugString()));
+
+    Tensor* c = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, {m, n}, &c));
+
+    const int32 offset_a =
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_a, max_a);
+    const int32 offset_b =
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_b, max_b);
+    // The real value of one unit of the 32-bit accumulators.
+    const double accumulator_scale =
+        static_cast<double>(FloatForOneQuantizedLevel<quint8>(min_a, max_a)) *
+        FloatForOneQuantizedLevel<quint8>(min_b, max_b);
+    const double output_scale =
+        FloatForOneQuantizedLevel<quint8>(min_output, max_output);
+    const double multiplier = accumulator_scale / output_scale;
+    const int32 result_offset =
+        FloatToQuantizedUnclamped<quint8>(0.0f, min_output, max_output);
+    // Relu clamps at the quantized value of zero.
+    const int32 result_min =
+        fused_relu_ ? std::min(std::max(result_offset, 0), 255) : 0;
+
+    const auto bias_flat = bias.flat<float>();
+    const quint8* a_data = a.flat<quint8>().data();
+    const quint8* b_data = b.flat<quint8>().data();
+    quint8* c_data = c->flat<quint8>().data();
+    const int lda = a.dim_size(1);
+    const int ldb = b.dim_size(1);
+    const int ldc = n;
+
+    if (multiplier > 0.0 && multiplier < 1.0) {
+      // Represents the multiplier as a 31-bit fixed point value in [0.5, 1)
+      // times a power of two.
+      int exponent;
+      const double significand = std::frexp(multiplier, &exponent);
+      int64 result_multiplier =
+          static_cast<int64>(std::round(significand * (1ll << 31)));
+      int result_shift = -exponent;
+      if (result_multiplier == (1ll << 31)) {
+        result_multiplier /= 2;
+        --result_shift;
+      }
+      // The pipeline adds the bias to the accumulators in their own units.
+      Tensor bias_accumulator;
+      OP_REQUIRES_OK(context, context->allocate_temp(DT_INT32, {n},
+                                                     &bias_accumulator));
+      auto bias_accumulator_flat = bias_accumulator.flat<int32>();
+      for (int j = 0; j < n; ++j) {
+        const double value = std::round(bias_flat(j) / accumulator_scale);
+        bias_accumulator_flat(j) = static_cast<int32>(std::min<double>(
+            std::max<double>(value, std::numeric_limits<int32>::lowest()),
+            std::numeric_limits<int32>::max()));
+      }
+      if (transpose_a_) {
+        if (transpose_b_) {
+          GemmlowpMultiplyWithBiasAndRequantize<true, true>(
+              context, a_data, b_data, bias_accumulator_flat.data(), c_data, m,
+              n, k, offset_a, offset_b, lda, ldb, ldc, result_offset,
+              result_multiplier, result_shift, result_min);
+        } else {
+          GemmlowpMultiplyWithBiasAndRequantize<true, false>(
+              context, a_data, b_data, bias_accumulator_flat.data(), c_data, m,
+              n, k, offset_a, offset_b, lda, ldb, ldc, result_offset,
+              result_multiplier, result_shift, result_min);
+        }
+      } else {
+        if (transpose_b_) {
+          GemmlowpMultiplyWithBiasAndRequantize<false, true>(
+              context, a_data, b_data, bias_accumulator_flat.data(), c_data, m,
+              n, k, offset_a, offset_b, lda, ldb, ldc, result_offset,
+              result_multiplier, result_shift, result_min);
+        } else {
+          GemmlowpMultiplyWithBiasAndRequantize<false, false>(
+              context, a_data, b_data, bias_accumulator_flat.data(), c_data, m,
+              n, k, offset_a, offset_b, lda, ldb, ldc, result_offset,
+              result_multiplier, result_shift, result_min);
+        }
+      }
+    } else {
+      // The output range is finer than the accumulators, which the fixed point
+      // pipeline can't represent, so requantize a 32-bit product instead. The
+      // bias is added in the finer output units.
+      Tensor accumulator;
+      OP_REQUIRES_OK(context,
+                     context->allocate_temp(DT_QINT32, {m, n}, &accumulator));
+      qint32* accumulator_data = accumulator.flat<qint32>().data();
+      ReferenceGemm<quint8, quint8, qint32>(
+          transpose_a_, transpose_b_, false, m, n, k, a_data, offset_a, lda,
+          b_data, offset_b, ldb, accumulator_data, 0, 0, 1, ldc);
+      for (int i = 0; i < m; ++i) {
+        for (int j = 0; j < n; ++j) {
+          const int64 index = static_cast<int64>(i) * n + j;
+          const double value =
+              std::round(accumulator_data[index].value * multiplier +
+                         bias_flat(j) / output_scale) +
+              result_offset;
+          c_data[index] = static_cast<uint8>(std::min(
+              std::max(value, static_cast<double>(result_min)), 255.0));
+        }
+      }
+    }
+
+    Tensor* c_min = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(1, {}, &c_min));
+    c_min->flat<float>()(0) = min_output;
+
+    Tensor* c_max = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(2, {}, &c_max));
+    c_max->flat<float>()(0) = max_output;
+  }
+
+ private:
+  bool transpose_a_;
+  bool transpose_b_;
+  bool fused_relu_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("QuantizedMatMulWithBiasAndRequantize")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<quint8>("T1")
+                            .TypeConstraint<quint8>("T2")
+                            .TypeConstraint<quint8>("Toutput"),
+                        QuantizedMatMulWithBiasAndRequantizeOp);
+
 }  // namespace tensorflow
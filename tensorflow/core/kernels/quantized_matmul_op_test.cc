@@ -334,4 +334,104 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+class QuantizedMatMulWithBiasAndRequantizeTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool fused_relu) {
+    TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_with_bias_op",
+                                "QuantizedMatMulWithBiasAndRequantize")
+                     .Input(FakeInput(DT_QUINT8))
+                     .Input(FakeInput(DT_QUINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("fused_relu", fused_relu)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Multiplies the matrices of Small_NoParams, whose quantized values are
+  // their float values, and adds a bias.
+  void AddSmallInputs(float min_output, float max_output) {
+    AddInputFromArray<quint8>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+    AddInputFromArray<quint8>(TensorShape({3, 4}),
+                              {7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18});
+    AddInputFromArray<float>(TensorShape({4}), {1.0f, -2.0f, 3.0f, -300.0f});
+    AddInputFromArray<float>(TensorShape({1}), {0});
+    AddInputFromArray<float>(TensorShape({1}), {255.0f});
+    AddInputFromArray<float>(TensorShape({1}), {0});
+    AddInputFromArray<float>(TensorShape({1}), {255.0f});
+    AddInputFromArray<float>(TensorShape({1}), {min_output});
+    AddInputFromArray<float>(TensorShape({1}), {max_output});
+  }
+
+  Tensor DequantizedOutput() {
+    const float output_min = GetOutput(1)->flat<float>()(0);
+    const float output_max = GetOutput(2)->flat<float>()(0);
+    return QuantizedTensorToFloat<quint8>(*GetOutput(0), output_min,
+                                          output_max);
+  }
+};
+
+TEST_F(QuantizedMatMulWithBiasAndRequantizeTest, Small) {
+  MakeOp(false /* fused_relu */);
+  AddSmallInputs(-256.0f, 256.0f);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(-256.0f, GetOutput(1)->flat<float>()(0));
+  EXPECT_EQ(256.0f, GetOutput(2)->flat<float>()(0));
+  // The products of Small_NoParams plus the bias, with the last column
+  // clamped to the output range.
+  Tensor expected(DT_FLOAT, TensorShape({2, 4}));
+  test::FillValues<float>(&expected,
+                          {75, 78, 89, -208, 174, 186, 206, -82});
+  // Allows for one quantized level of the output range.
+  test::ExpectTensorNear<float>(expected, DequantizedOutput(), 512.0 / 255.0);
+}
+
+TEST_F(QuantizedMatMulWithBiasAndRequantizeTest, SmallWithRelu) {
+  MakeOp(true /* fused_relu */);
+  AddSmallInputs(-256.0f, 256.0f);
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(DT_FLOAT, TensorShape({2, 4}));
+  test::FillValues<float>(&expected, {75, 78, 89, 0, 174, 186, 206, 0});
+  test::ExpectTensorNear<float>(expected, DequantizedOutput(), 512.0 / 255.0);
+}
+
+TEST_F(QuantizedMatMulWithBiasAndRequantizeTest, OutputFinerThanProduct) {
+  // One quantized level of the output is a tenth of one of the product, so
+  // the result is requantized from a 32-bit product.
+  MakeOp(false /* fused_relu */);
+  AddInputFromArray<quint8>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<quint8>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {0.5f, -20.0f});
+  AddInputFromArray<float>(TensorShape({1}), {0});
+  AddInputFromArray<float>(TensorShape({1}), {255.0f});
+  AddInputFromArray<float>(TensorShape({1}), {0});
+  AddInputFromArray<float>(TensorShape({1}), {255.0f});
+  AddInputFromArray<float>(TensorShape({1}), {0});
+  AddInputFromArray<float>(TensorShape({1}), {25.5f});
+  TF_ASSERT_OK(RunOpKernel());
+  // 1 * 1 + 2 * 3 + 0.5 = 7.5, and 1 * 2 + 2 * 4 - 20 = -10 clamped to 0.
+  Tensor expected(allocator(), DT_QUINT8, TensorShape({1, 2}));
+  test::FillValues<quint8>(&expected, {75, 0});
+  test::ExpectTensorEqual<quint8>(expected, *GetOutput(0));
+}
+
+TEST_F(QuantizedMatMulWithBiasAndRequantizeTest, BadBiasSize) {
+  MakeOp(false /* fused_relu */);
+  AddInputFromArray<quint8>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<quint8>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({3}), {0, 0, 0});
+  AddInputFromArray<float>(TensorShape({1}), {0});
+  AddInputFromArray<float>(TensorShape({1}), {255.0f});
+  AddInputFromArray<float>(TensorShape({1}), {0});
+  AddInputFromArray<float>(TensorShape({1}), {255.0f});
+  AddInputFromArray<float>(TensorShape({1}), {0});
+  AddInputFromArray<float>(TensorShape({1}), {25.5f});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
 }  // namespace tensorflow
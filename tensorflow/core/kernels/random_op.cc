@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/random/batched_philox_random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/logging.h"
@@ -72,6 +73,83 @@ struct FillPhiloxRandom {
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
 
+// Maps a stateless distribution over PhiloxRandom to the same distribution
+// over BatchedPhiloxRandom, which returns the same samples but computes
+// several groups at a time with SIMD instructions.
+template <class Distribution>
+struct BatchedDistribution {
+  static const bool kBatched = false;
+};
+
+#define REGISTER_BATCHED_DISTRIBUTION(Distribution, T)                 \
+  template <>                                                          \
+  struct BatchedDistribution<random::Distribution<PhiloxRandom, T>> {  \
+    static const bool kBatched = true;                                 \
+    typedef random::Distribution<random::BatchedPhiloxRandom, T> Type; \
+  }
+
+REGISTER_BATCHED_DISTRIBUTION(UniformDistribution, Eigen::half);
+REGISTER_BATCHED_DISTRIBUTION(UniformDistribution, float);
+REGISTER_BATCHED_DISTRIBUTION(UniformDistribution, double);
+REGISTER_BATCHED_DISTRIBUTION(NormalDistribution, Eigen::half);
+REGISTER_BATCHED_DISTRIBUTION(NormalDistribution, float);
+REGISTER_BATCHED_DISTRIBUTION(NormalDistribution, double);
+
+#undef REGISTER_BATCHED_DISTRIBUTION
+
+// Fills the groups in [start_group, limit_group) with samples of 'dist',
+// where 'gen' is positioned at the start of 'start_group'.
+template <class Distribution, class Generator>
+void FillPhiloxRandomGroups(Generator* gen,
+                            typename Distribution::ResultElementType* data,
+                            int64 size, int64 start_group, int64 limit_group,
+                            Distribution dist) {
+  const int kGroupSize = Distribution::kResultElementCount;
+
+  int64 offset = start_group * kGroupSize;
+
+  // First fill all the full-size groups
+  int64 limit_group_full = std::min(limit_group, size / kGroupSize);
+  for (int64 index = start_group; index < limit_group_full; ++index) {
+    auto samples = dist(gen);
+    std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
+    offset += kGroupSize;
+  }
+
+  // If there are any remaining elements that need to be filled, process them
+  if (limit_group_full < limit_group) {
+    int64 remaining_size = size - limit_group_full * kGroupSize;
+    auto samples = dist(gen);
+    std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
+  }
+}
+
+template <class Distribution,
+          bool kBatched = BatchedDistribution<Distribution>::kBatched>
+struct FillFixedSamplesTask {
+  typedef typename Distribution::ResultElementType T;
+  static void Run(random::PhiloxRandom gen, T* data, int64 size,
+                  int64 start_group, int64 limit_group, Distribution dist) {
+    FillPhiloxRandomGroups(&gen, data, size, start_group, limit_group, dist);
+  }
+};
+
+template <class Distribution>
+struct FillFixedSamplesTask<Distribution, true> {
+  typedef typename Distribution::ResultElementType T;
+  static void Run(random::PhiloxRandom gen, T* data, int64 size,
+                  int64 start_group, int64 limit_group, Distribution dist) {
+    if (!random::IsPhiloxBatchVectorized()) {
+      FillPhiloxRandomGroups(&gen, data, size, start_group, limit_group, dist);
+      return;
+    }
+    random::BatchedPhiloxRandom batched_gen(gen);
+    FillPhiloxRandomGroups(
+        &batched_gen, data, size, start_group, limit_group,
+        typename BatchedDistribution<Distribution>::Type());
+  }
+};
+
 // Specialization for distribution that takes a fixed number of samples for
 // each output.
 template <class Distribution>
@@ -79,25 +157,9 @@ struct FillPhiloxRandomTask<Distribution, false> {
   typedef typename Distribution::ResultElementType T;
   static void Run(random::PhiloxRandom gen, T* data, int64 size,
                   int64 start_group, int64 limit_group, Distribution dist) {
-    const int kGroupSize = Distribution::kResultElementCount;
-
     gen.Skip(start_group);
-    int64 offset = start_group * kGroupSize;
-
-    // First fill all the full-size groups
-    int64 limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64 index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
-      std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
-      offset += kGroupSize;
-    }
-
-    // If there are any remaining elements that need to be filled, process them
-    if (limit_group_full < limit_group) {
-      int64 remaining_size = size - limit_group_full * kGroupSize;
-      auto samples = dist(&gen);
-      std::copy(&samples[0], &samples[0] + remaining_size, data + offset);
-    }
+    FillFixedSamplesTask<Distribution>::Run(gen, data, size, start_group,
+                                            limit_group, dist);
   }
 };
 
@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
@@ -32,7 +34,11 @@ namespace {
 
 class TextLineDatasetOp : public DatasetOpKernel {
  public:
-  using DatasetOpKernel::DatasetOpKernel;
+  explicit TextLineDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr("num_readahead_buffers", &num_readahead_buffers_));
+  }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
     const Tensor* filenames_tensor;
@@ -75,7 +81,7 @@ class TextLineDatasetOp : public DatasetOpKernel {
     }
 
     *output = new Dataset(ctx, std::move(filenames), compression_type,
-                          zlib_compression_options);
+                          zlib_compression_options, num_readahead_buffers_);
   }
 
  private:
@@ -83,12 +89,14 @@ class TextLineDatasetOp : public DatasetOpKernel {
    public:
     Dataset(OpKernelContext* ctx, std::vector<string> filenames,
             const string& compression_type,
-            const io::ZlibCompressionOptions& options)
+            const io::ZlibCompressionOptions& options,
+            int64 num_readahead_buffers)
         : GraphDatasetBase(ctx),
           filenames_(std::move(filenames)),
           compression_type_(compression_type),
           use_compression_(!compression_type.empty()),
-          options_(options) {}
+          options_(options),
+          num_readahead_buffers_(num_readahead_buffers) {}
 
     std::unique_ptr<IteratorBase> MakeIterator(
         const string& prefix) const override {
@@ -119,8 +127,12 @@ class TextLineDatasetOp : public DatasetOpKernel {
       TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
       TF_RETURN_IF_ERROR(
           b->AddScalar(options_.input_buffer_size, &buffer_size));
+      AttrValue num_readahead_buffers;
+      b->BuildAttrValue(num_readahead_buffers_, &num_readahead_buffers);
       TF_RETURN_IF_ERROR(b->AddDataset(
-          this, {filenames, compression_type, buffer_size}, output));
+          this, {filenames, compression_type, buffer_size},
+          {std::make_pair("num_readahead_buffers", num_readahead_buffers)},
+          output));
       return Status::OK();
     }
 
@@ -216,8 +228,14 @@ class TextLineDatasetOp : public DatasetOpKernel {
         // Actually move on to next file.
         TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
             dataset()->filenames_[current_file_index_], &file_));
-        input_stream_.reset(
-            new io::RandomAccessInputStream(file_.get(), false));
+        if (dataset()->num_readahead_buffers_ > 0) {
+          input_stream_.reset(new io::ReadaheadInputStream(
+              file_.get(), dataset()->options_.input_buffer_size,
+              dataset()->num_readahead_buffers_));
+        } else {
+          input_stream_.reset(
+              new io::RandomAccessInputStream(file_.get(), false));
+        }
 
         if (dataset()->use_compression_) {
           zlib_input_stream_.reset(new io::ZlibInputStream(
@@ -243,8 +261,7 @@ class TextLineDatasetOp : public DatasetOpKernel {
       }
 
       mutex mu_;
-      std::unique_ptr<io::RandomAccessInputStream> input_stream_
-          GUARDED_BY(mu_);
+      std::unique_ptr<io::InputStreamInterface> input_stream_ GUARDED_BY(mu_);
       std::unique_ptr<io::ZlibInputStream> zlib_input_stream_ GUARDED_BY(mu_);
       std::unique_ptr<io::BufferedInputStream> buffered_input_stream_
           GUARDED_BY(mu_);
@@ -257,7 +274,10 @@ class TextLineDatasetOp : public DatasetOpKernel {
     const string compression_type_;
     const bool use_compression_;
     const io::ZlibCompressionOptions options_;
+    const int64 num_readahead_buffers_;
   };
+
+  int64 num_readahead_buffers_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TextLineDataset").Device(DEVICE_CPU),
@@ -485,7 +505,11 @@ REGISTER_KERNEL_BUILDER(Name("FixedLengthRecordDataset").Device(DEVICE_CPU),
 
 class TFRecordDatasetOp : public DatasetOpKernel {
  public:
-  using DatasetOpKernel::DatasetOpKernel;
+  explicit TFRecordDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr("num_readahead_buffers", &num_readahead_buffers_));
+  }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
     const Tensor* filenames_tensor;
@@ -511,15 +535,16 @@ class TFRecordDatasetOp : public DatasetOpKernel {
                 errors::InvalidArgument(
                     "`buffer_size` must be >= 0 (0 == no buffering)"));
 
-    *output =
-        new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+    *output = new Dataset(ctx, std::move(filenames), compression_type,
+                          buffer_size, num_readahead_buffers_);
   }
 
  private:
   class Dataset : public GraphDatasetBase {
    public:
     explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                     const string& compression_type, int64 buffer_size)
+                     const string& compression_type, int64 buffer_size,
+                     int64 num_readahead_buffers)
         : GraphDatasetBase(ctx),
           filenames_(std::move(filenames)),
           compression_type_(compression_type),
@@ -528,6 +553,7 @@ class TFRecordDatasetOp : public DatasetOpKernel {
       if (buffer_size > 0) {
         options_.buffer_size = buffer_size;
       }
+      options_.num_readahead_buffers = num_readahead_buffers;
     }
 
     std::unique_ptr<IteratorBase> MakeIterator(
@@ -558,8 +584,12 @@ class TFRecordDatasetOp : public DatasetOpKernel {
       TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
       Node* buffer_size = nullptr;
       TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+      AttrValue num_readahead_buffers;
+      b->BuildAttrValue(options_.num_readahead_buffers, &num_readahead_buffers);
       TF_RETURN_IF_ERROR(b->AddDataset(
-          this, {filenames, compression_type, buffer_size}, output));
+          this, {filenames, compression_type, buffer_size},
+          {std::make_pair("num_readahead_buffers", num_readahead_buffers)},
+          output));
       return Status::OK();
     }
 
@@ -669,11 +699,271 @@ class TFRecordDatasetOp : public DatasetOpKernel {
     const string compression_type_;
     io::RecordReaderOptions options_;
   };
+
+  int64 num_readahead_buffers_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TFRecordDataset").Device(DEVICE_CPU),
                         TFRecordDatasetOp);
 
+class IndexedTFRecordDatasetOp : public DatasetOpKernel {
+ public:
+  explicit IndexedTFRecordDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("skip_corrupted_records",
+                                     &skip_corrupted_records_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    int64 num_shards = -1;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "num_shards", &num_shards));
+    OP_REQUIRES(ctx, num_shards > 0,
+                errors::InvalidArgument("`num_shards` must be > 0"));
+
+    int64 shard_index = -1;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "shard_index", &shard_index));
+    OP_REQUIRES(ctx, shard_index >= 0 && shard_index < num_shards,
+                errors::InvalidArgument(
+                    "`shard_index` must be in [0, `num_shards`)"));
+
+    int64 buffer_size = -1;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    OP_REQUIRES(ctx, buffer_size >= 0,
+                errors::InvalidArgument(
+                    "`buffer_size` must be >= 0 (0 == no buffering)"));
+
+    *output = new Dataset(ctx, std::move(filenames), num_shards, shard_index,
+                          buffer_size, skip_corrupted_records_);
+  }
+
+ private:
+  class Dataset : public GraphDatasetBase {
+   public:
+    explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+                     int64 num_shards, int64 shard_index, int64 buffer_size,
+                     bool skip_corrupted_records)
+        : GraphDatasetBase(ctx),
+          filenames_(std::move(filenames)),
+          num_shards_(num_shards),
+          shard_index_(shard_index),
+          skip_corrupted_records_(skip_corrupted_records) {
+      options_.buffer_size = buffer_size;
+    }
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::IndexedTFRecord")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}});
+      return *shapes;
+    }
+
+    string DebugString() override {
+      return "IndexedTFRecordDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* num_shards = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(num_shards_, &num_shards));
+      Node* shard_index = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(shard_index_, &shard_index));
+      Node* buffer_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+      AttrValue skip_corrupted_records;
+      b->BuildAttrValue(skip_corrupted_records_, &skip_corrupted_records);
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {filenames, num_shards, shard_index, buffer_size},
+          {std::make_pair("skip_corrupted_records", skip_corrupted_records)},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        do {
+          // We are currently processing the shard of a file, so try to read
+          // its next record.
+          if (reader_) {
+            if (next_record_ < end_record_) {
+              Tensor result_tensor(cpu_allocator(), DT_STRING, {});
+              Status s =
+                  reader_->ReadRecord(&result_tensor.scalar<string>()());
+              if (s.ok()) {
+                ++next_record_;
+                out_tensors->emplace_back(std::move(result_tensor));
+                *end_of_sequence = false;
+                return Status::OK();
+              }
+              if (!dataset()->skip_corrupted_records_ ||
+                  !errors::IsDataLoss(s)) {
+                return s;
+              }
+              LOG(WARNING) << "Skipping corrupted record " << next_record_
+                           << " of "
+                           << dataset()->filenames_[current_file_index_]
+                           << ": " << s;
+              // The reader may have consumed part of the next record, so
+              // it is recreated at the offset of the next record.
+              TF_RETURN_IF_ERROR(SeekLocked(ctx->env(), next_record_ + 1));
+              continue;
+            }
+
+            // We have reached the end of the shard of the current file, so
+            // maybe move on to next file.
+            ResetStreamsLocked();
+            ++current_file_index_;
+          }
+
+          // Iteration ends when there are no more files to process.
+          if (current_file_index_ == dataset()->filenames_.size()) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+          TF_RETURN_IF_ERROR(SeekLocked(ctx->env(), begin_record_));
+        } while (true);
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("current_file_index"),
+                                               current_file_index_));
+        if (reader_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("next_record"), next_record_));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(OpKernelContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        ResetStreamsLocked();
+        int64 current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("current_file_index"),
+                                              &current_file_index));
+        current_file_index_ = size_t(current_file_index);
+        if (reader->Contains(full_name("next_record"))) {
+          int64 next_record;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("next_record"), &next_record));
+          TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+          if (next_record < begin_record_ || next_record > end_record_) {
+            return errors::InvalidArgument(
+                "Cannot restore the iterator at record ", next_record, " of ",
+                dataset()->filenames_[current_file_index_],
+                ", which is outside of the records [", begin_record_, ", ",
+                end_record_, ") of the shard.");
+          }
+          TF_RETURN_IF_ERROR(SeekLocked(ctx->env(), next_record));
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Reads the index of the file at `current_file_index_`, and finds the
+      // records of the shard.
+      Status SetupStreamsLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (current_file_index_ >= dataset()->filenames_.size()) {
+          return errors::InvalidArgument(
+              "current_file_index_:", current_file_index_,
+              " >= filenames_.size():", dataset()->filenames_.size());
+        }
+        const string& filename = dataset()->filenames_[current_file_index_];
+        TF_RETURN_IF_ERROR(io::RecordIndex::Read(
+            env, io::RecordIndexFilename(filename), &index_));
+        const int64 num_records = index_.num_records();
+        begin_record_ =
+            num_records * dataset()->shard_index_ / dataset()->num_shards_;
+        end_record_ = num_records * (dataset()->shard_index_ + 1) /
+                      dataset()->num_shards_;
+        return env->NewRandomAccessFile(filename, &file_);
+      }
+
+      // Sets up a reader stream that starts at the record `record` of the
+      // current file.
+      Status SeekLocked(Env* env, int64 record) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        next_record_ = record;
+        reader_.reset(
+            new io::SequentialRecordReader(file_.get(), dataset()->options_));
+        if (record < end_record_) {
+          TF_RETURN_IF_ERROR(reader_->SeekOffset(index_.offset(record)));
+        }
+        return Status::OK();
+      }
+
+      // Resets all reader streams.
+      void ResetStreamsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        reader_.reset();
+        file_.reset();
+      }
+
+      mutex mu_;
+      size_t current_file_index_ GUARDED_BY(mu_) = 0;
+      io::RecordIndex index_ GUARDED_BY(mu_);
+      // The records of the current file that belong to the shard, and the
+      // next one to read.
+      int64 begin_record_ GUARDED_BY(mu_) = 0;
+      int64 end_record_ GUARDED_BY(mu_) = 0;
+      int64 next_record_ GUARDED_BY(mu_) = 0;
+
+      // `reader_` will borrow the object that `file_` points to, so
+      // we must destroy `reader_` before `file_`.
+      std::unique_ptr<RandomAccessFile> file_ GUARDED_BY(mu_);
+      std::unique_ptr<io::SequentialRecordReader> reader_ GUARDED_BY(mu_);
+    };
+
+    const std::vector<string> filenames_;
+    const int64 num_shards_;
+    const int64 shard_index_;
+    const bool skip_corrupted_records_;
+    io::RecordReaderOptions options_;
+  };
+
+  bool skip_corrupted_records_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("IndexedTFRecordDataset").Device(DEVICE_CPU),
+                        IndexedTFRecordDatasetOp);
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -244,6 +244,22 @@ __global__ void RowReduceKernel(
   if (row < num_rows && lane == 0) out[row] = sum;
 }
 
+// maps a thread to each row, for rows too short to keep the lanes of a
+// warp busy
+template <typename T, typename outT, typename Op>
+__global__ void RowReduceSmallKernel(T in, outT out, int num_rows,
+                                     int num_cols, Op op) {
+  typedef typename std::iterator_traits<T>::value_type value_type;
+  const int row = blockIdx.x * blockDim.x + threadIdx.x;
+  if (row >= num_rows) return;
+
+  value_type sum = in[row * num_cols];
+  for (int col = 1; col < num_cols; ++col) {
+    sum = op(sum, in[row * num_cols + col]);
+  }
+  out[row] = sum;
+}
+
 // Works only if there are <= 16 columns
 // each warps sums over multiple rows at once
 template <typename T, typename outT, typename Op>
@@ -515,6 +531,15 @@ template <typename T, typename Op, typename OUT_T, typename IN_T>
 void LaunchRowReduction(OpKernelContext* ctx, OUT_T out, IN_T in, int num_rows,
                         int num_cols, Op op, T init,
                         const cudaStream_t& cu_stream) {
+  if (num_cols <= 16) {
+    const int threads_per_block = 128;
+    int num_blocks = Eigen::divup(num_rows, threads_per_block);
+
+    RowReduceSmallKernel<<<num_blocks, threads_per_block, 0, cu_stream>>>(
+        in, out, num_rows, num_cols, op);
+    return;
+  }
+
   if (num_cols < 1024) {
     const int threads_per_block = 128;
     const int warps_per_block = threads_per_block / 32;
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -132,6 +133,154 @@ class ReductionHelper {
   gtl::InlinedVector<int64, 4> out_reshape_;   // Reshape output for reduction.
 };
 
+// Inputs with at most this many elements are reduced by the hand-written
+// loops of SmallReduction, on the calling thread.
+static constexpr int64 kSmallReductionSize = 4096;
+
+// Row and column reductions of matrices with at most this many columns are
+// reduced by the hand-written loops of SmallReduction, whatever their size.
+static constexpr int64 kSkinnyReductionMaxCols = 16;
+
+// Partial results of a Reducer over disjoint sets of elements are combined
+// with Combiner, and the combined result is turned into the result of the
+// reduction of all "count" elements with Finalize().
+template <typename Reducer>
+struct PartialReduction {
+  typedef Reducer Combiner;
+  template <typename T>
+  static T Finalize(const Reducer& reducer, T accum, int64 count) {
+    return reducer.finalize(accum);
+  }
+};
+
+// The partial results of MeanReducer are sums, which are only divided by the
+// number of elements at the end.
+template <typename T>
+struct PartialReduction<Eigen::internal::MeanReducer<T>> {
+  typedef Eigen::internal::SumReducer<T> Combiner;
+  static T Finalize(const Eigen::internal::MeanReducer<T>& reducer, T accum,
+                    int64 count) {
+    return accum / T(count);
+  }
+};
+
+// Hand-written reductions of small and skinny tensors, where the expression
+// setup and thread pool dispatch of Eigen's generic reducer dominate.
+// Reduce() returns false, and leaves "out" untouched, if it does not handle
+// the reduction described by "helper".
+template <typename Device, typename T, typename Reducer>
+struct SmallReduction {
+  static bool Reduce(OpKernelContext* ctx, ReductionHelper& helper,
+                     const Tensor& data, const Reducer& reducer, Tensor* out) {
+    return false;
+  }
+};
+
+template <typename T, typename Reducer>
+struct SmallReduction<CPUDevice, T, Reducer> {
+  static bool Reduce(OpKernelContext* ctx, ReductionHelper& helper,
+                     const Tensor& data, const Reducer& reducer, Tensor* out) {
+    const int64 size = data.NumElements();
+    if (helper.ndims() == 1 && helper.reduce_first_axis()) {
+      if (size > kSmallReductionSize) return false;
+      ReduceRows(data.flat<T>().data(), 0, 1, size, reducer,
+                 out->flat<T>().data());
+      return true;
+    }
+    if (helper.ndims() != 2) return false;
+    const auto in = helper.in<T, 2>(data);
+    const int64 num_rows = in.dimension(0);
+    const int64 num_cols = in.dimension(1);
+    if (size > kSmallReductionSize && num_cols > kSkinnyReductionMaxCols) {
+      return false;
+    }
+    T* out_data = out->flat<T>().data();
+    if (!helper.reduce_first_axis()) {
+      // Each row is reduced on its own, so rows are simply sharded.
+      auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+            5 * num_cols, [&in, num_cols, &reducer, out_data](int64 begin,
+                                                              int64 end) {
+              ReduceRows(in.data(), begin, end, num_cols, reducer, out_data);
+            });
+      return true;
+    }
+    ReduceColumns(ctx, in.data(), num_rows, num_cols, reducer, out_data);
+    return true;
+  }
+
+ private:
+  // out[r] = reduce(in[r, :]) for the rows begin <= r < end of the row-major
+  // matrix "in".
+  static void ReduceRows(const T* in, int64 begin, int64 end, int64 num_cols,
+                         const Reducer& reducer, T* out) {
+    for (int64 r = begin; r < end; ++r) {
+      Reducer row_reducer = reducer;
+      T accum = row_reducer.initialize();
+      const T* row = in + r * num_cols;
+      for (int64 c = 0; c < num_cols; ++c) {
+        row_reducer.reduce(row[c], &accum);
+      }
+      out[r] = row_reducer.finalize(accum);
+    }
+  }
+
+  // accum[c] = partial reduce(in[begin:end, c]) of the row-major matrix "in",
+  // which sweeps the rows in memory order.
+  static void AccumulateColumns(const T* in, int64 begin, int64 end,
+                                int64 num_cols, const Reducer& reducer,
+                                T* accum) {
+    gtl::InlinedVector<Reducer, kSkinnyReductionMaxCols> col_reducers(
+        num_cols, reducer);
+    for (int64 c = 0; c < num_cols; ++c) {
+      accum[c] = reducer.initialize();
+    }
+    for (int64 r = begin; r < end; ++r) {
+      const T* row = in + r * num_cols;
+      for (int64 c = 0; c < num_cols; ++c) {
+        col_reducers[c].reduce(row[c], &accum[c]);
+      }
+    }
+  }
+
+  // out[c] = reduce(in[:, c]). The rows are split into blocks of about
+  // kSmallReductionSize elements, which are reduced in parallel and then
+  // combined column by column.
+  static void ReduceColumns(OpKernelContext* ctx, const T* in, int64 num_rows,
+                            int64 num_cols, const Reducer& reducer, T* out) {
+    const int64 rows_per_block =
+        std::max<int64>(1, kSmallReductionSize / num_cols);
+    const int64 num_blocks = Eigen::divup(num_rows, rows_per_block);
+    Tensor partial;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                           TensorShape({num_blocks, num_cols}),
+                                           &partial));
+    T* partial_data = partial.flat<T>().data();
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          5 * rows_per_block * num_cols,
+          [in, num_rows, num_cols, rows_per_block, &reducer, partial_data](
+              int64 begin, int64 end) {
+            for (int64 b = begin; b < end; ++b) {
+              const int64 row_begin = b * rows_per_block;
+              const int64 row_end =
+                  std::min(num_rows, row_begin + rows_per_block);
+              AccumulateColumns(in, row_begin, row_end, num_cols, reducer,
+                                partial_data + b * num_cols);
+            }
+          });
+    typedef typename PartialReduction<Reducer>::Combiner Combiner;
+    for (int64 c = 0; c < num_cols; ++c) {
+      Combiner combiner;
+      T accum = combiner.initialize();
+      for (int64 b = 0; b < num_blocks; ++b) {
+        combiner.reduce(partial_data[b * num_cols + c], &accum);
+      }
+      out[c] = PartialReduction<Reducer>::Finalize(reducer, accum, num_rows);
+    }
+  }
+};
+
 // For operations where the output is a reduction function along some
 // dimensions of the input.
 template <typename Device, class T, typename Tperm, typename Reducer>
@@ -192,6 +341,10 @@ class ReductionOp : public OpKernel {
       // with identity elements.  Example: tf.reduce_sum(tf.zeros((0, 3)), [0]).
       // Eigen sometimes crashes in this case, so we do it manually.
       Functor::FillIdentity(d, tmp_out.flat<T>(), reducer);
+    } else if (SmallReduction<Device, T, Reducer>::Reduce(ctx, helper, data,
+                                                          reducer, &tmp_out)) {
+      // Reduced by hand-written loops, unless allocating a temporary failed.
+      if (!ctx->status().ok()) return;
     } else if ((helper.ndims() == 1) && helper.reduce_first_axis()) {
       // Reduce to a scalar.
       Functor::Reduce(ctx, helper.out<T, 0>(&tmp_out), helper.in<T, 1>(data),
@@ -184,4 +184,59 @@ static void BM_Bool2DToScalarGPU(int iters, int num_x, int num_y) {
 }
 BENCHMARK(BM_Bool2DToScalarGPU)->RangePair(2048, 8192, 2048, 8192);
 
+static void BM_Sum2DToScalarCPU(int iters, int num_x, int num_y) {
+  ReduceToScalar<float>(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DToScalarCPU)->RangePair(1, 8192, 1, 8192);
+
+static void BM_Sum2DRowReduceCPU(int iters, int num_x, int num_y) {
+  DoRowReduce(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DRowReduceCPU)->RangePair(1, 8192, 1, 8192);
+
+static void BM_Sum2DColumnReduceCPU(int iters, int num_x, int num_y) {
+  DoColReduce(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DColumnReduceCPU)->RangePair(1, 8192, 1, 8192);
+
+static void DoScalarReduce(int iters, const string& device,
+                           const string& reduce, int num_x, int num_y) {
+  ReduceToScalar<float>(iters, device, reduce, num_x, num_y);
+}
+
+// Full, row and column reductions of small and of skinny [num_x, num_y]
+// matrices.
+#define BM_SMALL_AND_SKINNY(REDUCE, KIND, DEVICE)                            \
+  static void BM_##REDUCE##2D##KIND##SmallAndSkinny##_##DEVICE(              \
+      int iters, int num_x, int num_y) {                                     \
+    Do##KIND(iters, #DEVICE, #REDUCE, num_x, num_y);                         \
+  }                                                                          \
+  BENCHMARK(BM_##REDUCE##2D##KIND##SmallAndSkinny##_##DEVICE)                \
+      ->ArgPair(4, 4)                                                        \
+      ->ArgPair(16, 16)                                                      \
+      ->ArgPair(64, 64)                                                      \
+      ->ArgPair(1024, 1)                                                     \
+      ->ArgPair(1024, 8)                                                     \
+      ->ArgPair(1024, 16)                                                    \
+      ->ArgPair(65536, 1)                                                    \
+      ->ArgPair(65536, 8)                                                    \
+      ->ArgPair(65536, 16)                                                   \
+      ->ArgPair(1048576, 8)                                                  \
+      ->ArgPair(1048576, 16)
+
+#define BM_SMALL_AND_SKINNY_ALL(DEVICE)            \
+  BM_SMALL_AND_SKINNY(Sum, ScalarReduce, DEVICE);  \
+  BM_SMALL_AND_SKINNY(Sum, RowReduce, DEVICE);     \
+  BM_SMALL_AND_SKINNY(Sum, ColReduce, DEVICE);     \
+  BM_SMALL_AND_SKINNY(Mean, RowReduce, DEVICE);    \
+  BM_SMALL_AND_SKINNY(Mean, ColReduce, DEVICE);    \
+  BM_SMALL_AND_SKINNY(Max, RowReduce, DEVICE);     \
+  BM_SMALL_AND_SKINNY(Max, ColReduce, DEVICE)
+
+BM_SMALL_AND_SKINNY_ALL(cpu);
+BM_SMALL_AND_SKINNY_ALL(gpu);
+
+#undef BM_SMALL_AND_SKINNY_ALL
+#undef BM_SMALL_AND_SKINNY
+
 }  // end namespace tensorflow
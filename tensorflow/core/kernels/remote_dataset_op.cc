@@ -0,0 +1,349 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/dataset.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class RemoteDatasetOp : public DatasetOpKernel {
+ public:
+  explicit RemoteDatasetOp(OpKernelConstruction* ctx) : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("f", &func_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* graph_defs_t;
+    OP_REQUIRES_OK(ctx, ctx->input("graph_defs", &graph_defs_t));
+    const Tensor* workers_t;
+    OP_REQUIRES_OK(ctx, ctx->input("workers", &workers_t));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(graph_defs_t->shape()) &&
+                         TensorShapeUtils::IsVector(workers_t->shape()),
+                errors::InvalidArgument(
+                    "graph_defs and workers must be vectors, got ",
+                    graph_defs_t->shape().DebugString(), " and ",
+                    workers_t->shape().DebugString()));
+    OP_REQUIRES(ctx, graph_defs_t->NumElements() == workers_t->NumElements(),
+                errors::InvalidArgument(
+                    "graph_defs and workers must have the same size, got ",
+                    graph_defs_t->NumElements(), " and ",
+                    workers_t->NumElements()));
+    OP_REQUIRES(ctx, workers_t->NumElements() > 0,
+                errors::InvalidArgument("workers must not be empty"));
+
+    int64 buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "buffer_size", &buffer_size));
+    OP_REQUIRES(ctx, buffer_size > 0,
+                errors::InvalidArgument("buffer_size must be positive"));
+
+    FunctionLibraryRuntime* lib = ctx->function_library();
+    OP_REQUIRES(ctx, lib != nullptr,
+                errors::Internal("No function library is provided."));
+
+    // Instantiates `f` once for each worker, which registers it on the
+    // worker.
+    std::vector<string> graph_defs;
+    std::vector<string> workers;
+    std::vector<FunctionLibraryRuntime::Handle> handles;
+    for (int64 i = 0; i < workers_t->NumElements(); ++i) {
+      graph_defs.push_back(graph_defs_t->vec<string>()(i));
+      workers.push_back(DeviceNameUtils::CanonicalizeDeviceName(
+          workers_t->vec<string>()(i)));
+      AttrValueMap attr_values = func_.attr();
+      AttrValue target;
+      target.set_s(workers.back());
+      AddAttr("_target", target, &attr_values);
+      FunctionLibraryRuntime::Handle handle;
+      OP_REQUIRES_OK(ctx, lib->Instantiate(func_.name(),
+                                           AttrSlice(&attr_values), &handle));
+      handles.push_back(handle);
+    }
+
+    *output = new Dataset(lib, ctx->device()->name(), std::move(graph_defs),
+                          std::move(workers), std::move(handles), buffer_size,
+                          output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(FunctionLibraryRuntime* lib, const string& source_device,
+            std::vector<string> graph_defs, std::vector<string> workers,
+            std::vector<FunctionLibraryRuntime::Handle> handles,
+            int64 buffer_size, const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : lib_(lib),
+          source_device_(source_device),
+          graph_defs_(std::move(graph_defs)),
+          workers_(std::move(workers)),
+          handles_(std::move(handles)),
+          buffer_size_(buffer_size),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      return std::unique_ptr<IteratorBase>(
+          new Iterator({this, strings::StrCat(prefix, "::Remote")}));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() override {
+      return strings::StrCat("RemoteDatasetOp(", workers_.size(),
+                             " workers)::Dataset");
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            iterator_ids_(MakeIteratorIds(params.dataset->workers_.size())),
+            workers_(params.dataset->workers_.size()) {}
+
+      ~Iterator() override {
+        // The calls in flight refer to this iterator.
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        while (num_calls_ > 0) {
+          cond_var_.wait(l);
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        std::vector<Call> calls;
+        Status s;
+        {
+          mutex_lock l(mu_);
+          if (!runner_) {
+            runner_ = *ctx->runner();
+            ReserveCalls(&calls);
+          }
+        }
+        StartCalls(calls);
+        calls.clear();
+        {
+          mutex_lock l(mu_);
+          if (GetNextStatsRecorder* stats = GetNextStatsRecorder::Current()) {
+            stats->RecordBufferUtilization(buffer_.size(), Capacity());
+          }
+          {
+            ScopedInputWait wait;
+            while (buffer_.empty() && num_calls_ > 0) {
+              cond_var_.wait(l);
+            }
+          }
+          if (buffer_.empty()) {
+            // All the workers have reached their end.
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          s = buffer_.front().status;
+          if (s.ok()) {
+            *out_tensors = std::move(buffer_.front().value);
+          }
+          buffer_.pop_front();
+          *end_of_sequence = false;
+          ReserveCalls(&calls);
+        }
+        StartCalls(calls);
+        return s;
+      }
+
+     private:
+      struct Worker {
+        int64 num_calls = 0;
+        // True once a call has created the iterator on the worker.
+        bool created = false;
+        // True once the iterator on the worker has reached its end, or
+        // failed.
+        bool finished = false;
+      };
+
+      struct Call {
+        int index;
+        // True if the call creates the iterator on the worker.
+        bool create;
+      };
+
+      struct BufferElement {
+        Status status;
+        std::vector<Tensor> value;
+      };
+
+      // Returns the ids of the iterators of this iterator on `num_workers`
+      // workers, which are only known to it.
+      static std::vector<string> MakeIteratorIds(size_t num_workers) {
+        const string id = strings::FpToString(random::New64());
+        std::vector<string> iterator_ids;
+        for (size_t i = 0; i < num_workers; ++i) {
+          iterator_ids.push_back(strings::StrCat(id, "/", i));
+        }
+        return iterator_ids;
+      }
+
+      int64 Capacity() const {
+        return dataset()->buffer_size_ * workers_.size();
+      }
+
+      // Reserves calls to the workers with the fewest calls in flight, while
+      // the buffered elements and the calls in flight are fewer than the
+      // capacity. Only one call is issued to a worker until its iterator has
+      // been created.
+      void ReserveCalls(std::vector<Call>* calls)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (!cancelled_ && buffer_.size() + num_calls_ < Capacity()) {
+          int best = -1;
+          for (size_t i = 0; i < workers_.size(); ++i) {
+            // Breaks ties in a round-robin order.
+            const int index = (next_worker_ + i) % workers_.size();
+            const Worker& worker = workers_[index];
+            if (worker.finished ||
+                worker.num_calls >= dataset()->buffer_size_ ||
+                (!worker.created && worker.num_calls > 0)) {
+              continue;
+            }
+            if (best < 0 || worker.num_calls < workers_[best].num_calls) {
+              best = index;
+            }
+          }
+          if (best < 0) break;
+          next_worker_ = (best + 1) % workers_.size();
+          calls->push_back({best, !workers_[best].created});
+          ++workers_[best].num_calls;
+          ++num_calls_;
+        }
+      }
+
+      // Issues the reserved `calls`, without holding `mu_` since a call may
+      // complete synchronously.
+      void StartCalls(const std::vector<Call>& calls) LOCKS_EXCLUDED(mu_) {
+        for (const Call& call : calls) {
+          FunctionLibraryRuntime::Options opts;
+          // Copied from CapturedFunction::generate_step_id();
+          opts.step_id = -std::abs(static_cast<int64>(random::New64()));
+          opts.runner = &runner_;
+          opts.source_device = dataset()->source_device_;
+          opts.remote_execution = true;
+          opts.create_rendezvous = true;
+          AllocatorAttributes arg_alloc_attr;
+          arg_alloc_attr.set_on_host(true);
+          opts.args_alloc_attrs = {arg_alloc_attr, arg_alloc_attr};
+          // The serialized dataset is only sent with the call that creates
+          // the iterator on the worker.
+          Tensor graph(DT_STRING, TensorShape({}));
+          if (call.create) {
+            graph.scalar<string>()() = dataset()->graph_defs_[call.index];
+          }
+          Tensor iterator_id(DT_STRING, TensorShape({}));
+          iterator_id.scalar<string>()() = iterator_ids_[call.index];
+          auto* rets = new std::vector<Tensor>;
+          const int index = call.index;
+          dataset()->lib_->Run(opts, dataset()->handles_[index],
+                               {graph, iterator_id}, rets,
+                               [this, index, rets](const Status& status) {
+                                 CallDone(index, status, rets);
+                               });
+        }
+      }
+
+      void CallDone(int index, const Status& status, std::vector<Tensor>* rets)
+          LOCKS_EXCLUDED(mu_) {
+        std::unique_ptr<std::vector<Tensor>> value(rets);
+        std::vector<Call> calls;
+        {
+          mutex_lock l(mu_);
+          Worker& worker = workers_[index];
+          --worker.num_calls;
+          --num_calls_;
+          if (status.ok()) {
+            worker.created = true;
+            buffer_.push_back({status, std::move(*value)});
+          } else {
+            // The end of the dataset of the worker is not an error, and
+            // other errors are reported once.
+            worker.finished = true;
+            if (!errors::IsOutOfRange(status)) {
+              buffer_.push_back({status, {}});
+            }
+          }
+          ReserveCalls(&calls);
+          // Wakes the consumers, and the destructor once there is no call in
+          // flight.
+          cond_var_.notify_all();
+        }
+        if (!calls.empty()) {
+          StartCalls(calls);
+        }
+      }
+
+      const std::vector<string> iterator_ids_;
+      mutex mu_;
+      condition_variable cond_var_;
+      // Set by the first call to GetNext(), before any call is issued.
+      std::function<void(std::function<void()>)> runner_;
+      std::vector<Worker> workers_ GUARDED_BY(mu_);
+      int64 num_calls_ GUARDED_BY(mu_) = 0;
+      int next_worker_ GUARDED_BY(mu_) = 0;
+      std::deque<BufferElement> buffer_ GUARDED_BY(mu_);
+      bool cancelled_ GUARDED_BY(mu_) = false;
+    };
+
+    FunctionLibraryRuntime* const lib_;
+    const string source_device_;
+    const std::vector<string> graph_defs_;
+    const std::vector<string> workers_;
+    const std::vector<FunctionLibraryRuntime::Handle> handles_;
+    const int64 buffer_size_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  NameAttrList func_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("RemoteDataset").Device(DEVICE_CPU),
+                        RemoteDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
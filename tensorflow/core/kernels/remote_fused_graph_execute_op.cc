@@ -18,16 +18,21 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/remote_fused_graph_execute_info.pb.h"
 #include "tensorflow/core/kernels/i_remote_fused_graph_executor.h"
+#include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/remote_fused_graph_execute_utils.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
-class RemoteFusedGraphExecuteOp : public OpKernel {
+class RemoteFusedGraphExecuteOp : public AsyncOpKernel {
  public:
   explicit RemoteFusedGraphExecuteOp(OpKernelConstruction* const ctx)
-      : OpKernel(ctx), execute_info_() {
+      : AsyncOpKernel(ctx), execute_info_() {
     string serialized_proto;
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(RemoteFusedGraphExecuteUtils::
@@ -58,10 +63,20 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
 
       // 2. Setup graph in remote processor
       remote_fused_graph_executor_->SetupGraph();
+
+      if (execute_info_.async_execution()) {
+        thread_pool_.reset(new thread::ThreadPool(
+            ctx->env(), ThreadOptions(),
+            strings::StrCat("remote_fused_graph_execute_",
+                            SanitizeThreadSuffix(name())),
+            1 /* num_threads */, false /* low_latency_hint */));
+      }
     }
   }
 
   ~RemoteFusedGraphExecuteOp() final {
+    // Joins the thread before the graph is torn down.
+    thread_pool_.reset();
     if (remote_fused_graph_executor_) {
       // 6. Teardown graph in remote processor
       remote_fused_graph_executor_->TeardownGraph();
@@ -71,8 +86,29 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
     }
   }
 
-  void Compute(OpKernelContext* const ctx) final {
+  void ComputeAsync(OpKernelContext* const ctx, DoneCallback done) final {
     CHECK(ctx != nullptr);
+    if (thread_pool_) {
+      // Frees the calling thread for the host side of other steps while the
+      // remote processor runs this one.
+      thread_pool_->Schedule([this, ctx, done]() {
+        Execute(ctx);
+        done();
+      });
+    } else {
+      Execute(ctx);
+      done();
+    }
+  }
+
+  bool IsExpensive() final { return true; }
+
+ private:
+  // Runs one inference on the remote processor. The executor keeps the
+  // inputs and outputs of a single inference, so the inferences of
+  // concurrent steps run one after another.
+  void Execute(OpKernelContext* const ctx) {
+    mutex_lock l(mu_);
     const int input_count = ctx->num_inputs();
     const int graph_input_count = execute_info_.graph_input_node_name_size();
     CHECK(input_count == graph_input_count &&
@@ -81,8 +117,12 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
         << ", gt input count = " << execute_info_.graph_input_node_name_size()
         << ", type count = " << input_types_.size();
 
+    Env* const env = ctx->env();
+    const uint64 fill_start_us = env->NowMicros();
+
     // 3. Send first data type inputs into remote processor
     for (int i = 0; i < graph_input_count; ++i) {
+      port::Tracing::TraceMe activity(name(), "FillInputNode");
       const Tensor& input_tensor = ctx->input(i);
       const string& input_node_name = execute_info_.graph_input_node_name(i);
       if (remote_fused_graph_executor_) {
@@ -92,9 +132,12 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
     }
 
     // 4. Execute graph in remote processor
+    const uint64 execute_start_us = env->NowMicros();
     if (remote_fused_graph_executor_) {
+      port::Tracing::TraceMe activity(name(), "ExecuteGraph");
       remote_fused_graph_executor_->ExecuteGraph();
     }
+    const uint64 read_start_us = env->NowMicros();
 
     // 5. Load outputs from remote processor
     const int output_count = ctx->num_outputs();
@@ -104,6 +147,7 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
       Tensor* output = nullptr;
       const string& output_node_name = execute_info_.graph_output_node_name(i);
       if (remote_fused_graph_executor_) {
+        port::Tracing::TraceMe activity(name(), "ReadOutputNode");
         remote_fused_graph_executor_->ReadOutputNode(
             output_node_name,
             [i, &ctx, &output](const TensorShape& shape) -> Tensor* {
@@ -118,13 +162,17 @@ class RemoteFusedGraphExecuteOp : public OpKernel {
         TF_CHECK_OK(ctx->allocate_output(i, ts, &output));
       }
     }
+    VLOG(1) << name() << ": fill inputs "
+            << execute_start_us - fill_start_us << " us, execute "
+            << read_start_us - execute_start_us << " us, read outputs "
+            << env->NowMicros() - read_start_us << " us";
   }
 
-  bool IsExpensive() final { return true; }
-
- private:
   RemoteFusedGraphExecuteInfo execute_info_;
   std::unique_ptr<IRemoteFusedGraphExecutor> remote_fused_graph_executor_;
+  mutex mu_;
+  // Runs the inferences when execute_info_.async_execution() is set.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
   DataTypeVector input_types_;
   DataTypeVector output_types_;
 
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/remote_fused_graph_execute_op_test_utils.h"
 #include "tensorflow/core/kernels/remote_fused_graph_execute_utils.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
@@ -126,9 +127,10 @@ static Output BuildRemoteFusedGraphExecuteOp(
 }
 
 static RemoteFusedGraphExecuteInfo BuildRemoteFusedGraphExecuteInfo(
-    const GraphDef& original_graph) {
+    const GraphDef& original_graph, bool async_execution) {
   RemoteFusedGraphExecuteInfo execute_info;
   execute_info.set_executor_name(REMOTE_FUSED_EXECUTOR_NAME);
+  execute_info.set_async_execution(async_execution);
 
   // In this example, simply copy all nodes. Basically, you don't need to add
   // unused node for inference.
@@ -249,13 +251,14 @@ static RemoteFusedGraphExecuteUtils::ExecutorBuildRegistrar
 
 // 3. Create Graph transform function to fuse your graph
 static Status RewriteGraphToFusedGraph(const GraphDef& original_graph,
+                                       bool async_execution,
                                        GraphDef* fused_graph) {
   Scope root = Scope::NewRootScope();
   std::vector<Output> output_list;
   const Output op_a = BuildPlaceHolderOp(NAME_A, DT_FLOAT, {}, &root);
   output_list.emplace_back(op_a);
   const RemoteFusedGraphExecuteInfo execute_info =
-      BuildRemoteFusedGraphExecuteInfo(original_graph);
+      BuildRemoteFusedGraphExecuteInfo(original_graph, async_execution);
   BuildRemoteFusedGraphExecuteOp(REMOTE_FUSED_EXECUTE_OP_NODE_NAME, output_list,
                                  1, execute_info, &root);
   GraphDef fused_graph_def;
@@ -285,7 +288,9 @@ TEST(RemoteFusedExecuteGraphOp, EndToEndTest) {
 
   // 5.2 Fuse graph
   GraphDef fused_graph;
-  TF_ASSERT_OK(RewriteGraphToFusedGraph(original_graph, &fused_graph));
+  TF_ASSERT_OK(RewriteGraphToFusedGraph(original_graph,
+                                        false /* async_execution */,
+                                        &fused_graph));
 
   // 5.3 Setup session
   std::vector<Tensor> output_tensors;
@@ -320,6 +325,47 @@ TEST(RemoteFusedExecuteGraphOp, EndToEndTest) {
               FLOAT_VALUE_TOLERANCE);
 }
 
+TEST(RemoteFusedExecuteGraphOp, EndToEndAsyncTest) {
+  GraphDef original_graph;
+  TF_ASSERT_OK(RemoteFusedGraphExecuteOpTestUtils::BuildAddGraph(
+      NAME_A, NODE_A_VAL, NAME_B, NODE_B_VAL, NAME_A_PLUS_B, &original_graph));
+  GraphDef fused_graph;
+  TF_ASSERT_OK(RewriteGraphToFusedGraph(
+      original_graph, true /* async_execution */, &fused_graph));
+
+  SessionOptions session_options;
+  session_options.env = Env::Default();
+  std::unique_ptr<Session> session(NewSession(session_options));
+  TF_ASSERT_OK(session->Create(fused_graph));
+
+  Tensor input_a(DT_FLOAT, {});
+  input_a.flat<float>().data()[0] = NODE_A_VAL2;
+  const std::vector<std::pair<string, Tensor>> inputs{{NAME_A, input_a}};
+  const std::vector<string> outputs{REMOTE_FUSED_EXECUTE_OP_NODE_NAME};
+
+  // Concurrent steps share the op, whose inferences run one at a time.
+  constexpr int kNumSteps = 8;
+  std::vector<std::vector<Tensor>> output_tensors(kNumSteps);
+  std::vector<Status> statuses(kNumSteps);
+  {
+    thread::ThreadPool pool(Env::Default(), "remote_fused_graph_steps",
+                            kNumSteps);
+    for (int i = 0; i < kNumSteps; ++i) {
+      pool.Schedule([&session, &inputs, &outputs, &output_tensors, &statuses,
+                     i]() {
+        statuses[i] = session->Run(inputs, outputs, {}, &output_tensors[i]);
+      });
+    }
+  }
+  for (int i = 0; i < kNumSteps; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    ASSERT_EQ(1, output_tensors[i].size());
+    EXPECT_NEAR(NODE_A_VAL2 + NODE_B_VAL,
+                output_tensors[i].at(0).flat<float>().data()[0],
+                FLOAT_VALUE_TOLERANCE);
+  }
+}
+
 ////////////////////////////
 // End-to-end test: End   //
 ////////////////////////////
@@ -234,10 +234,15 @@ void RestoreTensor(OpKernelContext* context,
 #undef READER_COPY
 }
 
+// The maximum number of threads reading the tensors restored by
+// RestoreTensorsV2().
+static const int kNumRestoreThreads = 16;
+
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes) {
+                        gtl::ArraySlice<DataType> dtypes,
+                        bool memory_mapped) {
   const string& prefix_string = prefix.scalar<string>()();
   const auto& tensor_names_flat = tensor_names.flat<string>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<string>();
@@ -246,21 +251,31 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   TF_RETURN_IF_ERROR(reader.status());
 
   // TODO(zongheng): potential optimization: one Seek() in first lookup.
-  // TODO(zongheng): consider measuring speed and issuing concurrent lookups
-  // within a fixed memory budget.
   TensorShape restored_full_shape;
   Tensor* restored_tensor = nullptr;
+  // The full tensors are looked up together at the end, which reads them
+  // concurrently.
+  std::vector<string> full_tensor_names;
+  std::vector<Tensor*> full_tensors;
+  std::vector<Tensor*> restored_tensors(tensor_names_flat.size());
   for (size_t i = 0; i < tensor_names_flat.size(); ++i) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
     TF_RETURN_IF_ERROR(
         reader.LookupTensorShape(tensor_name, &restored_full_shape));
 
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && memory_mapped) {
+      // Lookup the full tensor, without copying it if it can be mapped.
+      Tensor mapped;
+      TF_RETURN_IF_ERROR(reader.LookupMapped(tensor_name, &mapped));
+      context->set_output(i, mapped);
+      restored_tensor = context->mutable_output(i);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(i, restored_full_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(reader.Lookup(tensor_name, restored_tensor));
+      full_tensor_names.push_back(tensor_name);
+      full_tensors.push_back(restored_tensor);
     } else {
       // Lookup the slice.
       TensorShape parsed_full_shape;
@@ -283,11 +298,16 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       TF_RETURN_IF_ERROR(
           reader.LookupSlice(tensor_name, parsed_slice, restored_tensor));
     }
-    if (dtypes[i] != restored_tensor->dtype()) {
+    restored_tensors[i] = restored_tensor;
+  }
+  TF_RETURN_IF_ERROR(reader.LookupMany(full_tensor_names, full_tensors,
+                                       kNumRestoreThreads));
+  for (size_t i = 0; i < tensor_names_flat.size(); ++i) {
+    if (dtypes[i] != restored_tensors[i]->dtype()) {
       return errors::InvalidArgument(
-          "tensor_name = ", tensor_name, "; expected dtype ",
+          "tensor_name = ", tensor_names_flat(i), "; expected dtype ",
           DataTypeString(dtypes[i]), " does not equal restored dtype ",
-          DataTypeString(restored_tensor->dtype()));
+          DataTypeString(restored_tensors[i]->dtype()));
     }
   }
   return Status::OK();
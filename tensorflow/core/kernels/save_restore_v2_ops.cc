@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/bounds_check.h"
@@ -29,9 +30,12 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
+#include "tensorflow/core/util/tensor_bundle/async_bundle_writer.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -85,12 +89,41 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Reads the options of the writers of SaveV2 and AsyncSaveV2 from the
+// environment.
+Status GetWriterOptionsFromEnv(BundleWriter::Options* options) {
+  // The number of data files of each bundle, which are written concurrently.
+  int64 num_data_shards;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_CHECKPOINT_NUM_DATA_SHARDS", 1,
+                                         &num_data_shards));
+  if (num_data_shards < 1) {
+    return errors::InvalidArgument(
+        "TF_CHECKPOINT_NUM_DATA_SHARDS must be at least 1, got ",
+        num_data_shards);
+  }
+  options->num_data_shards = num_data_shards;
+  // The alignment of the tensor contents in the data files, so that they can
+  // be restored from memory mappings (see TF_RESTORE_MEMORY_MAPPED).
+  int64 data_alignment;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_CHECKPOINT_DATA_ALIGNMENT", 1,
+                                         &data_alignment));
+  if (data_alignment < 1) {
+    return errors::InvalidArgument(
+        "TF_CHECKPOINT_DATA_ALIGNMENT must be at least 1, got ",
+        data_alignment);
+  }
+  options->data_alignment = data_alignment;
+  return Status::OK();
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, GetWriterOptionsFromEnv(&writer_options_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -105,7 +138,7 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<string>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<string>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
+    BundleWriter writer(Env::Default(), prefix_string, writer_options_);
     OP_REQUIRES_OK(context, writer.status());
     VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
 
@@ -136,14 +169,122 @@ class SaveV2 : public OpKernel {
     }
     OP_REQUIRES_OK(context, writer.Finish());
   }
+
+ private:
+  BundleWriter::Options writer_options_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
+// Snapshots a list of named tensors, and saves them using the tensor bundle
+// library on the thread of AsyncBundleWriter::Global().
+class AsyncSaveV2 : public OpKernel {
+ public:
+  explicit AsyncSaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("copy_on_write", &copy_on_write_));
+    OP_REQUIRES_OK(context, GetWriterOptionsFromEnv(&writer_options_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    const Tensor& tensor_names = context->input(1);
+    const Tensor& shape_and_slices = context->input(2);
+    ValidateInputs(true /* is save op */, context, prefix, tensor_names,
+                   shape_and_slices);
+    if (!context->status().ok()) return;
+
+    const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
+    const int num_tensors = static_cast<int>(tensor_names.NumElements());
+    const string& prefix_string = prefix.scalar<string>()();
+    const auto& tensor_names_flat = tensor_names.flat<string>();
+    const auto& shape_and_slices_flat = shape_and_slices.flat<string>();
+
+    // Validates the slices before anything is scheduled, so that the errors
+    // of the inputs are still returned by this op.
+    std::vector<AsyncBundleWriter::Entry> entries(num_tensors);
+    int64 total_bytes = 0;
+    for (int i = 0; i < num_tensors; ++i) {
+      AsyncBundleWriter::Entry* entry = &entries[i];
+      entry->key = tensor_names_flat(i);
+      const Tensor& tensor = context->input(i + kFixedInputs);
+      total_bytes += tensor.TotalBytes();
+      if (shape_and_slices_flat(i).empty()) continue;
+
+      const string& shape_spec = shape_and_slices_flat(i);
+      entry->is_slice = true;
+      entry->slice_spec = TensorSlice(tensor.dims());
+      TensorShape slice_shape;
+      OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
+                                  shape_spec, &entry->full_shape,
+                                  &entry->slice_spec, &slice_shape));
+      OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
+                  errors::InvalidArgument("Slice in shape_and_slice "
+                                          "specification does not match the "
+                                          "shape of the tensor to  save: ",
+                                          shape_spec, ", tensor: ",
+                                          tensor.shape().DebugString()));
+    }
+
+    AsyncBundleWriter* writer = AsyncBundleWriter::Global();
+    writer->ReserveBytes(total_bytes);
+    if (copy_on_write_) {
+      for (int i = 0; i < num_tensors; ++i) {
+        entries[i].tensor = context->input(i + kFixedInputs);
+      }
+    } else {
+      // Copying is bound by memory bandwidth, so the tensors are copied on
+      // the intra-op threads.
+      auto copy = [context, &entries](int64 start, int64 limit) {
+        for (int64 i = start; i < limit; ++i) {
+          entries[i].tensor =
+              tensor::DeepCopy(context->input(i + kFixedInputs));
+        }
+      };
+      auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads->num_threads, worker_threads->workers, num_tensors,
+            std::max<int64>(1, total_bytes / std::max(num_tensors, 1)), copy);
+    }
+    writer->Schedule(prefix_string, writer_options_, std::move(entries),
+                     total_bytes);
+    VLOG(1) << "AsyncSaveV2 scheduled " << num_tensors << " tensors of "
+            << total_bytes << " bytes to " << prefix_string;
+  }
+
+ private:
+  bool copy_on_write_;
+  BundleWriter::Options writer_options_;
+};
+REGISTER_KERNEL_BUILDER(Name("AsyncSaveV2").Device(DEVICE_CPU), AsyncSaveV2);
+
+// Waits for the checkpoints that AsyncSaveV2 writes to a prefix.
+class WaitForAsyncSaveV2 : public OpKernel {
+ public:
+  explicit WaitForAsyncSaveV2(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(prefix.shape()),
+                errors::InvalidArgument(
+                    "Input prefix should be a scalar tensor, got ",
+                    prefix.shape().DebugString(), " instead."));
+    const string& prefix_string = prefix.scalar<string>()();
+    OP_REQUIRES_OK(context, AsyncBundleWriter::Global()->Wait(prefix_string));
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("WaitForAsyncSaveV2").Device(DEVICE_CPU),
+                        WaitForAsyncSaveV2);
+
 // Restores a list of named tensors from a tensor bundle (V2 checkpoint format).
 class RestoreV2 : public OpKernel {
  public:
   explicit RestoreV2(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("dtypes", &dtypes_));
+    // Whether to restore the tensors from read-only memory mappings of the
+    // data files, which saves a copy and shares their pages across processes,
+    // but requires that the restored tensors are never modified (e.g. when
+    // serving).
+    OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_RESTORE_MEMORY_MAPPED",
+                                               false, &memory_mapped_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -174,13 +315,15 @@ class RestoreV2 : public OpKernel {
       return;
     }
     // If found, invokes the V2 reader.
-    OP_REQUIRES_OK(context, RestoreTensorsV2(context, prefix, tensor_names,
-                                             shape_and_slices, dtypes_));
+    OP_REQUIRES_OK(context,
+                   RestoreTensorsV2(context, prefix, tensor_names,
+                                    shape_and_slices, dtypes_, memory_mapped_));
   }
 
  private:
   // Expected dtypes of the to-restore tensors.
   std::vector<DataType> dtypes_;
+  bool memory_mapped_;
 };
 REGISTER_KERNEL_BUILDER(Name("RestoreV2").Device(DEVICE_CPU), RestoreV2);
 
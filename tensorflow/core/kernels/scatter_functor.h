@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/bounds_check.h"
@@ -215,9 +217,83 @@ struct ScatterFunctorBase<CPUDevice, T, Index, scatter_op::UpdateOp::ASSIGN> {
   }
 };
 
+// Applies large scatters on the intra-op thread pool of the device. The rows
+// of params are split into contiguous shards, the updates are bucketed by the
+// shard of their destination row, keeping their order, and every shard is then
+// updated by a single thread. No two threads write the same row, and the
+// updates of a row are applied in the same order as by ScatterFunctorBase, so
+// duplicate indices behave exactly as in the serial version.
+//
+// Unlike ScatterFunctorBase, all indices are checked before any update is
+// applied, so params are left untouched when an index is out of range.
+template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
+struct ParallelScatterFunctorCPU {
+  Index operator()(OpKernelContext* c, const Device& d,
+                   typename TTypes<T>::Matrix params,
+                   typename TTypes<T>::ConstMatrix updates,
+                   typename TTypes<Index>::ConstFlat indices) {
+    const Index N = static_cast<Index>(indices.size());
+    const Index limit = static_cast<Index>(params.dimension(0));
+    const int64 num_shards =
+        std::min<int64>(limit, 4 * static_cast<int64>(d.numThreads()));
+
+    // Read every index only once, and bucket the updates by shard.
+    std::vector<Index> rows(N);
+    std::vector<int64> shard_starts(num_shards + 1, 0);
+    for (Index i = 0; i < N; i++) {
+      const Index index = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index, limit)) return i;
+      rows[i] = index;
+      shard_starts[static_cast<int64>(index) * num_shards / limit + 1]++;
+    }
+    for (int64 s = 0; s < num_shards; s++) {
+      shard_starts[s + 1] += shard_starts[s];
+    }
+    std::vector<Index> order(N);
+    {
+      std::vector<int64> next(shard_starts.begin(), shard_starts.end() - 1);
+      for (Index i = 0; i < N; i++) {
+        order[next[static_cast<int64>(rows[i]) * num_shards / limit]++] = i;
+      }
+    }
+
+    auto work = [&](int64 first_shard, int64 last_shard) {
+      for (int64 k = shard_starts[first_shard]; k < shard_starts[last_shard];
+           k++) {
+        const Index i = order[k];
+        scatter_op::internal::Assign<op>::Run(
+            params.template chip<0>(rows[i]), updates.template chip<0>(i));
+      }
+    };
+    const double bytes_per_shard = static_cast<double>(N) *
+                                   params.dimension(1) * sizeof(T) / num_shards;
+    d.parallelFor(num_shards,
+                  Eigen::TensorOpCost(2 * bytes_per_shard, bytes_per_shard,
+                                      params.dimension(1) * N / num_shards),
+                  work);
+    return -1;
+  }
+};
+
 template <typename T, typename Index, scatter_op::UpdateOp op>
-struct ScatterFunctor<CPUDevice, T, Index, op>
-        : ScatterFunctorBase<CPUDevice, T, Index, op>{};
+struct ScatterFunctor<CPUDevice, T, Index, op> {
+  // Scatters that update fewer elements run serially.
+  static const int64 kMinParallelElements = 256 << 10;
+
+  Index operator()(OpKernelContext* c, const CPUDevice& d,
+                   typename TTypes<T>::Matrix params,
+                   typename TTypes<T>::ConstMatrix updates,
+                   typename TTypes<Index>::ConstFlat indices) {
+    const int64 num_elements =
+        static_cast<int64>(indices.size()) * params.dimension(1);
+    if (num_elements >= kMinParallelElements && params.dimension(0) > 1) {
+      return ParallelScatterFunctorCPU<CPUDevice, T, Index, op>()(
+          c, d, params, updates, indices);
+    }
+    return ScatterFunctorBase<CPUDevice, T, Index, op>()(c, d, params, updates,
+                                                         indices);
+  }
+};
 
 #ifdef TENSORFLOW_USE_SYCL
 template <typename T, typename Index, scatter_op::UpdateOp op>
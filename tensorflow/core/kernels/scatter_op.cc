@@ -14,13 +14,16 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/state_ops.cc.
+#define EIGEN_USE_THREADS
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
+#include "tensorflow/core/kernels/sparse_update_aggregator.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 #ifdef TENSORFLOW_USE_SYCL
@@ -52,22 +55,134 @@ static bool ValidShapes(const Tensor& params, const Tensor& updates,
   return true;
 }
 
+static Status ValidateInputs(const Tensor& params, const Tensor& indices,
+                             const Tensor& updates) {
+  if (!params.IsInitialized()) {
+    return errors::FailedPrecondition("Null ref for params");
+  }
+  if (!TensorShapeUtils::IsVectorOrHigher(params.shape())) {
+    return errors::InvalidArgument("params must be at least 1-D, got shape ",
+                                   params.shape().DebugString());
+  }
+  if (!ValidShapes(params, updates, indices)) {
+    return errors::InvalidArgument(
+        "Must have updates.shape = indices.shape + params.shape[1:], got ",
+        "updates.shape ", updates.shape().DebugString(), ", indices.shape ",
+        indices.shape().DebugString(), ", params.shape ",
+        params.shape().DebugString());
+  }
+  return Status::OK();
+}
+
 static void DoValidationChecking(OpKernelContext* c, const Tensor& params,
                                  const Tensor& indices, const Tensor& updates) {
-  OP_REQUIRES(c, params.IsInitialized(),
-              errors::FailedPrecondition("Null ref for params"));
-  OP_REQUIRES(c, TensorShapeUtils::IsVectorOrHigher(params.shape()),
-              errors::InvalidArgument("params must be at least 1-D, got shape ",
-                                      params.shape().DebugString()));
-  OP_REQUIRES(
-      c, ValidShapes(params, updates, indices),
-      errors::InvalidArgument(
-          "Must have updates.shape = indices.shape + params.shape[1:], got ",
-          "updates.shape ", updates.shape().DebugString(), ", indices.shape ",
-          indices.shape().DebugString(), ", params.shape ",
-          params.shape().DebugString()));
+  OP_REQUIRES_OK(c, ValidateInputs(params, indices, updates));
+}
+
+// If true, the ScatterAdd and ScatterSub ops with use_locking that update
+// the same variable on CPU concurrently are merged by a
+// SparseUpdateAggregator and applied together, e.g. on a parameter server
+// that receives the sparse updates of many workers.
+static bool AggregateSparseUpdates() {
+  static const bool aggregate = [] {
+    bool value;
+    Status s =
+        ReadBoolFromEnvVar("TF_SPARSE_UPDATE_AGGREGATION", false, &value);
+    if (!s.ok()) LOG(ERROR) << s;
+    return s.ok() && value;
+  }();
+  return aggregate;
+}
+
+// Applies the update of "c", a ScatterAdd (or ScatterSub if "negate") with
+// use_locking on CPU, together with the concurrent updates of the same
+// variable.
+template <typename T, typename Index>
+static void AggregatedScatterCompute(OpKernelContext* c, bool negate) {
+  typedef SparseUpdateAggregator<T, Index> Aggregator;
+  const Tensor& indices = c->input(1);
+  const Tensor& updates = c->input(2);
+  const int64 N_big = indices.NumElements();
+  OP_REQUIRES(c, N_big <= std::numeric_limits<Index>::max(),
+              errors::InvalidArgument(
+                  "indices has too many elements for ",
+                  DataTypeString(DataTypeToEnum<Index>::v()), " indexing: ",
+                  N_big, " > ", std::numeric_limits<Index>::max()));
+
+  typename Aggregator::Update update;
+  update.context = c;
+  update.indices = &indices;
+  update.updates = &updates;
+  update.negate = negate;
+  mutex* mu = c->input_ref_mutex(0);
+  Aggregator::ForVariable(mu)->Submit(
+      &update, [c, mu](const std::vector<typename Aggregator::Update*>& batch) {
+        mutex_lock l(*mu);
+        Tensor params = c->mutable_input(0, true);
+        for (auto* u : batch) {
+          u->status = ValidateInputs(params, *u->indices, *u->updates);
+        }
+        int64 num_rows = 0;
+        TensorShape row_shape;
+        if (params.IsInitialized() && params.dims() > 0) {
+          num_rows = params.dim_size(0);
+          row_shape = params.shape();
+          row_shape.RemoveDim(0);
+        }
+        if (num_rows > std::numeric_limits<Index>::max()) {
+          for (auto* u : batch) {
+            u->status.Update(errors::InvalidArgument(
+                "params.shape[0] too large for ",
+                DataTypeString(DataTypeToEnum<Index>::v()), " indexing: ",
+                num_rows, " > ", std::numeric_limits<Index>::max()));
+          }
+        }
+        Tensor merged_indices;
+        Tensor merged_updates;
+        Aggregator::Merge(batch, num_rows, row_shape, &merged_indices,
+                          &merged_updates);
+        if (merged_indices.NumElements() > 0) {
+          const Tensor& indices = merged_indices;
+          const Tensor& updates = merged_updates;
+          auto params_flat = params.flat_outer_dims<T>();
+          functor::ScatterFunctor<CPUDevice, T, Index,
+                                  scatter_op::UpdateOp::ADD>
+              functor;
+          functor(c, c->eigen_device<CPUDevice>(), params_flat,
+                  updates.flat_outer_dims<T>(), indices.flat<Index>());
+        }
+        for (auto* u : batch) {
+          // We always return the input ref.
+          if (u->status.ok()) u->context->forward_ref_input_to_ref_output(0, 0);
+        }
+      });
+  OP_REQUIRES_OK(c, update.status);
 }
 
+// Whether ScatterUpdateOp<Device, T, Index, op> can merge concurrent updates.
+template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
+struct AggregatedScatter {
+  static bool Compute(OpKernelContext* c) { return false; }
+};
+
+template <typename T, typename Index>
+struct AggregatedScatter<CPUDevice, T, Index, scatter_op::UpdateOp::ADD> {
+  static bool Compute(OpKernelContext* c) {
+    if (!AggregateSparseUpdates()) return false;
+    AggregatedScatterCompute<T, Index>(c, false /* negate */);
+    return true;
+  }
+};
+
+template <typename T, typename Index>
+struct AggregatedScatter<CPUDevice, T, Index, scatter_op::UpdateOp::SUB> {
+  static bool Compute(OpKernelContext* c) {
+    if (!AggregateSparseUpdates()) return false;
+    AggregatedScatterCompute<T, Index>(c, true /* negate */);
+    return true;
+  }
+};
+
 template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 class ScatterUpdateOp : public OpKernel {
  public:
@@ -82,6 +197,7 @@ class ScatterUpdateOp : public OpKernel {
 
   void Compute(OpKernelContext* c) override {
     if (use_exclusive_lock_) {
+      if (AggregatedScatter<Device, T, Index, op>::Compute(c)) return;
       // Hold mutex while we apply updates
       mutex_lock l(*c->input_ref_mutex(0));
       DoCompute(c);
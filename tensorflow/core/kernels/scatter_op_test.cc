@@ -37,8 +37,9 @@ namespace {
 
 class ScatterUpdateOpTest : public OpsTestBase {
  protected:
-  void MakeOp(DataType variable_ref_type, DataType index_type) {
-    TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterUpdate")
+  void MakeOp(DataType variable_ref_type, DataType index_type,
+              const string& op = "ScatterUpdate") {
+    TF_ASSERT_OK(NodeDefBuilder("myop", op)
                      .Input(FakeInput(variable_ref_type))
                      .Input(FakeInput(index_type))
                      .Input(FakeInput(RemoveRefType(variable_ref_type)))
@@ -159,6 +160,70 @@ TEST_F(ScatterUpdateOpTest, HigherRank) {
   test::ExpectTensorEqual<float>(expected, params_tensor);
 }
 
+// Scatters with enough elements run in parallel over shards of rows. The
+// indices below hit every row many times, in an order that is not sorted.
+static std::vector<int32> ManyDuplicateIndices(int num_rows, int num_indices) {
+  std::vector<int32> indices(num_indices);
+  for (int i = 0; i < num_indices; i++) {
+    indices[i] = (i * 7919) % num_rows;
+  }
+  return indices;
+}
+
+TEST_F(ScatterUpdateOpTest, Large_DuplicateIndicesTakeLastUpdate) {
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+
+  const int kRows = 1000;
+  const int kCols = 4;
+  const int kIndices = 100000;
+  const std::vector<int32> indices = ManyDuplicateIndices(kRows, kIndices);
+  std::vector<float> updates(kIndices * kCols);
+  std::vector<float> expected(kRows * kCols, -1);
+  for (int i = 0; i < kIndices; i++) {
+    for (int j = 0; j < kCols; j++) {
+      updates[i * kCols + j] = i * kCols + j;
+      expected[indices[i] * kCols + j] = i * kCols + j;
+    }
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}),
+                           std::vector<float>(kRows * kCols, -1));
+  AddInputFromArray<int32>(TensorShape({kIndices}), indices);
+  AddInputFromArray<float>(TensorShape({kIndices, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor params_tensor = *mutable_input(0).tensor;
+  Tensor expected_tensor(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  test::FillValues<float>(&expected_tensor, expected);
+  test::ExpectTensorEqual<float>(expected_tensor, params_tensor);
+}
+
+TEST_F(ScatterUpdateOpTest, Large_ScatterAddAccumulatesDuplicates) {
+  MakeOp(DT_INT64_REF, DT_INT32, "ScatterAdd");
+
+  const int kRows = 1000;
+  const int kCols = 4;
+  const int kIndices = 100000;
+  const std::vector<int32> indices = ManyDuplicateIndices(kRows, kIndices);
+  std::vector<int64> updates(kIndices * kCols);
+  std::vector<int64> expected(kRows * kCols, 1);
+  for (int i = 0; i < kIndices; i++) {
+    for (int j = 0; j < kCols; j++) {
+      updates[i * kCols + j] = i + j;
+      expected[indices[i] * kCols + j] += i + j;
+    }
+  }
+  AddInputFromArray<int64>(TensorShape({kRows, kCols}),
+                           std::vector<int64>(kRows * kCols, 1));
+  AddInputFromArray<int32>(TensorShape({kIndices}), indices);
+  AddInputFromArray<int64>(TensorShape({kIndices, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor params_tensor = *mutable_input(0).tensor;
+  Tensor expected_tensor(allocator(), DT_INT64, TensorShape({kRows, kCols}));
+  test::FillValues<int64>(&expected_tensor, expected);
+  test::ExpectTensorEqual<int64>(expected_tensor, params_tensor);
+}
+
 TEST_F(ScatterUpdateOpTest, Error_IndexOutOfRange) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
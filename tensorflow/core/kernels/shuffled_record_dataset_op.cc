@@ -0,0 +1,402 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <deque>
+#include <numeric>
+
+#include "tensorflow/core/kernels/dataset.h"
+
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+
+namespace tensorflow {
+
+namespace {
+
+// See documentation in ../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+class ShuffledFixedLengthRecordDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ShuffledFixedLengthRecordDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("reshuffle_each_iteration",
+                                     &reshuffle_each_iteration_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<string>()(i));
+    }
+
+    int64 header_bytes = -1;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "header_bytes", &header_bytes));
+    OP_REQUIRES(ctx, header_bytes >= 0,
+                errors::InvalidArgument("`header_bytes` must be >= 0"));
+
+    int64 record_bytes = -1;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "record_bytes", &record_bytes));
+    OP_REQUIRES(ctx, record_bytes > 0,
+                errors::InvalidArgument("`record_bytes` must be > 0"));
+
+    int64 footer_bytes = -1;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64>(ctx, "footer_bytes", &footer_bytes));
+    OP_REQUIRES(ctx, footer_bytes >= 0,
+                errors::InvalidArgument("`footer_bytes` must be >= 0"));
+
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed", &seed));
+
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed2", &seed2));
+
+    // By TensorFlow convention, passing 0 for both seeds indicates
+    // that the shuffling should be seeded non-deterministically.
+    if (seed == 0 && seed2 == 0) {
+      seed = random::New64();
+      seed2 = random::New64();
+    }
+
+    int64 num_parallel_reads = -1;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "num_parallel_reads",
+                                                   &num_parallel_reads));
+    OP_REQUIRES(ctx, num_parallel_reads > 0,
+                errors::InvalidArgument("`num_parallel_reads` must be > 0"));
+
+    *output = new Dataset(ctx, std::move(filenames), header_bytes, record_bytes,
+                          footer_bytes, seed, seed2, num_parallel_reads,
+                          reshuffle_each_iteration_);
+  }
+
+ private:
+  // Shuffles the indices of all the records of the files, rather than a
+  // window of the records themselves, and reads the records at the shuffled
+  // indices. An iterator holds 8 bytes per record for the permutation, plus
+  // the `num_parallel_reads` records that it reads ahead.
+  class Dataset : public GraphDatasetBase {
+   public:
+    explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+                     int64 header_bytes, int64 record_bytes, int64 footer_bytes,
+                     int64 seed, int64 seed2, int64 num_parallel_reads,
+                     bool reshuffle_each_iteration)
+        : GraphDatasetBase(ctx),
+          filenames_(std::move(filenames)),
+          header_bytes_(header_bytes),
+          record_bytes_(record_bytes),
+          footer_bytes_(footer_bytes),
+          seed_(seed),
+          seed2_(seed2),
+          num_parallel_reads_(num_parallel_reads),
+          reshuffle_each_iteration_(reshuffle_each_iteration),
+          parent_generator_(seed, seed2),
+          generator_(&parent_generator_) {}
+
+    std::unique_ptr<IteratorBase> MakeIterator(
+        const string& prefix) const override {
+      int64 iterator_seed = seed_;
+      int64 iterator_seed2 = seed2_;
+      if (reshuffle_each_iteration_) {
+        mutex_lock l(mu_);
+        iterator_seed = generator_();
+        iterator_seed2 = generator_();
+      }
+      return std::unique_ptr<IteratorBase>(new Iterator(
+          {this, strings::StrCat(prefix, "::ShuffledFixedLengthRecord")},
+          iterator_seed, iterator_seed2));
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+      return *dtypes;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      static std::vector<PartialTensorShape>* shapes =
+          new std::vector<PartialTensorShape>({{}});
+      return *shapes;
+    }
+
+    string DebugString() override {
+      return "ShuffledFixedLengthRecordDatasetOp::Dataset";
+    }
+
+   protected:
+    Status AsGraphDefInternal(DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      Node* header_bytes = nullptr;
+      Node* record_bytes = nullptr;
+      Node* footer_bytes = nullptr;
+      Node* seed = nullptr;
+      Node* seed2 = nullptr;
+      Node* num_parallel_reads = nullptr;
+      AttrValue reshuffle_each_iteration;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      TF_RETURN_IF_ERROR(b->AddScalar(header_bytes_, &header_bytes));
+      TF_RETURN_IF_ERROR(b->AddScalar(record_bytes_, &record_bytes));
+      TF_RETURN_IF_ERROR(b->AddScalar(footer_bytes_, &footer_bytes));
+      TF_RETURN_IF_ERROR(b->AddScalar(seed_, &seed));
+      TF_RETURN_IF_ERROR(b->AddScalar(seed2_, &seed2));
+      TF_RETURN_IF_ERROR(b->AddScalar(num_parallel_reads_,
+                                      &num_parallel_reads));
+      b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {filenames, header_bytes, record_bytes, footer_bytes, seed, seed2,
+           num_parallel_reads},
+          {std::make_pair("reshuffle_each_iteration",
+                          reshuffle_each_iteration)},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params, int64 seed, int64 seed2)
+          : DatasetIterator<Dataset>(params),
+            seed_(seed),
+            seed2_(seed2),
+            files_(params.dataset->filenames_.size()) {}
+
+      ~Iterator() override {
+        // The reads in flight refer to `this`.
+        mutex_lock l(mu_);
+        while (num_reads_in_flight_ > 0) {
+          cond_var_.wait(l);
+        }
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(EnsureIndexLocked(ctx->env()));
+        StartReadsLocked(ctx);
+        if (reads_.empty()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        std::shared_ptr<ReadResult> result = reads_.front();
+        while (!result->done) {
+          cond_var_.wait(l);
+        }
+        reads_.pop_front();
+        ++num_consumed_;
+        StartReadsLocked(ctx);
+        TF_RETURN_IF_ERROR(result->status);
+        Tensor record_tensor(cpu_allocator(), DT_STRING, {});
+        record_tensor.scalar<string>()().swap(result->record);
+        out_tensors->emplace_back(std::move(record_tensor));
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      Status SaveInternal(IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("seed"), seed_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("seed2"), seed2_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("num_consumed"), num_consumed_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(OpKernelContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        while (num_reads_in_flight_ > 0) {
+          cond_var_.wait(l);
+        }
+        reads_.clear();
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("seed"), &seed_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("seed2"), &seed2_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("num_consumed"), &num_consumed_));
+        // The permutation is a function of the seeds, so it is rebuilt
+        // rather than saved.
+        permutation_.clear();
+        index_built_ = false;
+        TF_RETURN_IF_ERROR(EnsureIndexLocked(ctx->env()));
+        if (num_consumed_ < 0 || num_consumed_ > permutation_.size()) {
+          return errors::InvalidArgument(
+              "Cannot restore an iterator that consumed ", num_consumed_,
+              " records of a dataset of ", permutation_.size(), " records.");
+        }
+        next_read_ = num_consumed_;
+        return Status::OK();
+      }
+
+     private:
+      struct ReadResult {
+        bool done = false;
+        Status status;
+        string record;
+      };
+
+      // Counts the records of each file, and shuffles the indices of all the
+      // records.
+      Status EnsureIndexLocked(Env* env) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (index_built_) {
+          return Status::OK();
+        }
+        const std::vector<string>& filenames = dataset()->filenames_;
+        file_start_.assign(1, 0);
+        file_start_.reserve(filenames.size() + 1);
+        for (const string& filename : filenames) {
+          uint64 file_size;
+          TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+          const int64 data_bytes = static_cast<int64>(file_size) -
+                                   dataset()->header_bytes_ -
+                                   dataset()->footer_bytes_;
+          if (data_bytes < 0 || data_bytes % dataset()->record_bytes_ != 0) {
+            return errors::DataLoss(
+                "Excluding its header and footer, the size of ", filename,
+                " (", file_size, " bytes) is not a multiple of `record_bytes` ",
+                "(", dataset()->record_bytes_, ").");
+          }
+          file_start_.push_back(file_start_.back() +
+                                data_bytes / dataset()->record_bytes_);
+        }
+
+        // Fisher-Yates shuffle.
+        random::PhiloxRandom parent_generator(seed_, seed2_);
+        random::SingleSampleAdapter<random::PhiloxRandom> generator(
+            &parent_generator);
+        permutation_.resize(file_start_.back());
+        std::iota(permutation_.begin(), permutation_.end(), 0);
+        for (int64 i = permutation_.size() - 1; i > 0; --i) {
+          const uint64 sample =
+              (static_cast<uint64>(generator()) << 32) | generator();
+          std::swap(permutation_[i], permutation_[sample % (i + 1)]);
+        }
+        index_built_ = true;
+        return Status::OK();
+      }
+
+      // Starts reading the records that follow the last read one, until
+      // `num_parallel_reads` reads are in flight or buffered.
+      void StartReadsLocked(IteratorContext* ctx)
+          EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (reads_.size() < dataset()->num_parallel_reads_ &&
+               next_read_ < permutation_.size()) {
+          const int64 record_index = permutation_[next_read_++];
+          const int file_index =
+              std::upper_bound(file_start_.begin(), file_start_.end(),
+                               record_index) -
+              file_start_.begin() - 1;
+          std::shared_ptr<ReadResult> result(new ReadResult);
+          reads_.push_back(result);
+
+          if (!files_[file_index]) {
+            Status s = ctx->env()->NewRandomAccessFile(
+                dataset()->filenames_[file_index], &files_[file_index]);
+            if (!s.ok()) {
+              result->status = s;
+              result->done = true;
+              continue;
+            }
+          }
+          const RandomAccessFile* file = files_[file_index].get();
+          const uint64 offset =
+              dataset()->header_bytes_ +
+              (record_index - file_start_[file_index]) *
+                  dataset()->record_bytes_;
+          const int64 record_bytes = dataset()->record_bytes_;
+          const string& filename = dataset()->filenames_[file_index];
+          ++num_reads_in_flight_;
+          (*ctx->runner())([this, file, offset, record_bytes, &filename,
+                            result]() {
+            result->record.resize(record_bytes);
+            StringPiece data;
+            Status s =
+                file->Read(offset, record_bytes, &data, &result->record[0]);
+            if (s.ok() || errors::IsOutOfRange(s)) {
+              if (data.size() != record_bytes) {
+                s = errors::DataLoss("Read ", data.size(), " of ",
+                                     record_bytes, " bytes at offset ", offset,
+                                     " of ", filename, ".");
+              } else {
+                s = Status::OK();
+                if (data.data() != result->record.data()) {
+                  result->record.assign(data.data(), data.size());
+                }
+              }
+            }
+            mutex_lock l(mu_);
+            result->status = s;
+            result->done = true;
+            --num_reads_in_flight_;
+            cond_var_.notify_all();
+          });
+        }
+      }
+
+      mutex mu_;
+      condition_variable cond_var_;
+      int64 seed_ GUARDED_BY(mu_);
+      int64 seed2_ GUARDED_BY(mu_);
+      bool index_built_ GUARDED_BY(mu_) = false;
+      // `file_start_[i]` is the index of the first record of file `i`, and
+      // its last entry is the number of records of all the files.
+      std::vector<int64> file_start_ GUARDED_BY(mu_);
+      std::vector<int64> permutation_ GUARDED_BY(mu_);
+      std::vector<std::unique_ptr<RandomAccessFile>> files_ GUARDED_BY(mu_);
+      // The reads in the order of `permutation_`, from the next record to
+      // return.
+      std::deque<std::shared_ptr<ReadResult>> reads_ GUARDED_BY(mu_);
+      int64 next_read_ GUARDED_BY(mu_) = 0;
+      int64 num_consumed_ GUARDED_BY(mu_) = 0;
+      int64 num_reads_in_flight_ GUARDED_BY(mu_) = 0;
+    };
+
+    const std::vector<string> filenames_;
+    const int64 header_bytes_;
+    const int64 record_bytes_;
+    const int64 footer_bytes_;
+    const int64 seed_;
+    const int64 seed2_;
+    const int64 num_parallel_reads_;
+    const bool reshuffle_each_iteration_;
+    mutable mutex mu_;
+    mutable random::PhiloxRandom parent_generator_ GUARDED_BY(mu_);
+    mutable random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        GUARDED_BY(mu_);
+  };
+
+  bool reshuffle_each_iteration_;
+};
+
+REGISTER_KERNEL_BUILDER(
+    Name("ShuffledFixedLengthRecordDataset").Device(DEVICE_CPU),
+    ShuffledFixedLengthRecordDatasetOp);
+
+}  // namespace
+
+}  // namespace tensorflow
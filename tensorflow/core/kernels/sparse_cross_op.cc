@@ -17,6 +17,7 @@ limitations under the License.
 #include <assert.h>
 #include <limits>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -172,8 +173,11 @@ class StringCrosser {
                 const int64 num_buckets_unused, const uint64 hash_key_unused)
       : columns_(columns) {}
 
-  string Generate(const int64 batch_index,
-                  const std::vector<int>& permutation) const {
+  // StringCrosser does not reuse anything between crosses.
+  struct Cache {};
+
+  string Generate(const int64 batch_index, const std::vector<int>& permutation,
+                  Cache* cache_unused) const {
     static const auto k_feature_separator = "_X_";
 
     gtl::InlinedVector<InternalType, 6> cross_vec(columns_.size());
@@ -197,14 +201,39 @@ class HashCrosser {
       const int64 num_buckets, const uint64 hash_key)
       : columns_(columns), num_buckets_(num_buckets), hash_key_(hash_key) {}
 
-  int64 Generate(const int64 batch_index,
-                 const std::vector<int>& permutation) const {
+  // The partial hashes of the previous cross. Consecutive crosses of a batch
+  // usually differ only in the last few columns, so the hash of the columns
+  // before the first difference can be reused.
+  struct Cache {
+    int64 batch_index = -1;
+    std::vector<int> permutation;
+    // prefix_hashes[i] is the hash of the first i features of permutation.
+    std::vector<uint64> prefix_hashes;
+  };
+
+  int64 Generate(const int64 batch_index, const std::vector<int>& permutation,
+                 Cache* cache) const {
     // Do the fingerprint concatenation on uint64.
-    uint64 hashed_output = hash_key_;
-    for (size_t i = 0; i < permutation.size(); ++i) {
+    size_t first_changed = 0;
+    if (cache->batch_index != batch_index ||
+        cache->permutation.size() != permutation.size()) {
+      cache->batch_index = batch_index;
+      cache->permutation.assign(permutation.size(), -1);
+      cache->prefix_hashes.resize(permutation.size() + 1);
+      cache->prefix_hashes[0] = hash_key_;
+    } else {
+      while (first_changed < permutation.size() &&
+             permutation[first_changed] == cache->permutation[first_changed]) {
+        ++first_changed;
+      }
+    }
+    for (size_t i = first_changed; i < permutation.size(); ++i) {
       uint64 hash_i = columns_[i]->Feature(batch_index, permutation[i]);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
+      cache->prefix_hashes[i + 1] =
+          FingerprintCat64(cache->prefix_hashes[i], hash_i);
+      cache->permutation[i] = permutation[i];
     }
+    const uint64 hashed_output = cache->prefix_hashes[permutation.size()];
     // The return value is int64 based on the number of buckets.
     if (num_buckets_ > 0) {
       return hashed_output % num_buckets_;
@@ -311,30 +340,55 @@ class SparseCrossOp : public OpKernel {
 
     ValidateInput(context, indices_list_in, values_list_in, shapes_list_in,
                   dense_list_in);
+    if (!context->status().ok()) return;
+
+    // For hashed crosses, fingerprint every string feature once up front
+    // instead of once for every cross that it is part of.
+    std::vector<const Tensor*> values(values_list_in.size());
+    std::vector<const Tensor*> dense(dense_list_in.size());
+    std::vector<Tensor> fingerprints(values.size() + dense.size());
+    for (int i = 0; i < values.size(); ++i) {
+      values[i] = &values_list_in[i];
+    }
+    for (int i = 0; i < dense.size(); ++i) {
+      dense[i] = &dense_list_in[i];
+    }
+    if (std::is_same<InternalType, int64>::value) {
+      for (int i = 0; i < values.size() + dense.size(); ++i) {
+        const Tensor** input =
+            i < values.size() ? &values[i] : &dense[i - values.size()];
+        if ((*input)->dtype() != DT_STRING) continue;
+        OP_REQUIRES_OK(context,
+                       FingerprintStrings(context, **input, &fingerprints[i]));
+        *input = &fingerprints[i];
+      }
+    }
 
+    const int64 batch_size = CalculateBatchSize(shapes_list_in, dense_list_in);
     std::vector<std::unique_ptr<ColumnInterface<InternalType>>> columns =
-        GenerateColumnsFromInput(indices_list_in, values_list_in,
-                                 shapes_list_in, dense_list_in);
+        GenerateColumnsFromInput(indices_list_in, values, dense, batch_size);
 
     typename CrossTraits<HASHED_OUTPUT, InternalType>::Crosser
         crosser(columns, num_buckets_, hash_key_);
     Tensor* indices_out;
     Tensor* values_out;
     Tensor* shape_out;
-    const int64 batch_size = CalculateBatchSize(shapes_list_in, dense_list_in);
     std::vector<int64> output_start_indices(batch_size);
     CreateOutputTensors(columns, batch_size, context, &indices_out, &values_out,
                         &shape_out, &output_start_indices);
+    if (!context->status().ok()) return;
 
     typename CrossTraits<HASHED_OUTPUT, InternalType>::Updater
         updater(output_start_indices, indices_out, values_out);
     auto do_work = [this, &columns, crosser, updater](int64 begin, int64 end) {
+      typename CrossTraits<HASHED_OUTPUT, InternalType>::Crosser::Cache cache;
       for (int b = begin; b < end; b++) {
         ProductIterator<InternalType> product_iterator(columns, b);
         int64 cross_count = 0;
         while (product_iterator.HasNext()) {
           const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count, crosser.Generate(b, permutation));
+          updater.Update(b, cross_count,
+                         crosser.Generate(b, permutation, &cache));
           cross_count++;
         }
       }
@@ -348,6 +402,27 @@ class SparseCrossOp : public OpKernel {
   }
 
  private:
+  // Sets *fingerprints to an int64 tensor holding the Fingerprint64 of every
+  // element of the string tensor "strings".
+  Status FingerprintStrings(OpKernelContext* context, const Tensor& strings,
+                            Tensor* fingerprints) {
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(DT_INT64, strings.shape(), fingerprints));
+    const auto strings_flat = strings.flat<string>();
+    auto fingerprints_flat = fingerprints->flat<int64>();
+    auto fingerprint = [&strings_flat, &fingerprints_flat](int64 begin,
+                                                           int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        fingerprints_flat(i) = Fingerprint64(strings_flat(i));
+      }
+    };
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int kCostPerUnit = 100;
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          strings_flat.size(), kCostPerUnit, fingerprint);
+    return Status::OK();
+  }
+
   // Validates input tensors.
   void ValidateInput(OpKernelContext* context,
                      const OpInputList& indices_list_in,
@@ -444,12 +519,11 @@ class SparseCrossOp : public OpKernel {
   // Generate the columns given the sparse and dense inputs.
   std::vector<std::unique_ptr<ColumnInterface<InternalType>>>
   GenerateColumnsFromInput(const OpInputList& indices_list_in,
-                           const OpInputList& values_list_in,
-                           const OpInputList& shapes_list_in,
-                           const OpInputList& dense_list_in) {
+                           const std::vector<const Tensor*>& values_list_in,
+                           const std::vector<const Tensor*>& dense_list_in,
+                           const int64 batch_size) {
     std::vector<std::unique_ptr<ColumnInterface<InternalType>>> columns;
-    const int64 batch_size = CalculateBatchSize(shapes_list_in, dense_list_in);
-    const int64 number_of_columns = shapes_list_in.size();
+    const int64 number_of_columns = values_list_in.size();
 
     std::vector<std::vector<int64>> feature_counts(number_of_columns,
                                                    std::vector<int64>());
@@ -462,12 +536,12 @@ class SparseCrossOp : public OpKernel {
     columns.reserve(values_list_in.size());
     for (int i = 0; i < values_list_in.size(); ++i) {
       columns.emplace_back(new SparseTensorColumn<InternalType>(
-          values_list_in[i], std::move(feature_counts[i]),
+          *values_list_in[i], std::move(feature_counts[i]),
           std::move(feature_start_indices[i])));
     }
     for (int i = 0; i < dense_list_in.size(); ++i) {
       columns.emplace_back(
-          new DenseTensorColumn<InternalType>(dense_list_in[i]));
+          new DenseTensorColumn<InternalType>(*dense_list_in[i]));
     }
 
     return columns;
@@ -0,0 +1,198 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_SPARSE_UPDATE_AGGREGATOR_H_
+#define TENSORFLOW_KERNELS_SPARSE_UPDATE_AGGREGATOR_H_
+
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/scatter_functor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/util.h"
+
+namespace tensorflow {
+
+/**
+ * Merges the sparse additive updates that concurrent ops make to the same
+ * variable, so that they are applied in one pass under the variable's mutex
+ * instead of each op taking the mutex in turn.
+ *
+ * An op Submit()s its update and blocks. One of the submitting threads, the
+ * combiner, takes every update submitted so far and passes them to its
+ * "combine" function, which typically locks the variable, Merge()s the
+ * updates and scatters the result. Updates submitted meanwhile wait for the
+ * next batch, which one of their threads combines once the current combiner
+ * is done. Like the accumulation of SparseConditionalAccumulator, merging
+ * sorts the rows of all updates by index and sums the rows of equal indices,
+ * so each index of the variable is written once per batch.
+ *
+ * Only additive updates can be merged: the result of several ScatterAdd or
+ * ScatterSub ops does not depend on the order in which they run.
+ */
+template <typename T, typename Index>
+class SparseUpdateAggregator {
+ public:
+  struct Update {
+    // The op that submitted the update, blocked until it is applied.
+    OpKernelContext* context = nullptr;
+    const Tensor* indices = nullptr;
+    // indices.shape + variable.shape[1:].
+    const Tensor* updates = nullptr;
+    // Whether "updates" is subtracted rather than added.
+    bool negate = false;
+    // Set by the combiner.
+    Status status;
+
+   private:
+    friend class SparseUpdateAggregator;
+    bool done = false;
+  };
+
+  typedef std::function<void(const std::vector<Update*>&)> CombineFn;
+
+  // Returns the aggregator of the variable whose mutex is "mu". The
+  // aggregators are never deleted; an idle aggregator holds no state, so
+  // the aggregator of a deleted variable can be reused by any variable that
+  // gets the same mutex address.
+  static SparseUpdateAggregator* ForVariable(const mutex* mu) {
+    static mutex* registry_mu = new mutex;
+    static auto* registry =
+        new std::unordered_map<const mutex*, SparseUpdateAggregator*>;
+    mutex_lock l(*registry_mu);
+    SparseUpdateAggregator*& aggregator = (*registry)[mu];
+    if (aggregator == nullptr) aggregator = new SparseUpdateAggregator;
+    return aggregator;
+  }
+
+  // Blocks until "update" has been passed to a call of "combine", made by
+  // this thread or by the thread of another Submit() to this aggregator.
+  void Submit(Update* update, const CombineFn& combine) {
+    std::vector<Update*> batch;
+    {
+      mutex_lock l(mu_);
+      update->done = false;
+      pending_.push_back(update);
+      while (!update->done && combining_) {
+        cv_.wait(l);
+      }
+      if (update->done) return;
+      // "update" is still pending, so it is part of the batch.
+      combining_ = true;
+      batch.swap(pending_);
+    }
+    combine(batch);
+    mutex_lock l(mu_);
+    for (Update* u : batch) {
+      u->done = true;
+    }
+    combining_ = false;
+    cv_.notify_all();
+  }
+
+  // Merges the updates of "batch" whose status is OK into "*indices", the
+  // sorted distinct indices they update, and "*values", the sum of their
+  // rows for each of these indices. The updates with an index that is not
+  // in [0, num_rows) get an error status and are left out. Each update must
+  // have rows of "row_shape".
+  static void Merge(const std::vector<Update*>& batch, int64 num_rows,
+                    const TensorShape& row_shape, Tensor* indices,
+                    Tensor* values) {
+    // (index, update, row of the update) of every row to merge.
+    std::vector<std::tuple<Index, int, int64>> entries;
+    for (int u = 0; u < batch.size(); ++u) {
+      Update* update = batch[u];
+      if (!update->status.ok()) continue;
+      auto update_indices = update->indices->template flat<Index>();
+      const int64 n = update_indices.size();
+      int64 bad_i = -1;
+      for (int64 i = 0; i < n; ++i) {
+        const Index index = update_indices(i);
+        if (index < 0 || index >= num_rows) {
+          bad_i = i;
+          break;
+        }
+      }
+      if (bad_i >= 0) {
+        update->status = errors::InvalidArgument(
+            "indices", SliceDebugString(update->indices->shape(), bad_i),
+            " = ", update_indices(bad_i), " is not in [0, ", num_rows, ")");
+        continue;
+      }
+      for (int64 i = 0; i < n; ++i) {
+        entries.emplace_back(update_indices(i), u, i);
+      }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    int64 num_unique = 0;
+    for (int64 e = 0; e < entries.size(); ++e) {
+      if (e == 0 || std::get<0>(entries[e]) != std::get<0>(entries[e - 1])) {
+        ++num_unique;
+      }
+    }
+    TensorShape values_shape({num_unique});
+    values_shape.AppendShape(row_shape);
+    *indices = Tensor(DataTypeToEnum<Index>::v(), TensorShape({num_unique}));
+    *values = Tensor(DataTypeToEnum<T>::v(), values_shape);
+    if (num_unique == 0) return;
+
+    auto indices_flat = indices->template flat<Index>();
+    auto values_flat = values->template flat_outer_dims<T>();
+    values_flat.setZero();
+    int64 out = -1;
+    for (int64 e = 0; e < entries.size(); ++e) {
+      const Index index = std::get<0>(entries[e]);
+      if (out < 0 || index != indices_flat(out)) {
+        indices_flat(++out) = index;
+      }
+      const Update* update = batch[std::get<1>(entries[e])];
+      const int64 n = update->indices->NumElements();
+      auto rows = update->updates->template shaped<T, 2>(
+          {n, update->updates->NumElements() / n});
+      auto row = rows.template chip<0>(std::get<2>(entries[e]));
+      if (update->negate) {
+        scatter_op::internal::Assign<scatter_op::UpdateOp::SUB>::Run(
+            values_flat.template chip<0>(out), row);
+      } else {
+        scatter_op::internal::Assign<scatter_op::UpdateOp::ADD>::Run(
+            values_flat.template chip<0>(out), row);
+      }
+    }
+  }
+
+ private:
+  SparseUpdateAggregator() {}
+
+  mutex mu_;
+  condition_variable cv_;
+  std::vector<Update*> pending_ GUARDED_BY(mu_);
+  bool combining_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SparseUpdateAggregator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_SPARSE_UPDATE_AGGREGATOR_H_
@@ -0,0 +1,108 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/sparse_update_aggregator.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+typedef SparseUpdateAggregator<float, int32> Aggregator;
+
+TEST(SparseUpdateAggregatorTest, MergeSumsEqualIndices) {
+  Tensor indices0 = test::AsTensor<int32>({3, 1, 3});
+  Tensor updates0 = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2});
+  Tensor indices1 = test::AsTensor<int32>({1});
+  Tensor updates1 = test::AsTensor<float>({10, 20}, {1, 2});
+  Aggregator::Update update0;
+  update0.indices = &indices0;
+  update0.updates = &updates0;
+  Aggregator::Update update1;
+  update1.indices = &indices1;
+  update1.updates = &updates1;
+  update1.negate = true;
+
+  Tensor indices;
+  Tensor values;
+  Aggregator::Merge({&update0, &update1}, 4, TensorShape({2}), &indices,
+                    &values);
+  TF_EXPECT_OK(update0.status);
+  TF_EXPECT_OK(update1.status);
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({1, 3}), indices);
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({3 - 10, 4 - 20, 1 + 5, 2 + 6}, {2, 2}), values);
+}
+
+TEST(SparseUpdateAggregatorTest, MergeLeavesOutBadIndices) {
+  Tensor indices0 = test::AsTensor<int32>({0, 4});
+  Tensor updates0 = test::AsTensor<float>({1, 2});
+  Tensor indices1 = test::AsTensor<int32>({2});
+  Tensor updates1 = test::AsTensor<float>({3});
+  Aggregator::Update update0;
+  update0.indices = &indices0;
+  update0.updates = &updates0;
+  Aggregator::Update update1;
+  update1.indices = &indices1;
+  update1.updates = &updates1;
+
+  Tensor indices;
+  Tensor values;
+  Aggregator::Merge({&update0, &update1}, 4, TensorShape({}), &indices,
+                    &values);
+  EXPECT_EQ(error::INVALID_ARGUMENT, update0.status.code());
+  TF_EXPECT_OK(update1.status);
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({2}), indices);
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({3}), values);
+}
+
+TEST(SparseUpdateAggregatorTest, SubmitCombinesEveryUpdateOnce) {
+  const int kNumUpdates = 100;
+  mutex var_mu;
+  Aggregator* aggregator = Aggregator::ForVariable(&var_mu);
+  EXPECT_EQ(aggregator, Aggregator::ForVariable(&var_mu));
+
+  mutex mu;
+  std::vector<int> combined(kNumUpdates, 0);
+  std::vector<Aggregator::Update> updates(kNumUpdates);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int i = 0; i < kNumUpdates; ++i) {
+      pool.Schedule([aggregator, &updates, &combined, &mu, i]() {
+        aggregator->Submit(
+            &updates[i],
+            [&updates, &combined, &mu](
+                const std::vector<Aggregator::Update*>& batch) {
+              mutex_lock l(mu);
+              for (Aggregator::Update* u : batch) {
+                ++combined[u - updates.data()];
+              }
+            });
+      });
+    }
+  }
+  for (int i = 0; i < kNumUpdates; ++i) {
+    EXPECT_EQ(1, combined[i]) << i;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
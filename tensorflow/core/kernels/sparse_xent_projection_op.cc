@@ -0,0 +1,417 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/sparse_xent_projection_op.h"
+
+#include <algorithm>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/fill_functor.h"
+
+#if GOOGLE_CUDA
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+// Partial specialization for a CPUDevice, that uses the Eigen implementation
+// from ProjectedSparseXentEigenImpl.
+namespace functor {
+template <typename T, typename Index>
+struct ProjectedSparseXentFunctor<CPUDevice, T, Index>
+    : ProjectedSparseXentEigenImpl<CPUDevice, T, Index> {};
+}  // namespace functor
+
+namespace {
+
+// Computes c = op(a) * op(b), or c += op(a) * op(b) if "accumulate", for
+// row-major matrices, where op(x) is x or its transpose, op(a) is m x k and
+// op(b) is k x n.
+template <typename Device, typename T>
+struct ProjectionGemm;
+
+template <typename T>
+struct ProjectionGemm<CPUDevice, T> {
+  static Status Compute(OpKernelContext* ctx, bool transpose_a,
+                        bool transpose_b, int64 m, int64 n, int64 k,
+                        const T* a, const T* b, bool accumulate, T* c) {
+    typename TTypes<T>::UnalignedConstMatrix a_matrix(
+        a, transpose_a ? k : m, transpose_a ? m : k);
+    typename TTypes<T>::UnalignedConstMatrix b_matrix(
+        b, transpose_b ? n : k, transpose_b ? k : n);
+    typename TTypes<T>::UnalignedMatrix c_matrix(c, m, n);
+    Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> contract_pairs;
+    contract_pairs[0] =
+        Eigen::IndexPair<Eigen::DenseIndex>(transpose_a ? 0 : 1,
+                                            transpose_b ? 1 : 0);
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    if (accumulate) {
+      c_matrix.device(d) += a_matrix.contract(b_matrix, contract_pairs);
+    } else {
+      c_matrix.device(d) = a_matrix.contract(b_matrix, contract_pairs);
+    }
+    return Status::OK();
+  }
+};
+
+#if GOOGLE_CUDA
+
+template <typename T>
+perftools::gputools::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory) {
+  perftools::gputools::DeviceMemoryBase wrapped(const_cast<T*>(cuda_memory));
+  perftools::gputools::DeviceMemory<T> typed(wrapped);
+  return typed;
+}
+
+template <typename T>
+struct ProjectionGemm<GPUDevice, T> {
+  static Status Compute(OpKernelContext* ctx, bool transpose_a,
+                        bool transpose_b, int64 m, int64 n, int64 k,
+                        const T* a, const T* b, bool accumulate, T* c) {
+    using perftools::gputools::blas::Transpose;
+    auto* stream = ctx->op_device_context()->stream();
+    if (stream == nullptr) {
+      return errors::Internal("No GPU stream available.");
+    }
+    auto a_ptr = AsDeviceMemory(a);
+    auto b_ptr = AsDeviceMemory(b);
+    auto c_ptr = AsDeviceMemory(c);
+    // cuBLAS works with column-major matrices, so compute
+    // c' = op(b)' * op(a)'.
+    bool blas_launch_status =
+        stream
+            ->ThenBlasGemm(
+                transpose_b ? Transpose::kTranspose : Transpose::kNoTranspose,
+                transpose_a ? Transpose::kTranspose : Transpose::kNoTranspose,
+                n, m, k, T(1), b_ptr, transpose_b ? k : n, a_ptr,
+                transpose_a ? m : k, accumulate ? T(1) : T(0), &c_ptr, n)
+            .ok();
+    if (!blas_launch_status) {
+      return errors::Internal("Blas GEMM launch failed : m=", m, ", n=", n,
+                              ", k=", k);
+    }
+    return Status::OK();
+  }
+};
+
+#endif  // GOOGLE_CUDA
+
+// Returns an error if a label is not in [0, num_classes).
+template <typename Index>
+Status CheckLabels(const Tensor& labels, int64 num_classes) {
+  if (labels.NumElements() == 0) return Status::OK();
+  const auto label_values = labels.vec<Index>();
+  auto min_max_value = std::minmax_element(
+      label_values.data(), label_values.data() + label_values.size());
+  if (*min_max_value.first < 0 || *min_max_value.second >= num_classes) {
+    const int64 bad_index = (*min_max_value.first < 0)
+                                ? *min_max_value.first
+                                : *min_max_value.second;
+    return errors::InvalidArgument("Received a label value of ", bad_index,
+                                   " which is outside the valid range of [0, ",
+                                   num_classes, ").  Label values: ",
+                                   labels.SummarizeValue(labels.NumElements()));
+  }
+  return Status::OK();
+}
+
+// Checks the inputs, weights, biases and labels shared by the op and its
+// gradient.
+Status CheckProjectionInputs(const Tensor& inputs, const Tensor& weights,
+                             const Tensor& biases, const Tensor& labels) {
+  if (!TensorShapeUtils::IsMatrix(inputs.shape())) {
+    return errors::InvalidArgument("inputs must be 2-D, but got shape ",
+                                   inputs.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsMatrix(weights.shape())) {
+    return errors::InvalidArgument("weights must be 2-D, but got shape ",
+                                   weights.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(biases.shape())) {
+    return errors::InvalidArgument("biases must be 1-D, but got shape ",
+                                   biases.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(labels.shape())) {
+    return errors::InvalidArgument("labels must be 1-D, but got shape ",
+                                   labels.shape().DebugString());
+  }
+  if (inputs.dim_size(1) != weights.dim_size(1)) {
+    return errors::InvalidArgument(
+        "inputs and weights must have the same second dimension, got inputs "
+        "shape ",
+        inputs.shape().DebugString(), " and weights shape ",
+        weights.shape().DebugString());
+  }
+  if (weights.dim_size(0) != biases.dim_size(0)) {
+    return errors::InvalidArgument(
+        "weights and biases must have the same first dimension, got weights "
+        "shape ",
+        weights.shape().DebugString(), " and biases shape ",
+        biases.shape().DebugString());
+  }
+  if (inputs.dim_size(0) != labels.dim_size(0)) {
+    return errors::InvalidArgument(
+        "inputs and labels must have the same first dimension, got inputs "
+        "shape ",
+        inputs.shape().DebugString(), " and labels shape ",
+        labels.shape().DebugString());
+  }
+  if (weights.dim_size(0) == 0) {
+    return errors::InvalidArgument(
+        "Must have at least one class, but got weights shape ",
+        weights.shape().DebugString());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+// Computes the logits of chunk_size classes at a time into a
+// [batch_size, chunk_size] buffer, and merges each chunk into a running
+// log-sum-exp of each row, so the [batch_size, num_classes] logits are
+// never materialized.
+template <typename Device, typename T, typename Index>
+class SparseSoftmaxXentWithProjectionOp : public OpKernel {
+ public:
+  explicit SparseSoftmaxXentWithProjectionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("chunk_size", &chunk_size_));
+    OP_REQUIRES(context, chunk_size_ > 0,
+                errors::InvalidArgument("chunk_size must be positive, got ",
+                                        chunk_size_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& inputs = context->input(0);
+    const Tensor& weights = context->input(1);
+    const Tensor& biases = context->input(2);
+    const Tensor& labels = context->input(3);
+    OP_REQUIRES_OK(context,
+                   CheckProjectionInputs(inputs, weights, biases, labels));
+
+    const int64 batch_size = inputs.dim_size(0);
+    const int64 dim = inputs.dim_size(1);
+    const int64 num_classes = weights.dim_size(0);
+
+    Tensor* loss_out = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, labels.shape(), &loss_out));
+    Tensor* log_sum_exp_out = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(1, labels.shape(),
+                                                     &log_sum_exp_out));
+    if (batch_size == 0) return;
+    if (std::is_same<Device, CPUDevice>::value) {
+      OP_REQUIRES_OK(context, CheckLabels<Index>(labels, num_classes));
+    }
+
+    const int64 chunk_size = std::min<int64>(chunk_size_, num_classes);
+    Tensor logits;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DataTypeToEnum<T>::value,
+                                TensorShape({batch_size, chunk_size}),
+                                &logits));
+    Tensor scratch, max_logits, sum_exp_logits, label_logits;
+    for (Tensor* t : {&scratch, &max_logits, &sum_exp_logits, &label_logits}) {
+      OP_REQUIRES_OK(context, context->allocate_temp(DataTypeToEnum<T>::value,
+                                                     labels.shape(), t));
+    }
+
+    typedef functor::ProjectedSparseXentFunctor<Device, T, Index> Functor;
+    const Device& d = context->eigen_device<Device>();
+    Functor::Initialize(d, max_logits.vec<T>(), sum_exp_logits.vec<T>(),
+                        label_logits.vec<T>());
+
+    const T* inputs_data = inputs.flat<T>().data();
+    const T* weights_data = weights.flat<T>().data();
+    const T* biases_data = biases.flat<T>().data();
+    for (int64 chunk_begin = 0; chunk_begin < num_classes;
+         chunk_begin += chunk_size) {
+      const int64 size = std::min(chunk_size, num_classes - chunk_begin);
+      typename TTypes<T>::Matrix chunk_logits(logits.flat<T>().data(),
+                                              batch_size, size);
+      // chunk_logits = inputs * weights[chunk_begin:chunk_begin + size]'.
+      OP_REQUIRES_OK(context,
+                     ProjectionGemm<Device, T>::Compute(
+                         context, false, true, batch_size, size, dim,
+                         inputs_data, weights_data + chunk_begin * dim, false,
+                         chunk_logits.data()));
+      Functor::ForwardChunk(
+          d,
+          typename TTypes<T>::UnalignedConstVec(biases_data + chunk_begin,
+                                                size),
+          labels.vec<Index>(), chunk_begin, chunk_logits, scratch.vec<T>(),
+          max_logits.vec<T>(), sum_exp_logits.vec<T>(), label_logits.vec<T>());
+    }
+    Functor::Loss(d, labels.vec<Index>(), num_classes,
+                  const_cast<const Tensor&>(max_logits).vec<T>(),
+                  const_cast<const Tensor&>(sum_exp_logits).vec<T>(),
+                  const_cast<const Tensor&>(label_logits).vec<T>(),
+                  loss_out->vec<T>(), log_sum_exp_out->vec<T>());
+  }
+
+ private:
+  int64 chunk_size_;
+};
+
+// Computes the logits again, chunk by chunk, from the log-sum-exp of the
+// forward pass, and accumulates the gradients of the inputs, weights and
+// biases from each chunk of gradients of the logits.
+template <typename Device, typename T, typename Index>
+class SparseSoftmaxXentWithProjectionGradOp : public OpKernel {
+ public:
+  explicit SparseSoftmaxXentWithProjectionGradOp(
+      OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("chunk_size", &chunk_size_));
+    OP_REQUIRES(context, chunk_size_ > 0,
+                errors::InvalidArgument("chunk_size must be positive, got ",
+                                        chunk_size_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& inputs = context->input(0);
+    const Tensor& weights = context->input(1);
+    const Tensor& biases = context->input(2);
+    const Tensor& labels = context->input(3);
+    const Tensor& log_sum_exp = context->input(4);
+    const Tensor& loss_grad = context->input(5);
+    OP_REQUIRES_OK(context,
+                   CheckProjectionInputs(inputs, weights, biases, labels));
+    OP_REQUIRES(context, log_sum_exp.shape() == labels.shape(),
+                errors::InvalidArgument(
+                    "log_sum_exp must have the shape of labels, got ",
+                    log_sum_exp.shape().DebugString(), " and ",
+                    labels.shape().DebugString()));
+    OP_REQUIRES(context, loss_grad.shape() == labels.shape(),
+                errors::InvalidArgument(
+                    "loss_grad must have the shape of labels, got ",
+                    loss_grad.shape().DebugString(), " and ",
+                    labels.shape().DebugString()));
+
+    const int64 batch_size = inputs.dim_size(0);
+    const int64 dim = inputs.dim_size(1);
+    const int64 num_classes = weights.dim_size(0);
+
+    Tensor* inputs_grad = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, inputs.shape(), &inputs_grad));
+    Tensor* weights_grad = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, weights.shape(), &weights_grad));
+    Tensor* biases_grad = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(2, biases.shape(), &biases_grad));
+    const Device& d = context->eigen_device<Device>();
+    if (batch_size == 0) {
+      functor::SetZeroFunctor<Device, T> set_zero;
+      set_zero(d, weights_grad->flat<T>());
+      set_zero(d, biases_grad->flat<T>());
+      return;
+    }
+    if (std::is_same<Device, CPUDevice>::value) {
+      OP_REQUIRES_OK(context, CheckLabels<Index>(labels, num_classes));
+    }
+
+    const int64 chunk_size = std::min<int64>(chunk_size_, num_classes);
+    Tensor logits;
+    OP_REQUIRES_OK(context, context->allocate_temp(
+                                DataTypeToEnum<T>::value,
+                                TensorShape({batch_size, chunk_size}),
+                                &logits));
+
+    typedef functor::ProjectedSparseXentFunctor<Device, T, Index> Functor;
+    const T* inputs_data = inputs.flat<T>().data();
+    const T* weights_data = weights.flat<T>().data();
+    const T* biases_data = biases.flat<T>().data();
+    T* inputs_grad_data = inputs_grad->flat<T>().data();
+    T* weights_grad_data = weights_grad->flat<T>().data();
+    T* biases_grad_data = biases_grad->flat<T>().data();
+    for (int64 chunk_begin = 0; chunk_begin < num_classes;
+         chunk_begin += chunk_size) {
+      const int64 size = std::min(chunk_size, num_classes - chunk_begin);
+      typename TTypes<T>::Matrix chunk_logits(logits.flat<T>().data(),
+                                              batch_size, size);
+      OP_REQUIRES_OK(context,
+                     ProjectionGemm<Device, T>::Compute(
+                         context, false, true, batch_size, size, dim,
+                         inputs_data, weights_data + chunk_begin * dim, false,
+                         chunk_logits.data()));
+      Functor::BackwardChunk(
+          d,
+          typename TTypes<T>::UnalignedConstVec(biases_data + chunk_begin,
+                                                size),
+          labels.vec<Index>(), chunk_begin, num_classes, log_sum_exp.vec<T>(),
+          loss_grad.vec<T>(), chunk_logits,
+          typename TTypes<T>::UnalignedVec(biases_grad_data + chunk_begin,
+                                           size));
+      // inputs_grad += logits_grad * weights[chunk_begin:chunk_begin + size].
+      OP_REQUIRES_OK(context,
+                     ProjectionGemm<Device, T>::Compute(
+                         context, false, false, batch_size, dim, size,
+                         chunk_logits.data(), weights_data + chunk_begin * dim,
+                         chunk_begin > 0, inputs_grad_data));
+      // weights_grad[chunk_begin:chunk_begin + size] = logits_grad' * inputs.
+      OP_REQUIRES_OK(context,
+                     ProjectionGemm<Device, T>::Compute(
+                         context, true, false, size, dim, batch_size,
+                         chunk_logits.data(), inputs_data, false,
+                         weights_grad_data + chunk_begin * dim));
+    }
+  }
+
+ private:
+  int64 chunk_size_;
+};
+
+#define REGISTER(Dev, T, Index)                                      \
+  REGISTER_KERNEL_BUILDER(                                           \
+      Name("SparseSoftmaxCrossEntropyWithProjection")                \
+          .Device(DEVICE_##Dev)                                      \
+          .TypeConstraint<T>("T")                                    \
+          .TypeConstraint<Index>("Tlabels"),                         \
+      SparseSoftmaxXentWithProjectionOp<Dev##Device, T, Index>);     \
+  REGISTER_KERNEL_BUILDER(                                           \
+      Name("SparseSoftmaxCrossEntropyWithProjectionGrad")            \
+          .Device(DEVICE_##Dev)                                      \
+          .TypeConstraint<T>("T")                                    \
+          .TypeConstraint<Index>("Tlabels"),                         \
+      SparseSoftmaxXentWithProjectionGradOp<Dev##Device, T, Index>);
+REGISTER(CPU, float, int32)
+REGISTER(CPU, float, int64)
+REGISTER(CPU, double, int32)
+REGISTER(CPU, double, int64)
+
+#if GOOGLE_CUDA
+REGISTER(GPU, float, int32)
+REGISTER(GPU, float, int64)
+REGISTER(GPU, double, int32)
+REGISTER(GPU, double, int64)
+#endif  // GOOGLE_CUDA
+
+#undef REGISTER
+
+}  // namespace tensorflow
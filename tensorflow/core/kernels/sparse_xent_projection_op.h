@@ -0,0 +1,295 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_KERNELS_SPARSE_XENT_PROJECTION_OP_H_
+#define TENSORFLOW_KERNELS_SPARSE_XENT_PROJECTION_OP_H_
+// Functor definitions for SparseSoftmaxCrossEntropyWithProjection, must be
+// compilable by nvcc.
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/bounds_check.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace generator {
+
+// Generator for the logits of the labels that fall in a chunk of classes.
+// For each minibatch entry b, it returns logits[b, label - chunk_begin] if
+// the label is one of the classes of "logits", which start at chunk_begin,
+// and 0 otherwise.
+template <typename T, typename Index>
+class ProjectedXentLabelLogitGenerator {
+ public:
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE ProjectedXentLabelLogitGenerator(
+      typename TTypes<T>::ConstMatrix logits,
+      typename TTypes<Index>::ConstVec labels, const Index chunk_begin)
+      : logits_(logits), labels_(labels), chunk_begin_(chunk_begin) {}
+
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE T
+  operator()(const Eigen::array<Eigen::DenseIndex, 1>& coords) const {
+    const Eigen::DenseIndex batch = coords[0];
+    const Index label =
+        tensorflow::internal::SubtleMustCopy(labels_(batch)) - chunk_begin_;
+    if (!FastBoundsCheck(label, logits_.dimension(1))) {
+      return T(0);
+    }
+    return logits_(batch, label);
+  }
+
+ private:
+  typename TTypes<T>::ConstMatrix logits_;
+  typename TTypes<Index>::ConstVec labels_;
+  const Index chunk_begin_;
+};
+
+// Generator for the loss: log_sum_exp[b] - label_logits[b], or NaN if the
+// label of minibatch entry b is not in [0, num_classes).
+template <typename T, typename Index>
+class ProjectedXentLossGenerator {
+ public:
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE ProjectedXentLossGenerator(
+      typename TTypes<T>::ConstVec log_sum_exp,
+      typename TTypes<T>::ConstVec label_logits,
+      typename TTypes<Index>::ConstVec labels, const Index num_classes)
+      : log_sum_exp_(log_sum_exp),
+        label_logits_(label_logits),
+        labels_(labels),
+        num_classes_(num_classes) {}
+
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE T
+  operator()(const Eigen::array<Eigen::DenseIndex, 1>& coords) const {
+    const Eigen::DenseIndex batch = coords[0];
+    const Index label = tensorflow::internal::SubtleMustCopy(labels_(batch));
+    if (!FastBoundsCheck(label, num_classes_)) {
+      return Eigen::NumTraits<T>::quiet_NaN();
+    }
+    return log_sum_exp_(batch) - label_logits_(batch);
+  }
+
+ private:
+  typename TTypes<T>::ConstVec log_sum_exp_;
+  typename TTypes<T>::ConstVec label_logits_;
+  typename TTypes<Index>::ConstVec labels_;
+  const Index num_classes_;
+};
+
+// Generator for the gradient of the loss with respect to a chunk of logits,
+// whose classes start at chunk_begin. For each minibatch entry, ignoring the
+// batch index b, it calculates:
+//
+//   (exp(logits[j] - log_sum_exp) - 1{ chunk_begin + j == label }) * loss_grad
+//
+// or NaN if the label is not in [0, num_classes).
+template <typename T, typename Index>
+class ProjectedXentGradGenerator {
+ public:
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE ProjectedXentGradGenerator(
+      typename TTypes<T>::ConstMatrix logits,
+      typename TTypes<T>::ConstVec log_sum_exp,
+      typename TTypes<T>::ConstVec loss_grad,
+      typename TTypes<Index>::ConstVec labels, const Index chunk_begin,
+      const Index num_classes)
+      : logits_(logits),
+        log_sum_exp_(log_sum_exp),
+        loss_grad_(loss_grad),
+        labels_(labels),
+        chunk_begin_(chunk_begin),
+        num_classes_(num_classes) {}
+
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE T
+  operator()(const Eigen::array<Eigen::DenseIndex, 2>& coords) const {
+    const Eigen::DenseIndex batch = coords[0];
+    const Eigen::DenseIndex depth = coords[1];
+    const Index label = tensorflow::internal::SubtleMustCopy(labels_(batch));
+    if (!FastBoundsCheck(label, num_classes_)) {
+      return Eigen::NumTraits<T>::quiet_NaN();
+    }
+    const T subtract =
+        TF_PREDICT_FALSE(chunk_begin_ + depth == label) ? T(1.0) : T(0.0);
+    return (Eigen::numext::exp(logits_(coords) - log_sum_exp_(batch)) -
+            subtract) *
+           loss_grad_(batch);
+  }
+
+ private:
+  typename TTypes<T>::ConstMatrix logits_;
+  typename TTypes<T>::ConstVec log_sum_exp_;
+  typename TTypes<T>::ConstVec loss_grad_;
+  typename TTypes<Index>::ConstVec labels_;
+  const Index chunk_begin_;
+  const Index num_classes_;
+};
+
+}  // namespace generator
+
+namespace functor {
+
+// Functors used by SparseSoftmaxCrossEntropyWithProjection and its gradient
+// for the element-wise work on each chunk of logits. The logits of a chunk of
+// classes are computed by a GEMM of the inputs and the weights of the chunk,
+// without the biases, which these functors add.
+template <typename Device, typename T, typename Index>
+struct ProjectedSparseXentFunctor {
+  // Sets max_logits to the lowest value, and sum_exp_logits and label_logits
+  // to 0, before the first chunk.
+  static void Initialize(const Device& d, typename TTypes<T>::Vec max_logits,
+                         typename TTypes<T>::Vec sum_exp_logits,
+                         typename TTypes<T>::Vec label_logits);
+
+  // Adds the biases of a chunk to its logits, merges the chunk into the
+  // running maximum and sum of exponentials of each row, and adds the logits
+  // of the labels in the chunk to label_logits.
+  //
+  // biases: chunk_size.
+  // labels: batch_size.
+  // logits: batch_size, chunk_size.
+  // scratch: temporary tensor, dims: batch_size.
+  // max_logits, sum_exp_logits, label_logits: batch_size.
+  static void ForwardChunk(const Device& d,
+                           typename TTypes<T>::UnalignedConstVec biases,
+                           typename TTypes<Index>::ConstVec labels,
+                           Index chunk_begin, typename TTypes<T>::Matrix logits,
+                           typename TTypes<T>::Vec scratch,
+                           typename TTypes<T>::Vec max_logits,
+                           typename TTypes<T>::Vec sum_exp_logits,
+                           typename TTypes<T>::Vec label_logits);
+
+  // Computes log_sum_exp and the loss once all the chunks have been merged.
+  static void Loss(const Device& d, typename TTypes<Index>::ConstVec labels,
+                   Index num_classes, typename TTypes<T>::ConstVec max_logits,
+                   typename TTypes<T>::ConstVec sum_exp_logits,
+                   typename TTypes<T>::ConstVec label_logits,
+                   typename TTypes<T>::Vec loss,
+                   typename TTypes<T>::Vec log_sum_exp);
+
+  // Adds the biases of a chunk to its logits, replaces them with the gradient
+  // of the loss with respect to them, and sums that along the batch into
+  // biases_grad.
+  static void BackwardChunk(const Device& d,
+                            typename TTypes<T>::UnalignedConstVec biases,
+                            typename TTypes<Index>::ConstVec labels,
+                            Index chunk_begin, Index num_classes,
+                            typename TTypes<T>::ConstVec log_sum_exp,
+                            typename TTypes<T>::ConstVec loss_grad,
+                            typename TTypes<T>::Matrix logits,
+                            typename TTypes<T>::UnalignedVec biases_grad);
+};
+
+// Eigen code implementing ProjectedSparseXentFunctor. This code works for
+// both CPU and GPU and is used by the functor specializations for both device
+// types.
+template <typename Device, typename T, typename Index>
+struct ProjectedSparseXentEigenImpl {
+  static void Initialize(const Device& d, typename TTypes<T>::Vec max_logits,
+                         typename TTypes<T>::Vec sum_exp_logits,
+                         typename TTypes<T>::Vec label_logits) {
+    max_logits.device(d) = max_logits.constant(Eigen::NumTraits<T>::lowest());
+    sum_exp_logits.device(d) = sum_exp_logits.constant(T(0));
+    label_logits.device(d) = label_logits.constant(T(0));
+  }
+
+  static void ForwardChunk(const Device& d,
+                           typename TTypes<T>::UnalignedConstVec biases,
+                           typename TTypes<Index>::ConstVec labels,
+                           Index chunk_begin, typename TTypes<T>::Matrix logits,
+                           typename TTypes<T>::Vec scratch,
+                           typename TTypes<T>::Vec max_logits,
+                           typename TTypes<T>::Vec sum_exp_logits,
+                           typename TTypes<T>::Vec label_logits) {
+    const int batch_size = logits.dimension(0);
+    const int chunk_size = logits.dimension(1);
+    Eigen::array<int, 1> along_class;
+    along_class[0] = 1;
+    Eigen::array<int, 2> batch_by_one;
+    batch_by_one[0] = batch_size;
+    batch_by_one[1] = 1;
+    Eigen::array<int, 2> one_by_class;
+    one_by_class[0] = 1;
+    one_by_class[1] = chunk_size;
+
+    // logits += biases.
+    logits.device(d) += biases.reshape(one_by_class).broadcast(batch_by_one);
+
+    // scratch = the new maximum of each row.
+    scratch.device(d) = max_logits.cwiseMax(logits.maximum(along_class));
+
+    // Rescales the sum of exponentials to the new maximum, and adds those of
+    // the chunk.
+    sum_exp_logits.device(d) =
+        sum_exp_logits * (max_logits - scratch).exp() +
+        (logits - scratch.reshape(batch_by_one).broadcast(one_by_class))
+            .exp()
+            .sum(along_class);
+    max_logits.device(d) = scratch;
+
+    generator::ProjectedXentLabelLogitGenerator<T, Index> label_logit_gen(
+        typename TTypes<T>::ConstMatrix(logits.data(), logits.dimensions()),
+        labels, chunk_begin);
+    label_logits.device(d) += label_logits.generate(label_logit_gen);
+  }
+
+  static void Loss(const Device& d, typename TTypes<Index>::ConstVec labels,
+                   Index num_classes, typename TTypes<T>::ConstVec max_logits,
+                   typename TTypes<T>::ConstVec sum_exp_logits,
+                   typename TTypes<T>::ConstVec label_logits,
+                   typename TTypes<T>::Vec loss,
+                   typename TTypes<T>::Vec log_sum_exp) {
+    log_sum_exp.device(d) = max_logits + sum_exp_logits.log();
+    generator::ProjectedXentLossGenerator<T, Index> loss_gen(
+        typename TTypes<T>::ConstVec(log_sum_exp.data(),
+                                     log_sum_exp.dimensions()),
+        label_logits, labels, num_classes);
+    loss.device(d) = loss.generate(loss_gen);
+  }
+
+  static void BackwardChunk(const Device& d,
+                            typename TTypes<T>::UnalignedConstVec biases,
+                            typename TTypes<Index>::ConstVec labels,
+                            Index chunk_begin, Index num_classes,
+                            typename TTypes<T>::ConstVec log_sum_exp,
+                            typename TTypes<T>::ConstVec loss_grad,
+                            typename TTypes<T>::Matrix logits,
+                            typename TTypes<T>::UnalignedVec biases_grad) {
+    const int batch_size = logits.dimension(0);
+    const int chunk_size = logits.dimension(1);
+    Eigen::array<int, 1> along_batch;
+    along_batch[0] = 0;
+    Eigen::array<int, 2> batch_by_one;
+    batch_by_one[0] = batch_size;
+    batch_by_one[1] = 1;
+    Eigen::array<int, 2> one_by_class;
+    one_by_class[0] = 1;
+    one_by_class[1] = chunk_size;
+
+    // logits += biases.
+    logits.device(d) += biases.reshape(one_by_class).broadcast(batch_by_one);
+
+    // Each gradient only reads the logit it replaces.
+    generator::ProjectedXentGradGenerator<T, Index> grad_gen(
+        typename TTypes<T>::ConstMatrix(logits.data(), logits.dimensions()),
+        log_sum_exp, loss_grad, labels, chunk_begin, num_classes);
+    logits.device(d) = logits.generate(grad_gen);
+
+    biases_grad.device(d) = logits.sum(along_batch);
+  }
+};
+
+}  // namespace functor
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_KERNELS_SPARSE_XENT_PROJECTION_OP_H_
@@ -0,0 +1,51 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/kernels/sparse_xent_projection_op.h"
+
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+// Partial specialization for a GPUDevice, that uses the Eigen implementation
+// from ProjectedSparseXentEigenImpl.
+namespace functor {
+template <typename T, typename Index>
+struct ProjectedSparseXentFunctor<GPUDevice, T, Index>
+    : ProjectedSparseXentEigenImpl<GPUDevice, T, Index> {};
+}  // end namespace functor
+
+// Instantiate the GPU implementation for float and double.
+#define REGISTER(T, Index)                                                   \
+  template struct functor::ProjectedSparseXentFunctor<GPUDevice, T, Index>;  \
+  template class generator::ProjectedXentLabelLogitGenerator<T, Index>;      \
+  template class generator::ProjectedXentLossGenerator<T, Index>;            \
+  template class generator::ProjectedXentGradGenerator<T, Index>;
+REGISTER(float, int32)
+REGISTER(float, int64)
+REGISTER(double, int32)
+REGISTER(double, int64)
+#undef REGISTER
+
+}  // end namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -14,12 +14,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/stats_aggregator.h"
 
+#include <map>
 #include <memory>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_op_kernel.h"
 #include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
@@ -49,9 +53,82 @@ class StatsAggregatorImpl : public StatsAggregator {
       histogram.EncodeToProto(value->mutable_histo(),
                               true /* preserve_zero_buckets */);
     }
+    EncodePipelineLocked(out_summary);
   }
 
  private:
+  // The statistics that `GetNextStatsRecorder` records for an iterator.
+  struct StageStats {
+    HistogramProto get_next_usecs;
+    HistogramProto input_wait_usecs;
+    HistogramProto buffer_utilization;
+  };
+
+  // Adds a text summary with a table of the stages of the input pipeline,
+  // from the consumer to the source, and marks the stage that spends the most
+  // time in itself as the bottleneck.
+  void EncodePipelineLocked(Summary* out_summary)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    // Sorting by prefix puts every iterator before its inputs.
+    std::map<string, StageStats> stages;
+    for (const auto& pair : histograms_) {
+      StringPiece name(pair.first);
+      HistogramProto* histo = nullptr;
+      if (str_util::ConsumeSuffix(&name, "::get_next_usecs")) {
+        histo = &stages[name.ToString()].get_next_usecs;
+      } else if (str_util::ConsumeSuffix(&name, "::input_wait_usecs")) {
+        histo = &stages[name.ToString()].input_wait_usecs;
+      } else if (str_util::ConsumeSuffix(&name, "::buffer_utilization")) {
+        histo = &stages[name.ToString()].buffer_utilization;
+      } else {
+        continue;
+      }
+      pair.second.EncodeToProto(histo, false /* preserve_zero_buckets */);
+    }
+    auto mean = [](const HistogramProto& histo) {
+      return histo.num() > 0 ? histo.sum() / histo.num() : 0.0;
+    };
+    string bottleneck;
+    double bottleneck_usecs = -1;
+    for (const auto& stage : stages) {
+      if (stage.second.get_next_usecs.num() == 0) continue;
+      const double self_usecs = mean(stage.second.get_next_usecs) -
+                                mean(stage.second.input_wait_usecs);
+      if (self_usecs > bottleneck_usecs) {
+        bottleneck = stage.first;
+        bottleneck_usecs = self_usecs;
+      }
+    }
+    if (bottleneck.empty()) return;
+
+    string table =
+        "| stage | elements | mean get_next (us) | mean input wait (us) | "
+        "mean self (us) | buffer utilization |\n"
+        "|---|---|---|---|---|---|\n";
+    for (const auto& stage : stages) {
+      const StageStats& s = stage.second;
+      if (s.get_next_usecs.num() == 0) continue;
+      const double get_next = mean(s.get_next_usecs);
+      const double input_wait = mean(s.input_wait_usecs);
+      const string buffer =
+          s.buffer_utilization.num() > 0
+              ? strings::Printf("%.2f", mean(s.buffer_utilization))
+              : "-";
+      strings::Appendf(&table, "| %s%s | %.0f | %.1f | %.1f | %.1f | %s |\n",
+                       stage.first.c_str(),
+                       stage.first == bottleneck ? " (bottleneck)" : "",
+                       s.get_next_usecs.num(), get_next, input_wait,
+                       get_next - input_wait, buffer.c_str());
+    }
+
+    Summary::Value* value = out_summary->add_value();
+    value->set_tag("pipeline");
+    value->mutable_metadata()->mutable_plugin_data()->set_plugin_name("text");
+    Tensor text(DT_STRING, TensorShape({}));
+    text.scalar<string>()() = table;
+    text.AsProtoTensorContent(value->mutable_tensor());
+  }
+
   mutex mu_;
   std::unordered_map<string, histogram::Histogram> histograms_ GUARDED_BY(mu_);
   TF_DISALLOW_COPY_AND_ASSIGN(StatsAggregatorImpl);
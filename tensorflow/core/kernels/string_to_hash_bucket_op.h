@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_OP_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_OP_H_
 
+#include <algorithm>
 #include <string>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,9 +24,35 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// Calls bucket(i) for every element i of "input" in parallel, with a cost
+// estimate based on the average length of the strings.
+template <typename Bucket>
+void ShardStringsToBuckets(OpKernelContext* context,
+                           typename TTypes<string>::ConstFlat input,
+                           const Bucket& bucket) {
+  const int64 size = input.size();
+  if (size == 0) return;
+  // Sample a few strings for the average length instead of walking all of
+  // them.
+  const int64 kNumSamples = 16;
+  int64 sampled_bytes = 0;
+  const int64 stride = std::max<int64>(size / kNumSamples, 1);
+  int64 num_sampled = 0;
+  for (int64 i = 0; i < size; i += stride, ++num_sampled) {
+    sampled_bytes += input(i).size();
+  }
+  const int64 cost_per_unit = 20 + sampled_bytes / num_sampled;
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, size,
+        cost_per_unit, [&bucket](int64 begin, int64 end) {
+          for (int64 i = begin; i < end; ++i) bucket(i);
+        });
+}
+
 template <uint64 hash(const string&)>
 class StringToHashBucketOp : public OpKernel {
  public:
@@ -44,15 +71,15 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
+    const uint64 num_buckets = num_buckets_;
+    ShardStringsToBuckets(context, input_flat, [&](int64 i) {
       const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
+      const uint64 bucket_id = input_hash % num_buckets;
       // The number of buckets is always in the positive range of int64 so is
       // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
       // safe.
       output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    });
   }
 
  private:
@@ -86,15 +113,15 @@ class StringToKeyedHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
+    const uint64 num_buckets = num_buckets_;
+    ShardStringsToBuckets(context, input_flat, [&](int64 i) {
       const uint64 input_hash = hash(key_, input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
+      const uint64 bucket_id = input_hash % num_buckets;
       // The number of buckets is always in the positive range of int64 so is
       // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
       // safe.
       output_flat(i) = static_cast<int64>(bucket_id);
-    }
+    });
   }
 
  private:
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/summary_interface.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "tensorflow/core/framework/graph.pb.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/png/png_io.h"
 #include "tensorflow/core/lib/wav/wav_io.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
 
@@ -210,12 +212,17 @@ Status NormalizeAndAddImages(const Tensor& tensor, int max_images, int h, int w,
 
 }  // namespace
 
+// Events are written to the file by a background thread, which wakes up when
+// max_queue events are queued, every flush_millis, and on Flush(). A write
+// only blocks when the thread falls behind by several queues, and the errors
+// of the thread are returned by the following writes and flushes.
 class SummaryWriterImpl : public SummaryWriterInterface {
  public:
   SummaryWriterImpl(int max_queue, int flush_millis, Env* env)
       : SummaryWriterInterface(),
         is_initialized_(false),
         max_queue_(max_queue),
+        max_pending_(kMaxPendingQueues * std::max(max_queue, 1)),
         flush_millis_(flush_millis),
         env_(env) {}
 
@@ -235,6 +242,8 @@ class SummaryWriterImpl : public SummaryWriterInterface {
     }
     last_flush_ = env_->NowMicros();
     is_initialized_ = true;
+    thread_.reset(env_->StartThread(ThreadOptions(), "summary_writer",
+                                    [this]() { WriterLoop(); }));
     return Status::OK();
   }
 
@@ -243,11 +252,25 @@ class SummaryWriterImpl : public SummaryWriterInterface {
     if (!is_initialized_) {
       return errors::FailedPrecondition("Class was not properly initialized.");
     }
-    return InternalFlush();
+    const uint64 target = num_enqueued_;
+    if (num_written_ < target) {
+      flush_requested_ = true;
+      work_cv_.notify_one();
+      while (num_written_ < target) {
+        written_cv_.wait(ml);
+      }
+    }
+    return write_status_;
   }
 
   ~SummaryWriterImpl() override {
-    (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      shutdown_ = true;
+    }
+    work_cv_.notify_one();
+    // Joins the writer thread, which writes the queued events first.
+    thread_.reset();
   }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
@@ -405,12 +428,17 @@ class SummaryWriterImpl : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    while (queue_.size() >= max_pending_) {
+      written_cv_.wait(ml);
+    }
     queue_.emplace_back(std::move(event));
+    ++num_enqueued_;
     if (queue_.size() >= max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      flush_requested_ = true;
+      work_cv_.notify_one();
     }
-    return Status::OK();
+    return write_status_;
   }
 
   string DebugString() override { return "SummaryWriterImpl"; }
@@ -420,27 +448,77 @@ class SummaryWriterImpl : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
-      events_writer_->WriteEvent(*e);
-    }
-    queue_.clear();
-    if (!events_writer_->Flush()) {
-      return errors::InvalidArgument("Could not flush events file.");
+  // Writes the queued events until the writer is destroyed.
+  void WriterLoop() {
+    std::vector<std::unique_ptr<Event>> events;
+    while (true) {
+      uint64 target;
+      {
+        mutex_lock ml(mu_);
+        while (!flush_requested_ && !shutdown_ && queue_.size() < max_queue_) {
+          if (flush_millis_ <= 0) {
+            work_cv_.wait(ml);
+          } else if (WaitForMilliseconds(&ml, &work_cv_, flush_millis_) ==
+                     kCond_Timeout) {
+            break;
+          }
+        }
+        if (queue_.empty() && !flush_requested_) {
+          if (shutdown_) return;
+          continue;
+        }
+        events.swap(queue_);
+        flush_requested_ = false;
+        target = num_enqueued_;
+      }
+      // Writers blocked on a full queue can go ahead.
+      written_cv_.notify_all();
+      for (const std::unique_ptr<Event>& e : events) {
+        events_writer_->WriteEvent(*e);
+      }
+      events.clear();
+      Status s;
+      if (!events_writer_->Flush()) {
+        s = errors::InvalidArgument("Could not flush events file.");
+      }
+      {
+        mutex_lock ml(mu_);
+        num_written_ = target;
+        write_status_.Update(s);
+        last_flush_ = env_->NowMicros();
+      }
+      written_cv_.notify_all();
     }
-    last_flush_ = env_->NowMicros();
-    return Status::OK();
   }
 
+  // The number of queues of events a write may get ahead of the writer
+  // thread before it blocks.
+  static const int kMaxPendingQueues = 4;
+
   bool is_initialized_;
   const int max_queue_;
+  const int max_pending_;
   const int flush_millis_;
-  uint64 last_flush_;
+  uint64 last_flush_ GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
+  // Signaled when there are events to write or the writer is destroyed.
+  condition_variable work_cv_;
+  // Signaled when the writer thread takes the queue and when it has written
+  // the events it took.
+  condition_variable written_cv_;
   std::vector<std::unique_ptr<Event>> queue_ GUARDED_BY(mu_);
-  // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ GUARDED_BY(mu_);
+  bool flush_requested_ GUARDED_BY(mu_) = false;
+  bool shutdown_ GUARDED_BY(mu_) = false;
+  // The number of events queued so far, and of those written by the thread.
+  uint64 num_enqueued_ GUARDED_BY(mu_) = 0;
+  uint64 num_written_ GUARDED_BY(mu_) = 0;
+  // The first error of the writer thread.
+  Status write_status_ GUARDED_BY(mu_);
+  // A pointer to allow deferred construction. Only used by the writer thread
+  // once it is started.
+  std::unique_ptr<EventsWriter> events_writer_;
+  std::unique_ptr<Thread> thread_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       GUARDED_BY(mu_);
 };
@@ -212,5 +212,43 @@ TEST_F(SummaryInterfaceTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+TEST_F(SummaryInterfaceTest, FlushWritesAllQueuedEvents) {
+  const string test_name = "flush_all_test";
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryWriter(3, 100000, testing::TmpDir(), test_name,
+                                  &env_, &writer));
+  Tensor one(DT_FLOAT, TensorShape({}));
+  one.scalar<float>()() = 1.0;
+  const int kNumEvents = 100;
+  for (int i = 0; i < kNumEvents; ++i) {
+    TF_CHECK_OK(writer->WriteScalar(i, one, "name"));
+  }
+  TF_CHECK_OK(writer->Flush());
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  int num_files = 0;
+  for (const string& f : files) {
+    if (!StringPiece(f).contains(test_name)) continue;
+    ++num_files;
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env_.NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    string record;
+    uint64 offset = 0;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));  // The file version.
+    for (int i = 0; i < kNumEvents; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      Event e;
+      e.ParseFromString(record);
+      EXPECT_EQ(i, e.step());
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+  EXPECT_EQ(1, num_files);
+  writer->Unref();
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/aggregate_ops_cpu.h"
+#include "tensorflow/core/kernels/dense_update_functor.h"
 
 namespace tensorflow {
 
@@ -77,6 +78,32 @@ TF_CALL_complex128(TENSOR_ARRAY_SET_ZERO_GPU);
 
 #undef TENSOR_ARRAY_SET_ZERO
 
+#define TENSOR_ARRAY_COPY(Device, T)                                        \
+  template <>                                                               \
+  Status TensorCopy<Device, T>(OpKernelContext * ctx, Tensor * dst,         \
+                               const Tensor* src) {                         \
+    functor::DenseUpdate<Device, T, ASSIGN> copy_functor;                   \
+    copy_functor(ctx->template eigen_device<Device>(), dst->flat<T>(),      \
+                 src->flat<T>());                                           \
+    return Status::OK();                                                    \
+  }
+
+#define TENSOR_ARRAY_COPY_CPU(T) TENSOR_ARRAY_COPY(CPUDevice, T)
+TF_CALL_POD_TYPES(TENSOR_ARRAY_COPY_CPU)
+#undef TENSOR_ARRAY_COPY_CPU
+
+#if GOOGLE_CUDA
+
+#define TENSOR_ARRAY_COPY_GPU(T) TENSOR_ARRAY_COPY(GPUDevice, T)
+TF_CALL_GPU_NUMBER_TYPES(TENSOR_ARRAY_COPY_GPU);
+TF_CALL_complex64(TENSOR_ARRAY_COPY_GPU);
+TF_CALL_complex128(TENSOR_ARRAY_COPY_GPU);
+#undef TENSOR_ARRAY_COPY_GPU
+
+#endif  // GOOGLE_CUDA
+
+#undef TENSOR_ARRAY_COPY
+
 }  // namespace tensor_array
 
 std::atomic<int64> TensorArray::tensor_array_counter{0};
@@ -108,4 +135,39 @@ Status TensorArray::CopyShapesFrom(TensorArray* rhs) {
   return Status::OK();
 }
 
+bool TensorArray::LockedBufferElementShape(TensorShape* shape) const {
+  if (!element_shape_.AsTensorShape(shape) || shape->num_elements() == 0) {
+    return false;
+  }
+#if EIGEN_MAX_ALIGN_BYTES > 0
+  // Kernels require their inputs to be aligned, so every view into the
+  // buffer has to start at a multiple of the alignment.
+  const int64 element_bytes = shape->num_elements() * DataTypeSize(dtype_);
+  if (element_bytes % EIGEN_MAX_ALIGN_BYTES != 0) return false;
+#endif
+  return true;
+}
+
+Status TensorArray::LockedMaybeAllocateBuffer(OpKernelContext* ctx) {
+  if (!contiguous_ || buffer_.IsInitialized()) return Status::OK();
+  TensorShape buffer_shape;
+  if (!LockedBufferElementShape(&buffer_shape)) {
+    contiguous_ = false;
+    return Status::OK();
+  }
+  buffer_shape.InsertDim(0, tensors_.size());
+  Tensor* unused;
+  return ctx->allocate_persistent(dtype_, buffer_shape, &buffer_, &unused);
+}
+
+Tensor TensorArray::LockedElementView(OpKernelContext* ctx,
+                                      const int32 index) {
+  const Tensor* buffer = buffer_.AccessTensor(ctx);
+  TensorShape element_shape(buffer->shape());
+  element_shape.RemoveDim(0);
+  Tensor view;
+  CHECK(view.CopyFrom(buffer->Slice(index, index + 1), element_shape));
+  return view;
+}
+
 }  // namespace tensorflow
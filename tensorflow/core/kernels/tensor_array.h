@@ -96,6 +96,34 @@ TF_CALL_complex128(TENSOR_ARRAY_SET_ZERO_GPU);
 
 #undef TENSOR_ARRAY_SET_ZERO
 
+template <typename Device, typename T>
+Status TensorCopy(OpKernelContext* ctx, Tensor* dst, const Tensor* src) {
+  return errors::InvalidArgument(
+      "tensor_array::TensorCopy type not supported: ",
+      DataTypeString(DataTypeToEnum<T>::value));
+};
+
+#define TENSOR_ARRAY_COPY(Device, T)                                   \
+  template <>                                                          \
+  Status TensorCopy<Device, T>(OpKernelContext * ctx, Tensor * dst,    \
+                               const Tensor* src);
+
+#define TENSOR_ARRAY_COPY_CPU(T) TENSOR_ARRAY_COPY(CPUDevice, T)
+TF_CALL_POD_TYPES(TENSOR_ARRAY_COPY_CPU)
+#undef TENSOR_ARRAY_COPY_CPU
+
+#if GOOGLE_CUDA
+
+#define TENSOR_ARRAY_COPY_GPU(T) TENSOR_ARRAY_COPY(GPUDevice, T)
+TF_CALL_GPU_NUMBER_TYPES(TENSOR_ARRAY_COPY_GPU);
+TF_CALL_complex64(TENSOR_ARRAY_COPY_GPU);
+TF_CALL_complex128(TENSOR_ARRAY_COPY_GPU);
+#undef TENSOR_ARRAY_COPY_GPU
+
+#endif  // GOOGLE_CUDA
+
+#undef TENSOR_ARRAY_COPY
+
 }  // namespace tensor_array
 
 // The TensorArray object keeps an array of PersistentTensors.  It
@@ -114,6 +142,14 @@ TF_CALL_complex128(TENSOR_ARRAY_SET_ZERO_GPU);
 //     All operations on a TensorArray are thread-safe.
 //   * A TensorArray may be preemptively closed, which releases all
 //     memory associated with it.
+//   * A contiguous TensorArray stores its elements as views into one
+//     buffer of shape [N] + element_shape.  Writes are copied into the
+//     buffer, a scatter or split of a whole array into an empty one adopts
+//     the written Tensor as the buffer, and stacking, gathering or
+//     concatenating consecutive elements returns a view of the buffer
+//     instead of a copy.  A TensorArray that asks to be contiguous but has
+//     a dynamic size, a non-POD dtype, or an element shape that is not
+//     fully defined by its first write stores its elements separately.
 //
 // These properties together allow the TensorArray to work as a
 // functional object and makes gradient computation easy.  For
@@ -140,7 +176,7 @@ class TensorArray : public ResourceBase {
               int32 N, const PartialTensorShape& element_shape,
               bool identical_element_shapes, bool dynamic_size,
               bool multiple_writes_aggregate, bool is_grad, int32 marked_size,
-              bool clear_after_read)
+              bool clear_after_read, bool contiguous)
       : key_(key),
         dtype_(dtype),
         handle_(handle),
@@ -153,6 +189,8 @@ class TensorArray : public ResourceBase {
         marked_size_(marked_size),
         element_shape_(element_shape),
         identical_element_shapes_(identical_element_shapes),
+        contiguous_(contiguous && !dynamic_size && !multiple_writes_aggregate &&
+                    DataTypeCanUseMemcpy(dtype)),
         tensors_(N) {}
 
   // Write PersistentTensor 'value' to index 'index'.
@@ -242,6 +280,48 @@ class TensorArray : public ResourceBase {
     return Status::OK();
   }
 
+  // Write the elements of 'value', which has shape [n] + element_shape,
+  // to the indices [first_index, first_index + n) of a contiguous
+  // TensorArray with a single copy, or without one when 'value' becomes the
+  // buffer of an empty array.
+  //
+  // Sets '*written' to false without writing anything when the TensorArray
+  // is not contiguous or any of the writes would fail; WriteOrAggregateMany
+  // then performs them one by one and reports the errors.
+  template <typename Device, typename T>
+  Status WriteContiguous(OpKernelContext* ctx, const int32 first_index,
+                         const Tensor& value, bool* written) {
+    mutex_lock l(mu_);
+    return LockedWriteContiguous<Device, T>(ctx, first_index, value, written);
+  }
+
+  // Read the elements at the indices [first_index, first_index + n) of a
+  // contiguous TensorArray like ReadMany, and set '*value' to a view of
+  // them in the buffer, of shape [n] + element_shape.
+  //
+  // Sets '*read' to false without reading anything when the TensorArray is
+  // not contiguous or the indices are out of range.
+  template <typename Device, typename T>
+  Status ReadContiguous(OpKernelContext* ctx, const int32 first_index,
+                        const int32 n, Tensor* value, bool* read) {
+    mutex_lock l(mu_);
+    *read = false;
+    TF_RETURN_IF_ERROR(LockedReturnIfClosed());
+    if (first_index < 0 || n <= 0 ||
+        static_cast<size_t>(first_index) + n > tensors_.size()) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(LockedMaybeAllocateBuffer(ctx));
+    if (!contiguous_) return Status::OK();
+    for (int32 i = first_index; i < first_index + n; ++i) {
+      PersistentTensor unused;
+      TF_RETURN_IF_ERROR(LockedRead<Device, T>(ctx, i, &unused));
+    }
+    *value = buffer_.AccessTensor(ctx)->Slice(first_index, first_index + n);
+    *read = true;
+    return Status::OK();
+  }
+
   DataType ElemType() const { return dtype_; }
 
   PartialTensorShape ElemShape() {
@@ -337,6 +417,7 @@ class TensorArray : public ResourceBase {
   void ClearAndMarkClosed() {
     mutex_lock l(mu_);
     tensors_.clear();
+    buffer_ = PersistentTensor();
     closed_ = true;
   }
 
@@ -356,10 +437,31 @@ class TensorArray : public ResourceBase {
                                 PersistentTensor* value)
       EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  template <typename Device, typename T>
+  Status LockedWriteContiguous(OpKernelContext* ctx, const int32 first_index,
+                               const Tensor& value, bool* written)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   template <typename Device, typename T>
   Status LockedRead(OpKernelContext* ctx, const int32 index,
                     PersistentTensor* value) EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns true if the elements may be stored in a buffer, which requires
+  // a fully defined element shape whose views into the buffer stay aligned,
+  // and sets '*shape' to that element shape.
+  bool LockedBufferElementShape(TensorShape* shape) const
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Allocates the buffer of a contiguous TensorArray on its first write or
+  // read, or stops it from being contiguous if the elements may not be
+  // stored in a buffer.
+  Status LockedMaybeAllocateBuffer(OpKernelContext* ctx)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the view of the element at 'index' in the buffer.
+  Tensor LockedElementView(OpKernelContext* ctx, const int32 index)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Status LockedReturnIfClosed() const EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     if (closed_) {
       return errors::InvalidArgument("TensorArray ", handle_.vec<string>()(1),
@@ -411,6 +513,16 @@ class TensorArray : public ResourceBase {
   // was not fully defined.
   const bool identical_element_shapes_;
 
+  // Whether the elements are stored as views into buffer_.  Once an element
+  // is stored, this no longer changes.
+  bool contiguous_ GUARDED_BY(mu_);
+
+  // The buffer of shape [N] + element_shape_ of a contiguous TensorArray.
+  // Allocated on the first write or read.  Elements read with
+  // clear_after_read = true keep their part of it until the TensorArray is
+  // closed.
+  PersistentTensor buffer_ GUARDED_BY(mu_);
+
   // TensorAndState is used to keep track of the PersistentTensors
   // stored in the TensorArray, along with their shapes, and a boolean
   // that determines whether they have already been read or not.
@@ -533,13 +645,70 @@ Status TensorArray::LockedWriteOrAggregate(OpKernelContext* ctx,
     // TensorArray.
     gradients_disallowed_ = true;
   } else {
-    t.tensor = *value;
+    TF_RETURN_IF_ERROR(LockedMaybeAllocateBuffer(ctx));
+    if (contiguous_) {
+      Tensor view = LockedElementView(ctx, index);
+      TF_RETURN_IF_ERROR(
+          tensor_array::TensorCopy<Device, T>(ctx, &view, value_t));
+      t.tensor = PersistentTensor(view);
+    } else {
+      t.tensor = *value;
+    }
     t.shape = value_t->shape();
     t.written = true;
   }
   return Status::OK();
 }
 
+template <typename Device, typename T>
+Status TensorArray::LockedWriteContiguous(OpKernelContext* ctx,
+                                          const int32 first_index,
+                                          const Tensor& value, bool* written) {
+  *written = false;
+  TF_RETURN_IF_ERROR(LockedReturnIfClosed());
+  if (!contiguous_ || value.dtype() != dtype_ || value.dims() == 0) {
+    return Status::OK();
+  }
+  const int64 n = value.dim_size(0);
+  if (first_index < 0 || n == 0 ||
+      static_cast<size_t>(first_index) + n > tensors_.size()) {
+    return Status::OK();
+  }
+  for (int64 i = first_index; i < first_index + n; ++i) {
+    if (tensors_[i].written || tensors_[i].read) return Status::OK();
+  }
+  TensorShape element_shape(value.shape());
+  element_shape.RemoveDim(0);
+  if (!element_shape_.IsCompatibleWith(element_shape)) return Status::OK();
+  if (identical_element_shapes_ && !element_shape_.IsFullyDefined()) {
+    element_shape_ = PartialTensorShape(element_shape.dim_sizes());
+  }
+
+  TensorShape buffer_element_shape;
+  if (!buffer_.IsInitialized() && first_index == 0 &&
+      static_cast<size_t>(n) == tensors_.size() &&
+      value.IsAligned() && LockedBufferElementShape(&buffer_element_shape)) {
+    // Nothing else refers to the storage of an empty array, so 'value' can
+    // become the buffer.
+    buffer_ = PersistentTensor(value);
+  } else {
+    TF_RETURN_IF_ERROR(LockedMaybeAllocateBuffer(ctx));
+    if (!contiguous_) return Status::OK();
+    Tensor slice =
+        buffer_.AccessTensor(ctx)->Slice(first_index, first_index + n);
+    TF_RETURN_IF_ERROR(
+        tensor_array::TensorCopy<Device, T>(ctx, &slice, &value));
+  }
+  for (int64 i = first_index; i < first_index + n; ++i) {
+    TensorAndState& t = tensors_[i];
+    t.tensor = PersistentTensor(LockedElementView(ctx, i));
+    t.shape = element_shape;
+    t.written = true;
+  }
+  *written = true;
+  return Status::OK();
+}
+
 template <typename Device, typename T>
 Status TensorArray::LockedRead(OpKernelContext* ctx, const int32 index,
                                PersistentTensor* value) {
@@ -605,9 +774,15 @@ Status TensorArray::LockedRead(OpKernelContext* ctx, const int32 index,
   if (!t.tensor.IsInitialized() || t.tensor.NumElements() == 0) {
     // We stored just a shape, but no value.  This means create and
     // return zeros of the appropriate shape.
+    TF_RETURN_IF_ERROR(LockedMaybeAllocateBuffer(ctx));
     Tensor* tensor_t;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_persistent(dtype_, t.shape, &t.tensor, &tensor_t));
+    if (contiguous_) {
+      t.tensor = PersistentTensor(LockedElementView(ctx, index));
+      tensor_t = t.tensor.AccessTensor(ctx);
+    } else {
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_persistent(dtype_, t.shape, &t.tensor, &tensor_t));
+    }
     if (t.shape.num_elements() > 0) {
       Status s = tensor_array::TensorSetZero<Device, T>(ctx, tensor_t);
       if (!s.ok()) return s;
@@ -95,6 +95,15 @@ Status SetupFlowControlInputs(OpKernelContext* ctx, bool set_output) {
   return Status::OK();
 }
 
+// Returns true if 'indices' are n consecutive increasing indices, which a
+// contiguous TensorArray can read or write as one slice of its buffer.
+bool IsConsecutive(const std::vector<int32>& indices) {
+  for (size_t i = 1; i < indices.size(); ++i) {
+    if (indices[i] != indices[0] + static_cast<int32>(i)) return false;
+  }
+  return !indices.empty();
+}
+
 // CREATION *******************************************************************
 
 // Virtual class for shared behavior between TensorArrayOp and
@@ -172,6 +181,11 @@ class TensorArrayOp : public TensorArrayCreationOp {
     }
     OP_REQUIRES_OK(context,
                    context->GetAttr("clear_after_read", &clear_after_read_));
+    if (context->HasAttr("contiguous")) {
+      OP_REQUIRES_OK(context, context->GetAttr("contiguous", &contiguous_));
+    } else {
+      contiguous_ = false;
+    }
     OP_REQUIRES_OK(context,
                    context->GetAttr("tensor_array_name", &tensor_array_name_));
     if (tensor_array_name_.empty()) tensor_array_name_ = name();
@@ -206,7 +220,7 @@ class TensorArrayOp : public TensorArrayCreationOp {
         key, dtype_, *tensor_array_output_handle, size, element_shape_,
         identical_element_shapes_, dynamic_size_,
         false /* multiple_writes_aggregate */, false /* is_grad */,
-        -1 /* marked_size */, clear_after_read_);
+        -1 /* marked_size */, clear_after_read_, contiguous_);
 
     TF_RETURN_IF_ERROR(
         rm->Create(ctx->step_container()->name(), key, tensor_array));
@@ -222,6 +236,7 @@ class TensorArrayOp : public TensorArrayCreationOp {
   bool identical_element_shapes_;
   bool dynamic_size_;
   bool clear_after_read_;
+  bool contiguous_;
   string tensor_array_name_;  // The name used to create the TensorArray.
 
   TF_DISALLOW_COPY_AND_ASSIGN(TensorArrayOp);
@@ -335,7 +350,8 @@ class TensorArrayGradOp : public TensorArrayCreationOp {
           array_size, tensor_array->ElemShape(),
           tensor_array->HasIdenticalElementShapes(), false /* dynamic_size */,
           true /* multiple_writes_aggregate */, true /* is_grad */,
-          marked_size /* marked_size */, true /* close_after_read */);
+          marked_size /* marked_size */, true /* close_after_read */,
+          false /* contiguous */);
       TF_RETURN_IF_ERROR((*ret)->CopyShapesFrom(tensor_array));
       return Status::OK();
     };
@@ -623,6 +639,19 @@ class TensorArrayPackOrGatherOp : public OpKernel {
       return;
     }
 
+    // A contiguous TensorArray returns consecutive elements as a view of its
+    // buffer, without copying them.
+    if (IsConsecutive(indices)) {
+      Tensor value;
+      bool read = false;
+      OP_REQUIRES_OK(ctx, tensor_array->ReadContiguous<Device, T>(
+                              ctx, indices[0], num_indices, &value, &read));
+      if (read) {
+        ctx->set_output(0, value);
+        return;
+      }
+    }
+
     // Read all the PersistentTensors into a vector to keep track of
     // their memory.
     Status s = tensor_array->ReadMany<Device, T>(ctx, indices, &values);
@@ -829,6 +858,41 @@ class TensorArrayConcatOp : public OpKernel {
       return;
     }
 
+    // A contiguous TensorArray of elements that are at least vectors returns
+    // their concatenation as a view of its buffer, without copying them.
+    Tensor contiguous_value;
+    bool read = false;
+    OP_REQUIRES_OK(ctx, tensor_array->ReadContiguous<Device, T>(
+                            ctx, 0, array_size, &contiguous_value, &read));
+    if (read && contiguous_value.dims() > 1) {
+      TensorShape output_shape_except0(contiguous_value.shape());
+      output_shape_except0.RemoveDim(0);
+      const int64 length = output_shape_except0.dim_size(0);
+      output_shape_except0.RemoveDim(0);
+      OP_REQUIRES(
+          ctx, element_shape_except0_.IsCompatibleWith(output_shape_except0),
+          errors::InvalidArgument(
+              "TensorArray was passed element_shape_except0 ",
+              element_shape_except0_.DebugString(),
+              " but index 0 has (excepting dimension 0) shape: ",
+              output_shape_except0.DebugString(), " which does not match."));
+      TensorShape output_shape(output_shape_except0);
+      output_shape.InsertDim(0, array_size * length);
+      Tensor output;
+      CHECK(output.CopyFrom(contiguous_value, output_shape));
+      ctx->set_output(0, output);
+      Tensor* lengths_tensor = nullptr;
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({array_size}),
+                                               &lengths_tensor));
+      lengths_tensor->vec<int64>().setConstant(length);
+      return;
+    }
+    OP_REQUIRES(
+        ctx, !read,
+        errors::InvalidArgument(
+            "Concat saw a scalar shape at index 0",
+            " but requires at least vectors.  Did you mean to call pack?"));
+
     // Read all the PersistentTensors into a vector to keep track of
     // their memory.
     std::vector<PersistentTensor> values;
@@ -1086,6 +1150,20 @@ class TensorArrayUnpackOrScatterOp : public OpKernel {
     }
     element_shape.RemoveDim(0);
 
+    // Record the pack size of the TensorArray.
+    if (LEGACY_UNPACK) {
+      OP_REQUIRES_OK(ctx, tensor_array->SetMarkedSize(array_size));
+    }
+
+    // A contiguous TensorArray takes consecutive elements with a single
+    // copy into its buffer.
+    if (IsConsecutive(write_indices)) {
+      bool written = false;
+      OP_REQUIRES_OK(ctx, tensor_array->WriteContiguous<Device, T>(
+                              ctx, write_indices[0], *tensor_value, &written));
+      if (written) return;
+    }
+
     auto tensor_value_t = tensor_value->shaped<T, 3>(
         {1, num_values, element_shape.num_elements()});
 
@@ -1115,11 +1193,6 @@ class TensorArrayUnpackOrScatterOp : public OpKernel {
       write_values.push_back(persistent_tensor);
     }
 
-    // Record the pack size of the TensorArray.
-    if (LEGACY_UNPACK) {
-      OP_REQUIRES_OK(ctx, tensor_array->SetMarkedSize(array_size));
-    }
-
     Status s = tensor_array->WriteOrAggregateMany<Device, T>(ctx, write_indices,
                                                              &write_values);
     OP_REQUIRES_OK(ctx, s);
@@ -1275,6 +1348,26 @@ class TensorArraySplitOp : public OpKernel {
                                 " but Op is trying to write dtype ",
                                 DataTypeString(tensor_value->dtype()), "."));
 
+    // Record the concat size of the TensorArray.
+    OP_REQUIRES_OK(ctx, tensor_array->SetMarkedSize(array_size));
+
+    // A contiguous TensorArray takes elements of equal lengths with a single
+    // copy into its buffer.
+    bool equal_lengths = num_tensors > 0 && total_length > 0;
+    for (int32 i = 1; equal_lengths && i < num_tensors; ++i) {
+      equal_lengths = tensor_lengths_t(i) == tensor_lengths_t(0);
+    }
+    if (equal_lengths) {
+      TensorShape elements_shape(element_shapes[0]);
+      elements_shape.InsertDim(0, num_tensors);
+      Tensor elements;
+      CHECK(elements.CopyFrom(*tensor_value, elements_shape));
+      bool written = false;
+      OP_REQUIRES_OK(ctx, tensor_array->WriteContiguous<Device, T>(
+                              ctx, 0, elements, &written));
+      if (written) return;
+    }
+
     auto tensor_value_t =
         tensor_value->shaped<T, 3>({1, total_length, elements_per_row});
 
@@ -1306,9 +1399,6 @@ class TensorArraySplitOp : public OpKernel {
       write_values.push_back(persistent_tensor);
     }
 
-    // Record the concat size of the TensorArray.
-    OP_REQUIRES_OK(ctx, tensor_array->SetMarkedSize(array_size));
-
     std::vector<int32> indices(array_size);
     std::iota(indices.begin(), indices.end(), 0);
 
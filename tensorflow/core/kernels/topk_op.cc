@@ -95,6 +95,65 @@ class TopK : public OpKernel {
   bool sorted_;
 };
 
+namespace {
+
+// Rows are reduced with std::nth_element rather than a TopN heap once k is
+// large, or once k is a large fraction of the row: the heap costs O(log k) for
+// every element that enters it, while the selection is linear in the row.
+constexpr int kMinSelectK = 1024;
+constexpr int64 kMaxHeapColsPerK = 16;
+
+// When there are fewer rows than threads, rows with at least this many columns
+// per thread are split into chunks that are reduced in parallel.
+constexpr int64 kMinColsPerChunk = 1 << 15;
+
+bool UseSelect(int k, int64 num_cols) {
+  return k >= kMinSelectK || k * kMaxHeapColsPerK >= num_cols;
+}
+
+// Reorders [begin, end) so that its first k elements are the greatest under
+// "comp", which must be a strict total order, and sorts them if "sorted".
+template <typename Comp>
+void SelectTopK(const Comp& comp, int k, bool sorted, int32* begin,
+                int32* end) {
+  if (begin + k < end) {
+    std::nth_element(begin, begin + k, end, comp);
+  }
+  if (sorted) {
+    std::sort(begin, begin + k, comp);
+  }
+}
+
+// Writes the k greatest indices in [col_begin, col_end) under "comp" to "out",
+// in order if "sorted". "scratch" is temporary storage.
+template <typename Comp>
+void FindTopK(const Comp& comp, int k, bool sorted, int32 col_begin,
+              int32 col_end, std::vector<int32>* scratch, int32* out) {
+  if (UseSelect(k, col_end - col_begin)) {
+    scratch->resize(col_end - col_begin);
+    std::iota(scratch->begin(), scratch->end(), col_begin);
+    SelectTopK(comp, k, sorted, scratch->data(),
+               scratch->data() + scratch->size());
+    std::copy(scratch->begin(), scratch->begin() + k, out);
+    return;
+  }
+
+  // Use the TopN heap object to sort.
+  gtl::TopN<int32, Comp> filter(k, comp);
+  filter.reserve(col_end - col_begin);
+  for (int32 c = col_begin; c < col_end; ++c) {
+    filter.push(c);
+  }
+  if (sorted) {
+    std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
+    std::copy(top_k->begin(), top_k->end(), out);
+  } else {
+    std::copy(filter.unsorted_begin(), filter.unsorted_end(), out);
+  }
+}
+
+}  // namespace
+
 namespace functor {
 
 template <typename T>
@@ -132,26 +191,68 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    // Orders indices by decreasing value, breaking ties by increasing index.
+    const auto make_stable_comp = [&input](int32 b) {
+      const T* input_data = &input(b, 0);
+      return [input_data](const int32 a, const int32 b) {
+        if (input_data[b] < input_data[a]) {
+          return true;
+        } else if (input_data[b] > input_data[a]) {
+          return false;
+        } else {
+          return a < b;
+        }
+      };
+    };
+
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64 num_chunks = std::min<int64>(worker_threads.num_threads,
+                                             num_cols / kMinColsPerChunk);
+    if (num_rows < worker_threads.num_threads && num_chunks > 1 &&
+        num_chunks * k <= num_cols / 2) {
+      // Too few rows to keep the threads busy. Each chunk of a row finds its
+      // own top k, and the top k of the row are selected from those.
+      std::vector<int32> candidates(num_rows * num_chunks * k);
+      auto FindChunkTopK = [&](int64 start, int64 limit) {
+        std::vector<int32> scratch;
+        for (int64 i = start; i < limit; ++i) {
+          const int64 b = i / num_chunks;
+          const int64 chunk = i % num_chunks;
+          const int32 col_begin = chunk * num_cols / num_chunks;
+          const int32 col_end = (chunk + 1) * num_cols / num_chunks;
+          FindTopK(make_stable_comp(b), k, /*sorted=*/false, col_begin, col_end,
+                   &scratch, &candidates[i * k]);
+        }
+      };
+      const double chunk_cost =
+          4 * num_cols / num_chunks *
+          (3 * Eigen::TensorOpCost::AddCost<int32>() +
+           Eigen::TensorOpCost::AddCost<T>());
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            num_rows * num_chunks, static_cast<int64>(chunk_cost),
+            FindChunkTopK, context->cancellation_manager());
+      if (context->IsCancelled()) {
+        return errors::Cancelled("TopK was cancelled");
+      }
+      for (int64 b = 0; b < num_rows; ++b) {
+        int32* begin = &candidates[b * num_chunks * k];
+        SelectTopK(make_stable_comp(b), k, sorted, begin,
+                   begin + num_chunks * k);
+        for (int i = 0; i < k; ++i) {
+          indices(b, i) = begin[i];
+          values(b, i) = input(b, begin[i]);
+        }
+      }
+      return Status::OK();
+    }
+
     auto SortIndices = [&, context](int start_batch, int limit_batch) {
+      std::vector<int32> scratch;
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32 a, const int32 b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
-          }
-        };
         const auto comp = [input_data](const int32 a, const int32 b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -175,26 +276,8 @@ struct TopKFunctor<CPUDevice, T> {
             run_begin = run_end;
           }
         } else {
-          // Use the TopN heap object to sort.
-          gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
-          filter.reserve(num_cols);
-          for (int32 c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
-
-          int32 i = 0;
-          if (sorted) {
-            std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
-            for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
-                 ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          } else {
-            for (auto top_k_it = filter.unsorted_begin();
-                 top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          }
+          FindTopK(make_stable_comp(b), k, sorted, 0, num_cols, &scratch,
+                   &indices(b, 0));
         }
         // Now that the indices are sorted, copy the values over in
         // sorted order.
@@ -217,9 +300,11 @@ struct TopKFunctor<CPUDevice, T> {
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
-          final_cost, SortIndices);
+          final_cost, SortIndices, context->cancellation_manager());
+    if (context->IsCancelled()) {
+      return errors::Cancelled("TopK was cancelled");
+    }
 
     return Status::OK();
   }
@@ -41,6 +41,28 @@ inline T sgn(const T x) {
   T one(1);
   return (x == zero ? zero : (x < zero ? -one : one));
 }
+
+// The CPU MultiApplyXYZ functors split their variables into blocks of at most
+// kMultiApplyBlockSize elements, so that a few large variables and many small
+// ones are both spread evenly over the threads.
+constexpr int64 kMultiApplyBlockSize = 4096;
+
+struct MultiApplyBlock {
+  int tensor;
+  int64 begin;
+  int64 end;
+};
+
+std::vector<MultiApplyBlock> MultiApplyBlocks(const std::vector<int64>& sizes) {
+  std::vector<MultiApplyBlock> blocks;
+  for (int i = 0; i < sizes.size(); ++i) {
+    for (int64 begin = 0; begin < sizes[i]; begin += kMultiApplyBlockSize) {
+      blocks.push_back(
+          {i, begin, std::min(begin + kMultiApplyBlockSize, sizes[i])});
+    }
+  }
+  return blocks;
+}
 }  // namespace
 
 namespace functor {
@@ -328,6 +350,74 @@ struct ApplyAdamSYCL {
 template <typename T>
 struct ApplyAdam<CPUDevice, T> : ApplyAdamNonCuda<CPUDevice, T> {};
 
+template <typename T>
+struct MultiApplyMomentum<CPUDevice, T> {
+  void operator()(const CPUDevice& d, const std::vector<T*>& var,
+                  const std::vector<T*>& accum,
+                  const std::vector<const T*>& grad,
+                  const std::vector<int64>& sizes,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar momentum, bool use_nesterov) {
+    const std::vector<MultiApplyBlock> blocks = MultiApplyBlocks(sizes);
+    const T lr_value = lr();
+    const T momentum_value = momentum();
+    const Eigen::TensorOpCost cost(3 * sizeof(T) * kMultiApplyBlockSize,
+                                   2 * sizeof(T) * kMultiApplyBlockSize,
+                                   5 * kMultiApplyBlockSize);
+    d.parallelFor(blocks.size(), cost, [&](Eigen::Index first,
+                                           Eigen::Index last) {
+      for (Eigen::Index b = first; b < last; ++b) {
+        const MultiApplyBlock& block = blocks[b];
+        T* var_data = var[block.tensor];
+        T* accum_data = accum[block.tensor];
+        const T* grad_data = grad[block.tensor];
+        for (int64 i = block.begin; i < block.end; ++i) {
+          MomentumUpdate(var_data + i, accum_data + i, grad_data[i], lr_value,
+                         momentum_value, use_nesterov);
+        }
+      }
+    });
+  }
+};
+
+template <typename T>
+struct MultiApplyAdam<CPUDevice, T> {
+  void operator()(const CPUDevice& d, const std::vector<T*>& var,
+                  const std::vector<T*>& m, const std::vector<T*>& v,
+                  const std::vector<const T*>& grad,
+                  const std::vector<int64>& sizes,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon, bool use_nesterov) {
+    const std::vector<MultiApplyBlock> blocks = MultiApplyBlocks(sizes);
+    const T alpha = lr() * Eigen::numext::sqrt(T(1) - beta2_power()) /
+                    (T(1) - beta1_power());
+    const T beta1_value = beta1();
+    const T beta2_value = beta2();
+    const T epsilon_value = epsilon();
+    const Eigen::TensorOpCost cost(4 * sizeof(T) * kMultiApplyBlockSize,
+                                   3 * sizeof(T) * kMultiApplyBlockSize,
+                                   15 * kMultiApplyBlockSize);
+    d.parallelFor(blocks.size(), cost, [&](Eigen::Index first,
+                                           Eigen::Index last) {
+      for (Eigen::Index b = first; b < last; ++b) {
+        const MultiApplyBlock& block = blocks[b];
+        T* var_data = var[block.tensor];
+        T* m_data = m[block.tensor];
+        T* v_data = v[block.tensor];
+        const T* grad_data = grad[block.tensor];
+        for (int64 i = block.begin; i < block.end; ++i) {
+          AdamUpdate(var_data + i, m_data + i, v_data + i, grad_data[i], alpha,
+                     beta1_value, beta2_value, epsilon_value, use_nesterov);
+        }
+      }
+    });
+  }
+};
+
 template <typename T>
 struct ApplyRMSProp<CPUDevice, T> {
   void operator()(const CPUDevice& d, typename TTypes<T>::Flat var,
@@ -2362,6 +2452,149 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+namespace {
+
+// Returns the input ids of the "name" input list of a ResourceMultiApplyXYZ
+// op.
+std::vector<int> MultiApplyInputIds(OpKernelContext* ctx, StringPiece name) {
+  int start, stop;
+  std::vector<int> ids;
+  if (ctx->op_kernel().InputRange(name, &start, &stop).ok()) {
+    for (int i = start; i < stop; ++i) ids.push_back(i);
+  }
+  return ids;
+}
+
+// Gets the variables of the "name" input list of a ResourceMultiApplyXYZ op,
+// which must be initialized and have the shapes of the gradients in "grad".
+// The tensors are added to "tensors", which keeps their buffers alive while
+// the update runs, and their data to "data".
+template <typename Device, typename T>
+Status GetMultiApplyVariables(OpKernelContext* ctx, StringPiece name,
+                              bool lock_held, const OpInputList& grad,
+                              std::vector<Tensor>* tensors,
+                              std::vector<T*>* data) {
+  const std::vector<int> ids = MultiApplyInputIds(ctx, name);
+  for (int i = 0; i < ids.size(); ++i) {
+    Tensor var;
+    TF_RETURN_IF_ERROR(GetInputTensorFromVariable<Device, T>(
+        ctx, ids[i], lock_held, false, &var));
+    if (!var.IsInitialized()) {
+      return errors::FailedPrecondition(
+          "Attempting to use uninitialized variables: ",
+          ctx->op_kernel().requested_input(ids[i]));
+    }
+    if (!var.shape().IsSameSize(grad[i].shape())) {
+      return errors::InvalidArgument(name, "[", i, "] and grad[", i,
+                                     "] do not have the same shape",
+                                     var.shape().DebugString(), " ",
+                                     grad[i].shape().DebugString());
+    }
+    tensors->push_back(var);
+    data->push_back(var.flat<T>().data());
+  }
+  return Status::OK();
+}
+
+// Returns the data and sizes of the gradients of a ResourceMultiApplyXYZ op.
+template <typename T>
+void GetMultiApplyGradients(const OpInputList& grad,
+                            std::vector<const T*>* data,
+                            std::vector<int64>* sizes) {
+  for (int i = 0; i < grad.size(); ++i) {
+    data->push_back(grad[i].flat<T>().data());
+    sizes->push_back(grad[i].NumElements());
+  }
+}
+
+}  // namespace
+
+template <typename Device, typename T>
+class MultiApplyMomentumOp : public OpKernel {
+ public:
+  explicit MultiApplyMomentumOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    std::vector<int> var_ids = MultiApplyInputIds(ctx, "var");
+    const std::vector<int> accum_ids = MultiApplyInputIds(ctx, "accum");
+    var_ids.insert(var_ids.end(), accum_ids.begin(), accum_ids.end());
+    auto locks =
+        MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_, var_ids);
+
+    OpInputList grad;
+    OP_REQUIRES_OK(ctx, ctx->input_list("grad", &grad));
+    std::vector<Tensor> tensors;
+    std::vector<T*> var;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<Device, T>(
+                            ctx, "var", use_exclusive_lock_, grad, &tensors,
+                            &var));
+    std::vector<T*> accum;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<Device, T>(
+                            ctx, "accum", use_exclusive_lock_, grad, &tensors,
+                            &accum));
+    const Tensor& lr = ctx->input(2 * grad.size());
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    const Tensor& momentum = ctx->input(3 * grad.size() + 1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(momentum.shape()),
+                errors::InvalidArgument("momentum is not a scalar: ",
+                                        momentum.shape().DebugString()));
+
+    std::vector<const T*> grad_data;
+    std::vector<int64> sizes;
+    GetMultiApplyGradients<T>(grad, &grad_data, &sizes);
+    const Device& device = ctx->template eigen_device<Device>();
+    functor::MultiApplyMomentum<Device, T>()(
+        device, var, accum, grad_data, sizes, lr.scalar<T>(),
+        momentum.scalar<T>(), use_nesterov_);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                               \
+  REGISTER_KERNEL_BUILDER(Name("ResourceMultiApplyMomentum") \
+                              .Device(DEVICE_##D)            \
+                              .HostMemory("var")             \
+                              .HostMemory("accum")           \
+                              .TypeConstraint<T>("T"),       \
+                          MultiApplyMomentumOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                                 \
+  template <>                                                               \
+  void MultiApplyMomentum<GPUDevice, T>::operator()(                        \
+      const GPUDevice& d, const std::vector<T*>& var,                       \
+      const std::vector<T*>& accum, const std::vector<const T*>& grad,      \
+      const std::vector<int64>& sizes, typename TTypes<T>::ConstScalar lr,  \
+      typename TTypes<T>::ConstScalar momentum, bool use_nesterov);         \
+  extern template struct MultiApplyMomentum<GPUDevice, T>;
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 // Note, this op works on cpu only.
 template <typename T, typename Tindex>
 class SparseApplyMomentumOp : public OpKernel {
@@ -2740,6 +2973,121 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+template <typename Device, typename T>
+class MultiApplyAdamOp : public OpKernel {
+ public:
+  explicit MultiApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    std::vector<int> var_ids = MultiApplyInputIds(ctx, "var");
+    for (const char* name : {"m", "v"}) {
+      const std::vector<int> ids = MultiApplyInputIds(ctx, name);
+      var_ids.insert(var_ids.end(), ids.begin(), ids.end());
+    }
+    auto locks =
+        MaybeLockVariableInputMutexesInOrder(ctx, use_exclusive_lock_, var_ids);
+
+    OpInputList grad;
+    OP_REQUIRES_OK(ctx, ctx->input_list("grad", &grad));
+    std::vector<Tensor> tensors;
+    std::vector<T*> var;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<Device, T>(
+                            ctx, "var", use_exclusive_lock_, grad, &tensors,
+                            &var));
+    std::vector<T*> m;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<Device, T>(
+                            ctx, "m", use_exclusive_lock_, grad, &tensors, &m));
+    std::vector<T*> v;
+    OP_REQUIRES_OK(ctx, GetMultiApplyVariables<Device, T>(
+                            ctx, "v", use_exclusive_lock_, grad, &tensors, &v));
+
+    const int scalars = 3 * grad.size();
+    const Tensor& beta1_power = ctx->input(scalars);
+    const Tensor& beta2_power = ctx->input(scalars + 1);
+    const Tensor& lr = ctx->input(scalars + 2);
+    const Tensor& beta1 = ctx->input(scalars + 3);
+    const Tensor& beta2 = ctx->input(scalars + 4);
+    const Tensor& epsilon = ctx->input(scalars + 5);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1_power.shape()),
+                errors::InvalidArgument("beta1_power is not a scalar: ",
+                                        beta1_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2_power.shape()),
+                errors::InvalidArgument("beta2_power is not a scalar: ",
+                                        beta2_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar : ",
+                                        lr.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1.shape()),
+                errors::InvalidArgument("beta1 is not a scalar: ",
+                                        beta1.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2.shape()),
+                errors::InvalidArgument("beta2 is not a scalar: ",
+                                        beta2.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+
+    std::vector<const T*> grad_data;
+    std::vector<int64> sizes;
+    GetMultiApplyGradients<T>(grad, &grad_data, &sizes);
+    const Device& device = ctx->template eigen_device<Device>();
+    functor::MultiApplyAdam<Device, T>()(
+        device, var, m, v, grad_data, sizes, beta1_power.scalar<T>(),
+        beta2_power.scalar<T>(), lr.scalar<T>(), beta1.scalar<T>(),
+        beta2.scalar<T>(), epsilon.scalar<T>(), use_nesterov_);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+#define REGISTER_KERNELS(D, T)                           \
+  REGISTER_KERNEL_BUILDER(Name("ResourceMultiApplyAdam") \
+                              .Device(DEVICE_##D)        \
+                              .HostMemory("var")         \
+                              .HostMemory("m")           \
+                              .HostMemory("v")           \
+                              .TypeConstraint<T>("T"),   \
+                          MultiApplyAdamOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA
+// Forward declarations of the functor specializations for GPU.
+namespace functor {
+#define DECLARE_GPU_SPEC(T)                                              \
+  template <>                                                            \
+  void MultiApplyAdam<GPUDevice, T>::operator()(                         \
+      const GPUDevice& d, const std::vector<T*>& var,                    \
+      const std::vector<T*>& m, const std::vector<T*>& v,                \
+      const std::vector<const T*>& grad, const std::vector<int64>& sizes, \
+      typename TTypes<T>::ConstScalar beta1_power,                       \
+      typename TTypes<T>::ConstScalar beta2_power,                       \
+      typename TTypes<T>::ConstScalar lr,                                \
+      typename TTypes<T>::ConstScalar beta1,                             \
+      typename TTypes<T>::ConstScalar beta2,                             \
+      typename TTypes<T>::ConstScalar epsilon, bool use_nesterov);       \
+  extern template struct MultiApplyAdam<GPUDevice, T>;
+DECLARE_GPU_SPEC(Eigen::half);
+DECLARE_GPU_SPEC(float);
+DECLARE_GPU_SPEC(double);
+#undef DECLARE_GPU_SPEC
+}  // namespace functor
+
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyRMSPropOp : public OpKernel {
  public:
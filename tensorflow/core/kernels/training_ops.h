@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_KERNELS_TRAINING_OPS_H_
 #define TENSORFLOW_KERNELS_TRAINING_OPS_H_
 
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/platform/types.h"
@@ -139,6 +141,61 @@ struct ApplyAdam {
                   typename TTypes<T>::ConstFlat grad, bool use_nesterov);
 };
 
+// The MultiApplyXYZ functors apply ApplyXYZ to a list of variables that share
+// the scalar hyperparameters, in as few device launches as possible. Entry i
+// of each vector describes the i-th variable, which has sizes[i] elements.
+template <typename Device, typename T>
+struct MultiApplyMomentum {
+  void operator()(const Device& d, const std::vector<T*>& var,
+                  const std::vector<T*>& accum,
+                  const std::vector<const T*>& grad,
+                  const std::vector<int64>& sizes,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar momentum, bool use_nesterov);
+};
+
+template <typename Device, typename T>
+struct MultiApplyAdam {
+  void operator()(const Device& d, const std::vector<T*>& var,
+                  const std::vector<T*>& m, const std::vector<T*>& v,
+                  const std::vector<const T*>& grad,
+                  const std::vector<int64>& sizes,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon, bool use_nesterov);
+};
+
+// Element-wise updates shared by the CPU and GPU MultiApplyXYZ functors.
+template <typename T>
+EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE void MomentumUpdate(
+    T* var, T* accum, const T grad, const T lr, const T momentum,
+    bool use_nesterov) {
+  *accum = *accum * momentum + grad;
+  if (use_nesterov) {
+    *var -= grad * lr + *accum * momentum * lr;
+  } else {
+    *var -= *accum * lr;
+  }
+}
+
+// "alpha" is lr * sqrt(1 - beta2^t) / (1 - beta1^t).
+template <typename T>
+EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE void AdamUpdate(
+    T* var, T* m, T* v, const T grad, const T alpha, const T beta1,
+    const T beta2, const T epsilon, bool use_nesterov) {
+  *m += (grad - *m) * (T(1) - beta1);
+  *v += (grad * grad - *v) * (T(1) - beta2);
+  if (use_nesterov) {
+    *var -= ((grad * (T(1) - beta1) + beta1 * *m) * alpha) /
+            (Eigen::numext::sqrt(*v) + epsilon);
+  } else {
+    *var -= (*m * alpha) / (Eigen::numext::sqrt(*v) + epsilon);
+  }
+}
+
 template <typename Device, typename T>
 struct ApplyRMSProp {
   void operator()(const Device& d, typename TTypes<T>::Flat var,
@@ -17,13 +17,101 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <algorithm>
+
 #include "tensorflow/core/kernels/training_ops.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
 
 namespace tensorflow {
 
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// The MultiApplyXYZ kernels update up to kMaxTensorsPerLaunch variables per
+// launch. Their pointers are passed by value in the kernel arguments, which
+// must not exceed 4KB.
+constexpr int kMaxTensorsPerLaunch = 32;
+
+template <typename T>
+struct MultiApplyArgs {
+  T* var[kMaxTensorsPerLaunch];
+  T* slot1[kMaxTensorsPerLaunch];
+  T* slot2[kMaxTensorsPerLaunch];
+  const T* grad[kMaxTensorsPerLaunch];
+  int64 size[kMaxTensorsPerLaunch];
+};
+
+// Row blockIdx.y of the grid updates the variable args.var[blockIdx.y].
+template <typename T>
+__global__ void MultiApplyMomentumKernel(MultiApplyArgs<T> args, const T* lr,
+                                         const T* momentum,
+                                         bool use_nesterov) {
+  const int t = blockIdx.y;
+  const T lr_value = ldg(lr);
+  const T momentum_value = ldg(momentum);
+  T* var = args.var[t];
+  T* accum = args.slot1[t];
+  const T* grad = args.grad[t];
+  for (int64 i = blockIdx.x * blockDim.x + threadIdx.x; i < args.size[t];
+       i += gridDim.x * blockDim.x) {
+    functor::MomentumUpdate(var + i, accum + i, ldg(grad + i), lr_value,
+                            momentum_value, use_nesterov);
+  }
+}
+
+template <typename T>
+__global__ void MultiApplyAdamKernel(MultiApplyArgs<T> args,
+                                     const T* beta1_power,
+                                     const T* beta2_power, const T* lr,
+                                     const T* beta1, const T* beta2,
+                                     const T* epsilon, bool use_nesterov) {
+  const int t = blockIdx.y;
+  const T one(1);
+  const T alpha = ldg(lr) * Eigen::numext::sqrt(one - ldg(beta2_power)) /
+                  (one - ldg(beta1_power));
+  const T beta1_value = ldg(beta1);
+  const T beta2_value = ldg(beta2);
+  const T epsilon_value = ldg(epsilon);
+  T* var = args.var[t];
+  T* m = args.slot1[t];
+  T* v = args.slot2[t];
+  const T* grad = args.grad[t];
+  for (int64 i = blockIdx.x * blockDim.x + threadIdx.x; i < args.size[t];
+       i += gridDim.x * blockDim.x) {
+    functor::AdamUpdate(var + i, m + i, v + i, ldg(grad + i), alpha,
+                        beta1_value, beta2_value, epsilon_value, use_nesterov);
+  }
+}
+
+// Fills "args" with the variables [start, start + *num) and returns the launch
+// config of one grid row, which is sized for the largest of them. The blocks
+// of rows with smaller variables exit early.
+template <typename T>
+CudaLaunchConfig MultiApplyLaunch(const GPUDevice& d,
+                                  const std::vector<T*>& var,
+                                  const std::vector<T*>& slot1,
+                                  const std::vector<T*>& slot2,
+                                  const std::vector<const T*>& grad,
+                                  const std::vector<int64>& sizes, int start,
+                                  int* num, MultiApplyArgs<T>* args) {
+  *num = std::min<int>(kMaxTensorsPerLaunch, sizes.size() - start);
+  int64 max_size = 1;
+  for (int t = 0; t < *num; ++t) {
+    args->var[t] = var[start + t];
+    args->slot1[t] = slot1[start + t];
+    args->slot2[t] = slot2.empty() ? nullptr : slot2[start + t];
+    args->grad[t] = grad[start + t];
+    args->size[t] = sizes[start + t];
+    max_size = std::max(max_size, sizes[start + t]);
+  }
+  return GetCudaLaunchConfig(
+      static_cast<int>(std::min<int64>(max_size, kint32max)), d);
+}
+
+}  // namespace
+
 namespace functor {
 template <typename T>
 struct ApplyGradientDescent<GPUDevice, T> {
@@ -144,6 +232,52 @@ struct ApplyAdam<GPUDevice, T> {
   }
 };
 
+template <typename T>
+struct MultiApplyMomentum<GPUDevice, T> {
+  void operator()(const GPUDevice& d, const std::vector<T*>& var,
+                  const std::vector<T*>& accum,
+                  const std::vector<const T*>& grad,
+                  const std::vector<int64>& sizes,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar momentum, bool use_nesterov) {
+    for (int start = 0; start < sizes.size(); start += kMaxTensorsPerLaunch) {
+      MultiApplyArgs<T> args;
+      int num;
+      const CudaLaunchConfig config = MultiApplyLaunch<T>(
+          d, var, accum, {}, grad, sizes, start, &num, &args);
+      MultiApplyMomentumKernel<T>
+          <<<dim3(config.block_count, num), config.thread_per_block, 0,
+             d.stream()>>>(args, lr.data(), momentum.data(), use_nesterov);
+    }
+  }
+};
+
+template <typename T>
+struct MultiApplyAdam<GPUDevice, T> {
+  void operator()(const GPUDevice& d, const std::vector<T*>& var,
+                  const std::vector<T*>& m, const std::vector<T*>& v,
+                  const std::vector<const T*>& grad,
+                  const std::vector<int64>& sizes,
+                  typename TTypes<T>::ConstScalar beta1_power,
+                  typename TTypes<T>::ConstScalar beta2_power,
+                  typename TTypes<T>::ConstScalar lr,
+                  typename TTypes<T>::ConstScalar beta1,
+                  typename TTypes<T>::ConstScalar beta2,
+                  typename TTypes<T>::ConstScalar epsilon, bool use_nesterov) {
+    for (int start = 0; start < sizes.size(); start += kMaxTensorsPerLaunch) {
+      MultiApplyArgs<T> args;
+      int num;
+      const CudaLaunchConfig config =
+          MultiApplyLaunch<T>(d, var, m, v, grad, sizes, start, &num, &args);
+      MultiApplyAdamKernel<T>
+          <<<dim3(config.block_count, num), config.thread_per_block, 0,
+             d.stream()>>>(args, beta1_power.data(), beta2_power.data(),
+                           lr.data(), beta1.data(), beta2.data(),
+                           epsilon.data(), use_nesterov);
+    }
+  }
+};
+
 template <typename T>
 struct ApplyRMSProp<GPUDevice, T> {
   void operator()(const GPUDevice& d, typename TTypes<T>::Flat var,
@@ -280,6 +414,14 @@ template struct functor::ApplyAdam<GPUDevice, Eigen::half>;
 template struct functor::ApplyAdam<GPUDevice, float>;
 template struct functor::ApplyAdam<GPUDevice, double>;
 
+template struct functor::MultiApplyMomentum<GPUDevice, Eigen::half>;
+template struct functor::MultiApplyMomentum<GPUDevice, float>;
+template struct functor::MultiApplyMomentum<GPUDevice, double>;
+
+template struct functor::MultiApplyAdam<GPUDevice, Eigen::half>;
+template struct functor::MultiApplyAdam<GPUDevice, float>;
+template struct functor::MultiApplyAdam<GPUDevice, double>;
+
 template struct functor::ApplyRMSProp<GPUDevice, Eigen::half>;
 template struct functor::ApplyRMSProp<GPUDevice, float>;
 template struct functor::ApplyRMSProp<GPUDevice, double>;
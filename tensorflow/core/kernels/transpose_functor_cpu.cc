@@ -15,6 +15,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,38 +32,171 @@ typedef Eigen::ThreadPoolDevice CPUDevice;
 namespace tensorflow {
 namespace {
 
+// The elements of one dimension of a transpose: its size and its strides in
+// the input and the output.
+struct TransposeDim {
+  int64 size;
+  int64 in_stride;
+  int64 out_stride;
+};
+
+// Returns the input and output offsets of the "index"-th element of the
+// iteration space "dims", whose last dimension varies fastest.
+inline void TransposeOffsets(const gtl::InlinedVector<TransposeDim, 8>& dims,
+                             int64 index, int64* in_offset,
+                             int64* out_offset) {
+  *in_offset = 0;
+  *out_offset = 0;
+  for (int i = dims.size() - 1; i >= 0; --i) {
+    const int64 k = index % dims[i].size;
+    index /= dims[i].size;
+    *in_offset += k * dims[i].in_stride;
+    *out_offset += k * dims[i].out_stride;
+  }
+}
+
+template <typename T, bool conjugate>
+inline void CopyElement(const T& from, T* to) {
+  if (conjugate) {
+    *to = Eigen::numext::conj(from);
+  } else {
+    *to = from;
+  }
+}
+
+// The tiles of TransposeTiles are one cache line of elements wide.
+template <typename T>
+constexpr int64 TileSize() {
+  return sizeof(T) >= 16 ? 4 : 64 / sizeof(T);
+}
+
+// Sets out[c * out_stride + r] = in[r * in_stride + c] for r < rows and
+// c < cols, tile by tile, so that both sides are read and written a cache
+// line at a time. Full tiles have a constant size, which the compiler unrolls
+// and vectorizes.
+template <typename T, bool conjugate>
+void TransposeTiles(const T* in, int64 in_stride, T* out, int64 out_stride,
+                    int64 rows, int64 cols) {
+  constexpr int64 kTile = TileSize<T>();
+  for (int64 c0 = 0; c0 < cols; c0 += kTile) {
+    if (rows == kTile && c0 + kTile <= cols) {
+      for (int64 c = c0; c < c0 + kTile; ++c) {
+        for (int64 r = 0; r < kTile; ++r) {
+          CopyElement<T, conjugate>(in[r * in_stride + c],
+                                    &out[c * out_stride + r]);
+        }
+      }
+    } else {
+      const int64 c1 = std::min(c0 + kTile, cols);
+      for (int64 c = c0; c < c1; ++c) {
+        for (int64 r = 0; r < rows; ++r) {
+          CopyElement<T, conjugate>(in[r * in_stride + c],
+                                    &out[c * out_stride + r]);
+        }
+      }
+    }
+  }
+}
+
+// Transposes "in" after merging the dimensions that stay adjacent, which
+// leaves a permutation that moves every dimension.
+//
+// If the last input dimension stays last, every output row is a contiguous
+// input row, and the rows are copied in parallel. Otherwise, let k be the
+// input dimension that becomes the last output dimension. For every index of
+// the other dimensions, the [in_dim(k), in_dim(last)] matrix is transposed
+// with TransposeTiles, and the work is split over the threads by those
+// indices and by tiles along dimension k.
 template <typename T, bool conjugate>
-void TransposeSimple(const CPUDevice& device, const Tensor& in,
-                     const gtl::ArraySlice<int32> perm, Tensor* out) {
-  const int ndims = in.dims();
-  gtl::InlinedVector<int64, 8> in_strides = ComputeStride<int64>(in.shape());
-  gtl::InlinedVector<int64, 8> out_strides = ComputeStride<int64>(out->shape());
+void TransposeTiled(const CPUDevice& device, const Tensor& in,
+                    const gtl::ArraySlice<int32> perm, Tensor* out) {
+  if (in.NumElements() == 0) return;
+  internal::TransposePermsVec out_positions;
+  internal::TransposeDimsVec new_dims(in.dims());
+  internal::ReduceTransposeDimensions(in.shape(), perm, &out_positions,
+                                      &new_dims);
+  const int ndims = out_positions.size();
+  // ReduceTransposeDimensions gives the output position of each reduced input
+  // dimension; new_perm[i] is the input dimension of output dimension i.
+  internal::TransposePermsVec new_perm(ndims);
+  for (int i = 0; i < ndims; ++i) new_perm[out_positions[i]] = i;
+
+  gtl::InlinedVector<int64, 8> in_strides(ndims);
+  gtl::InlinedVector<int64, 8> out_strides(ndims);
+  in_strides[ndims - 1] = 1;
+  out_strides[ndims - 1] = 1;
+  for (int i = ndims - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * new_dims[i + 1];
+    out_strides[i] = out_strides[i + 1] * new_dims[new_perm[i + 1]];
+  }
+
   const T* p = reinterpret_cast<const T*>(in.tensor_data().data());
   T* q = reinterpret_cast<T*>(const_cast<char*>((out->tensor_data().data())));
-  auto transpose_fn = [=, &in_strides, &out_strides, &perm](int64 begin,
-                                                            int64 end) {
-    for (int64 o_idx = begin; o_idx < end; ++o_idx) {
-      int64 i_idx = 0;
-      int64 t = o_idx;
-      for (int i = 0; i < ndims; ++i) {
-        const int64 ratio = t / out_strides[i];
-        t -= ratio * out_strides[i];
-        i_idx += ratio * in_strides[perm[i]];
-      }
-      if (conjugate) {
-        q[o_idx] = Eigen::numext::conj(p[i_idx]);
-      } else {
-        q[o_idx] = p[i_idx];
+  const int last = ndims - 1;
+  const int k = new_perm[last];
+
+  if (k == last) {
+    // Each output row of new_dims[last] elements is contiguous in the input,
+    // including when there is nothing to permute.
+    const int64 row_size = new_dims[last];
+    gtl::InlinedVector<TransposeDim, 8> rows;
+    for (int i = 0; i < last; ++i) {
+      rows.push_back({new_dims[new_perm[i]], in_strides[new_perm[i]],
+                      out_strides[i]});
+    }
+    auto copy_rows = [=, &rows](int64 begin, int64 end) {
+      for (int64 r = begin; r < end; ++r) {
+        int64 in_offset, out_offset;
+        TransposeOffsets(rows, r, &in_offset, &out_offset);
+        const T* from = p + in_offset;
+        T* to = q + out_offset;
+        for (int64 c = 0; c < row_size; ++c) {
+          CopyElement<T, conjugate>(from[c], &to[c]);
+        }
       }
+    };
+    const Eigen::TensorOpCost cost(row_size * sizeof(T), row_size * sizeof(T),
+                                   row_size * (conjugate ? 1 : 0.25));
+    device.parallelFor(in.NumElements() / row_size, cost,
+                       std::move(copy_rows));
+    return;
+  }
+
+  // The output dimension that holds the last input dimension.
+  int j = 0;
+  while (new_perm[j] != last) ++j;
+  constexpr int64 kTile = TileSize<T>();
+  const int64 num_rows = new_dims[k];
+  const int64 num_cols = new_dims[last];
+  const int64 num_row_tiles = (num_rows + kTile - 1) / kTile;
+  gtl::InlinedVector<TransposeDim, 8> outer;
+  for (int i = 0; i < last; ++i) {
+    if (i != j) {
+      outer.push_back({new_dims[new_perm[i]], in_strides[new_perm[i]],
+                       out_strides[i]});
+    }
+  }
+  // Tiles along dimension k vary fastest.
+  outer.push_back({num_row_tiles, in_strides[k] * kTile, kTile});
+  const int64 in_row_stride = in_strides[k];
+  const int64 out_col_stride = out_strides[j];
+  auto transpose_tiles = [=, &outer](int64 begin, int64 end) {
+    for (int64 b = begin; b < end; ++b) {
+      int64 in_offset, out_offset;
+      TransposeOffsets(outer, b, &in_offset, &out_offset);
+      const int64 row_begin = (b % num_row_tiles) * kTile;
+      TransposeTiles<T, conjugate>(p + in_offset, in_row_stride,
+                                   q + out_offset, out_col_stride,
+                                   std::min(kTile, num_rows - row_begin),
+                                   num_cols);
     }
   };
-  double cycles_per_element =
-      (conjugate ? 1 : 0) + ndims * (Eigen::TensorOpCost::DivCost<int64>() +
-                                     2 * Eigen::TensorOpCost::MulCost<int64>() +
-                                     2 * Eigen::TensorOpCost::AddCost<int64>());
-  Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T),
-                           /*bytes_stored=*/sizeof(T), cycles_per_element);
-  device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
+  const int64 block_size = kTile * num_cols;
+  const Eigen::TensorOpCost cost(block_size * sizeof(T),
+                                 block_size * sizeof(T),
+                                 block_size * (conjugate ? 2 : 1));
+  device.parallelFor(in.NumElements() / (num_rows * num_cols) * num_row_tiles,
+                     cost, std::move(transpose_tiles));
 }
 
 }  // namespace
@@ -71,27 +205,7 @@ template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
-    switch (in.dims()) {
-      case 2:
-        internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 3:
-        internal::TransposeUsingEigen<CPUDevice, T, 3>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 4:
-        internal::TransposeUsingEigen<CPUDevice, T, 4>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      case 5:
-        internal::TransposeUsingEigen<CPUDevice, T, 5>(d, in, perm, conjugate,
-                                                       out);
-        break;
-      default:
-        TransposeSimple<T, conjugate>(d, in, perm, out);
-        break;
-    }
+    TransposeTiled<T, conjugate>(d, in, perm, out);
   }
 };
 
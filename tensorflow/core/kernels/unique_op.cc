@@ -16,6 +16,7 @@ limitations under the License.
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -23,11 +24,28 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// Vectors of at least this many elements are deduplicated in parallel.
+const int64 kMinParallelUniqueSize = 1 << 16;
+
+// Rough number of cycles it takes to hash one element and look it up.
+const int64 kUniqueCostPerElement = 100;
+
+// Returns which of "num_partitions" partitions an element with hash "h" goes
+// to. The hash of an integer is the integer itself, so it is mixed first.
+inline int64 UniquePartition(uint64 h, int64 num_partitions) {
+  return ((h * 0x9ddfea08eb382d69ULL) >> 32) % num_partitions;
+}
+
+}  // namespace
+
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
@@ -90,6 +108,14 @@ class UniqueOp : public OpKernel {
                                 1, TensorShape({Tin.dimension(1)}), &idx));
     auto idx_vec = idx->template vec<TIndex>();
 
+    const int num_threads =
+        context->device()->tensorflow_cpu_worker_threads()->num_threads;
+    if (input.dims() == 1 && Tin.dimension(1) >= kMinParallelUniqueSize &&
+        num_threads > 1) {
+      ComputeVectorInParallel(context, input, num_threads, idx);
+      return;
+    }
+
     auto hash_fn = [&Tin](const int64& key) -> unsigned long {
       size_t h = 0;
       for (int64 i = 0; i < Tin.dimension(0); i++) {
@@ -146,6 +172,143 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Computes the unique elements of the vector "input" with "num_threads"
+  // threads. The elements are split by hash into one partition per thread,
+  // and each partition is deduplicated by one thread in input order, which
+  // finds the first occurrence of each element. A parallel prefix sum over the
+  // first occurrences then numbers the unique elements in the same order as
+  // the serial algorithm does.
+  void ComputeVectorInParallel(OpKernelContext* context, const Tensor& input,
+                               int num_threads, Tensor* idx) {
+    const auto x = input.vec<T>();
+    auto idx_vec = idx->template vec<TIndex>();
+    const int64 n = x.size();
+    auto* workers = context->device()->tensorflow_cpu_worker_threads()->workers;
+    const int64 num_partitions = num_threads;
+    const int64 num_chunks = num_threads;
+    const int64 chunk_size = (n + num_chunks - 1) / num_chunks;
+    const int64 chunk_cost = chunk_size * kUniqueCostPerElement;
+    auto chunk_start = [chunk_size, n](int64 chunk) {
+      return std::min(chunk * chunk_size, n);
+    };
+
+    // The partition of each element, and the number of elements of each chunk
+    // that go to each partition.
+    std::vector<int32> partition(n);
+    std::vector<int64> offsets(num_chunks * num_partitions, 0);
+    Shard(num_threads, workers, num_chunks, chunk_cost,
+          [&](int64 start_chunk, int64 limit_chunk) {
+            for (int64 c = start_chunk; c < limit_chunk; ++c) {
+              int64* sizes = &offsets[c * num_partitions];
+              for (int64 i = chunk_start(c); i < chunk_start(c + 1); ++i) {
+                partition[i] =
+                    UniquePartition(hash<T>{}(x(i)), num_partitions);
+                ++sizes[partition[i]];
+              }
+            }
+          });
+
+    // Lists the elements of each partition in input order: partition p is
+    // order[partition_starts[p]:partition_starts[p + 1]].
+    std::vector<int64> partition_starts(num_partitions + 1, 0);
+    int64 offset = 0;
+    for (int64 p = 0; p < num_partitions; ++p) {
+      partition_starts[p] = offset;
+      for (int64 c = 0; c < num_chunks; ++c) {
+        const int64 size = offsets[c * num_partitions + p];
+        offsets[c * num_partitions + p] = offset;
+        offset += size;
+      }
+    }
+    partition_starts[num_partitions] = n;
+    std::vector<int64> order(n);
+    Shard(num_threads, workers, num_chunks, chunk_cost / 10,
+          [&](int64 start_chunk, int64 limit_chunk) {
+            for (int64 c = start_chunk; c < limit_chunk; ++c) {
+              int64* chunk_offsets = &offsets[c * num_partitions];
+              for (int64 i = chunk_start(c); i < chunk_start(c + 1); ++i) {
+                order[chunk_offsets[partition[i]]++] = i;
+              }
+            }
+          });
+
+    // first[i] is the index of the first occurrence of x(i).
+    std::vector<int64> first(n);
+    Shard(num_threads, workers, num_partitions, chunk_cost,
+          [&](int64 start_partition, int64 limit_partition) {
+            for (int64 p = start_partition; p < limit_partition; ++p) {
+              std::unordered_map<T, int64, hash<T>> firsts;
+              for (int64 k = partition_starts[p]; k < partition_starts[p + 1];
+                   ++k) {
+                const int64 i = order[k];
+                first[i] = firsts.emplace(x(i), i).first->second;
+              }
+            }
+          });
+
+    // Numbers the first occurrences in input order, and copies them to the
+    // output.
+    std::vector<int64> chunk_num_uniques(num_chunks + 1, 0);
+    Shard(num_threads, workers, num_chunks, chunk_cost / 10,
+          [&](int64 start_chunk, int64 limit_chunk) {
+            for (int64 c = start_chunk; c < limit_chunk; ++c) {
+              for (int64 i = chunk_start(c); i < chunk_start(c + 1); ++i) {
+                chunk_num_uniques[c + 1] += first[i] == i;
+              }
+            }
+          });
+    for (int64 c = 0; c < num_chunks; ++c) {
+      chunk_num_uniques[c + 1] += chunk_num_uniques[c];
+    }
+    const int64 uniq_size = chunk_num_uniques[num_chunks];
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({uniq_size}), &output));
+    auto y = output->vec<T>();
+    // position[i] is the position in the output of the first occurrence i.
+    std::vector<int64> position(n);
+    Shard(num_threads, workers, num_chunks, chunk_cost / 10,
+          [&](int64 start_chunk, int64 limit_chunk) {
+            for (int64 c = start_chunk; c < limit_chunk; ++c) {
+              int64 next = chunk_num_uniques[c];
+              for (int64 i = chunk_start(c); i < chunk_start(c + 1); ++i) {
+                if (first[i] == i) {
+                  position[i] = next;
+                  y(next++) = x(i);
+                }
+              }
+            }
+          });
+
+    Shard(num_threads, workers, num_chunks, chunk_cost / 10,
+          [&](int64 start_chunk, int64 limit_chunk) {
+            for (int64 c = start_chunk; c < limit_chunk; ++c) {
+              for (int64 i = chunk_start(c); i < chunk_start(c + 1); ++i) {
+                idx_vec(i) = position[first[i]];
+              }
+            }
+          });
+
+    if (num_outputs() > 2) {
+      OP_REQUIRES_OK(context, context->allocate_output(
+                                  2, TensorShape({uniq_size}), &output));
+      auto count_output_vec = output->template vec<TIndex>();
+      count_output_vec.setZero();
+      // All the occurrences of a value are in the same partition, so the
+      // partitions count disjoint sets of values.
+      Shard(num_threads, workers, num_partitions, chunk_cost / 10,
+            [&](int64 start_partition, int64 limit_partition) {
+              for (int64 p = start_partition; p < limit_partition; ++p) {
+                for (int64 k = partition_starts[p];
+                     k < partition_starts[p + 1]; ++k) {
+                  count_output_vec(idx_vec(order[k]))++;
+                }
+              }
+            });
+    }
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                    \
@@ -183,42 +346,7 @@ TF_CALL_REAL_NUMBER_TYPES(REGISTER_UNIQUE);
 REGISTER_UNIQUE(string)
 #undef REGISTER_UNIQUE
 
-// Fake integer GPU kernels so that the use of Unique in optimizers (to
-// de-duplicate sparse gradient indices) does not conflict with gradients being
-// located on a GPU. These kernels run on the CPU, their inputs and outputs
-// residing in host (not GPU) memory.
-REGISTER_KERNEL_BUILDER(Name("Unique")
-                            .Device(DEVICE_GPU)
-                            .TypeConstraint<int32>("T")
-                            .TypeConstraint<int32>("out_idx")
-                            .HostMemory("x")
-                            .HostMemory("y")
-                            .HostMemory("idx"),
-                        UniqueOp<int32, int32>);
-REGISTER_KERNEL_BUILDER(Name("Unique")
-                            .Device(DEVICE_GPU)
-                            .TypeConstraint<int32>("T")
-                            .TypeConstraint<int64>("out_idx")
-                            .HostMemory("x")
-                            .HostMemory("y")
-                            .HostMemory("idx"),
-                        UniqueOp<int32, int64>);
-REGISTER_KERNEL_BUILDER(Name("Unique")
-                            .Device(DEVICE_GPU)
-                            .TypeConstraint<int64>("T")
-                            .TypeConstraint<int32>("out_idx")
-                            .HostMemory("x")
-                            .HostMemory("y")
-                            .HostMemory("idx"),
-                        UniqueOp<int64, int32>);
-REGISTER_KERNEL_BUILDER(Name("Unique")
-                            .Device(DEVICE_GPU)
-                            .TypeConstraint<int64>("T")
-                            .TypeConstraint<int64>("out_idx")
-                            .HostMemory("x")
-                            .HostMemory("y")
-                            .HostMemory("idx"),
-                        UniqueOp<int64, int64>);
+// The GPU kernels of Unique and UniqueWithCounts are in unique_op_gpu.cu.cc.
 
 #ifdef TENSORFLOW_USE_SYCL
 REGISTER_KERNEL_BUILDER(Name("Unique")
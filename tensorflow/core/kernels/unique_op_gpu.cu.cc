@@ -0,0 +1,319 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// The GPU implementation of Unique and UniqueWithCounts sorts the input and
+// finds the runs of equal elements:
+// 1. cub::DeviceRadixSort::SortPairs sorts the pairs (x[i], i). The sort is
+//    stable, so the first element of each run of equal keys is the first
+//    occurrence of its value.
+// 2. Marking the first element of each run and computing an inclusive prefix
+//    sum of the marks numbers the runs, in sorted order.
+// 3. The first occurrences are marked in input order, and an exclusive prefix
+//    sum of these marks gives the position in the output of each of them, so
+//    that the output is in order of first occurrence, as on CPU.
+// 4. The number of unique elements, which is the number of runs, is copied
+//    to the host asynchronously. Then the outputs are allocated, and the
+//    unique elements and their counts are written.
+
+#if GOOGLE_CUDA
+
+#define EIGEN_USE_GPU
+
+#include "external/cub_archive/cub/device/device_radix_sort.cuh"
+#include "external/cub_archive/cub/device/device_scan.cuh"
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/cuda.h"
+#include "tensorflow/core/util/cuda_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+using ::perftools::gputools::cuda::ScopedActivateExecutorContext;
+
+namespace {
+
+__global__ void RangeInitKernel(const int32 size, int32* out) {
+  CUDA_1D_KERNEL_LOOP(i, size) { out[i] = i; }
+}
+
+// Sets heads[i] to 1 if sorted_input[i] starts a run of equal elements.
+template <typename T>
+__global__ void MarkRunHeadsKernel(const int32 size, const T* sorted_input,
+                                   int32* heads) {
+  CUDA_1D_KERNEL_LOOP(i, size) {
+    heads[i] = i == 0 || ldg(sorted_input + i) != ldg(sorted_input + i - 1);
+  }
+}
+
+// Records where each run starts and the index in the input of its first
+// element, and marks the first occurrences in input order.
+__global__ void RunsKernel(const int32 size, const int32* heads,
+                           const int32* run_ids, const int32* sorted_indices,
+                           int32* run_starts, int32* run_firsts,
+                           int32* is_first) {
+  CUDA_1D_KERNEL_LOOP(i, size) {
+    const int32 head = ldg(heads + i);
+    const int32 index = ldg(sorted_indices + i);
+    if (head) {
+      const int32 run = ldg(run_ids + i) - 1;
+      run_starts[run] = i;
+      run_firsts[run] = index;
+    }
+    is_first[index] = head;
+  }
+}
+
+template <typename TIndex>
+__global__ void IdxKernel(const int32 size, const int32* run_ids,
+                          const int32* sorted_indices, const int32* run_firsts,
+                          const int32* positions, TIndex* idx) {
+  CUDA_1D_KERNEL_LOOP(i, size) {
+    const int32 run = ldg(run_ids + i) - 1;
+    idx[ldg(sorted_indices + i)] = ldg(positions + ldg(run_firsts + run));
+  }
+}
+
+template <typename T>
+__global__ void OutputKernel(const int32 size, const T* input,
+                             const int32* is_first, const int32* positions,
+                             T* output) {
+  CUDA_1D_KERNEL_LOOP(i, size) {
+    if (ldg(is_first + i)) {
+      output[ldg(positions + i)] = ldg(input + i);
+    }
+  }
+}
+
+template <typename TIndex>
+__global__ void CountKernel(const int32 num_runs, const int32 size,
+                            const int32* run_starts, const int32* run_firsts,
+                            const int32* positions, TIndex* count) {
+  CUDA_1D_KERNEL_LOOP(run, num_runs) {
+    const int32 end = run + 1 < num_runs ? ldg(run_starts + run + 1) : size;
+    count[ldg(positions + ldg(run_firsts + run))] =
+        end - ldg(run_starts + run);
+  }
+}
+
+// Runs the cub algorithm "f", which is called once with no storage to size its
+// temporary storage and once to do the work.
+template <typename F>
+Status RunCub(OpKernelContext* context, const F& f) {
+  size_t temp_storage_bytes = 0;
+  if (f(nullptr, temp_storage_bytes) != cudaSuccess) {
+    return errors::Internal("Failed to size the temporary storage of cub.");
+  }
+  Tensor temp_storage;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DT_INT8, TensorShape({static_cast<int64>(temp_storage_bytes)}),
+      &temp_storage));
+  if (f(temp_storage.flat<int8>().data(), temp_storage_bytes) != cudaSuccess) {
+    return errors::Internal("Failed to launch cub.");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+template <typename T, typename TIndex>
+class UniqueOpGPU : public AsyncOpKernel {
+ public:
+  explicit UniqueOpGPU(OpKernelConstruction* context)
+      : AsyncOpKernel(context) {}
+
+  void ComputeAsync(OpKernelContext* context, DoneCallback done) override {
+    const Tensor& input = context->input(0);
+    OP_REQUIRES_ASYNC(context, TensorShapeUtils::IsVector(input.shape()),
+                      errors::InvalidArgument("unique expects a 1D vector."),
+                      done);
+    OP_REQUIRES_ASYNC(
+        context, input.NumElements() <= std::numeric_limits<int32>::max(),
+        errors::InvalidArgument(
+            "unique does not support input tensors larger than ",
+            std::numeric_limits<int32>::max(), " elements"),
+        done);
+    const int32 n = input.NumElements();
+
+    Tensor* idx = nullptr;
+    OP_REQUIRES_OK_ASYNC(
+        context, context->allocate_output(1, TensorShape({n}), &idx), done);
+    if (n == 0) {
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context, context->allocate_output(0, TensorShape({0}), &output),
+          done);
+      if (num_outputs() > 2) {
+        OP_REQUIRES_OK_ASYNC(
+            context, context->allocate_output(2, TensorShape({0}), &output),
+            done);
+      }
+      done();
+      return;
+    }
+
+    Tensor sorted_input;
+    OP_REQUIRES_OK_ASYNC(context,
+                         context->allocate_temp(DataTypeToEnum<T>::value,
+                                                TensorShape({n}),
+                                                &sorted_input),
+                         done);
+    Tensor indices, sorted_indices, heads, run_ids, run_starts, run_firsts,
+        is_first, positions;
+    for (Tensor* t : {&indices, &sorted_indices, &heads, &run_ids, &run_starts,
+                      &run_firsts, &is_first, &positions}) {
+      OP_REQUIRES_OK_ASYNC(
+          context, context->allocate_temp(DT_INT32, TensorShape({n}), t),
+          done);
+    }
+
+    const GPUDevice& d = context->eigen_device<GPUDevice>();
+    const cudaStream_t& cu_stream = GetCudaStream(context);
+    const T* input_ptr = input.flat<T>().data();
+    T* sorted_input_ptr = sorted_input.flat<T>().data();
+    int32* indices_ptr = indices.flat<int32>().data();
+    int32* sorted_indices_ptr = sorted_indices.flat<int32>().data();
+    int32* heads_ptr = heads.flat<int32>().data();
+    int32* run_ids_ptr = run_ids.flat<int32>().data();
+    int32* run_starts_ptr = run_starts.flat<int32>().data();
+    int32* run_firsts_ptr = run_firsts.flat<int32>().data();
+    int32* is_first_ptr = is_first.flat<int32>().data();
+    int32* positions_ptr = positions.flat<int32>().data();
+
+    CudaLaunchConfig config = GetCudaLaunchConfig(n, d);
+    RangeInitKernel<<<config.block_count, config.thread_per_block, 0,
+                      d.stream()>>>(n, indices_ptr);
+    OP_REQUIRES_OK_ASYNC(
+        context, RunCub(context,
+                        [&](void* storage, size_t& bytes) {
+                          return cub::DeviceRadixSort::SortPairs(
+                              storage, bytes, input_ptr, sorted_input_ptr,
+                              indices_ptr, sorted_indices_ptr, n, 0,
+                              sizeof(T) * 8, cu_stream);
+                        }),
+        done);
+    MarkRunHeadsKernel<T><<<config.block_count, config.thread_per_block, 0,
+                            d.stream()>>>(n, sorted_input_ptr, heads_ptr);
+    OP_REQUIRES_OK_ASYNC(
+        context, RunCub(context,
+                        [&](void* storage, size_t& bytes) {
+                          return cub::DeviceScan::InclusiveSum(
+                              storage, bytes, heads_ptr, run_ids_ptr, n,
+                              cu_stream);
+                        }),
+        done);
+    RunsKernel<<<config.block_count, config.thread_per_block, 0,
+                 d.stream()>>>(n, heads_ptr, run_ids_ptr, sorted_indices_ptr,
+                               run_starts_ptr, run_firsts_ptr, is_first_ptr);
+    OP_REQUIRES_OK_ASYNC(
+        context, RunCub(context,
+                        [&](void* storage, size_t& bytes) {
+                          return cub::DeviceScan::ExclusiveSum(
+                              storage, bytes, is_first_ptr, positions_ptr, n,
+                              cu_stream);
+                        }),
+        done);
+    IdxKernel<TIndex><<<config.block_count, config.thread_per_block, 0,
+                        d.stream()>>>(n, run_ids_ptr, sorted_indices_ptr,
+                                      run_firsts_ptr, positions_ptr,
+                                      idx->flat<TIndex>().data());
+
+    // The number of unique elements is the id of the last run.
+    auto* stream = context->op_device_context()->stream();
+    OP_REQUIRES_ASYNC(context, stream,
+                      errors::Internal("No GPU stream available."), done);
+    Tensor num_runs_host;
+    AllocatorAttributes alloc_attr;
+    alloc_attr.set_on_host(true);
+    alloc_attr.set_gpu_compatible(true);
+    OP_REQUIRES_OK_ASYNC(
+        context, context->allocate_temp(DT_INT32, TensorShape({}),
+                                        &num_runs_host, alloc_attr),
+        done);
+    perftools::gputools::DeviceMemoryBase num_runs_device(run_ids_ptr + n - 1,
+                                                          sizeof(int32));
+    OP_REQUIRES_ASYNC(
+        context,
+        stream
+            ->ThenMemcpy(num_runs_host.flat<int32>().data(), num_runs_device,
+                         sizeof(int32))
+            .ok(),
+        errors::Internal("Failed to launch copy from device to host."), done);
+
+    // The temporaries are captured to keep them alive until the callback.
+    auto callback = [this, context, stream, n, num_runs_host, input,
+                     run_starts, run_firsts, is_first, positions, done]() {
+      // Ensure that within the callback, the proper GPU settings are
+      // configured.
+      ScopedActivateExecutorContext scoped_activation{stream->parent()};
+      const int32 num_runs = num_runs_host.scalar<int32>()();
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK_ASYNC(
+          context,
+          context->allocate_output(0, TensorShape({num_runs}), &output),
+          done);
+      const GPUDevice& d = context->eigen_device<GPUDevice>();
+      CudaLaunchConfig config = GetCudaLaunchConfig(n, d);
+      OutputKernel<T>
+          <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+              n, input.flat<T>().data(), is_first.flat<int32>().data(),
+              positions.flat<int32>().data(), output->flat<T>().data());
+      if (num_outputs() > 2) {
+        Tensor* count = nullptr;
+        OP_REQUIRES_OK_ASYNC(
+            context,
+            context->allocate_output(2, TensorShape({num_runs}), &count),
+            done);
+        config = GetCudaLaunchConfig(num_runs, d);
+        CountKernel<TIndex>
+            <<<config.block_count, config.thread_per_block, 0, d.stream()>>>(
+                num_runs, n, run_starts.flat<int32>().data(),
+                run_firsts.flat<int32>().data(),
+                positions.flat<int32>().data(), count->flat<TIndex>().data());
+      }
+      done();
+    };
+    context->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        stream, callback);
+  }
+};
+
+#define REGISTER_UNIQUE_GPU(type, index_type)                          \
+  REGISTER_KERNEL_BUILDER(Name("Unique")                               \
+                              .Device(DEVICE_GPU)                      \
+                              .TypeConstraint<type>("T")               \
+                              .TypeConstraint<index_type>("out_idx"),  \
+                          UniqueOpGPU<type, index_type>);              \
+  REGISTER_KERNEL_BUILDER(Name("UniqueWithCounts")                     \
+                              .Device(DEVICE_GPU)                      \
+                              .TypeConstraint<type>("T")               \
+                              .TypeConstraint<index_type>("out_idx"),  \
+                          UniqueOpGPU<type, index_type>)
+
+REGISTER_UNIQUE_GPU(int32, int32);
+REGISTER_UNIQUE_GPU(int32, int64);
+REGISTER_UNIQUE_GPU(int64, int32);
+REGISTER_UNIQUE_GPU(int64, int64);
+
+#undef REGISTER_UNIQUE_GPU
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
 #include <functional>
 #include <memory>
 
@@ -102,6 +103,52 @@ static void BM_Unique_INT32_Repeat(int iters, int dim, int max_int) {
   test::Benchmark("cpu", g).Run(iters);
 }
 
+// Returns "dim" ids in [0, max_int) drawn from a power law: the larger "skew",
+// the more often the smallest ids are drawn, as in the id batches of
+// embeddings. A skew of 1 is uniform.
+TensorProto GetSkewedInt64TensorProto(int dim, int max_int, int skew) {
+  TensorProto tensor_proto;
+  tensor_proto.set_dtype(DT_INT64);
+  tensor_proto.mutable_tensor_shape()->add_dim()->set_size(dim);
+  tensor_proto.mutable_tensor_shape()->set_unknown_rank(false);
+  for (int i = 0; i < dim; ++i) {
+    const double u = static_cast<double>(std::rand()) / RAND_MAX;
+    tensor_proto.add_int64_val(static_cast<int64>(std::pow(u, skew) * max_int));
+  }
+  return tensor_proto;
+}
+
+static void BM_Unique_INT64_Skewed(int iters, int dim, int skew,
+                                   const string& device) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT64, TensorShape({dim}));
+  CHECK(input.FromProto(GetSkewedInt64TensorProto(dim, 10 * 1024 * 1024,
+                                                   skew)));
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+
+  testing::BytesProcessed(static_cast<int64>(iters) * dim * sizeof(int64));
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark(device, g).Run(iters);
+}
+
+static void BM_Unique_INT64_Skewed_CPU(int iters, int dim, int skew) {
+  BM_Unique_INT64_Skewed(iters, dim, skew, "cpu");
+}
+
+#if GOOGLE_CUDA
+static void BM_Unique_INT64_Skewed_GPU(int iters, int dim, int skew) {
+  BM_Unique_INT64_Skewed(iters, dim, skew, "gpu");
+}
+#endif  // GOOGLE_CUDA
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -180,6 +227,25 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+#define BM_UNIQUE_SKEWED(name)        \
+  BENCHMARK(name)                     \
+      ->ArgPair(64 * 1024, 1)         \
+      ->ArgPair(64 * 1024, 4)         \
+      ->ArgPair(64 * 1024, 16)        \
+      ->ArgPair(1024 * 1024, 1)       \
+      ->ArgPair(1024 * 1024, 4)       \
+      ->ArgPair(1024 * 1024, 16)      \
+      ->ArgPair(4 * 1024 * 1024, 1)   \
+      ->ArgPair(4 * 1024 * 1024, 4)   \
+      ->ArgPair(4 * 1024 * 1024, 16);
+
+BM_UNIQUE_SKEWED(BM_Unique_INT64_Skewed_CPU);
+#if GOOGLE_CUDA
+BM_UNIQUE_SKEWED(BM_Unique_INT64_Skewed_GPU);
+#endif  // GOOGLE_CUDA
+
+#undef BM_UNIQUE_SKEWED
+
 BENCHMARK(BM_Unique_STRING)
     ->Arg(32)
     ->Arg(256)
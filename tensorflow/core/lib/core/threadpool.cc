@@ -17,6 +17,7 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
 #include "tensorflow/core/platform/logging.h"
@@ -28,6 +29,18 @@ limitations under the License.
 namespace tensorflow {
 namespace thread {
 
+namespace {
+
+// Dividing the rate of this counter by the number of threads of a pool
+// gives its utilization.
+auto* thread_pool_busy_micros = monitoring::Counter<1>::New(
+    "/tensorflow/core/thread_pool/busy_micros",
+    "The total time the threads of a pool spent running closures, in "
+    "microseconds.",
+    "pool");
+
+}  // namespace
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
@@ -42,10 +55,14 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  monitoring::CounterCell* const busy_micros_;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
                    const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        busy_micros_(thread_pool_busy_micros->GetCell(name)) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
     return env_->StartThread(thread_options_, name_, [=]() {
@@ -73,6 +90,7 @@ struct EigenEnvironment {
 
   void ExecuteTask(const Task& t) {
     WithContext wc(t.f->context);
+    const uint64 start_micros = env_->NowMicros();
     if (t.f->trace_id != 0) {
       port::Tracing::ScopedActivity region(
           port::Tracing::EventCategory::kRunClosure, t.f->trace_id);
@@ -80,6 +98,7 @@ struct EigenEnvironment {
     } else {
       t.f->f();
     }
+    busy_micros_->IncrementBy(env_->NowMicros() - start_micros);
   }
 };
 
@@ -16,7 +16,7 @@ limitations under the License.
 #include <stddef.h>
 #include <stdint.h>
 
-// SSE4.2 accelerated CRC32c.
+// SSE4.2 or ARMv8 accelerated CRC32c.
 
 // See if the SSE4.2 crc32c instruction is available.
 #undef USE_SSE_CRC32C
@@ -37,14 +37,27 @@ limitations under the License.
 #undef USE_SSE_CRC32C
 #endif
 
+// See if the ARMv8 crc32c instructions are available, which requires building
+// for a target with the CRC extension (e.g. -march=armv8-a+crc).
+#undef USE_ARM_CRC32C
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define USE_ARM_CRC32C 1
+#endif
+
 #ifdef USE_SSE_CRC32C
 #include <nmmintrin.h>
+#define CRC32C_U8(crc, p) _mm_crc32_u8(crc, p)
+#define CRC32C_U64(crc, p) _mm_crc32_u64(crc, p)
+#elif defined(USE_ARM_CRC32C)
+#include <arm_acle.h>
+#define CRC32C_U8(crc, p) __crc32cb(crc, p)
+#define CRC32C_U64(crc, p) __crc32cd(crc, p)
 #endif
 
 namespace tensorflow {
 namespace crc32c {
 
-#ifndef USE_SSE_CRC32C
+#if !defined(USE_SSE_CRC32C) && !defined(USE_ARM_CRC32C)
 
 bool CanAccelerate() { return false; }
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
@@ -54,10 +67,129 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
 
 #else
 
+namespace {
+
+// The crc32c instructions have a latency of several cycles, but a throughput
+// of one per cycle, so large buffers are processed as three interleaved
+// streams whose crcs are then combined.  Combining a crc with the crc of the
+// next n bytes requires shifting it by n zero bytes, which is a linear
+// operator over GF(2) applied with tables.  See
+// https://stackoverflow.com/questions/17645167 for the derivation.
+
+// The sizes of the blocks of each stream, in bytes.
+const size_t kLongBlockSize = 8192;
+const size_t kShortBlockSize = 256;
+
+// The reflected crc32c polynomial.
+const uint32_t kPolynomial = 0x82f63b78u;
+
+uint32_t MultiplyMatrixVector(const uint32_t *matrix, uint32_t vector) {
+  uint32_t sum = 0;
+  while (vector) {
+    if (vector & 1) sum ^= *matrix;
+    vector >>= 1;
+    matrix++;
+  }
+  return sum;
+}
+
+void SquareMatrix(uint32_t *square, const uint32_t *matrix) {
+  for (int n = 0; n < 32; n++) {
+    square[n] = MultiplyMatrixVector(matrix, matrix[n]);
+  }
+}
+
+// Sets "even" to the operator that appends "len" zero bytes to a crc.
+// REQUIRES: "len" is a power of two.
+void ZerosOperator(uint32_t *even, size_t len) {
+  uint32_t odd[32];
+  // The operator for one zero bit.
+  odd[0] = kPolynomial;
+  uint32_t row = 1;
+  for (int n = 1; n < 32; n++) {
+    odd[n] = row;
+    row <<= 1;
+  }
+  SquareMatrix(even, odd);  // Two zero bits.
+  SquareMatrix(odd, even);  // Four zero bits.
+  // Each squaring doubles the number of zero bits, starting with one byte.
+  while (true) {
+    SquareMatrix(even, odd);
+    len >>= 1;
+    if (len == 0) return;
+    SquareMatrix(odd, even);
+    len >>= 1;
+    if (len == 0) break;
+  }
+  for (int n = 0; n < 32; n++) {
+    even[n] = odd[n];
+  }
+}
+
+// Tables applying the operator that appends a block of zero bytes to a crc,
+// one byte of the crc at a time.
+struct ShiftTable {
+  explicit ShiftTable(size_t len) {
+    uint32_t op[32];
+    ZerosOperator(op, len);
+    for (uint32_t n = 0; n < 256; n++) {
+      table[0][n] = MultiplyMatrixVector(op, n);
+      table[1][n] = MultiplyMatrixVector(op, n << 8);
+      table[2][n] = MultiplyMatrixVector(op, n << 16);
+      table[3][n] = MultiplyMatrixVector(op, n << 24);
+    }
+  }
+
+  uint32_t Shift(uint32_t crc) const {
+    return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+           table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+  }
+
+  uint32_t table[4][256];
+};
+
+uint64_t Load64(const uint8_t *p) {
+  return *reinterpret_cast<const uint64_t *>(p);
+}
+
+// Extends "crc" (not inverted) with three interleaved streams of blocks of
+// "block_size" bytes while at least three blocks remain.
+// REQUIRES: "*p" is 8-byte aligned.
+uint64_t ExtendInterleaved(uint64_t crc, const ShiftTable &shift,
+                           size_t block_size, const uint8_t **p,
+                           const uint8_t *e) {
+  while (static_cast<size_t>(e - *p) >= 3 * block_size) {
+    const uint8_t *p0 = *p;
+    const uint8_t *end = p0 + block_size;
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    do {
+      crc = CRC32C_U64(crc, Load64(p0));
+      crc1 = CRC32C_U64(crc1, Load64(p0 + block_size));
+      crc2 = CRC32C_U64(crc2, Load64(p0 + 2 * block_size));
+      p0 += 8;
+    } while (p0 < end);
+    crc = shift.Shift(crc) ^ crc1;
+    crc = shift.Shift(crc) ^ crc2;
+    *p += 3 * block_size;
+  }
+  return crc;
+}
+
+}  // namespace
+
+#ifdef USE_SSE_CRC32C
 // SSE4.2 optimized crc32c computation.
 bool CanAccelerate() { return __builtin_cpu_supports("sse4.2"); }
+#else
+// The CRC extension is known to be available at compile time.
+bool CanAccelerate() { return true; }
+#endif
 
 uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
+  static const ShiftTable *long_shift = new ShiftTable(kLongBlockSize);
+  static const ShiftTable *short_shift = new ShiftTable(kShortBlockSize);
+
   const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
   const uint8_t *e = p + size;
   uint32_t l = crc ^ 0xffffffffu;
@@ -70,23 +202,27 @@ uint32_t AcceleratedExtend(uint32_t crc, const char *buf, size_t size) {
   if (x <= e) {
     // Process bytes until finished or p is 8-byte aligned
     while (p != x) {
-      l = _mm_crc32_u8(l, *p);
+      l = CRC32C_U8(l, *p);
       p++;
     }
   }
 
-  // Process bytes 16 at a time
+  // Process large buffers as three streams.
   uint64_t l64 = l;
+  l64 = ExtendInterleaved(l64, *long_shift, kLongBlockSize, &p, e);
+  l64 = ExtendInterleaved(l64, *short_shift, kShortBlockSize, &p, e);
+
+  // Process bytes 16 at a time
   while ((e - p) >= 16) {
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p));
-    l64 = _mm_crc32_u64(l64, *reinterpret_cast<const uint64_t *>(p + 8));
+    l64 = CRC32C_U64(l64, Load64(p));
+    l64 = CRC32C_U64(l64, Load64(p + 8));
     p += 16;
   }
 
   // Process remaining bytes one at a time.
   l = l64;
   while (p < e) {
-    l = _mm_crc32_u8(l, *p);
+    l = CRC32C_U8(l, *p);
     p++;
   }
 
@@ -62,6 +62,26 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, LargeBuffers) {
+  // Sizes that exercise the interleaved streams used for large buffers, the
+  // 16-byte loop, and the trailing bytes, at every alignment.
+  const size_t kSizes[] = {767, 768, 769, 24575, 24576, 24577, 100000};
+  std::string input(100008, 0);
+  for (size_t i = 0; i < input.size(); i++) {
+    input[i] = static_cast<char>(i * 7 + (i >> 8));
+  }
+  for (size_t size : kSizes) {
+    for (size_t offset = 0; offset < 8; offset++) {
+      const char* buf = input.data() + offset;
+      uint32 expected = 0;
+      for (size_t i = 0; i < size; i++) {
+        expected = Extend(expected, buf + i, 1);
+      }
+      EXPECT_EQ(expected, Value(buf, size)) << size << " " << offset;
+    }
+  }
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -81,5 +101,25 @@ static void BM_CRC(int iters, int len) {
 }
 BENCHMARK(BM_CRC)->Range(1, 256 * 1024);
 
+// Common sizes: record lengths, small records, table blocks, large records
+// and checkpoint chunks.
+static void BM_CRCAligned(int iters, int len) {
+  std::string input(len, 'x');
+  uint32 h = 0;
+  for (int i = 0; i < iters; i++) {
+    h = Extend(h, input.data(), len);
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * len);
+  VLOG(1) << h;
+}
+BENCHMARK(BM_CRCAligned)
+    ->Arg(8)
+    ->Arg(100)
+    ->Arg(1024)
+    ->Arg(4096)
+    ->Arg(64 * 1024)
+    ->Arg(1024 * 1024)
+    ->Arg(8 * 1024 * 1024);
+
 }  // namespace crc32c
 }  // namespace tensorflow
@@ -0,0 +1,78 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/bloom_filter.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/hash/hash.h"
+
+namespace tensorflow {
+namespace table {
+
+// A filter is an array of bits followed by a byte with the number of probes
+// per key.  The probes of a key are derived from one hash by double hashing,
+// as in [Kirsch, Mitzenmacher 2006].
+
+uint32 BloomHash(const StringPiece& key) {
+  return Hash32(key.data(), key.size(), 0xbc9f1d34);
+}
+
+void BuildBloomFilter(const std::vector<uint32>& key_hashes, int bits_per_key,
+                      string* dst) {
+  // k = ln(2) * bits_per_key minimizes the false positive rate.
+  const int num_probes =
+      std::min(30, std::max(1, static_cast<int>(bits_per_key * 0.69)));
+  // Small filters have a high false positive rate, so at least 64 bits are
+  // used.
+  const size_t bytes =
+      (std::max<size_t>(key_hashes.size() * bits_per_key, 64) + 7) / 8;
+  const size_t bits = bytes * 8;
+
+  const size_t init_size = dst->size();
+  dst->resize(init_size + bytes, 0);
+  dst->push_back(static_cast<char>(num_probes));
+  char* array = &(*dst)[init_size];
+  for (uint32 h : key_hashes) {
+    const uint32 delta = (h >> 17) | (h << 15);  // Rotates right 17 bits.
+    for (int j = 0; j < num_probes; j++) {
+      const uint32 bitpos = h % bits;
+      array[bitpos / 8] |= (1 << (bitpos % 8));
+      h += delta;
+    }
+  }
+}
+
+bool BloomFilterMayMatch(uint32 key_hash, const StringPiece& filter) {
+  const size_t len = filter.size();
+  if (len < 2) return true;
+  const size_t bits = (len - 1) * 8;
+  const int num_probes = static_cast<uint8>(filter[len - 1]);
+  if (num_probes > 30) {
+    // Reserved for new encodings, which are considered to match.
+    return true;
+  }
+  uint32 h = key_hash;
+  const uint32 delta = (h >> 17) | (h << 15);
+  for (int j = 0; j < num_probes; j++) {
+    const uint32 bitpos = h % bits;
+    if ((filter[bitpos / 8] & (1 << (bitpos % 8))) == 0) return false;
+    h += delta;
+  }
+  return true;
+}
+
+}  // namespace table
+}  // namespace tensorflow
@@ -0,0 +1,46 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
+#define TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace table {
+
+// The key of the bloom filter of a table in its metaindex block.
+static const char kBloomFilterMetaKey[] = "filter.bloom";
+
+// Returns the hash of "key" that the bloom filters are built from.
+uint32 BloomHash(const StringPiece& key);
+
+// Appends to "dst" a bloom filter of the keys whose BloomHash() values are
+// "key_hashes", using about "bits_per_key" bits per key.
+void BuildBloomFilter(const std::vector<uint32>& key_hashes, int bits_per_key,
+                      string* dst);
+
+// Returns false if the key whose BloomHash() value is "key_hash" was not one
+// of the keys that "filter" was built from, and true if it may have been.
+bool BloomFilterMayMatch(uint32 key_hash, const StringPiece& filter);
+
+}  // namespace table
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
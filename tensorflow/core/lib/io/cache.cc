@@ -0,0 +1,257 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/cache.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace table {
+
+Cache::~Cache() {}
+
+namespace {
+
+// An entry is a heap-allocated structure.  Entries are kept in a circular
+// doubly linked list ordered by access time.
+struct LRUHandle : public Cache::Handle {
+  void* value;
+  void (*deleter)(const StringPiece&, void* value);
+  LRUHandle* next;
+  LRUHandle* prev;
+  size_t charge;
+  bool in_cache;  // Whether the entry is in the cache.
+  uint32 refs;    // References, including the cache's if in_cache.
+  string key;
+};
+
+// A single shard of the sharded cache.
+//
+// The cache keeps two linked lists of its entries.  Every entry is in exactly
+// one of them, unless it has been erased while clients still reference it.
+// - in_use_: the entries referenced by clients, in no particular order.
+// - lru_: the entries only referenced by the cache, in LRU order, so that
+//   the entries to evict are found in constant time.
+class LRUShard {
+ public:
+  LRUShard() {
+    lru_.next = lru_.prev = &lru_;
+    in_use_.next = in_use_.prev = &in_use_;
+  }
+
+  ~LRUShard() {
+    // Errors if a client still holds a handle.
+    CHECK(in_use_.next == &in_use_);
+    for (LRUHandle* e = lru_.next; e != &lru_;) {
+      LRUHandle* next = e->next;
+      CHECK(e->in_cache);
+      CHECK_EQ(e->refs, 1);
+      e->in_cache = false;
+      Unref(e);
+      e = next;
+    }
+  }
+
+  void SetCapacity(size_t capacity) { capacity_ = capacity; }
+
+  Cache::Handle* Insert(const StringPiece& key, void* value, size_t charge,
+                        void (*deleter)(const StringPiece& key, void* value)) {
+    LRUHandle* e = new LRUHandle;
+    e->value = value;
+    e->deleter = deleter;
+    e->charge = charge;
+    e->in_cache = false;
+    e->refs = 1;  // For the returned handle.
+    e->key.assign(key.data(), key.size());
+    e->next = e->prev = nullptr;
+
+    mutex_lock l(mu_);
+    if (capacity_ > 0) {
+      e->refs++;  // For the cache's reference.
+      e->in_cache = true;
+      ListAppend(&in_use_, e);
+      usage_ += charge;
+      auto it = table_.find(e->key);
+      if (it != table_.end()) {
+        LRUHandle* old = it->second;
+        table_.erase(it);
+        FinishErase(old);
+      }
+      table_.emplace(e->key, e);
+    }
+    while (usage_ > capacity_ && lru_.next != &lru_) {
+      LRUHandle* old = lru_.next;
+      table_.erase(old->key);
+      FinishErase(old);
+    }
+    return e;
+  }
+
+  Cache::Handle* Lookup(const StringPiece& key) {
+    mutex_lock l(mu_);
+    auto it = table_.find(key);
+    if (it == table_.end()) return nullptr;
+    Ref(it->second);
+    return it->second;
+  }
+
+  void Release(Cache::Handle* handle) {
+    mutex_lock l(mu_);
+    Unref(static_cast<LRUHandle*>(handle));
+  }
+
+  void Erase(const StringPiece& key) {
+    mutex_lock l(mu_);
+    auto it = table_.find(key);
+    if (it == table_.end()) return;
+    LRUHandle* e = it->second;
+    table_.erase(it);
+    FinishErase(e);
+  }
+
+  size_t TotalCharge() const {
+    mutex_lock l(mu_);
+    return usage_;
+  }
+
+ private:
+  static void ListRemove(LRUHandle* e) {
+    e->next->prev = e->prev;
+    e->prev->next = e->next;
+  }
+
+  // Makes "e" the newest entry of "list".
+  static void ListAppend(LRUHandle* list, LRUHandle* e) {
+    e->next = list;
+    e->prev = list->prev;
+    e->prev->next = e;
+    e->next->prev = e;
+  }
+
+  void Ref(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (e->refs == 1 && e->in_cache) {
+      // The first client reference moves the entry out of lru_.
+      ListRemove(e);
+      ListAppend(&in_use_, e);
+    }
+    e->refs++;
+  }
+
+  void Unref(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    CHECK_GT(e->refs, 0);
+    e->refs--;
+    if (e->refs == 0) {
+      // Deallocates the entry, which is no longer in the cache.
+      (*e->deleter)(e->key, e->value);
+      delete e;
+    } else if (e->in_cache && e->refs == 1) {
+      // The last client reference is gone, so the entry can be evicted.
+      ListRemove(e);
+      ListAppend(&lru_, e);
+    }
+  }
+
+  // Drops the reference of the cache to "e", once removed from table_.
+  void FinishErase(LRUHandle* e) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    ListRemove(e);
+    e->in_cache = false;
+    usage_ -= e->charge;
+    Unref(e);
+  }
+
+  // Set before use.
+  size_t capacity_ = 0;
+
+  mutable mutex mu_;
+  size_t usage_ GUARDED_BY(mu_) = 0;
+  // Dummy heads of the lists.
+  LRUHandle lru_ GUARDED_BY(mu_);
+  LRUHandle in_use_ GUARDED_BY(mu_);
+  // The keys point into the keys of the entries.
+  std::unordered_map<StringPiece, LRUHandle*, StringPieceHasher> table_
+      GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LRUShard);
+};
+
+// Spreads the entries over shards with their own locks, so that concurrent
+// readers rarely contend.
+class ShardedLRUCache : public Cache {
+ public:
+  explicit ShardedLRUCache(size_t capacity) {
+    const size_t per_shard = (capacity + (kNumShards - 1)) / kNumShards;
+    for (int s = 0; s < kNumShards; s++) {
+      shards_[s].SetCapacity(per_shard);
+    }
+  }
+
+  Handle* Insert(const StringPiece& key, void* value, size_t charge,
+                 void (*deleter)(const StringPiece& key,
+                                 void* value)) override {
+    return Shard(key)->Insert(key, value, charge, deleter);
+  }
+
+  Handle* Lookup(const StringPiece& key) override {
+    return Shard(key)->Lookup(key);
+  }
+
+  void Release(Handle* handle) override {
+    LRUHandle* e = static_cast<LRUHandle*>(handle);
+    Shard(e->key)->Release(handle);
+  }
+
+  void Erase(const StringPiece& key) override { Shard(key)->Erase(key); }
+
+  void* Value(Handle* handle) override {
+    return static_cast<LRUHandle*>(handle)->value;
+  }
+
+  uint64 NewId() override {
+    mutex_lock l(id_mu_);
+    return ++last_id_;
+  }
+
+  size_t TotalCharge() const override {
+    size_t total = 0;
+    for (int s = 0; s < kNumShards; s++) {
+      total += shards_[s].TotalCharge();
+    }
+    return total;
+  }
+
+ private:
+  static const int kNumShardBits = 4;
+  static const int kNumShards = 1 << kNumShardBits;
+
+  LRUShard* Shard(const StringPiece& key) {
+    return &shards_[Hash32(key.data(), key.size(), 0) >> (32 - kNumShardBits)];
+  }
+
+  LRUShard shards_[kNumShards];
+  mutex id_mu_;
+  uint64 last_id_ GUARDED_BY(id_mu_) = 0;
+};
+
+}  // namespace
+
+Cache* NewLRUCache(size_t capacity) { return new ShardedLRUCache(capacity); }
+
+}  // namespace table
+}  // namespace tensorflow
@@ -0,0 +1,203 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// The reads are I/O bound, so the default pool has more threads than cores.
+const int kDefaultNumThreads = 16;
+
+thread::ThreadPool* DefaultPool() {
+  static thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "readahead", kDefaultNumThreads);
+  return pool;
+}
+
+}  // namespace
+
+struct ReadaheadInputStream::Buffer {
+  int64 offset = 0;
+  // Written by ReadBuffer() before `done` is set, and immutable after.
+  string data;
+  Status status;
+  bool done = false;  // Guarded by the stream's mu_.
+};
+
+ReadaheadInputStream::ReadaheadInputStream(RandomAccessFile* file,
+                                           size_t buffer_bytes,
+                                           int num_buffers,
+                                           thread::ThreadPool* pool)
+    : file_(file),
+      buffer_bytes_(std::max<size_t>(buffer_bytes, 1)),
+      num_buffers_(std::max(num_buffers, 1)),
+      pool_(pool != nullptr ? pool : DefaultPool()),
+      eof_offset_(kint64max) {}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  mutex_lock l(mu_);
+  while (num_outstanding_ > 0) {
+    cond_var_.wait(l);
+  }
+}
+
+void ReadaheadInputStream::IssueReadsLocked() {
+  while (buffers_.size() < static_cast<size_t>(num_buffers_) &&
+         next_offset_ < eof_offset_) {
+    std::shared_ptr<Buffer> buffer = std::make_shared<Buffer>();
+    buffer->offset = next_offset_;
+    next_offset_ += buffer_bytes_;
+    buffers_.push_back(buffer);
+    ++num_outstanding_;
+    pool_->Schedule([this, buffer]() { ReadBuffer(buffer); });
+  }
+}
+
+void ReadaheadInputStream::ReadBuffer(std::shared_ptr<Buffer> buffer) {
+  buffer->data.resize(buffer_bytes_);
+  StringPiece data;
+  Status s =
+      file_->Read(buffer->offset, buffer_bytes_, &data, &buffer->data[0]);
+  if (errors::IsOutOfRange(s)) {
+    // A short read at the end of the file.
+    s = Status::OK();
+  }
+  if (data.data() != buffer->data.data()) {
+    memmove(&buffer->data[0], data.data(), data.size());
+  }
+  buffer->data.resize(data.size());
+  buffer->status = s;
+
+  mutex_lock l(mu_);
+  // An empty read past the end of the file does not tell where it ends.
+  if (s.ok() && data.size() < buffer_bytes_ &&
+      (!data.empty() || buffer->offset == 0)) {
+    eof_offset_ = buffer->offset + data.size();
+  }
+  buffer->done = true;
+  --num_outstanding_;
+  cond_var_.notify_all();
+}
+
+void ReadaheadInputStream::WaitForFrontLocked(mutex_lock* l) {
+  const std::shared_ptr<Buffer>& buffer = buffers_.front();
+  while (!buffer->done) {
+    cond_var_.wait(*l);
+  }
+}
+
+Status ReadaheadInputStream::ReadNBytes(int64 bytes_to_read, string* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  mutex_lock l(mu_);
+  return ReadLocked(bytes_to_read, result, &l);
+}
+
+Status ReadaheadInputStream::ReadLocked(int64 bytes_to_read, string* result,
+                                        mutex_lock* l) {
+  int64 bytes_read = 0;
+  while (bytes_read < bytes_to_read) {
+    IssueReadsLocked();
+    if (buffers_.empty()) {
+      return errors::OutOfRange("reached end of file");
+    }
+    WaitForFrontLocked(l);
+    std::shared_ptr<Buffer> buffer = buffers_.front();
+    TF_RETURN_IF_ERROR(buffer->status);
+    const int64 start = position_ - buffer->offset;
+    const int64 available = static_cast<int64>(buffer->data.size()) - start;
+    if (available <= 0) {
+      return errors::OutOfRange("reached end of file");
+    }
+    const int64 n = std::min(available, bytes_to_read - bytes_read);
+    if (result != nullptr) {
+      result->append(buffer->data, start, n);
+    }
+    bytes_read += n;
+    position_ += n;
+    if (n == available && buffer->data.size() == buffer_bytes_) {
+      buffers_.pop_front();
+    }
+  }
+  return Status::OK();
+}
+
+Status ReadaheadInputStream::SkipNBytes(int64 bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  if (bytes_to_skip == 0) {
+    return Status::OK();
+  }
+  mutex_lock l(mu_);
+  const int64 start = position_;
+  // Check that the last skipped byte is within the file without reading the
+  // ones before it.
+  SeekLocked(start + bytes_to_skip - 1);
+  Status s = ReadLocked(1, nullptr, &l);
+  if (!errors::IsOutOfRange(s)) {
+    return s;
+  }
+  if (eof_offset_ != kint64max && eof_offset_ >= start) {
+    SeekLocked(eof_offset_);
+    return s;
+  }
+  // The size of the file is not known, so find it by reading up to it, as
+  // the other streams do.
+  SeekLocked(start);
+  return ReadLocked(bytes_to_skip, nullptr, &l);
+}
+
+int64 ReadaheadInputStream::Tell() const {
+  mutex_lock l(mu_);
+  return position_;
+}
+
+Status ReadaheadInputStream::Seek(int64 position) {
+  if (position < 0) {
+    return errors::InvalidArgument("Can't seek to a negative position: ",
+                                   position);
+  }
+  mutex_lock l(mu_);
+  SeekLocked(position);
+  return Status::OK();
+}
+
+void ReadaheadInputStream::SeekLocked(int64 position) {
+  if (!buffers_.empty() && position < buffers_.front()->offset) {
+    buffers_.clear();
+  }
+  while (!buffers_.empty() &&
+         buffers_.front()->offset + buffer_bytes_ <= position) {
+    buffers_.pop_front();
+  }
+  if (buffers_.empty()) {
+    next_offset_ = position;
+  }
+  position_ = position;
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace io {
+
+// Wraps a RandomAccessFile in an InputStreamInterface that keeps up to
+// `num_buffers` reads of `buffer_bytes` each in flight ahead of the current
+// position, so that the latency of the file system (e.g. a remote one) is
+// overlapped with the consumer's work instead of being paid on every buffer
+// refill. The reads are issued to a thread pool.
+//
+// Reads must be mostly sequential to benefit: seeking outside of the
+// buffered range discards the buffers and restarts the reads at the new
+// position.
+//
+// A given instance of ReadaheadInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file` or `pool`, which must outlive *this.
+  // If `pool` is null, the reads are issued to a process-wide pool.
+  ReadaheadInputStream(RandomAccessFile* file, size_t buffer_bytes,
+                       int num_buffers, thread::ThreadPool* pool = nullptr);
+
+  // Waits for the reads in flight to finish.
+  ~ReadaheadInputStream() override;
+
+  Status ReadNBytes(int64 bytes_to_read, string* result) override;
+
+  Status SkipNBytes(int64 bytes_to_skip) override;
+
+  int64 Tell() const override;
+
+  // Seek to this offset within the file.
+  //
+  // Buffers before `position` are released. If `position` is not within the
+  // buffered range, all the buffers are discarded and the next read will
+  // wait for the reads that restart at `position`.
+  Status Seek(int64 position);
+
+  Status Reset() override { return Seek(0); }
+
+ private:
+  struct Buffer;
+
+  // Issues reads until `num_buffers_` buffers are outstanding, or until the
+  // end of the file is known to be buffered.
+  void IssueReadsLocked() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Waits for the read of `buffers_.front()` to finish.
+  void WaitForFrontLocked(mutex_lock* l) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void SeekLocked(int64 position) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Reads `bytes_to_read` bytes, and appends them to `*result` if it is not
+  // null.
+  Status ReadLocked(int64 bytes_to_read, string* result, mutex_lock* l)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Runs on `pool_`.
+  void ReadBuffer(std::shared_ptr<Buffer> buffer);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t buffer_bytes_;
+  const int num_buffers_;
+  thread::ThreadPool* const pool_;  // Not owned.
+
+  mutable mutex mu_;
+  condition_variable cond_var_;
+  // The buffers of [buffers_.front()->offset, next_offset_), in order. The
+  // front buffer holds position_.
+  std::deque<std::shared_ptr<Buffer>> buffers_ GUARDED_BY(mu_);
+  int64 position_ GUARDED_BY(mu_) = 0;
+  int64 next_offset_ GUARDED_BY(mu_) = 0;
+  // The size of the file, once a read has come back short, or kint64max.
+  int64 eof_offset_ GUARDED_BY(mu_);
+  // Number of scheduled ReadBuffer() calls that have not finished, including
+  // the ones for buffers that have been discarded.
+  int num_outstanding_ GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadaheadInputStream);
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_READAHEAD_INPUTSTREAM_H_
@@ -0,0 +1,107 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+const uint32 kVersion = 1;
+const uint64 kMagic = 0x7466726563696478ull;  // "tfrecidx"
+const size_t kFooterSize =
+    sizeof(uint64) + sizeof(uint32) + sizeof(uint32) + sizeof(uint64);
+
+}  // namespace
+
+string RecordIndexFilename(StringPiece record_filename) {
+  return strings::StrCat(record_filename, ".index");
+}
+
+RecordIndexWriter::RecordIndexWriter(WritableFile* dest) : dest_(dest) {}
+
+Status RecordIndexWriter::Add(uint64 offset) {
+  DCHECK(!finished_);
+  char buf[sizeof(uint64)];
+  core::EncodeFixed64(buf, offset);
+  crc_ = crc32c::Extend(crc_, buf, sizeof(buf));
+  ++num_records_;
+  return dest_->Append(StringPiece(buf, sizeof(buf)));
+}
+
+Status RecordIndexWriter::Finish() {
+  DCHECK(!finished_);
+  finished_ = true;
+  char footer[kFooterSize];
+  core::EncodeFixed64(footer, num_records_);
+  core::EncodeFixed32(footer + sizeof(uint64), crc32c::Mask(crc_));
+  core::EncodeFixed32(footer + sizeof(uint64) + sizeof(uint32), kVersion);
+  core::EncodeFixed64(footer + sizeof(uint64) + 2 * sizeof(uint32), kMagic);
+  return dest_->Append(StringPiece(footer, sizeof(footer)));
+}
+
+/* static */
+Status RecordIndex::Read(Env* env, const string& filename,
+                         RecordIndex* index) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &contents));
+  if (contents.size() < kFooterSize) {
+    return errors::DataLoss("Record index ", filename, " is truncated.");
+  }
+  const char* footer = contents.data() + contents.size() - kFooterSize;
+  const uint64 num_records = core::DecodeFixed64(footer);
+  const uint32 masked_crc = core::DecodeFixed32(footer + sizeof(uint64));
+  const uint32 version =
+      core::DecodeFixed32(footer + sizeof(uint64) + sizeof(uint32));
+  const uint64 magic =
+      core::DecodeFixed64(footer + sizeof(uint64) + 2 * sizeof(uint32));
+  if (magic != kMagic) {
+    return errors::DataLoss(filename, " is not a record index.");
+  }
+  if (version != kVersion) {
+    return errors::Unimplemented("Record index ", filename, " has version ",
+                                 version, ", but only version ", kVersion,
+                                 " is supported.");
+  }
+  const size_t offsets_size = contents.size() - kFooterSize;
+  if (offsets_size != num_records * sizeof(uint64)) {
+    return errors::DataLoss("Record index ", filename, " has ", offsets_size,
+                            " bytes of offsets for ", num_records,
+                            " records.");
+  }
+  if (crc32c::Unmask(masked_crc) !=
+      crc32c::Value(contents.data(), offsets_size)) {
+    return errors::DataLoss("Checksum mismatch in record index ", filename);
+  }
+
+  index->offsets_.resize(num_records);
+  for (uint64 i = 0; i < num_records; ++i) {
+    index->offsets_[i] = core::DecodeFixed64(contents.data() + i * 8);
+    if (i > 0 && index->offsets_[i] <= index->offsets_[i - 1]) {
+      return errors::DataLoss("Record index ", filename,
+                              " has decreasing offsets at record ", i);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_LIB_IO_RECORD_INDEX_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Env;
+class WritableFile;
+
+namespace io {
+
+// A record index is a sidecar file of an uncompressed TFRecord file that
+// holds the offset of each of its records, so that a reader can seek to
+// record N with RecordReader::ReadRecord() instead of reading the N records
+// before it. It lets readers split a file by record range, and resume after
+// a corrupted record at the offset of the next one.
+//
+// Format of an index file:
+//  uint64    offset[num_records]  (the offset of each record's header)
+//  uint64    num_records
+//  uint32    masked crc of offset[]
+//  uint32    version
+//  uint64    magic number
+// All the integers are little-endian.
+
+// Returns the name of the index file of the record file `record_filename`.
+string RecordIndexFilename(StringPiece record_filename);
+
+// Writes the index of a record file as its records are written.
+//
+// This class is not thread safe; external synchronization required.
+class RecordIndexWriter {
+ public:
+  // Create a writer that will append the index to "*dest".
+  // "*dest" must be initially empty.
+  // "*dest" must remain live while this writer is in use.
+  explicit RecordIndexWriter(WritableFile* dest);
+
+  // Appends the offset of the next record, which must be greater than the
+  // offset of the previous one.
+  Status Add(uint64 offset);
+
+  // Writes the footer of the index. Does *not* close the WritableFile.
+  //
+  // After calling Finish(), any further calls to `Add()` are invalid.
+  Status Finish();
+
+  int64 num_records() const { return num_records_; }
+
+ private:
+  WritableFile* dest_;
+  int64 num_records_ = 0;
+  uint32 crc_ = 0;
+  bool finished_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RecordIndexWriter);
+};
+
+// The offsets of the records of a record file, read from its index.
+class RecordIndex {
+ public:
+  RecordIndex() {}
+
+  // Reads the index file `filename`, and checks its checksum.
+  static Status Read(Env* env, const string& filename, RecordIndex* index);
+
+  int64 num_records() const { return offsets_.size(); }
+
+  // The offset of record `i`, for 0 <= i < num_records().
+  uint64 offset(int64 i) const { return offsets_[i]; }
+
+ private:
+  std::vector<uint64> offsets_;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_RECORD_INDEX_H_
@@ -0,0 +1,111 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+string Record(int i) { return strings::StrCat("record", string(i, 'x')); }
+
+// Writes `num_records` records to `fname`, and their index.
+void WriteIndexedFile(const string& fname, int num_records) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  std::unique_ptr<WritableFile> index_file;
+  TF_CHECK_OK(env->NewWritableFile(RecordIndexFilename(fname), &index_file));
+  RecordWriter writer(file.get(), RecordWriterOptions(), index_file.get());
+  for (int i = 0; i < num_records; ++i) {
+    TF_CHECK_OK(writer.WriteRecord(Record(i)));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  TF_CHECK_OK(index_file->Close());
+}
+
+TEST(RecordIndexTest, SeekToEachRecord) {
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/record_index_test";
+  const int kNumRecords = 20;
+  WriteIndexedFile(fname, kNumRecords);
+
+  RecordIndex index;
+  TF_ASSERT_OK(RecordIndex::Read(env, RecordIndexFilename(fname), &index));
+  ASSERT_EQ(kNumRecords, index.num_records());
+  EXPECT_EQ(0, index.offset(0));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+  RecordReader reader(file.get());
+  for (int i = kNumRecords - 1; i >= 0; --i) {
+    uint64 offset = index.offset(i);
+    string record;
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(Record(i), record);
+    if (i + 1 < kNumRecords) {
+      EXPECT_EQ(index.offset(i + 1), offset);
+    }
+  }
+}
+
+TEST(RecordIndexTest, EmptyFile) {
+  const string fname = testing::TmpDir() + "/record_index_test_empty";
+  WriteIndexedFile(fname, 0);
+  RecordIndex index;
+  TF_ASSERT_OK(
+      RecordIndex::Read(Env::Default(), RecordIndexFilename(fname), &index));
+  EXPECT_EQ(0, index.num_records());
+}
+
+TEST(RecordIndexTest, CorruptIndex) {
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/record_index_test_corrupt";
+  WriteIndexedFile(fname, 5);
+  const string index_fname = RecordIndexFilename(fname);
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, index_fname, &contents));
+
+  // Flip a bit of an offset.
+  string corrupt = contents;
+  corrupt[9] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(env, index_fname, corrupt));
+  RecordIndex index;
+  EXPECT_TRUE(
+      errors::IsDataLoss(RecordIndex::Read(env, index_fname, &index)));
+
+  // Truncate the index.
+  TF_ASSERT_OK(WriteStringToFile(env, index_fname, contents.substr(8)));
+  EXPECT_TRUE(
+      errors::IsDataLoss(RecordIndex::Read(env, index_fname, &index)));
+
+  // A record file is not an index.
+  EXPECT_TRUE(errors::IsDataLoss(RecordIndex::Read(env, fname, &index)));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
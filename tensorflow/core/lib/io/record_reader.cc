@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -57,7 +58,10 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
     : src_(file), options_(options) {
-  if (options.buffer_size > 0) {
+  if (options.buffer_size > 0 && options.num_readahead_buffers > 0) {
+    input_stream_.reset(new ReadaheadInputStream(
+        file, options.buffer_size, options.num_readahead_buffers));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(file, options.buffer_size));
   } else {
     input_stream_.reset(new RandomAccessInputStream(file));
@@ -79,9 +83,9 @@ RecordReader::RecordReader(RandomAccessFile* file,
 }
 
 // Read n+4 bytes from file, verify that checksum of first n bytes is
-// stored in the last 4 bytes and store the first n bytes in *result.
-// May use *storage as backing store.
-Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
+// stored in the last 4 bytes (if "verify" is true) and store the first n bytes
+// in *result. May use *storage as backing store.
+Status RecordReader::ReadChecksummed(uint64 offset, size_t n, bool verify,
                                      StringPiece* result, string* storage) {
   if (n >= SIZE_MAX - sizeof(uint32)) {
     return errors::DataLoss("record size too large");
@@ -110,7 +114,8 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
     }
 
     uint32 masked_crc = core::DecodeFixed32(storage->data() + n);
-    if (crc32c::Unmask(masked_crc) != crc32c::Value(storage->data(), n)) {
+    if (verify &&
+        crc32c::Unmask(masked_crc) != crc32c::Value(storage->data(), n)) {
       return errors::DataLoss("corrupted record at ", offset);
     }
     *result = StringPiece(storage->data(), n);
@@ -134,7 +139,8 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
       }
 
       const uint32 masked_crc = core::DecodeFixed32(storage->data() + n);
-      if (crc32c::Unmask(masked_crc) != crc32c::Value(storage->data(), n)) {
+      if (verify &&
+          crc32c::Unmask(masked_crc) != crc32c::Value(storage->data(), n)) {
         return errors::DataLoss("corrupted record at ", offset);
       }
       *result = StringPiece(storage->data(), n);
@@ -151,7 +157,8 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n,
         }
       }
       const uint32 masked_crc = core::DecodeFixed32(data.data() + n);
-      if (crc32c::Unmask(masked_crc) != crc32c::Value(data.data(), n)) {
+      if (verify &&
+          crc32c::Unmask(masked_crc) != crc32c::Value(data.data(), n)) {
         return errors::DataLoss("corrupted record at ", offset);
       }
       *result = StringPiece(data.data(), n);
@@ -169,15 +176,22 @@ Status RecordReader::ReadRecord(uint64* offset, string* record) {
 
   // Read header data.
   StringPiece lbuf;
-  Status s = ReadChecksummed(*offset, sizeof(uint64), &lbuf, record);
+  // The length is always verified, since a corrupted length would make the
+  // rest of the file unreadable.
+  Status s = ReadChecksummed(*offset, sizeof(uint64), true, &lbuf, record);
   if (!s.ok()) {
     return s;
   }
   const uint64 length = core::DecodeFixed64(lbuf.data());
 
   // Read data
+  bool verify_data = false;
+  if (options_.checksum_sample_period > 0) {
+    verify_data = num_records_read_ % options_.checksum_sample_period == 0;
+  }
   StringPiece data;
-  s = ReadChecksummed(*offset + kHeaderSize, length, &data, record);
+  s = ReadChecksummed(*offset + kHeaderSize, length, verify_data, &data,
+                      record);
   if (!s.ok()) {
     if (errors::IsOutOfRange(s)) {
       s = errors::DataLoss("truncated record at ", *offset);
@@ -192,6 +206,7 @@ Status RecordReader::ReadRecord(uint64* offset, string* record) {
 
   record->resize(data.size());
 
+  ++num_records_read_;
   *offset += kHeaderSize + length + kFooterSize;
   return Status::OK();
 }
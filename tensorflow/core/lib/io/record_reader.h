@@ -42,6 +42,19 @@ class RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64 buffer_size = 0;
 
+  // If non-zero (and buffer_size is non-zero), up to num_readahead_buffers
+  // reads of buffer_size bytes are issued ahead of the current offset on a
+  // background thread pool, instead of one read at a time when the buffer is
+  // empty. This hides the latency of remote file systems.
+  int64 num_readahead_buffers = 0;
+
+  // Controls how often the checksum of the data of a record is verified:
+  // 1 verifies every record, N > 1 verifies every Nth record read, and 0
+  // verifies none. The checksum of the length of each record is always
+  // verified. Only use values other than 1 for trusted data, e.g. files on
+  // local disks, where the cost of checksumming dominates reading.
+  int64 checksum_sample_period = 1;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -79,11 +92,12 @@ class RecordReader {
   Status SkipNBytes(uint64 offset);
 
  private:
-  Status ReadChecksummed(uint64 offset, size_t n, StringPiece* result,
-                         string* storage);
+  Status ReadChecksummed(uint64 offset, size_t n, bool verify,
+                         StringPiece* result, string* storage);
 
   RandomAccessFile* src_;
   RecordReaderOptions options_;
+  int64 num_records_read_ = 0;
   std::unique_ptr<InputStreamInterface> input_stream_;
 #if !defined(IS_SLIM_BUILD)
   std::unique_ptr<ZlibInputStream> zlib_input_stream_;
@@ -55,8 +55,15 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
 }
 
 RecordWriter::RecordWriter(WritableFile* dest,
-                           const RecordWriterOptions& options)
+                           const RecordWriterOptions& options,
+                           WritableFile* index_dest)
     : dest_(dest), options_(options) {
+  if (index_dest != nullptr) {
+    if (IsZlibCompressed(options)) {
+      LOG(FATAL) << "Compressed record files cannot be indexed.";
+    }
+    index_writer_.reset(new RecordIndexWriter(index_dest));
+  }
   if (IsZlibCompressed(options)) {
 // We don't have zlib available on all embedded platforms, so fail.
 #if defined(IS_SLIM_BUILD)
@@ -105,12 +112,22 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   char footer[sizeof(uint32)];
   core::EncodeFixed32(footer, MaskedCrc(data.data(), data.size()));
 
+  if (index_writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(index_writer_->Add(offset_));
+  }
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  offset_ += sizeof(header) + data.size() + sizeof(footer);
+  return Status::OK();
 }
 
 Status RecordWriter::Close() {
+  if (index_writer_ != nullptr) {
+    Status s = index_writer_->Finish();
+    index_writer_.reset();
+    TF_RETURN_IF_ERROR(s);
+  }
 #if !defined(IS_SLIM_BUILD)
   if (IsZlibCompressed(options_)) {
     Status s = dest_->Close();
@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_LIB_IO_RECORD_WRITER_H_
 #define TENSORFLOW_LIB_IO_RECORD_WRITER_H_
 
+#include <memory>
+
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
@@ -50,8 +53,13 @@ class RecordWriter {
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
+  //
+  // If "index_dest" is not null, the writer also appends the record index of
+  // "*dest" (see record_index.h) to "*index_dest", under the same conditions
+  // as "*dest". Only uncompressed files can be indexed.
   RecordWriter(WritableFile* dest,
-               const RecordWriterOptions& options = RecordWriterOptions());
+               const RecordWriterOptions& options = RecordWriterOptions(),
+               WritableFile* index_dest = nullptr);
 
   // Calls Close() and logs if an error occurs.
   //
@@ -75,6 +83,9 @@ class RecordWriter {
  private:
   WritableFile* dest_;
   RecordWriterOptions options_;
+  std::unique_ptr<RecordIndexWriter> index_writer_;
+  // The offset of the next record in "*dest".
+  uint64 offset_ = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RecordWriter);
 };
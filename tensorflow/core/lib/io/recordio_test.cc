@@ -157,6 +157,11 @@ class RecordioTest : public ::testing::Test {
 
   void ForceError() { source_.force_error_ = true; }
 
+  void SetReaderOptions(const RecordReaderOptions& options) {
+    delete reader_;
+    reader_ = new RecordReader(&source_, options);
+  }
+
   void StartReadingAt(uint64_t initial_offset) { readpos_ = initial_offset; }
 
   void CheckOffsetPastEndReturnsNoRecords(uint64_t offset_past_end) {
@@ -252,6 +257,41 @@ TEST_F(RecordioTest, CorruptDataCrc) {
   AssertHasSubstr(Read(), "Data loss");
 }
 
+TEST_F(RecordioTest, SampledChecksums) {
+  const int kRecordSize = 3 + 16;
+  for (int i = 0; i < 4; ++i) {
+    Write("foo");
+  }
+  // Corrupt the data of records 1 and 2.
+  IncrementByte(kRecordSize + 12, 10);
+  IncrementByte(2 * kRecordSize + 12, 10);
+  RecordReaderOptions options;
+  options.checksum_sample_period = 2;
+  SetReaderOptions(options);
+  ASSERT_EQ("foo", Read());
+  ASSERT_EQ("poo", Read());
+  AssertHasSubstr(Read(), "Data loss");
+}
+
+TEST_F(RecordioTest, SkipChecksums) {
+  Write("foo");
+  IncrementByte(12, 10);
+  RecordReaderOptions options;
+  options.checksum_sample_period = 0;
+  SetReaderOptions(options);
+  ASSERT_EQ("poo", Read());
+  ASSERT_EQ("EOF", Read());
+}
+
+TEST_F(RecordioTest, SkipChecksumsStillVerifiesLength) {
+  Write("foo");
+  IncrementByte(6, 100);
+  RecordReaderOptions options;
+  options.checksum_sample_period = 0;
+  SetReaderOptions(options);
+  AssertHasSubstr(Read(), "Data loss");
+}
+
 TEST_F(RecordioTest, ReadEnd) { CheckOffsetPastEndReturnsNoRecords(0); }
 
 TEST_F(RecordioTest, ReadPastEnd) { CheckOffsetPastEndReturnsNoRecords(5); }
@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/table.h"
 
+#include <memory>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/block.h"
+#include "tensorflow/core/lib/io/bloom_filter.h"
+#include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/table_options.h"
 #include "tensorflow/core/lib/io/two_level_iterator.h"
@@ -27,17 +31,51 @@ namespace tensorflow {
 namespace table {
 
 struct Table::Rep {
-  ~Rep() { delete index_block; }
+  ~Rep() {
+    delete index_block;
+    if (filter.heap_allocated) delete[] filter.data.data();
+  }
 
   Options options;
   Status status;
   RandomAccessFile* file;
-  // XXX  uint64 cache_id;
+  uint64 cache_id;
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
   Block* index_block;
+  // The bloom filter of the keys, if the table has one.
+  BlockContents filter;
 };
 
+namespace {
+
+// The size of a metaindex block without entries, which only holds its
+// restart array.
+const uint64 kEmptyMetaindexSize = 2 * sizeof(uint32);
+
+// Reads the bloom filter of the table into "filter", or leaves it empty if
+// the table has none or on error.
+Status ReadFilter(RandomAccessFile* file, const BlockHandle& metaindex_handle,
+                  BlockContents* filter) {
+  filter->data = StringPiece();
+  filter->heap_allocated = false;
+  if (metaindex_handle.size() <= kEmptyMetaindexSize) return Status::OK();
+  BlockContents contents;
+  TF_RETURN_IF_ERROR(ReadBlock(file, metaindex_handle, &contents));
+  Block metaindex(contents);
+  std::unique_ptr<Iterator> iter(metaindex.NewIterator());
+  iter->Seek(kBloomFilterMetaKey);
+  if (!iter->Valid() || iter->key() != kBloomFilterMetaKey) {
+    return iter->status();
+  }
+  BlockHandle filter_handle;
+  StringPiece input = iter->value();
+  TF_RETURN_IF_ERROR(filter_handle.DecodeFrom(&input));
+  return ReadBlock(file, filter_handle, filter);
+}
+
+}  // namespace
+
 Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
                    Table** table) {
   *table = nullptr;
@@ -65,6 +103,13 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     }
   }
 
+  BlockContents filter;
+  if (s.ok()) {
+    // The filter is not needed to serve requests, so errors reading it are
+    // not propagated.
+    ReadFilter(file, footer.metaindex_handle(), &filter).IgnoreError();
+  }
+
   if (s.ok()) {
     // We've successfully read the footer and the index block: we're
     // ready to serve requests.
@@ -73,8 +118,8 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     rep->file = file;
     rep->metaindex_handle = footer.metaindex_handle();
     rep->index_block = index_block;
-    // XXX    rep->cache_id = (options.block_cache ?
-    // options.block_cache->NewId() : 0);
+    rep->filter = filter;
+    rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
     *table = new Table(rep);
   } else {
     if (index_block) delete index_block;
@@ -89,13 +134,24 @@ static void DeleteBlock(void* arg, void* ignored) {
   delete reinterpret_cast<Block*>(arg);
 }
 
+static void DeleteCachedBlock(const StringPiece& key, void* value) {
+  Block* block = reinterpret_cast<Block*>(value);
+  delete block;
+}
+
+static void ReleaseBlock(void* arg, void* h) {
+  Cache* cache = reinterpret_cast<Cache*>(arg);
+  Cache::Handle* handle = reinterpret_cast<Cache::Handle*>(h);
+  cache->Release(handle);
+}
+
 // Convert an index iterator value (i.e., an encoded BlockHandle)
 // into an iterator over the contents of the corresponding block.
 Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
   Table* table = reinterpret_cast<Table*>(arg);
-  //  Cache* block_cache = table->rep_->options.block_cache;
+  Cache* block_cache = table->rep_->options.block_cache;
   Block* block = nullptr;
-  //  Cache::Handle* cache_handle = NULL;
+  Cache::Handle* cache_handle = nullptr;
 
   BlockHandle handle;
   StringPiece input = index_value;
@@ -105,16 +161,40 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
 
   if (s.ok()) {
     BlockContents contents;
-    s = ReadBlock(table->rep_->file, handle, &contents);
-    if (s.ok()) {
-      block = new Block(contents);
+    if (block_cache != nullptr) {
+      char cache_key_buffer[16];
+      core::EncodeFixed64(cache_key_buffer, table->rep_->cache_id);
+      core::EncodeFixed64(cache_key_buffer + 8, handle.offset());
+      StringPiece key(cache_key_buffer, sizeof(cache_key_buffer));
+      cache_handle = block_cache->Lookup(key);
+      if (cache_handle != nullptr) {
+        block = reinterpret_cast<Block*>(block_cache->Value(cache_handle));
+      } else {
+        s = ReadBlock(table->rep_->file, handle, &contents);
+        if (s.ok()) {
+          block = new Block(contents);
+          if (contents.cachable) {
+            cache_handle = block_cache->Insert(key, block, block->size(),
+                                               &DeleteCachedBlock);
+          }
+        }
+      }
+    } else {
+      s = ReadBlock(table->rep_->file, handle, &contents);
+      if (s.ok()) {
+        block = new Block(contents);
+      }
     }
   }
 
   Iterator* iter;
   if (block != nullptr) {
     iter = block->NewIterator();
-    iter->RegisterCleanup(&DeleteBlock, block, nullptr);
+    if (cache_handle == nullptr) {
+      iter->RegisterCleanup(&DeleteBlock, block, nullptr);
+    } else {
+      iter->RegisterCleanup(&ReleaseBlock, block_cache, cache_handle);
+    }
   } else {
     iter = NewErrorIterator(s);
   }
@@ -130,6 +210,7 @@ Status Table::InternalGet(const StringPiece& k, void* arg,
                           void (*saver)(void*, const StringPiece&,
                                         const StringPiece&)) {
   Status s;
+  if (!KeyMayMatch(k)) return s;
   Iterator* iiter = rep_->index_block->NewIterator();
   iiter->Seek(k);
   if (iiter->Valid()) {
@@ -149,6 +230,11 @@ Status Table::InternalGet(const StringPiece& k, void* arg,
   return s;
 }
 
+bool Table::KeyMayMatch(const StringPiece& key) const {
+  if (rep_->filter.data.empty()) return true;
+  return BloomFilterMayMatch(BloomHash(key), rep_->filter.data);
+}
+
 uint64 Table::ApproximateOffsetOf(const StringPiece& key) const {
   Iterator* index_iter = rep_->index_block->NewIterator();
   index_iter->Seek(key);
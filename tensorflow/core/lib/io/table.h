@@ -62,6 +62,10 @@ class Table {
   // be close to the file length.
   uint64 ApproximateOffsetOf(const StringPiece& key) const;
 
+  // Returns false if the bloom filter of the table shows that "key" is not
+  // in the table, and true otherwise, e.g. if the table has no filter.
+  bool KeyMayMatch(const StringPiece& key) const;
+
  private:
   struct Rep;
   Rep* rep_;
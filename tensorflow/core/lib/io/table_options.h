@@ -21,6 +21,8 @@ limitations under the License.
 namespace tensorflow {
 namespace table {
 
+class Cache;
+
 // DB contents are stored in a set of blocks, each of which holds a
 // sequence of key,value pairs.  Each block may be compressed before
 // being stored in a file.  The following enum describes which
@@ -60,6 +62,18 @@ struct Options {
   // incompressible, the kSnappyCompression implementation will
   // efficiently detect that and will switch to uncompressed mode.
   CompressionType compression = kSnappyCompression;
+
+  // If non-null, use the specified cache for the data blocks read by a
+  // table, so that lookups near recently read keys do not read their block
+  // again.  The cache may be shared by any number of tables.  If null, data
+  // blocks are read from the file each time they are needed.
+  Cache* block_cache = nullptr;
+
+  // If positive, a table builder stores with the table a bloom filter of its
+  // keys with about this many bits per key, which lets lookups of keys that
+  // are not in the table skip reading data blocks.  10 gives a false positive
+  // rate of about 1%.  Readers use the filter of a table whenever it has one.
+  int filter_bits_per_key = 0;
 };
 
 }  // namespace table
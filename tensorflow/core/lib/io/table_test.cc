@@ -17,16 +17,19 @@ limitations under the License.
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/block.h"
 #include "tensorflow/core/lib/io/block_builder.h"
+#include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/iterator.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
@@ -224,6 +227,7 @@ class TableConstructor : public Constructor {
     // Open the table
     source_ = new StringSource(sink.contents());
     Options table_options;
+    table_options.block_cache = options.block_cache;
     return Table::Open(table_options, source_, sink.contents().size(), &table_);
   }
 
@@ -233,6 +237,10 @@ class TableConstructor : public Constructor {
     return table_->ApproximateOffsetOf(key);
   }
 
+  bool KeyMayMatch(const StringPiece& key) const {
+    return table_->KeyMayMatch(key);
+  }
+
   uint64 BytesRead() const { return source_->BytesRead(); }
 
  private:
@@ -252,11 +260,14 @@ enum TestType { TABLE_TEST, BLOCK_TEST };
 struct TestArgs {
   TestType type;
   int restart_interval;
+  // Whether tables have a small block cache and a bloom filter.
+  bool cache_and_filter;
 };
 
 static const TestArgs kTestArgList[] = {
-    {TABLE_TEST, 16}, {TABLE_TEST, 1}, {TABLE_TEST, 1024},
-    {BLOCK_TEST, 16}, {BLOCK_TEST, 1}, {BLOCK_TEST, 1024},
+    {TABLE_TEST, 16},       {TABLE_TEST, 1},       {TABLE_TEST, 1024},
+    {TABLE_TEST, 16, true}, {TABLE_TEST, 1, true}, {BLOCK_TEST, 16},
+    {BLOCK_TEST, 1},        {BLOCK_TEST, 1024},
 };
 static const int kNumTestArgs = sizeof(kTestArgList) / sizeof(kTestArgList[0]);
 
@@ -273,6 +284,12 @@ class Harness : public ::testing::Test {
     // Use shorter block size for tests to exercise block boundary
     // conditions more.
     options_.block_size = 256;
+    if (args.cache_and_filter) {
+      // Smaller than most tables of the tests, to exercise eviction.
+      block_cache_.reset(NewLRUCache(2048));
+      options_.block_cache = block_cache_.get();
+      options_.filter_bits_per_key = 10;
+    }
     switch (args.type) {
       case TABLE_TEST:
         constructor_ = new TableConstructor();
@@ -413,6 +430,7 @@ class Harness : public ::testing::Test {
 
  private:
   Options options_;
+  std::unique_ptr<Cache> block_cache_;
   Constructor* constructor_;
 };
 
@@ -621,5 +639,77 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+TEST(TableTest, BlockCacheAvoidsRereads) {
+  std::unique_ptr<Cache> cache(NewLRUCache(1 << 20));
+  TableConstructor c;
+  c.Add("k01", string(5000, 'a'));
+  c.Add("k02", string(5000, 'b'));
+  c.Add("k03", string(5000, 'c'));
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 1024;
+  options.compression = kNoCompression;
+  options.block_cache = cache.get();
+  c.Finish(options, &keys, &kvmap);
+
+  for (const char* key : {"k01", "k03"}) {
+    std::unique_ptr<Iterator> iter(c.NewIterator());
+    iter->Seek(key);
+    ASSERT_TRUE(iter->Valid());
+    EXPECT_EQ(kvmap[key], iter->value());
+  }
+  EXPECT_GT(cache->TotalCharge(), 10000);
+  // Both blocks are read from the cache this time.
+  const uint64 bytes_read = c.BytesRead();
+  for (const char* key : {"k01", "k03"}) {
+    std::unique_ptr<Iterator> iter(c.NewIterator());
+    iter->Seek(key);
+    ASSERT_TRUE(iter->Valid());
+    EXPECT_EQ(kvmap[key], iter->value());
+  }
+  EXPECT_EQ(bytes_read, c.BytesRead());
+}
+
+TEST(TableTest, BloomFilter) {
+  TableConstructor c;
+  for (int i = 0; i < 1000; i++) {
+    c.Add(strings::StrCat("key", i), "value");
+  }
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 1024;
+  options.filter_bits_per_key = 10;
+  c.Finish(options, &keys, &kvmap);
+
+  for (const string& key : keys) {
+    EXPECT_TRUE(c.KeyMayMatch(key)) << key;
+  }
+  int false_positives = 0;
+  for (int i = 0; i < 1000; i++) {
+    if (c.KeyMayMatch(strings::StrCat("absent", i))) false_positives++;
+  }
+  // The expected rate is about 1%.
+  EXPECT_LT(false_positives, 30);
+
+  // The filter is only consulted by point lookups; iteration still sees
+  // every key.
+  std::unique_ptr<Iterator> iter(c.NewIterator());
+  int num_keys = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) num_keys++;
+  EXPECT_EQ(1000, num_keys);
+}
+
+TEST(TableTest, NoBloomFilter) {
+  TableConstructor c;
+  c.Add("k01", "v");
+  std::vector<string> keys;
+  KVMap kvmap;
+  c.Finish(Options(), &keys, &kvmap);
+  EXPECT_TRUE(c.KeyMayMatch("k01"));
+  EXPECT_TRUE(c.KeyMayMatch("absent"));
+}
+
 }  // namespace table
 }  // namespace tensorflow
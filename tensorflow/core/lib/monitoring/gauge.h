@@ -77,6 +77,11 @@ class GaugeCell<int64> {
   // Atomically sets the value.
   void Set(int64 value);
 
+  // Atomically adds 'step', which may be negative, to the value. Lets
+  // several threads maintain a level such as a queue length without
+  // reading it first.
+  void IncrementBy(int64 step);
+
   // Retrieves the current value.
   int64 value() const;
 
@@ -194,6 +199,8 @@ T GaugeCell<T>::value() const {
 
 inline void GaugeCell<int64>::Set(int64 value) { value_ = value; }
 
+inline void GaugeCell<int64>::IncrementBy(int64 step) { value_ += step; }
+
 inline int64 GaugeCell<int64>::value() const { return value_; }
 
 inline void GaugeCell<bool>::Set(bool value) { value_ = value; }
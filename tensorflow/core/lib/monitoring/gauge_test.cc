@@ -43,6 +43,13 @@ TEST(LabeledGaugeTest, GetCell) {
   EXPECT_EQ(10, same_cell->value());
 }
 
+TEST(LabeledGaugeTest, IncrementBy) {
+  auto* cell = gauge_with_labels->GetCell("IncrementByOp");
+  cell->IncrementBy(3);
+  cell->IncrementBy(-1);
+  EXPECT_EQ(2, cell->value());
+}
+
 auto* gauge_without_labels = Gauge<int64, 0>::New(
     "/tensorflow/test/gauge_without_labels", "Gauge without any labels.");
 
@@ -33,6 +33,7 @@ class GaugeCell {
   ~GaugeCell() {}
 
   void Set(const T& value) {}
+  void IncrementBy(int64 step) {}
   T value() const { return T(); }
 
  private:
@@ -0,0 +1,221 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/prometheus_exporter.h"
+
+#include <algorithm>
+#include <cfloat>
+
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+namespace {
+
+string PrometheusName(const string& name) {
+  string result;
+  for (const char c : name) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+        c == ':' || (!result.empty() && c >= '0' && c <= '9')) {
+      result.push_back(c);
+    } else if (!result.empty()) {
+      result.push_back('_');
+    }
+  }
+  return result;
+}
+
+// Escapes '\' and newlines, and also '"' if 'quote' is true.
+string Escape(const string& s, bool quote) {
+  string result;
+  for (const char c : s) {
+    if (c == '\\') {
+      result.append("\\\\");
+    } else if (c == '\n') {
+      result.append("\\n");
+    } else if (c == '"' && quote) {
+      result.append("\\\"");
+    } else {
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
+// Returns the label set of 'point' followed by 'extra_name'="extra_value"
+// if 'extra_name' is not empty, e.g. {op="MatMul",le="+Inf"}.
+string Labels(const Point& point, const string& extra_name = "",
+              const string& extra_value = "") {
+  if (point.labels.empty() && extra_name.empty()) return "";
+  string result = "{";
+  for (const Point::Label& label : point.labels) {
+    if (result.size() > 1) result.push_back(',');
+    strings::StrAppend(&result, PrometheusName(label.name), "=\"",
+                       Escape(label.value, true), "\"");
+  }
+  if (!extra_name.empty()) {
+    if (result.size() > 1) result.push_back(',');
+    strings::StrAppend(&result, extra_name, "=\"", Escape(extra_value, true),
+                       "\"");
+  }
+  result.push_back('}');
+  return result;
+}
+
+string BucketLimit(double limit) {
+  return limit == DBL_MAX ? "+Inf" : strings::StrCat(limit);
+}
+
+void AppendHistogram(const string& name, const Point& point, string* out) {
+  const HistogramProto& histogram = point.histogram_value;
+  double cumulative_count = 0;
+  bool has_infinite_bucket = false;
+  for (int i = 0; i < histogram.bucket_size(); ++i) {
+    cumulative_count += histogram.bucket(i);
+    const double limit =
+        i < histogram.bucket_limit_size() ? histogram.bucket_limit(i) : DBL_MAX;
+    has_infinite_bucket = limit == DBL_MAX;
+    strings::StrAppend(out, name, "_bucket",
+                       Labels(point, "le", BucketLimit(limit)), " ",
+                       cumulative_count, "\n");
+  }
+  if (!has_infinite_bucket) {
+    strings::StrAppend(out, name, "_bucket", Labels(point, "le", "+Inf"), " ",
+                       histogram.num(), "\n");
+  }
+  strings::StrAppend(out, name, "_sum", Labels(point), " ", histogram.sum(),
+                     "\n");
+  strings::StrAppend(out, name, "_count", Labels(point), " ",
+                     histogram.num(), "\n");
+}
+
+}  // namespace
+
+string PrometheusText(const CollectedMetrics& metrics) {
+  string out;
+  for (const auto& entry : metrics.point_set_map) {
+    const PointSet& point_set = *entry.second;
+    const string name = PrometheusName(point_set.metric_name);
+    if (name.empty()) continue;
+
+    const auto descriptor_it =
+        metrics.metric_descriptor_map.find(point_set.metric_name);
+    const MetricDescriptor* descriptor =
+        descriptor_it == metrics.metric_descriptor_map.end()
+            ? nullptr
+            : descriptor_it->second.get();
+    ValueType value_type;
+    if (descriptor != nullptr) {
+      value_type = descriptor->value_type;
+    } else if (!point_set.points.empty()) {
+      value_type = point_set.points[0]->value_type;
+    } else {
+      continue;
+    }
+    const char* type = "gauge";
+    if (value_type == ValueType::kHistogram) {
+      type = "histogram";
+    } else if (value_type == ValueType::kInt64 && descriptor != nullptr &&
+               descriptor->metric_kind == MetricKind::kCumulative) {
+      type = "counter";
+    }
+    if (descriptor != nullptr) {
+      strings::StrAppend(&out, "# HELP ", name, " ",
+                         Escape(descriptor->description, false), "\n");
+    }
+    strings::StrAppend(&out, "# TYPE ", name, " ", type, "\n");
+
+    for (const auto& point : point_set.points) {
+      switch (point->value_type) {
+        case ValueType::kInt64:
+          strings::StrAppend(&out, name, Labels(*point), " ",
+                             point->int64_value, "\n");
+          break;
+        case ValueType::kBool:
+          strings::StrAppend(&out, name, Labels(*point), " ",
+                             point->bool_value ? 1 : 0, "\n");
+          break;
+        case ValueType::kString:
+          strings::StrAppend(&out, name,
+                             Labels(*point, "value", point->string_value),
+                             " 1\n");
+          break;
+        case ValueType::kHistogram:
+          AppendHistogram(name, *point, &out);
+          break;
+      }
+    }
+  }
+  return out;
+}
+
+Status WritePrometheusTextFile(Env* env, const string& path) {
+  const std::unique_ptr<CollectedMetrics> metrics =
+      CollectionRegistry::Default()->CollectMetrics({});
+  const string tmp_path = strings::StrCat(path, ".tmp");
+  TF_RETURN_IF_ERROR(
+      WriteStringToFile(env, tmp_path, PrometheusText(*metrics)));
+  return env->RenameFile(tmp_path, path);
+}
+
+PeriodicPrometheusWriter::PeriodicPrometheusWriter(Env* env,
+                                                   const string& path,
+                                                   int64 interval_micros)
+    : env_(env), path_(path), interval_micros_(interval_micros) {
+  thread_.reset(env_->StartThread(ThreadOptions(), "tf_prometheus_writer",
+                                  [this]() { WriteLoop(); }));
+}
+
+PeriodicPrometheusWriter::~PeriodicPrometheusWriter() {
+  {
+    mutex_lock l(mu_);
+    stop_ = true;
+  }
+  cond_var_.notify_all();
+  // Joins the thread.
+  thread_.reset();
+  Write();
+}
+
+void PeriodicPrometheusWriter::WriteLoop() {
+  for (;;) {
+    {
+      mutex_lock l(mu_);
+      uint64 now_micros = env_->NowMicros();
+      const uint64 deadline_micros = now_micros + interval_micros_;
+      while (!stop_ && now_micros < deadline_micros) {
+        WaitForMilliseconds(
+            &l, &cond_var_,
+            std::max<int64>(1, (deadline_micros - now_micros) / 1000));
+        now_micros = env_->NowMicros();
+      }
+      if (stop_) return;
+    }
+    Write();
+  }
+}
+
+void PeriodicPrometheusWriter::Write() {
+  const Status s = WritePrometheusTextFile(env_, path_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to write metrics to " << path_ << ": " << s;
+  }
+}
+
+}  // namespace monitoring
+}  // namespace tensorflow
@@ -0,0 +1,75 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/monitoring/collected_metrics.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace monitoring {
+
+// Renders 'metrics' in the Prometheus text exposition format (version
+// 0.0.4). Metric names lose their leading '/' and have every other
+// character that Prometheus does not allow replaced by '_', so
+// "/tensorflow/core/graph_runs" becomes "tensorflow_core_graph_runs".
+// Cumulative int64 metrics are exported as counters, histograms as
+// histograms, and the other metrics as gauges. Bool values are exported as 0
+// or 1, and string values as a "value" label of a sample equal to 1.
+string PrometheusText(const CollectedMetrics& metrics);
+
+// Collects the metrics of CollectionRegistry::Default() and writes them to
+// 'path' in the Prometheus text format. The file is written under a
+// temporary name and renamed, so a reader never sees a partial file.
+Status WritePrometheusTextFile(Env* env, const string& path);
+
+// Calls WritePrometheusTextFile(env, path) from a background thread every
+// 'interval_micros', for scraping by a node exporter's textfile collector or
+// similar agents. The file is written one last time on destruction.
+class PeriodicPrometheusWriter {
+ public:
+  PeriodicPrometheusWriter(Env* env, const string& path,
+                           int64 interval_micros);
+  ~PeriodicPrometheusWriter();
+
+ private:
+  void WriteLoop();
+  void Write();
+
+  Env* const env_;
+  const string path_;
+  const int64 interval_micros_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool stop_ GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PeriodicPrometheusWriter);
+};
+
+}  // namespace monitoring
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_LIB_MONITORING_PROMETHEUS_EXPORTER_H_
@@ -0,0 +1,143 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/monitoring/prometheus_exporter.h"
+
+#include <cfloat>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace monitoring {
+namespace {
+
+// Adds a metric with the given descriptor fields to 'metrics' and returns
+// its point set.
+PointSet* AddMetric(const string& name, const string& description,
+                    MetricKind kind, ValueType value_type,
+                    CollectedMetrics* metrics) {
+  std::unique_ptr<MetricDescriptor> descriptor(new MetricDescriptor);
+  descriptor->name = name;
+  descriptor->description = description;
+  descriptor->metric_kind = kind;
+  descriptor->value_type = value_type;
+  metrics->metric_descriptor_map[name] = std::move(descriptor);
+  std::unique_ptr<PointSet> point_set(new PointSet);
+  point_set->metric_name = name;
+  PointSet* result = point_set.get();
+  metrics->point_set_map[name] = std::move(point_set);
+  return result;
+}
+
+Point* AddPoint(ValueType value_type, const string& label_value,
+                PointSet* point_set) {
+  std::unique_ptr<Point> point(new Point);
+  point->value_type = value_type;
+  if (!label_value.empty()) {
+    point->labels.push_back({"op", label_value});
+  }
+  point_set->points.push_back(std::move(point));
+  return point_set->points.back().get();
+}
+
+TEST(PrometheusTextTest, Counter) {
+  CollectedMetrics metrics;
+  PointSet* runs = AddMetric("/tensorflow/core/graph_runs", "Graph runs.",
+                             MetricKind::kCumulative, ValueType::kInt64,
+                             &metrics);
+  AddPoint(ValueType::kInt64, "", runs)->int64_value = 42;
+  EXPECT_EQ(
+      "# HELP tensorflow_core_graph_runs Graph runs.\n"
+      "# TYPE tensorflow_core_graph_runs counter\n"
+      "tensorflow_core_graph_runs 42\n",
+      PrometheusText(metrics));
+}
+
+TEST(PrometheusTextTest, GaugesWithLabels) {
+  CollectedMetrics metrics;
+  PointSet* bytes = AddMetric("/tensorflow/core/bytes", "Bytes\nin use.",
+                              MetricKind::kGauge, ValueType::kInt64, &metrics);
+  AddPoint(ValueType::kInt64, "GPU_0_bfc", bytes)->int64_value = 7;
+  AddPoint(ValueType::kInt64, "a\"b\\c", bytes)->int64_value = 8;
+  PointSet* flag = AddMetric("/t/flag", "A flag.", MetricKind::kGauge,
+                             ValueType::kBool, &metrics);
+  AddPoint(ValueType::kBool, "", flag)->bool_value = true;
+  PointSet* version = AddMetric("/t/version", "A string.", MetricKind::kGauge,
+                                ValueType::kString, &metrics);
+  AddPoint(ValueType::kString, "", version)->string_value = "1.4";
+  EXPECT_EQ(
+      "# HELP t_flag A flag.\n"
+      "# TYPE t_flag gauge\n"
+      "t_flag 1\n"
+      "# HELP t_version A string.\n"
+      "# TYPE t_version gauge\n"
+      "t_version{value=\"1.4\"} 1\n"
+      "# HELP tensorflow_core_bytes Bytes\\nin use.\n"
+      "# TYPE tensorflow_core_bytes gauge\n"
+      "tensorflow_core_bytes{op=\"GPU_0_bfc\"} 7\n"
+      "tensorflow_core_bytes{op=\"a\\\"b\\\\c\"} 8\n",
+      PrometheusText(metrics));
+}
+
+TEST(PrometheusTextTest, Histogram) {
+  CollectedMetrics metrics;
+  PointSet* latency = AddMetric("/t/latency", "Latency.",
+                                MetricKind::kCumulative,
+                                ValueType::kHistogram, &metrics);
+  HistogramProto* histogram =
+      &AddPoint(ValueType::kHistogram, "MatMul", latency)->histogram_value;
+  histogram->set_num(3);
+  histogram->set_sum(25);
+  histogram->add_bucket_limit(10);
+  histogram->add_bucket(2);
+  histogram->add_bucket_limit(DBL_MAX);
+  histogram->add_bucket(1);
+  EXPECT_EQ(
+      "# HELP t_latency Latency.\n"
+      "# TYPE t_latency histogram\n"
+      "t_latency_bucket{op=\"MatMul\",le=\"10\"} 2\n"
+      "t_latency_bucket{op=\"MatMul\",le=\"+Inf\"} 3\n"
+      "t_latency_sum{op=\"MatMul\"} 25\n"
+      "t_latency_count{op=\"MatMul\"} 3\n",
+      PrometheusText(metrics));
+}
+
+auto* test_counter = Counter<0>::New("/tensorflow/test/prometheus_counter",
+                                     "Counter written by the test.");
+
+TEST(WritePrometheusTextFileTest, WritesRegisteredMetrics) {
+  test_counter->GetCell()->IncrementBy(5);
+  const string path =
+      io::JoinPath(testing::TmpDir(), "prometheus_exporter_test.prom");
+  TF_ASSERT_OK(WritePrometheusTextFile(Env::Default(), path));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), path, &contents));
+  EXPECT_NE(string::npos,
+            contents.find("\ntensorflow_test_prometheus_counter 5\n"));
+}
+
+TEST(PeriodicPrometheusWriterTest, WritesOnDestruction) {
+  const string path =
+      io::JoinPath(testing::TmpDir(), "prometheus_exporter_periodic.prom");
+  { PeriodicPrometheusWriter writer(Env::Default(), path, 3600 * 1000000LL); }
+  TF_EXPECT_OK(Env::Default()->FileExists(path));
+}
+
+}  // namespace
+}  // namespace monitoring
+}  // namespace tensorflow
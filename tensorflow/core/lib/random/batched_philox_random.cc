@@ -0,0 +1,176 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/random/batched_philox_random.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace tensorflow {
+namespace random {
+
+namespace {
+
+// The constants of PhiloxRandom.
+const uint32 kPhiloxW32A = 0x9E3779B9;
+const uint32 kPhiloxW32B = 0xBB67AE85;
+const uint32 kPhiloxM4x32A = 0xD2511F53;
+const uint32 kPhiloxM4x32B = 0xCD9E8D57;
+
+// Each 'Lanes' below holds one 32-bit word of kCount Philox streams, and
+// MultiplyHighLow() sets 'lo' and 'hi' to the low and high halves of the
+// 64-bit products of the lanes of 'a' and 'b'.
+#if defined(__AVX512F__)
+#define PHILOX_HAVE_LANES
+struct Lanes {
+  typedef __m512i Vec;
+  static const int kCount = 16;
+  static Vec Set(uint32 v) { return _mm512_set1_epi32(v); }
+  static Vec Load(const uint32* p) { return _mm512_loadu_si512(p); }
+  static void Store(uint32* p, Vec v) { _mm512_storeu_si512(p, v); }
+  static Vec Xor(Vec a, Vec b) { return _mm512_xor_si512(a, b); }
+  static void MultiplyHighLow(Vec a, Vec b, Vec* lo, Vec* hi) {
+    const Vec even = _mm512_mul_epu32(a, b);
+    const Vec odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32),
+                                     _mm512_srli_epi64(b, 32));
+    const Vec low_mask = _mm512_set1_epi64(0xFFFFFFFF);
+    *lo = _mm512_or_si512(_mm512_and_si512(even, low_mask),
+                          _mm512_slli_epi64(odd, 32));
+    *hi = _mm512_or_si512(_mm512_srli_epi64(even, 32),
+                          _mm512_andnot_si512(low_mask, odd));
+  }
+};
+#elif defined(__AVX2__)
+#define PHILOX_HAVE_LANES
+struct Lanes {
+  typedef __m256i Vec;
+  static const int kCount = 8;
+  static Vec Set(uint32 v) { return _mm256_set1_epi32(v); }
+  static Vec Load(const uint32* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const Vec*>(p));
+  }
+  static void Store(uint32* p, Vec v) {
+    _mm256_storeu_si256(reinterpret_cast<Vec*>(p), v);
+  }
+  static Vec Xor(Vec a, Vec b) { return _mm256_xor_si256(a, b); }
+  static void MultiplyHighLow(Vec a, Vec b, Vec* lo, Vec* hi) {
+    const Vec even = _mm256_mul_epu32(a, b);
+    const Vec odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32),
+                                     _mm256_srli_epi64(b, 32));
+    const Vec low_mask = _mm256_set1_epi64x(0xFFFFFFFF);
+    *lo = _mm256_or_si256(_mm256_and_si256(even, low_mask),
+                          _mm256_slli_epi64(odd, 32));
+    *hi = _mm256_or_si256(_mm256_srli_epi64(even, 32),
+                          _mm256_andnot_si256(low_mask, odd));
+  }
+};
+#elif defined(__ARM_NEON)
+#define PHILOX_HAVE_LANES
+struct Lanes {
+  typedef uint32x4_t Vec;
+  static const int kCount = 4;
+  static Vec Set(uint32 v) { return vdupq_n_u32(v); }
+  static Vec Load(const uint32* p) { return vld1q_u32(p); }
+  static void Store(uint32* p, Vec v) { vst1q_u32(p, v); }
+  static Vec Xor(Vec a, Vec b) { return veorq_u32(a, b); }
+  static void MultiplyHighLow(Vec a, Vec b, Vec* lo, Vec* hi) {
+    const uint64x2_t low = vmull_u32(vget_low_u32(a), vget_low_u32(b));
+    const uint64x2_t high = vmull_u32(vget_high_u32(a), vget_high_u32(b));
+    *lo = vcombine_u32(vmovn_u64(low), vmovn_u64(high));
+    *hi = vcombine_u32(vshrn_n_u64(low, 32), vshrn_n_u64(high, 32));
+  }
+};
+#endif
+
+#ifdef PHILOX_HAVE_LANES
+// Computes the Lanes::kCount groups that follow 'counter', which must not
+// carry out of its lowest word within them. Lane j runs the rounds of
+// PhiloxRandom::operator() on counter + j.
+void ComputeLanes(const PhiloxRandom::ResultType& counter,
+                  const PhiloxRandom::Key& key,
+                  PhiloxRandom::ResultType* results) {
+  typedef Lanes::Vec Vec;
+  uint32 words[PhiloxRandom::kResultElementCount][Lanes::kCount];
+  for (int j = 0; j < Lanes::kCount; ++j) {
+    words[0][j] = counter[0] + j;
+  }
+  Vec c0 = Lanes::Load(words[0]);
+  Vec c1 = Lanes::Set(counter[1]);
+  Vec c2 = Lanes::Set(counter[2]);
+  Vec c3 = Lanes::Set(counter[3]);
+  const Vec multiplier_a = Lanes::Set(kPhiloxM4x32A);
+  const Vec multiplier_b = Lanes::Set(kPhiloxM4x32B);
+  uint32 key0 = key[0];
+  uint32 key1 = key[1];
+  for (int round = 0; round < 10; ++round) {
+    Vec lo0, hi0, lo1, hi1;
+    Lanes::MultiplyHighLow(multiplier_a, c0, &lo0, &hi0);
+    Lanes::MultiplyHighLow(multiplier_b, c2, &lo1, &hi1);
+    c0 = Lanes::Xor(Lanes::Xor(hi1, c1), Lanes::Set(key0));
+    c1 = lo1;
+    c2 = Lanes::Xor(Lanes::Xor(hi0, c3), Lanes::Set(key1));
+    c3 = lo0;
+    key0 += kPhiloxW32A;
+    key1 += kPhiloxW32B;
+  }
+  Lanes::Store(words[0], c0);
+  Lanes::Store(words[1], c1);
+  Lanes::Store(words[2], c2);
+  Lanes::Store(words[3], c3);
+  for (int j = 0; j < Lanes::kCount; ++j) {
+    for (int i = 0; i < PhiloxRandom::kResultElementCount; ++i) {
+      results[j][i] = words[i][j];
+    }
+  }
+}
+#endif  // PHILOX_HAVE_LANES
+
+}  // namespace
+
+bool IsPhiloxBatchVectorized() {
+#ifdef PHILOX_HAVE_LANES
+  return true;
+#else
+  return false;
+#endif
+}
+
+void ComputePhiloxBatch(const PhiloxRandom& gen, int num_groups,
+                        PhiloxRandom::ResultType* results) {
+  PhiloxRandom g = gen;
+  int i = 0;
+#ifdef PHILOX_HAVE_LANES
+  for (; i + Lanes::kCount <= num_groups; i += Lanes::kCount) {
+    if (g.counter()[0] <= ~uint32{0} - (Lanes::kCount - 1)) {
+      ComputeLanes(g.counter(), g.key(), results + i);
+      g.Skip(Lanes::kCount);
+    } else {
+      // The lowest word of the counter wraps around within these groups.
+      for (int j = 0; j < Lanes::kCount; ++j) {
+        results[i + j] = g();
+      }
+    }
+  }
+#endif  // PHILOX_HAVE_LANES
+  for (; i < num_groups; ++i) {
+    results[i] = g();
+  }
+}
+
+}  // namespace random
+}  // namespace tensorflow
@@ -0,0 +1,78 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_RANDOM_BATCHED_PHILOX_RANDOM_H_
+#define TENSORFLOW_LIB_RANDOM_BATCHED_PHILOX_RANDOM_H_
+
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace random {
+
+// Computes the next 'num_groups' results of 'gen' into 'results', in the order
+// in which 'num_groups' calls of gen() would return them, with SIMD
+// instructions when the target supports them. Does not advance 'gen'.
+// CPU only.
+void ComputePhiloxBatch(const PhiloxRandom& gen, int num_groups,
+                        PhiloxRandom::ResultType* results);
+
+// Returns true if ComputePhiloxBatch uses SIMD instructions, i.e. if the code
+// was built for AVX2, AVX-512 or NEON. Otherwise it computes one group at a
+// time and is no faster than PhiloxRandom.
+bool IsPhiloxBatchVectorized();
+
+// A generator with the interface of PhiloxRandom that returns the same
+// results in the same order, but computes kBatchGroups of them at a time with
+// ComputePhiloxBatch. Distributions templated on their generator can use it in
+// place of PhiloxRandom on CPU:
+//
+//   BatchedPhiloxRandom gen(philox);
+//   UniformDistribution<BatchedPhiloxRandom, float> dist;
+//   auto samples = dist(&gen);
+//
+// The wrapped generator is advanced a whole batch at a time, so it should not
+// be used after it has been wrapped.
+class BatchedPhiloxRandom {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static const int kResultElementCount = PhiloxRandom::kResultElementCount;
+  static const int kElementCost = PhiloxRandom::kElementCost;
+  // The number of groups computed at a time, a multiple of the widest SIMD
+  // lane count (16 with AVX-512).
+  static const int kBatchGroups = 16;
+
+  explicit BatchedPhiloxRandom(const PhiloxRandom& gen) : gen_(gen) {}
+
+  ResultType operator()() {
+    if (next_ == kBatchGroups) {
+      ComputePhiloxBatch(gen_, kBatchGroups, results_);
+      gen_.Skip(kBatchGroups);
+      next_ = 0;
+    }
+    return results_[next_++];
+  }
+
+ private:
+  PhiloxRandom gen_;
+  ResultType results_[kBatchGroups];
+  int next_ = kBatchGroups;
+};
+
+}  // namespace random
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_RANDOM_BATCHED_PHILOX_RANDOM_H_
@@ -0,0 +1,130 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/random/batched_philox_random.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/random/philox_random_test_utils.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace random {
+namespace {
+
+// Checks that 'num_groups' results of BatchedPhiloxRandom match those of
+// PhiloxRandom, starting from 'counter'.
+void ExpectSameResults(const PhiloxRandom::ResultType& counter,
+                       const PhiloxRandom::Key& key, int num_groups) {
+  PhiloxRandom gen(counter, key);
+  BatchedPhiloxRandom batched_gen(gen);
+  for (int i = 0; i < num_groups; ++i) {
+    const PhiloxRandom::ResultType expected = gen();
+    const PhiloxRandom::ResultType actual = batched_gen();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(expected[j], actual[j]) << "group " << i << " element " << j;
+    }
+  }
+}
+
+TEST(BatchedPhiloxRandomTest, MatchesPhiloxRandom) {
+  const uint64 seed = GetTestSeed();
+  PhiloxRandom::Key key;
+  key[0] = static_cast<uint32>(seed);
+  key[1] = static_cast<uint32>(seed >> 32);
+  PhiloxRandom::ResultType counter;
+  counter[0] = 0;
+  counter[1] = 1;
+  counter[2] = 2;
+  counter[3] = 3;
+  ExpectSameResults(counter, key, 1000);
+}
+
+TEST(BatchedPhiloxRandomTest, CounterCarries) {
+  PhiloxRandom::Key key;
+  key[0] = 301;
+  key[1] = 17;
+  PhiloxRandom::ResultType counter;
+  counter[1] = 0xFFFFFFFF;
+  counter[2] = 0xFFFFFFFF;
+  counter[3] = 5;
+  // Start at each position of a batch before the lowest word wraps around.
+  for (int i = 1; i <= 2 * BatchedPhiloxRandom::kBatchGroups; ++i) {
+    counter[0] = 0xFFFFFFFF - i;
+    ExpectSameResults(counter, key, 3 * BatchedPhiloxRandom::kBatchGroups);
+  }
+}
+
+TEST(BatchedPhiloxRandomTest, ComputePhiloxBatch) {
+  PhiloxRandom gen(GetTestSeed());
+  gen.Skip(12345);
+  for (int num_groups : {0, 1, 3, 4, 8, 15, 16, 17, 33}) {
+    std::vector<PhiloxRandom::ResultType> results(num_groups);
+    ComputePhiloxBatch(gen, num_groups, results.data());
+    PhiloxRandom expected_gen = gen;
+    for (int i = 0; i < num_groups; ++i) {
+      const PhiloxRandom::ResultType expected = expected_gen();
+      for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+        ASSERT_EQ(expected[j], results[i][j]) << num_groups << " groups";
+      }
+    }
+  }
+}
+
+TEST(BatchedPhiloxRandomTest, Distributions) {
+  PhiloxRandom gen(GetTestSeed());
+  PhiloxRandom scalar_gen = gen;
+  BatchedPhiloxRandom batched_gen(gen);
+  UniformDistribution<PhiloxRandom, float> uniform;
+  UniformDistribution<BatchedPhiloxRandom, float> batched_uniform;
+  NormalDistribution<PhiloxRandom, float> normal;
+  NormalDistribution<BatchedPhiloxRandom, float> batched_normal;
+  for (int i = 0; i < 100; ++i) {
+    const auto expected_uniform = uniform(&scalar_gen);
+    const auto actual_uniform = batched_uniform(&batched_gen);
+    const auto expected_normal = normal(&scalar_gen);
+    const auto actual_normal = batched_normal(&batched_gen);
+    for (int j = 0; j < 4; ++j) {
+      ASSERT_EQ(expected_uniform[j], actual_uniform[j]);
+      ASSERT_EQ(expected_normal[j], actual_normal[j]);
+    }
+  }
+}
+
+template <class Generator>
+static void BM_Generate(int iters) {
+  PhiloxRandom philox(301, 17);
+  Generator gen(philox);
+  uint32 result = 0;
+  while (--iters > 0) {
+    result += gen()[0];
+  }
+  VLOG(4) << result;  // Dummy use
+}
+
+static void BM_PhiloxRandom(int iters) { BM_Generate<PhiloxRandom>(iters); }
+BENCHMARK(BM_PhiloxRandom);
+
+static void BM_BatchedPhiloxRandom(int iters) {
+  BM_Generate<BatchedPhiloxRandom>(iters);
+}
+BENCHMARK(BM_BatchedPhiloxRandom);
+
+}  // namespace
+}  // namespace random
+}  // namespace tensorflow
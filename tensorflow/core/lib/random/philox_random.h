@@ -150,6 +150,10 @@ class PhiloxRandom {
     }
   }
 
+  // The counter of the next group of random numbers, and the key.
+  PHILOX_DEVICE_INLINE const ResultType& counter() const { return counter_; }
+  PHILOX_DEVICE_INLINE const Key& key() const { return key_; }
+
   // Returns a group of four random numbers using the underlying Philox
   // algorithm.
   PHILOX_DEVICE_INLINE ResultType operator()() {
@@ -303,7 +303,90 @@ bool safe_strtou32(StringPiece str, uint32* value) {
   return true;
 }
 
+namespace {
+
+// Limits of the decimal numbers that FastDecimalToFloat converts: the
+// mantissa and the power of ten must both be exactly representable in T.
+template <typename T>
+struct FastDecimalLimits;
+
+template <>
+struct FastDecimalLimits<float> {
+  static constexpr uint64 kMaxMantissa = uint64{1} << 24;
+  static constexpr int kMaxExponent = 10;
+};
+
+template <>
+struct FastDecimalLimits<double> {
+  static constexpr uint64 kMaxMantissa = uint64{1} << 53;
+  static constexpr int kMaxExponent = 22;
+};
+
+const double kPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                               1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                               1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Converts a plain decimal number, [+-]digits[.digits][(e|E)[+-]digits], whose
+// mantissa and power of ten are exactly representable in T. The result of the
+// single multiplication or division is then correctly rounded, so it equals
+// what locale_independent_strtonum returns. Returns false for any other input,
+// including spaces, hex and special numbers, which must take the slow path.
+template <typename T>
+bool FastDecimalToFloat(StringPiece str, T* value) {
+  const char* p = str.data();
+  const char* end = p + str.size();
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = (*p == '-');
+    ++p;
+  }
+  uint64 mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  for (; p < end && IsDigit(*p); ++p, ++num_digits) {
+    if (num_digits == 19) return false;
+    mantissa = mantissa * 10 + (*p - '0');
+  }
+  if (p < end && *p == '.') {
+    for (++p; p < end && IsDigit(*p); ++p, ++num_digits, --exponent) {
+      if (num_digits == 19) return false;
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+  }
+  if (num_digits == 0) return false;
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool negative_exponent = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negative_exponent = (*p == '-');
+      ++p;
+    }
+    if (p == end) return false;
+    int explicit_exponent = 0;
+    for (; p < end && IsDigit(*p); ++p) {
+      if (explicit_exponent > 1000) return false;
+      explicit_exponent = explicit_exponent * 10 + (*p - '0');
+    }
+    exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+  }
+  if (p != end || mantissa > FastDecimalLimits<T>::kMaxMantissa ||
+      std::abs(exponent) > FastDecimalLimits<T>::kMaxExponent) {
+    return false;
+  }
+  T result = static_cast<T>(mantissa);
+  const T power = static_cast<T>(kPowersOfTen[std::abs(exponent)]);
+  result = exponent < 0 ? result / power : result * power;
+  *value = negative ? -result : result;
+  return true;
+}
+
+}  // namespace
+
 bool safe_strtof(const char* str, float* value) {
+  if (FastDecimalToFloat(StringPiece(str), value)) return true;
   const char* endptr;
   *value = locale_independent_strtonum<float>(str, &endptr);
   while (isspace(*endptr)) ++endptr;
@@ -314,7 +397,13 @@ bool safe_strtof(const char* str, float* value) {
   return *str != '\0' && *endptr == '\0';
 }
 
+bool safe_strtof(StringPiece str, float* value) {
+  if (FastDecimalToFloat(str, value)) return true;
+  return safe_strtof(str.ToString().c_str(), value);
+}
+
 bool safe_strtod(const char* str, double* value) {
+  if (FastDecimalToFloat(StringPiece(str), value)) return true;
   const char* endptr;
   *value = locale_independent_strtonum<double>(str, &endptr);
   while (isspace(*endptr)) ++endptr;
@@ -325,6 +414,11 @@ bool safe_strtod(const char* str, double* value) {
   return *str != '\0' && *endptr == '\0';
 }
 
+bool safe_strtod(StringPiece str, double* value) {
+  if (FastDecimalToFloat(str, value)) return true;
+  return safe_strtod(str.ToString().c_str(), value);
+}
+
 char* FloatToBuffer(float value, char* buffer) {
   // FLT_DIG is 6 for IEEE-754 floats, which are used on almost all
   // platforms these days.  Just in case some system exists where FLT_DIG
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/strings/numbers.h"
 
+#include <cmath>
 #include <string>
 #include "tensorflow/core/platform/test.h"
 
@@ -280,6 +281,37 @@ TEST(safe_strtof, Float) {
   EXPECT_FALSE(safe_strtof("-infinity is awesome", &result));
 }
 
+TEST(safe_strtof, StringPiece) {
+  float result = 0;
+
+  // Plain decimal numbers are converted straight from the piece.
+  for (const char* str :
+       {"0", "-0", "1.", ".5", "+12.5e-3", "16777216", "3.4E10", "0.1"}) {
+    float expected = 0;
+    EXPECT_TRUE(safe_strtof(StringPiece(str), &result)) << str;
+    EXPECT_TRUE(safe_strtof(str, &expected)) << str;
+    EXPECT_EQ(strtof(str, nullptr), result) << str;
+    EXPECT_EQ(std::signbit(expected), std::signbit(result)) << str;
+  }
+
+  // Other numbers take the slow path.
+  EXPECT_TRUE(safe_strtof(StringPiece(" 16777217 "), &result));
+  EXPECT_EQ(16777216.0f, result);
+  EXPECT_TRUE(safe_strtof(StringPiece("1.17549435e-38"), &result));
+  EXPECT_EQ(std::numeric_limits<float>::min(), result);
+  EXPECT_TRUE(safe_strtof(StringPiece("-inf"), &result));
+  EXPECT_EQ(-std::numeric_limits<float>::infinity(), result);
+
+  // The piece need not be terminated.
+  EXPECT_TRUE(safe_strtof(StringPiece("2.5,3", 3), &result));
+  EXPECT_EQ(2.5f, result);
+
+  EXPECT_FALSE(safe_strtof(StringPiece(""), &result));
+  EXPECT_FALSE(safe_strtof(StringPiece("."), &result));
+  EXPECT_FALSE(safe_strtof(StringPiece("1e"), &result));
+  EXPECT_FALSE(safe_strtof(StringPiece("1.5.2"), &result));
+}
+
 TEST(safe_strtod, Double) {
   double result = 0;
 
@@ -298,5 +330,21 @@ TEST(safe_strtod, Double) {
   EXPECT_EQ(0, result);
 }
 
+TEST(safe_strtod, StringPiece) {
+  double result = 0;
+
+  for (const char* str : {"0.1234567890123", "-9007199254740992", "1e22",
+                          "123456.789e-20", "1e23", "0.30000000000000004"}) {
+    EXPECT_TRUE(safe_strtod(StringPiece(str), &result)) << str;
+    EXPECT_EQ(strtod(str, nullptr), result) << str;
+  }
+
+  EXPECT_TRUE(safe_strtod(StringPiece("0x10"), &result));
+  EXPECT_EQ(16, result);
+  EXPECT_TRUE(safe_strtod(StringPiece("-7.25;", 5), &result));
+  EXPECT_EQ(-7.25, result);
+  EXPECT_FALSE(safe_strtod(StringPiece("1.0x"), &result));
+}
+
 }  // namespace strings
 }  // namespace tensorflow
@@ -0,0 +1,59 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+
+namespace tensorflow {
+
+// Note that the following operator is a placeholder. Once the graph has been
+// placed, the code in common_runtime/all_reduce.cc replaces each group of
+// these placeholders with a graph of operators that exchange the chunks of
+// the tensors over Send/Recv. The kernel registered for it only supports
+// groups of size 1.
+REGISTER_OP("CollectiveAllReduce")
+    .Input("input: T")
+    .Output("data: T")
+    .Attr("T: {half, float, double, int32, int64}")
+    .Attr("group_key: string")
+    .Attr("group_size: int >= 1")
+    .Attr("merge_op: {'Add', 'Mul', 'Maximum', 'Minimum'} = 'Add'")
+    .Attr("final_op: {'Id', 'Div'} = 'Id'")
+    .Attr("algorithm: {'ring', 'hierarchical'} = 'hierarchical'")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Reduces a tensor across the devices of a group.
+
+Every node of a group has the same `group_key` and `group_size`, is placed on
+a different device, and outputs the reduction of the inputs of all
+`group_size` nodes. All inputs must have the same shape.
+
+With `algorithm` "ring" the devices, ordered by name, form a ring along
+which each tensor is reduced and then gathered in `group_size` chunks. With
+"hierarchical" the tensors of the devices of each task are first reduced on
+one device of the task, the results are all-reduced over a ring of those
+devices, and then copied back to the other devices of their task.
+
+input: The tensor this device contributes to the reduction.
+group_key: Identifies the nodes that are reduced together.
+group_size: The number of nodes with `group_key`.
+merge_op: The binary operation that reduces two tensors.
+final_op: The operation applied to the result. "Div" divides it by
+  `group_size`.
+algorithm: How the reduction is decomposed over the devices.
+data: The reduction of the inputs of all nodes of the group.
+)doc");
+
+}  // namespace tensorflow
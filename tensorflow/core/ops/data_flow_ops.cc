@@ -1347,6 +1347,7 @@ REGISTER_OP("TensorArrayV3")
     .Attr("dynamic_size: bool = false")
     .Attr("clear_after_read: bool = true")
     .Attr("identical_element_shapes: bool = false")
+    .Attr("contiguous: bool = false")
     .Attr("tensor_array_name: string = ''")
     .Output("handle: resource")
     .Output("flow: float")
@@ -1381,6 +1382,11 @@ identical_element_shapes: If true (default is false), then all
   consistent shapes on write, and being able to fill in properly
   shaped zero tensors on stack -- even if the element_shape attribute
   is not fully defined.
+contiguous: If true (default is false), the elements are stored in one
+  buffer allocated on the first write, once the element shape is fully
+  defined.  Writes copy into the buffer, and stacking, gathering or
+  concatenating consecutive elements returns a view of it without copying.
+  Ignored if dynamic_size is true.
 tensor_array_name: Overrides the name used for the temporary tensor_array
   resource. Default value is the name of the 'TensorArray' op (which
   is guaranteed unique).
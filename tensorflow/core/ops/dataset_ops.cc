@@ -203,7 +203,9 @@ Unlike a "MapDataset", which applies `f` sequentially, this dataset invokes up
 to `num_parallel_calls` copies of `f` in parallel.
 
 num_parallel_calls: The number of concurrent invocations of `f` that process
-  elements from `input_dataset` in parallel.
+  elements from `input_dataset` in parallel. If -1, each iterator adjusts it at
+  runtime, from the time its consumer waits for elements, up to the number of
+  CPUs (or TF_DATA_AUTOTUNE_CPU_BUDGET).
 )doc");
 
 REGISTER_OP("MapAndBatchDataset")
@@ -232,6 +234,32 @@ num_parallel_batches: A scalar representing the number of batches to create in
   stragglers.
 )doc");
 
+REGISTER_OP("MapAndBatchDatasetV2")
+    .Input("input_dataset: variant")
+    .Input("other_arguments: Targuments")
+    .Input("batch_size: int64")
+    .Input("num_parallel_calls: int64")
+    .Output("handle: variant")
+    .Attr("f: func")
+    .Attr("Targuments: list(type) >= 0")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that applies `f` to the outputs of `input_dataset` and then
+batches `batch_size` of them.
+
+Unlike "MapAndBatchDataset", the number of concurrent invocations of `f` is
+set independently of `batch_size`: up to `num_parallel_calls` invocations are
+in flight, over as many batches as they need, and at least two batches are
+produced at once.
+
+batch_size: A scalar representing the number of elements to accumulate in a
+  batch.
+num_parallel_calls: A scalar representing the maximum number of concurrent
+  invocations of `f` that process elements from `input_dataset` in parallel.
+)doc");
+
 REGISTER_OP("PrefetchDataset")
     .Input("input_dataset: variant")
     .Input("buffer_size: int64")
@@ -243,7 +271,9 @@ REGISTER_OP("PrefetchDataset")
 Creates a dataset that asynchronously prefetches elements from `input_dataset`.
 
 buffer_size: The maximum number of elements to buffer in an iterator over
-  this dataset.
+  this dataset. If -1, each iterator adjusts it at runtime, from the time its
+  consumer waits for elements, while the buffered elements fit in 1GB (or
+  TF_DATA_AUTOTUNE_RAM_BUDGET_MB megabytes).
 )doc");
 
 REGISTER_OP("ScanDataset")
@@ -529,8 +559,15 @@ cache already exists, the cache will be used. If the cache is inappropriate
 (e.g. cannot be opened, contains tensors of the wrong shape / size), an error
 will the returned when used.
 
-filename: A path on the filesystem where we should cache the dataset. Note: this
-  will be a directory.
+The cache is written in memory-mappable chunks, so that iterating over an
+existing cache reads the tensors in place. Several iterators, e.g. over the
+shards of a sharded input pipeline, may write the same cache concurrently; the
+cache then holds the elements of all of them, and iterators that read it wait
+until all the writers have finished. An iterator that writes the cache can be
+saved and restored in the middle of an epoch.
+
+filename: A path on the filesystem where we should cache the dataset. The
+  files of the cache are named with this prefix.
 )doc");
 
 REGISTER_OP("TextLineDataset")
@@ -538,6 +575,7 @@ REGISTER_OP("TextLineDataset")
     .Input("compression_type: string")
     .Input("buffer_size: int64")
     .Output("handle: variant")
+    .Attr("num_readahead_buffers: int >= 0 = 0")
     .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
                       // stateful to inhibit constant folding.
     .SetShapeFn(shape_inference::ScalarShape)  // TODO(mrry): validate
@@ -552,6 +590,8 @@ filenames: A scalar or a vector containing the name(s) of the file(s) to be
 compression_type: A scalar containing either (i) the empty string (no
   compression), (ii) "ZLIB", or (iii) "GZIP".
 buffer_size: A scalar containing the number of bytes to buffer.
+num_readahead_buffers: If positive, the number of reads of `buffer_size` bytes
+  to issue asynchronously ahead of the current position in each file.
 )doc");
 
 REGISTER_OP("SqlDataset")
@@ -572,6 +612,29 @@ data_source_name: A connection string to connect to the database.
 query: A SQL query to execute.
 )doc");
 
+REGISTER_OP("ColumnarDataset")
+    .Input("filenames: string")
+    .Input("columns: string")
+    .Output("handle: variant")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
+                      // stateful to inhibit constant folding.
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that emits the row groups of one or more columnar files.
+
+Each element holds a batch of the values of each of the requested columns in
+a row group, with a row of the group per row of the batch. Only the chunks of
+the requested columns are read, and the chunks of the next row group are read
+in the background while a row group is consumed. The format of the files is
+described in tensorflow/core/util/columnar_file.proto.
+
+filenames: A scalar or vector containing the name(s) of the file(s) to be
+  read.
+columns: A vector containing the names of the columns to read.
+)doc");
+
 REGISTER_OP("FixedLengthRecordDataset")
     .Input("filenames: string")
     .Input("header_bytes: int64")
@@ -595,11 +658,54 @@ footer_bytes: A scalar representing the number of bytes to skip at the end
 buffer_size: A scalar representing the number of bytes to buffer. Must be > 0.
 )doc");
 
+REGISTER_OP("ShuffledFixedLengthRecordDataset")
+    .Input("filenames: string")
+    .Input("header_bytes: int64")
+    .Input("record_bytes: int64")
+    .Input("footer_bytes: int64")
+    .Input("seed: int64")
+    .Input("seed2: int64")
+    .Input("num_parallel_reads: int64")
+    .Output("handle: variant")
+    .Attr("reshuffle_each_iteration: bool = true")
+    .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
+                      // stateful to inhibit constant folding.
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that emits the records of binary files in a random order.
+
+Unlike a "ShuffleDataset" of a "FixedLengthRecordDataset", which shuffles the
+records in a buffer of materialized records, this dataset shuffles the
+indices of all the records of all the files, and reads each record from its
+offset. The order is a uniformly random permutation of all the records, and
+an iterator holds 8 bytes per record, plus the records that it reads ahead.
+
+filenames: A scalar or a vector containing the name(s) of the file(s) to be
+  read.
+header_bytes: A scalar representing the number of bytes to skip at the
+  beginning of a file.
+record_bytes: A scalar representing the number of bytes in each record.
+footer_bytes: A scalar representing the number of bytes to skip at the end
+  of a file.
+seed: A scalar seed for the random number generator. If either seed or
+  seed2 is set to be non-zero, the random number generator is seeded
+  by the given seed.  Otherwise, a random seed is used.
+seed2: A second scalar seed to avoid seed collision.
+num_parallel_reads: A scalar representing the number of records to read
+  concurrently, ahead of the consumer. Must be > 0.
+reshuffle_each_iteration: If true, each iterator over this dataset will be given
+  a different pseudorandomly generated seed, based on a sequence seeded by the
+  `seed` and `seed2` inputs. If false, each iterator will be given the same
+  seed, and repeated iteration over this dataset will yield the exact same
+  sequence of results.
+)doc");
+
 REGISTER_OP("TFRecordDataset")
     .Input("filenames: string")
     .Input("compression_type: string")
     .Input("buffer_size: int64")
     .Output("handle: variant")
+    .Attr("num_readahead_buffers: int >= 0 = 0")
     .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
                       // stateful to inhibit constant folding.
     .SetShapeFn(shape_inference::ScalarShape)
@@ -612,6 +718,71 @@ compression_type: A scalar containing either (i) the empty string (no
   compression), (ii) "ZLIB", or (iii) "GZIP".
 buffer_size: A scalar representing the number of bytes to buffer. A value of
   0 means no buffering will be performed.
+num_readahead_buffers: If positive (and `buffer_size` is positive), the number
+  of reads of `buffer_size` bytes to issue asynchronously ahead of the current
+  position in each file.
+)doc");
+
+REGISTER_OP("IndexedTFRecordDataset")
+    .Input("filenames: string")
+    .Input("num_shards: int64")
+    .Input("shard_index: int64")
+    .Input("buffer_size: int64")
+    .Output("handle: variant")
+    .Attr("skip_corrupted_records: bool = false")
+    .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
+                      // stateful to inhibit constant folding.
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that emits a range of the records of TFRecord files that
+have an index.
+
+Each file must be uncompressed and have an index file, as written by a
+`TFRecordWriter` with `write_index=True`. The records of each file are split
+into `num_shards` contiguous ranges, and the dataset seeks directly to the
+range at `shard_index` of each file instead of reading the records before it.
+
+filenames: A scalar or vector containing the name(s) of the file(s) to be
+  read.
+num_shards: A scalar representing the number of ranges that the records of
+  each file are split into.
+shard_index: A scalar representing the range of each file to read, in
+  [0, `num_shards`).
+buffer_size: A scalar representing the number of bytes to buffer. A value of
+  0 means no buffering will be performed.
+skip_corrupted_records: If true, a corrupted record is logged and skipped,
+  and reading resumes at the indexed offset of the next record. Otherwise, a
+  corrupted record is a `DataLoss` error.
+)doc");
+
+REGISTER_OP("RemoteDataset")
+    .Input("graph_defs: string")
+    .Input("workers: string")
+    .Input("buffer_size: int64")
+    .Output("handle: variant")
+    .Attr("f: func")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetIsStateful()  // TODO(b/65524810): Source dataset ops must be marked
+                      // stateful to inhibit constant folding.
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Creates a dataset that emits the elements of datasets running on remote workers.
+
+Each iterator of the dataset runs the dataset serialized in `graph_defs[i]`
+on the device `workers[i]`, by calling `f` on that device. `f` takes the
+serialized dataset and the id of the remote iterator, and returns its next
+element, as a "DatasetServiceGetNext" op does. Up to `buffer_size` calls of
+`f` are in flight on each worker, and each call is issued to the worker with
+the fewest calls in flight, so that faster workers produce more elements. The
+dataset ends when the datasets of all workers have ended.
+
+graph_defs: A vector of datasets serialized by "DatasetToGraph", one per
+  worker.
+workers: A vector of the names of the devices to run the datasets on, e.g.
+  "/job:data/task:0/cpu:0".
+buffer_size: A scalar representing the number of calls of `f` that can be in
+  flight on each worker.
 )doc");
 
 REGISTER_OP("Iterator")
@@ -732,6 +903,70 @@ dataset: A handle to a dataset that contains a single element.
 components: The components of the single element of `input`.
 )doc");
 
+REGISTER_OP("DevicePrefetchIterator")
+    .Output("handle: resource")
+    .Attr("buffer_size: int >= 1")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+A container for an iterator that prefetches elements to the device of the op.
+
+Once initialized by a "MakeDevicePrefetchIterator" op, the iterator gets up to
+`buffer_size` elements ahead of its consumer and copies them to the device
+asynchronously. On a GPU, the iterator builds the elements in pinned host
+memory (e.g. the batches of a "BatchDataset"), and copies them on the
+host-to-device stream, so that "DevicePrefetchIteratorGetNext" outputs
+tensors that are already in device memory. Components of a type that is
+always kept in host memory (e.g. `string`) are not copied.
+
+handle: A handle to the iterator that can be passed to a
+  "MakeDevicePrefetchIterator" or "DevicePrefetchIteratorGetNext" op.
+buffer_size: The number of elements to buffer on the device.
+)doc");
+
+REGISTER_OP("MakeDevicePrefetchIterator")
+    .Input("dataset: variant")
+    .Input("iterator: resource")
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+Makes a new iterator from `dataset` and prefetches its elements in `iterator`.
+
+This operation must be placed on the device of `iterator`, and may be executed
+multiple times. Each execution discards the buffered elements and resets
+`iterator` to the first element of `dataset`.
+)doc");
+
+REGISTER_OP("DevicePrefetchIteratorGetNext")
+    .Input("iterator: resource")
+    .Output("components: output_types")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      std::vector<PartialTensorShape> output_shapes;
+      TF_RETURN_IF_ERROR(c->GetAttr("output_shapes", &output_shapes));
+      if (output_shapes.size() != c->num_outputs()) {
+        return errors::InvalidArgument(
+            "`output_shapes` must be the same length as `output_types` (",
+            output_shapes.size(), " vs. ", c->num_outputs());
+      }
+      for (size_t i = 0; i < output_shapes.size(); ++i) {
+        shape_inference::ShapeHandle output_shape_handle;
+        TF_RETURN_IF_ERROR(c->MakeShapeFromPartialTensorShape(
+            output_shapes[i], &output_shape_handle));
+        c->set_output(static_cast<int>(i), output_shape_handle);
+      }
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Gets the next element that `iterator` has prefetched to its device.
+)doc");
+
 REGISTER_OP("IteratorToStringHandle")
     .Input("resource_handle: resource")
     .Output("string_handle: string")
@@ -784,6 +1019,60 @@ serialized: A variant tensor storing the state of the iterator contained in the
   resource.
 )doc");
 
+REGISTER_OP("DatasetToGraph")
+    .Input("input_dataset: variant")
+    .Output("graph: string")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .Doc(R"doc(
+Serializes `input_dataset` into a `GraphDef` that can be run by another process.
+
+The dataset must be serializable in the way iterator checkpoints are, and its
+functions must be stateless.
+
+graph: A scalar containing the serialized `GraphDef`.
+)doc");
+
+REGISTER_OP("DatasetServiceGetNext")
+    .Input("graph: string")
+    .Input("iterator_id: string")
+    .Output("components: output_types")
+    .Attr("output_types: list(type) >= 1")
+    .Attr("output_shapes: list(shape) >= 1")
+    .SetIsStateful()
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      std::vector<PartialTensorShape> output_shapes;
+      TF_RETURN_IF_ERROR(c->GetAttr("output_shapes", &output_shapes));
+      if (output_shapes.size() != c->num_outputs()) {
+        return errors::InvalidArgument(
+            "`output_shapes` must be the same length as `output_types` (",
+            output_shapes.size(), " vs. ", c->num_outputs());
+      }
+      for (size_t i = 0; i < output_shapes.size(); ++i) {
+        shape_inference::ShapeHandle output_shape_handle;
+        TF_RETURN_IF_ERROR(c->MakeShapeFromPartialTensorShape(
+            output_shapes[i], &output_shape_handle));
+        c->set_output(static_cast<int>(i), output_shape_handle);
+      }
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Gets the next element of an iterator that this device runs for a consumer.
+
+The iterators live in the "dataset_service" container of the device, and
+are looked up by `iterator_id`. If there is no iterator `iterator_id`, one is
+created over the dataset serialized in `graph`, which must then be non-empty.
+An iterator that has reached its end releases its dataset, and the iterators
+of datasets that never end, e.g. because they repeat, are released by
+resetting the container.
+
+graph: A scalar containing a dataset serialized by "DatasetToGraph", or the
+  empty string if the iterator was already created.
+iterator_id: A scalar that identifies the iterator on this device.
+)doc");
+
 REGISTER_OP("StatsAggregatorHandle")
     .Output("handle: resource")
     .SetShapeFn(shape_inference::ScalarShape)
@@ -532,6 +532,65 @@ crop_window: 1-D.  The crop window: [crop_y, crop_x, crop_height, crop_width].
 )doc",
                          kDecodeJpegCommonParamsDocStr));
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeAndResizeJpeg")
+    .Input("contents: string")
+    .Input("size: int32")
+    .Attr("channels: int = 3")
+    .Attr("align_corners: bool = false")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("try_recover_truncated: bool = false")
+    .Attr("acceptable_fraction: float = 1.0")
+    .Attr("dct_method: string = ''")
+    .Output("images: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      int32 channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 1 && channels != 3) {
+        return errors::InvalidArgument("channels must be 1 or 3, got ",
+                                       channels);
+      }
+      return SetOutputToSizedImage(c, c->Dim(contents, 0),
+                                   1 /* size_input_idx */,
+                                   c->MakeDim(channels));
+    })
+    .Doc(R"doc(
+Decode a batch of JPEG-encoded images and resize them to `size`.
+
+The result is that of decoding every image with `DecodeJpeg` at the largest
+`ratio` (1, 2, 4 or 8) that still gives an image of at least `size`, and then
+resizing it with `ResizeBilinear`. Letting libjpeg drop DCT coefficients for
+most of the downscaling is much faster than decoding the whole image, and the
+images of the batch are decoded in parallel.
+
+Note that the result differs from resizing the fully decoded image, since the
+DCT scaling averages pixels rather than interpolating between them.
+
+contents: 1-D.  The JPEG-encoded images.
+size: A 1-D int32 Tensor of 2 elements: `new_height, new_width`.  The size
+  of the output images.
+channels: Number of color channels for the decoded images, 1 (grayscale) or 3
+  (RGB).
+align_corners: If true, rescale the decoded images by (new_height - 1) /
+  (height - 1), which exactly aligns their 4 corners with those of the output
+  images. If false, rescale by new_height / height. Treat similarly the width
+  dimension.
+fancy_upscaling: If true use a slower but nicer upscaling of the
+  chroma planes (yuv420/422 only).
+try_recover_truncated:  If true try to recover an image from truncated input.
+acceptable_fraction: The minimum required fraction of lines before a truncated
+  input is accepted.
+dct_method: string specifying a hint about the algorithm used for
+  decompression.  Defaults to "" which maps to a system-specific
+  default.  Currently valid values are ["INTEGER_FAST",
+  "INTEGER_ACCURATE"].  The hint may be ignored (e.g., the internal
+  jpeg library changes to a version that does not have that specific
+  option.)
+images: 4-D with shape `[batch, new_height, new_width, channels]`.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -1540,4 +1599,76 @@ selected_indices: A 1-D integer tensor of shape `[M]` representing the selected
   indices from the boxes tensor, where `M <= max_output_size`.
 )doc");
 
+REGISTER_OP("BatchedNonMaxSuppression")
+    .Input("boxes: float")
+    .Input("scores: float")
+    .Input("max_output_size_per_class: int32")
+    .Input("iou_threshold: float")
+    .Input("score_threshold: float")
+    .Output("selected_indices: int32")
+    .Output("num_valid: int32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle boxes;
+      ShapeHandle scores;
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 3, &boxes));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 3, &scores));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 2), 4, &unused_dim));
+      DimensionHandle batch_size;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 0), c->Dim(scores, 0), &batch_size));
+      DimensionHandle num_boxes;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(boxes, 1), c->Dim(scores, 1), &num_boxes));
+      DimensionHandle num_classes = c->Dim(scores, 2);
+
+      // The output holds min(max_output_size_per_class, num_boxes) indices
+      // per class.
+      DimensionHandle output_size = c->UnknownDim();
+      const Tensor* max_output_size = c->input_tensor(2);
+      if (max_output_size != nullptr && c->ValueKnown(num_boxes)) {
+        output_size = c->MakeDim(std::min<int64>(
+            max_output_size->scalar<int32>()(), c->Value(num_boxes)));
+      }
+      c->set_output(0, c->MakeShape({batch_size, num_classes, output_size}));
+      c->set_output(1, c->Matrix(batch_size, num_classes));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Greedily selects a subset of bounding boxes for each class of each image.
+
+Runs the selection of `NonMaxSuppressionV2` independently for every class of
+every image of a batch: boxes are visited in descending order of their score
+for the class, and are pruned away if they have a high intersection-over-union
+(IOU) overlap with previously selected boxes of the class.  Only boxes whose
+score is above `score_threshold` are considered, and boxes with equal scores
+are visited in order of index.  Bounding boxes are supplied as
+[y1, x1, y2, x2], where (y1, x1) and (y2, x2) are the coordinates of any
+diagonal pair of box corners.
+
+The selected indices of each class are padded with 0 to a fixed size, so that
+the result of a whole batch can stay on the device that computed it.
+
+boxes: A 3-D float tensor of shape `[batch_size, num_boxes, 4]`, shared by
+  all classes of an image.
+scores: A 3-D float tensor of shape `[batch_size, num_boxes, num_classes]`
+  representing the score of each box for each class.
+max_output_size_per_class: A scalar integer tensor representing the maximum
+  number of boxes to be selected for each class of each image.
+iou_threshold: A 0-D float tensor representing the threshold for deciding
+  whether boxes overlap too much with respect to IOU.
+score_threshold: A 0-D float tensor representing the threshold for deciding
+  when to remove boxes based on score.
+selected_indices: A 3-D integer tensor of shape
+  `[batch_size, num_classes, M]`, where `M` is the smaller of
+  `max_output_size_per_class` and `num_boxes`, holding the indices into the
+  boxes of the image of the boxes selected for each class, padded with 0.
+num_valid: A 2-D integer tensor of shape `[batch_size, num_classes]` holding
+  the number of valid indices in each row of `selected_indices`.
+)doc");
+
 }  // namespace tensorflow
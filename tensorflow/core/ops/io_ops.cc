@@ -55,6 +55,26 @@ Status TwoElementOutput(InferenceContext* c) {
   return Status::OK();
 }
 
+// Shape function of SaveV2 and AsyncSaveV2.
+Status SaveV2Shape(InferenceContext* c) {
+  ShapeHandle unused;
+  ShapeHandle s;
+  DimensionHandle unused_dim;
+
+  // Validate prefix.
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+
+  // Validate tensor_names and shapes_and_slices.
+  for (int i = 1; i <= 2; ++i) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 1, &s));
+    TF_RETURN_IF_ERROR(
+        c->WithValue(c->Dim(s, 0), c->num_inputs() - 3, &unused_dim));
+  }
+  // TODO(mrry): Attempt to parse the shapes_and_slices values and use
+  // them to constrain the shape of the remaining inputs.
+  return Status::OK();
+}
+
 }  // namespace
 
 REGISTER_OP("SaveV2")
@@ -64,24 +84,7 @@ REGISTER_OP("SaveV2")
     .Input("tensors: dtypes")
     .Attr("dtypes: list(type)")
     .SetIsStateful()
-    .SetShapeFn([](InferenceContext* c) {
-      ShapeHandle unused;
-      ShapeHandle s;
-      DimensionHandle unused_dim;
-
-      // Validate prefix.
-      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
-
-      // Validate tensor_names and shapes_and_slices.
-      for (int i = 1; i <= 2; ++i) {
-        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 1, &s));
-        TF_RETURN_IF_ERROR(
-            c->WithValue(c->Dim(s, 0), c->num_inputs() - 3, &unused_dim));
-      }
-      // TODO(mrry): Attempt to parse the shapes_and_slices values and use
-      // them to constrain the shape of the remaining inputs.
-      return Status::OK();
-    })
+    .SetShapeFn(SaveV2Shape)
     .Doc(R"doc(
 Saves tensors in V2 checkpoint format.
 
@@ -97,6 +100,55 @@ shape_and_slices: shape {N}.  The slice specs of the tensors to be saved.
 tensors: `N` tensors to save.
 )doc");
 
+REGISTER_OP("AsyncSaveV2")
+    .Input("prefix: string")
+    .Input("tensor_names: string")
+    .Input("shape_and_slices: string")
+    .Input("tensors: dtypes")
+    .Attr("dtypes: list(type)")
+    .Attr("copy_on_write: bool = false")
+    .SetIsStateful()
+    .SetShapeFn(SaveV2Shape)
+    .Doc(R"doc(
+Saves tensors in V2 checkpoint format in the background.
+
+Like SaveV2, except that the op only snapshots the tensors into host memory, and
+the checkpoint is written by a background thread after the op returns.  Use
+WaitForAsyncSaveV2 to wait for the checkpoint and to get the error writing it,
+if any.
+
+The op blocks while earlier snapshots that are not written yet hold more than
+TF_ASYNC_CHECKPOINT_MAX_PENDING_BYTES bytes (0 by default, i.e. only one
+snapshot is pending at a time).
+
+prefix: Must have a single element. The prefix of the V2 checkpoint to which we
+  write the tensors.
+tensor_names: shape {N}. The names of the tensors to be saved.
+shape_and_slices: shape {N}.  The slice specs of the tensors to be saved.
+  Empty strings indicate that they are non-partitioned tensors.
+tensors: `N` tensors to save.
+copy_on_write: If true, the snapshot shares the buffers of "tensors" instead of
+  copying them.  Only valid when nothing updates these buffers in place while
+  they are shared, e.g. when "tensors" are read from resource variables, whose
+  updates copy the buffer first.
+)doc");
+
+REGISTER_OP("WaitForAsyncSaveV2")
+    .Input("prefix: string")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      return c->WithRank(c->input(0), 0, &unused);
+    })
+    .Doc(R"doc(
+Waits for the checkpoints that AsyncSaveV2 is writing to "prefix".
+
+Fails with the first error writing them.  Returns immediately if no checkpoint
+is being written to "prefix".
+
+prefix: scalar.  The prefix of the V2 checkpoint.
+)doc");
+
 REGISTER_OP("RestoreV2")
     .Input("prefix: string")
     .Input("tensor_names: string")
@@ -667,4 +667,135 @@ vocab_size: Number of elements of the file, use -1 if unknown.
 delimiter: Delimiter to separate fields in a line.
 )doc");
 
+// --------------------------------------------------------------------------
+
+REGISTER_OP("EmbeddingRowCache")
+    .Output("cache_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("dtype: {half, float, double}")
+    .Attr("row_shape: shape")
+    .Attr("capacity: int >= 0")
+    .Attr("max_staleness: int >= 0 = 0")
+    .SetIsStateful()
+    .SetShapeFn(ScalarOutput)
+    .Doc(R"doc(
+Creates a cache of the rows of an embedding.
+
+The cache keeps the `capacity` most recently used rows of an embedding whose
+rows have shape `row_shape`, e.g. the rows of a partitioned embedding variable
+on parameter servers that the ops of a worker look up every step.  Each row is
+tagged with the version, e.g. the global step, at which it was fetched, and is
+fetched again once it is more than `max_staleness` versions old.
+
+cache_handle: Handle to the cache.
+container: If non-empty, this cache is placed in the given container.
+  Otherwise, a default container is used.
+shared_name: If non-empty, this cache is shared under the given name across
+  multiple sessions.
+dtype: Type of the rows.
+row_shape: Shape of a row.
+capacity: Maximum number of rows in the cache.  0 disables the cache.
+max_staleness: Number of versions after which a cached row is fetched again.
+)doc");
+
+REGISTER_OP("EmbeddingRowCacheLookup")
+    .Input("cache_handle: resource")
+    .Input("ids: Tindices")
+    .Input("version: int64")
+    .Output("values: dtype")
+    .Output("miss_ids: Tindices")
+    .Output("miss_index: int32")
+    .Attr("dtype: {half, float, double}")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &handle));
+      ShapeHandle values;
+      TF_RETURN_IF_ERROR(c->Concatenate(ids, c->UnknownShape(), &values));
+      c->set_output(0, values);
+      c->set_output(1, c->Vector(InferenceContext::kUnknownDim));
+      c->set_output(2, ids);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Looks up rows in an embedding row cache.
+
+Returns the cached rows of `ids` that are at most `max_staleness` versions
+older than `version`, and the ids that have to be fetched.  The fetched rows
+are passed to `EmbeddingRowCacheUpdate` to complete the lookup.
+
+cache_handle: Handle to the cache.
+ids: 1-D.  The ids of the rows to look up.
+version: Scalar.  The current version, e.g. the global step.
+values: The rows of `ids`, with zeros for the rows that are not cached.
+miss_ids: 1-D.  The unique ids whose rows are not cached, in the order they
+  first appear in `ids`.
+miss_index: 1-D, the size of `ids`.  `miss_index[i]` is the position of
+  `ids[i]` in `miss_ids`, or -1 if its row is cached.
+)doc");
+
+REGISTER_OP("EmbeddingRowCacheUpdate")
+    .Input("cache_handle: resource")
+    .Input("values: dtype")
+    .Input("miss_ids: Tindices")
+    .Input("miss_index: int32")
+    .Input("miss_rows: dtype")
+    .Input("version: int64")
+    .Output("output: dtype")
+    .Attr("dtype: {half, float, double}")
+    .Attr("Tindices: {int32, int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle miss_ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &miss_ids));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &handle));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(5), 0, &handle));
+      ShapeHandle values;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(1), 1, &values));
+      c->set_output(0, values);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Completes a lookup in an embedding row cache with the fetched rows.
+
+Inserts `miss_rows` in the cache, tagged with `version`, evicting the least
+recently used rows if needed, and returns `values` with the rows that were not
+cached replaced by the fetched ones.
+
+cache_handle: Handle to the cache.
+values: The values returned by `EmbeddingRowCacheLookup`.
+miss_ids: The miss_ids returned by `EmbeddingRowCacheLookup`.
+miss_index: The miss_index returned by `EmbeddingRowCacheLookup`.
+miss_rows: The rows of `miss_ids`, of shape `[len(miss_ids)] + row_shape`.
+version: Scalar.  The version the rows were fetched at.
+output: The rows of the looked up ids.
+)doc");
+
+REGISTER_OP("EmbeddingRowCacheStats")
+    .Input("cache_handle: resource")
+    .Output("hits: int64")
+    .Output("misses: int64")
+    .Output("size: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        c->set_output(i, c->Scalar());
+      }
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Returns the statistics of an embedding row cache.
+
+cache_handle: Handle to the cache.
+hits: The number of looked up rows that were cached so far.
+misses: The number of looked up rows that had to be fetched so far.
+size: The number of rows in the cache.
+)doc");
+
 }  // namespace tensorflow
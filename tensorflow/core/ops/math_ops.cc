@@ -2182,6 +2182,94 @@ segment_ids: segment_ids passed to the corresponding SparseSegmentSqrtN op.
 output_dim0: dimension 0 of "data" passed to SparseSegmentSqrtN op.
 )doc");
 
+REGISTER_OP("FusedEmbeddingLookupSparse")
+    .Input("params: T")
+    .Input("ids: Tidx")
+    .Input("segment_ids: int32")
+    .Input("weights: T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle params_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &params_shape));
+      ShapeHandle ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids_shape));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->input(2), ids_shape, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &subshape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Looks up rows of `params` and combines them along sparse segments.
+
+Computes the same result as gathering `params` at `ids` and reducing the
+gathered rows with `SparseSegmentSum`, `SparseSegmentMean` or
+`SparseSegmentSqrtN`, without materializing the gathered rows: each row is
+added straight into the output row of its segment. If `weights` is not empty,
+each row is scaled by its weight, and the mean and sqrtn combiners divide
+by the sum of the weights and the square root of the sum of their squares.
+
+Segments without ids are zero. A segment whose weights sum to zero is not
+normalized. On GPU, out of range ids are ignored.
+
+params: The embeddings, a tensor of rank at least 1.
+ids: A 1-D tensor of indices into the first dimension of `params`.
+segment_ids: A 1-D tensor with the same size as `ids`, the segment of each
+  id. Values should be sorted and can be repeated.
+weights: A 1-D tensor with the same size as `ids`, the weight of each id, or
+  an empty tensor for unit weights.
+combiner: How the rows of a segment are combined.
+output: Has same shape as params, except for dimension 0 which has size `k`,
+  the number of segments.
+)doc");
+
+REGISTER_OP("FusedEmbeddingLookupSparseGrad")
+    .Input("grad: T")
+    .Input("segment_ids: int32")
+    .Input("weights: T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle grad_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &grad_shape));
+      ShapeHandle segment_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &segment_ids_shape));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(grad_shape, 1, &subshape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(segment_ids_shape, subshape, &out));
+      c->set_output(0, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes gradients for FusedEmbeddingLookupSparse.
+
+Returns the gradient of each looked up row, to be scattered into the gradient
+of "params" at the ids passed to FusedEmbeddingLookupSparse. The gradient with
+respect to the weights is not computed.
+
+grad: gradient propagated to the FusedEmbeddingLookupSparse op.
+segment_ids: segment_ids passed to the corresponding FusedEmbeddingLookupSparse
+  op.
+weights: weights passed to the corresponding FusedEmbeddingLookupSparse op.
+combiner: combiner of the corresponding FusedEmbeddingLookupSparse op.
+output: Has same shape as grad, except for dimension 0 which has the size of
+  `segment_ids`.
+)doc");
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
@@ -2751,6 +2839,66 @@ Tactivation: The type of output produced by activation function
 
 )doc");
 
+REGISTER_OP("QuantizedMatMulWithBiasAndRequantize")
+    .Input("a: T1")
+    .Input("b: T2")
+    .Input("bias: float")
+    .Input("min_a: float")
+    .Input("max_a: float")
+    .Input("min_b: float")
+    .Input("max_b: float")
+    .Input("min_freezed_output: float")
+    .Input("max_freezed_output: float")
+    .Output("out: Toutput")
+    .Output("min_out: float")
+    .Output("max_out: float")
+    .Attr("T1: quantizedtype")
+    .Attr("T2: quantizedtype")
+    .Attr("Toutput: quantizedtype = DT_QUINT8")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("fused_relu: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      for (int i = 3; i < 9; ++i) {
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+      }
+
+      c->set_output(1, c->Scalar());
+      c->set_output(2, c->Scalar());
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Performs a quantized matrix multiplication of `a` by the matrix `b`, adds
+`bias` and requantizes the result into the range
+[`min_freezed_output`, `max_freezed_output`].
+
+The bias addition, the optional Relu and the requantization are applied to
+the 32-bit accumulators as they are produced, instead of by separate passes
+over a 32-bit output.
+
+a: Must be a two-dimensional tensor.
+b: Must be a two-dimensional tensor.
+bias: A one-dimensional float tensor with one value per column of the
+  product.
+transpose_a: If true, `a` is transposed before multiplication.
+transpose_b: If true, `b` is transposed before multiplication.
+fused_relu: If true, negative results are replaced by zero.
+min_a: The float value that the lowest quantized `a` value represents.
+max_a: The float value that the highest quantized `a` value represents.
+min_b: The float value that the lowest quantized `b` value represents.
+max_b: The float value that the highest quantized `b` value represents.
+min_freezed_output: The float value that the lowest quantized output value
+  represents.
+max_freezed_output: The float value that the highest quantized output value
+  represents.
+min_out: The float value that the lowest quantized output value represents.
+max_out: The float value that the highest quantized output value represents.
+
+)doc");
+
 REGISTER_OP("QuantizedMul")
     .Input("x: T1")
     .Input("y: T2")
@@ -3031,6 +3179,58 @@ Equivalent to np.digitize.
 @end_compatibility
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("x: T")
+    .Input("operands: N * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("N: int >= 0")
+    .Attr("ops: list(string) >= 1")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Applies a chain of element-wise ops to x in a single pass over memory.
+
+Each of `ops` is one of "Add", "Mul", "Relu" and "Tanh", applied in order to the
+result of the previous op, starting with x. "Add" and "Mul" take the next of
+`operands` as their second argument, which must have the shape of x or be a
+scalar. Inserted by the grappler element-wise fusion pass.
+
+x: The input of the first op.
+operands: The second arguments of the binary ops, in order.
+y: The result of the last op, with the shape of x.
+ops: The ops of the chain.
+)doc");
+
+REGISTER_OP("_BatchedElementwise")
+    .Input("x: N * T")
+    .Input("operands: M * T")
+    .Output("y: N * T")
+    .Attr("T: {float, double}")
+    .Attr("N: int >= 1")
+    .Attr("M: int >= 0")
+    .Attr("ops: list(string) >= 1")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      for (int i = 0; i < n; ++i) {
+        c->set_output(i, c->input(i));
+      }
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Applies independent element-wise ops to the tensors of x in a single kernel.
+
+`ops[i]` is one of "Add", "Mul", "Relu" and "Tanh", applied to `x[i]`. "Add"
+and "Mul" take the next of `operands` as their second argument, which must have
+the shape of `x[i]` or be a scalar. Inserted by the grappler small op batching
+pass, so that many tiny ops cost a single GPU kernel launch.
+
+x: The inputs of the ops.
+operands: The second arguments of the binary ops, in order.
+y: The results of the ops, with the shapes of x.
+ops: The op applied to each of x.
+)doc");
+
 #ifdef INTEL_MKL
 REGISTER_OP("_MklAddN")
     .Input("inputs: N * T")
@@ -865,6 +865,70 @@ strides: 1-D of length 4.  The stride of the sliding window for each dimension
 padding: The type of padding algorithm to use.
  )doc");
 
+REGISTER_OP("FusedConv2DWithBias")
+    .Input("input: T")
+    .Input("filter: T")
+    .Input("bias: T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("strides: list(int)")
+    .Attr(GetPaddingAttrString())
+    .Attr("activation: {'Identity', 'Relu', 'Relu6'} = 'Relu'")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle input;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 4, &input));
+      ShapeHandle filter;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 4, &filter));
+      ShapeHandle bias;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &bias));
+      std::vector<int32> strides;
+      TF_RETURN_IF_ERROR(c->GetAttr("strides", &strides));
+      if (strides.size() != 4) {
+        return errors::InvalidArgument(
+            "FusedConv2DWithBias requires the stride attribute to contain 4 "
+            "values, but got: ",
+            strides.size());
+      }
+      Padding padding;
+      TF_RETURN_IF_ERROR(c->GetAttr("padding", &padding));
+
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(input, 3), c->Dim(filter, 2), &unused));
+      DimensionHandle output_depth_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(filter, 3), c->Dim(bias, 0), &output_depth_dim));
+
+      DimensionHandle output_rows, output_cols;
+      TF_RETURN_IF_ERROR(GetWindowedOutputSizeFromDims(
+          c, c->Dim(input, 1), c->Dim(filter, 0), strides[1], padding,
+          &output_rows));
+      TF_RETURN_IF_ERROR(GetWindowedOutputSizeFromDims(
+          c, c->Dim(input, 2), c->Dim(filter, 1), strides[2], padding,
+          &output_cols));
+      c->set_output(0, c->MakeShape({c->Dim(input, 0), output_rows,
+                                     output_cols, output_depth_dim}));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes a 2-D convolution, adds a bias and applies an activation.
+
+Computes the same result as `Conv2D` followed by `BiasAdd` and `activation`,
+but adds the bias and applies the activation to each block of the output
+while it is still in cache, instead of making two more passes over the whole
+output. The data_format and dilations attributes of Conv2D aren't supported
+by this op, and 'NHWC' order is used instead.
+
+input: 4-D with shape `[batch, in_height, in_width, in_channels]`.
+filter: 4-D with shape
+  `[filter_height, filter_width, in_channels, out_channels]`.
+bias: 1-D with size `out_channels`.
+strides: 1-D of length 4.  The stride of the sliding window for each dimension
+   of `input`.
+padding: The type of padding algorithm to use.
+activation: The activation applied after the bias is added.
+ )doc");
+
 // --------------------------------------------------------------------------
 
 REGISTER_OP("DepthwiseConv2dNative")
@@ -2156,6 +2220,108 @@ backprop: backpropagated gradients (batch_size x num_classes matrix).
 
 // --------------------------------------------------------------------------
 
+REGISTER_OP("SparseSoftmaxCrossEntropyWithProjection")
+    .Input("inputs: T")
+    .Input("weights: T")
+    .Input("biases: T")
+    .Input("labels: Tlabels")
+    .Output("loss: T")
+    .Output("log_sum_exp: T")
+    .Attr("T: {float, double}")
+    .Attr("Tlabels: {int32, int64} = DT_INT64")
+    .Attr("chunk_size: int = 8192")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle inputs;
+      ShapeHandle weights;
+      ShapeHandle biases;
+      ShapeHandle labels;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &inputs));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &weights));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &biases));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &labels));
+
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(inputs, 1), c->Dim(weights, 1), &unused));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(weights, 0), c->Dim(biases, 0), &unused));
+      DimensionHandle batch_size;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(inputs, 0), c->Dim(labels, 0), &batch_size));
+
+      c->set_output(0, c->Vector(batch_size));
+      c->set_output(1, c->Vector(batch_size));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes sparse softmax cross entropy over a linear projection.
+
+Computes the loss of `SparseSoftmaxCrossEntropyWithLogits` for the logits
+`matmul(inputs, weights, transpose_b=True) + biases` without materializing
+them: the logits are computed `chunk_size` classes at a time and merged into
+a running log-sum-exp of each row.
+
+inputs: batch_size x dim matrix.
+weights: num_classes x dim matrix.
+biases: num_classes vector.
+labels: batch_size vector with values in [0, num_classes).
+  This is the label for the given minibatch entry.
+loss: Per example loss (batch_size vector).
+log_sum_exp: The log of the sum of the exponentials of the logits of each
+  example (batch_size vector), which the gradient reuses.
+chunk_size: The number of classes whose logits are computed at a time.
+)doc");
+
+REGISTER_OP("SparseSoftmaxCrossEntropyWithProjectionGrad")
+    .Input("inputs: T")
+    .Input("weights: T")
+    .Input("biases: T")
+    .Input("labels: Tlabels")
+    .Input("log_sum_exp: T")
+    .Input("loss_grad: T")
+    .Output("inputs_grad: T")
+    .Output("weights_grad: T")
+    .Output("biases_grad: T")
+    .Attr("T: {float, double}")
+    .Attr("Tlabels: {int32, int64} = DT_INT64")
+    .Attr("chunk_size: int = 8192")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(5), 1, &unused));
+      ShapeHandle inputs;
+      ShapeHandle weights;
+      ShapeHandle biases;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &inputs));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &weights));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &biases));
+      c->set_output(0, inputs);
+      c->set_output(1, weights);
+      c->set_output(2, biases);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Computes the gradients of `SparseSoftmaxCrossEntropyWithProjection`.
+
+The logits are computed again `chunk_size` classes at a time, so the
+batch_size x num_classes logits are never materialized.
+
+inputs: batch_size x dim matrix.
+weights: num_classes x dim matrix.
+biases: num_classes vector.
+labels: batch_size vector with values in [0, num_classes).
+log_sum_exp: The log_sum_exp output of
+  `SparseSoftmaxCrossEntropyWithProjection`.
+loss_grad: The gradient of the loss (batch_size vector).
+inputs_grad: The gradient of `inputs`.
+weights_grad: The gradient of `weights`.
+biases_grad: The gradient of `biases`.
+chunk_size: The number of classes whose logits are computed at a time.
+)doc");
+
+// --------------------------------------------------------------------------
+
 REGISTER_OP("InTopK")
     .Input("predictions: float")
     .Input("targets: T")
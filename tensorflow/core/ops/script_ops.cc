@@ -24,6 +24,7 @@ REGISTER_OP("PyFunc")
     .Attr("token: string")
     .Attr("Tin: list(type) >= 0")
     .Attr("Tout: list(type) >=0")
+    .Attr("max_batch_size: int = 0")
     .SetIsStateful()
     .SetShapeFn(shape_inference::UnknownShape)
     .Doc(R"doc(
@@ -38,6 +39,9 @@ output: The outputs from the Op.
 Tin: Data types of the inputs to the op.
 Tout: Data types of the outputs from the op.
       The length of the list specifies the number of outputs.
+max_batch_size: If positive, the python function is vectorized: it is called
+  with the inputs of up to `max_batch_size` concurrent runs of the op stacked
+  along a new first dimension, and must return outputs stacked the same way.
 )doc");
 
 REGISTER_OP("PyFuncStateless")
@@ -46,6 +50,7 @@ REGISTER_OP("PyFuncStateless")
     .Attr("token: string")
     .Attr("Tin: list(type) >= 0")
     .Attr("Tout: list(type) >= 0")
+    .Attr("max_batch_size: int = 0")
     .SetShapeFn(shape_inference::UnknownShape)
     .Doc(R"doc(
 A stateless version of PyFunc.
@@ -185,6 +185,70 @@ adjoint_b: Use the adjoint of B in the matrix multiply.  If B is complex, this
   is transpose(conj(B)).  Otherwise it's transpose(B).
 )doc");
 
+REGISTER_OP("SparseTensorToCSRSparseMatrix")
+    .Input("indices: int64")
+    .Input("values: T")
+    .Input("dense_shape: int64")
+    .Output("csr: variant")
+    .Attr("T: {float, double, complex64, complex128}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      c->set_output(0, c->Scalar());
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Converts a SparseTensor of rank 2 to a CSRSparseMatrix.
+
+The matrix is stored in compressed sparse row (CSR) format together with its
+transpose, which is its compressed sparse column (CSC) format, in a scalar
+variant tensor. Converting a matrix that is used in many products once, and
+passing the result to each `CSRSparseMatrixMatMul`, avoids regrouping its
+entries by row in every product. The indices do not need to be ordered; repeated
+indices are summed by the products.
+
+indices: 2-D.  The `indices` of the `SparseTensor`, size `[nnz, 2]` Matrix.
+values: 1-D.  The `values` of the `SparseTensor`, size `[nnz]` Vector.
+dense_shape: 1-D.  The `shape` of the `SparseTensor`, size `[2]` Vector.
+csr: A scalar variant tensor holding the CSRSparseMatrix.
+)doc");
+
+REGISTER_OP("CSRSparseMatrixMatMul")
+    .Input("a: variant")
+    .Input("b: T")
+    .Output("product: T")
+    .Attr("T: {float, double, complex64, complex128}")
+    .Attr("adjoint_a: bool = false")
+    .Attr("adjoint_b: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      ShapeHandle b;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &b));
+      bool adjoint_b;
+      TF_RETURN_IF_ERROR(c->GetAttr("adjoint_b", &adjoint_b));
+      c->set_output(0, c->Matrix(InferenceContext::kUnknownDim,
+                                 c->Dim(b, adjoint_b ? 0 : 1)));
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Multiply the CSRSparseMatrix "A" by the dense matrix "B".
+
+Computes the same product as `SparseTensorDenseMatMul`. Each row of the output
+is computed from one row of A (or of its transpose if `adjoint_a`), so rows are
+partitioned across threads on CPU and computed without atomics on GPU.
+
+a: A scalar variant tensor holding a CSRSparseMatrix, as returned by
+  `SparseTensorToCSRSparseMatrix`.
+b: 2-D.  A dense Matrix.
+adjoint_a: Use the adjoint of A in the matrix multiply.  If A is complex, this
+  is transpose(conj(A)).  Otherwise it's transpose(A).
+adjoint_b: Use the adjoint of B in the matrix multiply.  If B is complex, this
+  is transpose(conj(B)).  Otherwise it's transpose(B).
+)doc");
+
 REGISTER_OP("SerializeSparse")
     .Input("sparse_indices: int64")
     .Input("sparse_values: T")
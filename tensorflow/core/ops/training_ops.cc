@@ -1295,6 +1295,64 @@ var - lr * momentum * accum, so in the end, the var you get is actually
 var - lr * momentum * accum.
 )doc");
 
+// Checks the inputs of a ResourceMultiApplyXYZ op, whose first
+// <num_var_lists> inputs are lists of N variables with the shapes of the
+// gradients in "grad", and whose inputs <scalars> are scalars, where N is the
+// number of gradients.
+static Status MultiApplyShapeFn(InferenceContext* c, int num_var_lists,
+                                const std::vector<int>& scalars) {
+  std::vector<ShapeHandle> grad;
+  TF_RETURN_IF_ERROR(c->input("grad", &grad));
+  const int n = grad.size();
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = grad[i];
+    for (int l = 0; l < num_var_lists; ++l) {
+      TF_RETURN_IF_ERROR(c->Merge(s, ShapeOrHandleShape(c, l * n + i), &s));
+    }
+  }
+  ShapeHandle unused;
+  for (int i : scalars) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+  }
+  return Status::OK();
+}
+
+REGISTER_OP("ResourceMultiApplyMomentum")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Input("momentum: T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      // lr and momentum.
+      return MultiApplyShapeFn(c, 2, {2 * n, 3 * n + 1});
+    })
+    .Doc(R"doc(
+Update each '*var[i]' according to the momentum scheme, as
+ResourceApplyMomentum does, in a single kernel.
+
+accum[i] = accum[i] * momentum + grad[i]
+var[i] -= lr * accum[i]
+
+var: Should be from Variables.
+accum: Should be from Variables, with the shapes of `var`.
+lr: Scaling factor. Must be a scalar.
+grad: The gradients, with the shapes of `var`.
+momentum: Momentum. Must be a scalar.
+use_locking: If `True`, updating of the var and accum tensors will be protected
+  by a lock; otherwise the behavior is undefined, but may exhibit less
+  contention.
+use_nesterov: If `True`, the tensor passed to compute grad will be
+var - lr * momentum * accum, so in the end, the var you get is actually
+var - lr * momentum * accum.
+)doc");
+
 REGISTER_OP("ResourceSparseApplyMomentum")
     .Input("var: resource")
     .Input("accum: resource")
@@ -1435,6 +1493,53 @@ use_locking: If `True`, updating of the var, m, and v tensors will be protected
 use_nesterov: If `True`, uses the nesterov update.
 )doc");
 
+REGISTER_OP("ResourceMultiApplyAdam")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      int n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      // beta1_power, beta2_power, lr, beta1, beta2 and epsilon.
+      return MultiApplyShapeFn(
+          c, 3, {3 * n, 3 * n + 1, 3 * n + 2, 3 * n + 3, 3 * n + 4, 3 * n + 5});
+    })
+    .Doc(R"doc(
+Update each '*var[i]' according to the Adam algorithm, as ResourceApplyAdam
+does, in a single kernel.
+
+lr_t <- learning_rate * sqrt(1 - beta2^t) / (1 - beta1^t)
+m_t <- beta1 * m_{t-1} + (1 - beta1) * g_t
+v_t <- beta2 * v_{t-1} + (1 - beta2) * g_t * g_t
+variable <- variable - lr_t * m_t / (sqrt(v_t) + epsilon)
+
+var: Should be from Variables.
+m: Should be from Variables, with the shapes of `var`.
+v: Should be from Variables, with the shapes of `var`.
+beta1_power: Must be a scalar.
+beta2_power: Must be a scalar.
+lr: Scaling factor. Must be a scalar.
+beta1: Momentum factor. Must be a scalar.
+beta2: Momentum factor. Must be a scalar.
+epsilon: Ridge term. Must be a scalar.
+grad: The gradients, with the shapes of `var`.
+use_locking: If `True`, updating of the var, m, and v tensors will be protected
+  by a lock; otherwise the behavior is undefined, but may exhibit less
+  contention.
+use_nesterov: If `True`, uses the nesterov update.
+)doc");
+
 static Status ApplyRMSPropShapeFn(InferenceContext* c, bool sparse) {
   ShapeHandle unused;
   ShapeHandle s = ShapeOrHandleShape(c, 0);                       // var
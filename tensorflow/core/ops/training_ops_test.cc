@@ -13,8 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -248,6 +250,31 @@ TEST(TrainingOpsTest, ApplyMomentum_ShapeFn) {
   INFER_ERROR("Shape must be rank 0 but is rank 1", op, "?;?;?;?;[?]");
 }
 
+TEST(TrainingOpsTest, ResourceMultiApplyMomentum_ShapeFn) {
+  ShapeInferenceTestOp op("ResourceMultiApplyMomentum");
+  std::vector<NodeDefBuilder::NodeOut> vars(2, {"a", 0, DT_RESOURCE});
+  std::vector<NodeDefBuilder::NodeOut> grads(2, {"b", 0, DT_FLOAT});
+  TF_ASSERT_OK(NodeDefBuilder("test", "ResourceMultiApplyMomentum")
+                   .Input(vars)
+                   .Input(vars)
+                   .Input("lr", 0, DT_FLOAT)
+                   .Input(grads)
+                   .Input("momentum", 0, DT_FLOAT)
+                   .Finalize(&op.node_def));
+
+  // Inputs are var[0], var[1], accum[0], accum[1], lr, grad[0], grad[1] and
+  // momentum.
+  INFER_OK(op, "[1];[2,3];[1];[2,?];[];[?];[?,3];[]", "");
+  INFER_ERROR("Dimension 0 in both shapes must be equal, but are 2 and 1", op,
+              "[1];?;?;?;[];[2];?;[]");
+  INFER_ERROR("Dimension 0 in both shapes must be equal, but are 2 and 1", op,
+              "?;?;?;[1];[];?;[2];[]");
+
+  // lr and momentum must be scalars.
+  INFER_ERROR("Shape must be rank 0 but is rank 1", op, "?;?;?;?;[?];?;?;?");
+  INFER_ERROR("Shape must be rank 0 but is rank 1", op, "?;?;?;?;?;?;?;[?]");
+}
+
 TEST(TrainingOpsTest, SparseApplyMomentum_ShapeFn) {
   ShapeInferenceTestOp op("SparseApplyMomentum");
 
@@ -289,6 +316,28 @@ TEST(TrainingOpsTest, ApplyAdam_ShapeFn) {
   INFER_ERROR(err, op, "?;?;?;?;?;?;?;?;[?];?");
 }
 
+TEST(TrainingOpsTest, ResourceMultiApplyAdam_ShapeFn) {
+  ShapeInferenceTestOp op("ResourceMultiApplyAdam");
+  std::vector<NodeDefBuilder::NodeOut> vars(1, {"a", 0, DT_RESOURCE});
+  std::vector<NodeDefBuilder::NodeOut> grads(1, {"b", 0, DT_FLOAT});
+  NodeDefBuilder builder("test", "ResourceMultiApplyAdam");
+  builder.Input(vars).Input(vars).Input(vars);
+  for (int i = 0; i < 6; ++i) builder.Input("scalar", i, DT_FLOAT);
+  TF_ASSERT_OK(builder.Input(grads).Finalize(&op.node_def));
+
+  // var, m, v and grad are merged.
+  INFER_OK(op, "[1,?,?,?];[?,2,?,?];[?,?,3,?];[];[];[];[];[];[];[?,?,?,4]", "");
+  INFER_ERROR("Dimension 0 in both shapes must be equal, but are 1 and 2", op,
+              "[1];[2];[1];[];[];[];[];[];[];[1]");
+  INFER_ERROR("Dimension 0 in both shapes must be equal, but are 2 and 1", op,
+              "[1];[1];[1];[];[];[];[];[];[];[2]");
+
+  // beta1_power, beta2_power, lr, beta1, beta2, and epsilon must be scalars.
+  const char err[] = "Shape must be rank 0 but is rank 1";
+  INFER_ERROR(err, op, "?;?;?;[?];?;?;?;?;?;?");
+  INFER_ERROR(err, op, "?;?;?;?;?;?;?;?;[?];?");
+}
+
 TEST(TrainingOpsTest, ApplyRMSProp_ShapeFn) {
   ShapeInferenceTestOp op("ApplyRMSProp");
 
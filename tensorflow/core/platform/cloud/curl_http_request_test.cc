@@ -440,6 +440,29 @@ TEST(CurlHttpRequestTest, PutRequest_WithBody_FromFile_NonZeroOffset) {
   std::remove(content_filename.c_str());
 }
 
+TEST(CurlHttpRequestTest, PutRequest_WithBody_FromMemory) {
+  FakeLibCurl libcurl("", 200);
+  CurlHttpRequest http_request(&libcurl);
+  TF_EXPECT_OK(http_request.Init());
+
+  string content = "put body content";
+
+  TF_EXPECT_OK(http_request.SetUri("http://www.testuri.com"));
+  TF_EXPECT_OK(http_request.AddAuthBearerHeader("fake-bearer"));
+  TF_EXPECT_OK(http_request.SetPutFromBuffer(content.c_str(), content.size()));
+  TF_EXPECT_OK(http_request.Send());
+
+  // Check interactions with libcurl.
+  EXPECT_TRUE(libcurl.is_initialized_);
+  EXPECT_EQ("http://www.testuri.com", libcurl.url_);
+  EXPECT_EQ("", libcurl.custom_request_);
+  EXPECT_EQ(2, libcurl.headers_->size());
+  EXPECT_EQ("Authorization: Bearer fake-bearer", (*libcurl.headers_)[0]);
+  EXPECT_EQ("Content-Length: 16", (*libcurl.headers_)[1]);
+  EXPECT_TRUE(libcurl.is_put_);
+  EXPECT_EQ("put body content", libcurl.posted_content_);
+}
+
 TEST(CurlHttpRequestTest, PutRequest_WithoutBody) {
   FakeLibCurl libcurl("", 200);
   CurlHttpRequest http_request(&libcurl);
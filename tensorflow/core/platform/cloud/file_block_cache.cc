@@ -17,9 +17,41 @@ limitations under the License.
 #include <cstring>
 #include <memory>
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
+namespace {
+
+auto* block_cache_hits = monitoring::Counter<0>::New(
+    "/tensorflow/core/file_block_cache/hits",
+    "The number of blocks read from a FileBlockCache that had been fetched.");
+
+auto* block_cache_misses = monitoring::Counter<0>::New(
+    "/tensorflow/core/file_block_cache/misses",
+    "The number of blocks read from a FileBlockCache that had to be fetched, "
+    "or waited for.");
+
+auto* block_cache_fetched_bytes = monitoring::Counter<0>::New(
+    "/tensorflow/core/file_block_cache/fetched_bytes",
+    "The number of bytes fetched by FileBlockCaches.");
+
+auto* block_cache_bytes_in_flight = monitoring::Gauge<int64, 0>::New(
+    "/tensorflow/core/file_block_cache/bytes_in_flight",
+    "The number of bytes requested by the fetches of FileBlockCaches that "
+    "have not finished.");
+
+mutex bytes_in_flight_mu(LINKER_INITIALIZED);
+int64 bytes_in_flight GUARDED_BY(bytes_in_flight_mu) = 0;
+
+void UpdateBytesInFlight(int64 delta) {
+  mutex_lock l(bytes_in_flight_mu);
+  bytes_in_flight += delta;
+  block_cache_bytes_in_flight->GetCell()->Set(bytes_in_flight);
+}
+
+}  // namespace
 
 bool FileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
   mutex_lock l(block->mu);
@@ -75,15 +107,19 @@ Status FileBlockCache::UpdateLRU(const Key& key,
     block->lru_iterator = lru_list_.begin();
   }
 
-  // Check for inconsistent state. If there is a block later in the same file
-  // in the cache, and our current block is not block size, this likely means
-  // we have inconsistent state within the cache. Note: it's possible some
-  // incomplete reads may still go undetected.
+  // Check for inconsistent state. If there is a block with data later in the
+  // same file in the cache, and our current block is not block size, this
+  // likely means we have inconsistent state within the cache. Later blocks
+  // that are still being fetched in the background, or that came back empty,
+  // are expected. Note: it's possible some incomplete reads may still go
+  // undetected.
   if (block->data.size() < block_size_) {
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
     auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    while (fcmp != block_map_.begin() && key < (--fcmp)->first) {
+      if (IsFetched(fcmp->second) && !fcmp->second->data.empty()) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
     }
   }
 
@@ -123,8 +159,11 @@ Status FileBlockCache::MaybeFetch(const Key& key,
       case FetchState::CREATED:
         block->state = FetchState::FETCHING;
         block->mu.unlock();  // Release the lock while making the API call.
+        UpdateBytesInFlight(block_size_);
         status.Update(
             block_fetcher_(key.first, key.second, block_size_, &block->data));
+        UpdateBytesInFlight(-static_cast<int64>(block_size_));
+        block_cache_fetched_bytes->GetCell()->IncrementBy(block->data.size());
         block->mu.lock();  // Reacquire the lock immediately afterwards
         if (status.ok()) {
           downloaded_block = true;
@@ -149,6 +188,56 @@ Status FileBlockCache::MaybeFetch(const Key& key,
       "Control flow should never reach the end of FileBlockCache::Fetch.");
 }
 
+bool FileBlockCache::IsFetched(const std::shared_ptr<Block>& block) {
+  mutex_lock l(block->mu);
+  return block->state == FetchState::FINISHED;
+}
+
+void FileBlockCache::MaybeFetchInBackground(
+    const Key& key, const std::shared_ptr<Block>& block) {
+  if (pending_fetches_ >= max_parallel_fetches_) {
+    return;
+  }
+  {
+    mutex_lock l(block->mu);
+    if (block->state == FetchState::FETCHING ||
+        block->state == FetchState::FINISHED) {
+      return;
+    }
+  }
+  ++pending_fetches_;
+  fetch_pool_->Schedule([this, key, block]() {
+    // An error is reported by the next Read() of the block, which fetches it
+    // again.
+    Status status = MaybeFetch(key, block);
+    mutex_lock lock(mu_);
+    --pending_fetches_;
+    if (status.ok() && block->data.empty()) {
+      // The block is past the end of the file, so do not keep it.
+      auto entry = block_map_.find(key);
+      if (entry != block_map_.end() && entry->second == block) {
+        RemoveBlock(entry);
+      }
+    }
+    Trim();
+  });
+}
+
+void FileBlockCache::Prefetch(const string& filename, size_t offset,
+                              size_t n) {
+  if (!fetch_pool_ || n == 0) {
+    return;
+  }
+  n = std::min(n, max_bytes_ / 2);
+  const size_t start = block_size_ * (offset / block_size_);
+  for (size_t pos = start; pos < offset + n; pos += block_size_) {
+    Key key = std::make_pair(filename, pos);
+    std::shared_ptr<Block> block = Lookup(key);
+    mutex_lock lock(mu_);
+    MaybeFetchInBackground(key, block);
+  }
+}
+
 Status FileBlockCache::Read(const string& filename, size_t offset, size_t n,
                             std::vector<char>* out) {
   out->clear();
@@ -166,6 +255,9 @@ Status FileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  // Fetch the blocks after the first one in the background, while this thread
+  // fetches the first one.
+  Prefetch(filename, start + block_size_, finish - start - block_size_);
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
@@ -173,6 +265,11 @@ Status FileBlockCache::Read(const string& filename, size_t offset, size_t n,
     // LRU iterator for the key and block.
     std::shared_ptr<Block> block = Lookup(key);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
+    if (IsFetched(block)) {
+      block_cache_hits->GetCell()->IncrementBy(1);
+    } else {
+      block_cache_misses->GetCell()->IncrementBy(1);
+    }
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
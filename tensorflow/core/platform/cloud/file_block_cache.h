@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <vector>
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
@@ -47,20 +49,31 @@ class FileBlockCache {
                                std::vector<char>*)>
       BlockFetcher;
 
+  /// If `max_parallel_fetches` is greater than 1, the blocks of a read that
+  /// spans several blocks, and the blocks passed to Prefetch(), are fetched
+  /// concurrently by up to that many threads.
   FileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                 BlockFetcher block_fetcher, Env* env = Env::Default())
+                 BlockFetcher block_fetcher, Env* env = Env::Default(),
+                 size_t max_parallel_fetches = 1)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        max_parallel_fetches_(std::max<size_t>(max_parallel_fetches, 1)) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (max_parallel_fetches_ > 1 && block_size_ > 0 && max_bytes_ > 0) {
+      fetch_pool_.reset(new thread::ThreadPool(env_, "TF_fetch_FBC",
+                                               max_parallel_fetches_));
+    }
   }
 
   ~FileBlockCache() {
+    // Destroying fetch_pool_ will block until the background fetches finish.
+    fetch_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -86,6 +99,14 @@ class FileBlockCache {
   Status Read(const string& filename, size_t offset, size_t n,
               std::vector<char>* out);
 
+  /// Start fetching the blocks of `filename` that hold the `n` bytes at
+  /// `offset` in the background, so that a later Read() of them does not wait
+  /// for the remote filesystem. Returns without waiting. This is a no-op
+  /// unless `max_parallel_fetches` is greater than 1, and it fetches at most
+  /// `max_bytes / 2` bytes, so that it does not evict the blocks being read.
+  void Prefetch(const string& filename, size_t offset, size_t n)
+      LOCKS_EXCLUDED(mu_);
+
   /// Remove all cached blocks for `filename`.
   void RemoveFile(const string& filename) LOCKS_EXCLUDED(mu_);
 
@@ -93,6 +114,7 @@ class FileBlockCache {
   size_t block_size() const { return block_size_; }
   size_t max_bytes() const { return max_bytes_; }
   uint64 max_staleness() const { return max_staleness_; }
+  size_t max_parallel_fetches() const { return max_parallel_fetches_; }
 
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const LOCKS_EXCLUDED(mu_);
@@ -109,6 +131,8 @@ class FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched concurrently by fetch_pool_.
+  const size_t max_parallel_fetches_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -178,6 +202,15 @@ class FileBlockCache {
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       LOCKS_EXCLUDED(mu_);
 
+  /// Schedule MaybeFetch() on fetch_pool_ if the block has not been fetched,
+  /// and fewer than max_parallel_fetches_ background fetches are pending.
+  void MaybeFetchInBackground(const Key& key,
+                              const std::shared_ptr<Block>& block)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Returns true if the block has been fetched successfully.
+  static bool IsFetched(const std::shared_ptr<Block>& block);
+
   /// Trim the block cache to make room for another entry.
   void Trim() EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -198,6 +231,10 @@ class FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads that run the background fetches, if max_parallel_fetches_ is
+  /// greater than 1.
+  std::unique_ptr<thread::ThreadPool> fetch_pool_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -217,6 +254,10 @@ class FileBlockCache {
 
   /// The combined number of bytes in all of the cached blocks.
   size_t cache_size_ GUARDED_BY(mu_) = 0;
+
+  /// The number of background fetches that have been scheduled and have not
+  /// finished.
+  size_t pending_fetches_ GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace tensorflow
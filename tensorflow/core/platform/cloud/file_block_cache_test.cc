@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/file_block_cache.h"
+#include <algorithm>
 #include <cstring>
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -470,5 +471,81 @@ TEST(FileBlockCacheTest, CoalesceConcurrentReads) {
   EXPECT_EQ(1, num_requests);
 }
 
+TEST(FileBlockCacheTest, ParallelFetchesOfOneRead) {
+  // This fetcher won't respond until `callers` blocks are being fetched
+  // concurrently, or 10 seconds have elapsed.
+  const int callers = 4;
+  BlockingCounter counter(callers);
+  auto fetcher = [&counter](const string& filename, size_t offset, size_t n,
+                            std::vector<char>* out) {
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    out->resize(n, 'x');
+    return Status::OK();
+  };
+  const int block_size = 8;
+  FileBlockCache cache(block_size, 2 * callers * block_size, 0, fetcher,
+                       Env::Default(), callers);
+  std::vector<char> out;
+  TF_EXPECT_OK(cache.Read("a", 0, callers * block_size, &out));
+  EXPECT_EQ(out, std::vector<char>(callers * block_size, 'x'));
+}
+
+TEST(FileBlockCacheTest, Prefetch) {
+  const size_t block_size = 16;
+  mutex mu;
+  std::vector<size_t> calls;
+  auto fetcher = [&mu, &calls](const string& filename, size_t offset, size_t n,
+                               std::vector<char>* out) {
+    {
+      mutex_lock l(mu);
+      calls.push_back(offset);
+    }
+    out->resize(n, 'x');
+    return Status::OK();
+  };
+  std::vector<char> out;
+  // Prefetching is disabled without parallel fetches.
+  FileBlockCache serial_cache(block_size, 4 * block_size, 0, fetcher);
+  serial_cache.Prefetch("a", 0, 2 * block_size);
+  EXPECT_EQ(serial_cache.CacheSize(), 0);
+  EXPECT_TRUE(calls.empty());
+
+  FileBlockCache cache(block_size, 4 * block_size, 0, fetcher, Env::Default(),
+                       2);
+  cache.Prefetch("a", 0, 2 * block_size);
+  // The reads wait for the prefetched blocks instead of fetching them again.
+  TF_EXPECT_OK(cache.Read("a", 0, block_size, &out));
+  TF_EXPECT_OK(cache.Read("a", block_size, block_size, &out));
+  EXPECT_EQ(out, std::vector<char>(block_size, 'x'));
+  EXPECT_EQ(cache.CacheSize(), 2 * block_size);
+  mutex_lock l(mu);
+  std::sort(calls.begin(), calls.end());
+  EXPECT_EQ(calls, std::vector<size_t>({0, block_size}));
+}
+
+TEST(FileBlockCacheTest, PrefetchPastEndOfFile) {
+  const size_t block_size = 8;
+  const size_t file_size = 12;
+  auto fetcher = [file_size](const string& filename, size_t offset, size_t n,
+                             std::vector<char>* out) {
+    if (offset < file_size) {
+      out->resize(std::min(n, file_size - offset), 'x');
+    }
+    return Status::OK();
+  };
+  FileBlockCache cache(block_size, 8 * block_size, 0, fetcher, Env::Default(),
+                       4);
+  cache.Prefetch("a", 0, 4 * block_size);
+  // The empty blocks past the end of the file do not make the partial last
+  // block look inconsistent.
+  std::vector<char> out;
+  TF_EXPECT_OK(cache.Read("a", 0, 4 * block_size, &out));
+  EXPECT_EQ(out.size(), file_size);
+  EXPECT_EQ(cache.CacheSize(), file_size);
+}
+
 }  // namespace
 }  // namespace tensorflow
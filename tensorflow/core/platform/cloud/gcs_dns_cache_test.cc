@@ -50,6 +50,10 @@ class TestHttpRequest : public HttpRequest {
   }
   Status SetPutEmptyBody() override { return Status::OK(); }
 
+  Status SetPutFromBuffer(const char* buffer, size_t size) override {
+    return Status::OK();
+  }
+
   Status SetPostFromBuffer(const char* buffer, size_t size) override {
     return Status::OK();
   }
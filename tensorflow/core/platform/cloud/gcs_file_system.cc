@@ -80,6 +80,17 @@ constexpr size_t kDefaultMaxCacheSize = 2 * kDefaultBlockSize;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that overrides the maximum number of blocks fetched
+// from GCS concurrently, by reads that span several blocks and by the
+// readahead of sequential reads. A value of 1 disables both.
+constexpr char kMaxParallelFetches[] = "GCS_READ_CACHE_MAX_PARALLEL_FETCHES";
+constexpr size_t kDefaultMaxParallelFetches = 4;
+// The environment variable that makes writable files stream their contents to
+// GCS in chunks of this size as they are written, instead of uploading them
+// from a local temporary file on every Sync(). Specified in MB. A value of 0
+// (the default) disables streaming uploads.
+constexpr char kUploadChunkSize[] = "GCS_WRITE_UPLOAD_CHUNK_SIZE_MB";
+constexpr size_t kDefaultUploadChunkSize = 0;
 // The environment variable that overrides the maximum age of entries in the
 // Stat cache. A value of 0 (the default) means nothing is cached.
 constexpr char kStatCacheMaxAge[] = "GCS_STAT_CACHE_MAX_AGE";
@@ -285,6 +296,7 @@ class GcsRandomAccessFile : public RandomAccessFile {
   Status Read(uint64 offset, size_t n, StringPiece* result,
               char* scratch) const override {
     *result = StringPiece();
+    MaybeReadAhead(offset, n);
     std::vector<char> out;
     TF_RETURN_IF_ERROR(file_block_cache_->Read(filename_, offset, n, &out));
     std::memcpy(scratch, out.data(), std::min(out.size(), n));
@@ -300,12 +312,73 @@ class GcsRandomAccessFile : public RandomAccessFile {
   }
 
  private:
+  /// If this read starts where the previous one ended, starts fetching the
+  /// blocks after it in the background. The number of blocks doubles with
+  /// each sequential read, up to the cache's max_parallel_fetches(), and goes
+  /// back to zero on a random read.
+  void MaybeReadAhead(uint64 offset, size_t n) const {
+    size_t readahead_blocks;
+    {
+      mutex_lock l(mu_);
+      if (offset == next_offset_) {
+        readahead_blocks_ =
+            std::min(std::max<size_t>(2 * readahead_blocks_, 1),
+                     file_block_cache_->max_parallel_fetches());
+      } else {
+        readahead_blocks_ = 0;
+      }
+      next_offset_ = offset + n;
+      readahead_blocks = readahead_blocks_;
+    }
+    if (readahead_blocks > 0) {
+      file_block_cache_->Prefetch(
+          filename_, offset + n,
+          readahead_blocks * file_block_cache_->block_size());
+    }
+  }
+
   /// The filename of this file.
   const string filename_;
   /// The LRU block cache for this file.
   mutable FileBlockCache* file_block_cache_;  // not owned
+
+  mutable mutex mu_;
+  /// The offset after the last read, which the next read of a sequential
+  /// access pattern starts at.
+  mutable uint64 next_offset_ GUARDED_BY(mu_) = 0;
+  /// The number of blocks after each read to start fetching.
+  mutable size_t readahead_blocks_ GUARDED_BY(mu_) = 0;
 };
 
+/// \brief Parses the Range header of a resumable upload status response.
+///
+/// Sets `uploaded` to the number of bytes that GCS has received.
+Status ParseUploadedRange(const string& received_range, const string& gcs_path,
+                          uint64* uploaded) {
+  if (received_range.empty()) {
+    // This means GCS doesn't have any bytes of the file yet.
+    *uploaded = 0;
+    return Status::OK();
+  }
+  StringPiece range_piece(received_range);
+  range_piece.Consume("bytes=");  // May or may not be present.
+  std::vector<int64> range_parts;
+  if (!str_util::SplitAndParseAsInts(range_piece, '-', &range_parts) ||
+      range_parts.size() != 2) {
+    return errors::Internal("Unexpected response from GCS when writing ",
+                            gcs_path, ": Range header '", received_range,
+                            "' could not be parsed.");
+  }
+  if (range_parts[0] != 0) {
+    return errors::Internal("Unexpected response from GCS when writing to ",
+                            gcs_path, ": the returned range '", received_range,
+                            "' does not start at zero.");
+  }
+  // If GCS returned "Range: 0-10", this means 11 bytes were uploaded.
+  *uploaded = range_parts[1] + 1;
+  return Status::OK();
+}
+
 /// \brief GCS-based implementation of a writeable file.
 ///
 /// Since GCS objects are immutable, this implementation writes to a local
@@ -519,29 +592,8 @@ class GcsWritableFile : public WritableFile {
       TF_RETURN_WITH_CONTEXT_IF_ERROR(status, " when resuming upload ",
                                       GetGcsPath());
     }
-    const string& received_range = request->GetResponseHeader("Range");
-    if (received_range.empty()) {
-      // This means GCS doesn't have any bytes of the file yet.
-      *uploaded = 0;
-    } else {
-      StringPiece range_piece(received_range);
-      range_piece.Consume("bytes=");  // May or may not be present.
-      std::vector<int64> range_parts;
-      if (!str_util::SplitAndParseAsInts(range_piece, '-', &range_parts) ||
-          range_parts.size() != 2) {
-        return errors::Internal("Unexpected response from GCS when writing ",
-                                GetGcsPath(), ": Range header '",
-                                received_range, "' could not be parsed.");
-      }
-      if (range_parts[0] != 0) {
-        return errors::Internal("Unexpected response from GCS when writing to ",
-                                GetGcsPath(), ": the returned range '",
-                                received_range, "' does not start at zero.");
-      }
-      // If GCS returned "Range: 0-10", this means 11 bytes were uploaded.
-      *uploaded = range_parts[1] + 1;
-    }
-    return Status::OK();
+    return ParseUploadedRange(request->GetResponseHeader("Range"),
+                              GetGcsPath(), uploaded);
   }
 
   Status UploadToSession(const string& session_uri, uint64 start_offset) {
@@ -583,6 +635,295 @@ class GcsWritableFile : public WritableFile {
   int64 initial_retry_delay_usec_;
 };
 
+/// \brief GCS-based implementation of a writeable file that streams its
+/// contents to GCS as they are appended.
+///
+/// Instead of buffering the whole object in a local temporary file and
+/// uploading it on Sync(), the appended data is sent to a resumable upload
+/// session in chunks of `chunk_size` bytes. Each full chunk is uploaded by a
+/// background thread while the next one is being filled, so at most two
+/// chunks are held in memory. GCS requires the chunk size to be a multiple of
+/// 256 KiB.
+///
+/// The object is only created in GCS by Close(), which uploads the last
+/// chunk. Flush() and Sync() wait for the full chunks to be uploaded and
+/// return their errors, but do not make the object visible.
+class GcsStreamingWritableFile : public WritableFile {
+ public:
+  GcsStreamingWritableFile(const string& bucket, const string& object,
+                           GcsFileSystem* filesystem,
+                           GcsFileSystem::TimeoutConfig* timeouts,
+                           std::function<void()> file_cache_erase,
+                           size_t chunk_size, int64 initial_retry_delay_usec)
+      : bucket_(bucket),
+        object_(object),
+        filesystem_(filesystem),
+        timeouts_(timeouts),
+        file_cache_erase_(std::move(file_cache_erase)),
+        chunk_size_(chunk_size),
+        initial_retry_delay_usec_(initial_retry_delay_usec) {
+    DCHECK_GT(chunk_size_, 0);
+    buffer_.reserve(chunk_size_);
+  }
+
+  ~GcsStreamingWritableFile() override { Close().IgnoreError(); }
+
+  Status Append(const StringPiece& data) override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    StringPiece remaining = data;
+    while (!remaining.empty()) {
+      const size_t n =
+          std::min(remaining.size(), chunk_size_ - buffer_.size());
+      buffer_.append(remaining.data(), n);
+      remaining.remove_prefix(n);
+      if (buffer_.size() == chunk_size_) {
+        TF_RETURN_IF_ERROR(StartChunkUpload());
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    if (closed_) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(WaitForChunkUpload());
+    if (!last_chunk_) {
+      NextChunk();
+      last_chunk_ = true;
+    }
+    // The last chunk may be shorter than chunk_size_, and its upload tells GCS
+    // the size of the object, which completes the upload.
+    TF_RETURN_IF_ERROR(UploadChunk());
+    closed_ = true;
+    string().swap(chunk_);
+    string().swap(buffer_);
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+    return Status::OK();
+  }
+
+  Status Flush() override { return Sync(); }
+
+  Status Sync() override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    return WaitForChunkUpload();
+  }
+
+ private:
+  Status CheckWritable() const {
+    if (closed_ || last_chunk_) {
+      return errors::FailedPrecondition("The file ", GetGcsPath(),
+                                        " is closed.");
+    }
+    return Status::OK();
+  }
+
+  /// Waits for the upload of the previous chunk, and starts uploading the full
+  /// buffer in the background.
+  Status StartChunkUpload() {
+    TF_RETURN_IF_ERROR(WaitForChunkUpload());
+    NextChunk();
+    upload_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "gcs_upload", [this]() {
+          upload_status_ = UploadChunk();
+        }));
+    return Status::OK();
+  }
+
+  /// Returns the status of the background uploads, once the one in flight (if
+  /// any) has finished. An error is permanent, because the chunks that were
+  /// not uploaded are not held anymore.
+  Status WaitForChunkUpload() {
+    // Destroying upload_thread_ blocks until it exits.
+    upload_thread_.reset();
+    return upload_status_;
+  }
+
+  /// Makes the buffer the chunk to upload, and reuses the memory of the
+  /// previous chunk for the buffer.
+  void NextChunk() {
+    chunk_offset_ += chunk_.size();
+    chunk_.swap(buffer_);
+    buffer_.clear();
+  }
+
+  /// Uploads chunk_, retrying and resuming failed uploads as recommended by
+  /// the GCS resumable API documentation.
+  Status UploadChunk() {
+    if (session_uri_.empty()) {
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [this]() { return CreateNewUploadSession(); },
+          initial_retry_delay_usec_));
+    }
+    const uint64 end = chunk_offset_ + chunk_.size();
+    uint64 uploaded = chunk_offset_;
+    bool first_attempt = true;
+    return RetryingUtils::CallWithRetries(
+        [this, end, &uploaded, &first_attempt]() {
+          bool completed = false;
+          if (!first_attempt) {
+            TF_RETURN_IF_ERROR(
+                RequestUploadSessionStatus(end, &completed, &uploaded));
+          }
+          first_attempt = false;
+          // GCS may keep only a part of a chunk, in which case the rest is
+          // sent again.
+          while (!completed && (last_chunk_ || uploaded < end)) {
+            const uint64 previously_uploaded = uploaded;
+            TF_RETURN_IF_ERROR(UploadRange(end, &completed, &uploaded));
+            if (!completed && uploaded == previously_uploaded) {
+              return errors::Unavailable("GCS did not accept any bytes of ",
+                                         GetGcsPath(), " at offset ", uploaded);
+            }
+          }
+          return Status::OK();
+        },
+        initial_retry_delay_usec_);
+  }
+
+  /// Initiates a new resumable upload session, of an object whose size is not
+  /// known yet.
+  Status CreateNewUploadSession() {
+    std::vector<char> output_buffer;
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    TF_RETURN_IF_ERROR(request->SetUri(strings::StrCat(
+        kGcsUploadUriBase, "b/", bucket_,
+        "/o?uploadType=resumable&name=", request->EscapeString(object_))));
+    TF_RETURN_IF_ERROR(request->SetPostEmptyBody());
+    TF_RETURN_IF_ERROR(request->SetResultBuffer(&output_buffer));
+    TF_RETURN_IF_ERROR(request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                            timeouts_->metadata));
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(
+        request->Send(), " when initiating an upload to ", GetGcsPath());
+    session_uri_ = request->GetResponseHeader("Location");
+    if (session_uri_.empty()) {
+      return errors::Internal("Unexpected response from GCS when writing to ",
+                              GetGcsPath(),
+                              ": 'Location' header not returned.");
+    }
+    return Status::OK();
+  }
+
+  /// The total size of the object for the Content-Range header, if known.
+  string TotalSize(uint64 end) const {
+    return last_chunk_ ? std::to_string(end) : "*";
+  }
+
+  /// \brief Requests the status of the upload session.
+  ///
+  /// If the upload has already succeeded, sets 'completed' to true.
+  /// Otherwise sets 'completed' to false and 'uploaded' to the currently
+  /// uploaded size in bytes, which must be within chunk_.
+  Status RequestUploadSessionStatus(uint64 end, bool* completed,
+                                    uint64* uploaded) {
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    TF_RETURN_IF_ERROR(request->SetUri(session_uri_));
+    TF_RETURN_IF_ERROR(request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                            timeouts_->metadata));
+    TF_RETURN_IF_ERROR(request->AddHeader(
+        "Content-Range", strings::StrCat("bytes */", TotalSize(end))));
+    TF_RETURN_IF_ERROR(request->SetPutEmptyBody());
+    const Status& status = request->Send();
+    if (status.ok()) {
+      *completed = true;
+      return Status::OK();
+    }
+    *completed = false;
+    if (request->GetResponseCode() != HTTP_CODE_RESUME_INCOMPLETE) {
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(status, " when resuming upload ",
+                                      GetGcsPath());
+    }
+    return ParseUploadedRangeOfChunk(request->GetResponseHeader("Range"), end,
+                                     uploaded);
+  }
+
+  /// Sends the bytes of chunk_ from `*uploaded` to `end`, and updates
+  /// `*uploaded` with the number of bytes that GCS has kept.
+  Status UploadRange(uint64 end, bool* completed, uint64* uploaded) {
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    TF_RETURN_IF_ERROR(request->SetUri(session_uri_));
+    if (*uploaded < end) {
+      TF_RETURN_IF_ERROR(request->AddHeader(
+          "Content-Range", strings::StrCat("bytes ", *uploaded, "-", end - 1,
+                                           "/", TotalSize(end))));
+    } else {
+      TF_RETURN_IF_ERROR(request->AddHeader(
+          "Content-Range", strings::StrCat("bytes */", TotalSize(end))));
+    }
+    TF_RETURN_IF_ERROR(request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                            timeouts_->write));
+    if (*uploaded < end) {
+      TF_RETURN_IF_ERROR(request->SetPutFromBuffer(
+          chunk_.data() + (*uploaded - chunk_offset_), end - *uploaded));
+    } else {
+      TF_RETURN_IF_ERROR(request->SetPutEmptyBody());
+    }
+    const Status& status = request->Send();
+    if (status.ok()) {
+      *completed = true;
+      *uploaded = end;
+      return Status::OK();
+    }
+    *completed = false;
+    if (request->GetResponseCode() != HTTP_CODE_RESUME_INCOMPLETE) {
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(status, " when uploading ",
+                                      GetGcsPath());
+    }
+    return ParseUploadedRangeOfChunk(request->GetResponseHeader("Range"), end,
+                                     uploaded);
+  }
+
+  Status ParseUploadedRangeOfChunk(const string& received_range, uint64 end,
+                                   uint64* uploaded) {
+    TF_RETURN_IF_ERROR(
+        ParseUploadedRange(received_range, GetGcsPath(), uploaded));
+    if (*uploaded < chunk_offset_) {
+      return errors::DataLoss("GCS lost the bytes of ", GetGcsPath(),
+                              " after offset ", *uploaded,
+                              ", which are not held anymore.");
+    }
+    if (*uploaded > end) {
+      return errors::Internal("Unexpected response from GCS when writing to ",
+                              GetGcsPath(), ": the returned range '",
+                              received_range, "' extends past offset ", end);
+    }
+    return Status::OK();
+  }
+
+  string GetGcsPath() const {
+    return strings::StrCat("gs://", bucket_, "/", object_);
+  }
+
+  const string bucket_;
+  const string object_;
+  GcsFileSystem* const filesystem_;  // Not owned.
+  GcsFileSystem::TimeoutConfig* timeouts_;
+  std::function<void()> file_cache_erase_;
+  const size_t chunk_size_;
+  const int64 initial_retry_delay_usec_;
+
+  /// The resumable upload session, once the first chunk is uploaded.
+  string session_uri_;
+  /// The data appended after chunk_.
+  string buffer_;
+  /// The chunk being uploaded, or the last one uploaded.
+  string chunk_;
+  /// The offset of chunk_ in the object.
+  uint64 chunk_offset_ = 0;
+  /// Whether chunk_ is the end of the object.
+  bool last_chunk_ = false;
+  bool closed_ = false;
+  /// The thread uploading chunk_, if any.
+  std::unique_ptr<Thread> upload_thread_;
+  /// The status of the previous upload by upload_thread_. Written by it, and
+  /// read after it is joined.
+  Status upload_status_;
+};
+
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
  public:
   GcsReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
@@ -616,6 +957,7 @@ GcsFileSystem::GcsFileSystem()
   size_t block_size = kDefaultBlockSize;
   size_t max_bytes = kDefaultMaxCacheSize;
   uint64 max_staleness = kDefaultMaxStaleness;
+  size_t max_parallel_fetches = kDefaultMaxParallelFetches;
   // Apply the sys env override for the readahead buffer size if it's provided.
   if (GetEnvVar(kReadaheadBufferSize, strings::safe_strtou64, &value)) {
     block_size = value;
@@ -631,7 +973,17 @@ GcsFileSystem::GcsFileSystem()
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
-  file_block_cache_ = MakeFileBlockCache(block_size, max_bytes, max_staleness);
+  if (GetEnvVar(kMaxParallelFetches, strings::safe_strtou64, &value)) {
+    max_parallel_fetches = value;
+  }
+  file_block_cache_ = MakeFileBlockCache(block_size, max_bytes, max_staleness,
+                                         max_parallel_fetches);
+  // Apply the override for the upload chunk size (MB) if provided. A multiple
+  // of 1 MB is a multiple of the 256 KiB that GCS requires.
+  upload_chunk_size_ = kDefaultUploadChunkSize;
+  if (GetEnvVar(kUploadChunkSize, strings::safe_strtou64, &value)) {
+    upload_chunk_size_ = value * 1024 * 1024;
+  }
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
   size_t stat_cache_max_entries = kStatCacheDefaultMaxEntries;
@@ -696,15 +1048,17 @@ GcsFileSystem::GcsFileSystem(
     uint64 stat_cache_max_age, size_t stat_cache_max_entries,
     uint64 matching_paths_cache_max_age,
     size_t matching_paths_cache_max_entries, int64 initial_retry_delay_usec,
-    TimeoutConfig timeouts)
+    TimeoutConfig timeouts, size_t max_parallel_fetches,
+    size_t upload_chunk_size)
     : auth_provider_(std::move(auth_provider)),
       http_request_factory_(std::move(http_request_factory)),
-      file_block_cache_(
-          MakeFileBlockCache(block_size, max_bytes, max_staleness)),
+      file_block_cache_(MakeFileBlockCache(block_size, max_bytes, max_staleness,
+                                           max_parallel_fetches)),
       stat_cache_(new StatCache(stat_cache_max_age, stat_cache_max_entries)),
       matching_paths_cache_(new MatchingPathsCache(
           matching_paths_cache_max_age, matching_paths_cache_max_entries)),
       timeouts_(timeouts),
+      upload_chunk_size_(upload_chunk_size),
       initial_retry_delay_usec_(initial_retry_delay_usec) {}
 
 Status GcsFileSystem::NewRandomAccessFile(
@@ -717,13 +1071,15 @@ Status GcsFileSystem::NewRandomAccessFile(
 
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
-    size_t block_size, size_t max_bytes, uint64 max_staleness) {
-  std::unique_ptr<FileBlockCache> file_block_cache(
-      new FileBlockCache(block_size, max_bytes, max_staleness,
-                         [this](const string& filename, size_t offset, size_t n,
-                                std::vector<char>* out) {
-                           return LoadBufferFromGCS(filename, offset, n, out);
-                         }));
+    size_t block_size, size_t max_bytes, uint64 max_staleness,
+    size_t max_parallel_fetches) {
+  std::unique_ptr<FileBlockCache> file_block_cache(new FileBlockCache(
+      block_size, max_bytes, max_staleness,
+      [this](const string& filename, size_t offset, size_t n,
+             std::vector<char>* out) {
+        return LoadBufferFromGCS(filename, offset, n, out);
+      },
+      Env::Default(), max_parallel_fetches));
   return file_block_cache;
 }
 
@@ -770,6 +1126,13 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
                                       std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+  if (upload_chunk_size_ > 0) {
+    result->reset(new GcsStreamingWritableFile(
+        bucket, object, this, &timeouts_,
+        [this, fname]() { file_block_cache_->RemoveFile(fname); },
+        upload_chunk_size_, initial_retry_delay_usec_));
+    return Status::OK();
+  }
   result->reset(new GcsWritableFile(
       bucket, object, this, &timeouts_,
       [this, fname]() { file_block_cache_->RemoveFile(fname); },
@@ -44,7 +44,8 @@ class GcsFileSystem : public FileSystem {
                 uint64 stat_cache_max_age, size_t stat_cache_max_entries,
                 uint64 matching_paths_cache_max_age,
                 size_t matching_paths_cache_max_entries,
-                int64 initial_retry_delay_usec, TimeoutConfig timeouts);
+                int64 initial_retry_delay_usec, TimeoutConfig timeouts,
+                size_t max_parallel_fetches = 1, size_t upload_chunk_size = 0);
 
   Status NewRandomAccessFile(
       const string& filename,
@@ -89,7 +90,11 @@ class GcsFileSystem : public FileSystem {
   size_t block_size() const { return file_block_cache_->block_size(); }
   size_t max_bytes() const { return file_block_cache_->max_bytes(); }
   uint64 max_staleness() const { return file_block_cache_->max_staleness(); }
+  size_t max_parallel_fetches() const {
+    return file_block_cache_->max_parallel_fetches();
+  }
   TimeoutConfig timeouts() const { return timeouts_; }
+  size_t upload_chunk_size() const { return upload_chunk_size_; }
 
   uint64 stat_cache_max_age() const { return stat_cache_->max_age(); }
   size_t stat_cache_max_entries() const { return stat_cache_->max_entries(); }
@@ -171,9 +176,9 @@ class GcsFileSystem : public FileSystem {
                        const string& object, FileStatistics* stat);
   Status RenameObject(const string& src, const string& target);
 
-  std::unique_ptr<FileBlockCache> MakeFileBlockCache(size_t block_size,
-                                                     size_t max_bytes,
-                                                     uint64 max_staleness);
+  std::unique_ptr<FileBlockCache> MakeFileBlockCache(
+      size_t block_size, size_t max_bytes, uint64 max_staleness,
+      size_t max_parallel_fetches);
 
   /// Loads file contents from GCS for a given filename, offset, and length.
   Status LoadBufferFromGCS(const string& filename, size_t offset, size_t n,
@@ -192,6 +197,10 @@ class GcsFileSystem : public FileSystem {
 
   TimeoutConfig timeouts_;
 
+  /// If positive, writable files stream their contents to GCS in chunks of
+  /// this many bytes, which must be a multiple of 256 KiB.
+  size_t upload_chunk_size_ = 0;
+
   /// The initial delay for exponential backoffs when retrying failed calls.
   const int64 initial_retry_delay_usec_ = 1000000L;
 
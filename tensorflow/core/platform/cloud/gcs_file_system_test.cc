@@ -385,6 +385,115 @@ TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   TF_EXPECT_OK(file->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_StreamingUpload) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2Fwriteable.txt\n"
+           "Auth Token: fake_token\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-7/*\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: content1\n",
+                           "", errors::FailedPrecondition("308"), nullptr,
+                           {{"Range", "bytes=0-7"}}, 308),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 8-15/*\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: ,content\n",
+                           "", errors::FailedPrecondition("308"), nullptr,
+                           {{"Range", "bytes=0-15"}}, 308),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 16-16/17\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: 2\n",
+                           "")});
+  GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+                   std::unique_ptr<HttpRequest::Factory>(
+                       new FakeHttpRequestFactory(&requests)),
+                   0 /* block size */, 0 /* max bytes */, 0 /* max staleness */,
+                   0 /* stat cache max age */, 0 /* stat cache max entries */,
+                   0 /* matching paths cache max age */,
+                   0 /* matching paths cache max entries */,
+                   0 /* initial retry delay */, kTestTimeoutConfig,
+                   1 /* max parallel fetches */, 8 /* upload chunk size */);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/path/writeable.txt", &file));
+
+  TF_EXPECT_OK(file->Append("content1,"));
+  TF_EXPECT_OK(file->Append("content2"));
+  TF_EXPECT_OK(file->Close());
+  EXPECT_EQ(error::Code::FAILED_PRECONDITION,
+            file->Append("content3").code());
+}
+
+TEST(GcsFileSystemTest, NewWritableFile_StreamingUploadResumes) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+           "uploadType=resumable&name=path%2Fwriteable.txt\n"
+           "Auth Token: fake_token\n"
+           "Post: yes\n"
+           "Timeouts: 5 1 10\n",
+           "", {{"Location", "https://custom/upload/location"}}),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 0-7/*\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: content1\n",
+                           "", errors::Unavailable("503"), 503),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Header Content-Range: bytes */*\n"
+                           "Put: yes\n",
+                           "", errors::FailedPrecondition("308"), nullptr,
+                           {{"Range", "bytes=0-3"}}, 308),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 4-7/*\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: ent1\n",
+                           "", errors::FailedPrecondition("308"), nullptr,
+                           {{"Range", "bytes=0-7"}}, 308),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Header Content-Range: bytes 8-11/12\n"
+                           "Timeouts: 5 1 30\n"
+                           "Put body: ,abc\n",
+                           "", errors::Unavailable("503"), 503),
+       new FakeHttpRequest("Uri: https://custom/upload/location\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Header Content-Range: bytes */12\n"
+                           "Put: yes\n",
+                           "")});
+  GcsFileSystem fs(std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+                   std::unique_ptr<HttpRequest::Factory>(
+                       new FakeHttpRequestFactory(&requests)),
+                   0 /* block size */, 0 /* max bytes */, 0 /* max staleness */,
+                   0 /* stat cache max age */, 0 /* stat cache max entries */,
+                   0 /* matching paths cache max age */,
+                   0 /* matching paths cache max entries */,
+                   0 /* initial retry delay */, kTestTimeoutConfig,
+                   1 /* max parallel fetches */, 8 /* upload chunk size */);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/path/writeable.txt", &file));
+
+  TF_EXPECT_OK(file->Append("content1,abc"));
+  // Waits for the upload of the first chunk.
+  TF_EXPECT_OK(file->Flush());
+  TF_EXPECT_OK(file->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceedsOnGetStatus) {
   // This test also verifies that a file's blocks are purged from the cache when
   // the file is written, even when the write takes the "succeeds on get status"
@@ -2295,6 +2404,8 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   EXPECT_EQ(128 * 1024 * 1024, fs1.block_size());
   EXPECT_EQ(2 * fs1.block_size(), fs1.max_bytes());
   EXPECT_EQ(0, fs1.max_staleness());
+  EXPECT_EQ(4, fs1.max_parallel_fetches());
+  EXPECT_EQ(0, fs1.upload_chunk_size());
   EXPECT_EQ(120, fs1.timeouts().connect);
   EXPECT_EQ(60, fs1.timeouts().idle);
   EXPECT_EQ(3600, fs1.timeouts().metadata);
@@ -2310,10 +2421,18 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   setenv("GCS_READ_CACHE_BLOCK_SIZE_MB", "1", 1);
   setenv("GCS_READ_CACHE_MAX_SIZE_MB", "16", 1);
   setenv("GCS_READ_CACHE_MAX_STALENESS", "60", 1);
+  setenv("GCS_READ_CACHE_MAX_PARALLEL_FETCHES", "8", 1);
   GcsFileSystem fs3;
   EXPECT_EQ(1048576L, fs3.block_size());
   EXPECT_EQ(16 * 1024 * 1024, fs3.max_bytes());
   EXPECT_EQ(60, fs3.max_staleness());
+  EXPECT_EQ(8, fs3.max_parallel_fetches());
+
+  // Verify the upload chunk size override.
+  setenv("GCS_WRITE_UPLOAD_CHUNK_SIZE_MB", "8", 1);
+  GcsFileSystem fs_upload;
+  EXPECT_EQ(8 * 1024 * 1024, fs_upload.upload_chunk_size());
+  unsetenv("GCS_WRITE_UPLOAD_CHUNK_SIZE_MB");
 
   // Verify StatCache and MatchingPathsCache overrides.
   setenv("GCS_STAT_CACHE_MAX_AGE", "60", 1);
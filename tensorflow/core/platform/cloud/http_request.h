@@ -84,6 +84,12 @@ class HttpRequest {
   /// the given offset.
   virtual Status SetPutFromFile(const string& body_filepath, size_t offset) = 0;
 
+  /// \brief Makes the request a PUT request.
+  ///
+  /// The request body will be taken from the specified buffer, which must
+  /// remain live until the request is sent.
+  virtual Status SetPutFromBuffer(const char* buffer, size_t size) = 0;
+
   /// Makes the request a PUT request with an empty body.
   virtual Status SetPutEmptyBody() = 0;
 
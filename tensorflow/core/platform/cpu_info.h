@@ -17,6 +17,9 @@ limitations under the License.
 #define TENSORFLOW_PLATFORM_CPU_INFO_H_
 
 #include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
 
 #if defined(PLATFORM_WINDOWS)
 #include "tensorflow/core/platform/windows/cpu_info.h"
@@ -34,6 +37,36 @@ constexpr bool kLittleEndian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
 // software can change it dynamically.
 int NumSchedulableCPUs();
 
+// Sets '*cpus' to the CPUs of NUMA node 'node'. Returns false if the node
+// does not exist or the platform does not expose its topology.
+bool NUMANodeCPUs(int node, std::vector<int>* cpus);
+
+// Returns the number of NUMA nodes of the host, or 1 if the platform does
+// not expose its topology.
+int NUMANumNodes();
+
+// Returns the NUMA node of the CPU the calling thread is running on, or -1
+// if it is unknown.
+int NUMANodeOfCurrentCPU();
+
+// Restricts the calling thread to run on 'cpus'. Returns false if the
+// platform does not support thread affinity or the request failed.
+bool SetCurrentThreadCPUAffinity(const std::vector<int>& cpus);
+
+// Counts of hardware events of the calling thread.
+struct CPUCounterValues {
+  int64 cycles = 0;
+  int64 instructions = 0;
+  int64 llc_misses = 0;
+  int64 stalled_cycles = 0;
+};
+
+// Sets '*values' to the hardware events counted on the calling thread since
+// its counters were opened, which happens on its first call. Events that the
+// CPU does not count stay 0. Returns false if the platform, or its settings
+// such as perf_event_paranoid on Linux, do not allow the counters.
+bool ReadCurrentThreadCPUCounters(CPUCounterValues* values);
+
 // Mostly ISA related features that we care about
 enum CPUFeature {
   // Do not change numeric assignments.
@@ -18,11 +18,16 @@ limitations under the License.
 #if GOOGLE_CUDA
 
 #include <stdlib.h>
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <unordered_map>
 
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/cupti_wrapper.h"
 #include "tensorflow/core/platform/env.h"
@@ -159,13 +164,25 @@ class CUPTIManager {
   void InternalBufferCompleted(CUcontext ctx, uint32_t streamId,
                                uint8_t *buffer, size_t size, size_t validSize);
 
-  // Size of buffers used for CUPTI tracing.
-  static constexpr size_t kBufferSize = 32 * 1024;
+  // Size of buffers used for CUPTI tracing. CUPTI hands a buffer back to
+  // BufferCompleted when it is full, so the records of a long step are
+  // consumed while the step runs rather than all at once in DisableTrace.
+  static constexpr size_t kBufferSize = 1024 * 1024;
   // Required alignment of CUPTI buffers.
   static constexpr size_t kBufferAlignment = 8;
+  // The most buffers CUPTI may hold at once. When all of them are full and
+  // not yet consumed, CUPTI drops new records instead of the tracer growing
+  // without bound.
+  static constexpr int kMaxBuffers = 32;
+  // The most consumed buffers kept for reuse.
+  static constexpr size_t kMaxFreeBuffers = 4;
 
   mutex mu_;
   CUPTIClient *client_ GUARDED_BY(mu_);
+
+  mutex buffer_mu_;
+  std::vector<uint8_t *> free_buffers_ GUARDED_BY(buffer_mu_);
+  int num_buffers_ GUARDED_BY(buffer_mu_) = 0;
   std::unique_ptr<perftools::gputools::profiler::CuptiWrapper> cupti_wrapper_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(CUPTIManager);
@@ -218,10 +235,22 @@ Status CUPTIManager::DisableTrace() {
 void CUPTIManager::InternalBufferRequested(uint8_t **buffer, size_t *size,
                                            size_t *maxNumRecords) {
   VLOG(2) << "BufferRequested";
-  void *p = port::AlignedMalloc(kBufferSize, kBufferAlignment);
-  *size = kBufferSize;
-  *buffer = reinterpret_cast<uint8_t *>(p);
   *maxNumRecords = 0;
+  mutex_lock l(buffer_mu_);
+  if (!free_buffers_.empty()) {
+    *buffer = free_buffers_.back();
+    free_buffers_.pop_back();
+  } else if (num_buffers_ < kMaxBuffers) {
+    *buffer = reinterpret_cast<uint8_t *>(
+        port::AlignedMalloc(kBufferSize, kBufferAlignment));
+    ++num_buffers_;
+  } else {
+    // CUPTI drops the records it has no buffer for.
+    *buffer = nullptr;
+    *size = 0;
+    return;
+  }
+  *size = kBufferSize;
 }
 
 void CUPTIManager::InternalBufferCompleted(CUcontext ctx, uint32_t streamId,
@@ -249,7 +278,14 @@ void CUPTIManager::InternalBufferCompleted(CUcontext ctx, uint32_t streamId,
       LOG(WARNING) << "Dropped " << dropped << " activity records";
     }
   }
-  port::AlignedFree(buffer);
+  if (buffer == nullptr) return;
+  mutex_lock l2(buffer_mu_);
+  if (free_buffers_.size() < kMaxFreeBuffers) {
+    free_buffers_.push_back(buffer);
+  } else {
+    port::AlignedFree(buffer);
+    --num_buffers_;
+  }
 }
 
 CUPTIManager *GetCUPTIManager() {
@@ -280,11 +316,25 @@ CUPTIManager *GetCUPTIManager() {
   } _var_;                                                         \
   }  // namespace
 
-// Thread-local state recording the most recent annotation (if any).
-// When non-null, this points to a string in the active annotation
-// of the current thread.  The annotation is guaranteed to remain live
-// for the duration of the CUPTI API callback.
-TF_STATIC_THREAD_LOCAL_POD(const char *, tls_current_annotation);
+// Thread-local state recording the id of the innermost active annotation of
+// the current thread, as interned by DeviceTracerImpl::InternAnnotation(), or
+// 0 if there is none.
+TF_STATIC_THREAD_LOCAL_POD(uint32, tls_current_annotation);
+
+// The annotation of each kernel launch and memcpy, indexed by its CUPTI
+// correlation ID modulo kNumCorrelations. An entry packs the correlation ID
+// in its upper 32 bits and the annotation id in its lower 32 bits, so that
+// an activity whose slot was reused by a later launch is reported as
+// unannotated instead of being misattributed. Correlation IDs are unique,
+// so the launching threads write distinct slots without locking, and the
+// table never needs to be cleared between traces.
+constexpr uint32 kNumCorrelations = 1 << 20;
+
+std::atomic<uint64> *CorrelationTable() {
+  static std::atomic<uint64> *table =
+      new std::atomic<uint64>[kNumCorrelations]();
+  return table;
+}
 
 class DeviceTracerImpl : public DeviceTracer,
                          public CUPTIClient,
@@ -306,14 +356,14 @@ class DeviceTracerImpl : public DeviceTracer,
   Annotation *PushAnnotation(StringPiece name) override {
     VLOG(2) << "PushAnnotation " << name;
     struct Impl : public port::Tracing::Engine::Annotation {
-      string annotation;
-      explicit Impl(StringPiece n) : annotation(n.ToString()) {
-        // Remember the most recent ScopedAnnotation for each thread.
-        tls_current_annotation.get() = annotation.c_str();
+      const uint32 enclosing_id;
+      explicit Impl(uint32 id) : enclosing_id(tls_current_annotation.get()) {
+        // Remember the innermost ScopedAnnotation for each thread.
+        tls_current_annotation.get() = id;
       }
-      ~Impl() override { tls_current_annotation.get() = nullptr; }
+      ~Impl() override { tls_current_annotation.get() = enclosing_id; }
     };
-    return new Impl(name);
+    return new Impl(InternAnnotation(name));
   }
   Tracer *StartTracing(StringPiece label, bool is_expensive) override {
     // We don't do anything with 'TraceMe' regions yet.
@@ -352,8 +402,16 @@ class DeviceTracerImpl : public DeviceTracer,
   static void CUPTIAPI ApiCallback(void *userdata, CUpti_CallbackDomain domain,
                                    CUpti_CallbackId cbid, const void *cbdata);
 
-  // Records the mapping between correlation ID and kernel name.
-  void AddCorrelationId(uint32 correlation_id, const string &name);
+  // Returns the id of 'name', a positive number that identifies it among the
+  // annotations of this trace.
+  uint32 InternAnnotation(StringPiece name) LOCKS_EXCLUDED(annotation_mu_);
+
+  // Records the annotation of the launch or copy with 'correlation_id'.
+  void AddCorrelationId(uint32 correlation_id, uint32 annotation_id);
+
+  // Returns the annotation recorded for 'correlation_id', or "unknown".
+  const string &AnnotationOf(uint32 correlation_id)
+      EXCLUSIVE_LOCKS_REQUIRED(annotation_mu_);
 
   // Returns the current system time in microseconds.
   inline int64 NowInUsec() { return Env::Default()->NowMicros(); }
@@ -362,9 +420,15 @@ class DeviceTracerImpl : public DeviceTracer,
   std::unique_ptr<perftools::gputools::profiler::CuptiWrapper> cupti_wrapper_;
   CUpti_SubscriberHandle subscriber_;
 
+  // The interned annotations. annotations_[i] has id i + 1, and is a deque
+  // so that the keys of annotation_ids_ can point into it.
+  mutex annotation_mu_;
+  std::deque<string> annotations_ GUARDED_BY(annotation_mu_);
+  gtl::FlatMap<StringPiece, uint32, StringPieceHasher> annotation_ids_
+      GUARDED_BY(annotation_mu_);
+
   mutex trace_mu_;
   static constexpr size_t kMaxRecords = 1024 * 1024;
-  std::map<uint32, string> correlations_ GUARDED_BY(trace_mu_);
   std::vector<KernelRecord> kernel_records_ GUARDED_BY(trace_mu_);
   std::vector<MemcpyRecord> memcpy_records_ GUARDED_BY(trace_mu_);
 
@@ -466,12 +530,34 @@ Status DeviceTracerImpl::Stop() {
   return Status::OK();
 }
 
+uint32 DeviceTracerImpl::InternAnnotation(StringPiece name) {
+  mutex_lock l(annotation_mu_);
+  auto it = annotation_ids_.find(name);
+  if (it != annotation_ids_.end()) return it->second;
+  annotations_.push_back(name.ToString());
+  const uint32 id = annotations_.size();
+  annotation_ids_.emplace(annotations_.back(), id);
+  return id;
+}
+
 void DeviceTracerImpl::AddCorrelationId(uint32 correlation_id,
-                                        const string &name) {
-  VLOG(2) << correlation_id << " : " << name;
-  mutex_lock l(trace_mu_);
-  if (correlations_.size() >= kMaxRecords) return;
-  correlations_.emplace(correlation_id, name);
+                                        uint32 annotation_id) {
+  VLOG(2) << correlation_id << " : " << annotation_id;
+  CorrelationTable()[correlation_id % kNumCorrelations].store(
+      (static_cast<uint64>(correlation_id) << 32) | annotation_id,
+      std::memory_order_relaxed);
+}
+
+const string &DeviceTracerImpl::AnnotationOf(uint32 correlation_id) {
+  static const string *unknown = new string("unknown");
+  const uint64 entry = CorrelationTable()[correlation_id % kNumCorrelations]
+                           .load(std::memory_order_relaxed);
+  const uint32 annotation_id = static_cast<uint32>(entry);
+  if ((entry >> 32) != correlation_id || annotation_id == 0 ||
+      annotation_id > annotations_.size()) {
+    return *unknown;
+  }
+  return annotations_[annotation_id - 1];
 }
 
 /*static*/ void DeviceTracerImpl::ApiCallback(void *userdata,
@@ -484,9 +570,8 @@ void DeviceTracerImpl::AddCorrelationId(uint32 correlation_id,
           << " func: " << cbInfo->functionName;
 
   // API callbacks are invoked synchronously on the thread making the
-  // CUDA API call.  If this pointer is non-null then the ScopedAnnotation
-  // must be valid.
-  const char *tls_annotation = tls_current_annotation.get();
+  // CUDA API call, so this is the id of its innermost ScopedAnnotation.
+  const uint32 tls_annotation = tls_current_annotation.get();
 
   if ((domain == CUPTI_CB_DOMAIN_DRIVER_API) &&
       (cbid == CUPTI_DRIVER_TRACE_CBID_cuLaunchKernel)) {
@@ -497,9 +582,10 @@ void DeviceTracerImpl::AddCorrelationId(uint32 correlation_id,
         VLOG(2) << "LAUNCH stream " << params->hStream << " correllation "
                 << cbInfo->correlationId << " kernel " << cbInfo->symbolName;
       }
-      const string annotation =
-          tls_annotation ? tls_annotation : cbInfo->symbolName;
-      tracer->AddCorrelationId(cbInfo->correlationId, annotation);
+      tracer->AddCorrelationId(
+          cbInfo->correlationId,
+          tls_annotation ? tls_annotation
+                         : tracer->InternAnnotation(cbInfo->symbolName));
     }
   } else if ((domain == CUPTI_CB_DOMAIN_RUNTIME_API) &&
              (cbid == CUPTI_RUNTIME_TRACE_CBID_cudaMemcpy_v3020 ||
@@ -513,8 +599,7 @@ void DeviceTracerImpl::AddCorrelationId(uint32 correlation_id,
         VLOG(2) << "MEMCPY count " << count << " kind " << kind;
       }
       if (tls_annotation) {
-        const string annotation = tls_annotation;
-        tracer->AddCorrelationId(cbInfo->correlationId, annotation);
+        tracer->AddCorrelationId(cbInfo->correlationId, tls_annotation);
       }
     }
   } else if ((domain == CUPTI_CB_DOMAIN_DRIVER_API) &&
@@ -525,8 +610,7 @@ void DeviceTracerImpl::AddCorrelationId(uint32 correlation_id,
               cbid == CUPTI_DRIVER_TRACE_CBID_cuMemcpyDtoHAsync_v2 ||
               cbid == CUPTI_DRIVER_TRACE_CBID_cuMemcpyDtoDAsync_v2)) {
     if (cbInfo->callbackSite == CUPTI_API_EXIT && tls_annotation) {
-      const string annotation = tls_annotation;
-      tracer->AddCorrelationId(cbInfo->correlationId, annotation);
+      tracer->AddCorrelationId(cbInfo->correlationId, tls_annotation);
     }
   } else {
     VLOG(1) << "Unhandled API Callback for " << domain << " " << cbid;
@@ -583,9 +667,12 @@ Status DeviceTracerImpl::Collect(StepStatsCollector *collector) {
   const string memcpy_device = strings::StrCat(prefix, "/device:GPU:", id, "/memcpy");
 
   mutex_lock l2(trace_mu_);
+  mutex_lock l3(annotation_mu_);
+  // The kernel time of each node, found from the "<node name>:<op type>"
+  // annotations that the GPU device sets around Compute().
+  std::unordered_map<string, int64> kernel_micros_by_node;
   for (const auto &rec : kernel_records_) {
-    auto it = correlations_.find(rec.correlation_id);
-    const string name = (it != correlations_.cend()) ? it->second : "unknown";
+    const string &name = AnnotationOf(rec.correlation_id);
     NodeExecStats *ns = new NodeExecStats;
     ns->set_all_start_micros(start_walltime_us_ +
                              ((rec.start_timestamp - start_timestamp_) / 1000));
@@ -595,6 +682,10 @@ Status DeviceTracerImpl::Collect(StepStatsCollector *collector) {
     ns->set_op_end_rel_micros(elapsed_us);
     ns->set_all_end_rel_micros(elapsed_us);
     ns->set_node_name(name);
+    const size_t colon = name.find(':');
+    if (colon != string::npos) {
+      kernel_micros_by_node[name.substr(0, colon)] += elapsed_us;
+    }
     // TODO(pbar) Generate details based on the kernel activity record.
     // ns->set_timeline_label(details);
     auto nscopy = new NodeExecStats;
@@ -602,9 +693,9 @@ Status DeviceTracerImpl::Collect(StepStatsCollector *collector) {
     collector->Save(strings::StrCat(stream_device, "all"), ns);
     collector->Save(strings::StrCat(stream_device, rec.stream_id), nscopy);
   }
+  collector->AddDeviceComputeTime(kernel_micros_by_node);
   for (const auto &rec : memcpy_records_) {
-    auto it = correlations_.find(rec.correlation_id);
-    const string name = (it != correlations_.cend()) ? it->second : "unknown";
+    const string &name = AnnotationOf(rec.correlation_id);
     NodeExecStats *ns = new NodeExecStats;
     ns->set_all_start_micros(start_walltime_us_ +
                              ((rec.start_timestamp - start_timestamp_) / 1000));
@@ -15,12 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/platform/test_benchmark.h"
 
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 
 #include <algorithm>
 #include <vector>
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/reporter.h"
@@ -86,6 +88,33 @@ void AddRange(std::vector<int>* dst, int lo, int hi, int mult) {
   }
 }
 
+// Returns the median of the non-empty 'values'.
+double Median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  const size_t n = values.size();
+  return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+// Keeps the 'seconds' within 'threshold' normalized median absolute
+// deviations of their median. The normalization makes the deviation an
+// estimate of the standard deviation of normally distributed times.
+std::vector<double> RejectOutliers(const std::vector<double>& seconds,
+                                   double threshold) {
+  if (threshold <= 0.0 || seconds.size() < 3) return seconds;
+  const double median = Median(seconds);
+  std::vector<double> deviations;
+  for (double s : seconds) {
+    deviations.push_back(std::abs(s - median));
+  }
+  const double mad = 1.4826 * Median(deviations);
+  if (mad == 0.0) return seconds;
+  std::vector<double> kept;
+  for (double s : seconds) {
+    if (std::abs(s - median) <= threshold * mad) kept.push_back(s);
+  }
+  return kept;
+}
+
 }  // namespace
 
 Benchmark* Benchmark::Range(int lo, int hi) {
@@ -111,8 +140,18 @@ Benchmark* Benchmark::RangePair(int lo1, int hi1, int lo2, int hi2) {
 }
 
 void Benchmark::Run(const char* pattern) {
+  Run(pattern, BenchmarkOptions());
+}
+
+void Benchmark::Run(const char* pattern, const BenchmarkOptions& options) {
   if (!all_benchmarks) return;
 
+  if (!options.cpus.empty() &&
+      !port::SetCurrentThreadCPUAffinity(options.cpus)) {
+    LOG(WARNING) << "Could not pin the benchmarks to CPUs "
+                 << str_util::Join(options.cpus, ",");
+  }
+
   // Converts "all" into the wildcard '.*'.  Currently pattern isn't
   // specified by clients, but we keep this here to match the internal
   // Google implementation, should we ever enable user-specified
@@ -161,22 +200,60 @@ void Benchmark::Run(const char* pattern) {
 
       int iters;
       double seconds;
-      b->Run(arg.first, arg.second, &iters, &seconds);
+      b->Run(arg.first, arg.second, options.min_time_s, &iters, &seconds);
+
+      // Every repetition runs the same number of iterations, so they can be
+      // compared by their total time.
+      std::vector<double> repetition_seconds;
+      if (options.warmup_repetitions <= 0) {
+        repetition_seconds.push_back(seconds);
+      }
+      for (int i = 0; i < options.warmup_repetitions; ++i) {
+        b->RunIterations(arg.first, arg.second, iters);
+      }
+      while (repetition_seconds.size() < options.repetitions) {
+        repetition_seconds.push_back(
+            b->RunIterations(arg.first, arg.second, iters));
+      }
+      const std::vector<double> kept_seconds =
+          RejectOutliers(repetition_seconds, options.outlier_threshold);
+      const int repetitions = kept_seconds.size();
+      seconds = 0;
+      for (double s : kept_seconds) {
+        seconds += s;
+      }
+      double stddev = 0;
+      for (double s : kept_seconds) {
+        const double deviation = s - seconds / repetitions;
+        stddev += deviation * deviation / repetitions;
+      }
+      stddev = std::sqrt(stddev);
+      // The counts of the last repetition, which are the same for all.
+      const int64 total_iters = static_cast<int64>(iters) * repetitions;
+      const int64 total_bytes = bytes_processed * repetitions;
+      const int64 total_items = items_processed * repetitions;
 
       char buf[100];
       std::string full_label = label;
       if (bytes_processed > 0) {
         snprintf(buf, sizeof(buf), " %.1fMB/s",
-                 (bytes_processed * 1e-6) / seconds);
+                 (total_bytes * 1e-6) / seconds);
         full_label += buf;
       }
       if (items_processed > 0) {
         snprintf(buf, sizeof(buf), " %.1fM items/s",
-                 (items_processed * 1e-6) / seconds);
+                 (total_items * 1e-6) / seconds);
         full_label += buf;
       }
-      printf("%-*s %10.0f %10d\t%s\n", width, name.c_str(),
-             seconds * 1e9 / iters, iters, full_label.c_str());
+      if (repetition_seconds.size() > 1) {
+        snprintf(buf, sizeof(buf), " +-%.1f%% over %d of %zu repetitions",
+                 100.0 * stddev * repetitions / seconds, repetitions,
+                 repetition_seconds.size());
+        full_label += buf;
+      }
+      printf("%-*s %10.0f %10lld\t%s\n", width, name.c_str(),
+             seconds * 1e9 / total_iters, static_cast<long long>(total_iters),
+             full_label.c_str());
 
       TestReporter reporter(name);
       Status s = reporter.Initialize();
@@ -184,8 +261,25 @@ void Benchmark::Run(const char* pattern) {
         LOG(ERROR) << s.ToString();
         exit(EXIT_FAILURE);
       }
-      s = reporter.Benchmark(iters, 0.0, seconds,
-                             items_processed * 1e-6 / seconds);
+      s = reporter.Benchmark(total_iters, 0.0, seconds,
+                             total_items * 1e-6 / seconds);
+      if (!s.ok()) {
+        LOG(ERROR) << s.ToString();
+        exit(EXIT_FAILURE);
+      }
+      s.Update(reporter.SetProperty("repetitions", repetitions));
+      s.Update(reporter.SetProperty("rejected_repetitions",
+                                    repetition_seconds.size() - repetitions));
+      // Per iteration, like the wall time of the entry.
+      s.Update(reporter.SetProperty("wall_time_stddev", stddev / iters));
+      s.Update(reporter.SetProperty(
+          "wall_time_min",
+          *std::min_element(kept_seconds.begin(), kept_seconds.end()) /
+              iters));
+      s.Update(reporter.SetProperty(
+          "wall_time_max",
+          *std::max_element(kept_seconds.begin(), kept_seconds.end()) /
+              iters));
       if (!s.ok()) {
         LOG(ERROR) << s.ToString();
         exit(EXIT_FAILURE);
@@ -204,28 +298,32 @@ void Benchmark::Register() {
   all_benchmarks->push_back(this);
 }
 
-void Benchmark::Run(int arg1, int arg2, int* run_count, double* run_seconds) {
+double Benchmark::RunIterations(int arg1, int arg2, int iters) {
   env = Env::Default();
+  accum_time = 0;
+  start_time = env->NowMicros();
+  bytes_processed = -1;
+  items_processed = -1;
+  label.clear();
+  if (fn0_) {
+    (*fn0_)(iters);
+  } else if (fn1_) {
+    (*fn1_)(iters, arg1);
+  } else {
+    (*fn2_)(iters, arg1, arg2);
+  }
+  StopTiming();
+  return accum_time * 1e-6;
+}
+
+void Benchmark::Run(int arg1, int arg2, double min_time_s, int* run_count,
+                    double* run_seconds) {
   static const int64 kMinIters = 100;
   static const int64 kMaxIters = 1000000000;
-  static const double kMinTime = 0.5;
   int64 iters = kMinIters;
   while (true) {
-    accum_time = 0;
-    start_time = env->NowMicros();
-    bytes_processed = -1;
-    items_processed = -1;
-    label.clear();
-    if (fn0_) {
-      (*fn0_)(iters);
-    } else if (fn1_) {
-      (*fn1_)(iters, arg1);
-    } else {
-      (*fn2_)(iters, arg1, arg2);
-    }
-    StopTiming();
-    const double seconds = accum_time * 1e-6;
-    if (seconds >= kMinTime || iters >= kMaxIters) {
+    const double seconds = RunIterations(arg1, arg2, iters);
+    if (seconds >= min_time_s || iters >= kMaxIters) {
       *run_count = iters;
       *run_seconds = seconds;
       return;
@@ -233,7 +331,7 @@ void Benchmark::Run(int arg1, int arg2, int* run_count, double* run_seconds) {
 
     // Update number of iterations.  Overshoot by 40% in an attempt
     // to succeed the next time.
-    double multiplier = 1.4 * kMinTime / std::max(seconds, 1e-9);
+    double multiplier = 1.4 * min_time_s / std::max(seconds, 1e-9);
     multiplier = std::min(10.0, multiplier);
     if (multiplier <= 1.0) multiplier *= 2.0;
     iters = std::max<int64>(multiplier * iters, iters + 1);
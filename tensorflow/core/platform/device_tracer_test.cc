@@ -226,5 +226,22 @@ TEST_F(DeviceTracerTest, RunWithTraceOption) {
   EXPECT_GE(run_metadata.step_stats().dev_stats_size(), 1);
 }
 
+TEST(StepStatsCollectorTest, AddDeviceComputeTime) {
+  StepStats stats;
+  StepStatsCollector collector(&stats);
+  for (const char* name : {"a", "b"}) {
+    NodeExecStats* ns = new NodeExecStats;
+    ns->set_node_name(name);
+    collector.Save("/device:GPU:0", ns);
+  }
+  collector.AddDeviceComputeTime({{"a", 5}, {"c", 7}});
+  collector.AddDeviceComputeTime({{"a", 2}});
+  collector.Finalize();
+  ASSERT_EQ(1, stats.dev_stats_size());
+  ASSERT_EQ(2, stats.dev_stats(0).node_stats_size());
+  EXPECT_EQ(7, stats.dev_stats(0).node_stats(0).device_compute_micros());
+  EXPECT_EQ(0, stats.dev_stats(0).node_stats(1).device_compute_micros());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -371,6 +371,8 @@ struct ThreadOptions {
   size_t stack_size = 0;  // 0: use system default value
   /// Guard area size to use near thread stacks to use (in bytes)
   size_t guard_size = 0;  // 0: use system default value
+  /// CPUs the thread is restricted to run on.
+  std::vector<int> cpu_affinity;  // empty: any CPU the process may use
 };
 
 /// A utility routine: reads contents of named file into `*data`
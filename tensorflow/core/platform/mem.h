@@ -29,6 +29,12 @@ namespace port {
 void* AlignedMalloc(size_t size, int minimum_alignment);
 void AlignedFree(void* aligned_memory);
 
+// Like AlignedMalloc, but asks the OS to back the pages with memory of NUMA
+// node 'node' when possible. The memory is page aligned and must be freed
+// with NUMAFree.
+void* NUMAMalloc(int node, size_t size, int minimum_alignment);
+void NUMAFree(void* ptr, size_t size);
+
 void* Malloc(size_t size);
 void* Realloc(void* ptr, size_t size);
 void Free(void* ptr);
@@ -59,6 +65,12 @@ void MallocExtension_ReleaseToSystem(std::size_t num_bytes);
 // routine, this routine returns 0.
 std::size_t MallocExtension_GetAllocatedSize(const void* p);
 
+// Returns the largest resident set size of the process so far, in bytes.
+//
+// This routine is just useful for statistics collection. Currently, if a
+// platform does not report it, this routine returns 0.
+std::size_t PeakResidentMemoryBytes();
+
 }  // namespace port
 }  // namespace tensorflow
 
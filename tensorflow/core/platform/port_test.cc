@@ -33,6 +33,35 @@ TEST(Port, AlignedMalloc) {
   }
 }
 
+TEST(Port, NUMANodeCPUs) {
+  std::vector<int> cpus;
+  EXPECT_FALSE(NUMANodeCPUs(-1, &cpus));
+  if (NUMANodeCPUs(0, &cpus)) {
+    EXPECT_FALSE(cpus.empty());
+    for (int cpu : cpus) {
+      EXPECT_GE(cpu, 0);
+    }
+  }
+}
+
+TEST(Port, SetCurrentThreadCPUAffinity) {
+  EXPECT_FALSE(SetCurrentThreadCPUAffinity({-1}));
+}
+
+TEST(Port, ReadCurrentThreadCPUCounters) {
+  CPUCounterValues start;
+  if (!ReadCurrentThreadCPUCounters(&start)) return;
+  double sum = 0;
+  for (int i = 0; i < 1000000; ++i) sum += i;
+  CPUCounterValues end;
+  ASSERT_TRUE(ReadCurrentThreadCPUCounters(&end));
+  EXPECT_GT(end.cycles, start.cycles);
+  EXPECT_GE(end.instructions, start.instructions);
+  EXPECT_GE(end.llc_misses, start.llc_misses);
+  EXPECT_GE(end.stalled_cycles, start.stalled_cycles);
+  EXPECT_GT(sum, 0);
+}
+
 TEST(ConditionVariable, WaitForMilliseconds_Timeout) {
   mutex m;
   mutex_lock l(m);
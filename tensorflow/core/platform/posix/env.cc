@@ -29,6 +29,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/lib/core/error_codes.pb.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/load_library.h"
 #include "tensorflow/core/platform/logging.h"
@@ -40,13 +41,24 @@ namespace {
 
 class StdThread : public Thread {
  public:
-  // name and thread_options are both ignored.
+  // name and the stack and guard sizes of thread_options are ignored.
   StdThread(const ThreadOptions& thread_options, const string& name,
             std::function<void()> fn)
-      : thread_(fn) {}
+      : thread_(WithAffinity(thread_options.cpu_affinity, std::move(fn))) {}
   ~StdThread() override { thread_.join(); }
 
  private:
+  static std::function<void()> WithAffinity(const std::vector<int>& cpus,
+                                            std::function<void()> fn) {
+    if (cpus.empty()) return fn;
+    return [cpus, fn]() {
+      if (!port::SetCurrentThreadCPUAffinity(cpus)) {
+        LOG(WARNING) << "Could not set the CPU affinity of a thread";
+      }
+      fn();
+    };
+  }
+
   std::thread thread_;
 };
 
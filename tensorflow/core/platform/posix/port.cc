@@ -21,6 +21,8 @@ limitations under the License.
 #include "absl/base/internal/sysinfo.h"
 #endif
 
+#include <algorithm>
+
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mem.h"
@@ -28,11 +30,16 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 
 #if defined(__linux__) && !defined(__ANDROID__)
+#include <linux/mempolicy.h>
+#include <linux/perf_event.h>
 #include <sched.h>
+#include <sys/syscall.h>
 #endif
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 #include <unistd.h>
 #ifdef TF_USE_SNAPPY
 #include "snappy.h"
@@ -73,6 +80,154 @@ int NumSchedulableCPUs() {
   return kDefaultCores;
 }
 
+bool NUMANodeCPUs(int node, std::vector<int>* cpus) {
+  cpus->clear();
+#if defined(__linux__) && !defined(__ANDROID__)
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+           node);
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+  // The list is a comma separated sequence of CPUs and ranges, e.g.
+  // "0-3,8-11".
+  char buf[4096];
+  const bool read = fgets(buf, sizeof(buf), f) != nullptr;
+  fclose(f);
+  if (!read) return false;
+  const char* p = buf;
+  while (*p != '\0' && *p != '\n') {
+    char* end;
+    const long first = strtol(p, &end, 10);
+    if (end == p) return false;
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      ++p;
+      last = strtol(p, &end, 10);
+      if (end == p || last < first) return false;
+      p = end;
+    }
+    for (long cpu = first; cpu <= last; ++cpu) {
+      cpus->push_back(static_cast<int>(cpu));
+    }
+    if (*p == ',') ++p;
+  }
+  return !cpus->empty();
+#else
+  return false;
+#endif
+}
+
+int NUMANumNodes() {
+  std::vector<int> cpus;
+  int num_nodes = 0;
+  while (NUMANodeCPUs(num_nodes, &cpus)) ++num_nodes;
+  return std::max(num_nodes, 1);
+}
+
+int NUMANodeOfCurrentCPU() {
+#if defined(__linux__) && !defined(__ANDROID__)
+  unsigned int cpu, node;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return static_cast<int>(node);
+  }
+#endif
+  return -1;
+}
+
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+// The perf events of a thread, in one group so that they are scheduled on the
+// PMU together and read with one system call.
+class ThreadCPUCounters {
+ public:
+  ThreadCPUCounters() {
+    const uint64 configs[kNumCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_STALLED_CYCLES_BACKEND};
+    for (int i = 0; i < kNumCounters; ++i) {
+      struct perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.read_format = PERF_FORMAT_GROUP;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      const int fd = syscall(SYS_perf_event_open, &attr, 0 /* this thread */,
+                             -1 /* any cpu */, group_fd_, 0);
+      if (fd < 0) {
+        // Without cycles there is no group; other events may be missing on
+        // some CPUs, e.g. stalled cycles.
+        if (i == 0) {
+          VLOG(1) << "perf_event_open failed: " << strerror(errno);
+          return;
+        }
+        continue;
+      }
+      if (group_fd_ < 0) group_fd_ = fd;
+      fds_[num_opened_] = fd;
+      indices_[num_opened_] = i;
+      ++num_opened_;
+    }
+  }
+
+  ~ThreadCPUCounters() {
+    for (int i = 0; i < num_opened_; ++i) close(fds_[i]);
+  }
+
+  bool Read(CPUCounterValues* values) const {
+    if (group_fd_ < 0) return false;
+    uint64 buffer[1 + kNumCounters];
+    const ssize_t size = sizeof(uint64) * (1 + num_opened_);
+    if (read(group_fd_, buffer, size) != size) return false;
+    int64 counts[kNumCounters] = {0};
+    for (int i = 0; i < num_opened_ && i < buffer[0]; ++i) {
+      counts[indices_[i]] = buffer[1 + i];
+    }
+    values->cycles = counts[0];
+    values->instructions = counts[1];
+    values->llc_misses = counts[2];
+    values->stalled_cycles = counts[3];
+    return true;
+  }
+
+ private:
+  static const int kNumCounters = 4;
+  int group_fd_ = -1;
+  int num_opened_ = 0;
+  int fds_[kNumCounters];
+  // The counter that each opened event counts.
+  int indices_[kNumCounters];
+};
+
+}  // namespace
+#endif
+
+bool ReadCurrentThreadCPUCounters(CPUCounterValues* values) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  static thread_local ThreadCPUCounters counters;
+  return counters.Read(values);
+#else
+  return false;
+#endif
+}
+
+bool SetCurrentThreadCPUAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    CPU_SET(cpu, &cpuset);
+  }
+  return sched_setaffinity(0, sizeof(cpu_set_t), &cpuset) == 0;
+#else
+  return false;
+#endif
+}
+
 void* AlignedMalloc(size_t size, int minimum_alignment) {
 #if defined(__ANDROID__)
   return memalign(minimum_alignment, size);
@@ -98,6 +253,27 @@ void* AlignedMalloc(size_t size, int minimum_alignment) {
 
 void AlignedFree(void* aligned_memory) { Free(aligned_memory); }
 
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+  const int page_size = getpagesize();
+  void* ptr = AlignedMalloc(size, std::max(minimum_alignment, page_size));
+#if defined(__linux__) && !defined(__ANDROID__)
+  if (ptr != nullptr && node >= 0 && node < 64 && size > 0) {
+    // The pages are not touched yet, so the preferred policy places them on
+    // 'node' when they are first written, falling back to other nodes when
+    // it is out of memory.
+    const unsigned long node_mask = 1UL << node;
+    const size_t length = (size + page_size - 1) / page_size * page_size;
+    if (syscall(SYS_mbind, ptr, length, MPOL_PREFERRED, &node_mask,
+                sizeof(node_mask) * 8, 0) != 0) {
+      VLOG(1) << "mbind to NUMA node " << node << " failed: " << errno;
+    }
+  }
+#endif
+  return ptr;
+}
+
+void NUMAFree(void* ptr, size_t size) { AlignedFree(ptr); }
+
 void* Malloc(size_t size) {
 #ifdef TENSORFLOW_USE_JEMALLOC
   return jemalloc_malloc(size);
@@ -128,6 +304,20 @@ void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
 
 std::size_t MallocExtension_GetAllocatedSize(const void* p) { return 0; }
 
+std::size_t PeakResidentMemoryBytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__) && defined(__MACH__)
+  // Reported in bytes.
+  return usage.ru_maxrss;
+#else
+  // Reported in kilobytes.
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
 void AdjustFilenameForLogging(string* filename) {
   // Nothing to do
 }
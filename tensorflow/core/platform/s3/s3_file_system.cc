@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/platform/s3/s3_file_system.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/s3/s3_crypto.h"
 
@@ -21,13 +23,19 @@ limitations under the License.
 #include <aws/core/utils/FileSystemUtils.h>
 #include <aws/s3/S3Client.h>
 #include <aws/s3/S3Errors.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/CompletedMultipartUpload.h>
+#include <aws/s3/model/CompletedPart.h>
 #include <aws/s3/model/CopyObjectRequest.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/GetObjectRequest.h>
 #include <aws/s3/model/HeadBucketRequest.h>
 #include <aws/s3/model/HeadObjectRequest.h>
 #include <aws/s3/model/ListObjectsRequest.h>
 #include <aws/s3/model/PutObjectRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
 
 #include <cstdlib>
 
@@ -36,6 +44,13 @@ namespace tensorflow {
 static const char* kS3FileSystemAllocationTag = "S3FileSystemAllocation";
 static const size_t kS3ReadAppendableFileBufferSize = 1024 * 1024;
 static const int kS3GetChildrenMaxKeys = 100;
+// The environment variable that enables multipart uploads of writable files,
+// with parts of the given size in MB. S3 requires parts of at least 5MB.
+static const char* kS3MultipartUploadPartSize =
+    "S3_MULTIPART_UPLOAD_PART_SIZE_MB";
+static const uint64 kS3MinMultipartUploadPartSize = 5;
+// The maximum number of parts of a file uploaded concurrently.
+static const int kS3MaxParallelPartUploads = 4;
 
 Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
   static mutex cfg_lock(LINKER_INITIALIZED);
@@ -214,6 +229,216 @@ class S3WritableFile : public WritableFile {
   std::shared_ptr<Aws::Utils::TempFile> outfile_;
 };
 
+template <typename Outcome>
+Status OutcomeToStatus(const Outcome& outcome) {
+  if (outcome.IsSuccess()) {
+    return Status::OK();
+  }
+  string error =
+      strings::StrCat(outcome.GetError().GetExceptionName().c_str(), ": ",
+                      outcome.GetError().GetMessage().c_str());
+  return errors::Internal(error);
+}
+
+// A writable file that uploads its contents with a multipart upload as they
+// are appended, instead of writing them to a temporary file that is uploaded
+// on Sync(). Up to kS3MaxParallelPartUploads parts are uploaded while the next
+// one is filled, so at most (kS3MaxParallelPartUploads + 1) parts are held in
+// memory.
+//
+// The object is only created (or replaced) by Close(), and Flush() and Sync()
+// do nothing but return the status of the uploads so far.
+class S3MultipartWritableFile : public WritableFile {
+ public:
+  S3MultipartWritableFile(const string& bucket, const string& object,
+                          size_t part_size)
+      : bucket_(bucket),
+        object_(object),
+        part_size_(part_size),
+        upload_pool_(new thread::ThreadPool(Env::Default(), "s3_upload",
+                                            kS3MaxParallelPartUploads)) {
+    Aws::Client::ClientConfiguration clientConfig = GetDefaultClientConfig();
+    clientConfig.connectTimeoutMs = 300000;
+    clientConfig.requestTimeoutMs = 600000;
+    s3_client_ = Aws::MakeShared<Aws::S3::S3Client>(kS3FileSystemAllocationTag,
+                                                    clientConfig);
+    buffer_.reserve(part_size_);
+  }
+
+  ~S3MultipartWritableFile() override {
+    if (!closed_) {
+      // The file was not closed, so the object must not be created.
+      WaitForPartUploads().IgnoreError();
+      AbortUpload();
+    }
+  }
+
+  Status Append(const StringPiece& data) override {
+    if (closed_) {
+      return errors::FailedPrecondition("The file is closed.");
+    }
+    StringPiece remaining = data;
+    while (!remaining.empty()) {
+      const size_t n = std::min(remaining.size(), part_size_ - buffer_.size());
+      buffer_.append(remaining.data(), n);
+      remaining.remove_prefix(n);
+      if (buffer_.size() == part_size_) {
+        TF_RETURN_IF_ERROR(StartPartUpload());
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    if (closed_) {
+      return Status::OK();
+    }
+    closed_ = true;
+    if (upload_id_.empty()) {
+      // The object is smaller than a part.
+      return PutObject();
+    }
+    Status status;
+    if (!buffer_.empty()) {
+      status = StartPartUpload();
+    }
+    status.Update(WaitForPartUploads());
+    if (status.ok()) {
+      status = CompleteUpload();
+    }
+    if (!status.ok()) {
+      AbortUpload();
+    }
+    return status;
+  }
+
+  Status Flush() override { return Sync(); }
+
+  Status Sync() override {
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+ private:
+  // Creates the multipart upload if needed, waits for a free upload slot, and
+  // starts uploading buffer_ as the next part.
+  Status StartPartUpload() {
+    if (upload_id_.empty()) {
+      Aws::S3::Model::CreateMultipartUploadRequest request;
+      request.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
+      auto outcome = s3_client_->CreateMultipartUpload(request);
+      TF_RETURN_IF_ERROR(OutcomeToStatus(outcome));
+      upload_id_ = outcome.GetResult().GetUploadId().c_str();
+    }
+    std::shared_ptr<Aws::StringStream> body =
+        Aws::MakeShared<Aws::StringStream>(kS3FileSystemAllocationTag);
+    body->write(buffer_.data(), buffer_.size());
+    const size_t part_length = buffer_.size();
+    buffer_.clear();
+    int part_number;
+    {
+      mutex_lock l(mu_);
+      while (parts_in_flight_ >= kS3MaxParallelPartUploads) {
+        parts_done_.wait(l);
+      }
+      TF_RETURN_IF_ERROR(status_);
+      ++parts_in_flight_;
+      etags_.emplace_back();
+      // Part numbers start at 1.
+      part_number = etags_.size();
+    }
+    upload_pool_->Schedule([this, body, part_length, part_number]() {
+      Aws::S3::Model::UploadPartRequest request;
+      request.WithBucket(bucket_.c_str())
+          .WithKey(object_.c_str())
+          .WithUploadId(upload_id_.c_str())
+          .WithPartNumber(part_number)
+          .WithContentLength(part_length);
+      request.SetBody(body);
+      auto outcome = s3_client_->UploadPart(request);
+      mutex_lock l(mu_);
+      if (outcome.IsSuccess()) {
+        etags_[part_number - 1] = outcome.GetResult().GetETag().c_str();
+      } else {
+        status_.Update(OutcomeToStatus(outcome));
+      }
+      --parts_in_flight_;
+      parts_done_.notify_all();
+    });
+    return Status::OK();
+  }
+
+  Status WaitForPartUploads() {
+    mutex_lock l(mu_);
+    while (parts_in_flight_ > 0) {
+      parts_done_.wait(l);
+    }
+    return status_;
+  }
+
+  Status CompleteUpload() {
+    Aws::S3::Model::CompletedMultipartUpload completed;
+    for (size_t i = 0; i < etags_.size(); ++i) {
+      completed.AddParts(Aws::S3::Model::CompletedPart()
+                             .WithETag(etags_[i].c_str())
+                             .WithPartNumber(i + 1));
+    }
+    Aws::S3::Model::CompleteMultipartUploadRequest request;
+    request.WithBucket(bucket_.c_str())
+        .WithKey(object_.c_str())
+        .WithUploadId(upload_id_.c_str())
+        .WithMultipartUpload(completed);
+    return OutcomeToStatus(s3_client_->CompleteMultipartUpload(request));
+  }
+
+  // Deletes the parts uploaded so far. Errors are ignored, since the upload
+  // has already failed.
+  void AbortUpload() {
+    if (upload_id_.empty()) {
+      return;
+    }
+    Aws::S3::Model::AbortMultipartUploadRequest request;
+    request.WithBucket(bucket_.c_str())
+        .WithKey(object_.c_str())
+        .WithUploadId(upload_id_.c_str());
+    s3_client_->AbortMultipartUpload(request);
+  }
+
+  Status PutObject() {
+    std::shared_ptr<Aws::StringStream> body =
+        Aws::MakeShared<Aws::StringStream>(kS3FileSystemAllocationTag);
+    body->write(buffer_.data(), buffer_.size());
+    Aws::S3::Model::PutObjectRequest request;
+    request.WithBucket(bucket_.c_str()).WithKey(object_.c_str());
+    request.SetBody(body);
+    request.SetContentLength(buffer_.size());
+    Status status = OutcomeToStatus(s3_client_->PutObject(request));
+    string().swap(buffer_);
+    return status;
+  }
+
+  const string bucket_;
+  const string object_;
+  const size_t part_size_;
+  std::shared_ptr<Aws::S3::S3Client> s3_client_;
+  // The data appended after the parts being uploaded.
+  string buffer_;
+  // The id of the multipart upload, once the first part is full.
+  string upload_id_;
+  bool closed_ = false;
+
+  mutex mu_;
+  condition_variable parts_done_;
+  int parts_in_flight_ GUARDED_BY(mu_) = 0;
+  // The ETag of each part, once uploaded.
+  std::vector<string> etags_ GUARDED_BY(mu_);
+  // The first error of the part uploads.
+  Status status_ GUARDED_BY(mu_);
+
+  // Declared last, so that it is destroyed (and waits for its uploads) first.
+  std::unique_ptr<thread::ThreadPool> upload_pool_;
+};
+
 class S3ReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
  public:
   S3ReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
@@ -254,7 +479,16 @@ Status S3FileSystem::NewWritableFile(const string& fname,
                                      std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
-  result->reset(new S3WritableFile(bucket, object));
+  const char* part_size_env = getenv(kS3MultipartUploadPartSize);
+  uint64 part_size_mb;
+  if (part_size_env && strings::safe_strtou64(part_size_env, &part_size_mb) &&
+      part_size_mb > 0) {
+    part_size_mb = std::max(part_size_mb, kS3MinMultipartUploadPartSize);
+    result->reset(new S3MultipartWritableFile(bucket, object,
+                                              part_size_mb * 1024 * 1024));
+  } else {
+    result->reset(new S3WritableFile(bucket, object));
+  }
   return Status::OK();
 }
 
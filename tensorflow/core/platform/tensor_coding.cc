@@ -29,6 +29,11 @@ void AssignRefCounted(StringPiece src, core::RefCounted* obj, string* out) {
 
 void EncodeStringList(const string* strings, int64 n, string* out) {
   out->clear();
+  size_t bytes = 0;
+  for (int i = 0; i < n; ++i) {
+    bytes += core::VarintLength(strings[i].size()) + strings[i].size();
+  }
+  out->reserve(bytes);
   for (int i = 0; i < n; ++i) {
     core::PutVarint32(out, strings[i].size());
   }
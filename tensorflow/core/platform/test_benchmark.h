@@ -45,6 +45,23 @@ using ::testing::Benchmark;
 
 #else
 
+// Controls how Benchmark::Run measures each benchmark.
+struct BenchmarkOptions {
+  // The minimum time of a repetition, from which the number of iterations is
+  // chosen.
+  double min_time_s = 0.5;
+  // The number of untimed repetitions after the number of iterations has
+  // been chosen. Without any, the run that chose it is the first repetition.
+  int warmup_repetitions = 0;
+  // The number of timed repetitions.
+  int repetitions = 1;
+  // Repetitions whose time deviates from the median by more than this many
+  // (normalized) median absolute deviations are dropped. <= 0 keeps all.
+  double outlier_threshold = 0.0;
+  // The CPUs to run the benchmarks on. Empty leaves the affinity unchanged.
+  std::vector<int> cpus;
+};
+
 class Benchmark {
  public:
   Benchmark(const char* name, void (*fn)(int));
@@ -56,6 +73,7 @@ class Benchmark {
   Benchmark* Range(int lo, int hi);
   Benchmark* RangePair(int lo1, int hi1, int lo2, int hi2);
   static void Run(const char* pattern);
+  static void Run(const char* pattern, const BenchmarkOptions& options);
 
  private:
   string name_;
@@ -66,7 +84,11 @@ class Benchmark {
   void (*fn2_)(int, int, int) = nullptr;
 
   void Register();
-  void Run(int arg1, int arg2, int* run_count, double* run_seconds);
+  // Chooses the number of iterations that takes at least min_time_s.
+  void Run(int arg1, int arg2, double min_time_s, int* run_count,
+           double* run_seconds);
+  // Runs 'iters' iterations, returning the timed seconds.
+  double RunIterations(int arg1, int arg2, int iters);
 };
 #endif
 
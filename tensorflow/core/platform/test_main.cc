@@ -27,6 +27,8 @@ limitations under the License.
 #include <iostream>
 
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -34,12 +36,35 @@ GTEST_API_ int main(int argc, char** argv) {
   std::cout << "Running main() from test_main.cc\n";
 
   testing::InitGoogleTest(&argc, argv);
+  const char* pattern = nullptr;
+  tensorflow::testing::BenchmarkOptions options;
   for (int i = 1; i < argc; i++) {
-    if (tensorflow::StringPiece(argv[i]).starts_with("--benchmarks=")) {
-      const char* pattern = argv[i] + strlen("--benchmarks=");
-      tensorflow::testing::Benchmark::Run(pattern);
-      return 0;
+    using tensorflow::str_util::SplitAndParseAsInts;
+    using tensorflow::strings::safe_strto32;
+    using tensorflow::strings::safe_strtod;
+    tensorflow::StringPiece arg(argv[i]);
+    bool parsed = true;
+    if (arg.Consume("--benchmarks=")) {
+      pattern = arg.data();
+    } else if (arg.Consume("--benchmark_min_time=")) {
+      parsed = safe_strtod(arg, &options.min_time_s);
+    } else if (arg.Consume("--benchmark_warmup_repetitions=")) {
+      parsed = safe_strto32(arg, &options.warmup_repetitions);
+    } else if (arg.Consume("--benchmark_repetitions=")) {
+      parsed = safe_strto32(arg, &options.repetitions);
+    } else if (arg.Consume("--benchmark_outlier_threshold=")) {
+      parsed = safe_strtod(arg, &options.outlier_threshold);
+    } else if (arg.Consume("--benchmark_cpus=")) {
+      parsed = SplitAndParseAsInts(arg, ',', &options.cpus);
     }
+    if (!parsed) {
+      std::cerr << "Invalid value in " << argv[i] << "\n";
+      return 1;
+    }
+  }
+  if (pattern != nullptr) {
+    tensorflow::testing::Benchmark::Run(pattern, options);
+    return 0;
   }
   return RUN_ALL_TESTS();
 }
@@ -56,6 +56,21 @@ int NumSchedulableCPUs() {
   return system_info.dwNumberOfProcessors;
 }
 
+bool NUMANodeCPUs(int node, std::vector<int>* cpus) {
+  cpus->clear();
+  return false;
+}
+
+int NUMANumNodes() { return 1; }
+
+int NUMANodeOfCurrentCPU() { return -1; }
+
+bool ReadCurrentThreadCPUCounters(CPUCounterValues* values) { return false; }
+
+bool SetCurrentThreadCPUAffinity(const std::vector<int>& cpus) {
+  return false;
+}
+
 void* AlignedMalloc(size_t size, int minimum_alignment) {
 #ifdef TENSORFLOW_USE_JEMALLOC
   void* ptr = NULL;
@@ -83,6 +98,12 @@ void AlignedFree(void* aligned_memory) {
 #endif
 }
 
+void* NUMAMalloc(int node, size_t size, int minimum_alignment) {
+  return AlignedMalloc(size, minimum_alignment);
+}
+
+void NUMAFree(void* ptr, size_t size) { AlignedFree(ptr); }
+
 void* Malloc(size_t size) {
 #ifdef TENSORFLOW_USE_JEMALLOC
   return jemalloc_malloc(size);
@@ -113,6 +134,8 @@ void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
 
 std::size_t MallocExtension_GetAllocatedSize(const void* p) { return 0; }
 
+std::size_t PeakResidentMemoryBytes() { return 0; }
+
 void AdjustFilenameForLogging(string* filename) {
   // Nothing to do
 }
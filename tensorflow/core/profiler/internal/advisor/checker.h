@@ -28,6 +28,8 @@ static const char* const kCheckers[] = {
     "AcceleratorUtilizationChecker", "OperationChecker",
     "ExpensiveOperationChecker",
     "JobChecker",  // Internal checker.
+    "PeakMemoryChecker",
+    "CriticalPathChecker",
 };
 
 class Checker {
@@ -0,0 +1,237 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// This checker finds the chain of operations that bounds the step time, and
+// how much each operation could be delayed without making the step longer.
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_CRITICAL_PATH_CHECKER_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_CRITICAL_PATH_CHECKER_H_
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/profiler/internal/advisor/checker.h"
+
+namespace tensorflow {
+namespace tfprof {
+
+class CriticalPathChecker : public Checker {
+ public:
+  string name() const override { return kCheckers[5]; }
+
+ private:
+  static const int kMaxReportedNodes = 10;
+
+  // The timing of a node in the analyzed step.
+  struct NodeTiming {
+    TFGraphNode* node = nullptr;
+    int64 start_micros = 0;
+    int64 end_micros = 0;
+    // The end of the input that finished last, or start_micros.
+    int64 ready_micros = 0;
+    // The input that finished last, if any.
+    const NodeTiming* latest_input = nullptr;
+    std::vector<NodeTiming*> consumers;
+    // The latest end_micros that would not delay the end of the step.
+    int64 latest_end_micros = 0;
+
+    int64 duration() const { return end_micros - start_micros; }
+    int64 wait() const {
+      return std::max<int64>(0, start_micros - ready_micros);
+    }
+    int64 slack() const {
+      return std::max<int64>(0, latest_end_micros - end_micros);
+    }
+  };
+
+  // Options: "step", the step to analyze. Defaults to the last step.
+  AdviceProto::Checker Check(const AdvisorOptionsProto::CheckerOption& options,
+                             const TFStats* stats) override {
+    if (!stats) {
+      fprintf(stderr, "Missing profiles (e.g. graph, run_meta). Skip %s\n",
+              name().c_str());
+      return reports_;
+    }
+    if (stats->steps().empty()) {
+      fprintf(stderr, "Missing RunMetadata info. Skip %s\n", name().c_str());
+      return reports_;
+    }
+    int64 step = *stats->steps().rbegin();
+    auto step_option = options.options().find("step");
+    if (step_option != options.options().end() &&
+        !strings::safe_strto64(step_option->second, &step)) {
+      fprintf(stderr, "Invalid step %s. Skip %s\n",
+              step_option->second.c_str(), name().c_str());
+      return reports_;
+    }
+    Analyze(step, stats);
+    return reports_;
+  }
+
+  void Analyze(int64 step, const TFStats* stats) {
+    std::unordered_map<string, NodeTiming> timings;
+    for (const auto& n : stats->nodes()) {
+      const int64 start = n.second->all_start_micros(step);
+      if (start <= 0) continue;
+      NodeTiming& t = timings[n.first];
+      t.node = n.second.get();
+      t.start_micros = start;
+      t.end_micros = std::max(start, n.second->latest_end_micros(step));
+      t.ready_micros = start;
+    }
+    if (timings.empty()) {
+      fprintf(stderr, "Missing run_meta of step %lld for %s\n", step,
+              name().c_str());
+      return;
+    }
+
+    // Connects the nodes through their data and control inputs. An input is
+    // only followed forward in time, which drops the back edges of loops.
+    auto before = [](const NodeTiming& a, const NodeTiming& b) {
+      if (a.start_micros != b.start_micros) {
+        return a.start_micros < b.start_micros;
+      }
+      return a.node->name() < b.node->name();
+    };
+    std::unordered_map<NodeTiming*, int> num_consumers_left;
+    for (auto& it : timings) {
+      NodeTiming& t = it.second;
+      int64 ready = 0;
+      for (const auto& input : t.node->inputs()) {
+        auto src = timings.find(input.second);
+        if (src == timings.end() || !before(src->second, t)) continue;
+        src->second.consumers.push_back(&t);
+        if (t.latest_input == nullptr || src->second.end_micros > ready) {
+          t.latest_input = &src->second;
+          ready = src->second.end_micros;
+        }
+      }
+      if (t.latest_input != nullptr) t.ready_micros = ready;
+    }
+
+    // Computes latest_end_micros from the consumers back to the producers.
+    int64 step_start = timings.begin()->second.start_micros;
+    NodeTiming* last = &timings.begin()->second;
+    for (auto& it : timings) {
+      step_start = std::min(step_start, it.second.start_micros);
+      if (it.second.end_micros > last->end_micros) last = &it.second;
+      num_consumers_left[&it.second] = it.second.consumers.size();
+    }
+    const int64 step_end = last->end_micros;
+    std::deque<NodeTiming*> ready_nodes;
+    for (auto& it : timings) {
+      it.second.latest_end_micros = step_end;
+      if (it.second.consumers.empty()) ready_nodes.push_back(&it.second);
+    }
+    std::unordered_map<const NodeTiming*, std::vector<NodeTiming*>> producers;
+    for (auto& it : timings) {
+      for (NodeTiming* c : it.second.consumers) {
+        producers[c].push_back(&it.second);
+      }
+    }
+    while (!ready_nodes.empty()) {
+      NodeTiming* c = ready_nodes.front();
+      ready_nodes.pop_front();
+      const int64 latest_ready =
+          c->latest_end_micros - c->duration() - c->wait();
+      for (NodeTiming* p : producers[c]) {
+        p->latest_end_micros = std::min(p->latest_end_micros, latest_ready);
+        if (--num_consumers_left[p] == 0) ready_nodes.push_back(p);
+      }
+    }
+
+    ReportCriticalPath(step, step_start, last);
+    ReportSlack(timings);
+  }
+
+  // Walks back from the node that finished last through the inputs that
+  // finished last. The wait before a node is a transfer when that input ran
+  // on another device, and queueing in the executor otherwise.
+  void ReportCriticalPath(int64 step, int64 step_start,
+                          const NodeTiming* last) {
+    std::vector<const NodeTiming*> path;
+    int64 compute = 0;
+    int64 transfer = 0;
+    int64 queueing = 0;
+    for (const NodeTiming* t = last; t != nullptr; t = t->latest_input) {
+      path.push_back(t);
+      compute += t->duration();
+      if (t->latest_input == nullptr) continue;
+      if (t->latest_input->node->canonical_device() !=
+          t->node->canonical_device()) {
+        transfer += t->wait();
+      } else {
+        queueing += t->wait();
+      }
+    }
+    const int64 total = last->end_micros - path.back()->start_micros;
+    std::vector<string> outputs;
+    outputs.push_back(strings::Printf(
+        "critical path of step %lld: %s over %zu ops (the step took %s), "
+        "compute: %s (%.2f%%), cross-device transfer: %s (%.2f%%), "
+        "queueing: %s (%.2f%%)",
+        step, FormatTime(total).c_str(), path.size(),
+        FormatTime(last->end_micros - step_start).c_str(),
+        FormatTime(compute).c_str(), 100.0 * compute / (total + 1e-10),
+        FormatTime(transfer).c_str(), 100.0 * transfer / (total + 1e-10),
+        FormatTime(queueing).c_str(), 100.0 * queueing / (total + 1e-10)));
+    std::sort(path.begin(), path.end(),
+              [](const NodeTiming* a, const NodeTiming* b) {
+                return a->duration() + a->wait() > b->duration() + b->wait();
+              });
+    for (int i = 0; i < kMaxReportedNodes && i < path.size(); ++i) {
+      const NodeTiming* t = path[i];
+      outputs.push_back(strings::Printf(
+          "  %s (%s) on %s, compute: %s, waited: %s", t->node->name().c_str(),
+          t->node->op().c_str(), t->node->canonical_device().c_str(),
+          FormatTime(t->duration()).c_str(), FormatTime(t->wait()).c_str()));
+    }
+    reports_.add_reports(str_util::Join(outputs, "\n"));
+  }
+
+  // Reports the slack of the most expensive ops: speeding up an op with
+  // slack does not make the step faster.
+  void ReportSlack(const std::unordered_map<string, NodeTiming>& timings) {
+    std::vector<const NodeTiming*> expensive;
+    for (const auto& it : timings) {
+      expensive.push_back(&it.second);
+    }
+    std::sort(expensive.begin(), expensive.end(),
+              [](const NodeTiming* a, const NodeTiming* b) {
+                if (a->duration() != b->duration()) {
+                  return a->duration() > b->duration();
+                }
+                return a->node->name() < b->node->name();
+              });
+    std::vector<string> outputs;
+    outputs.push_back("slack of the most expensive ops:");
+    for (int i = 0; i < kMaxReportedNodes && i < expensive.size(); ++i) {
+      const NodeTiming* t = expensive[i];
+      outputs.push_back(strings::Printf(
+          "  %s (%s), compute: %s, slack: %s%s", t->node->name().c_str(),
+          t->node->op().c_str(), FormatTime(t->duration()).c_str(),
+          FormatTime(t->slack()).c_str(),
+          t->slack() == 0 ? " (critical)" : ""));
+    }
+    reports_.add_reports(str_util::Join(outputs, "\n"));
+  }
+
+  AdviceProto::Checker reports_;
+};
+
+}  // namespace tfprof
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_CRITICAL_PATH_CHECKER_H_
@@ -0,0 +1,106 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// This checker reports which operations held the memory of each allocator
+// when it was at its peak.
+#ifndef THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_PEAK_MEMORY_CHECKER_H_
+#define THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_PEAK_MEMORY_CHECKER_H_
+
+#include "tensorflow/core/profiler/internal/advisor/checker.h"
+
+namespace tensorflow {
+namespace tfprof {
+
+class PeakMemoryChecker : public Checker {
+ public:
+  string name() const override { return kCheckers[4]; }
+
+ private:
+  static const int kMaxHolders = 10;
+
+  AdviceProto::Checker Check(const AdvisorOptionsProto::CheckerOption& options,
+                             const TFStats* stats) override {
+    if (!stats) {
+      fprintf(stderr, "Missing profiles (e.g. graph, run_meta). Skip %s\n",
+              name().c_str());
+      return reports_;
+    }
+    // The highest peak of each allocator over all steps.
+    std::map<string, std::pair<int64, const AllocatorTimeline*>> peaks;
+    for (const auto& step : stats->allocator_timelines()) {
+      for (const AllocatorTimeline& timeline : step.second) {
+        auto& peak = peaks[timeline.allocator_name()];
+        if (peak.second == nullptr ||
+            timeline.peak_bytes_in_use() > peak.second->peak_bytes_in_use()) {
+          peak = {step.first, &timeline};
+        }
+      }
+    }
+    if (peaks.empty()) {
+      fprintf(stderr, "Missing allocator timelines in run_meta. Skip %s\n",
+              name().c_str());
+      return reports_;
+    }
+    for (const auto& peak : peaks) {
+      const AllocatorTimeline& timeline = *peak.second.second;
+      if (timeline.live_at_peak_size() == 0) continue;
+      std::vector<string> outputs;
+      outputs.push_back(strings::Printf(
+          "%s peaked at %s in step %lld, held by:", peak.first.c_str(),
+          FormatMemory(timeline.peak_bytes_in_use()).c_str(),
+          peak.second.first));
+      for (int i = 0; i < kMaxHolders && i < timeline.live_at_peak_size();
+           ++i) {
+        outputs.push_back(
+            HolderString(timeline.live_at_peak(i),
+                         timeline.peak_bytes_in_use(), stats->nodes()));
+      }
+      reports_.add_reports(str_util::Join(outputs, "\n"));
+    }
+    return reports_;
+  }
+
+  // Describes the allocations of one op with its type, output shapes and
+  // the innermost frame of the code that created it, when they are known.
+  string HolderString(
+      const AllocationsAtPeak& holder, int64 peak_bytes,
+      const std::map<string, std::unique_ptr<TFGraphNode>>& nodes) {
+    string op = holder.op_name().empty() ? "<unattributed>" : holder.op_name();
+    auto node = nodes.find(holder.op_name());
+    if (node != nodes.end()) {
+      strings::StrAppend(&op, " (", node->second->op(), ")");
+      for (const auto& shape : node->second->output_shapes()) {
+        strings::StrAppend(&op, ", output ", shape.first, ": ",
+                           FormatShapes(shape.second));
+      }
+      const CallStack* call_stack = node->second->call_stack();
+      if (call_stack != nullptr && !call_stack->traces().empty()) {
+        const CallStack::Trace& trace = call_stack->traces().back();
+        strings::StrAppend(&op, ", at ", trace.file(), ":", trace.lineno());
+      }
+    }
+    return strings::Printf(
+        "  %s (%.2f%%) in %lld allocations: %s",
+        FormatMemory(holder.bytes()).c_str(),
+        100.0 * holder.bytes() / (peak_bytes + 1e-10),
+        holder.num_allocations(), op.c_str());
+  }
+
+  AdviceProto::Checker reports_;
+};
+
+}  // namespace tfprof
+}  // namespace tensorflow
+
+#endif  // THIRD_PARTY_TENSORFLOW_CORE_PROFILER_INTERNAL_ADVISOR_PEAK_MEMORY_CHECKER_H_
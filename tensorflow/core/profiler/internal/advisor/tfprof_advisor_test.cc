@@ -100,5 +100,62 @@ TEST_F(TFProfAdvisorTest, ExpensiveOperationChecker) {
                   .contains("top 1 operation type: Conv2D"));
 }
 
+TEST_F(TFProfAdvisorTest, PeakMemoryChecker) {
+  std::unique_ptr<RunMetadata> run_meta(new RunMetadata);
+  DeviceStepStats* dev_stats = run_meta->mutable_step_stats()->add_dev_stats();
+  AllocatorTimeline* timeline = dev_stats->add_allocator_timelines();
+  timeline->set_allocator_name("GPU_0_bfc");
+  timeline->set_peak_bytes_in_use(4096);
+  AllocationsAtPeak* live = timeline->add_live_at_peak();
+  live->set_op_name("n2");
+  live->set_bytes(3072);
+  live->set_num_allocations(2);
+  live = timeline->add_live_at_peak();
+  live->set_bytes(1024);
+  live->set_num_allocations(1);
+  stats_->AddRunMeta(0, std::move(run_meta));
+
+  AdvisorOptionsProto options;
+  (*options.mutable_checkers())[kCheckers[4]];
+  AdviceProto advice = advisor_->Advise(options);
+  ASSERT_EQ(1, advice.checkers().at(kCheckers[4]).reports_size());
+  const StringPiece report(advice.checkers().at(kCheckers[4]).reports(0));
+  EXPECT_TRUE(report.contains("GPU_0_bfc peaked at"));
+  EXPECT_TRUE(report.contains("(75.00%) in 2 allocations: n2 (Conv2D)"));
+  EXPECT_TRUE(report.contains("(25.00%) in 1 allocations: <unattributed>"));
+}
+
+TEST_F(TFProfAdvisorTest, CriticalPathChecker) {
+  // "c" waits 5us for "a", the input that finished last. "b" and "d" have
+  // slack.
+  TFStats stats(std::unique_ptr<GraphDef>(new GraphDef()), nullptr, nullptr,
+                nullptr);
+  stats.AddNodeForTest(0, CreateNode("a", "MatMul", {}, 0, 10, 10));
+  stats.AddNodeForTest(0, CreateNode("b", "Add", {}, 0, 10, 2));
+  std::unique_ptr<TFGraphNode> c = CreateNode("c", "Conv2D", {}, 0, 25, 5);
+  c->AddInput("a", 0, 0);
+  c->AddInput("b", 0, 1);
+  stats.AddNodeForTest(0, std::move(c));
+  stats.AddNodeForTest(0, CreateNode("d", "Relu", {}, 0, 10, 4));
+  Advisor advisor(&stats);
+
+  AdvisorOptionsProto options;
+  (*options.mutable_checkers())[kCheckers[5]];
+  AdviceProto advice = advisor.Advise(options);
+  const AdviceProto::Checker& checker = advice.checkers().at(kCheckers[5]);
+  ASSERT_EQ(2, checker.reports_size());
+  const StringPiece path(checker.reports(0));
+  EXPECT_TRUE(path.contains("critical path of step 0: 20us over 2 ops"));
+  EXPECT_TRUE(path.contains("compute: 15us (75.00%)"));
+  EXPECT_TRUE(path.contains("queueing: 5us (25.00%)"));
+  EXPECT_TRUE(path.contains("c (Conv2D)"));
+  EXPECT_FALSE(path.contains("b (Add)"));
+  const StringPiece slack(checker.reports(1));
+  EXPECT_TRUE(
+      slack.contains("a (MatMul), compute: 10us, slack: 0us (critical)"));
+  EXPECT_TRUE(slack.contains("b (Add), compute: 2us, slack: 8us"));
+  EXPECT_TRUE(slack.contains("d (Relu), compute: 4us, slack: 16us"));
+}
+
 }  // namespace tfprof
 }  // namespace tensorflow
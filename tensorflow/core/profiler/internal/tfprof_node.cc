@@ -44,8 +44,19 @@ bool IsCanonicalDevice(const string& device) { return CountAsCPUTime(device); }
 // For ops on cpu:
 // It will only appear as cpu:0.
 
+void AddCPUCounters(const CPUCounters& counters, CPUCounters* total) {
+  total->set_cycles(total->cycles() + counters.cycles());
+  total->set_instructions(total->instructions() + counters.instructions());
+  total->set_llc_misses(total->llc_misses() + counters.llc_misses());
+  total->set_stalled_cycles(total->stalled_cycles() +
+                            counters.stalled_cycles());
+}
+
 void ExecStep::AddTimeStats(const string& dev, const NodeExecStats& step_stat) {
   devices_.insert(dev);
+  if (step_stat.has_cpu_counters()) {
+    AddCPUCounters(step_stat.cpu_counters(), exec_.mutable_cpu_counters());
+  }
   if (step_stat.all_start_micros() > 0) {
     if (exec_.all_start_micros() > 0) {
       exec_.set_all_start_micros(
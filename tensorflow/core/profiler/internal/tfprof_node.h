@@ -84,6 +84,9 @@ class CallStack {
   CodeDef def_;
 };
 
+// Adds the counts of 'counters' to '*total'.
+void AddCPUCounters(const CPUCounters& counters, CPUCounters* total);
+
 class ExecStep {
  public:
   ExecStep() {}
@@ -93,6 +96,7 @@ class ExecStep {
   void AddMemoryStats(const string& dev, const NodeExecStats& step_stat);
 
   int64 run_count() const { return exec_.run_count(); }
+  const CPUCounters& cpu_counters() const { return exec_.cpu_counters(); }
   // The execution time of an op. If it runs on accelerator, then it's
   // accelerator_exec_micros(). Otherwise, it's CPU time.
   int64 exec_micros() const;
@@ -568,6 +572,31 @@ class TFGraphNode {
     return total_micros / execs_.size();
   }
 
+  // The hardware events of 'step', or their average over all steps if 'step'
+  // is negative.
+  CPUCounters cpu_counters(int64 step) const {
+    CPUCounters counters;
+    if (step >= 0) {
+      auto exec = execs_.find(step);
+      if (exec != execs_.end()) {
+        counters = exec->second.cpu_counters();
+      }
+      return counters;
+    }
+    if (execs_.empty()) {
+      return counters;
+    }
+    for (const auto& exec : execs_) {
+      AddCPUCounters(exec.second.cpu_counters(), &counters);
+    }
+    const int64 num_steps = execs_.size();
+    counters.set_cycles(counters.cycles() / num_steps);
+    counters.set_instructions(counters.instructions() / num_steps);
+    counters.set_llc_misses(counters.llc_misses() / num_steps);
+    counters.set_stalled_cycles(counters.stalled_cycles() / num_steps);
+    return counters;
+  }
+
   int64 requested_bytes(int64 step) const { GRAPH_NODE_BYTES(requested); }
   int64 peak_bytes(int64 step) const { GRAPH_NODE_BYTES(peak); }
   int64 residual_bytes(int64 step) const { GRAPH_NODE_BYTES(residual); }
@@ -784,6 +813,7 @@ class TFMultiGraphNode {
     output_bytes_ = 0;
 
     float_ops_ = 0;
+    cpu_counters_.Clear();
     parameters_ = 0;
     op_types_.clear();
     shapes_.clear();
@@ -811,6 +841,7 @@ class TFMultiGraphNode {
       output_bytes_ += node->output_bytes(step);
 
       float_ops_ += node->float_ops(step);
+      AddCPUCounters(node->cpu_counters(step), &cpu_counters_);
       parameters_ += node->parameters();
       if (node->shape().size() > 0) {
         shapes_.push_back(node->shape());
@@ -848,6 +879,8 @@ class TFMultiGraphNode {
 
   int64 float_ops() const { return float_ops_; }
 
+  const CPUCounters& cpu_counters() const { return cpu_counters_; }
+
   int64 parameters() const { return parameters_; }
 
   const std::set<string>& devices() const { return devices_; }
@@ -897,6 +930,7 @@ class TFMultiGraphNode {
   int64 residual_bytes_;
   int64 output_bytes_;
   int64 float_ops_;
+  CPUCounters cpu_counters_;
   int64 parameters_;
   std::set<string> devices_;
   std::vector<std::vector<int64>> shapes_;
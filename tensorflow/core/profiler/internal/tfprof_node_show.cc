@@ -161,6 +161,7 @@ bool ShowMultiNode::ReInit(int64 step,
   mutable_proto()->set_output_bytes(node->output_bytes());
 
   mutable_proto()->set_float_ops(node->float_ops());
+  *mutable_proto()->mutable_cpu_counters() = node->cpu_counters();
 
   mutable_proto()->set_parameters(node->parameters());
   return has_matched_type;
@@ -61,6 +61,31 @@ string FormatCPUExecTime(const ShowMultiNode* node, const ShowMultiNode* root) {
                       accu_pct, pct)
           .c_str());
 }
+// Instructions per cycle, last level cache misses per thousand instructions,
+// the fraction of stalled cycles and float ops per cycle, which tell whether
+// the kernels are bound by compute or by memory.
+string FormatCPUCounters(const ShowMultiNode* node) {
+  const CPUCounters& counters = node->proto().cpu_counters();
+  if (counters.cycles() <= 0) {
+    return strings::Printf("%30s", "cpu_counters N/A");
+  }
+  const double cycles = counters.cycles();
+  std::vector<string> values;
+  values.push_back(
+      strings::Printf("%.2f IPC", counters.instructions() / cycles));
+  if (counters.instructions() > 0) {
+    values.push_back(strings::Printf(
+        "%.2f LLC misses/Kinstr",
+        1000.0 * counters.llc_misses() / counters.instructions()));
+  }
+  values.push_back(strings::Printf("%.2f%% stalled",
+                                   100.0 * counters.stalled_cycles() / cycles));
+  if (node->proto().float_ops() > 0) {
+    values.push_back(strings::Printf("%.2f float_ops/cycle",
+                                     node->proto().float_ops() / cycles));
+  }
+  return strings::Printf("%30s", str_util::Join(values, " ").c_str());
+}
 string FormatAcceleratorExecTime(const ShowMultiNode* node,
                                  const ShowMultiNode* root) {
   double accu_pct = 0.0;
@@ -294,6 +319,10 @@ string TFOp::FormatNode(OpNode* node, OpNode* root, const Options& opts) const {
                     .c_str()));
   }
 
+  if (opts.select.find(kShown[14]) != opts.select.end()) {
+    attrs.push_back(FormatCPUCounters(node));
+  }
+
   if (opts.select.find(kShown[5]) != opts.select.end()) {
     attrs.push_back(str_util::Join(node->node->devices(), "|"));
   }
@@ -145,6 +145,9 @@ string TFMultiShow::FormatLegend(const Options& opts) const {
   if (opts.select.find(kShown[3]) != opts.select.end()) {
     legends.push_back("# float_ops");
   }
+  if (opts.select.find(kShown[14]) != opts.select.end()) {
+    legends.push_back("cpu counters");
+  }
   if (opts.select.find(kShown[5]) != opts.select.end()) {
     legends.push_back("assigned devices");
   }
@@ -207,5 +207,37 @@ TEST_F(TFProfShowTest, DumpOpMode) {
 
   EXPECT_EQ(dump_str, TestToFromProto("op", opts, true));
 }
+
+TEST_F(TFProfShowTest, DumpCPUCounters) {
+  std::unique_ptr<RunMetadata> run_meta(new RunMetadata);
+  CHECK(protobuf::TextFormat::ParseFromString(
+      "step_stats { dev_stats {"
+      "  device: '/job:localhost/replica:0/task:0/cpu:0'"
+      "  node_stats { node_name: 'Conv2D' all_start_micros: 10"
+      "    op_end_rel_micros: 5 cpu_counters { cycles: 1000"
+      "    instructions: 2000 llc_misses: 10 stalled_cycles: 250 } }"
+      "  node_stats { node_name: 'Conv2D_1' all_start_micros: 20"
+      "    op_end_rel_micros: 5 cpu_counters { cycles: 3000"
+      "    instructions: 6000 llc_misses: 30 stalled_cycles: 750 } }"
+      "} }",
+      run_meta.get()));
+  tf_stats_->AddRunMeta(10, std::move(run_meta));
+  tf_stats_->BuildAllViews();
+
+  string dump_file = io::JoinPath(testing::TmpDir(), "dump");
+  Options opts(5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, "name",
+               {".*"},  // accout_type_regexes
+               {".*"}, {""}, {"Conv2D"}, {""}, false, {"cpu_counters"},
+               "file", {{"outfile", dump_file}});
+  tf_stats_->ShowMultiGraphNode("op", opts);
+
+  string dump_str;
+  TF_CHECK_OK(ReadFileToString(Env::Default(), dump_file, &dump_str));
+  EXPECT_NE(string::npos, dump_str.find("node name | cpu counters\n"));
+  // Summed over both Conv2D nodes.
+  EXPECT_NE(string::npos,
+            dump_str.find("2.00 IPC 5.00 LLC misses/Kinstr 25.00% stalled"));
+  EXPECT_NE(string::npos, dump_str.find("float_ops/cycle"));
+}
 }  // namespace tfprof
 }  // namespace tensorflow
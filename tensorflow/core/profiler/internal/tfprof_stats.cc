@@ -259,6 +259,11 @@ void TFStats::AddRunMeta(int64 step, std::unique_ptr<RunMetadata> run_meta) {
   steps_.insert(step);
 
   for (const auto& dev_stat : run_meta->step_stats().dev_stats()) {
+    for (const AllocatorTimeline& timeline : dev_stat.allocator_timelines()) {
+      std::vector<AllocatorTimeline>& timelines = allocator_timelines_[step];
+      timelines.push_back(timeline);
+      timelines.back().clear_events();
+    }
     for (const NodeExecStats& node_stat : dev_stat.node_stats()) {
       string name = node_stat.node_name();
       // Sometimes the node_name is suffixed with unnecessary information.
@@ -27,6 +27,7 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "tensorflow/c/checkpoint_reader.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -69,6 +70,11 @@ class TFStats {
   double run_coverage() const {
     return covered_nodes_.size() / (nodes_map_.size() + 1e-10);
   }
+  // The allocator timelines of each step, without their events.
+  const std::map<int64, std::vector<AllocatorTimeline>>& allocator_timelines()
+      const {
+    return allocator_timelines_;
+  }
 
   void BuildView(const string& cmd);
   void BuildAllViews();
@@ -117,6 +123,7 @@ class TFStats {
   std::map<int64, string> id_to_string_;
   // Graph nodes covered by RunMetdata, that is traced with run time stats.
   std::set<int64> covered_nodes_;
+  std::map<int64, std::vector<AllocatorTimeline>> allocator_timelines_;
 };
 
 }  // namespace tfprof
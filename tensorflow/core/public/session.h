@@ -172,6 +172,44 @@ class Session {
                       const std::vector<string>& output_names,
                       std::vector<Tensor>* outputs);
 
+  /// \brief A handle to a subgraph, created with `Session::MakeCallable()`.
+  typedef int64 CallableHandle;
+
+  /// \brief Creates a `handle` for invoking the subgraph defined by
+  /// `feed_names`, `fetch_names` and `target_names` under `run_options`.
+  /// The feeds and fetches are resolved once, so repeated calls to
+  /// `RunCallable()` skip the per-step name lookups of `Run()`.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status MakeCallable(const RunOptions& run_options,
+                              const std::vector<string>& feed_names,
+                              const std::vector<string>& fetch_names,
+                              const std::vector<string>& target_names,
+                              CallableHandle* out_handle) {
+    return errors::Unimplemented(
+        "MakeCallable is not supported for this session.");
+  }
+
+  /// \brief Invokes the subgraph named by `handle`. `feed_tensors` must be
+  /// in the order of the `feed_names` passed to `MakeCallable()`, and
+  /// `*fetch_tensors` is filled in the order of its `fetch_names`.
+  /// `run_metadata` may be nullptr.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status RunCallable(CallableHandle handle,
+                             const std::vector<Tensor>& feed_tensors,
+                             std::vector<Tensor>* fetch_tensors,
+                             RunMetadata* run_metadata) {
+    return errors::Unimplemented(
+        "RunCallable is not supported for this session.");
+  }
+
+  /// \brief Releases the resources associated with `handle`. The handle is
+  /// invalid after this call returns.
+  /// NOTE: This API is still experimental and may change.
+  virtual Status ReleaseCallable(CallableHandle handle) {
+    return errors::Unimplemented(
+        "ReleaseCallable is not supported for this session.");
+  }
+
   /// \brief List devices in the session.
   ///
   /// Retrieves the list of available devices within the session, and populates
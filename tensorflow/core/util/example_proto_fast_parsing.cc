@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <cstring>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
@@ -23,10 +24,12 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/casts.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/presized_cuckoo_map.h"
@@ -60,6 +63,145 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+template <typename T>
+class LimitedArraySlice {
+ public:
+  typedef T value_type;
+
+  LimitedArraySlice(T* begin, size_t num_elements)
+      : current_(begin), end_(begin + num_elements) {}
+
+  // May return negative if there were push_back calls after slice was filled.
+  int64 EndDistance() const { return end_ - current_; }
+
+  // Attempts to push value to the back of this. If the slice has
+  // already been filled, this method has no effect on the underlying data, but
+  // it changes the number returned by EndDistance into negative values.
+  void push_back(T&& value) {
+    if (EndDistance() > 0) *current_ = std::move(value);
+    ++current_;
+  }
+
+  // Attempts to reserve `n` values at the back of this, and returns a pointer
+  // to them. If the slice cannot hold them, returns nullptr and, like
+  // push_back, changes the number returned by EndDistance.
+  T* GrowBy(size_t n) {
+    T* result = EndDistance() >= static_cast<int64>(n) ? current_ : nullptr;
+    current_ += n;
+    return result;
+  }
+
+ private:
+  T* current_;
+  T* end_;
+};
+
+// Appends `n` values to `list`, and returns a pointer to them, or nullptr if
+// `list` cannot hold them.
+template <typename T>
+T* GrowBy(SmallVector<T>* list, size_t n) {
+  const size_t size = list->size();
+  list->resize(size + n);
+  return list->data() + size;
+}
+
+template <typename T>
+T* GrowBy(LimitedArraySlice<T>* list, size_t n) {
+  return list->GrowBy(n);
+}
+
+// Points `*data` at the next `length` bytes of `stream`, which must be backed
+// by a flat array, and skips them.
+bool ReadPackedBytes(protobuf::io::CodedInputStream* stream, uint32 length,
+                     const uint8** data) {
+  if (length == 0) {
+    *data = nullptr;
+    return true;
+  }
+  const void* stream_alias;
+  int stream_size;
+  if (!stream->GetDirectBufferPointer(&stream_alias, &stream_size)) {
+    return false;
+  }
+  if (static_cast<uint32>(stream_size) < length) return false;
+  *data = static_cast<const uint8*>(stream_alias);
+  return stream->Skip(length);
+}
+
+bool ParseString(protobuf::io::CodedInputStream* stream, StringPiece* result) {
+  DCHECK(stream != nullptr);
+  DCHECK(result != nullptr);
+  uint32 length;
+  if (!stream->ReadVarint32(&length)) return false;
+  const uint8* data;
+  if (!ReadPackedBytes(stream, length, &data)) return false;
+  *result = StringPiece(reinterpret_cast<const char*>(data), length);
+  return true;
+}
+
+// Decodes the `n` little-endian floats at `data` into `out`. On little-endian
+// hosts this is a single memcpy, which is vectorized.
+void DecodePackedFloats(const uint8* data, size_t n, float* out) {
+  if (port::kLittleEndian) {
+    if (n > 0) memcpy(out, data, n * sizeof(float));
+  } else {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = bit_cast<float>(
+          core::DecodeFixed32(reinterpret_cast<const char*>(data) + 4 * i));
+    }
+  }
+}
+
+constexpr uint64 kVarintContinuationBits = 0x8080808080808080ull;
+
+// Returns the number of varints in [data, end), that is the number of bytes
+// without a continuation bit. Counts 8 bytes at a time.
+size_t CountPackedVarints(const uint8* data, const uint8* end) {
+  size_t count = 0;
+  for (; end - data >= 8; data += 8) {
+    uint64 word;
+    memcpy(&word, data, sizeof(word));
+    // One bit in each byte that ends a varint, summed by the multiplication
+    // into the top byte.
+    const uint64 ends = (~word & kVarintContinuationBits) >> 7;
+    count += (ends * 0x0101010101010101ull) >> 56;
+  }
+  for (; data < end; ++data) {
+    if ((*data & 0x80) == 0) ++count;
+  }
+  return count;
+}
+
+// Decodes the varints in [data, end) into `out`, which must have room for
+// CountPackedVarints(data, end) values. Runs of 8 one-byte varints, which are
+// common for small ids and counts, are decoded without branching per byte.
+bool DecodePackedVarints(const uint8* data, const uint8* end, int64* out) {
+  while (data < end) {
+    if (end - data >= 8) {
+      uint64 word;
+      memcpy(&word, data, sizeof(word));
+      if ((word & kVarintContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) out[i] = data[i];
+        out += 8;
+        data += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    uint8 byte;
+    int shift = 0;
+    do {
+      // A varint has at most 10 bytes.
+      if (data == end || shift >= 64) return false;
+      byte = *data++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    *out++ = static_cast<int64>(value);
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -109,11 +251,10 @@ class Feature {
     while (!stream.ExpectAtEnd()) {
       if (!stream.ExpectTag(kDelimitedTag(1))) return false;
       // parse string
-      uint32 bytes_length;
-      if (!stream.ReadVarint32(&bytes_length)) return false;
-      string bytes;
-      if (!stream.ReadString(&bytes, bytes_length)) return false;
-      bytes_list->push_back(std::move(bytes));
+      StringPiece bytes;
+      if (!ParseString(&stream, &bytes)) return false;
+      bytes_list->push_back(
+          typename Result::value_type(bytes.data(), bytes.size()));
     }
     stream.PopLimit(limit);
     return true;
@@ -139,15 +280,14 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          uint32 buffer32;
-          if (!stream.ReadLittleEndian32(&buffer32)) return false;
-          float_list->push_back(bit_cast<float>(buffer32));
+        if (packed_length % sizeof(float) != 0) return false;
+        const uint8* packed_data;
+        if (!ReadPackedBytes(&stream, packed_length, &packed_data)) {
+          return false;
         }
-
-        stream.PopLimit(packed_limit);
+        const size_t n = packed_length / sizeof(float);
+        float* out = GrowBy(float_list, n);
+        if (out != nullptr) DecodePackedFloats(packed_data, n, out);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kFixed32Tag(1))) return false;
@@ -181,15 +321,17 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        const uint8* packed_data;
+        if (!ReadPackedBytes(&stream, packed_length, &packed_data)) {
+          return false;
+        }
+        const uint8* packed_end = packed_data + packed_length;
+        int64* out =
+            GrowBy(int64_list, CountPackedVarints(packed_data, packed_end));
+        if (out != nullptr &&
+            !DecodePackedVarints(packed_data, packed_end, out)) {
+          return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -240,26 +382,6 @@ inline bool SkipExtraneousTag(protobuf::io::CodedInputStream* stream) {
   return false;  // unrecognized tag type
 }
 
-bool ParseString(protobuf::io::CodedInputStream* stream, StringPiece* result) {
-  DCHECK(stream != nullptr);
-  DCHECK(result != nullptr);
-  uint32 length;
-  if (!stream->ReadVarint32(&length)) return false;
-  if (length == 0) {
-    *result = StringPiece(nullptr, 0);
-    return true;
-  }
-  const void* stream_alias;
-  int stream_size;
-  if (!stream->GetDirectBufferPointer(&stream_alias, &stream_size)) {
-    return false;
-  }
-  if (static_cast<uint32>(stream_size) < length) return false;
-  *result = StringPiece(static_cast<const char*>(stream_alias), length);
-  stream->Skip(length);
-  return true;
-}
-
 bool ParseFeatureMapEntry(protobuf::io::CodedInputStream* stream,
                           parsed::FeatureMapEntry* feature_map_entry) {
   DCHECK(stream != nullptr);
@@ -408,7 +530,9 @@ enum class Type { Sparse, Dense };
 struct SparseBuffer {
   // Features are in one of the 3 vectors below depending on config's dtype.
   // Other 2 vectors remain empty.
-  SmallVector<string> bytes_list;
+  // Bytes features alias the serialized examples, which outlive the buffers,
+  // so that they are only copied once, into the output tensors.
+  SmallVector<StringPiece> bytes_list;
   SmallVector<float> float_list;
   SmallVector<int64> int64_list;
 
@@ -425,28 +549,6 @@ struct SeededHasher {
   uint64 seed{0xDECAFCAFFE};
 };
 
-template <typename T>
-class LimitedArraySlice {
- public:
-  LimitedArraySlice(T* begin, size_t num_elements)
-      : current_(begin), end_(begin + num_elements) {}
-
-  // May return negative if there were push_back calls after slice was filled.
-  int64 EndDistance() const { return end_ - current_; }
-
-  // Attempts to push value to the back of this. If the slice has
-  // already been filled, this method has no effect on the underlying data, but
-  // it changes the number returned by EndDistance into negative values.
-  void push_back(T&& value) {
-    if (EndDistance() > 0) *current_ = std::move(value);
-    ++current_;
-  }
-
- private:
-  T* current_;
-  T* end_;
-};
-
 Status FastParseSerializedExample(
     const string& serialized_example, const string& example_name,
     const size_t example_index, const Config& config,
@@ -765,8 +867,19 @@ Status CheckConfigDataType(DataType dtype) {
   }
 }
 
+// The type of the values of a SparseBuffer for an output of type T.
+template <typename T>
+struct BufferValue {
+  typedef T type;
+};
+template <>
+struct BufferValue<string> {
+  typedef StringPiece type;
+};
+
 template <typename T>
-const SmallVector<T>& GetListFromBuffer(const SparseBuffer& buffer);
+const SmallVector<typename BufferValue<T>::type>& GetListFromBuffer(
+    const SparseBuffer& buffer);
 
 template <>
 const SmallVector<int64>& GetListFromBuffer<int64>(const SparseBuffer& buffer) {
@@ -777,7 +890,7 @@ const SmallVector<float>& GetListFromBuffer<float>(const SparseBuffer& buffer) {
   return buffer.float_list;
 }
 template <>
-const SmallVector<string>& GetListFromBuffer<string>(
+const SmallVector<StringPiece>& GetListFromBuffer<string>(
     const SparseBuffer& buffer) {
   return buffer.bytes_list;
 }
@@ -786,9 +899,8 @@ template <typename T>
 void CopyOrMoveBlock(const T* b, const T* e, T* t) {
   std::copy(b, e, t);
 }
-template <>
-void CopyOrMoveBlock(const string* b, const string* e, string* t) {
-  std::move(b, e, t);
+void CopyOrMoveBlock(const StringPiece* b, const StringPiece* e, string* t) {
+  for (; b != e; ++b, ++t) t->assign(b->data(), b->size());
 }
 
 template <typename T>
@@ -929,6 +1041,12 @@ Status FastParseExample(const Config& config,
   std::vector<std::vector<SparseBuffer>> varlen_dense_buffers(num_minibatches);
   std::vector<Status> status_of_minibatch(num_minibatches);
   auto ProcessMiniBatch = [&](size_t minibatch) {
+    if (config.cancellation_manager != nullptr &&
+        config.cancellation_manager->IsCancelled()) {
+      status_of_minibatch[minibatch] =
+          errors::Cancelled("Parsing Examples was cancelled");
+      return;
+    }
     sparse_buffers[minibatch].resize(config.sparse.size());
     varlen_dense_buffers[minibatch].resize(config.dense.size());
     size_t start = first_example_of_minibatch(minibatch);
@@ -972,16 +1090,16 @@ Status FastParseExample(const Config& config,
     TensorShape indices_shape;
     indices_shape.AddDim(total_num_features);
     indices_shape.AddDim(2);
-    result->sparse_indices.emplace_back(DT_INT64, indices_shape);
-    Tensor* indices = &result->sparse_indices.back();
+    result->sparse_indices[d] = Tensor(DT_INT64, indices_shape);
+    Tensor* indices = &result->sparse_indices[d];
 
     TensorShape values_shape;
     values_shape.AddDim(total_num_features);
-    result->sparse_values.emplace_back(config.sparse[d].dtype, values_shape);
-    Tensor* values = &result->sparse_values.back();
+    result->sparse_values[d] = Tensor(config.sparse[d].dtype, values_shape);
+    Tensor* values = &result->sparse_values[d];
 
-    result->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
-    auto shapes_shape_t = result->sparse_shapes.back().vec<int64>();
+    result->sparse_shapes[d] = Tensor(DT_INT64, TensorShape({2}));
+    auto shapes_shape_t = result->sparse_shapes[d].vec<int64>();
     shapes_shape_t(0) = serialized.size();
     shapes_shape_t(1) = max_num_features;
 
@@ -1019,8 +1137,8 @@ Status FastParseExample(const Config& config,
           break;
         }
         case DT_STRING: {
-          std::move(buffer.bytes_list.begin(), buffer.bytes_list.end(),
-                    values->flat<string>().data() + offset);
+          CopyOrMoveBlock(buffer.bytes_list.begin(), buffer.bytes_list.end(),
+                          values->flat<string>().data() + offset);
           break;
         }
         default:
@@ -1088,13 +1206,13 @@ Status FastParseExample(const Config& config,
     }
   };
 
-  for (size_t d = 0; d < config.dense.size(); ++d) {
-    MergeDenseVarLenMinibatches(d);
-  }
-
-  for (size_t d = 0; d < config.sparse.size(); ++d) {
-    MergeSparseMinibatches(d);
-  }
+  // Each feature is merged into its own outputs, so features are merged in
+  // parallel.
+  result->sparse_indices.resize(config.sparse.size());
+  result->sparse_values.resize(config.sparse.size());
+  result->sparse_shapes.resize(config.sparse.size());
+  ParallelFor(MergeDenseVarLenMinibatches, config.dense.size(), thread_pool);
+  ParallelFor(MergeSparseMinibatches, config.sparse.size(), thread_pool);
 
   return Status::OK();
 }
@@ -59,6 +59,10 @@ struct FastParseExampleConfig {
 
   std::vector<Dense> dense;
   std::vector<Sparse> sparse;
+
+  // If set, the minibatches that have not started when it is cancelled are
+  // skipped and FastParseExample() returns Cancelled. Not owned.
+  CancellationManager* cancellation_manager = nullptr;
 };
 
 // This is exactly the output of TF's ParseExample Op.
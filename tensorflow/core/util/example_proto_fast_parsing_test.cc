@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -166,6 +167,37 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedVarintsOfAllSizes) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["ids"]
+                         .mutable_int64_list();
+  // Runs of one-byte varints, mixed with multi-byte and negative ones.
+  for (int i = 0; i < 100; ++i) {
+    int64_list->add_value(i % 128);
+    if (i % 13 == 0) int64_list->add_value(int64{1} << (i % 63));
+    if (i % 17 == 0) int64_list->add_value(-i);
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, PackedFloats) {
+  Example example;
+  auto* float_list = (*example.mutable_features()->mutable_feature())["floats"]
+                         .mutable_float_list();
+  for (int i = 0; i < 100; ++i) {
+    float_list->add_value(i * 0.25f - 7.0f);
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedVarint) {
+  // A packed int64_list whose last byte has a continuation bit.
+  Example example;
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x8d",
+      &example));
+}
+
 TEST(FastParse, EmptyFeatures) {
   Example example;
   example.mutable_features();
@@ -363,6 +395,47 @@ string MakeSerializedExample() {
   return serialized;
 }
 
+TEST(TestFastParseExample, SparseAndVarLenValues) {
+  Example example;
+  auto& fmap = *example.mutable_features()->mutable_feature();
+  fmap["string"].mutable_bytes_list()->add_value("abc");
+  fmap["string"].mutable_bytes_list()->add_value("");
+  for (int i = 0; i < 20; ++i) {
+    fmap["int64"].mutable_int64_list()->add_value(i * 1000);
+  }
+  std::vector<string> serialized = {Serialize(example), Serialize(Example())};
+
+  FastParseExampleConfig config;
+  config.sparse.push_back({"string", DT_STRING});
+  FastParseExampleConfig::Dense dense;
+  dense.feature_name = "int64";
+  dense.dtype = DT_INT64;
+  dense.shape = PartialTensorShape({-1});
+  dense.elements_per_stride = 1;
+  dense.variable_length = true;
+  dense.default_value = Tensor(DT_INT64, TensorShape({}));
+  dense.default_value.scalar<int64>()() = -1;
+  config.dense.push_back(dense);
+
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, gtl::ArraySlice<string>(),
+                                nullptr, &result));
+  ASSERT_EQ(1, result.sparse_values.size());
+  auto strings = result.sparse_values[0].vec<string>();
+  ASSERT_EQ(2, strings.size());
+  EXPECT_EQ("abc", strings(0));
+  EXPECT_EQ("", strings(1));
+
+  ASSERT_EQ(1, result.dense_values.size());
+  auto int64s = result.dense_values[0].matrix<int64>();
+  ASSERT_EQ(2, int64s.dimension(0));
+  ASSERT_EQ(20, int64s.dimension(1));
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(i * 1000, int64s(0, i));
+    EXPECT_EQ(-1, int64s(1, i));
+  }
+}
+
 TEST(TestFastParseExample, Empty) {
   Result result;
   FastParseExampleConfig config;
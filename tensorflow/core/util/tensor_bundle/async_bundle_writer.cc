@@ -0,0 +1,149 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/async_bundle_writer.h"
+
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+AsyncBundleWriter::AsyncBundleWriter(Env* env, int64 max_pending_bytes)
+    : env_(env), max_pending_bytes_(max_pending_bytes) {}
+
+AsyncBundleWriter::~AsyncBundleWriter() {
+  std::unique_ptr<Thread> thread;
+  {
+    mutex_lock l(mu_);
+    shutdown_ = true;
+    cond_.notify_all();
+    thread = std::move(thread_);
+  }
+  // Joins the thread once it has written the remaining bundles.
+  thread.reset();
+}
+
+// static
+AsyncBundleWriter* AsyncBundleWriter::Global() {
+  static AsyncBundleWriter* writer = []() {
+    int64 max_pending_bytes;
+    Status s = ReadInt64FromEnvVar("TF_ASYNC_CHECKPOINT_MAX_PENDING_BYTES", 0,
+                                   &max_pending_bytes);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      max_pending_bytes = 0;
+    }
+    return new AsyncBundleWriter(Env::Default(), max_pending_bytes);
+  }();
+  return writer;
+}
+
+void AsyncBundleWriter::ReserveBytes(int64 bytes) {
+  mutex_lock l(mu_);
+  while (pending_bytes_ > 0 && pending_bytes_ + bytes > max_pending_bytes_) {
+    cond_.wait(l);
+  }
+  pending_bytes_ += bytes;
+}
+
+void AsyncBundleWriter::Schedule(const string& prefix,
+                                 const BundleWriter::Options& options,
+                                 std::vector<Entry> entries,
+                                 int64 reserved_bytes) {
+  Save save;
+  save.prefix = prefix;
+  save.options = options;
+  save.entries = std::move(entries);
+  save.reserved_bytes = reserved_bytes;
+  mutex_lock l(mu_);
+  ++prefixes_[prefix].num_pending;
+  queue_.push_back(std::move(save));
+  if (thread_ == nullptr) {
+    thread_.reset(env_->StartThread(ThreadOptions(), "async_bundle_writer",
+                                    [this]() { WriterLoop(); }));
+  }
+  cond_.notify_all();
+}
+
+Status AsyncBundleWriter::Wait(const string& prefix) {
+  mutex_lock l(mu_);
+  auto it = prefixes_.find(prefix);
+  if (it == prefixes_.end()) return Status::OK();
+  while (it->second.num_pending > 0) {
+    cond_.wait(l);
+    // Another Wait() may have taken the state in the meantime.
+    it = prefixes_.find(prefix);
+    if (it == prefixes_.end()) return Status::OK();
+  }
+  Status s = it->second.status;
+  prefixes_.erase(it);
+  return s;
+}
+
+int64 AsyncBundleWriter::pending_bytes() const {
+  mutex_lock l(mu_);
+  return pending_bytes_;
+}
+
+void AsyncBundleWriter::WriterLoop() {
+  while (true) {
+    Save save;
+    {
+      mutex_lock l(mu_);
+      while (queue_.empty() && !shutdown_) {
+        cond_.wait(l);
+      }
+      if (queue_.empty()) return;
+      save = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    const uint64 start_micros = env_->NowMicros();
+    Status s = Write(env_, save);
+    VLOG(1) << "Wrote bundle " << save.prefix << " of "
+            << save.reserved_bytes << " bytes in "
+            << env_->NowMicros() - start_micros << " us: " << s;
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to write bundle " << save.prefix << ": " << s;
+    }
+    // Frees the tensors before their bytes are released.
+    save.entries.clear();
+    mutex_lock l(mu_);
+    pending_bytes_ -= save.reserved_bytes;
+    PrefixState* state = &prefixes_[save.prefix];
+    --state->num_pending;
+    state->status.Update(s);
+    cond_.notify_all();
+  }
+}
+
+// static
+Status AsyncBundleWriter::Write(Env* env, const Save& save) {
+  BundleWriter writer(env, save.prefix, save.options);
+  TF_RETURN_IF_ERROR(writer.status());
+  for (const Entry& entry : save.entries) {
+    if (entry.is_slice) {
+      TF_RETURN_IF_ERROR(writer.AddSlice(entry.key, entry.full_shape,
+                                         entry.slice_spec, entry.tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(entry.key, entry.tensor));
+    }
+  }
+  return writer.Finish();
+}
+
+}  // namespace tensorflow
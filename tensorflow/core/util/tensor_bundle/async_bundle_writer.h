@@ -0,0 +1,127 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Writes tensor bundles on a background thread, so that saving a checkpoint
+// only holds up the caller for as long as it takes to snapshot the tensors.
+// Usage:
+//
+//   AsyncBundleWriter* writer = AsyncBundleWriter::Global();
+//   writer->ReserveBytes(bytes);  // Blocks while too many bytes are pending.
+//   writer->Schedule(prefix, options, std::move(entries), bytes);
+//   ...
+//   TF_RETURN_IF_ERROR(writer->Wait(prefix));
+//
+// The tensors of the entries must not be modified until their bundle is
+// written, so they are usually deep copies of the tensors to save, or tensors
+// whose writers copy their buffer when it is shared (e.g. resource
+// variables).
+
+#ifndef TENSORFLOW_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
+#define TENSORFLOW_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+class AsyncBundleWriter {
+ public:
+  // A tensor to write, as by BundleWriter::Add(), or as by
+  // BundleWriter::AddSlice() if "is_slice".
+  struct Entry {
+    string key;
+    Tensor tensor;
+    bool is_slice = false;
+    TensorShape full_shape;
+    TensorSlice slice_spec;
+  };
+
+  // The bundles are written one at a time, in the order they are scheduled.
+  // "max_pending_bytes" bounds the bytes of the tensors held by the bundles
+  // that are scheduled but not written yet, except that a single bundle is
+  // always accepted when none is pending.
+  AsyncBundleWriter(Env* env, int64 max_pending_bytes);
+
+  // Waits for every scheduled bundle to be written.
+  ~AsyncBundleWriter();
+
+  // Returns the writer of the process, which bounds the pending bytes by the
+  // environment variable TF_ASYNC_CHECKPOINT_MAX_PENDING_BYTES.  It defaults
+  // to 0, i.e. a save waits for the previous one to be written.
+  static AsyncBundleWriter* Global();
+
+  // Blocks until "bytes" more bytes may be pending, then reserves them for a
+  // call to Schedule().  Meant to be called before the tensors are copied.
+  void ReserveBytes(int64 bytes);
+
+  // Writes "entries" to the bundle "prefix" in the background, and releases
+  // the "reserved_bytes" from ReserveBytes() once it is written.
+  void Schedule(const string& prefix, const BundleWriter::Options& options,
+                std::vector<Entry> entries, int64 reserved_bytes);
+
+  // Blocks until the bundles scheduled for "prefix" so far are written, and
+  // returns the first error writing them, or OK if none is pending.
+  Status Wait(const string& prefix);
+
+  // Returns the bytes reserved by the bundles that are not written yet.
+  int64 pending_bytes() const;
+
+ private:
+  struct Save {
+    string prefix;
+    BundleWriter::Options options;
+    std::vector<Entry> entries;
+    int64 reserved_bytes = 0;
+  };
+  // The saves of one prefix that are not waited for yet.
+  struct PrefixState {
+    int num_pending = 0;
+    Status status;
+  };
+
+  void WriterLoop();
+  static Status Write(Env* env, const Save& save);
+
+  Env* const env_;
+  const int64 max_pending_bytes_;
+
+  mutable mutex mu_;
+  condition_variable cond_;
+  bool shutdown_ GUARDED_BY(mu_) = false;
+  int64 pending_bytes_ GUARDED_BY(mu_) = 0;
+  std::deque<Save> queue_ GUARDED_BY(mu_);
+  std::unordered_map<string, PrefixState> prefixes_ GUARDED_BY(mu_);
+  // Started by the first Schedule().
+  std::unique_ptr<Thread> thread_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncBundleWriter);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_UTIL_TENSOR_BUNDLE_ASYNC_BUNDLE_WRITER_H_
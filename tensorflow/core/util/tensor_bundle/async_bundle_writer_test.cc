@@ -0,0 +1,134 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/async_bundle_writer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+AsyncBundleWriter::Entry FullEntry(const string& key, const Tensor& tensor) {
+  AsyncBundleWriter::Entry entry;
+  entry.key = key;
+  entry.tensor = tensor;
+  return entry;
+}
+
+TEST(AsyncBundleWriterTest, WritesBundles) {
+  AsyncBundleWriter writer(Env::Default(), 0);
+  const Tensor a = test::AsTensor<float>({1, 2, 3}, {3});
+  const Tensor b = test::AsTensor<int32>({4, 5}, {2});
+  std::vector<AsyncBundleWriter::Entry> entries;
+  entries.push_back(FullEntry("b", b));
+  entries.push_back(FullEntry("a", a));
+  AsyncBundleWriter::Entry slice;
+  slice.key = "c";
+  slice.tensor = test::AsTensor<int64>({7, 8}, {2});
+  slice.is_slice = true;
+  slice.full_shape = TensorShape({4});
+  TF_ASSERT_OK(TensorSlice::Parse("2,2", &slice.slice_spec));
+  entries.push_back(slice);
+  writer.ReserveBytes(32);
+  EXPECT_EQ(32, writer.pending_bytes());
+  writer.Schedule(Prefix("async_foo"), BundleWriter::Options(),
+                  std::move(entries), 32);
+  TF_EXPECT_OK(writer.Wait(Prefix("async_foo")));
+  EXPECT_EQ(0, writer.pending_bytes());
+
+  BundleReader reader(Env::Default(), Prefix("async_foo"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val(DT_FLOAT, TensorShape({3}));
+  TF_ASSERT_OK(reader.Lookup("a", &val));
+  test::ExpectTensorEqual<float>(a, val);
+  val = Tensor(DT_INT32, TensorShape({2}));
+  TF_ASSERT_OK(reader.Lookup("b", &val));
+  test::ExpectTensorEqual<int32>(b, val);
+  EXPECT_TRUE(reader.Contains("c"));
+
+  // Nothing is pending any more.
+  TF_EXPECT_OK(writer.Wait(Prefix("async_foo")));
+  TF_EXPECT_OK(writer.Wait(Prefix("async_nothing")));
+}
+
+TEST(AsyncBundleWriterTest, ReturnsErrors) {
+  AsyncBundleWriter writer(Env::Default(), 1 << 20);
+  std::vector<AsyncBundleWriter::Entry> entries;
+  entries.push_back(FullEntry("a", test::AsTensor<float>({1}, {1})));
+  entries.push_back(FullEntry("a", test::AsTensor<float>({2}, {1})));
+  writer.ReserveBytes(8);
+  writer.Schedule(Prefix("async_dup"), BundleWriter::Options(),
+                  std::move(entries), 8);
+  Status s = writer.Wait(Prefix("async_dup"));
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  // The error is only returned once.
+  TF_EXPECT_OK(writer.Wait(Prefix("async_dup")));
+}
+
+TEST(AsyncBundleWriterTest, BoundsPendingBytes) {
+  std::unique_ptr<AsyncBundleWriter> writer(
+      new AsyncBundleWriter(Env::Default(), 100));
+  // A single save is accepted whatever its size.
+  writer->ReserveBytes(1000);
+  std::atomic<bool> reserved(false);
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "reserve", [&writer, &reserved]() {
+        writer->ReserveBytes(10);
+        reserved = true;
+      }));
+  Env::Default()->SleepForMicroseconds(100000);
+  EXPECT_FALSE(reserved);
+
+  std::vector<AsyncBundleWriter::Entry> entries;
+  entries.push_back(FullEntry("a", test::AsTensor<float>({1}, {1})));
+  writer->Schedule(Prefix("async_big"), BundleWriter::Options(),
+                   std::move(entries), 1000);
+  thread.reset();
+  EXPECT_TRUE(reserved);
+  EXPECT_EQ(10, writer->pending_bytes());
+  TF_EXPECT_OK(writer->Wait(Prefix("async_big")));
+}
+
+TEST(AsyncBundleWriterTest, DestructorWritesPendingBundles) {
+  {
+    AsyncBundleWriter writer(Env::Default(), 0);
+    std::vector<AsyncBundleWriter::Entry> entries;
+    entries.push_back(FullEntry("a", test::AsTensor<float>({1}, {1})));
+    writer.ReserveBytes(4);
+    writer.Schedule(Prefix("async_dtor"), BundleWriter::Options(),
+                    std::move(entries), 4);
+  }
+  BundleReader reader(Env::Default(), Prefix("async_dtor"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_TRUE(reader.Contains("a"));
+}
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb_text.h"
@@ -32,11 +33,13 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/framework/versions.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/gtl/stl_util.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/random/random.h"
@@ -58,6 +61,27 @@ const char* const kHeaderEntryKey = "";
 
 namespace {
 
+// The size of the reads of tensor contents from the data files.
+const size_t kReadChunkSize = 8 << 20;  // 8MB
+
+// LookupMany() reads the tensors smaller than this that are close together in
+// their data file with one read, skipping gaps of up to kMaxCoalescedGap
+// bytes between them, e.g. alignment padding.
+const size_t kMaxCoalescedTensorSize = 256 << 10;  // 256KB
+const size_t kMaxCoalescedGap = 64 << 10;          // 64KB
+
+// The capacity of the block cache shared by the metadata tables of all the
+// readers.
+const size_t kMetadataBlockCacheSize = 16 << 20;  // 16MB
+
+// The bits per key of the bloom filters of the metadata tables, which let
+// lookups of missing keys, e.g. the lenient names tried by
+// GetBundleEntryProto(), skip reading data blocks.
+const int kMetadataFilterBitsPerKey = 10;
+
+// The maximum number of data files renamed concurrently by MergeBundles().
+const int kMaxMergeRenameThreads = 16;
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -369,6 +393,30 @@ Status CorruptFileError(const Status& in_status, const string& filename,
                       detail, "): ", in_status.error_message()));
 }
 
+// The allocator of the buffer of a single tensor aliasing a memory-mapped data
+// file.  Keeps the mapping alive, and is owned by the tensor buffer.
+class MappedTensorAllocator : public Allocator {
+ public:
+  MappedTensorAllocator(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                        uint64 offset)
+      : region_(std::move(region)), offset_(offset) {}
+
+  string Name() override { return "MappedTensorAllocator"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return const_cast<char*>(static_cast<const char*>(region_->data()) +
+                             offset_);
+  }
+
+  void DeallocateRaw(void* ptr) override { delete this; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const uint64 offset_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedTensorAllocator);
+};
+
 table::Options TableBuilderOptions() {
   table::Options o;
   // Compressed tables cannot be read by TensorFlow releases prior to 1.1.
@@ -376,35 +424,72 @@ table::Options TableBuilderOptions() {
   // (version 1.2) with the intention that they will be enabled again at
   // some point (perhaps the 1.3 release?).
   o.compression = table::kNoCompression;
+  o.filter_bits_per_key = kMetadataFilterBitsPerKey;
   return o;
 }
 
+// Returns the block cache of the metadata tables.  Every reader of a bundle
+// looks up its entries, e.g. the slices of a partitioned tensor, in the data
+// blocks of the table, which are thus only read once while they are cached.
+table::Cache* MetadataBlockCache() {
+  static table::Cache* cache = table::NewLRUCache(kMetadataBlockCacheSize);
+  return cache;
+}
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix)
-    : env_(env),
+    : BundleWriter(env, prefix, Options()) {}
+
+BundleWriter::BundleWriter(Env* env, StringPiece prefix,
+                           const Options& options)
+    : options_(options),
+      env_(env),
       prefix_(prefix.ToString()),
       tmp_metadata_path_(strings::StrCat(MetaFilename(prefix_), ".tempstate",
-                                         random::New64())),
-      tmp_data_path_(strings::StrCat(DataFilename(prefix_, 0, 1), ".tempstate",
-                                     random::New64())),
-      out_(nullptr),
-      size_(0) {
+                                         random::New64())) {
+  if (options.num_data_shards < 1) {
+    status_ = errors::InvalidArgument("A bundle needs at least one data file, ",
+                                      options.num_data_shards, " requested");
+    return;
+  }
+  if (options.data_alignment < 1) {
+    status_ = errors::InvalidArgument("Invalid data alignment ",
+                                      options.data_alignment);
+    return;
+  }
   status_ = env_->CreateDir(io::Dirname(prefix_).ToString());
   if (!status_.ok() && !errors::IsAlreadyExists(status_)) {
     return;
   }
-  const string filename = DataFilename(prefix_, 0, 1);
-  std::unique_ptr<WritableFile> wrapper;
-  status_ = env_->NewWritableFile(tmp_data_path_, &wrapper);
-  if (!status_.ok()) return;
-  out_ = std::unique_ptr<FileOutputBuffer>(
-      new FileOutputBuffer(wrapper.release(), 8 << 20 /* 8MB write buffer */));
+  status_ = Status::OK();
+  for (int i = 0; i < options.num_data_shards; ++i) {
+    std::unique_ptr<DataShard> shard(new DataShard);
+    shard->tmp_path =
+        strings::StrCat(DataFilename(prefix_, i, options.num_data_shards),
+                        ".tempstate", random::New64());
+    std::unique_ptr<WritableFile> wrapper;
+    status_ = env_->NewWritableFile(shard->tmp_path, &wrapper);
+    if (!status_.ok()) return;
+    mutex_lock l(shard->mu);
+    shard->out = std::unique_ptr<FileOutputBuffer>(new FileOutputBuffer(
+        wrapper.release(), 8 << 20 /* 8MB write buffer */));
+    VLOG(1) << "Writing to file " << shard->tmp_path;
+    shards_.push_back(std::move(shard));
+  }
+  if (shards_.size() > 1) {
+    write_pool_.reset(
+        new thread::ThreadPool(env_, "bundle_writer", shards_.size()));
+  }
+}
 
-  VLOG(1) << "Writing to file " << tmp_data_path_;
+BundleWriter::~BundleWriter() {
+  // Waits for the background writes.
+  write_pool_.reset();
 }
 
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
+  UpdateStatusFromWrites();
   if (!status_.ok()) return status_;
   CHECK_NE(key, kHeaderEntryKey);
   const string key_string = key.ToString();
@@ -416,28 +501,74 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
+
+  if (!write_pool_) {
+    status_ = WriteEntry(val, 0, entry);
+    return status_;
+  }
+  // Balances the bytes of the data files, which are written in parallel.
+  int shard_id = 0;
+  for (int i = 1; i < shards_.size(); ++i) {
+    if (shards_[i]->added_bytes < shards_[shard_id]->added_bytes) {
+      shard_id = i;
+    }
+  }
+  shards_[shard_id]->added_bytes += val.TotalBytes();
+  // The copy of "val" keeps its buffer alive until it is written.
+  write_pool_->Schedule([this, val, shard_id, entry]() {
+    Status s = WriteEntry(val, shard_id, entry);
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      write_status_.Update(s);
+    }
+  });
+  return Status::OK();
+}
+
+Status BundleWriter::WriteEntry(const Tensor& val, int shard_id,
+                                BundleEntryProto* entry) {
+  DataShard* shard = shards_[shard_id].get();
+  mutex_lock l(shard->mu);
+  FileOutputBuffer* out = shard->out.get();
+  const int64 padding =
+      DataTypeCanUseMemcpy(val.dtype())
+          ? (options_.data_alignment - shard->size % options_.data_alignment) %
+                options_.data_alignment
+          : 0;
+  if (padding > 0) {
+    TF_RETURN_IF_ERROR(out->Append(string(padding, '\0')));
+    shard->size += padding;
+  }
+  entry->set_shard_id(shard_id);
+  entry->set_offset(shard->size);
 
   // Updates the data file.
   size_t data_bytes_written = 0;
   uint32 crc32c = 0;
-  out_->clear_crc32c();
+  out->clear_crc32c();
+  Status status;
   if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
+    status = WriteStringTensor(val, out, &data_bytes_written, &crc32c);
   } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
+    status = WriteVariantTensor(val, out, &data_bytes_written, &crc32c);
   } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
+    status = WriteTensor(val, out, &data_bytes_written);
+    crc32c = out->crc32c();
   }
 
-  if (status_.ok()) {
+  if (status.ok()) {
     entry->set_size(data_bytes_written);
     entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
+    shard->size += data_bytes_written;
+  }
+  return status;
+}
+
+void BundleWriter::UpdateStatusFromWrites() {
+  if (write_pool_) {
+    mutex_lock l(mu_);
+    status_.Update(write_status_);
   }
-  return status_;
 }
 
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
@@ -481,18 +612,69 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   return status_;
 }
 
+Status BundleWriter::FinishDataShard(int shard_id, const string& filename,
+                                     const Status& status) {
+  DataShard* shard = shards_[shard_id].get();
+  mutex_lock l(shard->mu);
+  if (!shard->out) return status;
+  Status s = status;
+  s.Update(shard->out->Close());
+  shard->out = nullptr;
+  if (s.ok()) {
+    s = Env::Default()->RenameFile(shard->tmp_path, filename);
+  } else {
+    Env::Default()->DeleteFile(shard->tmp_path).IgnoreError();
+  }
+  return s;
+}
+
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
-  if (out_) {
-    status_.Update(out_->Close());
-    out_ = nullptr;
-    if (status_.ok()) {
-      status_ = Env::Default()->RenameFile(tmp_data_path_,
-                                           DataFilename(prefix_, 0, 1));
-    } else {
-      Env::Default()->DeleteFile(tmp_data_path_).IgnoreError();
+  if (write_pool_) {
+    // Waits for the background writes.
+    write_pool_.reset();
+    UpdateStatusFromWrites();
+  }
+  int num_shards = shards_.size();
+  if (num_shards > 1) {
+    // Drops the data files without tensors, so that MergeBundles() renames
+    // all the data files of the bundle.
+    std::vector<bool> used(shards_.size(), false);
+    used[0] = true;
+    for (const auto& p : entries_) {
+      if (p.second.slices().empty()) used[p.second.shard_id()] = true;
+    }
+    std::vector<int> shard_ids(shards_.size(), -1);
+    num_shards = 0;
+    for (int i = 0; i < shards_.size(); ++i) {
+      if (used[i]) shard_ids[i] = num_shards++;
+    }
+    for (auto& p : entries_) {
+      if (p.second.slices().empty()) {
+        p.second.set_shard_id(shard_ids[p.second.shard_id()]);
+      }
+    }
+    std::vector<Status> statuses(shards_.size());
+    {
+      thread::ThreadPool pool(env_, "bundle_writer", shards_.size());
+      for (int i = 0; i < shards_.size(); ++i) {
+        const string filename =
+            shard_ids[i] < 0 ? ""
+                             : DataFilename(prefix_, shard_ids[i], num_shards);
+        const Status status = (shard_ids[i] < 0 || !status_.ok())
+                                  ? errors::Cancelled("Unused data file")
+                                  : Status::OK();
+        pool.Schedule([this, i, filename, status, &statuses]() {
+          statuses[i] = FinishDataShard(i, filename, status);
+        });
+      }
+    }
+    for (int i = 0; i < shards_.size(); ++i) {
+      if (shard_ids[i] >= 0) status_.Update(statuses[i]);
     }
+  } else if (num_shards == 1) {
+    status_ = FinishDataShard(0, DataFilename(prefix_, 0, 1), status_);
   }
   if (!status_.ok()) return status_;
   // Build key -> BundleEntryProto table.
@@ -504,10 +686,11 @@ Status BundleWriter::Finish() {
     // platforms (e.g. Android).  The metadata file is small, so this is fine.
     table::Options options;
     options.compression = table::kNoCompression;
+    options.filter_bits_per_key = kMetadataFilterBitsPerKey;
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_shards);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -667,13 +850,29 @@ Status MergeBundles(Env* env, gtl::ArraySlice<string> prefixes,
     TF_RETURN_IF_ERROR(MergeOneBundle(env, prefixes[i], &merge));
   }
 
-  // Renames data files to contain the merged bundle prefix.
-  for (const auto& p : merge.shard_ids) {
-    VLOG(1) << "Renaming " << p.first << " to "
-            << DataFilename(merged_prefix, p.second, merge.shard_ids.size());
-    TF_RETURN_IF_ERROR(env->RenameFile(
-        p.first,
-        DataFilename(merged_prefix, p.second, merge.shard_ids.size())));
+  // Renames data files to contain the merged bundle prefix.  The renames are
+  // concurrent, since on some file systems they copy the data files.
+  if (!merge.shard_ids.empty()) {
+    std::vector<Status> statuses(merge.shard_ids.size());
+    {
+      // Destroying the pool waits for the renames.
+      thread::ThreadPool pool(
+          env, "merge_bundles",
+          std::min<int>(merge.shard_ids.size(), kMaxMergeRenameThreads));
+      for (const auto& p : merge.shard_ids) {
+        const string& old_filename = p.first;
+        const string new_filename =
+            DataFilename(merged_prefix, p.second, merge.shard_ids.size());
+        Status* status = &statuses[p.second];
+        pool.Schedule([env, &old_filename, new_filename, status]() {
+          VLOG(1) << "Renaming " << old_filename << " to " << new_filename;
+          *status = env->RenameFile(old_filename, new_filename);
+        });
+      }
+    }
+    for (const Status& s : statuses) {
+      TF_RETURN_IF_ERROR(s);
+    }
   }
 
   // Writes the final metadata table under the merged prefix.
@@ -730,7 +929,9 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
   status_ = env_->NewRandomAccessFile(filename, &wrapper);
   if (!status_.ok()) return;
   metadata_ = wrapper.release();
-  status_ = table::Table::Open(table::Options(), metadata_, file_size, &table_);
+  table::Options options;
+  options.block_cache = MetadataBlockCache();
+  status_ = table::Table::Open(options, metadata_, file_size, &table_);
   if (!status_.ok()) return;
   iter_ = table_->NewIterator();
 
@@ -778,8 +979,12 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
-  Seek(key);
-  if (!iter_->Valid() || iter_->key() != key) {
+  bool found = false;
+  if (table_->KeyMayMatch(key)) {
+    Seek(key);
+    found = iter_->Valid() && iter_->key() == key;
+  }
+  if (!found) {
     if (lenient_names_ && !key.ends_with(":0")) {
       // TODO(b/64763924): Remove after Jan 1st 2018.
       // Try appending ":0" to the key.
@@ -812,6 +1017,34 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+Status BundleReader::GetDataFile(int32 shard_id,
+                                 io::InputBuffer** buffered_file) {
+  *buffered_file = data_[shard_id];
+  if (*buffered_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    *buffered_file =
+        new io::InputBuffer(file.release(), 256 << 10 /* 256KB buffer */);
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_[shard_id] = *buffered_file;
+  }
+  return Status::OK();
+}
+
+Status BundleReader::GetMappedDataFile(
+    int32 shard_id, std::shared_ptr<ReadOnlyMemoryRegion>* region) {
+  std::shared_ptr<ReadOnlyMemoryRegion>& mapped = mapped_data_[shard_id];
+  if (mapped == nullptr) {
+    std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+    TF_RETURN_IF_ERROR(env_->NewReadOnlyMemoryRegionFromFile(
+        DataFilename(prefix_, shard_id, num_shards_), &new_region));
+    mapped = std::move(new_region);
+  }
+  *region = mapped;
+  return Status::OK();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
@@ -841,18 +1074,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file =
-        new io::InputBuffer(file.release(), 256 << 10 /* 256KB buffer */);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
@@ -862,7 +1085,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     // rely on io::InputBuffer's blind buffering here.
     char* backing_buffer = const_cast<char*>((ret->tensor_data().data()));
     TF_RETURN_IF_ERROR(ReadInputByChunk(buffered_file->file(), entry.offset(),
-                                        entry.size(), 8 << 20 /* 8MB buffer */,
+                                        entry.size(), kReadChunkSize,
                                         backing_buffer));
     actual_crc32c = crc32c::Value(backing_buffer, entry.size());
   } else if (entry.dtype() == DT_VARIANT) {
@@ -903,6 +1126,194 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMany(gtl::ArraySlice<string> keys,
+                                gtl::ArraySlice<Tensor*> vals,
+                                int num_threads) {
+  CHECK_EQ(keys.size(), vals.size());
+  // A read of file[offset, offset + size) into buffer[0, size).
+  struct ChunkRead {
+    const RandomAccessFile* file;
+    uint64 offset;
+    size_t size;
+    char* buffer;
+  };
+  // The contents of a tensor, to checksum once read.
+  struct TensorContents {
+    const string* key;
+    const char* buffer;
+    size_t size;
+    uint32 crc32c;
+  };
+  // A chunk read into a scratch buffer, whose pieces are then copied into the
+  // buffers of the small tensors [begin, end).
+  struct CoalescedRead {
+    size_t chunk;
+    size_t begin;
+    size_t end;
+  };
+  std::vector<ChunkRead> chunk_reads;
+  std::vector<ChunkRead> small_reads;
+  std::vector<TensorContents> contents;
+  // Looks up the entries in key order, so that each block of the metadata
+  // table is only visited once.
+  std::vector<size_t> order(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(),
+            [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+  for (size_t i : order) {
+    Tensor* val = vals[i];
+    CHECK(val != nullptr);
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &entry));
+    if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype())) {
+      TF_RETURN_IF_ERROR(Lookup(keys[i], val));
+      continue;
+    }
+    if (val->NumElements() == 0) {
+      *val = Tensor(entry.dtype(), TensorShape(entry.shape()));
+    }
+    if (entry.size() != val->TotalBytes()) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", keys[i],
+                              "; stored size ", entry.size(),
+                              "; expected size ", val->TotalBytes());
+    }
+    io::InputBuffer* buffered_file;
+    TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+    char* buffer = GetBackingBuffer(*val);
+    contents.push_back({&keys[i], buffer, entry.size(), entry.crc32c()});
+    if (entry.size() == 0) continue;
+    if (entry.size() < kMaxCoalescedTensorSize) {
+      small_reads.push_back(
+          {buffered_file->file(), entry.offset(), entry.size(), buffer});
+      continue;
+    }
+    // Splits the read at the offsets of the data file that are multiples of
+    // the chunk size.
+    const uint64 end = entry.offset() + entry.size();
+    for (uint64 offset = entry.offset(); offset < end;) {
+      const uint64 chunk_end =
+          std::min(end, (offset / kReadChunkSize + 1) * kReadChunkSize);
+      chunk_reads.push_back({buffered_file->file(), offset, chunk_end - offset,
+                             buffer + (offset - entry.offset())});
+      offset = chunk_end;
+    }
+  }
+
+  // Reads the runs of small tensors that are close together in the same data
+  // file with one read of at most the chunk size.
+  std::sort(small_reads.begin(), small_reads.end(),
+            [](const ChunkRead& a, const ChunkRead& b) {
+              if (a.file != b.file) return a.file < b.file;
+              return a.offset < b.offset;
+            });
+  std::vector<CoalescedRead> coalesced_reads;
+  std::vector<std::unique_ptr<char[]>> scratch_buffers;
+  for (size_t begin = 0; begin < small_reads.size();) {
+    const ChunkRead& first = small_reads[begin];
+    uint64 end = first.offset + first.size;
+    size_t next = begin + 1;
+    while (next < small_reads.size() && small_reads[next].file == first.file &&
+           small_reads[next].offset >= end &&
+           small_reads[next].offset - end <= kMaxCoalescedGap &&
+           small_reads[next].offset + small_reads[next].size - first.offset <=
+               kReadChunkSize) {
+      end = small_reads[next].offset + small_reads[next].size;
+      ++next;
+    }
+    if (next == begin + 1) {
+      chunk_reads.push_back(first);
+    } else {
+      scratch_buffers.emplace_back(new char[end - first.offset]);
+      coalesced_reads.push_back({chunk_reads.size(), begin, next});
+      chunk_reads.push_back({first.file, first.offset, end - first.offset,
+                             scratch_buffers.back().get()});
+    }
+    begin = next;
+  }
+  if (chunk_reads.empty()) return Status::OK();
+
+  std::vector<Status> read_statuses(chunk_reads.size());
+  std::vector<Status> checksum_statuses(contents.size());
+  {
+    thread::ThreadPool pool(
+        env_, "bundle_reader",
+        std::max(1, std::min<int>(num_threads, chunk_reads.size())));
+    BlockingCounter reads_done(chunk_reads.size());
+    for (size_t i = 0; i < chunk_reads.size(); ++i) {
+      pool.Schedule([&chunk_reads, &read_statuses, &reads_done, i]() {
+        const ChunkRead& read = chunk_reads[i];
+        read_statuses[i] = ReadInputByChunk(read.file, read.offset, read.size,
+                                            kReadChunkSize, read.buffer);
+        reads_done.DecrementCount();
+      });
+    }
+    reads_done.Wait();
+    for (const Status& s : read_statuses) {
+      TF_RETURN_IF_ERROR(s);
+    }
+    for (const CoalescedRead& coalesced : coalesced_reads) {
+      const ChunkRead& read = chunk_reads[coalesced.chunk];
+      for (size_t i = coalesced.begin; i < coalesced.end; ++i) {
+        const ChunkRead& piece = small_reads[i];
+        memcpy(piece.buffer, read.buffer + (piece.offset - read.offset),
+               piece.size);
+      }
+    }
+    for (size_t i = 0; i < contents.size(); ++i) {
+      pool.Schedule([&contents, &checksum_statuses, i]() {
+        const TensorContents& c = contents[i];
+        const uint32 actual_crc32c = crc32c::Value(c.buffer, c.size);
+        if (crc32c::Unmask(c.crc32c) != actual_crc32c) {
+          checksum_statuses[i] = errors::DataLoss(
+              "Checksum does not match for key ", *c.key, ": stored ",
+              strings::Printf("%08u", crc32c::Unmask(c.crc32c)),
+              " vs. calculated on the restored bytes ", actual_crc32c);
+        }
+      });
+    }
+  }
+  for (const Status& s : checksum_statuses) {
+    TF_RETURN_IF_ERROR(s);
+  }
+  return Status::OK();
+}
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      entry.size() == 0 || entry.offset() % Allocator::kAllocatorAlignment) {
+    // Cannot be aliased, so is read into a new tensor.
+    *val = Tensor(entry.dtype(), shape);
+    return Lookup(key, val);
+  }
+  if (entry.size() != shape.num_elements() * DataTypeSize(entry.dtype())) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(), "; expected size ",
+                            shape.num_elements() * DataTypeSize(entry.dtype()));
+  }
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  TF_RETURN_IF_ERROR(GetMappedDataFile(entry.shard_id(), &region));
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("Tensor ", key, " at offset ", entry.offset(),
+                            " of size ", entry.size(),
+                            " extends past the end of its data file");
+  }
+  if (reinterpret_cast<intptr_t>(region->data()) %
+          Allocator::kAllocatorAlignment !=
+      0) {
+    // Unlikely, since mappings start at page boundaries.
+    *val = Tensor(entry.dtype(), shape);
+    return Lookup(key, val);
+  }
+  // The tensor owns the allocator from this point.
+  *val = Tensor(new MappedTensorAllocator(region, entry.offset()),
+                entry.dtype(), shape);
+  return Status::OK();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1056,6 +1467,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 }
 
 bool BundleReader::Contains(StringPiece key) {
+  if (!table_->KeyMayMatch(key)) return false;
   Seek(key);
   return Valid() && (this->key() == key);
 }
@@ -39,9 +39,11 @@ limitations under the License.
 //   reader.Lookup("name", &tensor);
 //
 // A tensor bundle can be built using BundleWriter.  Each BundleWriter builds a
-// single data file bundle.  Multiple bundles can then be merged by
-// MergeBundles() without reading and writing large chunk of data: it reads the
-// metadata files and outputs a single merged metadata.  Typical usage:
+// bundle of one data file by default, or of several data files written
+// concurrently with BundleWriter::Options::num_data_shards.  Multiple bundles
+// can then be merged by MergeBundles() without reading and writing large chunk
+// of data: it reads the metadata files and outputs a single merged metadata.
+// Typical usage:
 //
 //   worker 0:
 //     BundleWriter writer(env, "/fs/model/train/ckpt-step/tmp/worker0-step");
@@ -71,12 +73,14 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/table.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_slice_set.h"
@@ -107,10 +111,29 @@ extern const char* const kHeaderEntryKey;
 // All threads accessing the same BundleWriter must synchronize.
 class BundleWriter {
  public:
+  struct Options {
+    // The number of data files the tensors are spread across.  With more than
+    // one, each tensor is written to the data file with the fewest bytes so
+    // far, and the data files are written concurrently, on one thread each.
+    int num_data_shards = 1;
+
+    // The contents of the tensors of numeric types start at offsets of the
+    // data files that are multiples of this, padding them with zeros if
+    // needed.  With a multiple of Allocator::kAllocatorAlignment, they can be
+    // restored from memory mappings with BundleReader::LookupMapped().
+    int64 data_alignment = 1;
+  };
+
   BundleWriter(Env* env, StringPiece prefix);
+  BundleWriter(Env* env, StringPiece prefix, const Options& options);
+  ~BundleWriter();
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
+  //
+  // With several data files, the contents of "val" are written in the
+  // background, so they must not be modified until Finish() returns, and an
+  // error while writing them is returned by a later call.
   Status Add(StringPiece key, const Tensor& val);
 
   // Partitioned variables support.
@@ -139,14 +162,43 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  const Options options_;
+  // A data file being written.
+  struct DataShard {
+    string tmp_path;
+    mutex mu;
+    std::unique_ptr<FileOutputBuffer> out GUARDED_BY(mu);
+    int64 size GUARDED_BY(mu) = 0;  // Number of bytes written into out.
+    // Number of bytes of the tensors added to this data file so far, including
+    // those not written yet.
+    int64 added_bytes = 0;
+  };
+
+  // Appends "val" to the data file "shard_id", and fills in the location,
+  // size and checksum of "entry".
+  Status WriteEntry(const Tensor& val, int shard_id, BundleEntryProto* entry);
+
+  // Closes the data file "shard_id" and renames it to its final name, or
+  // deletes it if "status" is not OK.
+  Status FinishDataShard(int shard_id, const string& filename,
+                         const Status& status);
+
+  // Merges the status of the background writes into status_.
+  void UpdateStatusFromWrites();
+
   Env* const env_;  // Not owned.
   const string prefix_;
   const string tmp_metadata_path_;
-  const string tmp_data_path_;
-  std::unique_ptr<FileOutputBuffer> out_;
-  int64 size_;  // Number of bytes written into out_.
+  std::vector<std::unique_ptr<DataShard>> shards_;
+  // Writes the tensors in the background, if there are several data files.
+  std::unique_ptr<thread::ThreadPool> write_pool_;
+  // Entries are only added by the caller, and their nodes are stable, so the
+  // background writes fill in their entry without synchronization.
   std::map<string, BundleEntryProto> entries_;
   Status status_;
+  mutex mu_;
+  // The first error of the background writes.
+  Status write_status_ GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(BundleWriter);
 };
@@ -210,6 +262,32 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensors keyed by "keys" into "vals", like calling Lookup() on
+  // each of them, except that the contents of the non-partitioned tensors of
+  // numeric types are read concurrently on up to "num_threads" threads.  They
+  // are read with large reads aligned in the data files, directly into the
+  // buffers of "vals", which can thus be e.g. host memory pinned for GPU
+  // transfers.  Small tensors that are close together in their data file are
+  // read with one read into a scratch buffer instead.  The other tensors are
+  // read sequentially.
+  //
+  // On error, "vals" may contain nonsense data.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupMany(gtl::ArraySlice<string> keys, gtl::ArraySlice<Tensor*> vals,
+                    int num_threads) TF_MUST_USE_RESULT;
+
+  // Looks up the tensor keyed by "key" like Lookup(), except that "val" is not
+  // required to be allocated, and if the tensor is a non-partitioned tensor of
+  // a numeric type whose contents are suitably aligned in its data file (see
+  // BundleWriter::Options::data_alignment), "val" is set to a tensor that
+  // aliases a read-only memory mapping of the data file instead of a copy.
+  //
+  // Such tensors share their pages with the other mappings of the file (e.g.
+  // in other processes), outlive the reader, and must never be modified.  To
+  // not read in all their pages, their checksum is not validated.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -261,6 +339,15 @@ class BundleReader {
   Status GetBundleEntryProto(StringPiece key,
                              BundleEntryProto* entry) TF_MUST_USE_RESULT;
 
+  // Opens the data file "shard_id" if it has not been opened.
+  Status GetDataFile(int32 shard_id,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
+  // Maps the data file "shard_id" in memory if it has not been mapped.
+  Status GetMappedDataFile(int32 shard_id,
+                           std::shared_ptr<ReadOnlyMemoryRegion>* region)
+      TF_MUST_USE_RESULT;
+
   // Reads the tensor value described by the metadata proto "entry".
   // Usage for "val" follows the comment of "Lookup()".
   Status GetValue(const BundleEntryProto& entry,
@@ -283,6 +370,10 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // The memory mappings of the data files, shared with the tensors that alias
+  // them.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -581,6 +581,177 @@ TEST(TensorBundleTest, DirectoryStructure) {
                           "merged.data-00001-of-00002"});
 }
 
+TEST(TensorBundleTest, MultipleDataShards) {
+  Env* env = Env::Default();
+  BundleWriter::Options options;
+  options.num_data_shards = 3;
+  {
+    BundleWriter writer(env, Prefix("multi_shard"), options);
+    TF_EXPECT_OK(writer.Add("float_0", Constant_2x3<float>(0.)));
+    TF_EXPECT_OK(writer.Add("float_1", Constant(1.f, TensorShape({100}))));
+    TF_EXPECT_OK(writer.Add("int_2", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("string_3", Constant_2x3<string>("three")));
+    TF_EXPECT_OK(writer.Add("double_4", Constant_2x3<double>(4.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("multi_shard"), i, 3)));
+  }
+  {
+    BundleReader reader(env, Prefix("multi_shard"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "float_0", Constant_2x3<float>(0.));
+    Expect<float>(&reader, "float_1", Constant(1.f, TensorShape({100})));
+    Expect<int32>(&reader, "int_2", Constant_2x3<int32>(2));
+    Expect<string>(&reader, "string_3", Constant_2x3<string>("three"));
+    Expect<double>(&reader, "double_4", Constant_2x3<double>(4.));
+  }
+
+  // The data files without tensors are dropped.
+  options.num_data_shards = 4;
+  {
+    BundleWriter writer(env, Prefix("unused_shards"), options);
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.Add("bar", Constant_2x3<float>(2.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("unused_shards"), 0, 2)));
+  TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("unused_shards"), 1, 2)));
+  TF_ASSERT_OK(MergeBundles(env,
+                            {Prefix("multi_shard"), Prefix("unused_shards")},
+                            Prefix("merged_shards")));
+  {
+    BundleReader reader(env, Prefix("merged_shards"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "bar", Constant_2x3<float>(2.));
+    Expect<float>(&reader, "foo", Constant_2x3<float>(1.));
+    Expect<string>(&reader, "string_3", Constant_2x3<string>("three"));
+    Expect<double>(&reader, "double_4", Constant_2x3<double>(4.));
+  }
+  for (int i = 0; i < 5; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("merged_shards"), i, 5)));
+  }
+}
+
+TEST(TensorBundleTest, LookupMany) {
+  // Spans several read chunks, at an unaligned offset.
+  const Tensor large = test::AsTensor<float>(
+      std::vector<float>(5 << 20, 1.5f), TensorShape({5 << 20}));
+  {
+    BundleWriter writer(Env::Default(), Prefix("lookup_many"));
+    TF_EXPECT_OK(writer.Add("a_small", Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.Add("b_large", large));
+    TF_EXPECT_OK(writer.Add("c_string", Constant_2x3<string>("c")));
+    TF_EXPECT_OK(writer.AddSlice("d_sliced", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("0,2"),
+                                 Constant(4, TensorShape({2}))));
+    TF_EXPECT_OK(writer.AddSlice("d_sliced", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("2,2"),
+                                 Constant(5, TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("lookup_many"));
+  TF_ASSERT_OK(reader.status());
+  Tensor small(DT_FLOAT, TensorShape({2, 3}));
+  Tensor large_val(DT_FLOAT, large.shape());
+  Tensor string_val(DT_STRING, TensorShape({2, 3}));
+  Tensor sliced_val(DT_INT32, TensorShape({4}));
+  Tensor unallocated;
+  TF_ASSERT_OK(reader.LookupMany(
+      {"c_string", "b_large", "a_small", "d_sliced", "a_small"},
+      {&string_val, &large_val, &small, &sliced_val, &unallocated},
+      4 /* num_threads */));
+  test::ExpectTensorEqual<float>(Constant_2x3<float>(1.), small);
+  test::ExpectTensorEqual<float>(large, large_val);
+  test::ExpectTensorEqual<string>(Constant_2x3<string>("c"), string_val);
+  test::ExpectTensorEqual<int32>(test::AsTensor<int32>({4, 4, 5, 5}),
+                                 sliced_val);
+  test::ExpectTensorEqual<float>(Constant_2x3<float>(1.), unallocated);
+
+  Tensor wrong_size(DT_FLOAT, TensorShape({2, 2}));
+  EXPECT_TRUE(errors::IsDataLoss(
+      reader.LookupMany({"a_small"}, {&wrong_size}, 4 /* num_threads */)));
+  EXPECT_TRUE(errors::IsNotFound(
+      reader.LookupMany({"nonexistent"}, {&small}, 4 /* num_threads */)));
+}
+
+TEST(TensorBundleTest, LookupManyCoalescesSmallTensors) {
+  const int kNumTensors = 100;
+  std::vector<string> keys;
+  {
+    BundleWriter writer(Env::Default(), Prefix("lookup_many_small"));
+    for (int i = 0; i < kNumTensors; ++i) {
+      keys.push_back(strings::StrCat("small_", 1000 + i));
+      TF_EXPECT_OK(writer.Add(keys.back(), Constant_2x3<int32>(i)));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("lookup_many_small"));
+  TF_ASSERT_OK(reader.status());
+  // Asks for every other tensor in reverse order, so that the reads skip
+  // gaps and the tensors are not in the order of the data file.
+  std::vector<string> lookup_keys;
+  std::vector<Tensor> vals;
+  for (int i = kNumTensors - 1; i >= 0; i -= 2) {
+    lookup_keys.push_back(keys[i]);
+    vals.emplace_back(DT_INT32, TensorShape({2, 3}));
+  }
+  std::vector<Tensor*> val_ptrs;
+  for (Tensor& val : vals) val_ptrs.push_back(&val);
+  TF_ASSERT_OK(reader.LookupMany(lookup_keys, val_ptrs, 4 /* num_threads */));
+  for (size_t i = 0; i < vals.size(); ++i) {
+    test::ExpectTensorEqual<int32>(
+        Constant_2x3<int32>(kNumTensors - 1 - 2 * i), vals[i]);
+  }
+  // Missing keys are rejected by the bloom filter of the metadata table.
+  EXPECT_FALSE(reader.Contains("small_999"));
+  EXPECT_TRUE(reader.Contains("small_1042"));
+}
+
+TEST(TensorBundleTest, LookupMapped) {
+  Env* env = Env::Default();
+  BundleWriter::Options options;
+  options.data_alignment = 64;
+  {
+    BundleWriter writer(env, Prefix("mapped"), options);
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<string>("x")));
+    TF_EXPECT_OK(writer.Add("c", Constant_2x3<int32>(3)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // "a" at offset 0, "b" at offset 24, and "c" padded to offset 64.
+  uint64 data_file_size;
+  TF_ASSERT_OK(
+      env->GetFileSize(DataFilename(Prefix("mapped"), 0, 1), &data_file_size));
+  EXPECT_EQ(64 + Constant_2x3<int32>(3).TotalBytes(), data_file_size);
+
+  Tensor a, b, c;
+  {
+    BundleReader reader(env, Prefix("mapped"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.LookupMapped("a", &a));
+    TF_ASSERT_OK(reader.LookupMapped("b", &b));
+    TF_ASSERT_OK(reader.LookupMapped("c", &c));
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("d", &a)));
+  }
+  // The tensors outlive the reader.
+  test::ExpectTensorEqual<float>(Constant_2x3<float>(1.), a);
+  test::ExpectTensorEqual<string>(Constant_2x3<string>("x"), b);
+  test::ExpectTensorEqual<int32>(Constant_2x3<int32>(3), c);
+
+  // Unaligned tensors are copied.
+  {
+    BundleWriter writer(env, Prefix("unaligned"));
+    TF_EXPECT_OK(writer.Add("a", Constant(1.f, TensorShape({3}))));
+    TF_EXPECT_OK(writer.Add("b", Constant(2.f, TensorShape({3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(env, Prefix("unaligned"));
+  TF_ASSERT_OK(reader.status());
+  TF_ASSERT_OK(reader.LookupMapped("b", &b));
+  test::ExpectTensorEqual<float>(Constant(2.f, TensorShape({3})), b);
+}
+
 TEST(TensorBundleTest, Error) {
   {  // Dup keys.
     BundleWriter writer(Env::Default(), Prefix("dup"));
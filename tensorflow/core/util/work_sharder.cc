@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/util/work_sharder.h"
 
+#include <algorithm>
+#include <memory>
+
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
@@ -74,4 +78,89 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
   counter.Wait();
 }
 
+void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
+           int64 cost_per_unit, std::function<void(int64, int64)> work,
+           CancellationManager* cancellation_manager) {
+  if (cancellation_manager == nullptr) {
+    Shard(max_parallelism, workers, total, cost_per_unit, std::move(work));
+    return;
+  }
+  Shard(max_parallelism, workers, total, cost_per_unit,
+        [&work, cancellation_manager](int64 start, int64 limit) {
+          if (!cancellation_manager->IsCancelled()) work(start, limit);
+        });
+}
+
+ShardCostModel::ShardCostModel(int64 initial_cost_per_unit)
+    : cost_per_unit_(std::max<int64>(1, initial_cost_per_unit)) {}
+
+void ShardCostModel::Update(int64 units, int64 nanos) {
+  if (units <= 0) return;
+  // A sample weighs a quarter, so that a few calls adapt the estimate while
+  // a single slow call, e.g. a preempted one, does not dominate it. Racing
+  // updates may drop a sample, which is fine for an estimate.
+  const int64 measured = nanos / units;
+  const int64 old_cost = cost_per_unit_.load(std::memory_order_relaxed);
+  cost_per_unit_.store(std::max<int64>(1, old_cost + (measured - old_cost) / 4),
+                       std::memory_order_relaxed);
+}
+
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64 total, ShardCostModel* cost_model,
+                   std::function<void(int64, int64)> work) {
+  CHECK_GE(total, 0);
+  if (total == 0) {
+    return;
+  }
+  if (workers->CurrentThreadId() >= 0) {
+    // Nested in a shard of the same pool.
+    max_parallelism = 1;
+  }
+  Env* env = Env::Default();
+  std::atomic<int64> elapsed_micros(0);
+  Shard(max_parallelism, workers, total, cost_model->cost_per_unit(),
+        [&work, &elapsed_micros, env](int64 start, int64 limit) {
+          const uint64 start_micros = env->NowMicros();
+          work(start, limit);
+          elapsed_micros += env->NowMicros() - start_micros;
+        });
+  cost_model->Update(total, 1000 * elapsed_micros.load());
+}
+
+void ParallelForEach(int max_parallelism, thread::ThreadPool* workers,
+                     int64 total, std::function<void(int64)> fn) {
+  CHECK_GE(total, 0);
+  const int64 num_threads =
+      workers == nullptr
+          ? 1
+          : std::min<int64>(total, std::min(max_parallelism,
+                                            workers->NumThreads() + 1));
+  if (num_threads <= 1) {
+    for (int64 i = 0; i < total; ++i) fn(i);
+    return;
+  }
+  struct State {
+    State(int64 total, std::function<void(int64)> fn)
+        : total(total), fn(std::move(fn)), pending(static_cast<int>(total)) {}
+    void Work() {
+      for (int64 i = next.fetch_add(1); i < total; i = next.fetch_add(1)) {
+        fn(i);
+        pending.DecrementCount();
+      }
+    }
+    const int64 total;
+    const std::function<void(int64)> fn;
+    std::atomic<int64> next{0};
+    BlockingCounter pending;
+  };
+  // Worker threads that start after the last call has been claimed return
+  // without touching "fn", but may still run after this function returns.
+  auto state = std::make_shared<State>(total, std::move(fn));
+  for (int64 i = 1; i < num_threads; ++i) {
+    workers->Schedule([state]() { state->Work(); });
+  }
+  state->Work();
+  state->pending.Wait();
+}
+
 }  // end namespace tensorflow
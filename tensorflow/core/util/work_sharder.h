@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_UTIL_WORK_SHARDER_H_
 #define TENSORFLOW_UTIL_WORK_SHARDER_H_
 
+#include <atomic>
 #include <functional>
 
+#include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -48,6 +50,59 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
            int64 cost_per_unit, std::function<void(int64, int64)> work);
 
+// Like Shard() above, but the shards that have not started when
+// "cancellation_manager" is cancelled are skipped, so that a cancelled step
+// releases the workers once the shards in flight are done. The work may
+// then be incomplete: callers must check for cancellation after Shard()
+// returns. "cancellation_manager" may be nullptr.
+void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
+           int64 cost_per_unit, std::function<void(int64, int64)> work,
+           CancellationManager* cancellation_manager);
+
+// Learns the cost per unit of one call site of AdaptiveShard() from the time
+// its shards take, for work whose cost is hard to estimate by hand. It is
+// meant to be a static shared by all the calls of the call site, e.g.
+//
+//   static ShardCostModel* cost_model = new ShardCostModel(1000);
+//   AdaptiveShard(max_parallelism, workers, total, cost_model, work);
+//
+// The estimate starts at "initial_cost_per_unit" and follows the measured
+// nanoseconds per unit with an exponential moving average. Thread-safe.
+class ShardCostModel {
+ public:
+  explicit ShardCostModel(int64 initial_cost_per_unit);
+
+  int64 cost_per_unit() const {
+    return cost_per_unit_.load(std::memory_order_relaxed);
+  }
+
+  // Records that "units" units of work took "nanos" nanoseconds.
+  void Update(int64 units, int64 nanos);
+
+ private:
+  std::atomic<int64> cost_per_unit_;
+};
+
+// Like Shard(), with the cost per unit taken from "cost_model" and the
+// measured cost of the shards recorded into it. When called from a thread of
+// "workers", e.g. from a shard of an enclosing Shard(), the work runs inline,
+// since the enclosing shards already keep the workers busy.
+//
+// REQUIRES: cost_model != nullptr
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64 total, ShardCostModel* cost_model,
+                   std::function<void(int64, int64)> work);
+
+// Runs "fn(i)" for every i in [0, total) on the calling thread and on up to
+// "max_parallelism" - 1 threads of "workers", each claiming the next i, and
+// returns once all calls have returned. Unlike Shard(), the calling thread
+// only waits for the calls that have already started, so this does not
+// deadlock when called from a thread of "workers" while all of them are
+// busy. Meant for coarse units of work. "workers" may be nullptr, in which
+// case every call runs on the calling thread.
+void ParallelForEach(int max_parallelism, thread::ThreadPool* workers,
+                     int64 total, std::function<void(int64)> fn);
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_UTIL_WORK_SHARDER_H_
@@ -76,6 +76,113 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(Shard, Cancellation) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  const int64 total = 1000;
+  for (auto workers : {1, 4}) {
+    CancellationManager cancellation_manager;
+    std::atomic<int64> num_elements(0);
+    auto work = [&num_elements](int64 start, int64 limit) {
+      num_elements += limit - start;
+    };
+    Shard(workers, &threads, total, 100000, work, &cancellation_manager);
+    EXPECT_EQ(num_elements.load(), total);
+
+    // Once cancelled, no shard is started.
+    num_elements = 0;
+    cancellation_manager.StartCancel();
+    Shard(workers, &threads, total, 100000, work, &cancellation_manager);
+    EXPECT_EQ(num_elements.load(), 0);
+
+    // Without a cancellation manager all the work is done.
+    Shard(workers, &threads, total, 100000, work, nullptr);
+    EXPECT_EQ(num_elements.load(), total);
+  }
+}
+
+TEST(ShardCostModel, Update) {
+  ShardCostModel cost_model(100);
+  EXPECT_EQ(100, cost_model.cost_per_unit());
+  // Units that take 1us each pull the estimate towards 1000ns.
+  for (int i = 0; i < 50; ++i) {
+    cost_model.Update(10, 10000);
+  }
+  EXPECT_NEAR(1000, cost_model.cost_per_unit(), 10);
+  // Ignores empty work, and keeps the estimate positive.
+  cost_model.Update(0, 0);
+  EXPECT_NEAR(1000, cost_model.cost_per_unit(), 10);
+  for (int i = 0; i < 100; ++i) {
+    cost_model.Update(10, 0);
+  }
+  EXPECT_LE(1, cost_model.cost_per_unit());
+  EXPECT_EQ(1, ShardCostModel(0).cost_per_unit());
+}
+
+TEST(AdaptiveShard, Basic) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  for (auto workers : {0, 1, 4, 16}) {
+    for (auto total : {0, 1, 7, 1000, 9999}) {
+      ShardCostModel cost_model(1000);
+      std::vector<std::atomic<int>> done(total);
+      for (auto& d : done) d = 0;
+      AdaptiveShard(workers, &threads, total, &cost_model,
+                    [&done](int64 start, int64 limit) {
+                      for (; start < limit; ++start) ++done[start];
+                    });
+      for (const auto& d : done) EXPECT_EQ(1, d.load());
+    }
+  }
+}
+
+TEST(AdaptiveShard, NestedRunsInline) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  ShardCostModel outer_cost(1000000);
+  ShardCostModel inner_cost(1000000);
+  std::atomic<int64> num_elements(0);
+  AdaptiveShard(4, &threads, 4, &outer_cost, [&](int64 start, int64 limit) {
+    for (; start < limit; ++start) {
+      std::atomic<int> num_inner_shards(0);
+      AdaptiveShard(4, &threads, 100, &inner_cost,
+                    [&](int64 inner_start, int64 inner_limit) {
+                      num_elements += inner_limit - inner_start;
+                      ++num_inner_shards;
+                    });
+      // The outer shard run by the calling thread is not nested.
+      if (threads.CurrentThreadId() >= 0) {
+        EXPECT_EQ(1, num_inner_shards.load());
+      }
+    }
+  });
+  EXPECT_EQ(400, num_elements.load());
+}
+
+TEST(ParallelForEach, Basic) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  for (auto max_parallelism : {0, 1, 4, 32}) {
+    for (auto total : {0, 1, 7, 1000}) {
+      std::vector<std::atomic<int>> done(total);
+      for (auto& d : done) d = 0;
+      ParallelForEach(max_parallelism, &threads, total,
+                      [&done](int64 i) { ++done[i]; });
+      for (const auto& d : done) EXPECT_EQ(1, d.load());
+    }
+  }
+  std::vector<int> done(10, 0);
+  ParallelForEach(4, nullptr, done.size(), [&done](int64 i) { ++done[i]; });
+  for (int d : done) EXPECT_EQ(1, d);
+}
+
+TEST(ParallelForEach, NestedInBusyWorkers) {
+  // Every worker runs an outer call that waits on inner calls, which would
+  // deadlock if the inner calls had to wait for free workers.
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  std::atomic<int64> num_inner(0);
+  ParallelForEach(5, &threads, 5, [&](int64 outer) {
+    ParallelForEach(5, &threads, 100, [&](int64 inner) { ++num_inner; });
+  });
+  EXPECT_EQ(500, num_inner.load());
+}
+
 void BM_Sharding(int iters, int arg) {
   thread::ThreadPool threads(Env::Default(), "test", 16);
   const int64 total = 1LL << 30;
@@ -87,5 +194,30 @@ void BM_Sharding(int iters, int arg) {
 }
 BENCHMARK(BM_Sharding)->Range(1, 128);
 
+// Sums a vector by shards, with a fixed cost per unit that is off by "arg"
+// orders of magnitude, or with the adaptive cost when "arg" is -1.
+void BM_ShardSum(int iters, int arg) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  const int64 total = 1 << 16;
+  std::vector<float> values(total, 1.0f);
+  std::atomic<int64> sum(0);
+  auto work = [&values, &sum](int64 start, int64 limit) {
+    float partial = 0;
+    for (; start < limit; ++start) partial += values[start];
+    sum += static_cast<int64>(partial);
+  };
+  ShardCostModel cost_model(1);
+  int64 cost_per_unit = 1;
+  for (int i = 0; i < arg; ++i) cost_per_unit *= 10;
+  while (iters-- > 0) {
+    if (arg < 0) {
+      AdaptiveShard(16, &threads, total, &cost_model, work);
+    } else {
+      Shard(16, &threads, total, cost_per_unit, work);
+    }
+  }
+}
+BENCHMARK(BM_ShardSum)->Arg(-1)->Arg(0)->Arg(2)->Arg(4);
+
 }  // namespace
 }  // namespace tensorflow
@@ -279,6 +279,62 @@ public final class Tensor<T> implements AutoCloseable {
     return t;
   }
 
+  /**
+   * Creates a Tensor of any type that uses the memory of the given direct buffer instead of copying
+   * it.
+   *
+   * <p>The data must be encoded as for {@link #create(Class, long[], ByteBuffer)}, starting at the
+   * current position of {@code data}. The tensor keeps the buffer reachable until the tensor and
+   * every computation using it release it, so its memory is still freed by the JVM. Changes to the
+   * buffer are visible to the tensor, so it should not be modified while the tensor is in use.
+   *
+   * <p>The data is copied once if its address is not aligned as TensorFlow requires. Buffers from
+   * {@link #allocateAlignedBuffer(int)} are always wrapped without a copy.
+   *
+   * @param <T> the tensor element type
+   * @param type the tensor element type, represented as a class object.
+   * @param shape the tensor shape.
+   * @param data a direct buffer containing the tensor data.
+   * @throws IllegalArgumentException If {@code data} is not a direct buffer, or if the tensor
+   *     datatype or shape is not compatible with the buffer
+   */
+  public static <T> Tensor<T> wrap(Class<T> type, long[] shape, ByteBuffer data) {
+    if (!data.isDirect()) {
+      throw new IllegalArgumentException("only direct ByteBuffers can be wrapped by a Tensor");
+    }
+    DataType dtype = DataType.fromClass(type);
+    int nremaining = data.remaining();
+    if (dtype != DataType.STRING) {
+      int elemBytes = elemByteSize(dtype);
+      if (data.remaining() % elemBytes != 0) {
+        throw new IllegalArgumentException(
+            String.format(
+                "ByteBuffer with %d bytes is not compatible with a %s Tensor (%d bytes/element)",
+                data.remaining(), dtype.toString(), elemBytes));
+      }
+      nremaining = data.remaining() / elemBytes;
+      if (nremaining != numElements(shape)) {
+        throw incompatibleBuffer(nremaining, shape);
+      }
+    }
+    Tensor<T> t = new Tensor<T>(dtype);
+    t.shapeCopy = Arrays.copyOf(shape, shape.length);
+    t.nativeHandle =
+        allocateWrapping(t.dtype.c(), t.shapeCopy, data, data.position(), data.remaining());
+    return t;
+  }
+
+  /**
+   * Allocates a direct buffer of {@code capacity} bytes, in native byte order, that {@link
+   * #wrap(Class, long[], ByteBuffer)} can use without copying.
+   */
+  public static ByteBuffer allocateAlignedBuffer(int capacity) {
+    ByteBuffer buf = ByteBuffer.allocateDirect(capacity + MAX_ALIGNMENT);
+    int offset = alignmentOffset(buf, MAX_ALIGNMENT);
+    buf.position(offset).limit(offset + capacity);
+    return buf.slice().order(ByteOrder.nativeOrder());
+  }
+
   /**
    * Returns this Tensor object with the type {@code Tensor<U>}. This method is useful when given a
    * value of type {@code Tensor<?>}.
@@ -538,6 +594,18 @@ public final class Tensor<T> implements AutoCloseable {
     dst.put(src);
   }
 
+  /**
+   * Returns a read-only view of the tensor data, in native byte order, that refers to the native
+   * memory of the tensor instead of copying it.
+   *
+   * <p>The data is encoded as per the specification of the TensorFlow <a
+   * href="https://www.tensorflow.org/code/tensorflow/c/c_api.h">C API</a>. The buffer must not be
+   * used after {@link #close()} is called, since that frees the memory it refers to.
+   */
+  public ByteBuffer asReadOnlyBuffer() {
+    return buffer().asReadOnlyBuffer().order(ByteOrder.nativeOrder());
+  }
+
   /** Returns a string describing the type and shape of the Tensor. */
   @Override
   public String toString() {
@@ -561,6 +629,9 @@ public final class Tensor<T> implements AutoCloseable {
     return nativeHandle;
   }
 
+  // The largest alignment that TensorFlow requires of tensor data.
+  private static final int MAX_ALIGNMENT = 64;
+
   private long nativeHandle;
   private DataType dtype;
   private long[] shapeCopy = null;
@@ -759,6 +830,11 @@ public final class Tensor<T> implements AutoCloseable {
 
   private static native long allocate(int dtype, long[] shape, long byteSize);
 
+  private static native long allocateWrapping(
+      int dtype, long[] shape, ByteBuffer data, int offset, long byteSize);
+
+  private static native int alignmentOffset(ByteBuffer data, int alignment);
+
   private static native long allocateScalarBytes(byte[] value);
 
   private static native long allocateNonScalarBytes(long[] shape, Object[] value);
@@ -20,6 +20,7 @@ limitations under the License.
 #include <string.h>
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/c/c_api.h"
 #include "tensorflow/java/src/main/native/exception_jni.h"
@@ -321,39 +322,69 @@ void readNDStringArray(JNIEnv* env, StringTensorReader* reader, int dims_left,
     if (TF_GetCode(status) != TF_OK) return;
   }
 }
-}  // namespace
 
-JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
-                                                            jclass clazz,
-                                                            jint dtype,
-                                                            jlongArray shape,
-                                                            jlong sizeInBytes) {
+// Copies the Java array 'shape' into 'dims'.
+void copyDims(JNIEnv* env, jlongArray shape, std::vector<int64_t>* dims) {
   int num_dims = static_cast<int>(env->GetArrayLength(shape));
-  jlong* dims = nullptr;
-  if (num_dims > 0) {
-    jboolean is_copy;
-    dims = env->GetLongArrayElements(shape, &is_copy);
-  }
+  dims->resize(num_dims);
+  if (num_dims == 0) return;
+  jboolean is_copy;
+  jlong* elems = env->GetLongArrayElements(shape, &is_copy);
   static_assert(sizeof(jlong) == sizeof(int64_t),
                 "Java long is not compatible with the TensorFlow C API");
   // On some platforms "jlong" is a "long" while "int64_t" is a "long long".
   //
-  // Thus, static_cast<int64_t*>(dims) will trigger a compiler error:
+  // Thus, static_cast<int64_t*>(elems) will trigger a compiler error:
   // static_cast from 'jlong *' (aka 'long *') to 'int64_t *' (aka 'long long
   // *') is not allowed
   //
   // Since this array is typically very small, use the guaranteed safe scheme of
   // creating a copy.
-  int64_t* dims_copy = new int64_t[num_dims];
   for (int i = 0; i < num_dims; ++i) {
-    dims_copy[i] = static_cast<int64_t>(dims[i]);
-  }
-  TF_Tensor* t = TF_AllocateTensor(static_cast<TF_DataType>(dtype), dims_copy,
-                                   num_dims, static_cast<size_t>(sizeInBytes));
-  delete[] dims_copy;
-  if (dims != nullptr) {
-    env->ReleaseLongArrayElements(shape, dims, JNI_ABORT);
+    (*dims)[i] = static_cast<int64_t>(elems[i]);
   }
+  env->ReleaseLongArrayElements(shape, elems, JNI_ABORT);
+}
+
+// Keeps the direct ByteBuffer wrapped by a TF_Tensor reachable, so that the
+// JVM does not free its memory before the tensor is deleted.
+struct WrappedBuffer {
+  JavaVM* jvm;
+  jobject buffer;  // A global reference.
+};
+
+void releaseWrappedBuffer(void* data, size_t len, void* arg) {
+  WrappedBuffer* wrapped = static_cast<WrappedBuffer*>(arg);
+  // The last reference to the tensor may be dropped by a TensorFlow thread,
+  // which has to be attached to the JVM to delete the global reference.
+  JNIEnv* env = nullptr;
+  bool attached = false;
+  if (wrapped->jvm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) ==
+      JNI_EDETACHED) {
+#ifdef __ANDROID__
+    attached = wrapped->jvm->AttachCurrentThread(&env, nullptr) == JNI_OK;
+#else
+    attached = wrapped->jvm->AttachCurrentThread(reinterpret_cast<void**>(&env),
+                                                 nullptr) == JNI_OK;
+#endif
+    if (!attached) env = nullptr;
+  }
+  if (env != nullptr) env->DeleteGlobalRef(wrapped->buffer);
+  if (attached) wrapped->jvm->DetachCurrentThread();
+  delete wrapped;
+}
+}  // namespace
+
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
+                                                            jclass clazz,
+                                                            jint dtype,
+                                                            jlongArray shape,
+                                                            jlong sizeInBytes) {
+  std::vector<int64_t> dims;
+  copyDims(env, shape, &dims);
+  TF_Tensor* t = TF_AllocateTensor(static_cast<TF_DataType>(dtype), dims.data(),
+                                   static_cast<int>(dims.size()),
+                                   static_cast<size_t>(sizeInBytes));
   if (t == nullptr) {
     throwException(env, kNullPointerException,
                    "unable to allocate memory for the Tensor");
@@ -362,6 +393,44 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
   return reinterpret_cast<jlong>(t);
 }
 
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateWrapping(
+    JNIEnv* env, jclass clazz, jint dtype, jlongArray shape, jobject buffer,
+    jint offset, jlong sizeInBytes) {
+  char* data = static_cast<char*>(env->GetDirectBufferAddress(buffer));
+  if (data == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "only direct ByteBuffers can be wrapped by a Tensor");
+    return 0;
+  }
+  JavaVM* jvm = nullptr;
+  if (env->GetJavaVM(&jvm) != JNI_OK) {
+    throwException(env, kIllegalStateException, "unable to get the JavaVM");
+    return 0;
+  }
+  std::vector<int64_t> dims;
+  copyDims(env, shape, &dims);
+  WrappedBuffer* wrapped = new WrappedBuffer{jvm, env->NewGlobalRef(buffer)};
+  // TF_NewTensor copies the data, and releases the buffer right away, if it
+  // is not aligned as TensorFlow requires.
+  TF_Tensor* t = TF_NewTensor(static_cast<TF_DataType>(dtype), dims.data(),
+                              static_cast<int>(dims.size()), data + offset,
+                              static_cast<size_t>(sizeInBytes),
+                              releaseWrappedBuffer, wrapped);
+  return reinterpret_cast<jlong>(t);
+}
+
+JNIEXPORT jint JNICALL Java_org_tensorflow_Tensor_alignmentOffset(
+    JNIEnv* env, jclass clazz, jobject buffer, jint alignment) {
+  void* data = env->GetDirectBufferAddress(buffer);
+  if (data == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "alignmentOffset requires a direct ByteBuffer");
+    return 0;
+  }
+  const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+  return static_cast<jint>((alignment - address % alignment) % alignment);
+}
+
 JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateScalarBytes(
     JNIEnv* env, jclass clazz, jbyteArray value) {
   // TF_STRING tensors are encoded with a table of 8-byte offsets followed by
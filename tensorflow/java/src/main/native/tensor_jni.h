@@ -31,6 +31,24 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv *, jclass,
                                                             jint, jlongArray,
                                                             jlong);
 
+/*
+ * Class:     org_tensorflow_Tensor
+ * Method:    allocateWrapping
+ * Signature: (I[JLjava/nio/ByteBuffer;IJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateWrapping(
+    JNIEnv *, jclass, jint, jlongArray, jobject, jint, jlong);
+
+/*
+ * Class:     org_tensorflow_Tensor
+ * Method:    alignmentOffset
+ * Signature: (Ljava/nio/ByteBuffer;I)I
+ */
+JNIEXPORT jint JNICALL Java_org_tensorflow_Tensor_alignmentOffset(JNIEnv *,
+                                                                  jclass,
+                                                                  jobject,
+                                                                  jint);
+
 /*
  * Class:     org_tensorflow_Tensor
  * Method:    allocateScalarBytes
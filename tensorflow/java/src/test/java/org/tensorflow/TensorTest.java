@@ -519,6 +519,46 @@ public class TensorTest {
     }
   }
 
+  @Test
+  public void wrapDirectBuffer() {
+    ByteBuffer buf = Tensor.allocateAlignedBuffer(4 * 4);
+    buf.asFloatBuffer().put(new float[] {1, 2, 3, 4});
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {2, 2}, buf)) {
+      assertArrayEquals(new float[][] {{1, 2}, {3, 4}}, t.copyTo(new float[2][2]));
+      // The tensor refers to the memory of the buffer instead of a copy.
+      buf.putFloat(0, 5);
+      assertArrayEquals(new float[][] {{5, 2}, {3, 4}}, t.copyTo(new float[2][2]));
+    }
+  }
+
+  @Test
+  public void wrapIncompatibleBuffer() {
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {2}, ByteBuffer.allocate(8))) {
+      fail("non-direct ByteBuffer wrapped");
+    } catch (IllegalArgumentException e) {
+      // The expected exception
+    }
+    ByteBuffer buf = Tensor.allocateAlignedBuffer(8);
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {3}, buf)) {
+      fail("incompatible shape wrapped");
+    } catch (IllegalArgumentException e) {
+      // The expected exception
+    }
+  }
+
+  @Test
+  public void asReadOnlyBuffer() {
+    final int[] ints = {1, 2, 3};
+    try (Tensor<Integer> t = Tensors.create(ints)) {
+      ByteBuffer buf = t.asReadOnlyBuffer();
+      assertTrue(buf.isReadOnly());
+      assertEquals(ByteOrder.nativeOrder(), buf.order());
+      int[] got = new int[ints.length];
+      buf.asIntBuffer().get(got);
+      assertArrayEquals(ints, got);
+    }
+  }
+
   @Test
   public void fromHandle() {
     // fromHandle is a package-visible method intended for use when the C TF_Tensor object has been
@@ -29,8 +29,12 @@ static std::vector<string> ListDevices(TF_Status* out_status) {
   std::vector<string> output;
   SessionOptions options;
   std::vector<Device*> devices;
-  Status status = DeviceFactory::AddDevices(
-      options, "" /* name_prefix */, &devices);
+  Status status;
+  // Creating the devices initializes the GPUs, which can take seconds, so
+  // other Python threads are allowed to run meanwhile.
+  Py_BEGIN_ALLOW_THREADS;
+  status = DeviceFactory::AddDevices(options, "" /* name_prefix */, &devices);
+  Py_END_ALLOW_THREADS;
   if (!status.ok()) {
     Set_TF_Status_from_Status(out_status, status);
   }
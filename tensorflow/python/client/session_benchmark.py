@@ -18,12 +18,14 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import threading
 import time
 
 import numpy as np
 
 from tensorflow.python.client import session
 from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import importer
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import random_ops
@@ -174,6 +176,66 @@ class SessionBenchmark(test.Benchmark):
     print("%s %f" % (name, np.median(times)))
     self.report_benchmark(iters=1, wall_time=np.median(times), name=name)
 
+  def _benchmarkRunOpConcurrentGraphConstruction(self, name, target, iters,
+                                                 num_ops):
+    """Runs a microbenchmark to measure the cost of running an op.
+
+    Reports the median cost of running a trivial (Variable) op while another
+    thread repeatedly imports a graph of `num_ops` ops and runs it in a new
+    session, which exercises the graph construction and session setup paths
+    that must not hold the GIL for long.
+
+    Args:
+      name: A human-readable name for logging the output.
+      target: The session target to use for the benchmark.
+      iters: The number of iterations to perform.
+      num_ops: The number of ops in the graph built by the other thread.
+    """
+    with ops.Graph().as_default() as g:
+      x = array_ops.placeholder(dtypes.float32, shape=[])
+      y = x
+      for _ in xrange(num_ops):
+        y = array_ops.identity(y)
+    graph_def = g.as_graph_def()
+
+    stop = threading.Event()
+    num_graphs = [0]
+
+    def build_graphs():
+      while not stop.is_set():
+        with ops.Graph().as_default():
+          imported_x, imported_y = importer.import_graph_def(
+              graph_def, return_elements=[x.name, y.name], name="")
+          with session.Session(target) as sess:
+            sess.run(imported_y, feed_dict={imported_x: 1.0})
+        num_graphs[0] += 1
+
+    times = []
+    with ops.Graph().as_default():
+      v = variables.Variable(random_ops.random_normal([]))
+      with session.Session(target) as sess:
+        sess.run(v.initializer)
+        runner = sess.make_callable(v.op)
+        runner()  # Warm-up run.
+        builder = threading.Thread(target=build_graphs)
+        builder.start()
+        try:
+          for _ in xrange(iters):
+            start_time = time.time()
+            runner()
+            end_time = time.time()
+            times.append(end_time - start_time)
+        finally:
+          stop.set()
+          builder.join()
+    print("%s %f (%d graphs built)" % (name, np.median(times), num_graphs[0]))
+    self.report_benchmark(
+        iters=1,
+        wall_time=np.median(times),
+        extras={"max_wall_time": np.max(times),
+                "graphs_built": num_graphs[0]},
+        name=name)
+
   def benchmarkGrpcSession(self):
     server = server_lib.Server.create_local_server()
     self._benchmarkFeed("benchmark_session_feed_grpc_4B", server.target, 1,
@@ -213,6 +275,8 @@ class SessionBenchmark(test.Benchmark):
     self._benchmarkRunOp("benchmark_session_runop_direct", "", 200000)
     self._benchmarkRunOpPrebuilt("benchmark_session_runopprebuilt_direct", "",
                                  200000)
+    self._benchmarkRunOpConcurrentGraphConstruction(
+        "benchmark_session_runop_concurrent_graph_direct", "", 20000, 1000)
 
 
 if __name__ == "__main__":
@@ -1221,6 +1221,20 @@ class SessionTest(test_util.TensorFlowTestCase):
           self.assertAllEqual(np_array, out_v)
           self.assertAllEqual(np_array, feed_v)
 
+  def testFeedReadOnlyArray(self):
+    with session.Session() as sess:
+      feed_t = array_ops.placeholder(dtype=dtypes.float32, shape=[3, 4])
+      out_t = math_ops.add(feed_t, 1.0)
+      np_array = np.arange(12, dtype=np.float32).reshape([3, 4])
+      np_array.setflags(write=False)
+      self.assertAllEqual(np_array + 1.0,
+                          sess.run(out_t, feed_dict={feed_t: np_array}))
+      self.assertAllEqual(np_array,
+                          sess.run(feed_t, feed_dict={feed_t: np_array}))
+      # The fed buffer is borrowed, so the ops must not have written to it.
+      self.assertAllEqual(np.arange(12, dtype=np.float32).reshape([3, 4]),
+                          np_array)
+
   def testMakeCallableOnTensorWithRunOptions(self):
     with session.Session() as sess:
       a = constant_op.constant(42.0)
@@ -161,6 +161,25 @@ class TextLineDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(iterator.get_next())
 
+  def testTextLineDatasetReadahead(self):
+    for compression_type in [None, "GZIP"]:
+      test_filenames = self._createFiles(
+          2, 5, crlf=True, compression_type=compression_type)
+      repeat_dataset = readers.TextLineDataset(
+          test_filenames,
+          compression_type=compression_type,
+          buffer_size=10,
+          num_readahead_buffers=3)
+      iterator = repeat_dataset.make_one_shot_iterator()
+
+      with self.test_session() as sess:
+        for j in range(2):
+          for i in range(5):
+            self.assertEqual(self._lineText(j, i),
+                             sess.run(iterator.get_next()))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(iterator.get_next())
+
 
 class FixedLengthRecordReaderTest(test.TestCase):
 
@@ -725,6 +744,21 @@ class TFRecordDatasetTest(test.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         sess.run(iterator.get_next())
 
+  def testReadWithReadahead(self):
+    for buffer_size in [1, 7, 2**20]:
+      d = readers.TFRecordDataset(
+          self.test_filenames,
+          buffer_size=buffer_size,
+          num_readahead_buffers=4)
+      iterator = d.make_one_shot_iterator()
+      with self.test_session() as sess:
+        for j in range(self._num_files):
+          for i in range(self._num_records):
+            self.assertAllEqual(self._record(j, i),
+                                sess.run(iterator.get_next()))
+        with self.assertRaises(errors.OutOfRangeError):
+          sess.run(iterator.get_next())
+
 
 if __name__ == "__main__":
   test.main()
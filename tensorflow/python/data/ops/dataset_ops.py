@@ -610,9 +610,12 @@ class Dataset(object):
     """Caches the elements in this dataset.
 
     Args:
-      filename: A `tf.string` scalar `tf.Tensor`, representing the name of a
-        directory on the filesystem to use for caching tensors in this Dataset.
+      filename: A `tf.string` scalar `tf.Tensor`, representing the prefix of
+        the files on the filesystem to use for caching tensors in this Dataset.
         If a filename is not provided, the dataset will be cached in memory.
+        Iterators over the shards of a pipeline may write the same cache
+        concurrently, and iterators that read an existing cache memory-map
+        its files.
 
     Returns:
       A `Dataset`.
@@ -44,7 +44,11 @@ def _convert_optional_param_to_tensor(argument_name,
 class TextLineDataset(Dataset):
   """A `Dataset` comprising lines from one or more text files."""
 
-  def __init__(self, filenames, compression_type=None, buffer_size=None):
+  def __init__(self,
+               filenames,
+               compression_type=None,
+               buffer_size=None,
+               num_readahead_buffers=0):
     """Creates a `TextLineDataset`.
 
     Args:
@@ -54,6 +58,10 @@ class TextLineDataset(Dataset):
       buffer_size: (Optional.) A `tf.int64` scalar denoting the number of bytes
         to buffer. A value of 0 results in the default buffering values chosen
         based on the compression type.
+      num_readahead_buffers: (Optional.) A Python integer. If positive, the
+        number of reads of `buffer_size` bytes to issue asynchronously ahead of
+        the current position in each file, which hides the latency of remote
+        file systems.
     """
     super(TextLineDataset, self).__init__()
     self._filenames = ops.convert_to_tensor(
@@ -65,10 +73,14 @@ class TextLineDataset(Dataset):
         argument_dtype=dtypes.string)
     self._buffer_size = _convert_optional_param_to_tensor(
         "buffer_size", buffer_size, _DEFAULT_READER_BUFFER_SIZE_BYTES)
+    self._num_readahead_buffers = num_readahead_buffers
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.text_line_dataset(
-        self._filenames, self._compression_type, self._buffer_size)
+        self._filenames,
+        self._compression_type,
+        self._buffer_size,
+        num_readahead_buffers=self._num_readahead_buffers)
 
   @property
   def output_classes(self):
@@ -86,7 +98,11 @@ class TextLineDataset(Dataset):
 class TFRecordDataset(Dataset):
   """A `Dataset` comprising records from one or more TFRecord files."""
 
-  def __init__(self, filenames, compression_type=None, buffer_size=None):
+  def __init__(self,
+               filenames,
+               compression_type=None,
+               buffer_size=None,
+               num_readahead_buffers=0):
     """Creates a `TFRecordDataset`.
 
     Args:
@@ -95,6 +111,10 @@ class TFRecordDataset(Dataset):
         `""` (no compression), `"ZLIB"`, or `"GZIP"`.
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. 0 means no buffering.
+      num_readahead_buffers: (Optional.) A Python integer. If positive (and
+        `buffer_size` is positive), the number of reads of `buffer_size` bytes
+        to issue asynchronously ahead of the current position in each file,
+        which hides the latency of remote file systems.
     """
     super(TFRecordDataset, self).__init__()
     # Force the type to string even if filenames is an empty list.
@@ -109,10 +129,14 @@ class TFRecordDataset(Dataset):
         "buffer_size",
         buffer_size,
         argument_default=_DEFAULT_READER_BUFFER_SIZE_BYTES)
+    self._num_readahead_buffers = num_readahead_buffers
 
   def _as_variant_tensor(self):
     return gen_dataset_ops.tf_record_dataset(
-        self._filenames, self._compression_type, self._buffer_size)
+        self._filenames,
+        self._compression_type,
+        self._buffer_size,
+        num_readahead_buffers=self._num_readahead_buffers)
 
   @property
   def output_classes(self):
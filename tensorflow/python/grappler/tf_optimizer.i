@@ -100,16 +100,21 @@ PyObject* TF_OptimizeGraph(
     tensorflow::grappler::ItemConfig item_config;
     item_config.inline_functions = false;
     item_config.apply_optimizations = false;
-    std::unique_ptr<tensorflow::grappler::GrapplerItem> grappler_item =
-        tensorflow::grappler::GrapplerItemFromMetaGraphDef(graph_id, metagraph, item_config);
 
     tensorflow::DeviceBase* cpu_device = nullptr;
     tensorflow::GraphDef out_graph;
+    tensorflow::Status status;
+    // The optimizers do not touch Python objects, so release the GIL while
+    // they run.
+    Py_BEGIN_ALLOW_THREADS;
+    std::unique_ptr<tensorflow::grappler::GrapplerItem> grappler_item =
+        tensorflow::grappler::GrapplerItemFromMetaGraphDef(graph_id, metagraph, item_config);
     tensorflow::grappler::MetaOptimizer optimizer(cpu_device, rewriter_config);
-    tensorflow::Status status = optimizer.Optimize(cluster.get(), *grappler_item, &out_graph);
+    status = optimizer.Optimize(cluster.get(), *grappler_item, &out_graph);
     if (verbose) {
       optimizer.PrintResult();
     }
+    Py_END_ALLOW_THREADS;
     tensorflow::Set_TF_Status_from_Status(out_status, status);
     string out_graph_str = out_graph.SerializeAsString();
     PyObject* ret = PyBytes_FromStringAndSize(out_graph_str.data(),
@@ -0,0 +1,204 @@
+# Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for sparse_ops.csr_sparse_matrix_dense_matmul."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import itertools
+import sys
+
+import numpy as np
+
+from tensorflow.python.client import session
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.ops import gradient_checker
+from tensorflow.python.ops import sparse_ops
+import tensorflow.python.ops.sparse_grad  # pylint: disable=unused-import
+from tensorflow.python.ops import variables
+from tensorflow.python.platform import test
+
+
+def _maybe_complex(x):
+  if x.dtype.kind == "c":  # complex
+    return (x + 1j * x) / 2
+  return x
+
+
+def _sparse(x, shuffle=False):
+  indices = np.vstack(np.where(x)).astype(np.int64).T
+  values = x[np.where(x)]
+  if shuffle:
+    perm = np.random.permutation(len(values))
+    indices = indices[perm]
+    values = values[perm]
+  return sparse_tensor.SparseTensorValue(
+      indices=indices, values=values, dense_shape=x.shape)
+
+
+class CSRSparseMatrixMatMulTest(test.TestCase):
+
+  def _testMatmul(self, x, y, adjoint_a=False, adjoint_b=False):
+    x_mat = np.matrix(x)
+    if adjoint_a:
+      x_mat = x_mat.H
+    y_mat = np.matrix(y)
+    if adjoint_b:
+      y_mat = y_mat.H
+    np_ans = x_mat * y_mat
+
+    with self.test_session(use_gpu=True):
+      csr_x = sparse_ops.sparse_tensor_to_csr_sparse_matrix(
+          _sparse(x, shuffle=True))
+      tf_ans = sparse_ops.csr_sparse_matrix_dense_matmul(
+          csr_x, y, adjoint_a=adjoint_a, adjoint_b=adjoint_b)
+      self.assertEqual(tf_ans.get_shape()[1], np_ans.shape[1])
+      tol = 1e-6 if x.dtype == np.float64 else 1e-4
+      self.assertAllClose(np_ans, tf_ans.eval(), rtol=tol, atol=tol)
+
+  def testBasic(self):
+    np.random.seed(127)  # Repeatable results
+    for dtype in [np.float32, np.float64, np.complex64, np.complex128]:
+      for adjoint_a, adjoint_b in itertools.product([False, True], repeat=2):
+        x = _maybe_complex(np.random.rand(10, 15).astype(dtype))
+        x[np.abs(x) < 0.5] = 0  # Make it sparse
+        y = _maybe_complex(np.random.randn(15, 20).astype(dtype))
+        if adjoint_a:
+          x = x.T
+        if adjoint_b:
+          y = y.T
+        self._testMatmul(x, y, adjoint_a=adjoint_a, adjoint_b=adjoint_b)
+
+  def testEmptyRows(self):
+    x = np.zeros((100, 7), dtype=np.float32)
+    x[3, 1] = 2.0
+    x[99, 6] = -1.0
+    y = np.random.randn(7, 33).astype(np.float32)
+    self._testMatmul(x, y)
+    self._testMatmul(x.T, np.random.randn(7, 33).astype(np.float32),
+                     adjoint_a=True)
+
+  def testNoEntries(self):
+    x = np.zeros((4, 5), dtype=np.float32)
+    y = np.random.randn(5, 3).astype(np.float32)
+    self._testMatmul(x, y)
+
+  def testRepeatedIndices(self):
+    indices = [[0, 1], [2, 0], [0, 1]]
+    values = np.array([1.0, 2.0, 3.0], dtype=np.float32)
+    y = np.arange(6, dtype=np.float32).reshape(2, 3)
+    with self.test_session(use_gpu=True):
+      csr_x = sparse_ops.sparse_tensor_to_csr_sparse_matrix(
+          sparse_tensor.SparseTensorValue(indices, values, [3, 2]))
+      ans = sparse_ops.csr_sparse_matrix_dense_matmul(csr_x, y).eval()
+    self.assertAllClose([[12.0, 16.0, 20.0], [0.0, 0.0, 0.0],
+                         [0.0, 2.0, 4.0]], ans)
+
+  def testReuse(self):
+    # One conversion feeds every product.
+    x = np.random.rand(20, 20).astype(np.float32)
+    x[x < 0.8] = 0
+    y = np.random.randn(20, 4).astype(np.float32)
+    with self.test_session(use_gpu=True):
+      csr_x = sparse_ops.sparse_tensor_to_csr_sparse_matrix(_sparse(x))
+      h = sparse_ops.csr_sparse_matrix_dense_matmul(csr_x, y)
+      h = sparse_ops.csr_sparse_matrix_dense_matmul(csr_x, h)
+      self.assertAllClose(x.dot(x.dot(y)), h.eval(), rtol=1e-4, atol=1e-4)
+
+  def testMatchesSparseTensorDenseMatMul(self):
+    x = np.random.rand(50, 40).astype(np.float32)
+    x[x < 0.9] = 0
+    y = np.random.randn(40, 64).astype(np.float32)
+    with self.test_session(use_gpu=True):
+      sp_x = _sparse(x)
+      csr_ans = sparse_ops.csr_sparse_matrix_dense_matmul(
+          sparse_ops.sparse_tensor_to_csr_sparse_matrix(sp_x), y)
+      sp_ans = sparse_ops.sparse_tensor_dense_matmul(sp_x, y)
+      self.assertAllClose(sp_ans.eval(), csr_ans.eval(), rtol=1e-5, atol=1e-5)
+
+  def testInvalidIndices(self):
+    with self.test_session():
+      csr_x = sparse_ops.sparse_tensor_to_csr_sparse_matrix(
+          sparse_tensor.SparseTensorValue([[0, 0], [3, 1]],
+                                          np.array([1.0, 2.0], np.float32),
+                                          [3, 2]))
+      with self.assertRaisesOpError("out of bounds"):
+        csr_x.eval()
+
+  def testInnerDimensionMismatch(self):
+    with self.test_session():
+      csr_x = sparse_ops.sparse_tensor_to_csr_sparse_matrix(
+          _sparse(np.eye(3, dtype=np.float32)))
+      y = np.ones((4, 2), dtype=np.float32)
+      with self.assertRaisesOpError("inner dimension does not match"):
+        sparse_ops.csr_sparse_matrix_dense_matmul(csr_x, y).eval()
+
+  def testGradient(self):
+    np.random.seed(1618)
+    x = np.random.rand(6, 5)
+    x[x < 0.5] = 0
+    y_shape = [5, 3]
+    y_init = np.random.randn(*y_shape)
+    with self.test_session(use_gpu=True):
+      csr_x = sparse_ops.sparse_tensor_to_csr_sparse_matrix(_sparse(x))
+      for adjoint_b in [False, True]:
+        shape = y_shape[::-1] if adjoint_b else y_shape
+        y = constant_op.constant(y_init.reshape(shape))
+        result = sparse_ops.csr_sparse_matrix_dense_matmul(
+            csr_x, y, adjoint_b=adjoint_b)
+        err = gradient_checker.compute_gradient_error(y, shape, result,
+                                                      [6, 3])
+        self.assertLess(err, 1e-6)
+
+
+class CSRSparseMatrixMatMulBenchmark(test.Benchmark):
+
+  def benchmarkMatMul(self):
+    # Multiplies by the same matrix several times, as the layers of a graph
+    # network do, with one CSR conversion or with SparseTensorDenseMatMul,
+    # which groups the entries again in each product.
+    num_products = 4
+    for (m, density, n, use_gpu) in itertools.product(
+        [10000, 100000], [1e-4, 1e-3], [16, 128], [False, True]):
+      nnz = int(m * m * density)
+      indices = np.random.randint(0, m, size=(nnz, 2)).astype(np.int64)
+      values = np.random.rand(nnz).astype(np.float32)
+      device = "/%s:0" % ("gpu" if use_gpu else "cpu")
+      with ops.Graph().as_default():
+        with ops.device(device):
+          sp_x = sparse_tensor.SparseTensor(indices, values, [m, m])
+          y = variables.Variable(np.random.rand(m, n).astype(np.float32))
+          csr_x = sparse_ops.sparse_tensor_to_csr_sparse_matrix(sp_x)
+          csr_h = y
+          sp_h = y
+          for _ in range(num_products):
+            csr_h = sparse_ops.csr_sparse_matrix_dense_matmul(csr_x, csr_h)
+            sp_h = sparse_ops.sparse_tensor_dense_matmul(sp_x, sp_h)
+        with session.Session() as sess:
+          sess.run(variables.global_variables_initializer())
+          for label, op in [("csr", csr_h), ("sparse_tensor", sp_h)]:
+            name = "m_%d_density_%g_n_%d_use_gpu_%s_%s" % (m, density, n,
+                                                           use_gpu, label)
+            r = self.run_op_benchmark(sess, op.op, min_iters=20, name=name)
+            print("Benchmark: %s \t wall_time: %0.03g s" % (name,
+                                                            r["wall_time"]))
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+  test.main()
@@ -229,6 +229,42 @@ class DecodeCSVOpTest(test.TestCase):
     self._test(
         args, expected_err_re="Quoted field has to end with quote followed.*")
 
+  def testEscapedQuotes(self):
+    args = {
+        "records": ['"a""b",1', '"""",2', '"x,y""",3', '"",4'],
+        "record_defaults": [["default"], [0]],
+    }
+
+    expected_out = [[b'a"b', b'"', b'x,y"', b"default"], [1, 2, 3, 4]]
+
+    self._test(args, expected_out)
+
+  def testManyRecords(self):
+    # Enough records to be split across threads.
+    num_records = 50000
+    ints = np.arange(num_records, dtype=np.int64) * 7 - 1000
+    floats = np.arange(num_records, dtype=np.float32) / 8
+    records = [
+        "%d,%s,x%d" % (ints[i], floats[i], i) for i in range(num_records)
+    ]
+    args = {
+        "records": records,
+        "record_defaults": [np.array([0], dtype=np.int64), [0.0], [""]],
+    }
+
+    expected_out = [ints, floats, [b"x%d" % i for i in range(num_records)]]
+
+    self._test(args, expected_out)
+
+  def testManyRecordsFirstErrorReported(self):
+    records = ["1"] * 50000
+    records[20000] = "a"
+    records[40000] = "b"
+    args = {"records": records, "record_defaults": [[0]]}
+
+    self._test(
+        args, expected_err_re="Field 0 in record 20000 is not a valid int32: a")
+
 
 if __name__ == "__main__":
   test.main()
@@ -30,6 +30,7 @@ from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import data_flow_ops
 from tensorflow.python.ops import embedding_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import gradient_checker
 from tensorflow.python.ops import linalg_ops
 from tensorflow.python.ops import math_ops
@@ -609,6 +610,57 @@ class EmbeddingLookupTest(test.TestCase):
           self.assertAllEqual(simple, sharded)
 
 
+class EmbeddingRowCacheTest(test.TestCase):
+
+  def testMatchesEmbeddingLookup(self):
+    with self.test_session():
+      num_shards = 3
+      vocab_size = 10
+      p, params, feed_dict = _EmbeddingParams(num_shards, vocab_size)
+      cache = embedding_ops.EmbeddingRowCache(dtypes.float32, [10], capacity=4)
+      id_vals = np.array([[3, 1], [3, 7], [9, 3]])
+      ids = constant_op.constant(id_vals, dtype=dtypes.int64)
+      version = constant_op.constant(0, dtype=dtypes.int64)
+      embedding = cache.lookup(p, ids, version)
+      self.assertEqual([3, 2, 10], embedding.get_shape().as_list())
+      expected = embedding_ops.embedding_lookup(p, ids).eval(
+          feed_dict=feed_dict)
+      self.assertAllEqual(expected, embedding.eval(feed_dict=feed_dict))
+      self.assertAllEqual(expected, embedding.eval(feed_dict=feed_dict))
+      hits, misses, size = cache.stats()
+      # The first lookup fetches the 4 unique ids, the second one reads them
+      # all from the cache.
+      self.assertEqual(6, hits.eval())
+      self.assertEqual(6, misses.eval())
+      self.assertEqual(4, size.eval())
+
+  def testStaleness(self):
+    with self.test_session():
+      params = variables.Variable([[1.0, 1.0], [2.0, 2.0]])
+      cache = embedding_ops.EmbeddingRowCache(
+          dtypes.float32, [2], capacity=2, max_staleness=1)
+      version = array_ops.placeholder(dtypes.int64, [])
+      embedding = cache.lookup(
+          params, constant_op.constant([1, 0]), version)
+      update = params.assign([[3.0, 3.0], [4.0, 4.0]])
+      variables.global_variables_initializer().run()
+      self.assertAllEqual([[2.0, 2.0], [1.0, 1.0]],
+                          embedding.eval(feed_dict={version: 0}))
+      update.eval()
+      self.assertAllEqual([[2.0, 2.0], [1.0, 1.0]],
+                          embedding.eval(feed_dict={version: 1}))
+      self.assertAllEqual([[4.0, 4.0], [3.0, 3.0]],
+                          embedding.eval(feed_dict={version: 2}))
+
+  def testWrongRowShape(self):
+    with self.test_session():
+      cache = embedding_ops.EmbeddingRowCache(dtypes.float32, [3], capacity=2)
+      embedding = cache.lookup(
+          constant_op.constant([[1.0, 1.0]]), constant_op.constant([0]), 0)
+      with self.assertRaisesOpError("miss_rows must be of shape"):
+        embedding.eval()
+
+
 class EmbeddingLookupSparseTest(test.TestCase):
 
   def _RandomIdsAndWeights(self, batch_size, vocab_size):
@@ -719,6 +771,58 @@ class EmbeddingLookupSparseTest(test.TestCase):
             x, x_shape, y, y_shape, x_init_value=x_init_value)
       self.assertLess(err, 1e-5 if dtype == dtypes.float64 else 2e-3)
 
+  def _FusedEmbeddingLookupSparse(self, params, sp_ids, sp_weights, combiner):
+    segment_ids = math_ops.cast(sp_ids.indices[:, 0], dtypes.int32)
+    if sp_weights is None:
+      weights = array_ops.zeros([0], dtype=params.dtype)
+    else:
+      weights = math_ops.cast(sp_weights.values, params.dtype)
+    return gen_math_ops.fused_embedding_lookup_sparse(
+        params, sp_ids.values, segment_ids, weights, combiner=combiner)
+
+  def testFusedEmbeddingLookupSparse(self):
+    vocab_size = 13
+    batch_size = 10
+    param_shape = [2, 5]
+    sp_ids, sp_weights, _, _, _ = self._RandomIdsAndWeights(
+        batch_size, vocab_size)
+
+    for combiner, dtype, ignore_weights in itertools.product(
+        ["sum", "mean", "sqrtn"], [dtypes.float32, dtypes.float64],
+        [True, False]):
+      with self.test_session():
+        p, _, feed_dict = _EmbeddingParams(
+            1, vocab_size, shape=param_shape, dtype=dtype)
+        weights = None if ignore_weights else sp_weights
+        expected = embedding_ops.embedding_lookup_sparse(
+            p, sp_ids, weights, combiner=combiner)
+        fused = self._FusedEmbeddingLookupSparse(p[0], sp_ids, weights,
+                                                 combiner)
+        self.assertEqual(fused.get_shape().as_list(), [None] + param_shape)
+        self.assertAllClose(
+            expected.eval(feed_dict=feed_dict), fused.eval(feed_dict=feed_dict))
+
+  def testGradientsFusedEmbeddingLookupSparse(self):
+    vocab_size = 12
+    batch_size = 4
+    param_shape = [2, 3]
+    sp_ids, sp_weights, _, _, _ = self._RandomIdsAndWeights(
+        batch_size, vocab_size)
+
+    for combiner, dtype, ignore_weights in itertools.product(
+        ["sum", "mean", "sqrtn"], [dtypes.float32, dtypes.float64],
+        [True, False]):
+      with self.test_session():
+        x, params, _ = _EmbeddingParams(
+            1, vocab_size, shape=param_shape, dtype=dtype)
+        y = self._FusedEmbeddingLookupSparse(
+            x[0], sp_ids, None if ignore_weights else sp_weights, combiner)
+        x_init_value = params[_PName(0) + ":0"]
+        y_shape = [batch_size] + param_shape
+        err = gradient_checker.compute_gradient_error(
+            x[0], x_init_value.shape, y, y_shape, x_init_value=x_init_value)
+      self.assertLess(err, 1e-5 if dtype == dtypes.float64 else 2e-3)
+
   def testIncompatibleShapes(self):
     with self.test_session():
       x, _, _ = _EmbeddingParams(1, 10, dtype=dtypes.float32)
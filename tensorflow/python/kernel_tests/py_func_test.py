@@ -18,6 +18,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import threading
+
 import numpy as np
 from six.moves import queue
 from six.moves import xrange  # pylint: disable=redefined-builtin
@@ -309,6 +311,55 @@ class PyFuncTest(test.TestCase):
       # This will result in a deadlock if the py_func's don't run in parallel.
       session.run([x, y])
 
+  def testBatchedSingleCall(self):
+    with self.test_session():
+      shapes = []
+
+      def batched_square(x):
+        shapes.append(x.shape)
+        return np.square(x)
+
+      x = constant_op.constant([1.0, 2.0, 3.0])
+      y, = script_ops.py_func(batched_square, [x], [dtypes.float32],
+                              max_batch_size=4)
+      self.assertAllEqual([1.0, 4.0, 9.0], y.eval())
+      self.assertEqual([(1, 3)], shapes)
+
+  def testBatchedConcurrentCalls(self):
+    with self.test_session() as sess:
+      batch_sizes = []
+
+      def batched_add_one(x):
+        batch_sizes.append(x.shape[0])
+        return x + 1
+
+      x = array_ops.placeholder(dtypes.int64, shape=[2])
+      y, = script_ops.py_func(batched_add_one, [x], [dtypes.int64],
+                              max_batch_size=3)
+      results = [None] * 8
+
+      def run(i):
+        results[i] = sess.run(y, feed_dict={x: [i, -i]})
+
+      threads = [threading.Thread(target=run, args=(i,)) for i in xrange(8)]
+      for t in threads:
+        t.start()
+      for t in threads:
+        t.join()
+      for i in xrange(8):
+        self.assertAllEqual([i + 1, 1 - i], results[i])
+      self.assertEqual(8, sum(batch_sizes))
+      self.assertLessEqual(max(batch_sizes), 3)
+
+  def testBatchedBadReturnShape(self):
+    with self.test_session():
+      x = constant_op.constant([1.0, 2.0])
+      y, = script_ops.py_func(lambda x: x[0], [x], [dtypes.float32],
+                              max_batch_size=2)
+      with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                   "along the first dimension"):
+        y.eval()
+
   def testNoReturnValueStateful(self):
 
     class State(object):
@@ -148,6 +148,14 @@ class BaseReductionTest(test.TestCase):
     for axes in _powerset(range(x.ndim)):
       self._compareAll(x, axes, feed_dict)
 
+  def _compareSkinny(self, dtype):
+    # Row and column reductions of matrices with few columns, whose column
+    # reductions on CPU are split into blocks of rows.
+    for shape in [(5, 3), (100000, 1), (100000, 3), (20000, 16), (3, 20000)]:
+      x = np.random.randint(-10, 10, size=shape).astype(dtype.as_numpy_dtype)
+      for axes in [None, 0, 1]:
+        self._compare(x, axes, keep_dims=False)
+
   def _compareGradient(self, x, reduction_axes, rtol=1e-8, atol=1e-8):
     if reduction_axes is not None and np.shape(reduction_axes) == (1,):
       # Test scalar reduction_axes argument
@@ -269,6 +277,10 @@ class SumReductionTest(BaseReductionTest):
       np_arr = self._makeIncremental((2,) * rank, dtypes.complex128)
       self._compareAllAxes(np_arr)
 
+  def testSkinny(self):
+    for dtype in [dtypes.int32, dtypes.float32, dtypes.float64]:
+      self._compareSkinny(dtype)
+
   def testInvalidIndex(self):
     np_arr = np.arange(0, 10).reshape([2, 5]).astype(np.float32)
     input_tensor = ops.convert_to_tensor(np_arr)
@@ -433,6 +445,10 @@ class MeanReductionTest(BaseReductionTest):
       np_arr = self._makeIncremental((2,) * rank, dtypes.complex128)
       self._compareAllAxes(np_arr)
 
+  def testSkinny(self):
+    for dtype in [dtypes.int32, dtypes.float32, dtypes.float64]:
+      self._compareSkinny(dtype)
+
   def testGradient(self):
     s = [2, 3, 4, 2]
     for dtype in [dtypes.float32, dtypes.float64]:
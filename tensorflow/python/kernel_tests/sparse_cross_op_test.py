@@ -353,6 +353,28 @@ class SparseCrossOpTest(test.TestCase):
       all_values_are_different = len(out.values) == len(set(out.values))
       self.assertTrue(all_values_are_different)
 
+  def test_hashed_3x3x3_matches_single_crosses(self):
+    """Tests that every cross of a batch hashes like the cross on its own."""
+    features = [['batch1-FC%d-F%d' % (c, f) for f in range(3)]
+                for c in range(3)]
+    op = sparse_ops._sparse_cross_hashed(
+        [self._sparse_tensor([column]) for column in features])
+    single_ops = []
+    for f0 in features[0]:
+      for f1 in features[1]:
+        for f2 in features[2]:
+          single_ops.append(
+              sparse_ops._sparse_cross_hashed([
+                  self._sparse_tensor([[f0]]),
+                  self._sparse_tensor([[f1]]),
+                  self._sparse_tensor([[f2]])
+              ]))
+    with self.test_session() as sess:
+      out, singles = sess.run([op, single_ops])
+      self.assertAllEqual([[0, i] for i in range(27)], out.indices)
+      self.assertAllEqual([single.values[0] for single in singles],
+                          out.values)
+
   def _assert_sparse_tensor_empty(self, sp):
     self.assertEquals(0, sp.indices.size)
     self.assertEquals(0, sp.values.size)
@@ -253,6 +253,132 @@ class SparseXentTest(test.TestCase):
         sess.run([ce], feed_dict={labels: labels_v2, logits: logits_v2})
 
 
+class SparseXentWithProjectionTest(test.TestCase):
+
+  def _npXentWithProjection(self, inputs, weights, biases, labels):
+    logits = inputs.dot(weights.T) + biases
+    batch_size = logits.shape[0]
+    e = np.exp(logits - np.amax(logits, axis=1, keepdims=True))
+    probs = e / np.sum(e, axis=1, keepdims=True)
+    labels_mat = np.zeros_like(probs)
+    labels_mat[np.arange(batch_size), labels] = 1.0
+    loss = -np.sum(labels_mat * np.log(probs + 1.0e-20), axis=1)
+    logits_grad = probs - labels_mat
+    return (loss, logits_grad.dot(weights), logits_grad.T.dot(inputs),
+            np.sum(logits_grad, axis=0))
+
+  def _testXentWithProjection(self, batch_size, dim, num_classes, chunk_size,
+                              dtype):
+    np.random.seed(1234)
+    inputs = np.random.randn(batch_size, dim).astype(dtype)
+    weights = np.random.randn(num_classes, dim).astype(dtype)
+    biases = np.random.randn(num_classes).astype(dtype)
+    labels = np.random.randint(0, num_classes, size=batch_size)
+    np_loss, np_inputs_grad, np_weights_grad, np_biases_grad = (
+        self._npXentWithProjection(inputs, weights, biases, labels))
+    for label_dtype in np.int32, np.int64:
+      with self.test_session(use_gpu=True) as sess:
+        loss, log_sum_exp = (
+            gen_nn_ops.sparse_softmax_cross_entropy_with_projection(
+                inputs, weights, biases, labels.astype(label_dtype),
+                chunk_size=chunk_size))
+        grads = gen_nn_ops.sparse_softmax_cross_entropy_with_projection_grad(
+            inputs, weights, biases, labels.astype(label_dtype), log_sum_exp,
+            np.ones(batch_size, dtype=dtype), chunk_size=chunk_size)
+        tf_loss, tf_inputs_grad, tf_weights_grad, tf_biases_grad = sess.run(
+            [loss] + list(grads))
+      self.assertAllCloseAccordingToType(np_loss, tf_loss)
+      self.assertAllCloseAccordingToType(np_inputs_grad, tf_inputs_grad)
+      self.assertAllCloseAccordingToType(np_weights_grad, tf_weights_grad)
+      self.assertAllCloseAccordingToType(np_biases_grad, tf_biases_grad)
+
+  def testSingleChunk(self):
+    self._testXentWithProjection(5, 7, 11, 16, np.float32)
+
+  def testMultipleChunks(self):
+    for dtype in np.float32, np.float64:
+      self._testXentWithProjection(5, 7, 32, 8, dtype)
+
+  def testRaggedLastChunk(self):
+    self._testXentWithProjection(6, 4, 29, 8, np.float64)
+
+  def testChunkSizeOne(self):
+    self._testXentWithProjection(3, 5, 6, 1, np.float64)
+
+  def testLargeLogits(self):
+    # A single chunk would overflow exp() without the running maximum.
+    inputs = np.array([[100.0, 0.0], [0.0, -100.0]], dtype=np.float32)
+    weights = np.array([[1.0, 0.0], [0.0, 1.0], [5.0, 5.0]],
+                       dtype=np.float32)
+    biases = np.zeros(3, dtype=np.float32)
+    labels = np.array([2, 1])
+    np_loss = self._npXentWithProjection(inputs, weights, biases, labels)[0]
+    with self.test_session(use_gpu=True):
+      loss, _ = gen_nn_ops.sparse_softmax_cross_entropy_with_projection(
+          inputs, weights, biases, labels, chunk_size=1)
+      self.assertAllClose(np_loss, loss.eval(), rtol=1e-3, atol=1e-3)
+
+  def testMatchesSparseSoftmaxCrossEntropyWithLogits(self):
+    inputs = np.random.randn(8, 16).astype(np.float32)
+    weights = np.random.randn(100, 16).astype(np.float32)
+    biases = np.random.randn(100).astype(np.float32)
+    labels = np.random.randint(0, 100, size=8)
+    with self.test_session(use_gpu=True) as sess:
+      loss, _ = gen_nn_ops.sparse_softmax_cross_entropy_with_projection(
+          inputs, weights, biases, labels, chunk_size=32)
+      logits = nn_ops.bias_add(
+          math_ops.matmul(inputs, weights, transpose_b=True), biases)
+      xent = nn_ops.sparse_softmax_cross_entropy_with_logits(
+          labels=labels, logits=logits)
+      tf_loss, tf_xent = sess.run([loss, xent])
+    self.assertAllClose(tf_xent, tf_loss, rtol=1e-5, atol=1e-5)
+
+  def testEmpty(self):
+    with self.test_session(use_gpu=True) as sess:
+      loss, log_sum_exp = (
+          gen_nn_ops.sparse_softmax_cross_entropy_with_projection(
+              np.zeros((0, 3)), np.ones((4, 3)), np.ones(4),
+              np.zeros((0,), dtype=np.int32)))
+      grads = gen_nn_ops.sparse_softmax_cross_entropy_with_projection_grad(
+          np.zeros((0, 3)), np.ones((4, 3)), np.ones(4),
+          np.zeros((0,), dtype=np.int32), log_sum_exp, np.zeros(0))
+      tf_loss, tf_inputs_grad, tf_weights_grad, tf_biases_grad = sess.run(
+          [loss] + list(grads))
+    self.assertEqual((0,), tf_loss.shape)
+    self.assertEqual((0, 3), tf_inputs_grad.shape)
+    self.assertAllEqual(np.zeros((4, 3)), tf_weights_grad)
+    self.assertAllEqual(np.zeros(4), tf_biases_grad)
+
+  def testInvalidLabel(self):
+    with self.test_session(use_gpu=False):
+      loss, _ = gen_nn_ops.sparse_softmax_cross_entropy_with_projection(
+          np.ones((2, 3), dtype=np.float32), np.ones((4, 3), dtype=np.float32),
+          np.ones(4, dtype=np.float32), [0, 4])
+      with self.assertRaisesOpError("Received a label value of"):
+        loss.eval()
+
+  def testShapeMismatch(self):
+    with self.test_session():
+      with self.assertRaises(ValueError):
+        gen_nn_ops.sparse_softmax_cross_entropy_with_projection(
+            np.ones((2, 3)), np.ones((4, 5)), np.ones(4), [0, 1])
+
+  def testGradient(self):
+    with self.test_session(use_gpu=True):
+      np.random.seed(4321)
+      inputs = constant_op.constant(
+          np.random.randn(3, 4), dtype=dtypes.float64)
+      weights = constant_op.constant(
+          np.random.randn(10, 4), dtype=dtypes.float64)
+      biases = constant_op.constant(np.random.randn(10), dtype=dtypes.float64)
+      labels = constant_op.constant([3, 0, 9])
+      loss, _ = gen_nn_ops.sparse_softmax_cross_entropy_with_projection(
+          inputs, weights, biases, labels, chunk_size=4)
+      err = gradient_checker.compute_gradient_error(
+          [inputs, weights, biases], [[3, 4], [10, 4], [10]], loss, [3])
+    self.assertLess(err, 5e-8)
+
+
 def _sparse_vs_dense_xent_benchmark_dense(labels, logits):
   labels = array_ops.identity(labels)
   logits = array_ops.identity(logits)
@@ -46,6 +46,15 @@ class StringToHashBucketOpTest(test.TestCase):
       # Fingerprint64('d') -> 4470636696479570465 -> mod 10 -> 5
       self.assertAllEqual([9, 2, 2, 5], result)
 
+  def testStringToHashBucketsFastLargeInput(self):
+    with self.test_session():
+      input_string = array_ops.placeholder(dtypes.string)
+      output = string_ops.string_to_hash_bucket_fast(input_string, 10)
+      result = output.eval(
+          feed_dict={input_string: [['a', 'b', 'c', 'd']] * 10000})
+
+      self.assertAllEqual([[9, 2, 2, 5]] * 10000, result)
+
   def testStringToOneHashBucketLegacyHash(self):
     with self.test_session():
       input_string = array_ops.placeholder(dtypes.string)
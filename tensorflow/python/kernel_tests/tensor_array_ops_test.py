@@ -1315,6 +1315,84 @@ class TensorArrayTest(test.TestCase):
       self.assertAllEqual([[1.0, -1.0], [8.0, -8.0]], g_vals[0])
       self.assertAllEqual(expected_grad, grad_vals[0])
 
+  def testContiguousTensorArrayWriteStackGatherConcat(self):
+    with self.test_session(use_gpu=True):
+      values = np.arange(48, dtype=np.float32).reshape(3, 2, 8)
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32,
+          size=3,
+          element_shape=[2, 8],
+          clear_after_read=False,
+          contiguous=True)
+      for i in range(3):
+        ta = ta.write(i, values[i])
+
+      stacked, gathered, concatenated, unordered = self.evaluate(
+          [ta.stack(), ta.gather([1, 2]), ta.concat(), ta.gather([2, 0])])
+      self.assertAllEqual(values, stacked)
+      self.assertAllEqual(values[1:], gathered)
+      self.assertAllEqual(values.reshape(6, 8), concatenated)
+      self.assertAllEqual(values[[2, 0]], unordered)
+
+  def testContiguousTensorArrayUnstackSplitAndRead(self):
+    with self.test_session(use_gpu=True):
+      values = np.arange(64, dtype=np.float32).reshape(4, 16)
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=4, contiguous=True)
+      ta = ta.unstack(values)
+      reads = self.evaluate([ta.read(i) for i in range(4)])
+      for i in range(4):
+        self.assertAllEqual(values[i], reads[i])
+
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=2, contiguous=True)
+      ta = ta.split(values, lengths=[2, 2])
+      self.assertAllEqual(values, self.evaluate(ta.concat()))
+
+      # Scattering part of the array copies into its buffer, and the
+      # remaining elements are filled with zeros when stacked.
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=4, contiguous=True)
+      ta = ta.scatter([1, 2], values[:2])
+      expected = np.zeros((4, 16), dtype=np.float32)
+      expected[1:3] = values[:2]
+      self.assertAllEqual(expected, self.evaluate(ta.stack()))
+
+  def testContiguousTensorArrayUnalignedElements(self):
+    with self.test_session(use_gpu=True):
+      # Elements of this shape are stored separately, since views of them
+      # into a buffer would not be aligned.
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=3, contiguous=True)
+      ta = ta.write(0, [1.0, 2.0, 3.0])
+      ta = ta.write(1, [4.0, 5.0, 6.0])
+      ta = ta.write(2, [7.0, 8.0, 9.0])
+      self.assertAllEqual([[1.0, 2.0, 3.0], [4.0, 5.0, 6.0], [7.0, 8.0, 9.0]],
+                          self.evaluate(ta.stack()))
+
+  def testContiguousTensorArrayWriteAfterUnstackFails(self):
+    with self.test_session(use_gpu=True):
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=2, contiguous=True)
+      ta = ta.unstack(array_ops.zeros([2, 16]))
+      with self.assertRaisesOpError(
+          "Could not write to TensorArray index 1 because "
+          "it has already been written to."):
+        self.evaluate(ta.write(1, array_ops.ones([16])).flow)
+
+  def testContiguousTensorArrayGradients(self):
+    with self.test_session(use_gpu=True) as session:
+      values = constant_op.constant(
+          np.arange(32, dtype=np.float32).reshape(2, 16))
+      ta = tensor_array_ops.TensorArray(
+          dtype=dtypes.float32, size=2, contiguous=True)
+      stacked = ta.unstack(values).stack()
+      grad = gradients_impl.gradients(
+          ys=[stacked], xs=[values], grad_ys=[2.0 * array_ops.ones([2, 16])])
+      stacked_val, grad_val = session.run([stacked, grad[0]])
+      self.assertAllEqual(np.arange(32).reshape(2, 16), stacked_val)
+      self.assertAllEqual(2.0 * np.ones((2, 16)), grad_val)
+
   def testTensorArrayGetsDeviceFromFirstWrite(self):
     with ops.device("/job:worker/task:0/cpu:0"):
       # this initial device will be ignored.
@@ -456,6 +456,25 @@ class TransposeTest(test.TestCase):
       xt = array_ops.transpose(x, [0, 2, 1]).eval()
       self.assertAllEqual(xt.shape, (1, 0, 4))
 
+  def testLargeAllPermutationsCpu(self):
+    # Dimensions that are not multiples of the tile size exercise the partial
+    # tiles of the CPU kernel.
+    for dtype in [np.uint8, np.int16, np.float32, np.float64, np.complex128]:
+      for shape in [[17, 33, 9, 70], [3, 5, 2, 7, 41]]:
+        x = np.arange(np.prod(shape)).reshape(shape).astype(dtype)
+        if dtype == np.complex128:
+          x -= 1j * x
+        cs = [False, True] if dtype == np.complex128 else [False]
+        with self.test_session(use_gpu=False):
+          inx = ops.convert_to_tensor(x)
+          for p in itertools.permutations(range(len(shape))):
+            for c in cs:
+              np_ans = np.transpose(x, p)
+              if c:
+                np_ans = np.conj(np_ans)
+              tf_ans = array_ops.transpose(inx, p, conjugate=c).eval()
+              self.assertAllEqual(np_ans, tf_ans)
+
   def _testError(self, x, p, err):
     with self.test_session():
       with self.assertRaisesOpError(err):
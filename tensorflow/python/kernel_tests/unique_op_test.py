@@ -50,6 +50,36 @@ class UniqueTest(test.TestCase):
     for i in range(len(x)):
       self.assertEqual(x[i], tf_y[tf_idx[i]])
 
+  def testInt64Large(self):
+    # Large enough to be deduplicated in parallel.
+    x = np.random.randint(0, high=50000, size=200000)
+    with self.test_session() as sess:
+      y, idx = array_ops.unique(x)
+      tf_y, tf_idx = sess.run([y, idx])
+
+    # The unique values are in order of first occurrence.
+    _, first = np.unique(x, return_index=True)
+    self.assertAllEqual(x[np.sort(first)], tf_y)
+    self.assertAllEqual(x, tf_y[tf_idx])
+
+  def testGpu(self):
+    for dtype in [np.int32, np.int64]:
+      x = np.random.randint(-1000, high=1000, size=20000).astype(dtype)
+      with self.test_session(use_gpu=True) as sess:
+        y, idx = array_ops.unique(x)
+        tf_y, tf_idx = sess.run([y, idx])
+
+      _, first = np.unique(x, return_index=True)
+      self.assertAllEqual(x[np.sort(first)], tf_y)
+      self.assertAllEqual(x, tf_y[tf_idx])
+
+  def testGpuEmpty(self):
+    with self.test_session(use_gpu=True) as sess:
+      y, idx = array_ops.unique(np.array([], dtype=np.int64))
+      tf_y, tf_idx = sess.run([y, idx])
+    self.assertEqual(0, len(tf_y))
+    self.assertEqual(0, len(tf_idx))
+
   def testString(self):
     indx = np.random.randint(65, high=122, size=7000)
     x = [chr(i) for i in indx]
@@ -116,6 +146,33 @@ class UniqueWithCountsTest(test.TestCase):
     for value, count in zip(tf_y, tf_count):
       self.assertEqual(count, np.sum(x == value))
 
+  def testInt64Large(self):
+    x = np.random.randint(0, high=50000, size=200000)
+    with self.test_session() as sess:
+      y, idx, count = array_ops.unique_with_counts(x)
+      tf_y, tf_idx, tf_count = sess.run([y, idx, count])
+
+    np_y, first, np_count = np.unique(x, return_index=True,
+                                      return_counts=True)
+    order = np.argsort(first)
+    self.assertAllEqual(np_y[order], tf_y)
+    self.assertAllEqual(x, tf_y[tf_idx])
+    self.assertAllEqual(np_count[order], tf_count)
+
+  def testGpu(self):
+    for out_idx in [dtypes.int32, dtypes.int64]:
+      x = np.random.randint(-1000, high=1000, size=20000)
+      with self.test_session(use_gpu=True) as sess:
+        y, idx, count = array_ops.unique_with_counts(x, out_idx=out_idx)
+        tf_y, tf_idx, tf_count = sess.run([y, idx, count])
+
+      np_y, first, np_count = np.unique(x, return_index=True,
+                                        return_counts=True)
+      order = np.argsort(first)
+      self.assertAllEqual(np_y[order], tf_y)
+      self.assertAllEqual(x, tf_y[tf_idx])
+      self.assertAllEqual(np_count[order], tf_count)
+
   def testString(self):
     indx = np.random.randint(65, high=122, size=7000)
     x = [chr(i) for i in indx]
@@ -27,6 +27,11 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Copies of at least this many bytes between ndarrays and tensors are made
+// with the GIL released. Below it the copy is too short to be worth waiting
+// for the GIL again, which can take a switch interval of another thread.
+const size_t kCopyWithoutGILBytes = 16 << 20;
+
 Status PyArrayDescr_to_TF_DataType(PyArray_Descr* descr,
                                    TF_DataType* out_tf_datatype) {
   PyObject* key;
@@ -360,8 +365,17 @@ Status TF_TensorToPyArray(Safe_TF_TensorPtr tensor, PyObject** out_ndarray) {
                             " bytes but TF_Tensor was ",
                             TF_TensorByteSize(tensor.get()), " bytes");
   } else {
-    memcpy(PyArray_DATA(py_array), TF_TensorData(tensor.get()),
-           PyArray_NBYTES(py_array));
+    // The new ndarray is not visible to any other thread yet.
+    void* dst = PyArray_DATA(py_array);
+    const void* src = TF_TensorData(tensor.get());
+    const size_t size = PyArray_NBYTES(py_array);
+    if (size >= kCopyWithoutGILBytes) {
+      Py_BEGIN_ALLOW_THREADS;
+      memcpy(dst, src, size);
+      Py_END_ALLOW_THREADS;
+    } else {
+      memcpy(dst, src, size);
+    }
   }
 
   // PyArray_Return turns rank 0 arrays into numpy scalars
@@ -374,8 +388,11 @@ Status PyArrayToTF_Tensor(PyObject* ndarray, Safe_TF_TensorPtr* out_tensor) {
   DCHECK(out_tensor != nullptr);
 
   // Make sure we dereference this array object in case of error, etc.
+  // Read-only arrays are accepted as they are: the buffer of a fed tensor
+  // does not own its memory, so TensorFlow never writes to it or forwards it
+  // to an op output, and C-contiguous aligned arrays are fed without a copy.
   Safe_PyObjectPtr array_safe(make_safe(
-      PyArray_FromAny(ndarray, nullptr, 0, 0, NPY_ARRAY_CARRAY, nullptr)));
+      PyArray_FromAny(ndarray, nullptr, 0, 0, NPY_ARRAY_CARRAY_RO, nullptr)));
   if (!array_safe) return errors::InvalidArgument("Not a ndarray.");
   PyArrayObject* array = reinterpret_cast<PyArrayObject*>(array_safe.get());
 
@@ -403,9 +420,21 @@ Status PyArrayToTF_Tensor(PyObject* ndarray, Safe_TF_TensorPtr* out_tensor) {
   } else if (dtype != TF_STRING) {
     size_t size = PyArray_NBYTES(array);
     array_safe.release();
-    *out_tensor = make_safe(TF_NewTensor(dtype, dims.data(), dims.size(),
-                                         PyArray_DATA(array), size,
-                                         &DelayedNumpyDecref, array));
+    // TF_NewTensor copies arrays that are not aligned for Eigen, and defers
+    // the decref of 'array', so it does not need the GIL.
+    TF_Tensor* tensor;
+    if (size >= kCopyWithoutGILBytes) {
+      Py_BEGIN_ALLOW_THREADS;
+      tensor = TF_NewTensor(dtype, dims.data(), dims.size(),
+                            PyArray_DATA(array), size, &DelayedNumpyDecref,
+                            array);
+      Py_END_ALLOW_THREADS;
+    } else {
+      tensor = TF_NewTensor(dtype, dims.data(), dims.size(),
+                            PyArray_DATA(array), size, &DelayedNumpyDecref,
+                            array);
+    }
+    *out_tensor = make_safe(tensor);
   } else {
     size_t size = 0;
     void* encoded = nullptr;
@@ -16,12 +16,14 @@ limitations under the License.
 #include "tensorflow/python/lib/core/py_func.h"
 
 #include <array>
+#include <deque>
 
 #include "numpy/arrayobject.h"
 #include "tensorflow/c/eager/c_api.h"
 #include "tensorflow/c/tf_status_helper.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/batch_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/macros.h"
@@ -244,6 +246,153 @@ Status DoCallPyFunc(PyCall* call, bool* out_log_on_error) {
   return s;
 }
 
+// Combines the concurrent calls of a vectorized py function. A call that
+// finds no batch running leads the next one: once it holds the GIL, it takes
+// the waiting calls whose inputs have the same shapes as its own, stacks
+// their inputs along a new first dimension, calls the python function once
+// and hands each call its slice of the outputs. The calls that arrive while
+// a batch runs wait for the GIL anyway, so batching adds no latency.
+class PyCallBatcher {
+ public:
+  explicit PyCallBatcher(int max_batch_size)
+      : max_batch_size_(max_batch_size) {}
+
+  // Runs 'call', which must not be eager, as part of a batch. Must be called
+  // without holding the GIL.
+  Status Call(PyCall* call, bool* out_log_on_error) {
+    Pending self;
+    self.call = call;
+    {
+      mutex_lock l(mu_);
+      pending_.push_back(&self);
+      while (!self.done && running_) {
+        cv_.wait(l);
+      }
+      if (self.done) {
+        *out_log_on_error = self.log_on_error;
+        return self.status;
+      }
+      running_ = true;
+    }
+
+    PyGILState_STATE py_threadstate = PyGILState_Ensure();
+    std::vector<Pending*> batch;
+    {
+      mutex_lock l(mu_);
+      batch.push_back(&self);
+      for (auto it = pending_.begin(); it != pending_.end();) {
+        if (*it == &self) {
+          it = pending_.erase(it);
+        } else if (batch.size() < max_batch_size_ &&
+                   SameInputShapes(*call, *(*it)->call)) {
+          batch.push_back(*it);
+          it = pending_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    bool log_on_error = true;
+    Status s = RunBatch(batch, &log_on_error);
+    PyGILState_Release(py_threadstate);
+
+    mutex_lock l(mu_);
+    for (Pending* p : batch) {
+      p->status = s;
+      p->log_on_error = log_on_error;
+      p->done = true;
+    }
+    running_ = false;
+    cv_.notify_all();
+    *out_log_on_error = log_on_error;
+    return s;
+  }
+
+ private:
+  struct Pending {
+    PyCall* call = nullptr;
+    Status status;
+    bool log_on_error = true;
+    bool done = false;
+  };
+
+  static bool SameInputShapes(const PyCall& a, const PyCall& b) {
+    if (a.ins.size() != b.ins.size()) return false;
+    for (size_t i = 0; i < a.ins.size(); ++i) {
+      if (a.ins[i].dtype() != b.ins[i].dtype() ||
+          a.ins[i].shape() != b.ins[i].shape()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Calls the python function on the stacked inputs of 'batch' and splits
+  // its outputs into the calls. A batch of one is reshaped without copies.
+  // Requires the GIL.
+  static Status RunBatch(const std::vector<Pending*>& batch,
+                         bool* out_log_on_error) {
+    const int64 n = batch.size();
+    const PyCall& first = *batch[0]->call;
+    PyCall batched;
+    batched.token = first.token;
+    batched.eager = false;
+    for (size_t i = 0; i < first.ins.size(); ++i) {
+      TensorShape shape = first.ins[i].shape();
+      shape.InsertDim(0, n);
+      Tensor t;
+      if (n == 1) {
+        CHECK(t.CopyFrom(first.ins[i], shape));
+      } else {
+        t = Tensor(first.ins[i].dtype(), shape);
+        for (int64 j = 0; j < n; ++j) {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+              batch[j]->call->ins[i], &t, j));
+        }
+      }
+      batched.ins.push_back(std::move(t));
+    }
+
+    TF_RETURN_IF_ERROR(DoCallPyFunc(&batched, out_log_on_error));
+
+    for (Pending* p : batch) {
+      p->call->out.clear();
+    }
+    for (size_t i = 0; i < batched.out.size(); ++i) {
+      const Tensor& out = batched.out[i];
+      if (out.dims() == 0 || out.dim_size(0) != n) {
+        return errors::InvalidArgument(
+            i, "-th value returned by ", first.token, " has shape ",
+            out.shape().DebugString(), ", but a batch of ", n,
+            " elements was expected along the first dimension.");
+      }
+      TensorShape element_shape = out.shape();
+      element_shape.RemoveDim(0);
+      for (int64 j = 0; j < n; ++j) {
+        Tensor element;
+        if (n == 1) {
+          CHECK(element.CopyFrom(out, element_shape));
+        } else {
+          element = Tensor(out.dtype(), element_shape);
+          TF_RETURN_IF_ERROR(
+              batch_util::CopySliceToElement(out, &element, j));
+        }
+        batch[j]->call->out.push_back(std::move(element));
+      }
+    }
+    return Status::OK();
+  }
+
+  const size_t max_batch_size_;
+  mutex mu_;
+  condition_variable cv_;
+  std::deque<Pending*> pending_ GUARDED_BY(mu_);
+  // True while a call leads a batch.
+  bool running_ GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PyCallBatcher);
+};
+
 }  // end namespace
 
 // Outside anonymous namespace just to make the friend declaration in
@@ -418,6 +567,13 @@ class PyFuncOp : public OpKernel {
   explicit PyFuncOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("token", &token_));
     eager_ = type_string() == "EagerPyFunc";
+    if (!eager_) {
+      int max_batch_size;
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("max_batch_size", &max_batch_size));
+      if (max_batch_size > 0) {
+        batcher_.reset(new PyCallBatcher(max_batch_size));
+      }
+    }
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -428,11 +584,16 @@ class PyFuncOp : public OpKernel {
       call.ins.push_back(ctx->input(i));
     }
 
-    PyGILState_STATE py_threadstate;
-    py_threadstate = PyGILState_Ensure();
     bool log_on_error;
-    Status s = DoCallPyFunc(&call, &log_on_error);
-    PyGILState_Release(py_threadstate);
+    Status s;
+    if (batcher_) {
+      s = batcher_->Call(&call, &log_on_error);
+    } else {
+      PyGILState_STATE py_threadstate;
+      py_threadstate = PyGILState_Ensure();
+      s = DoCallPyFunc(&call, &log_on_error);
+      PyGILState_Release(py_threadstate);
+    }
 
     // Ensures that GIL is released even when !s.ok().
     if (!s.ok()) {
@@ -466,6 +627,9 @@ class PyFuncOp : public OpKernel {
   // i.e., if and only if the eager attribute is set.
   bool eager_;
 
+  // Combines concurrent calls when the python function is vectorized.
+  std::unique_ptr<PyCallBatcher> batcher_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(PyFuncOp);
 };
 
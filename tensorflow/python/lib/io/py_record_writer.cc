@@ -16,7 +16,9 @@ limitations under the License.
 #include "tensorflow/python/lib/io/py_record_writer.h"
 
 #include "tensorflow/c/tf_status_helper.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/platform/env.h"
@@ -29,20 +31,36 @@ PyRecordWriter::PyRecordWriter() {}
 
 PyRecordWriter* PyRecordWriter::New(const string& filename,
                                     const string& compression_type_string,
-                                    TF_Status* out_status) {
+                                    bool write_index, TF_Status* out_status) {
   std::unique_ptr<WritableFile> file;
   Status s = Env::Default()->NewWritableFile(filename, &file);
   if (!s.ok()) {
     Set_TF_Status_from_Status(out_status, s);
     return nullptr;
   }
-  PyRecordWriter* writer = new PyRecordWriter;
-  writer->file_ = std::move(file);
-
   RecordWriterOptions options =
       RecordWriterOptions::CreateRecordWriterOptions(compression_type_string);
+  std::unique_ptr<WritableFile> index_file;
+  if (write_index) {
+    if (options.compression_type != RecordWriterOptions::NONE) {
+      Set_TF_Status_from_Status(
+          out_status, errors::InvalidArgument(
+                          "Compressed record files cannot be indexed."));
+      return nullptr;
+    }
+    s = Env::Default()->NewWritableFile(RecordIndexFilename(filename),
+                                        &index_file);
+    if (!s.ok()) {
+      Set_TF_Status_from_Status(out_status, s);
+      return nullptr;
+    }
+  }
+  PyRecordWriter* writer = new PyRecordWriter;
+  writer->file_ = std::move(file);
+  writer->index_file_ = std::move(index_file);
 
-  writer->writer_.reset(new RecordWriter(writer->file_.get(), options));
+  writer->writer_.reset(new RecordWriter(writer->file_.get(), options,
+                                         writer->index_file_.get()));
   return writer;
 }
 
@@ -76,6 +94,14 @@ void PyRecordWriter::Close(TF_Status* out_status) {
     return;
   }
   file_.reset(nullptr);
+  if (index_file_ != nullptr) {
+    s = index_file_->Close();
+    if (!s.ok()) {
+      Set_TF_Status_from_Status(out_status, s);
+      return;
+    }
+    index_file_.reset(nullptr);
+  }
 }
 
 }  // namespace io
@@ -38,9 +38,12 @@ class PyRecordWriter {
  public:
   // TODO(vrv): make this take a shared proto to configure
   // the compression options.
+  //
+  // If `write_index` is true, the record index of the file is written to
+  // io::RecordIndexFilename(filename).
   static PyRecordWriter* New(const string& filename,
                              const string& compression_type_string,
-                             TF_Status* out_status);
+                             bool write_index, TF_Status* out_status);
   ~PyRecordWriter();
 
   bool WriteRecord(tensorflow::StringPiece record);
@@ -52,6 +55,7 @@ class PyRecordWriter {
 
   std::unique_ptr<io::RecordWriter> writer_;
   std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<WritableFile> index_file_;
   TF_DISALLOW_COPY_AND_ASSIGN(PyRecordWriter);
 };
 
@@ -89,12 +89,17 @@ class TFRecordWriter(object):
   """
 
   # TODO(josh11b): Support appending?
-  def __init__(self, path, options=None):
+  def __init__(self, path, options=None, write_index=False):
     """Opens file `path` and creates a `TFRecordWriter` writing to it.
 
     Args:
       path: The path to the TFRecords file.
       options: (optional) A TFRecordOptions object.
+      write_index: (optional) If true, also writes the offsets of the records
+        to the index file `path + ".index"`, which lets readers such as
+        `tf.contrib.data.IndexedTFRecordDataset` read any range of records
+        without reading the records before it. Only uncompressed files can be
+        indexed.
 
     Raises:
       IOError: If `path` cannot be opened for writing.
@@ -103,7 +108,8 @@ class TFRecordWriter(object):
 
     with errors.raise_exception_on_not_ok_status() as status:
       self._writer = pywrap_tensorflow.PyRecordWriter_New(
-          compat.as_bytes(path), compat.as_bytes(compression_type), status)
+          compat.as_bytes(path), compat.as_bytes(compression_type),
+          write_index, status)
 
   def __enter__(self):
     """Enter a `with` block."""
@@ -23,11 +23,13 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.framework import tensor_shape
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import clip_ops
 # Imports gradient definitions.
 from tensorflow.python.ops import data_flow_grad  # pylint: disable=unused-import
 from tensorflow.python.ops import data_flow_ops
+from tensorflow.python.ops import gen_lookup_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import variables
@@ -325,6 +327,108 @@ def embedding_lookup(
       transform_fn=None)
 
 
+class EmbeddingRowCache(object):
+  """A cache of the rows of an embedding on the device that looks them up.
+
+  In distributed training the rows of a partitioned embedding live on
+  parameter servers, and each worker fetches the rows of its ids every step.
+  When a few ids are much more frequent than the others, the cache keeps the
+  `capacity` most recently used rows on the worker, so that only the ids that
+  are not cached are sent to the parameter servers.
+
+  Each row is tagged with the `version` it was fetched at, e.g. the global
+  step, and is fetched again once it is more than `max_staleness` versions
+  old, so that the rows read from the cache lag the parameter servers by at
+  most `max_staleness` updates.  Gradients do not flow to the cached rows, so
+  the rows that are trained should be looked up with `max_staleness=0` or with
+  `embedding_lookup`.
+  """
+
+  def __init__(self,
+               dtype,
+               row_shape,
+               capacity,
+               max_staleness=0,
+               shared_name=None,
+               name=None):
+    """Creates a cache.
+
+    Args:
+      dtype: The type of the rows.
+      row_shape: The shape of a row, i.e. `shape(params)[1:]`.
+      capacity: The maximum number of rows in the cache.  0 disables it.
+      max_staleness: The number of versions after which a row is fetched
+        again.
+      shared_name: If non-empty, the cache is shared under this name across
+        sessions.
+      name: A name for the operation (optional).
+    """
+    self._dtype = dtypes.as_dtype(dtype)
+    self._row_shape = tensor_shape.as_shape(row_shape)
+    self._handle = gen_lookup_ops._embedding_row_cache(
+        dtype=self._dtype,
+        row_shape=self._row_shape,
+        capacity=capacity,
+        max_staleness=max_staleness,
+        shared_name=shared_name,
+        name=name)
+
+  @property
+  def handle(self):
+    return self._handle
+
+  def lookup(self,
+             params,
+             ids,
+             version,
+             partition_strategy="mod",
+             name=None,
+             max_norm=None):
+    """Looks up `ids` in `params`, reading the fresh rows from the cache.
+
+    Args:
+      params: The embedding, as for `embedding_lookup`.
+      ids: A `Tensor` with type `int32` or `int64` containing the ids to be
+        looked up in `params`.
+      version: A scalar `int64` `Tensor`, e.g. the global step.
+      partition_strategy: The partitioning strategy of `params`, as for
+        `embedding_lookup`.
+      name: A name for the operation (optional).
+      max_norm: If provided, embedding values are l2-normalized to the value
+        of max_norm.
+
+    Returns:
+      A `Tensor` of shape `shape(ids) + row_shape`, as `embedding_lookup`.
+    """
+    with ops.name_scope(name, "embedding_row_cache_lookup",
+                        [self._handle, ids, version]) as name:
+      ids = ops.convert_to_tensor(ids, name="ids")
+      version = math_ops.cast(version, dtypes.int64)
+      flat_ids = array_ops.reshape(ids, [-1])
+      values, miss_ids, miss_index = (
+          gen_lookup_ops._embedding_row_cache_lookup(
+              self._handle, flat_ids, version, dtype=self._dtype))
+      miss_rows = _embedding_lookup_and_transform(
+          params,
+          miss_ids,
+          partition_strategy=partition_strategy,
+          transform_fn=None)
+      rows = gen_lookup_ops._embedding_row_cache_update(
+          self._handle, values, miss_ids, miss_index, miss_rows, version)
+      rows = _clip(rows, flat_ids, max_norm)
+      ret = array_ops.reshape(
+          rows,
+          array_ops.concat(
+              [array_ops.shape(ids), self._row_shape.as_list()], 0),
+          name=name)
+      ret.set_shape(ids.get_shape().concatenate(self._row_shape))
+      return ret
+
+  def stats(self, name=None):
+    """Returns the hits, misses and size of the cache as `int64` scalars."""
+    return gen_lookup_ops._embedding_row_cache_stats(self._handle, name=name)
+
+
 def embedding_lookup_sparse(params,
                             sp_ids,
                             sp_weights,
@@ -2595,6 +2595,48 @@ class JpegTest(test_util.TensorFlowTestCase):
             lambda e: "Invalid JPEG data or crop window" in str(e)):
           sess.run(result)
 
+  def testDecodeAndResizeJpeg(self):
+    with self.test_session() as sess:
+      base = "tensorflow/core/lib/jpeg/testdata"
+      rgb = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      cmyk = io_ops.read_file(os.path.join(base, "jpeg_merge_test1_cmyk.jpg"))
+      contents = array_ops.stack([rgb, cmyk])
+
+      # The image is 256x128, so each size below picks the given ratio.
+      for size, ratio in [([64, 32], 4), ([60, 30], 4), ([33, 17], 4),
+                          ([32, 9], 8), ([100, 64], 2), ([200, 100], 1),
+                          ([300, 150], 1)]:
+        for channels in 1, 3:
+          # Explicit two stages: decode at the ratio + resize.
+          decoded = array_ops.stack([
+              image_ops.decode_jpeg(rgb, channels=channels, ratio=ratio),
+              image_ops.decode_jpeg(cmyk, channels=channels, ratio=ratio)
+          ])
+          expected = image_ops.resize_bilinear(decoded, size)
+
+          # Combined decode+resize.
+          images = gen_image_ops.decode_and_resize_jpeg(
+              contents, size, channels=channels)
+          self.assertAllEqual(expected.get_shape().as_list(),
+                              images.get_shape().as_list())
+          expected, images = sess.run([expected, images])
+          self.assertAllClose(expected, images)
+
+  def testDecodeAndResizeJpegEmptyBatch(self):
+    with self.test_session():
+      images = gen_image_ops.decode_and_resize_jpeg(
+          constant_op.constant([], dtype=dtypes.string), [10, 20])
+      self.assertEqual((0, 10, 20, 3), images.eval().shape)
+
+  def testDecodeAndResizeJpegInvalidInput(self):
+    with self.test_session():
+      base = "tensorflow/core/lib/jpeg/testdata"
+      jpeg0 = io_ops.read_file(os.path.join(base, "jpeg_merge_test1.jpg"))
+      images = gen_image_ops.decode_and_resize_jpeg(
+          array_ops.stack([jpeg0, "not a jpeg"]), [10, 20])
+      with self.assertRaisesOpError("Expected JPEG"):
+        images.eval()
+
   def testSynthetic(self):
     with self.test_session(use_gpu=True) as sess:
       # Encode it, then decode it, then encode it
@@ -3109,5 +3151,80 @@ class NonMaxSuppressionTest(test_util.TensorFlowTestCase):
       self.assertAllClose(selected_indices, [3, 0, 5])
 
 
+class BatchedNonMaxSuppressionTest(test_util.TensorFlowTestCase):
+
+  def _iou(self, box_i, box_j):
+    ymin_i, ymax_i = sorted([box_i[0], box_i[2]])
+    xmin_i, xmax_i = sorted([box_i[1], box_i[3]])
+    ymin_j, ymax_j = sorted([box_j[0], box_j[2]])
+    xmin_j, xmax_j = sorted([box_j[1], box_j[3]])
+    area_i = (ymax_i - ymin_i) * (xmax_i - xmin_i)
+    area_j = (ymax_j - ymin_j) * (xmax_j - xmin_j)
+    if area_i <= 0 or area_j <= 0:
+      return 0.0
+    intersection = (max(min(ymax_i, ymax_j) - max(ymin_i, ymin_j), 0.0) *
+                    max(min(xmax_i, xmax_j) - max(xmin_i, xmin_j), 0.0))
+    return intersection / (area_i + area_j - intersection)
+
+  def _npBatchedNms(self, boxes, scores, max_output_size, iou_threshold,
+                    score_threshold):
+    batch_size, num_boxes, num_classes = scores.shape
+    output_size = min(max_output_size, num_boxes)
+    selected_indices = np.zeros([batch_size, num_classes, output_size],
+                                dtype=np.int32)
+    num_valid = np.zeros([batch_size, num_classes], dtype=np.int32)
+    for b in range(batch_size):
+      for c in range(num_classes):
+        candidates = [i for i in range(num_boxes)
+                      if scores[b, i, c] > score_threshold]
+        candidates.sort(key=lambda i: -scores[b, i, c])  # pylint: disable=cell-var-from-loop
+        selected = []
+        for i in candidates:
+          if len(selected) >= output_size:
+            break
+          if all(self._iou(boxes[b, i], boxes[b, j]) <= iou_threshold
+                 for j in selected):
+            selected.append(i)
+        selected_indices[b, c, :len(selected)] = selected
+        num_valid[b, c] = len(selected)
+    return selected_indices, num_valid
+
+  def testMatchesPerClassSelection(self):
+    np.random.seed(7)
+    for use_gpu in [False, True]:
+      for batch_size, num_boxes, num_classes in [(1, 1, 1), (2, 10, 3),
+                                                 (3, 100, 5), (2, 200, 1)]:
+        corners = np.random.rand(batch_size, num_boxes, 2, 2) * 10
+        sizes = np.random.rand(batch_size, num_boxes, 1, 2) * 3
+        boxes_np = np.concatenate([corners[:, :, 0], corners[:, :, 0] +
+                                   sizes[:, :, 0]], axis=2).astype(np.float32)
+        # Distinct scores, so that the order of the boxes is well defined.
+        scores_np = np.random.permutation(
+            batch_size * num_boxes * num_classes).reshape(
+                batch_size, num_boxes, num_classes).astype(np.float32)
+        scores_np /= scores_np.size
+        for max_output_size, iou_threshold, score_threshold in [
+            (5, 0.5, 0.0), (num_boxes, 0.3, 0.5), (2 * num_boxes, 0.7, -1.0)]:
+          expected_indices, expected_num_valid = self._npBatchedNms(
+              boxes_np, scores_np, max_output_size, iou_threshold,
+              score_threshold)
+          with self.test_session(use_gpu=use_gpu):
+            selected_indices, num_valid = (
+                gen_image_ops.batched_non_max_suppression(
+                    boxes_np, scores_np, max_output_size, iou_threshold,
+                    score_threshold))
+            self.assertAllEqual(expected_indices, selected_indices.eval())
+            self.assertAllEqual(expected_num_valid, num_valid.eval())
+
+  def testStaticShape(self):
+    with self.test_session():
+      boxes = array_ops.placeholder(dtypes.float32, shape=[4, 20, 4])
+      scores = array_ops.placeholder(dtypes.float32, shape=[4, 20, 3])
+      selected_indices, num_valid = gen_image_ops.batched_non_max_suppression(
+          boxes, scores, 30, 0.5, 0.0)
+      self.assertEqual([4, 3, 20], selected_indices.get_shape().as_list())
+      self.assertEqual([4, 3], num_valid.get_shape().as_list())
+
+
 if __name__ == "__main__":
   googletest.main()
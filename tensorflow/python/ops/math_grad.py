@@ -225,6 +225,19 @@ def _SparseSegmentSqrtNWithNumSegmentsGrad(op, grad):
                                               dim0), None, None, None)
 
 
+@ops.RegisterGradient("FusedEmbeddingLookupSparse")
+def _FusedEmbeddingLookupSparseGrad(op, grad):
+  """Gradient for FusedEmbeddingLookupSparse."""
+  # Like the gradient of Gather, the gradient of params is sparse: the scaled
+  # gradient of each looked up row, at its id.
+  values = gen_math_ops.fused_embedding_lookup_sparse_grad(
+      grad, op.inputs[2], op.inputs[3], combiner=op.get_attr("combiner"))
+  params_shape = array_ops.shape(op.inputs[0], out_type=dtypes.int64)
+  params_shape = math_ops.to_int32(params_shape)
+  return (ops.IndexedSlices(values, op.inputs[1], params_shape), None, None,
+          None)
+
+
 def _SegmentMinOrMaxGrad(op, grad, is_sorted):
   """Gradient for SegmentMin and (unsorted) SegmentMax. They share similar code."""
   zeros = array_ops.zeros(array_ops.shape(op.inputs[0]),
@@ -479,6 +479,23 @@ def _SparseSoftmaxCrossEntropyWithLogitsGrad(op, grad_0, _):
   return _BroadcastMul(grad_0, sparse_softmax_grad_without_gradient), None
 
 
+@ops.RegisterGradient("SparseSoftmaxCrossEntropyWithProjection")
+def _SparseSoftmaxCrossEntropyWithProjectionGrad(op, grad_0, _):
+  """Gradient function for SparseSoftmaxCrossEntropyWithProjection."""
+  # The log_sum_exp output (output[1]) only feeds the gradient, so its
+  # gradient is ignored. There is no gradient for the labels.
+  inputs_grad, weights_grad, biases_grad = (
+      gen_nn_ops.sparse_softmax_cross_entropy_with_projection_grad(
+          op.inputs[0],
+          op.inputs[1],
+          op.inputs[2],
+          op.inputs[3],
+          op.outputs[1],
+          grad_0,
+          chunk_size=op.get_attr("chunk_size")))
+  return inputs_grad, weights_grad, biases_grad, None
+
+
 @ops.RegisterGradient("Conv2D")
 def _Conv2DGrad(op, grad):
   dilations = op.get_attr("dilations")
@@ -163,7 +163,8 @@ class CleanupFunc(object):
     _py_funcs.remove(self._token)
 
 
-def _internal_py_func(func, inp, Tout, stateful=None, eager=False, name=None):
+def _internal_py_func(func, inp, Tout, stateful=None, eager=False, name=None,
+                      max_batch_size=None):
   """See documentation for py_func and eager_py_func."""
 
   is_list_or_tuple = False
@@ -206,10 +207,12 @@ def _internal_py_func(func, inp, Tout, stateful=None, eager=False, name=None):
   else:
     if stateful:
       result = gen_script_ops._py_func(
-          input=inp, token=token, Tout=Tout, name=name)
+          input=inp, token=token, Tout=Tout, max_batch_size=max_batch_size,
+          name=name)
     else:
       result = gen_script_ops._py_func_stateless(
-          input=inp, token=token, Tout=Tout, name=name)
+          input=inp, token=token, Tout=Tout, max_batch_size=max_batch_size,
+          name=name)
   # pylint: enable=protected-access
   return result if is_list_or_tuple else result[0]
 
@@ -243,7 +246,7 @@ def eager_py_func(func, inp, Tout, name=None):
   return _internal_py_func(func=func, inp=inp, Tout=Tout, eager=True, name=name)
 
 
-def py_func(func, inp, Tout, stateful=True, name=None):
+def py_func(func, inp, Tout, stateful=True, name=None, max_batch_size=None):
   """Wraps a python function and uses it as a TensorFlow op.
 
   Given a python function `func`, which takes numpy arrays as its
@@ -272,6 +275,21 @@ def py_func(func, inp, Tout, stateful=True, name=None):
     `tf.py_func()` and you must pin the created operation to a device in that
     server (e.g. using `with tf.device():`).
 
+  Only one thread can run Python code at a time, so concurrent runs of the
+  operation, e.g. in `tf.data.Dataset.map()` with `num_parallel_calls`,
+  serialize on `func`. If `func` is vectorized, pass `max_batch_size` to
+  combine the runs that wait for each other into a single call:
+
+  ```python
+  def my_func(x):
+    # x has the shape of `inp` with an additional first dimension holding
+    # the elements of up to 64 concurrent runs.
+    return np.sinh(x)
+  dataset = dataset.map(
+      lambda x: tf.py_func(my_func, [x], tf.float32, max_batch_size=64),
+      num_parallel_calls=64)
+  ```
+
   Args:
     func: A Python function, which accepts a list of NumPy `ndarray` objects
       having element types that match the corresponding `tf.Tensor` objects
@@ -292,12 +310,18 @@ def py_func(func, inp, Tout, stateful=True, name=None):
       common subexpression elimination are only performed on stateless
       operations.
     name: A name for the operation (optional).
+    max_batch_size: (Optional.) If set, `func` is vectorized: it is called
+      with the inputs of up to `max_batch_size` concurrent runs of the
+      operation with the same input shapes, stacked along a new first
+      dimension, and must return its outputs stacked the same way. Runs that
+      do not overlap are passed to `func` as a batch of one.
 
   Returns:
     A list of `Tensor` or a single `Tensor` which `func` computes.
   """
   return _internal_py_func(
-      func=func, inp=inp, Tout=Tout, stateful=stateful, eager=False, name=name)
+      func=func, inp=inp, Tout=Tout, stateful=stateful, eager=False, name=name,
+      max_batch_size=max_batch_size)
 
 
 # TODO(akshayka): PyFuncs where the 'eager' attribute is set to True should be
@@ -174,6 +174,30 @@ def _SparseTensorDenseMatMulGrad(op, grad):
   return (None, a_values_grad, None, b_grad)
 
 
+ops.NotDifferentiable("SparseTensorToCSRSparseMatrix")
+
+
+@ops.RegisterGradient("CSRSparseMatrixMatMul")
+def _CSRSparseMatrixMatMulGrad(op, grad):
+  """Gradient for the dense tensor in the CSRSparseMatrixMatMul op.
+
+  Like for SparseTensorDenseMatMul, the gradient is the product of the adjoint
+  of A with the incoming gradient, which the transpose held in the CSR matrix
+  computes row by row.
+  """
+  a, b = op.inputs
+  adj_a = op.get_attr("adjoint_a")
+  adj_b = op.get_attr("adjoint_b")
+  if b.dtype.base_dtype in (ops.dtypes.complex64, ops.dtypes.complex128):
+    raise NotImplementedError("CSRSparseMatrixMatMul op does not support "
+                              "complex gradients.")
+  b_grad = gen_sparse_ops._csr_sparse_matrix_mat_mul(  # pylint: disable=protected-access
+      a, grad, adjoint_a=not adj_a)
+  if adj_b:
+    b_grad = array_ops.transpose(b_grad)
+  return (None, b_grad)
+
+
 @ops.RegisterGradient("SparseDenseCwiseAdd")
 def _SparseDenseCwiseAddGrad(unused_op, unused_grad):
   raise NotImplementedError("Gradient for SparseDenseCwiseAdd is currently not"
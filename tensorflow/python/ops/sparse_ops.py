@@ -1795,6 +1795,71 @@ def sparse_tensor_dense_matmul(sp_a,
         adjoint_b=adjoint_b)
 
 
+def sparse_tensor_to_csr_sparse_matrix(sp_input, name=None):
+  """Converts a `SparseTensor` of rank 2 to a CSR sparse matrix.
+
+  The result is a scalar variant tensor holding the matrix in compressed sparse
+  row format, together with its transpose.  Converting a matrix that is used in
+  many products once, for example the adjacency matrix of a graph shared by the
+  layers of a network, and passing the result to each
+  `csr_sparse_matrix_dense_matmul` avoids regrouping its entries in every
+  product.
+
+  The matrix is kept in the memory of the device that converts it, and must be
+  multiplied on a device of the same type.  No gradient is provided with
+  respect to the values of `sp_input`.
+
+  Args:
+    sp_input: `SparseTensor` of rank 2, of type `float32`, `float64`,
+      `complex64` or `complex128`.
+    name: A name prefix for the returned tensors (optional)
+
+  Returns:
+    A scalar `variant` tensor.
+  """
+  sp_input = _convert_to_sparse_tensor(sp_input)
+  with ops.name_scope(name, "SparseTensorToCSRSparseMatrix",
+                      [sp_input.indices, sp_input.values]) as name:
+    return gen_sparse_ops._sparse_tensor_to_csr_sparse_matrix(
+        indices=sp_input.indices,
+        values=sp_input.values,
+        dense_shape=sp_input.dense_shape,
+        name=name)
+
+
+def csr_sparse_matrix_dense_matmul(csr_a,
+                                   b,
+                                   adjoint_a=False,
+                                   adjoint_b=False,
+                                   name=None):
+  """Multiply a CSR sparse matrix "A" by dense matrix "B".
+
+  Computes the same product as `sparse_tensor_dense_matmul`, but rows of the
+  output are partitioned across threads on CPU and computed without atomics on
+  GPU.
+
+  Args:
+    csr_a: A scalar `variant` tensor returned by
+      `sparse_tensor_to_csr_sparse_matrix`.
+    b: A dense Matrix with the same dtype as the values of `csr_a`.
+    adjoint_a: Use the adjoint of A in the matrix multiply.  If A is complex,
+      this is transpose(conj(A)).  Otherwise it's transpose(A).
+    adjoint_b: Use the adjoint of B in the matrix multiply.  If B is complex,
+      this is transpose(conj(B)).  Otherwise it's transpose(B).
+    name: A name prefix for the returned tensors (optional)
+
+  Returns:
+    A dense matrix (pseudo-code in dense np.matrix notation):
+      `A = A.H if adjoint_a else A`
+      `B = B.H if adjoint_b else B`
+      `return A*B`
+  """
+  with ops.name_scope(name, "CSRSparseMatrixMatMul", [csr_a, b]) as name:
+    b = ops.convert_to_tensor(b, name="b")
+    return gen_sparse_ops._csr_sparse_matrix_mat_mul(
+        a=csr_a, b=b, adjoint_a=adjoint_a, adjoint_b=adjoint_b, name=name)
+
+
 def sparse_softmax(sp_input, name=None):
   """Applies softmax to a batched N-D `SparseTensor`.
 
@@ -55,6 +55,7 @@ class _GraphTensorArray(object):
                infer_shape=True,
                element_shape=None,
                colocate_with_first_write_call=True,
+               contiguous=False,
                name=None):
     """Constructs a graph mode TensorArray.
 
@@ -84,6 +85,10 @@ class _GraphTensorArray(object):
         (write operations include `write`, `unstack`, and `split`).  If `False`,
         the TensorArray will be placed on the device determined by the
         device context available during its initialization.
+      contiguous: (optional) Python bool: If true, the elements are stored in
+        one buffer once their shape is fully defined.  Writes are copied into
+        the buffer, and `stack`, `concat` and `gather` of consecutive indices
+        return it without copying.  Ignored if `dynamic_size` is true.
       name: A name for the operation (optional).
 
     Raises:
@@ -154,6 +159,7 @@ class _GraphTensorArray(object):
               identical_element_shapes=infer_shape,
               dynamic_size=dynamic_size,
               clear_after_read=clear_after_read,
+              contiguous=contiguous,
               tensor_array_name=tensor_array_name,
               name=scope)
         if colocate_with_first_write_call:
@@ -473,6 +479,7 @@ class _EagerTensorArray(object):
                infer_shape=True,
                element_shape=None,
                colocate_with_first_write_call=True,
+               contiguous=False,
                name=None):
     """Constructs an Eager mode TensorArray.
 
@@ -491,13 +498,14 @@ class _EagerTensorArray(object):
       infer_shape: used for error checking, same semantics as TensorArray.
       element_shape: used for error checking, same semantics as TensorArray.
       colocate_with_first_write_call: unsupported.
+      contiguous: unused.
       name: unsupported.
 
     Raises:
       ValueError: handle or flow are supplied, or if size is not supplied.
     """
 
-    del (flow, tensor_array_name, name)  # not meaningful in Eager
+    del (flow, tensor_array_name, contiguous, name)  # not meaningful in Eager
 
     if handle is not None:
       raise ValueError("TensorArray handles are not supported in Eager mode.")
@@ -730,6 +738,7 @@ class TensorArray(object):
                infer_shape=True,
                element_shape=None,
                colocate_with_first_write_call=True,
+               contiguous=False,
                name=None):
     """Construct a new TensorArray or wrap an existing TensorArray handle.
 
@@ -766,6 +775,10 @@ class TensorArray(object):
         (write operations include `write`, `unstack`, and `split`).  If `False`,
         the TensorArray will be placed on the device determined by the
         device context available during its initialization.
+      contiguous: (optional) Python bool: If true, the elements are stored in
+        one buffer once their shape is fully defined.  Writes are copied into
+        the buffer, and `stack`, `concat` and `gather` of consecutive indices
+        return it without copying.  Ignored if `dynamic_size` is true.
       name: A name for the operation (optional).
 
     Raises:
@@ -788,6 +801,7 @@ class TensorArray(object):
         infer_shape=infer_shape,
         element_shape=element_shape,
         colocate_with_first_write_call=colocate_with_first_write_call,
+        contiguous=contiguous,
         name=name)
 
   @property
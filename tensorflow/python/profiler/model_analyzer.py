@@ -42,6 +42,8 @@ ALL_ADVICE = {
     'AcceleratorUtilizationChecker': {},
     'JobChecker': {},  # Only available internally.
     'OperationChecker': {},
+    'PeakMemoryChecker': {},
+    'CriticalPathChecker': {},
 }
 
 
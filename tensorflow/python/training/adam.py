@@ -37,7 +37,7 @@ class AdamOptimizer(optimizer.Optimizer):
   """
 
   def __init__(self, learning_rate=0.001, beta1=0.9, beta2=0.999, epsilon=1e-8,
-               use_locking=False, name="Adam"):
+               use_locking=False, name="Adam", use_multi_apply=False):
     """Construct a new Adam optimizer.
 
     Initialization:
@@ -88,12 +88,17 @@ class AdamOptimizer(optimizer.Optimizer):
       use_locking: If True use locks for update operations.
       name: Optional name for the operations created when applying gradients.
         Defaults to "Adam".
+      use_multi_apply: If `True`, dense gradients of resource variables are
+        applied by one `ResourceMultiApplyAdam` op per device and dtype,
+        instead of one op per variable, which saves kernel launches for models
+        with many small variables.
     """
     super(AdamOptimizer, self).__init__(use_locking, name)
     self._lr = learning_rate
     self._beta1 = beta1
     self._beta2 = beta2
     self._epsilon = epsilon
+    self._multi_apply_enabled = use_multi_apply
 
     # Tensor versions of the constructor arguments, created in _prepare().
     self._lr_t = None
@@ -171,6 +176,23 @@ class AdamOptimizer(optimizer.Optimizer):
         math_ops.cast(self._epsilon_t, grad.dtype.base_dtype),
         grad, use_locking=self._use_locking)
 
+  def _use_multi_apply(self):
+    return self._multi_apply_enabled
+
+  def _resource_apply_multi(self, grads, var_list):
+    dtype = grads[0].dtype.base_dtype
+    return training_ops.resource_multi_apply_adam(
+        [var.handle for var in var_list],
+        [self.get_slot(var, "m").handle for var in var_list],
+        [self.get_slot(var, "v").handle for var in var_list],
+        math_ops.cast(self._beta1_power, dtype),
+        math_ops.cast(self._beta2_power, dtype),
+        math_ops.cast(self._lr_t, dtype),
+        math_ops.cast(self._beta1_t, dtype),
+        math_ops.cast(self._beta2_t, dtype),
+        math_ops.cast(self._epsilon_t, dtype),
+        grads, use_locking=self._use_locking)
+
   def _apply_sparse_shared(self, grad, var, indices, scatter_add):
     beta1_power = math_ops.cast(self._beta1_power, var.dtype.base_dtype)
     beta2_power = math_ops.cast(self._beta2_power, var.dtype.base_dtype)
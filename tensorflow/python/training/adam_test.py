@@ -219,6 +219,37 @@ class AdamOptimizerTest(test.TestCase):
   def testResourceBasic(self):
     self.doTestBasic(use_resource=True)
 
+  def testResourceMultiApply(self):
+    for dtype in [dtypes.half, dtypes.float32, dtypes.float64]:
+      with self.test_session(graph=ops.Graph(), use_gpu=True):
+        np.random.seed(1)
+        shapes = [[2], [3, 5], [], [70, 90]]
+        var_np = [np.random.rand(*s).astype(dtype.as_numpy_dtype)
+                  for s in shapes]
+        grads_np = [np.random.rand(*s).astype(dtype.as_numpy_dtype)
+                    for s in shapes]
+        m_np = [0.0] * len(shapes)
+        v_np = [0.0] * len(shapes)
+        # The last variable is a ref variable, which is updated separately.
+        var = [resource_variable_ops.ResourceVariable(x) for x in var_np[:-1]]
+        var.append(variables.Variable(var_np[-1]))
+        grads = [constant_op.constant(g) for g in grads_np]
+
+        opt = adam.AdamOptimizer(use_multi_apply=True)
+        update = opt.apply_gradients(zip(grads, var))
+        op_types = [op.type for op in ops.get_default_graph().get_operations()]
+        self.assertEqual(1, op_types.count("ResourceMultiApplyAdam"))
+        self.assertEqual(0, op_types.count("ResourceApplyAdam"))
+        self.assertEqual(1, op_types.count("ApplyAdam"))
+        variables.global_variables_initializer().run()
+
+        for t in range(1, 4):
+          update.run()
+          for i in range(len(shapes)):
+            var_np[i], m_np[i], v_np[i] = adam_update_numpy(
+                var_np[i], grads_np[i], t, m_np[i], v_np[i])
+            self.assertAllCloseAccordingToType(var_np[i], var[i].eval())
+
   def testTensorLearningRate(self):
     for dtype in [dtypes.half, dtypes.float32, dtypes.float64]:
       with self.test_session():
@@ -42,7 +42,8 @@ class MomentumOptimizer(optimizer.Optimizer):
   """
 
   def __init__(self, learning_rate, momentum,
-               use_locking=False, name="Momentum", use_nesterov=False):
+               use_locking=False, name="Momentum", use_nesterov=False,
+               use_multi_apply=False):
     """Construct a new Momentum optimizer.
 
     Args:
@@ -57,6 +58,10 @@ class MomentumOptimizer(optimizer.Optimizer):
         This implementation always computes gradients at the value of the
         variable(s) passed to the optimizer. Using Nesterov Momentum makes the
         variable(s) track the values called `theta_t + mu*v_t` in the paper.
+      use_multi_apply: If `True`, dense gradients of resource variables are
+        applied by one `ResourceMultiApplyMomentum` op per device and dtype,
+        instead of one op per variable, which saves kernel launches for models
+        with many small variables.
 
     @compatibility(eager)
     When eager execution is enabled, learning_rate and momentum can each be a
@@ -69,6 +74,7 @@ class MomentumOptimizer(optimizer.Optimizer):
     self._learning_rate = learning_rate
     self._momentum = momentum
     self._use_nesterov = use_nesterov
+    self._multi_apply_enabled = use_multi_apply
 
   def _create_slots(self, var_list):
     for v in var_list:
@@ -105,6 +111,20 @@ class MomentumOptimizer(optimizer.Optimizer):
         use_locking=self._use_locking,
         use_nesterov=self._use_nesterov)
 
+  def _use_multi_apply(self):
+    return self._multi_apply_enabled
+
+  def _resource_apply_multi(self, grads, var_list):
+    dtype = grads[0].dtype.base_dtype
+    return training_ops.resource_multi_apply_momentum(
+        [var.handle for var in var_list],
+        [self.get_slot(var, "momentum").handle for var in var_list],
+        math_ops.cast(self._learning_rate_tensor, dtype),
+        grads,
+        math_ops.cast(self._momentum_tensor, dtype),
+        use_locking=self._use_locking,
+        use_nesterov=self._use_nesterov)
+
   def _apply_sparse(self, grad, var):
     mom = self.get_slot(var, "momentum")
     return training_ops.sparse_apply_momentum(
@@ -193,6 +193,42 @@ class MomentumOptimizerTest(test.TestCase):
           self.assertAllClose(var0_np, var0.eval())
           self.assertAllClose(var1_np, var1.eval())
 
+  def testResourceMultiApply(self):
+    for dtype in [dtypes.half, dtypes.float32, dtypes.float64]:
+      for use_nesterov in [False, True]:
+        with self.test_session(graph=ops.Graph(), use_gpu=True):
+          np.random.seed(1)
+          shapes = [[2], [3, 5], [], [70, 90]]
+          var_np = [np.random.rand(*s).astype(dtype.as_numpy_dtype)
+                    for s in shapes]
+          grads_np = [np.random.rand(*s).astype(dtype.as_numpy_dtype)
+                      for s in shapes]
+          accum_np = [np.zeros_like(x) for x in var_np]
+          var = [resource_variable_ops.ResourceVariable(x) for x in var_np]
+          grads = [constant_op.constant(g) for g in grads_np]
+
+          mom_opt = momentum_lib.MomentumOptimizer(
+              learning_rate=2.0, momentum=0.9, use_nesterov=use_nesterov,
+              use_multi_apply=True)
+          mom_update = mom_opt.apply_gradients(zip(grads, var))
+          op_types = [
+              op.type for op in ops.get_default_graph().get_operations()
+          ]
+          self.assertEqual(1, op_types.count("ResourceMultiApplyMomentum"))
+          self.assertEqual(0, op_types.count("ResourceApplyMomentum"))
+          variables.global_variables_initializer().run()
+
+          for _ in range(3):
+            mom_update.run()
+            for i in range(len(shapes)):
+              if use_nesterov:
+                var_np[i], accum_np[i] = self._update_nesterov_momentum_numpy(
+                    var_np[i], accum_np[i], grads_np[i], 2.0, 0.9)
+              else:
+                accum_np[i] = accum_np[i] * 0.9 + grads_np[i]
+                var_np[i] = var_np[i] - 2.0 * accum_np[i]
+              self.assertAllCloseAccordingToType(var_np[i], var[i].eval())
+
   def testSparseNesterovMomentum(self):
     for dtype in [dtypes.float32, dtypes.float64]:
       with self.test_session():
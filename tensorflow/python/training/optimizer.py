@@ -517,15 +517,22 @@ class Optimizer(object):
     update_ops = []
     with ops.name_scope(name, self._name) as name:
       self._prepare()
+      multi_apply_grads_and_vars = []
       for grad, var, processor in converted_grads_and_vars:
         if grad is None:
           continue
+        if (self._use_multi_apply() and
+            isinstance(processor, _DenseResourceVariableProcessor) and
+            isinstance(grad, ops.Tensor) and var.constraint is None):
+          multi_apply_grads_and_vars.append((grad, var))
+          continue
         # We colocate all ops created in _apply_dense or _apply_sparse
         # on the same device as the variable.
         # TODO(apassos): figure out how to get the variable name here.
         scope_name = var.op.name if context.in_graph_mode() else ""
         with ops.name_scope("update_" + scope_name), ops.colocate_with(var):
           update_ops.append(processor.update_op(self, grad))
+      update_ops.extend(self._multi_apply(multi_apply_grads_and_vars))
       if global_step is None:
         apply_updates = self._finish(update_ops, name)
       else:
@@ -689,6 +696,52 @@ class Optimizer(object):
     """
     raise NotImplementedError()
 
+  def _use_multi_apply(self):
+    """Whether to update dense resource variables with `_resource_apply_multi`.
+
+    Returns:
+      `False` by default. Optimizers that implement `_resource_apply_multi`
+      may return `True`, in which case the dense gradients of unconstrained
+      resource variables are applied by `_resource_apply_multi`, to all the
+      variables with the same device and dtype at once, instead of by
+      `_resource_apply_dense`.
+    """
+    return False
+
+  def _resource_apply_multi(self, grads, handles):
+    """Add ops to apply dense gradients to the variables in `handles`.
+
+    Args:
+      grads: a list of `Tensor`s representing the gradients.
+      handles: a list of `Tensor`s of dtype `resource` which point to the
+       variables to be updated, all of the same dtype and on the same device.
+
+    Returns:
+      An `Operation` which updates the values of the variables.
+    """
+    raise NotImplementedError()
+
+  def _multi_apply(self, grads_and_vars):
+    """Applies `grads_and_vars` with one `_resource_apply_multi` per device.
+
+    Args:
+      grads_and_vars: A list of (dense gradient, resource variable) pairs.
+
+    Returns:
+      A list of `Operation`s which update the variables.
+    """
+    groups = {}
+    for grad, var in grads_and_vars:
+      key = (var.device, var.dtype.base_dtype)
+      groups.setdefault(key, []).append((grad, var))
+    update_ops = []
+    for key in sorted(groups, key=lambda k: (k[0], k[1].name)):
+      grads, var_list = zip(*groups[key])
+      with ops.name_scope("update_multi"), ops.colocate_with(var_list[0]):
+        update_ops.append(
+            self._resource_apply_multi(list(grads), list(var_list)))
+    return update_ops
+
   def _resource_apply_sparse_duplicate_indices(self, grad, handle, indices):
     """Add ops to apply sparse gradients to `handle`, with repeated indices.
 
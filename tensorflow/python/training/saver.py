@@ -198,8 +198,21 @@ class BaseSaverBuilder(object):
       return resource_variable_ops.shape_safe_assign_variable_handle(
           self.handle_op, self._var_shape, restored_tensor)
 
-  def __init__(self, write_version=saver_pb2.SaverDef.V2):
+  def __init__(self, write_version=saver_pb2.SaverDef.V2, async_save=False):
+    """Creates a `BaseSaverBuilder`.
+
+    Args:
+      write_version: The checkpoint format, see `Saver`.
+      async_save: If `True`, the save op only snapshots the tensors and the
+        checkpoint is written in the background by the V2 format, see `Saver`.
+
+    Raises:
+      ValueError: If `async_save` is set without the V2 format.
+    """
+    if async_save and write_version != saver_pb2.SaverDef.V2:
+      raise ValueError("async_save requires the V2 checkpoint format.")
     self._write_version = write_version
+    self._async_save = async_save
 
   def save_op(self, filename_tensor, saveables):
     """Create an Op to save 'saveables'.
@@ -236,6 +249,9 @@ class BaseSaverBuilder(object):
     elif self._write_version == saver_pb2.SaverDef.V2:
       # "filename_tensor" is interpreted *NOT AS A FILENAME*, but as a prefix
       # of a V2 checkpoint: e.g. "/fs/train/ckpt-<step>/tmp/worker<i>-<step>".
+      if self._async_save:
+        return gen_io_ops._async_save_v2(filename_tensor, tensor_names,
+                                         tensor_slices, tensors)
       return io_ops.save_v2(filename_tensor, tensor_names, tensor_slices,
                             tensors)
     else:
@@ -749,6 +765,15 @@ class BaseSaverBuilder(object):
       # Add the Constant string tensor for the filename.
       filename_tensor = constant_op.constant(filename or "model")
 
+      if self._async_save:
+        if sharded:
+          raise ValueError("async_save does not support sharded savers.")
+        if context.in_graph_mode():
+          # Found by Saver.wait_for_async_saves() next to the filename tensor.
+          # pylint: disable=protected-access
+          gen_io_ops._wait_for_async_save_v2(
+              filename_tensor, name=_WAIT_FOR_ASYNC_SAVE_OP_NAME)
+
       # Add the save ops.
       if sharded:
         per_device = self._GroupByDevices(saveables)
@@ -797,6 +822,11 @@ class BaseSaverBuilder(object):
           version=self._write_version)
 
 
+# The name of the op that waits for the checkpoints of an async saver, in the
+# name scope of its filename tensor.
+_WAIT_FOR_ASYNC_SAVE_OP_NAME = "wait_for_async_save"
+
+
 def _get_saver_or_default():
   """Returns the saver from SAVERS collection, or creates a default one.
 
@@ -1122,7 +1152,8 @@ class Saver(object):
                write_version=saver_pb2.SaverDef.V2,
                pad_step_number=False,
                save_relative_paths=False,
-               filename=None):
+               filename=None,
+               async_save=False):
     """Creates a `Saver`.
 
     The constructor adds ops to save and restore variables.
@@ -1200,6 +1231,13 @@ class Saver(object):
         checkpoint directory and reload from the copied directory.
       filename: If known at graph construction time, filename used for variable
         loading/saving.
+      async_save: If `True`, `save()` only snapshots the variables into host
+        memory, and the checkpoint is written by a background thread while
+        training continues.  Call `wait_for_async_saves()` to wait for the
+        checkpoints and record them in the checkpoint state file.  Requires
+        the V2 format and a saver that is not sharded.  At most
+        `TF_ASYNC_CHECKPOINT_MAX_PENDING_BYTES` bytes of snapshots are pending
+        (by default, `save()` waits for the previous checkpoint).
 
     Raises:
       TypeError: If `var_list` is invalid.
@@ -1235,6 +1273,9 @@ class Saver(object):
     self._write_version = write_version
     self._pad_step_number = pad_step_number
     self._filename = filename
+    self._async_save = async_save
+    # The checkpoints that save() writes in the background.
+    self._pending_async_saves = []
     if not defer_build and context.in_graph_mode():
       self.build()
     if self.saver_def:
@@ -1260,7 +1301,8 @@ class Saver(object):
 
     if not self.saver_def or context.in_eager_mode():
       if self._builder is None:
-        self._builder = BaseSaverBuilder(self._write_version)
+        self._builder = BaseSaverBuilder(
+            self._write_version, async_save=self._async_save)
       if self._var_list is None:
         # pylint: disable=protected-access
         self._var_list = variables._all_saveable_objects()
@@ -1536,6 +1578,10 @@ class Saver(object):
       write_state: `Boolean` indicating whether or not to write the
         `CheckpointStateProto`.
 
+    With `async_save`, the checkpoint files are written in the background
+    after this returns, and `wait_for_async_saves()` writes the
+    `CheckpointStateProto`.
+
     Returns:
       A string: path prefix used for the checkpoint files.  If the saver is
         sharded, this string ends with: '-?????-of-nnnnn' where 'nnnnn'
@@ -1597,7 +1643,12 @@ class Saver(object):
           model_checkpoint_path = self.saver_def.save_tensor_name
 
         model_checkpoint_path = compat.as_str(model_checkpoint_path)
-        if write_state:
+        if self._async_save:
+          # The checkpoint state is written once the checkpoint is.
+          self._pending_async_saves.append(
+              (model_checkpoint_path, save_path_parent, latest_filename,
+               meta_graph_suffix, write_state))
+        elif write_state:
           self._RecordLastCheckpoint(model_checkpoint_path)
           _update_checkpoint_state(
               save_dir=save_path_parent,
@@ -1625,6 +1676,50 @@ class Saver(object):
     else:
       return model_checkpoint_path
 
+  def wait_for_async_saves(self, sess):
+    """Waits for the checkpoints that `save()` writes in the background.
+
+    Only the checkpoints of a `Saver` created with `async_save=True` are
+    written in the background.  Once each of them is written, this records it
+    as `save()` does otherwise: it updates the `CheckpointStateProto` if
+    `write_state` was set, and deletes old checkpoints.
+
+    Args:
+      sess: A Session to use to wait for the checkpoints.
+
+    Returns:
+      A list of the paths of the checkpoints written since the last call, in
+      the order they were saved.
+
+    Raises:
+      errors.OpError: The error writing a checkpoint.  The checkpoints saved
+        after it are still pending.
+    """
+    written = []
+    while self._pending_async_saves:
+      (model_checkpoint_path, save_dir, latest_filename, meta_graph_suffix,
+       write_state) = self._pending_async_saves.pop(0)
+      if context.in_graph_mode():
+        scope = self.saver_def.filename_tensor_name.rpartition("/")[0]
+        wait_op_name = (scope + "/" if scope else "") + (
+            _WAIT_FOR_ASYNC_SAVE_OP_NAME)
+        sess.run(wait_op_name,
+                 {self.saver_def.filename_tensor_name: model_checkpoint_path})
+      else:
+        # pylint: disable=protected-access
+        gen_io_ops._wait_for_async_save_v2(model_checkpoint_path)
+      written.append(model_checkpoint_path)
+      if write_state:
+        self._RecordLastCheckpoint(model_checkpoint_path)
+        _update_checkpoint_state(
+            save_dir=save_dir,
+            model_checkpoint_path=model_checkpoint_path,
+            all_model_checkpoint_paths=self.last_checkpoints,
+            latest_filename=latest_filename,
+            save_relative_paths=self._save_relative_paths)
+        self._MaybeDeleteOldCheckpoints(meta_graph_suffix=meta_graph_suffix)
+    return written
+
   def export_meta_graph(self,
                         filename=None,
                         collection_list=None,
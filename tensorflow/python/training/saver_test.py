@@ -259,6 +259,39 @@ class SaverTest(test.TestCase):
       save2.restore(sess, save_path)
       self.assertEquals(self.evaluate(v), [1])
 
+  def testAsyncSave(self):
+    save_dir = os.path.join(self.get_temp_dir(), "async_save")
+    os.mkdir(save_dir)
+    save_path = os.path.join(save_dir, "ckpt")
+    with self.test_session(graph=ops_lib.Graph()) as sess:
+      v0 = variables.Variable(10.0, name="v0")
+      v1 = resource_variable_ops.ResourceVariable(20.0, name="v1")
+      sess.run(variables.global_variables_initializer())
+      save = saver_module.Saver([v0, v1], async_save=True)
+      path0 = save.save(sess, save_path, global_step=0)
+      # The snapshot is taken by save(), whatever changes afterwards.
+      sess.run([v0.assign(11.0), v1.assign(21.0)])
+      path1 = save.save(sess, save_path, global_step=1)
+      self.assertEqual([path0, path1], save.wait_for_async_saves(sess))
+      self.assertEqual([], save.wait_for_async_saves(sess))
+      self.assertEqual(path1, saver_module.latest_checkpoint(save_dir))
+      self.assertEqual([path0, path1], save.last_checkpoints)
+
+      sess.run([v0.assign(0.0), v1.assign(0.0)])
+      save.restore(sess, path0)
+      self.assertEqual([10.0, 20.0], sess.run([v0, v1]))
+      save.restore(sess, path1)
+      self.assertEqual([11.0, 21.0], sess.run([v0, v1]))
+
+  def testAsyncSaveNotSharded(self):
+    with ops_lib.Graph().as_default():
+      v = variables.Variable(10.0, name="v")
+      with self.assertRaisesRegexp(ValueError, "sharded"):
+        saver_module.Saver([v], sharded=True, async_save=True)
+      with self.assertRaisesRegexp(ValueError, "V2"):
+        saver_module.Saver(
+            [v], write_version=saver_pb2.SaverDef.V1, async_save=True)
+
   def testSaveCopyRestoreWithSaveRelativePaths(self):
     """Save, copy checkpoint dir and restore from copied dir.
 
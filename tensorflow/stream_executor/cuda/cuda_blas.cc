@@ -35,7 +35,9 @@ limitations under the License.
 
 #include <assert.h>
 #include <complex>
+#include <type_traits>
 
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/stream_executor/cuda/cuda_activation.h"
 #include "tensorflow/stream_executor/cuda/cuda_gpu_executor.h"
 #include "tensorflow/stream_executor/cuda/cuda_helpers.h"
@@ -266,6 +268,19 @@ PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasSgemmEx)
 
 #if CUDA_VERSION >= 8000
 PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasGemmEx)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasSgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasDgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasCgemmStridedBatched)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasZgemmStridedBatched)
+#endif
+
+#if CUDA_VERSION >= 9000
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasGetMathMode)
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasSetMathMode)
+#endif
+
+#if CUDA_VERSION >= 9010
+PERFTOOLS_GPUTOOLS_CUBLAS_WRAP(cublasGemmStridedBatchedEx)
 #endif
 
 }  // namespace wrap
@@ -360,6 +375,79 @@ class ScopedCublasPointerMode {
   bool ok_;                       // Whether the change was successful.
 };
 
+#if CUDA_VERSION >= 9000
+// cuBLAS only uses the tensor cores of Volta and later GPUs when its math mode
+// is CUBLAS_TENSOR_OP_MATH, which is set with cublasSetMathMode.
+//
+// This helper sets the cuBLAS math mode to a desired value for a cuBLAS call
+// you are about to perform in a given scope.
+//
+// The prior cuBLAS math mode is retained and restored when this object goes
+// out of scope.
+class ScopedCublasMathMode {
+ public:
+  // Note that, because the setting of the cublas math mode is fallible,
+  // construction of this scoped datatype must be paired with a call to
+  // Init().
+  //
+  // Parameters:
+  //  handle: The cublas library handle to act upon in setting the math mode.
+  explicit ScopedCublasMathMode(CUDAExecutor *parent, cublasHandle_t handle)
+      : parent_(parent), handle_(handle), ok_(false) {}
+
+  // Attempts the switch to the requested scoped math mode, new_mode.
+  //
+  // Note that when false is returned, an appropriate error has already been
+  // logged.
+  bool Init(cublasMath_t new_mode) {
+    cublasStatus_t ret = wrap::cublasGetMathMode(parent_, handle_, &old_mode_);
+    if (ret != CUBLAS_STATUS_SUCCESS) {
+      LOG(ERROR) << "failed to get old cublas math mode: " << ToString(ret);
+      return ok_ = false;
+    }
+
+    ret = wrap::cublasSetMathMode(parent_, handle_, new_mode);
+    if (ret != CUBLAS_STATUS_SUCCESS) {
+      LOG(ERROR) << "failed to set new cublas math mode: " << ToString(ret);
+      return ok_ = false;
+    }
+
+    return ok_ = true;
+  }
+
+  // Switches back to the prior math mode, if the switch operation was
+  // successful in the first place.
+  ~ScopedCublasMathMode() {
+    if (ok_) {
+      cublasStatus_t ret = wrap::cublasSetMathMode(parent_, handle_, old_mode_);
+      if (ret != CUBLAS_STATUS_SUCCESS) {
+        LOG(ERROR) << "failed to set former cublas math mode: "
+                   << ToString(ret);
+      }
+    }
+  }
+
+ private:
+  CUDAExecutor *parent_;   // Executor establishing this math mode for.
+  cublasHandle_t handle_;  // Handle to the cuBLAS instance of interest.
+  cublasMath_t old_mode_;  // Prior cuBLAS math mode, to be restored.
+  bool ok_;                // Whether the change was successful.
+};
+#endif  // CUDA_VERSION >= 9000
+
+// Whether cuBLAS calls that allow it may use tensor-op math, which multiplies
+// half precision inputs on the tensor cores and accumulates in single
+// precision. Set TF_DISABLE_CUBLAS_TENSOR_OP_MATH to disable it.
+static bool TensorOpMathEnabled() {
+  static bool is_enabled = [] {
+    bool ret;
+    TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+        "TF_DISABLE_CUBLAS_TENSOR_OP_MATH", /*default_val=*/false, &ret));
+    return !ret;
+  }();
+  return is_enabled;
+}
+
 bool CUDABlas::Init() {
   cublasStatus_t ret = wrap::cublasCreate(parent_, &blas_);
   if (ret != CUBLAS_STATUS_SUCCESS) {
@@ -532,7 +620,7 @@ cudaDataType_t CUDAComputationType(blas::ComputationType ty) {
 template <typename FuncT, typename... Args>
 bool CUDABlas::DoBlasInternalImpl(FuncT cublas_func, Stream *stream,
                                   bool pointer_mode_host, bool err_on_failure,
-                                  Args... args) {
+                                  bool use_tensor_op_math, Args... args) {
   mutex_lock lock{mu_};
 
   CHECK(blas_ != nullptr);
@@ -545,6 +633,14 @@ bool CUDABlas::DoBlasInternalImpl(FuncT cublas_func, Stream *stream,
                                            : CUBLAS_POINTER_MODE_DEVICE)) {
     return false;
   }
+#if CUDA_VERSION >= 9000
+  ScopedCublasMathMode math_mode{parent_, blas_};
+  if (use_tensor_op_math && TensorOpMathEnabled()) {
+    if (!math_mode.Init(CUBLAS_TENSOR_OP_MATH)) {
+      return false;
+    }
+  }
+#endif
 
   cublasStatus_t ret = cublas_func(parent_, blas_, args...);
   if (err_on_failure && ret != CUBLAS_STATUS_SUCCESS) {
@@ -1765,7 +1861,7 @@ bool CUDABlas::DoBlasGemm(
   // TODO(sesse): Consider supporting the Hgemm interface, which uses half
   // calculations internally (faster on newer devices, such as Pascal and TX1,
   // but less precise).
-  return DoBlasInternal(
+  return DoBlasInternalWithTensorOps(
       wrap::cublasSgemmEx, stream, true /* = pointer_mode_host */,
       CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k, &alpha,
       CUDAMemory(a), SE_CUDA_DATA_HALF, lda, CUDAMemory(b), SE_CUDA_DATA_HALF,
@@ -2067,8 +2163,11 @@ bool CUDABlas::DoBlasGemmWithAlgorithmImpl(
   // Since we are converting 'algorithm' to cublasGemmAlgo_t by static_cast,
   // we do the following compile-time check on the default value:
   static_assert(blas::kDefaultGemmAlgo == CUBLAS_GEMM_DFALT, "");
-  bool result = DoBlasInternalFailureOK(
+  // Tensor-op math keeps the precision of half precision inputs.
+  bool result = DoBlasInternalImpl(
       wrap::cublasGemmEx, stream, /* pointer_mode_host = */ true,
+      /*err_on_failure=*/false,
+      /*use_tensor_op_math=*/std::is_same<InT, Eigen::half>::value,
       CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k, &alpha,
       CUDAMemory(a), cuda_in_type, lda, CUDAMemory(b), cuda_in_type, ldb, &beta,
       CUDAMemoryMutable(c), CUDADataType<OutT>::type, ldc,
@@ -2329,6 +2428,130 @@ bool CUDABlas::DoBlasGemmBatched(
   return status.ok();
 }
 
+template <typename T, typename CompT>
+bool CUDABlas::DoBlasGemmStridedBatchedLoop(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, CompT alpha, const DeviceMemory<T> &a, int lda,
+    int64 stride_a, const DeviceMemory<T> &b, int ldb, int64 stride_b,
+    CompT beta, DeviceMemory<T> *c, int ldc, int64 stride_c,
+    int batch_count) {
+  T *a_base = const_cast<T *>(static_cast<const T *>(a.opaque()));
+  T *b_base = const_cast<T *>(static_cast<const T *>(b.opaque()));
+  T *c_base = static_cast<T *>(c->opaque());
+  for (int i = 0; i < batch_count; ++i) {
+    DeviceMemory<T> a_i(DeviceMemoryBase(a_base + i * stride_a));
+    DeviceMemory<T> b_i(DeviceMemoryBase(b_base + i * stride_b));
+    DeviceMemory<T> c_i(DeviceMemoryBase(c_base + i * stride_c));
+    if (!DoBlasGemm(stream, transa, transb, m, n, k, alpha, a_i, lda, b_i, ldb,
+                    beta, &c_i, ldc)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, float alpha, const DeviceMemory<Eigen::half> &a,
+    int lda, int64 stride_a, const DeviceMemory<Eigen::half> &b, int ldb,
+    int64 stride_b, float beta, DeviceMemory<Eigen::half> *c, int ldc,
+    int64 stride_c, int batch_count) {
+#if CUDA_VERSION >= 9010
+  // Accumulates in single precision, like the half precision DoBlasGemm.
+  return DoBlasInternalWithTensorOps(
+      wrap::cublasGemmStridedBatchedEx, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k, &alpha,
+      CUDAMemory(a), SE_CUDA_DATA_HALF, lda, stride_a, CUDAMemory(b),
+      SE_CUDA_DATA_HALF, ldb, stride_b, &beta, CUDAMemoryMutable(c),
+      SE_CUDA_DATA_HALF, ldc, stride_c, batch_count, CUDA_R_32F,
+      CUBLAS_GEMM_DFALT);
+#else
+  return DoBlasGemmStridedBatchedLoop(stream, transa, transb, m, n, k, alpha,
+                                      a, lda, stride_a, b, ldb, stride_b, beta,
+                                      c, ldc, stride_c, batch_count);
+#endif
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, float alpha, const DeviceMemory<float> &a, int lda,
+    int64 stride_a, const DeviceMemory<float> &b, int ldb, int64 stride_b,
+    float beta, DeviceMemory<float> *c, int ldc, int64 stride_c,
+    int batch_count) {
+#if CUDA_VERSION >= 8000
+  return DoBlasInternal(
+      wrap::cublasSgemmStridedBatched, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k, &alpha,
+      CUDAMemory(a), lda, stride_a, CUDAMemory(b), ldb, stride_b, &beta,
+      CUDAMemoryMutable(c), ldc, stride_c, batch_count);
+#else
+  return DoBlasGemmStridedBatchedLoop(stream, transa, transb, m, n, k, alpha,
+                                      a, lda, stride_a, b, ldb, stride_b, beta,
+                                      c, ldc, stride_c, batch_count);
+#endif
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, double alpha, const DeviceMemory<double> &a, int lda,
+    int64 stride_a, const DeviceMemory<double> &b, int ldb, int64 stride_b,
+    double beta, DeviceMemory<double> *c, int ldc, int64 stride_c,
+    int batch_count) {
+#if CUDA_VERSION >= 8000
+  return DoBlasInternal(
+      wrap::cublasDgemmStridedBatched, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k, &alpha,
+      CUDAMemory(a), lda, stride_a, CUDAMemory(b), ldb, stride_b, &beta,
+      CUDAMemoryMutable(c), ldc, stride_c, batch_count);
+#else
+  return DoBlasGemmStridedBatchedLoop(stream, transa, transb, m, n, k, alpha,
+                                      a, lda, stride_a, b, ldb, stride_b, beta,
+                                      c, ldc, stride_c, batch_count);
+#endif
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, std::complex<float> alpha,
+    const DeviceMemory<std::complex<float>> &a, int lda, int64 stride_a,
+    const DeviceMemory<std::complex<float>> &b, int ldb, int64 stride_b,
+    std::complex<float> beta, DeviceMemory<std::complex<float>> *c, int ldc,
+    int64 stride_c, int batch_count) {
+#if CUDA_VERSION >= 8000
+  return DoBlasInternal(
+      wrap::cublasCgemmStridedBatched, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k,
+      CUDAComplex(&alpha), CUDAComplex(CUDAMemory(a)), lda, stride_a,
+      CUDAComplex(CUDAMemory(b)), ldb, stride_b, CUDAComplex(&beta),
+      CUDAComplex(CUDAMemoryMutable(c)), ldc, stride_c, batch_count);
+#else
+  return DoBlasGemmStridedBatchedLoop(stream, transa, transb, m, n, k, alpha,
+                                      a, lda, stride_a, b, ldb, stride_b, beta,
+                                      c, ldc, stride_c, batch_count);
+#endif
+}
+
+bool CUDABlas::DoBlasGemmStridedBatched(
+    Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+    uint64 n, uint64 k, std::complex<double> alpha,
+    const DeviceMemory<std::complex<double>> &a, int lda, int64 stride_a,
+    const DeviceMemory<std::complex<double>> &b, int ldb, int64 stride_b,
+    std::complex<double> beta, DeviceMemory<std::complex<double>> *c, int ldc,
+    int64 stride_c, int batch_count) {
+#if CUDA_VERSION >= 8000
+  return DoBlasInternal(
+      wrap::cublasZgemmStridedBatched, stream, true /* = pointer_mode_host */,
+      CUDABlasTranspose(transa), CUDABlasTranspose(transb), m, n, k,
+      CUDAComplex(&alpha), CUDAComplex(CUDAMemory(a)), lda, stride_a,
+      CUDAComplex(CUDAMemory(b)), ldb, stride_b, CUDAComplex(&beta),
+      CUDAComplex(CUDAMemoryMutable(c)), ldc, stride_c, batch_count);
+#else
+  return DoBlasGemmStridedBatchedLoop(stream, transa, transb, m, n, k, alpha,
+                                      a, lda, stride_a, b, ldb, stride_b, beta,
+                                      c, ldc, stride_c, batch_count);
+#endif
+}
+
 bool CUDABlas::DoBlasHemm(Stream *stream, blas::Side side,
                           blas::UpperLower uplo, uint64 m, uint64 n,
                           std::complex<float> alpha,
@@ -80,25 +80,38 @@ class CUDABlas : public blas::BlasSupport {
   // pointer_mode_host:  Indicate if the pointer to a scalar value is from host
   //                     (true) or device (false).
   // err_on_failure:     Whether to print an error if the cublas function fails.
+  // use_tensor_op_math: Whether the function may use tensor-op math, unless
+  //                     disabled by TF_DISABLE_CUBLAS_TENSOR_OP_MATH. Only
+  //                     set for half precision inputs, since for single
+  //                     precision ones it rounds the inputs to half.
   // args:               Arguments of cuBLAS function.
   template <typename FuncT, typename... Args>
   bool DoBlasInternalImpl(FuncT cublas_func, Stream *stream,
                           bool pointer_mode_host, bool err_on_failure,
-                          Args... args);
+                          bool use_tensor_op_math, Args... args);
 
   // Convenience functions that call DoBlasInternalImpl with different values
-  // for err_on_failure.
+  // for err_on_failure and use_tensor_op_math.
   template <typename FuncT, typename... Args>
   bool DoBlasInternal(FuncT cublas_func, Stream *stream, bool pointer_mode_host,
                       Args... args) {
     return DoBlasInternalImpl(cublas_func, stream, pointer_mode_host,
-                              /*err_on_failure=*/true, args...);
+                              /*err_on_failure=*/true,
+                              /*use_tensor_op_math=*/false, args...);
   }
   template <typename FuncT, typename... Args>
   bool DoBlasInternalFailureOK(FuncT cublas_func, Stream *stream,
                                bool pointer_mode_host, Args... args) {
     return DoBlasInternalImpl(cublas_func, stream, pointer_mode_host,
-                              /*err_on_failure=*/false, args...);
+                              /*err_on_failure=*/false,
+                              /*use_tensor_op_math=*/false, args...);
+  }
+  template <typename FuncT, typename... Args>
+  bool DoBlasInternalWithTensorOps(FuncT cublas_func, Stream *stream,
+                                   bool pointer_mode_host, Args... args) {
+    return DoBlasInternalImpl(cublas_func, stream, pointer_mode_host,
+                              /*err_on_failure=*/true,
+                              /*use_tensor_op_math=*/true, args...);
   }
 
   // A helper function to implement DoBlasGemmBatched interfaces for generic
@@ -112,6 +125,16 @@ class CUDABlas : public blas::BlasSupport {
       const port::ArraySlice<DeviceMemory<T> *> &c_array, int ldc,
       int batch_count, ScratchAllocator *scratch_allocator);
 
+  // Implements DoBlasGemmStridedBatched with one DoBlasGemm per product,
+  // for CUDA versions that have no strided batched GEMM.
+  template <typename T, typename CompT>
+  bool DoBlasGemmStridedBatchedLoop(
+      Stream *stream, blas::Transpose transa, blas::Transpose transb, uint64 m,
+      uint64 n, uint64 k, CompT alpha, const DeviceMemory<T> &a, int lda,
+      int64 stride_a, const DeviceMemory<T> &b, int ldb, int64 stride_b,
+      CompT beta, DeviceMemory<T> *c, int ldc, int64 stride_c,
+      int batch_count);
+
   // Helper function for implementing DoBlasGemmWithAlgorithm.
   //
   // We take alpha and beta by const reference because T might be Eigen::half,
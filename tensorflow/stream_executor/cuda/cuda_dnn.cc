@@ -407,6 +407,13 @@ port::Status CudnnSupport::Init() {
                                    ToString(status))};
 }
 
+string CudnnSupport::GetVersion() {
+  // The version is encoded as major * 1000 + minor * 100 + patch level.
+  const size_t version = ::cudnnGetVersion();
+  return port::StrCat(version / 1000, ".", version % 1000 / 100, ".",
+                      version % 100);
+}
+
 // Turns a BatchDescriptor structure into a cudnn tensor handle within a scope.
 class ScopedTensorDescriptor {
  public:
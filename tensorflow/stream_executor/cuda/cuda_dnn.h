@@ -47,6 +47,8 @@ class CudnnSupport : public dnn::DnnSupport {
 
   port::Status Init() override;
 
+  string GetVersion() override;
+
   port::StatusOr<std::unique_ptr<dnn::RnnDescriptor>> createRnnDescriptor(
       int num_layers, int hidden_size, int input_size,
       dnn::RnnInputMode input_mode, dnn::RnnDirectionMode direction_mode,
@@ -885,6 +885,11 @@ class DnnSupport {
 
   virtual port::Status Init() = 0;
 
+  // Returns the version of the library that implements the routines, e.g.
+  // "6.0.21", or "" if it is unknown. Results that depend on the library,
+  // such as autotuned algorithms, are only valid for the same version.
+  virtual string GetVersion() { return ""; }
+
   // Performs a single-precision forward batch normalization operation onto
   // the stream.
   //
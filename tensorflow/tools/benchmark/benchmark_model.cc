@@ -20,6 +20,9 @@ limitations under the License.
 
 #include "tensorflow/tools/benchmark/benchmark_model.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -33,14 +36,18 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/init_main.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/command_line_flags.h"
 #include "tensorflow/core/util/reporter.h"
 #include "tensorflow/core/util/stat_summarizer.h"
@@ -51,6 +58,13 @@ namespace benchmark_model {
 Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
                          std::unique_ptr<GraphDef>* graph_def) {
+  return InitializeSession(num_threads, -1, graph, session, graph_def);
+}
+
+Status InitializeSession(int num_threads, int num_inter_op_threads,
+                         const string& graph,
+                         std::unique_ptr<Session>* session,
+                         std::unique_ptr<GraphDef>* graph_def) {
   LOG(INFO) << "Loading TensorFlow.";
 
   tensorflow::SessionOptions options;
@@ -58,6 +72,9 @@ Status InitializeSession(int num_threads, const string& graph,
   if (num_threads > 0) {
     config.set_intra_op_parallelism_threads(num_threads);
   }
+  if (num_inter_op_threads > 0) {
+    config.set_inter_op_parallelism_threads(num_inter_op_threads);
+  }
   LOG(INFO) << "Got config, " << config.device_count_size() << " devices";
 
   session->reset(tensorflow::NewSession(options));
@@ -84,7 +101,8 @@ void InitializeTensor(const std::vector<float>& initialization_values,
   auto type_tensor = input_tensor->flat<T>();
   type_tensor = type_tensor.constant(0);
   if (!initialization_values.empty()) {
-    for (int i = 0; i < initialization_values.size(); ++i) {
+    for (int i = 0;
+         i < initialization_values.size() && i < type_tensor.size(); ++i) {
       type_tensor(i) = static_cast<T>(initialization_values[i]);
     }
   }
@@ -343,6 +361,232 @@ Status TimeMultipleRuns(double sleep_seconds, int num_runs, double max_time_s,
   return Status::OK();
 }
 
+Status TimeConcurrentRuns(int num_client_threads, double target_qps,
+                          int num_runs, double max_time_s,
+                          const std::vector<InputLayerInfo>& inputs,
+                          const std::vector<string>& outputs, Session* session,
+                          LatencyStats* latency_stats) {
+  num_client_threads = std::max(num_client_threads, 1);
+  LOG(INFO) << "Running benchmark for max " << num_runs << " iterations, max "
+            << max_time_s << " seconds on " << num_client_threads
+            << " client threads, "
+            << (target_qps > 0.0 ? strings::StrCat("at ", target_qps, " qps")
+                                 : string("closed loop"));
+
+  const bool until_max_time = num_runs <= 0;
+  mutex mu;
+  std::vector<int64> latencies_us;
+  Status status;
+  // The index of the next run to start, shared by all the client threads.
+  std::atomic<int64> next_run(0);
+  std::atomic<bool> stop(false);
+  const int64 start_us = Env::Default()->NowMicros();
+  {
+    thread::ThreadPool pool(Env::Default(), "benchmark_client",
+                            num_client_threads);
+    for (int t = 0; t < num_client_threads; ++t) {
+      pool.Schedule([&]() {
+        std::vector<int64> thread_latencies_us;
+        while (!stop) {
+          const int64 run = next_run++;
+          if (!until_max_time && run >= num_runs) break;
+          // In an open loop, a run is due at a fixed time, and it is late
+          // when all the client threads were busy.
+          int64 due_us = Env::Default()->NowMicros();
+          if (target_qps > 0.0) {
+            due_us =
+                start_us + static_cast<int64>(run * 1000000.0 / target_qps);
+            const int64 now_us = Env::Default()->NowMicros();
+            if (due_us > now_us) {
+              Env::Default()->SleepForMicroseconds(due_us - now_us);
+            }
+          }
+          if (max_time_s > 0.0 &&
+              (Env::Default()->NowMicros() - start_us) / 1000000.0 >
+                  max_time_s) {
+            stop = true;
+            break;
+          }
+          int64 time;
+          Status run_status =
+              RunBenchmark(inputs, outputs, session, nullptr, &time);
+          if (!run_status.ok()) {
+            mutex_lock l(mu);
+            status.Update(run_status);
+            stop = true;
+            break;
+          }
+          thread_latencies_us.push_back(Env::Default()->NowMicros() - due_us);
+        }
+        mutex_lock l(mu);
+        latencies_us.insert(latencies_us.end(), thread_latencies_us.begin(),
+                            thread_latencies_us.end());
+      });
+    }
+  }
+  const double wall_time_s = (Env::Default()->NowMicros() - start_us) / 1e6;
+  TF_RETURN_IF_ERROR(status);
+  ComputeLatencyStats(std::move(latencies_us), wall_time_s, latency_stats);
+  return Status::OK();
+}
+
+void ComputeLatencyStats(std::vector<int64> latencies_us, double wall_time_s,
+                         LatencyStats* latency_stats) {
+  *latency_stats = LatencyStats();
+  latency_stats->num_runs = latencies_us.size();
+  latency_stats->wall_time_s = wall_time_s;
+  if (latencies_us.empty()) {
+    return;
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  // The nearest-rank percentile: the smallest latency that is at least as
+  // large as the given fraction of all latencies.
+  auto percentile = [&latencies_us](double fraction) {
+    const int64 rank = static_cast<int64>(
+        std::ceil(fraction * latencies_us.size() - 1e-9));
+    return latencies_us[std::max<int64>(rank, 1) - 1];
+  };
+  int64 sum_us = 0;
+  for (int64 latency_us : latencies_us) {
+    sum_us += latency_us;
+  }
+  latency_stats->mean_us = static_cast<double>(sum_us) / latencies_us.size();
+  latency_stats->min_us = latencies_us.front();
+  latency_stats->max_us = latencies_us.back();
+  latency_stats->p50_us = percentile(0.5);
+  latency_stats->p90_us = percentile(0.9);
+  latency_stats->p99_us = percentile(0.99);
+  latency_stats->p999_us = percentile(0.999);
+  if (wall_time_s > 0.0) {
+    latency_stats->throughput_qps = latencies_us.size() / wall_time_s;
+  }
+}
+
+namespace {
+
+string JsonEscape(const string& s) {
+  string escaped;
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      strings::StrAppend(&escaped, strings::Printf("\\u%04x", c));
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+string LatencyReportToJson(
+    const string& graph,
+    const std::vector<std::pair<BenchmarkConfig, LatencyStats>>& results) {
+  string json = strings::StrCat("{\n  \"graph\": \"", JsonEscape(graph),
+                                "\",\n  \"tensorflow_version\": \"",
+                                JsonEscape(TF_VERSION_STRING),
+                                "\",\n  \"results\": [");
+  for (int i = 0; i < results.size(); ++i) {
+    const BenchmarkConfig& config = results[i].first;
+    const LatencyStats& stats = results[i].second;
+    strings::StrAppend(
+        &json, i > 0 ? "," : "", "\n    {",
+        strings::Printf(
+            "\"inter_op_threads\": %d, \"intra_op_threads\": %d, "
+            "\"batch_size\": %d, \"num_client_threads\": %d, "
+            "\"target_qps\": %.3f, \"num_runs\": %lld, "
+            "\"wall_time_s\": %.6f, \"throughput_qps\": %.3f, "
+            "\"mean_us\": %.1f, \"min_us\": %lld, \"max_us\": %lld, "
+            "\"p50_us\": %lld, \"p90_us\": %lld, \"p99_us\": %lld, "
+            "\"p999_us\": %lld",
+            config.inter_op_threads, config.intra_op_threads,
+            config.batch_size, config.num_client_threads,
+            std::max(config.target_qps, 0.0),
+            static_cast<long long>(stats.num_runs), stats.wall_time_s,
+            stats.throughput_qps, stats.mean_us,
+            static_cast<long long>(stats.min_us),
+            static_cast<long long>(stats.max_us),
+            static_cast<long long>(stats.p50_us),
+            static_cast<long long>(stats.p90_us),
+            static_cast<long long>(stats.p99_us),
+            static_cast<long long>(stats.p999_us)),
+        "}");
+  }
+  strings::StrAppend(&json, "\n  ]\n}\n");
+  return json;
+}
+
+// Returns the inputs with their first dimension replaced by batch_size.
+std::vector<InputLayerInfo> InputsWithBatchSize(
+    const std::vector<InputLayerInfo>& inputs, int batch_size) {
+  std::vector<InputLayerInfo> batched = inputs;
+  if (batch_size <= 0) {
+    return batched;
+  }
+  for (InputLayerInfo& input : batched) {
+    if (input.shape.dims() > 0) {
+      input.shape.set_dim(0, batch_size);
+    }
+  }
+  return batched;
+}
+
+// Benchmarks each of the configs in a session of its own.
+Status SweepConfigs(const string& graph,
+                    const std::vector<BenchmarkConfig>& configs,
+                    const std::vector<InputLayerInfo>& inputs,
+                    const std::vector<string>& outputs, int warmup_runs,
+                    int num_runs, double max_time_s,
+                    std::vector<std::pair<BenchmarkConfig, LatencyStats>>*
+                        results) {
+  for (const BenchmarkConfig& config : configs) {
+    std::unique_ptr<Session> session;
+    std::unique_ptr<GraphDef> graph_def;
+    TF_RETURN_IF_ERROR(InitializeSession(config.intra_op_threads,
+                                         config.inter_op_threads, graph,
+                                         &session, &graph_def));
+    const std::vector<InputLayerInfo> batched_inputs =
+        InputsWithBatchSize(inputs, config.batch_size);
+    if (warmup_runs > 0) {
+      int64 warmup_time_us = 0;
+      int64 num_warmup_runs = 0;
+      TF_RETURN_IF_ERROR(TimeMultipleRuns(
+          -1.0, warmup_runs, -1.0, batched_inputs, outputs, session.get(),
+          nullptr, &warmup_time_us, &num_warmup_runs));
+    }
+    LatencyStats stats;
+    TF_RETURN_IF_ERROR(TimeConcurrentRuns(
+        config.num_client_threads, config.target_qps, num_runs, max_time_s,
+        batched_inputs, outputs, session.get(), &stats));
+    TF_RETURN_IF_ERROR(session->Close());
+    results->emplace_back(config, stats);
+  }
+  return Status::OK();
+}
+
+// Logs the results of a sweep as a table, one config per line.
+void LogLatencyTable(
+    const std::vector<std::pair<BenchmarkConfig, LatencyStats>>& results) {
+  std::stringstream stream;
+  stream << "inter_op intra_op    batch  clients   target qps     qps"
+         << "      p50 us      p90 us      p99 us    p99.9 us\n";
+  for (const auto& result : results) {
+    const BenchmarkConfig& config = result.first;
+    const LatencyStats& stats = result.second;
+    stream << strings::Printf(
+        "%8d %8d %8d %8d %12.1f %7.1f %11lld %11lld %11lld %11lld\n",
+        config.inter_op_threads, config.intra_op_threads, config.batch_size,
+        config.num_client_threads, std::max(config.target_qps, 0.0),
+        stats.throughput_qps, static_cast<long long>(stats.p50_us),
+        static_cast<long long>(stats.p90_us),
+        static_cast<long long>(stats.p99_us),
+        static_cast<long long>(stats.p999_us));
+  }
+  LOG(INFO) << "Latency by config:\n" << stream.str();
+}
+
 int Main(int argc, char** argv) {
   string graph = "/data/local/tmp/tensorflow_inception_graph.pb";
   string input_layer_string = "input:0";
@@ -368,6 +612,12 @@ int Main(int argc, char** argv) {
   bool show_summary = true;
   bool show_flops = false;
   int warmup_runs = 1;
+  int num_client_threads = 1;
+  string target_qps = "-1.0";
+  string inter_op_threads_string = "";
+  string intra_op_threads_string = "";
+  string batch_sizes_string = "";
+  string latency_json_path = "";
 
   std::vector<Flag> flag_list = {
       Flag("graph", &graph, "graph file name"),
@@ -401,6 +651,18 @@ int Main(int argc, char** argv) {
            "whether to show a summary of the stats"),
       Flag("show_flops", &show_flops, "whether to estimate the model's FLOPs"),
       Flag("warmup_runs", &warmup_runs, "how many runs to initialize model"),
+      Flag("num_client_threads", &num_client_threads,
+           "number of threads running the model at once"),
+      Flag("target_qps", &target_qps,
+           "runs to start per second, regardless of their latency"),
+      Flag("inter_op_threads", &inter_op_threads_string,
+           "comma-separated inter-op thread pool sizes to sweep over"),
+      Flag("intra_op_threads", &intra_op_threads_string,
+           "comma-separated intra-op thread pool sizes to sweep over"),
+      Flag("batch_sizes", &batch_sizes_string,
+           "comma-separated sizes of the first input dimension to sweep over"),
+      Flag("latency_json", &latency_json_path,
+           "file to write the latency percentiles of the sweep to as JSON"),
   };
   string usage = Flags::Usage(argv[0], flag_list);
   const bool parse_result = Flags::Parse(&argc, argv, flag_list);
@@ -454,6 +716,8 @@ int Main(int argc, char** argv) {
   LOG(INFO) << "Output prefix: [" << output_prefix << "]";
   LOG(INFO) << "Show sizes: [" << show_sizes << "]";
   LOG(INFO) << "Warmup runs: [" << warmup_runs << "]";
+  LOG(INFO) << "Client threads: [" << num_client_threads << "]";
+  LOG(INFO) << "Target qps: [" << target_qps << "]";
 
   std::unique_ptr<Session> session;
   std::unique_ptr<StatSummarizer> stats;
@@ -645,6 +909,65 @@ int Main(int argc, char** argv) {
     }
   }
 
+  // If requested, measure the latency distribution under concurrent load for
+  // every combination of the swept settings.
+  const double target_runs_per_second =
+      std::strtod(target_qps.c_str(), nullptr);
+  if (num_client_threads > 1 || target_runs_per_second > 0.0 ||
+      !inter_op_threads_string.empty() || !intra_op_threads_string.empty() ||
+      !batch_sizes_string.empty() || !latency_json_path.empty()) {
+    std::vector<int32> inter_op_threads = {-1};
+    std::vector<int32> intra_op_threads = {num_threads};
+    std::vector<int32> batch_sizes = {-1};
+    if ((!inter_op_threads_string.empty() &&
+         !str_util::SplitAndParseAsInts(inter_op_threads_string, ',',
+                                        &inter_op_threads)) ||
+        (!intra_op_threads_string.empty() &&
+         !str_util::SplitAndParseAsInts(intra_op_threads_string, ',',
+                                        &intra_op_threads)) ||
+        (!batch_sizes_string.empty() &&
+         !str_util::SplitAndParseAsInts(batch_sizes_string, ',',
+                                        &batch_sizes))) {
+      LOG(ERROR) << "--inter_op_threads, --intra_op_threads and --batch_sizes"
+                 << " must be comma-separated lists of integers";
+      return -1;
+    }
+    std::vector<BenchmarkConfig> configs;
+    for (int32 inter_op : inter_op_threads) {
+      for (int32 intra_op : intra_op_threads) {
+        for (int32 batch_size : batch_sizes) {
+          BenchmarkConfig config;
+          config.inter_op_threads = inter_op;
+          config.intra_op_threads = intra_op;
+          config.batch_size = batch_size;
+          config.num_client_threads = num_client_threads;
+          config.target_qps = target_runs_per_second;
+          configs.push_back(config);
+        }
+      }
+    }
+    SleepSeconds(inter_benchmark_sleep_seconds);
+    std::vector<std::pair<BenchmarkConfig, LatencyStats>> results;
+    Status sweep_status = SweepConfigs(graph, configs, inputs, output_layers,
+                                       warmup_runs, max_num_runs,
+                                       max_benchmark_time_seconds, &results);
+    if (!sweep_status.ok()) {
+      LOG(ERROR) << "Sweep failed with " << sweep_status;
+      return -1;
+    }
+    LogLatencyTable(results);
+    if (!latency_json_path.empty()) {
+      Status write_status =
+          WriteStringToFile(Env::Default(), latency_json_path,
+                            LatencyReportToJson(graph, results));
+      if (!write_status.ok()) {
+        LOG(ERROR) << "Writing " << latency_json_path << " failed with "
+                   << write_status;
+        return -1;
+      }
+    }
+  }
+
   return 0;
 }
 
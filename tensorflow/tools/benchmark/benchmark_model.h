@@ -30,11 +30,45 @@ struct InputLayerInfo {
   std::vector<float> initialization_values;
 };
 
+// Latency distribution and throughput of a set of runs.
+struct LatencyStats {
+  int64 num_runs = 0;
+  double wall_time_s = 0.0;
+  double throughput_qps = 0.0;
+  double mean_us = 0.0;
+  int64 min_us = 0;
+  int64 max_us = 0;
+  int64 p50_us = 0;
+  int64 p90_us = 0;
+  int64 p99_us = 0;
+  int64 p999_us = 0;
+};
+
+// One point of a sweep over session configurations and load patterns.
+struct BenchmarkConfig {
+  int inter_op_threads = -1;
+  int intra_op_threads = -1;
+  // The size of the first dimension of every input, or -1 to keep the shapes
+  // that were given.
+  int batch_size = -1;
+  int num_client_threads = 1;
+  // Runs started per second, or <= 0 to start each run on a client thread as
+  // soon as its previous run has finished.
+  double target_qps = -1.0;
+};
+
 // Loads a model from disk into a new session.
 Status InitializeSession(int num_threads, const string& graph,
                          std::unique_ptr<Session>* session,
                          std::unique_ptr<GraphDef>* graph_def);
 
+// Loads a model from disk into a new session with the given intra-op and
+// inter-op thread pool sizes. A size <= 0 keeps the default.
+Status InitializeSession(int num_threads, int num_inter_op_threads,
+                         const string& graph,
+                         std::unique_ptr<Session>* session,
+                         std::unique_ptr<GraphDef>* graph_def);
+
 // Does a single run of the model that's been loaded into the given session.
 Status RunBenchmark(const std::vector<InputLayerInfo>& inputs,
                     const std::vector<string>& outputs, Session* session,
@@ -47,6 +81,28 @@ Status TimeMultipleRuns(double sleep_seconds, int num_runs, double max_time_s,
                         StatSummarizer* stats, int64* total_time_us,
                         int64* actual_num_runs);
 
+// Runs the model from num_client_threads threads at once. Like
+// TimeMultipleRuns, stops after num_runs runs if num_runs > 0 and once
+// max_time_s has passed if max_time_s > 0. If target_qps > 0 the runs are
+// started on a fixed schedule whatever the latency of earlier runs, and the
+// latency of a run includes the time it waited for a free client thread.
+Status TimeConcurrentRuns(int num_client_threads, double target_qps,
+                          int num_runs, double max_time_s,
+                          const std::vector<InputLayerInfo>& inputs,
+                          const std::vector<string>& outputs, Session* session,
+                          LatencyStats* latency_stats);
+
+// Computes the percentiles of the given run latencies, which together took
+// wall_time_s.
+void ComputeLatencyStats(std::vector<int64> latencies_us, double wall_time_s,
+                         LatencyStats* latency_stats);
+
+// Formats the results of a sweep as a JSON document, suitable for comparing
+// runs of different TensorFlow versions.
+string LatencyReportToJson(
+    const string& graph,
+    const std::vector<std::pair<BenchmarkConfig, LatencyStats>>& results);
+
 // Handles all setup and argument parsing.
 int Main(int argc, char** argv);
 
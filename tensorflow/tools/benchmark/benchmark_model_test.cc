@@ -26,27 +26,25 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
-TEST(BenchmarkModelTest, InitializeAndRun) {
-  const string dir = testing::TmpDir();
-  const string filename_pb = io::JoinPath(dir, "graphdef.pb");
-
-  // Create a simple graph and write it to filename_pb.
+// Creates a simple graph and writes it to filename_pb.
+void CreateTestGraph(const string& filename_pb,
+                     benchmark_model::InputLayerInfo* input,
+                     string* output_name) {
   const int input_width = 400;
   const int input_height = 10;
-  benchmark_model::InputLayerInfo input;
-  input.shape = TensorShape({input_width, input_height});
-  input.data_type = DT_FLOAT;
+  input->shape = TensorShape({input_width, input_height});
+  input->data_type = DT_FLOAT;
   const TensorShape constant_shape({input_height, input_width});
 
   Tensor constant_tensor(DT_FLOAT, constant_shape);
   test::FillFn<float>(&constant_tensor, [](int) -> float { return 3.0; });
 
   auto root = Scope::NewRootScope().ExitOnError();
-  auto placeholder =
-      ops::Placeholder(root, DT_FLOAT, ops::Placeholder::Shape(input.shape));
-  input.name = placeholder.node()->name();
+  auto placeholder = ops::Placeholder(
+      root, DT_FLOAT, ops::Placeholder::Shape({-1, input->shape.dim_size(1)}));
+  input->name = placeholder.node()->name();
   auto m = ops::MatMul(root, placeholder, constant_tensor);
-  const string output_name = m.node()->name();
+  *output_name = m.node()->name();
 
   GraphDef graph_def;
   TF_ASSERT_OK(root.ToGraphDef(&graph_def));
@@ -54,6 +52,13 @@ TEST(BenchmarkModelTest, InitializeAndRun) {
   graph_def.SerializeToString(&graph_def_serialized);
   TF_ASSERT_OK(
       WriteStringToFile(Env::Default(), filename_pb, graph_def_serialized));
+}
+
+TEST(BenchmarkModelTest, InitializeAndRun) {
+  const string filename_pb = io::JoinPath(testing::TmpDir(), "graphdef.pb");
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  CreateTestGraph(filename_pb, &input, &output_name);
 
   std::unique_ptr<Session> session;
   std::unique_ptr<GraphDef> loaded_graph_def;
@@ -69,5 +74,61 @@ TEST(BenchmarkModelTest, InitializeAndRun) {
   ASSERT_EQ(num_runs, 10);
 }
 
+TEST(BenchmarkModelTest, ConcurrentRuns) {
+  const string filename_pb = io::JoinPath(testing::TmpDir(), "graphdef.pb");
+  benchmark_model::InputLayerInfo input;
+  string output_name;
+  CreateTestGraph(filename_pb, &input, &output_name);
+
+  std::unique_ptr<Session> session;
+  std::unique_ptr<GraphDef> loaded_graph_def;
+  TF_ASSERT_OK(benchmark_model::InitializeSession(1, 2, filename_pb, &session,
+                                                  &loaded_graph_def));
+  benchmark_model::LatencyStats closed_loop;
+  TF_ASSERT_OK(benchmark_model::TimeConcurrentRuns(
+      4, -1.0, 20, 0.0, {input}, {output_name}, session.get(), &closed_loop));
+  EXPECT_EQ(20, closed_loop.num_runs);
+  EXPECT_GT(closed_loop.throughput_qps, 0.0);
+  EXPECT_LE(closed_loop.min_us, closed_loop.p50_us);
+  EXPECT_LE(closed_loop.p50_us, closed_loop.p999_us);
+  EXPECT_LE(closed_loop.p999_us, closed_loop.max_us);
+
+  // 10 runs at 100 qps take at least the 90ms until the last one is due.
+  benchmark_model::LatencyStats open_loop;
+  TF_ASSERT_OK(benchmark_model::TimeConcurrentRuns(
+      2, 100.0, 10, 0.0, {input}, {output_name}, session.get(), &open_loop));
+  EXPECT_EQ(10, open_loop.num_runs);
+  EXPECT_GE(open_loop.wall_time_s, 0.09);
+}
+
+TEST(BenchmarkModelTest, LatencyPercentiles) {
+  std::vector<int64> latencies_us;
+  for (int i = 1000; i > 0; --i) {
+    latencies_us.push_back(i);
+  }
+  benchmark_model::LatencyStats stats;
+  benchmark_model::ComputeLatencyStats(latencies_us, 2.0, &stats);
+  EXPECT_EQ(1000, stats.num_runs);
+  EXPECT_EQ(500.0, stats.throughput_qps);
+  EXPECT_EQ(500.5, stats.mean_us);
+  EXPECT_EQ(1, stats.min_us);
+  EXPECT_EQ(1000, stats.max_us);
+  EXPECT_EQ(500, stats.p50_us);
+  EXPECT_EQ(900, stats.p90_us);
+  EXPECT_EQ(990, stats.p99_us);
+  EXPECT_EQ(999, stats.p999_us);
+
+  benchmark_model::ComputeLatencyStats({7}, 1.0, &stats);
+  EXPECT_EQ(7, stats.p50_us);
+  EXPECT_EQ(7, stats.p999_us);
+
+  std::vector<std::pair<benchmark_model::BenchmarkConfig,
+                        benchmark_model::LatencyStats>>
+      results = {{benchmark_model::BenchmarkConfig(), stats}};
+  const string json = benchmark_model::LatencyReportToJson("a\"b.pb", results);
+  EXPECT_TRUE(StringPiece(json).contains("\"graph\": \"a\\\"b.pb\""));
+  EXPECT_TRUE(StringPiece(json).contains("\"p999_us\": 7}"));
+}
+
 }  // namespace
 }  // namespace tensorflow
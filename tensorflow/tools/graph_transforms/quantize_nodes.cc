@@ -162,6 +162,87 @@ string UniqueNodeNameFromInput(const string& input_name) {
   return result;
 }
 
+// Adds the nodes that quantize the float tensor 'input_name' into eight bits,
+// using the range of its values, and returns the name of the QuantizeV2 node.
+string AddQuantizeNodes(const string& namespace_prefix,
+                        const string& input_name,
+                        std::vector<NodeDef>* new_nodes) {
+  string unique_input_name =
+      namespace_prefix + "/" + UniqueNodeNameFromInput(input_name);
+
+  // Add some common constants we need for reshaping inputs.
+  NodeDef reshape_dims;
+  reshape_dims.set_op("Const");
+  reshape_dims.set_name(unique_input_name + "/reshape_dims");
+  AddNodeInput("^" + input_name, &reshape_dims);
+  SetNodeAttr("dtype", DT_INT32, &reshape_dims);
+  Tensor reshape_dims_tensor(DT_INT32, {1});
+  reshape_dims_tensor.flat<int32>()(0) = -1;
+  SetNodeTensorAttr<int32>("value", reshape_dims_tensor, &reshape_dims);
+  new_nodes->push_back(reshape_dims);
+
+  NodeDef reduction_dims;
+  reduction_dims.set_op("Const");
+  reduction_dims.set_name(unique_input_name + "/reduction_dims");
+  AddNodeInput("^" + input_name, &reduction_dims);
+  SetNodeAttr("dtype", DT_INT32, &reduction_dims);
+  Tensor reduction_dims_tensor(DT_INT32, {1});
+  reduction_dims_tensor.flat<int32>()(0) = 0;
+  SetNodeTensorAttr<int32>("value", reduction_dims_tensor, &reduction_dims);
+  new_nodes->push_back(reduction_dims);
+
+  NodeDef reshape_node;
+  reshape_node.set_op("Reshape");
+  reshape_node.set_name(unique_input_name + "/reshape");
+  SetNodeAttr("T", DT_FLOAT, &reshape_node);
+  AddNodeInput(input_name, &reshape_node);
+  AddNodeInput(reshape_dims.name(), &reshape_node);
+  new_nodes->push_back(reshape_node);
+
+  NodeDef min_node;
+  min_node.set_op("Min");
+  min_node.set_name(unique_input_name + "/min");
+  SetNodeAttr("T", DT_FLOAT, &min_node);
+  SetNodeAttr("keep_dims", false, &min_node);
+  AddNodeInput(reshape_node.name(), &min_node);
+  AddNodeInput(reduction_dims.name(), &min_node);
+  new_nodes->push_back(min_node);
+
+  NodeDef max_node;
+  max_node.set_op("Max");
+  max_node.set_name(unique_input_name + "/max");
+  SetNodeAttr("T", DT_FLOAT, &max_node);
+  SetNodeAttr("keep_dims", false, &max_node);
+  AddNodeInput(reshape_node.name(), &max_node);
+  AddNodeInput(reduction_dims.name(), &max_node);
+  new_nodes->push_back(max_node);
+
+  NodeDef quantize_node;
+  quantize_node.set_op("QuantizeV2");
+  quantize_node.set_name(unique_input_name + "/quantize");
+  SetNodeAttr("T", DT_QUINT8, &quantize_node);
+  SetNodeAttr("mode", "MIN_FIRST", &quantize_node);
+  AddNodeInput(input_name, &quantize_node);
+  AddNodeInput(min_node.name(), &quantize_node);
+  AddNodeInput(max_node.name(), &quantize_node);
+  new_nodes->push_back(quantize_node);
+  return quantize_node.name();
+}
+
+// Adds a constant float scalar node.
+string AddFloatConstNode(const string& name, float value,
+                         std::vector<NodeDef>* new_nodes) {
+  NodeDef const_node;
+  const_node.set_op("Const");
+  const_node.set_name(name);
+  SetNodeAttr("dtype", DT_FLOAT, &const_node);
+  Tensor const_tensor(DT_FLOAT, {});
+  const_tensor.flat<float>()(0) = value;
+  SetNodeTensorAttr<float>("value", const_tensor, &const_node);
+  new_nodes->push_back(const_node);
+  return const_node.name();
+}
+
 // Pulls two float values from the named parameters, with a lot of checking.
 Status ExtractRangeFromParams(const TransformFuncContext& context,
                               const string& min_name, const string& max_name,
@@ -600,6 +681,123 @@ Status HoistFakeQuants(const GraphDef& input_graph_def,
   return Status::OK();
 }
 
+// Replaces float MatMul ops followed by a BiasAdd, and optionally a Relu, with
+// a single QuantizedMatMulWithBiasAndRequantize that produces eight-bit results
+// in the fallback range. This avoids the 32-bit intermediate results, and the
+// separate passes over them, of quantizing each op on its own.
+Status FuseQuantizedMatMuls(const GraphDef& input_graph_def,
+                            const TransformFuncContext& context,
+                            GraphDef* output_graph_def) {
+  float fallback_min;
+  float fallback_max;
+  bool has_fallback_range;
+  TF_RETURN_IF_ERROR(ExtractRangeFromParams(
+      context, "fallback_min", "fallback_max", &fallback_min, &fallback_max,
+      &has_fallback_range));
+  if (!has_fallback_range) {
+    return errors::InvalidArgument(
+        "Fusing quantized MatMuls requires fallback_min and fallback_max");
+  }
+
+  GraphDef current_graph_def = input_graph_def;
+  for (bool fused_relu : {true, false}) {
+    OpTypePattern pattern = {"BiasAdd", {{"MatMul"}, {"*"}}};
+    if (fused_relu) {
+      pattern = {"Relu", {pattern}};
+    }
+    GraphDef fused_graph_def;
+    TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
+        current_graph_def, pattern,
+        [fused_relu, fallback_min, fallback_max](
+            const NodeMatch& match, const std::set<string>& input_nodes,
+            const std::set<string>& output_nodes,
+            std::vector<NodeDef>* new_nodes) {
+          const NodeDef& float_node = match.node;
+          const NodeMatch& bias_add_match =
+              fused_relu ? match.inputs[0] : match;
+          const NodeDef& bias_add_node = bias_add_match.node;
+          const NodeDef& matmul_node = bias_add_match.inputs[0].node;
+
+          const NodeDef& bias_node = bias_add_match.inputs[1].node;
+
+          // The intermediate results must not be used elsewhere, and only
+          // float ops are quantized.
+          bool can_fuse = true;
+          for (const string& output_node : output_nodes) {
+            if (output_node != float_node.name() &&
+                output_node != bias_node.name()) {
+              can_fuse = false;
+            }
+          }
+          for (const NodeDef* node :
+               {&float_node, &bias_add_node, &matmul_node}) {
+            DataType type;
+            TF_RETURN_IF_ERROR(GetNodeAttr(*node, "T", &type));
+            if (type != DT_FLOAT) {
+              can_fuse = false;
+            }
+          }
+          if (!can_fuse) {
+            CopyOriginalMatch(match, new_nodes);
+            return Status::OK();
+          }
+
+          // Keep the non-fused input, e.g. the bias, in the graph.
+          new_nodes->push_back(bias_node);
+
+          string namespace_prefix = float_node.name() + "_eightbit";
+          const string quantized_a =
+              AddQuantizeNodes(namespace_prefix, matmul_node.input(0),
+                               new_nodes);
+          const string quantized_b =
+              AddQuantizeNodes(namespace_prefix, matmul_node.input(1),
+                               new_nodes);
+
+          NodeDef fused_node;
+          fused_node.set_op("QuantizedMatMulWithBiasAndRequantize");
+          fused_node.set_name(float_node.name() + "/eightbit");
+          CopyNodeAttr(matmul_node, "transpose_a", "transpose_a", &fused_node);
+          CopyNodeAttr(matmul_node, "transpose_b", "transpose_b", &fused_node);
+          SetNodeAttr("T1", DT_QUINT8, &fused_node);
+          SetNodeAttr("T2", DT_QUINT8, &fused_node);
+          SetNodeAttr("Toutput", DT_QUINT8, &fused_node);
+          SetNodeAttr("fused_relu", fused_relu, &fused_node);
+          AddNodeInput(quantized_a + ":0", &fused_node);
+          AddNodeInput(quantized_b + ":0", &fused_node);
+          AddNodeInput(bias_add_node.input(1), &fused_node);
+          AddNodeInput(quantized_a + ":1", &fused_node);
+          AddNodeInput(quantized_a + ":2", &fused_node);
+          AddNodeInput(quantized_b + ":1", &fused_node);
+          AddNodeInput(quantized_b + ":2", &fused_node);
+          AddNodeInput(AddFloatConstNode(fused_node.name() + "/fallback_min",
+                                         fallback_min, new_nodes),
+                       &fused_node);
+          AddNodeInput(AddFloatConstNode(fused_node.name() + "/fallback_max",
+                                         fallback_max, new_nodes),
+                       &fused_node);
+          new_nodes->push_back(fused_node);
+
+          // Convert the 8-bit result back into float for the final output.
+          NodeDef dequantize_node;
+          dequantize_node.set_op("Dequantize");
+          dequantize_node.set_name(float_node.name());
+          SetNodeAttr("T", DT_QUINT8, &dequantize_node);
+          SetNodeAttr("mode", "MIN_FIRST", &dequantize_node);
+          AddNodeInput(fused_node.name() + ":0", &dequantize_node);
+          AddNodeInput(fused_node.name() + ":1", &dequantize_node);
+          AddNodeInput(fused_node.name() + ":2", &dequantize_node);
+          new_nodes->push_back(dequantize_node);
+
+          return Status::OK();
+        },
+        {}, &fused_graph_def));
+    current_graph_def = fused_graph_def;
+  }
+  *output_graph_def = current_graph_def;
+
+  return Status::OK();
+}
+
 // Converts any float ops that have eight-bit equivalents into their quantized
 // forms, so that as much calculation as possible is done in the lower-precision
 // format.
@@ -704,11 +902,25 @@ Status QuantizeNodes(const GraphDef& input_graph_def,
       context, "fallback_min", "fallback_max", &fallback_min, &fallback_max,
       &has_fallback_range));
 
+  // If fuse_matmuls is set, MatMul, BiasAdd and Relu chains are replaced by
+  // fused ops that requantize into the fallback range as they compute.
+  bool fuse_matmuls;
+  TF_RETURN_IF_ERROR(
+      context.GetOneBoolParameter("fuse_matmuls", false, &fuse_matmuls));
+  GraphDef fused_graph_def;
+  if (fuse_matmuls && op_map.count("MatMul") && op_map.count("BiasAdd")) {
+    TF_RETURN_IF_ERROR(
+        FuseQuantizedMatMuls(converted_graph_def, context, &fused_graph_def));
+    TF_RETURN_IF_ERROR(IsGraphValid(fused_graph_def));
+  } else {
+    fused_graph_def = converted_graph_def;
+  }
+
   // Replace all occurrences of the current float op with its quantized
   // equivalent.
   GraphDef quantized_graph_def;
   TF_RETURN_IF_ERROR(ReplaceMatchingOpTypes(
-      converted_graph_def, {op_pattern},
+      fused_graph_def, {op_pattern},
       [&op_map, fallback_min, fallback_max, has_fallback_range](
           const NodeMatch& match, const std::set<string>& input_nodes,
           const std::set<string>& output_nodes,
@@ -751,68 +963,8 @@ Status QuantizeNodes(const GraphDef& input_graph_def,
             continue;
           }
 
-          const string& input_name = float_node.input(i);
-          string unique_input_name =
-              namespace_prefix + "/" + UniqueNodeNameFromInput(input_name);
-
-          // Add some common constants we need for reshaping inputs.
-          NodeDef reshape_dims;
-          reshape_dims.set_op("Const");
-          reshape_dims.set_name(unique_input_name + "/reshape_dims");
-          AddNodeInput("^" + input_name, &reshape_dims);
-          SetNodeAttr("dtype", DT_INT32, &reshape_dims);
-          Tensor reshape_dims_tensor(DT_INT32, {1});
-          reshape_dims_tensor.flat<int32>()(0) = -1;
-          SetNodeTensorAttr<int32>("value", reshape_dims_tensor, &reshape_dims);
-          new_nodes->push_back(reshape_dims);
-
-          NodeDef reduction_dims;
-          reduction_dims.set_op("Const");
-          reduction_dims.set_name(unique_input_name + "/reduction_dims");
-          AddNodeInput("^" + input_name, &reduction_dims);
-          SetNodeAttr("dtype", DT_INT32, &reduction_dims);
-          Tensor reduction_dims_tensor(DT_INT32, {1});
-          reduction_dims_tensor.flat<int32>()(0) = 0;
-          SetNodeTensorAttr<int32>("value", reduction_dims_tensor,
-                                   &reduction_dims);
-          new_nodes->push_back(reduction_dims);
-
-          NodeDef reshape_node;
-          reshape_node.set_op("Reshape");
-          reshape_node.set_name(unique_input_name + "/reshape");
-          SetNodeAttr("T", DT_FLOAT, &reshape_node);
-          AddNodeInput(input_name, &reshape_node);
-          AddNodeInput(reshape_dims.name(), &reshape_node);
-          new_nodes->push_back(reshape_node);
-
-          NodeDef min_node;
-          min_node.set_op("Min");
-          min_node.set_name(unique_input_name + "/min");
-          SetNodeAttr("T", DT_FLOAT, &min_node);
-          SetNodeAttr("keep_dims", false, &min_node);
-          AddNodeInput(reshape_node.name(), &min_node);
-          AddNodeInput(reduction_dims.name(), &min_node);
-          new_nodes->push_back(min_node);
-
-          NodeDef max_node;
-          max_node.set_op("Max");
-          max_node.set_name(unique_input_name + "/max");
-          SetNodeAttr("T", DT_FLOAT, &max_node);
-          SetNodeAttr("keep_dims", false, &max_node);
-          AddNodeInput(reshape_node.name(), &max_node);
-          AddNodeInput(reduction_dims.name(), &max_node);
-          new_nodes->push_back(max_node);
-
-          NodeDef quantize_node;
-          quantize_node.set_op("QuantizeV2");
-          quantize_node.set_name(unique_input_name + "/quantize");
-          SetNodeAttr("T", DT_QUINT8, &quantize_node);
-          SetNodeAttr("mode", "MIN_FIRST", &quantize_node);
-          AddNodeInput(input_name, &quantize_node);
-          AddNodeInput(min_node.name(), &quantize_node);
-          AddNodeInput(max_node.name(), &quantize_node);
-          new_nodes->push_back(quantize_node);
-          quantized_input_names.push_back(quantize_node.name());
+          quantized_input_names.push_back(AddQuantizeNodes(
+              namespace_prefix, float_node.input(i), new_nodes));
         }
 
         // Set up the quantized version of the current op.
@@ -861,30 +1013,12 @@ Status QuantizeNodes(const GraphDef& input_graph_def,
           string requantize_max_input;
           if (has_fallback_range) {
             // Use constant values for the min/max range if they were given.
-            NodeDef fallback_min_node;
-            fallback_min_node.set_op("Const");
-            fallback_min_node.set_name(quantized_main_node.name() +
-                                       "/fallback_min");
-            SetNodeAttr("dtype", DT_FLOAT, &fallback_min_node);
-            Tensor fallback_min_tensor(DT_FLOAT, {});
-            fallback_min_tensor.flat<float>()(0) = fallback_min;
-            SetNodeTensorAttr<float>("value", fallback_min_tensor,
-                                     &fallback_min_node);
-            new_nodes->push_back(fallback_min_node);
-
-            NodeDef fallback_max_node;
-            fallback_max_node.set_op("Const");
-            fallback_max_node.set_name(quantized_main_node.name() +
-                                       "/fallback_max");
-            SetNodeAttr("dtype", DT_FLOAT, &fallback_max_node);
-            Tensor fallback_max_tensor(DT_FLOAT, {});
-            fallback_max_tensor.flat<float>()(0) = fallback_max;
-            SetNodeTensorAttr<float>("value", fallback_max_tensor,
-                                     &fallback_max_node);
-            new_nodes->push_back(fallback_max_node);
-
-            requantize_min_input = fallback_min_node.name();
-            requantize_max_input = fallback_max_node.name();
+            requantize_min_input = AddFloatConstNode(
+                quantized_main_node.name() + "/fallback_min", fallback_min,
+                new_nodes);
+            requantize_max_input = AddFloatConstNode(
+                quantized_main_node.name() + "/fallback_max", fallback_max,
+                new_nodes);
           } else {
             // Otherwise dynamically measure the range each time.
             NodeDef requant_range_node;
@@ -1428,6 +1428,76 @@ class QuantizeNodesTest : public ::testing::Test {
     ASSERT_EQ(1, node_map.count("included_reshape_op"));
     EXPECT_EQ("Dequantize", node_map.at("included_reshape_op")->op());
   }
+
+  void TestFuseMatMuls() {
+    auto root = tensorflow::Scope::NewRootScope();
+    using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+
+    Tensor a_tensor(DT_FLOAT, TensorShape({2, 3}));
+    test::FillValues<float>(&a_tensor, {1.0f, -2.0f, 3.0f, 4.0f, 5.0f, -6.0f});
+    Output a_op = Const(root.WithOpName("a_op"), Input::Initializer(a_tensor));
+
+    Tensor b_tensor(DT_FLOAT, TensorShape({3, 4}));
+    test::FillIota<float>(&b_tensor, -3.0f);
+    Output b_op = Const(root.WithOpName("b_op"), Input::Initializer(b_tensor));
+
+    Output bias_op = Placeholder(root.WithOpName("bias_op"), DT_FLOAT);
+
+    Output matmul_op = MatMul(root.WithOpName("matmul_op"), a_op, b_op);
+    Output bias_add_op =
+        BiasAdd(root.WithOpName("bias_add_op"), matmul_op, bias_op);
+    Output relu_op = Relu(root.WithOpName("relu_op"), bias_add_op);
+
+    Tensor c_tensor(DT_FLOAT, TensorShape({2, 4}));
+    test::FillValues<float>(&c_tensor,
+                            {0.1f, -0.2f, 0.3f, 0.4f, -0.5f, 0.6f, 0.7f, 0.8f});
+    Output c_op = Const(root.WithOpName("c_op"), Input::Initializer(c_tensor));
+
+    Tensor bias2_tensor(DT_FLOAT, TensorShape({2}));
+    test::FillValues<float>(&bias2_tensor, {1.0f, -1.0f});
+    Output bias2_op =
+        Const(root.WithOpName("bias2_op"), Input::Initializer(bias2_tensor));
+
+    Output matmul_op2 = MatMul(root.WithOpName("matmul_op2"), relu_op, c_op,
+                               MatMul::TransposeB(true));
+    Output bias_add_op2 =
+        BiasAdd(root.WithOpName("bias_add_op2"), matmul_op2, bias2_op);
+    Output relu_op2 = Relu(root.WithOpName("relu_op2"), matmul_op2);
+
+    GraphDef float_graph_def;
+    TF_ASSERT_OK(root.ToGraphDef(&float_graph_def));
+
+    Tensor bias_tensor(DT_FLOAT, TensorShape({4}));
+    test::FillValues<float>(&bias_tensor, {0.5f, -10.0f, 20.0f, 1.0f});
+
+    TransformFuncContext context;
+    context.params["fallback_min"] = {"-50"};
+    context.params["fallback_max"] = {"150"};
+    context.params["fuse_matmuls"] = {"true"};
+    GraphDef quantized_graph_def;
+    TestTransformedVersusFloatGraph(
+        QuantizeNodes, float_graph_def, {{"bias_op", bias_tensor}},
+        {{"bias_op", bias_tensor}}, {"relu_op", "bias_add_op2", "relu_op2"},
+        context, 2.0, &quantized_graph_def);
+
+    std::map<string, const NodeDef*> node_map;
+    MapNamesToNodes(quantized_graph_def, &node_map);
+    ASSERT_EQ(1, node_map.count("relu_op/eightbit"));
+    const NodeDef& fused_node = *node_map.at("relu_op/eightbit");
+    EXPECT_EQ("QuantizedMatMulWithBiasAndRequantize", fused_node.op());
+    EXPECT_TRUE(fused_node.attr().at("fused_relu").b());
+    EXPECT_EQ("bias_op", fused_node.input(2));
+    ASSERT_EQ(1, node_map.count("relu_op"));
+    EXPECT_EQ("Dequantize", node_map.at("relu_op")->op());
+    EXPECT_EQ(0, node_map.count("matmul_op"));
+    EXPECT_EQ(0, node_map.count("bias_add_op"));
+
+    // The second MatMul is also used by a Relu outside the pattern, so it's
+    // quantized on its own.
+    EXPECT_EQ(0, node_map.count("bias_add_op2/eightbit"));
+    ASSERT_EQ(1, node_map.count("matmul_op2/eightbit"));
+    EXPECT_EQ("QuantizedMatMul", node_map.at("matmul_op2/eightbit")->op());
+  }
 };
 
 TEST_F(QuantizeNodesTest, TestIgnoreOps) {
@@ -1529,5 +1599,7 @@ TEST_F(QuantizeNodesTest, TestMergeDuplicateInOut) {
 
 TEST_F(QuantizeNodesTest, TestExcludeNonFloat) { TestExcludeNonFloat(); }
 
+TEST_F(QuantizeNodesTest, TestFuseMatMuls) { TestFuseMatMuls(); }
+
 }  // namespace graph_transforms
 }  // namespace tensorflow
@@ -9,7 +9,8 @@ def tf_cc_logged_benchmark(
     benchmarks="..",
     tags=[],
     test_log_output_prefix="",
-    benchmark_type="cpp_microbenchmark"):
+    benchmark_type="cpp_microbenchmark",
+    benchmark_args=[]):
   if not name:
     fail("Must provide a name")
   if not target:
@@ -33,7 +34,8 @@ def tf_cc_logged_benchmark(
       args = [
           "--name=//%s:%s" % (PACKAGE_NAME, name),
           "--test_name=" + target,
-          "--test_args=--benchmarks=%s" % benchmarks,
+          "'--test_args=%s'" % " ".join(
+              ["--benchmarks=%s" % benchmarks] + benchmark_args),
           "--benchmark_type=%s" % benchmark_type,
       ],
       data = [
@@ -44,6 +46,27 @@ def tf_cc_logged_benchmark(
           "//tensorflow/tools/test:run_and_gather_logs"
       ])
 
+# Create a benchmark test target for each of the given TensorFlow C++ tests,
+# and a test_suite 'name' that runs all of them with the same arguments.
+def tf_cc_logged_benchmarks(
+    name=None,
+    targets=[],
+    tags=[],
+    benchmark_args=[]):
+  benchmark_names = []
+  for target in targets:
+    benchmark_name = "%s_%s" % (name, target.split(":")[-1])
+    tf_cc_logged_benchmark(
+        name=benchmark_name,
+        target=target,
+        tags=tags,
+        benchmark_args=benchmark_args)
+    benchmark_names.append(":" + benchmark_name)
+  native.test_suite(
+      name=name,
+      tags=["manual"],
+      tests=benchmark_names)
+
 # Create a benchmark test target of a TensorFlow python test (*py_tests)
 def tf_py_logged_benchmark(
     name=None,